@@ -17,6 +17,7 @@ import copy
 import base64
 import socket
 import itertools
+import urllib.parse
 
 import ecdsa
 #import rsa
@@ -51,7 +52,8 @@ def verifySignature(message: bytes, signature: bytes, key_name: str) -> bool:
 @defer.inlineCallbacks
 def addKeyToSVs(key_name):
     print("[", str(datetime.datetime.now()), "] [ addKeyToSVs ] start")
-    for name in [name for name, attrs in graph.nodes(data=True) if attrs["type"] == "SV"]:
+    # the NRs check the route registrations with them
+    for name in [name for name, attrs in graph.nodes(data=True) if attrs["type"] in ("SV", "NR")]:
         key_tuples = [(key_name, "RSA", keys[key_name])]
         resp = yield modules_socket.addKeys(name, key_tuples)
         if resp and resp == "success":
@@ -62,7 +64,7 @@ def addKeyToSVs(key_name):
 @defer.inlineCallbacks
 def addKeysToSV(node_name):
     print("[", str(datetime.datetime.now()), "] [ addKeysToSV ] start")
-    if graph.nodes[node_name]["type"] == "SV":
+    if graph.nodes[node_name]["type"] in ("SV", "NR"):
         key_tuples = []
         for key in keys:
             key_tuples.append((key, "RSA", keys[key]))
@@ -77,7 +79,7 @@ def addKeysToSV(node_name):
 @defer.inlineCallbacks
 def delSVsKey(key_name):
     print("[", str(datetime.datetime.now()), "] [ delSVsKey ] start")
-    for name in [name for name, attrs in graph.nodes(data=True) if attrs["type"] == "SV"]:
+    for name in [name for name, attrs in graph.nodes(data=True) if attrs["type"] in ("SV", "NR")]:
         resp = yield modules_socket.delKeys(name, [key_name])
         if resp and resp == "success":
             pass
@@ -107,6 +109,14 @@ node_default_attrs = {
         "cpu_system": 0,
         "cpu_total": 0,
         "last_update": 0.0
+    },
+    # time of the threads by stage (decode, table, encode, send, verify, report) from the reports of the modules
+    "stage_stats": {
+        # in seconds since the start of the module
+        "seconds": {},
+        # in percent of the time between the last two reports
+        "shares": {},
+        "last_update": 0.0
     }
 }
 specific_node_default_attrs = {
@@ -117,19 +127,51 @@ specific_node_default_attrs = {
             "cache_hit": 0.0,
             "hit_count": 0,
             "miss_count": 0,
+            "used_bytes": 0,
+            # most requested prefixes with their hits and misses
+            "prefixes": [],
             "last_update": 0.0
         },
+        # face id by clone, for the cooperative caching between the clones of a scaled CS
+        "peer_faces": {},
         "cpu_quota": 100000
     },
     "BR": {
         "type": "BR",
         "size": 250,
+        "pit_stats": {
+            "entries": 0,
+            "used_bytes": 0,
+            "rejected_count": 0,
+            "evicted_count": 0,
+            # Interests refused or entries evicted since the former report
+            "rejected": 0,
+            "evicted": 0,
+            # the ingress faces using the most of the PIT
+            "faces": [],
+            # round trip times by egress face and by prefix
+            "rtt": {},
+            "last_update": 0.0
+        },
         "cpu_quota": 50000
     },
     "NR": {
         "type": "NR",
         "static_routes": {},
         "dynamic_routes": {},
+        "forwarding_stats": {
+            "interests_per_second": 0.0,
+            # faces an Interest is sent to, on average
+            "fan_out": 0.0,
+            "lookup_ns": {},
+            # the prefixes with the most Interests
+            "prefixes": [],
+            # registrations queued or waiting for the manager
+            "registration_queue": 0,
+            "last_update": 0.0
+        },
+        # Interests sent per second, i.e. interests_per_second times fan_out, above which the NR is scaled up
+        "forwarding_quota": 200000,
         "cpu_quota": 100000
     },
     "SR": {
@@ -243,16 +285,43 @@ def updateContainersCpuStats():
     print("[", str(datetime.datetime.now()), "] [ updateContainersCpuStats ] end")
 
 
+# the stages of a report, the shares are over the time since the previous report rather than since the module started
+def updateStageStats(name, j):
+    if "stages" not in j or not graph.has_node(name):
+        return
+    stage_stats = graph.nodes[name]["stage_stats"]
+    seconds = {stage: value["seconds"] for stage, value in j["stages"].items() if isinstance(value, dict)}
+    deltas = {stage: max(value - stage_stats["seconds"].get(stage, 0.0), 0.0) for stage, value in seconds.items()}
+    total = sum(deltas.values())
+    stage_stats["shares"] = {stage: round(100 * delta / total, 1) for stage, delta in deltas.items()} if total > 0 else {}
+    stage_stats["seconds"] = seconds
+    stage_stats["last_update"] = time.time()
+
+
+# the stage taking the most of the time of a node, None until it reported its stages twice
+def getHotStage(attrs):
+    shares = attrs["stage_stats"]["shares"]
+    return max(shares, key=shares.get) if shares else None
+
+
+# from the forwarding_status reports of a NR, false for the other nodes or while a NR doesn't report
+def isForwardingOverloaded(attrs):
+    if attrs["type"] != "NR":
+        return False
+    forwarding_stats = attrs["forwarding_stats"]
+    return forwarding_stats["interests_per_second"] * max(forwarding_stats["fan_out"], 1.0) >= attrs["forwarding_quota"]
+
+
 @defer.inlineCallbacks
 def autoScale():
     print("[", str(datetime.datetime.now()), "] [ autoScale ] start")
-    scale_up_functions = {"BR": scaleUpBR, "NR": scaleUpNR}
-    scale_down_functions = {"NR": scaleDownNR}
+    scale_up_functions = {"BR": scaleUpBR, "NR": scaleUpNR, "CS": scaleUpCS}
+    scale_down_functions = {"NR": scaleDownNR, "CS": scaleDownCS}
     for name, attrs in list(graph.nodes(data=True)):
         if attrs["scalable"] and name not in locked_nodes:
             locked_nodes.add(name)
-            if attrs["cpu_stats"]["cpu_percent"] >= attrs["cpu_quota"] * 0.0009 and list(graph.predecessors(name)) and list(graph.successors(name)):
-                print("[", str(datetime.datetime.now()), "] [ autoScale ] scale up", name)
+            if (attrs["cpu_stats"]["cpu_percent"] >= attrs["cpu_quota"] * 0.0009 or isForwardingOverloaded(attrs)) and list(graph.predecessors(name)) and list(graph.successors(name)):
+                print("[", str(datetime.datetime.now()), "] [ autoScale ] scale up", name, "hot stage:", getHotStage(attrs))
                 yield scale_up_functions.get(attrs["type"], scaleUp)(name, attrs)
             elif attrs.get("scaled", False) and attrs["cpu_stats"]["cpu_percent"] <= attrs["cpu_quota"] * 0.0002:
                 print("[", str(datetime.datetime.now()), "] [ autoScale ] scale down", name)
@@ -264,7 +333,7 @@ def autoScale():
 
 
 @defer.inlineCallbacks
-def scaleUp(name, attrs):
+def scaleUp(name, attrs, strategy="weighted"):
     print("[", str(datetime.datetime.now()), "] [ scaleUp ] start")
     scale = attrs.get("scale", 1)
     in_node_names = list(graph.predecessors(name))
@@ -278,10 +347,10 @@ def scaleUp(name, attrs):
             graph.add_node(lb_name, editable=False, scalable=False, addresses=getContainerIPAddresses(lb_name),
                            **copy.deepcopy(node_default_attrs), **copy.deepcopy(specific_node_default_attrs["SR"]))
             print("[", str(datetime.datetime.now()), "] [ scaleUp ]", lb_name, "created")
-            # set strategy to loadbalancing
-            resp = yield modules_socket.editConfig(lb_name, {"strategy": "loadbalancing"})
+            # set strategy, weighted by how fast each clone answers unless the clones share the prefixes
+            resp = yield modules_socket.editConfig(lb_name, {"strategy": strategy, "auto_weights": True})
             if resp and "strategy" in resp:
-                print("[", str(datetime.datetime.now()), "] [ scaleUp ]", "set", lb_name, "strategy to loadbalancing")
+                print("[", str(datetime.datetime.now()), "] [ scaleUp ]", "set", lb_name, "strategy to", strategy)
                 attachNode(lb_name, in_node_names, [name])
     print("[", str(datetime.datetime.now()), "] [ scaleUp ]", "step 2")
     clone_name = name + "." + str(scale)
@@ -296,12 +365,46 @@ def scaleUp(name, attrs):
         #    if resp:
         #        print("[", str(datetime.datetime.now()), "] [ scaleUpBR ]", resp)
         # for each successor
-        attachNode(clone_name, [lb_name], out_node_names, True)
+        yield attachNode(clone_name, [lb_name], out_node_names, True)
+        # once its faces are there, the routes of a NR go to those of the same successors
+        if attrs["type"] in STATE_TRANSFER_TYPES:
+            yield transferState(name, clone_name)
     attrs["scale"] = scale + 1
     attrs["scaled"] = True
     print("[", str(datetime.datetime.now()), "] [ scaleUp ] end")
 
 
+# the clone of a NR is given the routes of the node, the dynamic routes it now has are those of the node to the same
+# successors
+@defer.inlineCallbacks
+def scaleUpNR(name, attrs):
+    print("[", str(datetime.datetime.now()), "] [ scaleUpNR ] start")
+    clone_name = name + "." + str(attrs.get("scale", 1))
+    yield scaleUp(name, attrs)
+    if graph.has_node(clone_name):
+        for out_name in graph.successors(clone_name):
+            if graph.has_edge(name, out_name):
+                routes = graph.nodes[name]["dynamic_routes"].get(graph.edges[name, out_name]["face_id"], None)
+                if routes:
+                    graph.nodes[clone_name]["dynamic_routes"][graph.edges[clone_name, out_name]["face_id"]] = set(routes)
+    print("[", str(datetime.datetime.now()), "] [ scaleUpNR ] end")
+
+
+# the clone listens first, then the node sends it its hot entries or its routes straight over TCP, the clone is useful
+# at once instead of after warming up
+@defer.inlineCallbacks
+def transferState(name, clone_name):
+    resp = yield modules_socket.importState(clone_name)
+    if resp != "success":
+        print("[", str(datetime.datetime.now()), "] [ transferState ]", clone_name, "can't receive the state of", name)
+        return
+    resp = yield modules_socket.exportState(name, clone_name)
+    if resp == "success":
+        print("[", str(datetime.datetime.now()), "] [ transferState ]", "state of", name, "sent to", clone_name)
+    else:
+        print("[", str(datetime.datetime.now()), "] [ transferState ]", "state of", name, "not sent to", clone_name)
+
+
 @defer.inlineCallbacks
 def scaleUpBR(name, attrs):
     print("[", str(datetime.datetime.now()), "] [ scaleUpBR ] start")
@@ -319,9 +422,10 @@ def scaleUpBR(name, attrs):
                 graph.add_node(lb_name, editable=False, scalable=False, addresses=getContainerIPAddresses(lb_name),
                                **copy.deepcopy(node_default_attrs), **copy.deepcopy(specific_node_default_attrs["SR"]))
                 print("[", str(datetime.datetime.now()), "] [ scaleUpBR ]", lb_name, "created")
-                resp = yield modules_socket.editConfig(lb_name, {"strategy": "loadbalancing"})
+                # a Name always goes to the same clone, its Interests are aggregated in a single PIT
+                resp = yield modules_socket.editConfig(lb_name, {"strategy": "hashing"})
                 if resp and "strategy" in resp:
-                    print("[", str(datetime.datetime.now()), "] [ scaleUpBR ]", "set", lb_name, "strategy to loadbalancing")
+                    print("[", str(datetime.datetime.now()), "] [ scaleUpBR ]", "set", lb_name, "strategy to hashing")
                 resp = yield modules_socket.addFace(lb_name, name)
                 if resp and resp > 0:
                     print("[", str(datetime.datetime.now()), "] [ scaleUpBR ]", lb_name, "linked to", name)
@@ -422,6 +526,57 @@ def scaleDown(name, attrs):
     print("[", str(datetime.datetime.now()), "] [ scaleDown ] end")
 
 
+# the clones of a CS share the prefixes instead of all caching the same Data: the SR sends each Interest to the clone
+# owning its prefix and a clone forwards its misses on the prefixes of another one to it
+@defer.inlineCallbacks
+def scaleUpCS(name, attrs):
+    print("[", str(datetime.datetime.now()), "] [ scaleUpCS ] start")
+    yield scaleUp(name, attrs, "hashing")
+    yield updateCSCluster(name, attrs)
+    print("[", str(datetime.datetime.now()), "] [ scaleUpCS ] end")
+
+
+@defer.inlineCallbacks
+def scaleDownCS(name, attrs):
+    print("[", str(datetime.datetime.now()), "] [ scaleDownCS ] start")
+    clone_name = name + "." + str(attrs["scale"] - 1)
+    for member in getCSClusterMembers(name, attrs):
+        face_id = graph.nodes[member]["peer_faces"].pop(clone_name, None)
+        if member != clone_name and face_id:
+            resp = yield modules_socket.delFaceById(member, face_id)
+            if resp:
+                print("[", str(datetime.datetime.now()), "] [ scaleDownCS ]", member, "no longer peer of", clone_name)
+    yield scaleDown(name, attrs)
+    yield updateCSCluster(name, attrs)
+    print("[", str(datetime.datetime.now()), "] [ scaleDownCS ] end")
+
+
+def getCSClusterMembers(name, attrs):
+    return [name] + [name + "." + str(i) for i in range(1, attrs.get("scale", 1)) if graph.has_node(name + "." + str(i))]
+
+
+def getCSClusterEndpoint(name):
+    # as the SR and the peers see the clone, the endpoint of their TCP face to it
+    return graph.nodes[name]["addresses"]["data"] + ":6363"
+
+
+@defer.inlineCallbacks
+def updateCSCluster(name, attrs):
+    members = getCSClusterMembers(name, attrs)
+    for member in members:
+        # a CS left alone is no longer part of a cluster
+        endpoint = getCSClusterEndpoint(member) if len(members) > 1 else ""
+        resp = yield modules_socket.editConfig(member, {"cluster_endpoint": endpoint})
+        if resp and "cluster_endpoint" in resp:
+            print("[", str(datetime.datetime.now()), "] [ updateCSCluster ]", member, "cluster endpoint set to", endpoint)
+        for peer in members:
+            if peer != member and peer not in graph.nodes[member]["peer_faces"]:
+                resp = yield modules_socket.addFace(member, peer, peer=True)
+                if resp and resp > 0:
+                    print("[", str(datetime.datetime.now()), "] [ updateCSCluster ]", member, "peer of", peer)
+                    graph.nodes[member]["peer_faces"][peer] = resp
+
+
 def scaleDownNR(name, attrs):
     print("[", str(datetime.datetime.now()), "] [ scaleDownNR ] pass")
     pass
@@ -535,6 +690,7 @@ def createNode(request: Request):
                            **copy.deepcopy(node_default_attrs), **copy.deepcopy(specific_node_default_attrs[j["type"]]))
             if j["type"] == "NR":
                 resp = yield modules_socket.editConfig(name, {"manager_address": "172.19.0.1", "manager_port": 9999})
+                addKeysToSV(name)
             if j["type"] == "SV":
                 addKeysToSV(name)
                 return name + " test"
@@ -563,6 +719,23 @@ def sendNodeInfo(request: Request, name):
         return
 
 
+# the bytes held by the tables and the faces of the module, by part, see MemoryStats
+@app.route("/api/nodes/<name>/memory", methods=["GET"])
+@defer.inlineCallbacks
+def sendNodeMemory(request: Request, name):
+    if graph.has_node(name):
+        resp = yield modules_socket.memoryStats(name)
+        if resp:
+            request.setHeader(b"Content-Type", b"application/json")
+            return json.dumps(resp, default=jsonSerial)
+        else:
+            request.setResponseCode(204)
+            return
+    else:
+        request.setResponseCode(404)
+        return
+
+
 @app.route("/api/nodes/<name>", methods=["DELETE"])
 @defer.inlineCallbacks
 def removeNode(request: Request, name):
@@ -602,6 +775,11 @@ def nodeReport(request: Request, name):
             d["manager_port"] = int(j["manager_port"])
         if j.get("report_each", None):
             d["report_each"] = int(j["report_each"])
+        if "report_delta" in j:
+            d["report_delta"] = bool(j["report_delta"])
+        for alarm in ["hit_ratio_alarm", "drop_rate_alarm", "queue_alarm"]:
+            if j.get(alarm, None) is not None:
+                d[alarm] = int(j[alarm])
         if j.get("strategy", None):
             d["strategy"] = j["strategy"]
         resp = yield modules_socket.editConfig(name, d)
@@ -703,17 +881,84 @@ def removeKey(request : Request):
     else:
         return "0"
 
+# binary management protocol -------------------------------------------------------------------------------------------
+# spoken with the modules which understand it for the bulk commands, see modules/common/management/management_tlv.h
+BINARY_MANAGEMENT_TYPES = {"FW", "NR"}
+# the modules which hand their state to a new clone, see modules/common/network/state_transfer.h
+STATE_TRANSFER_TYPES = {"CS", "NR"}
+STATE_TRANSFER_PORT = 6370
+# a batch stays under what a module reads at once
+MAX_BATCH_SIZE = 60000
+TLV_NAME, TLV_GENERIC_NAME_COMPONENT = 7, 8
+TLV_BATCH, TLV_COMMAND, TLV_COMMAND_ID, TLV_ACTION, TLV_FACE_ID, TLV_COST, TLV_WEIGHT = 200, 201, 202, 203, 204, 205, 206
+TLV_REPLY_BATCH, TLV_REPLY, TLV_STATUS, TLV_REASON, TLV_CHUNK_INDEX, TLV_CHUNK_COUNT, TLV_PAYLOAD = 210, 211, 212, 213, 214, 215, 216
+BINARY_ACTIONS = {"add_route": 1, "del_route": 2, "list": 3}
+BINARY_ACTION_NAMES = {code: action for action, code in BINARY_ACTIONS.items()}
+
+
+def tlvVarNumber(number: int) -> bytes:
+    if number < 253:
+        return bytes([number])
+    if number <= 0xffff:
+        return b"\xfd" + number.to_bytes(2, "big")
+    if number <= 0xffffffff:
+        return b"\xfe" + number.to_bytes(4, "big")
+    return b"\xff" + number.to_bytes(8, "big")
+
+
+def tlvEncode(type: int, value: bytes) -> bytes:
+    return tlvVarNumber(type) + tlvVarNumber(len(value)) + value
+
+
+def tlvNonNegativeInteger(type: int, number: int) -> bytes:
+    length = 1 if number <= 0xff else 2 if number <= 0xffff else 4 if number <= 0xffffffff else 8
+    return tlvEncode(type, number.to_bytes(length, "big"))
+
+
+# generic components only, as the modules get them from the URIs of the JSON commands
+def tlvName(uri: str) -> bytes:
+    components = [urllib.parse.unquote_to_bytes(component) for component in uri.split("/") if component]
+    return tlvEncode(TLV_NAME, b"".join(tlvEncode(TLV_GENERIC_NAME_COMPONENT, component) for component in components))
+
+
+def tlvReadVarNumber(data: bytes, offset: int) -> (int, int):
+    first = data[offset]
+    if first < 253:
+        return first, offset + 1
+    length = {253: 2, 254: 4, 255: 8}[first]
+    return int.from_bytes(data[offset + 1:offset + 1 + length], "big"), offset + 1 + length
+
+
+# the (type, value) of the elements in data, raises IndexError or ValueError on a truncated one
+def tlvDecode(data: bytes) -> list:
+    elements = []
+    offset = 0
+    while offset < len(data):
+        type, offset = tlvReadVarNumber(data, offset)
+        length, offset = tlvReadVarNumber(data, offset)
+        if offset + length > len(data):
+            raise ValueError("TLV length exceeds datagram size")
+        elements.append((type, data[offset:offset + length]))
+        offset += length
+    return elements
+
+
 # modules socket -------------------------------------------------------------------------------------------------------
 class ModulesSocket(DatagramProtocol):
     def __init__(self):
         self.routes = {"report": self.handleReport, "request": self.handleRequest, "reply": self.handleReply}
-        self.report_routes = {"producer_disconnection": self.handleProducerDisconnectionReport, "cache_status": self.handleCacheStatusReport, "invalid_signature": self.handleInvalidSignatureReport}
-        self.request_routes = {"route_registration": self.handlePrefixRegistrationRequest}
-        self.reply_results = {"add_face": "face_id", "del_face": "status", "edit_config": "changes", "add_route": "status", "del_route": "status", "add_keys": "status", "del_keys": "status"}
+        self.report_routes = {"producer_disconnection": self.handleProducerDisconnectionReport, "cache_status": self.handleCacheStatusReport, "pit_status": self.handlePitStatusReport, "invalid_signature": self.handleInvalidSignatureReport, "routes_registered": self.handleRoutesRegisteredReport, "forwarding_status": self.handleForwardingStatusReport}
+        self.request_routes = {"route_registration": self.handlePrefixRegistrationRequest, "route_registrations": self.handlePrefixRegistrationsRequest}
+        self.reply_results = {"add_face": "face_id", "del_face": "status", "edit_config": "changes", "add_route": "status", "del_route": "status", "add_keys": "status", "del_keys": "status", "add_trust_rules": "status", "del_trust_rules": "status", "export_state": "status", "import_state": "status", "memory_stats": "memory"}
         self.request_counter = 1
         self.pending_requests = {}
+        # the chunks received of the binary replies cut in several, by id
+        self.reply_chunks = {}
 
     def datagramReceived(self, data, addr):
+        if data and data[0] == TLV_REPLY_BATCH:
+            self.handleReplyBatch(data, addr)
+            return
         try:
             j = json.loads(data.decode())
             self.routes.get(j.get("type", None), self.unknown)(j, addr)
@@ -737,16 +982,27 @@ class ModulesSocket(DatagramProtocol):
     def handleCacheStatusReport(self, j: dict, addr):
         if all(field in j for field in ["hit_count", "miss_count"]) and graph.has_node(j["name"]):
             cache_stats = graph.nodes[j["name"]]["cache_stats"]
-            hit_delta = j["hit_count"] - cache_stats["hit_count"]
-            miss_delta = j["miss_count"] - cache_stats["miss_count"]
+            # a delta report only carries the increases since the previous one and what changed
+            if j.get("delta", False):
+                hit_delta = j["hit_count"]
+                miss_delta = j["miss_count"]
+            else:
+                hit_delta = j["hit_count"] - cache_stats["hit_count"]
+                miss_delta = j["miss_count"] - cache_stats["miss_count"]
             old_ratio = cache_stats["cache_hit"]
             cache_stats["cache_hit"] = round(100 * hit_delta / (hit_delta + miss_delta), 1) if hit_delta + miss_delta > 0 else 0.0
-            cache_stats["hit_count"] = j["hit_count"]
-            cache_stats["miss_count"] = j["miss_count"]
+            cache_stats["hit_count"] += hit_delta
+            cache_stats["miss_count"] += miss_delta
+            cache_stats["used_bytes"] = j.get("used_bytes", cache_stats["used_bytes"])
+            cache_stats["prefixes"] = j.get("prefixes", cache_stats["prefixes"])
             cache_stats["last_update"] = time.time()
-            print("[", str(datetime.datetime.now()), "] [ handleCacheStatusReport ]", j["name"], "-> cache hit:", cache_stats["cache_hit"])
+            updateStageStats(j["name"], j)
+            # sent as soon as the CS sees the threshold crossed, rather than at the next report
+            hit_ratio_alarm = any(alarm.get("alarm") == "hit_ratio" and alarm.get("raised", False) for alarm in j.get("alarms", []))
+            print("[", str(datetime.datetime.now()), "] [ handleCacheStatusReport ]", j["name"], "-> cache hit:", cache_stats["cache_hit"],
+                  "alarms:", j["alarms"] if "alarms" in j else "none")
             try:
-                if cache_stats["cache_hit"] < 0.8 * old_ratio:
+                if hit_ratio_alarm or cache_stats["cache_hit"] < 0.8 * old_ratio:
                     name = j["name"] + ".SV1"
                     if not graph.has_node(name) and createContainer(name, "SV"):
                         graph.add_node(name,  editable=False, scalable=False, addresses=getContainerIPAddresses(name),
@@ -759,12 +1015,45 @@ class ModulesSocket(DatagramProtocol):
             except Exception as e:
                 print(e)
 
+    def handlePitStatusReport(self, j: dict, addr):
+        if all(field in j for field in ["entries", "rejected_count", "evicted_count"]) and graph.has_node(j["name"]):
+            pit_stats = graph.nodes[j["name"]]["pit_stats"]
+            pit_stats["rejected"] = j["rejected_count"] - pit_stats["rejected_count"]
+            pit_stats["evicted"] = j["evicted_count"] - pit_stats["evicted_count"]
+            pit_stats["entries"] = j["entries"]
+            pit_stats["used_bytes"] = j.get("used_bytes", 0)
+            pit_stats["rejected_count"] = j["rejected_count"]
+            pit_stats["evicted_count"] = j["evicted_count"]
+            pit_stats["faces"] = j.get("faces", [])
+            pit_stats["rtt"] = j.get("rtt", {})
+            pit_stats["last_update"] = time.time()
+            updateStageStats(j["name"], j)
+            print("[", str(datetime.datetime.now()), "] [ handlePitStatusReport ]", j["name"], "-> entries:", pit_stats["entries"],
+                  "rejected:", pit_stats["rejected"], "evicted:", pit_stats["evicted"])
+
+    def handleForwardingStatusReport(self, j: dict, addr):
+        if all(field in j for field in ["forwarding"]) and graph.has_node(j["name"]):
+            forwarding_stats = graph.nodes[j["name"]]["forwarding_stats"]
+            forwarding = j["forwarding"]
+            forwarding_stats["interests_per_second"] = forwarding.get("interests_per_second", 0.0)
+            forwarding_stats["fan_out"] = forwarding.get("fan_out", 0.0)
+            forwarding_stats["lookup_ns"] = forwarding.get("lookup_ns", {})
+            forwarding_stats["prefixes"] = forwarding.get("prefixes", [])
+            forwarding_stats["registration_queue"] = j.get("queued_registrations", 0) + j.get("pending_requests", 0)
+            forwarding_stats["last_update"] = time.time()
+            updateStageStats(j["name"], j)
+            print("[", str(datetime.datetime.now()), "] [ handleForwardingStatusReport ]", j["name"], "-> interests/s:",
+                  round(forwarding_stats["interests_per_second"], 1), "fan-out:", round(forwarding_stats["fan_out"], 2),
+                  "registration queue:", forwarding_stats["registration_queue"])
+
     def handleInvalidSignatureReport(self, j: dict, addr):
         print("[", str(datetime.datetime.now()), "] [ handleInvalidSignatureReport ]", json.dumps(j))
         if all(field in j for field in ["invalid_signature_names"]) and graph.has_node(j["name"]):
             packet_stats = graph.nodes[j["name"]]["packet_stats"]
-            packet_stats["fake_count"] += len(j["invalid_signature_names"])
+            # the names are only the most seen ones, the count covers them all
+            packet_stats["fake_count"] += j.get("invalid_count", len(j["invalid_signature_names"]))
             packet_stats["last_update"] = time.time()
+            updateStageStats(j["name"], j)
 
     def handleRequest(self, j: dict, addr):
         if all(field in j for field in ["name", "action"]):
@@ -784,6 +1073,42 @@ class ModulesSocket(DatagramProtocol):
                 routes[j["face_id"]] = face_routes
                 propagateNewRoutes(j["name"], [j["prefix"]])
 
+    # a batch of registrations, answered in a single reply and propagated together
+    def handlePrefixRegistrationsRequest(self, j: dict, addr):
+        if "registrations" in j and graph.has_node(j["name"]):
+            results = []
+            routes = graph.nodes[j["name"]]["static_routes"]
+            new_prefixes = []
+            for registration in j["registrations"]:
+                if not all(field in registration for field in ["id", "face_id", "prefix", "key_name", "message", "signature"]):
+                    continue
+                result = verifySignature(base64.b64decode(registration["message"]), base64.b64decode(registration["signature"]), registration["key_name"])
+                results.append({"id": registration["id"], "result": result})
+                if result:
+                    face_routes = routes.get(registration["face_id"], set())
+                    face_routes.add(registration["prefix"])
+                    routes[registration["face_id"]] = face_routes
+                    new_prefixes.append(registration["prefix"])
+            print("[", str(datetime.datetime.now()), "] [ handlePrefixRegistrations ]", len(new_prefixes), "of", len(results), "routes accepted via", j["name"])
+            self.sendDatagram({"action": "reply", "id": 0, "results": results}, addr[0], addr[1])
+            if new_prefixes:
+                propagateNewRoutes(j["name"], new_prefixes)
+
+    # registrations the NR checked itself with the keys pushed to it
+    def handleRoutesRegisteredReport(self, j: dict, addr):
+        if "routes" in j and graph.has_node(j["name"]):
+            routes = graph.nodes[j["name"]]["static_routes"]
+            new_prefixes = []
+            for route in j["routes"]:
+                if all(field in route for field in ["face_id", "prefix"]):
+                    face_routes = routes.get(route["face_id"], set())
+                    face_routes.add(route["prefix"])
+                    routes[route["face_id"]] = face_routes
+                    new_prefixes.append(route["prefix"])
+            print("[", str(datetime.datetime.now()), "] [ handleRoutesRegistered ]", len(new_prefixes), "routes via", j["name"])
+            if new_prefixes:
+                propagateNewRoutes(j["name"], new_prefixes)
+
     def handleReply(self, j: dict, addr):
         print("[", str(datetime.datetime.now()), "] [ handleReply ]", json.dumps(j))
         deferred = self.pending_requests.get(j.get("id", 0), None)
@@ -792,35 +1117,101 @@ class ModulesSocket(DatagramProtocol):
         else:
             print("[", str(datetime.datetime.now()), "]", self.pending_request)
 
+    def handleReplyBatch(self, data: bytes, addr):
+        try:
+            replies = [value for type, value in tlvDecode(tlvDecode(data)[0][1]) if type == TLV_REPLY]
+        except (IndexError, ValueError) as e:
+            print("[", str(datetime.datetime.now()), "]", "Decoding reply batch has failed:", e)
+            return
+        for reply in replies:
+            fields = {}
+            for type, value in tlvDecode(reply):
+                fields[type] = value if type in (TLV_REASON, TLV_PAYLOAD) else int.from_bytes(value, "big")
+            id = fields.get(TLV_COMMAND_ID, 0)
+            action = BINARY_ACTION_NAMES.get(fields.get(TLV_ACTION, 0), "unknown")
+            deferred = self.pending_requests.get(id, None)
+            if TLV_PAYLOAD in fields:
+                # the JSON reply, once all its chunks are there
+                chunks = self.reply_chunks.setdefault(id, [None] * fields.get(TLV_CHUNK_COUNT, 1))
+                if fields.get(TLV_CHUNK_INDEX, 0) < len(chunks):
+                    chunks[fields.get(TLV_CHUNK_INDEX, 0)] = fields[TLV_PAYLOAD]
+                if None in chunks:
+                    continue
+                self.reply_chunks.pop(id, None)
+                result = json.loads(b"".join(chunks).decode())
+            else:
+                result = "success" if fields.get(TLV_STATUS, 1) == 0 else "fail"
+                if result == "fail":
+                    print("[", str(datetime.datetime.now()), "] [ handleReplyBatch ]", action, id, "failed:", fields.get(TLV_REASON, b"").decode())
+            if deferred:
+                deferred.callback(result)
+
     def editConfig(self, source, data: dict):
         source_addrs = graph.nodes[source]["addresses"]
         d = {"action": "edit_config", "id": self.request_counter}
         d.update(data)
         return self.sendDatagram(d, source_addrs["command"], 10000)
 
-    def addFace(self, source, target, producer=False):
+    def addFace(self, source, target, producer=False, peer=False, push=False):
         source_addrs = graph.nodes[source]["addresses"]
         target_addrs = graph.nodes[target]["addresses"]
         is_NR = graph.nodes[target]["type"] == "NR"
         d = {"action": "add_face", "id": self.request_counter, "layer": "tcp", "address": target_addrs["data"], "port": 6362 if is_NR and not producer else 6363}
+        if peer:
+            d["peer"] = True
+        if push:
+            d["push"] = True
         return self.sendDatagram(d, source_addrs["command"], 10000)
 
     def delFace(self, source, target):
+        return self.delFaceById(source, graph.edges[source, target]["face_id"])
+
+    # for the faces which aren't edges of the graph, e.g. between the clones of a CS
+    def delFaceById(self, source, face_id):
         source_addrs = graph.nodes[source]["addresses"]
-        face_id = graph.edges[source, target]["face_id"]
         d = {"action": "del_face", "id": self.request_counter, "face_id": face_id}
         return self.sendDatagram(d, source_addrs["command"], 10000)
 
     def addRoutes(self, name, face_id, prefixes: (list, set)):
         source_addrs = graph.nodes[name]["addresses"]
+        if graph.nodes[name]["type"] in BINARY_MANAGEMENT_TYPES:
+            return self.sendRoutes(name, "add_route", face_id, prefixes)
         d = {"action": "add_route", "id": self.request_counter, "face_id": face_id, "prefixes": prefixes}
         return self.sendDatagram(d, source_addrs["command"], 10000)
 
     def delRoutes(self, name, face_id, prefix: list):
         source_addrs = graph.nodes[name]["addresses"]
+        if graph.nodes[name]["type"] in BINARY_MANAGEMENT_TYPES:
+            return self.sendRoutes(name, "del_route", face_id, prefix)
         d = {"action": "del_route", "id": self.request_counter, "face_id": face_id, "prefixes": prefix}
         return self.sendDatagram(d, source_addrs["command"], 10000)
 
+    # the prefixes in as many commands as needed, each in a batch of its own and all of them sent at once. fires with
+    # "success" once every command succeeded, "fail" otherwise
+    def sendRoutes(self, name, action: str, face_id, prefixes: (list, set)):
+        source_addrs = graph.nodes[name]["addresses"]
+        names = [tlvName(prefix) for prefix in prefixes]
+        deferreds = []
+        start = 0
+        while start < len(names) or not deferreds:
+            end, size = start, 0
+            while end < len(names) and (end == start or size + len(names[end]) < MAX_BATCH_SIZE - 64):
+                size += len(names[end])
+                end += 1
+            command = tlvNonNegativeInteger(TLV_COMMAND_ID, self.request_counter) + tlvNonNegativeInteger(TLV_ACTION, BINARY_ACTIONS[action]) \
+                + tlvNonNegativeInteger(TLV_FACE_ID, face_id) + b"".join(names[start:end])
+            deferreds.append(self.sendBatch(tlvEncode(TLV_BATCH, tlvEncode(TLV_COMMAND, command)), source_addrs["command"], 10000))
+            start = end
+        d = defer.gatherResults(deferreds)
+        d.addCallback(lambda results: "success" if all(result == "success" for result in results) else "fail")
+        return d
+
+    # the whole list, where the JSON one is cut at a datagram
+    def binaryList(self, name):
+        source_addrs = graph.nodes[name]["addresses"]
+        command = tlvNonNegativeInteger(TLV_COMMAND_ID, self.request_counter) + tlvNonNegativeInteger(TLV_ACTION, BINARY_ACTIONS["list"])
+        return self.sendBatch(tlvEncode(TLV_BATCH, tlvEncode(TLV_COMMAND, command)), source_addrs["command"], 10000)
+
     def addKeys(self, name, keys: (list, set)):
         source_addrs = graph.nodes[name]["addresses"]
         d = {"action": "add_keys", "id": self.request_counter, "keys": keys}
@@ -831,11 +1222,36 @@ class ModulesSocket(DatagramProtocol):
         d = {"action": "del_keys", "id": self.request_counter, "keys": keys}
         return self.sendDatagram(d, source_addrs["command"], 10000)
 
+    def addTrustRules(self, name, rules: (list, set)):
+        source_addrs = graph.nodes[name]["addresses"]
+        d = {"action": "add_trust_rules", "id": self.request_counter, "rules": rules}
+        return self.sendDatagram(d, source_addrs["command"], 10000)
+
+    def delTrustRules(self, name, rules: (list, set)):
+        source_addrs = graph.nodes[name]["addresses"]
+        d = {"action": "del_trust_rules", "id": self.request_counter, "rules": rules}
+        return self.sendDatagram(d, source_addrs["command"], 10000)
+
+    def importState(self, name):
+        source_addrs = graph.nodes[name]["addresses"]
+        d = {"action": "import_state", "id": self.request_counter, "port": STATE_TRANSFER_PORT}
+        return self.sendDatagram(d, source_addrs["command"], 10000)
+
+    def exportState(self, name, clone_name):
+        source_addrs = graph.nodes[name]["addresses"]
+        d = {"action": "export_state", "id": self.request_counter, "address": graph.nodes[clone_name]["addresses"]["data"], "port": STATE_TRANSFER_PORT}
+        return self.sendDatagram(d, source_addrs["command"], 10000)
+
     def list(self, name):
         source_addrs = graph.nodes[name]["addresses"]
         d = {"action": "list", "id": self.request_counter}
         return self.sendDatagram(d, source_addrs["command"], 10000)
 
+    def memoryStats(self, name):
+        source_addrs = graph.nodes[name]["addresses"]
+        d = {"action": "memory_stats", "id": self.request_counter}
+        return self.sendDatagram(d, source_addrs["command"], 10000)
+
     def sendDatagram(self, data: dict, ip, port):
         # print("[", str(datetime.datetime.now()), "]", "send", data, "to", ip, port)
         # deferred to fire when the corresponding reply is received
@@ -847,6 +1263,21 @@ class ModulesSocket(DatagramProtocol):
         self.transport.write(json.dumps(data, default=jsonSerial).encode(), (ip, port))
         return d
 
+    # a batch of a single command, whose id is the current request_counter
+    def sendBatch(self, batch: bytes, ip, port):
+        d = defer.Deferred()
+        d.addTimeout(5, reactor, onTimeoutCancel=self.onTimeout)
+        d.addBoth(self.removeRequest, self.request_counter)
+        d.addBoth(self.removeChunks, self.request_counter)
+        self.pending_requests[self.request_counter] = d
+        self.request_counter += 1
+        self.transport.write(batch, (ip, port))
+        return d
+
+    def removeChunks(self, value, key):
+        self.reply_chunks.pop(key, None)
+        return value
+
     def onTimeout(self, result, timeout):
         #print("[", str(datetime.datetime.now()), "]", result, timeout)
         return None
@@ -933,7 +1364,8 @@ def removeContainer(name) -> bool:
     print("[", str(datetime.datetime.now()), "] [ removeContainer ] removing", name)
     try:
         container = docker_client.containers.get(name)
-        container.stop(timeout=3)
+        # SIGTERM lets the module drain for 2s (-g) and a content store save its snapshot before it is killed
+        container.stop(timeout=5)
         container.remove()
         return True
     except (docker.errors.NotFound, docker.errors.APIError):
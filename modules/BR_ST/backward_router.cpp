@@ -1,81 +1,209 @@
 #include "backward_router.h"
 
 #include <boost/bind.hpp>
+#include <boost/container/small_vector.hpp>
+
+#include <algorithm>
 
 #include "network/tcp_master_face.h"
 #include "network/udp_master_face.h"
 #include "network/tcp_face.h"
 #include "network/udp_face.h"
+#include "network/shm_master_face.h"
+#include "network/shm_face.h"
+#include "network/page_arena.h"
 #include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+#include "metrics/stage_profile.h"
 
-BackwardRouter::BackwardRouter(const std::string &name, size_t max_size, uint16_t local_port, uint16_t local_command_port)
+BackwardRouter::BackwardRouter(const std::string &name, size_t max_size, uint16_t local_port, uint16_t local_command_port, size_t udp_shards,
+                               size_t shards, size_t shard_prefix_length)
         : Module(1)
         , _name(name)
-        , _pit(max_size)
-        , _command_socket(_ios, {{}, local_command_port}) {
-    _tcp_ingress_master_face = std::make_shared<TcpMasterFace>(_ios, 16, local_port);
-    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, 16, local_port);
+        , _shard_prefix_length(shard_prefix_length)
+        , _size(max_size)
+        , _memory_budget(_ios)
+        , _command_socket(_control_ios, {{}, local_command_port})
+        , _connection_pool(_ios)
+        , _report_timer(_ios)
+        , _delay_between_report(0) {
+    shards = std::max<size_t>(shards, 1);
+    for (size_t i = 0; i < shards; ++i) {
+        _shards.emplace_back(new PitShard(_ios, shards > 1, max_size / shards + (i < max_size % shards), shard_prefix_length));
+    }
+    _tcp_ingress_master_face = std::make_shared<TcpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port, udp_shards);
+    _shm_ingress_master_face = std::make_shared<ShmMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _metrics.addCollector(boost::bind(&BackwardRouter::writeMetrics, this, _1));
 }
 
 void BackwardRouter::run() {
+    // before the ingress accepts any face, the commands are then read as usual
+    _startup_config.apply(_ios, _remote_command_endpoint, [this](const rapidjson::Document &command) {
+        executeCommand(command);
+    });
     commandRead();
+    for (auto &shard : _shards) {
+        shard->start();
+    }
     _tcp_ingress_master_face->listen(boost::bind(&BackwardRouter::onMasterFaceNotification, this, _1, _2),
-                               boost::bind(&BackwardRouter::onIngressInterest, this, _1, _2),
-                               boost::bind(&BackwardRouter::onIngressData, this, _1, _2),
+                               Face::BurstCallback(boost::bind(&BackwardRouter::onIngressBurst, this, _1, _2)),
                                boost::bind(&BackwardRouter::onMasterFaceError, this, _1, _2));
     _udp_ingress_master_face->listen(boost::bind(&BackwardRouter::onMasterFaceNotification, this, _1, _2),
-                               boost::bind(&BackwardRouter::onIngressInterest, this, _1, _2),
-                               boost::bind(&BackwardRouter::onIngressData, this, _1, _2),
+                               Face::BurstCallback(boost::bind(&BackwardRouter::onIngressBurst, this, _1, _2)),
                                boost::bind(&BackwardRouter::onMasterFaceError, this, _1, _2));
+    _shm_ingress_master_face->listen(boost::bind(&BackwardRouter::onMasterFaceNotification, this, _1, _2),
+                               Face::BurstCallback(boost::bind(&BackwardRouter::onIngressBurst, this, _1, _2)),
+                               boost::bind(&BackwardRouter::onMasterFaceError, this, _1, _2));
+}
+
+void BackwardRouter::beginDrain() {
+    _tcp_ingress_master_face->stopAccepting();
+    _udp_ingress_master_face->stopAccepting();
+    _shm_ingress_master_face->stopAccepting();
 }
 
-void BackwardRouter::onIngressInterest(const std::shared_ptr<Face> &ingress_face, const ndn::Interest &interest) {
-    if (_pit.insert(interest, ingress_face)) {
-        for (const auto& egress_face : _egress_faces) {
-            egress_face->send(interest);
+bool BackwardRouter::isDrained() {
+    size_t queued = _tcp_ingress_master_face->getQueuedPackets() + _udp_ingress_master_face->getQueuedPackets()
+                    + _shm_ingress_master_face->getQueuedPackets();
+    for (const auto &face : _egress_faces) {
+        queued += face->getQueueStats().packets;
+    }
+    if (queued > 0) {
+        return false;
+    }
+    for (auto &shard : _shards) {
+        if (shard->call([](Pit &pit) { return pit.getEntries(); }) > 0) {
+            return false;
         }
     }
+    return true;
+}
+
+size_t BackwardRouter::getShardIndex(const NameView &name, size_t length) const {
+    return _shards.size() == 1 ? 0 : name.getPrefixHash(std::min(length, _shard_prefix_length)) % _shards.size();
+}
+
+void BackwardRouter::updateEgressFaces() {
+    for (auto &shard : _shards) {
+        shard->setEgressFaces(_egress_faces);
+    }
+}
+
+void BackwardRouter::onIngressPacket(const std::shared_ptr<Face> &ingress_face, const NdnPacket &packet) {
+    // Interests are decoded by their shard, Data are dropped unless pushed off-path from a trusted face
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST:
+            _shards[getShardIndex(packet.getNameView(), packet.getNameView().size())]->submit(ingress_face, packet);
+            break;
+        case NdnPacket::DATA:
+            if (isTrusted(*ingress_face)) {
+                ++_unsolicited;
+                push(packet);
+            } else {
+                ++_untrusted;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void BackwardRouter::onIngressBurst(const std::shared_ptr<Face> &ingress_face, const std::vector<NdnPacket> &packets) {
+    bool only_interests = std::all_of(packets.begin(), packets.end(), [](const NdnPacket &packet) {
+        return packet.getType() == NdnPacket::INTEREST;
+    });
+    if (_shards.size() == 1 && only_interests) {
+        _shards.front()->submit(ingress_face, packets);
+        return;
+    }
+    for (const auto &packet : packets) {
+        onIngressPacket(ingress_face, packet);
+    }
+}
+
+bool BackwardRouter::isTrusted(const Face &face) const {
+    if (_trusted_addresses.empty()) {
+        return false;
+    }
+    std::string endpoint = face.getUnderlyingEndpoint();
+    return _trusted_addresses.count(endpoint.substr(0, endpoint.rfind(':'))) > 0;
 }
 
-void BackwardRouter::onIngressData(const std::shared_ptr<Face> &ingress_face, const ndn::Data &data) {
-    // drop
+void BackwardRouter::push(const NdnPacket &packet) {
+    if (_push_faces.empty()) {
+        return;
+    }
+    if (!_push_limiter.take()) {
+        ++_push_dropped;
+        return;
+    }
+    for (const auto &push_face : _push_faces) {
+        push_face->send(packet);
+    }
+    ++_pushed;
 }
 
-void BackwardRouter::onEgressInterest(const std::shared_ptr<Face> &egress_face, const ndn::Interest &interest) {
-    // drop
+void BackwardRouter::onPushPacket(const std::shared_ptr<Face> &push_face, const NdnPacket &packet) {
+
 }
 
-void BackwardRouter::onEgressData(const std::shared_ptr<Face> &egress_face, const ndn::Data &data) {
-    auto&& ingress_faces = _pit.get(data);
-    for (const auto& ingress_face : ingress_faces) {
-        ingress_face->send(data);
+void BackwardRouter::onEgressPacket(const std::shared_ptr<Face> &egress_face, NdnPacket &&packet) {
+    // Interests are dropped, Data are matched against the PIT by their Name spans and sent as received
+    if (packet.getType() != NdnPacket::DATA) {
+        return;
+    }
+    if (_off_path) {
+        push(packet);
+    }
+    const NameView &name = packet.getNameView();
+    size_t shard = getShardIndex(name, name.size());
+    // the CanBePrefix entries shorter than the sharding prefix are in the shards of the prefixes of the Data Name,
+    // a face waiting on several of them may get the Data more than once. they get copies, the shard of the Name the
+    // packet itself
+    boost::container::small_vector<size_t, 4> visited;
+    visited.emplace_back(shard);
+    for (size_t length = 0; length < std::min(name.size(), _shard_prefix_length) && _shards.size() > 1; ++length) {
+        size_t other = getShardIndex(name, length);
+        if (std::find(visited.begin(), visited.end(), other) == visited.end() && _shards[other]->getShortPrefixEntries() > 0) {
+            _shards[other]->submit(egress_face, packet);
+            visited.emplace_back(other);
+        }
     }
+    _shards[shard]->submit(egress_face, std::move(packet));
 }
 
 void BackwardRouter::onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "new " << " face with ID = " << face->getFaceId() << " from master face with ID = " << master_face->getMasterFaceId();
-    logger::log(logger::INFO, ss.str());
+    logger::log(logger::INFO, "new face with ID = {} from master face with ID = {}",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void BackwardRouter::onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "face with ID = " << face->getFaceId() << " from master face with ID = " << master_face->getMasterFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
-
+    logger::log(logger::ERROR, "face with ID = {} from master face with ID = {} can't process normally",
+                {face->getFaceId(), master_face->getMasterFaceId()});
+    // the entries only this consumer was waiting for leave at once
+    for (auto &shard : _shards) {
+        shard->call([&face](Pit &pit) {
+            return pit.removeFace(face);
+        });
+    }
 }
 
 void BackwardRouter::onFaceError(const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "face with ID = " << face->getFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    logger::log(logger::ERROR, "face with ID = {} can't process normally", {face->getFaceId()});
     for (auto& egress_face : _egress_faces) {
         if(egress_face == face) {
             std::swap(egress_face, _egress_faces.back());
             _egress_faces.pop_back();
+            updateEgressFaces();
             break;
         }
     }
+    auto it = std::find(_push_faces.begin(), _push_faces.end(), face);
+    if (it != _push_faces.end()) {
+        _push_faces.erase(it);
+    }
 }
 
 void BackwardRouter::commandRead() {
@@ -84,38 +212,18 @@ void BackwardRouter::commandRead() {
 }
 
 void BackwardRouter::commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred) {
-    enum action_type {
-        EDIT_CONFIG,
-        ADD_FACE,
-        DEL_FACE,
-    };
-
-    static const std::unordered_map<std::string, action_type> ACTIONS = {
-            {"edit_config", EDIT_CONFIG},
-            {"add_face", ADD_FACE},
-            {"del_face", DEL_FACE},
-    };
-
     if(!err) {
         try {
             rapidjson::Document document;
             document.Parse(_command_buffer, bytes_transferred);
             if(!document.HasParseError()){
                 if(document.HasMember("action") && document["action"].IsString() && document.HasMember("id") && document["id"].IsUint()){
-                    auto it = ACTIONS.find(document["action"].GetString());
-                    if(it != ACTIONS.end()) {
-                        switch (it->second) {
-                            case EDIT_CONFIG:
-                                commandEditConfig(document);
-                                break;
-                            case ADD_FACE:
-                                commandAddFace(document);
-                                break;
-                            case DEL_FACE:
-                                commandDelFace(document);
-                                break;
-                        }
-                    }
+                    // applied on the module thread, the next command is read once it is done
+                    auto command = std::make_shared<rapidjson::Document>(std::move(document));
+                    applyCommand([this, command]() {
+                        executeCommand(*command);
+                    }, boost::bind(&BackwardRouter::commandRead, this));
+                    return;
                 } else{
                     //std::string response = R"({"status":"fail", "reason":"action not provided or not implemented"})";
                     //_command_socket.send_to(boost::asio::buffer(response), _remote_command_endpoint);
@@ -134,13 +242,90 @@ void BackwardRouter::commandReadHandler(const boost::system::error_code &err, si
     }
 }
 
+void BackwardRouter::executeCommand(const rapidjson::Document &document) {
+    enum action_type {
+        EDIT_CONFIG,
+        ADD_FACE,
+        DEL_FACE,
+        LIST,
+        MEMORY_STATS,
+    };
+
+    static const std::unordered_map<std::string, action_type> ACTIONS = {
+            {"edit_config", EDIT_CONFIG},
+            {"add_face", ADD_FACE},
+            {"del_face", DEL_FACE},
+            {"list", LIST},
+            {"memory_stats", MEMORY_STATS},
+    };
+
+    auto it = ACTIONS.find(document["action"].GetString());
+    if (it == ACTIONS.end()) {
+        return;
+    }
+    switch (it->second) {
+        case EDIT_CONFIG:
+            commandEditConfig(document);
+            break;
+        case ADD_FACE:
+            commandAddFace(document);
+            break;
+        case DEL_FACE:
+            commandDelFace(document);
+            break;
+        case LIST:
+            commandList(document);
+            break;
+        case MEMORY_STATS:
+            commandMemoryStats(document);
+            break;
+    }
+}
+
+bool BackwardRouter::loadStartupConfig(const std::string &source) {
+    return _startup_config.load(source);
+}
+
+bool BackwardRouter::enableMemoryBudget(size_t percent) {
+    return _memory_budget.start(percent, boost::bind(&BackwardRouter::onMemoryBudget, this, _1));
+}
+
+void BackwardRouter::setSize(size_t size) {
+    _size = size;
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        size_t shard_size = size / _shards.size() + (i < size % _shards.size());
+        _shards[i]->call([shard_size](Pit &pit) {
+            pit.setSize(shard_size);
+        });
+    }
+}
+
+void BackwardRouter::setMaxBytes(size_t max_bytes) {
+    _max_bytes = max_bytes;
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        size_t shard_max_bytes = max_bytes / _shards.size() + (i < max_bytes % _shards.size());
+        _shards[i]->call([shard_max_bytes](Pit &pit) {
+            pit.setMaxBytes(shard_max_bytes);
+        });
+    }
+}
+
+void BackwardRouter::onMemoryBudget(size_t budget) {
+    setMaxBytes(budget);
+    size_t size = budget / (sizeof(PitEntry) + PitEntry::OVERHEAD);
+    if (size > _size) {
+        setSize(size);
+    }
+    logger::log(logger::INFO, "PIT budget of {} bytes, {} entries at most", {budget, _size});
+}
+
 void BackwardRouter::commandEditConfig(const rapidjson::Document &document) {
     std::vector<std::string> changes;
     if (document.HasMember("size") && document["size"].IsUint()) {
         bool has_change = false;
         size_t new_size = document["size"].GetUint();
-        if (new_size != _pit.getSize()) {
-            _pit.setSize(new_size);
+        if (new_size != _size) {
+            setSize(new_size);
             has_change = true;
         }
         if (has_change) {
@@ -148,6 +333,456 @@ void BackwardRouter::commandEditConfig(const rapidjson::Document &document) {
         }
     }
 
+    if (document.HasMember("max_bytes") && document["max_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["max_bytes"].GetUint();
+        if (max_bytes != _max_bytes) {
+            setMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("max_bytes");
+        }
+    }
+
+    if (document.HasMember("face_quota") && document["face_quota"].IsUint()) {
+        bool has_change = false;
+        size_t face_quota = document["face_quota"].GetUint();
+        if (face_quota != _face_quota) {
+            _face_quota = face_quota;
+            // the Names of a face are spread over the shards as well
+            for (size_t i = 0; i < _shards.size(); ++i) {
+                size_t shard_face_quota = face_quota / _shards.size() + (i < face_quota % _shards.size());
+                _shards[i]->call([shard_face_quota](Pit &pit) {
+                    pit.setFaceQuota(shard_face_quota);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("face_quota");
+        }
+    }
+
+    if (document.HasMember("eviction_batch") && document["eviction_batch"].IsUint()) {
+        bool has_change = false;
+        size_t batch = std::max<size_t>(document["eviction_batch"].GetUint(), 1);
+        if (batch != _eviction_batch) {
+            _eviction_batch = batch;
+            for (auto &shard : _shards) {
+                shard->call([batch](Pit &pit) {
+                    pit.setEvictionBatch(batch);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("eviction_batch");
+        }
+    }
+
+    if (document.HasMember("off_path") && document["off_path"].IsBool()) {
+        bool has_change = false;
+        bool off_path = document["off_path"].GetBool();
+        if (off_path != _off_path) {
+            _off_path = off_path;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("off_path");
+        }
+    }
+
+    if (document.HasMember("push_rate") && document["push_rate"].IsUint()) {
+        bool has_change = false;
+        double rate = document["push_rate"].GetUint();
+        if (rate != _push_limiter.getRate()) {
+            _push_limiter.set(rate, _push_limiter.getBurst());
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("push_rate");
+        }
+    }
+
+    if (document.HasMember("push_burst") && document["push_burst"].IsUint()) {
+        bool has_change = false;
+        double burst = std::max<double>(document["push_burst"].GetUint(), 1);
+        if (burst != _push_limiter.getBurst()) {
+            _push_limiter.set(_push_limiter.getRate(), burst);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("push_burst");
+        }
+    }
+
+    if (document.HasMember("trusted_addresses") && document["trusted_addresses"].IsArray()) {
+        bool has_change = false;
+        std::set<std::string> addresses;
+        for (const auto &address : document["trusted_addresses"].GetArray()) {
+            if (address.IsString()) {
+                addresses.emplace(address.GetString());
+            }
+        }
+        if (addresses != _trusted_addresses) {
+            _trusted_addresses = std::move(addresses);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("trusted_addresses");
+        }
+    }
+
+    if (document.HasMember("rtt_prefix_length") && document["rtt_prefix_length"].IsUint()) {
+        bool has_change = false;
+        size_t length = document["rtt_prefix_length"].GetUint();
+        if (length != _shards.front()->call([](Pit &pit) { return pit.getRttStats().getPrefixLength(); })) {
+            for (auto &shard : _shards) {
+                shard->call([length](Pit &pit) {
+                    pit.setRttPrefixLength(length);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("rtt_prefix_length");
+        }
+    }
+
+    if (document.HasMember("manager_address") && document.HasMember("manager_port") && document["manager_address"].IsString() && document["manager_port"].IsUint()) {
+        bool has_change = false;
+        boost::asio::ip::udp::endpoint new_endpoint(boost::asio::ip::address::from_string(document["manager_address"].GetString()), document["manager_port"].GetUint());
+        if (new_endpoint != _manager_endpoint) {
+            _manager_endpoint = new_endpoint;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("manager_endpoint");
+        }
+    }
+
+    if (document.HasMember("report_each") && document["report_each"].IsUint()) {
+        bool has_change = false;
+        boost::posix_time::milliseconds delay_between_report(document["report_each"].GetUint());
+        if (delay_between_report != _delay_between_report) {
+            _delay_between_report = delay_between_report;
+            has_change = true;
+        }
+        if (_delay_between_report.total_milliseconds() > 0) {
+            if (!_report_enable) {
+                _report_enable = true;
+                _report_timer.expires_from_now(_delay_between_report);
+                _report_timer.async_wait(boost::bind(&BackwardRouter::commandReport, this, _1));
+            }
+        } else {
+            _report_enable = false;
+        }
+        if (has_change) {
+            changes.emplace_back("report_each");
+        }
+    }
+
+    if (document.HasMember("remove_satisfied") && document["remove_satisfied"].IsBool()) {
+        bool has_change = false;
+        bool remove_satisfied = document["remove_satisfied"].GetBool();
+        if (remove_satisfied != _shards.front()->call([](Pit &pit) { return pit.isRemovingSatisfied(); })) {
+            for (auto &shard : _shards) {
+                shard->call([remove_satisfied](Pit &pit) {
+                    pit.setRemoveSatisfied(remove_satisfied);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("remove_satisfied");
+        }
+    }
+
+    if (document.HasMember("nack") && document["nack"].IsBool()) {
+        bool has_change = false;
+        bool nack = document["nack"].GetBool();
+        if (nack != _shards.front()->call([](Pit &pit) { return pit.isNacking(); })) {
+            for (auto &shard : _shards) {
+                shard->call([nack](Pit &pit) {
+                    pit.setNacking(nack);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("nack");
+        }
+    }
+
+    if (document.HasMember("nack_rate") && document["nack_rate"].IsUint()) {
+        bool has_change = false;
+        size_t nack_rate = document["nack_rate"].GetUint();
+        if (nack_rate != _nack_rate) {
+            _nack_rate = nack_rate;
+            // split over the shards as the Names are
+            double shard_nack_rate = static_cast<double>(nack_rate) / _shards.size();
+            for (auto &shard : _shards) {
+                shard->call([shard_nack_rate](Pit &pit) {
+                    pit.setNackRate(shard_nack_rate);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("nack_rate");
+        }
+    }
+
+    if (document.HasMember("dead_nonce_lifetime") && document["dead_nonce_lifetime"].IsUint()) {
+        bool has_change = false;
+        ndn::time::milliseconds lifetime(document["dead_nonce_lifetime"].GetUint());
+        if (lifetime != _shards.front()->call([](Pit &pit) { return pit.getDeadNonceLifetime(); })) {
+            for (auto &shard : _shards) {
+                shard->call([lifetime](Pit &pit) {
+                    pit.setDeadNonceLifetime(lifetime);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("dead_nonce_lifetime");
+        }
+    }
+
+    if (document.HasMember("straggler_window") && document["straggler_window"].IsUint()) {
+        bool has_change = false;
+        ndn::time::milliseconds window(document["straggler_window"].GetUint());
+        if (window != _shards.front()->call([](Pit &pit) { return pit.getStragglerWindow(); })) {
+            for (auto &shard : _shards) {
+                shard->call([window](Pit &pit) {
+                    pit.setStragglerWindow(window);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("straggler_window");
+        }
+    }
+
+    if (document.HasMember("udp_batch_size") && document["udp_batch_size"].IsUint()) {
+        bool has_change = false;
+        auto udp_master_face = std::static_pointer_cast<UdpMasterFace>(_udp_ingress_master_face);
+        size_t batch_size = document["udp_batch_size"].GetUint();
+        if (batch_size != udp_master_face->getBatchSize()) {
+            udp_master_face->setBatchSize(batch_size);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_batch_size");
+        }
+    }
+    if (document.HasMember("udp_segmentation") && document["udp_segmentation"].IsBool()) {
+        bool has_change = false;
+        auto udp_master_face = std::static_pointer_cast<UdpMasterFace>(_udp_ingress_master_face);
+        bool segmentation = document["udp_segmentation"].GetBool();
+        if (segmentation != udp_master_face->isSegmenting()) {
+            udp_master_face->setSegmentation(segmentation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_segmentation");
+        }
+    }
+    if (document.HasMember("tcp_gather_bytes") && document["tcp_gather_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["tcp_gather_bytes"].GetUint();
+        if (max_bytes != TcpFace::getGatherMaxBytes()) {
+            TcpFace::setGatherMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_bytes");
+        }
+    }
+    if (document.HasMember("tcp_gather_packets") && document["tcp_gather_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["tcp_gather_packets"].GetUint();
+        if (max_packets != TcpFace::getGatherMaxPackets()) {
+            TcpFace::setGatherMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_packets");
+        }
+    }
+    if (document.HasMember("tcp_max_packet_size") && document["tcp_max_packet_size"].IsUint()) {
+        bool has_change = false;
+        size_t size = document["tcp_max_packet_size"].GetUint();
+        if (size != TcpFace::getMaxPacketSize()) {
+            has_change = TcpFace::setMaxPacketSize(size);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_max_packet_size");
+        }
+    }
+    if (document.HasMember("tcp_flush") && document["tcp_flush"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_flush"].GetString();
+        if (policy != TcpFace::getFlushPolicy()) {
+            has_change = TcpFace::setFlushPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_flush");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_min_delay") && document["tcp_reconnect_min_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_min_delay"].GetUint();
+        if (value != TcpFace::getReconnectMinDelay()) {
+            TcpFace::setReconnectMinDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_min_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_max_delay") && document["tcp_reconnect_max_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_max_delay"].GetUint();
+        if (value != TcpFace::getReconnectMaxDelay()) {
+            TcpFace::setReconnectMaxDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_max_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_attempts") && document["tcp_reconnect_attempts"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_attempts"].GetUint();
+        if (value != TcpFace::getReconnectAttempts()) {
+            TcpFace::setReconnectAttempts(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_attempts");
+        }
+    }
+    if (document.HasMember("tcp_replay_max_age") && document["tcp_replay_max_age"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_replay_max_age"].GetUint();
+        if (value != TcpFace::getReplayMaxAge()) {
+            TcpFace::setReplayMaxAge(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_replay_max_age");
+        }
+    }
+    if (document.HasMember("tcp_credit_window") && document["tcp_credit_window"].IsUint()) {
+        bool has_change = false;
+        size_t window = document["tcp_credit_window"].GetUint();
+        if (window != TcpFace::getCreditWindow()) {
+            TcpFace::setCreditWindow(window);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_window");
+        }
+    }
+    if (document.HasMember("tcp_credit_policy") && document["tcp_credit_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_credit_policy"].GetString();
+        if (policy != TcpFace::getCreditPolicy()) {
+            has_change = TcpFace::setCreditPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_policy");
+        }
+    }
+    if (document.HasMember("udp_mtu") && document["udp_mtu"].IsUint()) {
+        bool has_change = false;
+        size_t mtu = document["udp_mtu"].GetUint();
+        if (mtu != LpLink::getMtu()) {
+            LpLink::setMtu(mtu);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_mtu");
+        }
+    }
+    if (document.HasMember("udp_aggregation") && document["udp_aggregation"].IsBool()) {
+        bool has_change = false;
+        bool aggregation = document["udp_aggregation"].GetBool();
+        if (aggregation != LpLink::getAggregation()) {
+            LpLink::setAggregation(aggregation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_aggregation");
+        }
+    }
+    if (document.HasMember("connection_pool") && _connection_pool.update(document["connection_pool"])) {
+        changes.emplace_back("connection_pool");
+    }
+    if (document.HasMember("socket_options")) {
+        bool has_change = false;
+        // the default of the faces created from now on, the ingress master faces change theirs at once
+        SocketOptions options = SocketOptions::getDefault();
+        if (options.update(document["socket_options"]) && options != SocketOptions::getDefault()) {
+            SocketOptions::setDefault(options);
+            for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face}) {
+                master_face->setSocketOptions(options);
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("socket_options");
+        }
+    }
+    if (document.HasMember("queue_max_packets") && document["queue_max_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["queue_max_packets"].GetUint();
+        if (max_packets != QueuePolicy::getMaxPackets()) {
+            QueuePolicy::setMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_packets");
+        }
+    }
+    if (document.HasMember("queue_max_bytes") && document["queue_max_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["queue_max_bytes"].GetUint();
+        if (max_bytes != QueuePolicy::getMaxBytes()) {
+            QueuePolicy::setMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_bytes");
+        }
+    }
+    if (document.HasMember("queue_drop_policy") && document["queue_drop_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["queue_drop_policy"].GetString();
+        if (policy != QueuePolicy::getDropPolicyName()) {
+            has_change = QueuePolicy::setDropPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_drop_policy");
+        }
+    }
+    if (document.HasMember("queue_scheduler") && document["queue_scheduler"].IsString()) {
+        bool has_change = false;
+        std::string scheduler = document["queue_scheduler"].GetString();
+        if (scheduler != QueuePolicy::getSchedulerName()) {
+            has_change = QueuePolicy::setScheduler(scheduler);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_scheduler");
+        }
+    }
+    if (document.HasMember("queue_classes") && QueuePolicy::setClasses(document["queue_classes"])) {
+        changes.emplace_back("queue_classes");
+    }
+
     std::stringstream ss;
     ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"edit_config", "changes":[)";
     bool first = true;
@@ -160,18 +795,20 @@ void BackwardRouter::commandEditConfig(const rapidjson::Document &document) {
         ss << '"' << change << '"';
     }
     ss << "]}";
-    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
 }
 
 void BackwardRouter::commandAddFace(const rapidjson::Document &document) {
     enum layer_type {
         TCP,
         UDP,
+        SHM,
     };
 
     static const std::unordered_map<std::string, layer_type> LAYERS = {
             {"tcp", TCP},
             {"udp", UDP},
+            {"shm", SHM},
     };
 
     if (document.HasMember("layer") && document.HasMember("address") && document.HasMember("port")
@@ -181,19 +818,36 @@ void BackwardRouter::commandAddFace(const rapidjson::Document &document) {
             std::shared_ptr<Face> face;
             switch (it->second) {
                 case TCP:
-                    face = std::make_shared<TcpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    face = _connection_pool.makeFace(_ios, document["address"].GetString(), document["port"].GetUint());
                     break;
                 case UDP:
                     face = std::make_shared<UdpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
                     break;
+                case SHM:
+                    face = std::make_shared<ShmFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    break;
+            }
+            if (document.HasMember("socket_options")) {
+                // on top of the default, before open for the buffers of a TCP connection
+                SocketOptions options = SocketOptions::getDefault();
+                if (options.update(document["socket_options"])) {
+                    face->setSocketOptions(options);
+                }
+            }
+            if (document.HasMember("push") && document["push"].IsBool() && document["push"].GetBool()) {
+                // to the ingress of a downstream cache, for off-path forwarding
+                _push_faces.push_back(face);
+                face->open(PacketHandler::bind<BackwardRouter, &BackwardRouter::onPushPacket>(this),
+                           boost::bind(&BackwardRouter::onFaceError, this, _1));
+            } else {
+                _egress_faces.push_back(face);
+                face->open(PacketHandler::bind<BackwardRouter, &BackwardRouter::onEgressPacket>(this),
+                           boost::bind(&BackwardRouter::onFaceError, this, _1));
+                updateEgressFaces();
             }
-            _egress_faces.push_back(face);
-            face->open(boost::bind(&BackwardRouter::onEgressInterest, this, _1, _2),
-                       boost::bind(&BackwardRouter::onEgressData, this, _1, _2),
-                       boost::bind(&BackwardRouter::onFaceError, this, _1));
             std::stringstream ss;
             ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_face", "face_id":)" << face->getFaceId() << "}";
-            _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+            sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
         }
     }
 }
@@ -207,16 +861,203 @@ void BackwardRouter::commandDelFace(const rapidjson::Document &document) {
                 egress_face->close();
                 std::swap(egress_face, _egress_faces[_egress_faces.size() - 1]);
                 _egress_faces.pop_back();
+                updateEgressFaces();
+                ok = true;
+                break;
+            }
+        }
+        for (auto it = _push_faces.begin(); !ok && it != _push_faces.end(); ++it) {
+            if ((*it)->getFaceId() == face_id) {
+                (*it)->close();
+                _push_faces.erase(it);
                 ok = true;
                 break;
             }
         }
         std::stringstream ss;
         ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_face", "face_id":)" << face_id << R"(, "status":)" << ok << "}";
-        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
     }
 }
 
 void BackwardRouter::commandList(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list")";
+    ss << R"(, "faces":[)";
+    bool first = true;
+    for (const auto &face : _egress_faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face->toJSON();
+    }
+    ss << R"(], "push_faces":[)";
+    first = true;
+    for (const auto &face : _push_faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face->toJSON();
+    }
+    ss << R"(], "master_faces":[)" << _tcp_ingress_master_face->toJSON() << ", " << _udp_ingress_master_face->toJSON() << ", " << _shm_ingress_master_face->toJSON() << "]"
+       << R"(, "connection_pool":)" << _connection_pool.toJSON() << R"(, "buffer_pool":)" << BufferPool::getStats().toJSON() << R"(, "page_arena":)" << PageArena::getStats().toJSON()
+       << R"(, "stages":)" << stage_profile::toJSON()
+       << R"(, "off_path":{"enabled":)" << (_off_path ? "true" : "false") << R"(, "push_rate":)" << _push_limiter.getRate()
+       << R"(, "push_burst":)" << _push_limiter.getBurst() << R"(, "trusted_addresses":[)";
+    first = true;
+    for (const auto &address : _trusted_addresses) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << '"' << address << '"';
+    }
+    ss << R"(], "pushed":)" << _pushed << R"(, "push_dropped":)" << _push_dropped << R"(, "unsolicited":)" << _unsolicited
+       << R"(, "untrusted":)" << _untrusted << "}"
+       << R"(, "pit":{"size":)" << _size << R"(, "shards":)" << _shards.size() << R"(, "shard_prefix_length":)" << _shard_prefix_length;
+    // summed over the shards, the settings are the same in all of them
+    size_t entries = 0, used_bytes = 0, rejected = 0, evicted = 0, expired = 0, satisfied = 0, looped = 0, duplicates = 0, dead_nonces = 0, nacked = 0, absorbed = 0;
+    bool remove_satisfied = true, nack = true;
+    ndn::time::milliseconds dead_nonce_lifetime(0);
+    ndn::time::milliseconds straggler_window(0);
+    RttStats rtt;
+    for (auto &shard : _shards) {
+        shard->call([&](Pit &pit) {
+            rtt.add(pit.getRttStats());
+            entries += pit.getEntries();
+            used_bytes += pit.getUsedBytes();
+            rejected += pit.getRejected();
+            evicted += pit.getEvicted();
+            expired += pit.getExpired();
+            satisfied += pit.getSatisfied();
+            looped += pit.getLooped();
+            duplicates += pit.getDuplicates();
+            dead_nonces += pit.getDeadNonces();
+            absorbed += pit.getAbsorbed();
+            nacked += pit.getNacked();
+            remove_satisfied = pit.isRemovingSatisfied();
+            nack = pit.isNacking();
+            dead_nonce_lifetime = pit.getDeadNonceLifetime();
+            straggler_window = pit.getStragglerWindow();
+        });
+    }
+    ss << R"(, "entries":)" << entries << R"(, "used_bytes":)" << used_bytes << R"(, "max_bytes":)" << _max_bytes
+       << R"(, "memory_budget":)" << _memory_budget.toJSON()
+       << R"(, "face_quota":)" << _face_quota << R"(, "eviction_batch":)" << _eviction_batch
+       << R"(, "rejected":)" << rejected << R"(, "evicted":)" << evicted
+       << R"(, "expired":)" << expired << R"(, "satisfied":)" << satisfied
+       << R"(, "remove_satisfied":)" << (remove_satisfied ? "true" : "false") << R"(, "looped":)" << looped
+       << R"(, "duplicates":)" << duplicates << R"(, "dead_nonces":)" << dead_nonces
+       << R"(, "dead_nonce_lifetime":)" << dead_nonce_lifetime.count() << R"(, "straggler_window":)" << straggler_window.count()
+       << R"(, "absorbed":)" << absorbed << R"(, "nack":)" << (nack ? "true" : "false")
+       << R"(, "nack_rate":)" << _nack_rate << R"(, "nacked":)" << nacked << R"(, "rtt":)" << rtt.toJSON() << "}}";
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+}
+
+void BackwardRouter::commandMemoryStats(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    MemoryStats stats;
+    for (auto &shard : _shards) {
+        shard->call([&stats](Pit &pit) {
+            pit.addMemoryStats(stats);
+        });
+    }
+    for (const auto &face : _egress_faces) {
+        face->addMemoryStats(stats);
+    }
+    for (const auto &face : _push_faces) {
+        face->addMemoryStats(stats);
+    }
+    _tcp_ingress_master_face->addMemoryStats(stats);
+    _udp_ingress_master_face->addMemoryStats(stats);
+    _shm_ingress_master_face->addMemoryStats(stats);
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"memory_stats", "memory":)"
+       << stats.toJSON() << "}";
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+}
+
+
+void BackwardRouter::commandReport(const boost::system::error_code &err) {
+    // the faces using the most bytes, a flooding face is among them
+    static const size_t REPORTED_FACES = 8;
 
+    if (!err && _manager_endpoint.address() != boost::asio::ip::address_v4::any() && _manager_endpoint.port() != 0) {
+        stage_profile::Scope stage(stage_profile::REPORT);
+        size_t entries = 0, used_bytes = 0, rejected = 0, evicted = 0, satisfied = 0, expired = 0, looped = 0, nacked = 0;
+        std::unordered_map<size_t, Pit::FaceUsage> usage;
+        RttStats rtt;
+        for (auto &shard : _shards) {
+            shard->call([&](Pit &pit) {
+                rtt.add(pit.getRttStats());
+                entries += pit.getEntries();
+                used_bytes += pit.getUsedBytes();
+                rejected += pit.getRejected();
+                evicted += pit.getEvicted();
+                satisfied += pit.getSatisfied();
+                expired += pit.getExpired();
+                looped += pit.getLooped();
+                nacked += pit.getNacked();
+                pit.getFaceUsage(usage);
+            });
+        }
+        std::vector<std::pair<size_t, Pit::FaceUsage>> faces(usage.begin(), usage.end());
+        size_t reported = std::min(faces.size(), REPORTED_FACES);
+        std::partial_sort(faces.begin(), faces.begin() + reported, faces.end(), [](const std::pair<size_t, Pit::FaceUsage> &a, const std::pair<size_t, Pit::FaceUsage> &b) {
+            return a.second.bytes > b.second.bytes;
+        });
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"report", "action":"pit_status", "entries":)" << entries
+           << R"(, "size":)" << _size << R"(, "used_bytes":)" << used_bytes << R"(, "max_bytes":)" << _max_bytes
+           << R"(, "face_quota":)" << _face_quota << R"(, "rejected_count":)" << rejected << R"(, "evicted_count":)" << evicted
+           << R"(, "satisfied_count":)" << satisfied << R"(, "expired_count":)" << expired << R"(, "looped_count":)" << looped
+           << R"(, "nacked_count":)" << nacked << R"(, "faces":[)";
+        for (size_t i = 0; i < reported; ++i) {
+            if (i > 0) {
+                ss << ", ";
+            }
+            ss << R"({"face_id":)" << faces[i].first << R"(, "entries":)" << faces[i].second.entries << R"(, "bytes":)" << faces[i].second.bytes
+               << R"(, "rejected_count":)" << faces[i].second.rejected << R"(, "evicted_count":)" << faces[i].second.evicted << "}";
+        }
+        ss << R"(], "rtt":)" << rtt.toJSON() << R"(, "stages":)" << stage_profile::toJSON() << "}";
+        sendOnControl(_command_socket, ss.str(), _manager_endpoint);
+    }
+    if(_report_enable) {
+        _report_timer.expires_from_now(_delay_between_report);
+        _report_timer.async_wait(boost::bind(&BackwardRouter::commandReport, this, _1));
+    }
 }
+
+void BackwardRouter::writeMetrics(MetricsWriter &writer) {
+    for (const auto &face : _egress_faces) {
+        face->writeMetrics(writer);
+    }
+    for (const auto &face : _push_faces) {
+        face->writeMetrics(writer);
+    }
+    _tcp_ingress_master_face->writeMetrics(writer);
+    _udp_ingress_master_face->writeMetrics(writer);
+    _shm_ingress_master_face->writeMetrics(writer);
+    BufferPool::getStats().writeMetrics(writer);
+    PageArena::getStats().writeMetrics(writer);
+    stage_profile::writeMetrics(writer);
+    if (_memory_budget.isEnabled()) {
+        _memory_budget.writeMetrics(writer, {});
+    }
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        metrics::Labels labels = {{"shard", std::to_string(i)}};
+        _shards[i]->call([&](Pit &pit) {
+            pit.writeMetrics(writer, labels);
+        });
+    }
+    writer.counter("ndn_pushed_total", "Data copied to the push faces", {}, _pushed);
+    writer.counter("ndn_push_dropped_total", "copies to the push faces over the rate", {}, _push_dropped);
+    writer.counter("ndn_unsolicited_total", "unsolicited Data received from the ingress faces", {}, _unsolicited);
+    writer.counter("ndn_untrusted_total", "unsolicited Data received from untrusted addresses", {}, _untrusted);
+}
\ No newline at end of file
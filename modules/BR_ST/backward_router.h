@@ -6,42 +6,123 @@
 #include <boost/asio.hpp>
 
 #include <memory>
+#include <set>
+#include <string>
 #include <vector>
 
 #include "rapidjson/document.h"
 
-#include "module.h"
+#include "runtime/module.h"
+#include "management/startup_config.h"
 #include "network/face.h"
 #include "network/master_face.h"
-#include "pit.h"
+#include "network/token_bucket.h"
+#include "network/tcp_connection_pool.h"
+#include "metrics/memory_budget.h"
+#include "pit_shard.h"
 
+// threads: the faces, the commands and the timers run on the module thread, which owns everything below. the PIT is
+// split in shards (-j), each one only touched by its own thread, see PitShard
 class BackwardRouter : public Module {
     const std::string _name;
 
-    Pit _pit;
+    // the shard of a Name is given by the name_hash of its first components, an Interest and the Data answering it
+    // share those unless the Interest is a shorter CanBePrefix one, which the Data also looks for in the shards of
+    // its shorter prefixes
+    const size_t _shard_prefix_length;
+    std::vector<std::unique_ptr<PitShard>> _shards;
+    // summed over the shards
+    size_t _size;
+    size_t _max_bytes = 0;
+    size_t _face_quota = 0;
+    // entries evicted at once by an insert into a full shard, see Pit::setEvictionBatch
+    size_t _eviction_batch = 1;
+    // Nacks per second over all the shards, 0 for no limit
+    size_t _nack_rate = 0;
+    // off by default, with a share of the cgroup memory limit the byte limit of the PIT follows the budget
+    MemoryBudget _memory_budget;
 
     char _command_buffer[65536];
     boost::asio::ip::udp::socket _command_socket;
     boost::asio::ip::udp::endpoint _remote_command_endpoint;
+    StartupConfig _startup_config;
+    // connections kept open to the endpoints set by edit_config, add_face takes them
+    TcpConnectionPool _connection_pool;
+
+    bool _report_enable = false;
+    boost::asio::ip::udp::endpoint _manager_endpoint;
+    boost::asio::deadline_timer _report_timer;
+    boost::posix_time::milliseconds _delay_between_report;
 
     std::vector<std::shared_ptr<Face>> _egress_faces;
     std::shared_ptr<MasterFace> _tcp_ingress_master_face;
     std::shared_ptr<MasterFace> _udp_ingress_master_face;
+    std::shared_ptr<MasterFace> _shm_ingress_master_face;
+
+    // off-path forwarding: with _off_path the Data received from the egress faces are copied to the push faces, e.g.
+    // to the ingress of content stores to warm them up, and so are the unsolicited Data received from an ingress face
+    // whose address is trusted. both share the token bucket, the copies over it are dropped
+    std::vector<std::shared_ptr<Face>> _push_faces;
+    bool _off_path = false;
+    std::set<std::string> _trusted_addresses;
+    TokenBucket _push_limiter;
+    size_t _pushed = 0;
+    size_t _push_dropped = 0;
+    size_t _unsolicited = 0;
+    size_t _untrusted = 0;
+
+    bool isTrusted(const Face &face) const;
+
+    // of all the shards, as edited
+    void setSize(size_t size);
+
+    void setMaxBytes(size_t max_bytes);
+
+    // the budget becomes the byte limit, the size is raised to hold that many of the smallest entries so that it
+    // doesn't bind first
+    void onMemoryBudget(size_t budget);
+
+    void push(const NdnPacket &packet);
+
+    // the ingress master faces stop accepting, the faces already there are served until the module stops
+    void beginDrain() override;
+
+    // nothing queued on the faces and no Interest pending in the PIT, whose entries can't outlive the faces of this
+    // instance anyway, so that instead of being handed over they are answered or expire
+    bool isDrained() override;
 
 public:
-    BackwardRouter(const std::string &name, size_t max_size, uint16_t local_port, uint16_t local_command_port);
+    // with more than one shard each of them runs on its own thread, a single shard runs on the module thread
+    BackwardRouter(const std::string &name, size_t max_size, uint16_t local_port, uint16_t local_command_port, size_t udp_shards = 1,
+                   size_t shards = 1, size_t shard_prefix_length = 2);
 
     ~BackwardRouter() override = default;
 
     void run() override;
 
-    void onIngressInterest(const std::shared_ptr<Face> &ingress_face, const ndn::Interest &interest);
+    // the commands applied by run() before the ingress accepts a face, see StartupConfig. false if source can't be
+    // read. before start()
+    bool loadStartupConfig(const std::string &source);
 
-    void onIngressData(const std::shared_ptr<Face> &ingress_face, const ndn::Data &data);
+    // the PIT takes percent of the cgroup memory limit and shrinks under memory pressure, see MemoryBudget. false
+    // without a limit. before start()
+    bool enableMemoryBudget(size_t percent);
 
-    void onEgressInterest(const std::shared_ptr<Face> &egress_face, const ndn::Interest &interest);
+    size_t getShardIndex(const NameView &name, size_t length) const;
 
-    void onEgressData(const std::shared_ptr<Face> &egress_face, const ndn::Data &data);
+    // the shards are told about any change of the egress faces
+    void updateEgressFaces();
+
+    void onIngressPacket(const std::shared_ptr<Face> &ingress_face, const NdnPacket &packet);
+
+    // the packets of a read of an ingress face, a burst of Interests goes to a single shard at once
+    void onIngressBurst(const std::shared_ptr<Face> &ingress_face, const std::vector<NdnPacket> &packets);
+
+    // the packet is kept by the shard of its Name
+    void onEgressPacket(const std::shared_ptr<Face> &egress_face, NdnPacket &&packet);
+
+    // the push faces don't expect anything back, all is dropped
+    void onPushPacket(const std::shared_ptr<Face> &push_face, const NdnPacket &packet);
 
     void onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
 
@@ -53,6 +134,9 @@ public:
 
     void commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred);
 
+    // a parsed command with an action, on the module thread
+    void executeCommand(const rapidjson::Document &document);
+
     void commandEditConfig(const rapidjson::Document &document);
 
     void commandAddFace(const rapidjson::Document &document);
@@ -60,4 +144,14 @@ public:
     void commandDelFace(const rapidjson::Document &document);
 
     void commandList(const rapidjson::Document &document);
+
+    // the bytes held by the PIT of each shard and the faces, see MemoryStats
+    void commandMemoryStats(const rapidjson::Document &document);
+
+    // the PIT usage and the faces taking the most of it, for the manager to spot an Interest flood, and the round
+    // trip times by egress face and by prefix
+    void commandReport(const boost::system::error_code &err);
+
+    // at each scrape, from the module thread as commandList
+    void writeMetrics(MetricsWriter &writer);
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+// insert, aggregation, satisfaction and expiry in the Pit, with the heap an entry takes besides its Interest. the
+// Interests are decoded by the Pit as in BR
+// usage: pit_bench [entries...]
+
+#include "pit.h"
+#include "bench/bench.h"
+
+static std::vector<ndn::Block> makeInterests(const std::vector<ndn::Name> &names, uint32_t nonce) {
+    std::vector<ndn::Block> interests;
+    interests.reserve(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        interests.emplace_back(bench::makeInterest(names[i], nonce + static_cast<uint32_t>(i)).wireEncode());
+    }
+    return interests;
+}
+
+static void run(size_t entries) {
+    boost::asio::io_service ios;
+    auto consumer = std::make_shared<bench::NullFace>(ios);
+    auto other_consumer = std::make_shared<bench::NullFace>(ios);
+    auto producer = std::make_shared<bench::NullFace>(ios);
+    auto names = bench::makeNames(entries);
+    auto order = bench::makeOrder(entries);
+    auto interests = bench::toPackets(makeInterests(names, 0));
+    auto other_interests = bench::toPackets(makeInterests(names, 1u << 31));
+    std::vector<ndn::Block> data_blocks;
+    data_blocks.reserve(entries);
+    for (const auto &name : names) {
+        data_blocks.emplace_back(bench::makeData(name, 4000, 100));
+    }
+    auto data = bench::toPackets(data_blocks);
+
+    size_t forwarded = 0;
+    size_t before = bench::getHeapBytes();
+    std::unique_ptr<Pit> pit(new Pit(entries));
+    bench::measure("Pit", "insert", entries, entries, [&](size_t i) {
+        const NdnPacket &packet = interests[i];
+        forwarded += pit->insert(packet.getInterest(), consumer, packet.getNameView().getHash()) == Pit::FORWARD;
+    });
+    bench::printMemory("Pit", entries, bench::getHeapBytes() - before);
+    // the same Names from another face with other nonces
+    bench::measure("Pit", "aggregate", entries, entries, [&](size_t i) {
+        const NdnPacket &packet = other_interests[order[i]];
+        forwarded += pit->insert(packet.getInterest(), other_consumer, packet.getNameView().getHash()) == Pit::FORWARD;
+    });
+    size_t answered = 0;
+    bench::measure("Pit", "satisfy", entries, entries, [&](size_t i) {
+        answered += pit->get(data[order[i]].getNameView(), producer->getFaceId()).size();
+    });
+    pit.reset();
+
+    pit.reset(new Pit(entries));
+    for (size_t i = 0; i < entries; ++i) {
+        pit->insert(interests[i].getInterest(), consumer, interests[i].getNameView().getHash());
+    }
+    size_t expired = 0;
+    bench::measureBatch("Pit", "expire", entries, entries, [&]() {
+        expired = pit->removeExpired(ndn::time::steady_clock::now() + ndn::time::seconds(10));
+    });
+    if (forwarded != entries || answered != entries * 2 || expired != entries) {
+        std::printf("Pit: unexpected verdicts\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t entries : bench::getSizes(argc, argv)) {
+        run(entries);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "dead_nonce_list.h"
+
+#include <algorithm>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+
+const ndn::time::milliseconds DeadNonceList::DEFAULT_LIFETIME {6000};
+
+DeadNonceList::DeadNonceList(size_t capacity, const ndn::time::milliseconds &lifetime) : _lifetime(lifetime) {
+    setCapacity(capacity);
+}
+
+uint64_t DeadNonceList::key(uint64_t name_hash, uint32_t nonce) {
+    return name_hash::mix(name_hash, nonce);
+}
+
+bool DeadNonceList::test(const Filter &filter, uint64_t key) const {
+    if (filter.insertions == 0) {
+        return false;
+    }
+    // double hashing, the second hash is odd so the probes don't repeat
+    uint64_t step = name_hash::mix(key, HASHES) | 1;
+    for (size_t i = 0; i < HASHES; ++i, key += step) {
+        uint64_t bit = key & _mask;
+        if (!(filter.words[bit / 64] & (1ULL << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DeadNonceList::swap(const ndn::time::steady_clock::time_point &now) {
+    _current ^= 1;
+    Filter &filter = _filters[_current];
+    std::fill(filter.words.begin(), filter.words.end(), 0);
+    filter.insertions = 0;
+    filter.since = now;
+}
+
+size_t DeadNonceList::getCapacity() const {
+    return _capacity;
+}
+
+void DeadNonceList::setCapacity(size_t capacity) {
+    _capacity = std::max<size_t>(capacity, 1);
+    // about 10 bits per nonce for 7 hashes and 1% of false positives
+    uint64_t bits = 64;
+    while (bits < _capacity * 10) {
+        bits *= 2;
+    }
+    _mask = bits - 1;
+    auto now = ndn::time::steady_clock::now();
+    for (auto &filter : _filters) {
+        filter.words.assign(bits / 64, 0);
+        filter.insertions = 0;
+        filter.since = now;
+    }
+}
+
+const ndn::time::milliseconds& DeadNonceList::getLifetime() const {
+    return _lifetime;
+}
+
+void DeadNonceList::setLifetime(const ndn::time::milliseconds &lifetime) {
+    _lifetime = lifetime;
+}
+
+void DeadNonceList::add(uint64_t name_hash, uint32_t nonce, const ndn::time::steady_clock::time_point &now) {
+    if (_filters[_current].insertions >= _capacity) {
+        swap(now);
+    }
+    Filter &filter = _filters[_current];
+    uint64_t k = key(name_hash, nonce);
+    uint64_t step = name_hash::mix(k, HASHES) | 1;
+    for (size_t i = 0; i < HASHES; ++i, k += step) {
+        uint64_t bit = k & _mask;
+        filter.words[bit / 64] |= 1ULL << (bit % 64);
+    }
+    ++filter.insertions;
+}
+
+bool DeadNonceList::contains(uint64_t name_hash, uint32_t nonce) const {
+    uint64_t k = key(name_hash, nonce);
+    return test(_filters[_current], k) || test(_filters[_current ^ 1], k);
+}
+
+void DeadNonceList::rotate(const ndn::time::steady_clock::time_point &now) {
+    // the older filter holds the nonces of the lifetime before, they already had a lifetime at least
+    if (now - _filters[_current].since >= _lifetime) {
+        swap(now);
+    }
+}
+
+size_t DeadNonceList::size() const {
+    return _filters[0].insertions + _filters[1].insertions;
+}
+
+size_t DeadNonceList::getMemoryUsage() const {
+    return memory_usage::of(_filters[0].words) + memory_usage::of(_filters[1].words);
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// the nonces of the Interests whose PIT entry is gone, by (name_hash, nonce), so that one coming back through a loop
+// once its entry was satisfied or expired is still recognized. two Bloom filters take turns: the nonces go to the
+// current one, both are looked up, and the older one is cleared to become the current one once the current one holds
+// capacity nonces or is older than the lifetime. a nonce is thus remembered for a lifetime at least unless more than
+// capacity nonces come meanwhile, and a false positive, about 1% when full, drops an Interest which didn't loop
+class DeadNonceList {
+public:
+    static const size_t DEFAULT_CAPACITY = 65536;
+    // longer than the time an Interest takes to loop back
+    static const ndn::time::milliseconds DEFAULT_LIFETIME;
+
+private:
+    static const size_t HASHES = 7;
+
+    struct Filter {
+        std::vector<uint64_t> words;
+        size_t insertions = 0;
+        ndn::time::steady_clock::time_point since;
+    };
+
+    size_t _capacity;
+    ndn::time::milliseconds _lifetime;
+    Filter _filters[2];
+    size_t _current = 0;
+    // bits per filter - 1, a power of 2 minus 1
+    uint64_t _mask = 0;
+
+    static uint64_t key(uint64_t name_hash, uint32_t nonce);
+
+    bool test(const Filter &filter, uint64_t key) const;
+
+    void swap(const ndn::time::steady_clock::time_point &now);
+
+public:
+    explicit DeadNonceList(size_t capacity = DEFAULT_CAPACITY, const ndn::time::milliseconds &lifetime = DEFAULT_LIFETIME);
+
+    size_t getCapacity() const;
+
+    // the nonces remembered so far are forgotten
+    void setCapacity(size_t capacity);
+
+    const ndn::time::milliseconds& getLifetime() const;
+
+    void setLifetime(const ndn::time::milliseconds &lifetime);
+
+    void add(uint64_t name_hash, uint32_t nonce, const ndn::time::steady_clock::time_point &now);
+
+    bool contains(uint64_t name_hash, uint32_t nonce) const;
+
+    // the current filter is retired once older than the lifetime
+    void rotate(const ndn::time::steady_clock::time_point &now);
+
+    // nonces added to both filters
+    size_t size() const;
+
+    // the words of both filters
+    size_t getMemoryUsage() const;
+};
\ No newline at end of file
@@ -1,19 +1,46 @@
 #include <ndn-cxx/common.hpp>
 
-#include "pit.h"
+#include <algorithm>
+
 #include "backward_router.h"
 #include "log/logger.h"
-
-static bool stop = false;
-static void signal_handler(int signum) {
-    stop = true;
-}
+#include "network/packet_capture.h"
+#include "network/tracer.h"
+#include "network/page_arena.h"
+#include "network/socket_options.h"
+#include "network/udp_egress_socket.h"
+#include "network/uring_service.h"
+#include "network/xdp_socket.h"
 
 int main(int argc, char *argv[]) {
     std::string name = "";
     size_t size = 0;
     uint16_t local_port = 0;
     uint16_t local_command_port = 0;
+    size_t udp_shards = 1;
+    size_t shards = 1;
+    size_t shard_prefix_length = 2;
+    std::string backend = "epoll";
+    // "eth0" or "eth0:2", the UDP master faces then read their port off the NIC queues with AF_XDP
+    std::string xdp_interface = "";
+    // "receive_buffer=8388608,dscp=46", the default profile of the sockets of the faces, see SocketOptions
+    std::string socket_options = "";
+    // "connected" for a connected socket per egress UDP face, "shared" for one socket shared by them, see UdpEgressSocket
+    std::string egress_sockets = "connected";
+    // "thp", "2M" or "1G", optionally ":local", the pages of the large tables, see PageArena
+    std::string pages = "";
+    // in milliseconds, SIGINT or SIGTERM lets the module drain that long at most before it stops
+    size_t drain_timeout = 2000;
+    // 0 for no metrics endpoint
+    uint16_t metrics_port = 0;
+    // one packet in trace_sampling is traced through the chain, see Tracer, 0 for none
+    uint64_t trace_sampling = 0;
+    // "directory[:file_mb[:files]]", the packets of the faces are captured there for ndnms-bench -R, see PacketCapture
+    std::string capture = "";
+    // percent of the cgroup memory limit the PIT takes, sized by bytes rather than by -s, see MemoryBudget. 0 for none
+    size_t memory_percent = 0;
+    // a file or the JSON of the commands applied before the module listens, see StartupConfig
+    std::string startup_config = "";
 
     char flags = 0;
     for (int i = 1; i < argc; i += 2) {
@@ -34,13 +61,58 @@ int main(int argc, char *argv[]) {
                 local_command_port = std::atoi(argv[i + 1]);
                 flags |= 0x8;
                 break;
+            case 'u':
+                udp_shards = std::atoi(argv[i + 1]);
+                break;
+            // each shard has a thread of its own, -j as for the other modules
+            case 't':
+            case 'j':
+                shards = std::max(1, std::atoi(argv[i + 1]));
+                break;
+            case 'k':
+                shard_prefix_length = std::atoi(argv[i + 1]);
+                break;
+            case 'b':
+                backend = argv[i + 1];
+                break;
+            case 'X':
+                xdp_interface = argv[i + 1];
+                break;
+            case 'O':
+                socket_options = argv[i + 1];
+                break;
+            case 'U':
+                egress_sockets = argv[i + 1];
+                break;
+            case 'H':
+                pages = argv[i + 1];
+                break;
+            case 'g':
+                drain_timeout = std::atoi(argv[i + 1]);
+                break;
+            case 'M':
+                metrics_port = std::atoi(argv[i + 1]);
+                break;
+            case 'T':
+                trace_sampling = std::strtoull(argv[i + 1], nullptr, 10);
+                break;
+            case 'R':
+                capture = argv[i + 1];
+                break;
+            case 'L':
+                memory_percent = std::atoi(argv[i + 1]);
+                break;
+            case 'F':
+                startup_config = argv[i + 1];
+                break;
             case 'h':
             default:
                 exit(0);
                 break;
         }
     }
-    if (flags != 0xF) {
+    // -s may be left out with -L
+    if ((memory_percent > 0 ? flags | 0x2 : flags) != 0xF) {
         exit(-1);
     }
 
@@ -49,18 +121,50 @@ int main(int argc, char *argv[]) {
     logger::setFilename("logs.txt");
     logger::isTee(true);
     logger::setMinimalLogLevel(logger::INFO);
+    Tracer::setSampling(trace_sampling);
+    if (!capture.empty() && !PacketCapture::start(capture)) {
+        logger::log(logger::WARNING, "the packets can't be captured in {}", {capture});
+    }
 
-    BackwardRouter backward_router(name, size, local_port, local_command_port);
-    backward_router.start();
-
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    // faces created by the module pick the backend up, it must be selected before
+    if (backend == "io_uring" && !UringService::enable()) {
+        logger::log(logger::WARNING, "io_uring is not available, falling back to epoll");
+    }
+    if (!xdp_interface.empty() && !XdpSocket::enable(xdp_interface)) {
+        logger::log(logger::WARNING, "AF_XDP is not available on {}, udp is read from the sockets", {xdp_interface});
+    }
+    SocketOptions options;
+    if (SocketOptions::parse(socket_options, options)) {
+        SocketOptions::setDefault(options);
+    } else {
+        logger::log(logger::WARNING, "invalid socket options {}, the kernel defaults are kept", {socket_options});
+    }
+    if (egress_sockets == "shared") {
+        UdpEgressSocket::enable();
+    }
+    // before the tables are created
+    if (!pages.empty() && !PageArena::enable(pages)) {
+        logger::log(logger::WARNING, "invalid pages {}, the tables are kept in the heap", {pages});
+    }
 
-    do {
-        sleep(15);
-    } while (!stop);
+    BackwardRouter backward_router(name, size, local_port, local_command_port, udp_shards, shards, shard_prefix_length);
+    if (memory_percent > 0 && !backward_router.enableMemoryBudget(memory_percent)) {
+        if (size == 0) {
+            logger::log(logger::ERROR, "no cgroup memory limit to size the PIT from, -s is needed");
+            return -1;
+        }
+        logger::log(logger::WARNING, "no cgroup memory limit, the PIT keeps the size it was given");
+    }
+    if (metrics_port != 0) {
+        backward_router.enableMetrics(metrics_port);
+    }
+    if (!startup_config.empty() && !backward_router.loadStartupConfig(startup_config)) {
+        logger::log(logger::ERROR, "the startup configuration {} can't be read", {startup_config});
+        return -1;
+    }
+    backward_router.start();
 
-    backward_router.stop();
+    backward_router.waitForStop(boost::posix_time::milliseconds(drain_timeout));
 
     return 0;
 }
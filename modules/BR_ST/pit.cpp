@@ -1,8 +1,17 @@
 #include "pit.h"
 
+#include <algorithm>
+
+#include "log/probes.h"
+#include "metrics/memory_stats.h"
+#include "network/coarse_clock.h"
+#include "network/name_hash.h"
+
 const ndn::time::milliseconds Pit::MINIMAL_INTEREST_LIFETIME {5};
+const ndn::time::milliseconds Pit::EXPIRY_TICK {10};
 
-Pit::Pit(size_t size) : _max_size(size) {
+Pit::Pit(size_t size) : _max_size(size), _expiry(EXPIRY_TICK, EXPIRY_SLOTS) {
+    _tree.setDeferredPruning(true);
 
 }
 
@@ -14,40 +23,487 @@ void Pit::setSize(size_t size) {
     _max_size = size;
 }
 
-bool Pit::insert(const ndn::Interest &interest, const std::shared_ptr<Face> &face) {
+size_t Pit::getMaxBytes() const {
+    return _max_bytes;
+}
+
+void Pit::setMaxBytes(size_t max_bytes) {
+    _max_bytes = max_bytes;
+    while (isOverLimits() && evictNoisiest()) {
+
+    }
+}
+
+size_t Pit::getEvictionBatch() const {
+    return _eviction_batch;
+}
+
+void Pit::setEvictionBatch(size_t batch) {
+    _eviction_batch = std::max<size_t>(batch, 1);
+}
+
+size_t Pit::getFaceQuota() const {
+    return _face_quota;
+}
+
+void Pit::setFaceQuota(size_t face_quota) {
+    _face_quota = face_quota;
+}
+
+bool Pit::isRemovingSatisfied() const {
+    return _remove_satisfied;
+}
+
+void Pit::setRemoveSatisfied(bool remove_satisfied) {
+    _remove_satisfied = remove_satisfied;
+}
+
+const ndn::time::milliseconds& Pit::getCacheLifetime() const {
+    return _cache_lifetime;
+}
+
+void Pit::setCacheLifetime(const ndn::time::milliseconds &lifetime) {
+    _cache_lifetime = lifetime;
+}
+
+Pit::Verdict Pit::insert(const ndn::Interest &interest, const std::shared_ptr<Face> &face) {
+    return insert(interest, face, name_hash::hash(interest.getName()));
+}
+
+Pit::Verdict Pit::insert(const ndn::Interest &interest, const std::shared_ptr<Face> &face, uint64_t hash) {
     if (interest.getInterestLifetime() < MINIMAL_INTEREST_LIFETIME) {
-        return false;
+        return TOO_SHORT;
     }
 
-    if (auto entry = _tree.find(interest.getName())) {
-        _list.splice(_list.begin(), _list, _list_index.at(interest.getName().toUri()));
-        return entry->addFace(interest, face);
+    const ndn::Name &name = interest.getName();
+    uint32_t nonce = interest.getNonce();
+    if (auto entry = interest.getCanBePrefix() ? _tree.find(name) : _exact.find(name, hash)) {
+        if (entry->hasNonce(nonce)) {
+            ++(entry->hasFace(face) ? _duplicates : _looped);
+            return DROP;
+        }
+        if (_cache_lifetime.count() > 0) {
+            _cached = entry->getFreshData(coarse_clock::now());
+            if (_cached) {
+                ++_cache_hits;
+                return CACHED;
+            }
+        }
+        if (entry->getFaceId() != face->getFaceId() && !entry->hasFace(face)) {
+            _by_face[face->getFaceId()].joined.emplace_back(entry);
+        }
+        return entry->addFace(interest, face) ? FORWARD : DROP;
+    }
+    if (_dead_nonces.contains(hash, nonce)) {
+        ++_looped;
+        return DROP;
+    }
+    if (_stragglers.contains(hash, face->getFaceId(), coarse_clock::now())) {
+        ++_absorbed;
+        return DROP;
+    }
+    size_t size = PitEntry::getSize(interest);
+    auto &face_entries = _by_face[face->getFaceId()];
+    if (_face_quota > 0 && face_entries.usage.bytes + size > _face_quota) {
+        ++face_entries.usage.rejected;
+        ++_rejected;
+        return CONGESTION;
+    }
+    auto entry = std::make_shared<PitEntry>(interest, face, hash);
+    // keyed by the copy of the entry, not by the Name of the Interest which shares its read chunk
+    if (entry->canBePrefix()) {
+        _tree.insert(entry->getName(), entry);
+        countPrefixEntry(*entry, true);
     } else {
-        _tree.insert(interest.getName(), std::make_shared<PitEntry>(interest, face));
-        _list_index[interest.getName().toUri()] = _list.emplace(_list.begin(), interest.getName());
-        if (_list.size() > _max_size) {
-            _tree.remove(*_list.rbegin());
-            _list_index.erase(_list.rbegin()->toUri());
-            _list.erase(--_list.end());
+        _exact.insert(entry->getName(), entry);
+    }
+    _expiry.schedule(entry, entry->getKeepUntil());
+    face_entries.arrivals.emplace_back(entry);
+    ++face_entries.usage.entries;
+    face_entries.usage.bytes += size;
+    _used_bytes += size;
+    if (isOverLimits()) {
+        // down to half of the PIT at most
+        size_t slack = std::min(_eviction_batch - 1, _max_size / 2);
+        while (isOverLimits(slack)) {
+            // the Interest itself may be the one to go, it isn't worth forwarding then
+            auto evicted = evictNoisiest(entry);
+            if (evicted == entry) {
+                return CONGESTION;
+            } else if (!evicted) {
+                return isOverLimits() ? CONGESTION : FORWARD;
+            }
+        }
+    }
+    return FORWARD;
+}
+
+bool Pit::isOverLimits(size_t slack) const {
+    return getEntries() + slack > _max_size || (_max_bytes > 0 && _used_bytes + _cached_bytes > _max_bytes);
+}
+
+std::shared_ptr<PitEntry> Pit::evictNoisiest(const std::shared_ptr<PitEntry> &except) {
+    // there are a few ingress faces, they are all looked at
+    FaceEntries *noisiest = nullptr;
+    for (auto &face_entries : _by_face) {
+        if (face_entries.second.usage.entries > 0 && (!noisiest || face_entries.second.usage.bytes > noisiest->usage.bytes)) {
+            noisiest = &face_entries.second;
+        }
+    }
+    if (!noisiest) {
+        return nullptr;
+    }
+    while (!noisiest->arrivals.empty()) {
+        auto oldest = noisiest->arrivals.front().lock();
+        noisiest->arrivals.pop_front();
+        if (oldest && remove(oldest)) {
+            ++noisiest->usage.evicted;
+            ++_evicted;
+            if (oldest != except && oldest->hasFaces() && allowNack()) {
+                _nacks.emplace_back(Nack{oldest, LpLink::CONGESTION});
+            }
+            return oldest;
+        }
+    }
+    return nullptr;
+}
+
+void Pit::release(const PitEntry &entry) {
+    _used_bytes -= entry.getSize();
+    _cached_bytes -= entry.getDataSize();
+    auto it = _by_face.find(entry.getFaceId());
+    if (it != _by_face.end()) {
+        --it->second.usage.entries;
+        it->second.usage.bytes -= entry.getSize();
+    }
+}
+
+size_t Pit::removeFace(const std::shared_ptr<Face> &face) {
+    auto it = _by_face.find(face->getFaceId());
+    if (it == _by_face.end()) {
+        return 0;
+    }
+    auto now = coarse_clock::now();
+    size_t removed = 0;
+    // remove() only looks the face entries up, the iterator stays valid
+    auto remove_face = [&](const std::weak_ptr<PitEntry> &weak_entry) {
+        auto entry = weak_entry.lock();
+        if (entry && entry->delFace(face) && !entry->hasFaces() && remove(entry)) {
+            retire(*entry, now);
+            ++removed;
+        }
+    };
+    std::for_each(it->second.arrivals.begin(), it->second.arrivals.end(), remove_face);
+    std::for_each(it->second.joined.begin(), it->second.joined.end(), remove_face);
+    it->second.joined.clear();
+    // those still waiting for other faces are charged to it until they leave
+    if (it->second.usage.entries == 0) {
+        _by_face.erase(it);
+    }
+    return removed;
+}
+
+void Pit::prefetch(const NameView &name) const {
+    _exact.prefetch(name);
+}
+
+const PitEntry::Faces& Pit::get(const NameView &name, size_t egress_face_id) {
+    return get(name, egress_face_id, nullptr);
+}
+
+const PitEntry::Faces& Pit::get(const NdnPacket &data, size_t egress_face_id) {
+    return get(data.getNameView(), egress_face_id, _cache_lifetime.count() > 0 ? &data : nullptr);
+}
+
+const PitEntry::Faces& Pit::get(const NameView &name, size_t egress_face_id, const NdnPacket *data) {
+    _faces.clear();
+    auto now = coarse_clock::now();
+    auto lifetime = data ? std::min(data->getFreshnessPeriod(), _cache_lifetime) : ndn::time::milliseconds(0);
+    // the entries holding the Data are kept
+    bool is_taking = _remove_satisfied && lifetime.count() <= 0;
+    // the longest Name first, then its prefixes
+    if (auto entry = is_taking ? _exact.take(name) : _exact.find(name)) {
+        satisfy(*entry, name, egress_face_id, now, data, lifetime);
+    }
+    if (_tree.getPopulatedNodes() > 0) {
+        auto list = is_taking ? _tree.takeValuesUntil(name) : _tree.findValuesUntil(name);
+        for (auto it = list.rbegin(); it != list.rend(); ++it) {
+            satisfy(**it, name, egress_face_id, now, data, lifetime);
+            if (is_taking) {
+                countPrefixEntry(**it, false);
+            }
+        }
+    }
+    return _faces;
+}
+
+const std::shared_ptr<const ndn::Buffer>& Pit::getCachedData() const {
+    return _cached;
+}
+
+void Pit::satisfy(PitEntry &entry, const NameView &name, size_t egress_face_id, const ndn::time::steady_clock::time_point &now,
+                  const NdnPacket *data, const ndn::time::milliseconds &lifetime) {
+    NDNMS_PROBE2(pit_satisfy, name.getHash(), egress_face_id);
+    // an entry kept once satisfied has no faces left, a second Data for it isn't a round trip
+    size_t first_face = _faces.size();
+    if (entry.takeFaces(_faces)) {
+        _rtt.record(egress_face_id, name, now - entry.getForwardedAt());
+    }
+    for (size_t i = first_face; i < _faces.size(); ++i) {
+        _stragglers.add(entry.getNameHash(), _faces[i]->getFaceId(), now);
+    }
+    if (lifetime.count() > 0) {
+        ++_satisfied;
+        const auto &wire = data->getWire();
+        _cached_bytes += wire->size() - entry.getDataSize();
+        entry.setData(wire, now + lifetime);
+        // the expiry wheel finds it again once due
+    } else if (_remove_satisfied) {
+        ++_satisfied;
+        release(entry);
+        retire(entry, now);
+    }
+}
+
+bool Pit::remove(const std::shared_ptr<PitEntry> &entry) {
+    if (entry->canBePrefix()) {
+        if (_tree.find(entry->getName()) != entry) {
+            return false;
+        }
+        _tree.remove(entry->getName());
+        countPrefixEntry(*entry, false);
+    } else {
+        if (_exact.find(entry->getName()) != entry) {
+            return false;
+        }
+        _exact.remove(entry->getName());
+    }
+    release(*entry);
+    return true;
+}
+
+size_t Pit::removeExpired(const ndn::time::steady_clock::time_point &now) {
+    size_t removed = 0;
+    _expiry.advance(now, [this, &now, &removed](const std::shared_ptr<PitEntry> &entry) {
+        if (entry->getKeepUntil() > now) {
+            _expiry.schedule(entry, entry->getKeepUntil());
+        } else if (remove(entry)) {
+            NDNMS_PROBE1(pit_expire, entry->getNameHash());
+            retire(*entry, now);
+            ++removed;
+            // nothing came back from upstream in time, unless the entry was satisfied and kept
+            if (entry->hasFaces() && allowNack()) {
+                _nacks.emplace_back(Nack{entry, LpLink::NO_ROUTE});
+            }
+        }
+    });
+    _expired += removed;
+    for (auto it = _by_face.begin(); it != _by_face.end();) {
+        auto &arrivals = it->second.arrivals;
+        while (!arrivals.empty() && arrivals.front().expired()) {
+            arrivals.pop_front();
+        }
+        auto &joined = it->second.joined;
+        while (!joined.empty() && joined.front().expired()) {
+            joined.pop_front();
+        }
+        if (it->second.usage.entries == 0 && joined.empty()) {
+            it = _by_face.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    _dead_nonces.rotate(now);
+    _tree.prune(SIZE_MAX);
+    return removed;
+}
+
+void Pit::countPrefixEntry(const PitEntry &entry, bool added) {
+    size_t length = entry.getName().size();
+    if (added) {
+        if (length >= _prefix_entries.size()) {
+            _prefix_entries.resize(length + 1, 0);
         }
-        //std::cout << _tree.getPopulatedNodes() << "/" << _max_size << " (" << _tree.size() << " total nodes)" << std::endl;
-        return true;
+        ++_prefix_entries[length];
+    } else {
+        --_prefix_entries[length];
     }
 }
 
-std::set<std::shared_ptr<Face>> Pit::get(const ndn::Data &data) {
-    std::set<std::shared_ptr<Face>> faces;
-    auto list = _tree.findAllUntil(data.getName());
-    for (auto it = list.rbegin(); it != list.rend(); ++it) {
-        auto&& entry_faces = it->second->getAndResetFaces();
-        faces.insert(std::make_move_iterator(entry_faces.begin()), std::make_move_iterator(entry_faces.end()));
-        //_tree.remove(it->first);
+void Pit::retire(const PitEntry &entry, const ndn::time::steady_clock::time_point &now) {
+    for (size_t i = 0; i < entry.getNonceCount(); ++i) {
+        _dead_nonces.add(entry.getNameHash(), entry.getNonces()[i], now);
+    }
+}
+
+ndn::time::steady_clock::duration Pit::getExpiryTick() const {
+    return _expiry.getTick();
+}
+
+size_t Pit::getEntries() const {
+    return _exact.size() + _tree.getPopulatedNodes();
+}
+
+size_t Pit::getPrefixEntriesShorterThan(size_t length) const {
+    size_t entries = 0;
+    for (size_t i = 0; i < std::min(length, _prefix_entries.size()); ++i) {
+        entries += _prefix_entries[i];
     }
-    return faces;
+    return entries;
+}
+
+size_t Pit::getUsedBytes() const {
+    return _used_bytes;
+}
+
+size_t Pit::getCachedBytes() const {
+    return _cached_bytes;
+}
+
+size_t Pit::getCacheHits() const {
+    return _cache_hits;
+}
+
+size_t Pit::getRejected() const {
+    return _rejected;
+}
+
+size_t Pit::getEvicted() const {
+    return _evicted;
+}
+
+void Pit::getFaceUsage(std::unordered_map<size_t, FaceUsage> &usage) const {
+    for (const auto &face_entries : _by_face) {
+        auto &total = usage[face_entries.first];
+        total.entries += face_entries.second.usage.entries;
+        total.bytes += face_entries.second.usage.bytes;
+        total.rejected += face_entries.second.usage.rejected;
+        total.evicted += face_entries.second.usage.evicted;
+    }
+}
+
+size_t Pit::getExpired() const {
+    return _expired;
+}
+
+size_t Pit::getSatisfied() const {
+    return _satisfied;
+}
+
+size_t Pit::getLooped() const {
+    return _looped;
+}
+
+size_t Pit::getDuplicates() const {
+    return _duplicates;
+}
+
+size_t Pit::getDeadNonces() const {
+    return _dead_nonces.size();
+}
+
+size_t Pit::getAbsorbed() const {
+    return _absorbed;
+}
+
+const ndn::time::milliseconds& Pit::getStragglerWindow() const {
+    return _stragglers.getWindow();
+}
+
+void Pit::setStragglerWindow(const ndn::time::milliseconds &window) {
+    _stragglers.setWindow(window);
+}
+
+bool Pit::isNacking() const {
+    return _nack;
+}
+
+void Pit::setNacking(bool nack) {
+    _nack = nack;
+}
+
+double Pit::getNackRate() const {
+    return _nack_limiter.getRate();
+}
+
+void Pit::setNackRate(double rate) {
+    _nack_limiter.set(rate, std::max(rate, 1.0));
+}
+
+bool Pit::allowNack() {
+    if (!_nack || !_nack_limiter.take()) {
+        return false;
+    }
+    ++_nacked;
+    return true;
+}
+
+size_t Pit::getNacked() const {
+    return _nacked;
+}
+
+void Pit::takeNacks(std::vector<Nack> &nacks) {
+    nacks.swap(_nacks);
+    _nacks.clear();
+}
+
+const RttStats& Pit::getRttStats() const {
+    return _rtt;
+}
+
+void Pit::setRttPrefixLength(size_t length) {
+    _rtt.setPrefixLength(length);
+}
+
+const ndn::time::milliseconds& Pit::getDeadNonceLifetime() const {
+    return _dead_nonces.getLifetime();
+}
+
+void Pit::setDeadNonceLifetime(const ndn::time::milliseconds &lifetime) {
+    _dead_nonces.setLifetime(lifetime);
+}
+
+void Pit::addMemoryStats(MemoryStats &stats) const {
+    _exact.addMemoryStats(stats, "pit_exact");
+    _tree.addMemoryStats(stats, "pit_tree");
+    size_t entries = 0;
+    size_t entry_bytes = 0;
+    auto add_entry = [&](const PitEntry &entry) {
+        ++entries;
+        entry_bytes += entry.getMemoryUsage();
+    };
+    _exact.forEachValue(add_entry);
+    _tree.forEachValue(add_entry);
+    // the cached Data in them as well
+    stats.add("pit_entries", entries, entry_bytes);
+    size_t by_face_bytes = memory_usage::of(_by_face) + memory_usage::of(_prefix_entries) + memory_usage::of(_faces);
+    for (const auto &face : _by_face) {
+        by_face_bytes += memory_usage::of(face.second.arrivals) + memory_usage::of(face.second.joined);
+    }
+    stats.add("pit_by_face", _by_face.size(), by_face_bytes);
+    stats.add("pit_expiry", _expiry.size(), _expiry.getMemoryUsage());
+    stats.add("pit_dead_nonces", _dead_nonces.size(), _dead_nonces.getMemoryUsage());
+    stats.add("pit_stragglers", _stragglers.getCapacity(), _stragglers.getMemoryUsage());
+    stats.add("pit_rtt", 1, _rtt.getMemoryUsage());
+    stats.add("pit_nacks", _nacks.size(), memory_usage::of(_nacks));
 }
 
 std::string Pit::toJSON() const {
     std::stringstream ss;
-    ss << R"({"type": "pit", "tree":)" << _tree.toJSON() << "}";
+    ss << R"({"type": "pit", "exact":)" << _exact.toJSON() << R"(, "tree":)" << _tree.toJSON() << "}";
     return ss.str();
 }
+
+void Pit::writeMetrics(MetricsWriter &writer, const metrics::Labels &labels) const {
+    writer.gauge("ndn_pit_entries", "entries in the PIT", labels, getEntries());
+    writer.gauge("ndn_pit_bytes", "bytes of the Interests in the PIT", labels, _used_bytes);
+    const std::pair<const char*, size_t> outcomes[] = {
+            {"satisfied", _satisfied}, {"expired", _expired}, {"rejected", _rejected}, {"evicted", _evicted},
+            {"looped", _looped}, {"duplicate", _duplicates}, {"nacked", _nacked}, {"cached", _cache_hits},
+            {"absorbed", _absorbed}};
+    for (const auto &outcome : outcomes) {
+        metrics::Labels outcome_labels = labels;
+        outcome_labels.emplace_back("outcome", outcome.first);
+        writer.counter("ndn_pit_interests_total", "Interests by how the PIT handled them", outcome_labels, outcome.second);
+    }
+}
@@ -3,24 +3,143 @@
 #include <ndn-cxx/interest.hpp>
 #include <ndn-cxx/data.hpp>
 
+#include <deque>
 #include <memory>
-#include <list>
 #include <unordered_map>
-#include <set>
+#include <vector>
 
 #include "tree/named_tree.h"
+#include "tree/name_hash_index.h"
+#include "tree/timer_wheel.h"
 #include "pit_entry.h"
+#include "dead_nonce_list.h"
+#include "straggler_table.h"
+#include "rtt_stats.h"
 #include "network/face.h"
+#include "network/lp_link.h"
+#include "network/ndn_packet.h"
+#include "network/token_bucket.h"
+#include "metrics/metrics.h"
 
 class Pit {
+public:
+    // what insert does with an Interest
+    enum Verdict {
+        // in a new entry, or one to retransmit
+        FORWARD,
+        // aggregated in an entry, or a duplicate or a loop
+        DROP,
+        // over the limits of the PIT or the quota of its face
+        CONGESTION,
+        // its lifetime is below the minimal one
+        TOO_SHORT,
+        // answered by the Data its entry holds, see getCachedData
+        CACHED,
+    };
+
+    // an entry removed before it was satisfied, its faces are still waiting
+    struct Nack {
+        std::shared_ptr<PitEntry> entry;
+        LpLink::NackReason reason;
+    };
+
+    // what the entries created by a face take, the counters are kept while it has some
+    struct FaceUsage {
+        size_t entries = 0;
+        size_t bytes = 0;
+        // Interests refused over the quota of the face
+        size_t rejected = 0;
+        // entries removed to stay under the limits of the whole PIT
+        size_t evicted = 0;
+    };
+
 private:
     static const ndn::time::milliseconds MINIMAL_INTEREST_LIFETIME;
+    // 10ms ticks over 40.96s, longer lifetimes take a few turns
+    static const ndn::time::milliseconds EXPIRY_TICK;
+    static const size_t EXPIRY_SLOTS = 4096;
 
+    struct FaceEntries {
+        FaceUsage usage;
+        // the entries of the face in the order they were created, those removed meanwhile are skipped
+        std::deque<std::weak_ptr<PitEntry>> arrivals;
+        // the entries created by other faces which the face was added to, so that removeFace reaches them as well
+        std::deque<std::weak_ptr<PitEntry>> joined;
+    };
+
+    // safety limits once the entries expire, above them the oldest entry of the face using the most bytes is evicted
+    // so that a face flooding the PIT with Interests nobody answers loses its own entries first
     size_t _max_size;
+    // as counted by PitEntry::getSize, 0 for no limit
+    size_t _max_bytes = 0;
+    size_t _used_bytes = 0;
+    // bytes the entries of a single face may take, 0 for no limit. an Interest which would go over it is dropped
+    size_t _face_quota = 0;
+    size_t _rejected = 0;
+    size_t _evicted = 0;
+    // entries evicted at once by an insert over the size, so that the next ones find room
+    size_t _eviction_batch = 1;
+    bool _remove_satisfied = true;
+    // the Data are kept in the entries they satisfy while fresh, at most for that long, 0 for none: the lookup which
+    // would aggregate an Interest answers it then, as the CS in front of the PIT would
+    ndn::time::milliseconds _cache_lifetime{0};
+    size_t _cached_bytes = 0;
+    size_t _cache_hits = 0;
+    // the Data insert answered the last Interest with
+    std::shared_ptr<const ndn::Buffer> _cached;
 
+    // the entries of the Interests without CanBePrefix, a Data finds them by its Name in a single probe
+    NameHashIndex<PitEntry> _exact;
+    // those with CanBePrefix, looked up by every prefix of the Data Name only while there are some
     NamedTree<PitEntry> _tree;
-    std::list<ndn::Name> _list;
-    std::unordered_map<std::string, std::list<ndn::Name>::iterator> _list_index;
+    // CanBePrefix entries by length of their Name
+    std::vector<size_t> _prefix_entries;
+    // by id of the face which created the entries
+    std::unordered_map<size_t, FaceEntries> _by_face;
+    // reused by each get
+    PitEntry::Faces _faces;
+    // the entries by _keep_until, checked again when due since an Interest added to an entry extends it
+    TimerWheel<PitEntry> _expiry;
+    size_t _expired = 0;
+    size_t _satisfied = 0;
+    // the nonces of the entries removed, so that an Interest looping back after them is still dropped
+    DeadNonceList _dead_nonces;
+    size_t _looped = 0;
+    size_t _duplicates = 0;
+    // the faces the entries satisfied lately answered, their late Interests for the same Names are dropped
+    StragglerTable _stragglers;
+    size_t _absorbed = 0;
+    RttStats _rtt;
+    // Nacks for the Interests refused and the entries evicted or expired, so that the consumers give up at once
+    // rather than retransmit blindly once their lifetime is over. limited as they cost an encoding each
+    bool _nack = true;
+    TokenBucket _nack_limiter;
+    size_t _nacked = 0;
+    std::vector<Nack> _nacks;
+
+    void retire(const PitEntry &entry, const ndn::time::steady_clock::time_point &now);
+
+    // the entry keeps data for lifetime if it is positive
+    void satisfy(PitEntry &entry, const NameView &name, size_t egress_face_id, const ndn::time::steady_clock::time_point &now,
+                 const NdnPacket *data, const ndn::time::milliseconds &lifetime);
+
+    // data is null for a Data not to be cached
+    const PitEntry::Faces& get(const NameView &name, size_t egress_face_id, const NdnPacket *data);
+
+    // false if the entry was already removed
+    bool remove(const std::shared_ptr<PitEntry> &entry);
+
+    void countPrefixEntry(const PitEntry &entry, bool added);
+
+    // the bytes of an entry leaving the PIT are given back to its face
+    void release(const PitEntry &entry);
+
+    // slack entries under the size are asked for as well
+    bool isOverLimits(size_t slack = 0) const;
+
+    // the oldest entry of the face using the most bytes, null if there are none. a Nack is queued for it unless it is
+    // except, the entry of the Interest being inserted
+    std::shared_ptr<PitEntry> evictNoisiest(const std::shared_ptr<PitEntry> &except = nullptr);
 
 public:
     explicit Pit(size_t size);
@@ -31,9 +150,132 @@ public:
 
     void setSize(size_t size);
 
-    bool insert(const ndn::Interest &interest, const std::shared_ptr<Face> &face);
+    size_t getMaxBytes() const;
+
+    void setMaxBytes(size_t max_bytes);
+
+    size_t getEvictionBatch() const;
+
+    // 1 evicts an entry per insert past the size, more evict down to size - batch + 1 entries in one pass
+    void setEvictionBatch(size_t batch);
+
+    size_t getFaceQuota() const;
+
+    void setFaceQuota(size_t face_quota);
+
+    bool isRemovingSatisfied() const;
+
+    // false keeps the entries satisfied until they expire, with their faces reset
+    void setRemoveSatisfied(bool remove_satisfied);
+
+    const ndn::time::milliseconds& getCacheLifetime() const;
+
+    // the Data given to get(packet, ...) are kept in the entries they satisfy, for their freshness period but at most
+    // lifetime, and answer the Interests insert finds them for. 0 for none. their bytes count in the max bytes
+    void setCacheLifetime(const ndn::time::milliseconds &lifetime);
+
+    // FORWARD if the Interest must be forwarded. one whose nonce was seen for its Name, in its entry or in the dead
+    // nonce list, is dropped: from another face it looped, from the same face it is a duplicate, as is one from a face
+    // a Data of the Name was sent to within the straggler window. one which would
+    // create an entry over the quota of its face, or whose entry is evicted at once, is refused with CONGESTION. while
+    // caching, one whose entry holds a fresh Data is CACHED
+    Verdict insert(const ndn::Interest &interest, const std::shared_ptr<Face> &face);
+
+    // same with the name_hash of the Interest Name known already, e.g. from the NameView of its packet
+    Verdict insert(const ndn::Interest &interest, const std::shared_ptr<Face> &face, uint64_t name_hash);
+
+    // the face is gone, e.g. a consumer disconnected: it is removed from the entries it created or joined, and those
+    // left waiting for nobody are removed at once rather than once expired. returns how many were removed
+    size_t removeFace(const std::shared_ptr<Face> &face);
+
+    // the exact entry a packet of the Name would look up is brought into the cache, a burst is prefetched as a whole
+    // before its packets are handled one by one
+    void prefetch(const NameView &name) const;
+
+    // the faces of the entries the Data from the egress face answers, valid until the next call. the round trip
+    // time of each entry is recorded
+    const PitEntry::Faces& get(const NameView &name, size_t egress_face_id);
+
+    // same, the Data is kept in the entries it satisfies while caching
+    const PitEntry::Faces& get(const NdnPacket &data, size_t egress_face_id);
+
+    // the Data an Interest was CACHED with, valid until the next insert
+    const std::shared_ptr<const ndn::Buffer>& getCachedData() const;
+
+    // removes the entries whose lifetime is over at now, returns how many were removed. the tree nodes left empty by
+    // the removals since the last call are freed as well
+    size_t removeExpired(const ndn::time::steady_clock::time_point &now);
 
-    std::set<std::shared_ptr<Face>> get(const ndn::Data &data);
+    ndn::time::steady_clock::duration getExpiryTick() const;
+
+    size_t getEntries() const;
+
+    // CanBePrefix entries whose Name has less than length components
+    size_t getPrefixEntriesShorterThan(size_t length) const;
+
+    // of the Interests, the Data cached aside
+    size_t getUsedBytes() const;
+
+    size_t getCachedBytes() const;
+
+    size_t getCacheHits() const;
+
+    size_t getRejected() const;
+
+    size_t getEvicted() const;
+
+    // the usage of each face is added to that in usage, by face id, so that the shards of a router sum up theirs
+    void getFaceUsage(std::unordered_map<size_t, FaceUsage> &usage) const;
+
+    size_t getExpired() const;
+
+    size_t getSatisfied() const;
+
+    size_t getLooped() const;
+
+    size_t getDuplicates() const;
+
+    size_t getDeadNonces() const;
+
+    // Interests dropped within the straggler window
+    size_t getAbsorbed() const;
+
+    const ndn::time::milliseconds& getStragglerWindow() const;
+
+    // 0 forwards the late Interests as new ones
+    void setStragglerWindow(const ndn::time::milliseconds &window);
+
+    const RttStats& getRttStats() const;
+
+    bool isNacking() const;
+
+    void setNacking(bool nack);
+
+    double getNackRate() const;
+
+    // Nacks per second, 0 for no limit
+    void setNackRate(double rate);
+
+    // true if a Nack may be sent now, counted as sent then
+    bool allowNack();
+
+    size_t getNacked() const;
+
+    // the Nacks queued for the entries evicted or expired since the last call, they are moved to nacks
+    void takeNacks(std::vector<Nack> &nacks);
+
+    // prefix length of the RTT by prefix, those measured so far are forgotten
+    void setRttPrefixLength(size_t length);
+
+    const ndn::time::milliseconds& getDeadNonceLifetime() const;
+
+    void setDeadNonceLifetime(const ndn::time::milliseconds &lifetime);
 
     std::string toJSON() const;
+
+    // "pit_exact_records", "pit_tree_nodes" and the like of the indexes, "pit_entries" then the side tables
+    void addMemoryStats(MemoryStats &stats) const;
+
+    // the entries and how the Interests were handled, with labels on each sample
+    void writeMetrics(MetricsWriter &writer, const metrics::Labels &labels) const;
 };
\ No newline at end of file
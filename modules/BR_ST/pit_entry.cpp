@@ -1,55 +1,167 @@
 #include "pit_entry.h"
 
+#include <algorithm>
+
+#include "metrics/memory_stats.h"
+#include "network/coarse_clock.h"
+
 const ndn::time::milliseconds PitEntry::RETRANSMISSION_TIME {250};
 
-PitEntry::PitEntry(const ndn::Interest &interest, const std::shared_ptr<Face> &face)
-        : _keep_until(ndn::time::steady_clock::now() + interest.getInterestLifetime())
-        , _last_update(ndn::time::steady_clock::now()) {
-    _faces.emplace(face);
-    //_nonces.emplace(interest.getNonce());
+PitEntry::PitEntry(const ndn::Interest &interest, const std::shared_ptr<Face> &face, uint64_t name_hash)
+        : _name(NdnPacket::copyName(interest.getName()))
+        , _name_hash(name_hash)
+        , _can_be_prefix(interest.getCanBePrefix())
+        , _face_id(face->getFaceId())
+        , _size(getSize(interest))
+        , _keep_until(coarse_clock::now() + interest.getInterestLifetime())
+        , _last_update(coarse_clock::now())
+        , _forwarded_at(_last_update) {
+    _faces.emplace_back(FaceTable::global().getRef(face));
+    addNonce(interest.getNonce());
 }
 
-const std::set<std::shared_ptr<Face>> PitEntry::getAndResetFaces() {
-    std::set<std::shared_ptr<Face>> faces;
-    for (auto& face : _faces) {
-        if (auto f = face.lock()) {
-            faces.emplace(f);
-        }
+size_t PitEntry::getSize(const ndn::Interest &interest) {
+    const ndn::Name &name = interest.getName();
+    return sizeof(PitEntry) + OVERHEAD + 2 * (name.wireEncode().size() + name.size() * sizeof(ndn::Block));
+}
+
+bool PitEntry::takeFaces(Faces &faces) {
+    if (_faces.empty()) {
+        return false;
     }
+    FaceTable::global().resolve(_faces, faces);
     _faces.clear();
-    return faces;
+    return true;
 }
 
 bool PitEntry::addFace(const ndn::Interest &interest, const std::shared_ptr<Face> &face) {
-    _faces.emplace(face);
-    //_nonces.emplace(interest.getNonce());
-    auto time_point = ndn::time::steady_clock::now();
+    // nothing is pending upstream for an entry kept once satisfied
+    bool was_satisfied = _faces.empty();
+    FaceTable::add(_faces, FaceTable::global().getRef(face));
+    addNonce(interest.getNonce());
+    auto time_point = coarse_clock::now();
     _keep_until = time_point + interest.getInterestLifetime();
-    bool need_retransmission = _last_update + RETRANSMISSION_TIME < time_point;
+    bool need_retransmission = was_satisfied || _last_update + RETRANSMISSION_TIME < time_point;
     _last_update = time_point;
+    if (need_retransmission) {
+        _forwarded_at = time_point;
+    }
     return need_retransmission;
 }
 
+bool PitEntry::delFace(const std::shared_ptr<Face> &face) {
+    auto it = std::find(_faces.begin(), _faces.end(), FaceTable::global().getRef(face));
+    if (it == _faces.end()) {
+        return false;
+    }
+    _faces.erase(it);
+    for (size_t i = _faces.size(); i-- > 0;) {
+        if (!FaceTable::global().resolve(_faces[i])) {
+            _faces.erase(_faces.begin() + i);
+        }
+    }
+    return true;
+}
+
+void PitEntry::addNonce(uint32_t nonce) {
+    _nonces[_next_nonce] = nonce;
+    _next_nonce = (_next_nonce + 1) % MAX_NONCES;
+    if (_nonce_count < MAX_NONCES) {
+        ++_nonce_count;
+    }
+}
+
+bool PitEntry::hasNonce(uint32_t nonce) const {
+    for (size_t i = 0; i < _nonce_count; ++i) {
+        if (_nonces[i] == nonce) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PitEntry::hasFace(const std::shared_ptr<Face> &face) const {
+    return FaceTable::contains(_faces, FaceTable::global().getRef(face));
+}
+
+bool PitEntry::hasFaces() const {
+    return !_faces.empty();
+}
+
+uint32_t PitEntry::getLastNonce() const {
+    return _nonces[(_next_nonce + MAX_NONCES - 1) % MAX_NONCES];
+}
+
+const std::array<uint32_t, PitEntry::MAX_NONCES>& PitEntry::getNonces() const {
+    return _nonces;
+}
+
+size_t PitEntry::getNonceCount() const {
+    return _nonce_count;
+}
+
 bool PitEntry::isValid() const {
-    return _keep_until > ndn::time::steady_clock::now();
+    return _keep_until > coarse_clock::now();
+}
+
+const ndn::Name& PitEntry::getName() const {
+    return _name;
+}
+
+uint64_t PitEntry::getNameHash() const {
+    return _name_hash;
+}
+
+bool PitEntry::canBePrefix() const {
+    return _can_be_prefix;
+}
+
+size_t PitEntry::getFaceId() const {
+    return _face_id;
+}
+
+size_t PitEntry::getSize() const {
+    return _size;
+}
+
+const ndn::time::steady_clock::time_point& PitEntry::getForwardedAt() const {
+    return _forwarded_at;
+}
+
+const ndn::time::steady_clock::time_point& PitEntry::getKeepUntil() const {
+    return _keep_until;
+}
+
+void PitEntry::setData(const std::shared_ptr<const ndn::Buffer> &wire, const ndn::time::steady_clock::time_point &fresh_until) {
+    _data = wire;
+    _fresh_until = fresh_until;
+    _keep_until = std::max(_keep_until, fresh_until);
+}
+
+std::shared_ptr<const ndn::Buffer> PitEntry::getFreshData(const ndn::time::steady_clock::time_point &now) const {
+    return _data && _fresh_until > now ? _data : nullptr;
+}
+
+size_t PitEntry::getDataSize() const {
+    return _data ? _data->size() : 0;
+}
+
+size_t PitEntry::getMemoryUsage() const {
+    return memory_usage::ofShared<PitEntry>() + memory_usage::of(_name) + memory_usage::of(_faces) + getDataSize();
 }
 
 std::string PitEntry::toJSON() {
     std::stringstream ss;
     ss << R"({"faces": [)";
     bool first_face = true;
-    auto it = _faces.cbegin();
-    while (it != _faces.cend()) {
-        if (auto face = it->lock()) {
+    for (const auto &ref : _faces) {
+        if (auto face = FaceTable::global().resolve(ref)) {
             if (first_face) {
                 first_face = false;
             } else {
                 ss << ", ";
             }
             ss << face->getFaceId();
-            ++it;
-        } else {
-            it = _faces.erase(it);
         }
     }
     ss << R"(], "valid_for":)" << ndn::time::duration_cast<ndn::time::milliseconds>(_keep_until - ndn::time::steady_clock::now()).count() << "}";
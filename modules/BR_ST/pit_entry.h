@@ -2,30 +2,117 @@
 
 #include <ndn-cxx/interest.hpp>
 
+#include <array>
+#include <cstdint>
 #include <memory>
-#include <set>
 
 #include "network/face.h"
+#include "network/face_table.h"
 
 class PitEntry {
+public:
+    // the most recent nonces are kept, an older one replaced by a newer is forgotten
+    static const size_t MAX_NONCES = 4;
+
+    using Faces = FaceTable::Faces;
+
+    // memory held besides the Name and its component Blocks, kept twice with the copy in the table: the shared_ptr
+    // control block, the record or the tree nodes and the slots of the table
+    static const size_t OVERHEAD = 192;
+
 private:
     static const ndn::time::milliseconds RETRANSMISSION_TIME;
 
-    std::set<std::weak_ptr<Face>, std::owner_less<std::weak_ptr<Face>>> _faces;
-    //std::set<uint32_t > _nonces;
+    // kept to remove the entry from the tree once it expires
+    const ndn::Name _name;
+    const uint64_t _name_hash;
+    const bool _can_be_prefix;
+    // the face which created the entry, charged with its size
+    const size_t _face_id;
+    const size_t _size;
+    // resolved through FaceTable::global(), the faces gone meanwhile are skipped
+    FaceTable::Refs _faces;
+    // inline ring, nothing is allocated for them
+    std::array<uint32_t, MAX_NONCES> _nonces;
+    uint8_t _nonce_count = 0;
+    uint8_t _next_nonce = 0;
     ndn::time::steady_clock::time_point _keep_until;
     ndn::time::steady_clock::time_point _last_update;
+    // the round trip time of the Data is measured from there
+    ndn::time::steady_clock::time_point _forwarded_at;
+    // the Data which satisfied the entry when the PIT caches them, see Pit::setCacheLifetime
+    std::shared_ptr<const ndn::Buffer> _data;
+    ndn::time::steady_clock::time_point _fresh_until;
+
+    void addNonce(uint32_t nonce);
 
 public:
-    PitEntry(const ndn::Interest &interest, const std::shared_ptr<Face> &face);
+    // name_hash is the name_hash of the Interest Name
+    PitEntry(const ndn::Interest &interest, const std::shared_ptr<Face> &face, uint64_t name_hash);
 
     ~PitEntry() = default;
 
-    const std::set<std::shared_ptr<Face>> getAndResetFaces();
+    // estimate of the bytes the entry of the Interest uses, known before it is created
+    static size_t getSize(const ndn::Interest &interest);
+
+    // the faces still alive are appended to faces unless already there, the entry keeps none. false if it had none
+    // left, e.g. satisfied already
+    bool takeFaces(Faces &faces);
 
+    // true if the Interest must be forwarded again, as it is once the entry was satisfied. its nonce must not be in
+    // the entry already
     bool addFace(const ndn::Interest &interest, const std::shared_ptr<Face> &face);
 
+    // the face is forgotten along with those gone already, false if the entry didn't have it
+    bool delFace(const std::shared_ptr<Face> &face);
+
+    // an Interest with a nonce already seen is either a duplicate from the same face or a loop
+    bool hasNonce(uint32_t nonce) const;
+
+    bool hasFace(const std::shared_ptr<Face> &face) const;
+
+    // false once satisfied
+    bool hasFaces() const;
+
+    // the nonce of the last Interest added
+    uint32_t getLastNonce() const;
+
+    // the first getNonceCount() are valid
+    const std::array<uint32_t, MAX_NONCES>& getNonces() const;
+
+    size_t getNonceCount() const;
+
     bool isValid() const;
 
+    const ndn::Name& getName() const;
+
+    uint64_t getNameHash() const;
+
+    // only a Data with the same Name satisfies the entry otherwise
+    bool canBePrefix() const;
+
+    size_t getFaceId() const;
+
+    // as given by getSize(interest) for the Interest which created the entry
+    size_t getSize() const;
+
+    // when the entry was created or last retransmitted
+    const ndn::time::steady_clock::time_point& getForwardedAt() const;
+
+    // extended by each Interest added, the entry expires once it is passed
+    const ndn::time::steady_clock::time_point& getKeepUntil() const;
+
+    // wire is answered to the Interests for the entry until fresh_until, which it is kept until at least
+    void setData(const std::shared_ptr<const ndn::Buffer> &wire, const ndn::time::steady_clock::time_point &fresh_until);
+
+    // null unless the Data held is still fresh at now
+    std::shared_ptr<const ndn::Buffer> getFreshData(const ndn::time::steady_clock::time_point &now) const;
+
+    // of the Data held, fresh or not, 0 for none
+    size_t getDataSize() const;
+
+    // the bytes the entry actually holds, by the layout of its members rather than the estimate of getSize
+    size_t getMemoryUsage() const;
+
     std::string toJSON();
 };
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "pit_shard.h"
+
+#include <boost/bind.hpp>
+
+#include "log/probes.h"
+#include "metrics/stage_profile.h"
+#include "network/coarse_clock.h"
+
+PitShard::PitShard(boost::asio::io_service &module_ios, bool threaded, size_t size, size_t short_prefix_length)
+        : _own_ios(threaded ? new boost::asio::io_service(1) : nullptr)
+        , _own_ios_work(threaded ? new boost::asio::io_service::work(*_own_ios) : nullptr)
+        , _ios(threaded ? *_own_ios : module_ios)
+        , _pit(size)
+        , _short_prefix_length(short_prefix_length)
+        , _short_prefix_entries(0)
+        , _short_interests_queued(0)
+        , _inbox(INBOX_SIZE)
+        , _fair_queue(FAIR_QUANTUM)
+        , _is_draining(false)
+        , _expiry_timer(_ios) {
+
+}
+
+PitShard::~PitShard() {
+    if (_thread) {
+        _own_ios->stop();
+        _thread->join();
+    }
+}
+
+void PitShard::start() {
+    if (_own_ios) {
+        _thread.reset(new boost::thread(boost::bind(&boost::asio::io_service::run, _own_ios.get())));
+    }
+    _ios.post(boost::bind(&PitShard::removeExpired, this, boost::system::error_code()));
+}
+
+void PitShard::submit(const std::shared_ptr<Face> &face, NdnPacket packet) {
+    if (isShortInterest(packet)) {
+        ++_short_interests_queued;
+    }
+    if (!_thread) {
+        process(face, packet);
+        return;
+    }
+    if (!_inbox.emplace(face, std::move(packet))) {
+        // the inbox only absorbs bursts between two drains
+        _ios.post(boost::bind(&PitShard::process, this, face, packet));
+        return;
+    }
+    if (!_is_draining.exchange(true)) {
+        _ios.post(boost::bind(&PitShard::drainInbox, this));
+    }
+}
+
+void PitShard::submit(const std::shared_ptr<Face> &face, const std::vector<NdnPacket> &packets) {
+    if (_thread) {
+        // batched again by drainInbox
+        for (const auto &packet : packets) {
+            submit(face, packet);
+        }
+        return;
+    }
+    for (const auto &packet : packets) {
+        if (isShortInterest(packet)) {
+            ++_short_interests_queued;
+        }
+        _batch.emplace_back(face, packet);
+        if (_batch.size() == BATCH_SIZE) {
+            processBatch();
+        }
+    }
+    processBatch();
+}
+
+void PitShard::setEgressFaces(const std::vector<std::shared_ptr<Face>> &faces) {
+    if (!_thread) {
+        _egress_faces = faces;
+        return;
+    }
+    _ios.post([this, faces]() {
+        _egress_faces = faces;
+    });
+}
+
+size_t PitShard::getShortPrefixEntries() const {
+    return _short_prefix_entries.load(std::memory_order_relaxed) + _short_interests_queued.load(std::memory_order_relaxed);
+}
+
+bool PitShard::isShortInterest(const NdnPacket &packet) const {
+    return packet.getType() == NdnPacket::INTEREST && packet.getNameView().size() < _short_prefix_length;
+}
+
+void PitShard::process(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    stage_profile::Scope stage(stage_profile::TABLE);
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST: {
+            // decoded here, on the shard thread
+            Pit::Verdict verdict = _pit.insert(packet.getInterest(), face, packet.getNameView().getHash());
+            NDNMS_PROBE3(pit_insert, packet.getNameView().getHash(), face->getFaceId(), verdict);
+            switch (verdict) {
+                case Pit::FORWARD:
+                    for (const auto &egress_face : _egress_faces) {
+                        egress_face->send(packet);
+                    }
+                    break;
+                case Pit::CONGESTION:
+                    nack(face, packet, LpLink::CONGESTION);
+                    break;
+                case Pit::TOO_SHORT:
+                    // it would expire before any Data comes back through the router
+                    nack(face, packet, LpLink::NO_ROUTE);
+                    break;
+                default:
+                    break;
+            }
+            // the entries evicted to make room for it
+            sendNacks();
+            break;
+        }
+        case NdnPacket::DATA:
+            for (const auto &ingress_face : _pit.get(packet.getNameView(), face->getFaceId())) {
+                ingress_face->send(packet);
+            }
+            break;
+        default:
+            break;
+    }
+    _short_prefix_entries.store(_pit.getPrefixEntriesShorterThan(_short_prefix_length), std::memory_order_relaxed);
+    if (isShortInterest(packet)) {
+        --_short_interests_queued;
+    }
+}
+
+void PitShard::processBatch() {
+    // a single clock read for the whole batch
+    coarse_clock::Scope scope;
+    for (const auto &request : _batch) {
+        if (request.packet.getType() != NdnPacket::UNKNOWN) {
+            _pit.prefetch(request.packet.getNameView());
+        }
+    }
+    for (const auto &request : _batch) {
+        process(request.face, request.packet);
+    }
+    _batch.clear();
+}
+
+void PitShard::drainInbox() {
+    for (;;) {
+        while (Request *request = _inbox.peek(0)) {
+            size_t face_id = request->face->getFaceId();
+            _fair_queue.push(face_id, std::move(*request));
+            _inbox.pop();
+        }
+        if (!_fair_queue.empty()) {
+            _fair_queue.round([this](Request &&request) {
+                _batch.emplace_back(std::move(request));
+                if (_batch.size() == BATCH_SIZE) {
+                    processBatch();
+                }
+            });
+            processBatch();
+            continue;
+        }
+        // a producer may have pushed after the last peek but seen the inbox as still being drained
+        _is_draining = false;
+        if (!_inbox.peek(0) || _is_draining.exchange(true)) {
+            return;
+        }
+    }
+}
+
+void PitShard::nack(const std::shared_ptr<Face> &face, const NdnPacket &packet, LpLink::NackReason reason) {
+    if (_pit.allowNack()) {
+        stage_profile::Scope stage(stage_profile::ENCODE);
+        const ndn::Block &block = packet.getBlock();
+        face->send(LpLink::nack(block.wire(), block.size(), reason));
+    }
+}
+
+void PitShard::sendNacks() {
+    _pit.takeNacks(_nacks);
+    for (const auto &nack : _nacks) {
+        _nack_faces.clear();
+        if (!nack.entry->takeFaces(_nack_faces)) {
+            continue;
+        }
+        std::shared_ptr<const ndn::Buffer> wire;
+        {
+            stage_profile::Scope stage(stage_profile::ENCODE);
+            ndn::Interest interest(nack.entry->getName());
+            interest.setCanBePrefix(nack.entry->canBePrefix());
+            interest.setNonce(nack.entry->getLastNonce());
+            const ndn::Block &block = interest.wireEncode();
+            wire = LpLink::nack(block.wire(), block.size(), nack.reason);
+        }
+        for (const auto &face : _nack_faces) {
+            face->send(wire);
+        }
+    }
+    _nacks.clear();
+}
+
+void PitShard::removeExpired(const boost::system::error_code &err) {
+    // a few ticks of the wheel at once, an entry outlives its lifetime by this delay at most
+    static const boost::posix_time::milliseconds DELAY_BETWEEN_EXPIRIES(50);
+
+    if (err) {
+        return;
+    }
+    _pit.removeExpired(ndn::time::steady_clock::now());
+    sendNacks();
+    _short_prefix_entries.store(_pit.getPrefixEntriesShorterThan(_short_prefix_length), std::memory_order_relaxed);
+    _expiry_timer.expires_from_now(DELAY_BETWEEN_EXPIRIES);
+    _expiry_timer.async_wait(boost::bind(&PitShard::removeExpired, this, _1));
+}
\ No newline at end of file
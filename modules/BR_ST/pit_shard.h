@@ -0,0 +1,127 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "pit.h"
+#include "network/face.h"
+#include "network/fair_queue.h"
+#include "network/mpsc_queue.h"
+#include "network/ndn_packet.h"
+
+// one Pit of the backward router and the thread it runs on, the router spreads the Names over its shards by name_hash
+// so that the Interests and the Data of a Name always meet in the same shard and are aggregated as with a single PIT.
+// packets are handed over through a lock-free inbox and the shard sends them on by itself, the Interests to its own
+// copy of the egress faces and the Data to the faces of the entries. a shard created without a thread of its own runs
+// on the module io_service and handles the packets at once
+class PitShard {
+private:
+    static const size_t INBOX_SIZE = 4096;
+    // packets taken out of the inbox at once, their entries are prefetched together
+    static const size_t BATCH_SIZE = 32;
+    // packets of each face handled by a round of drainInbox, a consumer flooding the shard delays the others by that
+    static const size_t FAIR_QUANTUM = 8;
+
+    struct Request {
+        std::shared_ptr<Face> face;
+        NdnPacket packet;
+
+        Request(const std::shared_ptr<Face> &face, NdnPacket packet) : face(face), packet(std::move(packet)) {
+
+        }
+    };
+
+    std::unique_ptr<boost::asio::io_service> _own_ios;
+    std::unique_ptr<boost::asio::io_service::work> _own_ios_work;
+    boost::asio::io_service &_ios;
+    std::unique_ptr<boost::thread> _thread;
+
+    Pit _pit;
+    // as set by the module thread, only read on the shard thread
+    std::vector<std::shared_ptr<Face>> _egress_faces;
+    const size_t _short_prefix_length;
+    // published after each packet for the router, which sends the Data to this shard as well while there are some.
+    // the short Interests not processed yet are counted too, a Data right behind one of them isn't missed
+    std::atomic<size_t> _short_prefix_entries;
+    std::atomic<size_t> _short_interests_queued;
+
+    bool isShortInterest(const NdnPacket &packet) const;
+
+    // reused by each batch
+    std::vector<Request> _batch;
+    // reused by each sendNacks
+    std::vector<Pit::Nack> _nacks;
+    PitEntry::Faces _nack_faces;
+
+    MpscQueue<Request> _inbox;
+    // the packets taken out of the inbox, by face
+    FairQueue<Request> _fair_queue;
+    std::atomic<bool> _is_draining;
+    boost::asio::deadline_timer _expiry_timer;
+
+    void process(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+
+    // the entries of the whole batch are prefetched, then its packets are processed in order
+    void processBatch();
+
+    // the inbox is moved to the fair queue before each of its rounds, a packet of a quiet face is handled by the next
+    // round whatever the faces ahead of it in the inbox queued
+    void drainInbox();
+
+    // the Interest refused is sent back to face in a Nack
+    void nack(const std::shared_ptr<Face> &face, const NdnPacket &packet, LpLink::NackReason reason);
+
+    // the faces of the entries the Pit queued Nacks for get the Interest back in them, encoded again from the entry
+    // as its wire isn't kept
+    void sendNacks();
+
+    void removeExpired(const boost::system::error_code &err);
+
+public:
+    // short_prefix_length is the number of components the router hashes, the CanBePrefix entries shorter than that
+    // can be reached by the Data of other shards
+    PitShard(boost::asio::io_service &module_ios, bool threaded, size_t size, size_t short_prefix_length);
+
+    PitShard(const PitShard&) = delete;
+
+    PitShard& operator=(const PitShard&) = delete;
+
+    ~PitShard();
+
+    void start();
+
+    // an Interest from an ingress face or a Data from an egress face, from any thread. the packet is moved into the
+    // inbox, a caller done with it hands it over with std::move
+    void submit(const std::shared_ptr<Face> &face, NdnPacket packet);
+
+    // a read burst of a face, handled as a batch at once without a thread of its own
+    void submit(const std::shared_ptr<Face> &face, const std::vector<NdnPacket> &packets);
+
+    // the faces the Interests are forwarded to from now on, from any thread
+    void setEgressFaces(const std::vector<std::shared_ptr<Face>> &faces);
+
+    size_t getShortPrefixEntries() const;
+
+    // runs f(Pit&) on the shard thread and waits for its result, for the commands
+    template <class F>
+    auto call(const F &f) -> decltype(f(std::declval<Pit&>())) {
+        using Result = decltype(f(std::declval<Pit&>()));
+        if (!_thread) {
+            return f(_pit);
+        }
+        auto task = std::make_shared<std::packaged_task<Result()>>([this, &f]() {
+            return f(_pit);
+        });
+        auto result = task->get_future();
+        _ios.post([task]() {
+            (*task)();
+        });
+        return result.get();
+    }
+};
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "rtt_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <tuple>
+
+#include "metrics/memory_stats.h"
+
+void RttStats::Estimator::record(uint64_t rtt) {
+    // alpha = 1/8 and beta = 1/4, the first sample sets both
+    double sample = static_cast<double>(rtt);
+    if (samples == 0) {
+        srtt = sample;
+        rttvar = sample / 2;
+    } else {
+        rttvar = 0.75 * rttvar + 0.25 * std::abs(srtt - sample);
+        srtt = 0.875 * srtt + 0.125 * sample;
+    }
+    ++samples;
+    histogram.record(rtt);
+}
+
+void RttStats::Estimator::add(const Estimator &other) {
+    if (other.samples == 0) {
+        return;
+    }
+    double total = static_cast<double>(samples + other.samples);
+    srtt = (srtt * samples + other.srtt * other.samples) / total;
+    rttvar = (rttvar * samples + other.rttvar * other.samples) / total;
+    samples += other.samples;
+    histogram.add(other.histogram);
+}
+
+std::string RttStats::Estimator::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"srtt_us":)" << static_cast<uint64_t>(srtt) << R"(, "rttvar_us":)" << static_cast<uint64_t>(rttvar)
+       << R"(, "samples":)" << samples << R"(, "histogram":)" << histogram.toJSON() << "}";
+    return ss.str();
+}
+
+RttStats::RttStats(size_t prefix_length, size_t max_prefixes)
+        : _prefix_length(prefix_length)
+        , _max_prefixes(max_prefixes) {
+
+}
+
+size_t RttStats::getPrefixLength() const {
+    return _prefix_length;
+}
+
+void RttStats::setPrefixLength(size_t prefix_length) {
+    _prefix_length = prefix_length;
+    _prefixes.clear();
+    _untracked = 0;
+}
+
+void RttStats::record(size_t face_id, const NameView &name, const ndn::time::steady_clock::duration &rtt) {
+    auto microseconds = static_cast<uint64_t>(std::max<int64_t>(ndn::time::duration_cast<ndn::time::microseconds>(rtt).count(), 0));
+    _faces[face_id].record(microseconds);
+    size_t length = std::min(_prefix_length, name.size());
+    uint64_t hash = name.getPrefixHash(length);
+    auto it = _prefixes.find(hash);
+    if (it == _prefixes.end()) {
+        if (_prefixes.size() >= _max_prefixes) {
+            ++_untracked;
+            return;
+        }
+        it = _prefixes.emplace(std::piecewise_construct, std::forward_as_tuple(hash), std::forward_as_tuple()).first;
+        it->second.prefix = name.toName().getPrefix(length);
+    }
+    it->second.estimator.record(microseconds);
+}
+
+void RttStats::add(const RttStats &other) {
+    for (const auto &face : other._faces) {
+        _faces[face.first].add(face.second);
+    }
+    for (const auto &prefix : other._prefixes) {
+        auto it = _prefixes.find(prefix.first);
+        if (it == _prefixes.end()) {
+            it = _prefixes.emplace(std::piecewise_construct, std::forward_as_tuple(prefix.first), std::forward_as_tuple()).first;
+            it->second.prefix = prefix.second.prefix;
+        }
+        it->second.estimator.add(prefix.second.estimator);
+    }
+    _untracked += other._untracked;
+}
+
+std::string RttStats::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"faces":[)";
+    bool first = true;
+    for (const auto &face : _faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << R"({"face_id":)" << face.first << R"(, "rtt":)" << face.second.toJSON() << "}";
+    }
+    ss << R"(], "prefixes":[)";
+    first = true;
+    for (const auto &prefix : _prefixes) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << R"({"prefix":")" << prefix.second.prefix.toUri() << R"(", "rtt":)" << prefix.second.estimator.toJSON() << "}";
+    }
+    ss << R"(], "untracked":)" << _untracked << "}";
+    return ss.str();
+}
+
+size_t RttStats::getMemoryUsage() const {
+    size_t bytes = memory_usage::of(_faces) + memory_usage::of(_prefixes);
+    for (const auto &prefix : _prefixes) {
+        bytes += memory_usage::of(prefix.second.prefix);
+    }
+    return bytes;
+}
\ No newline at end of file
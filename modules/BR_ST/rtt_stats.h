@@ -0,0 +1,70 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "network/face_stats.h"
+#include "network/name_view.h"
+
+// round trip times of the Interests satisfied, from the last time the entry was forwarded to the Data answering it,
+// by egress face and by prefix of the Data Name. each gets a smoothed RTT and its variation as TCP computes them
+// (RFC 6298) and a histogram. only the first max_prefixes prefixes met are followed, memory doesn't grow with the
+// number of Names
+class RttStats {
+public:
+    static const size_t DEFAULT_PREFIX_LENGTH = 2;
+    static const size_t DEFAULT_MAX_PREFIXES = 64;
+
+    struct Estimator {
+        // in microseconds
+        double srtt = 0;
+        double rttvar = 0;
+        size_t samples = 0;
+        LatencyHistogram histogram;
+
+        void record(uint64_t rtt);
+
+        // other is folded in as if its samples were recorded here, the smoothed values are weighted by samples
+        void add(const Estimator &other);
+
+        std::string toJSON() const;
+    };
+
+private:
+    struct PrefixEstimator {
+        ndn::Name prefix;
+        Estimator estimator;
+    };
+
+    size_t _prefix_length;
+    size_t _max_prefixes;
+    // by face id
+    std::unordered_map<size_t, Estimator> _faces;
+    // by name_hash of the prefix
+    std::unordered_map<uint64_t, PrefixEstimator> _prefixes;
+    // samples of the prefixes not followed
+    size_t _untracked = 0;
+
+public:
+    explicit RttStats(size_t prefix_length = DEFAULT_PREFIX_LENGTH, size_t max_prefixes = DEFAULT_MAX_PREFIXES);
+
+    size_t getPrefixLength() const;
+
+    // the prefixes followed so far are forgotten
+    void setPrefixLength(size_t prefix_length);
+
+    void record(size_t face_id, const NameView &name, const ndn::time::steady_clock::duration &rtt);
+
+    // the estimators of other are folded into those here, for the shards of a router
+    void add(const RttStats &other);
+
+    // {"faces": [{"face_id", ...}], "prefixes": [{"prefix", ...}], "untracked"}
+    std::string toJSON() const;
+
+    // the estimators by face and by prefix, with the prefixes
+    size_t getMemoryUsage() const;
+};
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "straggler_table.h"
+
+#include <algorithm>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+
+const ndn::time::milliseconds StragglerTable::DEFAULT_WINDOW {100};
+
+StragglerTable::StragglerTable(size_t capacity, const ndn::time::milliseconds &window) : _window(window) {
+    size_t buckets = 1;
+    while (buckets * WAYS < capacity) {
+        buckets *= 2;
+    }
+    _mask = buckets - 1;
+    _slots.resize(buckets * WAYS);
+}
+
+uint64_t StragglerTable::key(uint64_t name_hash, size_t face_id) {
+    // 0 marks the free slots
+    return name_hash::mix(name_hash, face_id) | 1;
+}
+
+const ndn::time::milliseconds& StragglerTable::getWindow() const {
+    return _window;
+}
+
+void StragglerTable::setWindow(const ndn::time::milliseconds &window) {
+    _window = window;
+    std::fill(_slots.begin(), _slots.end(), Slot());
+}
+
+void StragglerTable::add(uint64_t name_hash, size_t face_id, const ndn::time::steady_clock::time_point &now) {
+    if (_window.count() == 0) {
+        return;
+    }
+    uint64_t k = key(name_hash, face_id);
+    Slot *bucket = &_slots[(k & _mask) * WAYS];
+    Slot *victim = bucket;
+    for (size_t i = 0; i < WAYS; ++i) {
+        if (bucket[i].key == k) {
+            victim = &bucket[i];
+            break;
+        } else if (bucket[i].expire_time < victim->expire_time) {
+            victim = &bucket[i];
+        }
+    }
+    victim->key = k;
+    victim->expire_time = now + _window;
+}
+
+bool StragglerTable::contains(uint64_t name_hash, size_t face_id, const ndn::time::steady_clock::time_point &now) const {
+    if (_window.count() == 0) {
+        return false;
+    }
+    uint64_t k = key(name_hash, face_id);
+    const Slot *bucket = &_slots[(k & _mask) * WAYS];
+    for (size_t i = 0; i < WAYS; ++i) {
+        if (bucket[i].key == k) {
+            return bucket[i].expire_time > now;
+        }
+    }
+    return false;
+}
+
+size_t StragglerTable::getCapacity() const {
+    return _slots.size();
+}
+
+size_t StragglerTable::getMemoryUsage() const {
+    return memory_usage::of(_slots);
+}
\ No newline at end of file
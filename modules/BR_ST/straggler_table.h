@@ -0,0 +1,51 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// the faces a Data was just sent to, by (name_hash, face id), for a short window once their PIT entry was satisfied:
+// an Interest for the Name from one of them meanwhile, a copy of a multicast Interest with another nonce or a
+// retransmission crossing the Data, is absorbed rather than sent upstream again. buckets of WAYS (key, expiry) slots
+// allocated at once, a full bucket gives up the slot expiring first: a straggler forgotten that way is only forwarded
+// as it was before
+class StragglerTable {
+public:
+    static const size_t DEFAULT_CAPACITY = 16384;
+    // shorter than any retransmission timer of a consumer, a Data lost downstream is still asked for again
+    static const ndn::time::milliseconds DEFAULT_WINDOW;
+
+private:
+    static const size_t WAYS = 4;
+
+    struct Slot {
+        // 0 for a free slot
+        uint64_t key = 0;
+        ndn::time::steady_clock::time_point expire_time;
+    };
+
+    std::vector<Slot> _slots;
+    // buckets - 1, a power of 2 minus 1
+    size_t _mask = 0;
+    ndn::time::milliseconds _window;
+
+    static uint64_t key(uint64_t name_hash, size_t face_id);
+
+public:
+    explicit StragglerTable(size_t capacity = DEFAULT_CAPACITY, const ndn::time::milliseconds &window = DEFAULT_WINDOW);
+
+    const ndn::time::milliseconds& getWindow() const;
+
+    // 0 absorbs nothing, the faces remembered so far are forgotten
+    void setWindow(const ndn::time::milliseconds &window);
+
+    // the Data of the Name was sent to the face at now
+    void add(uint64_t name_hash, size_t face_id, const ndn::time::steady_clock::time_point &now);
+
+    bool contains(uint64_t name_hash, size_t face_id, const ndn::time::steady_clock::time_point &now) const;
+
+    size_t getCapacity() const;
+
+    size_t getMemoryUsage() const;
+};
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "admission_policy.h"
+
+#include <algorithm>
+#include <random>
+
+#include "cache_policy.h"
+
+class AlwaysAdmission : public AdmissionPolicy {
+public:
+    std::string getName() const override {
+        return "always";
+    }
+
+    bool admit(uint64_t hash, size_t size) override {
+        return true;
+    }
+};
+
+// only the Data whose Name was missed at least twice lately, content requested once never enters the cache. the
+// misses are counted by a frequency sketch, which forgets them over time
+class SecondRequestAdmission : public AdmissionPolicy {
+private:
+    FrequencySketch _misses;
+
+public:
+    explicit SecondRequestAdmission(size_t capacity) : _misses(capacity) {
+
+    }
+
+    std::string getName() const override {
+        return "second_request";
+    }
+
+    bool admit(uint64_t hash, size_t size) override {
+        return _misses.estimate(hash) >= 2;
+    }
+
+    void onMiss(uint64_t hash) override {
+        _misses.increment(hash);
+    }
+
+    size_t getMemoryUsage() const override {
+        return _misses.getMemoryUsage();
+    }
+};
+
+// each Data with the same probability, popular content gets in after a few requests and one-shot content rarely does
+class ProbabilisticAdmission : public AdmissionPolicy {
+private:
+    std::bernoulli_distribution _distribution;
+    std::minstd_rand _generator;
+
+public:
+    explicit ProbabilisticAdmission(double probability) : _distribution(probability), _generator(std::random_device()()) {
+
+    }
+
+    std::string getName() const override {
+        return "probabilistic";
+    }
+
+    bool admit(uint64_t hash, size_t size) override {
+        return _distribution(_generator);
+    }
+};
+
+// the Data up to a size, larger ones would evict several smaller ones
+class SizeAdmission : public AdmissionPolicy {
+private:
+    const size_t _max_size;
+
+public:
+    explicit SizeAdmission(size_t max_size) : _max_size(max_size) {
+
+    }
+
+    std::string getName() const override {
+        return "size";
+    }
+
+    bool admit(uint64_t hash, size_t size) override {
+        return size <= _max_size;
+    }
+};
+
+std::unique_ptr<AdmissionPolicy> AdmissionPolicy::create(const std::string &policy, size_t capacity, const Parameters &parameters) {
+    if (policy == "always") {
+        return std::unique_ptr<AdmissionPolicy>(new AlwaysAdmission());
+    } else if (policy == "second_request") {
+        return std::unique_ptr<AdmissionPolicy>(new SecondRequestAdmission(capacity));
+    } else if (policy == "probabilistic") {
+        return std::unique_ptr<AdmissionPolicy>(new ProbabilisticAdmission(std::min(std::max(parameters.probability, 0.0), 1.0)));
+    } else if (policy == "size") {
+        return std::unique_ptr<AdmissionPolicy>(new SizeAdmission(parameters.max_size));
+    }
+    return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// which Data enters the content store at all, those refused don't evict anything. a Data whose Name is already
+// cached is always admitted, its former version is replaced
+class AdmissionPolicy {
+public:
+    struct Parameters {
+        // of probabilistic
+        double probability = 0.1;
+        // of size, on the Data wire
+        size_t max_size = 4096;
+    };
+
+    virtual ~AdmissionPolicy() = default;
+
+    // "always", "second_request", "probabilistic" or "size", null if the policy is unknown. capacity is the number
+    // of entries of the cache
+    static std::unique_ptr<AdmissionPolicy> create(const std::string &policy, size_t capacity, const Parameters &parameters);
+
+    virtual std::string getName() const = 0;
+
+    // hash is the name_hash of the Data Name, size the length of its wire
+    virtual bool admit(uint64_t hash, size_t size) = 0;
+
+    // a lookup which found nothing, hash is the name_hash of the Interest Name
+    virtual void onMiss(uint64_t hash) {
+
+    }
+
+    // bytes held by the policy, e.g. by its sketch
+    virtual size_t getMemoryUsage() const {
+        return 0;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+// insert, hit, miss, eviction and expiry in LruCache with each of its policies, with the heap an entry takes
+// besides its Data. the Data have 100 bytes of payload
+// usage: cache_bench [entries...]
+
+#include <thread>
+
+#include "lru_cache.h"
+#include "bench/bench.h"
+
+static const char *POLICIES[] = {"lru", "slru", "arc", "tinylfu"};
+
+static std::vector<ndn::Block> makeData(const std::vector<ndn::Name> &names, uint16_t freshness) {
+    std::vector<ndn::Block> data;
+    data.reserve(names.size());
+    for (const auto &name : names) {
+        data.emplace_back(bench::makeData(name, freshness, 100));
+    }
+    return data;
+}
+
+static std::vector<ndn::Block> makeInterests(const std::vector<ndn::Name> &names) {
+    std::vector<ndn::Block> interests;
+    interests.reserve(names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        interests.emplace_back(bench::makeInterest(names[i], static_cast<uint32_t>(i)).wireEncode());
+    }
+    return interests;
+}
+
+static void run(const char *policy, size_t entries) {
+    auto names = bench::makeNames(entries);
+    auto others = bench::makeNames(entries, entries);
+    auto order = bench::makeOrder(entries);
+    auto data = bench::toPackets(makeData(names, 60000));
+    auto other_data = bench::toPackets(makeData(others, 60000));
+    auto interests = bench::toPackets(makeInterests(names));
+    auto misses = bench::toPackets(makeInterests(others));
+    std::string table = std::string("LruCache ") + policy;
+
+    size_t before = bench::getHeapBytes();
+    std::unique_ptr<LruCache> cache(new LruCache(entries, 0, policy));
+    bench::measure(table.c_str(), "insert", entries, entries, [&](size_t i) {
+        cache->insert(data[i]);
+    });
+    bench::printMemory(table.c_str(), entries, bench::getHeapBytes() - before);
+    bench::measure(table.c_str(), "hit", entries, entries, [&](size_t i) {
+        cache->get(interests[order[i]].getNameView());
+    });
+    bench::measure(table.c_str(), "miss", entries, entries, [&](size_t i) {
+        cache->get(misses[order[i]].getNameView());
+    });
+    // each Data of another Name takes the place of one already cached
+    bench::measure(table.c_str(), "evict", entries, entries, [&](size_t i) {
+        cache->insert(other_data[i]);
+    });
+    cache.reset();
+
+    auto stale_data = bench::toPackets(makeData(names, 1));
+    cache.reset(new LruCache(entries, 0, policy));
+    for (const auto &packet : stale_data) {
+        cache->insert(packet);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    bench::measureBatch(table.c_str(), "expire", entries, entries, [&]() {
+        cache->removeExpired(entries);
+    });
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t entries : bench::getSizes(argc, argv)) {
+        for (const char *policy : POLICIES) {
+            run(policy, entries);
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -1,19 +1,206 @@
 #include "cache_entry.h"
 
-CacheEntry::CacheEntry(const ndn::Data &data)
-        : _data(data)
-        , expire_time_point(ndn::time::steady_clock::now() + data.getFreshnessPeriod()) {
+#include <ndn-cxx/util/sha256.hpp>
 
+#include <cstring>
+
+#include "metrics/memory_stats.h"
+#include "lz4_codec.h"
+#include "network/buffer_pool.h"
+#include "network/coarse_clock.h"
+#include "network/tlv_reader.h"
+
+CacheEntry::CacheEntry(const NdnPacket &packet, ContentIndex *contents)
+        : _name(NdnPacket::copyName(packet.getName()))
+        , _wire(packet.getWire())
+        , expire_time_point(coarse_clock::now() + packet.getFreshnessPeriod())
+        , _size(sizeof(CacheEntry) + OVERHEAD + _wire->size() + _name.wireEncode().size() + _name.size() * sizeof(ndn::Block))
+        , _last_access(coarse_clock::now()) {
+    if (contents) {
+        shareContent(*contents);
+    }
+    keepVerifiedTag(packet);
+}
+
+CacheEntry::CacheEntry(const NdnPacket &packet, const ndn::time::steady_clock::time_point &expire_time, ContentIndex *contents)
+        : _name(NdnPacket::copyName(packet.getName()))
+        , _wire(packet.getWire())
+        , expire_time_point(expire_time)
+        , _size(sizeof(CacheEntry) + OVERHEAD + _wire->size() + _name.wireEncode().size() + _name.size() * sizeof(ndn::Block))
+        , _last_access(coarse_clock::now()) {
+    if (contents) {
+        shareContent(*contents);
+    }
+    keepVerifiedTag(packet);
+}
+
+void CacheEntry::keepVerifiedTag(const NdnPacket &packet) {
+    LpLink::VerifiedTag tag;
+    if (packet.getLpPacket() && LpLink::readVerified(packet.getLpPacket(), packet.getLpPacketSize(), tag)) {
+        _verified_tag.reset(new LpLink::VerifiedTag(tag));
+    }
+}
+
+const LpLink::VerifiedTag* CacheEntry::getVerifiedTag() const {
+    return _verified_tag.get();
+}
+
+void CacheEntry::shareContent(ContentIndex &contents) {
+    const uint8_t *begin = _wire->data();
+    const uint8_t *end = begin + _wire->size();
+    const uint8_t *it = begin;
+    uint32_t type;
+    try {
+        size_t length = tlv_reader::readHeader(it, end, type);
+        end = it + length;
+        // Name, MetaInfo, then Content
+        while (it != end) {
+            const uint8_t *element = it;
+            length = tlv_reader::readHeader(it, end, type);
+            it += length;
+            if (type == ndn::tlv::Content) {
+                if (static_cast<size_t>(it - element) < ContentIndex::MIN_CONTENT_SIZE) {
+                    return;
+                }
+                _content = contents.share(element, it - element);
+                _content_offset = element - begin;
+                auto rest = std::make_shared<ndn::Buffer>(begin, element);
+                rest->insert(rest->end(), it, begin + _wire->size());
+                _wire = std::move(rest);
+                _size -= _content->size();
+                return;
+            }
+            if (type != ndn::tlv::Name && type != ndn::tlv::MetaInfo) {
+                return;
+            }
+        }
+    } catch (const ndn::tlv::Error &e) {
+        // kept whole
+    }
+}
+
+const ndn::Name& CacheEntry::getName() const {
+    return _name;
+}
+
+std::shared_ptr<const ndn::Buffer> CacheEntry::getWire() const {
+    if (_raw_size > 0) {
+        auto wire = BufferPool::local().acquire(_raw_size);
+        // the block was made from this wire, it can't fail but for a corrupted heap
+        lz4_codec::decompress(_wire->data(), _wire->size(), wire->data(), _raw_size);
+        return wire;
+    }
+    if (!_content) {
+        return _wire;
+    }
+    auto wire = BufferPool::local().acquire(_wire->size() + _content->size());
+    auto it = std::copy(_wire->begin(), _wire->begin() + _content_offset, wire->begin());
+    it = std::copy(_content->begin(), _content->end(), it);
+    std::copy(_wire->begin() + _content_offset, _wire->end(), it);
+    return wire;
 }
 
 const ndn::Data& CacheEntry::getData() const {
-    return _data;
+    if (!_data) {
+        _data = std::make_shared<const ndn::Data>(ndn::Block(getWire()));
+    }
+    return *_data;
+}
+
+bool CacheEntry::hasDigest(const uint8_t *digest, size_t length) const {
+    if (!_digest) {
+        auto wire = getWire();
+        _digest = ndn::util::Sha256::computeDigest(wire->data(), wire->size());
+    }
+    return _digest->size() == length && std::memcmp(_digest->data(), digest, length) == 0;
 }
 
 bool CacheEntry::isValid() const {
-    return expire_time_point > ndn::time::steady_clock::now();
+    return expire_time_point > coarse_clock::now();
 }
 
 ndn::time::milliseconds CacheEntry::remainingTime() const {
-    return ndn::time::duration_cast<ndn::time::milliseconds>(expire_time_point - ndn::time::steady_clock::now());
+    return ndn::time::duration_cast<ndn::time::milliseconds>(expire_time_point - coarse_clock::now());
+}
+
+const ndn::time::steady_clock::time_point& CacheEntry::getExpireTime() const {
+    return expire_time_point;
+}
+
+size_t CacheEntry::getSize() const {
+    return _size;
+}
+
+size_t CacheEntry::getMemoryUsage() const {
+    size_t bytes = memory_usage::ofShared<CacheEntry>() + memory_usage::of(_name);
+    if (_data) {
+        bytes += memory_usage::ofShared<ndn::Data>();
+    }
+    if (_digest) {
+        bytes += memory_usage::ofShared<ndn::Buffer>() + _digest->capacity();
+    }
+    if (_verified_tag) {
+        bytes += sizeof(LpLink::VerifiedTag);
+    }
+    return bytes;
+}
+
+size_t CacheEntry::getWireMemoryUsage() const {
+    return memory_usage::ofShared<ndn::Buffer>() + _wire->capacity();
+}
+
+CacheEntry::PolicyHook& CacheEntry::getHook() {
+    return _hook;
+}
+
+size_t& CacheEntry::getExpirySlot() {
+    return _expiry_slot;
+}
+
+void CacheEntry::touch() {
+    _last_access = coarse_clock::now();
+}
+
+const ndn::time::steady_clock::time_point& CacheEntry::getLastAccess() const {
+    return _last_access;
+}
+
+bool CacheEntry::isCompressed() const {
+    return _raw_size > 0;
+}
+
+size_t CacheEntry::getRawSize() const {
+    return _raw_size > 0 ? _raw_size : _wire->size() + (_content ? _content->size() : 0);
+}
+
+size_t CacheEntry::compress() {
+    if (_raw_size > 0 || _is_incompressible || _content) {
+        return 0;
+    }
+    auto block = lz4_codec::compress(_wire->data(), _wire->size(), _wire->size() - _wire->size() / 8);
+    if (!block) {
+        _is_incompressible = true;
+        return 0;
+    }
+    size_t saved = _wire->size() - block->size();
+    _raw_size = _wire->size();
+    _wire = std::move(block);
+    // it points into the former wire
+    _data.reset();
+    _size -= saved;
+    return saved;
+}
+
+size_t CacheEntry::decompress() {
+    if (_raw_size == 0) {
+        return 0;
+    }
+    // kept by the entry, not taken from the pool
+    auto wire = std::make_shared<ndn::Buffer>(_raw_size);
+    lz4_codec::decompress(_wire->data(), _wire->size(), wire->data(), _raw_size);
+    size_t added = _raw_size - _wire->size();
+    _raw_size = 0;
+    _wire = std::move(wire);
+    _size += added;
+    return added;
 }
\ No newline at end of file
@@ -1,22 +1,123 @@
 #pragma once
 
 #include <ndn-cxx/data.hpp>
+#include <ndn-cxx/encoding/buffer.hpp>
 
+#include <cstdint>
 #include <memory>
 
+#include "network/lp_link.h"
+#include "network/ndn_packet.h"
+#include "content_index.h"
+
 class CacheEntry {
+public:
+    // state of the entry in the replacement policy, see CachePolicy
+    struct PolicyHook {
+        static const int NO_LIST = -1;
+
+        CacheEntry *newer = nullptr;
+        CacheEntry *older = nullptr;
+        int list = NO_LIST;
+        // name_hash of the Data Name
+        uint64_t hash = 0;
+        // index of the PartitionedPolicy partition the entry was inserted into
+        uint32_t partition = 0;
+    };
+
+    // memory held besides the wire encoding and the Blocks of the Name components: the shared_ptr control blocks and
+    // the node of the cache tree
+    static const size_t OVERHEAD = 256;
+
 private:
-    const ndn::Data _data;
+    const ndn::Name _name;
+    // the packet as received, sent as is on each hit. without its Content TLV if that one is shared
+    std::shared_ptr<const ndn::Buffer> _wire;
+    // the Content TLV kept by the ContentIndex, put back at _content_offset of the wire on each hit
+    std::shared_ptr<const ndn::Buffer> _content;
+    size_t _content_offset = 0;
+    // of the wire once decompressed, 0 unless _wire holds it as an LZ4 block
+    size_t _raw_size = 0;
+    // set once compression didn't pay, it isn't tried again
+    bool _is_incompressible = false;
+    mutable std::shared_ptr<const ndn::Data> _data;
     const ndn::time::steady_clock::time_point expire_time_point;
+    size_t _size;
+    // SHA-256 of the whole wire, the implicit digest of the Data, computed on the first Interest which names it
+    mutable ndn::ConstBufferPtr _digest;
+    PolicyHook _hook;
+    // inserted or hit for the last time
+    ndn::time::steady_clock::time_point _last_access;
+    // position in the ExpiryIndex
+    size_t _expiry_slot = SIZE_MAX;
+    // the verdict of the signature verifier which checked the Data on its way here, null if none did
+    std::unique_ptr<const LpLink::VerifiedTag> _verified_tag;
+
+    // the Content TLV of a large enough payload goes to contents, the rest of the wire is copied
+    void shareContent(ContentIndex &contents);
+
+    // the Verified field of the LpPacket the Data came in, if any
+    void keepVerifiedTag(const NdnPacket &packet);
 
 public:
-    explicit CacheEntry(const ndn::Data &data);
+    // the packet must be a Data, it expires after its FreshnessPeriod. its payload is shared through contents if set
+    explicit CacheEntry(const NdnPacket &packet, ContentIndex *contents = nullptr);
+
+    // a Data which was cached before, e.g. on disk, it keeps its expiration time
+    CacheEntry(const NdnPacket &packet, const ndn::time::steady_clock::time_point &expire_time, ContentIndex *contents = nullptr);
 
     ~CacheEntry() = default;
 
+    const ndn::Name& getName() const;
+
+    // the wire of a shared payload is put together again in a pooled buffer, at the cost of a copy, a compressed one
+    // is decompressed in one on each call
+    std::shared_ptr<const ndn::Buffer> getWire() const;
+
+    // sent along with the wire on each hit for the next verifiers to trust the Data, null if it came without
+    const LpLink::VerifiedTag* getVerifiedTag() const;
+
+    // decoded from the wire on the first call only, hits are served from getWire()
     const ndn::Data& getData() const;
 
+    // digest is the value of an ImplicitSha256DigestComponent
+    bool hasDigest(const uint8_t *digest, size_t length) const;
+
     bool isValid() const;
 
     ndn::time::milliseconds remainingTime() const;
+
+    const ndn::time::steady_clock::time_point& getExpireTime() const;
+
+    // estimate of the bytes used by the entry, counted against the byte budget of the cache. a shared payload isn't,
+    // the ContentIndex counts it once
+    size_t getSize() const;
+
+    // the bytes the entry holds as laid out in memory: the entry itself with its Name, and the Data or the digest
+    // once decoded or computed. the wire and the shared payload are apart
+    size_t getMemoryUsage() const;
+
+    // of the buffer holding the wire, with its headroom if it came from a pooled read buffer
+    size_t getWireMemoryUsage() const;
+
+    PolicyHook& getHook();
+
+    size_t& getExpirySlot();
+
+    // on each hit, for compressCold()
+    void touch();
+
+    const ndn::time::steady_clock::time_point& getLastAccess() const;
+
+    bool isCompressed() const;
+
+    // of the wire, decompressed if need be
+    size_t getRawSize() const;
+
+    // the wire is replaced by its LZ4 block unless that saves less than 1/8 of it, the payload is shared or it was
+    // tried already. the decoded Data is dropped, returns the bytes saved on getSize(), 0 if it wasn't compressed
+    size_t compress();
+
+    // the wire is decompressed back in place, e.g. once hit, returns the bytes added to getSize()
+    size_t decompress();
 };
\ No newline at end of file
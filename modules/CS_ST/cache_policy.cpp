@@ -0,0 +1,646 @@
+#include "cache_policy.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "network/name_hash.h"
+
+FrequencySketch::FrequencySketch(size_t capacity) {
+    resize(capacity);
+}
+
+void FrequencySketch::resize(size_t capacity) {
+    size_t width = 64;
+    while (width < capacity) {
+        width *= 2;
+    }
+    _counters.assign(width * ROWS, 0);
+    _mask = width - 1;
+    _additions = 0;
+    _sample_size = std::max<size_t>(capacity, 1) * 10;
+}
+
+size_t FrequencySketch::index(uint64_t hash, size_t row) const {
+    return row * (_mask + 1) + (name_hash::mix(hash, row + 1) & _mask);
+}
+
+void FrequencySketch::increment(uint64_t hash) {
+    bool added = false;
+    for (size_t row = 0; row < ROWS; ++row) {
+        uint8_t &counter = _counters[index(hash, row)];
+        if (counter < MAX_COUNT) {
+            ++counter;
+            added = true;
+        }
+    }
+    if (added && ++_additions == _sample_size) {
+        for (auto &counter : _counters) {
+            counter /= 2;
+        }
+        _additions /= 2;
+    }
+}
+
+uint8_t FrequencySketch::estimate(uint64_t hash) const {
+    uint8_t count = MAX_COUNT;
+    for (size_t row = 0; row < ROWS; ++row) {
+        count = std::min(count, _counters[index(hash, row)]);
+    }
+    return count;
+}
+
+// least recently used first, the former behaviour of the content store
+size_t FrequencySketch::getMemoryUsage() const {
+    return memory_usage::of(_counters);
+}
+
+class LruPolicy : public CachePolicy {
+private:
+    EntryList _entries{0};
+
+public:
+    explicit LruPolicy(size_t capacity) : CachePolicy(capacity) {
+
+    }
+
+    std::string getName() const override {
+        return "lru";
+    }
+
+    void setCapacity(size_t capacity, std::vector<CacheEntry*> &evicted) override {
+        _capacity = capacity;
+        while (_entries.size() > _capacity) {
+            evicted.emplace_back(_entries.popOldest());
+        }
+    }
+
+    void insert(CacheEntry *entry, std::vector<CacheEntry*> &evicted) override {
+        _entries.pushNewest(entry);
+        setCapacity(_capacity, evicted);
+    }
+
+    void onHit(CacheEntry *entry) override {
+        _entries.touch(entry);
+    }
+
+    void erase(CacheEntry *entry) override {
+        _entries.remove(entry);
+    }
+
+    CacheEntry* popVictim() override {
+        return _entries.popOldest();
+    }
+
+    CacheEntry* getColdest() const override {
+        return _entries.oldest();
+    }
+};
+
+// segmented LRU: new entries go to a probation segment and only those hit there reach the protected one, a scan of
+// Data requested once only goes through probation and leaves the popular entries in place
+class SlruPolicy : public CachePolicy {
+private:
+    EntryList _probation{0};
+    EntryList _protected{1};
+
+    size_t getProtectedCapacity() const {
+        return _capacity * 4 / 5;
+    }
+
+    void evict(std::vector<CacheEntry*> &evicted) {
+        while (_probation.size() + _protected.size() > _capacity) {
+            evicted.emplace_back(popVictim());
+        }
+    }
+
+public:
+    explicit SlruPolicy(size_t capacity) : CachePolicy(capacity) {
+
+    }
+
+    std::string getName() const override {
+        return "slru";
+    }
+
+    void setCapacity(size_t capacity, std::vector<CacheEntry*> &evicted) override {
+        _capacity = capacity;
+        while (_protected.size() > getProtectedCapacity()) {
+            _probation.pushNewest(_protected.popOldest());
+        }
+        evict(evicted);
+    }
+
+    void insert(CacheEntry *entry, std::vector<CacheEntry*> &evicted) override {
+        _probation.pushNewest(entry);
+        evict(evicted);
+    }
+
+    void onHit(CacheEntry *entry) override {
+        if (_protected.contains(entry)) {
+            _protected.touch(entry);
+            return;
+        }
+        _probation.remove(entry);
+        _protected.pushNewest(entry);
+        // the protected entry used the least recently goes back to probation
+        if (_protected.size() > getProtectedCapacity()) {
+            _probation.pushNewest(_protected.popOldest());
+        }
+    }
+
+    void erase(CacheEntry *entry) override {
+        (_protected.contains(entry) ? _protected : _probation).remove(entry);
+    }
+
+    CacheEntry* popVictim() override {
+        return !_probation.empty() ? _probation.popOldest() : _protected.popOldest();
+    }
+
+    CacheEntry* getColdest() const override {
+        return !_probation.empty() ? _probation.oldest() : _protected.oldest();
+    }
+};
+
+// Adaptive Replacement Cache (Megiddo and Modha): t1 holds the entries seen once, t2 those seen at least twice, the
+// ghost lists b1 and b2 remember what was evicted from each. a miss on a ghost moves the target size p of t1 toward
+// the list it was evicted from, so the split between recency and frequency follows the workload
+class ArcPolicy : public CachePolicy {
+private:
+    EntryList _t1{0};
+    EntryList _t2{1};
+    GhostList _b1;
+    GhostList _b2;
+    size_t _p = 0;
+
+    CacheEntry* replace(bool in_b2) {
+        if (!_t1.empty() && ((in_b2 && _t1.size() == _p) || _t1.size() > _p || _t2.empty())) {
+            CacheEntry *entry = _t1.popOldest();
+            _b1.pushNewest(entry->getHook().hash);
+            return entry;
+        } else if (!_t2.empty()) {
+            CacheEntry *entry = _t2.popOldest();
+            _b2.pushNewest(entry->getHook().hash);
+            return entry;
+        }
+        return nullptr;
+    }
+
+    void replace(bool in_b2, std::vector<CacheEntry*> &evicted) {
+        if (CacheEntry *entry = replace(in_b2)) {
+            evicted.emplace_back(entry);
+        }
+    }
+
+    void trimGhosts() {
+        while (_t1.size() + _b1.size() > _capacity && _b1.size() > 0) {
+            _b1.popOldest();
+        }
+        while (_t1.size() + _t2.size() + _b1.size() + _b2.size() > 2 * _capacity && _b2.size() > 0) {
+            _b2.popOldest();
+        }
+    }
+
+public:
+    explicit ArcPolicy(size_t capacity) : CachePolicy(capacity) {
+
+    }
+
+    std::string getName() const override {
+        return "arc";
+    }
+
+    void setCapacity(size_t capacity, std::vector<CacheEntry*> &evicted) override {
+        _capacity = capacity;
+        _p = std::min(_p, _capacity);
+        while (_t1.size() + _t2.size() > _capacity) {
+            replace(false, evicted);
+        }
+        trimGhosts();
+    }
+
+    void insert(CacheEntry *entry, std::vector<CacheEntry*> &evicted) override {
+        uint64_t hash = entry->getHook().hash;
+        bool full = _t1.size() + _t2.size() >= _capacity;
+        if (_b1.contains(hash)) {
+            // evicted too early from t1, t1 grows
+            _p = std::min(_capacity, _p + std::max<size_t>(_b2.size() / _b1.size(), 1));
+            _b1.erase(hash);
+            if (full) {
+                replace(false, evicted);
+            }
+            _t2.pushNewest(entry);
+        } else if (_b2.contains(hash)) {
+            // evicted too early from t2, t2 grows
+            _p -= std::min(_p, std::max<size_t>(_b1.size() / _b2.size(), 1));
+            _b2.erase(hash);
+            if (full) {
+                replace(true, evicted);
+            }
+            _t2.pushNewest(entry);
+        } else {
+            if (_t1.size() + _b1.size() >= _capacity) {
+                if (_t1.size() < _capacity) {
+                    _b1.popOldest();
+                    if (full) {
+                        replace(false, evicted);
+                    }
+                } else if (CacheEntry *oldest = _t1.popOldest()) {
+                    evicted.emplace_back(oldest);
+                }
+            } else if (full) {
+                if (_t1.size() + _t2.size() + _b1.size() + _b2.size() >= 2 * _capacity) {
+                    _b2.popOldest();
+                }
+                replace(false, evicted);
+            }
+            _t1.pushNewest(entry);
+        }
+        // a capacity of 0 keeps nothing
+        while (_t1.size() + _t2.size() > _capacity) {
+            replace(false, evicted);
+        }
+        trimGhosts();
+    }
+
+    void onHit(CacheEntry *entry) override {
+        (_t1.contains(entry) ? _t1 : _t2).remove(entry);
+        _t2.pushNewest(entry);
+    }
+
+    void erase(CacheEntry *entry) override {
+        (_t1.contains(entry) ? _t1 : _t2).remove(entry);
+    }
+
+    CacheEntry* popVictim() override {
+        CacheEntry *entry = replace(false);
+        trimGhosts();
+        return entry;
+    }
+
+    // the entries seen once, unless t1 is empty
+    CacheEntry* getColdest() const override {
+        return !_t1.empty() ? _t1.oldest() : _t2.oldest();
+    }
+
+    size_t getMemoryUsage() const override {
+        return _b1.getMemoryUsage() + _b2.getMemoryUsage();
+    }
+};
+
+// W-TinyLFU (Einziger, Friedman and Manes): new entries wait in a window LRU of 1% of the capacity, the one leaving
+// the window only enters the main segmented LRU if its Name was requested more often than the entry it would evict,
+// as estimated by a frequency sketch counting every lookup. scans don't get past the window
+class TinyLfuPolicy : public CachePolicy {
+private:
+    EntryList _window{0};
+    EntryList _probation{1};
+    EntryList _protected{2};
+    FrequencySketch _sketch;
+
+    size_t getWindowCapacity() const {
+        return std::max<size_t>(_capacity / 100, 1);
+    }
+
+    size_t getMainCapacity() const {
+        return _capacity - std::min(_capacity, getWindowCapacity());
+    }
+
+    size_t getProtectedCapacity() const {
+        return getMainCapacity() * 4 / 5;
+    }
+
+    void evict(std::vector<CacheEntry*> &evicted) {
+        while (_window.size() > getWindowCapacity() || _window.size() + _probation.size() + _protected.size() > _capacity) {
+            if (_window.empty()) {
+                evicted.emplace_back(popVictim());
+                continue;
+            }
+            CacheEntry *candidate = _window.popOldest();
+            if (_probation.size() + _protected.size() < getMainCapacity()) {
+                _probation.pushNewest(candidate);
+                continue;
+            }
+            CacheEntry *victim = !_probation.empty() ? _probation.oldest() : _protected.oldest();
+            if (victim && _sketch.estimate(candidate->getHook().hash) > _sketch.estimate(victim->getHook().hash)) {
+                erase(victim);
+                evicted.emplace_back(victim);
+                _probation.pushNewest(candidate);
+            } else {
+                evicted.emplace_back(candidate);
+            }
+        }
+    }
+
+public:
+    explicit TinyLfuPolicy(size_t capacity) : CachePolicy(capacity), _sketch(capacity) {
+
+    }
+
+    std::string getName() const override {
+        return "tinylfu";
+    }
+
+    void setCapacity(size_t capacity, std::vector<CacheEntry*> &evicted) override {
+        _capacity = capacity;
+        _sketch.resize(capacity);
+        while (_protected.size() > getProtectedCapacity()) {
+            _probation.pushNewest(_protected.popOldest());
+        }
+        evict(evicted);
+    }
+
+    void insert(CacheEntry *entry, std::vector<CacheEntry*> &evicted) override {
+        _sketch.increment(entry->getHook().hash);
+        _window.pushNewest(entry);
+        evict(evicted);
+    }
+
+    void onHit(CacheEntry *entry) override {
+        _sketch.increment(entry->getHook().hash);
+        if (_window.contains(entry)) {
+            _window.touch(entry);
+        } else if (_protected.contains(entry)) {
+            _protected.touch(entry);
+        } else {
+            _probation.remove(entry);
+            _protected.pushNewest(entry);
+            if (_protected.size() > getProtectedCapacity()) {
+                _probation.pushNewest(_protected.popOldest());
+            }
+        }
+    }
+
+    void onMiss(uint64_t hash) override {
+        _sketch.increment(hash);
+    }
+
+    void erase(CacheEntry *entry) override {
+        if (_window.contains(entry)) {
+            _window.remove(entry);
+        } else if (_protected.contains(entry)) {
+            _protected.remove(entry);
+        } else {
+            _probation.remove(entry);
+        }
+    }
+
+    // the main segments first, the window only holds the most recent entries
+    CacheEntry* popVictim() override {
+        if (!_probation.empty()) {
+            return _probation.popOldest();
+        }
+        return !_protected.empty() ? _protected.popOldest() : _window.popOldest();
+    }
+
+    CacheEntry* getColdest() const override {
+        if (!_probation.empty()) {
+            return _probation.oldest();
+        }
+        return !_protected.empty() ? _protected.oldest() : _window.oldest();
+    }
+
+    size_t getMemoryUsage() const override {
+        return _sketch.getMemoryUsage();
+    }
+};
+
+std::unique_ptr<CachePolicy> CachePolicy::create(const std::string &policy, size_t capacity) {
+    if (policy == "lru") {
+        return std::unique_ptr<CachePolicy>(new LruPolicy(capacity));
+    } else if (policy == "slru") {
+        return std::unique_ptr<CachePolicy>(new SlruPolicy(capacity));
+    } else if (policy == "arc") {
+        return std::unique_ptr<CachePolicy>(new ArcPolicy(capacity));
+    } else if (policy == "tinylfu") {
+        return std::unique_ptr<CachePolicy>(new TinyLfuPolicy(capacity));
+    }
+    return nullptr;
+}
+
+PartitionedPolicy::PartitionedPolicy(size_t capacity, bool is_borrowing) : CachePolicy(capacity), _is_borrowing(is_borrowing) {
+
+}
+
+std::unique_ptr<PartitionedPolicy> PartitionedPolicy::create(const std::string &policy, const std::vector<Config> &partitions,
+                                                             bool is_borrowing, size_t capacity) {
+    std::unique_ptr<PartitionedPolicy> partitioned(new PartitionedPolicy(capacity, is_borrowing));
+    std::vector<Config> configs(partitions);
+    std::stable_sort(configs.begin(), configs.end(), [](const Config &lhs, const Config &rhs) {
+        return lhs.prefix.size() > rhs.prefix.size();
+    });
+    double shares = 0;
+    configs.insert(configs.begin(), Config{ndn::Name(), 0, policy});
+    for (const auto &config : configs) {
+        auto sub_policy = CachePolicy::create(config.policy.empty() ? policy : config.policy, capacity);
+        if (!sub_policy || config.share < 0) {
+            return nullptr;
+        }
+        shares += config.share;
+        Partition partition;
+        partition.prefix = config.prefix;
+        partition.share = config.share;
+        partition.policy = std::move(sub_policy);
+        partitioned->_partitions.emplace_back(std::move(partition));
+    }
+    // the rounding of the shares aside
+    if (shares > 1.000001) {
+        return nullptr;
+    }
+    partitioned->_partitions.front().share = std::max(1 - shares, 0.0);
+    std::vector<CacheEntry*> evicted;
+    partitioned->distribute(evicted);
+    return partitioned;
+}
+
+bool PartitionedPolicy::isPrefixOf(const ndn::Name &prefix, const NameView &name) {
+    if (prefix.size() > name.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (NameComponentRef::compare(prefix.get(i), name[i]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t PartitionedPolicy::findPartition(const ndn::Name &name) const {
+    for (size_t i = 1; i < _partitions.size(); ++i) {
+        if (_partitions[i].prefix.isPrefixOf(name)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+size_t PartitionedPolicy::findPartition(const NameView &name) const {
+    for (size_t i = 1; i < _partitions.size(); ++i) {
+        if (isPrefixOf(_partitions[i].prefix, name)) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+void PartitionedPolicy::distribute(std::vector<CacheEntry*> &evicted) {
+    // the default partition gets what the rounding down of the others leaves
+    size_t quotas = 0;
+    for (size_t i = 1; i < _partitions.size(); ++i) {
+        _partitions[i].quota = static_cast<size_t>(_capacity * _partitions[i].share);
+        quotas += _partitions[i].quota;
+    }
+    _partitions.front().quota = _capacity - std::min(_capacity, quotas);
+    for (auto &partition : _partitions) {
+        size_t before = evicted.size();
+        // a borrowing partition is only bounded by the whole cache, the victims are chosen here
+        partition.policy->setCapacity(_is_borrowing ? _capacity : partition.quota, evicted);
+        partition.size -= evicted.size() - before;
+        _size -= evicted.size() - before;
+    }
+    while (_size > _capacity) {
+        CacheEntry *victim = popVictim();
+        if (!victim) {
+            break;
+        }
+        evicted.emplace_back(victim);
+    }
+}
+
+PartitionedPolicy::Partition* PartitionedPolicy::selectVictimPartition() {
+    Partition *selected = nullptr;
+    int64_t selected_excess = 0;
+    for (auto &partition : _partitions) {
+        int64_t excess = static_cast<int64_t>(partition.size) - static_cast<int64_t>(partition.quota);
+        if (partition.size > 0 && (!selected || excess > selected_excess)) {
+            selected = &partition;
+            selected_excess = excess;
+        }
+    }
+    return selected;
+}
+
+std::string PartitionedPolicy::getName() const {
+    return _partitions.front().policy->getName();
+}
+
+void PartitionedPolicy::setCapacity(size_t capacity, std::vector<CacheEntry*> &evicted) {
+    _capacity = capacity;
+    distribute(evicted);
+}
+
+void PartitionedPolicy::insert(CacheEntry *entry, std::vector<CacheEntry*> &evicted) {
+    size_t index = findPartition(entry->getName());
+    entry->getHook().partition = static_cast<uint32_t>(index);
+    Partition &partition = _partitions[index];
+    size_t before = evicted.size();
+    partition.policy->insert(entry, evicted);
+    // entry itself among them if the policy didn't admit it
+    size_t removed = evicted.size() - before;
+    partition.size = partition.size + 1 - removed;
+    _size = _size + 1 - removed;
+    while (_size > _capacity) {
+        CacheEntry *victim = popVictim();
+        if (!victim) {
+            break;
+        }
+        evicted.emplace_back(victim);
+    }
+}
+
+void PartitionedPolicy::onHit(CacheEntry *entry) {
+    _partitions[entry->getHook().partition].policy->onHit(entry);
+}
+
+void PartitionedPolicy::onMiss(uint64_t hash) {
+
+}
+
+void PartitionedPolicy::erase(CacheEntry *entry) {
+    Partition &partition = _partitions[entry->getHook().partition];
+    partition.policy->erase(entry);
+    --partition.size;
+    --_size;
+}
+
+CacheEntry* PartitionedPolicy::popVictim() {
+    Partition *partition = selectVictimPartition();
+    if (!partition) {
+        return nullptr;
+    }
+    CacheEntry *victim = partition->policy->popVictim();
+    if (victim) {
+        --partition->size;
+        --_size;
+    }
+    return victim;
+}
+
+CacheEntry* PartitionedPolicy::getColdest() const {
+    const Partition *largest = &_partitions.front();
+    for (const auto &partition : _partitions) {
+        if (partition.size > largest->size) {
+            largest = &partition;
+        }
+    }
+    return largest->policy->getColdest();
+}
+
+size_t PartitionedPolicy::getMemoryUsage() const {
+    size_t bytes = memory_usage::of(_partitions);
+    for (const auto &partition : _partitions) {
+        bytes += memory_usage::of(partition.prefix) + partition.policy->getMemoryUsage();
+    }
+    return bytes;
+}
+
+void PartitionedPolicy::record(const NameView &name, bool is_hit) {
+    Partition &partition = _partitions[findPartition(name)];
+    if (is_hit) {
+        ++partition.hits;
+    } else {
+        ++partition.misses;
+        partition.policy->onMiss(name.getHash());
+    }
+}
+
+std::vector<PartitionedPolicy::Stats> PartitionedPolicy::getStats() const {
+    std::vector<Stats> stats;
+    for (const auto &partition : _partitions) {
+        Stats partition_stats;
+        partition_stats.prefix = partition.prefix.toUri();
+        partition_stats.policy = partition.policy->getName();
+        partition_stats.quota = partition.quota;
+        partition_stats.entries = partition.size;
+        partition_stats.hits = partition.hits;
+        partition_stats.misses = partition.misses;
+        stats.emplace_back(std::move(partition_stats));
+    }
+    return stats;
+}
+
+void PartitionedPolicy::mergeStats(std::vector<Stats> &stats, const std::vector<Stats> &other) {
+    if (stats.empty()) {
+        stats = other;
+        return;
+    }
+    for (size_t i = 0; i < std::min(stats.size(), other.size()); ++i) {
+        stats[i].quota += other[i].quota;
+        stats[i].entries += other[i].entries;
+        stats[i].hits += other[i].hits;
+        stats[i].misses += other[i].misses;
+    }
+}
+
+std::string PartitionedPolicy::statsToJSON(const std::vector<Stats> &stats) {
+    std::stringstream ss;
+    ss << "[";
+    for (size_t i = 0; i < stats.size(); ++i) {
+        size_t lookups = stats[i].hits + stats[i].misses;
+        ss << (i == 0 ? "" : ", ") << R"({"prefix":")" << stats[i].prefix << R"(", "policy":")" << stats[i].policy
+           << R"(", "quota":)" << stats[i].quota << R"(, "entries":)" << stats[i].entries << R"(, "hits":)" << stats[i].hits
+           << R"(, "misses":)" << stats[i].misses
+           << R"(, "hit_ratio":)" << (lookups > 0 ? static_cast<double>(stats[i].hits) / lookups : 0.0) << "}";
+    }
+    ss << "]";
+    return ss.str();
+}
\ No newline at end of file
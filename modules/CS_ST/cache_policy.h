@@ -0,0 +1,308 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <ndn-cxx/name.hpp>
+
+#include "metrics/memory_stats.h"
+#include "network/name_view.h"
+
+#include "cache_entry.h"
+
+// recency list of cache entries threaded through their PolicyHook, most recent first, nothing is allocated. an entry
+// is in one list at most, the id of that list is kept in its hook
+class EntryList {
+private:
+    const int _id;
+    CacheEntry *_newest = nullptr;
+    CacheEntry *_oldest = nullptr;
+    size_t _size = 0;
+
+public:
+    explicit EntryList(int id) : _id(id) {
+
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    bool contains(CacheEntry *entry) const {
+        return entry->getHook().list == _id;
+    }
+
+    CacheEntry* oldest() const {
+        return _oldest;
+    }
+
+    void pushNewest(CacheEntry *entry) {
+        auto &hook = entry->getHook();
+        hook.list = _id;
+        hook.newer = nullptr;
+        hook.older = _newest;
+        if (_newest) {
+            _newest->getHook().newer = entry;
+        } else {
+            _oldest = entry;
+        }
+        _newest = entry;
+        ++_size;
+    }
+
+    void remove(CacheEntry *entry) {
+        auto &hook = entry->getHook();
+        if (hook.newer) {
+            hook.newer->getHook().older = hook.older;
+        } else {
+            _newest = hook.older;
+        }
+        if (hook.older) {
+            hook.older->getHook().newer = hook.newer;
+        } else {
+            _oldest = hook.newer;
+        }
+        hook.list = CacheEntry::PolicyHook::NO_LIST;
+        hook.newer = nullptr;
+        hook.older = nullptr;
+        --_size;
+    }
+
+    void touch(CacheEntry *entry) {
+        if (entry != _newest) {
+            remove(entry);
+            pushNewest(entry);
+        }
+    }
+
+    CacheEntry* popOldest() {
+        CacheEntry *entry = _oldest;
+        if (entry) {
+            remove(entry);
+        }
+        return entry;
+    }
+};
+
+// Names of entries evicted recently, held by name_hash only, the oldest are forgotten first
+class GhostList {
+private:
+    std::list<uint64_t> _hashes;
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> _index;
+
+public:
+    size_t size() const {
+        return _index.size();
+    }
+
+    bool contains(uint64_t hash) const {
+        return _index.count(hash) > 0;
+    }
+
+    void pushNewest(uint64_t hash) {
+        if (!contains(hash)) {
+            _index.emplace(hash, _hashes.insert(_hashes.begin(), hash));
+        }
+    }
+
+    void erase(uint64_t hash) {
+        auto it = _index.find(hash);
+        if (it != _index.end()) {
+            _hashes.erase(it->second);
+            _index.erase(it);
+        }
+    }
+
+    void popOldest() {
+        if (!_hashes.empty()) {
+            _index.erase(_hashes.back());
+            _hashes.pop_back();
+        }
+    }
+
+    size_t getMemoryUsage() const {
+        return memory_usage::of(_hashes) + memory_usage::of(_index);
+    }
+};
+
+// approximate access counts of the Names by name_hash: count-min sketch of 4 rows of counters saturating at 15, all
+// halved once as many accesses as 10 times the capacity were counted so that old popularity fades away
+class FrequencySketch {
+private:
+    static const size_t ROWS = 4;
+    static const uint8_t MAX_COUNT = 15;
+
+    std::vector<uint8_t> _counters;
+    size_t _mask = 0;
+    size_t _additions = 0;
+    size_t _sample_size = 0;
+
+    size_t index(uint64_t hash, size_t row) const;
+
+public:
+    explicit FrequencySketch(size_t capacity);
+
+    void resize(size_t capacity);
+
+    void increment(uint64_t hash);
+
+    uint8_t estimate(uint64_t hash) const;
+
+    size_t getMemoryUsage() const;
+};
+
+// which Data leaves the content store when it is full. the policies see CacheEntry pointers, they are told about
+// every entry which enters or leaves the cache and never free one: the entries they evict are returned so that the
+// cache removes them from its tree
+class CachePolicy {
+protected:
+    size_t _capacity;
+
+public:
+    explicit CachePolicy(size_t capacity) : _capacity(capacity) {
+
+    }
+
+    virtual ~CachePolicy() = default;
+
+    // "lru", "slru", "arc" or "tinylfu", null if the policy is unknown
+    static std::unique_ptr<CachePolicy> create(const std::string &policy, size_t capacity);
+
+    virtual std::string getName() const = 0;
+
+    size_t getCapacity() const {
+        return _capacity;
+    }
+
+    // entries above the new capacity are appended to evicted
+    virtual void setCapacity(size_t capacity, std::vector<CacheEntry*> &evicted) = 0;
+
+    // a Data entering the cache, the entries which make room are appended to evicted, possibly entry itself if the
+    // policy doesn't admit it
+    virtual void insert(CacheEntry *entry, std::vector<CacheEntry*> &evicted) = 0;
+
+    virtual void onHit(CacheEntry *entry) = 0;
+
+    // a lookup which found nothing, hash is the name_hash of the Interest Name
+    virtual void onMiss(uint64_t hash) {
+
+    }
+
+    // an entry leaving the cache otherwise than by an eviction, e.g. once expired or replaced
+    virtual void erase(CacheEntry *entry) = 0;
+
+    // the entry the policy would evict next removed from it, used by the cache to stay under a budget the policy
+    // doesn't know about, e.g. in bytes. null once empty
+    virtual CacheEntry* popVictim() = 0;
+
+    // the oldest entry of the list the victims are taken from first, left in place, the hooks lead from it to the
+    // newer entries of that list. null once empty
+    virtual CacheEntry* getColdest() const = 0;
+
+    // bytes held besides the hooks of the entries, e.g. by the ghost lists
+    virtual size_t getMemoryUsage() const {
+        return 0;
+    }
+};
+
+
+// the cache split between tenants by Name prefix, each partition evicts by its own policy within its share of the
+// capacity so that a busy namespace doesn't push out the hot Data of the others. with borrowing a partition grows past
+// its share while the cache has room, the victims are then taken from the partition the furthest past its share. the
+// Names under none of the prefixes go to the default partition, which gets the share left
+class PartitionedPolicy : public CachePolicy {
+public:
+    struct Config {
+        ndn::Name prefix;
+        // of the capacity, the shares of the partitions sum to 1 at most
+        double share;
+        // empty for the policy of the default partition
+        std::string policy;
+    };
+
+    // of a partition, the default one first
+    struct Stats {
+        std::string prefix;
+        std::string policy;
+        size_t quota = 0;
+        size_t entries = 0;
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+private:
+    struct Partition {
+        ndn::Name prefix;
+        double share;
+        std::unique_ptr<CachePolicy> policy;
+        // the capacity times the share
+        size_t quota = 0;
+        size_t size = 0;
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    // the default one first, the longest prefixes next so that the first match is the longest one
+    std::vector<Partition> _partitions;
+    const bool _is_borrowing;
+    size_t _size = 0;
+
+    PartitionedPolicy(size_t capacity, bool is_borrowing);
+
+    static bool isPrefixOf(const ndn::Name &prefix, const NameView &name);
+
+    size_t findPartition(const ndn::Name &name) const;
+
+    size_t findPartition(const NameView &name) const;
+
+    // the quotas and the capacities of the policies, the entries above them are appended to evicted
+    void distribute(std::vector<CacheEntry*> &evicted);
+
+    // the partition the furthest past its quota, the next victim is taken from it
+    Partition* selectVictimPartition();
+
+public:
+    // policy is the one of the default partition, null if a policy is unknown or the shares sum past 1
+    static std::unique_ptr<PartitionedPolicy> create(const std::string &policy, const std::vector<Config> &partitions,
+                                                     bool is_borrowing, size_t capacity);
+
+    // the policy of the default partition
+    std::string getName() const override;
+
+    void setCapacity(size_t capacity, std::vector<CacheEntry*> &evicted) override;
+
+    void insert(CacheEntry *entry, std::vector<CacheEntry*> &evicted) override;
+
+    void onHit(CacheEntry *entry) override;
+
+    // left to record(), which knows the partition of the Interest
+    void onMiss(uint64_t hash) override;
+
+    void erase(CacheEntry *entry) override;
+
+    CacheEntry* popVictim() override;
+
+    // of the partition holding the most entries
+    CacheEntry* getColdest() const override;
+
+    size_t getMemoryUsage() const override;
+
+    // a lookup by the cache, counted in the partition of the Interest Name
+    void record(const NameView &name, bool is_hit);
+
+    std::vector<Stats> getStats() const;
+
+    // summed by partition, those of each shard are in the same order
+    static void mergeStats(std::vector<Stats> &stats, const std::vector<Stats> &other);
+
+    // [{"prefix", "policy", "quota", "entries", "hits", "misses", "hit_ratio"}], the default partition first
+    static std::string statsToJSON(const std::vector<Stats> &stats);
+};
\ No newline at end of file
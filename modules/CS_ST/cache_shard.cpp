@@ -0,0 +1,174 @@
+#include "cache_shard.h"
+
+#include <boost/bind.hpp>
+
+#include "log/probes.h"
+#include "metrics/stage_profile.h"
+#include "network/coarse_clock.h"
+
+CacheShard::CacheShard(boost::asio::io_service &module_ios, bool threaded, size_t size, size_t max_bytes,
+                       const std::string &policy, const MissCallback &miss_callback)
+        : _module_ios(module_ios)
+        , _own_ios(threaded ? new boost::asio::io_service(1) : nullptr)
+        , _own_ios_work(threaded ? new boost::asio::io_service::work(*_own_ios) : nullptr)
+        , _ios(threaded ? *_own_ios : module_ios)
+        , _cache(size, max_bytes, policy)
+        , _miss_callback(miss_callback)
+        , _inbox(INBOX_SIZE)
+        , _fair_queue(FAIR_QUANTUM)
+        , _is_draining(false)
+        , _expiry_timer(_ios)
+        , _hit_counter(0)
+        , _miss_counter(0) {
+
+}
+
+CacheShard::~CacheShard() {
+    if (_thread) {
+        _own_ios->stop();
+        _thread->join();
+    }
+}
+
+void CacheShard::start() {
+    if (_own_ios) {
+        _thread.reset(new boost::thread(boost::bind(&boost::asio::io_service::run, _own_ios.get())));
+    }
+    _ios.post(boost::bind(&CacheShard::removeExpired, this, boost::system::error_code()));
+}
+
+void CacheShard::submit(const std::shared_ptr<Face> &face, NdnPacket packet, bool from_ingress) {
+    push(face, std::move(packet), from_ingress, ndn::time::steady_clock::time_point());
+}
+
+void CacheShard::onAnswered(const NdnPacket &packet) {
+    if (!_thread) {
+        _cache.onAnswered(packet.getNameView());
+        return;
+    }
+    _ios.post([this, packet]() {
+        _cache.onAnswered(packet.getNameView());
+    });
+}
+
+void CacheShard::restore(const NdnPacket &packet, const ndn::time::steady_clock::time_point &expire_time) {
+    push(nullptr, packet, false, expire_time);
+}
+
+void CacheShard::push(const std::shared_ptr<Face> &face, NdnPacket packet, bool from_ingress,
+                      const ndn::time::steady_clock::time_point &expire_time) {
+    if (!_thread) {
+        process(face, packet, from_ingress, expire_time);
+        return;
+    }
+    if (!_inbox.emplace(face, std::move(packet), from_ingress, expire_time)) {
+        // the inbox only absorbs bursts between two drains
+        _ios.post(boost::bind(&CacheShard::process, this, face, packet, from_ingress, expire_time));
+        return;
+    }
+    if (!_is_draining.exchange(true)) {
+        _ios.post(boost::bind(&CacheShard::drainInbox, this));
+    }
+}
+
+void CacheShard::process(const std::shared_ptr<Face> &face, const NdnPacket &packet, bool from_ingress,
+                         const ndn::time::steady_clock::time_point &expire_time) {
+    stage_profile::Scope stage(stage_profile::TABLE);
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST:
+            if (auto entry = _cache.get(packet.getNameView())) {
+                NDNMS_PROBE2(cs_hit, packet.getNameView().getHash(), entry->getSize());
+                std::shared_ptr<const ndn::Buffer> wire = entry->getWire();
+                if (const LpLink::VerifiedTag *tag = entry->getVerifiedTag()) {
+                    // the next verifiers trust the Data on the tag it came with
+                    auto tagged_wire = LpLink::verified(wire->data(), wire->size(), *tag);
+                    if (face->carriesLpPacket(tagged_wire->size())) {
+                        wire = tagged_wire;
+                    }
+                }
+                face->send(wire);
+                ++_hit_counter;
+            } else {
+                NDNMS_PROBE1(cs_miss, packet.getNameView().getHash());
+                ++_miss_counter;
+                // dropped by the negative cache, the misses from the egress side aren't remembered
+                if (from_ingress && _cache.checkMiss(packet.getNameView()) != NegativeCache::FORWARD) {
+                    break;
+                }
+                if (_thread) {
+                    _module_ios.post(boost::bind(_miss_callback, face, packet, from_ingress));
+                } else {
+                    _miss_callback(face, packet, from_ingress);
+                }
+            }
+            break;
+        case NdnPacket::DATA:
+            if (expire_time == ndn::time::steady_clock::time_point()) {
+                _cache.insert(packet);
+            } else {
+                _cache.restore(packet, expire_time);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void CacheShard::drainInbox() {
+    // the clock is read again every few requests, the inbox may never empty under load
+    static const size_t CLOCK_REFRESH_REQUESTS = 64;
+
+    coarse_clock::Scope scope;
+    size_t count = 0;
+    for (;;) {
+        while (Request *request = _inbox.peek(0)) {
+            size_t face_id = request->face ? request->face->getFaceId() : 0;
+            _fair_queue.push(face_id, std::move(*request));
+            _inbox.pop();
+        }
+        if (!_fair_queue.empty()) {
+            _fair_queue.round([this, &count](Request &&request) {
+                if (++count % CLOCK_REFRESH_REQUESTS == 0) {
+                    coarse_clock::refresh();
+                }
+                process(request.face, request.packet, request.from_ingress, request.expire_time);
+            });
+            continue;
+        }
+        // a producer may have pushed after the last peek but seen the inbox as still being drained
+        _is_draining = false;
+        if (!_inbox.peek(0) || _is_draining.exchange(true)) {
+            return;
+        }
+    }
+}
+
+void CacheShard::removeExpired(const boost::system::error_code &err) {
+    // slices short enough not to delay the packets behind them, the next one is queued at once while some are left
+    static const size_t SLICE_ENTRIES = 256;
+    // each takes microseconds
+    static const size_t SLICE_COMPRESSIONS = 32;
+    static const boost::posix_time::milliseconds DELAY_BETWEEN_SLICES(100);
+
+    if (err) {
+        return;
+    }
+    // the nodes left empty by the evictions as well
+    bool is_done = _cache.removeExpired(SLICE_ENTRIES) < SLICE_ENTRIES;
+    is_done = _cache.pruneTree(SLICE_ENTRIES) < SLICE_ENTRIES && is_done;
+    is_done = _cache.compressCold(SLICE_COMPRESSIONS) < SLICE_COMPRESSIONS && is_done;
+    if (!is_done) {
+        _ios.post(boost::bind(&CacheShard::removeExpired, this, boost::system::error_code()));
+    } else {
+        _expiry_timer.expires_from_now(DELAY_BETWEEN_SLICES);
+        _expiry_timer.async_wait(boost::bind(&CacheShard::removeExpired, this, _1));
+    }
+}
+
+size_t CacheShard::getHitCounter() const {
+    return _hit_counter;
+}
+
+size_t CacheShard::getMissCounter() const {
+    return _miss_counter;
+}
\ No newline at end of file
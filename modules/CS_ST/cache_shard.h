@@ -0,0 +1,122 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "lru_cache.h"
+#include "network/face.h"
+#include "network/fair_queue.h"
+#include "network/mpsc_queue.h"
+#include "network/ndn_packet.h"
+
+// one LruCache of the content store and the thread it runs on, the content store spreads the Names over its shards
+// by name_hash. faces hand the packets over through a lock-free inbox, hits are answered from the shard thread and
+// misses are given back to the module thread, which owns the faces lists. a shard created without a thread of its own
+// runs on the module io_service and handles the packets at once
+class CacheShard {
+public:
+    // an Interest the cache couldn't answer, from_ingress tells on which side of the content store it arrived
+    using MissCallback = std::function<void(const std::shared_ptr<Face>&, const NdnPacket&, bool from_ingress)>;
+
+private:
+    static const size_t INBOX_SIZE = 4096;
+    // packets of each face handled by a round of drainInbox, a consumer flooding the shard delays the others by that
+    static const size_t FAIR_QUANTUM = 8;
+
+    struct Request {
+        std::shared_ptr<Face> face;
+        NdnPacket packet;
+        bool from_ingress;
+        // set for the Data of a snapshot, which keep their expiration time
+        ndn::time::steady_clock::time_point expire_time;
+
+        Request(const std::shared_ptr<Face> &face, NdnPacket packet, bool from_ingress,
+                const ndn::time::steady_clock::time_point &expire_time)
+                : face(face)
+                , packet(std::move(packet))
+                , from_ingress(from_ingress)
+                , expire_time(expire_time) {
+
+        }
+    };
+
+    boost::asio::io_service &_module_ios;
+    std::unique_ptr<boost::asio::io_service> _own_ios;
+    std::unique_ptr<boost::asio::io_service::work> _own_ios_work;
+    boost::asio::io_service &_ios;
+    std::unique_ptr<boost::thread> _thread;
+
+    LruCache _cache;
+    const MissCallback _miss_callback;
+
+    MpscQueue<Request> _inbox;
+    // the packets taken out of the inbox, by face, the Data of a snapshot together
+    FairQueue<Request> _fair_queue;
+    std::atomic<bool> _is_draining;
+    boost::asio::deadline_timer _expiry_timer;
+
+    std::atomic<size_t> _hit_counter;
+    std::atomic<size_t> _miss_counter;
+
+    void process(const std::shared_ptr<Face> &face, const NdnPacket &packet, bool from_ingress,
+                 const ndn::time::steady_clock::time_point &expire_time);
+
+    void push(const std::shared_ptr<Face> &face, NdnPacket packet, bool from_ingress,
+              const ndn::time::steady_clock::time_point &expire_time);
+
+    // the inbox is moved to the fair queue before each of its rounds, a packet of a quiet face is handled by the next
+    // round whatever the faces ahead of it in the inbox queued
+    void drainInbox();
+
+    void removeExpired(const boost::system::error_code &err);
+
+public:
+    CacheShard(boost::asio::io_service &module_ios, bool threaded, size_t size, size_t max_bytes,
+               const std::string &policy, const MissCallback &miss_callback);
+
+    CacheShard(const CacheShard&) = delete;
+
+    CacheShard& operator=(const CacheShard&) = delete;
+
+    ~CacheShard();
+
+    void start();
+
+    // a packet to look up if it is an Interest, to cache if it is a Data, from any thread. the packet is moved into
+    // the inbox, a caller done with it hands it over with std::move
+    void submit(const std::shared_ptr<Face> &face, NdnPacket packet, bool from_ingress);
+
+    // a Data given to the ingress without going through this shard, it clears the negative cache, from any thread
+    void onAnswered(const NdnPacket &packet);
+
+    // a Data read back from a snapshot, from any thread
+    void restore(const NdnPacket &packet, const ndn::time::steady_clock::time_point &expire_time);
+
+    // runs f(LruCache&) on the shard thread and waits for its result, for the commands
+    template <class F>
+    auto call(const F &f) -> decltype(f(std::declval<LruCache&>())) {
+        using Result = decltype(f(std::declval<LruCache&>()));
+        if (!_thread) {
+            return f(_cache);
+        }
+        auto task = std::make_shared<std::packaged_task<Result()>>([this, &f]() {
+            return f(_cache);
+        });
+        auto result = task->get_future();
+        _ios.post([task]() {
+            (*task)();
+        });
+        return result.get();
+    }
+
+    size_t getHitCounter() const;
+
+    size_t getMissCounter() const;
+};
\ No newline at end of file
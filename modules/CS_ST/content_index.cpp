@@ -0,0 +1,56 @@
+#include "content_index.h"
+
+#include <cstring>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+
+void ContentIndex::Release::operator()(const ndn::Buffer *content) const {
+    index->forget(hash, content);
+    delete content;
+}
+
+void ContentIndex::forget(uint64_t hash, const ndn::Buffer *content) {
+    auto range = _contents.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.buffer == content) {
+            _bytes -= content->size();
+            _contents.erase(it);
+            return;
+        }
+    }
+}
+
+std::shared_ptr<const ndn::Buffer> ContentIndex::share(const uint8_t *content, size_t size) {
+    uint64_t hash = name_hash::extend(name_hash::SEED, {0, content, size});
+    auto range = _contents.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        const ndn::Buffer &buffer = *it->second.buffer;
+        if (buffer.size() == size && std::memcmp(buffer.data(), content, size) == 0) {
+            if (auto shared = it->second.holders.lock()) {
+                ++_shared;
+                return shared;
+            }
+        }
+    }
+    std::shared_ptr<const ndn::Buffer> shared(new ndn::Buffer(content, size), Release{this, hash});
+    _contents.emplace(hash, Content{shared.get(), shared});
+    _bytes += size;
+    return shared;
+}
+
+size_t ContentIndex::getContents() const {
+    return _contents.size();
+}
+
+size_t ContentIndex::getBytes() const {
+    return _bytes;
+}
+
+size_t ContentIndex::getShared() const {
+    return _shared;
+}
+
+size_t ContentIndex::getMemoryUsage() const {
+    return memory_usage::of(_contents) + _contents.size() * memory_usage::ofShared<ndn::Buffer>();
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ndn-cxx/encoding/buffer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+// the Content TLVs shared by the Data cached under several Names, e.g. versioned aliases or re-signed copies: a
+// payload is kept once by the entries which carry it, the index only points at it and forgets it with the last of
+// them. a hash match is checked byte by byte. not thread-safe, each cache has its own and outlives its entries
+class ContentIndex {
+public:
+    // under this many bytes a Content TLV costs less to copy than to share
+    static const size_t MIN_CONTENT_SIZE = 256;
+
+private:
+    struct Release {
+        ContentIndex *index;
+        uint64_t hash;
+
+        void operator()(const ndn::Buffer *content) const;
+    };
+
+    struct Content {
+        // to find it again in the deleter, once the weak_ptr no longer can be locked
+        const ndn::Buffer *buffer;
+        std::weak_ptr<const ndn::Buffer> holders;
+    };
+
+    std::unordered_multimap<uint64_t, Content> _contents;
+    size_t _bytes = 0;
+    // the Data whose payload was already there
+    size_t _shared = 0;
+
+    void forget(uint64_t hash, const ndn::Buffer *content);
+
+public:
+    ContentIndex() = default;
+
+    ContentIndex(const ContentIndex&) = delete;
+
+    ContentIndex& operator=(const ContentIndex&) = delete;
+
+    // of size bytes from content, copied if it isn't there yet
+    std::shared_ptr<const ndn::Buffer> share(const uint8_t *content, size_t size);
+
+    size_t getContents() const;
+
+    // of the payloads kept, each once
+    size_t getBytes() const;
+
+    size_t getShared() const;
+
+    // of the index and the buffer headers of the payloads, the payloads themselves are getBytes()
+    size_t getMemoryUsage() const;
+};
\ No newline at end of file
@@ -2,95 +2,477 @@
 
 #include <boost/bind.hpp>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <sys/stat.h>
+
 #include "network/tcp_master_face.h"
 #include "network/tcp_face.h"
 #include "network/udp_master_face.h"
 #include "network/udp_face.h"
+#include "network/shm_master_face.h"
+#include "network/shm_face.h"
+#include "network/page_arena.h"
+#include "network/memory_master_face.h"
+#include "network/memory_face.h"
+#include "network/striped_tcp_face.h"
 #include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+#include "metrics/sampling_profiler.h"
+#include "metrics/stage_profile.h"
+#include "network/tlv_reader.h"
+#include "network/rendezvous_hash.h"
+#include "network/state_transfer.h"
+#include "tree/name_snapshot.h"
+#include "lz4_codec.h"
+
+namespace {
+    // [{"prefix", "share", "policy"}], the policy is optional
+    bool readPartitions(const rapidjson::Value &value, std::vector<PartitionedPolicy::Config> &partitions) {
+        for (const auto &partition : value.GetArray()) {
+            if (!partition.IsObject() || !partition.HasMember("prefix") || !partition["prefix"].IsString()
+                || !partition.HasMember("share") || !partition["share"].IsNumber()) {
+                return false;
+            }
+            PartitionedPolicy::Config config;
+            try {
+                config.prefix = ndn::Name(partition["prefix"].GetString());
+            } catch (const std::exception &e) {
+                return false;
+            }
+            config.share = partition["share"].GetDouble();
+            if (partition.HasMember("policy") && partition["policy"].IsString()) {
+                config.policy = partition["policy"].GetString();
+            }
+            partitions.emplace_back(std::move(config));
+        }
+        return true;
+    }
 
-ContentStore::ContentStore(const std::string &name, size_t size, uint16_t local_port, uint16_t local_command_port)
+    bool isSamePartitions(const std::vector<PartitionedPolicy::Config> &lhs, const std::vector<PartitionedPolicy::Config> &rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const PartitionedPolicy::Config &a, const PartitionedPolicy::Config &b) {
+            return a.prefix == b.prefix && a.share == b.share && a.policy == b.policy;
+        });
+    }
+}
+
+ContentStore::ContentStore(const std::string &name, size_t size, size_t max_bytes, const std::string &policy, uint16_t local_port, uint16_t local_command_port, size_t udp_shards, size_t shards, size_t shard_prefix_length)
         : Module(1)
         , _name(name)
-        , _cs(size)
-        , _command_socket(_ios, {{}, local_command_port})
+        , _size(size)
+        , _max_bytes(max_bytes)
+        , _policy(CachePolicy::create(policy, 0) ? policy : "lru")
+        , _shard_prefix_length(shard_prefix_length)
+        , _command_socket(_control_ios, {{}, local_command_port})
+        , _connection_pool(_ios)
         , _report_timer(_ios)
-        , _delay_between_report(0) {
-    _tcp_ingress_master_face = std::make_shared<TcpMasterFace>(_ios, 16, local_port);
-    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, 16, local_port);
+        , _delay_between_report(0)
+        , _alarm_timer(_ios)
+        , _pending_misses(std::chrono::milliseconds(4000), PENDING_MISSES_MAX_ENTRIES)
+        , _loop_monitor(_ios)
+        , _memory_budget(_ios)
+        , _snapshot_timer(_ios)
+        , _delay_between_snapshots(0) {
+    shards = std::max<size_t>(shards, 1);
+    for (size_t i = 0; i < shards; ++i) {
+        _shards.emplace_back(new CacheShard(_ios, shards > 1, size / shards + (i < size % shards), (max_bytes + shards - 1) / shards,
+                                            _policy, boost::bind(&ContentStore::onCacheMiss, this, _1, _2, _3)));
+    }
+    _tcp_ingress_master_face = std::make_shared<TcpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port, udp_shards);
+    _shm_ingress_master_face = std::make_shared<ShmMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _mem_ingress_master_face = std::make_shared<MemoryMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _metrics.addCollector(boost::bind(&ContentStore::writeMetrics, this, _1));
+}
+
+ContentStore::~ContentStore() {
+    if (_snapshot_reader.joinable()) {
+        _snapshot_reader.join();
+    }
 }
 
 void ContentStore::run() {
+    // before the ingress accepts any face, the commands are then read as usual
+    _startup_config.apply(_ios, _remote_command_endpoint, [this](const rapidjson::Document &command) {
+        executeCommand(command);
+    });
     commandRead();
+    _loop_monitor.start();
+    for (auto &shard : _shards) {
+        shard->start();
+    }
+    if (!_snapshot_path.empty()) {
+        // Interests are served while the snapshot is read and restored
+        std::string path = _snapshot_path;
+        _snapshot_reader = std::thread([this, path]() {
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                logger::log(logger::INFO, "no content store snapshot in " + path);
+                return;
+            }
+            auto snapshot = std::make_shared<const std::string>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            _ios.post(boost::bind(&ContentStore::restoreSnapshot, this, snapshot, 0, path));
+        });
+        if (_delay_between_snapshots.total_seconds() > 0) {
+            _snapshot_timer.expires_from_now(_delay_between_snapshots);
+            _snapshot_timer.async_wait(boost::bind(&ContentStore::onSnapshotTimer, this, _1));
+        }
+    }
     _tcp_ingress_master_face->listen(boost::bind(&ContentStore::onMasterFaceNotification, this, _1, _2),
-                               boost::bind(&ContentStore::onIngressInterest, this, _1, _2),
-                               boost::bind(&ContentStore::onIngressData, this, _1, _2),
-                               boost::bind(&ContentStore::onMasterFaceError, this, _1, _2));
+                                     PacketHandler::bind<ContentStore, &ContentStore::onIngressPacket>(this),
+                                     boost::bind(&ContentStore::onMasterFaceError, this, _1, _2));
     _udp_ingress_master_face->listen(boost::bind(&ContentStore::onMasterFaceNotification, this, _1, _2),
-                                     boost::bind(&ContentStore::onIngressInterest, this, _1, _2),
-                                     boost::bind(&ContentStore::onIngressData, this, _1, _2),
+                                     PacketHandler::bind<ContentStore, &ContentStore::onIngressPacket>(this),
+                                     boost::bind(&ContentStore::onMasterFaceError, this, _1, _2));
+    _shm_ingress_master_face->listen(boost::bind(&ContentStore::onMasterFaceNotification, this, _1, _2),
+                                     PacketHandler::bind<ContentStore, &ContentStore::onIngressPacket>(this),
+                                     boost::bind(&ContentStore::onMasterFaceError, this, _1, _2));
+    _mem_ingress_master_face->listen(boost::bind(&ContentStore::onMasterFaceNotification, this, _1, _2),
+                                     PacketHandler::bind<ContentStore, &ContentStore::onIngressPacket>(this),
                                      boost::bind(&ContentStore::onMasterFaceError, this, _1, _2));
 }
 
-void ContentStore::onIngressInterest(const std::shared_ptr<Face> &ingress_face, const ndn::Interest &interest) {
-    //std::cout << interest.getName();
-    auto entry = _cs.get(interest);
-    if (entry) {
-        //std::cout << " -> respond with cache" << std::endl;
-        ingress_face->send(entry->getData());
-        ++_hit_counter;
-    } else {
-        //std::cout << " -> forward packet" << std::endl;
-        for (auto& egress_face : _egress_faces) {
-            egress_face->send(interest);
+void ContentStore::beginDrain() {
+    _tcp_ingress_master_face->stopAccepting();
+    _udp_ingress_master_face->stopAccepting();
+    _shm_ingress_master_face->stopAccepting();
+    _mem_ingress_master_face->stopAccepting();
+}
+
+bool ContentStore::isDrained() {
+    if (getQueuedPackets() > 0) {
+        return false;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (_pending_misses.getWaiting(now) > 0) {
+        return false;
+    }
+    for (const auto &pending : _peer_pending) {
+        if (now - pending.second < std::chrono::seconds(PEER_PENDING_LIFETIME)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t ContentStore::getQueuedPackets() const {
+    size_t queued = _tcp_ingress_master_face->getQueuedPackets() + _udp_ingress_master_face->getQueuedPackets()
+                    + _shm_ingress_master_face->getQueuedPackets() + _mem_ingress_master_face->getQueuedPackets();
+    for (const auto &face : _egress_faces) {
+        queued += face->getQueueStats().packets;
+    }
+    return queued;
+}
+
+bool ContentStore::enableDiskTier(const std::string &directory, size_t size) {
+    if (_shards.size() == 1) {
+        return _shards.front()->call([&](LruCache &cache) {
+            return cache.enableDiskTier(directory, size);
+        });
+    }
+    if (::mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        logger::log(logger::ERROR, "can't create cache directory " + directory + ": " + std::strerror(errno));
+        return false;
+    }
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        std::string shard_directory = directory + "/shard-" + std::to_string(i);
+        size_t shard_size = size / _shards.size();
+        if (!_shards[i]->call([&](LruCache &cache) { return cache.enableDiskTier(shard_directory, shard_size); })) {
+            return false;
         }
-        ++_miss_counter;
     }
+    return true;
+}
+
+bool ContentStore::enableSharedTier(const std::string &name, size_t size) {
+    auto shared = std::make_shared<SharedTier>(name);
+    if (!shared->open(size)) {
+        return false;
+    }
+    for (auto &shard : _shards) {
+        shard->call([&shared](LruCache &cache) {
+            cache.setSharedTier(shared);
+        });
+    }
+    _shared_tier = shared;
+    return true;
+}
+
+bool ContentStore::enableMemoryBudget(size_t percent) {
+    return _memory_budget.start(percent, boost::bind(&ContentStore::onMemoryBudget, this, _1));
+}
+
+void ContentStore::onIngressPacket(const std::shared_ptr<Face> &ingress_face, NdnPacket &&packet) {
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST:
+            onIngressInterest(ingress_face, std::move(packet));
+            break;
+        case NdnPacket::DATA:
+            onIngressData(ingress_face, std::move(packet));
+            break;
+        default:
+            break;
+    }
+}
+
+CacheShard& ContentStore::getShard(const NdnPacket &packet) {
+    if (_shards.size() == 1) {
+        return *_shards.front();
+    }
+    const NameView &name = packet.getNameView();
+    return *_shards[name.getPrefixHash(std::min(name.size(), _shard_prefix_length)) % _shards.size()];
+}
+
+size_t ContentStore::getShardMaxBytes(size_t max_bytes) const {
+    return (max_bytes + _shards.size() - 1) / _shards.size();
+}
+
+void ContentStore::setSize(size_t size) {
+    _size = size;
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        size_t shard_size = size / _shards.size() + (i < size % _shards.size());
+        _shards[i]->call([shard_size](LruCache &cache) {
+            cache.setSize(shard_size);
+        });
+    }
+}
+
+void ContentStore::setMaxBytes(size_t max_bytes) {
+    _max_bytes = max_bytes;
+    size_t shard_max_bytes = getShardMaxBytes(max_bytes);
+    for (auto &shard : _shards) {
+        shard->call([shard_max_bytes](LruCache &cache) {
+            cache.setMaxBytes(shard_max_bytes);
+        });
+    }
+}
+
+void ContentStore::onMemoryBudget(size_t budget) {
+    setMaxBytes(budget);
+    size_t size = budget / (sizeof(CacheEntry) + CacheEntry::OVERHEAD);
+    if (size > _size) {
+        setSize(size);
+    }
+    logger::log(logger::INFO, "cache budget of {} bytes, {} entries at most", {budget, _size});
+}
+
+void ContentStore::onIngressInterest(const std::shared_ptr<Face> &ingress_face, NdnPacket &&packet) {
+    //std::cout << interest.getName();
+    // the segments asked ahead are the first work shed
+    if (_prefetcher.isEnabled() && !_loop_monitor.isOverloaded()) {
+        prefetch(packet);
+    }
+    CacheShard &shard = getShard(packet);
+    shard.submit(ingress_face, std::move(packet), true);
 }
 
-void ContentStore::onIngressData(const std::shared_ptr<Face> &ingress_face, const ndn::Data &data) {
-    _cs.insert(data);
+void ContentStore::onIngressData(const std::shared_ptr<Face> &ingress_face, NdnPacket &&packet) {
+    // the cache and the egress faces share the received buffer
     for (auto& egress_face : _egress_faces) {
-        egress_face->send(data);
+        egress_face->send(packet);
+    }
+    // while overloaded the Data is only passed on
+    if (_loop_monitor.isOverloaded()) {
+        ++_shed_insert_counter;
+        return;
+    }
+    CacheShard &shard = getShard(packet);
+    shard.submit(ingress_face, std::move(packet), true);
+}
+
+void ContentStore::onEgressPacket(const std::shared_ptr<Face> &egress_face, NdnPacket &&packet) {
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST:
+            onEgressInterest(egress_face, std::move(packet));
+            break;
+        case NdnPacket::DATA:
+            onEgressData(egress_face, std::move(packet));
+            break;
+        default:
+            break;
     }
 }
 
-void ContentStore::onEgressInterest(const std::shared_ptr<Face> &egress_face, const ndn::Interest &interest) {
+void ContentStore::onEgressInterest(const std::shared_ptr<Face> &egress_face, NdnPacket &&packet) {
     //std::cout << interest.getName();
-    auto entry = _cs.get(interest);
-    if (entry) {
-        //std::cout << " -> respond with cache" << std::endl;
-        egress_face->send(entry->getData());
-        ++_hit_counter;
+    CacheShard &shard = getShard(packet);
+    shard.submit(egress_face, std::move(packet), false);
+}
+
+void ContentStore::onEgressData(const std::shared_ptr<Face> &egress_face, NdnPacket &&packet) {
+    // a prefetched Data waits in the cache for its consumer
+    if (!_prefetcher.isEnabled() || !_prefetcher.onData(packet.getNameView(), packet.getBlock().size())) {
+        sendDataToIngress(packet);
+        // while overloaded the Data is only passed on, a prefetched one is still kept for its consumer
+        if (_loop_monitor.isOverloaded()) {
+            ++_shed_insert_counter;
+            return;
+        }
+    }
+    CacheShard &shard = getShard(packet);
+    shard.submit(egress_face, std::move(packet), false);
+}
+
+void ContentStore::prefetch(const NdnPacket &packet) {
+    if (getOwnerPeer(packet)) {
+        return;
+    }
+    _prefetcher.onInterest(packet.getNameView(), std::chrono::steady_clock::now(), _prefetch_names);
+    for (const auto &name : _prefetch_names) {
+        ndn::Interest interest(name);
+        interest.setCanBePrefix(false);
+        interest.setInterestLifetime(ndn::time::seconds(Prefetcher::LIFETIME));
+        for (auto &egress_face : _egress_faces) {
+            egress_face->send(interest);
+        }
+    }
+    _prefetch_names.clear();
+}
+
+void ContentStore::sendDataToIngress(const NdnPacket &packet) {
+    // the Verified tag of a signature verifier goes on with the Data to the faces which carry it
+    const std::shared_ptr<const ndn::Buffer> &wire = packet.getWire();
+    std::shared_ptr<const ndn::Buffer> tagged_wire = wire;
+    LpLink::VerifiedTag tag;
+    if (packet.getLpPacket() && LpLink::readVerified(packet.getLpPacket(), packet.getLpPacketSize(), tag)) {
+        tagged_wire = LpLink::verified(wire->data(), wire->size(), tag);
+    }
+    if (_coalescing && _pending_misses.take(packet.getNameView(), _waiting_faces)) {
+        for (const auto &face : _waiting_faces) {
+            face->send(face->carriesLpPacket(tagged_wire->size()) ? tagged_wire : wire);
+        }
+        _waiting_faces.clear();
+        return;
+    }
+    _tcp_ingress_master_face->sendToAllFaces(tagged_wire);
+    _udp_ingress_master_face->sendToAllFaces(tagged_wire->size() <= LpLink::getMtu() ? tagged_wire : wire);
+    _shm_ingress_master_face->sendToAllFaces(packet);
+    _mem_ingress_master_face->sendToAllFaces(packet);
+}
+
+void ContentStore::onCacheMiss(const std::shared_ptr<Face> &face, const NdnPacket &packet, bool from_ingress) {
+    //std::cout << " -> forward packet" << std::endl;
+    if (from_ingress) {
+        // the Interests for a Name already forwarded wait for its Data
+        if (_coalescing && !_pending_misses.add(packet.getNameView().getHash(), face, std::chrono::steady_clock::now())) {
+            ++_coalesced_counter;
+            return;
+        }
+        // a Name another clone owns is asked to it rather than upstream, unless a clone already sent it here
+        if (auto owner = getOwnerPeer(packet)) {
+            if (!isPeer(face)) {
+                addPeerPending(packet);
+                owner->send(packet);
+                return;
+            }
+        }
+        for (auto& egress_face : _egress_faces) {
+            egress_face->send(packet);
+        }
     } else {
-        //std::cout << " -> forward packet" << std::endl;
-        _tcp_ingress_master_face->sendToAllFaces(interest);
-        _udp_ingress_master_face->sendToAllFaces(interest);
-        ++_miss_counter;
+        _tcp_ingress_master_face->sendToAllFaces(packet);
+        _udp_ingress_master_face->sendToAllFaces(packet);
+        _shm_ingress_master_face->sendToAllFaces(packet);
+        _mem_ingress_master_face->sendToAllFaces(packet);
+    }
+}
+
+void ContentStore::onPeerPacket(const std::shared_ptr<Face> &peer_face, const NdnPacket &packet) {
+    // the owner sends all the Data it gets to its ingress, only those asked for by this clone are passed on, and
+    // they aren't cached twice
+    if (packet.getType() == NdnPacket::DATA && takePeerPending(packet)) {
+        getShard(packet).onAnswered(packet);
+        sendDataToIngress(packet);
+    }
+}
+
+void ContentStore::updateNegativeParameters() {
+    // the Interests attached to a pending miss are answered, suppressing them would leave their faces without Data
+    NegativeCache::Parameters parameters = _negative_parameters;
+    if (_coalescing) {
+        parameters.suppression_window = ndn::time::milliseconds(0);
+    }
+    for (auto &shard : _shards) {
+        shard->call([&](LruCache &cache) {
+            cache.setNegativeParameters(parameters);
+        });
+    }
+}
+
+void ContentStore::updateClusterKeys() {
+    _cluster_key_hashes.clear();
+    if (_cluster_endpoint.empty()) {
+        return;
+    }
+    _cluster_key_hashes.emplace_back(rendezvous_hash::hashKey(_cluster_endpoint));
+    for (const auto &face : _peer_faces) {
+        _cluster_key_hashes.emplace_back(rendezvous_hash::hashKey(face->getUnderlyingEndpoint()));
+    }
+}
+
+std::shared_ptr<Face> ContentStore::getOwnerPeer(const NdnPacket &packet) const {
+    if (_cluster_key_hashes.size() < 2) {
+        return nullptr;
     }
+    const NameView &name = packet.getNameView();
+    size_t owner = rendezvous_hash::select(name.getPrefixHash(std::min(name.size(), _cluster_prefix_length)), _cluster_key_hashes);
+    return owner > 0 ? _peer_faces[owner - 1] : nullptr;
 }
 
-void ContentStore::onEgressData(const std::shared_ptr<Face> &egress_face, const ndn::Data &data) {
-    _cs.insert(data);
-    _tcp_ingress_master_face->sendToAllFaces(data);
-    _udp_ingress_master_face->sendToAllFaces(data);
+bool ContentStore::isPeer(const std::shared_ptr<Face> &face) const {
+    // the connections of the peers come from their address on another port than the one they listen on
+    std::string endpoint = face->getUnderlyingEndpoint();
+    std::string address = endpoint.substr(0, endpoint.rfind(':'));
+    for (const auto &peer_face : _peer_faces) {
+        std::string peer_endpoint = peer_face->getUnderlyingEndpoint();
+        if (peer_endpoint.compare(0, peer_endpoint.rfind(':'), address) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ContentStore::addPeerPending(const NdnPacket &packet) {
+    auto now = std::chrono::steady_clock::now();
+    if (_peer_pending.size() >= PEER_PENDING_MAX_ENTRIES) {
+        for (auto it = _peer_pending.begin(); it != _peer_pending.end();) {
+            it = now - it->second > std::chrono::seconds(PEER_PENDING_LIFETIME) ? _peer_pending.erase(it) : std::next(it);
+        }
+    }
+    _peer_pending[packet.getNameView().getHash()] = now;
+}
+
+bool ContentStore::takePeerPending(const NdnPacket &packet) {
+    // the Data Name may be longer than the Interest one, each of its prefixes is tried, the shortest first
+    const NameView &name = packet.getNameView();
+    for (size_t i = 0; i <= name.size(); ++i) {
+        auto it = _peer_pending.find(name.getPrefixHash(i));
+        if (it != _peer_pending.end()) {
+            _peer_pending.erase(it);
+            return true;
+        }
+    }
+    return false;
 }
 
 void ContentStore::onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "new " << " face with ID = " << face->getFaceId() << " form master face with ID = " << master_face->getMasterFaceId();
-    logger::log(logger::INFO, ss.str());
+    logger::log(logger::INFO, "new face with ID = {} form master face with ID = {}",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void ContentStore::onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << " face with ID = " << face->getFaceId() << " from master face with ID = " << master_face->getMasterFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    logger::log(logger::ERROR, " face with ID = {} from master face with ID = {} can't process normally",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void ContentStore::onFaceError(const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << " face with ID = " << face->getFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    logger::log(logger::ERROR, " face with ID = {} can't process normally", {face->getFaceId()});
     for (auto& egress_face : _egress_faces) {
         if(egress_face == face) {
             std::swap(egress_face, _egress_faces.back());
@@ -98,6 +480,11 @@ void ContentStore::onFaceError(const std::shared_ptr<Face> &face) {
             break;
         }
     }
+    auto it = std::find(_peer_faces.begin(), _peer_faces.end(), face);
+    if (it != _peer_faces.end()) {
+        _peer_faces.erase(it);
+        updateClusterKeys();
+    }
 }
 
 void ContentStore::commandRead() {
@@ -106,38 +493,18 @@ void ContentStore::commandRead() {
 }
 
 void ContentStore::commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred) {
-    enum action_type {
-        EDIT_CONFIG,
-        ADD_FACE,
-        DEL_FACE,
-    };
-
-    static const std::map<std::string, action_type> ACTIONS = {
-            {"edit_config", EDIT_CONFIG},
-            {"add_face", ADD_FACE},
-            {"del_face", DEL_FACE},
-    };
-
     if(!err) {
         try {
             rapidjson::Document document;
             document.Parse(_command_buffer, bytes_transferred);
             if(!document.HasParseError()){
                 if(document.HasMember("action") && document["action"].IsString() && document.HasMember("id") && document["id"].IsUint()){
-                    auto it = ACTIONS.find(document["action"].GetString());
-                    if(it != ACTIONS.end()) {
-                        switch (it->second) {
-                            case EDIT_CONFIG:
-                                commandEditConfig(document);
-                                break;
-                            case ADD_FACE:
-                                commandAddFace(document);
-                                break;
-                            case DEL_FACE:
-                                commandDelFace(document);
-                                break;
-                        }
-                    }
+                    // applied on the module thread, the next command is read once it is done
+                    auto command = std::make_shared<rapidjson::Document>(std::move(document));
+                    applyCommand([this, command]() {
+                        executeCommand(*command);
+                    }, boost::bind(&ContentStore::commandRead, this));
+                    return;
                 } else{
                     //std::string response = R"({"status":"fail", "reason":"action not provided or not implemented"})";
                     //_command_socket.send_to(boost::asio::buffer(response), _remote_command_endpoint);
@@ -156,19 +523,345 @@ void ContentStore::commandReadHandler(const boost::system::error_code &err, size
     }
 }
 
+void ContentStore::executeCommand(const rapidjson::Document &document) {
+    enum action_type {
+        EDIT_CONFIG,
+        ADD_FACE,
+        DEL_FACE,
+        LIST,
+        EXPORT_STATE,
+        IMPORT_STATE,
+        MEMORY_STATS,
+        PROFILE,
+    };
+
+    static const std::map<std::string, action_type> ACTIONS = {
+            {"edit_config", EDIT_CONFIG},
+            {"add_face", ADD_FACE},
+            {"del_face", DEL_FACE},
+            {"list", LIST},
+            {"export_state", EXPORT_STATE},
+            {"import_state", IMPORT_STATE},
+            {"memory_stats", MEMORY_STATS},
+            {"profile", PROFILE},
+    };
+
+    auto it = ACTIONS.find(document["action"].GetString());
+    if (it == ACTIONS.end()) {
+        return;
+    }
+    switch (it->second) {
+        case EDIT_CONFIG:
+            commandEditConfig(document);
+            break;
+        case ADD_FACE:
+            commandAddFace(document);
+            break;
+        case DEL_FACE:
+            commandDelFace(document);
+            break;
+        case LIST:
+            commandList(document);
+            break;
+        case EXPORT_STATE:
+            commandExportState(document);
+            break;
+        case IMPORT_STATE:
+            commandImportState(document);
+            break;
+        case MEMORY_STATS:
+            commandMemoryStats(document);
+            break;
+        case PROFILE:
+            commandProfile(document);
+            break;
+    }
+}
+
 void ContentStore::commandEditConfig(const rapidjson::Document &document) {
     std::vector<std::string> changes;
     if (document.HasMember("size") && document["size"].IsUint()) {
         bool has_change = false;
         size_t new_size = document["size"].GetUint();
-        if (new_size != _cs.getSize()) {
-            _cs.setSize(new_size);
+        if (new_size != _size) {
+            setSize(new_size);
             has_change = true;
         }
         if (has_change) {
             changes.emplace_back("size");
         }
     }
+    if (document.HasMember("max_bytes") && document["max_bytes"].IsUint64()) {
+        bool has_change = false;
+        size_t max_bytes = document["max_bytes"].GetUint64();
+        if (max_bytes != _max_bytes) {
+            setMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("max_bytes");
+        }
+    }
+    if (document.HasMember("policy") && document["policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["policy"].GetString();
+        if (policy != _policy && CachePolicy::create(policy, 0)) {
+            _policy = policy;
+            for (auto &shard : _shards) {
+                shard->call([&policy](LruCache &cache) {
+                    return cache.setPolicy(policy);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("policy");
+        }
+    }
+    if ((document.HasMember("partitions") && document["partitions"].IsArray())
+        || (document.HasMember("partition_borrowing") && document["partition_borrowing"].IsBool())) {
+        bool has_change = false;
+        std::vector<PartitionedPolicy::Config> partitions;
+        bool is_valid = true;
+        if (document.HasMember("partitions") && document["partitions"].IsArray()) {
+            is_valid = readPartitions(document["partitions"], partitions);
+        } else {
+            partitions = _partitions;
+        }
+        bool is_borrowing = document.HasMember("partition_borrowing") && document["partition_borrowing"].IsBool() ? document["partition_borrowing"].GetBool() : _is_partition_borrowing;
+        if (is_valid && (!isSamePartitions(partitions, _partitions) || is_borrowing != _is_partition_borrowing)
+            && (partitions.empty() || PartitionedPolicy::create(_policy, partitions, is_borrowing, 0))) {
+            _partitions = partitions;
+            _is_partition_borrowing = is_borrowing;
+            for (auto &shard : _shards) {
+                shard->call([&](LruCache &cache) {
+                    return cache.setPartitions(partitions, is_borrowing);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("partitions");
+        }
+    }
+    if ((document.HasMember("admission") && document["admission"].IsString())
+        || (document.HasMember("admission_probability") && document["admission_probability"].IsNumber())
+        || (document.HasMember("admission_max_size") && document["admission_max_size"].IsUint())) {
+        bool has_change = false;
+        std::string admission = document.HasMember("admission") && document["admission"].IsString() ? document["admission"].GetString() : _admission;
+        AdmissionPolicy::Parameters parameters = _admission_parameters;
+        if (document.HasMember("admission_probability") && document["admission_probability"].IsNumber()) {
+            parameters.probability = document["admission_probability"].GetDouble();
+        }
+        if (document.HasMember("admission_max_size") && document["admission_max_size"].IsUint()) {
+            parameters.max_size = document["admission_max_size"].GetUint();
+        }
+        if ((admission != _admission || parameters.probability != _admission_parameters.probability
+             || parameters.max_size != _admission_parameters.max_size) && AdmissionPolicy::create(admission, 0, parameters)) {
+            _admission = admission;
+            _admission_parameters = parameters;
+            for (auto &shard : _shards) {
+                shard->call([&](LruCache &cache) {
+                    return cache.setAdmission(admission, parameters);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("admission");
+        }
+    }
+    if ((document.HasMember("negative_ttl") && document["negative_ttl"].IsUint())
+        || (document.HasMember("negative_timeout") && document["negative_timeout"].IsUint())
+        || (document.HasMember("suppression_window") && document["suppression_window"].IsUint())) {
+        bool has_change = false;
+        NegativeCache::Parameters parameters = _negative_parameters;
+        if (document.HasMember("negative_ttl") && document["negative_ttl"].IsUint()) {
+            parameters.ttl = ndn::time::milliseconds(document["negative_ttl"].GetUint());
+        }
+        if (document.HasMember("negative_timeout") && document["negative_timeout"].IsUint()) {
+            parameters.timeout = ndn::time::milliseconds(document["negative_timeout"].GetUint());
+        }
+        if (document.HasMember("suppression_window") && document["suppression_window"].IsUint()) {
+            parameters.suppression_window = ndn::time::milliseconds(document["suppression_window"].GetUint());
+        }
+        if (parameters.ttl != _negative_parameters.ttl || parameters.timeout != _negative_parameters.timeout
+            || parameters.suppression_window != _negative_parameters.suppression_window) {
+            _negative_parameters = parameters;
+            updateNegativeParameters();
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("negative_cache");
+        }
+    }
+    if (document.HasMember("coalescing") && document["coalescing"].IsBool()) {
+        bool has_change = false;
+        bool coalescing = document["coalescing"].GetBool();
+        if (coalescing != _coalescing) {
+            _coalescing = coalescing;
+            _pending_misses.clear();
+            updateNegativeParameters();
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("coalescing");
+        }
+    }
+    if (document.HasMember("dedup") && document["dedup"].IsBool()) {
+        bool has_change = false;
+        bool dedup = document["dedup"].GetBool();
+        if (dedup != _dedup) {
+            _dedup = dedup;
+            for (auto &shard : _shards) {
+                shard->call([dedup](LruCache &cache) {
+                    cache.setDeduplication(dedup);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("dedup");
+        }
+    }
+    if (document.HasMember("eviction_batch") && document["eviction_batch"].IsUint()) {
+        bool has_change = false;
+        size_t batch = std::max<size_t>(document["eviction_batch"].GetUint(), 1);
+        if (batch != _eviction_batch) {
+            _eviction_batch = batch;
+            for (auto &shard : _shards) {
+                shard->call([batch](LruCache &cache) {
+                    cache.setEvictionBatch(batch);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("eviction_batch");
+        }
+    }
+    if (document.HasMember("compression_age") && document["compression_age"].IsUint() && lz4_codec::isAvailable()) {
+        bool has_change = false;
+        size_t age = document["compression_age"].GetUint();
+        if (age != _compression_age) {
+            _compression_age = age;
+            for (auto &shard : _shards) {
+                shard->call([age](LruCache &cache) {
+                    cache.setCompressionAge(ndn::time::seconds(age));
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("compression_age");
+        }
+    }
+    if ((document.HasMember("prefetch_window") && document["prefetch_window"].IsUint())
+        || (document.HasMember("prefetch_max_bytes") && document["prefetch_max_bytes"].IsUint64())) {
+        bool has_change = false;
+        Prefetcher::Parameters parameters = _prefetcher.getParameters();
+        if (document.HasMember("prefetch_window") && document["prefetch_window"].IsUint()) {
+            parameters.window = document["prefetch_window"].GetUint();
+        }
+        if (document.HasMember("prefetch_max_bytes") && document["prefetch_max_bytes"].IsUint64()) {
+            parameters.max_bytes = document["prefetch_max_bytes"].GetUint64();
+        }
+        if (parameters.window != _prefetcher.getParameters().window || parameters.max_bytes != _prefetcher.getParameters().max_bytes) {
+            _prefetcher.setParameters(parameters);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("prefetch");
+        }
+    }
+    if (document.HasMember("overload_lag") && document["overload_lag"].IsUint()) {
+        bool has_change = false;
+        size_t threshold = document["overload_lag"].GetUint();
+        if (threshold != _loop_monitor.getThreshold()) {
+            _loop_monitor.setThreshold(threshold);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("overload_lag");
+        }
+    }
+    if (document.HasMember("coalescing_lifetime") && document["coalescing_lifetime"].IsUint()) {
+        bool has_change = false;
+        std::chrono::milliseconds lifetime(document["coalescing_lifetime"].GetUint());
+        if (lifetime != _pending_misses.getLifetime()) {
+            _pending_misses.setLifetime(lifetime);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("coalescing_lifetime");
+        }
+    }
+    if ((document.HasMember("prefix_stats_depth") && document["prefix_stats_depth"].IsUint())
+        || (document.HasMember("prefix_stats_entries") && document["prefix_stats_entries"].IsUint())) {
+        bool has_change = false;
+        size_t depth = document.HasMember("prefix_stats_depth") && document["prefix_stats_depth"].IsUint() ? document["prefix_stats_depth"].GetUint() : _prefix_stats_depth;
+        size_t entries = document.HasMember("prefix_stats_entries") && document["prefix_stats_entries"].IsUint() ? document["prefix_stats_entries"].GetUint() : _prefix_stats_entries;
+        if (depth != _prefix_stats_depth || entries != _prefix_stats_entries) {
+            _prefix_stats_depth = depth;
+            _prefix_stats_entries = entries;
+            for (auto &shard : _shards) {
+                shard->call([depth, entries](LruCache &cache) {
+                    cache.setPrefixStats(depth, entries);
+                });
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("prefix_stats");
+        }
+    }
+    if (document.HasMember("cluster_endpoint") && document["cluster_endpoint"].IsString()) {
+        bool has_change = false;
+        std::string endpoint = document["cluster_endpoint"].GetString();
+        if (endpoint != _cluster_endpoint) {
+            _cluster_endpoint = endpoint;
+            updateClusterKeys();
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("cluster_endpoint");
+        }
+    }
+    if (document.HasMember("cluster_prefix_length") && document["cluster_prefix_length"].IsUint()) {
+        bool has_change = false;
+        size_t prefix_length = document["cluster_prefix_length"].GetUint();
+        if (prefix_length != _cluster_prefix_length) {
+            _cluster_prefix_length = prefix_length;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("cluster_prefix_length");
+        }
+    }
+    if (document.HasMember("udp_batch_size") && document["udp_batch_size"].IsUint()) {
+        bool has_change = false;
+        auto udp_master_face = std::static_pointer_cast<UdpMasterFace>(_udp_ingress_master_face);
+        size_t batch_size = document["udp_batch_size"].GetUint();
+        if (batch_size != udp_master_face->getBatchSize()) {
+            udp_master_face->setBatchSize(batch_size);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_batch_size");
+        }
+    }
+    if (document.HasMember("udp_segmentation") && document["udp_segmentation"].IsBool()) {
+        bool has_change = false;
+        auto udp_master_face = std::static_pointer_cast<UdpMasterFace>(_udp_ingress_master_face);
+        bool segmentation = document["udp_segmentation"].GetBool();
+        if (segmentation != udp_master_face->isSegmenting()) {
+            udp_master_face->setSegmentation(segmentation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_segmentation");
+        }
+    }
     if (document.HasMember("manager_address") && document.HasMember("manager_port") && document["manager_address"].IsString() && document["manager_port"].IsUint()) {
         bool has_change = false;
         boost::asio::ip::udp::endpoint new_endpoint(boost::asio::ip::address::from_string(document["manager_address"].GetString()), document["manager_port"].GetUint());
@@ -201,6 +894,235 @@ void ContentStore::commandEditConfig(const rapidjson::Document &document) {
             changes.emplace_back("report_each");
         }
     }
+    if (document.HasMember("report_delta") && document["report_delta"].IsBool()) {
+        bool report_delta = document["report_delta"].GetBool();
+        if (report_delta != _report_delta) {
+            if (report_delta) {
+                // a last full report, the deltas start from it
+                sendReport("");
+                makeDeltaReport("");
+            }
+            _report_delta = report_delta;
+            changes.emplace_back("report_delta");
+        }
+    }
+    // in percent, 0 disables it
+    if (document.HasMember("hit_ratio_alarm") && document["hit_ratio_alarm"].IsUint()) {
+        size_t trigger = std::min(document["hit_ratio_alarm"].GetUint(), 100u);
+        if (trigger != (_hit_ratio_alarm.isEnabled() ? _hit_ratio_alarm.getTrigger() : 0)) {
+            if (trigger > 0) {
+                _hit_ratio_alarm.set(trigger, trigger + HIT_RATIO_HYSTERESIS);
+            } else {
+                _hit_ratio_alarm.disable();
+            }
+            changes.emplace_back("hit_ratio_alarm");
+        }
+    }
+    // in packets queued on the faces, 0 disables it
+    if (document.HasMember("queue_alarm") && document["queue_alarm"].IsUint()) {
+        size_t trigger = document["queue_alarm"].GetUint();
+        if (trigger != (_queue_alarm.isEnabled() ? _queue_alarm.getTrigger() : 0)) {
+            if (trigger > 0) {
+                _queue_alarm.set(trigger, trigger / 2);
+            } else {
+                _queue_alarm.disable();
+            }
+            changes.emplace_back("queue_alarm");
+        }
+    }
+    armAlarms();
+    if (document.HasMember("tcp_gather_bytes") && document["tcp_gather_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["tcp_gather_bytes"].GetUint();
+        if (max_bytes != TcpFace::getGatherMaxBytes()) {
+            TcpFace::setGatherMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_bytes");
+        }
+    }
+    if (document.HasMember("tcp_gather_packets") && document["tcp_gather_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["tcp_gather_packets"].GetUint();
+        if (max_packets != TcpFace::getGatherMaxPackets()) {
+            TcpFace::setGatherMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_packets");
+        }
+    }
+    if (document.HasMember("tcp_max_packet_size") && document["tcp_max_packet_size"].IsUint()) {
+        bool has_change = false;
+        size_t size = document["tcp_max_packet_size"].GetUint();
+        if (size != TcpFace::getMaxPacketSize()) {
+            has_change = TcpFace::setMaxPacketSize(size);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_max_packet_size");
+        }
+    }
+    if (document.HasMember("tcp_flush") && document["tcp_flush"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_flush"].GetString();
+        if (policy != TcpFace::getFlushPolicy()) {
+            has_change = TcpFace::setFlushPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_flush");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_min_delay") && document["tcp_reconnect_min_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_min_delay"].GetUint();
+        if (value != TcpFace::getReconnectMinDelay()) {
+            TcpFace::setReconnectMinDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_min_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_max_delay") && document["tcp_reconnect_max_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_max_delay"].GetUint();
+        if (value != TcpFace::getReconnectMaxDelay()) {
+            TcpFace::setReconnectMaxDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_max_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_attempts") && document["tcp_reconnect_attempts"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_attempts"].GetUint();
+        if (value != TcpFace::getReconnectAttempts()) {
+            TcpFace::setReconnectAttempts(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_attempts");
+        }
+    }
+    if (document.HasMember("tcp_replay_max_age") && document["tcp_replay_max_age"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_replay_max_age"].GetUint();
+        if (value != TcpFace::getReplayMaxAge()) {
+            TcpFace::setReplayMaxAge(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_replay_max_age");
+        }
+    }
+    if (document.HasMember("tcp_credit_window") && document["tcp_credit_window"].IsUint()) {
+        bool has_change = false;
+        size_t window = document["tcp_credit_window"].GetUint();
+        if (window != TcpFace::getCreditWindow()) {
+            TcpFace::setCreditWindow(window);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_window");
+        }
+    }
+    if (document.HasMember("tcp_credit_policy") && document["tcp_credit_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_credit_policy"].GetString();
+        if (policy != TcpFace::getCreditPolicy()) {
+            has_change = TcpFace::setCreditPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_policy");
+        }
+    }
+    if (document.HasMember("udp_mtu") && document["udp_mtu"].IsUint()) {
+        bool has_change = false;
+        size_t mtu = document["udp_mtu"].GetUint();
+        if (mtu != LpLink::getMtu()) {
+            LpLink::setMtu(mtu);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_mtu");
+        }
+    }
+    if (document.HasMember("udp_aggregation") && document["udp_aggregation"].IsBool()) {
+        bool has_change = false;
+        bool aggregation = document["udp_aggregation"].GetBool();
+        if (aggregation != LpLink::getAggregation()) {
+            LpLink::setAggregation(aggregation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_aggregation");
+        }
+    }
+    if (document.HasMember("connection_pool") && _connection_pool.update(document["connection_pool"])) {
+        changes.emplace_back("connection_pool");
+    }
+    if (document.HasMember("socket_options")) {
+        bool has_change = false;
+        // the default of the faces created from now on, the ingress master faces change theirs at once
+        SocketOptions options = SocketOptions::getDefault();
+        if (options.update(document["socket_options"]) && options != SocketOptions::getDefault()) {
+            SocketOptions::setDefault(options);
+            for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face}) {
+                master_face->setSocketOptions(options);
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("socket_options");
+        }
+    }
+    if (document.HasMember("queue_max_packets") && document["queue_max_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["queue_max_packets"].GetUint();
+        if (max_packets != QueuePolicy::getMaxPackets()) {
+            QueuePolicy::setMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_packets");
+        }
+    }
+    if (document.HasMember("queue_max_bytes") && document["queue_max_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["queue_max_bytes"].GetUint();
+        if (max_bytes != QueuePolicy::getMaxBytes()) {
+            QueuePolicy::setMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_bytes");
+        }
+    }
+    if (document.HasMember("queue_drop_policy") && document["queue_drop_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["queue_drop_policy"].GetString();
+        if (policy != QueuePolicy::getDropPolicyName()) {
+            has_change = QueuePolicy::setDropPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_drop_policy");
+        }
+    }
+    if (document.HasMember("queue_scheduler") && document["queue_scheduler"].IsString()) {
+        bool has_change = false;
+        std::string scheduler = document["queue_scheduler"].GetString();
+        if (scheduler != QueuePolicy::getSchedulerName()) {
+            has_change = QueuePolicy::setScheduler(scheduler);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_scheduler");
+        }
+    }
+    if (document.HasMember("queue_classes") && QueuePolicy::setClasses(document["queue_classes"])) {
+        changes.emplace_back("queue_classes");
+    }
 
     std::stringstream ss;
     ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"edit_config", "changes":[)";
@@ -214,18 +1136,22 @@ void ContentStore::commandEditConfig(const rapidjson::Document &document) {
         ss << '"' << change << '"';
     }
     ss << "]}";
-    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
 }
 
 void ContentStore::commandAddFace(const rapidjson::Document &document) {
     enum layer_type {
         TCP,
         UDP,
+        SHM,
+        MEM,
     };
 
     static const std::unordered_map<std::string, layer_type> LAYERS = {
             {"tcp", TCP},
             {"udp", UDP},
+            {"shm", SHM},
+            {"mem", MEM},
     };
 
     if (document.HasMember("layer") && document.HasMember("address") && document.HasMember("port")
@@ -235,19 +1161,45 @@ void ContentStore::commandAddFace(const rapidjson::Document &document) {
             std::shared_ptr<Face> face;
             switch (it->second) {
                 case TCP:
-                    face = std::make_shared<TcpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    if (document.HasMember("connections") && document["connections"].IsUint() && document["connections"].GetUint() > 1) {
+                        // striped by Name over that many connections
+                        face = std::make_shared<StripedTcpFace>(_ios, _connection_pool, document["address"].GetString(),
+                                                                document["port"].GetUint(), document["connections"].GetUint());
+                    } else {
+                        face = _connection_pool.makeFace(_ios, document["address"].GetString(), document["port"].GetUint());
+                    }
                     break;
                 case UDP:
                     face = std::make_shared<UdpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
                     break;
+                case SHM:
+                    face = std::make_shared<ShmFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    break;
+                case MEM:
+                    face = std::make_shared<MemoryFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    break;
+            }
+            if (document.HasMember("socket_options")) {
+                // on top of the default, before open for the buffers of a TCP connection
+                SocketOptions options = SocketOptions::getDefault();
+                if (options.update(document["socket_options"])) {
+                    face->setSocketOptions(options);
+                }
+            }
+            if (document.HasMember("peer") && document["peer"].IsBool() && document["peer"].GetBool()) {
+                // to the ingress of another clone, its endpoint must be the same as its cluster_endpoint
+                _peer_faces.push_back(face);
+                updateClusterKeys();
+                face->open(PacketHandler::bind<ContentStore, &ContentStore::onPeerPacket>(this),
+                           boost::bind(&ContentStore::onFaceError, this, _1));
+            } else {
+                _egress_faces.push_back(face);
+                face->open(PacketHandler::bind<ContentStore, &ContentStore::onEgressPacket>(this),
+                           boost::bind(&ContentStore::onFaceError, this, _1));
             }
-            _egress_faces.push_back(face);
-            face->open(boost::bind(&ContentStore::onEgressInterest, this, _1, _2),
-                       boost::bind(&ContentStore::onEgressData, this, _1, _2),
-                       boost::bind(&ContentStore::onFaceError, this, _1));
             std::stringstream ss;
             ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_face", "face_id":)" << face->getFaceId() << "}";
-            _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+            sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
         }
     }
 }
@@ -265,23 +1217,288 @@ void ContentStore::commandDelFace(const rapidjson::Document &document) {
                 break;
             }
         }
+        for (auto it = _peer_faces.begin(); !ok && it != _peer_faces.end(); ++it) {
+            if ((*it)->getFaceId() == face_id) {
+                (*it)->close();
+                _peer_faces.erase(it);
+                updateClusterKeys();
+                ok = true;
+                break;
+            }
+        }
         std::stringstream ss;
         ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_face", "face_id":)" << face_id << R"(, "status":)" << ok << "}";
-        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
     }
 }
 
 void ContentStore::commandList(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list", "size":)" << _size
+       << R"(, "max_bytes":)" << _max_bytes << R"(, "used_bytes":)" << getUsedBytes()
+       << R"(, "policy":")" << _policy << R"(", "admission":")" << _admission << R"(", "shards":)" << _shards.size()
+       << R"(, "negative_ttl":)" << _negative_parameters.ttl.count() << R"(, "negative_timeout":)" << _negative_parameters.timeout.count()
+       << R"(, "suppression_window":)" << _negative_parameters.suppression_window.count()
+       << R"(, "prefix_stats_depth":)" << _prefix_stats_depth << R"(, "prefix_stats_entries":)" << _prefix_stats_entries
+       << R"(, "coalescing":)" << (_coalescing ? "true" : "false") << R"(, "coalescing_lifetime":)" << _pending_misses.getLifetime().count()
+       << R"(, "pending_misses":)" << _pending_misses.size() << R"(, "dedup":)" << (_dedup ? "true" : "false")
+       << R"(, "eviction_batch":)" << _eviction_batch << R"(, "compression_age":)" << _compression_age
+       << R"(, "shared_tier":")" << (_shared_tier ? _shared_tier->getName() : "") << "\""
+       << R"(, "prefetch_window":)" << _prefetcher.getParameters().window << R"(, "prefetch_max_bytes":)" << _prefetcher.getParameters().max_bytes
+       << R"(, "prefetch_streams":)" << _prefetcher.getStreams() << R"(, "loop":)" << _loop_monitor.toJSON()
+       << R"(, "memory_budget":)" << _memory_budget.toJSON()
+       << R"(, "cluster_endpoint":")" << _cluster_endpoint << R"(", "cluster_prefix_length":)" << _cluster_prefix_length;
+    ss << R"(, "partitions":[)";
+    for (size_t i = 0; i < _partitions.size(); ++i) {
+        ss << (i == 0 ? "" : ", ") << R"({"prefix":")" << _partitions[i].prefix.toUri() << R"(", "share":)" << _partitions[i].share
+           << R"(, "policy":")" << (_partitions[i].policy.empty() ? _policy : _partitions[i].policy) << R"("})";
+    }
+    ss << R"(], "partition_borrowing":)" << (_is_partition_borrowing ? "true" : "false");
+    ss << R"(, "faces":[)";
+    bool first = true;
+    for (const auto &face : _egress_faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face->toJSON();
+    }
+    ss << R"(], "peers":[)";
+    first = true;
+    for (const auto &face : _peer_faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face->toJSON();
+    }
+    ss << R"(], "master_faces":[)" << _tcp_ingress_master_face->toJSON() << ", " << _udp_ingress_master_face->toJSON() << ", " << _shm_ingress_master_face->toJSON() << ", " << _mem_ingress_master_face->toJSON() << "]"
+       << R"(, "connection_pool":)" << _connection_pool.toJSON() << R"(, "buffer_pool":)" << BufferPool::getStats().toJSON() << R"(, "page_arena":)" << PageArena::getStats().toJSON()
+       << R"(, "stages":)" << stage_profile::toJSON() << "}";
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+}
+
+void ContentStore::commandMemoryStats(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    MemoryStats stats;
+    LruCache::CompressionStats compression;
+    for (auto &shard : _shards) {
+        shard->call([&stats, &compression](LruCache &cache) {
+            cache.addMemoryStats(stats);
+            cache.addCompressionStats(compression);
+        });
+    }
+    if (_shared_tier) {
+        // once for all the shards, in shared memory rather than on the heap
+        stats.add("shared_tier_mapped", 1, _shared_tier->getMappedBytes());
+    }
+    stats.add("pending_misses", _pending_misses.size(), _pending_misses.getMemoryUsage());
+    stats.add("prefetcher", _prefetcher.getStreams(), _prefetcher.getMemoryUsage());
+    stats.add("peer_pending", _peer_pending.size(), memory_usage::of(_peer_pending));
+    for (const auto &face : _egress_faces) {
+        face->addMemoryStats(stats);
+    }
+    for (const auto &face : _peer_faces) {
+        face->addMemoryStats(stats);
+    }
+    _tcp_ingress_master_face->addMemoryStats(stats);
+    _udp_ingress_master_face->addMemoryStats(stats);
+    _shm_ingress_master_face->addMemoryStats(stats);
+    _mem_ingress_master_face->addMemoryStats(stats);
     std::stringstream ss;
-    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list", "size":)" << _cs.getSize() << R"(})";
-    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"memory_stats", "memory":)"
+       << stats.toJSON() << R"(, "compression":{"available":)" << (lz4_codec::isAvailable() ? "true" : "false")
+       << R"(, "entries":)" << compression.entries << R"(, "raw_bytes":)" << compression.raw_bytes
+       << R"(, "compressed_bytes":)" << compression.compressed_bytes << R"(, "ratio":)"
+       << (compression.compressed_bytes > 0 ? static_cast<double>(compression.raw_bytes) / compression.compressed_bytes : 0.0)
+       << R"(, "decompressed_count":)" << compression.decompressions << "}}";
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
 }
 
-void ContentStore::commandReport(const boost::system::error_code &err) {
-    if (!err && _manager_endpoint.address() != boost::asio::ip::address_v4::any() && _manager_endpoint.port() != 0) {
+void ContentStore::commandProfile(const rapidjson::Document &document) {
+    uint64_t id = document["id"].GetUint();
+    size_t duration = document.HasMember("duration") && document["duration"].IsUint() ? document["duration"].GetUint() : sampling_profiler::DEFAULT_DURATION_MS;
+    size_t frequency = document.HasMember("frequency") && document["frequency"].IsUint() ? document["frequency"].GetUint() : sampling_profiler::DEFAULT_FREQUENCY;
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << id << R"(, "action":"profile", )";
+    if (!sampling_profiler::start(frequency, duration)) {
+        ss << R"("status":"fail", "reason":"a profile is running or the timer can't be set"})";
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+        return;
+    }
+    logger::log(logger::INFO, "profiling for {}ms", {std::min(duration, sampling_profiler::MAX_DURATION_MS)});
+    boost::asio::ip::udp::endpoint endpoint = _remote_command_endpoint;
+    // the stacks are folded on the control thread, the module thread goes on serving meanwhile
+    auto timer = std::make_shared<boost::asio::deadline_timer>(_control_ios, boost::posix_time::milliseconds(std::min(duration, sampling_profiler::MAX_DURATION_MS)));
+    std::string reply = ss.str();
+    timer->async_wait([this, timer, reply, endpoint](const boost::system::error_code &err) {
+        sendOnControl(_command_socket, reply + R"("status":"success", "profile":)" + sampling_profiler::stop(sampling_profiler::DATAGRAM_BYTES) + "}", endpoint);
+    });
+}
+
+void ContentStore::commandExportState(const rapidjson::Document &document) {
+    uint64_t id = document["id"].GetUint();
+    if (!document.HasMember("address") || !document["address"].IsString() || !document.HasMember("port") || !document["port"].IsUint()) {
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << id << R"(, "action":"export_state", "status":"fail", "reason":"address or port not provided"})";
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+        return;
+    }
+    size_t count;
+    auto snapshot = std::make_shared<const std::string>(makeSnapshot(count));
+    std::string address = document["address"].GetString();
+    uint16_t port = static_cast<uint16_t>(document["port"].GetUint());
+    boost::asio::ip::udp::endpoint endpoint = _remote_command_endpoint;
+    // written from the control thread, the module thread goes on serving meanwhile
+    state_transfer::send(_control_ios, address, port, snapshot, [this, id, count, address, port, endpoint](const boost::system::error_code &err) {
         std::stringstream ss;
-        ss << R"({"name":")" << _name << R"(", "type":"report", "action":"cache_status", "hit_count":)" << _hit_counter << R"(, "miss_count":)" << _miss_counter << "}";
-        _command_socket.send_to(boost::asio::buffer(ss.str()), _manager_endpoint);
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << id << R"(, "action":"export_state", )";
+        if (err) {
+            logger::log(logger::ERROR, "content store state not sent to {}:{}: {}", {address, port, err.message()});
+            ss << R"("status":"fail", "reason":")" << err.message() << R"("})";
+        } else {
+            logger::log(logger::INFO, "{} entries sent to {}:{}", {count, address, port});
+            ss << R"("status":"success", "entries":)" << count << "}";
+        }
+        sendOnControl(_command_socket, ss.str(), endpoint);
+    });
+}
+
+void ContentStore::commandImportState(const rapidjson::Document &document) {
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"import_state", )";
+    if (!document.HasMember("port") || !document["port"].IsUint()) {
+        ss << R"("status":"fail", "reason":"port not provided"})";
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+        return;
+    }
+    uint16_t port = static_cast<uint16_t>(document["port"].GetUint());
+    std::string source = "the state received on port " + std::to_string(port);
+    auto err = state_transfer::receive(_control_ios, port, MAX_STATE_SIZE, STATE_TIMEOUT, [this, source](const boost::system::error_code &err, const std::shared_ptr<const std::string> &state) {
+        if (err) {
+            logger::log(logger::ERROR, "content store state not received: " + err.message());
+            return;
+        }
+        _ios.post(boost::bind(&ContentStore::restoreSnapshot, this, state, 0, source));
+    });
+    if (err) {
+        ss << R"("status":"fail", "reason":")" << err.message() << R"("})";
+    } else {
+        ss << R"("status":"success"})";
+    }
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+}
+
+ContentStore::ReportCounters ContentStore::getReportCounters() {
+    ReportCounters counters;
+    for (auto &shard : _shards) {
+        counters.hits += shard->getHitCounter();
+        counters.misses += shard->getMissCounter();
+        shard->call([&counters](LruCache &cache) {
+            for (const auto &policy_stats : cache.getStats()) {
+                counters.stats[policy_stats.first].hits += policy_stats.second.hits;
+                counters.stats[policy_stats.first].misses += policy_stats.second.misses;
+            }
+            PartitionedPolicy::mergeStats(counters.partitions, cache.getPartitionStats());
+            counters.admitted += cache.getAdmitted();
+            counters.rejected += cache.getRejected();
+            counters.disk_hits += cache.getDiskHits();
+            counters.disk_used_bytes += cache.getDiskUsedBytes();
+            counters.shared_hits += cache.getSharedHits();
+            counters.negative_hits += cache.getNegativeHits();
+            counters.suppressed += cache.getSuppressed();
+            counters.negative_entries += cache.getNegativeEntries();
+            counters.dedup_contents += cache.getDedupContents();
+            counters.dedup_bytes += cache.getDedupBytes();
+            counters.dedup_shared += cache.getDedupShared();
+            const auto &prefix_counters = cache.getPrefixStats().getCounters();
+            counters.prefix_counters.insert(counters.prefix_counters.end(), prefix_counters.begin(), prefix_counters.end());
+        });
+    }
+    return counters;
+}
+
+std::string ContentStore::makeReport(const std::string &alarms) {
+    ReportCounters counters = getReportCounters();
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"report", "action":"cache_status", "hit_count":)" << counters.hits << R"(, "miss_count":)" << counters.misses
+       << R"(, "used_bytes":)" << getUsedBytes() << R"(, "max_bytes":)" << _max_bytes
+       << R"(, "admitted_count":)" << counters.admitted << R"(, "rejected_count":)" << counters.rejected
+       << R"(, "disk_hit_count":)" << counters.disk_hits << R"(, "disk_used_bytes":)" << counters.disk_used_bytes
+       << R"(, "shared_hit_count":)" << counters.shared_hits
+       << R"(, "negative_hit_count":)" << counters.negative_hits << R"(, "suppressed_count":)" << counters.suppressed
+       << R"(, "negative_entries":)" << counters.negative_entries << R"(, "coalesced_count":)" << _coalesced_counter
+       << R"(, "dedup_contents":)" << counters.dedup_contents << R"(, "dedup_bytes":)" << counters.dedup_bytes
+       << R"(, "dedup_shared_count":)" << counters.dedup_shared
+       << R"(, "prefetch_count":)" << _prefetcher.getPrefetched() << R"(, "prefetch_used_count":)" << _prefetcher.getUsed()
+       << R"(, "prefetch_wasted_count":)" << _prefetcher.getWasted() << R"(, "prefetch_bytes":)" << _prefetcher.getFetchedBytes()
+       << R"(, "shed_insert_count":)" << _shed_insert_counter << R"(, "loop_lag_us":)" << _loop_monitor.getLag()
+       << R"(, "policy":")" << _policy << R"(", "policies":)" << LruCache::statsToJSON(counters.stats)
+       << R"(, "partitions":)" << PartitionedPolicy::statsToJSON(counters.partitions)
+       << R"(, "prefix_stats_depth":)" << _prefix_stats_depth
+       << R"(, "prefixes":)" << PrefixStats::toJSON(PrefixStats::merge(counters.prefix_counters, _prefix_stats_entries))
+       << R"(, "stages":)" << stage_profile::toJSON();
+    if (!alarms.empty()) {
+        ss << R"(, "alarms":)" << alarms;
+    }
+    ss << "}";
+    return ss.str();
+}
+
+std::string ContentStore::makeDeltaReport(const std::string &alarms) {
+    // the hits and the misses are always there for the ratio, the policies, the prefixes and the stages never are
+    ReportCounters counters = getReportCounters();
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"report", "action":"cache_status", "delta":true)";
+    _report_deltas.counter(ss, "hit_count", counters.hits, true);
+    _report_deltas.counter(ss, "miss_count", counters.misses, true);
+    _report_deltas.gauge(ss, "used_bytes", getUsedBytes());
+    _report_deltas.gauge(ss, "max_bytes", _max_bytes);
+    _report_deltas.counter(ss, "admitted_count", counters.admitted);
+    _report_deltas.counter(ss, "rejected_count", counters.rejected);
+    _report_deltas.counter(ss, "disk_hit_count", counters.disk_hits);
+    _report_deltas.gauge(ss, "disk_used_bytes", counters.disk_used_bytes);
+    _report_deltas.counter(ss, "shared_hit_count", counters.shared_hits);
+    _report_deltas.counter(ss, "negative_hit_count", counters.negative_hits);
+    _report_deltas.counter(ss, "suppressed_count", counters.suppressed);
+    _report_deltas.gauge(ss, "negative_entries", counters.negative_entries);
+    _report_deltas.counter(ss, "coalesced_count", _coalesced_counter);
+    _report_deltas.gauge(ss, "dedup_contents", counters.dedup_contents);
+    _report_deltas.gauge(ss, "dedup_bytes", counters.dedup_bytes);
+    _report_deltas.counter(ss, "dedup_shared_count", counters.dedup_shared);
+    _report_deltas.counter(ss, "prefetch_count", _prefetcher.getPrefetched());
+    _report_deltas.counter(ss, "prefetch_used_count", _prefetcher.getUsed());
+    _report_deltas.counter(ss, "prefetch_wasted_count", _prefetcher.getWasted());
+    _report_deltas.gauge(ss, "prefetch_bytes", _prefetcher.getFetchedBytes());
+    _report_deltas.counter(ss, "shed_insert_count", _shed_insert_counter);
+    _report_deltas.gauge(ss, "loop_lag_us", _loop_monitor.getLag());
+    if (!_report_deltas.takeChanges() && alarms.empty()) {
+        return "";
+    }
+    if (!alarms.empty()) {
+        ss << R"(, "alarms":)" << alarms;
+    }
+    ss << "}";
+    return ss.str();
+}
+
+void ContentStore::sendReport(const std::string &alarms) {
+    if (_manager_endpoint.address() == boost::asio::ip::address_v4::any() || _manager_endpoint.port() == 0) {
+        return;
+    }
+    stage_profile::Scope stage(stage_profile::REPORT);
+    std::string report = _report_delta ? makeDeltaReport(alarms) : makeReport(alarms);
+    if (!report.empty()) {
+        sendOnControl(_command_socket, report, _manager_endpoint);
+    }
+}
+
+void ContentStore::commandReport(const boost::system::error_code &err) {
+    if (!err) {
+        sendReport("");
     }
     if(_report_enable) {
         _report_timer.expires_from_now(_delay_between_report);
@@ -289,3 +1506,205 @@ void ContentStore::commandReport(const boost::system::error_code &err) {
     }
 }
 
+void ContentStore::armAlarms() {
+    if (!_is_alarm_timer_armed && (_hit_ratio_alarm.isEnabled() || _queue_alarm.isEnabled())) {
+        _is_alarm_timer_armed = true;
+        _alarm_hits = 0;
+        _alarm_misses = 0;
+        for (auto &shard : _shards) {
+            _alarm_hits += shard->getHitCounter();
+            _alarm_misses += shard->getMissCounter();
+        }
+        _alarm_timer.expires_from_now(boost::posix_time::milliseconds(ALARM_CHECK_INTERVAL));
+        _alarm_timer.async_wait(boost::bind(&ContentStore::checkAlarms, this, _1));
+    }
+}
+
+void ContentStore::checkAlarms(const boost::system::error_code &err) {
+    if (err || (!_hit_ratio_alarm.isEnabled() && !_queue_alarm.isEnabled())) {
+        _is_alarm_timer_armed = false;
+        return;
+    }
+    std::stringstream alarms;
+    size_t hits = 0;
+    size_t misses = 0;
+    for (auto &shard : _shards) {
+        hits += shard->getHitCounter();
+        misses += shard->getMissCounter();
+    }
+    // the ratio of a few lookups says little, they are added to those of the next checks until there are enough
+    size_t lookups = hits - _alarm_hits + misses - _alarm_misses;
+    if (lookups >= ALARM_MIN_LOOKUPS) {
+        double hit_ratio = 100.0 * (hits - _alarm_hits) / lookups;
+        if (_hit_ratio_alarm.update(hit_ratio)) {
+            alarms << _hit_ratio_alarm.toJSON("hit_ratio", hit_ratio);
+        }
+        _alarm_hits = hits;
+        _alarm_misses = misses;
+    }
+    size_t queued = getQueuedPackets();
+    if (_queue_alarm.update(queued)) {
+        alarms << (alarms.tellp() > 0 ? ", " : "") << _queue_alarm.toJSON("queue", queued);
+    }
+    if (alarms.tellp() > 0) {
+        sendReport("[" + alarms.str() + "]");
+    }
+    _alarm_timer.expires_from_now(boost::posix_time::milliseconds(ALARM_CHECK_INTERVAL));
+    _alarm_timer.async_wait(boost::bind(&ContentStore::checkAlarms, this, _1));
+}
+
+void ContentStore::writeMetrics(MetricsWriter &writer) {
+    for (const auto &face : _egress_faces) {
+        face->writeMetrics(writer);
+    }
+    for (const auto &face : _peer_faces) {
+        face->writeMetrics(writer);
+    }
+    _tcp_ingress_master_face->writeMetrics(writer);
+    _udp_ingress_master_face->writeMetrics(writer);
+    _shm_ingress_master_face->writeMetrics(writer);
+    _mem_ingress_master_face->writeMetrics(writer);
+    BufferPool::getStats().writeMetrics(writer);
+    stage_profile::writeMetrics(writer);
+    PageArena::getStats().writeMetrics(writer);
+    if (_memory_budget.isEnabled()) {
+        _memory_budget.writeMetrics(writer, {});
+    }
+    struct ShardStats {
+        size_t used_bytes, admitted, rejected, disk_hits, disk_used_bytes, negative_hits, suppressed, negative_entries, shared_hits;
+    };
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        ShardStats stats = _shards[i]->call([](LruCache &cache) {
+            return ShardStats{cache.getUsedBytes(), cache.getAdmitted(), cache.getRejected(), cache.getDiskHits(), cache.getDiskUsedBytes(),
+                              cache.getNegativeHits(), cache.getSuppressed(), cache.getNegativeEntries(), cache.getSharedHits()};
+        });
+        metrics::Labels labels = {{"shard", std::to_string(i)}};
+        writer.counter("ndn_cache_hits_total", "Interests answered from the cache", labels, _shards[i]->getHitCounter());
+        writer.counter("ndn_cache_misses_total", "Interests the cache couldn't answer", labels, _shards[i]->getMissCounter());
+        writer.counter("ndn_cache_admitted_total", "Data admitted in the cache", labels, stats.admitted);
+        writer.counter("ndn_cache_rejected_total", "Data refused by the admission policy", labels, stats.rejected);
+        writer.counter("ndn_cache_disk_hits_total", "Interests answered from the disk tier", labels, stats.disk_hits);
+        writer.counter("ndn_cache_shared_hits_total", "Interests answered from the tier shared with the clones", labels, stats.shared_hits);
+        writer.counter("ndn_cache_negative_hits_total", "Interests answered by the negative cache", labels, stats.negative_hits);
+        writer.counter("ndn_cache_suppressed_total", "misses suppressed while one was pending upstream", labels, stats.suppressed);
+        writer.gauge("ndn_cache_used_bytes", "bytes of the Data in memory", labels, stats.used_bytes);
+        writer.gauge("ndn_cache_disk_used_bytes", "bytes of the Data on disk", labels, stats.disk_used_bytes);
+        writer.gauge("ndn_cache_negative_entries", "entries of the negative cache", labels, stats.negative_entries);
+    }
+    writer.gauge("ndn_cache_max_bytes", "byte budget of the cache", {}, _max_bytes);
+    writer.counter("ndn_cache_coalesced_total", "misses coalesced with one pending", {}, _coalesced_counter);
+    writer.gauge("ndn_cache_pending_misses", "misses waiting for their Data", {}, _pending_misses.size());
+    writer.counter("ndn_cache_prefetched_total", "segments asked upstream ahead of their consumer", {}, _prefetcher.getPrefetched());
+    writer.counter("ndn_cache_prefetch_used_total", "prefetched segments asked for in time", {}, _prefetcher.getUsed());
+    writer.counter("ndn_cache_shed_inserts_total", "Data passed on without being cached while overloaded", {}, _shed_insert_counter);
+    _loop_monitor.writeMetrics(writer, {});
+}
+
+size_t ContentStore::getUsedBytes() {
+    size_t used_bytes = 0;
+    for (auto &shard : _shards) {
+        used_bytes += shard->call([](LruCache &cache) {
+            return cache.getUsedBytes();
+        });
+    }
+    return used_bytes;
+}
+
+bool ContentStore::loadStartupConfig(const std::string &source) {
+    return _startup_config.load(source);
+}
+
+void ContentStore::enableSnapshot(const std::string &path, size_t delay) {
+    _snapshot_path = path;
+    _delay_between_snapshots = boost::posix_time::seconds(delay);
+}
+
+std::string ContentStore::makeSnapshot(size_t &count) {
+    std::string records;
+    count = 0;
+    for (auto &shard : _shards) {
+        count += shard->call([&records](LruCache &cache) {
+            return cache.writeSnapshot(records);
+        });
+    }
+    std::string snapshot;
+    name_snapshot::writeHeader(snapshot, count);
+    snapshot.append(records);
+    return snapshot;
+}
+
+bool ContentStore::saveSnapshot() {
+    if (_snapshot_path.empty()) {
+        return false;
+    }
+    size_t count;
+    std::string snapshot = makeSnapshot(count);
+    // written aside then renamed, a restart never reads a partial file
+    std::string path = _snapshot_path + ".tmp";
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(snapshot.data(), snapshot.size());
+    file.close();
+    if (!file || std::rename(path.c_str(), _snapshot_path.c_str()) != 0) {
+        logger::log(logger::ERROR, "can't write content store snapshot " + _snapshot_path);
+        return false;
+    }
+    std::stringstream ss;
+    ss << count << " entries saved in " << _snapshot_path;
+    logger::log(logger::INFO, ss.str());
+    return true;
+}
+
+void ContentStore::onSnapshotTimer(const boost::system::error_code &err) {
+    if (err) {
+        return;
+    }
+    saveSnapshot();
+    _snapshot_timer.expires_from_now(_delay_between_snapshots);
+    _snapshot_timer.async_wait(boost::bind(&ContentStore::onSnapshotTimer, this, _1));
+}
+
+void ContentStore::restoreSnapshot(const std::shared_ptr<const std::string> &snapshot, size_t offset, const std::string &source) {
+    static const size_t SLICE_RECORDS = 256;
+
+    const uint8_t *begin = reinterpret_cast<const uint8_t*>(snapshot->data());
+    const uint8_t *end = begin + snapshot->size();
+    const uint8_t *it = begin + offset;
+    try {
+        uint32_t type;
+        if (offset == 0) {
+            size_t length = tlv_reader::readHeader(it, end, type);
+            if (type != name_snapshot::HEADER) {
+                throw ndn::tlv::Error("not a content store snapshot");
+            }
+            it += length;
+            _restored_entries = 0;
+        }
+        auto steady_now = ndn::time::steady_clock::now();
+        auto system_now = ndn::time::duration_cast<ndn::time::milliseconds>(ndn::time::system_clock::now().time_since_epoch());
+        for (size_t i = 0; i < SLICE_RECORDS && it != end; ++i) {
+            size_t length = tlv_reader::readHeader(it, end, type);
+            if (type != name_snapshot::VALUE || length < 8) {
+                throw ndn::tlv::Error("invalid content store snapshot record");
+            }
+            ndn::time::milliseconds expire_time(tlv_reader::readNonNegativeInteger(it, 8));
+            if (expire_time > system_now) {
+                NdnPacket packet(ndn::Block(BufferPool::local().copy(it + 8, length - 8)));
+                if (packet.getType() == NdnPacket::DATA) {
+                    getShard(packet).restore(packet, steady_now + (expire_time - system_now));
+                    ++_restored_entries;
+                }
+            }
+            it += length;
+        }
+    } catch (const std::exception &e) {
+        logger::log(logger::ERROR, std::string("content store snapshot partially restored: ") + e.what());
+        return;
+    }
+    if (it != end) {
+        _ios.post(boost::bind(&ContentStore::restoreSnapshot, this, snapshot, it - begin, source));
+    } else {
+        std::stringstream ss;
+        ss << _restored_entries << " entries restored from " << source;
+        logger::log(logger::INFO, ss.str());
+    }
+}
\ No newline at end of file
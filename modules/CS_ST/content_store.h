@@ -5,52 +5,269 @@
 
 #include <boost/asio.hpp>
 
+#include <chrono>
 #include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <queue>
 
 #include "rapidjson/document.h"
 
-#include "module.h"
+#include "runtime/module.h"
+#include "management/startup_config.h"
+#include "metrics/report_trigger.h"
 #include "lru_cache.h"
+#include "cache_shard.h"
+#include "pending_misses.h"
+#include "prefetcher.h"
+#include "network/loop_monitor.h"
+#include "metrics/memory_budget.h"
 #include "network/master_face.h"
 #include "network/face.h"
+#include "network/tcp_connection_pool.h"
 
+// threads: the faces, the commands and the timers run on the module thread, which owns everything below. the cache
+// is split in shards (-j), each one only touched by its own thread, see CacheShard
 class ContentStore : public Module {
     const std::string _name;
 
-    LruCache _cs;
+    size_t _size;
+    size_t _max_bytes;
+    std::string _policy;
+    std::string _admission = "always";
+    AdmissionPolicy::Parameters _admission_parameters;
+    // the cache split between tenants by Name prefix, none by default, see PartitionedPolicy
+    std::vector<PartitionedPolicy::Config> _partitions;
+    bool _is_partition_borrowing = true;
+    // in milliseconds in the commands, disabled by default
+    NegativeCache::Parameters _negative_parameters;
+    // hits and misses of the most requested prefixes, by their first components
+    size_t _prefix_stats_depth = 2;
+    size_t _prefix_stats_entries = 64;
+    // the shard of a Name is given by the name_hash of its first components, the Data under a same prefix of that
+    // length are in one shard and an Interest only looks into one of them
+    const size_t _shard_prefix_length;
 
     char _command_buffer[65536];
     boost::asio::ip::udp::socket _command_socket;
     boost::asio::ip::udp::endpoint _remote_command_endpoint;
+    StartupConfig _startup_config;
+    // connections kept open to the endpoints set by edit_config, add_face takes them
+    TcpConnectionPool _connection_pool;
 
     bool _report_enable = false;
     boost::asio::ip::udp::endpoint _manager_endpoint;
     boost::asio::deadline_timer _report_timer;
     boost::posix_time::milliseconds _delay_between_report;
-    size_t _hit_counter = 0;
-    size_t _miss_counter = 0;
+    // the periodic reports only carry the counters which changed, none is sent when nothing did
+    bool _report_delta = false;
+    ReportDeltas _report_deltas;
+    // checked every ALARM_CHECK_INTERVAL while one of them is set, a crossing is reported at once. the hit ratio is
+    // in percent over the lookups since the previous check, ALARM_MIN_LOOKUPS at least
+    ThresholdAlarm _hit_ratio_alarm{ThresholdAlarm::BELOW};
+    ThresholdAlarm _queue_alarm{ThresholdAlarm::ABOVE};
+    boost::asio::deadline_timer _alarm_timer;
+    bool _is_alarm_timer_armed = false;
+    size_t _alarm_hits = 0;
+    size_t _alarm_misses = 0;
+    // in milliseconds
+    static const size_t ALARM_CHECK_INTERVAL = 100;
+    static const size_t ALARM_MIN_LOOKUPS = 100;
+    // in percent, the hit ratio alarm clears that much above its trigger, the queue one at half of it
+    static const size_t HIT_RATIO_HYSTERESIS = 5;
 
     std::vector<std::shared_ptr<Face>> _egress_faces;
+    // cooperative caching between the clones behind a hashing strategy router: a clone owns the Names which
+    // rendezvous_hash gives to its cluster_endpoint, a miss on a Name owned by another clone is sent to that peer
+    // instead of upstream. no cluster while the endpoint is empty
+    std::string _cluster_endpoint;
+    size_t _cluster_prefix_length = 2;
+    std::vector<std::shared_ptr<Face>> _peer_faces;
+    // of the own endpoint first, then of the peers in order
+    std::vector<uint64_t> _cluster_key_hashes;
+    // name_hash of the Interests sent to a peer, by when they were sent
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> _peer_pending;
+    static const size_t PEER_PENDING_MAX_ENTRIES = 65536;
+    // in seconds, the default Interest lifetime
+    static const int PEER_PENDING_LIFETIME = 4;
+
+    // off by default, the Data then go to every ingress face and the Interests are aggregated further down
+    bool _coalescing = false;
+    // off by default, each cached Data then keeps its own payload and a hit is sent without a copy
+    bool _dedup = false;
+    // entries evicted at once by an insert into a full shard, see LruCache::setEvictionBatch
+    size_t _eviction_batch = 1;
+    // in seconds, off by default. the entries not hit for that long are compressed, see LruCache::compressCold
+    size_t _compression_age = 0;
+    // null unless enableSharedTier() was called
+    std::shared_ptr<SharedTier> _shared_tier;
+    PendingMisses _pending_misses;
+    static const size_t PENDING_MISSES_MAX_ENTRIES = 65536;
+    size_t _coalesced_counter = 0;
+    // reused by each Data sent to the faces waiting for it
+    std::vector<std::shared_ptr<Face>> _waiting_faces;
+    // off by default, with a window the next segments of the Names read in order are asked upstream ahead
+    Prefetcher _prefetcher;
+    // reused by each Interest read
+    std::vector<ndn::Name> _prefetch_names;
+    // past the overload_lag of the module thread, off by default, the prefetches and the cache inserts are shed
+    LoopMonitor _loop_monitor;
+    size_t _shed_insert_counter = 0;
+    // off by default, with a share of the cgroup memory limit the byte limit of the cache follows the budget
+    MemoryBudget _memory_budget;
     std::shared_ptr<MasterFace> _tcp_ingress_master_face;
     std::shared_ptr<MasterFace> _udp_ingress_master_face;
+    std::shared_ptr<MasterFace> _shm_ingress_master_face;
+    std::shared_ptr<MasterFace> _mem_ingress_master_face;
+
+    // destroyed first, their threads may still send on the faces
+    std::vector<std::unique_ptr<CacheShard>> _shards;
+
+    // warm restart, empty if the cache is not saved
+    std::string _snapshot_path;
+    boost::asio::deadline_timer _snapshot_timer;
+    boost::posix_time::seconds _delay_between_snapshots;
+    std::thread _snapshot_reader;
+    size_t _restored_entries = 0;
+    // a new clone is warmed with the snapshot of a running one, see state_transfer. in bytes and seconds
+    static const size_t MAX_STATE_SIZE = 1 << 30;
+    static const size_t STATE_TIMEOUT = 30;
+
+    CacheShard& getShard(const NdnPacket &packet);
+
+    // the byte budget is split evenly between the shards, as the size
+    size_t getShardMaxBytes(size_t max_bytes) const;
+
+    // of all the shards, as edited
+    void setSize(size_t size);
+
+    void setMaxBytes(size_t max_bytes);
+
+    // the budget becomes the byte limit, the size is raised to hold that many of the smallest entries so that it
+    // doesn't bind first
+    void onMemoryBudget(size_t budget);
+
+    // summed over the shards
+    size_t getUsedBytes();
+
+    // to the faces waiting for it with coalescing, otherwise or if none asked for it to all the ingress faces
+    void sendDataToIngress(const NdnPacket &packet);
+
+    // the Interests of the prefetcher after the one read, to the egress faces. the clones leave it to the owner
+    void prefetch(const NdnPacket &packet);
+
+    // to the shards, without the suppression window while coalescing
+    void updateNegativeParameters();
+
+    void updateClusterKeys();
+
+    // the peer face of the owner of the Name, null if this clone owns it or isn't part of a cluster
+    std::shared_ptr<Face> getOwnerPeer(const NdnPacket &packet) const;
+
+    // a face opened by another clone of the cluster
+    bool isPeer(const std::shared_ptr<Face> &face) const;
+
+    // the entries older than PEER_PENDING_LIFETIME are dropped once PEER_PENDING_MAX_ENTRIES are reached
+    void addPeerPending(const NdnPacket &packet);
+
+    // false if no Interest was sent to a peer for this Data
+    bool takePeerPending(const NdnPacket &packet);
+
+    // the ingress master faces stop accepting, the faces already there are served until the module stops
+    void beginDrain() override;
+
+    // nothing queued on the faces and no miss waiting for its Data, the cache itself is handed over with the snapshot
+    bool isDrained() override;
+
+    // on the ingress and the egress faces
+    size_t getQueuedPackets() const;
+
+    // summed over the shards, for the reports
+    struct ReportCounters {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t admitted = 0;
+        size_t rejected = 0;
+        size_t disk_hits = 0;
+        size_t disk_used_bytes = 0;
+        size_t shared_hits = 0;
+        size_t negative_hits = 0;
+        size_t suppressed = 0;
+        size_t negative_entries = 0;
+        size_t dedup_contents = 0;
+        size_t dedup_bytes = 0;
+        size_t dedup_shared = 0;
+        LruCache::Stats stats;
+        std::vector<PartitionedPolicy::Stats> partitions;
+        std::vector<PrefixStats::Counter> prefix_counters;
+    };
+
+    ReportCounters getReportCounters();
+
+    // alarms is the JSON array of the alarms which changed, empty for a periodic report
+    std::string makeReport(const std::string &alarms);
+
+    // empty if nothing changed since the previous one and there is no alarm
+    std::string makeDeltaReport(const std::string &alarms);
+
+    void sendReport(const std::string &alarms);
+
+    // arms the alarm timer if an alarm is set and it isn't armed yet
+    void armAlarms();
+
+    void checkAlarms(const boost::system::error_code &err);
 
 public:
-    ContentStore(const std::string &name, size_t size, uint16_t local_port, uint16_t local_command_port);
+    // with more than one shard each of them runs on its own thread, a single shard runs on the module thread
+    ContentStore(const std::string &name, size_t size, size_t max_bytes, const std::string &policy, uint16_t local_port, uint16_t local_command_port, size_t udp_shards = 1, size_t shards = 1, size_t shard_prefix_length = 2);
 
-    ~ContentStore() override = default;
+    ~ContentStore() override;
 
     void run() override;
 
-    void onIngressInterest(const std::shared_ptr<Face> &ingress_face, const ndn::Interest &interest);
+    // the cache is read back from path in the background once running, and written there each delay seconds if it
+    // isn't 0 and by saveSnapshot(). before start()
+    void enableSnapshot(const std::string &path, size_t delay);
+
+    // the commands applied by run() before the ingress accepts a face, see StartupConfig. false if source can't be
+    // read. before start()
+    bool loadStartupConfig(const std::string &source);
+
+    // the fresh entries of all the shards, false and logged if the file can't be written
+    bool saveSnapshot();
+
+    // the snapshot of all the shards in memory, as saved or sent to a clone
+    std::string makeSnapshot(size_t &count);
+
+    // evicted Data go to segment files of size bytes in directory, split between the shards, before start()
+    bool enableDiskTier(const std::string &directory, size_t size);
+
+    // the shared memory segment name, created with size bytes if no clone of the host did yet, for all the shards.
+    // before start()
+    bool enableSharedTier(const std::string &name, size_t size);
+
+    // the cache takes percent of the cgroup memory limit and shrinks under memory pressure, see MemoryBudget. false
+    // without a limit. before start()
+    bool enableMemoryBudget(size_t percent);
+
+    // the packets are handed over to their shard once sent, the cache keeps the buffer they were received in
+    void onIngressPacket(const std::shared_ptr<Face> &ingress_face, NdnPacket &&packet);
+
+    void onIngressInterest(const std::shared_ptr<Face> &ingress_face, NdnPacket &&packet);
 
-    void onIngressData(const std::shared_ptr<Face> &ingress_face, const ndn::Data &data);
+    void onIngressData(const std::shared_ptr<Face> &ingress_face, NdnPacket &&packet);
 
-    void onEgressInterest(const std::shared_ptr<Face> &egress_face, const ndn::Interest &interest);
+    void onEgressPacket(const std::shared_ptr<Face> &egress_face, NdnPacket &&packet);
 
-    void onEgressData(const std::shared_ptr<Face> &egress_face, const ndn::Data &data);
+    void onEgressInterest(const std::shared_ptr<Face> &egress_face, NdnPacket &&packet);
+
+    void onEgressData(const std::shared_ptr<Face> &egress_face, NdnPacket &&packet);
+
+    void onCacheMiss(const std::shared_ptr<Face> &face, const NdnPacket &packet, bool from_ingress);
+
+    void onPeerPacket(const std::shared_ptr<Face> &peer_face, const NdnPacket &packet);
 
     void onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
 
@@ -62,6 +279,9 @@ public:
 
     void commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred);
 
+    // a parsed command with an action, on the module thread
+    void executeCommand(const rapidjson::Document &document);
+
     void commandEditConfig(const rapidjson::Document &document);
 
     void commandAddFace(const rapidjson::Document &document);
@@ -70,5 +290,26 @@ public:
 
     void commandList(const rapidjson::Document &document);
 
+    // the snapshot is sent to the clone listening on address:port, answered once it is all written
+    void commandExportState(const rapidjson::Document &document);
+
+    // listens for the snapshot of another clone on port, answered at once. it is restored as the one of a restart
+    void commandImportState(const rapidjson::Document &document);
+
+    // the bytes held by the cache of each shard, the side tables and the faces, see MemoryStats
+    void commandMemoryStats(const rapidjson::Document &document);
+
+    // where the CPU time of the process goes for duration ms, answered with the folded stacks once it is over, see
+    // sampling_profiler
+    void commandProfile(const rapidjson::Document &document);
+
     void commandReport(const boost::system::error_code &err);
+
+    // at each scrape, from the module thread as commandList
+    void writeMetrics(MetricsWriter &writer);
+
+    void onSnapshotTimer(const boost::system::error_code &err);
+
+    // a slice of the records from offset, the next one is queued until the end of the snapshot. source is only logged
+    void restoreSnapshot(const std::shared_ptr<const std::string> &snapshot, size_t offset, const std::string &source);
 };
\ No newline at end of file
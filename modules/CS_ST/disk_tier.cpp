@@ -0,0 +1,206 @@
+#include "disk_tier.h"
+
+#include <ndn-cxx/encoding/block.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "network/buffer_pool.h"
+#include "network/coarse_clock.h"
+
+DiskTier::DiskTier(const std::string &directory, size_t size, size_t segment_size)
+        : _directory(directory)
+        , _segment_size(segment_size)
+        , _segments(std::max<size_t>(size / segment_size, 2))
+        , _current_segment(0) {
+
+}
+
+DiskTier::~DiskTier() {
+    for (auto &segment : _segments) {
+        if (segment.mapping) {
+            ::munmap(segment.mapping, _segment_size);
+        }
+    }
+}
+
+bool DiskTier::open() {
+    if (::mkdir(_directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        logger::log(logger::ERROR, "can't create cache directory " + _directory + ": " + std::strerror(errno));
+        return false;
+    }
+    for (size_t i = 0; i < _segments.size(); ++i) {
+        std::stringstream ss;
+        ss << _directory << "/segment-" << i;
+        int fd = ::open(ss.str().c_str(), O_CREAT | O_TRUNC | O_RDWR, 0600);
+        if (fd < 0) {
+            logger::log(logger::ERROR, "can't create cache segment " + ss.str() + ": " + std::strerror(errno));
+            return false;
+        }
+        void *address = MAP_FAILED;
+        if (::ftruncate(fd, _segment_size) == 0) {
+            address = ::mmap(nullptr, _segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            logger::log(logger::ERROR, "can't map cache segment " + ss.str() + ": " + std::strerror(errno));
+            return false;
+        }
+        _segments[i].mapping = static_cast<uint8_t*>(address);
+        if (i > 0) {
+            _free_segments.push_back(i);
+        }
+    }
+    return true;
+}
+
+void DiskTier::release(const Location &location) {
+    Segment &segment = _segments[location.segment];
+    _used_bytes -= getRecordSize(getHeader(location).length);
+    if (--segment.live_records == 0 && location.segment != _current_segment) {
+        _sealed_segments.erase(std::find(_sealed_segments.begin(), _sealed_segments.end(), location.segment));
+        dropSegment(location.segment);
+    }
+}
+
+void DiskTier::dropSegment(uint32_t segment) {
+    Segment &dropped = _segments[segment];
+    for (size_t offset = 0; offset < dropped.write_offset;) {
+        const auto &header = *reinterpret_cast<const RecordHeader*>(dropped.mapping + offset);
+        auto it = _index.find(header.hash);
+        if (it != _index.end() && it->second.segment == segment && it->second.offset == offset) {
+            _used_bytes -= getRecordSize(header.length);
+            _index.erase(it);
+        }
+        offset += getRecordSize(header.length);
+    }
+    // the pages leave the resident set until the segment is written again from its start
+    ::madvise(dropped.mapping, _segment_size, MADV_DONTNEED);
+    dropped.write_offset = 0;
+    dropped.live_records = 0;
+    dropped.latest_expire_time = ndn::time::steady_clock::time_point();
+    _free_segments.push_back(segment);
+}
+
+void DiskTier::nextSegment() {
+    if (_segments[_current_segment].live_records > 0) {
+        _sealed_segments.push_back(_current_segment);
+    } else {
+        dropSegment(_current_segment);
+    }
+    if (_free_segments.empty()) {
+        // the oldest records are lost
+        dropSegment(_sealed_segments.front());
+        _sealed_segments.pop_front();
+    }
+    _current_segment = _free_segments.back();
+    _free_segments.pop_back();
+}
+
+void DiskTier::append(CacheEntry &entry) {
+    const auto &wire = entry.getWire();
+    size_t record_size = getRecordSize(wire->size());
+    if (!_segments[_current_segment].mapping || record_size > _segment_size || !entry.isValid()) {
+        return;
+    }
+    if (_segments[_current_segment].write_offset + record_size > _segment_size) {
+        nextSegment();
+    }
+    Segment &segment = _segments[_current_segment];
+    Location location{_current_segment, static_cast<uint32_t>(segment.write_offset)};
+    RecordHeader &header = getHeader(location);
+    header.hash = entry.getHook().hash;
+    header.expire_time = entry.getExpireTime().time_since_epoch().count();
+    header.length = static_cast<uint32_t>(wire->size());
+    header.reserved = 0;
+    std::memcpy(segment.mapping + location.offset + sizeof(RecordHeader), wire->data(), wire->size());
+    segment.write_offset += record_size;
+    ++segment.live_records;
+    segment.latest_expire_time = std::max(segment.latest_expire_time, entry.getExpireTime());
+    _used_bytes += record_size;
+
+    auto it = _index.find(header.hash);
+    if (it != _index.end()) {
+        // a former version of the Data, or another Name of the same hash
+        Location former = it->second;
+        it->second = location;
+        release(former);
+    } else {
+        _index.emplace(header.hash, location);
+    }
+}
+
+std::shared_ptr<const ndn::Buffer> DiskTier::take(const NameView &name, ndn::time::steady_clock::time_point &expire_time) {
+    auto it = _index.find(name.getHash());
+    if (it == _index.end()) {
+        return nullptr;
+    }
+    Location location = it->second;
+    const RecordHeader &header = getHeader(location);
+    expire_time = ndn::time::steady_clock::time_point(ndn::time::steady_clock::duration(header.expire_time));
+    if (expire_time <= coarse_clock::now()) {
+        _index.erase(it);
+        release(location);
+        return nullptr;
+    }
+    auto wire = BufferPool::local().copy(_segments[location.segment].mapping + location.offset + sizeof(RecordHeader), header.length);
+    // the hash only selects the record, the Names are compared to rule out collisions
+    ndn::Block block(wire);
+    NameView record_name(block);
+    if (record_name.size() != name.size()) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < name.size(); ++i) {
+        NameComponentRef a = name[i];
+        NameComponentRef b = record_name[i];
+        if (a.type != b.type || a.length != b.length || std::memcmp(a.value, b.value, a.length) != 0) {
+            return nullptr;
+        }
+    }
+    _index.erase(it);
+    release(location);
+    return wire;
+}
+
+void DiskTier::collect(const ndn::time::steady_clock::time_point &now) {
+    for (auto it = _sealed_segments.begin(); it != _sealed_segments.end();) {
+        if (_segments[*it].latest_expire_time <= now) {
+            uint32_t segment = *it;
+            it = _sealed_segments.erase(it);
+            dropSegment(segment);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t DiskTier::getEntries() const {
+    return _index.size();
+}
+
+size_t DiskTier::getUsedBytes() const {
+    return _used_bytes;
+}
+
+size_t DiskTier::getMappedBytes() const {
+    size_t bytes = 0;
+    for (const auto &segment : _segments) {
+        if (segment.mapping) {
+            bytes += _segment_size;
+        }
+    }
+    return bytes;
+}
+
+size_t DiskTier::getMemoryUsage() const {
+    return memory_usage::of(_segments) + memory_usage::of(_free_segments) + memory_usage::of(_sealed_segments) + memory_usage::of(_index);
+}
\ No newline at end of file
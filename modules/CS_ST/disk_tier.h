@@ -0,0 +1,102 @@
+#pragma once
+
+#include <ndn-cxx/encoding/buffer.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "network/name_view.h"
+#include "cache_entry.h"
+
+// second tier of the content store: the entries evicted from memory are appended to segment files mapped in memory,
+// found back by name_hash. segments are written one after the other, a full one is sealed and the oldest sealed one
+// is recycled when no segment is free, its records are then lost. a segment is freed as soon as all its records were
+// taken back or expired. the files are scratch space, they are truncated when the tier is opened
+class DiskTier {
+public:
+    static const size_t SEGMENT_SIZE = 64 * 1024 * 1024;
+
+private:
+    struct RecordHeader {
+        uint64_t hash;
+        // steady_clock ticks, the records don't outlive the process
+        int64_t expire_time;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    struct Segment {
+        uint8_t *mapping = nullptr;
+        size_t write_offset = 0;
+        // records the index still points to
+        size_t live_records = 0;
+        ndn::time::steady_clock::time_point latest_expire_time;
+    };
+
+    struct Location {
+        uint32_t segment;
+        uint32_t offset;
+    };
+
+    const std::string _directory;
+    const size_t _segment_size;
+    std::vector<Segment> _segments;
+    std::vector<uint32_t> _free_segments;
+    // sealed segments, the oldest first
+    std::deque<uint32_t> _sealed_segments;
+    uint32_t _current_segment;
+    std::unordered_map<uint64_t, Location> _index;
+    size_t _used_bytes = 0;
+
+    static size_t getRecordSize(size_t length) {
+        return (sizeof(RecordHeader) + length + 7) & ~static_cast<size_t>(7);
+    }
+
+    RecordHeader& getHeader(const Location &location) {
+        return *reinterpret_cast<RecordHeader*>(_segments[location.segment].mapping + location.offset);
+    }
+
+    void release(const Location &location);
+
+    void dropSegment(uint32_t segment);
+
+    void nextSegment();
+
+public:
+    // size in bytes over all segment files, at least 2 segments are used
+    DiskTier(const std::string &directory, size_t size, size_t segment_size = SEGMENT_SIZE);
+
+    DiskTier(const DiskTier&) = delete;
+
+    DiskTier& operator=(const DiskTier&) = delete;
+
+    ~DiskTier();
+
+    // creates the directory and maps the segment files, false and logged if it fails
+    bool open();
+
+    // copies the wire of the entry, nothing is done if it is expired or larger than a segment
+    void append(CacheEntry &entry);
+
+    // the wire of the Data named name and its expiration time, removed from the tier. null if it isn't there or expired
+    std::shared_ptr<const ndn::Buffer> take(const NameView &name, ndn::time::steady_clock::time_point &expire_time);
+
+    // frees the sealed segments all of whose records expired
+    void collect(const ndn::time::steady_clock::time_point &now);
+
+    size_t getEntries() const;
+
+    // of the records still indexed
+    size_t getUsedBytes() const;
+
+    // of the segment files mapped, in the page cache rather than on the heap
+    size_t getMappedBytes() const;
+
+    // of the index and the segment table
+    size_t getMemoryUsage() const;
+};
\ No newline at end of file
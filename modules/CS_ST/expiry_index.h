@@ -0,0 +1,89 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "cache_entry.h"
+#include "metrics/memory_stats.h"
+
+// the cached entries ordered by expiration time, a binary min-heap whose slots are kept in the entries so that any of
+// them is removed in O(log n) when it leaves the cache otherwise than by expiring
+class ExpiryIndex {
+private:
+    std::vector<CacheEntry*> _heap;
+
+    static bool before(CacheEntry *a, CacheEntry *b) {
+        return a->getExpireTime() < b->getExpireTime();
+    }
+
+    void place(size_t slot, CacheEntry *entry) {
+        _heap[slot] = entry;
+        entry->getExpirySlot() = slot;
+    }
+
+    void siftUp(size_t slot) {
+        CacheEntry *entry = _heap[slot];
+        while (slot > 0 && before(entry, _heap[(slot - 1) / 2])) {
+            place(slot, _heap[(slot - 1) / 2]);
+            slot = (slot - 1) / 2;
+        }
+        place(slot, entry);
+    }
+
+    void siftDown(size_t slot) {
+        CacheEntry *entry = _heap[slot];
+        while (2 * slot + 1 < _heap.size()) {
+            size_t child = 2 * slot + 1;
+            if (child + 1 < _heap.size() && before(_heap[child + 1], _heap[child])) {
+                ++child;
+            }
+            if (!before(_heap[child], entry)) {
+                break;
+            }
+            place(slot, _heap[child]);
+            slot = child;
+        }
+        place(slot, entry);
+    }
+
+public:
+    size_t size() const {
+        return _heap.size();
+    }
+
+    size_t getMemoryUsage() const {
+        return memory_usage::of(_heap);
+    }
+
+    void insert(CacheEntry *entry) {
+        _heap.push_back(entry);
+        siftUp(_heap.size() - 1);
+    }
+
+    void remove(CacheEntry *entry) {
+        size_t slot = entry->getExpirySlot();
+        if (slot >= _heap.size() || _heap[slot] != entry) {
+            return;
+        }
+        entry->getExpirySlot() = SIZE_MAX;
+        CacheEntry *last = _heap.back();
+        _heap.pop_back();
+        if (last != entry) {
+            place(slot, last);
+            siftDown(slot);
+            siftUp(last->getExpirySlot());
+        }
+    }
+
+    // the entry expiring first if it is expired at now, removed from the index, null otherwise
+    CacheEntry* popExpired(const ndn::time::steady_clock::time_point &now) {
+        if (_heap.empty() || _heap.front()->getExpireTime() > now) {
+            return nullptr;
+        }
+        CacheEntry *entry = _heap.front();
+        remove(entry);
+        return entry;
+    }
+};
\ No newline at end of file
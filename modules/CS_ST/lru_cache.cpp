@@ -1,7 +1,24 @@
 #include "lru_cache.h"
 
-LruCache::LruCache(size_t size) : _max_size(size) {
+#include <algorithm>
+#include <sstream>
 
+#include "log/probes.h"
+#include "metrics/memory_stats.h"
+#include "network/coarse_clock.h"
+#include "tree/name_snapshot.h"
+
+LruCache::LruCache(size_t size, size_t max_bytes, const std::string &policy)
+        : _max_size(size)
+        , _max_bytes(max_bytes)
+        , _policy(CachePolicy::create(policy, size))
+        , _admission(AdmissionPolicy::create("always", size, AdmissionPolicy::Parameters()))
+        , _prefix_stats(2, 64) {
+    if (!_policy) {
+        _policy = CachePolicy::create("lru", size);
+    }
+    _tree.setDeferredPruning(true);
+    _current_stats = &_stats[_policy->getName()];
 }
 
 size_t LruCache::getSize() const {
@@ -10,35 +27,521 @@ size_t LruCache::getSize() const {
 
 void LruCache::setSize(size_t size) {
     _max_size = size;
+    _policy->setCapacity(size, _evicted);
+    removeEvicted();
+}
+
+size_t LruCache::getEvictionBatch() const {
+    return _eviction_batch;
+}
+
+void LruCache::setEvictionBatch(size_t batch) {
+    _eviction_batch = std::max<size_t>(batch, 1);
+}
+
+size_t LruCache::getMaxBytes() const {
+    return _max_bytes;
+}
+
+void LruCache::setMaxBytes(size_t max_bytes) {
+    _max_bytes = max_bytes;
+    enforceMaxBytes();
+}
+
+size_t LruCache::getUsedBytes() const {
+    return _used_bytes + _contents.getBytes();
+}
+
+bool LruCache::isDeduplicating() const {
+    return _dedup;
+}
+
+void LruCache::setDeduplication(bool dedup) {
+    _dedup = dedup;
+}
+
+std::string LruCache::getPolicy() const {
+    return _policy->getName();
+}
+
+std::unique_ptr<CachePolicy> LruCache::createPolicy(const std::string &policy) const {
+    if (_partition_configs.empty()) {
+        return CachePolicy::create(policy, _max_size);
+    }
+    return PartitionedPolicy::create(policy, _partition_configs, _is_partition_borrowing, _max_size);
 }
 
-void LruCache::insert(const ndn::Data &data) {
-    if (data.getFreshnessPeriod().count() > 0) {
-        _tree.insert(data.getName(), std::make_shared<CacheEntry>(data), true);
-        _list_index[data.getName().toUri()] = _list.emplace(_list.begin(), data.getName());
-        if (_list.size() > _max_size) {
-            _tree.remove(*_list.rbegin());
-            _list_index.erase(_list.rbegin()->toUri());
-            _list.erase(--_list.end());
+void LruCache::replacePolicy(std::unique_ptr<CachePolicy> policy) {
+    // the new policy starts from the entries in the tree order, the hooks of the former one are overwritten
+    _policy = std::move(policy);
+    _partitions = _partition_configs.empty() ? nullptr : static_cast<PartitionedPolicy*>(_policy.get());
+    for (const auto &node : _tree.subtree(ndn::Name())) {
+        if (node.getValue()) {
+            node.getValue()->getHook() = CacheEntry::PolicyHook{nullptr, nullptr, CacheEntry::PolicyHook::NO_LIST,
+                                                                node.getValue()->getHook().hash};
+            _policy->insert(node.getValue().get(), _evicted);
+        }
+    }
+    removeEvicted();
+    _current_stats = &_stats[_policy->getName()];
+}
+
+bool LruCache::setPolicy(const std::string &policy) {
+    auto new_policy = createPolicy(policy);
+    if (!new_policy) {
+        return false;
+    }
+    replacePolicy(std::move(new_policy));
+    return true;
+}
+
+bool LruCache::setPartitions(const std::vector<PartitionedPolicy::Config> &partitions, bool is_borrowing) {
+    auto former_configs = std::move(_partition_configs);
+    bool was_borrowing = _is_partition_borrowing;
+    _partition_configs = partitions;
+    _is_partition_borrowing = is_borrowing;
+    auto new_policy = createPolicy(_policy->getName());
+    if (!new_policy) {
+        _partition_configs = std::move(former_configs);
+        _is_partition_borrowing = was_borrowing;
+        return false;
+    }
+    replacePolicy(std::move(new_policy));
+    return true;
+}
+
+std::vector<PartitionedPolicy::Stats> LruCache::getPartitionStats() const {
+    return _partitions ? _partitions->getStats() : std::vector<PartitionedPolicy::Stats>();
+}
+
+std::string LruCache::getAdmission() const {
+    return _admission->getName();
+}
+
+bool LruCache::setAdmission(const std::string &policy, const AdmissionPolicy::Parameters &parameters) {
+    auto admission = AdmissionPolicy::create(policy, _max_size, parameters);
+    if (!admission) {
+        return false;
+    }
+    _admission = std::move(admission);
+    return true;
+}
+
+const NegativeCache::Parameters& LruCache::getNegativeParameters() const {
+    return _negative.getParameters();
+}
+
+void LruCache::setNegativeParameters(const NegativeCache::Parameters &parameters) {
+    _negative.setParameters(parameters);
+}
+
+NegativeCache::Verdict LruCache::checkMiss(const NameView &name) {
+    NegativeCache::Verdict verdict = _negative.onMiss(name.getHash(), coarse_clock::now());
+    if (verdict == NegativeCache::NEGATIVE) {
+        ++_negative_hits;
+    } else if (verdict == NegativeCache::SUPPRESSED) {
+        ++_suppressed;
+    }
+    return verdict;
+}
+
+void LruCache::onAnswered(const NameView &name) {
+    _negative.onData(name);
+}
+
+bool LruCache::enableDiskTier(const std::string &directory, size_t size) {
+    std::unique_ptr<DiskTier> disk(new DiskTier(directory, size));
+    if (!disk->open()) {
+        return false;
+    }
+    _disk = std::move(disk);
+    return true;
+}
+
+void LruCache::setSharedTier(const std::shared_ptr<SharedTier> &shared) {
+    _shared = shared;
+}
+
+const ndn::time::seconds& LruCache::getCompressionAge() const {
+    return _compression_age;
+}
+
+void LruCache::setCompressionAge(const ndn::time::seconds &age) {
+    _compression_age = age;
+    _compression_cursor.clear();
+}
+
+void LruCache::removeEvicted(bool demote) {
+    for (CacheEntry *entry : _evicted) {
+        if (demote && _disk) {
+            _disk->append(*entry);
+        }
+        // the entry is freed with its node, its Name is copied before
+        ndn::Name name = entry->getName();
+        NDNMS_PROBE1(cs_evict, entry->getSize());
+        _used_bytes -= entry->getSize();
+        _expiry.remove(entry);
+        _exact.remove(name);
+        _tree.remove(name);
+    }
+    _evicted.clear();
+}
+
+void LruCache::enforceMaxBytes() {
+    while (_max_bytes > 0 && getUsedBytes() > _max_bytes) {
+        CacheEntry *victim = _policy->popVictim();
+        if (!victim) {
+            break;
+        }
+        _evicted.emplace_back(victim);
+        removeEvicted();
+    }
+}
+
+void LruCache::insert(const NdnPacket &packet) {
+    // answered, even if it isn't cached
+    _negative.onData(packet.getNameView());
+    if (packet.getFreshnessPeriod().count() > 0) {
+        const NameView &name = packet.getNameView();
+        if (!_admission->admit(name.getHash(), packet.getBlock().size()) && !_tree.find(name)) {
+            ++_rejected;
+            return;
+        }
+        ++_admitted;
+        auto entry = std::make_shared<CacheEntry>(packet, _dedup ? &_contents : nullptr);
+        entry->getHook().hash = packet.getNameView().getHash();
+        insert(entry);
+        if (_shared) {
+            _shared->append(*entry);
         }
         //std::cout << _tree.getPopulatedNodes() << "/" << _max_size << std::endl;
     }
 }
 
-std::shared_ptr<CacheEntry> LruCache::get(const ndn::Interest &interest) {
-    auto pair = _tree.findFirstFrom(interest.getName(), interest.getChildSelector());
-    while (pair.second) {
-        if (pair.second->isValid()) {
-            //std::cout << pair.first << " valid for " << pair.second->remainingTime() << std::endl;
-            _list.splice(_list.begin(), _list, _list_index.at(pair.second->getData().getName().toUri()));
-            return pair.second;
-        } else {
-            //std::cout << pair.first << "not valid" << std::endl;
-            _tree.remove(pair.first);
-            _list.erase(_list_index.at(pair.first.toUri()));
-            _list_index.erase(pair.first.toUri());
+void LruCache::restore(const NdnPacket &packet, const ndn::time::steady_clock::time_point &expire_time) {
+    if (expire_time > ndn::time::steady_clock::now()) {
+        auto entry = std::make_shared<CacheEntry>(packet, expire_time, _dedup ? &_contents : nullptr);
+        entry->getHook().hash = packet.getNameView().getHash();
+        insert(entry);
+    }
+}
+
+void LruCache::insert(const std::shared_ptr<CacheEntry> &entry) {
+    if (auto former = _tree.find(entry->getName())) {
+        _policy->erase(former.get());
+        _used_bytes -= former->getSize();
+        _expiry.remove(former.get());
+    }
+    _tree.insert(entry->getName(), entry, true);
+    _exact.insert(entry->getName(), entry, true);
+    _used_bytes += entry->getSize();
+    _expiry.insert(entry.get());
+    _policy->insert(entry.get(), _evicted);
+    if (!_evicted.empty()) {
+        // the cache is full, the next victims go along, half of it at most
+        size_t batch = std::min(_eviction_batch, _max_size / 2 + 1);
+        while (_evicted.size() < batch) {
+            CacheEntry *victim = _policy->popVictim();
+            if (!victim) {
+                break;
+            }
+            _evicted.emplace_back(victim);
+        }
+    }
+    removeEvicted();
+    enforceMaxBytes();
+}
+
+std::shared_ptr<CacheEntry> LruCache::get(const NameView &name) {
+    std::shared_ptr<CacheEntry> entry;
+    if (name.size() > 0 && name[name.size() - 1].type == ndn::tlv::ImplicitSha256DigestComponent) {
+        // the tree holds the Names without their implicit digest, the only Data under the rest of the Name is the one
+        // whose digest is checked
+        NameComponentRef digest = name[name.size() - 1];
+        entry = _tree.find(name, name.size() - 1);
+        if (entry && !entry->isValid()) {
+            _evicted.emplace_back(entry.get());
+            entry = nullptr;
+        } else if (entry && !entry->hasDigest(digest.value, digest.length)) {
+            entry = nullptr;
+        }
+    } else if (!name.getCanBePrefix()) {
+        entry = _exact.find(name);
+        if (entry && !entry->isValid()) {
+            _evicted.emplace_back(entry.get());
+            entry = nullptr;
         }
-        pair = _tree.findFirstFrom(interest.getName(), interest.getChildSelector());
+    } else {
+        // a single walk of the subtree in the order of the ChildSelector, the stale entries met on the way are skipped
+        // and removed once it is over
+        entry = _tree.findFirstMatch(name, name.getChildSelector() != 0, [this](const std::shared_ptr<CacheEntry> &candidate) {
+            if (candidate->isValid()) {
+                return true;
+            }
+            _evicted.emplace_back(candidate.get());
+            return false;
+        });
+    }
+    for (CacheEntry *stale : _evicted) {
+        _policy->erase(stale);
+    }
+    removeEvicted(false);
+    if (entry) {
+        _policy->onHit(entry.get());
+        entry->touch();
+        ++_current_stats->hits;
+        _prefix_stats.record(name, true);
+        if (_partitions) {
+            _partitions->record(name, true);
+        }
+        if (entry->isCompressed()) {
+            // hot again, it isn't decompressed on each hit
+            _used_bytes += entry->decompress();
+            ++_decompressions;
+            enforceMaxBytes();
+        }
+        return entry;
+    }
+    if (_disk) {
+        ndn::time::steady_clock::time_point expire_time;
+        if (auto wire = _disk->take(name, expire_time)) {
+            auto entry = std::make_shared<CacheEntry>(NdnPacket(ndn::Block(wire)), expire_time, _dedup ? &_contents : nullptr);
+            entry->getHook().hash = name.getHash();
+            insert(entry);
+            ++_current_stats->hits;
+            ++_disk_hits;
+            _prefix_stats.record(name, true);
+            if (_partitions) {
+                _partitions->record(name, true);
+            }
+            return entry;
+        }
+    }
+    if (_shared) {
+        ndn::time::steady_clock::time_point expire_time;
+        if (auto wire = _shared->find(name, expire_time)) {
+            // answered from the copy of the segment, the Data isn't cached here once more
+            ++_current_stats->hits;
+            ++_shared_hits;
+            _prefix_stats.record(name, true);
+            if (_partitions) {
+                _partitions->record(name, true);
+            }
+            return std::make_shared<CacheEntry>(NdnPacket(ndn::Block(wire)), expire_time);
+        }
+    }
+    _policy->onMiss(name.getHash());
+    _admission->onMiss(name.getHash());
+    ++_current_stats->misses;
+    _prefix_stats.record(name, false);
+    if (_partitions) {
+        _partitions->record(name, false);
     }
     return nullptr;
+}
+
+size_t LruCache::removeExpired(size_t max_entries) {
+    auto now = coarse_clock::now();
+    size_t removed = 0;
+    while (removed < max_entries) {
+        CacheEntry *entry = _expiry.popExpired(now);
+        if (!entry) {
+            break;
+        }
+        _policy->erase(entry);
+        _evicted.emplace_back(entry);
+        removeEvicted(false);
+        ++removed;
+    }
+    if (_disk) {
+        _disk->collect(now);
+    }
+    _negative.expire(now);
+    return removed;
+}
+
+size_t LruCache::pruneTree(size_t max_nodes) {
+    return _tree.prune(max_nodes);
+}
+
+size_t LruCache::compressCold(size_t max_entries) {
+    // the compressed entries stay at the cold end, the walk past them is bounded as well
+    static const size_t MAX_VISITS_PER_ENTRY = 16;
+
+    if (_compression_age.count() == 0) {
+        return 0;
+    }
+    auto cold_before = coarse_clock::now() - _compression_age;
+    CacheEntry *entry = _policy->getColdest();
+    bool is_resumed = false;
+    if (!_compression_cursor.empty()) {
+        auto cursor = _tree.find(_compression_cursor);
+        if (cursor && cursor->getHook().list == _compression_list && cursor->getLastAccess() < cold_before) {
+            entry = cursor->getHook().newer;
+            is_resumed = true;
+        }
+    }
+    size_t compressed = 0;
+    CacheEntry *last = nullptr;
+    for (size_t visits = 0; entry && compressed < max_entries && visits < MAX_VISITS_PER_ENTRY * max_entries; ++visits) {
+        // the policy lists are ordered by recency, the rest is hotter
+        if (entry->getLastAccess() >= cold_before) {
+            break;
+        }
+        if (size_t saved = entry->compress()) {
+            _used_bytes -= saved;
+            ++compressed;
+        }
+        last = entry;
+        entry = entry->getHook().newer;
+    }
+    if (last) {
+        _compression_cursor = last->getName();
+        _compression_list = last->getHook().list;
+    } else if (!is_resumed) {
+        _compression_cursor.clear();
+    }
+    return compressed;
+}
+
+size_t LruCache::writeSnapshot(std::string &out) const {
+    // the steady clock doesn't survive a restart, the expiration times are written on the system clock
+    auto now = ndn::time::duration_cast<ndn::time::milliseconds>(ndn::time::system_clock::now().time_since_epoch());
+    size_t records = 0;
+    for (const auto &node : _tree.subtree(ndn::Name())) {
+        const auto &entry = node.getValue();
+        if (!entry || !entry->isValid()) {
+            continue;
+        }
+        uint64_t expire_time = static_cast<uint64_t>((now + entry->remainingTime()).count());
+        const auto &wire = entry->getWire();
+        name_snapshot::writeVarNumber(out, name_snapshot::VALUE);
+        name_snapshot::writeVarNumber(out, 8 + wire->size());
+        for (size_t i = 8; i-- > 0;) {
+            out.push_back(static_cast<char>(expire_time >> (8 * i)));
+        }
+        out.append(reinterpret_cast<const char*>(wire->data()), wire->size());
+        ++records;
+    }
+    return records;
+}
+
+const LruCache::Stats& LruCache::getStats() const {
+    return _stats;
+}
+
+const PrefixStats& LruCache::getPrefixStats() const {
+    return _prefix_stats;
+}
+
+void LruCache::setPrefixStats(size_t depth, size_t entries) {
+    _prefix_stats.reset(depth, entries);
+}
+
+size_t LruCache::getAdmitted() const {
+    return _admitted;
+}
+
+size_t LruCache::getRejected() const {
+    return _rejected;
+}
+
+size_t LruCache::getNegativeHits() const {
+    return _negative_hits;
+}
+
+size_t LruCache::getSuppressed() const {
+    return _suppressed;
+}
+
+size_t LruCache::getNegativeEntries() const {
+    return _negative.getNegativeEntries();
+}
+
+size_t LruCache::getDiskHits() const {
+    return _disk_hits;
+}
+
+size_t LruCache::getSharedHits() const {
+    return _shared_hits;
+}
+
+size_t LruCache::getDiskEntries() const {
+    return _disk ? _disk->getEntries() : 0;
+}
+
+size_t LruCache::getDiskUsedBytes() const {
+    return _disk ? _disk->getUsedBytes() : 0;
+}
+
+size_t LruCache::getDedupContents() const {
+    return _contents.getContents();
+}
+
+size_t LruCache::getDedupBytes() const {
+    return _contents.getBytes();
+}
+
+size_t LruCache::getDedupShared() const {
+    return _contents.getShared();
+}
+
+void LruCache::addCompressionStats(CompressionStats &stats) const {
+    _tree.forEachValue([&](const CacheEntry &entry) {
+        if (entry.isCompressed()) {
+            ++stats.entries;
+            stats.raw_bytes += entry.getRawSize();
+            stats.compressed_bytes += entry.getWireMemoryUsage();
+        }
+    });
+    stats.decompressions += _decompressions;
+}
+
+void LruCache::addMemoryStats(MemoryStats &stats) const {
+    _tree.addMemoryStats(stats, "cache_tree");
+    _exact.addMemoryStats(stats, "cache_exact");
+    size_t entry_bytes = 0;
+    size_t wire_bytes = 0;
+    size_t compressed_entries = 0;
+    size_t compressed_bytes = 0;
+    _tree.forEachValue([&](const CacheEntry &entry) {
+        entry_bytes += entry.getMemoryUsage();
+        if (entry.isCompressed()) {
+            ++compressed_entries;
+            compressed_bytes += entry.getWireMemoryUsage();
+        } else {
+            wire_bytes += entry.getWireMemoryUsage();
+        }
+    });
+    stats.add("cache_entries", _tree.getPopulatedNodes(), entry_bytes);
+    stats.add("cache_wires", _tree.getPopulatedNodes() - compressed_entries, wire_bytes);
+    stats.add("cache_compressed_wires", compressed_entries, compressed_bytes);
+    stats.add("cache_shared_payloads", _contents.getContents(), _contents.getBytes() + _contents.getMemoryUsage());
+    // the lists themselves are intrusive, in the hooks of the entries
+    stats.add("cache_policy", 1, _policy->getMemoryUsage() + _admission->getMemoryUsage() + memory_usage::of(_evicted));
+    stats.add("cache_expiry_index", _expiry.size(), _expiry.getMemoryUsage());
+    stats.add("cache_negative", _negative.getPendingEntries() + _negative.getNegativeEntries(), _negative.getMemoryUsage());
+    stats.add("cache_prefix_stats", _prefix_stats.getCounters().size(), _prefix_stats.getMemoryUsage());
+    if (_disk) {
+        stats.add("disk_tier_index", _disk->getEntries(), _disk->getMemoryUsage());
+        stats.add("disk_tier_mapped", _disk->getEntries(), _disk->getMappedBytes());
+    }
+}
+
+std::string LruCache::statsToJSON(const Stats &stats) {
+    std::stringstream ss;
+    ss << "{";
+    bool first = true;
+    for (const auto &policy_stats : stats) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        size_t lookups = policy_stats.second.hits + policy_stats.second.misses;
+        ss << '"' << policy_stats.first << R"(":{"hits":)" << policy_stats.second.hits << R"(, "misses":)" << policy_stats.second.misses
+           << R"(, "hit_ratio":)" << (lookups > 0 ? static_cast<double>(policy_stats.second.hits) / lookups : 0.0) << "}";
+    }
+    ss << "}";
+    return ss.str();
 }
\ No newline at end of file
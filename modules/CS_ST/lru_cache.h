@@ -3,23 +3,107 @@
 #include <ndn-cxx/interest.hpp>
 #include <ndn-cxx/data.hpp>
 
+#include <map>
 #include <memory>
-#include <list>
-#include <unordered_map>
+#include <string>
+#include <vector>
 
 #include "tree/named_tree.h"
+#include "tree/name_hash_index.h"
+#include "network/ndn_packet.h"
 #include "cache_entry.h"
+#include "content_index.h"
+#include "cache_policy.h"
+#include "admission_policy.h"
+#include "negative_cache.h"
+#include "prefix_stats.h"
+#include "expiry_index.h"
+#include "disk_tier.h"
+#include "shared_tier.h"
 
+// the Data cached by Name in a tree, which of them are evicted is up to the replacement policy
 class LruCache {
+public:
+    struct PolicyStats {
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    // by policy name
+    using Stats = std::map<std::string, PolicyStats>;
+
+    // of the entries held compressed, summed over the shards for memory_stats
+    struct CompressionStats {
+        size_t entries = 0;
+        size_t raw_bytes = 0;
+        size_t compressed_bytes = 0;
+        size_t decompressions = 0;
+    };
+
 private:
     size_t _max_size;
+    // 0 for no limit
+    size_t _max_bytes;
+    size_t _used_bytes = 0;
 
+    // before the tree, the entries release their payloads into it
+    ContentIndex _contents;
+    bool _dedup = false;
     NamedTree<CacheEntry> _tree;
-    std::list<ndn::Name> _list;
-    std::unordered_map<std::string, std::list<ndn::Name>::iterator> _list_index;
+    // the same entries by their exact Name, an Interest without CanBePrefix finds its Data in a single probe
+    NameHashIndex<CacheEntry> _exact;
+    std::unique_ptr<CachePolicy> _policy;
+    // none for a single partition, see PartitionedPolicy
+    std::vector<PartitionedPolicy::Config> _partition_configs;
+    bool _is_partition_borrowing = true;
+    // _policy itself once partitioned
+    PartitionedPolicy *_partitions = nullptr;
+    std::unique_ptr<AdmissionPolicy> _admission;
+    size_t _admitted = 0;
+    size_t _rejected = 0;
+    NegativeCache _negative;
+    size_t _negative_hits = 0;
+    size_t _suppressed = 0;
+    ExpiryIndex _expiry;
+    // since the start, by policy, including those used before the current one
+    Stats _stats;
+    PolicyStats *_current_stats;
+    PrefixStats _prefix_stats;
+    // reused by each insert
+    std::vector<CacheEntry*> _evicted;
+    // entries evicted at once by an insert into the full cache, so that the next ones find room
+    size_t _eviction_batch = 1;
+    // where the evicted entries go if set
+    std::unique_ptr<DiskTier> _disk;
+    size_t _disk_hits = 0;
+    // where the Data admitted are copied and the misses looked up if set, held by the other shards as well
+    std::shared_ptr<SharedTier> _shared;
+    size_t _shared_hits = 0;
+    // the entries not hit for that long are compressed by compressCold(), 0 for none
+    ndn::time::seconds _compression_age{0};
+    // Name of the last entry compressCold() went through and the policy list it was in, the next slice goes on from
+    // there while it is still cold in the same list
+    ndn::Name _compression_cursor;
+    int _compression_list = CacheEntry::PolicyHook::NO_LIST;
+    size_t _decompressions = 0;
+
+    // the entries are appended to the disk tier unless demote is false
+    void removeEvicted(bool demote = true);
+
+    void insert(const std::shared_ptr<CacheEntry> &entry);
+
+    void enforceMaxBytes();
+
+    // partitioned if partitions are set, null if a policy is unknown
+    std::unique_ptr<CachePolicy> createPolicy(const std::string &policy) const;
+
+    // the cached Data are handed over to policy
+    void replacePolicy(std::unique_ptr<CachePolicy> policy);
 
 public:
-    explicit LruCache(size_t size);
+    // size in entries and max_bytes as counted by CacheEntry::getSize, 0 for no byte limit. policy is one of those
+    // of CachePolicy::create, lru if it is unknown
+    explicit LruCache(size_t size, size_t max_bytes = 0, const std::string &policy = "lru");
 
     ~LruCache() = default;
 
@@ -27,7 +111,128 @@ public:
 
     void setSize(size_t size);
 
-    void insert(const ndn::Data &data);
+    size_t getEvictionBatch() const;
+
+    // 1 evicts an entry per insert past the size, more evict down to size - batch + 1 entries in one pass
+    void setEvictionBatch(size_t batch);
+
+    size_t getMaxBytes() const;
+
+    void setMaxBytes(size_t max_bytes);
+
+    // the shared payloads are counted once
+    size_t getUsedBytes() const;
+
+    bool isDeduplicating() const;
+
+    // the Data inserted from now on share their payload with the cached Data which carry the same, the others keep
+    // theirs until they leave
+    void setDeduplication(bool dedup);
+
+    std::string getPolicy() const;
+
+    std::string getAdmission() const;
+
+    // false if the policy is unknown
+    bool setAdmission(const std::string &policy, const AdmissionPolicy::Parameters &parameters);
+
+    const NegativeCache::Parameters& getNegativeParameters() const;
+
+    void setNegativeParameters(const NegativeCache::Parameters &parameters);
+
+    // an Interest get() didn't answer and which would be forwarded upstream, it should be dropped unless FORWARD
+    NegativeCache::Verdict checkMiss(const NameView &name);
+
+    // a Data which answers Interests without being cached here, e.g. by another clone of the content store
+    void onAnswered(const NameView &name);
+
+    // size in bytes of the segment files in directory, false if they can't be created
+    bool enableDiskTier(const std::string &directory, size_t size);
+
+    // the segment already opened, shared with the other shards and the clones of the host
+    void setSharedTier(const std::shared_ptr<SharedTier> &shared);
+
+    const ndn::time::seconds& getCompressionAge() const;
+
+    // 0 stops compressing, the entries compressed already are decompressed once hit
+    void setCompressionAge(const ndn::time::seconds &age);
+
+    // the cached Data are handed over to the new policy, false if the policy is unknown. with partitions it is the
+    // one of the default partition and of those which don't name theirs
+    bool setPolicy(const std::string &policy);
+
+    // none goes back to a single policy, the cached Data are handed over to the partitions. false if a policy is
+    // unknown or the shares sum past 1, the partitions are then left as they were
+    bool setPartitions(const std::vector<PartitionedPolicy::Config> &partitions, bool is_borrowing);
+
+    // empty without partitions
+    std::vector<PartitionedPolicy::Stats> getPartitionStats() const;
+
+    // the packet must be a Data
+    void insert(const NdnPacket &packet);
+
+    // a Data cached before, e.g. by a former run of the module, nothing is done if it already expired
+    void restore(const NdnPacket &packet, const ndn::time::steady_clock::time_point &expire_time);
+
+    // a Name ending with an implicit digest matches the Data under the rest of it if that one has this digest, a Name
+    // which can't be a prefix only the Data of that Name, the others go through the tree. a Data only found on disk is brought back into memory, the Interest must then name it exactly
+    std::shared_ptr<CacheEntry> get(const NameView &name);
+
+    // removes the entries expired, at most max_entries of them so that the caller runs it in slices, returns how
+    // many were removed
+    size_t removeExpired(size_t max_entries);
+
+    // the tree nodes left empty by the removals are freed here rather than by each of them, about max_nodes of them
+    // so that the caller runs it in slices, returns how many were freed
+    size_t pruneTree(size_t max_nodes);
+
+    // the entries not hit for the compression age are compressed from the coldest end of the policy, at most
+    // max_entries of them so that the caller runs it in slices, returns how many were compressed
+    size_t compressCold(size_t max_entries);
+
+    // the fresh entries as name_snapshot VALUE records holding the expiration time, in milliseconds since the Unix
+    // epoch as an 8 bytes NonNegativeInteger, then the Data wire. returns the number of records
+    size_t writeSnapshot(std::string &out) const;
+
+    const Stats& getStats() const;
+
+    const PrefixStats& getPrefixStats() const;
+
+    // the prefixes counted so far are forgotten, depth 0 stops counting
+    void setPrefixStats(size_t depth, size_t entries);
+
+    size_t getAdmitted() const;
+
+    size_t getRejected() const;
+
+    size_t getNegativeHits() const;
+
+    size_t getSuppressed() const;
+
+    size_t getNegativeEntries() const;
+
+    size_t getDiskHits() const;
+
+    size_t getSharedHits() const;
+
+    size_t getDiskEntries() const;
+
+    size_t getDiskUsedBytes() const;
+
+    size_t getDedupContents() const;
+
+    size_t getDedupBytes() const;
+
+    size_t getDedupShared() const;
+
+    void addCompressionStats(CompressionStats &stats) const;
+
+    // "cache_tree_nodes" and "cache_tree_components" of the tree, "cache_exact_records" and "cache_exact_slots" of the
+    // exact index, "cache_entries", "cache_wires" and
+    // "cache_compressed_wires" of the Data in memory, "cache_shared_payloads" of the ContentIndex, then the policies
+    // and side tables
+    void addMemoryStats(MemoryStats &stats) const;
 
-    std::shared_ptr<CacheEntry> get(const ndn::Interest &interest);
+    // {"policy": {"hits", "misses", "hit_ratio"}} for each policy
+    static std::string statsToJSON(const Stats &stats);
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "lz4_codec.h"
+
+#ifdef NDNMS_HAS_LZ4
+#include <lz4.h>
+
+#include <vector>
+#endif
+
+namespace lz4_codec {
+
+#ifdef NDNMS_HAS_LZ4
+
+    bool isAvailable() {
+        return true;
+    }
+
+    std::shared_ptr<const ndn::Buffer> compress(const uint8_t *data, size_t size, size_t max_size) {
+        if (size > static_cast<size_t>(LZ4_MAX_INPUT_SIZE) || max_size == 0) {
+            return nullptr;
+        }
+        // the block is written here first, its buffer is then allocated to its exact size
+        thread_local std::vector<char> scratch;
+        scratch.resize(max_size);
+        int length = LZ4_compress_default(reinterpret_cast<const char*>(data), scratch.data(), static_cast<int>(size),
+                                          static_cast<int>(max_size));
+        if (length <= 0) {
+            return nullptr;
+        }
+        return std::make_shared<ndn::Buffer>(scratch.data(), static_cast<size_t>(length));
+    }
+
+    bool decompress(const uint8_t *block, size_t block_size, uint8_t *out, size_t size) {
+        int length = LZ4_decompress_safe(reinterpret_cast<const char*>(block), reinterpret_cast<char*>(out),
+                                         static_cast<int>(block_size), static_cast<int>(size));
+        return length >= 0 && static_cast<size_t>(length) == size;
+    }
+
+#else
+
+    bool isAvailable() {
+        return false;
+    }
+
+    std::shared_ptr<const ndn::Buffer> compress(const uint8_t *data, size_t size, size_t max_size) {
+        return nullptr;
+    }
+
+    bool decompress(const uint8_t *block, size_t block_size, uint8_t *out, size_t size) {
+        return false;
+    }
+
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <ndn-cxx/encoding/buffer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// LZ4 block compression of the cached wires, built when CMake finds liblz4 and its header. without them nothing is
+// compressed and the compressed tier of the cache stays off
+namespace lz4_codec {
+
+    bool isAvailable();
+
+    // null unless the block takes at most max_size bytes
+    std::shared_ptr<const ndn::Buffer> compress(const uint8_t *data, size_t size, size_t max_size);
+
+    // false unless the block decodes to exactly size bytes
+    bool decompress(const uint8_t *block, size_t block_size, uint8_t *out, size_t size);
+}
\ No newline at end of file
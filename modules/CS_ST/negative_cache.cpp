@@ -0,0 +1,85 @@
+#include "negative_cache.h"
+
+#include "metrics/memory_stats.h"
+
+void NegativeCache::setParameters(const Parameters &parameters) {
+    _parameters = parameters;
+    if (!isEnabled()) {
+        _pending.clear();
+        _pending_order.clear();
+        _negative.clear();
+        _negative_order.clear();
+    }
+}
+
+NegativeCache::Verdict NegativeCache::onMiss(uint64_t hash, const TimePoint &now) {
+    if (!isEnabled()) {
+        return FORWARD;
+    }
+    auto negative_it = _negative.find(hash);
+    if (negative_it != _negative.end() && now < negative_it->second) {
+        return NEGATIVE;
+    }
+    auto pending_it = _pending.find(hash);
+    if (pending_it != _pending.end()) {
+        if (now - pending_it->second < _parameters.suppression_window) {
+            return SUPPRESSED;
+        }
+        // a retransmission, the timeout starts again from it
+        pending_it->second = now;
+        _pending_order.emplace_back(hash, now);
+    } else if (_pending.size() < _parameters.max_entries) {
+        _pending.emplace(hash, now);
+        _pending_order.emplace_back(hash, now);
+    }
+    return FORWARD;
+}
+
+void NegativeCache::onData(const NameView &name) {
+    if (_pending.empty() && _negative.empty()) {
+        return;
+    }
+    for (size_t i = 0; i <= name.size(); ++i) {
+        uint64_t hash = name.getPrefixHash(i);
+        _pending.erase(hash);
+        _negative.erase(hash);
+    }
+}
+
+void NegativeCache::expire(const TimePoint &now) {
+    while (!_pending_order.empty() && now - _pending_order.front().second >= _parameters.timeout) {
+        auto front = _pending_order.front();
+        _pending_order.pop_front();
+        auto it = _pending.find(front.first);
+        // otherwise answered, or forwarded again since
+        if (it == _pending.end() || it->second != front.second) {
+            continue;
+        }
+        _pending.erase(it);
+        if (_parameters.ttl.count() > 0 && _negative.size() < _parameters.max_entries) {
+            TimePoint until = now + _parameters.ttl;
+            _negative[front.first] = until;
+            _negative_order.emplace_back(front.first, until);
+        }
+    }
+    while (!_negative_order.empty() && _negative_order.front().second <= now) {
+        auto front = _negative_order.front();
+        _negative_order.pop_front();
+        auto it = _negative.find(front.first);
+        if (it != _negative.end() && it->second == front.second) {
+            _negative.erase(it);
+        }
+    }
+}
+
+size_t NegativeCache::getPendingEntries() const {
+    return _pending.size();
+}
+
+size_t NegativeCache::getNegativeEntries() const {
+    return _negative.size();
+}
+
+size_t NegativeCache::getMemoryUsage() const {
+    return memory_usage::of(_pending) + memory_usage::of(_pending_order) + memory_usage::of(_negative) + memory_usage::of(_negative_order);
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+#include "network/name_view.h"
+
+// recent misses of the content store by name_hash: an Interest forwarded upstream which no Data answered within the
+// timeout makes its Name negative for ttl, the Interests for it are then dropped instead of forwarded again. with a
+// suppression window, an Interest identical to one forwarded less than that ago is dropped too, the Data coming
+// back to the first one is sent to every ingress face anyway. a Data for a Name clears it at once
+class NegativeCache {
+public:
+    struct Parameters {
+        // 0 disables the negative entries
+        ndn::time::milliseconds ttl = ndn::time::milliseconds(0);
+        // the default Interest lifetime
+        ndn::time::milliseconds timeout = ndn::time::milliseconds(4000);
+        // 0 disables the suppression
+        ndn::time::milliseconds suppression_window = ndn::time::milliseconds(0);
+        // of each of the pending and the negative Names, the misses above aren't remembered
+        size_t max_entries = 65536;
+    };
+
+    enum Verdict {
+        FORWARD,
+        SUPPRESSED,
+        NEGATIVE,
+    };
+
+private:
+    using TimePoint = ndn::time::steady_clock::time_point;
+
+    Parameters _parameters;
+    // when the last Interest for each Name was forwarded, the queue holds them in that order along with stale ones
+    std::unordered_map<uint64_t, TimePoint> _pending;
+    std::deque<std::pair<uint64_t, TimePoint>> _pending_order;
+    // until when each Name is negative, in that order in the queue
+    std::unordered_map<uint64_t, TimePoint> _negative;
+    std::deque<std::pair<uint64_t, TimePoint>> _negative_order;
+
+public:
+    const Parameters& getParameters() const {
+        return _parameters;
+    }
+
+    // the entries already there keep the times they were given
+    void setParameters(const Parameters &parameters);
+
+    bool isEnabled() const {
+        return _parameters.ttl.count() > 0 || _parameters.suppression_window.count() > 0;
+    }
+
+    // an Interest the cache didn't answer, hash is the name_hash of its Name. FORWARD records it as pending
+    Verdict onMiss(uint64_t hash, const TimePoint &now);
+
+    // a Data received, the pending and negative entries of its Name and of its prefixes are cleared since the
+    // Interests answered by it may have been shorter
+    void onData(const NameView &name);
+
+    // pending entries which timed out become negative, negative ones past their ttl are dropped
+    void expire(const TimePoint &now);
+
+    size_t getPendingEntries() const;
+
+    size_t getNegativeEntries() const;
+
+    // of both tables and their queues
+    size_t getMemoryUsage() const;
+};
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "pending_misses.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "metrics/memory_stats.h"
+
+PendingMisses::PendingMisses(std::chrono::milliseconds lifetime, size_t max_entries)
+        : _lifetime(lifetime)
+        , _max_entries(max_entries) {
+
+}
+
+std::chrono::milliseconds PendingMisses::getLifetime() const {
+    return _lifetime;
+}
+
+void PendingMisses::setLifetime(std::chrono::milliseconds lifetime) {
+    _lifetime = lifetime;
+}
+
+bool PendingMisses::add(uint64_t hash, const std::shared_ptr<Face> &face, const std::chrono::steady_clock::time_point &now) {
+    auto it = _entries.find(hash);
+    if (it == _entries.end()) {
+        if (_entries.size() >= _max_entries) {
+            for (auto entry_it = _entries.begin(); entry_it != _entries.end();) {
+                entry_it = now - entry_it->second.forwarded >= _lifetime ? _entries.erase(entry_it) : std::next(entry_it);
+            }
+            if (_entries.size() >= _max_entries) {
+                // forwarded without being remembered, its Data goes to every ingress face
+                return true;
+            }
+        }
+        it = _entries.emplace(hash, Entry()).first;
+        it->second.forwarded = now - _lifetime;
+    }
+    // a Data which didn't come back in time is asked again, the faces already waiting keep waiting
+    bool forward = now - it->second.forwarded >= _lifetime;
+    if (forward) {
+        it->second.forwarded = now;
+    }
+    auto &faces = it->second.faces;
+    if (std::none_of(faces.begin(), faces.end(), [&face](const std::weak_ptr<Face> &waiting) {
+        return waiting.lock() == face;
+    })) {
+        faces.emplace_back(face);
+    }
+    return forward;
+}
+
+bool PendingMisses::take(const NameView &name, std::vector<std::shared_ptr<Face>> &faces) {
+    bool found = false;
+    for (size_t i = 0; i <= name.size() && !_entries.empty(); ++i) {
+        auto it = _entries.find(name.getPrefixHash(i));
+        if (it == _entries.end()) {
+            continue;
+        }
+        for (const auto &waiting : it->second.faces) {
+            auto face = waiting.lock();
+            if (face && std::find(faces.begin(), faces.end(), face) == faces.end()) {
+                faces.emplace_back(face);
+            }
+        }
+        _entries.erase(it);
+        found = true;
+    }
+    return found;
+}
+
+void PendingMisses::clear() {
+    _entries.clear();
+}
+
+size_t PendingMisses::size() const {
+    return _entries.size();
+}
+
+size_t PendingMisses::getWaiting(const std::chrono::steady_clock::time_point &now) const {
+    size_t waiting = 0;
+    for (const auto &entry : _entries) {
+        if (now - entry.second.forwarded < _lifetime) {
+            ++waiting;
+        }
+    }
+    return waiting;
+}
+
+size_t PendingMisses::getMemoryUsage() const {
+    size_t bytes = memory_usage::of(_entries);
+    for (const auto &entry : _entries) {
+        bytes += memory_usage::of(entry.second.faces);
+    }
+    return bytes;
+}
\ No newline at end of file
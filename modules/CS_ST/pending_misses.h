@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "network/face.h"
+#include "network/name_view.h"
+
+// the misses of the content store forwarded upstream and still waiting for their Data, by name_hash of the Interest
+// Name: the later Interests for the same Name are attached to the first one instead of being forwarded, and the
+// Data is sent to the faces they came from only
+class PendingMisses {
+private:
+    struct Entry {
+        std::vector<std::weak_ptr<Face>> faces;
+        std::chrono::steady_clock::time_point forwarded;
+    };
+
+    std::chrono::milliseconds _lifetime;
+    size_t _max_entries;
+    std::unordered_map<uint64_t, Entry> _entries;
+
+public:
+    // an entry older than lifetime is forwarded again, those are dropped once max_entries are reached
+    PendingMisses(std::chrono::milliseconds lifetime, size_t max_entries);
+
+    std::chrono::milliseconds getLifetime() const;
+
+    void setLifetime(std::chrono::milliseconds lifetime);
+
+    // the face waits for the Data of the Name, true if the Interest must be forwarded, false if it was attached to
+    // one forwarded less than lifetime ago
+    bool add(uint64_t hash, const std::shared_ptr<Face> &face, const std::chrono::steady_clock::time_point &now);
+
+    // appends the faces still open which wait for this Data, under its Name or one of its prefixes, and forgets
+    // them. false if none waited
+    bool take(const NameView &name, std::vector<std::shared_ptr<Face>> &faces);
+
+    void clear();
+
+    size_t size() const;
+
+    // the entries forwarded less than lifetime ago, the others won't get their Data any more
+    size_t getWaiting(const std::chrono::steady_clock::time_point &now) const;
+
+    size_t getMemoryUsage() const;
+};
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "prefetcher.h"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+#include "network/tlv_reader.h"
+
+namespace {
+    const uint32_t GENERIC_COMPONENT = 8;
+    const uint32_t SEGMENT_COMPONENT = 50;
+    // of the segments of the former naming conventions, in a generic component
+    const uint8_t SEGMENT_MARKER = 0x00;
+
+    bool isNonNegativeInteger(size_t length) {
+        return length == 1 || length == 2 || length == 4 || length == 8;
+    }
+
+    bool readSegment(const NameComponentRef &component, uint64_t &segment) {
+        if (component.type == SEGMENT_COMPONENT && isNonNegativeInteger(component.length)) {
+            segment = tlv_reader::readNonNegativeInteger(component.value, component.length);
+            return true;
+        }
+        if (component.type == GENERIC_COMPONENT && component.length > 1 && component.value[0] == SEGMENT_MARKER
+            && isNonNegativeInteger(component.length - 1)) {
+            segment = tlv_reader::readNonNegativeInteger(component.value + 1, component.length - 1);
+            return true;
+        }
+        return false;
+    }
+
+    // the value of the segment component of the same convention as model, returns its length
+    size_t writeSegment(const NameComponentRef &model, uint64_t segment, uint8_t *value) {
+        size_t offset = 0;
+        if (model.type == GENERIC_COMPONENT) {
+            value[offset++] = SEGMENT_MARKER;
+        }
+        size_t length = segment <= 0xff ? 1 : segment <= 0xffff ? 2 : segment <= 0xffffffff ? 4 : 8;
+        for (size_t i = 0; i < length; ++i) {
+            value[offset + i] = static_cast<uint8_t>(segment >> (8 * (length - 1 - i)));
+        }
+        return offset + length;
+    }
+}
+
+const Prefetcher::Parameters& Prefetcher::getParameters() const {
+    return _parameters;
+}
+
+void Prefetcher::setParameters(const Parameters &parameters) {
+    _parameters = parameters;
+    _streams.clear();
+    _prefetches.clear();
+    _order.clear();
+    _in_flight = 0;
+    _fetched_bytes = 0;
+}
+
+bool Prefetcher::isEnabled() const {
+    return _parameters.window > 0;
+}
+
+void Prefetcher::expire(const std::chrono::steady_clock::time_point &now) {
+    while (!_order.empty() && now - _order.front().first >= std::chrono::seconds(LIFETIME)) {
+        auto it = _prefetches.find(_order.front().second);
+        if (it != _prefetches.end() && it->second.time == _order.front().first) {
+            if (it->second.size > 0) {
+                _fetched_bytes -= it->second.size;
+            } else {
+                --_in_flight;
+            }
+            ++_wasted_counter;
+            _prefetches.erase(it);
+        }
+        _order.pop_front();
+    }
+}
+
+bool Prefetcher::isFull() const {
+    return _fetched_bytes + _in_flight * _mean_size >= _parameters.max_bytes;
+}
+
+void Prefetcher::onInterest(const NameView &name, const std::chrono::steady_clock::time_point &now, std::vector<ndn::Name> &names) {
+    if (name.size() == 0) {
+        return;
+    }
+    expire(now);
+    auto prefetch_it = _prefetches.find(name.getHash());
+    if (prefetch_it != _prefetches.end()) {
+        if (prefetch_it->second.size > 0) {
+            _fetched_bytes -= prefetch_it->second.size;
+        } else {
+            --_in_flight;
+        }
+        ++_used_counter;
+        _prefetches.erase(prefetch_it);
+    }
+
+    NameComponentRef last = name[name.size() - 1];
+    uint64_t segment;
+    if (!readSegment(last, segment)) {
+        return;
+    }
+    uint64_t stream_hash = name.getPrefixHash(name.size() - 1);
+    auto stream_it = _streams.find(stream_hash);
+    if (stream_it == _streams.end()) {
+        if (_streams.size() >= MAX_STREAMS) {
+            for (auto it = _streams.begin(); it != _streams.end();) {
+                it = now - it->second.last_time >= std::chrono::seconds(LIFETIME) ? _streams.erase(it) : std::next(it);
+            }
+            if (_streams.size() >= MAX_STREAMS) {
+                return;
+            }
+        }
+        _streams.emplace(stream_hash, Stream{segment, segment, 0, now});
+        return;
+    }
+
+    Stream &stream = stream_it->second;
+    if (segment == stream.last_segment + 1) {
+        stream.window = std::min(std::max<size_t>(stream.window * 2, 1), _parameters.window);
+    } else if (segment != stream.last_segment) {
+        // a retransmission leaves the stream as it is, a jump starts it again from there
+        stream.window = 0;
+        stream.last_prefetched = segment;
+    }
+    stream.last_segment = segment;
+    stream.last_time = now;
+    stream.last_prefetched = std::max(stream.last_prefetched, segment);
+
+    ndn::Name prefix;
+    bool has_prefix = false;
+    uint8_t value[9];
+    while (stream.last_prefetched < segment + stream.window && !isFull()) {
+        size_t length = writeSegment(last, ++stream.last_prefetched, value);
+        uint64_t hash = name_hash::extend(stream_hash, NameComponentRef{last.type, value, length});
+        if (!has_prefix) {
+            prefix = name.toName().getPrefix(-1);
+            has_prefix = true;
+        }
+        names.emplace_back(prefix);
+        names.back().append(ndn::Name::Component(ndn::makeBinaryBlock(last.type, value, length)));
+        _prefetches[hash] = Prefetch{now, 0};
+        _order.emplace_back(now, hash);
+        ++_in_flight;
+        ++_prefetched_counter;
+    }
+}
+
+bool Prefetcher::onData(const NameView &name, size_t size) {
+    auto it = _prefetches.find(name.getHash());
+    if (it == _prefetches.end() || it->second.size > 0) {
+        return false;
+    }
+    it->second.size = std::max<size_t>(size, 1);
+    --_in_flight;
+    _fetched_bytes += it->second.size;
+    _mean_size = (_mean_size * 7 + size) / 8;
+    return true;
+}
+
+size_t Prefetcher::getStreams() const {
+    return _streams.size();
+}
+
+size_t Prefetcher::getFetchedBytes() const {
+    return _fetched_bytes;
+}
+
+size_t Prefetcher::getPrefetched() const {
+    return _prefetched_counter;
+}
+
+size_t Prefetcher::getUsed() const {
+    return _used_counter;
+}
+
+size_t Prefetcher::getWasted() const {
+    return _wasted_counter;
+}
+
+size_t Prefetcher::getMemoryUsage() const {
+    return memory_usage::of(_streams) + memory_usage::of(_prefetches) + memory_usage::of(_order);
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "network/name_view.h"
+
+// the next segments of the objects read in order, asked upstream before their consumer does. a stream is the Name of
+// the Interests without their last segment component, its window doubles at each segment asked right after the
+// previous one up to the max and is back to nothing on a jump. the Data prefetched and not asked yet are capped in
+// bytes, those in flight counted at the mean size. not thread-safe, the content store runs it where its ingress
+// Interests are read
+class Prefetcher {
+public:
+    struct Parameters {
+        // segments asked ahead at most, 0 for no prefetching
+        size_t window = 0;
+        size_t max_bytes = 16 << 20;
+    };
+
+    // in seconds, the default Interest lifetime. a prefetched Data not asked for by then is forgotten
+    static const int LIFETIME = 4;
+    static const size_t MAX_STREAMS = 4096;
+
+private:
+    struct Stream {
+        uint64_t last_segment;
+        // the last segment prefetched, or asked if it is greater
+        uint64_t last_prefetched;
+        size_t window;
+        std::chrono::steady_clock::time_point last_time;
+    };
+
+    struct Prefetch {
+        std::chrono::steady_clock::time_point time;
+        // 0 while in flight
+        size_t size;
+    };
+
+    Parameters _parameters;
+    // by name_hash of the stream
+    std::unordered_map<uint64_t, Stream> _streams;
+    // by name_hash of the Name prefetched, until its consumer asks for it or LIFETIME is over
+    std::unordered_map<uint64_t, Prefetch> _prefetches;
+    // in the order they were sent, the entries already asked for are skipped
+    std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t>> _order;
+    size_t _in_flight = 0;
+    size_t _fetched_bytes = 0;
+    size_t _mean_size = 4096;
+    size_t _prefetched_counter = 0;
+    size_t _used_counter = 0;
+    size_t _wasted_counter = 0;
+
+    void expire(const std::chrono::steady_clock::time_point &now);
+
+    bool isFull() const;
+
+public:
+    Prefetcher() = default;
+
+    const Parameters& getParameters() const;
+
+    // the streams and the prefetches in flight are forgotten
+    void setParameters(const Parameters &parameters);
+
+    bool isEnabled() const;
+
+    // the Names to ask upstream after an Interest for name are appended to names
+    void onInterest(const NameView &name, const std::chrono::steady_clock::time_point &now, std::vector<ndn::Name> &names);
+
+    // true if the Data was prefetched and no consumer asked for it yet, it then only goes to the cache
+    bool onData(const NameView &name, size_t size);
+
+    size_t getStreams() const;
+
+    // of the Data prefetched and not asked yet
+    size_t getFetchedBytes() const;
+
+    size_t getPrefetched() const;
+
+    // the prefetched Names a consumer asked for in time
+    size_t getUsed() const;
+
+    size_t getWasted() const;
+
+    // of the streams and the prefetches tracked
+    size_t getMemoryUsage() const;
+};
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "prefix_stats.h"
+
+#include <ndn-cxx/name.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+#include "metrics/memory_stats.h"
+#include "tree/name_snapshot.h"
+
+PrefixStats::PrefixStats(size_t depth, size_t capacity) : _depth(depth), _capacity(capacity) {
+
+}
+
+size_t PrefixStats::getDepth() const {
+    return _depth;
+}
+
+size_t PrefixStats::getCapacity() const {
+    return _capacity;
+}
+
+void PrefixStats::reset(size_t depth, size_t capacity) {
+    _depth = depth;
+    _capacity = capacity;
+    _counters.clear();
+    _index.clear();
+}
+
+size_t PrefixStats::siftUp(size_t i) {
+    while (i > 0 && _counters[i].getCount() < _counters[(i - 1) / 2].getCount()) {
+        std::swap(_counters[i], _counters[(i - 1) / 2]);
+        _index[_counters[i].hash] = i;
+        i = (i - 1) / 2;
+    }
+    return i;
+}
+
+void PrefixStats::siftDown(size_t i) {
+    for (;;) {
+        size_t smallest = i;
+        for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < _counters.size(); ++child) {
+            if (_counters[child].getCount() < _counters[smallest].getCount()) {
+                smallest = child;
+            }
+        }
+        if (smallest == i) {
+            return;
+        }
+        std::swap(_counters[i], _counters[smallest]);
+        _index[_counters[i].hash] = i;
+        _index[_counters[smallest].hash] = smallest;
+        i = smallest;
+    }
+}
+
+void PrefixStats::record(const NameView &name, bool hit) {
+    if (_depth == 0 || _capacity == 0) {
+        return;
+    }
+    size_t length = std::min(name.size(), _depth);
+    uint64_t hash = name.getPrefixHash(length);
+    auto it = _index.find(hash);
+    size_t i;
+    if (it != _index.end()) {
+        i = it->second;
+    } else {
+        if (_counters.size() < _capacity) {
+            _counters.push_back({hash, std::string(), 0, 0, 0});
+            i = siftUp(_counters.size() - 1);
+        } else {
+            i = 0;
+            _index.erase(_counters[0].hash);
+            size_t error = _counters[0].getCount();
+            _counters[0] = {hash, std::string(), 0, 0, error};
+        }
+        name_snapshot::writeComponents(_counters[i].prefix, name, length);
+        _index[hash] = i;
+    }
+    ++(hit ? _counters[i].hits : _counters[i].misses);
+    siftDown(i);
+}
+
+const std::vector<PrefixStats::Counter>& PrefixStats::getCounters() const {
+    return _counters;
+}
+
+size_t PrefixStats::getMemoryUsage() const {
+    size_t bytes = memory_usage::of(_counters) + memory_usage::of(_index);
+    for (const auto &counter : _counters) {
+        bytes += memory_usage::of(counter.prefix);
+    }
+    return bytes;
+}
+
+std::vector<PrefixStats::Counter> PrefixStats::merge(const std::vector<Counter> &counters, size_t max_entries) {
+    std::vector<Counter> merged;
+    std::unordered_map<uint64_t, size_t> index;
+    for (const auto &counter : counters) {
+        auto it = index.find(counter.hash);
+        if (it == index.end()) {
+            index.emplace(counter.hash, merged.size());
+            merged.push_back(counter);
+        } else {
+            merged[it->second].hits += counter.hits;
+            merged[it->second].misses += counter.misses;
+            merged[it->second].error += counter.error;
+        }
+    }
+    std::sort(merged.begin(), merged.end(), [](const Counter &lhs, const Counter &rhs) {
+        return lhs.getCount() > rhs.getCount();
+    });
+    if (merged.size() > max_entries) {
+        merged.resize(max_entries);
+    }
+    return merged;
+}
+
+std::string PrefixStats::toJSON(const std::vector<Counter> &counters) {
+    std::stringstream ss;
+    ss << "[";
+    bool first = true;
+    for (const auto &counter : counters) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        std::string wire;
+        name_snapshot::writeVarNumber(wire, ndn::tlv::Name);
+        name_snapshot::writeVarNumber(wire, counter.prefix.size());
+        wire.append(counter.prefix);
+        ndn::Name prefix(ndn::Block(reinterpret_cast<const uint8_t*>(wire.data()), wire.size()));
+        ss << R"({"prefix":")" << prefix.toUri() << R"(", "hits":)" << counter.hits << R"(, "misses":)" << counter.misses
+           << R"(, "error":)" << counter.error << "}";
+    }
+    ss << "]";
+    return ss.str();
+}
\ No newline at end of file
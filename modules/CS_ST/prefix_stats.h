@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "network/name_view.h"
+
+// hits and misses of the most requested prefixes of the Interest Names, cut at a given depth. Space-Saving (Metwally,
+// Agrawal and El Abbadi): at most capacity prefixes are counted, one seen for the first time takes the place of the
+// least requested and inherits its count as error. memory stays bounded whatever the number of distinct Names, and
+// every prefix requested more often than once in capacity lookups is among those counted
+class PrefixStats {
+public:
+    struct Counter {
+        uint64_t hash;
+        // TLV of the components, as written by name_snapshot::writeComponents
+        std::string prefix;
+        // since the prefix is counted
+        size_t hits;
+        size_t misses;
+        // at most this many lookups counted before were for other prefixes
+        size_t error;
+
+        size_t getCount() const {
+            return hits + misses + error;
+        }
+    };
+
+private:
+    size_t _depth;
+    size_t _capacity;
+    // min-heap on getCount(), the least requested prefix is the first one replaced
+    std::vector<Counter> _counters;
+    // position of each prefix in the heap, by name_hash
+    std::unordered_map<uint64_t, size_t> _index;
+
+    // the new position of the counter
+    size_t siftUp(size_t i);
+
+    void siftDown(size_t i);
+
+public:
+    PrefixStats(size_t depth, size_t capacity);
+
+    size_t getDepth() const;
+
+    size_t getCapacity() const;
+
+    // the counters are reset
+    void reset(size_t depth, size_t capacity);
+
+    // a lookup of this Interest Name, nothing is recorded at depth 0
+    void record(const NameView &name, bool hit);
+
+    const std::vector<Counter>& getCounters() const;
+
+    size_t getMemoryUsage() const;
+
+    // those of several caches summed by prefix, the max_entries most requested first
+    static std::vector<Counter> merge(const std::vector<Counter> &counters, size_t max_entries);
+
+    // [{"prefix", "hits", "misses", "error"}]
+    static std::string toJSON(const std::vector<Counter> &counters);
+};
\ No newline at end of file
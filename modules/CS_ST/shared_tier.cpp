@@ -0,0 +1,233 @@
+#include "shared_tier.h"
+
+#include <ndn-cxx/encoding/block.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log/logger.h"
+#include "network/buffer_pool.h"
+#include "network/coarse_clock.h"
+
+namespace {
+    // the slots start on their own cache line
+    const size_t HEADER_SIZE = 64;
+    // how long a process opening the segment waits for the one creating it
+    const size_t OPEN_ATTEMPTS = 100;
+    const std::chrono::milliseconds OPEN_DELAY(10);
+}
+
+SharedTier::SharedTier(const std::string &name) : _name(name) {
+    static_assert(sizeof(Header) <= HEADER_SIZE, "the header of the shared tier overlaps its index");
+}
+
+SharedTier::~SharedTier() {
+    if (_mapping) {
+        ::munmap(_mapping, _mapping_size);
+    }
+}
+
+bool SharedTier::open(size_t size) {
+    int fd = ::shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    bool is_creator = fd >= 0;
+    if (!is_creator && errno == EEXIST) {
+        fd = ::shm_open(_name.c_str(), O_RDWR, 0);
+    }
+    if (fd < 0) {
+        logger::log(logger::ERROR, "can't open shared memory segment " + _name + ": " + std::strerror(errno));
+        return false;
+    }
+    uint64_t log_size = 0;
+    uint64_t buckets = 1;
+    size_t mapping_size = 0;
+    if (is_creator) {
+        log_size = std::max<size_t>(size, 2 * BYTES_PER_BUCKET) & ~static_cast<size_t>(7);
+        while (buckets * BYTES_PER_BUCKET < log_size) {
+            buckets <<= 1;
+        }
+        mapping_size = HEADER_SIZE + buckets * WAYS * sizeof(Slot) + log_size;
+        if (::ftruncate(fd, mapping_size) != 0) {
+            logger::log(logger::ERROR, "can't size shared memory segment " + _name + ": " + std::strerror(errno));
+            ::close(fd);
+            ::shm_unlink(_name.c_str());
+            return false;
+        }
+    } else {
+        // the process creating it may not have sized it yet
+        struct stat status;
+        for (size_t i = 0; i < OPEN_ATTEMPTS && ::fstat(fd, &status) == 0 && status.st_size == 0; ++i) {
+            std::this_thread::sleep_for(OPEN_DELAY);
+        }
+        mapping_size = ::fstat(fd, &status) == 0 ? static_cast<size_t>(status.st_size) : 0;
+    }
+    bool is_mapped = mapping_size > HEADER_SIZE && map(fd, mapping_size);
+    ::close(fd);
+    if (!is_mapped) {
+        logger::log(logger::ERROR, "can't map shared memory segment " + _name);
+        return false;
+    }
+
+    if (is_creator) {
+        // a new segment is zeroed, the log and the index are already empty
+        _header->log_size = log_size;
+        _header->buckets = buckets;
+        _header->magic.store(MAGIC, std::memory_order_release);
+    } else {
+        for (size_t i = 0; i < OPEN_ATTEMPTS && _header->magic.load(std::memory_order_acquire) != MAGIC; ++i) {
+            std::this_thread::sleep_for(OPEN_DELAY);
+        }
+        if (_header->magic.load(std::memory_order_acquire) != MAGIC
+            || HEADER_SIZE + _header->buckets * WAYS * sizeof(Slot) + _header->log_size != mapping_size) {
+            logger::log(logger::ERROR, "invalid shared memory segment " + _name);
+            ::munmap(_mapping, _mapping_size);
+            _mapping = nullptr;
+            _header = nullptr;
+            return false;
+        }
+        if (_header->log_size != size) {
+            logger::log(logger::INFO, "shared memory segment {} already holds {} bytes of log", {_name, _header->log_size});
+        }
+    }
+    _log = static_cast<uint8_t*>(_mapping) + HEADER_SIZE + _header->buckets * WAYS * sizeof(Slot);
+    return true;
+}
+
+bool SharedTier::map(int fd, size_t size) {
+    void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+    _mapping = address;
+    _mapping_size = size;
+    _header = static_cast<Header*>(address);
+    _slots = reinterpret_cast<Slot*>(static_cast<uint8_t*>(address) + HEADER_SIZE);
+    return true;
+}
+
+void SharedTier::write(uint64_t position, const void *data, size_t size) {
+    size_t offset = position % _header->log_size;
+    size_t first = std::min<size_t>(size, _header->log_size - offset);
+    std::memcpy(_log + offset, data, first);
+    std::memcpy(_log, static_cast<const uint8_t*>(data) + first, size - first);
+}
+
+void SharedTier::read(uint64_t position, void *data, size_t size) const {
+    size_t offset = position % _header->log_size;
+    size_t first = std::min<size_t>(size, _header->log_size - offset);
+    std::memcpy(data, _log + offset, first);
+    std::memcpy(static_cast<uint8_t*>(data) + first, _log, size - first);
+}
+
+bool SharedTier::isIntact(uint64_t position) const {
+    // the reads of the record before the cursor, a writer reserves its record before writing it
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return _header->cursor.load(std::memory_order_relaxed) - position <= _header->log_size;
+}
+
+void SharedTier::append(CacheEntry &entry) {
+    const auto &wire = entry.getWire();
+    size_t record_size = getRecordSize(wire->size());
+    if (!_header || record_size > _header->log_size / 4 || !entry.isValid()) {
+        return;
+    }
+    uint64_t hash = entry.getHook().hash;
+    uint64_t position = _header->cursor.fetch_add(record_size);
+    RecordHeader header{hash, entry.getExpireTime().time_since_epoch().count(), static_cast<uint32_t>(wire->size()), 0};
+    write(position, &header, sizeof(header));
+    write(position + sizeof(header), wire->data(), wire->size());
+
+    // the slot of a former version of the Data, else an empty one, else that of the oldest record
+    Slot *bucket = _slots + (hash & (_header->buckets - 1)) * WAYS;
+    Slot *slot = bucket;
+    uint64_t oldest = UINT64_MAX;
+    for (size_t i = 0; i < WAYS; ++i) {
+        uint64_t slot_position = bucket[i].position.load(std::memory_order_relaxed);
+        if (slot_position == 0 || bucket[i].hash.load(std::memory_order_relaxed) == hash) {
+            slot = &bucket[i];
+            break;
+        }
+        if (slot_position < oldest) {
+            oldest = slot_position;
+            slot = &bucket[i];
+        }
+    }
+    // a reader may still pair the hash with another position for a while, the record header tells them apart
+    slot->position.store(0, std::memory_order_relaxed);
+    slot->hash.store(hash, std::memory_order_relaxed);
+    slot->position.store(position + 1, std::memory_order_release);
+    _header->inserts.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::shared_ptr<const ndn::Buffer> SharedTier::find(const NameView &name, ndn::time::steady_clock::time_point &expire_time) {
+    if (!_header) {
+        return nullptr;
+    }
+    uint64_t hash = name.getHash();
+    Slot *bucket = _slots + (hash & (_header->buckets - 1)) * WAYS;
+    for (size_t i = 0; i < WAYS; ++i) {
+        uint64_t slot_position = bucket[i].position.load(std::memory_order_acquire);
+        if (slot_position == 0 || bucket[i].hash.load(std::memory_order_relaxed) != hash) {
+            continue;
+        }
+        uint64_t position = slot_position - 1;
+        RecordHeader header;
+        read(position, &header, sizeof(header));
+        if (!isIntact(position) || header.hash != hash || getRecordSize(header.length) > _header->log_size / 4) {
+            continue;
+        }
+        expire_time = ndn::time::steady_clock::time_point(ndn::time::steady_clock::duration(header.expire_time));
+        if (expire_time <= coarse_clock::now()) {
+            continue;
+        }
+        auto wire = BufferPool::local().acquire(header.length);
+        read(position + sizeof(header), wire->data(), header.length);
+        if (!isIntact(position)) {
+            continue;
+        }
+        // the hash only selects the record, the Names are compared to rule out collisions
+        ndn::Block block(wire);
+        NameView record_name(block);
+        if (record_name.size() != name.size()) {
+            continue;
+        }
+        bool is_same = true;
+        for (size_t j = 0; j < name.size() && is_same; ++j) {
+            NameComponentRef a = name[j];
+            NameComponentRef b = record_name[j];
+            is_same = a.type == b.type && a.length == b.length && std::memcmp(a.value, b.value, a.length) == 0;
+        }
+        if (is_same) {
+            _header->hits.fetch_add(1, std::memory_order_relaxed);
+            return wire;
+        }
+    }
+    return nullptr;
+}
+
+const std::string& SharedTier::getName() const {
+    return _name;
+}
+
+size_t SharedTier::getLogSize() const {
+    return _header ? _header->log_size : 0;
+}
+
+size_t SharedTier::getInserts() const {
+    return _header ? _header->inserts.load(std::memory_order_relaxed) : 0;
+}
+
+size_t SharedTier::getHits() const {
+    return _header ? _header->hits.load(std::memory_order_relaxed) : 0;
+}
+
+size_t SharedTier::getMappedBytes() const {
+    return _mapping_size;
+}
\ No newline at end of file
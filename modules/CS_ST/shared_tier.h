@@ -0,0 +1,112 @@
+#pragma once
+
+#include <ndn-cxx/encoding/buffer.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "network/name_view.h"
+#include "cache_entry.h"
+
+// tier of the content store shared by the clones running on the same host: a POSIX shared memory segment mapped by
+// every process opening it under the same name, each of them still with its own faces and its own LruCache in front
+// of it. the Data cached by one clone are answered by all of them, exactly named as with the disk tier
+//
+// the segment holds a log of records written one after the other, wrapping around so that the oldest are overwritten,
+// and a hash index of WAYS slots per bucket from name_hash to the position of a record. nothing is locked: a writer
+// reserves its record by moving the cursor, writes it then publishes it in a slot, a reader copies the record and
+// keeps it only if the cursor didn't move past it meanwhile and if its Name is the one looked up. the expiration
+// times are on the steady clock, CLOCK_MONOTONIC is the same for the processes of a host
+//
+// the segment outlives the processes so that a clone restarted finds it warm, it goes away with the host or once
+// removed, e.g. rm /dev/shm/ndnms-cache
+class SharedTier {
+public:
+    static const uint64_t MAGIC = 0x6e646e6d73637331; // "ndnmscs1"
+    static const size_t WAYS = 4;
+    // bytes of log per bucket of the index
+    static const size_t BYTES_PER_BUCKET = 4096;
+
+private:
+    struct Header {
+        std::atomic<uint64_t> magic;
+        uint64_t log_size;
+        uint64_t buckets;
+        // absolute write position, the log offset is its remainder
+        std::atomic<uint64_t> cursor;
+        std::atomic<uint64_t> inserts;
+        std::atomic<uint64_t> hits;
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> hash;
+        // position of the record + 1, 0 for none
+        std::atomic<uint64_t> position;
+    };
+
+    struct RecordHeader {
+        uint64_t hash;
+        // steady_clock ticks
+        int64_t expire_time;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the index of the shared tier needs lock-free 64 bits atomics");
+
+    const std::string _name;
+    void *_mapping = nullptr;
+    size_t _mapping_size = 0;
+    Header *_header = nullptr;
+    Slot *_slots = nullptr;
+    uint8_t *_log = nullptr;
+
+    static size_t getRecordSize(size_t length) {
+        return (sizeof(RecordHeader) + length + 7) & ~static_cast<size_t>(7);
+    }
+
+    // the log wraps around, a record may go past its end
+    void write(uint64_t position, const void *data, size_t size);
+
+    void read(uint64_t position, void *data, size_t size) const;
+
+    // true while nothing was written over the record at position
+    bool isIntact(uint64_t position) const;
+
+    bool map(int fd, size_t size);
+
+public:
+    explicit SharedTier(const std::string &name);
+
+    SharedTier(const SharedTier&) = delete;
+
+    SharedTier& operator=(const SharedTier&) = delete;
+
+    ~SharedTier();
+
+    // maps the segment, created with size bytes if no process did yet, or as it is otherwise. false and logged if it
+    // fails
+    bool open(size_t size);
+
+    // copies the wire of the entry, nothing is done if it is expired or larger than a quarter of the log
+    void append(CacheEntry &entry);
+
+    // a copy of the wire of the Data named name and its expiration time, null if it isn't there or expired. the
+    // record stays for the other clones
+    std::shared_ptr<const ndn::Buffer> find(const NameView &name, ndn::time::steady_clock::time_point &expire_time);
+
+    const std::string& getName() const;
+
+    // of the log, the Data written there the last log_size bytes
+    size_t getLogSize() const;
+
+    // by all the processes
+    size_t getInserts() const;
+
+    size_t getHits() const;
+
+    size_t getMappedBytes() const;
+};
\ No newline at end of file
@@ -0,0 +1,367 @@
+// offline replay of a trace of Interests through LruCache, the code of the content store, for each configuration of
+// a sweep at once: policies times sizes times byte budgets, one thread per configuration. a Data missing from the
+// cache is inserted as if it came back from upstream, with the size and the FreshnessPeriod of the trace, and the
+// clock of the tables follows the times of the trace, so that the entries expire as they would have
+//
+// the trace is a capture of a module started with -R, its Interests with the Data it saw for them, or a text file
+// with a request per line: TIME_MS NAME [PAYLOAD_BYTES [FRESHNESS_MS]], # for comments
+// usage: ndnms-cache-sim -t TRACE -s SIZES [-b MAX_BYTES] [-P POLICIES] [-a ADMISSION] [-f FRESHNESS] [-p PAYLOAD] [-j THREADS]
+//        the lists are comma separated, e.g. -s 10000,100000,1000000 -P lru,arc,tinylfu -b 0,1073741824
+
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/encoding/block.hpp>
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "lru_cache.h"
+#include "log/logger.h"
+#include "network/coarse_clock.h"
+#include "network/ndn_packet.h"
+#include "network/packet_capture.h"
+
+struct Request {
+    // milliseconds since the first request
+    int64_t time;
+    uint32_t name;
+    uint32_t payload;
+    uint32_t freshness;
+};
+
+// the Names once each, as Interests for the lookups, and the requests referring to them
+struct Trace {
+    std::vector<ndn::Name> names;
+    std::vector<NdnPacket> interests;
+    std::vector<Request> requests;
+    std::unordered_map<std::string, uint32_t> index;
+
+    uint32_t addName(const ndn::Name &name) {
+        std::string uri = name.toUri();
+        auto it = index.find(uri);
+        if (it != index.end()) {
+            return it->second;
+        }
+        uint32_t i = static_cast<uint32_t>(names.size());
+        names.push_back(name);
+        ndn::Interest interest(name);
+        interest.setCanBePrefix(false);
+        interests.emplace_back(interest.wireEncode());
+        index.emplace(std::move(uri), i);
+        return i;
+    }
+};
+
+struct Configuration {
+    std::string policy;
+    size_t size;
+    size_t max_bytes;
+};
+
+struct Result {
+    size_t hits = 0;
+    size_t hit_bytes = 0;
+    size_t requested_bytes = 0;
+    // as counted against the byte budget, see CacheEntry::getSize
+    size_t peak_bytes = 0;
+    double seconds = 0;
+};
+
+static std::vector<std::string> split(const std::string &list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+static void appendVarNumber(std::vector<uint8_t> &wire, uint64_t number) {
+    if (number < 253) {
+        wire.push_back(static_cast<uint8_t>(number));
+    } else if (number <= 0xffff) {
+        wire.push_back(253);
+        wire.push_back(static_cast<uint8_t>(number >> 8));
+        wire.push_back(static_cast<uint8_t>(number));
+    } else {
+        wire.push_back(254);
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            wire.push_back(static_cast<uint8_t>(number >> shift));
+        }
+    }
+}
+
+static void appendElement(std::vector<uint8_t> &wire, uint32_t type, const uint8_t *value, size_t size) {
+    appendVarNumber(wire, type);
+    appendVarNumber(wire, size);
+    wire.insert(wire.end(), value, value + size);
+}
+
+// Name, a MetaInfo with the FreshnessPeriod, payload bytes of Content and a DigestSha256 signature nothing checks
+static NdnPacket makeData(const ndn::Name &name, uint32_t freshness, uint32_t payload) {
+    const ndn::Block &name_block = name.wireEncode();
+    std::vector<uint8_t> value(name_block.wire(), name_block.wire() + name_block.size());
+    const uint8_t freshness_period[] = {ndn::tlv::FreshnessPeriod, 4, static_cast<uint8_t>(freshness >> 24),
+                                        static_cast<uint8_t>(freshness >> 16), static_cast<uint8_t>(freshness >> 8),
+                                        static_cast<uint8_t>(freshness)};
+    appendElement(value, ndn::tlv::MetaInfo, freshness_period, sizeof(freshness_period));
+    std::vector<uint8_t> content(payload, 'x');
+    appendElement(value, ndn::tlv::Content, content.data(), content.size());
+    const uint8_t signature_info[] = {ndn::tlv::SignatureType, 1, ndn::tlv::SignatureTypeValue::DigestSha256};
+    appendElement(value, ndn::tlv::SignatureInfo, signature_info, sizeof(signature_info));
+    const uint8_t signature_value[32] = {};
+    appendElement(value, ndn::tlv::SignatureValue, signature_value, sizeof(signature_value));
+    std::vector<uint8_t> wire;
+    appendElement(wire, ndn::tlv::Data, value.data(), value.size());
+    return NdnPacket(ndn::Block(std::make_shared<const ndn::Buffer>(wire.data(), wire.size())));
+}
+
+static void readText(const std::string &path, uint32_t payload, uint32_t freshness, Trace &trace) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("can't open " + path);
+    }
+    std::string line;
+    int64_t first = -1;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::stringstream ss(line);
+        int64_t time;
+        std::string uri;
+        if (!(ss >> time >> uri)) {
+            throw std::runtime_error("malformed request: " + line);
+        }
+        Request request{0, trace.addName(ndn::Name(uri)), payload, freshness};
+        // a failed extraction would zero the field
+        uint32_t value;
+        if (ss >> value) {
+            request.payload = value;
+            if (ss >> value) {
+                request.freshness = value;
+            }
+        }
+        if (first < 0) {
+            first = time;
+        }
+        request.time = time - first;
+        trace.requests.push_back(request);
+    }
+}
+
+// the Interests the module received, with the size and freshness of the Data it sent or received on their Name.
+// an Interest whose Data isn't in the capture takes the defaults
+static void readCapture(const std::string &directory, uint32_t payload, uint32_t freshness, Trace &trace) {
+    CaptureReader reader(directory);
+    CaptureReader::Record record;
+    std::unordered_map<std::string, std::pair<uint32_t, uint32_t>> data;
+    while (reader.next(record)) {
+        if (record.size == 0 || record.wire[0] != ndn::tlv::Data) {
+            continue;
+        }
+        try {
+            NdnPacket packet(ndn::Block(std::make_shared<const ndn::Buffer>(record.wire, record.size)));
+            const ndn::Data &decoded = packet.getData();
+            data[decoded.getName().toUri()] = {static_cast<uint32_t>(decoded.getContent().value_size()),
+                                               static_cast<uint32_t>(decoded.getFreshnessPeriod().count())};
+        } catch (const std::exception &e) {
+            continue;
+        }
+    }
+
+    reader.rewind();
+    int64_t first = -1;
+    while (reader.next(record)) {
+        if (record.direction != PacketCapture::IN || record.size == 0 || record.wire[0] != ndn::tlv::Interest) {
+            continue;
+        }
+        try {
+            ndn::Interest interest(ndn::Block(std::make_shared<const ndn::Buffer>(record.wire, record.size)));
+            Request request{0, trace.addName(interest.getName()), payload, freshness};
+            auto it = data.find(interest.getName().toUri());
+            if (it != data.end()) {
+                request.payload = it->second.first;
+                request.freshness = it->second.second;
+            }
+            if (first < 0) {
+                first = record.time;
+            }
+            request.time = (record.time - first) / 1000000;
+            trace.requests.push_back(request);
+        } catch (const std::exception &e) {
+            continue;
+        }
+    }
+}
+
+// one configuration, on its own thread. the expired entries are removed once per second of the trace, as the content
+// store does on its timer
+static Result simulate(const Trace &trace, const Configuration &configuration, const std::string &admission) {
+    auto start = std::chrono::steady_clock::now();
+    Result result;
+    LruCache cache(configuration.size, configuration.max_bytes, configuration.policy);
+    if (!admission.empty()) {
+        cache.setAdmission(admission, AdmissionPolicy::Parameters());
+    }
+
+    coarse_clock::Scope scope;
+    auto origin = ndn::time::steady_clock::now();
+    int64_t next_expiry = 1000;
+    for (const Request &request : trace.requests) {
+        coarse_clock::set(origin + ndn::time::milliseconds(request.time));
+        if (request.time >= next_expiry) {
+            cache.removeExpired(SIZE_MAX);
+            next_expiry = request.time + 1000;
+        }
+        result.requested_bytes += request.payload;
+        if (cache.get(trace.interests[request.name].getNameView())) {
+            ++result.hits;
+            result.hit_bytes += request.payload;
+            continue;
+        }
+        cache.insert(makeData(trace.names[request.name], request.freshness, request.payload));
+        result.peak_bytes = std::max(result.peak_bytes, cache.getUsedBytes());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    std::string trace_path = "";
+    std::string sizes_list = "";
+    std::string max_bytes_list = "0";
+    std::string policies_list = "lru";
+    std::string admission = "";
+    uint32_t freshness = 3600000;
+    uint32_t payload = 1024;
+    size_t threads = 0;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc && argv[i][1] != 'h') {
+            exit(-1);
+        }
+        switch (argv[i][1]) {
+            case 't':
+                trace_path = argv[i + 1];
+                break;
+            case 's':
+                sizes_list = argv[i + 1];
+                break;
+            case 'b':
+                max_bytes_list = argv[i + 1];
+                break;
+            case 'P':
+                policies_list = argv[i + 1];
+                break;
+            case 'a':
+                admission = argv[i + 1];
+                break;
+            case 'f':
+                freshness = std::strtoul(argv[i + 1], nullptr, 10);
+                break;
+            case 'p':
+                payload = std::strtoul(argv[i + 1], nullptr, 10);
+                break;
+            case 'j':
+                threads = std::max(std::atoi(argv[i + 1]), 1);
+                break;
+            case 'h':
+            default:
+                std::cout << "usage: ndnms-cache-sim -t TRACE -s SIZES [-b MAX_BYTES] [-P POLICIES] [-a ADMISSION] [-f FRESHNESS]" << std::endl
+                          << "                       [-p PAYLOAD] [-j THREADS]" << std::endl;
+                exit(0);
+                break;
+        }
+    }
+
+    std::vector<Configuration> configurations;
+    for (const auto &policy : split(policies_list)) {
+        if (!CachePolicy::create(policy, 1)) {
+            std::cerr << "unknown policy " << policy << std::endl;
+            exit(-1);
+        }
+        for (const auto &size : split(sizes_list)) {
+            for (const auto &max_bytes : split(max_bytes_list)) {
+                configurations.push_back({policy, std::strtoull(size.c_str(), nullptr, 10), std::strtoull(max_bytes.c_str(), nullptr, 10)});
+            }
+        }
+    }
+    if (trace_path.empty() || configurations.empty()) {
+        exit(-1);
+    }
+    if (!admission.empty() && !AdmissionPolicy::create(admission, 1, AdmissionPolicy::Parameters())) {
+        std::cerr << "unknown admission policy " << admission << std::endl;
+        exit(-1);
+    }
+    if (threads == 0) {
+        threads = configurations.size();
+    }
+
+    logger::setMinimalLogLevel(logger::WARNING);
+    Trace trace;
+    try {
+        struct stat status;
+        if (::stat(trace_path.c_str(), &status) == 0 && S_ISDIR(status.st_mode)) {
+            readCapture(trace_path, payload, freshness, trace);
+        } else {
+            readText(trace_path, payload, freshness, trace);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        exit(-1);
+    }
+    if (trace.requests.empty()) {
+        std::cerr << "no request in " << trace_path << std::endl;
+        exit(-1);
+    }
+    std::cout << trace.requests.size() << " requests on " << trace.names.size() << " Names over "
+              << trace.requests.back().time / 1000.0 << "s, " << configurations.size() << " configurations on "
+              << std::min(threads, configurations.size()) << " threads" << std::endl;
+
+    // the threads take the next configuration until none is left, the results are printed in the sweep order
+    std::vector<Result> results(configurations.size());
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < std::min(threads, configurations.size()); ++i) {
+        workers.emplace_back([&]() {
+            for (size_t j = next++; j < configurations.size(); j = next++) {
+                results[j] = simulate(trace, configurations[j], admission);
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    std::printf("%-8s %10s %14s %10s %15s %16s %9s\n", "policy", "entries", "max_bytes", "hit_ratio", "byte_hit_ratio", "peak_used_bytes", "seconds");
+    for (size_t i = 0; i < configurations.size(); ++i) {
+        const Configuration &configuration = configurations[i];
+        const Result &result = results[i];
+        std::printf("%-8s %10zu %14zu %10.4f %15.4f %16zu %9.2f\n", configuration.policy.c_str(), configuration.size,
+                    configuration.max_bytes, static_cast<double>(result.hits) / trace.requests.size(),
+                    result.requested_bytes == 0 ? 0 : static_cast<double>(result.hit_bytes) / result.requested_bytes,
+                    result.peak_bytes, result.seconds);
+    }
+    logger::flush();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+// round trip of an Interest and its Data through the fused forwarder stages and through the PD -> BR -> NR chain, with
+// the same Pit and Fib. the chain hands the wire to the next stage in a loopback datagram, which is then parsed again
+// as the next process would, so each of its four hops costs a send, a receive and a new NdnPacket. the network and the
+// scheduling of a real deployment are left out, both sides measure the stages only
+// usage: chain_bench [round trips]
+
+#include <ndn-cxx/interest.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "fib.h"
+#include "pit.h"
+#include "network/face.h"
+
+// a face which only counts what it is given
+class NullFace : public Face {
+public:
+    size_t sent = 0;
+
+    explicit NullFace(boost::asio::io_service &ios) : Face(ios) {
+
+    }
+
+    std::string getUnderlyingProtocol() const override {
+        return "null";
+    }
+
+    std::string getUnderlyingEndpoint() const override {
+        return "";
+    }
+
+    void open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) override {
+
+    }
+
+    void close() override {
+
+    }
+
+    void send(const std::string &message) override {
+        ++sent;
+    }
+
+    void send(const ndn::Interest &interest) override {
+        ++sent;
+    }
+
+    void send(const ndn::Data &data) override {
+        ++sent;
+    }
+
+    void send(const std::shared_ptr<const ndn::Buffer> &wire) override {
+        ++sent;
+    }
+
+    QueueStats getQueueStats() const override {
+        return {};
+    }
+};
+
+// a loopback UDP socket sending to itself, each hop of the chain goes through it
+class Hop {
+private:
+    int _fd;
+    sockaddr_in _address{};
+    std::vector<uint8_t> _buffer;
+
+public:
+    Hop() : _fd(::socket(AF_INET, SOCK_DGRAM, 0)), _buffer(1 << 16) {
+        _address.sin_family = AF_INET;
+        _address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(_address);
+        if (_fd < 0 || ::bind(_fd, reinterpret_cast<sockaddr*>(&_address), length) != 0
+            || ::getsockname(_fd, reinterpret_cast<sockaddr*>(&_address), &length) != 0) {
+            throw std::runtime_error("can't bind the loopback socket");
+        }
+    }
+
+    ~Hop() {
+        ::close(_fd);
+    }
+
+    // the packet as the next stage receives it, in a buffer of its own
+    NdnPacket cross(const NdnPacket &packet) {
+        const auto &wire = packet.getWire();
+        ::sendto(_fd, wire->data(), wire->size(), 0, reinterpret_cast<sockaddr*>(&_address), sizeof(_address));
+        ssize_t size = ::recv(_fd, _buffer.data(), _buffer.size(), 0);
+        return NdnPacket(ndn::Block(std::make_shared<const ndn::Buffer>(_buffer.data(), static_cast<size_t>(size))));
+    }
+};
+
+static void appendVarNumber(std::vector<uint8_t> &wire, size_t number) {
+    if (number < 253) {
+        wire.push_back(static_cast<uint8_t>(number));
+    } else {
+        wire.push_back(253);
+        wire.push_back(static_cast<uint8_t>(number >> 8));
+        wire.push_back(static_cast<uint8_t>(number));
+    }
+}
+
+// Name, empty Content and a DigestSha256 SignatureInfo, nothing checks the SignatureValue here
+static ndn::Block makeData(const ndn::Name &name) {
+    static const uint8_t TAIL[] = {0x15, 0x00, 0x16, 0x03, 0x1b, 0x01, 0x00, 0x17, 0x00};
+    const ndn::Block &name_block = name.wireEncode();
+    std::vector<uint8_t> wire;
+    wire.push_back(ndn::tlv::Data);
+    appendVarNumber(wire, name_block.size() + sizeof(TAIL));
+    wire.insert(wire.end(), name_block.wire(), name_block.wire() + name_block.size());
+    wire.insert(wire.end(), TAIL, TAIL + sizeof(TAIL));
+    return ndn::Block(std::make_shared<const ndn::Buffer>(wire.data(), wire.size()));
+}
+
+struct Packets {
+    std::vector<ndn::Block> interests;
+    std::vector<ndn::Block> data;
+};
+
+static Packets makePackets(size_t round_trips) {
+    Packets packets;
+    for (size_t i = 0; i < round_trips; ++i) {
+        ndn::Name name("/bench/video");
+        name.appendNumber(i).appendSegment(0);
+        ndn::Interest interest(name);
+        interest.setCanBePrefix(false);
+        interest.setNonce(static_cast<uint32_t>(i));
+        interest.setInterestLifetime(ndn::time::milliseconds(4000));
+        packets.interests.emplace_back(interest.wireEncode());
+        packets.data.emplace_back(makeData(name));
+    }
+    return packets;
+}
+
+template <typename RoundTrip>
+static void run(const char *label, const Packets &packets, const RoundTrip &round_trip) {
+    size_t delivered = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < packets.interests.size(); ++i) {
+        delivered += round_trip(packets.interests[i], packets.data[i]);
+    }
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    std::cout << label << ": " << time.count() * 1e9 / packets.interests.size() << " ns per round trip, "
+              << packets.interests.size() / time.count() << " round trips/s"
+              << (delivered == packets.interests.size() ? "" : " (Data lost)") << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    size_t round_trips = argc > 1 ? std::stoul(argv[1]) : 100000;
+    auto packets = makePackets(round_trips);
+
+    boost::asio::io_service ios;
+    auto consumer = std::make_shared<NullFace>(ios);
+    auto producer = std::make_shared<NullFace>(ios);
+
+    {
+        Fib fib;
+        fib.insert(producer, ndn::Name("/bench"));
+        Pit pit(round_trips);
+        run("fused", packets, [&](const ndn::Block &interest_block, const ndn::Block &data_block) -> size_t {
+            NdnPacket interest(interest_block);
+            if (interest.isLocalScope() || pit.insert(interest.getInterest(), consumer, interest.getNameView().getHash()) != Pit::FORWARD) {
+                return 0;
+            }
+            for (const auto &face : fib.get(interest.getNameView())) {
+                face->send(interest);
+            }
+            NdnPacket data(data_block);
+            return pit.get(data.getNameView(), producer->getFaceId()).size();
+        });
+    }
+
+    {
+        Fib fib;
+        fib.insert(producer, ndn::Name("/bench"));
+        Pit pit(round_trips);
+        Hop hop;
+        run("chain", packets, [&](const ndn::Block &interest_block, const ndn::Block &data_block) -> size_t {
+            // PD
+            NdnPacket interest(interest_block);
+            if (interest.isLocalScope()) {
+                return 0;
+            }
+            // BR
+            NdnPacket br_interest = hop.cross(interest);
+            if (pit.insert(br_interest.getInterest(), consumer, br_interest.getNameView().getHash()) != Pit::FORWARD) {
+                return 0;
+            }
+            // NR
+            NdnPacket nr_interest = hop.cross(br_interest);
+            for (const auto &face : fib.get(nr_interest.getNameView())) {
+                face->send(nr_interest);
+            }
+            // the Data back from NR to BR, then from BR to PD
+            NdnPacket data(data_block);
+            NdnPacket br_data = hop.cross(data);
+            size_t faces = pit.get(br_data.getNameView(), producer->getFaceId()).size();
+            hop.cross(br_data);
+            return faces;
+        });
+    }
+
+    return 0;
+}
\ No newline at end of file
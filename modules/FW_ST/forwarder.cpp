@@ -0,0 +1,648 @@
+#include "forwarder.h"
+
+#include <boost/bind.hpp>
+
+#include "network/tcp_master_face.h"
+#include "network/udp_master_face.h"
+#include "network/shm_master_face.h"
+#include "network/tcp_face.h"
+#include "network/udp_face.h"
+#include "network/shm_face.h"
+#include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+#include "log/probes.h"
+#include "metrics/stage_profile.h"
+
+const uint8_t Forwarder::REGISTRATION_REPLY[44] = {0x65, 0x2a, 0x66, 0x01, 0xc8, 0x67, 0x07, 0x53, 0x75, 0x63, 0x63, 0x65, 0x73, 0x73,
+                                                   0x68, 0x1c, 0x07, 0x0d, 0x08, 0x03, 0x63, 0x6f, 0x6d, 0x08, 0x06, 0x67, 0x6f, 0x6f,
+                                                   0x67, 0x6c, 0x65, 0x69, 0x02, 0x01, 0x0d, 0x6f, 0x01, 0x00, 0x6a, 0x01, 0x00, 0x6c,
+                                                   0x01, 0x01};
+
+Forwarder::Forwarder(const std::string &name, size_t max_size, uint16_t local_port, uint16_t local_command_port,
+                     const std::string &fib_engine)
+        : Module(1)
+        , _name(name)
+        , _fib(fib_engine)
+        , _pit(max_size)
+        , _size(max_size)
+        , _command_socket(_control_ios, {{}, local_command_port})
+        , _connection_pool(_ios)
+        , _expiry_timer(_ios) {
+    _tcp_master_face = std::make_shared<TcpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _udp_master_face = std::make_shared<UdpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _shm_master_face = std::make_shared<ShmMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _metrics.addCollector(boost::bind(&Forwarder::writeMetrics, this, _1));
+}
+
+void Forwarder::run() {
+    // before the master faces accept any face, the commands are then read as usual
+    _startup_config.apply(_ios, _remote_command_endpoint, [this](const rapidjson::Document &command) {
+        executeCommand(command);
+    });
+    commandRead();
+    removeExpired(boost::system::error_code());
+    for (const auto &master_face : {_tcp_master_face, _udp_master_face, _shm_master_face}) {
+        master_face->listen(boost::bind(&Forwarder::onMasterFaceNotification, this, _1, _2),
+                            PacketHandler::bind<Forwarder, &Forwarder::onPacket>(this),
+                            boost::bind(&Forwarder::onMasterFaceError, this, _1, _2));
+    }
+}
+
+bool Forwarder::loadStartupConfig(const std::string &source) {
+    return _startup_config.load(source);
+}
+
+void Forwarder::beginDrain() {
+    for (const auto &master_face : {_tcp_master_face, _udp_master_face, _shm_master_face}) {
+        master_face->stopAccepting();
+    }
+}
+
+bool Forwarder::isDrained() {
+    size_t queued = 0;
+    for (const auto &master_face : {_tcp_master_face, _udp_master_face, _shm_master_face}) {
+        queued += master_face->getQueuedPackets();
+    }
+    for (const auto &egress_face : _egress_faces) {
+        queued += egress_face.second->getQueueStats().packets;
+    }
+    return queued == 0 && _pit.getEntries() == 0;
+}
+
+void Forwarder::onPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST:
+            // the dispatch PD does, on the first component only
+            if (packet.isLocalScope()) {
+                onLocalInterest(face, packet);
+            } else {
+                onInterest(face, packet);
+            }
+            break;
+        case NdnPacket::DATA:
+            onData(face, packet);
+            break;
+        default:
+            break;
+    }
+}
+
+void Forwarder::onInterest(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    stage_profile::Scope stage(stage_profile::TABLE);
+    const NameView &name = packet.getNameView();
+    // decoded here only, the BR stage of the chain
+    Pit::Verdict verdict = _pit.insert(packet.getInterest(), face, name.getHash());
+    NDNMS_PROBE3(pit_insert, name.getHash(), face->getFaceId(), verdict);
+    switch (verdict) {
+        case Pit::FORWARD: {
+            // the NR stage, on the same Name spans
+            bool is_routed = false;
+            for (const auto &producer_face : _fib.get(name)) {
+                if (producer_face != face) {
+                    producer_face->send(packet);
+                    is_routed = true;
+                }
+            }
+            if (is_routed) {
+                ++_forwarded;
+            } else {
+                ++_unrouted;
+                nack(face, packet, LpLink::NO_ROUTE);
+            }
+            break;
+        }
+        case Pit::CONGESTION:
+            nack(face, packet, LpLink::CONGESTION);
+            break;
+        case Pit::TOO_SHORT:
+            nack(face, packet, LpLink::NO_ROUTE);
+            break;
+        case Pit::CACHED:
+            // the CS stage, answered by the same lookup
+            face->send(_pit.getCachedData());
+            break;
+        default:
+            break;
+    }
+    // the entries evicted to make room for it
+    sendNacks();
+}
+
+void Forwarder::onData(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    stage_profile::Scope stage(stage_profile::TABLE);
+    for (const auto &consumer_face : _pit.get(packet, face->getFaceId())) {
+        consumer_face->send(packet);
+    }
+}
+
+void Forwarder::onLocalInterest(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    static const ndn::Name localhost("/localhost/nfd/rib/register");
+    static const ndn::Name localhop("/localhop/nfd/rib/register");
+    if (!_accept_registrations) {
+        return;
+    }
+    try {
+        const ndn::Name &name = packet.getName();
+        if (!localhost.isPrefixOf(name) && !localhop.isPrefixOf(name)) {
+            return;
+        }
+        // kept in the FIB, not in the buffer of the Interest
+        ndn::Name prefix = NdnPacket::copyName(ndn::Name(name.get(4).blockFromValue()));
+        std::stringstream ss;
+        ss << prefix << " name prefix registered for face with ID = " << face->getFaceId();
+        logger::log(logger::INFO, ss.str());
+        ndn::Data data(name);
+        data.setContent(REGISTRATION_REPLY, sizeof(REGISTRATION_REPLY));
+        data.setFreshnessPeriod(ndn::time::milliseconds(0));
+        _keychain.sign(data);
+        face->send(data);
+        _fib.insert(face, prefix);
+        ++_registrations;
+    } catch (const std::exception &e) {
+        return;
+    }
+}
+
+void Forwarder::nack(const std::shared_ptr<Face> &face, const NdnPacket &packet, LpLink::NackReason reason) {
+    if (_pit.allowNack()) {
+        stage_profile::Scope stage(stage_profile::ENCODE);
+        const ndn::Block &block = packet.getBlock();
+        face->send(LpLink::nack(block.wire(), block.size(), reason));
+    }
+}
+
+void Forwarder::sendNacks() {
+    _pit.takeNacks(_nacks);
+    for (const auto &nack : _nacks) {
+        _nack_faces.clear();
+        if (!nack.entry->takeFaces(_nack_faces)) {
+            continue;
+        }
+        std::shared_ptr<const ndn::Buffer> wire;
+        {
+            stage_profile::Scope stage(stage_profile::ENCODE);
+            ndn::Interest interest(nack.entry->getName());
+            interest.setCanBePrefix(nack.entry->canBePrefix());
+            interest.setNonce(nack.entry->getLastNonce());
+            const ndn::Block &block = interest.wireEncode();
+            wire = LpLink::nack(block.wire(), block.size(), nack.reason);
+        }
+        for (const auto &face : _nack_faces) {
+            face->send(wire);
+        }
+    }
+    _nacks.clear();
+}
+
+void Forwarder::removeExpired(const boost::system::error_code &err) {
+    static const boost::posix_time::milliseconds DELAY_BETWEEN_EXPIRIES(50);
+
+    if (err) {
+        return;
+    }
+    _pit.removeExpired(ndn::time::steady_clock::now());
+    sendNacks();
+    _expiry_timer.expires_from_now(DELAY_BETWEEN_EXPIRIES);
+    _expiry_timer.async_wait(boost::bind(&Forwarder::removeExpired, this, _1));
+}
+
+void Forwarder::onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
+    logger::log(logger::INFO, "new face with ID = {} from master face with ID = {}",
+                {face->getFaceId(), master_face->getMasterFaceId()});
+}
+
+void Forwarder::onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
+    logger::log(logger::ERROR, "face with ID = {} from master face with ID = {} can't process normally",
+                {face->getFaceId(), master_face->getMasterFaceId()});
+    // the routes registered by the producer on it, and the entries only this consumer was waiting for
+    _fib.remove(face);
+    _fib.removeExpiredFaces();
+    _pit.removeFace(face);
+}
+
+void Forwarder::onFaceError(const std::shared_ptr<Face> &face) {
+    _fib.remove(face);
+    _egress_faces.erase(face->getFaceId());
+    logger::log(logger::ERROR, "face with ID = {} can't process normally", {face->getFaceId()});
+}
+
+void Forwarder::commandRead() {
+    _command_socket.async_receive_from(boost::asio::buffer(_command_buffer, 65536), _remote_command_endpoint,
+                                       boost::bind(&Forwarder::commandReadHandler, this, _1, _2));
+}
+
+void Forwarder::commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred) {
+    if (!err) {
+        try {
+            if (management::isBatch(_command_buffer, bytes_transferred)) {
+                // decoded here, only the table updates run on the module thread
+                auto commands = std::make_shared<std::vector<management::Command>>(management::decodeBatch(_command_buffer, bytes_transferred));
+                applyCommand([this, commands]() {
+                    commandBatch(*commands);
+                }, boost::bind(&Forwarder::commandRead, this));
+                return;
+            }
+            rapidjson::Document document;
+            document.Parse(_command_buffer, bytes_transferred);
+            if (!document.HasParseError() && document.HasMember("action") && document["action"].IsString()
+                && document.HasMember("id") && document["id"].IsUint()) {
+                // applied on the module thread, the next command is read once it is done
+                auto command = std::make_shared<rapidjson::Document>(std::move(document));
+                applyCommand([this, command]() {
+                    executeCommand(*command);
+                }, boost::bind(&Forwarder::commandRead, this));
+                return;
+            }
+        } catch (const std::exception &e) {
+            std::cout << e.what() << std::endl;
+        }
+        commandRead();
+    } else {
+        std::cerr << "command socket error !" << std::endl;
+    }
+}
+
+void Forwarder::executeCommand(const rapidjson::Document &document) {
+    enum action_type {
+        EDIT_CONFIG,
+        ADD_FACE,
+        DEL_FACE,
+        ADD_ROUTE,
+        DEL_ROUTE,
+        LIST,
+        MEMORY_STATS,
+    };
+
+    static const std::unordered_map<std::string, action_type> ACTIONS = {
+            {"edit_config", EDIT_CONFIG},
+            {"add_face", ADD_FACE},
+            {"del_face", DEL_FACE},
+            {"add_route", ADD_ROUTE},
+            {"del_route", DEL_ROUTE},
+            {"list", LIST},
+            {"memory_stats", MEMORY_STATS},
+    };
+
+    auto it = ACTIONS.find(document["action"].GetString());
+    if (it == ACTIONS.end()) {
+        return;
+    }
+    switch (it->second) {
+        case EDIT_CONFIG:
+            commandEditConfig(document);
+            break;
+        case ADD_FACE:
+            commandAddFace(document);
+            break;
+        case DEL_FACE:
+            commandDelFace(document);
+            break;
+        case ADD_ROUTE:
+            commandAddRoutes(document);
+            break;
+        case DEL_ROUTE:
+            commandDelRoutes(document);
+            break;
+        case LIST:
+            commandList(document);
+            break;
+        case MEMORY_STATS:
+            commandMemoryStats(document);
+            break;
+    }
+}
+
+void Forwarder::commandEditConfig(const rapidjson::Document &document) {
+    std::vector<std::string> changes;
+    if (document.HasMember("size") && document["size"].IsUint()) {
+        bool has_change = false;
+        size_t size = document["size"].GetUint();
+        if (size != _size) {
+            _size = size;
+            _pit.setSize(size);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("size");
+        }
+    }
+    if (document.HasMember("max_bytes") && document["max_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["max_bytes"].GetUint();
+        if (max_bytes != _pit.getMaxBytes()) {
+            _pit.setMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("max_bytes");
+        }
+    }
+    if (document.HasMember("face_quota") && document["face_quota"].IsUint()) {
+        bool has_change = false;
+        size_t face_quota = document["face_quota"].GetUint();
+        if (face_quota != _pit.getFaceQuota()) {
+            _pit.setFaceQuota(face_quota);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("face_quota");
+        }
+    }
+    if (document.HasMember("nack") && document["nack"].IsBool()) {
+        bool has_change = false;
+        bool nack = document["nack"].GetBool();
+        if (nack != _pit.isNacking()) {
+            _pit.setNacking(nack);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("nack");
+        }
+    }
+    if (document.HasMember("straggler_window") && document["straggler_window"].IsUint()) {
+        bool has_change = false;
+        ndn::time::milliseconds window(document["straggler_window"].GetUint());
+        if (window != _pit.getStragglerWindow()) {
+            _pit.setStragglerWindow(window);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("straggler_window");
+        }
+    }
+    if (document.HasMember("cache_lifetime") && document["cache_lifetime"].IsUint()) {
+        bool has_change = false;
+        ndn::time::milliseconds lifetime(document["cache_lifetime"].GetUint());
+        if (lifetime != _pit.getCacheLifetime()) {
+            _pit.setCacheLifetime(lifetime);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("cache_lifetime");
+        }
+    }
+    if (document.HasMember("fib_aggregation") && document["fib_aggregation"].IsBool()) {
+        bool has_change = false;
+        bool aggregation = document["fib_aggregation"].GetBool();
+        if (aggregation != _fib.isAggregating()) {
+            _fib.setAggregation(aggregation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("fib_aggregation");
+        }
+    }
+    if (document.HasMember("connection_pool") && _connection_pool.update(document["connection_pool"])) {
+        changes.emplace_back("connection_pool");
+    }
+    if (document.HasMember("socket_options")) {
+        bool has_change = false;
+        // the default of the faces created from now on, the ingress master faces change theirs at once
+        SocketOptions options = SocketOptions::getDefault();
+        if (options.update(document["socket_options"]) && options != SocketOptions::getDefault()) {
+            SocketOptions::setDefault(options);
+            for (const auto &master_face : {_tcp_master_face, _udp_master_face}) {
+                master_face->setSocketOptions(options);
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("socket_options");
+        }
+    }
+    if (document.HasMember("accept_registrations") && document["accept_registrations"].IsBool()) {
+        bool has_change = false;
+        bool accept_registrations = document["accept_registrations"].GetBool();
+        if (accept_registrations != _accept_registrations) {
+            _accept_registrations = accept_registrations;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("accept_registrations");
+        }
+    }
+
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"edit_config", "changes":[)";
+    bool first = true;
+    for (const auto &change : changes) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ",";
+        }
+        ss << '"' << change << '"';
+    }
+    ss << "]}";
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+}
+
+void Forwarder::commandAddFace(const rapidjson::Document &document) {
+    enum layer_type {
+        TCP,
+        UDP,
+        SHM,
+    };
+
+    static const std::unordered_map<std::string, layer_type> LAYERS = {
+            {"tcp", TCP},
+            {"udp", UDP},
+            {"shm", SHM},
+    };
+
+    if (document.HasMember("layer") && document.HasMember("address") && document.HasMember("port")
+        && document["layer"].IsString() && document["address"].IsString() && document["port"].IsUint()) {
+        auto it = LAYERS.find(document["layer"].GetString());
+        if (it != LAYERS.end()) {
+            std::shared_ptr<Face> face;
+            switch (it->second) {
+                case TCP:
+                    face = _connection_pool.makeFace(_ios, document["address"].GetString(), document["port"].GetUint());
+                    break;
+                case UDP:
+                    face = std::make_shared<UdpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    break;
+                case SHM:
+                    face = std::make_shared<ShmFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    break;
+            }
+            if (document.HasMember("socket_options")) {
+                // on top of the default, before open for the buffers of a TCP connection
+                SocketOptions options = SocketOptions::getDefault();
+                if (options.update(document["socket_options"])) {
+                    face->setSocketOptions(options);
+                }
+            }
+            // Interests may come back from upstream as well, for the producers connected here
+            face->open(PacketHandler::bind<Forwarder, &Forwarder::onPacket>(this),
+                       boost::bind(&Forwarder::onFaceError, this, _1));
+            _egress_faces.emplace(face->getFaceId(), face);
+            std::stringstream ss;
+            ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_face", "face_id":)" << face->getFaceId() << "}";
+            sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+        }
+    }
+}
+
+void Forwarder::commandDelFace(const rapidjson::Document &document) {
+    if (document.HasMember("face_id") && document["face_id"].IsUint()) {
+        size_t face_id = document["face_id"].GetUint();
+        auto it = _egress_faces.find(face_id);
+        bool ok = it != _egress_faces.end();
+        if (ok) {
+            it->second->close();
+            _fib.remove(it->second);
+            _egress_faces.erase(it);
+        }
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_face", "face_id":)" << face_id << R"(, "status":)" << ok << "}";
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+    }
+}
+
+void Forwarder::commandAddRoutes(const rapidjson::Document &document) {
+    if (document.HasMember("face_id") && document["face_id"].IsUint() && document.HasMember("prefixes") && document["prefixes"].IsArray()) {
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_route", )";
+        auto it = _egress_faces.find(document["face_id"].GetUint());
+        if (it != _egress_faces.end()) {
+            std::vector<ndn::Name> prefixes;
+            for (const auto &prefix : document["prefixes"].GetArray()) {
+                if (prefix.IsString()) {
+                    prefixes.emplace_back(prefix.GetString());
+                }
+            }
+            uint32_t cost = document.HasMember("cost") && document["cost"].IsUint() ? document["cost"].GetUint() : FibEntry::DEFAULT_COST;
+            uint32_t weight = document.HasMember("weight") && document["weight"].IsUint() ? document["weight"].GetUint() : FibEntry::DEFAULT_WEIGHT;
+            _fib.insert(it->second, prefixes, cost, weight);
+            ss << R"("status":"success"})";
+        } else {
+            ss << R"("status":"fail", "reason":"unknown face id"})";
+        }
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+    }
+}
+
+void Forwarder::commandDelRoutes(const rapidjson::Document &document) {
+    if (document.HasMember("face_id") && document["face_id"].IsUint() && document.HasMember("prefixes") && document["prefixes"].IsArray()) {
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_route", )";
+        auto it = _egress_faces.find(document["face_id"].GetUint());
+        if (it != _egress_faces.end()) {
+            std::vector<ndn::Name> prefixes;
+            for (const auto &prefix : document["prefixes"].GetArray()) {
+                if (prefix.IsString()) {
+                    prefixes.emplace_back(prefix.GetString());
+                }
+            }
+            _fib.remove(it->second, prefixes);
+            ss << R"("status":"success"})";
+        } else {
+            ss << R"("status":"fail", "reason":"unknown face id"})";
+        }
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+    }
+}
+
+void Forwarder::commandList(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    sendOnControl(_command_socket, makeListReply(document["id"].GetUint()), _remote_command_endpoint);
+}
+
+void Forwarder::commandMemoryStats(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    MemoryStats stats;
+    _fib.addMemoryStats(stats);
+    _pit.addMemoryStats(stats);
+    stats.add("nacks", _nacks.size(), memory_usage::of(_nacks) + memory_usage::of(_nack_faces));
+    for (const auto &face : _egress_faces) {
+        face.second->addMemoryStats(stats);
+    }
+    _tcp_master_face->addMemoryStats(stats);
+    _udp_master_face->addMemoryStats(stats);
+    _shm_master_face->addMemoryStats(stats);
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"memory_stats", "memory":)"
+       << stats.toJSON() << "}";
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+}
+
+std::string Forwarder::makeListReply(uint64_t id) {
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << id << R"(, "action":"list", "faces":[)";
+    bool first = true;
+    for (const auto &face : _egress_faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face.second->toJSON();
+    }
+    ss << R"(], "master_faces":[)" << _tcp_master_face->toJSON() << ", " << _udp_master_face->toJSON() << ", " << _shm_master_face->toJSON() << "]"
+       << R"(, "connection_pool":)" << _connection_pool.toJSON() << R"(, "buffer_pool":)" << BufferPool::getStats().toJSON() << R"(, "stages":)" << stage_profile::toJSON()
+       << R"(, "fib":{"engine":")" << _fib.getEngine() << R"(", "aggregation":)" << (_fib.isAggregating() ? "true" : "false")
+       << R"(, "logical_entries":)" << _fib.getLogicalSize() << R"(, "physical_entries":)" << _fib.getPhysicalSize()
+       << R"(, "accept_registrations":)" << (_accept_registrations ? "true" : "false") << R"(, "registrations":)" << _registrations << "}"
+       << R"(, "pit":{"size":)" << _size << R"(, "entries":)" << _pit.getEntries() << R"(, "used_bytes":)" << _pit.getUsedBytes()
+       << R"(, "max_bytes":)" << _pit.getMaxBytes() << R"(, "face_quota":)" << _pit.getFaceQuota()
+       << R"(, "rejected":)" << _pit.getRejected() << R"(, "evicted":)" << _pit.getEvicted() << R"(, "expired":)" << _pit.getExpired()
+       << R"(, "satisfied":)" << _pit.getSatisfied() << R"(, "looped":)" << _pit.getLooped() << R"(, "duplicates":)" << _pit.getDuplicates()
+       << R"(, "straggler_window":)" << _pit.getStragglerWindow().count() << R"(, "absorbed":)" << _pit.getAbsorbed()
+       << R"(, "nack":)" << (_pit.isNacking() ? "true" : "false") << R"(, "nacked":)" << _pit.getNacked()
+       << R"(, "cache_lifetime":)" << _pit.getCacheLifetime().count() << R"(, "cached_bytes":)" << _pit.getCachedBytes()
+       << R"(, "cache_hits":)" << _pit.getCacheHits() << R"(, "rtt":)" << _pit.getRttStats().toJSON() << "}"
+       << R"(, "forwarded":)" << _forwarded << R"(, "unrouted":)" << _unrouted << "}";
+    return ss.str();
+}
+
+void Forwarder::commandBatch(const std::vector<management::Command> &commands) {
+    management::ReplyBatch replies;
+    for (const auto &command : commands) {
+        switch (command.action) {
+            case management::ADD_ROUTE:
+            case management::DEL_ROUTE: {
+                auto it = command.has_face_id ? _egress_faces.find(command.face_id) : _egress_faces.end();
+                if (it == _egress_faces.end()) {
+                    replies.add(command.id, command.action, management::FAIL, "unknown face id");
+                } else if (command.action == management::ADD_ROUTE) {
+                    uint32_t cost = command.has_cost ? static_cast<uint32_t>(command.cost) : FibEntry::DEFAULT_COST;
+                    uint32_t weight = command.has_weight ? static_cast<uint32_t>(command.weight) : FibEntry::DEFAULT_WEIGHT;
+                    _fib.insert(it->second, command.names, cost, weight);
+                    replies.add(command.id, command.action, management::SUCCESS);
+                } else {
+                    _fib.remove(it->second, command.names);
+                    replies.add(command.id, command.action, management::SUCCESS);
+                }
+                break;
+            }
+            case management::LIST:
+                replies.addPayload(command.id, command.action, makeListReply(command.id));
+                break;
+            default:
+                replies.add(command.id, command.action, management::FAIL, "action not implemented");
+                break;
+        }
+    }
+    for (const auto &datagram : replies.finish()) {
+        sendOnControl(_command_socket, datagram, _remote_command_endpoint);
+    }
+}
+
+void Forwarder::writeMetrics(MetricsWriter &writer) {
+    for (const auto &face : _egress_faces) {
+        face.second->writeMetrics(writer);
+    }
+    _tcp_master_face->writeMetrics(writer);
+    _udp_master_face->writeMetrics(writer);
+    _shm_master_face->writeMetrics(writer);
+    BufferPool::getStats().writeMetrics(writer);
+    stage_profile::writeMetrics(writer);
+    _pit.writeMetrics(writer, {});
+    writer.gauge("ndn_fib_logical_entries", "prefixes in the FIB", {}, _fib.getLogicalSize());
+    writer.gauge("ndn_fib_physical_entries", "entries of the FIB once aggregated", {}, _fib.getPhysicalSize());
+    writer.counter("ndn_forwarded_total", "Interests forwarded", {}, _forwarded);
+    writer.counter("ndn_unrouted_total", "Interests without a route", {}, _unrouted);
+    writer.counter("ndn_registrations_total", "prefix registrations accepted", {}, _registrations);
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+
+#include <boost/asio.hpp>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rapidjson/document.h"
+
+#include "runtime/module.h"
+#include "management/startup_config.h"
+#include "management/management_tlv.h"
+#include "network/face.h"
+#include "network/master_face.h"
+#include "network/tcp_connection_pool.h"
+#include "fib.h"
+#include "pit.h"
+
+// the name router, the backward router and the packet dispatcher fused in one process: consumers and producers all
+// connect to the same port as they would to a PD, and an Interest goes through the PIT then the FIB without leaving
+// the module thread. the stages hand the NdnPacket itself to each other, the wire received is the wire sent and only
+// the Interests creating a PIT entry are decoded, once. the Data go back to the faces of the PIT entries, which keep
+// them while fresh with a cache_lifetime: the CS stage is then the same lookup as the aggregation
+//
+// threads: everything below belongs to the module thread, FW scales by running more of them as NR, BR and PD would
+class Forwarder : public Module {
+    // registrations are answered with the reply NR sends
+    static const uint8_t REGISTRATION_REPLY[44];
+
+    const std::string _name;
+
+    Fib _fib;
+    Pit _pit;
+    size_t _size;
+
+    char _command_buffer[65536];
+    boost::asio::ip::udp::socket _command_socket;
+    boost::asio::ip::udp::endpoint _remote_command_endpoint;
+    StartupConfig _startup_config;
+    // connections kept open to the endpoints set by edit_config, add_face takes them
+    TcpConnectionPool _connection_pool;
+
+    // there is no manager to validate the /localhost/nfd/rib/register Interests of the producers, they are either all
+    // accepted or all ignored and the routes are only given with add_routes
+    bool _accept_registrations = false;
+    ndn::KeyChain _keychain;
+
+    boost::asio::deadline_timer _expiry_timer;
+    // reused by each sendNacks
+    std::vector<Pit::Nack> _nacks;
+    PitEntry::Faces _nack_faces;
+
+    size_t _forwarded = 0;
+    // Interests for which the FIB had no face but the one they came from
+    size_t _unrouted = 0;
+    size_t _registrations = 0;
+
+    // to other forwarders or routers, routes are given to them with add_routes
+    std::unordered_map<size_t, std::shared_ptr<Face>> _egress_faces;
+    std::shared_ptr<MasterFace> _tcp_master_face;
+    std::shared_ptr<MasterFace> _udp_master_face;
+    std::shared_ptr<MasterFace> _shm_master_face;
+
+    void onInterest(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+
+    void onData(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+
+    // the Interests to /localhost and /localhop, only the registrations are handled
+    void onLocalInterest(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+
+    // the Interest refused is sent back to face in a Nack
+    void nack(const std::shared_ptr<Face> &face, const NdnPacket &packet, LpLink::NackReason reason);
+
+    // to the faces of the entries evicted or expired, as PitShard does
+    void sendNacks();
+
+    void removeExpired(const boost::system::error_code &err);
+
+    // the master faces stop accepting, the faces already there are served until the module stops
+    void beginDrain() override;
+
+    // nothing queued on the faces and no Interest pending in the PIT, as in BR
+    bool isDrained() override;
+
+public:
+    Forwarder(const std::string &name, size_t max_size, uint16_t local_port, uint16_t local_command_port,
+              const std::string &fib_engine = "tree");
+
+    ~Forwarder() override = default;
+
+    void run() override;
+
+    // the commands applied by run() before the faces are accepted, see StartupConfig. false if source can't be
+    // read. before start()
+    bool loadStartupConfig(const std::string &source);
+
+    // from the consumers, the producers and the egress faces alike
+    void onPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+
+    void onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
+
+    void onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
+
+    void onFaceError(const std::shared_ptr<Face> &face);
+
+    void commandRead();
+
+    void commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred);
+
+    // a parsed command with an action, on the module thread
+    void executeCommand(const rapidjson::Document &document);
+
+    void commandEditConfig(const rapidjson::Document &document);
+
+    void commandAddFace(const rapidjson::Document &document);
+
+    void commandDelFace(const rapidjson::Document &document);
+
+    void commandAddRoutes(const rapidjson::Document &document);
+
+    void commandDelRoutes(const rapidjson::Document &document);
+
+    void commandList(const rapidjson::Document &document);
+
+    // the bytes held by the FIB, the PIT and the faces, see MemoryStats
+    void commandMemoryStats(const rapidjson::Document &document);
+
+    std::string makeListReply(uint64_t id);
+
+    // the commands of a binary batch, answered together
+    void commandBatch(const std::vector<management::Command> &commands);
+
+    // at each scrape, from the module thread as commandList
+    void writeMetrics(MetricsWriter &writer);
+};
\ No newline at end of file
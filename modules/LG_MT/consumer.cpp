@@ -0,0 +1,202 @@
+#include "consumer.h"
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+#include "packets.h"
+#include "log/logger.h"
+#include "network/tcp_face.h"
+#include "network/udp_face.h"
+
+Consumer::Consumer(const Config &config, std::unique_ptr<NameGenerator> generator, uint32_t seed)
+        : _config(config)
+        , _generator(std::move(generator))
+        , _timer(_ios)
+        , _random(seed)
+        , _outstanding(0)
+        , _is_sending(true) {
+    if (_config.layer == "UDP") {
+        _face = std::make_shared<UdpFace>(_ios, _config.host, _config.port);
+    } else {
+        _face = std::make_shared<TcpFace>(_ios, _config.host, _config.port);
+    }
+}
+
+void Consumer::start() {
+    if (!_config.capture.empty()) {
+        _capture.reset(new CaptureReader(_config.capture));
+        // the same start for all the consumers, each one replays its share at the offsets of the capture
+        if (_capture->next(_record)) {
+            _capture_start = _record.time;
+        }
+        _capture->rewind();
+        _has_record = nextRecord();
+    }
+    _face->open(Face::PacketCallback(boost::bind(&Consumer::onPacket, shared_from_this(), _1, _2)),
+                boost::bind(&Consumer::onError, shared_from_this(), _1));
+    _last_tick = Clock::now();
+    tick();
+    _thread = std::thread([this]() {
+        _ios.run();
+    });
+}
+
+void Consumer::stopSending() {
+    _is_sending = false;
+}
+
+void Consumer::stop() {
+    _ios.post(boost::bind(&Consumer::stopHandler, shared_from_this()));
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+void Consumer::tick() {
+    _timer.expires_from_now(boost::posix_time::microseconds(TICK_US));
+    _timer.async_wait(boost::bind(&Consumer::tickHandler, shared_from_this(), _1));
+}
+
+void Consumer::tickHandler(const boost::system::error_code &err) {
+    if (err) {
+        return;
+    }
+    auto now = Clock::now();
+    expire(now);
+    if (_is_sending && _face->isConnected() && _capture && _config.speed > 0) {
+        replay(now);
+    } else if (_is_sending && _face->isConnected()) {
+        size_t room = _config.window - std::min(_config.window, _outstanding.load());
+        if (_config.rate == 0) {
+            send(room, now);
+        } else {
+            std::chrono::duration<double> elapsed = now - _last_tick;
+            // the credit left while the window was full doesn't come out as a burst later
+            _credit = std::min(_credit + elapsed.count() * _config.rate, static_cast<double>(_config.window));
+            size_t count = std::min(room, static_cast<size_t>(_credit));
+            _credit -= count;
+            send(count, now);
+        }
+    }
+    _last_tick = now;
+    tick();
+}
+
+void Consumer::send(size_t count, Clock::time_point now) {
+    for (size_t i = 0; i < count; ++i) {
+        if (_capture) {
+            if (!_has_record) {
+                _is_sending = false;
+                return;
+            }
+            sendRecord(now);
+            continue;
+        }
+        std::string name = _config.prefix;
+        _generator->next(name);
+        auto wire = packets::makeInterest(name, _random(), _config.lifetime);
+        send(std::move(name), wire, now);
+    }
+}
+
+void Consumer::send(std::string name, const std::shared_ptr<const ndn::Buffer> &wire, Clock::time_point now) {
+    _face->send(wire);
+    _pending[name].emplace_back(now);
+    _expiries.emplace_back(now, std::move(name));
+    ++_outstanding;
+    _stats.sent.add(1);
+}
+
+void Consumer::replay(Clock::time_point now) {
+    if (_replay_start == Clock::time_point()) {
+        _replay_start = now;
+    }
+    std::chrono::duration<double, std::nano> elapsed = now - _replay_start;
+    int64_t due = _capture_start + static_cast<int64_t>(elapsed.count() * _config.speed);
+    while (_has_record && _record.time <= due) {
+        sendRecord(now);
+    }
+    if (!_has_record) {
+        _is_sending = false;
+    }
+}
+
+bool Consumer::nextRecord() {
+    while (_capture->next(_record)) {
+        if (_record.direction != PacketCapture::IN || _record.size == 0 || _record.wire[0] != ndn::tlv::Interest) {
+            continue;
+        }
+        try {
+            auto name = packets::findName(_record.wire, _record.size);
+            _record_name.assign(reinterpret_cast<const char*>(name.first), name.second);
+        } catch (const ndn::tlv::Error &e) {
+            continue;
+        }
+        if (_config.threads > 1 && std::hash<std::string>()(_record_name) % _config.threads != _config.thread) {
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+void Consumer::sendRecord(Clock::time_point now) {
+    // the Interest as it was captured, its Nonce and its InterestLifetime included
+    send(std::move(_record_name), BufferPool::local().copy(_record.wire, _record.size), now);
+    _has_record = nextRecord();
+}
+
+void Consumer::expire(Clock::time_point now) {
+    auto deadline = now - std::chrono::milliseconds(_config.lifetime);
+    while (!_expiries.empty() && _expiries.front().first <= deadline) {
+        const auto &expiry = _expiries.front();
+        // the Interest is in _pending only if its Data didn't come, a Name sent again since then has a later time
+        auto it = _pending.find(expiry.second);
+        if (it != _pending.end() && it->second.front() == expiry.first) {
+            it->second.pop_front();
+            if (it->second.empty()) {
+                _pending.erase(it);
+            }
+            --_outstanding;
+            _stats.timeouts.add(1);
+        }
+        _expiries.pop_front();
+    }
+}
+
+void Consumer::onPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    if (packet.getType() != NdnPacket::DATA) {
+        return;
+    }
+    auto name = packets::findName(packet.getBlock());
+    auto it = _pending.find(std::string(reinterpret_cast<const char*>(name.first), name.second));
+    if (it == _pending.end()) {
+        return;
+    }
+    auto now = Clock::now();
+    // the Interests aggregated on a Name are all answered by its Data
+    for (const auto &time : it->second) {
+        _stats.latency.record(std::chrono::duration_cast<std::chrono::microseconds>(now - time).count());
+        _stats.received.add(1);
+        _stats.bytes.add(packet.getBlock().size());
+        --_outstanding;
+    }
+    _pending.erase(it);
+    if (_is_sending && _config.rate == 0) {
+        send(_config.window - std::min(_config.window, _outstanding.load()), now);
+    }
+}
+
+void Consumer::onError(const std::shared_ptr<Face> &face) {
+    logger::log(logger::ERROR, "face to {} lost, consumer stopped", {_config.host});
+    _is_sending = false;
+}
+
+void Consumer::stopHandler() {
+    _timer.cancel();
+    _face->close();
+    _ios.stop();
+}
\ No newline at end of file
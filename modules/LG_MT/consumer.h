@@ -0,0 +1,147 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "name_generator.h"
+#include "network/face.h"
+#include "network/face_stats.h"
+#include "network/packet_capture.h"
+
+// one thread of the load generator asking for Names through a face of its own, paced by a tick. its counters and its
+// histogram are written by that thread only and read by the report from the main thread
+//
+// with a capture it replays the Interests a module received instead, as they were on the wire, at the pace they
+// came in times the speed. the threads share the Names of the capture by their hash, so an Interest and those
+// which follow it on the same Name go out of the same thread in their order
+class Consumer : public std::enable_shared_from_this<Consumer> {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static const size_t TICK_US = 1000;
+
+    struct Config {
+        // TCP or UDP
+        std::string layer;
+        std::string host;
+        uint16_t port;
+        // the value of the Name TLV, see packets
+        std::string prefix;
+        // Interests/s of this consumer, 0 for as many as the window lets out
+        double rate;
+        // Interests sent and not answered yet, at most
+        size_t window;
+        // in milliseconds, an Interest without Data by then is a timeout
+        uint64_t lifetime;
+        // directory of a capture to replay, see PacketCapture, none if empty
+        std::string capture;
+        // of the replay, 2 for twice as fast as captured, 0 for as many Interests as the window lets out
+        double speed;
+        // this consumer among those of the run, for the share of the capture it replays
+        size_t thread;
+        size_t threads;
+    };
+
+    struct Stats {
+        RelaxedCounter sent;
+        RelaxedCounter received;
+        RelaxedCounter timeouts;
+        // of the Data received, whole packets
+        RelaxedCounter bytes;
+        // from the send of the Interest to the receive of its Data, in microseconds
+        LatencyHistogram latency;
+    };
+
+private:
+    const Config _config;
+    boost::asio::io_service _ios;
+    std::thread _thread;
+    std::unique_ptr<NameGenerator> _generator;
+    std::shared_ptr<Face> _face;
+    boost::asio::deadline_timer _timer;
+    std::mt19937 _random;
+
+    // by Name, the send times of the Interests not answered yet, several of them when the distribution repeats a
+    // Name and they are aggregated on the way
+    std::unordered_map<std::string, std::deque<Clock::time_point>> _pending;
+    // the same Interests in the order they were sent, for the timeouts
+    std::deque<std::pair<Clock::time_point, std::string>> _expiries;
+    std::atomic<size_t> _outstanding;
+    // Interests the rate allows and which are not sent yet
+    double _credit = 0;
+    Clock::time_point _last_tick;
+    std::atomic<bool> _is_sending;
+
+    std::unique_ptr<CaptureReader> _capture;
+    // the next Interest of the capture for this consumer and its Name, valid if _has_record
+    CaptureReader::Record _record;
+    std::string _record_name;
+    bool _has_record = false;
+    // the time of the first packet of the capture, that of the first replayed Interest once the face is connected
+    int64_t _capture_start = 0;
+    Clock::time_point _replay_start;
+
+    Stats _stats;
+
+public:
+    Consumer(const Config &config, std::unique_ptr<NameGenerator> generator, uint32_t seed);
+
+    ~Consumer() = default;
+
+    // opens the face and starts the thread, the Interests go out once the face is connected. throws
+    // std::runtime_error if the capture can't be read
+    void start();
+
+    // the Interests still pending are answered or time out
+    void stopSending();
+
+    // joins the thread, the face is closed
+    void stop();
+
+    size_t getOutstanding() const {
+        return _outstanding;
+    }
+
+    // false once the capture is replayed, or the face lost
+    bool isSending() const {
+        return _is_sending;
+    }
+
+    const Stats& getStats() const {
+        return _stats;
+    }
+
+private:
+    void tick();
+
+    void tickHandler(const boost::system::error_code &err);
+
+    void send(size_t count, Clock::time_point now);
+
+    // the Interests of the capture due at now
+    void replay(Clock::time_point now);
+
+    // the next Interest of the capture for this consumer into _record, false at its end
+    bool nextRecord();
+
+    // _record, then the next one is read
+    void sendRecord(Clock::time_point now);
+
+    void send(std::string name, const std::shared_ptr<const ndn::Buffer> &wire, Clock::time_point now);
+
+    void expire(Clock::time_point now);
+
+    void onPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+
+    void onError(const std::shared_ptr<Face> &face);
+
+    void stopHandler();
+};
\ No newline at end of file
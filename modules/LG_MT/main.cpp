@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "consumer.h"
+#include "name_generator.h"
+#include "packets.h"
+#include "producer.h"
+#include "log/logger.h"
+#include "network/tcp_face.h"
+
+// load generator for a module or a chain of them: consumer threads ask for Names through the chain and a producer
+// answers at its end, both speak the same framing as the faces of the modules. every second it reports the rates
+// of the last second, the latency percentiles are since the start. the consumers may replay the Interests of a
+// capture instead, see Consumer, the run then ends with the capture
+static std::atomic<bool> is_stopped(false);
+
+static void onSignal(int signal) {
+    is_stopped = true;
+}
+
+static std::string toPrefix(const std::string &uri) {
+    std::string prefix;
+    std::stringstream ss(uri);
+    std::string component;
+    while (std::getline(ss, component, '/')) {
+        if (!component.empty()) {
+            packets::appendComponent(prefix, component);
+        }
+    }
+    return prefix;
+}
+
+static void printLatency(const LatencyHistogram &latency) {
+    std::cout << "p50 " << latency.getQuantile(0.5) << "us, p90 " << latency.getQuantile(0.9)
+              << "us, p99 " << latency.getQuantile(0.99) << "us, p99.9 " << latency.getQuantile(0.999)
+              << "us, max " << latency.getQuantile(1) << "us";
+}
+
+int main(int argc, char *argv[]) {
+    std::string mode = "consumer";
+    std::string layer = "TCP";
+    std::string host = "";
+    uint16_t port = 0;
+    uint16_t producer_port = 0;
+    std::string prefix = "/bench";
+    std::string distribution = "seq:1000";
+    size_t payload_size = 1024;
+    // Interests/s of all the threads, 0 for as many as their windows let out
+    double rate = 0;
+    size_t window = 32;
+    size_t threads = 1;
+    // in seconds, 0 to run until SIGINT or SIGTERM
+    size_t duration = 10;
+    uint64_t lifetime = 4000;
+    uint64_t freshness = 0;
+    // captured by a module started with -R, replayed instead of the distribution
+    std::string capture = "";
+    double speed = 1;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc && argv[i][1] != 'h') {
+            exit(-1);
+        }
+        switch (argv[i][1]) {
+            case 'm':
+                mode = argv[i + 1];
+                break;
+            case 'L':
+                layer = argv[i + 1];
+                std::transform(layer.begin(), layer.end(), layer.begin(), ::toupper);
+                break;
+            case 'c': {
+                std::string endpoint = argv[i + 1];
+                size_t colon = endpoint.rfind(':');
+                if (colon == std::string::npos) {
+                    exit(-1);
+                }
+                host = endpoint.substr(0, colon);
+                port = std::atoi(endpoint.c_str() + colon + 1);
+                break;
+            }
+            case 'p':
+                producer_port = std::atoi(argv[i + 1]);
+                break;
+            case 'n':
+                prefix = argv[i + 1];
+                break;
+            case 'd':
+                distribution = argv[i + 1];
+                break;
+            case 's':
+                payload_size = std::min<size_t>(std::strtoul(argv[i + 1], nullptr, 10), TcpFace::NDN_MAX_PACKET_SIZE - 400);
+                break;
+            case 'r':
+                rate = std::atof(argv[i + 1]);
+                break;
+            case 'w':
+                window = std::max(std::atoi(argv[i + 1]), 1);
+                break;
+            case 'j':
+                threads = std::max(std::atoi(argv[i + 1]), 1);
+                break;
+            case 'D':
+                duration = std::atoi(argv[i + 1]);
+                break;
+            case 'l':
+                lifetime = std::strtoull(argv[i + 1], nullptr, 10);
+                break;
+            case 'f':
+                freshness = std::strtoull(argv[i + 1], nullptr, 10);
+                break;
+            case 'R':
+                capture = argv[i + 1];
+                break;
+            case 'x':
+                speed = std::max(std::atof(argv[i + 1]), 0.0);
+                break;
+            case 'h':
+            default:
+                std::cout << "usage: ndnms-bench [-m consumer|producer|both] [-L TCP|UDP] [-c HOST:PORT] [-p PORT] [-n PREFIX]" << std::endl
+                          << "                   [-d zipf:OBJECTS:ALPHA|seq:SEGMENTS|flood] [-s PAYLOAD] [-r RATE] [-w WINDOW]" << std::endl
+                          << "                   [-j THREADS] [-D SECONDS] [-l LIFETIME] [-f FRESHNESS] [-R CAPTURE] [-x SPEED]" << std::endl;
+                exit(0);
+                break;
+        }
+    }
+    bool has_consumers = mode == "consumer" || mode == "both";
+    bool has_producer = mode == "producer" || mode == "both";
+    if ((!has_consumers && !has_producer) || (has_consumers && port == 0) || (has_producer && producer_port == 0)
+        || (layer != "TCP" && layer != "UDP")) {
+        exit(-1);
+    }
+
+    std::unique_ptr<NameDistribution> names;
+    try {
+        names.reset(new NameDistribution(distribution));
+    } catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << std::endl;
+        exit(-1);
+    }
+
+    std::cout << "ndnms-bench v1.0" << std::endl;
+
+    logger::isTee(true);
+    logger::setMinimalLogLevel(logger::WARNING);
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::unique_ptr<Producer> producer;
+    if (has_producer) {
+        producer.reset(new Producer(layer, producer_port, threads, payload_size, freshness));
+        producer->start();
+        std::cout << "producer on " << layer << " port " << producer_port << ", " << payload_size << " bytes of payload" << std::endl;
+    }
+
+    std::vector<std::shared_ptr<Consumer>> consumers;
+    if (has_consumers) {
+        Consumer::Config config;
+        config.layer = layer;
+        config.host = host;
+        config.port = port;
+        config.prefix = toPrefix(prefix);
+        config.rate = rate / threads;
+        config.window = window;
+        config.lifetime = lifetime;
+        config.capture = capture;
+        config.speed = speed;
+        config.threads = threads;
+        std::random_device random;
+        for (size_t i = 0; i < threads; ++i) {
+            config.thread = i;
+            consumers.emplace_back(std::make_shared<Consumer>(config, names->makeGenerator(i, threads, random()), random()));
+            try {
+                consumers.back()->start();
+            } catch (const std::runtime_error &e) {
+                std::cerr << e.what() << std::endl;
+                exit(-1);
+            }
+        }
+        if (capture.empty()) {
+            std::cout << threads << " consumers to " << layer << " " << host << ":" << port << ", " << prefix << ", "
+                      << names->toString() << ", " << (rate == 0 ? "window of " + std::to_string(window) : std::to_string(rate) + " Interests/s")
+                      << std::endl;
+        } else {
+            std::cout << threads << " consumers to " << layer << " " << host << ":" << port << ", replaying " << capture << " "
+                      << (speed == 0 ? "with a window of " + std::to_string(window) : "at x" + std::to_string(speed)) << std::endl;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t last_sent = 0;
+    uint64_t last_received = 0;
+    uint64_t last_timeouts = 0;
+    uint64_t last_bytes = 0;
+    uint64_t last_served = 0;
+    for (size_t second = 1; !is_stopped && (duration == 0 || second <= duration); ++second) {
+        std::this_thread::sleep_until(start + std::chrono::seconds(second));
+        std::cout << std::setw(4) << second << "s:";
+        if (has_consumers) {
+            uint64_t sent = 0, received = 0, timeouts = 0, bytes = 0;
+            size_t outstanding = 0;
+            LatencyHistogram latency;
+            for (const auto &consumer : consumers) {
+                const auto &stats = consumer->getStats();
+                sent += stats.sent.get();
+                received += stats.received.get();
+                timeouts += stats.timeouts.get();
+                bytes += stats.bytes.get();
+                outstanding += consumer->getOutstanding();
+                latency.add(stats.latency);
+            }
+            std::cout << " " << sent - last_sent << " Interests/s, " << received - last_received << " Data/s ("
+                      << (bytes - last_bytes) * 8 / 1e6 << " Mbit/s), " << timeouts - last_timeouts << " timeouts/s, "
+                      << outstanding << " outstanding, ";
+            printLatency(latency);
+            last_sent = sent;
+            last_received = received;
+            last_timeouts = timeouts;
+            last_bytes = bytes;
+        }
+        if (has_producer) {
+            uint64_t served = producer->getServed();
+            std::cout << " " << served - last_served << " served/s";
+            last_served = served;
+        }
+        std::cout << std::endl;
+        if (!capture.empty() && has_consumers
+            && std::none_of(consumers.begin(), consumers.end(), [](const std::shared_ptr<Consumer> &consumer) {
+                return consumer->isSending();
+            })) {
+            break;
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (has_consumers) {
+        // what is still pending is answered or times out before the totals
+        for (const auto &consumer : consumers) {
+            consumer->stopSending();
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(lifetime + 100);
+        while (!is_stopped && std::chrono::steady_clock::now() < deadline
+               && std::any_of(consumers.begin(), consumers.end(), [](const std::shared_ptr<Consumer> &consumer) {
+                   return consumer->getOutstanding() > 0;
+               })) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        uint64_t sent = 0, received = 0, timeouts = 0, bytes = 0;
+        LatencyHistogram latency;
+        for (const auto &consumer : consumers) {
+            consumer->stop();
+            const auto &stats = consumer->getStats();
+            sent += stats.sent.get();
+            received += stats.received.get();
+            timeouts += stats.timeouts.get();
+            bytes += stats.bytes.get();
+            latency.add(stats.latency);
+        }
+        std::cout << "sent " << sent << " Interests in " << elapsed.count() << "s, received " << received << " Data, "
+                  << timeouts << " timeouts" << std::endl
+                  << "throughput: " << received / elapsed.count() << " Data/s, " << bytes * 8 / elapsed.count() / 1e6 << " Mbit/s" << std::endl
+                  << "latency: ";
+        printLatency(latency);
+        std::cout << std::endl;
+    }
+    if (has_producer) {
+        producer->stop();
+        std::cout << "served " << producer->getServed() << " Data" << std::endl;
+    }
+    logger::flush();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "name_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+#include "packets.h"
+
+ZipfGenerator::ZipfGenerator(const std::shared_ptr<const std::vector<double>> &cdf, uint64_t seed)
+        : _cdf(cdf)
+        , _random(seed)
+        , _uniform(0, 1) {
+
+}
+
+void ZipfGenerator::next(std::string &name) {
+    auto it = std::lower_bound(_cdf->begin(), _cdf->end(), _uniform(_random));
+    size_t rank = std::min(static_cast<size_t>(it - _cdf->begin()), _cdf->size() - 1);
+    packets::appendComponent(name, std::to_string(rank));
+}
+
+std::shared_ptr<const std::vector<double>> ZipfGenerator::makeCdf(size_t objects, double alpha) {
+    auto cdf = std::make_shared<std::vector<double>>(objects);
+    double sum = 0;
+    for (size_t i = 0; i < objects; ++i) {
+        sum += 1 / std::pow(static_cast<double>(i + 1), alpha);
+        (*cdf)[i] = sum;
+    }
+    for (auto &p : *cdf) {
+        p /= sum;
+    }
+    return cdf;
+}
+
+SegmentGenerator::SegmentGenerator(size_t thread, size_t threads, size_t segments)
+        : _object(thread)
+        , _stride(threads)
+        , _segments(segments) {
+
+}
+
+void SegmentGenerator::next(std::string &name) {
+    packets::appendComponent(name, std::to_string(_object));
+    packets::appendComponent(name, std::to_string(_segment));
+    if (++_segment == _segments) {
+        _segment = 0;
+        _object += _stride;
+    }
+}
+
+FloodGenerator::FloodGenerator(uint64_t seed) : _random(seed) {
+
+}
+
+void FloodGenerator::next(std::string &name) {
+    std::stringstream ss;
+    ss << std::hex << _random();
+    packets::appendComponent(name, ss.str());
+}
+
+NameDistribution::NameDistribution(const std::string &spec) {
+    std::vector<std::string> fields;
+    std::stringstream ss(spec);
+    std::string field;
+    while (std::getline(ss, field, ':')) {
+        fields.emplace_back(field);
+    }
+    bool is_valid = false;
+    try {
+        if (fields.size() == 3 && fields[0] == "zipf") {
+            _kind = ZIPF;
+            _size = std::stoul(fields[1]);
+            _alpha = std::stod(fields[2]);
+            is_valid = _size > 0;
+        } else if (fields.size() == 2 && fields[0] == "seq") {
+            _kind = SEGMENTS;
+            _size = std::stoul(fields[1]);
+            is_valid = _size > 0;
+        } else if (fields.size() == 1 && fields[0] == "flood") {
+            _kind = FLOOD;
+            is_valid = true;
+        }
+    } catch (const std::logic_error &e) {
+        // std::stoul and std::stod throw std::invalid_argument or std::out_of_range
+    }
+    if (!is_valid) {
+        throw std::invalid_argument("unknown name distribution " + spec + ", expected zipf:OBJECTS:ALPHA, seq:SEGMENTS or flood");
+    }
+    if (_kind == ZIPF) {
+        _cdf = ZipfGenerator::makeCdf(_size, _alpha);
+    }
+}
+
+std::unique_ptr<NameGenerator> NameDistribution::makeGenerator(size_t thread, size_t threads, uint64_t seed) const {
+    switch (_kind) {
+        case ZIPF:
+            return std::unique_ptr<NameGenerator>(new ZipfGenerator(_cdf, seed));
+        case SEGMENTS:
+            return std::unique_ptr<NameGenerator>(new SegmentGenerator(thread, threads, _size));
+        case FLOOD:
+        default:
+            return std::unique_ptr<NameGenerator>(new FloodGenerator(seed));
+    }
+}
+
+std::string NameDistribution::toString() const {
+    std::stringstream ss;
+    switch (_kind) {
+        case ZIPF:
+            ss << "zipf, " << _size << " objects, alpha = " << _alpha;
+            break;
+        case SEGMENTS:
+            ss << "sequential segments, " << _size << " per object";
+            break;
+        case FLOOD:
+            ss << "random suffix flood";
+            break;
+    }
+    return ss.str();
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// the components a consumer thread appends to the prefix for its next Interest, each thread has a generator of its own
+class NameGenerator {
+public:
+    virtual ~NameGenerator() = default;
+
+    // appended to name, already encoded, see packets::appendComponent
+    virtual void next(std::string &name) = 0;
+};
+
+// /prefix/RANK, ranks in [0, objects) drawn with a Zipf law of exponent alpha, the repeated Names hit the caches
+class ZipfGenerator : public NameGenerator {
+private:
+    // P(rank <= i), shared by the generators of all the threads
+    std::shared_ptr<const std::vector<double>> _cdf;
+    std::mt19937_64 _random;
+    std::uniform_real_distribution<double> _uniform;
+
+public:
+    ZipfGenerator(const std::shared_ptr<const std::vector<double>> &cdf, uint64_t seed);
+
+    void next(std::string &name) override;
+
+    static std::shared_ptr<const std::vector<double>> makeCdf(size_t objects, double alpha);
+};
+
+// /prefix/OBJECT/SEGMENT, the segments of an object in order then the next object, as a file or a video is fetched.
+// the threads take the objects in turn so that no two of them ask for the same Name
+class SegmentGenerator : public NameGenerator {
+private:
+    uint64_t _object;
+    const size_t _stride;
+    const size_t _segments;
+    size_t _segment = 0;
+
+public:
+    SegmentGenerator(size_t thread, size_t threads, size_t segments);
+
+    void next(std::string &name) override;
+};
+
+// /prefix/RANDOM, a random 64-bit suffix never asked for before: every Interest misses the caches and makes a PIT
+// entry, as in an Interest flooding attack
+class FloodGenerator : public NameGenerator {
+private:
+    std::mt19937_64 _random;
+
+public:
+    explicit FloodGenerator(uint64_t seed);
+
+    void next(std::string &name) override;
+};
+
+// parsed from the -d option: zipf:OBJECTS:ALPHA, seq:SEGMENTS or flood
+class NameDistribution {
+private:
+    enum Kind {
+        ZIPF,
+        SEGMENTS,
+        FLOOD,
+    };
+
+    Kind _kind;
+    size_t _size = 0;
+    double _alpha = 0;
+    std::shared_ptr<const std::vector<double>> _cdf;
+
+public:
+    // throws std::invalid_argument on an unknown distribution
+    explicit NameDistribution(const std::string &spec);
+
+    std::unique_ptr<NameGenerator> makeGenerator(size_t thread, size_t threads, uint64_t seed) const;
+
+    std::string toString() const;
+};
\ No newline at end of file
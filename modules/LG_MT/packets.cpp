@@ -0,0 +1,104 @@
+#include "packets.h"
+
+#include <ndn-cxx/encoding/tlv.hpp>
+
+#include <vector>
+
+#include "network/buffer_pool.h"
+#include "network/tlv_reader.h"
+
+namespace packets {
+    static const size_t SIGNATURE_SIZE = 32;
+
+    static void appendVarNumber(std::vector<uint8_t> &wire, uint64_t number) {
+        if (number < 253) {
+            wire.push_back(static_cast<uint8_t>(number));
+        } else if (number <= 0xffff) {
+            wire.push_back(253);
+            wire.push_back(static_cast<uint8_t>(number >> 8));
+            wire.push_back(static_cast<uint8_t>(number));
+        } else {
+            wire.push_back(254);
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                wire.push_back(static_cast<uint8_t>(number >> shift));
+            }
+        }
+    }
+
+    static void appendNonNegativeInteger(std::vector<uint8_t> &wire, uint32_t type, uint64_t number) {
+        size_t length = number <= 0xff ? 1 : number <= 0xffff ? 2 : number <= 0xffffffff ? 4 : 8;
+        appendVarNumber(wire, type);
+        appendVarNumber(wire, length);
+        for (size_t i = length; i > 0; --i) {
+            wire.push_back(static_cast<uint8_t>(number >> (8 * (i - 1))));
+        }
+    }
+
+    static void appendElement(std::vector<uint8_t> &wire, uint32_t type, const uint8_t *value, size_t size) {
+        appendVarNumber(wire, type);
+        appendVarNumber(wire, size);
+        wire.insert(wire.end(), value, value + size);
+    }
+
+    static std::shared_ptr<const ndn::Buffer> wrap(uint32_t type, const std::vector<uint8_t> &value) {
+        std::vector<uint8_t> wire;
+        wire.reserve(value.size() + 10);
+        appendElement(wire, type, value.data(), value.size());
+        return BufferPool::local().copy(wire.data(), wire.size());
+    }
+
+    void appendComponent(std::string &name, const std::string &value) {
+        std::vector<uint8_t> wire;
+        appendVarNumber(wire, ndn::tlv::NameComponent);
+        appendVarNumber(wire, value.size());
+        name.append(wire.begin(), wire.end());
+        name += value;
+    }
+
+    std::shared_ptr<const ndn::Buffer> makeInterest(const std::string &name, uint32_t nonce, uint64_t lifetime) {
+        std::vector<uint8_t> value;
+        value.reserve(name.size() + 20);
+        appendElement(value, ndn::tlv::Name, reinterpret_cast<const uint8_t*>(name.data()), name.size());
+        const uint8_t nonce_bytes[] = {static_cast<uint8_t>(nonce >> 24), static_cast<uint8_t>(nonce >> 16),
+                                       static_cast<uint8_t>(nonce >> 8), static_cast<uint8_t>(nonce)};
+        appendElement(value, ndn::tlv::Nonce, nonce_bytes, sizeof(nonce_bytes));
+        appendNonNegativeInteger(value, ndn::tlv::InterestLifetime, lifetime);
+        return wrap(ndn::tlv::Interest, value);
+    }
+
+    std::shared_ptr<const ndn::Buffer> makeData(const uint8_t *name, size_t name_size, const std::string &payload, uint64_t freshness) {
+        static const uint8_t SIGNATURE_INFO[] = {ndn::tlv::SignatureType, 0x01, ndn::tlv::SignatureTypeValue::DigestSha256};
+        static const uint8_t SIGNATURE_VALUE[SIGNATURE_SIZE] = {};
+        std::vector<uint8_t> value;
+        value.reserve(name_size + payload.size() + SIGNATURE_SIZE + 30);
+        appendElement(value, ndn::tlv::Name, name, name_size);
+        if (freshness != 0) {
+            std::vector<uint8_t> meta_info;
+            appendNonNegativeInteger(meta_info, ndn::tlv::FreshnessPeriod, freshness);
+            appendElement(value, ndn::tlv::MetaInfo, meta_info.data(), meta_info.size());
+        }
+        appendElement(value, ndn::tlv::Content, reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+        appendElement(value, ndn::tlv::SignatureInfo, SIGNATURE_INFO, sizeof(SIGNATURE_INFO));
+        appendElement(value, ndn::tlv::SignatureValue, SIGNATURE_VALUE, sizeof(SIGNATURE_VALUE));
+        return wrap(ndn::tlv::Data, value);
+    }
+
+    std::pair<const uint8_t*, size_t> findName(const uint8_t *wire, size_t length) {
+        const uint8_t *begin = wire;
+        const uint8_t *end = begin + length;
+        tlv_reader::readVarNumber(begin, end);
+        tlv_reader::readVarNumber(begin, end);
+        if (tlv_reader::readVarNumber(begin, end) != ndn::tlv::Name) {
+            throw ndn::tlv::Error("the packet doesn't start with a Name");
+        }
+        uint64_t size = tlv_reader::readVarNumber(begin, end);
+        if (size > static_cast<uint64_t>(end - begin)) {
+            throw ndn::tlv::Error("truncated Name");
+        }
+        return {begin, static_cast<size_t>(size)};
+    }
+
+    std::pair<const uint8_t*, size_t> findName(const ndn::Block &block) {
+        return findName(block.wire(), block.size());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/encoding/buffer.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+// bare TLV encoding of the generated packets, so that building them costs less than handling them in the modules
+// under test. a Name is kept as the value of its Name TLV, its components already encoded
+namespace packets {
+    void appendComponent(std::string &name, const std::string &value);
+
+    // Name, Nonce and InterestLifetime, valid in both Interest formats
+    std::shared_ptr<const ndn::Buffer> makeInterest(const std::string &name, uint32_t nonce, uint64_t lifetime);
+
+    // DigestSha256 SignatureInfo with a zeroed SignatureValue, the modules only read its type. no MetaInfo for a
+    // freshness of 0
+    std::shared_ptr<const ndn::Buffer> makeData(const uint8_t *name, size_t name_size, const std::string &payload, uint64_t freshness);
+
+    // the value of the Name TLV of an Interest or a Data, throws ndn::tlv::Error on malformed packets
+    std::pair<const uint8_t*, size_t> findName(const uint8_t *wire, size_t length);
+
+    std::pair<const uint8_t*, size_t> findName(const ndn::Block &block);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "producer.h"
+
+#include <boost/bind.hpp>
+
+#include "packets.h"
+#include "log/logger.h"
+#include "network/tcp_master_face.h"
+#include "network/udp_master_face.h"
+
+Producer::Producer(const std::string &layer, uint16_t port, size_t threads, size_t payload_size, uint64_t freshness)
+        : _work(new boost::asio::io_service::work(_ios))
+        , _thread_count(threads)
+        , _payload(payload_size, 'x')
+        , _freshness(freshness)
+        , _served(0) {
+    if (layer == "UDP") {
+        _master_face = std::make_shared<UdpMasterFace>(_ios, 1024, port, threads);
+    } else {
+        _master_face = std::make_shared<TcpMasterFace>(_ios, 1024, port);
+    }
+}
+
+void Producer::start() {
+    _master_face->listen(boost::bind(&Producer::onMasterFaceNotification, this, _1, _2),
+                         PacketHandler::bind<Producer, &Producer::onPacket>(this),
+                         boost::bind(&Producer::onMasterFaceError, this, _1, _2));
+    for (size_t i = 0; i < _thread_count; ++i) {
+        _threads.emplace_back([this]() {
+            _ios.run();
+        });
+    }
+}
+
+void Producer::stop() {
+    _master_face->close();
+    _work.reset();
+    _ios.stop();
+    for (auto &thread : _threads) {
+        thread.join();
+    }
+}
+
+void Producer::onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
+    logger::log(logger::INFO, "producer face {} opened", {face->getFaceId()});
+}
+
+void Producer::onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
+    logger::log(logger::INFO, "producer face {} closed", {face->getFaceId()});
+}
+
+void Producer::onPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    if (packet.getType() != NdnPacket::INTEREST) {
+        return;
+    }
+    auto name = packets::findName(packet.getBlock());
+    face->send(packets::makeData(name.first, name.second, _payload, _freshness));
+    _served.fetch_add(1, std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/master_face.h"
+
+// answers every Interest it receives with a Data of the same Name, the faces accepted by its master face are served
+// by all of its threads
+class Producer {
+private:
+    boost::asio::io_service _ios;
+    std::unique_ptr<boost::asio::io_service::work> _work;
+    const size_t _thread_count;
+    std::vector<std::thread> _threads;
+    std::shared_ptr<MasterFace> _master_face;
+    const std::string _payload;
+    // in milliseconds, 0 for none, which keeps the Data out of the content stores
+    const uint64_t _freshness;
+    std::atomic<uint64_t> _served;
+
+public:
+    // layer is TCP or UDP, a UDP master face gets a shard per thread
+    Producer(const std::string &layer, uint16_t port, size_t threads, size_t payload_size, uint64_t freshness);
+
+    ~Producer() = default;
+
+    void start();
+
+    void stop();
+
+    uint64_t getServed() const {
+        return _served;
+    }
+
+private:
+    void onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
+
+    void onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
+
+    void onPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+};
\ No newline at end of file
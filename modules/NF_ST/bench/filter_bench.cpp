@@ -0,0 +1,79 @@
+// bulk insert, check of a filtered Name, alone and by bursts, check of a Name no rule matches and bulk removal in the Filter with each of
+// its engines, with and without the Bloom precheck, and the heap a rule takes. the packets ask for a version under
+// a filtered Name
+// usage: filter_bench [rules...]
+
+#include "filter.h"
+#include "bench/bench.h"
+
+static const char *ENGINES[] = {"tree", "hash", "static"};
+// packets of a read, as a face delivers them
+static const size_t BURST_SIZE = 32;
+
+static std::vector<ndn::Block> makeInterests(const std::vector<ndn::Name> &prefixes) {
+    std::vector<ndn::Block> interests;
+    interests.reserve(prefixes.size());
+    for (size_t i = 0; i < prefixes.size(); ++i) {
+        ndn::Name name(prefixes[i]);
+        name.append(ndn::Name::Component("v1"));
+        interests.emplace_back(bench::makeInterest(name, static_cast<uint32_t>(i)).wireEncode());
+    }
+    return interests;
+}
+
+static void run(const char *engine, bool is_prechecked, size_t count) {
+    auto names = bench::makeNames(count);
+    auto order = bench::makeOrder(count);
+    auto packets = bench::toPackets(makeInterests(names));
+    auto misses = bench::toPackets(makeInterests(bench::makeNames(count, count)));
+    std::vector<Filter::Rule> rules;
+    rules.reserve(count);
+    for (const auto &name : names) {
+        rules.emplace_back(Filter::Rule{name, true, false, 0, 0, false});
+    }
+    std::string table = std::string("Filter ") + engine + (is_prechecked ? " precheck" : "");
+
+    size_t before = bench::getHeapBytes();
+    Filter filter(engine);
+    filter.setPrechecked(is_prechecked);
+    bench::measureBatch(table.c_str(), "insert", count, count, [&]() {
+        filter.insert(rules);
+    });
+    bench::printMemory(table.c_str(), count, bench::getHeapBytes() - before);
+    size_t dropped = 0;
+    bench::measure(table.c_str(), "match", count, count, [&](size_t i) {
+        dropped += filter.check(packets[order[i]].getNameView(), 0) == Filter::DROP;
+    });
+    std::vector<const NameView*> burst;
+    std::vector<Filter::Verdict> verdicts;
+    bench::measureBatch(table.c_str(), "match burst", count, count, [&]() {
+        for (size_t i = 0; i < count; i += BURST_SIZE) {
+            burst.clear();
+            for (size_t j = i; j < std::min(i + BURST_SIZE, count); ++j) {
+                burst.push_back(&packets[order[j]].getNameView());
+            }
+            filter.check(burst, 0, verdicts);
+            dropped += std::count(verdicts.begin(), verdicts.end(), Filter::DROP);
+        }
+    });
+    bench::measure(table.c_str(), "miss", count, count, [&](size_t i) {
+        dropped += filter.check(misses[order[i]].getNameView(), 0) == Filter::DROP;
+    });
+    bench::measureBatch(table.c_str(), "remove", count, count, [&]() {
+        filter.remove(names);
+    });
+    if (dropped != 2 * count) {
+        std::printf("%s: unexpected verdicts\n", table.c_str());
+    }
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t count : bench::getSizes(argc, argv)) {
+        for (const char *engine : ENGINES) {
+            run(engine, false, count);
+            run(engine, true, count);
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -1,21 +1,360 @@
 #include "filter.h"
 
-Filter::Filter() {
-    _tree.insert("/", std::make_shared<FilterEntry>(false));
+#include <ndn-cxx/util/time.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "metrics/memory_stats.h"
+#include "tree/flow_cache.h"
+
+static const size_t LIMITED_ENTRY_SIZE = 17;
+
+static void encodeInteger(std::string &out, uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+static uint64_t decodeInteger(const uint8_t *value) {
+    uint64_t result = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        result = (result << 8) | value[i];
+    }
+    return result;
+}
+
+// a rule is stored as its flags: drop, pattern, limit and limit per face from the lowest bit, a limit is followed by
+// its rate in thousandths of packets by second and its burst
+static std::string encodeEntry(const FilterEntry &entry) {
+    const auto &limit = entry.getLimit();
+    std::string out(1, (entry.getDrop() ? 1 : 0) | (entry.isPattern() ? 2 : 0) | (limit ? 4 : 0) |
+                       (limit && limit->isPerFace() ? 8 : 0));
+    if (limit) {
+        encodeInteger(out, static_cast<uint64_t>(limit->getRate() * 1000));
+        encodeInteger(out, limit->getBurst());
+    }
+    return out;
+}
+
+static std::shared_ptr<FilterEntry> decodeEntry(const uint8_t *value, size_t length) {
+    if (length == 0 || length != ((value[0] & 4) ? LIMITED_ENTRY_SIZE : 1)) {
+        return nullptr;
+    }
+    std::shared_ptr<RuleRateLimiter> limit;
+    if (value[0] & 4) {
+        limit = std::make_shared<RuleRateLimiter>(decodeInteger(value + 1) / 1000.0, decodeInteger(value + 9), (value[0] & 8) != 0);
+    }
+    return std::make_shared<FilterEntry>((value[0] & 1) != 0, (value[0] & 2) != 0, limit);
+}
+
+// the entries are made once for both instances of the index, the rate limits they hold are shared
+static std::shared_ptr<FilterEntry> makeEntry(const Filter::Rule &rule) {
+    std::shared_ptr<RuleRateLimiter> limit;
+    if (rule.rate > 0) {
+        limit = std::make_shared<RuleRateLimiter>(rule.rate, rule.burst, rule.per_face);
+    }
+    return std::make_shared<FilterEntry>(rule.drop, rule.is_pattern, limit);
+}
+
+static std::unique_ptr<NameIndex<FilterEntry>> createIndex(const std::string &engine) {
+    auto index = NameIndex<FilterEntry>::create(engine);
+    return index ? std::move(index) : NameIndex<FilterEntry>::create("tree");
+}
+
+size_t Filter::RuleSet::size() const {
+    return _instances[0]->matcher.size() + _instances[0]->matcher.getPatternCount();
 }
 
-void Filter::insert(const ndn::Name &name, bool drop) {
-    _tree.insert(name, std::make_shared<FilterEntry>(drop), true);
+// the default policy, shared by both instances of the index so that its hits are counted once
+Filter::Filter(const std::string &engine)
+        : _engine(createIndex(engine)->getEngine())
+        , _rules([this, root = std::make_shared<FilterEntry>(false)]() {
+            std::unique_ptr<Rules> rules(new Rules());
+            rules->index = createIndex(_engine);
+            rules->index->insert("/", root, false);
+            rules->matcher.compile(*rules->index);
+            return rules;
+        }) {
+
+}
+
+std::string Filter::getEngine() const {
+    return _engine;
+}
+
+void Filter::insert(const ndn::Name &name, bool drop, bool is_pattern) {
+    insert({name, drop, is_pattern, 0, 0, false});
+}
+
+void Filter::insert(const Rule &rule) {
+    auto entry = makeEntry(rule);
+    update([&rule, &entry](NameIndex<FilterEntry> &index) {
+        index.insert(rule.name, entry, true);
+    });
+}
+
+void Filter::insert(const std::vector<Rule> &rules) {
+    NameIndex<FilterEntry>::Entries entries;
+    entries.reserve(rules.size());
+    for (const auto &rule : rules) {
+        entries.emplace_back(rule.name, makeEntry(rule));
+    }
+    update([&entries](NameIndex<FilterEntry> &index) {
+        // the bulk insert takes a copy, entries is used for both instances
+        index.insert(entries, true);
+    });
+}
+
+void Filter::remove(const std::vector<ndn::Name> &names) {
+    update([&names](NameIndex<FilterEntry> &index) {
+        for (const auto &name : names) {
+            index.remove(name);
+        }
+    });
+}
+
+std::shared_ptr<Filter::RuleSet> Filter::compile(const std::vector<Rule> &rules, bool is_prechecked) const {
+    NameIndex<FilterEntry>::Entries entries;
+    entries.reserve(rules.size());
+    for (const auto &rule : rules) {
+        entries.emplace_back(rule.name, makeEntry(rule));
+    }
+    auto root = std::make_shared<FilterEntry>(false);
+    auto rule_set = std::make_shared<RuleSet>();
+    for (auto &instance : rule_set->_instances) {
+        instance.reset(new Rules());
+        instance->index = createIndex(_engine);
+        instance->index->insert(entries, true);
+        instance->index->insert("/", root, false);
+        instance->matcher.compile(*instance->index, is_prechecked);
+    }
+    return rule_set;
+}
+
+std::shared_ptr<Filter::RuleSet> Filter::compile(const std::string &path, bool is_prechecked) const {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return nullptr;
+    }
+    std::string snapshot((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    auto wire = reinterpret_cast<const uint8_t*>(snapshot.data());
+    // the records are decoded the same for both instances, the entries of the first one are reused by the second
+    std::vector<std::shared_ptr<FilterEntry>> decoded;
+    // the default policy, in case the snapshot has none
+    auto root = std::make_shared<FilterEntry>(false);
+    auto rule_set = std::make_shared<RuleSet>();
+    for (auto &instance : rule_set->_instances) {
+        instance.reset(new Rules());
+        instance->index = createIndex(_engine);
+        size_t next = 0;
+        try {
+            instance->index->readSnapshot(wire, snapshot.size(), [&decoded, &next](const uint8_t *value, size_t length) {
+                if (next == decoded.size()) {
+                    decoded.push_back(decodeEntry(value, length));
+                }
+                return decoded[next++];
+            });
+        } catch (const ndn::tlv::Error &e) {
+            return nullptr;
+        }
+        instance->index->insert("/", root, false);
+        instance->matcher.compile(*instance->index, is_prechecked);
+    }
+    return rule_set;
+}
+
+void Filter::replace(RuleSet &rule_set) {
+    size_t next = 0;
+    _rules.write([this, &rule_set, &next](Rules &rules) {
+        std::swap(rules, *rule_set._instances[next++]);
+        // the precheck may have been set while the rule set was compiled
+        if (rules.matcher.isPrechecked() != _is_prechecked) {
+            rules.matcher.compile(*rules.index, _is_prechecked);
+        }
+    });
+}
+
+void Filter::setPrechecked(bool is_prechecked) {
+    _is_prechecked = is_prechecked;
+    update([](NameIndex<FilterEntry>&) {
+
+    });
+}
+
+bool Filter::isPrechecked() const {
+    return _is_prechecked;
+}
+
+bool Filter::isCachingLookups() const {
+    return _is_caching.load(std::memory_order_relaxed);
+}
+
+void Filter::setLookupCache(bool is_caching) {
+    _is_caching.store(is_caching, std::memory_order_relaxed);
+}
+
+FilterMatcher::Verdict Filter::match(const Rules &rules, const NameView &name, uint64_t generation) {
+    // the entry and the limit of a verdict live as long as the generation, which the read guards. the segments of a
+    // stream share the verdict of their prefix unless a rule is longer
+    thread_local FlowCache<FilterMatcher::Verdict> cache;
+    uint64_t key = FlowCache<FilterMatcher::Verdict>::getKey(name, rules.matcher.getFlowLength());
+    if (const FilterMatcher::Verdict *cached = cache.find(key, generation)) {
+        return *cached;
+    }
+    FilterMatcher::Verdict verdict = rules.matcher.match(name);
+    cache.insert(key, generation, verdict);
+    return verdict;
+}
+
+size_t Filter::getPrecheckBytes() const {
+    return _rules.read([](const Rules &rules) {
+        return rules.matcher.getPrecheckBytes();
+    });
 }
 
 void Filter::remove(const ndn::Name &name) {
-    _tree.remove(name);
+    update([&name](NameIndex<FilterEntry> &index) {
+        index.remove(name);
+    });
+}
+
+bool Filter::get(const ndn::Name &name) const {
+    return _rules.read([&name](const Rules &rules) {
+        return rules.matcher.match(name).drop;
+    });
 }
 
-bool Filter::get(const ndn::Name &name) {
-    return _tree.findLastUntil(name).second->getDrop();
+bool Filter::get(const NameView &name) const {
+    if (isCachingLookups()) {
+        return _rules.readWithGeneration([&name](const Rules &rules, uint64_t generation) {
+            return match(rules, name, generation).drop;
+        });
+    }
+    return _rules.read([&name](const Rules &rules) {
+        return rules.matcher.match(name).drop;
+    });
+}
+
+Filter::Verdict Filter::apply(const FilterMatcher::Verdict &verdict, size_t face_id, uint64_t &now) {
+    if (verdict.entry) {
+        verdict.entry->hit();
+    }
+    if (verdict.drop) {
+        return DROP;
+    }
+    if (!verdict.limit) {
+        return PASS;
+    }
+    if (now == 0) {
+        now = static_cast<uint64_t>(ndn::time::duration_cast<ndn::time::nanoseconds>(
+                ndn::time::steady_clock::now().time_since_epoch()).count());
+    }
+    bool has_token = verdict.limit->isPerFace() ? _face_buckets.consume(*verdict.limit, face_id, now)
+                                                : verdict.limit->consume(now);
+    return has_token ? PASS : OVER_LIMIT;
+}
+
+Filter::Verdict Filter::check(const NameView &name, size_t face_id) {
+    bool is_caching = isCachingLookups();
+    return _rules.readWithGeneration([this, &name, face_id, is_caching](const Rules &rules, uint64_t generation) {
+        FilterMatcher::Verdict verdict = is_caching ? match(rules, name, generation) : rules.matcher.match(name);
+        uint64_t now = 0;
+        return apply(verdict, face_id, now);
+    });
+}
+
+void Filter::check(const std::vector<const NameView*> &names, size_t face_id, std::vector<Verdict> &verdicts) {
+    // far enough for the slots to arrive while the packets in between are matched
+    static const size_t PREFETCH_DISTANCE = 4;
+
+    verdicts.clear();
+    bool is_caching = isCachingLookups();
+    _rules.readWithGeneration([this, &names, face_id, &verdicts, is_caching](const Rules &rules, uint64_t generation) {
+        for (size_t i = 0; i < std::min(PREFETCH_DISTANCE, names.size()); ++i) {
+            rules.matcher.prefetch(*names[i]);
+        }
+        uint64_t now = 0;
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (i + PREFETCH_DISTANCE < names.size()) {
+                rules.matcher.prefetch(*names[i + PREFETCH_DISTANCE]);
+            }
+            const NameView &name = *names[i];
+            FilterMatcher::Verdict verdict = is_caching ? match(rules, name, generation) : rules.matcher.match(name);
+            verdicts.push_back(apply(verdict, face_id, now));
+        }
+    });
+}
+
+std::string Filter::takeHitsJSON(size_t max_rules) const {
+    std::vector<std::pair<uint64_t, ndn::Name>> hits;
+    _rules.read([&hits](const Rules &rules) {
+        rules.index->forEachAfter(nullptr, [&hits](const ndn::Name &name, const std::shared_ptr<FilterEntry> &entry) {
+            uint64_t new_hits = entry->takeNewHits();
+            if (new_hits > 0) {
+                hits.emplace_back(new_hits, name);
+            }
+            return true;
+        });
+    });
+    size_t size = std::min(hits.size(), max_rules);
+    std::partial_sort(hits.begin(), hits.begin() + size, hits.end(), [](const std::pair<uint64_t, ndn::Name> &lhs,
+                                                                         const std::pair<uint64_t, ndn::Name> &rhs) {
+        return lhs.first > rhs.first;
+    });
+    std::stringstream ss;
+    ss << "[";
+    for (size_t i = 0; i < size; ++i) {
+        if (i > 0) {
+            ss << ", ";
+        }
+        ss << R"({"name":")" << hits[i].second.toUri() << R"(", "hits":)" << hits[i].first << "}";
+    }
+    ss << "]";
+    return ss.str();
 }
 
 std::string Filter::toJSON() const {
-    return _tree.toJSON();
+    return _rules.read([](const Rules &rules) {
+        return rules.index->toJSON();
+    });
+}
+
+void Filter::addMemoryStats(MemoryStats &stats) const {
+    MemoryStats instance;
+    size_t entries = 0;
+    size_t entry_bytes = 0;
+    _rules.read([&](const Rules &rules) {
+        rules.index->addMemoryStats(instance, "filter_index");
+        instance.add("filter_matcher", rules.matcher.size() + rules.matcher.getPatternCount(), rules.matcher.getMemoryUsage());
+        rules.index->forEachAfter(nullptr, [&](const ndn::Name&, const std::shared_ptr<FilterEntry> &entry) {
+            ++entries;
+            entry_bytes += memory_usage::ofShared<FilterEntry>() + (entry->getLimit() ? memory_usage::ofShared<RuleRateLimiter>() : 0);
+            return true;
+        });
+    });
+    stats.add(instance, 2);
+    stats.add("filter_entries", entries, entry_bytes);
+    stats.add("filter_face_buckets", _face_buckets.size(), _face_buckets.getMemoryUsage());
+}
+
+bool Filter::save(const std::string &path) const {
+    std::string snapshot;
+    _rules.read([&snapshot](const Rules &rules) {
+        rules.index->writeSnapshot(snapshot, encodeEntry);
+    });
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(snapshot.data(), snapshot.size());
+    return static_cast<bool>(file);
+}
+
+bool Filter::load(const std::string &path) {
+    auto rule_set = compile(path, _is_prechecked);
+    if (!rule_set) {
+        return false;
+    }
+    replace(*rule_set);
+    return true;
 }
\ No newline at end of file
@@ -3,27 +3,157 @@
 #include <ndn-cxx/interest.hpp>
 #include <ndn-cxx/data.hpp>
 
+#include <atomic>
 #include <memory>
 #include <list>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
-#include "tree/named_tree.h"
+#include "tree/left_right.h"
+#include "tree/name_index.h"
 #include "filter_entry.h"
+#include "filter_matcher.h"
 
+// lookups can run on any thread of the module while rules are changed, see LeftRight. the packets are matched
+// against the rules compiled after each change, the index is kept for the commands and the snapshots
 class Filter {
 private:
-    NamedTree<FilterEntry> _tree;
+    struct Rules {
+        std::unique_ptr<NameIndex<FilterEntry>> index;
+        FilterMatcher matcher;
+    };
 
 public:
-    Filter();
+    struct Rule {
+        ndn::Name name;
+        bool drop;
+        // the name is a pattern, see PatternMatcher
+        bool is_pattern;
+        // Interests or Data by second accepted beyond burst, no limit if 0, see RuleRateLimiter
+        double rate;
+        size_t burst;
+        bool per_face;
+    };
+
+    enum Verdict {
+        PASS,
+        DROP,
+        // the rule accepts the packet but its rate limit is reached
+        OVER_LIMIT
+    };
+
+    // all the rules of a filter compiled apart from it, to replace its rules at once, see compile and replace
+    class RuleSet {
+    private:
+        friend class Filter;
+
+        // one for each instance of the filter
+        std::unique_ptr<Rules> _instances[2];
+
+    public:
+        // rules and patterns, the root rule included
+        size_t size() const;
+    };
+
+private:
+    // the engine actually used
+    const std::string _engine;
+    LeftRight<Rules> _rules;
+    FaceBuckets _face_buckets;
+    // only changed by the writers
+    bool _is_prechecked = false;
+    // off by default, the matches of each thread are then cached by the prefix the rules look at, see FlowCache
+    std::atomic<bool> _is_caching{false};
+
+    // the rules of generation matched against name, or the verdict the calling thread cached for its flow
+    static FilterMatcher::Verdict match(const Rules &rules, const NameView &name, uint64_t generation);
+
+    // the rule of verdict counts a hit and its rate limit is applied, now is read once for all the packets it is
+    // given to, from 0
+    Verdict apply(const FilterMatcher::Verdict &verdict, size_t face_id, uint64_t &now);
+
+    // f(NameIndex<FilterEntry>&) applied to the rules, which are compiled again
+    template <class Function>
+    void update(const Function &f) {
+        _rules.write([this, &f](Rules &rules) {
+            f(*rules.index);
+            rules.matcher.compile(*rules.index, _is_prechecked);
+        });
+    }
+
+public:
+    // engine is "tree", "hash" or "static", see NameIndex
+    explicit Filter(const std::string &engine = "tree");
+
+    std::string getEngine() const;
 
     ~Filter() = default;
 
-    void insert(const ndn::Name &name, bool drop);
+    void insert(const ndn::Name &name, bool drop, bool is_pattern = false);
+
+    void insert(const Rule &rule);
+
+    // rules of a single command, applied at once
+    void insert(const std::vector<Rule> &rules);
+
+    // a Bloom filter of the prefix rules looked at before them, for large rule sets which most packets match none of,
+    // see FilterMatcher
+    void setPrechecked(bool is_prechecked);
 
+    bool isPrechecked() const;
+
+    size_t getPrecheckBytes() const;
+
+    bool isCachingLookups() const;
+
+    // the Names met again since the last change of the rules, or under the same prefix as deep as the longest rule,
+    // get the same verdict without being matched
+    void setLookupCache(bool is_caching);
+
+    // removes the rule of name, prefix or pattern
     void remove(const ndn::Name &name);
 
-    bool get(const ndn::Name &name);
+    // rules of a single command, removed at once
+    void remove(const std::vector<ndn::Name> &names);
+
+    // rules compiled on the calling thread for the engine of the filter, which is unchanged. the root rule accepts
+    // unless rules holds one
+    std::shared_ptr<RuleSet> compile(const std::vector<Rule> &rules, bool is_prechecked) const;
+
+    // same from a file written by save, null if it can't be read
+    std::shared_ptr<RuleSet> compile(const std::string &path, bool is_prechecked) const;
+
+    // the rules are swapped with those of rule_set in a single write, rule_set holds the former ones afterwards so
+    // that they can be freed away from the packet threads
+    void replace(RuleSet &rule_set);
+
+    bool get(const ndn::Name &name) const;
+
+    bool get(const NameView &name) const;
+
+    // same as get, the rule counts a hit and a token is taken from its rate limit, the one of face_id for a limit
+    // per face
+    Verdict check(const NameView &name, size_t face_id);
+
+    // same as check for the Names of a read burst of face_id under a single read of the rules, verdicts[i] is that of
+    // names[i]. the tables are probed for the packets a few places ahead while one is matched, so that the cache
+    // misses of the burst overlap
+    void check(const std::vector<const NameView*> &names, size_t face_id, std::vector<Verdict> &verdicts);
+
+    // [{"name", "hits"}] of the max_rules rules with the most hits since the last call, most first. to be called
+    // from a single thread
+    std::string takeHitsJSON(size_t max_rules) const;
 
     std::string toJSON() const;
+
+    // "filter_index_..." and "filter_matcher" of both instances, "filter_entries" with their rate limits, shared by
+    // the instances, and "filter_face_buckets"
+    void addMemoryStats(MemoryStats &stats) const;
+
+    // the rules as a name_snapshot file, false if it can't be written
+    bool save(const std::string &path) const;
+
+    // replaces the rules by those of a file written by save, false and unchanged if it can't be read
+    bool load(const std::string &path);
 };
\ No newline at end of file
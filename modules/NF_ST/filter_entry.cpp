@@ -1,6 +1,9 @@
 #include "filter_entry.h"
 
-FilterEntry::FilterEntry(bool drop) : _drop(drop) {
+FilterEntry::FilterEntry(bool drop, bool pattern, std::shared_ptr<RuleRateLimiter> limit)
+        : _drop(drop)
+        , _pattern(pattern)
+        , _limit(std::move(limit)) {
 
 }
 
@@ -8,8 +11,36 @@ bool FilterEntry::getDrop() const {
     return _drop;
 }
 
+bool FilterEntry::isPattern() const {
+    return _pattern;
+}
+
+const std::shared_ptr<RuleRateLimiter>& FilterEntry::getLimit() const {
+    return _limit;
+}
+
+void FilterEntry::hit() const {
+    _hits.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t FilterEntry::getHits() const {
+    return _hits.load(std::memory_order_relaxed);
+}
+
+uint64_t FilterEntry::takeNewHits() const {
+    uint64_t hits = getHits();
+    uint64_t new_hits = hits - _reported_hits;
+    _reported_hits = hits;
+    return new_hits;
+}
+
 std::string FilterEntry::toJSON() const {
     std::stringstream ss;
-    ss << R"({"drop": )" << (_drop ? "true" : "false") << R"(})";
+    ss << R"({"drop": )" << (_drop ? "true" : "false") << R"(, "pattern": )" << (_pattern ? "true" : "false")
+       << R"(, "hits": )" << getHits();
+    if (_limit) {
+        ss << R"(, "limit": )" << _limit->toJSON();
+    }
+    ss << "}";
     return ss.str();
 }
\ No newline at end of file
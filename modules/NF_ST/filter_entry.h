@@ -2,18 +2,40 @@
 
 #include <ndn-cxx/data.hpp>
 
+#include <atomic>
 #include <memory>
 
+#include "rule_rate_limiter.h"
+
 class FilterEntry {
 private:
     bool _drop;
+    // the Name is a pattern, see PatternMatcher
+    bool _pattern;
+    // shared by the instances of the index, see Filter
+    std::shared_ptr<RuleRateLimiter> _limit;
+    // packets which matched the rule, counted from any thread
+    mutable std::atomic<uint64_t> _hits{0};
+    // hits at the last report, only read and set by the control strand
+    mutable uint64_t _reported_hits = 0;
 
 public:
-    explicit FilterEntry(bool drop);
+    explicit FilterEntry(bool drop, bool pattern = false, std::shared_ptr<RuleRateLimiter> limit = nullptr);
 
     ~FilterEntry() = default;
 
     bool getDrop() const;
 
+    bool isPattern() const;
+
+    const std::shared_ptr<RuleRateLimiter>& getLimit() const;
+
+    void hit() const;
+
+    uint64_t getHits() const;
+
+    // hits since the last call
+    uint64_t takeNewHits() const;
+
     std::string toJSON() const;
 };
\ No newline at end of file
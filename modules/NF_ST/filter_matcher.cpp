@@ -0,0 +1,204 @@
+#include "filter_matcher.h"
+
+#include <algorithm>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+
+static NameComponentRef componentAt(const ndn::Name &name, size_t i) {
+    return name_hash::toRef(name.get(i));
+}
+
+static NameComponentRef componentAt(const NameView &name, size_t i) {
+    return name[i];
+}
+
+template <class NameType>
+bool FilterMatcher::matches(uint32_t rule, const NameType &name, size_t length) const {
+    const ndn::Name &rule_name = _names[rule];
+    for (size_t i = 0; i < length; ++i) {
+        if (NameComponentRef::compare(rule_name.get(i), componentAt(name, i)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class NameType>
+const FilterMatcher::Slot* FilterMatcher::lookup(const NameType &name, size_t length, uint64_t hash) const {
+    const Table &table = _tables[length];
+    size_t mask = table.slots.size() - 1;
+    // linear probing, the table is at most half full
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot &slot = table.slots[i];
+        if (slot.rule == EMPTY) {
+            return nullptr;
+        }
+        if (slot.hash == hash && matches(slot.rule, name, length)) {
+            return &slot;
+        }
+    }
+}
+
+bool FilterMatcher::isCandidate(size_t length, uint64_t hash) const {
+    return length == 0 || !_is_prechecked || _precheck.mayContain(hash);
+}
+
+void FilterMatcher::compile(const NameIndex<FilterEntry> &index, bool is_prechecked) {
+    _names.clear();
+    _tables.clear();
+    _lengths.clear();
+    _drop_patterns.clear();
+    _accept_patterns.clear();
+    _patterns.clear();
+    std::vector<Verdict> verdicts;
+    index.forEachAfter(nullptr, [this, &verdicts](const ndn::Name &name, const std::shared_ptr<FilterEntry> &entry) {
+        if (entry->isPattern()) {
+            (entry->getDrop() ? _drop_patterns : _accept_patterns).add(name, _patterns.size());
+            _patterns.push_back(entry.get());
+            return true;
+        }
+        _names.emplace_back(name);
+        verdicts.push_back({entry->getDrop(), entry->getLimit().get(), entry.get()});
+        if (name.size() >= _tables.size()) {
+            _tables.resize(name.size() + 1);
+        }
+        ++_tables[name.size()].size;
+        return true;
+    });
+    for (size_t length = _tables.size(); length-- > 0;) {
+        Table &table = _tables[length];
+        if (table.size == 0) {
+            continue;
+        }
+        size_t capacity = 2;
+        while (capacity < 2 * table.size) {
+            capacity <<= 1;
+        }
+        table.slots.assign(capacity, Slot{0, EMPTY, {false, nullptr, nullptr}});
+        _lengths.emplace_back(length);
+    }
+    _is_prechecked = is_prechecked;
+    if (_is_prechecked) {
+        _precheck.reset(_names.size());
+    } else {
+        _precheck.clear();
+    }
+    for (uint32_t rule = 0; rule < _names.size(); ++rule) {
+        const ndn::Name &name = _names[rule];
+        Table &table = _tables[name.size()];
+        uint64_t hash = name_hash::hash(name);
+        size_t mask = table.slots.size() - 1;
+        size_t i = hash & mask;
+        while (table.slots[i].rule != EMPTY) {
+            i = (i + 1) & mask;
+        }
+        table.slots[i] = Slot{hash, rule, verdicts[rule]};
+        if (_is_prechecked) {
+            _precheck.insert(hash);
+        }
+    }
+}
+
+size_t FilterMatcher::size() const {
+    return _names.size();
+}
+
+bool FilterMatcher::isPrechecked() const {
+    return _is_prechecked;
+}
+
+size_t FilterMatcher::getPrecheckBytes() const {
+    return _precheck.getBytes();
+}
+
+size_t FilterMatcher::getPatternCount() const {
+    return _drop_patterns.size() + _accept_patterns.size();
+}
+
+size_t FilterMatcher::getFlowLength() const {
+    if (getPatternCount() > 0) {
+        return SIZE_MAX;
+    }
+    return _lengths.empty() ? 0 : _lengths.front();
+}
+
+size_t FilterMatcher::getMemoryUsage() const {
+    size_t bytes = memory_usage::of(_names) + memory_usage::of(_tables) + memory_usage::of(_lengths) + memory_usage::of(_patterns)
+                   + _drop_patterns.getMemoryUsage() + _accept_patterns.getMemoryUsage() + _precheck.getBytes();
+    for (const auto &name : _names) {
+        bytes += memory_usage::of(name);
+    }
+    for (const auto &table : _tables) {
+        bytes += memory_usage::of(table.slots);
+    }
+    return bytes;
+}
+
+template <class NameType>
+FilterMatcher::Verdict FilterMatcher::matchImpl(const NameType &name) const {
+    size_t pattern = _drop_patterns.match(name);
+    if (pattern != PatternMatcher::NONE) {
+        return {true, nullptr, _patterns[pattern]};
+    }
+    pattern = _accept_patterns.match(name);
+    if (pattern != PatternMatcher::NONE) {
+        return {false, nullptr, _patterns[pattern]};
+    }
+    return matchPrefixes(name);
+}
+
+FilterMatcher::Verdict FilterMatcher::matchPrefixes(const ndn::Name &name) const {
+    // the prefix hashes are computed once, from the shortest
+    std::vector<uint64_t> hashes(1, name_hash::SEED);
+    size_t max_length = _lengths.empty() ? 0 : std::min(_lengths.front(), name.size());
+    for (size_t i = 0; i < max_length; ++i) {
+        hashes.emplace_back(name_hash::extend(hashes.back(), componentAt(name, i)));
+    }
+    for (size_t length : _lengths) {
+        if (length <= max_length && isCandidate(length, hashes[length])) {
+            if (const Slot *slot = lookup(name, length, hashes[length])) {
+                return slot->verdict;
+            }
+        }
+    }
+    return {false, nullptr, nullptr};
+}
+
+FilterMatcher::Verdict FilterMatcher::matchPrefixes(const NameView &name) const {
+    for (size_t length : _lengths) {
+        if (length > name.size()) {
+            continue;
+        }
+        uint64_t hash = name.getPrefixHash(length);
+        if (isCandidate(length, hash)) {
+            if (const Slot *slot = lookup(name, length, hash)) {
+                return slot->verdict;
+            }
+        }
+    }
+    return {false, nullptr, nullptr};
+}
+
+FilterMatcher::Verdict FilterMatcher::match(const ndn::Name &name) const {
+    return matchImpl(name);
+}
+
+FilterMatcher::Verdict FilterMatcher::match(const NameView &name) const {
+    return matchImpl(name);
+}
+
+void FilterMatcher::prefetch(const NameView &name) const {
+    for (size_t length : _lengths) {
+        if (length > name.size()) {
+            continue;
+        }
+        uint64_t hash = name.getPrefixHash(length);
+        if (length > 0 && _is_prechecked) {
+            _precheck.prefetch(hash);
+        } else {
+            const Table &table = _tables[length];
+            __builtin_prefetch(&table.slots[hash & (table.slots.size() - 1)]);
+        }
+    }
+}
\ No newline at end of file
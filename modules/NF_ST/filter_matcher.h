@@ -0,0 +1,107 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "network/name_view.h"
+#include "tree/blocked_bloom_filter.h"
+#include "tree/name_index.h"
+#include "filter_entry.h"
+#include "pattern_matcher.h"
+
+// the rules compiled for the packet path: a table per prefix length holding the name_hash of each rule and its
+// verdict inline, so that a match probes only the lengths which have rules, longest first, and reads a slot or two
+// by length plus the components of the rule found. the pattern rules come first: a Name matching a drop pattern is
+// dropped, else one matching an accept pattern is accepted, else the prefix rules apply. all is built again from the
+// rules on every change
+class FilterMatcher {
+public:
+    struct Verdict {
+        bool drop;
+        // the rate limit of the rule, owned by its entry in the index, null if there is none
+        RuleRateLimiter *limit;
+        // the rule, null if none applies
+        const FilterEntry *entry;
+    };
+
+private:
+    static const uint32_t EMPTY = UINT32_MAX;
+
+    struct Slot {
+        uint64_t hash;
+        uint32_t rule;
+        Verdict verdict;
+    };
+
+    struct Table {
+        std::vector<Slot> slots;
+        size_t size = 0;
+    };
+
+    // the names of the rules, compared on a hash match only
+    std::vector<ndn::Name> _names;
+    // by prefix length, index 0 holds the root
+    std::vector<Table> _tables;
+    // the lengths which have rules, longest first
+    std::vector<size_t> _lengths;
+    PatternMatcher _drop_patterns;
+    PatternMatcher _accept_patterns;
+    // by pattern id
+    std::vector<const FilterEntry*> _patterns;
+    // the hashes of the prefix rules but the root, looked at before the tables when the rules are set to be
+    // prechecked: a Name under none of them reads a cache line by length instead of a slot and a rule
+    bool _is_prechecked = false;
+    BlockedBloomFilter _precheck;
+
+    bool isCandidate(size_t length, uint64_t hash) const;
+
+    // verdict of the longest prefix rule of name
+    Verdict matchPrefixes(const ndn::Name &name) const;
+
+    Verdict matchPrefixes(const NameView &name) const;
+
+    template <class NameType>
+    Verdict matchImpl(const NameType &name) const;
+
+    template <class NameType>
+    bool matches(uint32_t rule, const NameType &name, size_t length) const;
+
+    template <class NameType>
+    const Slot* lookup(const NameType &name, size_t length, uint64_t hash) const;
+
+public:
+    FilterMatcher() = default;
+
+    ~FilterMatcher() = default;
+
+    // replaces the compiled rules by those of index, with a precheck if is_prechecked is set
+    void compile(const NameIndex<FilterEntry> &index, bool is_prechecked = false);
+
+    bool isPrechecked() const;
+
+    // bytes of the precheck, 0 if there is none
+    size_t getPrecheckBytes() const;
+
+    // prefix rules
+    size_t size() const;
+
+    size_t getPatternCount() const;
+
+    // the components past which no verdict depends on a Name: those of the longest prefix rule, all of them while
+    // there are patterns
+    size_t getFlowLength() const;
+
+    // of the names, the tables, the patterns and the precheck
+    size_t getMemoryUsage() const;
+
+    // verdict of the rules for name, accept without limit if none applies. the patterns have no rate limit
+    Verdict match(const ndn::Name &name) const;
+
+    Verdict match(const NameView &name) const;
+
+    // the slot each length which has rules would probe first for name, or the precheck block in its place, is brought
+    // into the cache for a match of name a bit later, e.g. once those of the next packets of a burst were as well
+    void prefetch(const NameView &name) const;
+};
\ No newline at end of file
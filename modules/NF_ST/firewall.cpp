@@ -2,145 +2,261 @@
 
 #include <boost/bind.hpp>
 
+#include <algorithm>
+
 #include "network/tcp_master_face.h"
 #include "network/tcp_face.h"
 #include "network/udp_master_face.h"
 #include "network/udp_face.h"
+#include "network/shm_master_face.h"
+#include "network/shm_face.h"
+#include "network/memory_master_face.h"
+#include "network/memory_face.h"
 #include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+#include "log/probes.h"
+#include "metrics/stage_profile.h"
 
-Firewall::Firewall(const std::string &name, uint16_t local_port, uint16_t local_command_port)
-        : Module(1)
+Firewall::Firewall(const std::string &name, uint16_t local_port, uint16_t local_command_port, size_t udp_shards, const std::string &filter_engine,
+                   size_t concurrency, Runtime runtime)
+        : Module(concurrency, runtime)
         , _name(name)
-        , _command_socket(_ios, {{}, local_command_port})
-        , _report_timer(_ios)
-        , _delay_between_report(0) {
-    _tcp_ingress_master_face = std::make_shared<TcpMasterFace>(_ios, 16, local_port);
-    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, 16, local_port);
+        , _filter(filter_engine)
+        , _command_socket(_control_ios, {{}, local_command_port})
+        , _connection_pool(_ios)
+        , _control_strand(_control_ios)
+        , _report_timer(_control_ios)
+        , _delay_between_report(0)
+        , _alarm_timer(_control_ios)
+        , _egress_faces([]() { return std::unique_ptr<std::vector<std::shared_ptr<Face>>>(new std::vector<std::shared_ptr<Face>>()); })
+        , _compile_ios_work(new boost::asio::io_service::work(_compile_ios))
+        , _compile_thread([this]() { _compile_ios.run(); }) {
+    // in PINNED the TCP and memory faces and those of add_face are spread over the cores, UDP and SHM stay on _ios
+    auto tcp_master_face = std::make_shared<TcpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    tcp_master_face->setServicePicker([this]() -> boost::asio::io_service& {
+        return nextCoreService();
+    });
+    _tcp_ingress_master_face = tcp_master_face;
+    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port, udp_shards);
+    _shm_ingress_master_face = std::make_shared<ShmMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    auto mem_master_face = std::make_shared<MemoryMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    mem_master_face->setServicePicker([this]() -> boost::asio::io_service& {
+        return nextCoreService();
+    });
+    _mem_ingress_master_face = mem_master_face;
+    _metrics.addCollector(boost::bind(&Firewall::writeMetrics, this, _1));
+}
+
+Firewall::~Firewall() {
+    // a rule set being compiled is given up
+    _compile_ios_work.reset();
+    _compile_ios.stop();
+    _compile_thread.join();
 }
 
 void Firewall::run() {
-    commandRead();
-    _tcp_ingress_master_face->listen(boost::bind(&Firewall::onMasterFaceNotification, this, _1, _2),
-                                     boost::bind(&Firewall::onIngressInterest, this, _1, _2),
-                                     boost::bind(&Firewall::onIngressData, this, _1, _2),
-                                     boost::bind(&Firewall::onMasterFaceError, this, _1, _2));
-    _udp_ingress_master_face->listen(boost::bind(&Firewall::onMasterFaceNotification, this, _1, _2),
-                                     boost::bind(&Firewall::onIngressInterest, this, _1, _2),
-                                     boost::bind(&Firewall::onIngressData, this, _1, _2),
-                                     boost::bind(&Firewall::onMasterFaceError, this, _1, _2));
-}
-
-void Firewall::onIngressInterest(const std::shared_ptr<Face> &ingress_face, const ndn::Interest &interest) {
-    if (_drop_interest && _filter.get(interest.getName())) {
-        ++_interest_drop_counter;
-    } else {
-        for (auto& egress_face : _egress_faces) {
-            egress_face->send(interest);
+    // before the ingress accepts any face, nothing runs on _control_strand yet
+    _startup_config.apply(_ios, _remote_command_endpoint, [this](const rapidjson::Document &command) {
+        executeCommand(command);
+    });
+    _control_strand.post(boost::bind(&Firewall::commandRead, this));
+    _tcp_ingress_master_face->listen(_control_strand.wrap(boost::bind(&Firewall::onMasterFaceNotification, this, _1, _2)),
+                                     Face::BurstCallback(boost::bind(&Firewall::onIngressBurst, this, _1, _2)),
+                                     _control_strand.wrap(boost::bind(&Firewall::onMasterFaceError, this, _1, _2)));
+    _udp_ingress_master_face->listen(_control_strand.wrap(boost::bind(&Firewall::onMasterFaceNotification, this, _1, _2)),
+                                     Face::BurstCallback(boost::bind(&Firewall::onIngressBurst, this, _1, _2)),
+                                     _control_strand.wrap(boost::bind(&Firewall::onMasterFaceError, this, _1, _2)));
+    _shm_ingress_master_face->listen(_control_strand.wrap(boost::bind(&Firewall::onMasterFaceNotification, this, _1, _2)),
+                                     Face::BurstCallback(boost::bind(&Firewall::onIngressBurst, this, _1, _2)),
+                                     _control_strand.wrap(boost::bind(&Firewall::onMasterFaceError, this, _1, _2)));
+    _mem_ingress_master_face->listen(_control_strand.wrap(boost::bind(&Firewall::onMasterFaceNotification, this, _1, _2)),
+                                     Face::BurstCallback(boost::bind(&Firewall::onIngressBurst, this, _1, _2)),
+                                     _control_strand.wrap(boost::bind(&Firewall::onMasterFaceError, this, _1, _2)));
+}
+
+bool Firewall::loadStartupConfig(const std::string &source) {
+    return _startup_config.load(source);
+}
+
+void Firewall::beginDrain() {
+    for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face, _shm_ingress_master_face, _mem_ingress_master_face}) {
+        master_face->stopAccepting();
+    }
+}
+
+bool Firewall::isDrained() {
+    return getQueuedPackets() == 0;
+}
+
+size_t Firewall::getQueuedPackets() {
+    size_t queued = 0;
+    for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face, _shm_ingress_master_face, _mem_ingress_master_face}) {
+        queued += master_face->getQueuedPackets();
+    }
+    _egress_faces.read([&queued](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+        for (const auto &egress_face : egress_faces) {
+            queued += egress_face->getQueueStats().packets;
         }
+    });
+    return queued;
+}
+
+size_t Firewall::getDrops() const {
+    return _interest_drop_counter + _data_drop_counter + _over_limit_counter;
+}
+
+bool Firewall::saveRules(const std::string &path) const {
+    return _filter.save(path);
+}
+
+bool Firewall::loadRules(const std::string &path) {
+    return _filter.load(path);
+}
+
+void Firewall::onIngressPacket(const std::shared_ptr<Face> &ingress_face, const NdnPacket &packet) {
+    if (pass(ingress_face, packet)) {
+        _egress_faces.read([&packet](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+            for (auto& egress_face : egress_faces) {
+                egress_face->send(packet);
+            }
+        });
     }
 }
 
-void Firewall::onIngressData(const std::shared_ptr<Face> &ingress_face, const ndn::Data &data) {
-    if (_drop_data && _filter.get(data.getName())) {
-        ++_data_drop_counter;
-    } else {
-        for (auto& egress_face : _egress_faces) {
-            egress_face->send(data);
+void Firewall::onIngressBurst(const std::shared_ptr<Face> &ingress_face, const std::vector<NdnPacket> &packets) {
+    // reused by the bursts of each face thread
+    thread_local std::vector<const NameView*> names;
+    thread_local std::vector<size_t> filtered;
+    thread_local std::vector<Filter::Verdict> verdicts;
+    names.clear();
+    filtered.clear();
+    for (size_t i = 0; i < packets.size(); ++i) {
+        if (isFiltered(packets[i])) {
+            names.push_back(&packets[i].getNameView());
+            filtered.push_back(i);
+        }
+    }
+    if (!names.empty()) {
+        stage_profile::Scope stage(stage_profile::TABLE);
+        _filter.check(names, ingress_face->getFaceId(), verdicts);
+    }
+    size_t next = 0;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        const NdnPacket &packet = packets[i];
+        bool is_passing;
+        if (next < filtered.size() && filtered[next] == i) {
+            is_passing = pass(ingress_face, packet, verdicts[next++]);
+        } else {
+            is_passing = packet.getType() != NdnPacket::UNKNOWN;
+        }
+        if (is_passing) {
+            _egress_faces.read([&packet](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+                for (auto& egress_face : egress_faces) {
+                    egress_face->send(packet);
+                }
+            });
         }
     }
 }
 
-void Firewall::onEgressInterest(const std::shared_ptr<Face> &egress_face, const ndn::Interest &interest) {
-    if (_drop_interest && _filter.get(interest.getName())) {
-        ++_interest_drop_counter;
-    } else {
-        _tcp_ingress_master_face->sendToAllFaces(interest);
-        _udp_ingress_master_face->sendToAllFaces(interest);
+void Firewall::onEgressPacket(const std::shared_ptr<Face> &egress_face, const NdnPacket &packet) {
+    if (pass(egress_face, packet)) {
+        _tcp_ingress_master_face->sendToAllFaces(packet);
+        _udp_ingress_master_face->sendToAllFaces(packet);
+        _shm_ingress_master_face->sendToAllFaces(packet);
+        _mem_ingress_master_face->sendToAllFaces(packet);
     }
 }
 
-void Firewall::onEgressData(const std::shared_ptr<Face> &egress_face, const ndn::Data &data) {
-    if (_drop_data && _filter.get(data.getName())) {
-        ++_data_drop_counter;
-    } else {
-        _tcp_ingress_master_face->sendToAllFaces(data);
-        _udp_ingress_master_face->sendToAllFaces(data);
+bool Firewall::pass(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    if (!isFiltered(packet)) {
+        return packet.getType() != NdnPacket::UNKNOWN;
+    }
+    Filter::Verdict verdict;
+    {
+        stage_profile::Scope stage(stage_profile::TABLE);
+        verdict = _filter.check(packet.getNameView(), face->getFaceId());
     }
+    return pass(face, packet, verdict);
+}
+
+bool Firewall::isFiltered(const NdnPacket &packet) const {
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST:
+            return _drop_interest;
+        case NdnPacket::DATA:
+            return _drop_data;
+        default:
+            return false;
+    }
+}
+
+bool Firewall::pass(const std::shared_ptr<Face> &face, const NdnPacket &packet, Filter::Verdict verdict) {
+    bool is_interest = packet.getType() == NdnPacket::INTEREST;
+    NDNMS_PROBE3(nf_verdict, packet.getNameView().getHash(), face->getFaceId(), verdict);
+    if (verdict == Filter::PASS) {
+        return true;
+    }
+    // the packets over the limit are counted as dropped too
+    if (verdict == Filter::OVER_LIMIT) {
+        ++_over_limit_counter;
+    }
+    ++(is_interest ? _interest_drop_counter : _data_drop_counter);
+    logDrop(face, packet, verdict == Filter::OVER_LIMIT);
+    return false;
+}
+
+void Firewall::logDrop(const std::shared_ptr<Face> &face, const NdnPacket &packet, bool is_over_limit) {
+    size_t sampling = _drop_log_sampling;
+    if (sampling == 0 || _drop_log_counter.fetch_add(1, std::memory_order_relaxed) % sampling != 0) {
+        return;
+    }
+    size_t face_id = face->getFaceId();
+    _drop_logger.log(logger::INFO, [packet, face_id, is_over_limit]() {
+        std::stringstream ss;
+        ss << (packet.getType() == NdnPacket::INTEREST ? "Interest " : "Data ") << packet.getNameView().toName()
+           << " from face " << face_id << (is_over_limit ? " over the rate limit" : " dropped");
+        return ss.str();
+    });
 }
 
 void Firewall::onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "new " << " face with ID = " << face->getFaceId() << " form master face with ID = " << master_face->getMasterFaceId();
-    logger::log(logger::INFO, ss.str());
+    logger::log(logger::INFO, "new face with ID = {} form master face with ID = {}",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void Firewall::onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << " face with ID = " << face->getFaceId() << " from master face with ID = " << master_face->getMasterFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    logger::log(logger::ERROR, " face with ID = {} from master face with ID = {} can't process normally",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void Firewall::onFaceError(const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << " face with ID = " << face->getFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
-    for (auto& egress_face : _egress_faces) {
-        if(egress_face == face) {
-            std::swap(egress_face, _egress_faces.back());
-            _egress_faces.pop_back();
-            break;
+    logger::log(logger::ERROR, " face with ID = {} can't process normally", {face->getFaceId()});
+    _egress_faces.write([&face](std::vector<std::shared_ptr<Face>> &egress_faces) {
+        for (auto& egress_face : egress_faces) {
+            if(egress_face == face) {
+                std::swap(egress_face, egress_faces.back());
+                egress_faces.pop_back();
+                break;
+            }
         }
-    }
+    });
 }
 
 void Firewall::commandRead() {
     _command_socket.async_receive_from(boost::asio::buffer(_command_buffer, 65536), _remote_command_endpoint,
-                                       boost::bind(&Firewall::commandReadHandler, this, _1, _2));
+                                       _control_strand.wrap(boost::bind(&Firewall::commandReadHandler, this, _1, _2)));
 }
 
 void Firewall::commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred) {
-    enum action_type {
-        EDIT_CONFIG,
-        ADD_FACE,
-        DEL_FACE,
-        ADD_RULES,
-        DEL_RULES,
-    };
-
-    static const std::map<std::string, action_type> ACTIONS = {
-            {"edit_config", EDIT_CONFIG},
-            {"add_face", ADD_FACE},
-            {"del_face", DEL_FACE},
-            {"add_rules", ADD_RULES},
-            {"del_rules", DEL_RULES},
-    };
-
     if(!err) {
         try {
             rapidjson::Document document;
             document.Parse(_command_buffer, bytes_transferred);
             if(!document.HasParseError()){
                 if(document.HasMember("action") && document["action"].IsString() && document.HasMember("id") && document["id"].IsUint()){
-                    auto it = ACTIONS.find(document["action"].GetString());
-                    if(it != ACTIONS.end()) {
-                        switch (it->second) {
-                            case EDIT_CONFIG:
-                                commandEditConfig(document);
-                                break;
-                            case ADD_FACE:
-                                commandAddFace(document);
-                                break;
-                            case DEL_FACE:
-                                commandDelFace(document);
-                                break;
-                            case ADD_RULES:
-                                commandAddRules(document);
-                                break;
-                            case DEL_RULES:
-                                commandDelRules(document);
-                                break;
-                        }
-                    }
+                    executeCommand(document);
                 } else{
                     //std::string response = R"({"status":"fail", "reason":"action not provided or not implemented"})";
                     //_command_socket.send_to(boost::asio::buffer(response), _remote_command_endpoint);
@@ -159,6 +275,71 @@ void Firewall::commandReadHandler(const boost::system::error_code &err, size_t b
     }
 }
 
+void Firewall::executeCommand(const rapidjson::Document &document) {
+    enum action_type {
+        EDIT_CONFIG,
+        ADD_FACE,
+        DEL_FACE,
+        ADD_RULES,
+        DEL_RULES,
+        BEGIN_RULES,
+        COMMIT_RULES,
+        LOAD_RULES,
+        LIST,
+        MEMORY_STATS,
+    };
+
+    static const std::map<std::string, action_type> ACTIONS = {
+            {"edit_config", EDIT_CONFIG},
+            {"add_face", ADD_FACE},
+            {"del_face", DEL_FACE},
+            {"add_rules", ADD_RULES},
+            {"del_rules", DEL_RULES},
+            {"begin_rules", BEGIN_RULES},
+            {"commit_rules", COMMIT_RULES},
+            {"load_rules", LOAD_RULES},
+            {"list", LIST},
+            {"memory_stats", MEMORY_STATS},
+    };
+
+    auto it = ACTIONS.find(document["action"].GetString());
+    if (it == ACTIONS.end()) {
+        return;
+    }
+    switch (it->second) {
+        case EDIT_CONFIG:
+            commandEditConfig(document);
+            break;
+        case ADD_FACE:
+            commandAddFace(document);
+            break;
+        case DEL_FACE:
+            commandDelFace(document);
+            break;
+        case ADD_RULES:
+            commandAddRules(document);
+            break;
+        case DEL_RULES:
+            commandDelRules(document);
+            break;
+        case BEGIN_RULES:
+            commandBeginRules(document);
+            break;
+        case COMMIT_RULES:
+            commandCommitRules(document);
+            break;
+        case LOAD_RULES:
+            commandLoadRules(document);
+            break;
+        case LIST:
+            commandList(document);
+            break;
+        case MEMORY_STATS:
+            commandMemoryStats(document);
+            break;
+    }
+}
+
 void Firewall::commandEditConfig(const rapidjson::Document &document) {
     std::vector<std::string> changes;
     if (document.HasMember("drop_interest") && document["drop_interest"].IsBool()) {
@@ -208,7 +389,7 @@ void Firewall::commandEditConfig(const rapidjson::Document &document) {
             if (!_report_enable) {
                 _report_enable = true;
                 _report_timer.expires_from_now(_delay_between_report);
-                _report_timer.async_wait(boost::bind(&Firewall::commandReport, this, _1));
+                _report_timer.async_wait(_control_strand.wrap(boost::bind(&Firewall::commandReport, this, _1)));
             }
         } else {
             _report_enable = false;
@@ -217,6 +398,266 @@ void Firewall::commandEditConfig(const rapidjson::Document &document) {
             changes.emplace_back("report_each");
         }
     }
+    if (document.HasMember("report_delta") && document["report_delta"].IsBool()) {
+        bool report_delta = document["report_delta"].GetBool();
+        if (report_delta != _report_delta) {
+            _report_delta = report_delta;
+            changes.emplace_back("report_delta");
+        }
+    }
+    // in packets per second, 0 disables it. it clears at half of it
+    if (document.HasMember("drop_rate_alarm") && document["drop_rate_alarm"].IsUint()) {
+        size_t trigger = document["drop_rate_alarm"].GetUint();
+        if (trigger != (_drop_rate_alarm.isEnabled() ? _drop_rate_alarm.getTrigger() : 0)) {
+            if (trigger > 0) {
+                _drop_rate_alarm.set(trigger, trigger / 2.0);
+            } else {
+                _drop_rate_alarm.disable();
+            }
+            changes.emplace_back("drop_rate_alarm");
+        }
+    }
+    // in packets queued on the faces, 0 disables it. it clears at half of it
+    if (document.HasMember("queue_alarm") && document["queue_alarm"].IsUint()) {
+        size_t trigger = document["queue_alarm"].GetUint();
+        if (trigger != (_queue_alarm.isEnabled() ? _queue_alarm.getTrigger() : 0)) {
+            if (trigger > 0) {
+                _queue_alarm.set(trigger, trigger / 2.0);
+            } else {
+                _queue_alarm.disable();
+            }
+            changes.emplace_back("queue_alarm");
+        }
+    }
+    armAlarms();
+    if (document.HasMember("tcp_gather_bytes") && document["tcp_gather_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["tcp_gather_bytes"].GetUint();
+        if (max_bytes != TcpFace::getGatherMaxBytes()) {
+            TcpFace::setGatherMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_bytes");
+        }
+    }
+    if (document.HasMember("tcp_gather_packets") && document["tcp_gather_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["tcp_gather_packets"].GetUint();
+        if (max_packets != TcpFace::getGatherMaxPackets()) {
+            TcpFace::setGatherMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_packets");
+        }
+    }
+    if (document.HasMember("tcp_max_packet_size") && document["tcp_max_packet_size"].IsUint()) {
+        bool has_change = false;
+        size_t size = document["tcp_max_packet_size"].GetUint();
+        if (size != TcpFace::getMaxPacketSize()) {
+            has_change = TcpFace::setMaxPacketSize(size);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_max_packet_size");
+        }
+    }
+    if (document.HasMember("tcp_flush") && document["tcp_flush"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_flush"].GetString();
+        if (policy != TcpFace::getFlushPolicy()) {
+            has_change = TcpFace::setFlushPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_flush");
+        }
+    }
+
+    if (document.HasMember("filter_precheck") && document["filter_precheck"].IsBool()) {
+        bool has_change = false;
+        bool filter_precheck = document["filter_precheck"].GetBool();
+        if (filter_precheck != _filter.isPrechecked()) {
+            _filter.setPrechecked(filter_precheck);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("filter_precheck");
+        }
+    }
+
+    if (document.HasMember("filter_lookup_cache") && document["filter_lookup_cache"].IsBool()) {
+        bool has_change = false;
+        bool is_caching = document["filter_lookup_cache"].GetBool();
+        if (is_caching != _filter.isCachingLookups()) {
+            _filter.setLookupCache(is_caching);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("filter_lookup_cache");
+        }
+    }
+
+    if (document.HasMember("drop_log_sampling") && document["drop_log_sampling"].IsUint()) {
+        bool has_change = false;
+        size_t drop_log_sampling = document["drop_log_sampling"].GetUint();
+        if (drop_log_sampling != _drop_log_sampling) {
+            _drop_log_sampling = drop_log_sampling;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("drop_log_sampling");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_min_delay") && document["tcp_reconnect_min_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_min_delay"].GetUint();
+        if (value != TcpFace::getReconnectMinDelay()) {
+            TcpFace::setReconnectMinDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_min_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_max_delay") && document["tcp_reconnect_max_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_max_delay"].GetUint();
+        if (value != TcpFace::getReconnectMaxDelay()) {
+            TcpFace::setReconnectMaxDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_max_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_attempts") && document["tcp_reconnect_attempts"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_attempts"].GetUint();
+        if (value != TcpFace::getReconnectAttempts()) {
+            TcpFace::setReconnectAttempts(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_attempts");
+        }
+    }
+    if (document.HasMember("tcp_replay_max_age") && document["tcp_replay_max_age"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_replay_max_age"].GetUint();
+        if (value != TcpFace::getReplayMaxAge()) {
+            TcpFace::setReplayMaxAge(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_replay_max_age");
+        }
+    }
+    if (document.HasMember("tcp_credit_window") && document["tcp_credit_window"].IsUint()) {
+        bool has_change = false;
+        size_t window = document["tcp_credit_window"].GetUint();
+        if (window != TcpFace::getCreditWindow()) {
+            TcpFace::setCreditWindow(window);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_window");
+        }
+    }
+    if (document.HasMember("tcp_credit_policy") && document["tcp_credit_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_credit_policy"].GetString();
+        if (policy != TcpFace::getCreditPolicy()) {
+            has_change = TcpFace::setCreditPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_policy");
+        }
+    }
+    if (document.HasMember("udp_mtu") && document["udp_mtu"].IsUint()) {
+        bool has_change = false;
+        size_t mtu = document["udp_mtu"].GetUint();
+        if (mtu != LpLink::getMtu()) {
+            LpLink::setMtu(mtu);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_mtu");
+        }
+    }
+    if (document.HasMember("udp_aggregation") && document["udp_aggregation"].IsBool()) {
+        bool has_change = false;
+        bool aggregation = document["udp_aggregation"].GetBool();
+        if (aggregation != LpLink::getAggregation()) {
+            LpLink::setAggregation(aggregation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_aggregation");
+        }
+    }
+    if (document.HasMember("connection_pool") && _connection_pool.update(document["connection_pool"])) {
+        changes.emplace_back("connection_pool");
+    }
+    if (document.HasMember("socket_options")) {
+        bool has_change = false;
+        // the default of the faces created from now on, the ingress master faces change theirs at once
+        SocketOptions options = SocketOptions::getDefault();
+        if (options.update(document["socket_options"]) && options != SocketOptions::getDefault()) {
+            SocketOptions::setDefault(options);
+            for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face}) {
+                master_face->setSocketOptions(options);
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("socket_options");
+        }
+    }
+    if (document.HasMember("queue_max_packets") && document["queue_max_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["queue_max_packets"].GetUint();
+        if (max_packets != QueuePolicy::getMaxPackets()) {
+            QueuePolicy::setMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_packets");
+        }
+    }
+    if (document.HasMember("queue_max_bytes") && document["queue_max_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["queue_max_bytes"].GetUint();
+        if (max_bytes != QueuePolicy::getMaxBytes()) {
+            QueuePolicy::setMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_bytes");
+        }
+    }
+    if (document.HasMember("queue_drop_policy") && document["queue_drop_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["queue_drop_policy"].GetString();
+        if (policy != QueuePolicy::getDropPolicyName()) {
+            has_change = QueuePolicy::setDropPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_drop_policy");
+        }
+    }
+    if (document.HasMember("queue_scheduler") && document["queue_scheduler"].IsString()) {
+        bool has_change = false;
+        std::string scheduler = document["queue_scheduler"].GetString();
+        if (scheduler != QueuePolicy::getSchedulerName()) {
+            has_change = QueuePolicy::setScheduler(scheduler);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_scheduler");
+        }
+    }
+    if (document.HasMember("queue_classes") && QueuePolicy::setClasses(document["queue_classes"])) {
+        changes.emplace_back("queue_classes");
+    }
 
     std::stringstream ss;
     ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"edit_config", "changes":[)";
@@ -237,11 +678,15 @@ void Firewall::commandAddFace(const rapidjson::Document &document) {
     enum layer_type {
         TCP,
         UDP,
+        SHM,
+        MEM,
     };
 
     static const std::unordered_map<std::string, layer_type> LAYERS = {
             {"tcp", TCP},
             {"udp", UDP},
+            {"shm", SHM},
+            {"mem", MEM},
     };
 
     if (document.HasMember("layer") && document.HasMember("address") && document.HasMember("port")
@@ -251,16 +696,30 @@ void Firewall::commandAddFace(const rapidjson::Document &document) {
             std::shared_ptr<Face> face;
             switch (it->second) {
                 case TCP:
-                    face = std::make_shared<TcpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    face = _connection_pool.makeFace(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
                     break;
                 case UDP:
-                    face = std::make_shared<UdpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    face = std::make_shared<UdpFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
+                    break;
+                case SHM:
+                    face = std::make_shared<ShmFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
+                    break;
+                case MEM:
+                    face = std::make_shared<MemoryFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
                     break;
             }
-            _egress_faces.push_back(face);
-            face->open(boost::bind(&Firewall::onEgressInterest, this, _1, _2),
-                       boost::bind(&Firewall::onEgressData, this, _1, _2),
-                       boost::bind(&Firewall::onFaceError, this, _1));
+            if (document.HasMember("socket_options")) {
+                // on top of the default, before open for the buffers of a TCP connection
+                SocketOptions options = SocketOptions::getDefault();
+                if (options.update(document["socket_options"])) {
+                    face->setSocketOptions(options);
+                }
+            }
+            _egress_faces.write([&face](std::vector<std::shared_ptr<Face>> &egress_faces) {
+                egress_faces.push_back(face);
+            });
+            face->open(PacketHandler::bind<Firewall, &Firewall::onEgressPacket>(this),
+                       _control_strand.wrap(boost::bind(&Firewall::onFaceError, this, _1)));
             std::stringstream ss;
             ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_face", "face_id":)" << face->getFaceId() << "}";
             _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
@@ -271,15 +730,21 @@ void Firewall::commandAddFace(const rapidjson::Document &document) {
 void Firewall::commandDelFace(const rapidjson::Document &document) {
     if (document.HasMember("face_id") && document["face_id"].IsUint()) {
         size_t face_id = document["face_id"].GetUint();
-        bool ok = false;
-        for (auto& egress_face : _egress_faces) {
-            if (egress_face->getFaceId() == face_id) {
-                egress_face->close();
-                std::swap(egress_face, _egress_faces.back());
-                _egress_faces.pop_back();
-                ok = true;
-                break;
+        std::shared_ptr<Face> face;
+        _egress_faces.write([&](std::vector<std::shared_ptr<Face>> &egress_faces) {
+            for (auto& egress_face : egress_faces) {
+                if (egress_face->getFaceId() == face_id) {
+                    face = egress_face;
+                    std::swap(egress_face, egress_faces.back());
+                    egress_faces.pop_back();
+                    break;
+                }
             }
+        });
+        // closed once no reader can send to it anymore
+        bool ok = static_cast<bool>(face);
+        if (face) {
+            face->close();
         }
         std::stringstream ss;
         ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_face", "face_id":)" << face_id << R"(, "status":)" << ok << "}";
@@ -287,27 +752,87 @@ void Firewall::commandDelFace(const rapidjson::Document &document) {
     }
 }
 
+bool Firewall::parseRule(const rapidjson::Value &rule, Filter::Rule &filter_rule) {
+    if (!rule.IsArray()) {
+        return false;
+    }
+    auto rule_info = rule.GetArray();
+    // [name, drop, priority] for a prefix, a true fourth member makes name a pattern, a fifth one
+    // {"rate", "burst", "per_face"} limits the packets the rule accepts
+    if (rule_info.Size() < 3 || rule_info.Size() > 5 || !rule_info[0].IsString() || !rule_info[1].IsBool() ||
+            !rule_info[2].IsUint() || (rule_info.Size() >= 4 && !rule_info[3].IsBool()) ||
+            (rule_info.Size() == 5 && !rule_info[4].IsObject())) {
+        return false;
+    }
+    filter_rule.name = ndn::Name(rule_info[0].GetString());
+    filter_rule.drop = rule_info[1].GetBool();
+    filter_rule.is_pattern = rule_info.Size() >= 4 && rule_info[3].GetBool();
+    filter_rule.rate = 0;
+    filter_rule.burst = 1;
+    filter_rule.per_face = false;
+    if (rule_info.Size() == 5) {
+        const auto &limit = rule_info[4];
+        if (limit.HasMember("rate") && limit["rate"].IsNumber()) {
+            filter_rule.rate = std::max(limit["rate"].GetDouble(), 0.0);
+        }
+        if (limit.HasMember("burst") && limit["burst"].IsUint()) {
+            filter_rule.burst = std::max<size_t>(limit["burst"].GetUint(), 1);
+        }
+        if (limit.HasMember("per_face") && limit["per_face"].IsBool()) {
+            filter_rule.per_face = limit["per_face"].GetBool();
+        }
+    }
+    std::stringstream ss;
+    if (filter_rule.is_pattern && !PatternMatcher::isValid(filter_rule.name)) {
+        ss << "pattern " << filter_rule.name << " has more than " << PatternMatcher::MAX_PATTERN_SIZE << " components";
+        logger::log(logger::WARNING, ss.str());
+        return false;
+    }
+    if (filter_rule.is_pattern && filter_rule.rate > 0) {
+        ss << "pattern " << filter_rule.name << " can't be rate limited";
+        logger::log(logger::WARNING, ss.str());
+        return false;
+    }
+    return true;
+}
+
 void Firewall::commandAddRules(const rapidjson::Document &document) {
     if (document.HasMember("rules") && document["rules"].IsArray()) {
         std::stringstream ss;
         ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_rules", )";
         auto&& rules = document["rules"].GetArray();
+        bool is_staged = document.HasMember("version") && document["version"].IsUint();
         if (rules.Empty()) {
             ss << R"("status":"fail", "reason":"empty rule list"})";
+        } else if (is_staged && (!_staged_rules || document["version"].GetUint() != _staged_version)) {
+            ss << R"("status":"fail", "reason":"unknown version"})";
         } else {
+            std::vector<Filter::Rule> filter_rules;
             for (auto &rule : rules) {
-                if (rule.IsArray()) {
-                    auto rule_info = rule.GetArray();
-                    if (rule_info.Size() == 3 && rule_info[0].IsString() && rule_info[1].IsBool() && rule_info[2].IsUint()) {
-                        ndn::Name name_prefix(rule_info[0].GetString());
-                        _filter.insert(name_prefix, rule_info[1].GetBool());
-                        std::stringstream ss1;
-                        ss1 << name_prefix << " with " << (rule_info[1].GetBool() ? "drop" : "accept") << " policy added by manager";
-                        logger::log(logger::INFO, ss1.str());
-                    }
+                Filter::Rule filter_rule;
+                if (!parseRule(rule, filter_rule)) {
+                    continue;
+                }
+                if (is_staged) {
+                    // the rule set of a version is logged once it is in force
+                    _staged_rules->push_back(std::move(filter_rule));
+                    continue;
                 }
+                std::stringstream ss1;
+                ss1 << (filter_rule.is_pattern ? "pattern " : "") << filter_rule.name << " with " << (filter_rule.drop ? "drop" : "accept") << " policy";
+                if (filter_rule.rate > 0) {
+                    ss1 << " limited to " << filter_rule.rate << " packets by second" << (filter_rule.per_face ? " by face" : "");
+                }
+                ss1 << " added by manager";
+                logger::log(logger::INFO, ss1.str());
+                filter_rules.push_back(std::move(filter_rule));
+            }
+            if (is_staged) {
+                ss << R"("status":"success", "version":)" << _staged_version << R"(, "staged":)" << _staged_rules->size() << "}";
+            } else {
+                _filter.insert(filter_rules);
+                ss << R"("status":"success"})";
             }
-            ss << R"("status":"success"})";
         }
         _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
     }
@@ -321,37 +846,243 @@ void Firewall::commandDelRules(const rapidjson::Document &document) {
         if (rules.Empty()) {
             ss << R"("status":"fail", "reason":"empty prefix list"})";
         } else {
+            std::vector<ndn::Name> names;
             for (auto &rule : rules) {
                 if (rule.IsString()) {
-                    ndn::Name name_prefix(rule.GetString());
-                    _filter.remove(name_prefix);
+                    names.emplace_back(rule.GetString());
                     std::stringstream ss1;
-                    ss1 << name_prefix << " removed by manager";
+                    ss1 << names.back() << " removed by manager";
                     logger::log(logger::INFO, ss1.str());
                 }
             }
+            _filter.remove(names);
             ss << R"("status":"success"})";
         }
         _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
-        std::cout << _filter.toJSON() << std::endl;
     }
 }
 
+void Firewall::commandBeginRules(const rapidjson::Document &document) {
+    if (document.HasMember("version") && document["version"].IsUint()) {
+        // a rule set staged before and not committed is dropped
+        _staged_version = document["version"].GetUint();
+        _staged_rules = std::make_shared<std::vector<Filter::Rule>>();
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint()
+           << R"(, "action":"begin_rules", "version":)" << _staged_version << R"(, "status":"success"})";
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    }
+}
+
+void Firewall::commandCommitRules(const rapidjson::Document &document) {
+    if (document.HasMember("version") && document["version"].IsUint()) {
+        size_t version = document["version"].GetUint();
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint()
+           << R"(, "action":"commit_rules", "version":)" << version << ", ";
+        if (!_staged_rules || version != _staged_version) {
+            ss << R"("status":"fail", "reason":"unknown version"})";
+        } else if (document.HasMember("count") && document["count"].IsUint() && document["count"].GetUint() != _staged_rules->size()) {
+            ss << R"("status":"fail", "reason":"incomplete", "staged":)" << _staged_rules->size() << "}";
+        } else if (_is_compiling) {
+            ss << R"("status":"fail", "reason":"busy"})";
+        } else {
+            auto rules = std::move(_staged_rules);
+            bool is_prechecked = _filter.isPrechecked();
+            compileRules(ss.str(), version, [this, rules, is_prechecked]() {
+                return _filter.compile(*rules, is_prechecked);
+            });
+            return;
+        }
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    }
+}
+
+void Firewall::commandLoadRules(const rapidjson::Document &document) {
+    if (document.HasMember("path") && document["path"].IsString()) {
+        size_t version = document.HasMember("version") && document["version"].IsUint() ? document["version"].GetUint() : _rules_version + 1;
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint()
+           << R"(, "action":"load_rules", "version":)" << version << ", ";
+        if (_is_compiling) {
+            ss << R"("status":"fail", "reason":"busy"})";
+            _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+            return;
+        }
+        std::string path = document["path"].GetString();
+        bool is_prechecked = _filter.isPrechecked();
+        compileRules(ss.str(), version, [this, path, is_prechecked]() {
+            return _filter.compile(path, is_prechecked);
+        });
+    }
+}
+
+void Firewall::compileRules(const std::string &reply, size_t version, const std::function<std::shared_ptr<Filter::RuleSet>()> &compile) {
+    _is_compiling = true;
+    boost::asio::ip::udp::endpoint endpoint = _remote_command_endpoint;
+    _compile_ios.post([this, reply, version, compile, endpoint]() {
+        std::shared_ptr<Filter::RuleSet> rule_set = compile();
+        _control_strand.post([this, reply, version, rule_set, endpoint]() mutable {
+            std::stringstream ss;
+            ss << reply;
+            if (rule_set) {
+                size_t size = rule_set->size();
+                // a single write, the former rules are freed on the compile thread
+                _filter.replace(*rule_set);
+                _rules_version = version;
+                _compile_ios.post([rule_set]() {
+
+                });
+                rule_set.reset();
+                std::stringstream ss1;
+                ss1 << "rules of version " << version << " in force, " << size << " rules";
+                logger::log(logger::INFO, ss1.str());
+                ss << R"("status":"success"})";
+            } else {
+                ss << R"("status":"fail", "reason":"rules can't be read"})";
+            }
+            _is_compiling = false;
+            _command_socket.send_to(boost::asio::buffer(ss.str()), endpoint);
+        });
+    });
+}
+
 void Firewall::commandList(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
     std::stringstream ss;
-    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list")" << "}";
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list")";
+    ss << R"(, "faces":[)";
+    _egress_faces.read([&ss](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+        bool first = true;
+        for (const auto &face : egress_faces) {
+            if (first) {
+                first = false;
+            } else {
+                ss << ", ";
+            }
+            ss << face->toJSON();
+        }
+    });
+    ss << R"(], "master_faces":[)" << _tcp_ingress_master_face->toJSON() << ", " << _udp_ingress_master_face->toJSON() << ", " << _shm_ingress_master_face->toJSON() << ", " << _mem_ingress_master_face->toJSON() << "]"
+       << R"(, "connection_pool":)" << _connection_pool.toJSON() << R"(, "buffer_pool":)" << BufferPool::getStats().toJSON() << R"(, "stages":)" << stage_profile::toJSON()
+       << R"(, "rules_version":)" << _rules_version << R"(, "staged_rules":)" << (_staged_rules ? _staged_rules->size() : 0)
+       << R"(, "filter_precheck":)" << _filter.isPrechecked() << R"(, "filter_precheck_bytes":)" << _filter.getPrecheckBytes()
+       << R"(, "filter_lookup_cache":)" << (_filter.isCachingLookups() ? "true" : "false")
+       << R"(, "drop_log_sampling":)" << _drop_log_sampling << R"(, "drop_log_lost":)" << _drop_logger.getDropped() << "}";
     _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
 }
 
+void Firewall::commandMemoryStats(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    MemoryStats stats;
+    _filter.addMemoryStats(stats);
+    if (_staged_rules) {
+        size_t staged_bytes = memory_usage::of(*_staged_rules);
+        for (const auto &rule : *_staged_rules) {
+            staged_bytes += memory_usage::of(rule.name);
+        }
+        stats.add("staged_rules", _staged_rules->size(), staged_bytes);
+    }
+    _egress_faces.read([&stats](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+        for (const auto &face : egress_faces) {
+            face->addMemoryStats(stats);
+        }
+    });
+    _tcp_ingress_master_face->addMemoryStats(stats);
+    _udp_ingress_master_face->addMemoryStats(stats);
+    _shm_ingress_master_face->addMemoryStats(stats);
+    _mem_ingress_master_face->addMemoryStats(stats);
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"memory_stats", "memory":)"
+       << stats.toJSON() << "}";
+    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+}
+
+void Firewall::sendReport(const std::string &alarms) {
+    if (_manager_endpoint.address() == boost::asio::ip::address_v4::any() || _manager_endpoint.port() == 0) {
+        return;
+    }
+    stage_profile::Scope stage(stage_profile::REPORT);
+    std::string rules = _filter.takeHitsJSON(MAX_REPORTED_RULES);
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"report", "action":"cache_status")";
+    if (_report_delta) {
+        // the hits of the rules are since the previous report in both
+        ss << R"(, "delta":true)";
+        _report_deltas.counter(ss, "interest_drop", _interest_drop_counter);
+        _report_deltas.counter(ss, "data_drop", _data_drop_counter);
+        _report_deltas.counter(ss, "over_limit", _over_limit_counter);
+        bool has_changes = _report_deltas.takeChanges();
+        if (rules != "[]") {
+            ss << R"(, "rules":)" << rules;
+        } else if (!has_changes && alarms.empty()) {
+            return;
+        }
+    } else {
+        ss << R"(, "interest_drop":)" << _interest_drop_counter << R"(, "data_drop":)" << _data_drop_counter
+           << R"(, "over_limit":)" << _over_limit_counter << R"(, "rules":)" << rules << R"(, "stages":)" << stage_profile::toJSON();
+    }
+    if (!alarms.empty()) {
+        ss << R"(, "alarms":)" << alarms;
+    }
+    ss << "}";
+    _command_socket.send_to(boost::asio::buffer(ss.str()), _manager_endpoint);
+}
+
 void Firewall::commandReport(const boost::system::error_code &err) {
-    if (!err && _manager_endpoint.address() != boost::asio::ip::address_v4::any() && _manager_endpoint.port() != 0) {
-        std::stringstream ss;
-        ss << R"({"name":")" << _name << R"(", "type":"report", "action":"cache_status", "interest_drop":)" << _interest_drop_counter << R"(, "data_drop":)" << _data_drop_counter << "}";
-        _command_socket.send_to(boost::asio::buffer(ss.str()), _manager_endpoint);
+    if (!err) {
+        sendReport("");
     }
     if(_report_enable) {
         _report_timer.expires_from_now(_delay_between_report);
-        _report_timer.async_wait(boost::bind(&Firewall::commandReport, this, _1));
+        _report_timer.async_wait(_control_strand.wrap(boost::bind(&Firewall::commandReport, this, _1)));
+    }
+}
+
+void Firewall::armAlarms() {
+    if (!_is_alarm_timer_armed && (_drop_rate_alarm.isEnabled() || _queue_alarm.isEnabled())) {
+        _is_alarm_timer_armed = true;
+        _alarm_drops = getDrops();
+        _alarm_timer.expires_from_now(boost::posix_time::milliseconds(ALARM_CHECK_INTERVAL));
+        _alarm_timer.async_wait(_control_strand.wrap(boost::bind(&Firewall::checkAlarms, this, _1)));
     }
 }
 
+void Firewall::checkAlarms(const boost::system::error_code &err) {
+    if (err || (!_drop_rate_alarm.isEnabled() && !_queue_alarm.isEnabled())) {
+        _is_alarm_timer_armed = false;
+        return;
+    }
+    std::stringstream alarms;
+    size_t drops = getDrops();
+    double drop_rate = (drops - _alarm_drops) * 1000.0 / ALARM_CHECK_INTERVAL;
+    _alarm_drops = drops;
+    if (_drop_rate_alarm.update(drop_rate)) {
+        alarms << _drop_rate_alarm.toJSON("drop_rate", drop_rate);
+    }
+    size_t queued = getQueuedPackets();
+    if (_queue_alarm.update(queued)) {
+        alarms << (alarms.tellp() > 0 ? ", " : "") << _queue_alarm.toJSON("queue", queued);
+    }
+    if (alarms.tellp() > 0) {
+        sendReport("[" + alarms.str() + "]");
+    }
+    _alarm_timer.expires_from_now(boost::posix_time::milliseconds(ALARM_CHECK_INTERVAL));
+    _alarm_timer.async_wait(_control_strand.wrap(boost::bind(&Firewall::checkAlarms, this, _1)));
+}
+
+void Firewall::writeMetrics(MetricsWriter &writer) {
+    _egress_faces.read([&writer](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+        for (const auto &egress_face : egress_faces) {
+            egress_face->writeMetrics(writer);
+        }
+    });
+    for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face, _shm_ingress_master_face, _mem_ingress_master_face}) {
+        master_face->writeMetrics(writer);
+    }
+    BufferPool::getStats().writeMetrics(writer);
+    stage_profile::writeMetrics(writer);
+    writer.counter("ndn_filter_dropped_total", "packets dropped by the filter", {{"type", "interest"}}, _interest_drop_counter);
+    writer.counter("ndn_filter_dropped_total", "packets dropped by the filter", {{"type", "data"}}, _data_drop_counter);
+    writer.counter("ndn_filter_over_limit_total", "packets dropped by the rate limit of a rule", {}, _over_limit_counter);
+}
@@ -5,19 +5,34 @@
 
 #include <boost/asio.hpp>
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <queue>
 
 #include "rapidjson/document.h"
 
-#include "module.h"
+#include "runtime/module.h"
+#include "management/startup_config.h"
 #include "filter.h"
+#include "log/async_logger.h"
+#include "metrics/report_trigger.h"
 #include "network/master_face.h"
 #include "network/face.h"
+#include "network/tcp_connection_pool.h"
+#include "tree/left_right.h"
 
+// threads: the packets are handled by all the threads of the module (-j, -r), the filter and the egress faces are
+// shared and guard themselves, the counters and options are atomic and everything else only runs on the control strand
 class Firewall : public Module {
+public:
+    // rules with the most hits put in a report
+    static const size_t MAX_REPORTED_RULES = 64;
+
+private:
     const std::string _name;
 
     Filter _filter;
@@ -25,34 +40,119 @@ class Firewall : public Module {
     char _command_buffer[65536];
     boost::asio::ip::udp::socket _command_socket;
     boost::asio::ip::udp::endpoint _remote_command_endpoint;
+    StartupConfig _startup_config;
+    // connections kept open to the endpoints set by edit_config, add_face takes them
+    TcpConnectionPool _connection_pool;
 
-    bool _drop_interest = false;
-    bool _drop_data = false;
-    bool _report_enable = false;
+    // handlers of the commands, the timers and the face events run in turn on _control_ios, packets on every thread of
+    // the module
+    boost::asio::strand _control_strand;
+
+    std::atomic<bool> _drop_interest{false};
+    std::atomic<bool> _drop_data{false};
+    std::atomic<bool> _report_enable{false};
     boost::asio::ip::udp::endpoint _manager_endpoint;
     boost::asio::deadline_timer _report_timer;
     boost::posix_time::milliseconds _delay_between_report;
-    size_t _interest_drop_counter = 0;
-    size_t _data_drop_counter = 0;
-
-    std::vector<std::shared_ptr<Face>> _egress_faces;
+    // on the control strand as the reports: the periodic ones only carry what changed, none is sent when nothing did
+    bool _report_delta = false;
+    ReportDeltas _report_deltas;
+    // checked every ALARM_CHECK_INTERVAL while one of them is set, a crossing is reported at once. the drop rate is
+    // of the packets dropped by the rules or their limits, per second since the previous check
+    ThresholdAlarm _drop_rate_alarm{ThresholdAlarm::ABOVE};
+    ThresholdAlarm _queue_alarm{ThresholdAlarm::ABOVE};
+    boost::asio::deadline_timer _alarm_timer;
+    bool _is_alarm_timer_armed = false;
+    size_t _alarm_drops = 0;
+    // in milliseconds
+    static const size_t ALARM_CHECK_INTERVAL = 100;
+    std::atomic<size_t> _interest_drop_counter{0};
+    std::atomic<size_t> _data_drop_counter{0};
+    // packets dropped by the rate limit of a rule
+    std::atomic<size_t> _over_limit_counter{0};
+    // one dropped packet in drop_log_sampling has its Name logged, none if 0
+    std::atomic<size_t> _drop_log_sampling{0};
+    std::atomic<size_t> _drop_log_counter{0};
+    AsyncLogger _drop_logger;
+
+    LeftRight<std::vector<std::shared_ptr<Face>>> _egress_faces;
     std::shared_ptr<MasterFace> _tcp_ingress_master_face;
     std::shared_ptr<MasterFace> _udp_ingress_master_face;
+    std::shared_ptr<MasterFace> _shm_ingress_master_face;
+    std::shared_ptr<MasterFace> _mem_ingress_master_face;
+
+    // rule sets uploaded in several commands or loaded from a file are compiled on a thread of their own and put in
+    // force at once, see Filter::replace. the rules of a version are staged until it is committed
+    size_t _rules_version = 0;
+    size_t _staged_version = 0;
+    std::shared_ptr<std::vector<Filter::Rule>> _staged_rules;
+    bool _is_compiling = false;
+    boost::asio::io_service _compile_ios;
+    std::unique_ptr<boost::asio::io_service::work> _compile_ios_work;
+    std::thread _compile_thread;
+
+    // false if rule isn't well formed, see commandAddRules
+    static bool parseRule(const rapidjson::Value &rule, Filter::Rule &filter_rule);
+
+    // compile runs on the compile thread, the rules it returns are put in force as version and reply sent with the
+    // status appended to it
+    void compileRules(const std::string &reply, size_t version, const std::function<std::shared_ptr<Filter::RuleSet>()> &compile);
+
+    // the ingress master faces stop accepting, the faces already there are served until the module stops
+    void beginDrain() override;
+
+    // nothing queued on the faces
+    bool isDrained() override;
+
+    // on the ingress and the egress faces
+    size_t getQueuedPackets();
+
+    size_t getDrops() const;
+
+    // alarms is the JSON array of the alarms which changed, empty for a periodic report
+    void sendReport(const std::string &alarms);
+
+    // arms the alarm timer if an alarm is set and it isn't armed yet
+    void armAlarms();
+
+    void checkAlarms(const boost::system::error_code &err);
 
 public:
-    Firewall(const std::string &name, uint16_t local_port, uint16_t local_command_port);
+    Firewall(const std::string &name, uint16_t local_port, uint16_t local_command_port, size_t udp_shards = 1, const std::string &filter_engine = "tree",
+             size_t concurrency = 1, Runtime runtime = SHARED);
 
-    ~Firewall() override = default;
+    ~Firewall() override;
 
     void run() override;
 
-    void onIngressInterest(const std::shared_ptr<Face> &ingress_face, const ndn::Interest &interest);
+    // the commands applied by run() before the ingress accepts a face, see StartupConfig. false if source can't be
+    // read. before start()
+    bool loadStartupConfig(const std::string &source);
+
+    // rules kept across restarts, see Filter::save and Filter::load
+    bool saveRules(const std::string &path) const;
+
+    bool loadRules(const std::string &path);
+
+    // only the Name is decoded to apply the filter, packets are forwarded as received
+    void onIngressPacket(const std::shared_ptr<Face> &ingress_face, const NdnPacket &packet);
+
+    // the packets of a read checked together, see Filter::check, and forwarded in order
+    void onIngressBurst(const std::shared_ptr<Face> &ingress_face, const std::vector<NdnPacket> &packets);
+
+    void onEgressPacket(const std::shared_ptr<Face> &egress_face, const NdnPacket &packet);
+
+    // false if the packet received on face is dropped, the drop counters are updated
+    bool pass(const std::shared_ptr<Face> &face, const NdnPacket &packet);
 
-    void onIngressData(const std::shared_ptr<Face> &ingress_face, const ndn::Data &data);
+    // the packets of its type are checked against the rules, the others pass unless they aren't Interests nor Data
+    bool isFiltered(const NdnPacket &packet) const;
 
-    void onEgressInterest(const std::shared_ptr<Face> &egress_face, const ndn::Interest &interest);
+    // same as pass once the rules gave verdict
+    bool pass(const std::shared_ptr<Face> &face, const NdnPacket &packet, Filter::Verdict verdict);
 
-    void onEgressData(const std::shared_ptr<Face> &egress_face, const ndn::Data &data);
+    // the Name is formatted and written by the thread of _drop_logger
+    void logDrop(const std::shared_ptr<Face> &face, const NdnPacket &packet, bool is_over_limit);
 
     void onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
 
@@ -64,6 +164,9 @@ public:
 
     void commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred);
 
+    // a parsed command with an action, on _control_strand
+    void executeCommand(const rapidjson::Document &document);
+
     void commandEditConfig(const rapidjson::Document &document);
 
     void commandAddFace(const rapidjson::Document &document);
@@ -74,7 +177,22 @@ public:
 
     void commandDelRules(const rapidjson::Document &document);
 
+    // {"version"}, the rules of that version are then added with add_rules and a "version" member
+    void commandBeginRules(const rapidjson::Document &document);
+
+    // {"version", "count"}, count is optional and checked against the rules staged
+    void commandCommitRules(const rapidjson::Document &document);
+
+    // {"path", "version"}, a file written by saveRules, version is optional
+    void commandLoadRules(const rapidjson::Document &document);
+
     void commandList(const rapidjson::Document &document);
 
+    // the bytes held by the rules, compiled and staged, and the faces, see MemoryStats
+    void commandMemoryStats(const rapidjson::Document &document);
+
     void commandReport(const boost::system::error_code &err);
+
+    // at each scrape, off the control strand: only what is shared with the packet threads is read
+    void writeMetrics(MetricsWriter &writer);
 };
\ No newline at end of file
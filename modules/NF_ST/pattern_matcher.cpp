@@ -0,0 +1,202 @@
+#include "pattern_matcher.h"
+
+#include <boost/container/small_vector.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+
+enum ComponentKind {
+    LITERAL,
+    ANY,
+    ANY_SEQUENCE,
+    GLOB
+};
+
+static ComponentKind kindOf(const ndn::Name::Component &component) {
+    if (component.type() != ndn::tlv::NameComponent) {
+        return LITERAL;
+    }
+    auto value = reinterpret_cast<const char*>(component.value());
+    size_t size = component.value_size();
+    if (size == 1 && value[0] == '*') {
+        return ANY;
+    }
+    if (size == 2 && value[0] == '*' && value[1] == '*') {
+        return ANY_SEQUENCE;
+    }
+    return std::memchr(value, '*', size) ? GLOB : LITERAL;
+}
+
+bool PatternMatcher::matchesGlob(const Glob &glob, const NameComponentRef &component) {
+    if (component.type != glob.type) {
+        return false;
+    }
+    auto value = reinterpret_cast<const char*>(component.value);
+    size_t begin = 0;
+    size_t end = component.length;
+    const std::string &first = glob.pieces.front();
+    const std::string &last = glob.pieces.back();
+    if (first.size() + last.size() > end || first.compare(0, first.size(), value, first.size()) != 0 ||
+            last.compare(0, last.size(), value + end - last.size(), last.size()) != 0) {
+        return false;
+    }
+    begin += first.size();
+    end -= last.size();
+    // the first match of each piece leaves the most room to the next ones
+    for (size_t i = 1; i + 1 < glob.pieces.size(); ++i) {
+        const std::string &piece = glob.pieces[i];
+        if (piece.empty()) {
+            continue;
+        }
+        const char *found = std::search(value + begin, value + end, piece.begin(), piece.end());
+        if (found == value + end) {
+            return false;
+        }
+        begin = found - value + piece.size();
+    }
+    return true;
+}
+
+uint64_t PatternMatcher::close(const Bank &bank, uint64_t states) {
+    uint64_t closed = states | ((states & bank.any_sequence) << 1);
+    while (closed != states) {
+        states = closed;
+        closed = states | ((states & bank.any_sequence) << 1);
+    }
+    return closed;
+}
+
+uint64_t PatternMatcher::accepts(const Bank &bank, const NameComponentRef &component, uint64_t hash) const {
+    uint64_t mask = bank.any;
+    auto it = bank.literals.find(hash);
+    if (it != bank.literals.end()) {
+        for (const auto &literal : it->second) {
+            if (NameComponentRef::compare(literal.component, component) == 0) {
+                mask |= literal.bit;
+            }
+        }
+    }
+    for (const auto &glob : bank.globs) {
+        if (matchesGlob(glob, component)) {
+            mask |= glob.bit;
+        }
+    }
+    return mask;
+}
+
+bool PatternMatcher::isValid(const ndn::Name &pattern) {
+    return pattern.size() <= MAX_PATTERN_SIZE;
+}
+
+void PatternMatcher::add(const ndn::Name &pattern, size_t id) {
+    size_t bits = pattern.size() + 1;
+    if (_banks.empty() || _banks.back().size + bits > 64) {
+        _banks.emplace_back();
+    }
+    Bank &bank = _banks.back();
+    size_t base = bank.size;
+    bank.start |= uint64_t(1) << base;
+    bank.final |= uint64_t(1) << (base + pattern.size());
+    bank.ids[base + pattern.size()] = id;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        const ndn::Name::Component &component = pattern.get(i);
+        uint64_t bit = uint64_t(1) << (base + i);
+        switch (kindOf(component)) {
+            case LITERAL:
+                bank.literals[name_hash::extend(name_hash::SEED, name_hash::toRef(component))].push_back({component, bit});
+                break;
+            case ANY:
+                bank.any |= bit;
+                break;
+            case ANY_SEQUENCE:
+                bank.any_sequence |= bit;
+                break;
+            case GLOB: {
+                Glob glob{component.type(), {}, bit};
+                auto value = reinterpret_cast<const char*>(component.value());
+                size_t begin = 0;
+                for (size_t j = 0; j < component.value_size(); ++j) {
+                    if (value[j] == '*') {
+                        glob.pieces.emplace_back(value + begin, j - begin);
+                        begin = j + 1;
+                    }
+                }
+                glob.pieces.emplace_back(value + begin, component.value_size() - begin);
+                bank.globs.push_back(std::move(glob));
+                break;
+            }
+        }
+    }
+    bank.size += bits;
+    ++_size;
+}
+
+void PatternMatcher::clear() {
+    _banks.clear();
+    _size = 0;
+}
+
+size_t PatternMatcher::size() const {
+    return _size;
+}
+
+size_t PatternMatcher::getMemoryUsage() const {
+    size_t bytes = memory_usage::of(_banks);
+    for (const auto &bank : _banks) {
+        bytes += memory_usage::of(bank.literals) + memory_usage::of(bank.globs);
+        for (const auto &literals : bank.literals) {
+            bytes += memory_usage::of(literals.second);
+        }
+        for (const auto &glob : bank.globs) {
+            bytes += memory_usage::of(glob.pieces);
+            for (const auto &piece : glob.pieces) {
+                bytes += memory_usage::of(piece);
+            }
+        }
+    }
+    return bytes;
+}
+
+size_t PatternMatcher::match(const ndn::Name &name) const {
+    if (_banks.empty()) {
+        return NONE;
+    }
+    boost::container::small_vector<NameComponentRef, NameView::INLINE_COMPONENTS> components;
+    boost::container::small_vector<uint64_t, NameView::INLINE_COMPONENTS> hashes;
+    for (const auto &component : name) {
+        components.push_back(name_hash::toRef(component));
+        hashes.push_back(name_hash::extend(name_hash::SEED, components.back()));
+    }
+    return match(components.data(), hashes.data(), components.size());
+}
+
+size_t PatternMatcher::match(const NameView &name) const {
+    if (_banks.empty()) {
+        return NONE;
+    }
+    boost::container::small_vector<NameComponentRef, NameView::INLINE_COMPONENTS> components;
+    boost::container::small_vector<uint64_t, NameView::INLINE_COMPONENTS> hashes;
+    for (size_t i = 0; i < name.size(); ++i) {
+        components.push_back(name[i]);
+        hashes.push_back(name_hash::extend(name_hash::SEED, components.back()));
+    }
+    return match(components.data(), hashes.data(), components.size());
+}
+
+size_t PatternMatcher::match(const NameComponentRef *components, const uint64_t *hashes, size_t size) const {
+    for (const auto &bank : _banks) {
+        uint64_t states = close(bank, bank.start);
+        for (size_t i = 0; i < size && !(states & bank.final) && states; ++i) {
+            // a "**" keeps its state on any component, the other states move on if their component is accepted
+            uint64_t moved = (states & ~bank.any_sequence & accepts(bank, components[i], hashes[i])) << 1;
+            states = close(bank, moved | (states & bank.any_sequence));
+        }
+        if (uint64_t finals = states & bank.final) {
+            return bank.ids[__builtin_ctzll(finals)];
+        }
+    }
+    return NONE;
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "network/name_view.h"
+
+// Name patterns matched a component at a time: a generic component "*" stands for any single component, "**" for
+// any number of them, a "*" inside a generic component for any bytes of its value, any other component must be
+// equal. a pattern matches the Names which have a prefix it matches.
+// patterns are packed into banks of 64 bits, the state of a pattern of n components taking n + 1 bits, and all the
+// patterns of a bank go through a Name at once as a bit-parallel NFA (shift-and): a component costs a hash lookup
+// and a few word operations by bank, whatever the number of patterns in it
+class PatternMatcher {
+public:
+    // components of a pattern, one bit of the bank is left for its final state
+    static const size_t MAX_PATTERN_SIZE = 63;
+    // returned by match when no pattern matches
+    static const size_t NONE = SIZE_MAX;
+
+private:
+    struct Literal {
+        ndn::Name::Component component;
+        uint64_t bit;
+    };
+
+    // the value starts with the first piece, ends with the last one and holds the others in order between them
+    struct Glob {
+        uint32_t type;
+        std::vector<std::string> pieces;
+        uint64_t bit;
+    };
+
+    struct Bank {
+        uint64_t start = 0;
+        uint64_t final = 0;
+        uint64_t any = 0;
+        uint64_t any_sequence = 0;
+        // by name_hash of the component alone
+        std::unordered_map<uint64_t, std::vector<Literal>> literals;
+        std::vector<Glob> globs;
+        // ids of the patterns by bit of their final state
+        size_t ids[64];
+        size_t size = 0;
+    };
+
+    std::vector<Bank> _banks;
+    size_t _size = 0;
+
+    static bool matchesGlob(const Glob &glob, const NameComponentRef &component);
+
+    // the states reached through the "**" of states
+    static uint64_t close(const Bank &bank, uint64_t states);
+
+    uint64_t accepts(const Bank &bank, const NameComponentRef &component, uint64_t hash) const;
+
+    // the components with the name_hash of each alone
+    size_t match(const NameComponentRef *components, const uint64_t *hashes, size_t size) const;
+
+public:
+    PatternMatcher() = default;
+
+    ~PatternMatcher() = default;
+
+    static bool isValid(const ndn::Name &pattern);
+
+    // pattern must be valid, id is returned by match
+    void add(const ndn::Name &pattern, size_t id);
+
+    void clear();
+
+    size_t size() const;
+
+    // of the banks with their literals and globs
+    size_t getMemoryUsage() const;
+
+    // id of a pattern matching name, the one added first in its bank, NONE if there is none
+    size_t match(const ndn::Name &name) const;
+
+    size_t match(const NameView &name) const;
+};
\ No newline at end of file
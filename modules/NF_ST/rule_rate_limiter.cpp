@@ -0,0 +1,85 @@
+#include "rule_rate_limiter.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+
+static std::atomic<uint64_t> next_bucket_id{1};
+
+RuleRateLimiter::RuleRateLimiter(double rate, size_t burst, bool per_face)
+        : _rate(rate)
+        , _burst(std::max<size_t>(burst, 1))
+        , _per_face(per_face)
+        , _interval(static_cast<uint64_t>(1e9 / std::max(rate, 1e-3)))
+        , _tolerance(_interval * (_burst - 1))
+        , _id(next_bucket_id++) {
+
+}
+
+double RuleRateLimiter::getRate() const {
+    return _rate;
+}
+
+size_t RuleRateLimiter::getBurst() const {
+    return _burst;
+}
+
+bool RuleRateLimiter::isPerFace() const {
+    return _per_face;
+}
+
+uint64_t RuleRateLimiter::getId() const {
+    return _id;
+}
+
+bool RuleRateLimiter::consume(uint64_t now) {
+    return consume(_tat, now);
+}
+
+bool RuleRateLimiter::consume(std::atomic<uint64_t> &tat, uint64_t now) const {
+    uint64_t current = tat.load(std::memory_order_relaxed);
+    while (true) {
+        uint64_t base = std::max(current, now);
+        if (base - now > _tolerance) {
+            return false;
+        }
+        if (tat.compare_exchange_weak(current, base + _interval, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+std::string RuleRateLimiter::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"rate":)" << _rate << R"(, "burst":)" << _burst << R"(, "per_face":)" << (_per_face ? "true" : "false") << "}";
+    return ss.str();
+}
+
+FaceBuckets::FaceBuckets(size_t size) {
+    size_t capacity = 1;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    _slots = std::vector<Slot>(capacity);
+}
+
+bool FaceBuckets::consume(const RuleRateLimiter &bucket, size_t face_id, uint64_t now) {
+    // 0 stays the key of the free slots
+    uint64_t key = name_hash::mix(bucket.getId(), face_id) | 1;
+    Slot &slot = _slots[(key >> 1) & (_slots.size() - 1)];
+    if (slot.key.load(std::memory_order_relaxed) != key) {
+        slot.key.store(key, std::memory_order_relaxed);
+        slot.tat.store(0, std::memory_order_relaxed);
+    }
+    return bucket.consume(slot.tat, now);
+}
+
+size_t FaceBuckets::size() const {
+    return _slots.size();
+}
+
+size_t FaceBuckets::getMemoryUsage() const {
+    return memory_usage::of(_slots);
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// rate limit of a filter rule, a token bucket of burst tokens refilled at rate tokens by second. it is kept as the
+// theoretical arrival time of the next packet (GCRA), a single word changed by compare and swap, so that every
+// thread of the module takes tokens without locking
+class RuleRateLimiter {
+private:
+    double _rate;
+    size_t _burst;
+    bool _per_face;
+    // in nanoseconds
+    uint64_t _interval;
+    uint64_t _tolerance;
+    std::atomic<uint64_t> _tat{0};
+    // the bucket in a FaceBuckets table, unique for the process
+    const uint64_t _id;
+
+public:
+    // per_face gives every ingress face a bucket of its own, see FaceBuckets
+    RuleRateLimiter(double rate, size_t burst, bool per_face);
+
+    ~RuleRateLimiter() = default;
+
+    double getRate() const;
+
+    size_t getBurst() const;
+
+    bool isPerFace() const;
+
+    uint64_t getId() const;
+
+    // false if the bucket is empty, now in nanoseconds of the steady clock
+    bool consume(uint64_t now);
+
+    // same on the theoretical arrival time of another bucket with the same rate and burst
+    bool consume(std::atomic<uint64_t> &tat, uint64_t now) const;
+
+    std::string toJSON() const;
+};
+
+// the buckets of the rules limited per ingress face, in a table of fixed size whatever the number of faces: a slot
+// is taken over by the last (rule, face) hashed to it, which restarts with a full bucket
+class FaceBuckets {
+public:
+    static const size_t DEFAULT_SIZE = 4096;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key{0};
+        std::atomic<uint64_t> tat{0};
+    };
+
+    std::vector<Slot> _slots;
+
+public:
+    // size is rounded up to a power of 2
+    explicit FaceBuckets(size_t size = DEFAULT_SIZE);
+
+    ~FaceBuckets() = default;
+
+    bool consume(const RuleRateLimiter &bucket, size_t face_id, uint64_t now);
+
+    size_t size() const;
+
+    size_t getMemoryUsage() const;
+};
\ No newline at end of file
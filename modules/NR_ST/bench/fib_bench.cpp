@@ -0,0 +1,72 @@
+// bulk insert, longest prefix match, miss and bulk removal in the Fib with each of its engines, with the heap a
+// route takes, then the lookups of a few hot Names without and with the lookup cache. the Interests ask for a version
+// under a routed Name
+// usage: fib_bench [routes...]
+
+#include "fib.h"
+#include "bench/bench.h"
+
+static const char *ENGINES[] = {"tree", "hash", "static"};
+
+static std::vector<ndn::Block> makeInterests(const std::vector<ndn::Name> &prefixes) {
+    std::vector<ndn::Block> interests;
+    interests.reserve(prefixes.size());
+    for (size_t i = 0; i < prefixes.size(); ++i) {
+        ndn::Name name(prefixes[i]);
+        name.append(ndn::Name::Component("v1"));
+        interests.emplace_back(bench::makeInterest(name, static_cast<uint32_t>(i)).wireEncode());
+    }
+    return interests;
+}
+
+static void run(const char *engine, size_t routes) {
+    boost::asio::io_service ios;
+    auto producer = std::make_shared<bench::NullFace>(ios);
+    auto prefixes = bench::makeNames(routes);
+    auto order = bench::makeOrder(routes);
+    auto interests = bench::toPackets(makeInterests(prefixes));
+    auto misses = bench::toPackets(makeInterests(bench::makeNames(routes, routes)));
+    std::string table = std::string("Fib ") + engine;
+
+    size_t before = bench::getHeapBytes();
+    // Fib is over-aligned, it stays on the stack
+    Fib fib(engine);
+    bench::measureBatch(table.c_str(), "insert", routes, routes, [&]() {
+        fib.insert(producer, prefixes);
+    });
+    bench::printMemory(table.c_str(), routes, bench::getHeapBytes() - before);
+    size_t found = 0;
+    bench::measure(table.c_str(), "lookup", routes, routes, [&](size_t i) {
+        found += fib.get(interests[order[i]].getNameView()).size();
+    });
+    bench::measure(table.c_str(), "miss", routes, routes, [&](size_t i) {
+        found += fib.get(misses[order[i]].getNameView()).size();
+    });
+    // fits in the cache of the thread
+    const size_t hot = std::min<size_t>(routes, 256);
+    size_t hot_found = 0;
+    bench::measure(table.c_str(), "hot", routes, routes, [&](size_t i) {
+        hot_found += fib.get(interests[order[i % hot]].getNameView()).size();
+    });
+    fib.setLookupCache(true);
+    bench::measure(table.c_str(), "hot cached", routes, routes, [&](size_t i) {
+        hot_found += fib.get(interests[order[i % hot]].getNameView()).size();
+    });
+    fib.setLookupCache(false);
+    bench::measureBatch(table.c_str(), "remove", routes, routes, [&]() {
+        fib.remove(producer, prefixes);
+    });
+    if (found != routes || hot_found != 2 * routes || fib.getLogicalSize() != 0) {
+        std::printf("%s: unexpected routes\n", table.c_str());
+    }
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t routes : bench::getSizes(argc, argv)) {
+        for (const char *engine : ENGINES) {
+            run(engine, routes);
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
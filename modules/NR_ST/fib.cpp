@@ -1,56 +1,444 @@
 #include "fib.h"
 
-void Fib::insert(const std::shared_ptr<Face> &face, const ndn::Name &prefix) {
-    if (auto entry = _tree.find(prefix)) {
-        return entry->addFace(prefix, face);
-    } else {
-        _tree.insert(prefix, std::make_shared<FibEntry>(face));
+#include "metrics/memory_stats.h"
+#include "tree/decision_cache.h"
+
+namespace {
+    // the faces are weak, the cache of a thread doesn't keep alive those the routes dropped
+    using CachedFaces = boost::container::small_vector<std::weak_ptr<Face>, 4>;
+
+    struct CachedNextHop {
+        std::weak_ptr<Face> face;
+        uint32_t cost;
+        uint32_t weight;
+    };
+
+    using CachedNextHops = boost::container::small_vector<CachedNextHop, 4>;
+}
+
+Fib::Fib(const std::string &engine) : _index([&engine]() {
+    auto index = NameIndex<FibEntry>::create(engine);
+    return index ? std::move(index) : NameIndex<FibEntry>::create("tree");
+}), _mapping([]() {
+    return std::unique_ptr<Mapping>(new Mapping());
+}) {
+
+}
+
+std::string Fib::getEngine() const {
+    return _index.read([](const NameIndex<FibEntry> &index) {
+        return index.getEngine();
+    });
+}
+
+bool Fib::isAggregating() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _aggregation;
+}
+
+void Fib::setAggregation(bool aggregation) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (aggregation == _aggregation) {
+        return;
+    }
+    _aggregation = aggregation;
+    NameIndex<FibEntry>::Entries installs;
+    std::vector<ndn::Name> removals;
+    for (auto &route : _routes) {
+        place(route.first, route.second, false, installs, removals);
     }
+    _index.write([&](NameIndex<FibEntry> &index) {
+        for (const auto &prefix : removals) {
+            index.remove(prefix);
+        }
+        index.insert(installs, true);
+    });
+}
 
-    auto it = _faces.find(face);
-    if (it != _faces.end()) {
-        it->second.emplace_back(prefix);
-    } else {
-        _faces.emplace(face, std::vector<ndn::Name>{prefix});
+bool Fib::isCachingLookups() const {
+    return _is_caching.load(std::memory_order_relaxed);
+}
+
+void Fib::setLookupCache(bool is_caching) {
+    _is_caching.store(is_caching, std::memory_order_relaxed);
+}
+
+void Fib::setMapped(const std::shared_ptr<const MappedFib> &fib, const EndpointResolver &resolve) {
+    MappedFib::Faces faces;
+    if (fib) {
+        for (const auto &endpoint : fib->getEndpoints()) {
+            faces.emplace_back(resolve(endpoint));
+        }
+    }
+    _mapping.write([&fib, &faces](Mapping &mapping) {
+        mapping.fib = fib;
+        mapping.faces = faces;
+    });
+    _is_mapped.store(fib != nullptr);
+    // a new generation, the lookups cached from the previous mapping are computed again
+    _index.write([](NameIndex<FibEntry>&) {
+
+    });
+}
+
+std::shared_ptr<const MappedFib> Fib::getMapped() const {
+    return _mapping.read([](const Mapping &mapping) {
+        return mapping.fib;
+    });
+}
+
+void Fib::lookupMapped(const NameView &name, FaceTable::Faces &faces) const {
+    if (!_is_mapped.load(std::memory_order_relaxed)) {
+        return;
+    }
+    _mapping.read([&name, &faces](const Mapping &mapping) {
+        if (mapping.fib) {
+            mapping.fib->getFaces(name, mapping.faces, faces);
+        }
+    });
+}
+
+void Fib::lookupMapped(const NameView &name, bool longest_prefix, FibEntry::NextHops &next_hops) const {
+    if (!_is_mapped.load(std::memory_order_relaxed)) {
+        return;
+    }
+    _mapping.read([&name, longest_prefix, &next_hops](const Mapping &mapping) {
+        if (mapping.fib) {
+            mapping.fib->getNextHops(name, longest_prefix, mapping.faces, next_hops);
+        }
+    });
+}
+
+size_t Fib::getLogicalSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _routes.size();
+}
+
+size_t Fib::getPhysicalSize() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _installed;
+}
+
+const Fib::Route* Fib::findParent(const ndn::Name &prefix) const {
+    for (size_t length = prefix.size(); length-- > 0;) {
+        auto it = _routes.find(prefix.getPrefix(length));
+        if (it != _routes.end()) {
+            return &it->second;
+        }
     }
+    return nullptr;
 }
 
-std::set<std::shared_ptr<Face>> Fib::get(const ndn::Name &name) {
-    std::set<std::shared_ptr<Face>> faces;
-    auto list = _tree.findAllUntil(name);
-    for (auto& element : list) {
-        auto &&entry_faces = element.second->getFaces();
-        faces.insert(std::make_move_iterator(entry_faces.begin()), std::make_move_iterator(entry_faces.end()));
+void Fib::place(const ndn::Name &prefix, Route &route, bool is_changed, NameIndex<FibEntry>::Entries &installs,
+                std::vector<ndn::Name> &removals) {
+    // the lookups of all the modes give the same next hops whether such a route is there or not: a face of its
+    // entry is one of its parent with the same cost and weight, and the longest prefix falls back to the parent
+    const Route *parent = _aggregation ? findParent(prefix) : nullptr;
+    bool is_installed = !parent || !route.entry->hasSameNextHops(*parent->entry);
+    if (is_installed && (is_changed || !route.is_installed)) {
+        installs.emplace_back(prefix, route.entry);
+    } else if (!is_installed && route.is_installed) {
+        removals.emplace_back(prefix);
+    }
+    if (is_installed != route.is_installed) {
+        route.is_installed = is_installed;
+        is_installed ? ++_installed : --_installed;
     }
-    return faces;
+}
+
+void Fib::publish(const std::set<ndn::Name> &changed, std::vector<ndn::Name> removals) {
+    // a route compares to the nearest one above it, only the routes right below a change may fold or unfold
+    std::set<ndn::Name> prefixes(changed);
+    if (_aggregation) {
+        for (const auto &prefix : changed) {
+            auto it = _routes.upper_bound(prefix);
+            while (it != _routes.end() && prefix.isPrefixOf(it->first)) {
+                const ndn::Name &child = it->first;
+                prefixes.emplace(child);
+                // the routes below child compare to it or to those below it
+                do {
+                    ++it;
+                } while (it != _routes.end() && child.isPrefixOf(it->first));
+            }
+        }
+    }
+    NameIndex<FibEntry>::Entries installs;
+    for (const auto &prefix : prefixes) {
+        auto it = _routes.find(prefix);
+        if (it != _routes.end()) {
+            place(prefix, it->second, changed.count(prefix) != 0, installs, removals);
+        }
+    }
+    if (installs.empty() && removals.empty()) {
+        return;
+    }
+    // a single write, the readers are waited for once rather than for each prefix
+    _index.write([&](NameIndex<FibEntry> &index) {
+        for (const auto &prefix : removals) {
+            index.remove(prefix);
+        }
+        index.insert(installs, true);
+    });
+}
+
+void Fib::updateRoutes(const std::vector<ndn::Name> &prefixes, const std::function<void(FibEntry&)> &change) {
+    std::set<ndn::Name> changed;
+    std::vector<ndn::Name> removals;
+    for (const auto &prefix : prefixes) {
+        auto it = _routes.find(prefix);
+        if (it == _routes.end()) {
+            continue;
+        }
+        auto entry = std::make_shared<FibEntry>(*it->second.entry);
+        change(*entry);
+        if (entry->isValid()) {
+            it->second.entry = std::move(entry);
+        } else {
+            if (it->second.is_installed) {
+                removals.emplace_back(prefix);
+                --_installed;
+            }
+            _routes.erase(it);
+        }
+        changed.emplace(prefix);
+    }
+    publish(changed, std::move(removals));
+}
+
+void Fib::insert(const std::shared_ptr<Face> &face, const ndn::Name &prefix, uint32_t cost, uint32_t weight) {
+    insert(face, std::vector<ndn::Name>{prefix}, cost, weight);
+}
+
+void Fib::insert(const std::shared_ptr<Face> &face, const std::vector<ndn::Name> &prefixes, uint32_t cost, uint32_t weight) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::set<ndn::Name> changed;
+    for (const auto &prefix : prefixes) {
+        auto it = _routes.find(prefix);
+        if (it == _routes.end()) {
+            _routes.emplace(prefix, Route{std::make_shared<FibEntry>(face, cost, weight), false});
+        } else {
+            auto entry = std::make_shared<FibEntry>(*it->second.entry);
+            entry->addFace(prefix, face, cost, weight);
+            it->second.entry = std::move(entry);
+        }
+        changed.emplace(prefix);
+    }
+    _faces[face].insert(prefixes.begin(), prefixes.end());
+    // the new prefixes are bulk inserted
+    publish(changed, {});
+}
+
+FaceTable::Faces Fib::get(const NameView &name) const {
+    auto lookup = [this, &name](const NameIndex<FibEntry> &index) {
+        FaceTable::Faces faces;
+        auto list = index.findValuesUntil(name);
+        for (auto& entry : list) {
+            entry->getFaces(faces);
+        }
+        lookupMapped(name, faces);
+        return faces;
+    };
+    if (!isCachingLookups()) {
+        return _index.read(lookup);
+    }
+    return _index.readWithGeneration([&name, &lookup](const NameIndex<FibEntry> &index, uint64_t generation) {
+        thread_local DecisionCache<CachedFaces> cache;
+        FaceTable::Faces faces;
+        if (CachedFaces *cached = cache.find(name.getHash(), generation)) {
+            for (const auto &weak_face : *cached) {
+                auto face = weak_face.lock();
+                if (!face) {
+                    break;
+                }
+                faces.emplace_back(std::move(face));
+            }
+            if (faces.size() == cached->size()) {
+                return faces;
+            }
+            cache.erase(name.getHash());
+        }
+        faces = lookup(index);
+        cache.insert(name.getHash(), generation, CachedFaces(faces.begin(), faces.end()));
+        return faces;
+    });
+}
+
+void Fib::getNextHops(const NameView &name, bool longest_prefix, FibEntry::NextHops &next_hops) const {
+    auto lookup = [this, &name, longest_prefix, &next_hops](const NameIndex<FibEntry> &index) {
+        // from the shortest prefix to the longest one
+        auto list = index.findValuesUntil(name);
+        if (!longest_prefix) {
+            for (const auto &entry : list) {
+                entry->getNextHops(next_hops);
+            }
+            lookupMapped(name, false, next_hops);
+            return;
+        }
+        for (auto it = list.rbegin(); it != list.rend() && next_hops.empty(); ++it) {
+            (*it)->getNextHops(next_hops);
+        }
+        if (next_hops.empty()) {
+            lookupMapped(name, true, next_hops);
+        }
+    };
+    if (!isCachingLookups()) {
+        _index.read(lookup);
+        return;
+    }
+    _index.readWithGeneration([&](const NameIndex<FibEntry> &index, uint64_t generation) {
+        // one for each kind of lookup
+        thread_local DecisionCache<CachedNextHops> caches[2];
+        DecisionCache<CachedNextHops> &cache = caches[longest_prefix ? 1 : 0];
+        size_t size = next_hops.size();
+        if (CachedNextHops *cached = cache.find(name.getHash(), generation)) {
+            for (const auto &cached_next_hop : *cached) {
+                auto face = cached_next_hop.face.lock();
+                if (!face) {
+                    break;
+                }
+                next_hops.push_back(FibEntry::NextHop{std::move(face), cached_next_hop.cost, cached_next_hop.weight});
+            }
+            if (next_hops.size() - size == cached->size()) {
+                return;
+            }
+            next_hops.erase(next_hops.begin() + size, next_hops.end());
+            cache.erase(name.getHash());
+        }
+        lookup(index);
+        CachedNextHops computed;
+        for (auto it = next_hops.begin() + size; it != next_hops.end(); ++it) {
+            computed.push_back(CachedNextHop{it->face, it->cost, it->weight});
+        }
+        cache.insert(name.getHash(), generation, std::move(computed));
+    });
 }
 
 void Fib::remove(const std::shared_ptr<Face> &face) {
+    std::lock_guard<std::mutex> lock(_mutex);
     auto it = _faces.find(face);
     if (it != _faces.end()) {
-        for (const auto& name : it->second) {
-            _tree.remove(name);
-        }
+        // only the prefixes of the face are visited, the other faces of their entries keep their routes
+        std::vector<ndn::Name> prefixes(it->second.begin(), it->second.end());
         _faces.erase(it);
+        updateRoutes(prefixes, [&face](FibEntry &entry) {
+            entry.delFace(face);
+        });
     }
 }
 
 void Fib::remove(const std::shared_ptr<Face> &face, const ndn::Name &prefix) {
-    auto it = _tree.find(prefix);
-    it->delFace(face);
+    remove(face, std::vector<ndn::Name>{prefix});
+}
+
+void Fib::remove(const std::shared_ptr<Face> &face, const std::vector<ndn::Name> &prefixes) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    updateRoutes(prefixes, [&face](FibEntry &entry) {
+        entry.delFace(face);
+    });
+    auto it = _faces.find(face);
+    if (it != _faces.end()) {
+        for (const auto &prefix : prefixes) {
+            it->second.erase(prefix);
+        }
+        if (it->second.empty()) {
+            _faces.erase(it);
+        }
+    }
+}
+
+size_t Fib::removeExpiredFaces() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<ndn::Name> prefixes;
+    size_t removed = 0;
+    for (auto it = _faces.begin(); it != _faces.end();) {
+        if (it->first.expired()) {
+            prefixes.insert(prefixes.end(), it->second.begin(), it->second.end());
+            it = _faces.erase(it);
+            ++removed;
+        } else {
+            ++it;
+        }
+    }
+    if (!prefixes.empty()) {
+        updateRoutes(prefixes, [](FibEntry &entry) {
+            entry.removeExpiredFaces();
+        });
+    }
+    return removed;
 }
 
 bool Fib::isPrefix(const std::shared_ptr<Face> &face, const ndn::Name &name) const {
-    auto list = _tree.findAllUntil(name);
-    for (const auto& element : list) {
-        const auto &entry_faces = element.second->getFaces();
-        if (entry_faces.find(face) != entry_faces.end()) {
-            return true;
+    return _index.read([&](const NameIndex<FibEntry> &index) {
+        auto list = index.findValuesUntil(name);
+        for (const auto& entry : list) {
+            if (entry->hasFace(face)) {
+                return true;
+            }
+        }
+        return false;
+    });
+}
+
+bool Fib::hasRoute(const std::shared_ptr<Face> &face, const ndn::Name &prefix) const {
+    // a folded prefix has no entry in the index
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _routes.find(prefix);
+    return it != _routes.end() && it->second.entry->hasFace(face);
+}
+
+void Fib::forEachRoute(const std::function<void(const ndn::Name&, const FibEntry::NextHops&)> &visitor) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    FibEntry::NextHops next_hops;
+    for (const auto &route : _routes) {
+        next_hops.clear();
+        route.second.entry->getNextHops(next_hops);
+        if (!next_hops.empty()) {
+            visitor(route.first, next_hops);
+        }
+    }
+}
+
+void Fib::addMemoryStats(MemoryStats &stats) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    MemoryStats instance;
+    _index.read([&instance](const NameIndex<FibEntry> &index) {
+        index.addMemoryStats(instance, "fib_index");
+    });
+    stats.add(instance, 2);
+    size_t route_bytes = memory_usage::of(_routes);
+    for (const auto &route : _routes) {
+        route_bytes += memory_usage::of(route.first) + route.second.entry->getMemoryUsage();
+    }
+    stats.add("fib_routes", _routes.size(), route_bytes);
+    size_t face_bytes = memory_usage::of(_faces);
+    for (const auto &face : _faces) {
+        face_bytes += memory_usage::of(face.second);
+        for (const auto &prefix : face.second) {
+            face_bytes += memory_usage::of(prefix);
         }
     }
-    return false;
+    stats.add("fib_faces", _faces.size(), face_bytes);
+    auto mapped = getMapped();
+    if (mapped) {
+        stats.add("fib_mapped", mapped->getRoutes(), mapped->getBytes());
+    }
 }
 
 std::string Fib::toJSON() const {
-    return _tree.toJSON();
-}
\ No newline at end of file
+    return _index.read([](const NameIndex<FibEntry> &index) {
+        return index.toJSON();
+    });
+}
+
+void Fib::toJSON(NameIndex<FibEntry>::JsonWriter &writer) const {
+    _index.read([&writer](const NameIndex<FibEntry> &index) {
+        index.toJSON(writer);
+    });
+}
+
+bool Fib::writePage(NameIndex<FibEntry>::JsonWriter &writer, const rapidjson::StringBuffer &buffer, const ndn::Name *cursor,
+                    size_t limit, size_t max_bytes, ndn::Name &next) const {
+    return _index.read([&](const NameIndex<FibEntry> &index) {
+        return index.writePage(writer, buffer, cursor, limit, max_bytes, next);
+    });
+}
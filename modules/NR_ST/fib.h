@@ -3,34 +3,156 @@
 #include <ndn-cxx/interest.hpp>
 #include <ndn-cxx/data.hpp>
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <list>
+#include <map>
 #include <unordered_map>
+#include <mutex>
 #include <set>
 
-#include "tree/named_tree.h"
+#include "tree/left_right.h"
+#include "tree/name_index.h"
 #include "fib_entry.h"
+#include "mapped_fib.h"
 #include "network/face.h"
 
+// lookups can run on any thread of the module while routes are changed, see LeftRight. the routes given are kept
+// apart from the index, which only holds those installed: with aggregation, a route whose next hops are those of the
+// nearest route above it is folded into that one, lookups give the same next hops without its entry. it is installed
+// again as soon as they differ
+//
+// the routes of a MappedFib may be looked up as well, those shared by the replicas of a host: all the prefixes give
+// their next hops together, the longest prefix match only falls back on them when the routes given to this replica,
+// e.g. by its producers, have none
 class Fib {
+public:
+    // the face of the replica to an endpoint of a MappedFib, null if it has none
+    using EndpointResolver = std::function<std::shared_ptr<Face>(const std::string &endpoint)>;
+
 private:
-    NamedTree<FibEntry> _tree;
-    std::map<std::weak_ptr<Face>, std::vector<ndn::Name>, std::owner_less<std::weak_ptr<Face>>> _faces;
+    struct Route {
+        // never changed once installed, the two instances of the index share it and a change makes a copy
+        std::shared_ptr<FibEntry> entry;
+        bool is_installed;
+    };
+
+    LeftRight<NameIndex<FibEntry>> _index;
+    // the members below are only used by the writers
+    mutable std::mutex _mutex;
+    // prefixes of each face. a face is removed by visiting its own prefixes only, a route left without faces is
+    // removed with it
+    std::map<std::weak_ptr<Face>, std::set<ndn::Name>, std::owner_less<std::weak_ptr<Face>>> _faces;
+    // in canonical Name order, the routes below a prefix follow it
+    std::map<ndn::Name, Route> _routes;
+    bool _aggregation = false;
+    size_t _installed = 0;
+    // off by default, the lookups of each thread are then cached by exact Name, see DecisionCache
+    std::atomic<bool> _is_caching{false};
+
+    struct Mapping {
+        std::shared_ptr<const MappedFib> fib;
+        // by endpoint of fib
+        MappedFib::Faces faces;
+    };
+
+    // read by the lookups only while _is_mapped, which spares them the read otherwise
+    LeftRight<Mapping> _mapping;
+    std::atomic<bool> _is_mapped{false};
+
+    void lookupMapped(const NameView &name, FaceTable::Faces &faces) const;
+
+    void lookupMapped(const NameView &name, bool longest_prefix, FibEntry::NextHops &next_hops) const;
+
+    // the nearest route above prefix, null if there is none
+    const Route* findParent(const ndn::Name &prefix) const;
+
+    // route is folded or installed, the entry to install or the prefix to remove from the index is queued
+    void place(const ndn::Name &prefix, Route &route, bool is_changed, NameIndex<FibEntry>::Entries &installs,
+               std::vector<ndn::Name> &removals);
+
+    // the routes of changed and those right below them are placed again and the index is changed in a single write
+    void publish(const std::set<ndn::Name> &changed, std::vector<ndn::Name> removals);
+
+    // change is applied to a copy of the entry of each of the prefixes, a route left without faces is removed
+    void updateRoutes(const std::vector<ndn::Name> &prefixes, const std::function<void(FibEntry&)> &change);
 
 public:
-    Fib() = default;
+    // engine is "tree", "hash" or "static", see NameIndex
+    explicit Fib(const std::string &engine = "tree");
+
+    std::string getEngine() const;
+
+    bool isAggregating() const;
+
+    // the routes are folded or installed again at once
+    void setAggregation(bool aggregation);
+
+    bool isCachingLookups() const;
+
+    // get and getNextHops answer again the Names they were given since the last change of the routes without
+    // walking the index, but for those whose faces are gone meanwhile
+    void setLookupCache(bool is_caching);
+
+    // replaces the routes of the MappedFib looked up, none if fib is null, its endpoints are resolved once here. the
+    // lookups cached are dropped. called again with the same fib when the faces of the replica change
+    void setMapped(const std::shared_ptr<const MappedFib> &fib, const EndpointResolver &resolve);
+
+    // null if none
+    std::shared_ptr<const MappedFib> getMapped() const;
+
+    // the routes given
+    size_t getLogicalSize() const;
+
+    // the entries of the index, the routes which are not folded
+    size_t getPhysicalSize() const;
 
     ~Fib() = default;
 
-    void insert(const std::shared_ptr<Face> &face, const ndn::Name &prefix);
+    void insert(const std::shared_ptr<Face> &face, const ndn::Name &prefix, uint32_t cost = FibEntry::DEFAULT_COST,
+                uint32_t weight = FibEntry::DEFAULT_WEIGHT);
+
+    // routes of a single command, the new prefixes are bulk inserted
+    void insert(const std::shared_ptr<Face> &face, const std::vector<ndn::Name> &prefixes, uint32_t cost = FibEntry::DEFAULT_COST,
+                uint32_t weight = FibEntry::DEFAULT_WEIGHT);
+
+    // the faces of all the prefixes of name, each once
+    FaceTable::Faces get(const NameView &name) const;
 
-    std::set<std::shared_ptr<Face>> get(const ndn::Name &name);
+    // the next hops of all the prefixes of name, each face once with its lowest cost, or only those of the longest
+    // prefix which still has some
+    void getNextHops(const NameView &name, bool longest_prefix, FibEntry::NextHops &next_hops) const;
 
     void remove(const std::shared_ptr<Face>& face);
 
     void remove(const std::shared_ptr<Face>& face, const ndn::Name &prefix);
 
+    // routes of a single command, published at once
+    void remove(const std::shared_ptr<Face>& face, const std::vector<ndn::Name> &prefixes);
+
+    // the routes of the faces destroyed without being removed, returns the number of those faces
+    size_t removeExpiredFaces();
+
     bool isPrefix(const std::shared_ptr<Face> &face, const ndn::Name &name) const;
 
+    // true if prefix itself is routed to face, folded or not
+    bool hasRoute(const std::shared_ptr<Face> &face, const ndn::Name &prefix) const;
+
+    // every route given, folded or not, in canonical Name order with its next hops still alive, e.g. to hand them to
+    // a clone or to compile a MappedFib, whose routes aren't visited. the writers wait meanwhile
+    void forEachRoute(const std::function<void(const ndn::Name&, const FibEntry::NextHops&)> &visitor) const;
+
+    // "fib_index_..." of both instances of the index, "fib_routes" with their entries, shared by the index,
+    // "fib_faces" and "fib_mapped", the file shared with the other replicas. the writers wait meanwhile
+    void addMemoryStats(MemoryStats &stats) const;
+
+    // the installed entries only, as the listings below
     std::string toJSON() const;
+
+    void toJSON(NameIndex<FibEntry>::JsonWriter &writer) const;
+
+    // see NameIndex::writePage
+    bool writePage(NameIndex<FibEntry>::JsonWriter &writer, const rapidjson::StringBuffer &buffer, const ndn::Name *cursor,
+                   size_t limit, size_t max_bytes, ndn::Name &next) const;
 };
\ No newline at end of file
@@ -1,51 +1,113 @@
 #include "fib_entry.h"
 
-FibEntry::FibEntry(const std::shared_ptr<Face> &face) {
-    _faces.emplace(face);
+#include <algorithm>
+
+#include "metrics/memory_stats.h"
+
+FibEntry::FibEntry(const std::shared_ptr<Face> &face, uint32_t cost, uint32_t weight) {
+    _faces.emplace_back(FaceTable::global().getRef(face));
+    _metrics.emplace_back(Metric{cost, weight});
+}
+
+void FibEntry::getFaces(FaceTable::Faces &faces) const {
+    // readers run concurrently, the entry is only changed by the writers
+    FaceTable::global().resolve(_faces, faces);
 }
 
-std::set<std::shared_ptr<Face>> FibEntry::getFaces() {
-    std::set<std::shared_ptr<Face>> faces;
-    for (const auto& face : _faces) {
-        if (auto f = face.lock()) {
-            faces.insert(f);
-        } else {
-            _faces.erase(face);
+void FibEntry::getNextHops(NextHops &next_hops) const {
+    for (size_t i = 0; i < _faces.size(); ++i) {
+        auto face = FaceTable::global().resolve(_faces[i]);
+        if (!face) {
+            continue;
+        }
+        auto it = std::find_if(next_hops.begin(), next_hops.end(), [&face](const NextHop &next_hop) {
+            return next_hop.face == face;
+        });
+        if (it == next_hops.end()) {
+            next_hops.emplace_back(NextHop{face, _metrics[i].cost, _metrics[i].weight});
+        } else if (_metrics[i].cost < it->cost) {
+            it->cost = _metrics[i].cost;
+            it->weight = _metrics[i].weight;
         }
     }
-    return faces;
 }
 
-void FibEntry::addFace(const ndn::Name &name, const std::shared_ptr<Face> &face) {
-    _faces.emplace(face);
+bool FibEntry::hasFace(const std::shared_ptr<Face> &face) const {
+    return FaceTable::contains(_faces, FaceTable::global().getRef(face));
+}
+
+void FibEntry::addFace(const ndn::Name &name, const std::shared_ptr<Face> &face, uint32_t cost, uint32_t weight) {
+    auto ref = FaceTable::global().getRef(face);
+    auto it = std::find(_faces.begin(), _faces.end(), ref);
+    if (it != _faces.end()) {
+        _metrics[it - _faces.begin()] = Metric{cost, weight};
+    } else {
+        _faces.emplace_back(ref);
+        _metrics.emplace_back(Metric{cost, weight});
+    }
 }
 
 void FibEntry::delFace(const std::shared_ptr<Face> &face) {
-    _faces.erase(face);
+    auto it = std::find(_faces.begin(), _faces.end(), FaceTable::global().getRef(face));
+    if (it != _faces.end()) {
+        _metrics.erase(_metrics.begin() + (it - _faces.begin()));
+        _faces.erase(it);
+    }
+}
+
+void FibEntry::removeExpiredFaces() {
+    for (size_t i = _faces.size(); i-- > 0;) {
+        if (!FaceTable::global().resolve(_faces[i])) {
+            _metrics.erase(_metrics.begin() + i);
+            _faces.erase(_faces.begin() + i);
+        }
+    }
 }
 
 bool FibEntry::isValid() const {
     return !_faces.empty();
 }
 
-std::string FibEntry::toJSON() {
-    std::stringstream ss;
-    ss << R"({"faces": [)";
+bool FibEntry::hasSameNextHops(const FibEntry &other) const {
+    if (_faces.size() != other._faces.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < _faces.size(); ++i) {
+        auto it = std::find(other._faces.begin(), other._faces.end(), _faces[i]);
+        if (it == other._faces.end()) {
+            return false;
+        }
+        const Metric &metric = other._metrics[it - other._faces.begin()];
+        if (metric.cost != _metrics[i].cost || metric.weight != _metrics[i].weight) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t FibEntry::getMemoryUsage() const {
+    return memory_usage::ofShared<FibEntry>() + memory_usage::of(_faces) + memory_usage::of(_metrics);
+}
+
+std::string FibEntry::toJSON() const {
+    // faces[i] has costs[i] and weights[i]
+    std::stringstream faces, costs, weights;
     bool first_face = true;
-    auto it = _faces.cbegin();
-    while (it != _faces.cend()) {
-        if (auto face = it->lock()) {
+    for (size_t i = 0; i < _faces.size(); ++i) {
+        if (auto face = FaceTable::global().resolve(_faces[i])) {
             if (first_face) {
                 first_face = false;
             } else {
-                ss << ", ";
+                faces << ", ";
+                costs << ", ";
+                weights << ", ";
             }
-            ss << face->getFaceId();
-            ++it;
-        } else {
-            it = _faces.erase(it);
+            faces << face->getFaceId();
+            costs << _metrics[i].cost;
+            weights << _metrics[i].weight;
         }
     }
-    ss << R"(]})";
+    std::stringstream ss;
+    ss << R"({"faces": [)" << faces.str() << R"(], "costs": [)" << costs.str() << R"(], "weights": [)" << weights.str() << "]}";
     return ss.str();
 }
\ No newline at end of file
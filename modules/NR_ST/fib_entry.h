@@ -2,27 +2,67 @@
 
 #include <ndn-cxx/interest.hpp>
 
+#include <boost/container/small_vector.hpp>
+
 #include <memory>
-#include <set>
 
 #include "network/face.h"
+#include "network/face_table.h"
 
 class FibEntry {
+public:
+    static const uint32_t DEFAULT_COST = 0;
+    static const uint32_t DEFAULT_WEIGHT = 1;
+
+    // the lowest cost is preferred, the next hops of the same cost share the Interests by weight
+    struct NextHop {
+        std::shared_ptr<Face> face;
+        uint32_t cost;
+        uint32_t weight;
+    };
+
+    using NextHops = boost::container::small_vector<NextHop, 4>;
+
 private:
-    std::set<std::weak_ptr<Face>, std::owner_less<std::weak_ptr<Face>>> _faces;
+    struct Metric {
+        uint32_t cost;
+        uint32_t weight;
+    };
+
+    // resolved through FaceTable::global(), nothing is allocated for a few faces
+    FaceTable::Refs _faces;
+    // by index in _faces
+    boost::container::small_vector<Metric, 4> _metrics;
 
 public:
-    explicit FibEntry(const std::shared_ptr<Face> &face);
+    explicit FibEntry(const std::shared_ptr<Face> &face, uint32_t cost = DEFAULT_COST, uint32_t weight = DEFAULT_WEIGHT);
 
     ~FibEntry() = default;
 
-    std::set<std::shared_ptr<Face>> getFaces();
+    // the faces are appended to faces unless already there. expired faces are skipped, they are removed with their
+    // prefixes by Fib::remove
+    void getFaces(FaceTable::Faces &faces) const;
 
-    void addFace(const ndn::Name &name, const std::shared_ptr<Face> &face);
+    // the next hops still alive are appended to next_hops, a face already there keeps the lowest of its costs
+    void getNextHops(NextHops &next_hops) const;
+
+    bool hasFace(const std::shared_ptr<Face> &face) const;
+
+    // the cost and weight of a face already there are updated
+    void addFace(const ndn::Name &name, const std::shared_ptr<Face> &face, uint32_t cost = DEFAULT_COST, uint32_t weight = DEFAULT_WEIGHT);
 
     void delFace(const std::shared_ptr<Face> &face);
 
+    // the refs of the faces gone, which getFaces skips otherwise on each lookup
+    void removeExpiredFaces();
+
     bool isValid() const;
 
-    std::string toJSON();
+    // the same faces with the same costs and weights, in any order
+    bool hasSameNextHops(const FibEntry &other) const;
+
+    // of an entry made with std::make_shared, as the routes are
+    size_t getMemoryUsage() const;
+
+    std::string toJSON() const;
 };
\ No newline at end of file
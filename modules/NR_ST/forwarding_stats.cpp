@@ -0,0 +1,128 @@
+#include "forwarding_stats.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "metrics/memory_stats.h"
+
+ForwardingStats::ForwardingStats(size_t prefix_length, size_t max_prefixes)
+        : _prefix_length(prefix_length)
+        , _max_prefixes(max_prefixes)
+        , _since(Clock::now()) {
+
+}
+
+ForwardingStats::Slot& ForwardingStats::getSlot() {
+    static std::atomic<size_t> next(0);
+    static thread_local size_t slot = next++ % SLOTS;
+    return _slots[slot];
+}
+
+size_t ForwardingStats::getPrefixLength() const {
+    return _prefix_length.load(std::memory_order_relaxed);
+}
+
+void ForwardingStats::setPrefixLength(size_t prefix_length) {
+    _prefix_length.store(prefix_length, std::memory_order_relaxed);
+}
+
+void ForwardingStats::record(const NameView &name, const Clock::duration &lookup, size_t faces) {
+    size_t length = std::min(_prefix_length.load(std::memory_order_relaxed), name.size());
+    uint64_t hash = name.getPrefixHash(length);
+    auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(ndn::time::duration_cast<ndn::time::nanoseconds>(lookup).count(), 0));
+    Slot &slot = getSlot();
+    std::lock_guard<std::mutex> lock(slot.mutex);
+    ++slot.interests;
+    slot.faces += faces;
+    if (faces == 0) {
+        ++slot.unrouted;
+    }
+    slot.lookups->record(nanoseconds);
+    auto it = slot.prefixes.find(hash);
+    if (it != slot.prefixes.end()) {
+        ++it->second.interests;
+    } else if (slot.prefixes.size() < _max_prefixes) {
+        slot.prefixes.emplace(hash, Prefix{name.toName().getPrefix(length), 1});
+    } else {
+        ++slot.untracked;
+    }
+}
+
+std::string ForwardingStats::takeReport(const Clock::time_point &now) {
+    uint64_t interests = 0, faces = 0, unrouted = 0, untracked = 0;
+    LatencyHistogram lookups;
+    std::unordered_map<uint64_t, Prefix> prefixes;
+    for (auto &slot : _slots) {
+        std::unique_ptr<LatencyHistogram> slot_lookups(new LatencyHistogram());
+        std::unordered_map<uint64_t, Prefix> slot_prefixes;
+        {
+            std::lock_guard<std::mutex> lock(slot.mutex);
+            interests += slot.interests;
+            faces += slot.faces;
+            unrouted += slot.unrouted;
+            untracked += slot.untracked;
+            slot.interests = slot.faces = slot.unrouted = slot.untracked = 0;
+            slot.lookups.swap(slot_lookups);
+            slot.prefixes.swap(slot_prefixes);
+        }
+        // summed out of the lock, the thread of the slot goes on meanwhile
+        lookups.add(*slot_lookups);
+        for (auto &prefix : slot_prefixes) {
+            auto it = prefixes.find(prefix.first);
+            if (it == prefixes.end()) {
+                prefixes.emplace(prefix.first, std::move(prefix.second));
+            } else {
+                it->second.interests += prefix.second.interests;
+            }
+        }
+    }
+    auto interval = std::max<int64_t>(ndn::time::duration_cast<ndn::time::milliseconds>(now - _since).count(), 1);
+    _since = now;
+    double seconds = interval / 1000.0;
+
+    std::vector<const Prefix*> hottest;
+    for (const auto &prefix : prefixes) {
+        hottest.emplace_back(&prefix.second);
+    }
+    size_t reported = std::min(hottest.size(), REPORTED_PREFIXES);
+    std::partial_sort(hottest.begin(), hottest.begin() + reported, hottest.end(), [](const Prefix *a, const Prefix *b) {
+        return a->interests > b->interests;
+    });
+    uint64_t routed = interests - unrouted;
+    std::stringstream ss;
+    ss << R"({"interval_ms":)" << interval << R"(, "interests_count":)" << interests << R"(, "interests_per_second":)" << interests / seconds
+       << R"(, "unrouted_count":)" << unrouted << R"(, "fan_out":)" << (routed > 0 ? static_cast<double>(faces) / routed : 0.0)
+       << R"(, "lookup_ns":{"count":)" << lookups.getCount() << R"(, "p50":)" << lookups.getQuantile(0.5) << R"(, "p90":)" << lookups.getQuantile(0.9)
+       << R"(, "p99":)" << lookups.getQuantile(0.99) << R"(, "p999":)" << lookups.getQuantile(0.999) << R"(}, "prefixes":[)";
+    for (size_t i = 0; i < reported; ++i) {
+        if (i > 0) {
+            ss << ", ";
+        }
+        ss << R"({"prefix":")" << hottest[i]->prefix.toUri() << R"(", "interests_count":)" << hottest[i]->interests
+           << R"(, "interests_per_second":)" << hottest[i]->interests / seconds << "}";
+    }
+    ss << R"(], "untracked_count":)" << untracked << "}";
+    return ss.str();
+}
+
+size_t ForwardingStats::getPrefixes() {
+    size_t prefixes = 0;
+    for (auto &slot : _slots) {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        prefixes += slot.prefixes.size();
+    }
+    return prefixes;
+}
+
+size_t ForwardingStats::getMemoryUsage() {
+    size_t bytes = 0;
+    for (auto &slot : _slots) {
+        std::lock_guard<std::mutex> lock(slot.mutex);
+        bytes += sizeof(LatencyHistogram) + memory_usage::of(slot.prefixes);
+        for (const auto &prefix : slot.prefixes) {
+            bytes += memory_usage::of(prefix.second.prefix);
+        }
+    }
+    return bytes;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "network/face_stats.h"
+#include "network/name_view.h"
+
+// what the forwarding threads did between two reports: the Interests by prefix of their Name, the time taken by the
+// FIB lookup and the fan-out, the faces an Interest is sent to. each thread records in a slot of its own, the report
+// sums the slots and starts them over. only the first max_prefixes prefixes met by a slot in an interval are
+// followed, the Interests of the others are only counted
+class ForwardingStats {
+public:
+    using Clock = ndn::time::steady_clock;
+
+    static const size_t DEFAULT_PREFIX_LENGTH = 2;
+    static const size_t DEFAULT_MAX_PREFIXES = 64;
+    // the prefixes with the most Interests in a report
+    static const size_t REPORTED_PREFIXES = 8;
+
+private:
+    // threads are spread on the slots as on the indicators of LeftRight
+    static const size_t SLOTS = 16;
+
+    struct Prefix {
+        ndn::Name prefix;
+        uint64_t interests;
+    };
+
+    struct alignas(64) Slot {
+        std::mutex mutex;
+        // by name_hash of the prefix
+        std::unordered_map<uint64_t, Prefix> prefixes;
+        uint64_t interests = 0;
+        // the faces the Interests were sent to, summed
+        uint64_t faces = 0;
+        uint64_t unrouted = 0;
+        uint64_t untracked = 0;
+        // in nanoseconds, a lookup seldom takes a microsecond
+        std::unique_ptr<LatencyHistogram> lookups{new LatencyHistogram()};
+    };
+
+    Slot _slots[SLOTS];
+    std::atomic<size_t> _prefix_length;
+    size_t _max_prefixes;
+    // start of the interval, only used by the report
+    Clock::time_point _since;
+
+    Slot& getSlot();
+
+public:
+    explicit ForwardingStats(size_t prefix_length = DEFAULT_PREFIX_LENGTH, size_t max_prefixes = DEFAULT_MAX_PREFIXES);
+
+    ForwardingStats(const ForwardingStats&) = delete;
+
+    ForwardingStats& operator=(const ForwardingStats&) = delete;
+
+    size_t getPrefixLength() const;
+
+    // the prefixes of the current interval may have both lengths
+    void setPrefixLength(size_t prefix_length);
+
+    // from any thread, faces is 0 for an Interest without route
+    void record(const NameView &name, const Clock::duration &lookup, size_t faces);
+
+    // {"interval_ms", "interests_count", "interests_per_second", "unrouted_count", "fan_out", "lookup_ns",
+    // "prefixes": [{"prefix", "interests_count", "interests_per_second"}], "untracked_count"} of the interval which
+    // ends now, the next one starts
+    std::string takeReport(const Clock::time_point &now = Clock::now());
+
+    // the prefixes counted so far in the slots
+    size_t getPrefixes();
+
+    // of the prefixes and the histograms of the slots
+    size_t getMemoryUsage();
+};
\ No newline at end of file
@@ -0,0 +1,377 @@
+#include "mapped_fib.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "network/name_hash.h"
+#include "network/tlv_reader.h"
+
+const char MappedFib::MAGIC[8] = {'N', 'D', 'N', 'F', 'I', 'B', '\0', '1'};
+
+namespace {
+    void appendU32(std::string &out, uint32_t value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void align(std::string &out) {
+        out.append((8 - out.size() % 8) % 8, '\0');
+    }
+
+    uint32_t readU32(const uint8_t *it) {
+        uint32_t value;
+        std::memcpy(&value, it, sizeof(value));
+        return value;
+    }
+
+    // the smallest power of 2 above twice count, a probe always ends on an empty slot
+    size_t slotsFor(size_t count) {
+        size_t slots = 2;
+        while (slots <= 2 * count) {
+            slots <<= 1;
+        }
+        return slots;
+    }
+}
+
+void MappedFib::Builder::add(const ndn::Name &prefix, const FibEntry::NextHops &next_hops) {
+    std::vector<uint32_t> hops;
+    for (const auto &next_hop : next_hops) {
+        std::string endpoint = next_hop.face->getUnderlyingEndpoint();
+        auto it = _endpoints.find(endpoint);
+        if (it == _endpoints.end()) {
+            it = _endpoints.emplace(endpoint, static_cast<uint32_t>(_endpoint_list.size())).first;
+            _endpoint_list.push_back(endpoint);
+        }
+        hops.insert(hops.end(), {it->second, next_hop.cost, next_hop.weight});
+    }
+    _routes.emplace_back(prefix, std::move(hops));
+}
+
+std::string MappedFib::Builder::build(uint64_t version) const {
+    std::string out(sizeof(Header), '\0');
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = version;
+    header.routes = _routes.size();
+    header.endpoints = static_cast<uint32_t>(_endpoint_list.size());
+    header.endpoints_offset = out.size();
+    for (const auto &endpoint : _endpoint_list) {
+        appendU32(out, static_cast<uint32_t>(endpoint.size()));
+        out.append(endpoint);
+    }
+    align(out);
+    size_t tables = 0;
+    for (const auto &route : _routes) {
+        tables = std::max(tables, route.first.size() + 1);
+    }
+    header.tables = static_cast<uint32_t>(tables);
+    header.tables_offset = out.size();
+    out.append(tables * sizeof(Table), '\0');
+    // the records, and the slots of each length once they are all placed
+    std::vector<std::vector<Slot>> slots(tables);
+    std::vector<size_t> counts(tables, 0);
+    for (const auto &route : _routes) {
+        ++counts[route.first.size()];
+    }
+    for (size_t length = 0; length < tables; ++length) {
+        if (counts[length] != 0) {
+            slots[length].assign(slotsFor(counts[length]), Slot{0, 0});
+        }
+    }
+    for (const auto &route : _routes) {
+        const ndn::Block &name = route.first.wireEncode();
+        std::vector<Slot> &table = slots[route.first.size()];
+        size_t mask = table.size() - 1;
+        uint64_t hash = name_hash::hash(route.first);
+        size_t i = hash & mask;
+        while (table[i].record != 0) {
+            i = (i + 1) & mask;
+        }
+        table[i] = Slot{hash, out.size()};
+        out.append(reinterpret_cast<const char*>(name.wire()), name.size());
+        appendU32(out, static_cast<uint32_t>(route.second.size() / 3));
+        for (uint32_t value : route.second) {
+            appendU32(out, value);
+        }
+    }
+    align(out);
+    for (size_t length = 0; length < tables; ++length) {
+        Table table{0, slots[length].size()};
+        if (!slots[length].empty()) {
+            table.slots_offset = out.size();
+            out.append(reinterpret_cast<const char*>(slots[length].data()), slots[length].size() * sizeof(Slot));
+        }
+        std::memcpy(&out[header.tables_offset + length * sizeof(Table)], &table, sizeof(Table));
+    }
+    header.size = out.size();
+    std::memcpy(&out[0], &header, sizeof(Header));
+    return out;
+}
+
+MappedFib::~MappedFib() {
+    if (_base) {
+        ::munmap(const_cast<uint8_t*>(_base), _size);
+    }
+}
+
+bool MappedFib::publish(const std::string &path, const std::string &image, std::string &error) {
+    std::string next = path + ".next";
+    int fd = ::open(next.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    size_t written = 0;
+    while (written < image.size()) {
+        ssize_t n = ::write(fd, image.data() + written, image.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            error = std::strerror(errno);
+            ::close(fd);
+            ::unlink(next.c_str());
+            return false;
+        }
+        written += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    // the replicas open either the previous inode or this one, never a file being written
+    if (::rename(next.c_str(), path.c_str()) != 0) {
+        error = std::strerror(errno);
+        ::unlink(next.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const MappedFib> MappedFib::open(const std::string &path, std::string &error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = std::strerror(errno);
+        return nullptr;
+    }
+    struct stat status;
+    if (::fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(Header)) {
+        error = "not a mapped FIB";
+        ::close(fd);
+        return nullptr;
+    }
+    void *address = ::mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        error = std::strerror(errno);
+        return nullptr;
+    }
+    std::shared_ptr<MappedFib> fib(new MappedFib());
+    fib->_base = static_cast<const uint8_t*>(address);
+    fib->_size = static_cast<size_t>(status.st_size);
+    fib->_device = status.st_dev;
+    fib->_inode = status.st_ino;
+    if (!fib->validate(error)) {
+        return nullptr;
+    }
+    return fib;
+}
+
+bool MappedFib::validate(std::string &error) {
+    error = "invalid mapped FIB";
+    _header = reinterpret_cast<const Header*>(_base);
+    if (std::memcmp(_header->magic, MAGIC, sizeof(MAGIC)) != 0 || _header->size != _size) {
+        return false;
+    }
+    if (_header->tables_offset % 8 != 0 || _header->tables_offset > _size
+        || _header->tables > (_size - _header->tables_offset) / sizeof(Table)) {
+        return false;
+    }
+    _tables = reinterpret_cast<const Table*>(_base + _header->tables_offset);
+    size_t offset = _header->endpoints_offset;
+    for (uint32_t i = 0; i < _header->endpoints; ++i) {
+        if (offset > _size || _size - offset < sizeof(uint32_t)) {
+            return false;
+        }
+        uint32_t length = readU32(_base + offset);
+        offset += sizeof(uint32_t);
+        if (length > _size - offset) {
+            return false;
+        }
+        _endpoints.emplace_back(reinterpret_cast<const char*>(_base + offset), length);
+        offset += length;
+    }
+    const uint8_t *end = _base + _size;
+    uint64_t routes = 0;
+    for (uint32_t length = 0; length < _header->tables; ++length) {
+        const Table &table = _tables[length];
+        if (table.slots == 0) {
+            continue;
+        }
+        if ((table.slots & (table.slots - 1)) != 0 || table.slots_offset % 8 != 0 || table.slots_offset > _size
+            || table.slots > (_size - table.slots_offset) / sizeof(Slot)) {
+            return false;
+        }
+        const Slot *slots = reinterpret_cast<const Slot*>(_base + table.slots_offset);
+        bool has_empty = false;
+        for (uint64_t i = 0; i < table.slots; ++i) {
+            if (slots[i].record == 0) {
+                has_empty = true;
+                continue;
+            }
+            if (slots[i].record >= _size) {
+                return false;
+            }
+            try {
+                const uint8_t *it = _base + slots[i].record;
+                uint32_t type;
+                size_t name_length = tlv_reader::readHeader(it, end, type);
+                if (type != ndn::tlv::Name) {
+                    return false;
+                }
+                const uint8_t *name_end = it + name_length;
+                size_t components = 0;
+                while (it != name_end) {
+                    size_t component_length = tlv_reader::readHeader(it, name_end, type);
+                    it += component_length;
+                    ++components;
+                }
+                if (components != length || end - it < 4) {
+                    return false;
+                }
+                uint32_t next_hops = readU32(it);
+                it += 4;
+                if (next_hops > static_cast<size_t>(end - it) / 12) {
+                    return false;
+                }
+                for (uint32_t j = 0; j < next_hops; ++j) {
+                    if (readU32(it + 12 * j) >= _header->endpoints) {
+                        return false;
+                    }
+                }
+            } catch (const ndn::tlv::Error&) {
+                return false;
+            }
+            ++routes;
+        }
+        if (!has_empty) {
+            return false;
+        }
+    }
+    if (routes != _header->routes) {
+        return false;
+    }
+    error.clear();
+    return true;
+}
+
+uint64_t MappedFib::getVersion() const {
+    return _header->version;
+}
+
+size_t MappedFib::getRoutes() const {
+    return _header->routes;
+}
+
+size_t MappedFib::getBytes() const {
+    return _size;
+}
+
+bool MappedFib::isCurrent(const std::string &path) const {
+    struct stat status;
+    return ::stat(path.c_str(), &status) == 0 && status.st_dev == _device && status.st_ino == _inode;
+}
+
+const uint8_t* MappedFib::findRecord(const NameView &name, size_t length) const {
+    if (length >= _header->tables || _tables[length].slots == 0) {
+        return nullptr;
+    }
+    const Table &table = _tables[length];
+    const Slot *slots = reinterpret_cast<const Slot*>(_base + table.slots_offset);
+    size_t mask = table.slots - 1;
+    uint64_t hash = name.getPrefixHash(length);
+    const uint8_t *end = _base + _size;
+    for (size_t i = hash & mask; slots[i].record != 0; i = (i + 1) & mask) {
+        if (slots[i].hash != hash) {
+            continue;
+        }
+        // validated, the record holds length components
+        const uint8_t *it = _base + slots[i].record;
+        uint32_t type;
+        tlv_reader::readHeader(it, end, type);
+        bool is_match = true;
+        for (size_t j = 0; j < length && is_match; ++j) {
+            size_t component_length = tlv_reader::readHeader(it, end, type);
+            NameComponentRef component = name[j];
+            is_match = type == component.type && component_length == component.length
+                       && (component_length == 0 || std::memcmp(it, component.value, component_length) == 0);
+            it += component_length;
+        }
+        if (is_match) {
+            return _base + slots[i].record;
+        }
+    }
+    return nullptr;
+}
+
+void MappedFib::appendNextHops(const uint8_t *record, const Faces &faces, FibEntry::NextHops &next_hops) const {
+    uint32_t type;
+    size_t name_length = tlv_reader::readHeader(record, _base + _size, type);
+    record += name_length;
+    uint32_t count = readU32(record);
+    record += 4;
+    for (uint32_t i = 0; i < count; ++i, record += 12) {
+        uint32_t endpoint = readU32(record);
+        if (endpoint >= faces.size()) {
+            continue;
+        }
+        auto face = faces[endpoint].lock();
+        if (!face) {
+            continue;
+        }
+        uint32_t cost = readU32(record + 4);
+        auto it = std::find_if(next_hops.begin(), next_hops.end(), [&face](const FibEntry::NextHop &next_hop) {
+            return next_hop.face == face;
+        });
+        if (it == next_hops.end()) {
+            next_hops.emplace_back(FibEntry::NextHop{std::move(face), cost, readU32(record + 8)});
+        } else if (cost < it->cost) {
+            it->cost = cost;
+            it->weight = readU32(record + 8);
+        }
+    }
+}
+
+void MappedFib::getFaces(const NameView &name, const Faces &faces, FaceTable::Faces &out) const {
+    FibEntry::NextHops next_hops;
+    getNextHops(name, false, faces, next_hops);
+    for (auto &next_hop : next_hops) {
+        if (std::find(out.begin(), out.end(), next_hop.face) == out.end()) {
+            out.emplace_back(std::move(next_hop.face));
+        }
+    }
+}
+
+void MappedFib::getNextHops(const NameView &name, bool longest_prefix, const Faces &faces, FibEntry::NextHops &next_hops) const {
+    if (_header->tables == 0) {
+        return;
+    }
+    size_t max_length = std::min<size_t>(name.size(), _header->tables - 1);
+    if (!longest_prefix) {
+        for (size_t length = 0; length <= max_length; ++length) {
+            if (const uint8_t *record = findRecord(name, length)) {
+                appendNextHops(record, faces, next_hops);
+            }
+        }
+        return;
+    }
+    size_t size = next_hops.size();
+    for (size_t length = max_length + 1; length-- > 0 && next_hops.size() == size;) {
+        if (const uint8_t *record = findRecord(name, length)) {
+            appendNextHops(record, faces, next_hops);
+        }
+    }
+}
\ No newline at end of file
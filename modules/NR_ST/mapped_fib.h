@@ -0,0 +1,128 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "fib_entry.h"
+#include "network/face_table.h"
+#include "network/name_view.h"
+
+// routes compiled into a file which the replicas of a host map read-only: they are held once in the page cache
+// whatever the number of replicas, and a new replica routes as soon as it mapped the file rather than once the
+// manager sent it every route. a version is never changed, the next one is written aside and renamed over it, a
+// replica keeps the version it mapped until it maps the new one
+//
+//   Header, then the endpoints, the tables and the records, each aligned on 8 bytes
+//   Endpoint = uint32 length, the bytes of Face::getUnderlyingEndpoint()
+//   Table    = by prefix length, 0 for the root: the offset of its slots and their number, a power of 2 above twice
+//              the routes of that length, probed linearly from the name_hash of the prefix
+//   Slot     = the name_hash of the prefix, the offset of its record, 0 for an empty slot
+//   Record   = the Name TLV, then uint32 next hops and uint32 endpoint, cost and weight for each
+//
+// the integers are in the byte order of the host, the file isn't meant to leave it
+class MappedFib {
+public:
+    // the faces of the replica by endpoint of the file, empty for the endpoints it has no face to
+    using Faces = std::vector<std::weak_ptr<Face>>;
+
+    // the routes of a Fib, see Fib::forEachRoute
+    class Builder {
+    private:
+        std::map<std::string, uint32_t> _endpoints;
+        std::vector<std::string> _endpoint_list;
+        std::vector<std::pair<ndn::Name, std::vector<uint32_t>>> _routes;
+
+    public:
+        void add(const ndn::Name &prefix, const FibEntry::NextHops &next_hops);
+
+        size_t getRoutes() const {
+            return _routes.size();
+        }
+
+        std::string build(uint64_t version) const;
+    };
+
+private:
+    struct Header {
+        char magic[8];
+        uint64_t version;
+        uint64_t size;
+        uint64_t routes;
+        uint32_t endpoints;
+        uint32_t tables;
+        uint64_t endpoints_offset;
+        uint64_t tables_offset;
+    };
+
+    struct Table {
+        uint64_t slots_offset;
+        uint64_t slots;
+    };
+
+    struct Slot {
+        uint64_t hash;
+        uint64_t record;
+    };
+
+    static const char MAGIC[8];
+
+    const uint8_t *_base = nullptr;
+    size_t _size = 0;
+    const Header *_header = nullptr;
+    const Table *_tables = nullptr;
+    std::vector<std::string> _endpoints;
+    // of the file mapped, see isCurrent
+    dev_t _device = 0;
+    ino_t _inode = 0;
+
+    MappedFib() = default;
+
+    // every offset and record checked once, the lookups then trust them
+    bool validate(std::string &error);
+
+    // the record of the prefix of name of length components, null if it has no route
+    const uint8_t* findRecord(const NameView &name, size_t length) const;
+
+    // the next hops of record whose face is alive, a face already there keeps the lowest of its costs
+    void appendNextHops(const uint8_t *record, const Faces &faces, FibEntry::NextHops &next_hops) const;
+
+public:
+    MappedFib(const MappedFib&) = delete;
+
+    MappedFib& operator=(const MappedFib&) = delete;
+
+    ~MappedFib();
+
+    // image written next to path and renamed over it, the replicas mapping path see either version whole. false
+    // with error set if it can't be written
+    static bool publish(const std::string &path, const std::string &image, std::string &error);
+
+    // null with error set if path can't be mapped or isn't a valid image
+    static std::shared_ptr<const MappedFib> open(const std::string &path, std::string &error);
+
+    uint64_t getVersion() const;
+
+    size_t getRoutes() const;
+
+    size_t getBytes() const;
+
+    const std::vector<std::string>& getEndpoints() const {
+        return _endpoints;
+    }
+
+    // false once a new version was published at path
+    bool isCurrent(const std::string &path) const;
+
+    // as FibEntry::getFaces for all the prefixes of name
+    void getFaces(const NameView &name, const Faces &faces, FaceTable::Faces &out) const;
+
+    // as Fib::getNextHops
+    void getNextHops(const NameView &name, bool longest_prefix, const Faces &faces, FibEntry::NextHops &next_hops) const;
+};
\ No newline at end of file
@@ -2,53 +2,240 @@
 
 #include <boost/bind.hpp>
 
+#include <algorithm>
+#include <map>
+#include <tuple>
+
 #include "base64.h"
 
 #include "network/tcp_master_face.h"
 #include "network/tcp_face.h"
 #include "network/udp_master_face.h"
 #include "network/udp_face.h"
+#include "network/shm_master_face.h"
+#include "network/shm_face.h"
+#include "network/page_arena.h"
 #include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+#include "log/probes.h"
+#include "metrics/stage_profile.h"
+#include "network/state_transfer.h"
+#include "network/tlv_reader.h"
+#include "tree/name_snapshot.h"
+
+const boost::posix_time::seconds NameRouter::REQUEST_TIMEOUT {5};
 
-NameRouter::NameRouter(const std::string &name, uint16_t local_consumer_port, uint16_t local_producer_port, uint16_t local_command_port)
-        : Module(1)
+NameRouter::NameRouter(const std::string &name, uint16_t local_consumer_port, uint16_t local_producer_port, uint16_t local_command_port,
+                       const std::string &fib_engine, size_t concurrency, Runtime runtime)
+        : Module(concurrency, runtime)
         , _name(name)
-        , _command_socket(_ios, {{}, local_command_port}) {
-    _tcp_consumer_master_face = std::make_shared<TcpMasterFace>(_ios, 16, local_consumer_port);
-    _udp_consumer_master_face = std::make_shared<UdpMasterFace>(_ios, 16, local_consumer_port);
-    _tcp_producer_master_face = std::make_shared<TcpMasterFace>(_ios, 16, local_producer_port);
-    _udp_producer_master_face = std::make_shared<UdpMasterFace>(_ios, 16, local_producer_port);
+        , _fib(fib_engine)
+        , _command_socket(_control_ios, {{}, local_command_port})
+        , _connection_pool(_ios)
+        , _control_strand(_control_ios)
+        , _reply_signer(new ReplySigner(ReplySigner::KEYCHAIN))
+        , _registration_timer(_control_ios)
+        , _return_timer(_control_ios)
+        , _report_timer(_control_ios)
+        , _delay_between_report(0) {
+    // in PINNED the TCP faces and those of add_face are spread over the cores, UDP and SHM stay on _ios. each core
+    // accepts the TCP faces it runs
+    std::vector<boost::asio::io_service*> acceptor_services;
+    for (const auto &core_service : _core_services) {
+        acceptor_services.push_back(core_service.get());
+    }
+    auto tcp_consumer_master_face = std::make_shared<TcpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_consumer_port);
+    tcp_consumer_master_face->setAcceptorServices(acceptor_services);
+    _tcp_consumer_master_face = tcp_consumer_master_face;
+    _udp_consumer_master_face = std::make_shared<UdpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_consumer_port);
+    _shm_consumer_master_face = std::make_shared<ShmMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_consumer_port);
+    auto tcp_producer_master_face = std::make_shared<TcpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_producer_port);
+    tcp_producer_master_face->setAcceptorServices(acceptor_services);
+    _tcp_producer_master_face = tcp_producer_master_face;
+    _udp_producer_master_face = std::make_shared<UdpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_producer_port);
+    _shm_producer_master_face = std::make_shared<ShmMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_producer_port);
+    _lookup_latency = _metrics.addHistogram("ndn_fib_lookup_microseconds", "time of the FIB lookups of the Interests",
+                                            {0.25, 0.5, 1, 2, 5, 10, 20, 50, 100, 1000});
+    _metrics.addCollector(boost::bind(&NameRouter::writeMetrics, this, _1));
+}
+
+bool NameRouter::loadStartupConfig(const std::string &source) {
+    return _startup_config.load(source);
+}
+
+bool NameRouter::setReplySigning(const std::string &spec) {
+    std::unique_ptr<ReplySigner> reply_signer = ReplySigner::create(spec);
+    if (!reply_signer) {
+        return false;
+    }
+    _reply_signer = std::move(reply_signer);
+    return true;
 }
 
 void NameRouter::run() {
-    commandRead();
-    _tcp_consumer_master_face->listen(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2),
-                                      boost::bind(&NameRouter::onConsumerInterest, this, _1, _2),
-                                      boost::bind(&NameRouter::onConsumerData, this, _1, _2),
-                                      boost::bind(&NameRouter::onMasterFaceError, this, _1, _2));
-    _udp_consumer_master_face->listen(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2),
-                                      boost::bind(&NameRouter::onConsumerInterest, this, _1, _2),
-                                      boost::bind(&NameRouter::onConsumerData, this, _1, _2),
-                                      boost::bind(&NameRouter::onMasterFaceError, this, _1, _2));
-    _tcp_producer_master_face->listen(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2),
-                                      boost::bind(&NameRouter::onProducerInterest, this, _1, _2),
+    // before the consumer faces are accepted, nothing runs on _control_strand yet
+    _startup_config.apply(_ios, _remote_command_endpoint, [this](const rapidjson::Document &command) {
+        executeCommand(command);
+    });
+    _control_strand.post([this]() {
+        commandRead();
+        removeExpiredReturns(boost::system::error_code());
+    });
+    _tcp_consumer_master_face->listen(_control_strand.wrap(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2)),
+                                      PacketHandler::bind<NameRouter, &NameRouter::onConsumerPacket>(this),
+                                      _control_strand.wrap(boost::bind(&NameRouter::onMasterFaceError, this, _1, _2)));
+    _udp_consumer_master_face->listen(_control_strand.wrap(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2)),
+                                      PacketHandler::bind<NameRouter, &NameRouter::onConsumerPacket>(this),
+                                      _control_strand.wrap(boost::bind(&NameRouter::onMasterFaceError, this, _1, _2)));
+    _shm_consumer_master_face->listen(_control_strand.wrap(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2)),
+                                      PacketHandler::bind<NameRouter, &NameRouter::onConsumerPacket>(this),
+                                      _control_strand.wrap(boost::bind(&NameRouter::onMasterFaceError, this, _1, _2)));
+    _tcp_producer_master_face->listen(_control_strand.wrap(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2)),
+                                      _control_strand.wrap(boost::bind(&NameRouter::onProducerInterest, this, _1, _2)),
+                                      boost::bind(&NameRouter::onProducerData, this, _1, _2),
+                                      _control_strand.wrap(boost::bind(&NameRouter::onMasterFaceError, this, _1, _2)));
+    _udp_producer_master_face->listen(_control_strand.wrap(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2)),
+                                      _control_strand.wrap(boost::bind(&NameRouter::onProducerInterest, this, _1, _2)),
                                       boost::bind(&NameRouter::onProducerData, this, _1, _2),
-                                      boost::bind(&NameRouter::onMasterFaceError, this, _1, _2));
-    _udp_producer_master_face->listen(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2),
-                                      boost::bind(&NameRouter::onProducerInterest, this, _1, _2),
+                                      _control_strand.wrap(boost::bind(&NameRouter::onMasterFaceError, this, _1, _2)));
+    _shm_producer_master_face->listen(_control_strand.wrap(boost::bind(&NameRouter::onMasterFaceNotification, this, _1, _2)),
+                                      _control_strand.wrap(boost::bind(&NameRouter::onProducerInterest, this, _1, _2)),
                                       boost::bind(&NameRouter::onProducerData, this, _1, _2),
-                                      boost::bind(&NameRouter::onMasterFaceError, this, _1, _2));
+                                      _control_strand.wrap(boost::bind(&NameRouter::onMasterFaceError, this, _1, _2)));
+}
+
+void NameRouter::beginDrain() {
+    for (const auto &master_face : {_tcp_consumer_master_face, _udp_consumer_master_face, _shm_consumer_master_face,
+                                    _tcp_producer_master_face, _udp_producer_master_face, _shm_producer_master_face}) {
+        master_face->stopAccepting();
+    }
+}
+
+bool NameRouter::isDrained() {
+    for (const auto &master_face : {_tcp_consumer_master_face, _udp_consumer_master_face, _shm_consumer_master_face,
+                                    _tcp_producer_master_face, _udp_producer_master_face, _shm_producer_master_face}) {
+        if (master_face->getQueuedPackets() > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NameRouter::onConsumerPacket(const std::shared_ptr<Face> &consumer_face, const NdnPacket &packet) {
+    // Data from consumers are dropped, Interests are routed on their Name spans and sent as received
+    if (packet.getType() == NdnPacket::INTEREST) {
+        Strategy strategy = _strategy.load(std::memory_order_relaxed);
+        bool longest_prefix_match = _longest_prefix_match.load(std::memory_order_relaxed);
+        bool is_measured = _report_enable.load(std::memory_order_relaxed);
+        bool is_timed = is_measured || isMetricsEnabled();
+        boost::optional<NameView> hint;
+        if (_forwarding_hint.load(std::memory_order_relaxed)) {
+            hint = packet.getForwardingHint();
+        }
+        auto start = is_timed ? ForwardingStats::Clock::now() : ForwardingStats::Clock::time_point();
+        auto measure = [this, &packet, is_measured, &start](size_t faces) {
+            auto lookup = ForwardingStats::Clock::now() - start;
+            if (is_measured) {
+                _forwarding_stats.record(packet.getNameView(), lookup, faces);
+            }
+            if (isMetricsEnabled()) {
+                _lookup_latency->observe(std::max<int64_t>(ndn::time::duration_cast<ndn::time::nanoseconds>(lookup).count(), 0) / 1000.0);
+            }
+        };
+        // recorded before the Interest is sent, its Data may come back on another thread right after
+        auto record = [this, &consumer_face, &packet]() {
+            if (_targeted_return.load(std::memory_order_relaxed)) {
+                _return_table.insert(packet.getNameView().getHash(), consumer_face);
+            }
+        };
+        if (strategy == MULTICAST && !longest_prefix_match) {
+            auto producer_faces = [this, &packet, &hint]() {
+                stage_profile::Scope stage(stage_profile::TABLE);
+                NDNMS_PROBE1(fib_lookup_start, packet.getNameView().getHash());
+                auto faces = _fib.get(hint ? *hint : packet.getNameView());
+                if (faces.empty() && hint) {
+                    faces = _fib.get(packet.getNameView());
+                }
+                NDNMS_PROBE2(fib_lookup_end, packet.getNameView().getHash(), faces.size());
+                return faces;
+            }();
+            if (is_timed) {
+                measure(producer_faces.size());
+            }
+            if (!producer_faces.empty()) {
+                record();
+            }
+            for (const auto& producer_face : producer_faces) {
+                producer_face->send(packet);
+            }
+            return;
+        }
+        FibEntry::NextHops next_hops;
+        const FibEntry::NextHop *next_hop;
+        {
+            stage_profile::Scope stage(stage_profile::TABLE);
+            NDNMS_PROBE1(fib_lookup_start, packet.getNameView().getHash());
+            _fib.getNextHops(hint ? *hint : packet.getNameView(), longest_prefix_match, next_hops);
+            if (next_hops.empty() && hint) {
+                _fib.getNextHops(packet.getNameView(), longest_prefix_match, next_hops);
+            }
+            next_hop = strategy == MULTICAST ? nullptr : selectNextHop(next_hops, strategy, packet.getNameView().getHash());
+            NDNMS_PROBE2(fib_lookup_end, packet.getNameView().getHash(), strategy == MULTICAST ? next_hops.size() : next_hop ? 1 : 0);
+        }
+        if (is_timed) {
+            measure(strategy == MULTICAST ? next_hops.size() : next_hop ? 1 : 0);
+        }
+        if (strategy == MULTICAST) {
+            if (!next_hops.empty()) {
+                record();
+            }
+            for (const auto &next_hop : next_hops) {
+                next_hop.face->send(packet);
+            }
+        } else if (next_hop) {
+            record();
+            next_hop->face->send(packet);
+        }
+    }
 }
 
-void NameRouter::onConsumerInterest(const std::shared_ptr<Face> &consumer_face, const ndn::Interest &interest) {
-    auto producer_faces = _fib.get(interest.getName());
-    for (const auto& producer_face : producer_faces) {
-        producer_face->send(interest);
+const char* NameRouter::toString(Strategy strategy) {
+    switch (strategy) {
+        case BEST_ROUTE:
+            return "best_route";
+        case WEIGHTED:
+            return "weighted";
+        default:
+            return "multicast";
     }
 }
 
-void NameRouter::onConsumerData(const std::shared_ptr<Face> &consumer_face, const ndn::Data &data) {
-    // drop
+const FibEntry::NextHop* NameRouter::selectNextHop(const FibEntry::NextHops &next_hops, Strategy strategy, uint64_t name_hash) {
+    const FibEntry::NextHop *best = nullptr;
+    uint64_t total_weight = 0;
+    for (const auto &next_hop : next_hops) {
+        if (!best || next_hop.cost < best->cost) {
+            best = &next_hop;
+            total_weight = next_hop.weight;
+        } else if (next_hop.cost == best->cost) {
+            total_weight += next_hop.weight;
+        }
+    }
+    if (!best || strategy != WEIGHTED || total_weight == 0) {
+        return best;
+    }
+    uint64_t point = name_hash % total_weight;
+    for (const auto &next_hop : next_hops) {
+        if (next_hop.cost != best->cost) {
+            continue;
+        }
+        if (point < next_hop.weight) {
+            return &next_hop;
+        }
+        point -= next_hop.weight;
+    }
+    return best;
 }
 
 void NameRouter::onProducerInterest(const std::shared_ptr<Face> &producer_face, const ndn::Interest &interest) {
@@ -56,26 +243,42 @@ void NameRouter::onProducerInterest(const std::shared_ptr<Face> &producer_face,
     static const ndn::Name localhop("/localhop/nfd/rib/register");
     if (localhost.isPrefixOf(interest.getName()) || localhop.isPrefixOf(interest.getName())) {
         try {
-            ndn::Name prefix(interest.getName().get(4).blockFromValue());
+            // kept in the FIB, not in the buffer of the Interest
+            ndn::Name prefix = NdnPacket::copyName(ndn::Name(interest.getName().get(4).blockFromValue()));
             std::stringstream ss;
             ss << "face with ID = " << producer_face->getFaceId() << " want to register " << prefix << " name prefix";
             logger::log(logger::INFO, ss.str());
-            if (_manager_endpoint != boost::asio::ip::udp::endpoint()) {
-                ndn::Name name = interest.getName().getPrefix(-1);
+            if (_fib.hasRoute(producer_face, prefix)) {
+                // validated already, e.g. refreshed by the producer
+                onManagerValidation(producer_face, interest, prefix, true);
+                return;
+            }
+            ndn::Name name = interest.getName().getPrefix(-1);
+            ndn::Signature signature(interest.getName().get(-2).blockFromValue(), interest.getName().get(-1).blockFromValue());
+            if (EVP_PKEY *pkey = _keys.find(signature.getKeyLocator().getName())) {
+                // the manager pushed the key, it is only told about the new route afterwards
+                bool is_valid = KeyStore::verify(name.wireEncode().value(), name.wireEncode().value_size(),
+                                                 signature.getValue().value(), signature.getValue().value_size(), pkey);
+                onManagerValidation(producer_face, interest, prefix, is_valid);
+                if (is_valid && _manager_endpoint != boost::asio::ip::udp::endpoint()) {
+                    std::stringstream ss1;
+                    ss1 << R"({"face_id":)" << producer_face->getFaceId() << R"(, "prefix":")" << prefix
+                        << R"(", "key_name":")" << signature.getKeyLocator().getName() << "\"}";
+                    _queued_routes.emplace_back(ss1.str());
+                    armRegistrationTimer();
+                }
+            } else if (_manager_endpoint != boost::asio::ip::udp::endpoint()) {
                 std::string message = base64_encode(name.wireEncode().value(), name.wireEncode().value_size());
-                ndn::Signature signature(interest.getName().get(-2).blockFromValue(), interest.getName().get(-1).blockFromValue());
-                std::stringstream ss;
-                ss << R"({"name":")" << _name << R"(", "type":"request", "id":)" << _request_id << R"(, "action":"route_registration", "face_id":)"
-                   << producer_face->getFaceId() << R"(, "prefix":")" << prefix << R"(", "message":")" << message
-                   << R"(", "key_name":")" << signature.getKeyLocator().getName() << R"(", "signature_type":")" << signature.getType()
-                   << R"(", "signature":")" << base64_encode(signature.getValue().value(), signature.getValue().value_size()) << "\"}";
+                std::stringstream ss1;
+                ss1 << R"({"id":)" << _request_id << R"(, "face_id":)"
+                    << producer_face->getFaceId() << R"(, "prefix":")" << prefix << R"(", "message":")" << message
+                    << R"(", "key_name":")" << signature.getKeyLocator().getName() << R"(", "signature_type":")" << signature.getType()
+                    << R"(", "signature":")" << base64_encode(signature.getValue().value(), signature.getValue().value_size()) << "\"}";
                 _requests.emplace(_request_id, boost::bind(&NameRouter::onManagerValidation, this, producer_face, interest, prefix, _1));
-                auto timer = std::make_shared<boost::asio::deadline_timer>(_ios);
-                timer->expires_from_now(boost::posix_time::seconds(5));
-                timer->async_wait(boost::bind(&NameRouter::onTimeout, this, _1, _request_id));
-                _request_timers.emplace(_request_id, timer);
+                _request_deadlines.emplace_back(boost::posix_time::microsec_clock::universal_time() + REQUEST_TIMEOUT, _request_id);
                 ++_request_id;
-                _command_socket.send_to(boost::asio::buffer(ss.str()), _manager_endpoint);
+                _queued_registrations.emplace_back(ss1.str());
+                armRegistrationTimer();
             }
         } catch (const std::exception &e) {
             return;
@@ -86,116 +289,157 @@ void NameRouter::onProducerInterest(const std::shared_ptr<Face> &producer_face,
 void NameRouter::onManagerValidation(const std::shared_ptr<Face> &producer_face, const ndn::Interest &interest, const ndn::Name &prefix, bool result) {
     std::stringstream ss;
     if (result) {
-        ss << prefix << " name prefix accepted by manager for face with ID = " << producer_face->getFaceId();
+        ss << prefix << " name prefix accepted for face with ID = " << producer_face->getFaceId();
         logger::log(logger::INFO, ss.str());
         ndn::Data data(interest.getName());
         // I can't find the content to return in the doc so I just copy paste an existing reply, it's ok for the producers so it's ok for me
         uint8_t content[44] = {0x65, 0x2a, 0x66, 0x01, 0xc8, 0x67, 0x07, 0x53, 0x75, 0x63, 0x63, 0x65, 0x73, 0x73, 0x68, 0x1c, 0x07, 0x0d, 0x08, 0x03, 0x63, 0x6f, 0x6d, 0x08, 0x06, 0x67, 0x6f, 0x6f, 0x67, 0x6c, 0x65, 0x69, 0x02, 0x01, 0x0d, 0x6f, 0x01, 0x00, 0x6a, 0x01, 0x00, 0x6c, 0x01, 0x01};
         data.setContent(content, 44);
         data.setFreshnessPeriod(ndn::time::milliseconds(0));
-        _keychain.sign(data);
-        producer_face->send(data);
+        _reply_signer->sign(data, [producer_face](const ndn::Data &data) {
+            producer_face->send(data);
+        });
         _fib.insert(producer_face, prefix);
     } else {
-        ss << prefix << " name prefix refused by manager for face with ID = " << producer_face->getFaceId();
+        ss << prefix << " name prefix refused for face with ID = " << producer_face->getFaceId();
         logger::log(logger::INFO, ss.str());
     }
 }
 
-void NameRouter::onTimeout(const boost::system::error_code &err, size_t index) {
-    if (!err) {
-        _requests.erase(index);
-        _request_timers.erase(index);
+void NameRouter::armRegistrationTimer() {
+    if (!_is_registration_timer_armed) {
+        _is_registration_timer_armed = true;
+        _registration_timer.expires_from_now(boost::posix_time::milliseconds(_registration_delay));
+        _registration_timer.async_wait(_control_strand.wrap(boost::bind(&NameRouter::flushRegistrations, this, _1)));
     }
 }
 
+void NameRouter::flushRegistrations(const boost::system::error_code &err) {
+    _is_registration_timer_armed = false;
+    if (err) {
+        return;
+    }
+    // the manager didn't answer those, the producers register again
+    auto now = boost::posix_time::microsec_clock::universal_time();
+    while (!_request_deadlines.empty() && _request_deadlines.front().first <= now) {
+        _requests.erase(_request_deadlines.front().second);
+        _request_deadlines.pop_front();
+    }
+    auto send = [this](std::vector<std::string> &queued, const std::string &header, const std::string &field) {
+        for (size_t begin = 0; begin < queued.size(); begin += MAX_BATCHED_REGISTRATIONS) {
+            size_t end = std::min(begin + MAX_BATCHED_REGISTRATIONS, queued.size());
+            std::stringstream ss;
+            ss << R"({"name":")" << _name << "\", " << header << R"(, ")" << field << R"(":[)";
+            for (size_t i = begin; i < end; ++i) {
+                if (i > begin) {
+                    ss << ", ";
+                }
+                ss << queued[i];
+            }
+            ss << "]}";
+            _command_socket.send_to(boost::asio::buffer(ss.str()), _manager_endpoint);
+        }
+        queued.clear();
+    };
+    send(_queued_registrations, R"("type":"request", "action":"route_registrations")", "registrations");
+    send(_queued_routes, R"("type":"report", "action":"routes_registered")", "routes");
+}
+
 void NameRouter::onProducerData(const std::shared_ptr<Face> &producer_face, const ndn::Data &data) {
     if (!_check_prefix || _fib.isPrefix(producer_face, data.getName())) {
-        _tcp_consumer_master_face->sendToAllFaces(data);
-        _udp_consumer_master_face->sendToAllFaces(data);
+        // the wire the Data was decoded from, copied once at most out of the read buffer and shared by all the faces
+        // instead of once by face
+        auto wire = Face::getWireBuffer(data.wireEncode());
+        if (_targeted_return.load(std::memory_order_relaxed)) {
+            FaceTable::Faces consumer_faces;
+            if (_return_table.take(data.getName(), consumer_faces)) {
+                for (const auto &consumer_face : consumer_faces) {
+                    consumer_face->send(wire);
+                }
+                return;
+            }
+        }
+        _tcp_consumer_master_face->sendToAllFaces(wire);
+        _udp_consumer_master_face->sendToAllFaces(wire);
+        _shm_consumer_master_face->sendToAllFaces(wire);
+    }
+}
+
+void NameRouter::removeExpiredReturns(const boost::system::error_code &err) {
+    if (err) {
+        return;
+    }
+    _return_table.removeExpired();
+    if (!_mapped_fib_path.empty()) {
+        // the previous version stays mapped meanwhile, the failure is only logged when it changes
+        std::string error;
+        if (!refreshMappedFib(error) && error != _mapped_fib_error) {
+            logger::log(logger::ERROR, "mapped FIB {} not refreshed: {}", {_mapped_fib_path, error});
+        }
+        _mapped_fib_error = error;
+    }
+    _return_timer.expires_from_now(boost::posix_time::seconds(1));
+    _return_timer.async_wait(_control_strand.wrap(boost::bind(&NameRouter::removeExpiredReturns, this, _1)));
+}
+
+void NameRouter::commandReport(const boost::system::error_code &err) {
+    if (!err && _manager_endpoint != boost::asio::ip::udp::endpoint()) {
+        stage_profile::Scope stage(stage_profile::REPORT);
+        // registrations waiting for the next flush, and those sent which the manager didn't answer yet
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"report", "action":"forwarding_status", "forwarding":)" << _forwarding_stats.takeReport()
+           << R"(, "queued_registrations":)" << _queued_registrations.size() << R"(, "queued_routes":)" << _queued_routes.size()
+           << R"(, "pending_requests":)" << _requests.size() << R"(, "fib_entries":)" << _fib.getLogicalSize()
+           << R"(, "stages":)" << stage_profile::toJSON() << "}";
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _manager_endpoint);
+    }
+    if (_report_enable) {
+        _report_timer.expires_from_now(_delay_between_report);
+        _report_timer.async_wait(_control_strand.wrap(boost::bind(&NameRouter::commandReport, this, _1)));
     }
 }
 
 void NameRouter::onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "new face with ID = " << face->getFaceId() << " form master face with ID = " << master_face->getMasterFaceId();
-    logger::log(logger::INFO, ss.str());
+    logger::log(logger::INFO, "new face with ID = {} form master face with ID = {}",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void NameRouter::onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "face with ID = " << face->getFaceId() << " from master face with ID = " << master_face->getMasterFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    logger::log(logger::ERROR, "face with ID = {} from master face with ID = {} can't process normally",
+                {face->getFaceId(), master_face->getMasterFaceId()});
+    _fib.remove(face);
+    // the faces destroyed meanwhile without an error, their refs would be skipped by each lookup otherwise
+    _fib.removeExpiredFaces();
     std::stringstream ss1;
     ss1 << R"({"name":")" << _name << R"(", "type":"report", "action":"producer_disconnection", "face_id":)" << face->getFaceId() << "}";
     _command_socket.send_to(boost::asio::buffer(ss1.str()), _remote_command_endpoint);
 }
 
 void NameRouter::onFaceError(const std::shared_ptr<Face> &face) {
-    //_fib.remove(face);
+    _fib.remove(face);
     _egress_faces.erase(face->getFaceId());
-    std::stringstream ss;
-    ss << "face with ID = " << face->getFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    resolveMappedFib();
+    logger::log(logger::ERROR, "face with ID = {} can't process normally", {face->getFaceId()});
 }
 
 void NameRouter::commandRead() {
     _command_socket.async_receive_from(boost::asio::buffer(_command_buffer, 65536), _remote_command_endpoint,
-                                       boost::bind(&NameRouter::commandReadHandler, this, _1, _2));
+                                       _control_strand.wrap(boost::bind(&NameRouter::commandReadHandler, this, _1, _2)));
 }
 
 void NameRouter::commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred) {
-    enum action_type {
-        REPLY,
-        EDIT_CONFIG,
-        ADD_FACE,
-        DEL_FACE,
-        ADD_ROUTE,
-        DEL_ROUTE,
-        LIST
-    };
-
-    static const std::map<std::string, action_type> ACTIONS = {
-            {"reply", REPLY},
-            {"edit_config", EDIT_CONFIG},
-            {"add_face", ADD_FACE},
-            {"del_face", DEL_FACE},
-            {"add_route", ADD_ROUTE},
-            {"del_route", DEL_ROUTE},
-            {"list", LIST}
-    };
-
     if(!err) {
         try {
+            if (management::isBatch(_command_buffer, bytes_transferred)) {
+                commandBatch(management::decodeBatch(_command_buffer, bytes_transferred));
+                commandRead();
+                return;
+            }
             rapidjson::Document document;
             document.Parse(_command_buffer, bytes_transferred);
             if(!document.HasParseError()){
                 if(document.HasMember("action") && document["action"].IsString() && document.HasMember("id") && document["id"].IsUint()){
-                    auto it = ACTIONS.find(document["action"].GetString());
-                    if(it != ACTIONS.end()) {
-                        switch (it->second) {
-                            case REPLY:
-                                commandReply(document);
-                                break;
-                            case EDIT_CONFIG:
-                                commandEditConfig(document);
-                                break;
-                            case ADD_FACE:
-                                commandAddFace(document);
-                                break;
-                            case DEL_FACE:
-                                commandDelFace(document);
-                                break;
-                            case ADD_ROUTE:
-                                commandAddRoutes(document);
-                                break;
-                            case DEL_ROUTE:
-                                commandDelRoutes(document);
-                                break;
-                            case LIST:
-                                commandList(document);
-                        }
-                    }
+                    executeCommand(document);
                 } else{
                     //std::string response = R"({"status":"fail", "reason":"action not provided or not implemented"})";
                     //_command_socket.send_to(boost::asio::buffer(response), _remote_command_endpoint);
@@ -214,11 +458,109 @@ void NameRouter::commandReadHandler(const boost::system::error_code &err, size_t
     }
 }
 
+void NameRouter::executeCommand(const rapidjson::Document &document) {
+    enum action_type {
+        REPLY,
+        EDIT_CONFIG,
+        ADD_FACE,
+        DEL_FACE,
+        ADD_ROUTE,
+        DEL_ROUTE,
+        ADD_KEYS,
+        DEL_KEYS,
+        LIST,
+        EXPORT_STATE,
+        IMPORT_STATE,
+        MEMORY_STATS,
+        PUBLISH_FIB,
+        MAP_FIB
+    };
+
+    static const std::map<std::string, action_type> ACTIONS = {
+            {"reply", REPLY},
+            {"edit_config", EDIT_CONFIG},
+            {"add_face", ADD_FACE},
+            {"del_face", DEL_FACE},
+            {"add_route", ADD_ROUTE},
+            {"del_route", DEL_ROUTE},
+            {"add_keys", ADD_KEYS},
+            {"del_keys", DEL_KEYS},
+            {"list", LIST},
+            {"export_state", EXPORT_STATE},
+            {"import_state", IMPORT_STATE},
+            {"memory_stats", MEMORY_STATS},
+            {"publish_fib", PUBLISH_FIB},
+            {"map_fib", MAP_FIB}
+    };
+
+    auto it = ACTIONS.find(document["action"].GetString());
+    if (it == ACTIONS.end()) {
+        return;
+    }
+    switch (it->second) {
+        case REPLY:
+            commandReply(document);
+            break;
+        case EDIT_CONFIG:
+            commandEditConfig(document);
+            break;
+        case ADD_FACE:
+            commandAddFace(document);
+            break;
+        case DEL_FACE:
+            commandDelFace(document);
+            break;
+        case ADD_ROUTE:
+            commandAddRoutes(document);
+            break;
+        case DEL_ROUTE:
+            commandDelRoutes(document);
+            break;
+        case ADD_KEYS:
+            commandAddKeys(document);
+            break;
+        case DEL_KEYS:
+            commandDelKeys(document);
+            break;
+        case LIST:
+            commandList(document);
+            break;
+        case EXPORT_STATE:
+            commandExportState(document);
+            break;
+        case IMPORT_STATE:
+            commandImportState(document);
+            break;
+        case MEMORY_STATS:
+            commandMemoryStats(document);
+            break;
+        case PUBLISH_FIB:
+            commandPublishFib(document);
+            break;
+        case MAP_FIB:
+            commandMapFib(document);
+            break;
+    }
+}
+
 void NameRouter::commandReply(const rapidjson::Document &document) {
-    if (document.HasMember("result") && document["result"].IsBool()) {
-        auto it = _requests.find(document["id"].GetUint());
+    auto reply = [this](size_t id, bool result) {
+        auto it = _requests.find(id);
         if (it != _requests.end()) {
-            it->second(document["result"].GetBool());
+            auto callback = std::move(it->second);
+            _requests.erase(it);
+            callback(result);
+        }
+    };
+    if (document.HasMember("result") && document["result"].IsBool()) {
+        reply(document["id"].GetUint(), document["result"].GetBool());
+    }
+    // the replies to a batch of registrations
+    if (document.HasMember("results") && document["results"].IsArray()) {
+        for (const auto &result : document["results"].GetArray()) {
+            if (result.IsObject() && result.HasMember("id") && result["id"].IsUint() && result.HasMember("result") && result["result"].IsBool()) {
+                reply(result["id"].GetUint(), result["result"].GetBool());
+            }
         }
     }
 }
@@ -237,6 +579,40 @@ void NameRouter::commandEditConfig(const rapidjson::Document &document) {
         }
     }
 
+    if (document.HasMember("report_each") && document["report_each"].IsUint()) {
+        bool has_change = false;
+        boost::posix_time::milliseconds delay_between_report(document["report_each"].GetUint());
+        if (delay_between_report != _delay_between_report) {
+            _delay_between_report = delay_between_report;
+            has_change = true;
+        }
+        if (_delay_between_report.total_milliseconds() > 0) {
+            if (!_report_enable) {
+                _report_enable = true;
+                // the first report covers the Interests from now on
+                _forwarding_stats.takeReport();
+                _report_timer.expires_from_now(_delay_between_report);
+                _report_timer.async_wait(_control_strand.wrap(boost::bind(&NameRouter::commandReport, this, _1)));
+            }
+        } else {
+            _report_enable = false;
+        }
+        if (has_change) {
+            changes.emplace_back("report_each");
+        }
+    }
+    if (document.HasMember("report_prefix_length") && document["report_prefix_length"].IsUint()) {
+        bool has_change = false;
+        size_t prefix_length = document["report_prefix_length"].GetUint();
+        if (prefix_length != _forwarding_stats.getPrefixLength()) {
+            _forwarding_stats.setPrefixLength(prefix_length);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("report_prefix_length");
+        }
+    }
+
     if (document.HasMember("check_prefix") && document["check_prefix"].IsBool()) {
         bool has_change = false;
         bool check_prefix = document["check_prefix"].GetBool();
@@ -248,6 +624,314 @@ void NameRouter::commandEditConfig(const rapidjson::Document &document) {
             changes.emplace_back("check_prefix");
         }
     }
+    if (document.HasMember("registration_delay") && document["registration_delay"].IsUint()) {
+        bool has_change = false;
+        size_t delay = document["registration_delay"].GetUint();
+        if (delay != _registration_delay) {
+            _registration_delay = delay;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("registration_delay");
+        }
+    }
+    if (document.HasMember("targeted_return") && document["targeted_return"].IsBool()) {
+        bool has_change = false;
+        bool targeted_return = document["targeted_return"].GetBool();
+        if (targeted_return != _targeted_return) {
+            _targeted_return = targeted_return;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("targeted_return");
+        }
+    }
+    if (document.HasMember("return_ttl") && document["return_ttl"].IsUint()) {
+        bool has_change = false;
+        ndn::time::milliseconds ttl(document["return_ttl"].GetUint());
+        if (ttl != _return_table.getTtl()) {
+            _return_table.setTtl(ttl);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("return_ttl");
+        }
+    }
+    if (document.HasMember("return_max_records") && document["return_max_records"].IsUint()) {
+        bool has_change = false;
+        size_t max_records = document["return_max_records"].GetUint();
+        if (max_records != _return_table.getMaxRecords()) {
+            _return_table.setMaxRecords(max_records);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("return_max_records");
+        }
+    }
+    if (document.HasMember("strategy") && document["strategy"].IsString()) {
+        bool has_change = false;
+        std::string name = document["strategy"].GetString();
+        for (Strategy strategy : {MULTICAST, BEST_ROUTE, WEIGHTED}) {
+            if (name == toString(strategy) && strategy != _strategy) {
+                _strategy = strategy;
+                has_change = true;
+            }
+        }
+        if (has_change) {
+            changes.emplace_back("strategy");
+        }
+    }
+    if (document.HasMember("longest_prefix_match") && document["longest_prefix_match"].IsBool()) {
+        bool has_change = false;
+        bool longest_prefix_match = document["longest_prefix_match"].GetBool();
+        if (longest_prefix_match != _longest_prefix_match) {
+            _longest_prefix_match = longest_prefix_match;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("longest_prefix_match");
+        }
+    }
+    if (document.HasMember("forwarding_hint") && document["forwarding_hint"].IsBool()) {
+        bool has_change = false;
+        bool forwarding_hint = document["forwarding_hint"].GetBool();
+        if (forwarding_hint != _forwarding_hint) {
+            _forwarding_hint = forwarding_hint;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("forwarding_hint");
+        }
+    }
+    if (document.HasMember("fib_aggregation") && document["fib_aggregation"].IsBool()) {
+        bool has_change = false;
+        bool aggregation = document["fib_aggregation"].GetBool();
+        if (aggregation != _fib.isAggregating()) {
+            _fib.setAggregation(aggregation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("fib_aggregation");
+        }
+    }
+    if (document.HasMember("fib_lookup_cache") && document["fib_lookup_cache"].IsBool()) {
+        bool has_change = false;
+        bool is_caching = document["fib_lookup_cache"].GetBool();
+        if (is_caching != _fib.isCachingLookups()) {
+            _fib.setLookupCache(is_caching);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("fib_lookup_cache");
+        }
+    }
+    if (document.HasMember("tcp_gather_bytes") && document["tcp_gather_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["tcp_gather_bytes"].GetUint();
+        if (max_bytes != TcpFace::getGatherMaxBytes()) {
+            TcpFace::setGatherMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_bytes");
+        }
+    }
+    if (document.HasMember("tcp_gather_packets") && document["tcp_gather_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["tcp_gather_packets"].GetUint();
+        if (max_packets != TcpFace::getGatherMaxPackets()) {
+            TcpFace::setGatherMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_packets");
+        }
+    }
+    if (document.HasMember("tcp_max_packet_size") && document["tcp_max_packet_size"].IsUint()) {
+        bool has_change = false;
+        size_t size = document["tcp_max_packet_size"].GetUint();
+        if (size != TcpFace::getMaxPacketSize()) {
+            has_change = TcpFace::setMaxPacketSize(size);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_max_packet_size");
+        }
+    }
+    if (document.HasMember("tcp_flush") && document["tcp_flush"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_flush"].GetString();
+        if (policy != TcpFace::getFlushPolicy()) {
+            has_change = TcpFace::setFlushPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_flush");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_min_delay") && document["tcp_reconnect_min_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_min_delay"].GetUint();
+        if (value != TcpFace::getReconnectMinDelay()) {
+            TcpFace::setReconnectMinDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_min_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_max_delay") && document["tcp_reconnect_max_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_max_delay"].GetUint();
+        if (value != TcpFace::getReconnectMaxDelay()) {
+            TcpFace::setReconnectMaxDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_max_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_attempts") && document["tcp_reconnect_attempts"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_attempts"].GetUint();
+        if (value != TcpFace::getReconnectAttempts()) {
+            TcpFace::setReconnectAttempts(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_attempts");
+        }
+    }
+    if (document.HasMember("tcp_replay_max_age") && document["tcp_replay_max_age"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_replay_max_age"].GetUint();
+        if (value != TcpFace::getReplayMaxAge()) {
+            TcpFace::setReplayMaxAge(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_replay_max_age");
+        }
+    }
+    if (document.HasMember("tcp_credit_window") && document["tcp_credit_window"].IsUint()) {
+        bool has_change = false;
+        size_t window = document["tcp_credit_window"].GetUint();
+        if (window != TcpFace::getCreditWindow()) {
+            TcpFace::setCreditWindow(window);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_window");
+        }
+    }
+    if (document.HasMember("tcp_credit_policy") && document["tcp_credit_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_credit_policy"].GetString();
+        if (policy != TcpFace::getCreditPolicy()) {
+            has_change = TcpFace::setCreditPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_policy");
+        }
+    }
+    if (document.HasMember("udp_mtu") && document["udp_mtu"].IsUint()) {
+        bool has_change = false;
+        size_t mtu = document["udp_mtu"].GetUint();
+        if (mtu != LpLink::getMtu()) {
+            LpLink::setMtu(mtu);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_mtu");
+        }
+    }
+    if (document.HasMember("udp_aggregation") && document["udp_aggregation"].IsBool()) {
+        bool has_change = false;
+        bool aggregation = document["udp_aggregation"].GetBool();
+        if (aggregation != LpLink::getAggregation()) {
+            LpLink::setAggregation(aggregation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_aggregation");
+        }
+    }
+    if (document.HasMember("connection_pool") && _connection_pool.update(document["connection_pool"])) {
+        changes.emplace_back("connection_pool");
+    }
+    if (document.HasMember("socket_options")) {
+        bool has_change = false;
+        // the default of the faces created from now on, the ingress master faces change theirs at once
+        SocketOptions options = SocketOptions::getDefault();
+        if (options.update(document["socket_options"]) && options != SocketOptions::getDefault()) {
+            SocketOptions::setDefault(options);
+            for (const auto &master_face : {_tcp_consumer_master_face, _tcp_producer_master_face,
+                                             _udp_consumer_master_face, _udp_producer_master_face}) {
+                master_face->setSocketOptions(options);
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("socket_options");
+        }
+    }
+    if (document.HasMember("udp_segmentation") && document["udp_segmentation"].IsBool()) {
+        bool has_change = false;
+        bool segmentation = document["udp_segmentation"].GetBool();
+        for (const auto &master_face : {_udp_consumer_master_face, _udp_producer_master_face}) {
+            auto udp_master_face = std::static_pointer_cast<UdpMasterFace>(master_face);
+            if (segmentation != udp_master_face->isSegmenting()) {
+                udp_master_face->setSegmentation(segmentation);
+                has_change = true;
+            }
+        }
+        if (has_change) {
+            changes.emplace_back("udp_segmentation");
+        }
+    }
+    if (document.HasMember("queue_max_packets") && document["queue_max_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["queue_max_packets"].GetUint();
+        if (max_packets != QueuePolicy::getMaxPackets()) {
+            QueuePolicy::setMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_packets");
+        }
+    }
+    if (document.HasMember("queue_max_bytes") && document["queue_max_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["queue_max_bytes"].GetUint();
+        if (max_bytes != QueuePolicy::getMaxBytes()) {
+            QueuePolicy::setMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_bytes");
+        }
+    }
+    if (document.HasMember("queue_drop_policy") && document["queue_drop_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["queue_drop_policy"].GetString();
+        if (policy != QueuePolicy::getDropPolicyName()) {
+            has_change = QueuePolicy::setDropPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_drop_policy");
+        }
+    }
+    if (document.HasMember("queue_scheduler") && document["queue_scheduler"].IsString()) {
+        bool has_change = false;
+        std::string scheduler = document["queue_scheduler"].GetString();
+        if (scheduler != QueuePolicy::getSchedulerName()) {
+            has_change = QueuePolicy::setScheduler(scheduler);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_scheduler");
+        }
+    }
+    if (document.HasMember("queue_classes") && QueuePolicy::setClasses(document["queue_classes"])) {
+        changes.emplace_back("queue_classes");
+    }
 
     std::stringstream ss;
     ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"edit_config", "changes":[)";
@@ -268,11 +952,13 @@ void NameRouter::commandAddFace(const rapidjson::Document &document) {
     enum layer_type {
         TCP,
         UDP,
+        SHM,
     };
 
     static const std::unordered_map<std::string, layer_type> LAYERS = {
             {"tcp", TCP},
             {"udp", UDP},
+            {"shm", SHM},
     };
 
     if (document.HasMember("layer") && document.HasMember("address") && document.HasMember("port")
@@ -282,16 +968,27 @@ void NameRouter::commandAddFace(const rapidjson::Document &document) {
             std::shared_ptr<Face> face;
             switch (it->second) {
                 case TCP:
-                    face = std::make_shared<TcpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    face = _connection_pool.makeFace(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
                     break;
                 case UDP:
-                    face = std::make_shared<UdpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    face = std::make_shared<UdpFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
+                    break;
+                case SHM:
+                    face = std::make_shared<ShmFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
                     break;
             }
-            face->open(boost::bind(&NameRouter::onProducerInterest, this, _1, _2),
+            if (document.HasMember("socket_options")) {
+                // on top of the default, before open for the buffers of a TCP connection
+                SocketOptions options = SocketOptions::getDefault();
+                if (options.update(document["socket_options"])) {
+                    face->setSocketOptions(options);
+                }
+            }
+            face->open(_control_strand.wrap(boost::bind(&NameRouter::onProducerInterest, this, _1, _2)),
                        boost::bind(&NameRouter::onProducerData, this, _1, _2),
-                       boost::bind(&NameRouter::onFaceError, this, _1));
+                       _control_strand.wrap(boost::bind(&NameRouter::onFaceError, this, _1)));
             _egress_faces.emplace(face->getFaceId(), face);
+            resolveMappedFib();
             std::stringstream ss;
             ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_face", "face_id":)" << face->getFaceId() << "}";
             _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
@@ -302,7 +999,13 @@ void NameRouter::commandAddFace(const rapidjson::Document &document) {
 void NameRouter::commandDelFace(const rapidjson::Document &document) {
     if (document.HasMember("face_id") && document["face_id"].IsUint()) {
         size_t face_id = document["face_id"].GetUint();
-        bool ok = _egress_faces.erase(face_id);
+        auto it = _egress_faces.find(face_id);
+        bool ok = it != _egress_faces.end();
+        if (ok) {
+            _fib.remove(it->second);
+            _egress_faces.erase(it);
+            resolveMappedFib();
+        }
         std::stringstream ss;
         ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(", action":"del_face", "face_id":)" << face_id << R"(, "status":)" << ok << "}";
         _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
@@ -319,15 +1022,20 @@ void NameRouter::commandAddRoutes(const rapidjson::Document &document) {
         } else {
             auto it = _egress_faces.find(document["face_id"].GetUint());
             if (it != _egress_faces.end()) {
+                std::vector<ndn::Name> name_prefixes;
                 for (auto &prefix : prefixes) {
                     if (prefix.IsString()) {
                         ndn::Name name_prefix(prefix.GetString());
-                        _fib.insert(it->second, name_prefix);
+                        name_prefixes.emplace_back(name_prefix);
                         std::stringstream ss1;
                         ss1 << name_prefix << " name added by manager for face with ID = " << it->second->getFaceId();
                         logger::log(logger::INFO, ss1.str());
                     }
                 }
+                // the same for all the prefixes of the command
+                uint32_t cost = document.HasMember("cost") && document["cost"].IsUint() ? document["cost"].GetUint() : FibEntry::DEFAULT_COST;
+                uint32_t weight = document.HasMember("weight") && document["weight"].IsUint() ? document["weight"].GetUint() : FibEntry::DEFAULT_WEIGHT;
+                _fib.insert(it->second, name_prefixes, cost, weight);
                 ss << R"("status":"success"})";
             } else {
                 ss << R"("status":"fail", "reason":"unknown face id"})";
@@ -347,15 +1055,17 @@ void NameRouter::commandDelRoutes(const rapidjson::Document &document) {
         } else {
             auto it = _egress_faces.find(document["face_id"].GetUint());
             if (it != _egress_faces.end()) {
+                std::vector<ndn::Name> name_prefixes;
                 for (auto &prefix : prefixes) {
                     if (prefix.IsString()) {
                         ndn::Name name_prefix(prefix.GetString());
-                        _fib.remove(it->second, name_prefix);
+                        name_prefixes.emplace_back(name_prefix);
                         std::stringstream ss1;
                         ss1 << name_prefix << " name removed by manager for face with ID = " << it->second->getFaceId();
                         logger::log(logger::INFO, ss1.str());
                     }
                 }
+                _fib.remove(it->second, name_prefixes);
                 ss << R"("status":"success"})";
             } else {
                 ss << R"("status":"fail", "reason":"unknown face id"})";
@@ -365,8 +1075,477 @@ void NameRouter::commandDelRoutes(const rapidjson::Document &document) {
     }
 }
 
+void NameRouter::commandAddKeys(const rapidjson::Document &document) {
+    // [key_name, type, PEM] as for the SV
+    if (document.HasMember("keys") && document["keys"].IsArray()) {
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_keys", )";
+        auto &&keys = document["keys"].GetArray();
+        if (keys.Empty()) {
+            ss << R"("status":"fail", "reason":"empty key list"})";
+        } else {
+            bool is_success = true;
+            for (auto &key : keys) {
+                if (key.IsArray()) {
+                    auto key_info = key.GetArray();
+                    if (key_info.Size() == 3 && key_info[0].IsString() && key_info[1].IsString() && key_info[2].IsString()) {
+                        ndn::Name key_name(key_info[0].GetString());
+                        std::stringstream ss1;
+                        if (_keys.add(key_name, key_info[2].GetString())) {
+                            ss1 << "key " << key_name << " added by manager";
+                        } else {
+                            ss1 << "error while adding key " << key_name;
+                            is_success = false;
+                        }
+                        logger::log(logger::INFO, ss1.str());
+                    }
+                }
+            }
+            ss << R"("status":")" << (is_success ? "success" : "fail") << "\"}";
+        }
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    }
+}
+
+void NameRouter::commandDelKeys(const rapidjson::Document &document) {
+    if (document.HasMember("keys") && document["keys"].IsArray()) {
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_keys", )";
+        auto &&keys = document["keys"].GetArray();
+        if (keys.Empty()) {
+            ss << R"("status":"fail", "reason":"empty key list"})";
+        } else {
+            for (auto &key : keys) {
+                if (key.IsString()) {
+                    ndn::Name key_name(key.GetString());
+                    if (_keys.remove(key_name)) {
+                        std::stringstream ss1;
+                        ss1 << "key with name " << key_name << " removed by manager";
+                        logger::log(logger::INFO, ss1.str());
+                    }
+                }
+            }
+            ss << R"("status":"success"})";
+        }
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    }
+}
+
 void NameRouter::commandList(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    std::string reply = makeListReply(document);
+    _command_socket.send_to(boost::asio::buffer(reply), _remote_command_endpoint);
+}
+
+void NameRouter::commandMemoryStats(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    MemoryStats stats;
+    _fib.addMemoryStats(stats);
+    stats.add("return_table", _return_table.size(), _return_table.getMemoryUsage());
+    stats.add("forwarding_stats", _forwarding_stats.getPrefixes(), _forwarding_stats.getMemoryUsage());
+    _keys.addMemoryStats(stats, "keys");
+    stats.add("requests", _requests.size() + _request_deadlines.size(), memory_usage::of(_requests) + memory_usage::of(_request_deadlines));
+    for (const auto &face : _egress_faces) {
+        face.second->addMemoryStats(stats);
+    }
+    _tcp_consumer_master_face->addMemoryStats(stats);
+    _tcp_producer_master_face->addMemoryStats(stats);
+    _udp_consumer_master_face->addMemoryStats(stats);
+    _shm_consumer_master_face->addMemoryStats(stats);
+    _udp_producer_master_face->addMemoryStats(stats);
+    _shm_producer_master_face->addMemoryStats(stats);
     std::stringstream ss;
-    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list", "table":{"type":"fib", "tree":)" << _fib.toJSON() << "}}";
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"memory_stats", "memory":)"
+       << stats.toJSON() << "}";
     _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
 }
+
+std::string NameRouter::makeListReply(const rapidjson::Document &document) {
+    // the reply is written as the FIB is walked, the other parts are small and copied as they are
+    auto raw = [](NameIndex<FibEntry>::JsonWriter &writer, const std::string &json) {
+        writer.RawValue(json.c_str(), json.size(), rapidjson::kObjectType);
+    };
+    rapidjson::StringBuffer buffer;
+    NameIndex<FibEntry>::JsonWriter writer(buffer);
+    writer.StartObject();
+    writer.Key("name");
+    writer.String(_name.c_str(), static_cast<rapidjson::SizeType>(_name.size()));
+    writer.Key("type");
+    writer.String("reply");
+    writer.Key("id");
+    writer.Uint(document["id"].GetUint());
+    writer.Key("action");
+    writer.String("list");
+    writer.Key("table");
+    writer.StartObject();
+    writer.Key("type");
+    writer.String("fib");
+    writer.Key("engine");
+    std::string engine = _fib.getEngine();
+    writer.String(engine.c_str(), static_cast<rapidjson::SizeType>(engine.size()));
+    writer.Key("strategy");
+    writer.String(toString(_strategy));
+    writer.Key("longest_prefix_match");
+    writer.Bool(_longest_prefix_match);
+    writer.Key("forwarding_hint");
+    writer.Bool(_forwarding_hint);
+    // the entries listed below are the physical ones, the folded routes are not
+    writer.Key("aggregation");
+    writer.Bool(_fib.isAggregating());
+    writer.Key("lookup_cache");
+    writer.Bool(_fib.isCachingLookups());
+    writer.Key("logical_entries");
+    writer.Uint(static_cast<unsigned>(_fib.getLogicalSize()));
+    writer.Key("physical_entries");
+    writer.Uint(static_cast<unsigned>(_fib.getPhysicalSize()));
+    writer.Key("mapped_fib");
+    auto mapped = _fib.getMapped();
+    if (mapped) {
+        writer.StartObject();
+        writer.Key("path");
+        writer.String(_mapped_fib_path.c_str(), static_cast<rapidjson::SizeType>(_mapped_fib_path.size()));
+        writer.Key("version");
+        writer.Uint64(mapped->getVersion());
+        writer.Key("routes");
+        writer.Uint64(mapped->getRoutes());
+        writer.EndObject();
+    } else {
+        writer.Null();
+    }
+    writer.Key("keys");
+    writer.Uint(static_cast<unsigned>(_keys.size()));
+    writer.Key("targeted_return");
+    writer.Bool(_targeted_return);
+    writer.Key("return_table");
+    raw(writer, _return_table.toJSON());
+    bool has_cursor = document.HasMember("cursor") && document["cursor"].IsString();
+    bool has_limit = document.HasMember("limit") && document["limit"].IsUint();
+    if (has_cursor || has_limit) {
+        // a page of entries in Name order, "next" is given back as "cursor" to get the following one
+        ndn::Name cursor;
+        if (has_cursor) {
+            try {
+                cursor = ndn::Name(document["cursor"].GetString());
+            } catch (const std::exception &e) {
+                has_cursor = false;
+            }
+        }
+        size_t limit = has_limit ? document["limit"].GetUint() : SIZE_MAX;
+        ndn::Name next;
+        writer.Key("entries");
+        bool is_truncated = _fib.writePage(writer, buffer, has_cursor ? &cursor : nullptr, limit, LIST_PAGE_BYTES, next);
+        writer.Key("next");
+        if (is_truncated) {
+            std::string uri = next.toUri();
+            writer.String(uri.c_str(), static_cast<rapidjson::SizeType>(uri.size()));
+        } else {
+            writer.Null();
+        }
+    } else {
+        writer.Key("tree");
+        _fib.toJSON(writer);
+    }
+    writer.EndObject();
+    writer.Key("faces");
+    writer.StartArray();
+    for (const auto &face : _egress_faces) {
+        raw(writer, face.second->toJSON());
+    }
+    writer.EndArray();
+    writer.Key("master_faces");
+    writer.StartArray();
+    for (const auto &master_face : {_tcp_consumer_master_face, _tcp_producer_master_face, _udp_consumer_master_face,
+                                    _udp_producer_master_face, _shm_consumer_master_face, _shm_producer_master_face}) {
+        raw(writer, master_face->toJSON());
+    }
+    writer.EndArray();
+    writer.Key("connection_pool");
+    std::string connection_pool = _connection_pool.toJSON();
+    writer.RawValue(connection_pool.c_str(), connection_pool.size(), rapidjson::kArrayType);
+    writer.Key("buffer_pool");
+    raw(writer, BufferPool::getStats().toJSON());
+    writer.Key("page_arena");
+    raw(writer, PageArena::getStats().toJSON());
+    writer.Key("stages");
+    raw(writer, stage_profile::toJSON());
+    writer.EndObject();
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+std::string NameRouter::makeRoutesState(size_t &count) const {
+    std::string records;
+    count = 0;
+    _fib.forEachRoute([&records, &count](const ndn::Name &prefix, const FibEntry::NextHops &next_hops) {
+        const ndn::Block &name = prefix.wireEncode();
+        for (const auto &next_hop : next_hops) {
+            std::string value;
+            for (uint32_t number : {next_hop.cost, next_hop.weight}) {
+                for (size_t i = 4; i-- > 0;) {
+                    value.push_back(static_cast<char>(number >> (8 * i)));
+                }
+            }
+            value.append(next_hop.face->getUnderlyingEndpoint());
+            records.append(reinterpret_cast<const char*>(name.wire()), name.size());
+            name_snapshot::writeVarNumber(records, name_snapshot::VALUE);
+            name_snapshot::writeVarNumber(records, value.size());
+            records.append(value);
+            ++count;
+        }
+    });
+    std::string state;
+    name_snapshot::writeHeader(state, count);
+    state.append(records);
+    return state;
+}
+
+size_t NameRouter::restoreRoutesState(const std::string &state, size_t &skipped) {
+    std::unordered_map<std::string, std::shared_ptr<Face>> faces;
+    for (const auto &egress_face : _egress_faces) {
+        faces.emplace(egress_face.second->getUnderlyingEndpoint(), egress_face.second);
+    }
+    const uint8_t *it = reinterpret_cast<const uint8_t*>(state.data());
+    const uint8_t *end = it + state.size();
+    uint32_t type;
+    size_t length = tlv_reader::readHeader(it, end, type);
+    if (type != name_snapshot::HEADER) {
+        throw ndn::tlv::Error("not a routes state");
+    }
+    it += length;
+    // bulk inserted by face and metrics, a route at a time would publish the index as often
+    std::map<std::tuple<std::shared_ptr<Face>, uint32_t, uint32_t>, std::vector<ndn::Name>> routes;
+    size_t count = 0;
+    skipped = 0;
+    while (it != end) {
+        const uint8_t *element = it;
+        length = tlv_reader::readHeader(it, end, type);
+        if (type != ndn::tlv::Name) {
+            throw ndn::tlv::Error("routes state record without Name");
+        }
+        it += length;
+        ndn::Name prefix(ndn::Block(element, it - element));
+        length = tlv_reader::readHeader(it, end, type);
+        if (type != name_snapshot::VALUE || length < 8) {
+            throw ndn::tlv::Error("invalid routes state record");
+        }
+        auto cost = static_cast<uint32_t>(tlv_reader::readNonNegativeInteger(it, 4));
+        auto weight = static_cast<uint32_t>(tlv_reader::readNonNegativeInteger(it + 4, 4));
+        auto face = faces.find(std::string(reinterpret_cast<const char*>(it + 8), length - 8));
+        it += length;
+        if (face == faces.end()) {
+            ++skipped;
+            continue;
+        }
+        routes[std::make_tuple(face->second, cost, weight)].emplace_back(std::move(prefix));
+        ++count;
+    }
+    for (const auto &route : routes) {
+        _fib.insert(std::get<0>(route.first), route.second, std::get<1>(route.first), std::get<2>(route.first));
+    }
+    return count;
+}
+
+void NameRouter::commandExportState(const rapidjson::Document &document) {
+    uint64_t id = document["id"].GetUint();
+    if (!document.HasMember("address") || !document["address"].IsString() || !document.HasMember("port") || !document["port"].IsUint()) {
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << id << R"(, "action":"export_state", "status":"fail", "reason":"address or port not provided"})";
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+        return;
+    }
+    size_t count;
+    auto state = std::make_shared<const std::string>(makeRoutesState(count));
+    std::string address = document["address"].GetString();
+    uint16_t port = static_cast<uint16_t>(document["port"].GetUint());
+    boost::asio::ip::udp::endpoint endpoint = _remote_command_endpoint;
+    state_transfer::send(_control_ios, address, port, state, _control_strand.wrap([this, id, count, address, port, endpoint](const boost::system::error_code &err) {
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << id << R"(, "action":"export_state", )";
+        if (err) {
+            logger::log(logger::ERROR, "routes not sent to {}:{}: {}", {address, port, err.message()});
+            ss << R"("status":"fail", "reason":")" << err.message() << R"("})";
+        } else {
+            logger::log(logger::INFO, "{} routes sent to {}:{}", {count, address, port});
+            ss << R"("status":"success", "routes":)" << count << "}";
+        }
+        _command_socket.send_to(boost::asio::buffer(ss.str()), endpoint);
+    }));
+}
+
+void NameRouter::commandImportState(const rapidjson::Document &document) {
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"import_state", )";
+    if (!document.HasMember("port") || !document["port"].IsUint()) {
+        ss << R"("status":"fail", "reason":"port not provided"})";
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+        return;
+    }
+    uint16_t port = static_cast<uint16_t>(document["port"].GetUint());
+    auto err = state_transfer::receive(_control_ios, port, MAX_STATE_SIZE, STATE_TIMEOUT, _control_strand.wrap(
+            [this](const boost::system::error_code &err, const std::shared_ptr<const std::string> &state) {
+        if (err) {
+            logger::log(logger::ERROR, "routes not received: " + err.message());
+            return;
+        }
+        try {
+            size_t skipped;
+            size_t count = restoreRoutesState(*state, skipped);
+            logger::log(logger::INFO, "{} routes restored, {} of faces unknown here skipped", {count, skipped});
+        } catch (const std::exception &e) {
+            logger::log(logger::ERROR, std::string("routes partially restored: ") + e.what());
+        }
+    }));
+    if (err) {
+        ss << R"("status":"fail", "reason":")" << err.message() << R"("})";
+    } else {
+        ss << R"("status":"success"})";
+    }
+    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+}
+
+void NameRouter::commandPublishFib(const rapidjson::Document &document) {
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"publish_fib", )";
+    if (!document.HasMember("path") || !document["path"].IsString() || document["path"].GetStringLength() == 0) {
+        ss << R"("status":"fail", "reason":"path not provided"})";
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+        return;
+    }
+    std::string path = document["path"].GetString();
+    MappedFib::Builder builder;
+    _fib.forEachRoute([&builder](const ndn::Name &prefix, const FibEntry::NextHops &next_hops) {
+        builder.add(prefix, next_hops);
+    });
+    std::string error;
+    auto previous = MappedFib::open(path, error);
+    uint64_t version = previous ? previous->getVersion() + 1 : 1;
+    previous.reset();
+    if (MappedFib::publish(path, builder.build(version), error)) {
+        logger::log(logger::INFO, "{} routes published to {} as version {}", {builder.getRoutes(), path, version});
+        ss << R"("status":"success", "version":)" << version << R"(, "routes":)" << builder.getRoutes() << "}";
+    } else {
+        logger::log(logger::ERROR, "routes not published to {}: {}", {path, error});
+        ss << R"("status":"fail", "reason":")" << error << R"("})";
+    }
+    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+}
+
+void NameRouter::commandMapFib(const rapidjson::Document &document) {
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"map_fib", )";
+    if (!document.HasMember("path") || !document["path"].IsString()) {
+        ss << R"("status":"fail", "reason":"path not provided"})";
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+        return;
+    }
+    std::string path = document["path"].GetString();
+    if (path.empty()) {
+        _mapped_fib_path.clear();
+        _fib.setMapped(nullptr, nullptr);
+        ss << R"("status":"success"})";
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+        return;
+    }
+    std::string previous_path = _mapped_fib_path;
+    _mapped_fib_path = path;
+    if (previous_path != path) {
+        // another file, whatever its inode
+        _fib.setMapped(nullptr, nullptr);
+    }
+    std::string error;
+    if (refreshMappedFib(error)) {
+        auto mapped = _fib.getMapped();
+        ss << R"("status":"success", "version":)" << mapped->getVersion() << R"(, "routes":)" << mapped->getRoutes() << "}";
+    } else {
+        // the previous mapping is kept
+        _mapped_fib_path = previous_path;
+        ss << R"("status":"fail", "reason":")" << error << R"("})";
+    }
+    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+}
+
+void NameRouter::resolveMappedFib() {
+    auto mapped = _fib.getMapped();
+    if (mapped) {
+        mapFib(mapped);
+    }
+}
+
+void NameRouter::mapFib(const std::shared_ptr<const MappedFib> &mapped) {
+    std::unordered_map<std::string, std::shared_ptr<Face>> faces;
+    for (const auto &egress_face : _egress_faces) {
+        faces.emplace(egress_face.second->getUnderlyingEndpoint(), egress_face.second);
+    }
+    _fib.setMapped(mapped, [&faces](const std::string &endpoint) {
+        auto it = faces.find(endpoint);
+        return it != faces.end() ? it->second : nullptr;
+    });
+}
+
+bool NameRouter::refreshMappedFib(std::string &error) {
+    auto mapped = _fib.getMapped();
+    if (mapped && mapped->isCurrent(_mapped_fib_path)) {
+        return true;
+    }
+    mapped = MappedFib::open(_mapped_fib_path, error);
+    if (!mapped) {
+        return false;
+    }
+    mapFib(mapped);
+    logger::log(logger::INFO, "version {} of the mapped FIB {} with {} routes", {mapped->getVersion(), _mapped_fib_path, mapped->getRoutes()});
+    return true;
+}
+
+void NameRouter::commandBatch(const std::vector<management::Command> &commands) {
+    management::ReplyBatch replies;
+    for (const auto &command : commands) {
+        switch (command.action) {
+            case management::ADD_ROUTE:
+            case management::DEL_ROUTE: {
+                auto it = command.has_face_id ? _egress_faces.find(command.face_id) : _egress_faces.end();
+                if (command.names.empty()) {
+                    replies.add(command.id, command.action, management::FAIL, "empty prefix list");
+                } else if (it == _egress_faces.end()) {
+                    replies.add(command.id, command.action, management::FAIL, "unknown face id");
+                } else if (command.action == management::ADD_ROUTE) {
+                    uint32_t cost = command.has_cost ? static_cast<uint32_t>(command.cost) : FibEntry::DEFAULT_COST;
+                    uint32_t weight = command.has_weight ? static_cast<uint32_t>(command.weight) : FibEntry::DEFAULT_WEIGHT;
+                    _fib.insert(it->second, command.names, cost, weight);
+                    logger::log(logger::INFO, "{} names added by manager for face with ID = {}", {command.names.size(), it->second->getFaceId()});
+                    replies.add(command.id, command.action, management::SUCCESS);
+                } else {
+                    _fib.remove(it->second, command.names);
+                    logger::log(logger::INFO, "{} names removed by manager for face with ID = {}", {command.names.size(), it->second->getFaceId()});
+                    replies.add(command.id, command.action, management::SUCCESS);
+                }
+                break;
+            }
+            case management::LIST: {
+                // the whole tree, the chunks take the place of the pages
+                rapidjson::Document document;
+                document.SetObject();
+                document.AddMember("id", static_cast<unsigned>(command.id), document.GetAllocator());
+                replies.addPayload(command.id, command.action, makeListReply(document));
+                break;
+            }
+            default:
+                replies.add(command.id, command.action, management::FAIL, "action not implemented");
+                break;
+        }
+    }
+    for (const auto &datagram : replies.finish()) {
+        _command_socket.send_to(boost::asio::buffer(datagram), _remote_command_endpoint);
+    }
+}
+
+void NameRouter::writeMetrics(MetricsWriter &writer) {
+    for (const auto &master_face : {_tcp_consumer_master_face, _udp_consumer_master_face, _shm_consumer_master_face,
+                                    _tcp_producer_master_face, _udp_producer_master_face, _shm_producer_master_face}) {
+        master_face->writeMetrics(writer);
+    }
+    BufferPool::getStats().writeMetrics(writer);
+    PageArena::getStats().writeMetrics(writer);
+    stage_profile::writeMetrics(writer);
+    writer.gauge("ndn_fib_logical_entries", "prefixes in the FIB", {}, _fib.getLogicalSize());
+    writer.gauge("ndn_fib_physical_entries", "entries of the FIB once aggregated", {}, _fib.getPhysicalSize());
+    writer.gauge("ndn_return_records", "consumer faces recorded for the Data to come back", {}, _return_table.size());
+}
@@ -2,10 +2,11 @@
 
 #include <ndn-cxx/interest.hpp>
 #include <ndn-cxx/data.hpp>
-#include <ndn-cxx/security/key-chain.hpp>
 
 #include <boost/asio.hpp>
 
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -13,12 +14,41 @@
 
 #include "rapidjson/document.h"
 
-#include "module.h"
+#include "runtime/module.h"
+#include "management/startup_config.h"
+#include "management/management_tlv.h"
 #include "network/face.h"
 #include "network/master_face.h"
+#include "network/tcp_connection_pool.h"
+#include "security/key_store.h"
 #include "fib.h"
+#include "forwarding_stats.h"
+#include "reply_signer.h"
+#include "striped_return_table.h"
 
+// threads: the packets are handled by all the threads of the module (-j, -r), the FIB and the return table are shared
+// and guard themselves, the options they read are atomic and everything else only runs on the control strand
 class NameRouter : public Module {
+    // FIB entries of a paged list reply stop there, leaving room for the faces in the 64KiB datagram
+    static const size_t LIST_PAGE_BYTES = 48 * 1024;
+    // a registration takes about 500 bytes in the request to the manager
+    static const size_t MAX_BATCHED_REGISTRATIONS = 64;
+    static const size_t DEFAULT_REGISTRATION_DELAY = 10;
+    static const boost::posix_time::seconds REQUEST_TIMEOUT;
+    // a new clone is given the routes of a running one, see state_transfer. in bytes and seconds
+    static const size_t MAX_STATE_SIZE = 256 << 20;
+    static const size_t STATE_TIMEOUT = 30;
+
+    // how an Interest picks its next hops among those of the FIB
+    enum Strategy {
+        // all of them
+        MULTICAST,
+        // the first one of lowest cost
+        BEST_ROUTE,
+        // one of lowest cost by weight, chosen by the name_hash of the Interest so a Name always takes the same one
+        WEIGHTED,
+    };
+
     const std::string _name;
 
     Fib _fib;
@@ -26,36 +56,105 @@ class NameRouter : public Module {
     char _command_buffer[65536];
     boost::asio::ip::udp::socket _command_socket;
     boost::asio::ip::udp::endpoint _remote_command_endpoint;
-
-    ndn::KeyChain _keychain;
+    StartupConfig _startup_config;
+    // connections kept open to the endpoints set by edit_config, add_face takes them
+    TcpConnectionPool _connection_pool;
+    // on _control_ios: commands, registrations and face events run there, the threads of the packets never wait on them
+    boost::asio::strand _control_strand;
+
+    // the replies to the registrations, off the control strand with the KeyChain
+    std::unique_ptr<ReplySigner> _reply_signer;
     size_t _request_id = 1;
     std::map<size_t, std::function<void(bool)>> _requests;
-    std::map<size_t, std::shared_ptr<boost::asio::deadline_timer>> _request_timers;
+    // by id, hence by deadline as well
+    std::deque<std::pair<boost::posix_time::ptime, size_t>> _request_deadlines;
+    // the registrations of producers are queued and sent to the manager in a few datagrams every registration_delay,
+    // a storm of producers reconnecting after an outage doesn't flood it
+    std::vector<std::string> _queued_registrations;
+    // registrations checked with _keys, the manager is told about them in the same flushes
+    std::vector<std::string> _queued_routes;
+    // pushed by the manager as to the SVs, a registration signed by one of them isn't sent to the manager
+    KeyStore _keys;
+    boost::asio::deadline_timer _registration_timer;
+    bool _is_registration_timer_armed = false;
+    // in milliseconds
+    size_t _registration_delay = DEFAULT_REGISTRATION_DELAY;
     boost::asio::ip::udp::endpoint _manager_endpoint;
-    bool _check_prefix = false;
+    std::atomic<bool> _check_prefix{false};
+    std::atomic<Strategy> _strategy{MULTICAST};
+    // only the next hops of the longest prefix of the Interest Name, not those of all its prefixes
+    std::atomic<bool> _longest_prefix_match{false};
+    // the Data go back to the consumer faces which asked for them only, rather than to all of them
+    std::atomic<bool> _targeted_return{true};
+    // the Interests with a ForwardingHint are routed on its delegation, on their own Name if it has no route, so that
+    // the routes of the providers stand for all the Names they serve
+    std::atomic<bool> _forwarding_hint{true};
+    StripedReturnTable _return_table;
+    boost::asio::deadline_timer _return_timer;
+    // the Interests are only measured while the forwarding_status reports are sent
+    std::atomic<bool> _report_enable{false};
+    boost::asio::deadline_timer _report_timer;
+    boost::posix_time::milliseconds _delay_between_report;
+    ForwardingStats _forwarding_stats;
+    // in microseconds, only while the metrics are enabled
+    std::shared_ptr<Histogram> _lookup_latency;
 
     std::unordered_map<size_t, std::shared_ptr<Face>> _egress_faces;
+    // the MappedFib the lookups read, mapped again each second once a new version was published there. empty if none
+    std::string _mapped_fib_path;
+    std::string _mapped_fib_error;
     std::shared_ptr<MasterFace> _tcp_consumer_master_face;
     std::shared_ptr<MasterFace> _tcp_producer_master_face;
     std::shared_ptr<MasterFace> _udp_consumer_master_face;
+    std::shared_ptr<MasterFace> _shm_consumer_master_face;
     std::shared_ptr<MasterFace> _udp_producer_master_face;
+    std::shared_ptr<MasterFace> _shm_producer_master_face;
+
+    static const char* toString(Strategy strategy);
+
+    // null if next_hops is empty
+    static const FibEntry::NextHop* selectNextHop(const FibEntry::NextHops &next_hops, Strategy strategy, uint64_t name_hash);
+
+    // the master faces stop accepting, the faces already there are served until the module stops
+    void beginDrain() override;
+
+    // nothing queued on the faces of the master faces, the egress faces belong to the control strand and aren't
+    // looked at
+    bool isDrained() override;
 
 public:
-    NameRouter(const std::string &name, uint16_t local_consumer_port, uint16_t local_producer_port, uint16_t local_command_port);
+    NameRouter(const std::string &name, uint16_t local_consumer_port, uint16_t local_producer_port, uint16_t local_command_port,
+               const std::string &fib_engine = "tree", size_t concurrency = 1, Runtime runtime = SHARED);
 
     ~NameRouter() override = default;
 
     void run() override;
 
-    void onConsumerInterest(const std::shared_ptr<Face> &consumer_face, const ndn::Interest &interest);
+    // the commands applied by run() before the consumers are accepted, see StartupConfig. false if source can't be
+    // read. before start()
+    bool loadStartupConfig(const std::string &source);
+
+    // how the registration replies are signed from now on, see ReplySigner::create. false and unchanged if spec is
+    // invalid. before start
+    bool setReplySigning(const std::string &spec);
 
-    void onConsumerData(const std::shared_ptr<Face> &consumer_face, const ndn::Data &data);
+    void onConsumerPacket(const std::shared_ptr<Face> &consumer_face, const NdnPacket &packet);
 
     void onProducerInterest(const std::shared_ptr<Face> &producer_face, const ndn::Interest &interest);
 
     void onManagerValidation(const std::shared_ptr<Face> &producer_face, const ndn::Interest &interest, const ndn::Name &prefix, bool result);
 
-    void onTimeout(const boost::system::error_code &err, size_t index);
+    void armRegistrationTimer();
+
+    // each second, from the control strand
+    void removeExpiredReturns(const boost::system::error_code &err);
+
+    // sends the registrations and the routes queued and forgets the requests past their deadline, from the control
+    // strand
+    void flushRegistrations(const boost::system::error_code &err);
+
+    // each report_each to the manager, from the control strand
+    void commandReport(const boost::system::error_code &err);
 
     void onProducerData(const std::shared_ptr<Face> &producer_face, const ndn::Data &data);
 
@@ -65,10 +164,16 @@ public:
 
     void onFaceError(const std::shared_ptr<Face> &face);
 
+    // at each scrape, off the control strand: only the master faces and the tables which guard themselves are read
+    void writeMetrics(MetricsWriter &writer);
+
     void commandRead();
 
     void commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred);
 
+    // a parsed command with an action, on _control_strand
+    void executeCommand(const rapidjson::Document &document);
+
     void commandReply(const rapidjson::Document &document);
 
     void commandEditConfig(const rapidjson::Document &document);
@@ -81,5 +186,46 @@ public:
 
     void commandDelRoutes(const rapidjson::Document &document);
 
+    void commandAddKeys(const rapidjson::Document &document);
+
+    void commandDelKeys(const rapidjson::Document &document);
+
     void commandList(const rapidjson::Document &document);
+
+    // the bytes held by the FIB, the side tables and the faces, see MemoryStats
+    void commandMemoryStats(const rapidjson::Document &document);
+
+    std::string makeListReply(const rapidjson::Document &document);
+
+    // a name_snapshot of the routes, a record per next hop giving its cost, its weight and the endpoint of its face,
+    // which a clone has a face to as well
+    std::string makeRoutesState(size_t &count) const;
+
+    // the records of state are routed to the egress faces of the same endpoints, those of the other faces are
+    // skipped. returns the number of routes added
+    size_t restoreRoutesState(const std::string &state, size_t &skipped);
+
+    // the routes are sent to the clone listening on address:port, answered once they are all written
+    void commandExportState(const rapidjson::Document &document);
+
+    // listens for the routes of another clone on port, answered at once. run once its egress faces are added
+    void commandImportState(const rapidjson::Document &document);
+
+    // the routes compiled into a MappedFib at "path", the version after the one there if any
+    void commandPublishFib(const rapidjson::Document &document);
+
+    // the lookups read the MappedFib at "path" on top of the routes of this replica, or stop with an empty path
+    void commandMapFib(const rapidjson::Document &document);
+
+    // the endpoints of mapped are given the egress faces of the same endpoints, then the lookups read it
+    void mapFib(const std::shared_ptr<const MappedFib> &mapped);
+
+    // the endpoints of the MappedFib are given the egress faces again, after each change of them
+    void resolveMappedFib();
+
+    // maps the version at _mapped_fib_path unless it is the one already mapped, false if it can't be mapped
+    bool refreshMappedFib(std::string &error);
+
+    // the commands of a binary batch, answered together
+    void commandBatch(const std::vector<management::Command> &commands);
 };
\ No newline at end of file
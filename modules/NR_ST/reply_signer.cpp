@@ -0,0 +1,104 @@
+#include "reply_signer.h"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
+#include <ndn-cxx/signature.hpp>
+
+#include <openssl/hmac.h>
+#include <openssl/sha.h>
+
+#include <fstream>
+#include <iterator>
+
+#include "log/logger.h"
+
+ReplySigner::ReplySigner(Mode mode, const ndn::Name &key_name, const std::vector<uint8_t> &key)
+        : _mode(mode)
+        , _key_name(key_name)
+        , _key(key) {
+    if (_mode == KEYCHAIN) {
+        _signing_ios_work.reset(new boost::asio::io_service::work(_signing_ios));
+        _signing_thread = boost::thread([this]() {
+            _signing_ios.run();
+        });
+    }
+}
+
+ReplySigner::~ReplySigner() {
+    if (_signing_ios_work) {
+        _signing_ios_work.reset();
+        _signing_thread.join();
+    }
+}
+
+std::unique_ptr<ReplySigner> ReplySigner::create(const std::string &spec) {
+    if (spec == "keychain") {
+        return std::unique_ptr<ReplySigner>(new ReplySigner(KEYCHAIN));
+    }
+    if (spec == "sha256") {
+        return std::unique_ptr<ReplySigner>(new ReplySigner(DIGEST_SHA256));
+    }
+    if (spec.compare(0, 5, "hmac:") != 0) {
+        return nullptr;
+    }
+    size_t colon = spec.find(':', 5);
+    if (colon == std::string::npos || colon == 5 || colon + 1 == spec.size()) {
+        return nullptr;
+    }
+    std::ifstream file(spec.substr(colon + 1), std::ios::binary);
+    std::vector<uint8_t> key((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (key.empty()) {
+        return nullptr;
+    }
+    try {
+        return std::unique_ptr<ReplySigner>(new ReplySigner(HMAC_SHA256, ndn::Name(spec.substr(5, colon - 5)), key));
+    } catch (const std::exception &e) {
+        return nullptr;
+    }
+}
+
+ReplySigner::Mode ReplySigner::getMode() const {
+    return _mode;
+}
+
+void ReplySigner::signLocally(ndn::Data &data) const {
+    if (_mode == DIGEST_SHA256) {
+        data.setSignature(ndn::Signature(ndn::SignatureInfo(ndn::tlv::SignatureTypeValue::DigestSha256)));
+    } else {
+        data.setSignature(ndn::Signature(ndn::SignatureInfo(ndn::tlv::SignatureTypeValue::SignatureHmacWithSha256,
+                                                            ndn::KeyLocator(_key_name))));
+    }
+    ndn::EncodingBuffer encoder;
+    data.wireEncode(encoder, true);
+    uint8_t value[SHA256_DIGEST_LENGTH];
+    unsigned int size = SHA256_DIGEST_LENGTH;
+    if (_mode == DIGEST_SHA256) {
+        SHA256(encoder.buf(), encoder.size(), value);
+    } else {
+        HMAC(EVP_sha256(), _key.data(), static_cast<int>(_key.size()), encoder.buf(), encoder.size(), value, &size);
+    }
+    data.wireEncode(encoder, ndn::makeBinaryBlock(ndn::tlv::SignatureValue, value, size));
+}
+
+void ReplySigner::sign(ndn::Data &data, const Callback &callback) {
+    if (_mode != KEYCHAIN) {
+        signLocally(data);
+        callback(data);
+        return;
+    }
+    auto copy = std::make_shared<ndn::Data>(data);
+    _signing_ios.post([this, copy, callback]() {
+        try {
+            if (!_keychain) {
+                // opens the PIB and the TPM, at the first registration rather than at startup
+                _keychain.reset(new ndn::KeyChain());
+            }
+            _keychain->sign(*copy);
+        } catch (const std::exception &e) {
+            // no reply, the producer registers again
+            logger::log(logger::ERROR, "can't sign the registration reply ({})", {e.what()});
+            return;
+        }
+        callback(*copy);
+    });
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/security/key-chain.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// the signature of the replies to the registrations of the producers. with the KeyChain, RSA or ECDSA with the
+// default identity, a signature takes a millisecond or more: the replies are signed on a thread of their own, which
+// opens the PIB and the TPM at the first one, and a storm of registrations doesn't hold the control strand. a local
+// producer can do with a DigestSha256 or an HMAC with a key shared with it, both signed at once by the caller
+class ReplySigner {
+public:
+    enum Mode {
+        // the default key of the KeyChain, on the signing thread
+        KEYCHAIN,
+        DIGEST_SHA256,
+        // SignatureHmacWithSha256, the KeyLocator is the name of the key
+        HMAC_SHA256,
+    };
+
+    // the Data signed, on the signing thread with KEYCHAIN
+    typedef std::function<void(const ndn::Data&)> Callback;
+
+private:
+    const Mode _mode;
+    const ndn::Name _key_name;
+    const std::vector<uint8_t> _key;
+
+    // only with KEYCHAIN
+    std::unique_ptr<ndn::KeyChain> _keychain;
+    boost::asio::io_service _signing_ios;
+    std::unique_ptr<boost::asio::io_service::work> _signing_ios_work;
+    boost::thread _signing_thread;
+
+    // the DigestSha256 or the HMAC of the signed portion of data
+    void signLocally(ndn::Data &data) const;
+
+public:
+    explicit ReplySigner(Mode mode, const ndn::Name &key_name = ndn::Name(), const std::vector<uint8_t> &key = {});
+
+    ReplySigner(const ReplySigner&) = delete;
+
+    ReplySigner& operator=(const ReplySigner&) = delete;
+
+    // the replies queued are signed and their callbacks run before it returns
+    ~ReplySigner();
+
+    // "keychain", "sha256" or "hmac:KEY_NAME:FILE", FILE holding the raw bytes of the key. null if spec is invalid or
+    // the key can't be read
+    static std::unique_ptr<ReplySigner> create(const std::string &spec);
+
+    Mode getMode() const;
+
+    // data is copied if it has to wait for the signing thread, callback may run before this returns
+    void sign(ndn::Data &data, const Callback &callback);
+};
\ No newline at end of file
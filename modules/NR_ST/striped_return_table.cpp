@@ -0,0 +1,128 @@
+#include "striped_return_table.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+
+const ndn::time::milliseconds StripedReturnTable::DEFAULT_TTL {4000};
+
+StripedReturnTable::StripedReturnTable()
+        : _max_stripe_records(DEFAULT_MAX_RECORDS / STRIPES)
+        , _ttl_ms(DEFAULT_TTL.count())
+        , _returned(0)
+        , _missed(0)
+        , _overflowed(0)
+        , _expired(0) {
+
+}
+
+StripedReturnTable::Stripe& StripedReturnTable::getStripe(uint64_t name_hash) {
+    // the low bits pick the bucket in the stripe, the high ones the stripe
+    return _stripes[(name_hash >> 58) % STRIPES];
+}
+
+bool StripedReturnTable::insert(uint64_t name_hash, const std::shared_ptr<Face> &face, const Clock::time_point &now) {
+    auto ref = FaceTable::global().getRef(face);
+    auto expires = now + ndn::time::milliseconds(_ttl_ms.load(std::memory_order_relaxed));
+    Stripe &stripe = getStripe(name_hash);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto it = stripe.records.find(name_hash);
+    if (it == stripe.records.end()) {
+        if (stripe.records.size() >= _max_stripe_records.load(std::memory_order_relaxed)) {
+            ++_overflowed;
+            return false;
+        }
+        it = stripe.records.emplace(name_hash, Record()).first;
+    }
+    FaceTable::add(it->second.faces, ref);
+    it->second.expires = expires;
+    return true;
+}
+
+bool StripedReturnTable::take(const ndn::Name &name, FaceTable::Faces &faces, const Clock::time_point &now) {
+    bool found = false;
+    uint64_t hash = name_hash::SEED;
+    for (size_t length = 0; length <= name.size(); ++length) {
+        if (length > 0) {
+            hash = name_hash::extend(hash, name_hash::toRef(name.get(length - 1)));
+        }
+        Stripe &stripe = getStripe(hash);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.records.find(hash);
+        if (it == stripe.records.end()) {
+            continue;
+        }
+        if (it->second.expires > now) {
+            FaceTable::global().resolve(it->second.faces, faces);
+            found = true;
+        }
+        stripe.records.erase(it);
+    }
+    ++(found ? _returned : _missed);
+    return found;
+}
+
+size_t StripedReturnTable::removeExpired(const Clock::time_point &now) {
+    size_t removed = 0;
+    for (auto &stripe : _stripes) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (auto it = stripe.records.begin(); it != stripe.records.end();) {
+            if (it->second.expires <= now) {
+                it = stripe.records.erase(it);
+                ++removed;
+            } else {
+                ++it;
+            }
+        }
+    }
+    _expired += removed;
+    return removed;
+}
+
+size_t StripedReturnTable::size() {
+    size_t size = 0;
+    for (auto &stripe : _stripes) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        size += stripe.records.size();
+    }
+    return size;
+}
+
+size_t StripedReturnTable::getMaxRecords() const {
+    return _max_stripe_records.load() * STRIPES;
+}
+
+void StripedReturnTable::setMaxRecords(size_t max_records) {
+    // the records over it are only removed as they expire
+    _max_stripe_records = std::max<size_t>(max_records / STRIPES, 1);
+}
+
+ndn::time::milliseconds StripedReturnTable::getTtl() const {
+    return ndn::time::milliseconds(_ttl_ms.load());
+}
+
+void StripedReturnTable::setTtl(const ndn::time::milliseconds &ttl) {
+    _ttl_ms = ttl.count();
+}
+
+size_t StripedReturnTable::getMemoryUsage() {
+    size_t bytes = 0;
+    for (auto &stripe : _stripes) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        bytes += memory_usage::of(stripe.records);
+        for (const auto &record : stripe.records) {
+            bytes += memory_usage::of(record.second.faces);
+        }
+    }
+    return bytes;
+}
+
+std::string StripedReturnTable::toJSON() {
+    std::stringstream ss;
+    ss << R"({"records":)" << size() << R"(, "max_records":)" << getMaxRecords() << R"(, "ttl":)" << _ttl_ms.load()
+       << R"(, "returned":)" << _returned.load() << R"(, "missed":)" << _missed.load()
+       << R"(, "overflowed":)" << _overflowed.load() << R"(, "expired":)" << _expired.load() << "}";
+    return ss.str();
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "network/face.h"
+#include "network/face_table.h"
+
+// the consumer faces which sent an Interest forwarded to the producers, so that its Data only goes back to them: a
+// record by name_hash of the Interest Name with its faces and a deadline, none of the nonces nor the aggregation of
+// a PIT. the records are spread over stripes with a lock each, the threads of the module seldom meet on one. a Data
+// without a record, e.g. after a collision or once full, is sent to all the consumer faces as before. unlike the
+// lock-free ReturnTable of the strategy routers, a record is bounded by max_records and taken by its Data
+class StripedReturnTable {
+public:
+    using Clock = ndn::time::steady_clock;
+
+    static const size_t DEFAULT_MAX_RECORDS = 65536;
+    // the default Interest lifetime
+    static const ndn::time::milliseconds DEFAULT_TTL;
+
+private:
+    static const size_t STRIPES = 64;
+
+    struct Record {
+        FaceTable::Refs faces;
+        Clock::time_point expires;
+    };
+
+    struct alignas(64) Stripe {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, Record> records;
+    };
+
+    Stripe _stripes[STRIPES];
+    std::atomic<size_t> _max_stripe_records;
+    std::atomic<int64_t> _ttl_ms;
+    std::atomic<size_t> _returned;
+    std::atomic<size_t> _missed;
+    std::atomic<size_t> _overflowed;
+    std::atomic<size_t> _expired;
+
+    Stripe& getStripe(uint64_t name_hash);
+
+public:
+    StripedReturnTable();
+
+    StripedReturnTable(const StripedReturnTable&) = delete;
+
+    StripedReturnTable& operator=(const StripedReturnTable&) = delete;
+
+    // false if the stripe of the Name is full, nothing is recorded then
+    bool insert(uint64_t name_hash, const std::shared_ptr<Face> &face, const Clock::time_point &now = Clock::now());
+
+    // the faces of the records of name and of its prefixes, for the CanBePrefix Interests, are appended to faces and
+    // the records removed. false if there were none
+    bool take(const ndn::Name &name, FaceTable::Faces &faces, const Clock::time_point &now = Clock::now());
+
+    size_t removeExpired(const Clock::time_point &now = Clock::now());
+
+    size_t size();
+
+    size_t getMaxRecords() const;
+
+    void setMaxRecords(size_t max_records);
+
+    ndn::time::milliseconds getTtl() const;
+
+    void setTtl(const ndn::time::milliseconds &ttl);
+
+    std::string toJSON();
+
+    // of the records of all the stripes
+    size_t getMemoryUsage();
+};
\ No newline at end of file
@@ -2,27 +2,114 @@
 
 #include "packet_dispather.h"
 #include "log/logger.h"
+#include "network/page_arena.h"
+#include "network/packet_capture.h"
+#include "network/tracer.h"
 
-static bool stop = false;
-static void signal_handler(int signum) {
-    stop = true;
+// address:port, the port is 0 if it is missing
+static void parsePath(const std::string &path, std::string &remote_ip, uint16_t &remote_port) {
+    size_t colon = path.rfind(':');
+    remote_ip = path.substr(0, colon);
+    remote_port = colon == std::string::npos ? 0 : std::atoi(path.c_str() + colon + 1);
 }
 
 int main(int argc, char *argv[]) {
+    uint16_t local_port = PacketDispatcher::DEFAULT_PORT;
+    uint16_t local_command_port = PacketDispatcher::DEFAULT_COMMAND_PORT;
+    size_t concurrency = PacketDispatcher::DEFAULT_CONCURRENCY;
+    std::string layer = "tcp";
+    std::string consumer_path;
+    std::string producer_path;
+    // "thp", "2M" or "1G", optionally ":local", the pages of the session tables, see PageArena
+    std::string pages = "";
+    // in milliseconds, SIGINT or SIGTERM lets the module drain that long at most before it stops
+    size_t drain_timeout = 2000;
+    // 0 for no metrics endpoint
+    uint16_t metrics_port = 0;
+    // one packet in trace_sampling is traced through the chain, see Tracer, 0 for none
+    uint64_t trace_sampling = 0;
+    // "directory[:file_mb[:files]]", the packets of the faces are captured there for ndnms-bench -R, see PacketCapture
+    std::string capture = "";
+    // a file or the JSON of the commands applied before the module listens, see StartupConfig
+    std::string startup_config = "";
+
+    for (int i = 1; i < argc; i += 2) {
+        switch (argv[i][1]) {
+            case 'p':
+                local_port = std::atoi(argv[i + 1]);
+                break;
+            case 'C':
+                local_command_port = std::atoi(argv[i + 1]);
+                break;
+            case 'j':
+                concurrency = std::max(std::atoi(argv[i + 1]), 1);
+                break;
+            case 'l':
+                layer = argv[i + 1];
+                break;
+            case 'c':
+                consumer_path = argv[i + 1];
+                break;
+            case 's':
+                producer_path = argv[i + 1];
+                break;
+            case 'H':
+                pages = argv[i + 1];
+                break;
+            case 'g':
+                drain_timeout = std::atoi(argv[i + 1]);
+                break;
+            case 'M':
+                metrics_port = std::atoi(argv[i + 1]);
+                break;
+            case 'T':
+                trace_sampling = std::strtoull(argv[i + 1], nullptr, 10);
+                break;
+            case 'R':
+                capture = argv[i + 1];
+                break;
+            case 'F':
+                startup_config = argv[i + 1];
+                break;
+            case 'h':
+            default:
+                exit(0);
+                break;
+        }
+    }
+
     logger::setFilename("logs.txt");
     logger::isTee(true);
     logger::setMinimalLogLevel(logger::INFO);
+    Tracer::setSampling(trace_sampling);
+    if (!capture.empty() && !PacketCapture::start(capture)) {
+        logger::log(logger::WARNING, "the packets can't be captured in {}", {capture});
+    }
+    if (!pages.empty() && !PageArena::enable(pages)) {
+        logger::log(logger::WARNING, "invalid pages {}, the tables are kept in the heap", {pages});
+    }
 
-    PacketDispatcher packet_dispatcher;
+    PacketDispatcher packet_dispatcher(local_port, local_command_port, concurrency);
+    std::string remote_ip;
+    uint16_t remote_port;
+    if (!consumer_path.empty()) {
+        parsePath(consumer_path, remote_ip, remote_port);
+        packet_dispatcher.setConsumerPath(layer, remote_ip, remote_port);
+    }
+    if (!producer_path.empty()) {
+        parsePath(producer_path, remote_ip, remote_port);
+        packet_dispatcher.setProducerPath(layer, remote_ip, remote_port);
+    }
+    if (metrics_port != 0) {
+        packet_dispatcher.enableMetrics(metrics_port);
+    }
+    if (!startup_config.empty() && !packet_dispatcher.loadStartupConfig(startup_config)) {
+        logger::log(logger::ERROR, "the startup configuration {} can't be read", {startup_config});
+        return -1;
+    }
     packet_dispatcher.start();
 
-    signal(SIGINT, signal_handler);
-
-    do {
-        sleep(15);
-    }while(!stop);
-
-    packet_dispatcher.stop();
+    packet_dispatcher.waitForStop(boost::posix_time::milliseconds(drain_timeout));
 
     return 0;
 }
\ No newline at end of file
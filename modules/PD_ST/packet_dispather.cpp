@@ -9,65 +9,107 @@
 #include "network/udp_master_face.h"
 #include "network/udp_face.h"
 #include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+#include "metrics/stage_profile.h"
 
-size_t PacketDispatcher::Session::session_count = 0;
+std::atomic<size_t> PacketDispatcher::Session::session_count{0};
 
-PacketDispatcher::Session::Session(PacketDispatcher &packet_dispatcher, boost::asio::ip::tcp::socket&& socket)
-        : _packet_dispatcher(packet_dispatcher), _session_id(++session_count) {
+PacketDispatcher::Session::Session(PacketDispatcher &packet_dispatcher, boost::asio::io_service &ios, const std::shared_ptr<Face> &face, bool is_datagram)
+        : _packet_dispatcher(packet_dispatcher), _ios(ios), _session_id(++session_count)
+        , _is_multiplexed(is_datagram || packet_dispatcher._egress_pool_size > 0)
+        , _is_datagram(is_datagram)
+        , _bidirectionnal_face(face)
+        , _producer_layer(packet_dispatcher._producer_layer)
+        , _producer_remote_ip(packet_dispatcher._producer_remote_ip)
+        , _producer_remote_port(packet_dispatcher._producer_remote_port) {
     std::cout << "new session with ID = " << _session_id;
-    _bidirectionnal_face = std::make_shared<TcpFace>(std::move(socket));
-    if(packet_dispatcher._consumer_layer == "udp") {
-        _consumer_face = std::make_shared<UdpFace>(_packet_dispatcher._ios, _packet_dispatcher._consumer_remote_ip, _packet_dispatcher._consumer_remote_port);
-    } else {
-        _consumer_face = std::make_shared<TcpFace>(_packet_dispatcher._ios, _packet_dispatcher._consumer_remote_ip, _packet_dispatcher._consumer_remote_port);
-    }
-    if(packet_dispatcher._producer_layer == "udp") {
-        _producer_face = std::make_shared<UdpFace>(_packet_dispatcher._ios, _packet_dispatcher._producer_remote_ip, _packet_dispatcher._producer_remote_port);
-    } else {
-        _producer_face = std::make_shared<TcpFace>(_packet_dispatcher._ios, _packet_dispatcher._producer_remote_ip, _packet_dispatcher._producer_remote_port);
+    if (_is_multiplexed) {
+        std::cout << " multiplexed on the egress pool" << std::endl;
+        return;
     }
-    std::cout << " connected to " << _packet_dispatcher._consumer_remote_ip << ":" << _packet_dispatcher._consumer_remote_port << " and "
-              << _packet_dispatcher._producer_remote_ip << ":" << _packet_dispatcher._producer_remote_port << std::endl;
+    _consumer_face = createEgressFace(packet_dispatcher._consumer_layer, packet_dispatcher._consumer_remote_ip, packet_dispatcher._consumer_remote_port);
+    std::cout << " connected to " << _packet_dispatcher._consumer_remote_ip << ":" << _packet_dispatcher._consumer_remote_port << std::endl;
 }
 
 PacketDispatcher::Session::~Session() {
     std::cout << "session with ID = " << _session_id << " destroyed" << std::endl;
 }
 
+size_t PacketDispatcher::Session::getSessionId() const {
+    return _session_id;
+}
+
+std::shared_ptr<Face> PacketDispatcher::Session::createEgressFace(const std::string &layer, const std::string &remote_ip, uint16_t remote_port) {
+    if(layer == "udp") {
+        return std::make_shared<UdpFace>(_ios, remote_ip, remote_port);
+    } else {
+        return _packet_dispatcher._connection_pool.makeFace(_ios, remote_ip, remote_port);
+    }
+}
+
+const std::shared_ptr<Face>& PacketDispatcher::Session::getProducerFace() {
+    if (!_producer_face) {
+        _producer_face = createEgressFace(_producer_layer, _producer_remote_ip, _producer_remote_port);
+        _producer_face->open(PacketHandler::bind<PacketDispatcher::Session, &PacketDispatcher::Session::onPacket2>(this),
+                             boost::bind(&PacketDispatcher::Session::onFaceError, this, _1));
+    }
+    return _producer_face;
+}
+
 void PacketDispatcher::Session::start() {
-    _bidirectionnal_face->open(boost::bind(&PacketDispatcher::Session::onInterest, this, _1, _2),
-                               boost::bind(&PacketDispatcher::Session::onData, this, _1, _2),
-                               boost::bind(&PacketDispatcher::Session::onFaceError, this, _1));
-    _consumer_face->open(boost::bind(&PacketDispatcher::Session::onInterest2, this, _1, _2),
-                         boost::bind(&PacketDispatcher::Session::onData2, this, _1, _2),
-                         boost::bind(&PacketDispatcher::Session::onFaceError, this, _1));
-    _producer_face->open(boost::bind(&PacketDispatcher::Session::onInterest2, this, _1, _2),
-                         boost::bind(&PacketDispatcher::Session::onData2, this, _1, _2),
+    if (!_is_datagram) {
+        _bidirectionnal_face->open(PacketHandler::bind<PacketDispatcher::Session, &PacketDispatcher::Session::onPacket>(this),
+                                   boost::bind(&PacketDispatcher::Session::onFaceError, this, _1));
+    }
+    if (_is_multiplexed) {
+        std::lock_guard<std::mutex> lock(_packet_dispatcher._pool_mutex);
+        _packet_dispatcher._multiplexed_sessions.emplace(_session_id, shared_from_this());
+        return;
+    }
+    _consumer_face->open(PacketHandler::bind<PacketDispatcher::Session, &PacketDispatcher::Session::onPacket2>(this),
                          boost::bind(&PacketDispatcher::Session::onFaceError, this, _1));
 }
 
 void PacketDispatcher::Session::stop() {
     _bidirectionnal_face->close();
-    _consumer_face->close();
-    _producer_face->close();
-}
-
-void PacketDispatcher::Session::onInterest(const std::shared_ptr<Face> &face, const ndn::Interest &interest) {
-    static const ndn::Name localhost("/localhost");
-    static const ndn::Name localhop("/localhop");
-    (localhost.isPrefixOf(interest.getName()) || localhop.isPrefixOf(interest.getName()) ? _producer_face : _consumer_face)->send(interest);
+    if (_consumer_face) {
+        _consumer_face->close();
+    }
+    if (_producer_face) {
+        _producer_face->close();
+    }
+    if (_is_multiplexed) {
+        std::lock_guard<std::mutex> lock(_packet_dispatcher._pool_mutex);
+        _packet_dispatcher._multiplexed_sessions.erase(_session_id);
+    }
 }
 
-void PacketDispatcher::Session::onData(const std::shared_ptr<Face> &face, const ndn::Data &data) {
-    _producer_face->send(data);
+void PacketDispatcher::Session::send(const NdnPacket &packet) {
+    _bidirectionnal_face->send(packet);
 }
 
-void PacketDispatcher::Session::onInterest2(const std::shared_ptr<Face> &face, const ndn::Interest &interest) {
-    _bidirectionnal_face->send(interest);
+void PacketDispatcher::Session::onPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST:
+            if (packet.isLocalScope()) {
+                getProducerFace()->send(packet);
+            } else if (_is_multiplexed) {
+                _packet_dispatcher.sendToPool(_session_id, packet);
+            } else {
+                _consumer_face->send(packet);
+            }
+            break;
+        case NdnPacket::DATA:
+            getProducerFace()->send(packet);
+            break;
+        default:
+            break;
+    }
 }
 
-void PacketDispatcher::Session::onData2(const std::shared_ptr<Face> &face, const ndn::Data &data) {
-    _bidirectionnal_face->send(data);
+void PacketDispatcher::Session::onPacket2(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    _bidirectionnal_face->send(packet);
 }
 
 void PacketDispatcher::Session::onFaceError(const std::shared_ptr<Face> &egress_face) {
@@ -75,63 +117,197 @@ void PacketDispatcher::Session::onFaceError(const std::shared_ptr<Face> &egress_
 }
 
 
-PacketDispatcher::PacketDispatcher()
-        : Module(1)
-        , _acceptor(_ios, {{}, 6360})
-        , _acceptor_socket(_ios)
-        , _command_socket(_ios, {{}, 10002}){
+PacketDispatcher::PacketDispatcher(uint16_t local_port, uint16_t local_command_port, size_t concurrency)
+        : CoreModule(concurrency)
+        , _local_port(local_port)
+        , _acceptor(_ios, {{}, local_port})
+        , _command_socket(_ios, {{}, local_command_port})
+        , _startup_config(false)
+        , _connection_pool(_ios)
+        , _session_pit(SESSION_PIT_SIZE) {
+    _metrics.addCollector(boost::bind(&PacketDispatcher::writeMetrics, this, _1));
+}
+
+void PacketDispatcher::setConsumerPath(const std::string &layer, const std::string &remote_ip, uint16_t remote_port) {
+    std::lock_guard<std::mutex> lock(_pool_mutex);
+    _consumer_layer = layer;
+    _consumer_remote_ip = remote_ip;
+    _consumer_remote_port = remote_port;
+}
 
+void PacketDispatcher::setProducerPath(const std::string &layer, const std::string &remote_ip, uint16_t remote_port) {
+    _producer_layer = layer;
+    _producer_remote_ip = remote_ip;
+    _producer_remote_port = remote_port;
 }
 
 void PacketDispatcher::run() {
+    // before the first session is accepted, the commands are then read as usual
+    _startup_config.apply(_ios, _remote_command_endpoint, [this](const rapidjson::Document &command) {
+        executeCommand(command);
+    });
     commandRead();
     accept();
+    listenUdp();
+}
+
+bool PacketDispatcher::loadStartupConfig(const std::string &source) {
+    return _startup_config.load(source);
+}
+
+void PacketDispatcher::beginDrain() {
+    boost::system::error_code err;
+    _acceptor.close(err);
+    for (const auto &master_face : _ingress_master_faces) {
+        master_face->stopAccepting();
+    }
+}
+
+bool PacketDispatcher::isDrained() {
+    size_t queued = 0;
+    for (const auto &master_face : _ingress_master_faces) {
+        queued += master_face->getQueuedPackets();
+    }
+    std::lock_guard<std::mutex> guard(_pool_mutex);
+    for (const auto &face : _egress_pool) {
+        if (face) {
+            queued += face->getQueueStats().packets;
+        }
+    }
+    return queued == 0;
 }
 
 
 void PacketDispatcher::accept() {
-    _acceptor.async_accept(_acceptor_socket, boost::bind(&PacketDispatcher::acceptHandler, this, _1));
+    _acceptor_service = &nextCoreService();
+    _acceptor_socket.reset(new boost::asio::ip::tcp::socket(*_acceptor_service));
+    _acceptor.async_accept(*_acceptor_socket, boost::bind(&PacketDispatcher::acceptHandler, this, _1));
 }
 
 void PacketDispatcher::acceptHandler(const boost::system::error_code &err) {
     if (!err) {
-        auto session = std::make_shared<Session>(*this, std::move(_acceptor_socket));
+        // the session is built here, with the config as it is now, then runs on the worker of its socket
+        auto face = std::make_shared<TcpFace>(std::move(*_acceptor_socket));
+        auto session = std::make_shared<Session>(*this, *_acceptor_service, face, false);
         session->start();
         _sessions.emplace(session);
         accept();
-    } else {
+    } else if (err != boost::asio::error::operation_aborted) {
         std::cerr << "accept error" << std::endl;
     }
 }
 
+void PacketDispatcher::listenUdp() {
+    _udp_master_face = std::make_shared<UdpMasterFace>(nextCoreService(), MasterFace::DEFAULT_MAX_CONNECTION, _local_port);
+    _udp_master_face->listen(boost::bind(&PacketDispatcher::onUdpFace, this, _1, _2),
+                             PacketHandler::bind<PacketDispatcher, &PacketDispatcher::onUdpPacket>(this),
+                             boost::bind(&PacketDispatcher::onUdpFaceError, this, _1, _2));
+    _ingress_master_faces.emplace_back(_udp_master_face);
+}
+
+void PacketDispatcher::onUdpFace(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
+    // no connection to open, the consumer path is the egress pool already
+    auto session = std::make_shared<Session>(*this, master_face->get_io_service(), face, true);
+    session->start();
+    _udp_sessions.emplace(face->getFaceId(), session);
+}
+
+void PacketDispatcher::onUdpPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    auto it = _udp_sessions.find(face->getFaceId());
+    if (it != _udp_sessions.end()) {
+        it->second->onPacket(face, packet);
+    }
+}
+
+void PacketDispatcher::onUdpFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
+    auto it = _udp_sessions.find(face->getFaceId());
+    if (it != _udp_sessions.end()) {
+        auto session = std::move(it->second);
+        _udp_sessions.erase(it);
+        session->stop();
+    }
+}
+
+const std::shared_ptr<Face>& PacketDispatcher::getPoolFace(size_t session_id) {
+    auto &face = _egress_pool[session_id % _egress_pool.size()];
+    if (!face) {
+        if (_consumer_layer == "udp") {
+            face = std::make_shared<UdpFace>(nextCoreService(), _consumer_remote_ip, _consumer_remote_port);
+        } else {
+            face = _connection_pool.makeFace(nextCoreService(), _consumer_remote_ip, _consumer_remote_port);
+        }
+        face->open(PacketHandler::bind<PacketDispatcher, &PacketDispatcher::onPoolPacket>(this),
+                   boost::bind(&PacketDispatcher::onPoolFaceError, this, _1));
+    }
+    return face;
+}
+
+void PacketDispatcher::resetEgressPool() {
+    for (const auto &face : _egress_pool) {
+        if (face) {
+            face->close();
+        }
+    }
+    _egress_pool.assign(_egress_pool_size, nullptr);
+}
+
+void PacketDispatcher::sendToPool(size_t session_id, const NdnPacket &packet) {
+    std::lock_guard<std::mutex> lock(_pool_mutex);
+    if (_egress_pool.empty()) {
+        // the pool was disabled after the session started, it keeps sharing the faces of a pool of 1
+        _egress_pool.resize(1);
+    }
+    _session_pit.insert(packet, session_id);
+    getPoolFace(session_id)->send(packet);
+}
+
+void PacketDispatcher::onPoolPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    // only Data come back on the consumer path
+    if (packet.getType() != NdnPacket::DATA) {
+        return;
+    }
+    std::vector<std::shared_ptr<Session>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(_pool_mutex);
+        for (size_t session_id : _session_pit.get(packet.getNameView())) {
+            auto it = _multiplexed_sessions.find(session_id);
+            if (it != _multiplexed_sessions.end()) {
+                if (auto session = it->second.lock()) {
+                    sessions.emplace_back(std::move(session));
+                }
+            }
+        }
+    }
+    // the faces of the sessions take packets from any thread
+    for (const auto &session : sessions) {
+        session->send(packet);
+    }
+}
+
+void PacketDispatcher::onPoolFaceError(const std::shared_ptr<Face> &face) {
+    // the slot is opened again by the next Interest, the sessions outlive their pool face
+    std::lock_guard<std::mutex> lock(_pool_mutex);
+    for (auto &pool_face : _egress_pool) {
+        if (pool_face == face) {
+            pool_face->close();
+            pool_face = nullptr;
+        }
+    }
+}
+
 void PacketDispatcher::commandRead() {
     _command_socket.async_receive_from(boost::asio::buffer(_command_buffer, 65536), _remote_command_endpoint,
                                        boost::bind(&PacketDispatcher::commandReadHandler, this, _1, _2));
 }
 
 void PacketDispatcher::commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred) {
-    enum action_type {
-        EDIT_CONFIG,
-    };
-
-    static const std::map<std::string, action_type> ACTIONS = {
-            {"edit_config", EDIT_CONFIG},
-    };
-
     if(!err) {
         try {
             rapidjson::Document document;
             document.Parse(_command_buffer, bytes_transferred);
             if(!document.HasParseError()){
                 if(document.HasMember("action") && document["action"].IsString()){
-                    auto it = ACTIONS.find(document["action"].GetString());
-                    if(it != ACTIONS.end()) {
-                        switch (it->second) {
-                            case EDIT_CONFIG:
-                                commandEditConfig(document);
-                                break;
-                        }
-                    }
+                    executeCommand(document);
                 } else{
                     std::string response = R"({"status":"fail", "reason":"action not provided or not implemented"})";
                     _command_socket.send_to(boost::asio::buffer(response), _remote_command_endpoint);
@@ -150,6 +326,31 @@ void PacketDispatcher::commandReadHandler(const boost::system::error_code &err,
     }
 }
 
+void PacketDispatcher::executeCommand(const rapidjson::Document &document) {
+    enum action_type {
+        EDIT_CONFIG,
+        MEMORY_STATS,
+    };
+
+    static const std::map<std::string, action_type> ACTIONS = {
+            {"edit_config", EDIT_CONFIG},
+            {"memory_stats", MEMORY_STATS},
+    };
+
+    auto it = ACTIONS.find(document["action"].GetString());
+    if (it == ACTIONS.end()) {
+        return;
+    }
+    switch (it->second) {
+        case EDIT_CONFIG:
+            commandEditConfig(document);
+            break;
+        case MEMORY_STATS:
+            commandMemoryStats(document);
+            break;
+    }
+}
+
 void PacketDispatcher::commandEditConfig(const rapidjson::Document &document) {
     std::vector<std::string> changes;
     if (document.HasMember("id") && document["id"].IsUint()) {
@@ -161,7 +362,13 @@ void PacketDispatcher::commandEditConfig(const rapidjson::Document &document) {
     }
     if (document.HasMember("consumer_path_address") && document["consumer_path_address"].IsString() &&
             document.HasMember("consumer_path_port") && document["consumer_path_port"].IsUint()) {
+        std::lock_guard<std::mutex> lock(_pool_mutex);
         bool has_change = false;
+        if (document.HasMember("consumer_path_layer") && document["consumer_path_layer"].IsString() &&
+                _consumer_layer != document["consumer_path_layer"].GetString()) {
+            _consumer_layer = document["consumer_path_layer"].GetString();
+            has_change = true;
+        }
         if (_consumer_remote_ip != document["consumer_path_address"].GetString()) {
             _consumer_remote_ip = document["consumer_path_address"].GetString();
             has_change = true;
@@ -172,11 +379,17 @@ void PacketDispatcher::commandEditConfig(const rapidjson::Document &document) {
         }
         if (has_change) {
             changes.emplace_back(R"("consumer_path")");
+            resetEgressPool();
         }
     }
     if (document.HasMember("producer_path_address") && document["producer_path_address"].IsString() &&
         document.HasMember("producer_path_port") && document["producer_path_port"].IsUint()) {
         bool has_change = false;
+        if (document.HasMember("producer_path_layer") && document["producer_path_layer"].IsString() &&
+                _producer_layer != document["producer_path_layer"].GetString()) {
+            _producer_layer = document["producer_path_layer"].GetString();
+            has_change = true;
+        }
         if (_producer_remote_ip != document["producer_path_address"].GetString()) {
             _producer_remote_ip = document["producer_path_address"].GetString();
             has_change = true;
@@ -189,6 +402,19 @@ void PacketDispatcher::commandEditConfig(const rapidjson::Document &document) {
             changes.emplace_back(R"("producer_path")");
         }
     }
+    if (document.HasMember("egress_pool_size") && document["egress_pool_size"].IsUint()) {
+        size_t egress_pool_size = document["egress_pool_size"].GetUint();
+        std::lock_guard<std::mutex> lock(_pool_mutex);
+        if (egress_pool_size != _egress_pool_size) {
+            // only sessions accepted from now on are affected, the multiplexed ones move to the new pool
+            _egress_pool_size = egress_pool_size;
+            resetEgressPool();
+            changes.emplace_back(R"("egress_pool_size")");
+        }
+    }
+    if (document.HasMember("connection_pool") && _connection_pool.update(document["connection_pool"])) {
+        changes.emplace_back(R"("connection_pool")");
+    }
     if (document.HasMember("id") && document["id"].IsUint()) {
         _module_id = document["id"].GetUint();
         id_set = true;
@@ -213,3 +439,41 @@ void PacketDispatcher::commandEditConfig(const rapidjson::Document &document) {
 void PacketDispatcher::commandList(const rapidjson::Document &document) {
 
 }
+
+void PacketDispatcher::commandMemoryStats(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    MemoryStats stats;
+    stats.add("sessions", _sessions.size(), memory_usage::of(_sessions) + _sessions.size() * memory_usage::ofShared<Session>());
+    for (const auto &master_face : _ingress_master_faces) {
+        master_face->addMemoryStats(stats);
+    }
+    {
+        std::lock_guard<std::mutex> guard(_pool_mutex);
+        _session_pit.addMemoryStats(stats);
+        stats.add("multiplexed_sessions", _multiplexed_sessions.size(), memory_usage::of(_multiplexed_sessions));
+        for (const auto &face : _egress_pool) {
+            if (face) {
+                face->addMemoryStats(stats);
+            }
+        }
+    }
+    std::stringstream ss;
+    ss << R"({"id":)" << _module_id << R"(,"type":"reply","to":"memory_stats","memory":)" << stats.toJSON() << "}";
+    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+}
+
+void PacketDispatcher::writeMetrics(MetricsWriter &writer) {
+    for (const auto &master_face : _ingress_master_faces) {
+        master_face->writeMetrics(writer);
+    }
+    BufferPool::getStats().writeMetrics(writer);
+    stage_profile::writeMetrics(writer);
+    std::lock_guard<std::mutex> guard(_pool_mutex);
+    for (const auto &face : _egress_pool) {
+        if (face) {
+            face->writeMetrics(writer);
+        }
+    }
+    writer.gauge("ndn_multiplexed_sessions", "sessions sharing the egress pool", {}, _multiplexed_sessions.size());
+    writer.gauge("ndn_session_pit_entries", "Interests of the multiplexed sessions waiting for their Data", {}, _session_pit.size());
+}
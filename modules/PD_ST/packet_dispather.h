@@ -5,86 +5,170 @@
 
 #include <boost/asio.hpp>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <set>
+#include <unordered_map>
 
 #include "rapidjson/document.h"
 
-#include "module.h"
+#include "runtime/core_module.h"
+#include "management/startup_config.h"
+#include "session_pit.h"
 #include "network/face.h"
 #include "network/master_face.h"
+#include "network/tcp_connection_pool.h"
 
-class PacketDispatcher : public Module {
+// threads: each session runs on one core service (-j), the egress pool, the session PIT and the paths are shared and
+// guarded by _pool_mutex, the commands run on _ios
+class PacketDispatcher : public CoreModule {
 private:
     class Session : public std::enable_shared_from_this<Session> {
     private:
-        static size_t session_count;
+        // TCP sessions are made on the acceptor thread and UDP ones on the worker of the UDP master face
+        static std::atomic<size_t> session_count;
 
         size_t _session_id;
 
         PacketDispatcher &_packet_dispatcher;
 
+        // the worker the session was handed to, all its faces run there
+        boost::asio::io_service &_ios;
+
+        // consumer traffic goes through the egress pool
+        bool _is_multiplexed;
+
+        // a sub-face of the UDP master face, which opened it and hands its packets to the session
+        bool _is_datagram;
+
         std::shared_ptr<Face> _bidirectionnal_face;
         std::shared_ptr<Face> _consumer_face;
+        // only opened on first use, most consumers never need it
         std::shared_ptr<Face> _producer_face;
 
+        // copied when the session is accepted, the producer face is opened later from the worker
+        std::string _producer_layer;
+        std::string _producer_remote_ip;
+        uint16_t _producer_remote_port;
+
     public:
-        Session(PacketDispatcher &packet_dispatcher, boost::asio::ip::tcp::socket&& socket);
+        // the ingress face must run on ios, datagram sessions are always multiplexed
+        Session(PacketDispatcher &packet_dispatcher, boost::asio::io_service &ios, const std::shared_ptr<Face> &face, bool is_datagram);
 
         ~Session();
 
+        size_t getSessionId() const;
+
         void start();
 
         void stop();
 
-        void onInterest(const std::shared_ptr<Face> &face, const ndn::Interest &interest);
+        void send(const NdnPacket &packet);
 
-        void onData(const std::shared_ptr<Face> &face, const ndn::Data &data);
+        // only the first Name component of Interests is read to pick the pipeline, packets are forwarded as received
+        void onPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet);
 
-        void onInterest2(const std::shared_ptr<Face> &face, const ndn::Interest &interest);
-
-        void onData2(const std::shared_ptr<Face> &face, const ndn::Data &data);
+        void onPacket2(const std::shared_ptr<Face> &face, const NdnPacket &packet);
 
         void onFaceError(const std::shared_ptr<Face> &egress_face);
+
+    private:
+        std::shared_ptr<Face> createEgressFace(const std::string &layer, const std::string &remote_ip, uint16_t remote_port);
+
+        const std::shared_ptr<Face>& getProducerFace();
     };
 
+    static const size_t SESSION_PIT_SIZE = 1 << 16;
+
+public:
+    static const uint16_t DEFAULT_PORT = 6360;
+    static const uint16_t DEFAULT_COMMAND_PORT = 10002;
+    static const size_t DEFAULT_CONCURRENCY = 4;
+
+private:
+
     bool id_set = false;
     size_t _module_id = 0;
 
     char _command_buffer[65536];
     boost::asio::ip::udp::socket _command_socket;
     boost::asio::ip::udp::endpoint _remote_command_endpoint;
+    // the id of an edit_config is the module id
+    StartupConfig _startup_config;
+    // connections kept open to the endpoints set by edit_config, e.g. the consumer path, the sessions and the egress
+    // pool take them
+    TcpConnectionPool _connection_pool;
 
+    uint16_t _local_port;
     boost::asio::ip::tcp::acceptor _acceptor;
-    boost::asio::ip::tcp::socket _acceptor_socket;
+    // made on the next worker before each accept, the session it is given to stays there
+    boost::asio::io_service *_acceptor_service = nullptr;
+    std::unique_ptr<boost::asio::ip::tcp::socket> _acceptor_socket;
 
     std::string _consumer_layer;
     std::string _consumer_remote_ip;
-    uint16_t _consumer_remote_port;
+    uint16_t _consumer_remote_port = 0;
 
     std::string _producer_layer;
     std::string _producer_remote_ip;
-    uint16_t _producer_remote_port;
+    uint16_t _producer_remote_port = 0;
 
     std::set<std::shared_ptr<Session>> _sessions;
     std::vector<std::shared_ptr<MasterFace>> _ingress_master_faces;
 
+    // UDP consumers get a lightweight session by remote endpoint, made on the first datagram and dropped when
+    // the sub-face times out. by face id, only used on the worker of the UDP master face
+    std::shared_ptr<MasterFace> _udp_master_face;
+    std::unordered_map<size_t, std::shared_ptr<Session>> _udp_sessions;
+
+    // multiplexed egress: with a pool size above 0, new sessions share that many consumer faces instead of opening
+    // their own, Interests are tagged with their session in _session_pit to route Data back. the pool is shared by
+    // the sessions of all the workers, _pool_mutex guards it along with the consumer path it connects to
+    std::mutex _pool_mutex;
+    size_t _egress_pool_size = 0;
+    std::vector<std::shared_ptr<Face>> _egress_pool;
+    SessionPit _session_pit;
+    std::unordered_map<size_t, std::weak_ptr<Session>> _multiplexed_sessions;
+
+    // no more TCP sessions and no more UDP consumers, the sessions already there are served until the module stops
+    void beginDrain() override;
+
+    // nothing queued on the UDP consumers and on the egress pool. the session PIT isn't waited for, its expired
+    // entries are only dropped by the lookups
+    bool isDrained() override;
+
 public:
-    PacketDispatcher();
+    // TCP and UDP consumers are both accepted on local_port
+    PacketDispatcher(uint16_t local_port, uint16_t local_command_port, size_t concurrency = DEFAULT_CONCURRENCY);
 
     ~PacketDispatcher() override = default;
 
+    // before start, edit_config changes them afterwards
+    void setConsumerPath(const std::string &layer, const std::string &remote_ip, uint16_t remote_port);
+
+    void setProducerPath(const std::string &layer, const std::string &remote_ip, uint16_t remote_port);
+
     void run() override;
 
+    // the commands applied by run() before the sessions are accepted, see StartupConfig. false if source can't be
+    // read. before start()
+    bool loadStartupConfig(const std::string &source);
+
     void accept();
 
+    void listenUdp();
+
     void acceptHandler(const boost::system::error_code &err);
 
     void commandRead();
 
     void commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred);
 
+    // a parsed command with an action, on _ios
+    void executeCommand(const rapidjson::Document &document);
+
     void commandEditConfig(const rapidjson::Document &document);
 
     void commandAddFace(const rapidjson::Document &document);
@@ -96,4 +180,29 @@ public:
     void commandDelMasterFace(const rapidjson::Document &document);
 
     void commandList(const rapidjson::Document &document);
+
+    // the bytes held by the sessions, the session PIT and the faces, see MemoryStats
+    void commandMemoryStats(const rapidjson::Document &document);
+
+    // at each scrape, from _ios as commandList
+    void writeMetrics(MetricsWriter &writer);
+
+private:
+    // pool faces are opened on first use, a session always uses the same one. _pool_mutex must be held
+    const std::shared_ptr<Face>& getPoolFace(size_t session_id);
+
+    // _pool_mutex must be held
+    void resetEgressPool();
+
+    void sendToPool(size_t session_id, const NdnPacket &packet);
+
+    void onPoolPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+
+    void onPoolFaceError(const std::shared_ptr<Face> &face);
+
+    void onUdpFace(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
+
+    void onUdpPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+
+    void onUdpFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
 };
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "session_pit.h"
+
+#include <algorithm>
+
+#include "metrics/memory_stats.h"
+#include "network/tlv_reader.h"
+
+const ndn::time::milliseconds SessionPit::DEFAULT_INTEREST_LIFETIME {4000};
+
+SessionPit::SessionPit(size_t size) : _max_size(size) {
+
+}
+
+size_t SessionPit::size() const {
+    return _tree.getPopulatedNodes();
+}
+
+void SessionPit::insert(const NdnPacket &interest, size_t session_id) {
+    const ndn::Name &name = interest.getName();
+    auto keep_until = ndn::time::steady_clock::now() + getInterestLifetime(interest.getBlock());
+    if (auto entry = _tree.touch(name)) {
+        if (entry->keep_until < ndn::time::steady_clock::now()) {
+            entry->sessions.clear();
+        }
+        entry->sessions.emplace(session_id);
+        entry->keep_until = std::max(entry->keep_until, keep_until);
+        return;
+    }
+    auto entry = std::make_shared<Entry>();
+    entry->sessions.emplace(session_id);
+    entry->keep_until = keep_until;
+    _tree.insert(NdnPacket::copyName(name), entry);
+    if (_tree.getPopulatedNodes() > _max_size) {
+        _tree.removeLeastRecent();
+    }
+}
+
+std::set<size_t> SessionPit::get(const NameView &name) {
+    std::set<size_t> sessions;
+    auto now = ndn::time::steady_clock::now();
+    for (const auto &pair : _tree.findAllUntil(name)) {
+        if (pair.second->keep_until >= now) {
+            sessions.insert(pair.second->sessions.begin(), pair.second->sessions.end());
+        }
+        _tree.remove(pair.first);
+    }
+    return sessions;
+}
+
+void SessionPit::addMemoryStats(MemoryStats &stats) const {
+    _tree.addMemoryStats(stats, "session_pit");
+    size_t entry_bytes = 0;
+    _tree.forEachValue([&entry_bytes](const Entry &entry) {
+        entry_bytes += memory_usage::ofShared<Entry>() + memory_usage::of(entry.sessions);
+    });
+    stats.add("session_pit_entries", size(), entry_bytes);
+}
+
+ndn::time::milliseconds SessionPit::getInterestLifetime(const ndn::Block &interest) {
+    const uint8_t *it = interest.value();
+    const uint8_t *end = it + interest.value_size();
+    while (it != end) {
+        uint32_t type;
+        size_t length = tlv_reader::readHeader(it, end, type);
+        if (type == ndn::tlv::InterestLifetime) {
+            return ndn::time::milliseconds(tlv_reader::readNonNegativeInteger(it, length));
+        }
+        it += length;
+    }
+    return DEFAULT_INTEREST_LIFETIME;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "tree/named_tree.h"
+#include "network/ndn_packet.h"
+
+// pending Interests of the sessions multiplexed on the egress pool, tagged with the ID of the session which
+// expressed them, Data received on a pool face go to every session tagged on a prefix of their Name
+class SessionPit {
+private:
+    static const ndn::time::milliseconds DEFAULT_INTEREST_LIFETIME;
+
+    struct Entry {
+        std::set<size_t> sessions;
+        ndn::time::steady_clock::time_point keep_until;
+    };
+
+    size_t _max_size;
+
+    NamedTree<Entry> _tree;
+
+public:
+    explicit SessionPit(size_t size);
+
+    ~SessionPit() = default;
+
+    size_t size() const;
+
+    void insert(const NdnPacket &interest, size_t session_id);
+
+    // satisfied entries are removed, expired ones are skipped
+    std::set<size_t> get(const NameView &name);
+
+    // "session_pit_nodes" and "session_pit_components" of the tree, "session_pit_entries" with their sessions
+    void addMemoryStats(MemoryStats &stats) const;
+
+private:
+    // InterestLifetime read from the wire, the rest of the Interest is not decoded
+    static ndn::time::milliseconds getInterestLifetime(const ndn::Block &interest);
+};
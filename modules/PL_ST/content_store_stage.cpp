@@ -0,0 +1,7 @@
+#include "stage.h"
+
+#include "content_store.h"
+
+std::unique_ptr<Stage> makeContentStore(const std::string &name, size_t size, uint16_t local_port, uint16_t local_command_port) {
+    return std::unique_ptr<Stage>(new ModuleStage<ContentStore>(name, size, 0, "lru", local_port, local_command_port));
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+#include "stage.h"
+
+#include "firewall.h"
+
+std::unique_ptr<Stage> makeFirewall(const std::string &name, uint16_t local_port, uint16_t local_command_port) {
+    return std::unique_ptr<Stage>(new ModuleStage<Firewall>(name, local_port, local_command_port));
+}
\ No newline at end of file
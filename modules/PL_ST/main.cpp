@@ -0,0 +1,192 @@
+#include <ndn-cxx/common.hpp>
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <csignal>
+#include <sstream>
+#include <vector>
+
+#include "stage.h"
+#include "log/logger.h"
+#include "network/packet_capture.h"
+#include "network/tracer.h"
+#include "network/page_arena.h"
+#include "network/socket_options.h"
+#include "network/udp_egress_socket.h"
+#include "network/uring_service.h"
+#include "network/xdp_socket.h"
+
+struct StageConfig {
+    std::string kind;
+    std::string name;
+    uint16_t local_port = 0;
+    uint16_t local_command_port = 0;
+};
+
+// kind:name:port:command_port, kind is cs, sv or nf
+static bool parseStage(const std::string &arg, StageConfig &config) {
+    std::stringstream ss(arg);
+    std::string port;
+    std::string command_port;
+    if (!std::getline(ss, config.kind, ':') || !std::getline(ss, config.name, ':') || !std::getline(ss, port, ':')
+        || !std::getline(ss, command_port) || (config.kind != "cs" && config.kind != "sv" && config.kind != "nf")) {
+        return false;
+    }
+    config.local_port = std::atoi(port.c_str());
+    config.local_command_port = std::atoi(command_port.c_str());
+    return config.local_port != 0 && config.local_command_port != 0;
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<StageConfig> configs;
+    size_t size = 100000;
+    std::string backend = "epoll";
+    // "eth0" or "eth0:2", the UDP master faces then read their port off the NIC queues with AF_XDP
+    std::string xdp_interface = "";
+    // "receive_buffer=8388608,dscp=46", the default profile of the sockets of the faces, see SocketOptions
+    std::string socket_options = "";
+    // "connected" for a connected socket per egress UDP face, "shared" for one socket shared by them, see UdpEgressSocket
+    std::string egress_sockets = "connected";
+    // "thp", "2M" or "1G", optionally ":local", the pages of the large tables, see PageArena
+    std::string pages = "";
+    // in milliseconds, as for the modules
+    size_t drain_timeout = 2000;
+    // each stage serves its metrics on its own port from this one in the order of -s, 0 for none
+    uint16_t metrics_port = 0;
+    // one packet in trace_sampling is traced through the chain, see Tracer, 0 for none
+    uint64_t trace_sampling = 0;
+    // "directory[:file_mb[:files]]", the packets of the faces are captured there for ndnms-bench -R, see PacketCapture
+    std::string capture = "";
+
+    for (int i = 1; i < argc; i += 2) {
+        switch (argv[i][1]) {
+            case 's':
+                configs.emplace_back();
+                if (!parseStage(argv[i + 1], configs.back())) {
+                    exit(-1);
+                }
+                break;
+            case 'S':
+                size = std::atoi(argv[i + 1]);
+                break;
+            case 'b':
+                backend = argv[i + 1];
+                break;
+            case 'X':
+                xdp_interface = argv[i + 1];
+                break;
+            case 'O':
+                socket_options = argv[i + 1];
+                break;
+            case 'U':
+                egress_sockets = argv[i + 1];
+                break;
+            case 'H':
+                pages = argv[i + 1];
+                break;
+            case 'g':
+                drain_timeout = std::atoi(argv[i + 1]);
+                break;
+            case 'M':
+                metrics_port = std::atoi(argv[i + 1]);
+                break;
+            case 'T':
+                trace_sampling = std::strtoull(argv[i + 1], nullptr, 10);
+                break;
+            case 'R':
+                capture = argv[i + 1];
+                break;
+            case 'h':
+            default:
+                exit(0);
+                break;
+        }
+    }
+
+    if (configs.empty()) {
+        exit(-1);
+    }
+
+    std::cout << "pipeline v1.0" << std::endl;
+
+    logger::setFilename("logs.txt");
+    logger::isTee(true);
+    logger::setMinimalLogLevel(logger::INFO);
+    Tracer::setSampling(trace_sampling);
+    if (!capture.empty() && !PacketCapture::start(capture)) {
+        logger::log(logger::WARNING, "the packets can't be captured in {}", {capture});
+    }
+
+    // faces created by the stages pick the backend up, it must be selected before
+    if (backend == "io_uring" && !UringService::enable()) {
+        logger::log(logger::WARNING, "io_uring is not available, falling back to epoll");
+    }
+    if (!xdp_interface.empty() && !XdpSocket::enable(xdp_interface)) {
+        logger::log(logger::WARNING, "AF_XDP is not available on {}, udp is read from the sockets", {xdp_interface});
+    }
+    SocketOptions options;
+    if (SocketOptions::parse(socket_options, options)) {
+        SocketOptions::setDefault(options);
+    } else {
+        logger::log(logger::WARNING, "invalid socket options {}, the kernel defaults are kept", {socket_options});
+    }
+    if (egress_sockets == "shared") {
+        UdpEgressSocket::enable();
+    }
+    // before the tables are created
+    if (!pages.empty() && !PageArena::enable(pages)) {
+        logger::log(logger::WARNING, "invalid pages {}, the tables are kept in the heap", {pages});
+    }
+
+    std::vector<std::unique_ptr<Stage>> stages;
+    for (const auto &config : configs) {
+        if (config.kind == "cs") {
+            stages.emplace_back(makeContentStore(config.name, size, config.local_port, config.local_command_port));
+        } else if (config.kind == "sv") {
+            stages.emplace_back(makeSignatureVerifier(config.name, config.local_port, config.local_command_port));
+        } else {
+            stages.emplace_back(makeFirewall(config.name, config.local_port, config.local_command_port));
+        }
+    }
+    if (metrics_port != 0) {
+        for (size_t i = 0; i < stages.size(); ++i) {
+            stages[i]->enableMetrics(metrics_port + i);
+        }
+    }
+    for (const auto &stage : stages) {
+        stage->start();
+    }
+
+    // as Module::waitForStop, for all the stages at once: they drain together and a second signal stops them all
+    boost::asio::io_service signal_ios;
+    boost::asio::signal_set signals(signal_ios, SIGINT, SIGTERM);
+    std::atomic<size_t> draining{0};
+    signals.async_wait([&](const boost::system::error_code &err, int signum) {
+        if (err) {
+            return;
+        }
+        logger::log(logger::INFO, "draining the stages before stopping");
+        draining = stages.size();
+        for (const auto &stage : stages) {
+            stage->drain(boost::posix_time::milliseconds(drain_timeout), [&](bool drained) {
+                if (!drained) {
+                    logger::log(logger::WARNING, "drain timed out, stopping with packets in flight");
+                }
+                if (--draining == 0) {
+                    signal_ios.stop();
+                }
+            });
+        }
+        signals.async_wait([&signal_ios](const boost::system::error_code &err, int signum) {
+            signal_ios.stop();
+        });
+    });
+    signal_ios.run();
+
+    for (const auto &stage : stages) {
+        stage->stop();
+    }
+
+    return 0;
+}
\ No newline at end of file
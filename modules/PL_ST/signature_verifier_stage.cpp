@@ -0,0 +1,7 @@
+#include "stage.h"
+
+#include "signature_verifier.h"
+
+std::unique_ptr<Stage> makeSignatureVerifier(const std::string &name, uint16_t local_port, uint16_t local_command_port) {
+    return std::unique_ptr<Stage>(new ModuleStage<SignatureVerifier>(name, local_port, local_command_port));
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+// a module run as one stage of the pipeline: it keeps its ports, its command socket and its threads, and the manager
+// links the stages with add_face on the "mem" layer as it would link containers over TCP
+class Stage {
+public:
+    virtual ~Stage() = default;
+
+    virtual void start() = 0;
+
+    virtual void stop() = 0;
+
+    // see Module::enableMetrics
+    virtual void enableMetrics(uint16_t port) = 0;
+
+    // see Module::drain, done is called from a thread of the stage
+    virtual void drain(const boost::posix_time::time_duration &timeout, const std::function<void(bool)> &done) = 0;
+};
+
+template <typename M>
+class ModuleStage : public Stage {
+private:
+    M _module;
+
+public:
+    template <typename... Args>
+    explicit ModuleStage(Args&&... args) : _module(std::forward<Args>(args)...) {
+
+    }
+
+    // some modules have cache line aligned members, which new doesn't honour before C++17
+    static void* operator new(size_t size) {
+        void *pointer;
+        if (posix_memalign(&pointer, alignof(ModuleStage), size) != 0) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+
+    static void operator delete(void *pointer) {
+        free(pointer);
+    }
+
+    void start() override {
+        _module.start();
+    }
+
+    void stop() override {
+        _module.stop();
+    }
+
+    void enableMetrics(uint16_t port) override {
+        _module.enableMetrics(port);
+    }
+
+    void drain(const boost::posix_time::time_duration &timeout, const std::function<void(bool)> &done) override {
+        _module.drain(timeout, done);
+    }
+};
+
+// each one is defined in a translation unit of its own, the headers of the modules aren't made to be included together
+std::unique_ptr<Stage> makeContentStore(const std::string &name, size_t size, uint16_t local_port, uint16_t local_command_port);
+
+std::unique_ptr<Stage> makeSignatureVerifier(const std::string &name, uint16_t local_port, uint16_t local_command_port);
+
+std::unique_ptr<Stage> makeFirewall(const std::string &name, uint16_t local_port, uint16_t local_command_port);
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "face_health.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "metrics/metrics.h"
+
+void FaceHealth::onData(const Clock::time_point &now) {
+    _data.store(_data.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    int64_t since = _waiting_since.exchange(0, std::memory_order_relaxed);
+    // the wait of a stalled face would raise the limit it is judged by
+    if (since == 0 || !_is_usable.load(std::memory_order_relaxed)) {
+        return;
+    }
+    int64_t sample = std::max<int64_t>(getTime(now) - since, 0);
+    int64_t wait = _wait.load(std::memory_order_relaxed);
+    _wait.store(wait == 0 ? sample : wait - wait / 8 + sample / 8, std::memory_order_relaxed);
+}
+
+void FaceHealth::update(size_t queued, const Clock::time_point &now, const Settings &settings) {
+    int64_t since = _waiting_since.load(std::memory_order_relaxed);
+    int64_t limit = std::max<int64_t>(ndn::time::duration_cast<ndn::time::nanoseconds>(settings.stall_timeout).count(),
+                                      static_cast<int64_t>(STALL_FACTOR) * _wait.load(std::memory_order_relaxed));
+    bool is_stalled = (since != 0 && getTime(now) - since > limit)
+                      || (settings.max_queue > 0 && queued > settings.max_queue);
+    uint64_t data = _data.load(std::memory_order_relaxed);
+    bool has_answered = data != _last_data;
+    _last_data = data;
+    if (_is_usable.load(std::memory_order_relaxed)) {
+        if (is_stalled) {
+            _is_usable.store(false, std::memory_order_relaxed);
+            _answered_probes = 0;
+            // probed right away
+            _last_probe = Clock::time_point();
+            ++_failovers;
+        }
+    } else if (is_stalled) {
+        _answered_probes = 0;
+    } else if (has_answered && ++_answered_probes >= FAILBACK_PROBES) {
+        _is_usable.store(true, std::memory_order_relaxed);
+    }
+    if (!_is_usable.load(std::memory_order_relaxed) && now - _last_probe >= settings.probe_interval) {
+        _is_probe_due.store(true, std::memory_order_relaxed);
+        _last_probe = now;
+    }
+}
+
+std::string FaceHealth::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"usable":)" << (isUsable() ? "true" : "false") << R"(, "wait_us":)" << _wait.load(std::memory_order_relaxed) / 1000
+       << R"(, "failovers":)" << _failovers << "}";
+    return ss.str();
+}
+
+void FaceHealth::writeMetrics(MetricsWriter &writer, size_t face_id) const {
+    metrics::Labels labels = {{"face", std::to_string(face_id)}};
+    writer.gauge("ndn_face_usable", "1 while the failover strategy sends traffic to the face", labels, isUsable() ? 1 : 0);
+    writer.counter("ndn_face_failovers_total", "times the face stalled and its traffic went to the next one", labels,
+                   static_cast<double>(_failovers));
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class MetricsWriter;
+
+// whether an egress face answers, for FailoverStrategy: the face stalls when the first Interest sent to it since its
+// last Data waits longer than the stall timeout, or STALL_FACTOR times the usual wait, or when more than max_queue
+// packets wait in its queue. a stalled face is given no more traffic but a copy of an Interest each probe_interval,
+// and takes it back once it answered FAILBACK_PROBES probes in a row. the packets only touch atomics, the state is
+// decided by update from _ios
+class FaceHealth {
+public:
+    using Clock = ndn::time::steady_clock;
+
+    static const size_t STALL_FACTOR = 4;
+    static const size_t FAILBACK_PROBES = 3;
+
+    struct Settings {
+        ndn::time::milliseconds stall_timeout{20};
+        ndn::time::milliseconds probe_interval{20};
+        // 0 for no limit
+        size_t max_queue = 1024;
+    };
+
+private:
+    // in nanoseconds of Clock, 0 while no Interest waits. an Interest unanswered keeps waiting until the next Data
+    std::atomic<int64_t> _waiting_since{0};
+    // in nanoseconds, smoothed over the waits ended by a Data while usable
+    std::atomic<int64_t> _wait{0};
+    // only written by the thread of the face
+    std::atomic<uint64_t> _data{0};
+    std::atomic<bool> _is_usable{true};
+    std::atomic<bool> _is_probe_due{false};
+
+    // on _ios
+    uint64_t _last_data = 0;
+    size_t _answered_probes = 0;
+    Clock::time_point _last_probe;
+    uint64_t _failovers = 0;
+
+    // in nanoseconds of Clock
+    static int64_t getTime(const Clock::time_point &now) {
+        return ndn::time::duration_cast<ndn::time::nanoseconds>(now.time_since_epoch()).count();
+    }
+
+public:
+    FaceHealth() = default;
+
+    FaceHealth(const FaceHealth&) = delete;
+
+    FaceHealth& operator=(const FaceHealth&) = delete;
+
+    // from any thread, for each Interest sent to the face
+    void onInterest(const Clock::time_point &now) {
+        if (_waiting_since.load(std::memory_order_relaxed) == 0) {
+            _waiting_since.store(getTime(now), std::memory_order_relaxed);
+        }
+    }
+
+    // from the thread of the face
+    void onData(const Clock::time_point &now);
+
+    bool isUsable() const {
+        return _is_usable.load(std::memory_order_relaxed);
+    }
+
+    // true once for each probe update asks, the Interest is then copied to the face
+    bool takeProbe() {
+        return _is_probe_due.load(std::memory_order_relaxed) && _is_probe_due.exchange(false, std::memory_order_relaxed);
+    }
+
+    // on _ios every few milliseconds, queued the packets waiting in the queue of the face
+    void update(size_t queued, const Clock::time_point &now, const Settings &settings);
+
+    // {"usable", "wait_us", "failovers"}
+    std::string toJSON() const;
+
+    void writeMetrics(MetricsWriter &writer, size_t face_id) const;
+};
\ No newline at end of file
@@ -1,5 +1,27 @@
 #include "failover_strategy.h"
 
-std::vector<std::shared_ptr<Face>> FailoverStrategy::selectFaces(const std::vector<std::shared_ptr<Face>> &faces) {
-    return !faces.empty() ? std::vector<std::shared_ptr<Face>>{faces[0]} : std::vector<std::shared_ptr<Face>>();
+Strategy::Selection FailoverStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces,
+                                                  const std::vector<uint64_t> &key_hashes,
+                                                  const std::vector<std::shared_ptr<FaceHealth>> &health) const {
+    if (faces.empty()) {
+        return {0, 0};
+    }
+    if (packet.getType() != NdnPacket::INTEREST) {
+        return {0, 1};
+    }
+    size_t selected = 0;
+    for (size_t i = 0; i < health.size(); ++i) {
+        if (health[i]->isUsable()) {
+            selected = i;
+            break;
+        }
+    }
+    Selection selection{selected, 1};
+    for (size_t i = 0; i < health.size(); ++i) {
+        if (i != selected && health[i]->takeProbe()) {
+            selection.probe = i;
+            break;
+        }
+    }
+    return selection;
 }
\ No newline at end of file
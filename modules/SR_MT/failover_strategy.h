@@ -2,6 +2,9 @@
 
 #include "strategy.h"
 
+// each Interest goes to the first face, in the order they were added, which its FaceHealth takes as usable, or to the
+// first face when none is. the Interests are copied by turns to the faces passed over when their FaceHealth asks for
+// a probe, the traffic fails back once they answer again
 class FailoverStrategy : public Strategy {
 private:
 
@@ -10,5 +13,7 @@ public:
 
     ~FailoverStrategy() override = default;
 
-    std::vector<std::shared_ptr<Face>> selectFaces(const std::vector<std::shared_ptr<Face>> &faces);
+    Selection selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces,
+                          const std::vector<uint64_t> &key_hashes,
+                          const std::vector<std::shared_ptr<FaceHealth>> &health) const override;
 };
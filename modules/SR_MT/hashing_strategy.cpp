@@ -0,0 +1,23 @@
+#include "hashing_strategy.h"
+
+#include <algorithm>
+
+#include "network/rendezvous_hash.h"
+
+HashingStrategy::HashingStrategy(size_t prefix_length) : Strategy(), _prefix_length(prefix_length) {
+
+}
+
+size_t HashingStrategy::getFlowLength() const {
+    return _prefix_length;
+}
+
+Strategy::Selection HashingStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces,
+                                                 const std::vector<uint64_t> &key_hashes,
+                                                 const std::vector<std::shared_ptr<FaceHealth>> &health) const {
+    if (faces.empty()) {
+        return {0, 0};
+    }
+    const NameView &name = packet.getNameView();
+    return {rendezvous_hash::select(name.getPrefixHash(std::min(name.size(), _prefix_length)), key_hashes), 1};
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "strategy.h"
+
+// each packet goes to one face picked by rendezvous hashing of the first components of its Name on the endpoints of
+// the faces, as the HashingStrategy of SR_ST: the clones of a scaled content store or backward router always get the
+// same Names, and a face added or removed only moves the Names it takes or held. the key hashes come with the faces,
+// nothing is computed nor kept per packet
+class HashingStrategy : public Strategy {
+private:
+    const size_t _prefix_length;
+
+public:
+    explicit HashingStrategy(size_t prefix_length);
+
+    ~HashingStrategy() override = default;
+
+    size_t getFlowLength() const override;
+
+    Selection selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces,
+                          const std::vector<uint64_t> &key_hashes,
+                          const std::vector<std::shared_ptr<FaceHealth>> &health) const override;
+};
\ No newline at end of file
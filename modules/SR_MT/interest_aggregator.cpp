@@ -0,0 +1,78 @@
+#include "interest_aggregator.h"
+
+#include <sstream>
+
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+
+InterestAggregator::Table& InterestAggregator::getTable() {
+    // a module holds a single aggregator, the owner only changes with a new one
+    static thread_local const InterestAggregator *owner = nullptr;
+    static thread_local Table *table = nullptr;
+    if (owner != this) {
+        std::unique_ptr<Table> new_table(new Table());
+        table = new_table.get();
+        owner = this;
+        std::lock_guard<std::mutex> lock(_tables_mutex);
+        _tables.push_back(std::move(new_table));
+    }
+    return *table;
+}
+
+ndn::time::milliseconds InterestAggregator::getWindow() const {
+    return ndn::time::duration_cast<ndn::time::milliseconds>(ndn::time::nanoseconds(_window.load(std::memory_order_relaxed)));
+}
+
+void InterestAggregator::setWindow(const ndn::time::milliseconds &window) {
+    _window.store(ndn::time::duration_cast<ndn::time::nanoseconds>(window).count(), std::memory_order_relaxed);
+}
+
+bool InterestAggregator::isRepeat(uint64_t name_hash, const Clock::time_point &now) {
+    Table &table = getTable();
+    int64_t time = ndn::time::duration_cast<ndn::time::nanoseconds>(now.time_since_epoch()).count();
+    // the low bits pick the entry, the hash is kept whole to tell the Names apart
+    Entry &entry = table.entries[name_hash % TABLE_SIZE];
+    if (entry.name_hash == name_hash && entry.expiry > time) {
+        table.merged.store(table.merged.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return true;
+    }
+    entry.name_hash = name_hash;
+    entry.expiry = time + _window.load(std::memory_order_relaxed);
+    table.forwarded.store(table.forwarded.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return false;
+}
+
+size_t InterestAggregator::getMemoryUsage() const {
+    std::lock_guard<std::mutex> lock(_tables_mutex);
+    return memory_usage::of(_tables) + _tables.size() * sizeof(Table);
+}
+
+std::string InterestAggregator::toJSON() const {
+    size_t forwarded = 0;
+    size_t merged = 0;
+    {
+        std::lock_guard<std::mutex> lock(_tables_mutex);
+        for (const auto &table : _tables) {
+            forwarded += table->forwarded.load(std::memory_order_relaxed);
+            merged += table->merged.load(std::memory_order_relaxed);
+        }
+    }
+    std::stringstream ss;
+    ss << R"({"window":)" << getWindow().count() << R"(, "forwarded":)" << forwarded << R"(, "merged":)" << merged << "}";
+    return ss.str();
+}
+
+void InterestAggregator::writeMetrics(MetricsWriter &writer) const {
+    size_t forwarded = 0;
+    size_t merged = 0;
+    {
+        std::lock_guard<std::mutex> lock(_tables_mutex);
+        for (const auto &table : _tables) {
+            forwarded += table->forwarded.load(std::memory_order_relaxed);
+            merged += table->merged.load(std::memory_order_relaxed);
+        }
+    }
+    const char *help = "Interests seen by the aggregation, sent downstream or merged into an earlier one";
+    writer.counter("ndn_aggregated_interests_total", help, {{"result", "forwarded"}}, forwarded);
+    writer.counter("ndn_aggregated_interests_total", help, {{"result", "merged"}}, merged);
+}
\ No newline at end of file
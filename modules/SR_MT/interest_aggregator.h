@@ -0,0 +1,77 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class MetricsWriter;
+
+// the repeats of an Interest within a short window, by name_hash, aren't sent downstream again: under multicast each
+// Interest goes to every egress face, so a Name asked by several consumers at once would be sent there as many times.
+// each thread has a table of its own, direct mapped and never locked, the repeats are merged when their ingress faces
+// share a thread, which is always the case for UDP and SHM. a repeat is answered by the Data of the first Interest,
+// sent back to every ingress face or, with data_unicast, to those of the ReturnTable, which records the repeat as
+// well. the selectors aren't compared, the window should stay well below the retransmission timeout of the consumers
+class InterestAggregator {
+public:
+    using Clock = ndn::time::steady_clock;
+
+    // entries by thread
+    static const size_t TABLE_SIZE = 4096;
+
+private:
+    struct Entry {
+        uint64_t name_hash;
+        // in nanoseconds of Clock
+        int64_t expiry;
+    };
+
+    struct Table {
+        Entry entries[TABLE_SIZE];
+        // read by the scrapes
+        std::atomic<size_t> forwarded{0};
+        std::atomic<size_t> merged{0};
+    };
+
+    // in nanoseconds, 0 while off
+    std::atomic<int64_t> _window{0};
+    // one by thread which saw an Interest while on, only added to
+    mutable std::mutex _tables_mutex;
+    std::vector<std::unique_ptr<Table>> _tables;
+
+    Table& getTable();
+
+public:
+    InterestAggregator() = default;
+
+    InterestAggregator(const InterestAggregator&) = delete;
+
+    InterestAggregator& operator=(const InterestAggregator&) = delete;
+
+    ndn::time::milliseconds getWindow() const;
+
+    // 0 to turn it off, the entries already there expire as they were
+    void setWindow(const ndn::time::milliseconds &window);
+
+    bool isEnabled() const {
+        return _window.load(std::memory_order_relaxed) != 0;
+    }
+
+    // from any thread, for each Interest while enabled: true if this thread let an Interest for the same Name through
+    // less than the window ago, the Interest is then dropped. the window runs from the first Interest, a Name asked
+    // steadily is sent downstream once per window
+    bool isRepeat(uint64_t name_hash, const Clock::time_point &now);
+
+    // of the tables of the threads
+    size_t getMemoryUsage() const;
+
+    // {"window", "forwarded", "merged"}
+    std::string toJSON() const;
+
+    void writeMetrics(MetricsWriter &writer) const;
+};
\ No newline at end of file
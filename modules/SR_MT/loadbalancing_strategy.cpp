@@ -1,15 +1,10 @@
 #include "loadbalancing_strategy.h"
 
-std::vector<std::shared_ptr<Face>> LoadbalancingStrategy::selectFaces(const std::vector<std::shared_ptr<Face>> &faces) {
-    std::vector<std::shared_ptr<Face>> v;
+Strategy::Selection LoadbalancingStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces,
+                                                       const std::vector<uint64_t> &key_hashes,
+                                                       const std::vector<std::shared_ptr<FaceHealth>> &health) const {
     if (faces.empty()) {
-        return v;
-    } else {
-        tbb::spin_mutex::scoped_lock lock(_mutex);
-        if (_index >= faces.size()) {
-            _index = 0;
-        }
-        v.emplace_back(faces[_index++]);
-        return v;
+        return {0, 0};
     }
+    return {_index.fetch_add(1, std::memory_order_relaxed) % faces.size(), 1};
 }
\ No newline at end of file
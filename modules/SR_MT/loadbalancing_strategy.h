@@ -1,20 +1,20 @@
 #pragma once
 
-#include "atomic"
-
-#include <tbb/spin_mutex.h>
+#include <atomic>
 
 #include "strategy.h"
 
 class LoadbalancingStrategy : public Strategy {
 private:
-    tbb::spin_mutex _mutex;
-    std::atomic<size_t> _index {0};
+    // round robin over the faces of the snapshot, a change of the faces only moves where it goes on from
+    mutable std::atomic<size_t> _index {0};
 
 public:
     LoadbalancingStrategy() = default;
 
     ~LoadbalancingStrategy() override = default;
 
-    std::vector<std::shared_ptr<Face>> selectFaces(const std::vector<std::shared_ptr<Face>> &faces) override;
+    Selection selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces,
+                          const std::vector<uint64_t> &key_hashes,
+                          const std::vector<std::shared_ptr<FaceHealth>> &health) const override;
 };
\ No newline at end of file
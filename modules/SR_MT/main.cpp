@@ -1,15 +1,23 @@
 #include "strategy_router.h"
 #include "log/logger.h"
-
-static bool stop = false;
-static void signal_handler(int signum) {
-    stop = true;
-}
+#include "network/packet_capture.h"
+#include "network/tracer.h"
 
 int main(int argc, char *argv[]) {
     std::string name = "";
     uint16_t local_port = 0;
     uint16_t local_command_port = 0;
+    size_t concurrency = StrategyRouter::DEFAULT_CONCURRENCY;
+    // in milliseconds, SIGINT or SIGTERM lets the module drain that long at most before it stops
+    size_t drain_timeout = 2000;
+    // 0 for no metrics endpoint
+    uint16_t metrics_port = 0;
+    // one packet in trace_sampling is traced through the chain, see Tracer, 0 for none
+    uint64_t trace_sampling = 0;
+    // "directory[:file_mb[:files]]", the packets of the faces are captured there for ndnms-bench -R, see PacketCapture
+    std::string capture = "";
+    // a file or the JSON of the commands applied before the module listens, see StartupConfig
+    std::string startup_config = "";
 
     char flags = 0;
     for (int i = 1; i < argc; i += 2) {
@@ -26,6 +34,24 @@ int main(int argc, char *argv[]) {
                 local_command_port = std::atoi(argv[i + 1]);
                 flags |= 0x4;
                 break;
+            case 'j':
+                concurrency = std::max(std::atoi(argv[i + 1]), 1);
+                break;
+            case 'g':
+                drain_timeout = std::atoi(argv[i + 1]);
+                break;
+            case 'M':
+                metrics_port = std::atoi(argv[i + 1]);
+                break;
+            case 'T':
+                trace_sampling = std::strtoull(argv[i + 1], nullptr, 10);
+                break;
+            case 'R':
+                capture = argv[i + 1];
+                break;
+            case 'F':
+                startup_config = argv[i + 1];
+                break;
             case 'h':
             default:
                 exit(0);
@@ -41,18 +67,22 @@ int main(int argc, char *argv[]) {
     logger::setFilename("logs.txt");
     logger::isTee(true);
     logger::setMinimalLogLevel(logger::INFO);
+    Tracer::setSampling(trace_sampling);
+    if (!capture.empty() && !PacketCapture::start(capture)) {
+        logger::log(logger::WARNING, "the packets can't be captured in {}", {capture});
+    }
 
-    StrategyRouter strategy_router(name, local_port, local_command_port);
+    StrategyRouter strategy_router(name, local_port, local_command_port, concurrency);
+    if (metrics_port != 0) {
+        strategy_router.enableMetrics(metrics_port);
+    }
+    if (!startup_config.empty() && !strategy_router.loadStartupConfig(startup_config)) {
+        logger::log(logger::ERROR, "the startup configuration {} can't be read", {startup_config});
+        return -1;
+    }
     strategy_router.start();
 
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
-
-    do {
-        sleep(15);
-    }while(!stop);
-
-    strategy_router.stop();
+    strategy_router.waitForStop(boost::posix_time::milliseconds(drain_timeout));
 
     return 0;
 }
\ No newline at end of file
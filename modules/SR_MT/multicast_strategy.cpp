@@ -1,5 +1,7 @@
 #include "multicast_strategy.h"
 
-std::vector<std::shared_ptr<Face>> MulticastStrategy::selectFaces(const std::vector<std::shared_ptr<Face>> &faces) {
-    return faces;
+Strategy::Selection MulticastStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces,
+                                                   const std::vector<uint64_t> &key_hashes,
+                                                   const std::vector<std::shared_ptr<FaceHealth>> &health) const {
+    return {0, faces.size()};
 }
\ No newline at end of file
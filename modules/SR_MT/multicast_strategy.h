@@ -10,5 +10,7 @@ public:
 
     ~MulticastStrategy() override = default;
 
-    std::vector<std::shared_ptr<Face>> selectFaces(const std::vector<std::shared_ptr<Face>> &faces) override;
+    Selection selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces,
+                          const std::vector<uint64_t> &key_hashes,
+                          const std::vector<std::shared_ptr<FaceHealth>> &health) const override;
 };
@@ -1,3 +0,0 @@
-#include "master_face.h"
-
-size_t MasterFace::counter = 0;
\ No newline at end of file
@@ -1,17 +1,39 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
+#include "face_health.h"
 #include "network/face.h"
+#include "network/ndn_packet.h"
 
 class Strategy {
-private:
-
 public:
+    static const size_t NO_PROBE = static_cast<size_t>(-1);
+
+    // the faces [first, first + count) of those given, nothing is copied nor allocated for a packet. an Interest is
+    // also copied to the face probe, to learn whether it answers again
+    struct Selection {
+        size_t first;
+        size_t count;
+        size_t probe = NO_PROBE;
+    };
+
     Strategy() = default;
 
     virtual ~Strategy() = default;
 
-    virtual std::vector<std::shared_ptr<Face>> selectFaces(const std::vector<std::shared_ptr<Face>> &faces) = 0;
+    // from any thread, faces is the snapshot the selection indexes, key_hashes[i] the rendezvous_hash key of faces[i]
+    // and health[i] its FaceHealth. the packet is only read by the strategies which route by Name, through its
+    // NameView. a strategy is never changed once published, but for the atomics it keeps its state in
+    // the components of a Name past which the selection doesn't change for a given snapshot of the faces, the
+    // router may then keep it by flow, see FlowCache. 0 if it changes from packet to packet, e.g. by round robin
+    virtual size_t getFlowLength() const {
+        return 0;
+    }
+
+    virtual Selection selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces,
+                                  const std::vector<uint64_t> &key_hashes,
+                                  const std::vector<std::shared_ptr<FaceHealth>> &health) const = 0;
 };
\ No newline at end of file
@@ -7,70 +7,238 @@
 #include "multicast_strategy.h"
 #include "failover_strategy.h"
 #include "loadbalancing_strategy.h"
+#include "hashing_strategy.h"
+#include "network/coarse_clock.h"
+#include "network/rendezvous_hash.h"
 #include "network/tcp_master_face.h"
 #include "network/tcp_face.h"
 #include "network/udp_master_face.h"
 #include "network/udp_face.h"
+#include "network/shm_master_face.h"
+#include "network/shm_face.h"
 #include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+#include "metrics/stage_profile.h"
+#include "tree/flow_cache.h"
 
-StrategyRouter::StrategyRouter(const std::string &name, uint16_t local_port, uint16_t local_command_port)
-        : Module(4)
+StrategyRouter::StrategyRouter(const std::string &name, uint16_t local_port, uint16_t local_command_port, size_t concurrency)
+        : CoreModule(concurrency)
         , _name(name)
-        , _command_socket(_ios, {{}, local_command_port}) {
-    _tcp_ingress_master_face = std::make_shared<TcpMasterFace>(_ios, local_port);
-    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, local_port);
+        , _command_socket(_ios, {{}, local_command_port})
+        , _connection_pool(_ios)
+        , _egress([]() {
+            return std::unique_ptr<Egress>(new Egress());
+        })
+        , _health_timer(_ios) {
+    // the consumers are spread over the cores as they connect, UDP and SHM stay on _ios
+    auto tcp_master_face = std::make_shared<TcpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    tcp_master_face->setServicePicker([this]() -> boost::asio::io_service& {
+        return nextCoreService();
+    });
+    _tcp_ingress_master_face = tcp_master_face;
+    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _shm_ingress_master_face = std::make_shared<ShmMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _metrics.addCollector(boost::bind(&StrategyRouter::writeMetrics, this, _1));
 }
 
 void StrategyRouter::run() {
-    _strategy = std::make_shared<MulticastStrategy>();
-    _strategy_name = "multicast";
+    publishStrategy("multicast", std::make_shared<MulticastStrategy>());
+    // before the ingress accepts any face, the commands are then read as usual
+    _startup_config.apply(_ios, _remote_command_endpoint, [this](const rapidjson::Document &command) {
+        executeCommand(command);
+    });
     commandRead();
     _tcp_ingress_master_face->listen(boost::bind(&StrategyRouter::onMasterFaceNotification, this, _1, _2),
-                                     boost::bind(&StrategyRouter::onIngressPacket, this, _1),
+                                     PacketHandler::bind<StrategyRouter, &StrategyRouter::onIngressPacket>(this),
                                      boost::bind(&StrategyRouter::onMasterFaceError, this, _1, _2));
     _udp_ingress_master_face->listen(boost::bind(&StrategyRouter::onMasterFaceNotification, this, _1, _2),
-                                     boost::bind(&StrategyRouter::onIngressPacket, this, _1),
+                                     PacketHandler::bind<StrategyRouter, &StrategyRouter::onIngressPacket>(this),
                                      boost::bind(&StrategyRouter::onMasterFaceError, this, _1, _2));
+    _shm_ingress_master_face->listen(boost::bind(&StrategyRouter::onMasterFaceNotification, this, _1, _2),
+                                     PacketHandler::bind<StrategyRouter, &StrategyRouter::onIngressPacket>(this),
+                                     boost::bind(&StrategyRouter::onMasterFaceError, this, _1, _2));
+}
+
+bool StrategyRouter::loadStartupConfig(const std::string &source) {
+    return _startup_config.load(source);
+}
+
+void StrategyRouter::beginDrain() {
+    _tcp_ingress_master_face->stopAccepting();
+    _udp_ingress_master_face->stopAccepting();
+    _shm_ingress_master_face->stopAccepting();
 }
 
-void StrategyRouter::onIngressPacket(const NdnPacket &packet) {
-    tbb::speculative_spin_rw_mutex::scoped_lock lock(_egress_faces_mutex, false);
-    auto egress_faces = _strategy->selectFaces(_egress_faces);
-    lock.release();
-    for (auto& egress_face : egress_faces) {
-        egress_face->send(packet);
+bool StrategyRouter::isDrained() {
+    size_t queued = _tcp_ingress_master_face->getQueuedPackets() + _udp_ingress_master_face->getQueuedPackets()
+                    + _shm_ingress_master_face->getQueuedPackets();
+    _egress.read([&queued](const Egress &egress) {
+        for (const auto &face : egress.faces) {
+            queued += face->getQueueStats().packets;
+        }
+    });
+    return queued == 0;
+}
+
+void StrategyRouter::publishStrategy(const std::string &name, const std::shared_ptr<const Strategy> &strategy) {
+    // the health is tracked from scratch, what it was the last time says nothing of now
+    bool is_tracking_health = name == "failover";
+    std::shared_ptr<const Strategy> previous;
+    std::vector<std::shared_ptr<FaceHealth>> health;
+    _egress.write([&strategy, is_tracking_health, &previous, &health](Egress &egress) {
+        previous = egress.strategy;
+        egress.strategy = strategy;
+        if (is_tracking_health) {
+            // made for the first instance written, the second one holds the same faces
+            if (health.empty()) {
+                for (size_t i = 0; i < egress.faces.size(); ++i) {
+                    health.push_back(std::make_shared<FaceHealth>());
+                }
+            }
+            egress.health = health;
+        }
+    });
+    // no reader is left on previous, it only keeps its state
+    if (previous && name != _strategy_name) {
+        _previous_strategies[_strategy_name] = previous;
     }
+    _previous_strategies.erase(name);
+    _strategy_name = name;
+    _is_tracking_health.store(is_tracking_health);
+    if (is_tracking_health && !_is_health_armed) {
+        armHealth();
+    }
+}
+
+void StrategyRouter::armHealth() {
+    _is_health_armed = true;
+    _health_timer.expires_from_now(boost::posix_time::milliseconds(HEALTH_INTERVAL_MS));
+    _health_timer.async_wait(boost::bind(&StrategyRouter::onHealthTimer, this, _1));
 }
 
-void StrategyRouter::onEgressPacket(const NdnPacket &packet) {
-    _tcp_ingress_master_face->sendToAllFaces(packet);
-    _udp_ingress_master_face->sendToAllFaces(packet);
+void StrategyRouter::onHealthTimer(const boost::system::error_code &err) {
+    _is_health_armed = false;
+    if (err || !_is_tracking_health.load()) {
+        return;
+    }
+    FaceHealth::Clock::time_point now = FaceHealth::Clock::now();
+    _egress.read([this, &now](const Egress &egress) {
+        for (size_t i = 0; i < egress.faces.size(); ++i) {
+            bool was_usable = egress.health[i]->isUsable();
+            egress.health[i]->update(egress.faces[i]->getQueueStats().packets, now, _health_settings);
+            if (egress.health[i]->isUsable() != was_usable) {
+                logger::log(logger::INFO, was_usable ? "face with ID = {} stalled, failing over" : "face with ID = {} answers again, failing back",
+                            {egress.faces[i]->getFaceId()});
+            }
+        }
+    });
+    armHealth();
+}
+
+void StrategyRouter::onIngressPacket(const std::shared_ptr<Face> &ingress_face, const NdnPacket &packet) {
+    if (_data_unicast.load(std::memory_order_relaxed) && packet.getType() == NdnPacket::INTEREST) {
+        _return_table.insert(packet.getNameView(), ingress_face);
+    }
+    // after the insert, the face of a repeat gets the Data as well
+    if (_interest_aggregator.isEnabled() && packet.getType() == NdnPacket::INTEREST
+        && _interest_aggregator.isRepeat(packet.getNameView().getHash(), coarse_clock::now())) {
+        return;
+    }
+    // the faces are used in place, a send only queues the packet on its face
+    _egress.readWithGeneration([this, &packet](const Egress &egress, uint64_t generation) {
+        if (!egress.strategy) {
+            return;
+        }
+        auto selection = select(egress, packet, generation);
+        bool is_tracking = packet.getType() == NdnPacket::INTEREST && _is_tracking_health.load(std::memory_order_relaxed);
+        FaceHealth::Clock::time_point now = is_tracking ? coarse_clock::now() : FaceHealth::Clock::time_point();
+        for (size_t i = 0; i < selection.count; ++i) {
+            size_t index = (selection.first + i) % egress.faces.size();
+            egress.faces[index]->send(packet);
+            if (is_tracking) {
+                egress.health[index]->onInterest(now);
+            }
+        }
+        if (selection.probe != Strategy::NO_PROBE) {
+            egress.faces[selection.probe]->send(packet);
+            if (is_tracking) {
+                egress.health[selection.probe]->onInterest(now);
+            }
+        }
+    });
+}
+
+Strategy::Selection StrategyRouter::select(const Egress &egress, const NdnPacket &packet, uint64_t generation) const {
+    size_t flow_length = egress.strategy->getFlowLength();
+    if (flow_length == 0 || !_is_caching_flows.load(std::memory_order_relaxed)) {
+        return egress.strategy->selectFaces(packet, egress.faces, egress.key_hashes, egress.health);
+    }
+    // a selection only indexes the faces of its generation
+    thread_local FlowCache<Strategy::Selection> cache;
+    uint64_t key = FlowCache<Strategy::Selection>::getKey(packet.getNameView(), flow_length);
+    if (const Strategy::Selection *cached = cache.find(key, generation)) {
+        return *cached;
+    }
+    Strategy::Selection selection = egress.strategy->selectFaces(packet, egress.faces, egress.key_hashes, egress.health);
+    cache.insert(key, generation, selection);
+    return selection;
+}
+
+void StrategyRouter::onEgressPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    if (_is_tracking_health.load(std::memory_order_relaxed) && packet.getType() == NdnPacket::DATA) {
+        _egress.read([&face](const Egress &egress) {
+            for (size_t i = 0; i < egress.faces.size(); ++i) {
+                if (egress.faces[i] == face) {
+                    egress.health[i]->onData(coarse_clock::now());
+                    break;
+                }
+            }
+        });
+    }
+    if (_data_unicast.load(std::memory_order_relaxed) && packet.getType() == NdnPacket::DATA) {
+        FaceTable::Faces faces;
+        if (_return_table.lookup(packet.getNameView(), faces)) {
+            for (const auto &face : faces) {
+                face->send(packet);
+            }
+            return;
+        }
+    }
+    std::shared_ptr<const ndn::Buffer> wire = packet.getWire();
+    _tcp_ingress_master_face->sendToAllFaces(wire);
+    // the faces of the UDP and SHM master faces are only walked from _ios, the packet comes from a core
+    _ios.post([this, wire]() {
+        _udp_ingress_master_face->sendToAllFaces(wire);
+        _shm_ingress_master_face->sendToAllFaces(wire);
+    });
 }
 
 void StrategyRouter::onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "new face with ID = " << face->getFaceId() << " form master face with ID = " << master_face->getMasterFaceId();
-    logger::log(logger::INFO, ss.str());
+    logger::log(logger::INFO, "new face with ID = {} form master face with ID = {}",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void StrategyRouter::onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "face with ID = " << face->getFaceId() << " from master face with ID = " << master_face->getMasterFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    logger::log(logger::ERROR, "face with ID = {} from master face with ID = {} can't process normally",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void StrategyRouter::onFaceError(const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "face with ID = " << face->getFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
-    tbb::speculative_spin_rw_mutex::scoped_lock lock(_egress_faces_mutex, true);
-    for (auto& egress_face : _egress_faces) {
-        if(egress_face == face) {
-            std::swap(egress_face, _egress_faces.back());
-            _egress_faces.pop_back();
-            break;
+    logger::log(logger::ERROR, "face with ID = {} can't process normally", {face->getFaceId()});
+    _egress.write([&face](Egress &egress) {
+        for (size_t i = 0; i < egress.faces.size(); ++i) {
+            if(egress.faces[i] == face) {
+                std::swap(egress.faces[i], egress.faces.back());
+                std::swap(egress.key_hashes[i], egress.key_hashes.back());
+                std::swap(egress.health[i], egress.health.back());
+                egress.faces.pop_back();
+                egress.key_hashes.pop_back();
+                egress.health.pop_back();
+                break;
+            }
         }
-    }
+    });
 }
 
 void StrategyRouter::commandRead() {
@@ -79,43 +247,13 @@ void StrategyRouter::commandRead() {
 }
 
 void StrategyRouter::commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred) {
-    enum ActionType {
-        EDIT_CONFIG,
-        ADD_FACE,
-        DEL_FACE,
-        LIST
-    };
-
-    static const std::unordered_map<std::string, ActionType> ACTIONS = {
-            {"edit_config", EDIT_CONFIG},
-            {"add_face", ADD_FACE},
-            {"del_face", DEL_FACE},
-            {"list", LIST}
-    };
-
     if(!err) {
         try {
             rapidjson::Document document;
             document.Parse(_command_buffer, bytes_transferred);
             if(!document.HasParseError()){
                 if(document.HasMember("action") && document["action"].IsString() && document.HasMember("id") && document["id"].IsUint()){
-                    auto it = ACTIONS.find(document["action"].GetString());
-                    if(it != ACTIONS.end()) {
-                        switch (it->second) {
-                            case EDIT_CONFIG:
-                                commandEditConfig(document);
-                                break;
-                            case ADD_FACE:
-                                commandAddFace(document);
-                                break;
-                            case DEL_FACE:
-                                commandDelFace(document);
-                                break;
-                            case LIST:
-                                commandList(document);
-                                break;
-                        }
-                    }
+                    executeCommand(document);
                 } else{
                     std::string response = R"({"status":"fail", "reason":"action not provided or not implemented"})";
                     _command_socket.send_to(boost::asio::buffer(response), _remote_command_endpoint);
@@ -134,40 +272,190 @@ void StrategyRouter::commandReadHandler(const boost::system::error_code &err, si
     }
 }
 
+void StrategyRouter::executeCommand(const rapidjson::Document &document) {
+    enum ActionType {
+        EDIT_CONFIG,
+        ADD_FACE,
+        DEL_FACE,
+        LIST,
+        MEMORY_STATS
+    };
+
+    static const std::unordered_map<std::string, ActionType> ACTIONS = {
+            {"edit_config", EDIT_CONFIG},
+            {"add_face", ADD_FACE},
+            {"del_face", DEL_FACE},
+            {"list", LIST},
+            {"memory_stats", MEMORY_STATS}
+    };
+
+    auto it = ACTIONS.find(document["action"].GetString());
+    if (it == ACTIONS.end()) {
+        return;
+    }
+    switch (it->second) {
+        case EDIT_CONFIG:
+            commandEditConfig(document);
+            break;
+        case ADD_FACE:
+            commandAddFace(document);
+            break;
+        case DEL_FACE:
+            commandDelFace(document);
+            break;
+        case LIST:
+            commandList(document);
+            break;
+        case MEMORY_STATS:
+            commandMemoryStats(document);
+            break;
+    }
+}
+
 void StrategyRouter::commandEditConfig(const rapidjson::Document &document) {
     std::vector<std::string> changes;
+    if (document.HasMember("hash_prefix_length") && document["hash_prefix_length"].IsUint()) {
+        bool has_change = false;
+        size_t prefix_length = document["hash_prefix_length"].GetUint();
+        if (prefix_length != _hash_prefix_length) {
+            _hash_prefix_length = prefix_length;
+            if (_strategy_name == "hashing") {
+                publishStrategy("hashing", std::make_shared<HashingStrategy>(_hash_prefix_length));
+            } else {
+                // hashes with the former length
+                _previous_strategies.erase("hashing");
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("hash_prefix_length");
+        }
+    }
+    if (document.HasMember("data_unicast") && document["data_unicast"].IsBool()) {
+        bool has_change = false;
+        bool data_unicast = document["data_unicast"].GetBool();
+        if (data_unicast != _data_unicast.load()) {
+            _data_unicast.store(data_unicast);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("data_unicast");
+        }
+    }
+    if (document.HasMember("flow_cache") && document["flow_cache"].IsBool()) {
+        bool has_change = false;
+        bool is_caching_flows = document["flow_cache"].GetBool();
+        if (is_caching_flows != _is_caching_flows.load()) {
+            _is_caching_flows.store(is_caching_flows);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("flow_cache");
+        }
+    }
+    if (document.HasMember("return_ttl") && document["return_ttl"].IsUint() && document["return_ttl"].GetUint() > 0) {
+        bool has_change = false;
+        ndn::time::milliseconds ttl(document["return_ttl"].GetUint());
+        if (ttl != _return_table.getTtl()) {
+            _return_table.setTtl(ttl);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("return_ttl");
+        }
+    }
+    if (document.HasMember("aggregation_window") && document["aggregation_window"].IsUint()) {
+        bool has_change = false;
+        ndn::time::milliseconds window(document["aggregation_window"].GetUint());
+        if (window != _interest_aggregator.getWindow()) {
+            _interest_aggregator.setWindow(window);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("aggregation_window");
+        }
+    }
+    if (document.HasMember("failover_stall_timeout") && document["failover_stall_timeout"].IsUint()
+        && document["failover_stall_timeout"].GetUint() > 0) {
+        bool has_change = false;
+        ndn::time::milliseconds stall_timeout(document["failover_stall_timeout"].GetUint());
+        if (stall_timeout != _health_settings.stall_timeout) {
+            _health_settings.stall_timeout = stall_timeout;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("failover_stall_timeout");
+        }
+    }
+    if (document.HasMember("failover_probe_interval") && document["failover_probe_interval"].IsUint()
+        && document["failover_probe_interval"].GetUint() > 0) {
+        bool has_change = false;
+        ndn::time::milliseconds probe_interval(document["failover_probe_interval"].GetUint());
+        if (probe_interval != _health_settings.probe_interval) {
+            _health_settings.probe_interval = probe_interval;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("failover_probe_interval");
+        }
+    }
+    if (document.HasMember("failover_max_queue") && document["failover_max_queue"].IsUint()) {
+        bool has_change = false;
+        size_t max_queue = document["failover_max_queue"].GetUint();
+        if (max_queue != _health_settings.max_queue) {
+            _health_settings.max_queue = max_queue;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("failover_max_queue");
+        }
+    }
+    if (document.HasMember("connection_pool") && _connection_pool.update(document["connection_pool"])) {
+        changes.emplace_back("connection_pool");
+    }
     if (document.HasMember("strategy") && document["strategy"].IsString()) {
         enum StrategyType {
             MULTICAST,
             LOADBALANCING,
-            FAILOVER
+            FAILOVER,
+            HASHING
         };
 
         static const std::unordered_map<std::string, StrategyType> STRATEGIES = {
                 {"multicast", MULTICAST},
                 {"loadbalancing", LOADBALANCING},
-                {"failover", FAILOVER}
+                {"failover", FAILOVER},
+                {"hashing", HASHING}
         };
 
         bool has_change = false;
         if (document["strategy"].GetString() != _strategy_name) {
             auto it = STRATEGIES.find(document["strategy"].GetString());
-            tbb::speculative_spin_rw_mutex::scoped_lock lock(_egress_faces_mutex, true);
             if (it != STRATEGIES.end()) {
-                switch (it->second) {
-                    case MULTICAST:
-                        _strategy = std::make_shared<MulticastStrategy>();
-                        _strategy_name = "multicast";
-                        break;
-                    case LOADBALANCING:
-                        _strategy = std::make_shared<LoadbalancingStrategy>();
-                        _strategy_name = "loadbalancing";
-                        break;
-                    case FAILOVER:
-                        _strategy = std::make_shared<FailoverStrategy>();
-                        _strategy_name = "failover";
-                        break;
+                // with carry_state false, the strategy starts anew rather than from where it was left
+                bool carry_state = !document.HasMember("carry_state") || !document["carry_state"].IsBool()
+                                   || document["carry_state"].GetBool();
+                auto previous = _previous_strategies.find(it->first);
+                std::shared_ptr<const Strategy> strategy;
+                if (carry_state && previous != _previous_strategies.end()) {
+                    strategy = previous->second;
+                } else {
+                    switch (it->second) {
+                        case MULTICAST:
+                            strategy = std::make_shared<MulticastStrategy>();
+                            break;
+                        case LOADBALANCING:
+                            strategy = std::make_shared<LoadbalancingStrategy>();
+                            break;
+                        case FAILOVER:
+                            strategy = std::make_shared<FailoverStrategy>();
+                            break;
+                        case HASHING:
+                            strategy = std::make_shared<HashingStrategy>(_hash_prefix_length);
+                            break;
+                    }
                 }
+                publishStrategy(it->first, strategy);
                 has_change = true;
             }
             if (has_change) {
@@ -195,11 +483,13 @@ void StrategyRouter::commandAddFace(const rapidjson::Document &document) {
     enum layer_type {
         TCP,
         UDP,
+        SHM,
     };
 
     static const std::unordered_map<std::string, layer_type> LAYERS = {
             {"tcp", TCP},
             {"udp", UDP},
+            {"shm", SHM},
     };
 
     if (document.HasMember("layer") && document.HasMember("address") && document.HasMember("port")
@@ -209,17 +499,24 @@ void StrategyRouter::commandAddFace(const rapidjson::Document &document) {
             std::shared_ptr<Face> face;
             switch (it->second) {
                 case TCP:
-                    face = std::make_shared<TcpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    face = _connection_pool.makeFace(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
                     break;
                 case UDP:
-                    face = std::make_shared<UdpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    face = std::make_shared<UdpFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
+                    break;
+                case SHM:
+                    face = std::make_shared<ShmFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
                     break;
             }
-            tbb::speculative_spin_rw_mutex::scoped_lock lock(_egress_faces_mutex, true);
-            _egress_faces.push_back(face);
-            face->open(boost::bind(&StrategyRouter::onEgressPacket, this, _1),
+            face->open(PacketHandler::bind<StrategyRouter, &StrategyRouter::onEgressPacket>(this),
                        boost::bind(&StrategyRouter::onFaceError, this, _1));
-            lock.release();
+            uint64_t key_hash = rendezvous_hash::hashKey(face->getUnderlyingEndpoint());
+            std::shared_ptr<FaceHealth> health = std::make_shared<FaceHealth>();
+            _egress.write([&face, key_hash, &health](Egress &egress) {
+                egress.faces.push_back(face);
+                egress.key_hashes.push_back(key_hash);
+                egress.health.push_back(health);
+            });
             std::stringstream ss;
             ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_face", "face_id":)" << face->getFaceId() << "}";
             _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
@@ -230,15 +527,25 @@ void StrategyRouter::commandAddFace(const rapidjson::Document &document) {
 void StrategyRouter::commandDelFace(const rapidjson::Document &document) {
     if (document.HasMember("face_id") && document["face_id"].IsUint()) {
         size_t face_id = document["face_id"].GetUint();
-        bool ok = false;
-        for (auto& egress_face : _egress_faces) {
-            if (egress_face->getFaceId() == face_id) {
-                egress_face->close();
-                std::swap(egress_face, _egress_faces.back());
-                _egress_faces.pop_back();
-                ok = true;
-                break;
+        std::shared_ptr<Face> face;
+        _egress.write([face_id, &face](Egress &egress) {
+            for (size_t i = 0; i < egress.faces.size(); ++i) {
+                if (egress.faces[i]->getFaceId() == face_id) {
+                    face = egress.faces[i];
+                    std::swap(egress.faces[i], egress.faces.back());
+                    std::swap(egress.key_hashes[i], egress.key_hashes.back());
+                    std::swap(egress.health[i], egress.health.back());
+                    egress.faces.pop_back();
+                    egress.key_hashes.pop_back();
+                    egress.health.pop_back();
+                    break;
+                }
             }
+        });
+        // closed once no packet can be sent to it anymore
+        bool ok = face != nullptr;
+        if (face) {
+            face->close();
         }
         std::stringstream ss;
         ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_face", "face_id":)" << face_id << R"(, "status":)" << ok << "}";
@@ -248,6 +555,61 @@ void StrategyRouter::commandDelFace(const rapidjson::Document &document) {
 
 void StrategyRouter::commandList(const rapidjson::Document &document) {
     std::stringstream ss;
-    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list", "strategy":")" << _strategy_name << "\"}";
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list", "strategy":")" << _strategy_name
+       << R"(", "hash_prefix_length":)" << _hash_prefix_length << R"(, "data_unicast":)" << (_data_unicast.load() ? "true" : "false")
+       << R"(, "flow_cache":)" << (_is_caching_flows.load() ? "true" : "false")
+       << R"(, "return_table":)" << _return_table.toJSON() << R"(, "aggregation":)" << _interest_aggregator.toJSON()
+       << R"(, "failover":{"stall_timeout":)" << _health_settings.stall_timeout.count() << R"(, "probe_interval":)"
+       << _health_settings.probe_interval.count() << R"(, "max_queue":)" << _health_settings.max_queue << R"(, "faces":[)";
+    if (_is_tracking_health.load()) {
+        _egress.read([&ss](const Egress &egress) {
+            for (size_t i = 0; i < egress.faces.size(); ++i) {
+                ss << (i == 0 ? "" : ", ") << R"({"face_id":)" << egress.faces[i]->getFaceId() << R"(, "health":)" << egress.health[i]->toJSON() << "}";
+            }
+        });
+    }
+    ss << R"(]}, "connection_pool":)" << _connection_pool.toJSON() << R"(, "buffer_pool":)" << BufferPool::getStats().toJSON() << "}";
+    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+}
+
+void StrategyRouter::commandMemoryStats(const rapidjson::Document &document) {
+    MemoryStats stats;
+    MemoryStats instance;
+    _egress.read([&stats, &instance](const Egress &egress) {
+        instance.add("egress", egress.faces.size(), memory_usage::of(egress.faces) + memory_usage::of(egress.key_hashes)
+                                                    + memory_usage::of(egress.health));
+        stats.add("face_health", egress.health.size(), egress.health.size() * memory_usage::ofShared<FaceHealth>());
+        for (const auto &face : egress.faces) {
+            face->addMemoryStats(stats);
+        }
+    });
+    stats.add(instance, 2);
+    stats.add("return_table", _return_table.size(), _return_table.getMemoryUsage());
+    stats.add("interest_aggregator", 1, _interest_aggregator.getMemoryUsage());
+    _tcp_ingress_master_face->addMemoryStats(stats);
+    _udp_ingress_master_face->addMemoryStats(stats);
+    _shm_ingress_master_face->addMemoryStats(stats);
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"memory_stats", "memory":)"
+       << stats.toJSON() << "}";
     _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
 }
+
+void StrategyRouter::writeMetrics(MetricsWriter &writer) {
+    bool is_tracking_health = _is_tracking_health.load();
+    _egress.read([&writer, is_tracking_health](const Egress &egress) {
+        for (size_t i = 0; i < egress.faces.size(); ++i) {
+            egress.faces[i]->writeMetrics(writer);
+            if (is_tracking_health) {
+                egress.health[i]->writeMetrics(writer, egress.faces[i]->getFaceId());
+            }
+        }
+    });
+    _tcp_ingress_master_face->writeMetrics(writer);
+    _udp_ingress_master_face->writeMetrics(writer);
+    _shm_ingress_master_face->writeMetrics(writer);
+    BufferPool::getStats().writeMetrics(writer);
+    stage_profile::writeMetrics(writer);
+    _return_table.writeMetrics(writer);
+    _interest_aggregator.writeMetrics(writer);
+}
@@ -2,44 +2,106 @@
 
 #include <boost/asio.hpp>
 
+#include <atomic>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
-#include <tbb/spin_rw_mutex.h>
-
 #include "rapidjson/document.h"
 
-#include "module.h"
+#include "runtime/core_module.h"
+#include "management/startup_config.h"
+#include "interest_aggregator.h"
 #include "strategy.h"
+#include "tree/left_right.h"
 #include "network/face.h"
 #include "network/master_face.h"
+#include "network/return_table.h"
+#include "network/tcp_connection_pool.h"
 
-class StrategyRouter : public Module {
+// threads: each face runs on one core service (-j), the strategies and the faces lists are shared through LeftRight,
+// the commands run on _ios
+class StrategyRouter : public CoreModule {
 private:
+    // what the packets are forwarded with, the faces and the strategy are changed together
+    struct Egress {
+        std::vector<std::shared_ptr<Face>> faces;
+        // rendezvous_hash key of the endpoint of each face, by index in faces
+        std::vector<uint64_t> key_hashes;
+        // of each face, by index in faces, shared by the two instances and made anew when failover is picked
+        std::vector<std::shared_ptr<FaceHealth>> health;
+        // shared by the two instances, only its own atomics change once it is published
+        std::shared_ptr<const Strategy> strategy;
+    };
+
     const std::string _name;
 
     std::string _strategy_name;
-    std::shared_ptr<Strategy> _strategy;
+    // those replaced, by name, picked again with the state they had, e.g. where the round robin was
+    std::unordered_map<std::string, std::shared_ptr<const Strategy>> _previous_strategies;
+    size_t _hash_prefix_length = 2;
 
     char _command_buffer[65536];
     boost::asio::ip::udp::socket _command_socket;
     boost::asio::ip::udp::endpoint _remote_command_endpoint;
-
-    tbb::speculative_spin_rw_mutex _egress_faces_mutex;
-    std::vector<std::shared_ptr<Face>> _egress_faces;
+    StartupConfig _startup_config;
+    // connections kept open to the endpoints set by edit_config, add_face takes them
+    TcpConnectionPool _connection_pool;
+
+    // read by every packet without a lock, see LeftRight
+    LeftRight<Egress> _egress;
+    // by the Interests from the ingress faces, the Data go back to the faces which asked when data_unicast is on
+    std::atomic<bool> _data_unicast{false};
+    ReturnTable _return_table;
+    // off by default, the selections of the strategies which allow it are then kept by flow on each thread
+    std::atomic<bool> _is_caching_flows{false};
+    // while the strategy is failover, the packets then keep the FaceHealth of the egress faces
+    std::atomic<bool> _is_tracking_health{false};
+    // on _ios, the FaceHealth are updated every HEALTH_INTERVAL_MS while tracking
+    FaceHealth::Settings _health_settings;
+    boost::asio::deadline_timer _health_timer;
+    bool _is_health_armed = false;
+    // off until edit_config sets an aggregation_window
+    InterestAggregator _interest_aggregator;
     std::shared_ptr<MasterFace> _tcp_ingress_master_face;
     std::shared_ptr<MasterFace> _udp_ingress_master_face;
+    std::shared_ptr<MasterFace> _shm_ingress_master_face;
+
+    // the ingress master faces stop accepting, the faces already there are served until the module stops
+    void beginDrain() override;
+
+    // nothing queued on the faces
+    bool isDrained() override;
+
+    // on _ios, the readers go on with the previous strategy until the write switched them, no packet is lost. the
+    // health of the faces is tracked anew when failover is picked
+    void publishStrategy(const std::string &name, const std::shared_ptr<const Strategy> &strategy);
+
+    // the selection of the strategy of egress, from the flow cache of the thread if on, for the egress of generation
+    Strategy::Selection select(const Egress &egress, const NdnPacket &packet, uint64_t generation) const;
+
+    void armHealth();
+
+    void onHealthTimer(const boost::system::error_code &err);
 
 public:
-    StrategyRouter(const std::string &name, uint16_t local_port, uint16_t local_command_port);
+    static const size_t DEFAULT_CONCURRENCY = 4;
+    static const size_t HEALTH_INTERVAL_MS = 5;
+
+    StrategyRouter(const std::string &name, uint16_t local_port, uint16_t local_command_port, size_t concurrency = DEFAULT_CONCURRENCY);
 
     ~StrategyRouter() override = default;
 
     void run() override;
 
-    void onIngressPacket(const NdnPacket &packet);
+    // the commands applied by run() before the ingress accepts a face, see StartupConfig. false if source can't be
+    // read. before start()
+    bool loadStartupConfig(const std::string &source);
+
+    void onIngressPacket(const std::shared_ptr<Face> &ingress_face, const NdnPacket &packet);
 
-    void onEgressPacket(const NdnPacket &packet);
+    void onEgressPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet);
 
     void onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
 
@@ -51,6 +113,9 @@ public:
 
     void commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred);
 
+    // a parsed command with an action, on _ios
+    void executeCommand(const rapidjson::Document &document);
+
     void commandEditConfig(const rapidjson::Document &document);
 
     void commandAddFace(const rapidjson::Document &document);
@@ -58,4 +123,10 @@ public:
     void commandDelFace(const rapidjson::Document &document);
 
     void commandList(const rapidjson::Document &document);
+
+    // the bytes held by the egress faces, the side tables and the ingress faces, see MemoryStats
+    void commandMemoryStats(const rapidjson::Document &document);
+
+    // at each scrape, from _ios as commandList
+    void writeMetrics(MetricsWriter &writer);
 };
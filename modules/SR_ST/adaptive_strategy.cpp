@@ -0,0 +1,60 @@
+#include "adaptive_strategy.h"
+
+#include <tuple>
+
+const ndn::time::milliseconds AdaptiveStrategy::DEFAULT_PROBE_INTERVAL {1000};
+
+AdaptiveStrategy::AdaptiveStrategy(const ndn::time::milliseconds &probe_interval, const ndn::time::milliseconds &timeout)
+        : Strategy()
+        , _probe_interval(probe_interval)
+        , _measurements(timeout) {
+
+}
+
+std::vector<std::shared_ptr<Face>> AdaptiveStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) {
+    if (faces.empty()) {
+        return std::vector<std::shared_ptr<Face>>();
+    }
+    // only the Interests are measured, a Data from a consumer goes to the best face as well
+    if (packet.getType() != NdnPacket::INTEREST) {
+        return {faces[0]};
+    }
+    _measurements.prune(faces);
+    size_t best = 0;
+    // 0 for the faces measured, 1 for those not measured yet and 2 for those timing out
+    std::tuple<int, double> best_cost;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        const FaceMeasurements::Measurement *measurement = _measurements.find(faces[i]->getFaceId());
+        std::tuple<int, double> cost;
+        if (measurement && measurement->isTimingOut()) {
+            cost = std::make_tuple(2, static_cast<double>(measurement->timeouts));
+        } else if (!measurement || measurement->samples == 0) {
+            cost = std::make_tuple(1, 0.0);
+        } else {
+            cost = std::make_tuple(0, measurement->srtt + static_cast<double>(faces[i]->getQueueStats().packets * QUEUED_PACKET_COST));
+        }
+        if (i == 0 || cost < best_cost) {
+            best = i;
+            best_cost = cost;
+        }
+    }
+    std::vector<std::shared_ptr<Face>> selected_faces = {faces[best]};
+    Clock::time_point now = Clock::now();
+    if (faces.size() > 1 && now - _last_probe >= _probe_interval) {
+        size_t probe = _probe_index++ % (faces.size() - 1);
+        selected_faces.emplace_back(faces[probe < best ? probe : probe + 1]);
+        _last_probe = now;
+    }
+    for (const auto &face : selected_faces) {
+        _measurements.onInterest(packet.getNameView(), face, now);
+    }
+    return selected_faces;
+}
+
+void AdaptiveStrategy::onData(const NdnPacket &packet, const std::shared_ptr<Face> &face) {
+    _measurements.onData(packet.getNameView(), face);
+}
+
+const FaceMeasurements* AdaptiveStrategy::getMeasurements() const {
+    return &_measurements;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "face_measurements.h"
+#include "strategy.h"
+
+// each Interest goes to the face which answers the soonest, as the ASF strategy of NFD: faces are ranked by their
+// srtt plus the packets waiting in their queue, the faces not measured yet come after those measured and the faces
+// timing out last. every probe_interval an Interest is also sent to one of the other faces in turn, so that their
+// measurements stay current and a face which got faster is found again
+class AdaptiveStrategy : public Strategy {
+public:
+    using Clock = FaceMeasurements::Clock;
+
+    static const ndn::time::milliseconds DEFAULT_PROBE_INTERVAL;
+    // in microseconds, the cost of each packet queued on a face
+    static const size_t QUEUED_PACKET_COST = 100;
+
+private:
+    const ndn::time::milliseconds _probe_interval;
+    FaceMeasurements _measurements;
+    Clock::time_point _last_probe;
+    size_t _probe_index = 0;
+
+public:
+    explicit AdaptiveStrategy(const ndn::time::milliseconds &probe_interval = DEFAULT_PROBE_INTERVAL,
+                              const ndn::time::milliseconds &timeout = FaceMeasurements::DEFAULT_TIMEOUT);
+
+    ~AdaptiveStrategy() override = default;
+
+    std::vector<std::shared_ptr<Face>> selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) override;
+
+    void onData(const NdnPacket &packet, const std::shared_ptr<Face> &face) override;
+
+    const FaceMeasurements* getMeasurements() const override;
+};
\ No newline at end of file
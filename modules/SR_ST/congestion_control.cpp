@@ -0,0 +1,120 @@
+#include "congestion_control.h"
+
+#include <sstream>
+
+#include "metrics/memory_stats.h"
+#include "network/lp_link.h"
+
+TokenBucket& CongestionControl::getBucket(const std::shared_ptr<Face> &face) {
+    auto it = _buckets.find(face->getFaceId());
+    if (it == _buckets.end()) {
+        it = _buckets.emplace(face->getFaceId(), TokenBucket(_rate, _burst)).first;
+    }
+    return it->second;
+}
+
+bool CongestionControl::isCongested(const std::shared_ptr<Face> &face, const Clock::time_point &now) {
+    return (_queue_threshold > 0 && face->getQueueStats().packets >= _queue_threshold) || !getBucket(face).canTake(now);
+}
+
+bool CongestionControl::isEnabled() const {
+    return _queue_threshold > 0 || _rate > 0;
+}
+
+std::string CongestionControl::getAction() const {
+    switch (_action) {
+        case SHED:
+            return "shed";
+        case MARK:
+            return "mark";
+        case DROP:
+            return "drop";
+    }
+    return "";
+}
+
+bool CongestionControl::setAction(const std::string &action) {
+    static const std::unordered_map<std::string, Action> ACTIONS = {
+            {"shed", SHED},
+            {"mark", MARK},
+            {"drop", DROP}
+    };
+
+    auto it = ACTIONS.find(action);
+    if (it == ACTIONS.end()) {
+        return false;
+    }
+    _action = it->second;
+    return true;
+}
+
+size_t CongestionControl::getQueueThreshold() const {
+    return _queue_threshold;
+}
+
+void CongestionControl::setQueueThreshold(size_t queue_threshold) {
+    _queue_threshold = queue_threshold;
+}
+
+double CongestionControl::getRate() const {
+    return _rate;
+}
+
+double CongestionControl::getBurst() const {
+    return _burst;
+}
+
+void CongestionControl::setRate(double rate, double burst) {
+    _rate = rate;
+    _burst = burst;
+    _buckets.clear();
+}
+
+const std::vector<std::shared_ptr<Face>>& CongestionControl::getFaces(const std::vector<std::shared_ptr<Face>> &faces, const Clock::time_point &now) {
+    // the faces removed since are forgotten once they outnumber those left
+    if (_buckets.size() > 2 * faces.size()) {
+        _buckets.clear();
+    }
+    if (_action != SHED) {
+        return faces;
+    }
+    _uncongested_faces.clear();
+    for (const auto &face : faces) {
+        if (!isCongested(face, now)) {
+            _uncongested_faces.emplace_back(face);
+        }
+    }
+    if (_uncongested_faces.size() < faces.size()) {
+        ++_shed;
+        if (_uncongested_faces.empty()) {
+            ++_dropped;
+        }
+    }
+    return _uncongested_faces;
+}
+
+void CongestionControl::send(const std::shared_ptr<Face> &face, const NdnPacket &packet, const Clock::time_point &now) {
+    bool is_congested = _queue_threshold > 0 && face->getQueueStats().packets >= _queue_threshold;
+    if (!is_congested && getBucket(face).take(now)) {
+        face->send(packet);
+        return;
+    }
+    if (_action == MARK) {
+        const ndn::Block &block = packet.getBlock();
+        face->send(LpLink::congestionMark(block.wire(), block.size()));
+        ++_marked;
+    } else {
+        ++_dropped;
+    }
+}
+
+size_t CongestionControl::getMemoryUsage() const {
+    return memory_usage::of(_buckets) + memory_usage::of(_uncongested_faces);
+}
+
+std::string CongestionControl::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"action":")" << getAction() << R"(", "queue_threshold":)" << _queue_threshold << R"(, "rate":)" << _rate << R"(, "burst":)" << _burst
+       << R"(, "shed":)" << _shed << R"(, "marked":)" << _marked << R"(, "dropped":)" << _dropped << "}";
+    return ss.str();
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "network/face.h"
+#include "network/ndn_packet.h"
+#include "network/token_bucket.h"
+
+// congestion of the egress faces: a face is congested while its egress queue holds queue_threshold packets or more
+// (0 for no threshold) or while its token bucket of rate Interests per second (0 for no limit) is empty. an Interest
+// the strategy would send to a congested face is, by action, kept from it with the strategy choosing among the other
+// faces and dropped if they are all congested (shed), sent anyway with an NDNLPv2 CongestionMark (mark), or dropped
+// at once (drop), so that a slow content store doesn't back up the hops before it
+class CongestionControl {
+public:
+    using Clock = ndn::time::steady_clock;
+
+    enum Action {
+        SHED,
+        MARK,
+        DROP,
+    };
+
+private:
+    Action _action = SHED;
+    size_t _queue_threshold = 0;
+    double _rate = 0;
+    double _burst = 1;
+    // by face ID
+    std::unordered_map<size_t, TokenBucket> _buckets;
+    std::vector<std::shared_ptr<Face>> _uncongested_faces;
+
+    uint64_t _shed = 0;
+    uint64_t _marked = 0;
+    uint64_t _dropped = 0;
+
+    TokenBucket& getBucket(const std::shared_ptr<Face> &face);
+
+    bool isCongested(const std::shared_ptr<Face> &face, const Clock::time_point &now);
+
+public:
+    bool isEnabled() const;
+
+    std::string getAction() const;
+
+    // false if the action is unknown
+    bool setAction(const std::string &action);
+
+    size_t getQueueThreshold() const;
+
+    void setQueueThreshold(size_t queue_threshold);
+
+    double getRate() const;
+
+    double getBurst() const;
+
+    // the buckets start full again
+    void setRate(double rate, double burst);
+
+    // the faces the strategy chooses among, only those not congested with shed. empty if they are all congested
+    const std::vector<std::shared_ptr<Face>>& getFaces(const std::vector<std::shared_ptr<Face>> &faces, const Clock::time_point &now = Clock::now());
+
+    // the packet is sent to the face the strategy chose, marked or not, or dropped
+    void send(const std::shared_ptr<Face> &face, const NdnPacket &packet, const Clock::time_point &now = Clock::now());
+
+    // of the buckets by face
+    size_t getMemoryUsage() const;
+
+    // {"action", "queue_threshold", "rate", "burst", "shed", "marked", "dropped"}
+    std::string toJSON() const;
+};
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "face_measurements.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <unordered_set>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+
+const ndn::time::milliseconds FaceMeasurements::DEFAULT_TIMEOUT {2000};
+
+FaceMeasurements::FaceMeasurements(const ndn::time::milliseconds &timeout) : _timeout(timeout) {
+
+}
+
+uint64_t FaceMeasurements::getKey(uint64_t name_hash, size_t face_id) {
+    return name_hash::mix(name_hash, face_id);
+}
+
+void FaceMeasurements::removeExpired(const Clock::time_point &now) {
+    while (!_sent.empty() && _sent.front().first + _timeout <= now) {
+        auto it = _pending.find(_sent.front().second);
+        if (it != _pending.end() && it->second.sent == _sent.front().first) {
+            ++_faces[it->second.face_id].timeouts;
+            _pending.erase(it);
+        }
+        _sent.pop_front();
+    }
+}
+
+void FaceMeasurements::onInterest(const NameView &name, const std::shared_ptr<Face> &face, const Clock::time_point &now) {
+    removeExpired(now);
+    _faces[face->getFaceId()];
+    if (_pending.size() >= MAX_PENDING) {
+        return;
+    }
+    uint64_t key = getKey(name.getHash(), face->getFaceId());
+    _pending[key] = Pending{face->getFaceId(), now};
+    _sent.emplace_back(now, key);
+}
+
+void FaceMeasurements::onData(const NameView &name, const std::shared_ptr<Face> &face, const Clock::time_point &now) {
+    // the longest prefix first, the Name of the Interest itself unless it was CanBePrefix
+    for (size_t length = name.size() + 1; length-- > 0;) {
+        auto it = _pending.find(getKey(name.getPrefixHash(length), face->getFaceId()));
+        if (it == _pending.end()) {
+            continue;
+        }
+        // alpha = 1/8 and beta = 1/4 as RttStats, the first sample sets both
+        double sample = static_cast<double>(std::max<int64_t>(ndn::time::duration_cast<ndn::time::microseconds>(now - it->second.sent).count(), 0));
+        Measurement &measurement = _faces[face->getFaceId()];
+        if (measurement.samples == 0) {
+            measurement.srtt = sample;
+            measurement.rttvar = sample / 2;
+        } else {
+            measurement.rttvar = 0.75 * measurement.rttvar + 0.25 * std::abs(measurement.srtt - sample);
+            measurement.srtt = 0.875 * measurement.srtt + 0.125 * sample;
+        }
+        ++measurement.samples;
+        measurement.timeouts = 0;
+        _pending.erase(it);
+        return;
+    }
+}
+
+const FaceMeasurements::Measurement* FaceMeasurements::find(size_t face_id) const {
+    auto it = _faces.find(face_id);
+    return it != _faces.end() ? &it->second : nullptr;
+}
+
+void FaceMeasurements::prune(const std::vector<std::shared_ptr<Face>> &faces) {
+    if (_faces.size() <= 2 * faces.size()) {
+        return;
+    }
+    std::unordered_set<size_t> face_ids;
+    for (const auto &face : faces) {
+        face_ids.emplace(face->getFaceId());
+    }
+    for (auto it = _faces.begin(); it != _faces.end();) {
+        if (face_ids.count(it->first) == 0) {
+            it = _faces.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t FaceMeasurements::getPending() const {
+    return _pending.size();
+}
+
+size_t FaceMeasurements::getMemoryUsage() const {
+    return memory_usage::of(_pending) + memory_usage::of(_sent) + memory_usage::of(_faces);
+}
+
+std::string FaceMeasurements::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"pending":)" << _pending.size() << R"(, "faces":[)";
+    bool first = true;
+    for (const auto &face : _faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << R"({"face_id":)" << face.first << R"(, "srtt_us":)" << static_cast<uint64_t>(face.second.srtt) << R"(, "rttvar_us":)"
+           << static_cast<uint64_t>(face.second.rttvar) << R"(, "samples":)" << face.second.samples << R"(, "timeouts":)" << face.second.timeouts << "}";
+    }
+    ss << "]}";
+    return ss.str();
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "network/face.h"
+#include "network/name_view.h"
+
+// round trip times of the egress faces of a strategy, from the Interests it sends and the Data coming back on the
+// same faces: an Interest is pending by name_hash and face until its Data or its timeout, which counts against the
+// face until it gives a Data again. the Data of a CanBePrefix Interest is matched on the prefixes of its Name
+class FaceMeasurements {
+public:
+    using Clock = ndn::time::steady_clock;
+
+    static const size_t MAX_PENDING = 65536;
+    // Interests timed out in a row before a face is taken as failing
+    static const size_t MAX_TIMEOUTS = 3;
+    static const ndn::time::milliseconds DEFAULT_TIMEOUT;
+
+    struct Measurement {
+        // in microseconds, smoothed as TCP does (RFC 6298)
+        double srtt = 0;
+        double rttvar = 0;
+        size_t samples = 0;
+        // since the last Data
+        size_t timeouts = 0;
+
+        bool isTimingOut() const {
+            return timeouts >= MAX_TIMEOUTS;
+        }
+    };
+
+private:
+    struct Pending {
+        size_t face_id;
+        Clock::time_point sent;
+    };
+
+    ndn::time::milliseconds _timeout;
+    // by name_hash mixed with the face ID, an Interest probed on two faces is pending on both
+    std::unordered_map<uint64_t, Pending> _pending;
+    // in the order sent, hence of deadline. an Interest answered or sent again leaves its former entry here, it no
+    // longer matches _pending when it expires
+    std::deque<std::pair<Clock::time_point, uint64_t>> _sent;
+    std::unordered_map<size_t, Measurement> _faces;
+
+    static uint64_t getKey(uint64_t name_hash, size_t face_id);
+
+    void removeExpired(const Clock::time_point &now);
+
+public:
+    explicit FaceMeasurements(const ndn::time::milliseconds &timeout = DEFAULT_TIMEOUT);
+
+    void onInterest(const NameView &name, const std::shared_ptr<Face> &face, const Clock::time_point &now = Clock::now());
+
+    void onData(const NameView &name, const std::shared_ptr<Face> &face, const Clock::time_point &now = Clock::now());
+
+    // null while the face was sent no Interest
+    const Measurement* find(size_t face_id) const;
+
+    // the faces no longer given are forgotten once they outnumber those left, as by HashingStrategy
+    void prune(const std::vector<std::shared_ptr<Face>> &faces);
+
+    // Interests pending, some already answered may still be in the order sent
+    size_t getPending() const;
+
+    size_t getMemoryUsage() const;
+
+    // {"pending", "faces": [{"face_id", "srtt_us", "rttvar_us", "samples", "timeouts"}]}
+    std::string toJSON() const;
+};
\ No newline at end of file
@@ -1,9 +1,61 @@
 #include "failover_strategy.h"
 
-FailoverStrategy::FailoverStrategy() : Strategy() {
+const ndn::time::milliseconds FailoverStrategy::DEFAULT_MAX_RTT {500};
+const ndn::time::milliseconds FailoverStrategy::DEFAULT_PROBE_INTERVAL {1000};
 
+FailoverStrategy::FailoverStrategy(const ndn::time::milliseconds &max_rtt, const ndn::time::milliseconds &probe_interval,
+                                   const ndn::time::milliseconds &timeout)
+        : Strategy()
+        , _max_rtt(max_rtt)
+        , _probe_interval(probe_interval)
+        , _measurements(timeout) {
+
+}
+
+bool FailoverStrategy::isUsable(const std::shared_ptr<Face> &face) const {
+    const FaceMeasurements::Measurement *measurement = _measurements.find(face->getFaceId());
+    if (!measurement) {
+        return true;
+    }
+    if (measurement->isTimingOut()) {
+        return false;
+    }
+    return _max_rtt.count() == 0 || measurement->samples == 0
+           || measurement->srtt <= static_cast<double>(ndn::time::duration_cast<ndn::time::microseconds>(_max_rtt).count());
+}
+
+std::vector<std::shared_ptr<Face>> FailoverStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) {
+    if (faces.empty()) {
+        return std::vector<std::shared_ptr<Face>>();
+    }
+    if (packet.getType() != NdnPacket::INTEREST) {
+        return {faces[0]};
+    }
+    _measurements.prune(faces);
+    // the first face when none is usable, its measurements are those to recover first
+    size_t selected = 0;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        if (isUsable(faces[i])) {
+            selected = i;
+            break;
+        }
+    }
+    std::vector<std::shared_ptr<Face>> selected_faces = {faces[selected]};
+    Clock::time_point now = Clock::now();
+    if (selected > 0 && now - _last_probe >= _probe_interval) {
+        selected_faces.emplace_back(faces[_probe_index++ % selected]);
+        _last_probe = now;
+    }
+    for (const auto &face : selected_faces) {
+        _measurements.onInterest(packet.getNameView(), face, now);
+    }
+    return selected_faces;
+}
+
+void FailoverStrategy::onData(const NdnPacket &packet, const std::shared_ptr<Face> &face) {
+    _measurements.onData(packet.getNameView(), face);
 }
 
-std::vector<std::shared_ptr<Face>> FailoverStrategy::selectFaces(const std::vector<std::shared_ptr<Face>> &faces) {
-    return !faces.empty() ? std::vector<std::shared_ptr<Face>>{faces[0]} : std::vector<std::shared_ptr<Face>>();
+const FaceMeasurements* FailoverStrategy::getMeasurements() const {
+    return &_measurements;
 }
\ No newline at end of file
@@ -1,14 +1,37 @@
 #pragma once
 
+#include "face_measurements.h"
 #include "strategy.h"
 
+// each Interest goes to the first face, in the order they were added, which neither times out nor answers slower than
+// max_rtt (0 for no limit). every probe_interval an Interest is also sent to one of the faces passed over before it,
+// so that traffic fails back once it answers in time again
 class FailoverStrategy : public Strategy {
+public:
+    using Clock = FaceMeasurements::Clock;
+
+    static const ndn::time::milliseconds DEFAULT_MAX_RTT;
+    static const ndn::time::milliseconds DEFAULT_PROBE_INTERVAL;
+
 private:
+    const ndn::time::milliseconds _max_rtt;
+    const ndn::time::milliseconds _probe_interval;
+    FaceMeasurements _measurements;
+    Clock::time_point _last_probe;
+    size_t _probe_index = 0;
+
+    bool isUsable(const std::shared_ptr<Face> &face) const;
 
 public:
-    FailoverStrategy();
+    explicit FailoverStrategy(const ndn::time::milliseconds &max_rtt = DEFAULT_MAX_RTT,
+                              const ndn::time::milliseconds &probe_interval = DEFAULT_PROBE_INTERVAL,
+                              const ndn::time::milliseconds &timeout = FaceMeasurements::DEFAULT_TIMEOUT);
 
     ~FailoverStrategy() override = default;
 
-    std::vector<std::shared_ptr<Face>> selectFaces(const std::vector<std::shared_ptr<Face>> &faces);
-};
+    std::vector<std::shared_ptr<Face>> selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) override;
+
+    void onData(const NdnPacket &packet, const std::shared_ptr<Face> &face) override;
+
+    const FaceMeasurements* getMeasurements() const override;
+};
\ No newline at end of file
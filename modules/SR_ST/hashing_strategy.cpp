@@ -0,0 +1,29 @@
+#include "hashing_strategy.h"
+
+#include <algorithm>
+
+#include "network/rendezvous_hash.h"
+
+HashingStrategy::HashingStrategy(size_t prefix_length) : Strategy(), _prefix_length(prefix_length) {
+
+}
+
+std::vector<std::shared_ptr<Face>> HashingStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) {
+    if (faces.empty()) {
+        return std::vector<std::shared_ptr<Face>>();
+    }
+    // the faces removed since are forgotten once they outnumber those left
+    if (_key_hashes.size() > 2 * faces.size()) {
+        _key_hashes.clear();
+    }
+    _selected_key_hashes.clear();
+    for (const auto &face : faces) {
+        auto it = _key_hashes.find(face->getFaceId());
+        if (it == _key_hashes.end()) {
+            it = _key_hashes.emplace(face->getFaceId(), rendezvous_hash::hashKey(face->getUnderlyingEndpoint())).first;
+        }
+        _selected_key_hashes.emplace_back(it->second);
+    }
+    const NameView &name = packet.getNameView();
+    return {faces[rendezvous_hash::select(name.getPrefixHash(std::min(name.size(), _prefix_length)), _selected_key_hashes)]};
+}
\ No newline at end of file
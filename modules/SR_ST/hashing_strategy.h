@@ -0,0 +1,23 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "strategy.h"
+
+// each packet goes to one face picked by rendezvous hashing of the first components of its Name on the endpoints of
+// the faces, e.g. to the clone of a content store which caches that prefix. the content store clones hash the same
+// way and agree on the owner of a Name as long as they know the same endpoints
+class HashingStrategy : public Strategy {
+private:
+    const size_t _prefix_length;
+    // rendezvous_hash key of each face by face ID, computed once
+    std::unordered_map<size_t, uint64_t> _key_hashes;
+    std::vector<uint64_t> _selected_key_hashes;
+
+public:
+    explicit HashingStrategy(size_t prefix_length);
+
+    ~HashingStrategy() override = default;
+
+    std::vector<std::shared_ptr<Face>> selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) override;
+};
\ No newline at end of file
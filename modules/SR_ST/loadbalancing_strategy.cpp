@@ -5,7 +5,7 @@ LoadbalancingStrategy::LoadbalancingStrategy() : Strategy() {
 
 }
 
-std::vector<std::shared_ptr<Face>> LoadbalancingStrategy::selectFaces(const std::vector<std::shared_ptr<Face>> &faces) {
+std::vector<std::shared_ptr<Face>> LoadbalancingStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) {
     if (faces.empty()) {
         return std::vector<std::shared_ptr<Face>>();
     } else {
@@ -11,5 +11,5 @@ public:
 
     ~LoadbalancingStrategy() = default;
 
-    std::vector<std::shared_ptr<Face>> selectFaces(const std::vector<std::shared_ptr<Face>> &faces) override;
+    std::vector<std::shared_ptr<Face>> selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) override;
 };
\ No newline at end of file
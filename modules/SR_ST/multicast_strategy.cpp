@@ -4,6 +4,6 @@ MulticastStrategy::MulticastStrategy() : Strategy() {
 
 }
 
-std::vector<std::shared_ptr<Face>> MulticastStrategy::selectFaces(const std::vector<std::shared_ptr<Face>> &faces) {
+std::vector<std::shared_ptr<Face>> MulticastStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) {
     return faces;
 }
\ No newline at end of file
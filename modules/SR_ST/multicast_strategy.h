@@ -10,5 +10,5 @@ public:
 
     ~MulticastStrategy() override = default;
 
-    std::vector<std::shared_ptr<Face>> selectFaces(const std::vector<std::shared_ptr<Face>> &faces) override;
+    std::vector<std::shared_ptr<Face>> selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) override;
 };
@@ -4,6 +4,9 @@
 #include <vector>
 
 #include "network/face.h"
+#include "network/ndn_packet.h"
+
+class FaceMeasurements;
 
 class Strategy {
 private:
@@ -15,5 +18,16 @@ public:
 
     virtual ~Strategy() = default;
 
-    virtual std::vector<std::shared_ptr<Face>> selectFaces(const std::vector<std::shared_ptr<Face>> &faces) = 0;
+    // the packet is only read by the strategies which route by Name, they use its NameView and never decode it
+    virtual std::vector<std::shared_ptr<Face>> selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) = 0;
+
+    // a Data from one of the egress faces, for the strategies which measure them
+    virtual void onData(const NdnPacket &packet, const std::shared_ptr<Face> &face) {
+
+    }
+
+    // null for the strategies which don't measure their faces
+    virtual const FaceMeasurements* getMeasurements() const {
+        return nullptr;
+    }
 };
\ No newline at end of file
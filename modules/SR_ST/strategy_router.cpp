@@ -8,71 +8,183 @@
 #include "network/tcp_face.h"
 #include "network/udp_master_face.h"
 #include "network/udp_face.h"
+#include "network/shm_master_face.h"
+#include "network/shm_face.h"
+#include "network/lp_link.h"
 #include "multicast_strategy.h"
 #include "failover_strategy.h"
 #include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+#include "metrics/stage_profile.h"
 #include "loadbalancing_strategy.h"
+#include "hashing_strategy.h"
+#include "adaptive_strategy.h"
+#include "face_measurements.h"
 
 StrategyRouter::StrategyRouter(const std::string &name, uint16_t local_port, uint16_t local_command_port)
         : Module(1)
         , _name(name)
-        , _command_socket(_ios, {{}, local_command_port}){
-    _tcp_ingress_master_face = std::make_shared<TcpMasterFace>(_ios, 16, local_port);
-    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, 16, local_port);
+        , _probe_interval(AdaptiveStrategy::DEFAULT_PROBE_INTERVAL)
+        , _measurement_timeout(FaceMeasurements::DEFAULT_TIMEOUT)
+        , _failover_max_rtt(FailoverStrategy::DEFAULT_MAX_RTT)
+        , _loop_monitor(_ios)
+        , _command_socket(_control_ios, {{}, local_command_port})
+        , _connection_pool(_ios){
+    _tcp_ingress_master_face = std::make_shared<TcpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _shm_ingress_master_face = std::make_shared<ShmMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _metrics.addCollector(boost::bind(&StrategyRouter::writeMetrics, this, _1));
 }
 
 void StrategyRouter::run() {
     _strategy = std::unique_ptr<Strategy>(new MulticastStrategy());
     _strategy_name = "multicast";
+    // before the ingress accepts any face, the commands are then read as usual
+    _startup_config.apply(_ios, _remote_command_endpoint, [this](const rapidjson::Document &command) {
+        executeCommand(command);
+    });
     commandRead();
+    _loop_monitor.start();
     _tcp_ingress_master_face->listen(boost::bind(&StrategyRouter::onMasterFaceNotification, this, _1, _2),
-                                     boost::bind(&StrategyRouter::onIngressInterest, this, _1, _2),
-                                     boost::bind(&StrategyRouter::onIngressData, this, _1, _2),
+                                     PacketHandler::bind<StrategyRouter, &StrategyRouter::onIngressPacket>(this),
                                      boost::bind(&StrategyRouter::onMasterFaceError, this, _1, _2));
     _udp_ingress_master_face->listen(boost::bind(&StrategyRouter::onMasterFaceNotification, this, _1, _2),
-                                     boost::bind(&StrategyRouter::onIngressInterest, this, _1, _2),
-                                     boost::bind(&StrategyRouter::onIngressData, this, _1, _2),
+                                     PacketHandler::bind<StrategyRouter, &StrategyRouter::onIngressPacket>(this),
                                      boost::bind(&StrategyRouter::onMasterFaceError, this, _1, _2));
+    _shm_ingress_master_face->listen(boost::bind(&StrategyRouter::onMasterFaceNotification, this, _1, _2),
+                                     PacketHandler::bind<StrategyRouter, &StrategyRouter::onIngressPacket>(this),
+                                     boost::bind(&StrategyRouter::onMasterFaceError, this, _1, _2));
+}
+
+bool StrategyRouter::loadStartupConfig(const std::string &source) {
+    return _startup_config.load(source);
+}
+
+void StrategyRouter::beginDrain() {
+    _tcp_ingress_master_face->stopAccepting();
+    _udp_ingress_master_face->stopAccepting();
+    _shm_ingress_master_face->stopAccepting();
 }
 
-void StrategyRouter::onIngressInterest(const std::shared_ptr<Face> &ingress_face, const ndn::Interest &interest) {
-    for (const auto& egress_face : _strategy->selectFaces(_egress_faces)) {
-        egress_face->send(interest);
+bool StrategyRouter::isDrained() {
+    size_t queued = _tcp_ingress_master_face->getQueuedPackets() + _udp_ingress_master_face->getQueuedPackets()
+                    + _shm_ingress_master_face->getQueuedPackets();
+    for (const auto &face : _egress_faces) {
+        queued += face->getQueueStats().packets;
     }
+    return queued == 0;
 }
 
-void StrategyRouter::onIngressData(const std::shared_ptr<Face> &ingress_face, const ndn::Data &data) {
-    for (const auto& egress_face : _strategy->selectFaces(_egress_faces)) {
-        egress_face->send(data);
+std::unique_ptr<Strategy> StrategyRouter::createStrategy(const std::string &name) const {
+    enum strategy_type {
+        MULTICAST,
+        LOADBALANCING,
+        FAILOVER,
+        HASHING,
+        ADAPTIVE,
+        WEIGHTED
+    };
+
+    static const std::unordered_map<std::string, strategy_type> STRATEGIES = {
+            {"multicast", MULTICAST},
+            {"loadbalancing", LOADBALANCING},
+            {"failover", FAILOVER},
+            {"hashing", HASHING},
+            {"adaptive", ADAPTIVE},
+            {"weighted", WEIGHTED}
+    };
+
+    auto it = STRATEGIES.find(name);
+    if (it == STRATEGIES.end()) {
+        return nullptr;
+    }
+    switch (it->second) {
+        case MULTICAST:
+            return std::unique_ptr<Strategy>(new MulticastStrategy());
+        case LOADBALANCING:
+            return std::unique_ptr<Strategy>(new LoadbalancingStrategy());
+        case FAILOVER:
+            return std::unique_ptr<Strategy>(new FailoverStrategy(_failover_max_rtt, _probe_interval, _measurement_timeout));
+        case HASHING:
+            return std::unique_ptr<Strategy>(new HashingStrategy(_hash_prefix_length));
+        case ADAPTIVE:
+            return std::unique_ptr<Strategy>(new AdaptiveStrategy(_probe_interval, _measurement_timeout));
+        case WEIGHTED:
+            return std::unique_ptr<Strategy>(new WeightedStrategy(_weights, _auto_weights, _probe_interval, _measurement_timeout));
     }
+    return nullptr;
 }
 
-void StrategyRouter::onEgressInterest(const std::shared_ptr<Face> &egress_face, const ndn::Interest &interest) {
-    _tcp_ingress_master_face->sendToAllFaces(interest);
-    _udp_ingress_master_face->sendToAllFaces(interest);
+void StrategyRouter::resetStrategies() {
+    _strategy = createStrategy(_strategy_name);
+    _strategy_choices.forEachAfter(nullptr, [this](const ndn::Name &prefix, const std::shared_ptr<StrategyChoice> &choice) {
+        choice->strategy = createStrategy(choice->name);
+        return true;
+    });
 }
 
-void StrategyRouter::onEgressData(const std::shared_ptr<Face> &egress_face, const ndn::Data &data) {
-    _tcp_ingress_master_face->sendToAllFaces(data);
-    _udp_ingress_master_face->sendToAllFaces(data);
+Strategy& StrategyRouter::getStrategy(const NdnPacket &packet) {
+    if (_strategy_choices.size() > 0) {
+        std::shared_ptr<StrategyChoice> choice = _strategy_choices.findLastValueUntil(packet.getNameView());
+        if (choice) {
+            return *choice->strategy;
+        }
+    }
+    return *_strategy;
+}
+
+void StrategyRouter::onIngressPacket(const std::shared_ptr<Face> &ingress_face, const NdnPacket &packet) {
+    if (packet.getType() == NdnPacket::INTEREST && _loop_monitor.isOverloaded()) {
+        ++_shed_interests;
+        stage_profile::Scope stage(stage_profile::ENCODE);
+        const ndn::Block &block = packet.getBlock();
+        ingress_face->send(LpLink::nack(block.wire(), block.size(), LpLink::CONGESTION));
+        return;
+    }
+    if (_data_unicast && packet.getType() == NdnPacket::INTEREST) {
+        _return_table.insert(packet.getNameView(), ingress_face);
+    }
+    Strategy &strategy = getStrategy(packet);
+    if (!_congestion_control.isEnabled() || packet.getType() != NdnPacket::INTEREST) {
+        for (const auto& egress_face : strategy.selectFaces(packet, _egress_faces)) {
+            egress_face->send(packet);
+        }
+        return;
+    }
+    for (const auto& egress_face : strategy.selectFaces(packet, _congestion_control.getFaces(_egress_faces))) {
+        _congestion_control.send(egress_face, packet);
+    }
+}
+
+void StrategyRouter::onEgressPacket(const std::shared_ptr<Face> &egress_face, const NdnPacket &packet) {
+    if (packet.getType() == NdnPacket::DATA) {
+        getStrategy(packet).onData(packet, egress_face);
+        FaceTable::Faces faces;
+        if (_data_unicast && _return_table.lookup(packet.getNameView(), faces)) {
+            for (const auto &face : faces) {
+                face->send(packet);
+            }
+            return;
+        }
+    }
+    _tcp_ingress_master_face->sendToAllFaces(packet);
+    _udp_ingress_master_face->sendToAllFaces(packet);
+    _shm_ingress_master_face->sendToAllFaces(packet);
 }
 
 void StrategyRouter::onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "new face with ID = " << face->getFaceId() << " form master face with ID = " << master_face->getMasterFaceId();
-    logger::log(logger::INFO, ss.str());
+    logger::log(logger::INFO, "new face with ID = {} form master face with ID = {}",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void StrategyRouter::onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "face with ID = " << face->getFaceId() << " from master face with ID = " << master_face->getMasterFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    logger::log(logger::ERROR, "face with ID = {} from master face with ID = {} can't process normally",
+                {face->getFaceId(), master_face->getMasterFaceId()});
 }
 
 void StrategyRouter::onFaceError(const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "face with ID = " << face->getFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    logger::log(logger::ERROR, "face with ID = {} can't process normally", {face->getFaceId()});
     for (auto& egress_face : _egress_faces) {
         if(egress_face == face) {
             std::swap(egress_face, _egress_faces.back());
@@ -88,43 +200,18 @@ void StrategyRouter::commandRead() {
 }
 
 void StrategyRouter::commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred) {
-    enum action_type {
-        EDIT_CONFIG,
-        ADD_FACE,
-        DEL_FACE,
-        LIST
-    };
-
-    static const std::unordered_map<std::string, action_type> ACTIONS = {
-            {"edit_config", EDIT_CONFIG},
-            {"add_face", ADD_FACE},
-            {"del_face", DEL_FACE},
-            {"list", LIST}
-    };
-
     if(!err) {
         try {
             rapidjson::Document document;
             document.Parse(_command_buffer, bytes_transferred);
             if(!document.HasParseError()){
                 if(document.HasMember("action") && document["action"].IsString() && document.HasMember("id") && document["id"].IsUint()){
-                    auto it = ACTIONS.find(document["action"].GetString());
-                    if(it != ACTIONS.end()) {
-                        switch (it->second) {
-                            case EDIT_CONFIG:
-                                commandEditConfig(document);
-                                break;
-                            case ADD_FACE:
-                                commandAddFace(document);
-                                break;
-                            case DEL_FACE:
-                                commandDelFace(document);
-                                break;
-                            case LIST:
-                                commandList(document);
-                                break;
-                        }
-                    }
+                    // applied on the module thread, the next command is read once it is done
+                    auto command = std::make_shared<rapidjson::Document>(std::move(document));
+                    applyCommand([this, command]() {
+                        executeCommand(*command);
+                    }, boost::bind(&StrategyRouter::commandRead, this));
+                    return;
                 } else{
                     std::string response = R"({"status":"fail", "reason":"action not provided or not implemented"})";
                     _command_socket.send_to(boost::asio::buffer(response), _remote_command_endpoint);
@@ -143,39 +230,223 @@ void StrategyRouter::commandReadHandler(const boost::system::error_code &err, si
     }
 }
 
+void StrategyRouter::executeCommand(const rapidjson::Document &document) {
+    enum action_type {
+        EDIT_CONFIG,
+        ADD_FACE,
+        DEL_FACE,
+        LIST,
+        SET_STRATEGY,
+        UNSET_STRATEGY,
+        MEMORY_STATS
+    };
+
+    static const std::unordered_map<std::string, action_type> ACTIONS = {
+            {"edit_config", EDIT_CONFIG},
+            {"add_face", ADD_FACE},
+            {"del_face", DEL_FACE},
+            {"list", LIST},
+            {"set_strategy", SET_STRATEGY},
+            {"unset_strategy", UNSET_STRATEGY},
+            {"memory_stats", MEMORY_STATS}
+    };
+
+    auto it = ACTIONS.find(document["action"].GetString());
+    if (it == ACTIONS.end()) {
+        return;
+    }
+    switch (it->second) {
+        case EDIT_CONFIG:
+            commandEditConfig(document);
+            break;
+        case ADD_FACE:
+            commandAddFace(document);
+            break;
+        case DEL_FACE:
+            commandDelFace(document);
+            break;
+        case LIST:
+            commandList(document);
+            break;
+        case SET_STRATEGY:
+            commandSetStrategy(document);
+            break;
+        case UNSET_STRATEGY:
+            commandUnsetStrategy(document);
+            break;
+        case MEMORY_STATS:
+            commandMemoryStats(document);
+            break;
+    }
+}
+
 void StrategyRouter::commandEditConfig(const rapidjson::Document &document) {
     std::vector<std::string> changes;
+    // the settings of the strategies, which are created again once all are read
+    bool strategy_change = false;
+    if (document.HasMember("hash_prefix_length") && document["hash_prefix_length"].IsUint()) {
+        bool has_change = false;
+        size_t prefix_length = document["hash_prefix_length"].GetUint();
+        if (prefix_length != _hash_prefix_length) {
+            _hash_prefix_length = prefix_length;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("hash_prefix_length");
+            strategy_change = true;
+        }
+    }
+    if (document.HasMember("probe_interval") && document["probe_interval"].IsUint()) {
+        bool has_change = false;
+        ndn::time::milliseconds probe_interval(document["probe_interval"].GetUint());
+        if (probe_interval != _probe_interval) {
+            _probe_interval = probe_interval;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("probe_interval");
+            strategy_change = true;
+        }
+    }
+    if (document.HasMember("measurement_timeout") && document["measurement_timeout"].IsUint() && document["measurement_timeout"].GetUint() > 0) {
+        bool has_change = false;
+        ndn::time::milliseconds timeout(document["measurement_timeout"].GetUint());
+        if (timeout != _measurement_timeout) {
+            _measurement_timeout = timeout;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("measurement_timeout");
+            strategy_change = true;
+        }
+    }
+    if (document.HasMember("failover_max_rtt") && document["failover_max_rtt"].IsUint()) {
+        bool has_change = false;
+        ndn::time::milliseconds max_rtt(document["failover_max_rtt"].GetUint());
+        if (max_rtt != _failover_max_rtt) {
+            _failover_max_rtt = max_rtt;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("failover_max_rtt");
+            strategy_change = true;
+        }
+    }
+    if (document.HasMember("weights") && document["weights"].IsArray()) {
+        bool has_change = false;
+        WeightedStrategy::Weights weights;
+        for (const auto &weight : document["weights"].GetArray()) {
+            if (weight.IsObject() && weight.HasMember("face_id") && weight["face_id"].IsUint() && weight.HasMember("weight") && weight["weight"].IsUint()) {
+                weights[weight["face_id"].GetUint()] = weight["weight"].GetUint();
+            }
+        }
+        if (weights != _weights) {
+            _weights = weights;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("weights");
+            strategy_change = true;
+        }
+    }
+    if (document.HasMember("auto_weights") && document["auto_weights"].IsBool()) {
+        bool has_change = false;
+        bool auto_weights = document["auto_weights"].GetBool();
+        if (auto_weights != _auto_weights) {
+            _auto_weights = auto_weights;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("auto_weights");
+            strategy_change = true;
+        }
+    }
+    if (strategy_change) {
+        resetStrategies();
+    }
+    if (document.HasMember("overload_lag") && document["overload_lag"].IsUint()) {
+        bool has_change = false;
+        size_t threshold = document["overload_lag"].GetUint();
+        if (threshold != _loop_monitor.getThreshold()) {
+            _loop_monitor.setThreshold(threshold);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("overload_lag");
+        }
+    }
+    if (document.HasMember("data_unicast") && document["data_unicast"].IsBool()) {
+        bool has_change = false;
+        bool data_unicast = document["data_unicast"].GetBool();
+        if (data_unicast != _data_unicast) {
+            _data_unicast = data_unicast;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("data_unicast");
+        }
+    }
+    if (document.HasMember("return_ttl") && document["return_ttl"].IsUint() && document["return_ttl"].GetUint() > 0) {
+        bool has_change = false;
+        ndn::time::milliseconds ttl(document["return_ttl"].GetUint());
+        if (ttl != _return_table.getTtl()) {
+            _return_table.setTtl(ttl);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("return_ttl");
+        }
+    }
+    if (document.HasMember("congestion_action") && document["congestion_action"].IsString()) {
+        bool has_change = false;
+        std::string action = document["congestion_action"].GetString();
+        if (action != _congestion_control.getAction()) {
+            has_change = _congestion_control.setAction(action);
+        }
+        if (has_change) {
+            changes.emplace_back("congestion_action");
+        }
+    }
+    if (document.HasMember("congestion_queue_threshold") && document["congestion_queue_threshold"].IsUint()) {
+        bool has_change = false;
+        size_t threshold = document["congestion_queue_threshold"].GetUint();
+        if (threshold != _congestion_control.getQueueThreshold()) {
+            _congestion_control.setQueueThreshold(threshold);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("congestion_queue_threshold");
+        }
+    }
+    if (document.HasMember("face_rate") && document["face_rate"].IsUint()) {
+        bool has_change = false;
+        double rate = document["face_rate"].GetUint();
+        if (rate != _congestion_control.getRate()) {
+            _congestion_control.setRate(rate, _congestion_control.getBurst());
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("face_rate");
+        }
+    }
+    if (document.HasMember("face_burst") && document["face_burst"].IsUint()) {
+        bool has_change = false;
+        double burst = document["face_burst"].GetUint();
+        if (burst != _congestion_control.getBurst()) {
+            _congestion_control.setRate(_congestion_control.getRate(), burst);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("face_burst");
+        }
+    }
     if (document.HasMember("strategy") && document["strategy"].IsString()) {
-        enum strategy_type {
-            MULTICAST,
-            LOADBALANCING,
-            FAILOVER
-        };
-
-        static const std::unordered_map<std::string, strategy_type> STRATEGIES = {
-                {"multicast", MULTICAST},
-                {"loadbalancing", LOADBALANCING},
-                {"failover", FAILOVER}
-        };
-
         bool has_change = false;
         if (document["strategy"].GetString() != _strategy_name) {
-            auto it = STRATEGIES.find(document["strategy"].GetString());
-            if (it != STRATEGIES.end()) {
-                switch (it->second) {
-                    case MULTICAST:
-                        _strategy = std::unique_ptr<Strategy>(new MulticastStrategy());
-                        _strategy_name = "multicast";
-                        break;
-                    case LOADBALANCING:
-                        _strategy = std::unique_ptr<Strategy>(new LoadbalancingStrategy());
-                        _strategy_name = "loadbalancing";
-                        break;
-                    case FAILOVER:
-                        _strategy = std::unique_ptr<Strategy>(new FailoverStrategy());
-                        _strategy_name = "failover";
-                        break;
-                }
+            std::unique_ptr<Strategy> strategy = createStrategy(document["strategy"].GetString());
+            if (strategy) {
+                _strategy = std::move(strategy);
+                _strategy_name = document["strategy"].GetString();
                 has_change = true;
             }
             if (has_change) {
@@ -183,6 +454,198 @@ void StrategyRouter::commandEditConfig(const rapidjson::Document &document) {
             }
         }
     }
+    if (document.HasMember("tcp_gather_bytes") && document["tcp_gather_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["tcp_gather_bytes"].GetUint();
+        if (max_bytes != TcpFace::getGatherMaxBytes()) {
+            TcpFace::setGatherMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_bytes");
+        }
+    }
+    if (document.HasMember("tcp_gather_packets") && document["tcp_gather_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["tcp_gather_packets"].GetUint();
+        if (max_packets != TcpFace::getGatherMaxPackets()) {
+            TcpFace::setGatherMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_packets");
+        }
+    }
+    if (document.HasMember("tcp_max_packet_size") && document["tcp_max_packet_size"].IsUint()) {
+        bool has_change = false;
+        size_t size = document["tcp_max_packet_size"].GetUint();
+        if (size != TcpFace::getMaxPacketSize()) {
+            has_change = TcpFace::setMaxPacketSize(size);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_max_packet_size");
+        }
+    }
+    if (document.HasMember("tcp_flush") && document["tcp_flush"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_flush"].GetString();
+        if (policy != TcpFace::getFlushPolicy()) {
+            has_change = TcpFace::setFlushPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_flush");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_min_delay") && document["tcp_reconnect_min_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_min_delay"].GetUint();
+        if (value != TcpFace::getReconnectMinDelay()) {
+            TcpFace::setReconnectMinDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_min_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_max_delay") && document["tcp_reconnect_max_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_max_delay"].GetUint();
+        if (value != TcpFace::getReconnectMaxDelay()) {
+            TcpFace::setReconnectMaxDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_max_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_attempts") && document["tcp_reconnect_attempts"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_attempts"].GetUint();
+        if (value != TcpFace::getReconnectAttempts()) {
+            TcpFace::setReconnectAttempts(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_attempts");
+        }
+    }
+    if (document.HasMember("tcp_replay_max_age") && document["tcp_replay_max_age"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_replay_max_age"].GetUint();
+        if (value != TcpFace::getReplayMaxAge()) {
+            TcpFace::setReplayMaxAge(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_replay_max_age");
+        }
+    }
+    if (document.HasMember("tcp_credit_window") && document["tcp_credit_window"].IsUint()) {
+        bool has_change = false;
+        size_t window = document["tcp_credit_window"].GetUint();
+        if (window != TcpFace::getCreditWindow()) {
+            TcpFace::setCreditWindow(window);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_window");
+        }
+    }
+    if (document.HasMember("tcp_credit_policy") && document["tcp_credit_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_credit_policy"].GetString();
+        if (policy != TcpFace::getCreditPolicy()) {
+            has_change = TcpFace::setCreditPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_policy");
+        }
+    }
+    if (document.HasMember("udp_mtu") && document["udp_mtu"].IsUint()) {
+        bool has_change = false;
+        size_t mtu = document["udp_mtu"].GetUint();
+        if (mtu != LpLink::getMtu()) {
+            LpLink::setMtu(mtu);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_mtu");
+        }
+    }
+    if (document.HasMember("udp_aggregation") && document["udp_aggregation"].IsBool()) {
+        bool has_change = false;
+        bool aggregation = document["udp_aggregation"].GetBool();
+        if (aggregation != LpLink::getAggregation()) {
+            LpLink::setAggregation(aggregation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_aggregation");
+        }
+    }
+    if (document.HasMember("connection_pool") && _connection_pool.update(document["connection_pool"])) {
+        changes.emplace_back("connection_pool");
+    }
+    if (document.HasMember("socket_options")) {
+        bool has_change = false;
+        // the default of the faces created from now on, the ingress master faces change theirs at once
+        SocketOptions options = SocketOptions::getDefault();
+        if (options.update(document["socket_options"]) && options != SocketOptions::getDefault()) {
+            SocketOptions::setDefault(options);
+            for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face}) {
+                master_face->setSocketOptions(options);
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("socket_options");
+        }
+    }
+    if (document.HasMember("queue_max_packets") && document["queue_max_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["queue_max_packets"].GetUint();
+        if (max_packets != QueuePolicy::getMaxPackets()) {
+            QueuePolicy::setMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_packets");
+        }
+    }
+    if (document.HasMember("queue_max_bytes") && document["queue_max_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["queue_max_bytes"].GetUint();
+        if (max_bytes != QueuePolicy::getMaxBytes()) {
+            QueuePolicy::setMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_bytes");
+        }
+    }
+    if (document.HasMember("queue_drop_policy") && document["queue_drop_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["queue_drop_policy"].GetString();
+        if (policy != QueuePolicy::getDropPolicyName()) {
+            has_change = QueuePolicy::setDropPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_drop_policy");
+        }
+    }
+    if (document.HasMember("queue_scheduler") && document["queue_scheduler"].IsString()) {
+        bool has_change = false;
+        std::string scheduler = document["queue_scheduler"].GetString();
+        if (scheduler != QueuePolicy::getSchedulerName()) {
+            has_change = QueuePolicy::setScheduler(scheduler);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_scheduler");
+        }
+    }
+    if (document.HasMember("queue_classes") && QueuePolicy::setClasses(document["queue_classes"])) {
+        changes.emplace_back("queue_classes");
+    }
 
     std::stringstream ss;
     ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"edit_config", "changes":[)";
@@ -196,18 +659,20 @@ void StrategyRouter::commandEditConfig(const rapidjson::Document &document) {
         ss << '"' << change << '"';
     }
     ss << "]}";
-    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
 }
 
 void StrategyRouter::commandAddFace(const rapidjson::Document &document) {
     enum layer_type {
         TCP,
         UDP,
+        SHM,
     };
 
     static const std::unordered_map<std::string, layer_type> LAYERS = {
             {"tcp", TCP},
             {"udp", UDP},
+            {"shm", SHM},
     };
 
     if (document.HasMember("layer") && document.HasMember("address") && document.HasMember("port")
@@ -217,19 +682,28 @@ void StrategyRouter::commandAddFace(const rapidjson::Document &document) {
             std::shared_ptr<Face> face;
             switch (it->second) {
                 case TCP:
-                    face = std::make_shared<TcpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    face = _connection_pool.makeFace(_ios, document["address"].GetString(), document["port"].GetUint());
                     break;
                 case UDP:
                     face = std::make_shared<UdpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
                     break;
+                case SHM:
+                    face = std::make_shared<ShmFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    break;
+            }
+            if (document.HasMember("socket_options")) {
+                // on top of the default, before open for the buffers of a TCP connection
+                SocketOptions options = SocketOptions::getDefault();
+                if (options.update(document["socket_options"])) {
+                    face->setSocketOptions(options);
+                }
             }
             _egress_faces.push_back(face);
-            face->open(boost::bind(&StrategyRouter::onEgressInterest, this, _1, _2),
-                       boost::bind(&StrategyRouter::onEgressData, this, _1, _2),
+            face->open(PacketHandler::bind<StrategyRouter, &StrategyRouter::onEgressPacket>(this),
                        boost::bind(&StrategyRouter::onFaceError, this, _1));
             std::stringstream ss;
             ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_face", "face_id":)" << face->getFaceId() << "}";
-            _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+            sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
         }
     }
 }
@@ -249,12 +723,133 @@ void StrategyRouter::commandDelFace(const rapidjson::Document &document) {
         }
         std::stringstream ss;
         ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_face", "face_id":)" << face_id << R"(, "status":)" << ok << "}";
-        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
     }
 }
 
 void StrategyRouter::commandList(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list", "strategy":")" << _strategy_name << '"'
+       << R"(, "hash_prefix_length":)" << _hash_prefix_length << R"(, "probe_interval":)" << _probe_interval.count()
+       << R"(, "measurement_timeout":)" << _measurement_timeout.count() << R"(, "failover_max_rtt":)" << _failover_max_rtt.count()
+       << R"(, "data_unicast":)" << (_data_unicast ? "true" : "false") << R"(, "return_table":)" << _return_table.toJSON()
+       << R"(, "congestion":)" << _congestion_control.toJSON() << R"(, "shed_interests":)" << _shed_interests
+       << R"(, "loop":)" << _loop_monitor.toJSON();
+    ss << R"(, "auto_weights":)" << (_auto_weights ? "true" : "false") << R"(, "weights":[)";
+    bool first = true;
+    for (const auto &weight : _weights) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << R"({"face_id":)" << weight.first << R"(, "weight":)" << weight.second << "}";
+    }
+    ss << "]";
+    const FaceMeasurements *measurements = _strategy->getMeasurements();
+    ss << R"(, "measurements":)" << (measurements ? measurements->toJSON() : "null");
+    ss << R"(, "strategy_choices":[)";
+    first = true;
+    _strategy_choices.forEachAfter(nullptr, [&ss, &first](const ndn::Name &prefix, const std::shared_ptr<StrategyChoice> &choice) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        const FaceMeasurements *measurements = choice->strategy->getMeasurements();
+        ss << R"({"prefix":")" << prefix.toUri() << R"(", "strategy":")" << choice->name << R"(", "measurements":)"
+           << (measurements ? measurements->toJSON() : "null") << "}";
+        return true;
+    });
+    ss << "]";
+    ss << R"(, "faces":[)";
+    first = true;
+    for (const auto &face : _egress_faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face->toJSON();
+    }
+    ss << R"(], "master_faces":[)" << _tcp_ingress_master_face->toJSON() << ", " << _udp_ingress_master_face->toJSON() << ", " << _shm_ingress_master_face->toJSON() << "]"
+       << R"(, "connection_pool":)" << _connection_pool.toJSON() << R"(, "buffer_pool":)" << BufferPool::getStats().toJSON() << R"(, "stages":)" << stage_profile::toJSON() << "}";
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+}
+
+
+void StrategyRouter::commandSetStrategy(const rapidjson::Document &document) {
+    if (document.HasMember("prefix") && document["prefix"].IsString() && document.HasMember("strategy") && document["strategy"].IsString()) {
+        ndn::Name prefix(document["prefix"].GetString());
+        auto choice = std::make_shared<StrategyChoice>();
+        choice->name = document["strategy"].GetString();
+        choice->strategy = createStrategy(choice->name);
+        bool ok = choice->strategy != nullptr;
+        if (ok) {
+            _strategy_choices.insert(prefix, choice, true);
+        }
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"set_strategy", "prefix":")" << prefix.toUri()
+           << R"(", "status":)" << ok << "}";
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+    }
+}
+
+void StrategyRouter::commandUnsetStrategy(const rapidjson::Document &document) {
+    if (document.HasMember("prefix") && document["prefix"].IsString()) {
+        ndn::Name prefix(document["prefix"].GetString());
+        bool ok = _strategy_choices.find(prefix) != nullptr;
+        _strategy_choices.remove(prefix);
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"unset_strategy", "prefix":")" << prefix.toUri()
+           << R"(", "status":)" << ok << "}";
+        sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
+    }
+}
+
+void StrategyRouter::commandMemoryStats(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    MemoryStats stats;
+    // the strategies themselves are a few words but for their measurements
+    auto add_measurements = [&stats](const Strategy &strategy) {
+        if (const FaceMeasurements *measurements = strategy.getMeasurements()) {
+            stats.add("strategy_measurements", measurements->getPending(), measurements->getMemoryUsage());
+        }
+    };
+    add_measurements(*_strategy);
+    _strategy_choices.addMemoryStats(stats, "strategy_choices");
+    size_t choice_bytes = 0;
+    _strategy_choices.forEachValue([&](const StrategyChoice &choice) {
+        choice_bytes += memory_usage::ofShared<StrategyChoice>() + memory_usage::of(choice.name);
+        add_measurements(*choice.strategy);
+    });
+    stats.add("strategy_choice_values", _strategy_choices.size(), choice_bytes);
+    stats.add("weights", _weights.size(), memory_usage::of(_weights));
+    stats.add("congestion_control", 1, _congestion_control.getMemoryUsage());
+    stats.add("return_table", _return_table.size(), _return_table.getMemoryUsage());
+    for (const auto &face : _egress_faces) {
+        face->addMemoryStats(stats);
+    }
+    _tcp_ingress_master_face->addMemoryStats(stats);
+    _udp_ingress_master_face->addMemoryStats(stats);
+    _shm_ingress_master_face->addMemoryStats(stats);
     std::stringstream ss;
-    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"list", "strategy":")" << _strategy_name << "\"}";
-    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"memory_stats", "memory":)"
+       << stats.toJSON() << "}";
+    sendOnControl(_command_socket, ss.str(), _remote_command_endpoint);
 }
+
+void StrategyRouter::writeMetrics(MetricsWriter &writer) {
+    for (const auto &face : _egress_faces) {
+        face->writeMetrics(writer);
+    }
+    _tcp_ingress_master_face->writeMetrics(writer);
+    _udp_ingress_master_face->writeMetrics(writer);
+    _shm_ingress_master_face->writeMetrics(writer);
+    BufferPool::getStats().writeMetrics(writer);
+    stage_profile::writeMetrics(writer);
+    _return_table.writeMetrics(writer);
+    writer.counter("ndn_shed_interests_total", "Interests Nacked with Congestion while overloaded", {}, _shed_interests);
+    _loop_monitor.writeMetrics(writer, {});
+}
\ No newline at end of file
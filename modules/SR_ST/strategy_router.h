@@ -11,25 +11,82 @@
 
 #include "rapidjson/document.h"
 
-#include "module.h"
+#include "runtime/module.h"
+#include "management/startup_config.h"
 #include "network/face.h"
+#include "network/loop_monitor.h"
 #include "network/master_face.h"
+#include "network/return_table.h"
+#include "network/tcp_connection_pool.h"
+#include "tree/name_hash_index.h"
+#include "congestion_control.h"
 #include "strategy.h"
+#include "weighted_strategy.h"
 
+// threads: everything below belongs to the module thread, SR_MT is the strategy router spread over several
 class StrategyRouter : public Module {
 private:
+    // the strategy of the packets under a prefix in place of the one of the router, each has its own state
+    struct StrategyChoice {
+        std::string name;
+        std::unique_ptr<Strategy> strategy;
+
+        std::string toJSON() const {
+            return R"({"strategy":")" + name + R"("})";
+        }
+    };
+
     const std::string _name;
 
     std::string _strategy_name;
     std::unique_ptr<Strategy> _strategy;
+    // by longest prefix of the packet Name, looked up on its NameView
+    NameHashIndex<StrategyChoice> _strategy_choices;
+    // components of the Name hashed by the hashing strategy, the content store clones behind must use the same
+    size_t _hash_prefix_length = 2;
+    // of the adaptive, failover and weighted strategies, which measure the RTT of their faces
+    ndn::time::milliseconds _probe_interval;
+    ndn::time::milliseconds _measurement_timeout;
+    ndn::time::milliseconds _failover_max_rtt;
+    // of the weighted strategy by face ID, scaled by the measurements every probe_interval with auto_weights
+    WeightedStrategy::Weights _weights;
+    bool _auto_weights = false;
+
+    // of the Interests to the egress faces
+    CongestionControl _congestion_control;
+    // past the overload_lag of the module thread, off by default, the Interests from the ingress are Nacked with
+    // Congestion instead of forwarded, the Data still go back
+    LoopMonitor _loop_monitor;
+    size_t _shed_interests = 0;
 
     char _command_buffer[65536];
     boost::asio::ip::udp::socket _command_socket;
     boost::asio::ip::udp::endpoint _remote_command_endpoint;
+    StartupConfig _startup_config;
+    // connections kept open to the endpoints set by edit_config, add_face takes them
+    TcpConnectionPool _connection_pool;
 
     std::vector<std::shared_ptr<Face>> _egress_faces;
+    // by the Interests from the ingress faces, the Data go back to the faces which asked when data_unicast is on
+    bool _data_unicast = false;
+    ReturnTable _return_table;
     std::shared_ptr<MasterFace> _tcp_ingress_master_face;
     std::shared_ptr<MasterFace> _udp_ingress_master_face;
+    std::shared_ptr<MasterFace> _shm_ingress_master_face;
+
+    // null if the name is unknown
+    std::unique_ptr<Strategy> createStrategy(const std::string &name) const;
+
+    // the strategies start over with the current settings, e.g. their measurements
+    void resetStrategies();
+
+    Strategy& getStrategy(const NdnPacket &packet);
+
+    // the ingress master faces stop accepting, the faces already there are served until the module stops
+    void beginDrain() override;
+
+    // nothing queued on the faces
+    bool isDrained() override;
 
 public:
     StrategyRouter(const std::string &name, uint16_t local_port, uint16_t local_command_port);
@@ -38,13 +95,14 @@ public:
 
     void run() override;
 
-    void onIngressInterest(const std::shared_ptr<Face> &ingress_face, const ndn::Interest &interest);
+    // the commands applied by run() before the ingress accepts a face, see StartupConfig. false if source can't be
+    // read. before start()
+    bool loadStartupConfig(const std::string &source);
 
-    void onIngressData(const std::shared_ptr<Face> &ingress_face, const ndn::Data &data);
+    // packets are forwarded as received, they are never decoded
+    void onIngressPacket(const std::shared_ptr<Face> &ingress_face, const NdnPacket &packet);
 
-    void onEgressInterest(const std::shared_ptr<Face> &egress_face, const ndn::Interest &interest);
-
-    void onEgressData(const std::shared_ptr<Face> &egress_face, const ndn::Data &data);
+    void onEgressPacket(const std::shared_ptr<Face> &egress_face, const NdnPacket &packet);
 
     void onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
 
@@ -56,6 +114,9 @@ public:
 
     void commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred);
 
+    // a parsed command with an action, on the module thread
+    void executeCommand(const rapidjson::Document &document);
+
     void commandEditConfig(const rapidjson::Document &document);
 
     void commandAddFace(const rapidjson::Document &document);
@@ -63,4 +124,14 @@ public:
     void commandDelFace(const rapidjson::Document &document);
 
     void commandList(const rapidjson::Document &document);
+
+    // at each scrape, from the module thread as commandList
+    void writeMetrics(MetricsWriter &writer);
+
+    void commandSetStrategy(const rapidjson::Document &document);
+
+    void commandUnsetStrategy(const rapidjson::Document &document);
+
+    // the bytes held by the strategies, the side tables and the faces, see MemoryStats
+    void commandMemoryStats(const rapidjson::Document &document);
 };
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "weighted_strategy.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "adaptive_strategy.h"
+
+WeightedStrategy::WeightedStrategy(const Weights &weights, bool is_auto, const ndn::time::milliseconds &update_interval,
+                                   const ndn::time::milliseconds &timeout)
+        : Strategy()
+        , _weights(weights)
+        , _is_auto(is_auto)
+        , _update_interval(update_interval)
+        , _measurements(timeout) {
+
+}
+
+size_t WeightedStrategy::getWeight(size_t face_id) const {
+    auto it = _weights.find(face_id);
+    return it != _weights.end() ? it->second : DEFAULT_WEIGHT;
+}
+
+void WeightedStrategy::updateWeights(const std::vector<std::shared_ptr<Face>> &faces) {
+    std::vector<double> costs(faces.size(), 0);
+    double min_cost = 0;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        const FaceMeasurements::Measurement *measurement = _measurements.find(faces[i]->getFaceId());
+        if (measurement && !measurement->isTimingOut() && measurement->samples > 0) {
+            costs[i] = measurement->srtt + static_cast<double>(faces[i]->getQueueStats().packets * AdaptiveStrategy::QUEUED_PACKET_COST) + 1;
+            if (min_cost == 0 || costs[i] < min_cost) {
+                min_cost = costs[i];
+            }
+        }
+    }
+    for (size_t i = 0; i < faces.size(); ++i) {
+        size_t weight = getWeight(faces[i]->getFaceId());
+        const FaceMeasurements::Measurement *measurement = _measurements.find(faces[i]->getFaceId());
+        size_t target = weight;
+        if (measurement && measurement->isTimingOut()) {
+            target = std::min(weight, MIN_WEIGHT);
+        } else if (costs[i] > 0) {
+            target = std::max(static_cast<size_t>(std::lround(weight * min_cost / costs[i])), std::min(weight, MIN_WEIGHT));
+        }
+        // halfway to the target, a single slow sample doesn't swing the traffic
+        auto it = _shares.find(faces[i]->getFaceId());
+        size_t previous = it != _shares.end() ? it->second.weight : weight;
+        _shares[faces[i]->getFaceId()].weight = (previous + target + 1) / 2;
+    }
+}
+
+std::vector<std::shared_ptr<Face>> WeightedStrategy::selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) {
+    if (faces.empty()) {
+        return std::vector<std::shared_ptr<Face>>();
+    }
+    // the faces removed since are forgotten once they outnumber those left
+    if (_shares.size() > 2 * faces.size()) {
+        _shares.clear();
+    }
+    Clock::time_point now = Clock::now();
+    if (_is_auto) {
+        _measurements.prune(faces);
+        if (now - _last_update >= _update_interval) {
+            updateWeights(faces);
+            _last_update = now;
+        }
+    }
+    size_t selected = 0;
+    Share *selected_share = nullptr;
+    int64_t total = 0;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        auto it = _shares.find(faces[i]->getFaceId());
+        if (it == _shares.end()) {
+            it = _shares.emplace(faces[i]->getFaceId(), Share{getWeight(faces[i]->getFaceId())}).first;
+        }
+        it->second.current += static_cast<int64_t>(it->second.weight);
+        total += static_cast<int64_t>(it->second.weight);
+        if (!selected_share || it->second.current > selected_share->current) {
+            selected = i;
+            selected_share = &it->second;
+        }
+    }
+    selected_share->current -= total;
+    if (_is_auto && packet.getType() == NdnPacket::INTEREST) {
+        _measurements.onInterest(packet.getNameView(), faces[selected], now);
+    }
+    return {faces[selected]};
+}
+
+void WeightedStrategy::onData(const NdnPacket &packet, const std::shared_ptr<Face> &face) {
+    if (_is_auto) {
+        _measurements.onData(packet.getNameView(), face);
+    }
+}
+
+const FaceMeasurements* WeightedStrategy::getMeasurements() const {
+    return _is_auto ? &_measurements : nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "face_measurements.h"
+#include "strategy.h"
+
+// smooth weighted round-robin as nginx does: each face gets a share of the Interests in proportion to its weight,
+// interleaved rather than in runs. weights are given by face ID, DEFAULT_WEIGHT for the faces not given. with
+// is_auto the weight of each face is also scaled by how fast it answers, the lowest srtt plus queued packets over its
+// own as measured by AdaptiveStrategy, and recomputed every update_interval, so that a slow or warming up clone gets
+// less until it catches up
+class WeightedStrategy : public Strategy {
+public:
+    using Clock = FaceMeasurements::Clock;
+    using Weights = std::unordered_map<size_t, size_t>;
+
+    static const size_t DEFAULT_WEIGHT = 100;
+    // a face timing out keeps a little so that it is still measured
+    static const size_t MIN_WEIGHT = 1;
+
+private:
+    struct Share {
+        size_t weight;
+        int64_t current = 0;
+    };
+
+    const Weights _weights;
+    const bool _is_auto;
+    const ndn::time::milliseconds _update_interval;
+    FaceMeasurements _measurements;
+    // by face ID
+    std::unordered_map<size_t, Share> _shares;
+    Clock::time_point _last_update;
+
+    size_t getWeight(size_t face_id) const;
+
+    void updateWeights(const std::vector<std::shared_ptr<Face>> &faces);
+
+public:
+    WeightedStrategy(const Weights &weights, bool is_auto, const ndn::time::milliseconds &update_interval,
+                     const ndn::time::milliseconds &timeout = FaceMeasurements::DEFAULT_TIMEOUT);
+
+    ~WeightedStrategy() override = default;
+
+    std::vector<std::shared_ptr<Face>> selectFaces(const NdnPacket &packet, const std::vector<std::shared_ptr<Face>> &faces) override;
+
+    void onData(const NdnPacket &packet, const std::shared_ptr<Face> &face) override;
+
+    // null unless is_auto
+    const FaceMeasurements* getMeasurements() const override;
+};
\ No newline at end of file
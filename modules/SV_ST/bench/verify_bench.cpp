@@ -0,0 +1,133 @@
+// signature checks per second on one core for each key type, with a fresh context per check as KeyStore::verify does,
+// with the contexts of a KeyStore::Verifier kept between checks, and with its batched verify
+// usage: verify_bench [checks] [message size] [provider]
+
+#include <openssl/ec.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/obj_mac.h>
+#include <openssl/rsa.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "security/key_store.h"
+
+struct KeyType {
+    std::string name;
+    int id;
+    // RSA bits or EC curve
+    int parameter;
+    bool is_prehashed;
+};
+
+static EVP_PKEY* makeKey(const KeyType &type) {
+    EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(type.id, NULL);
+    EVP_PKEY *pkey = NULL;
+    if (ctx && EVP_PKEY_keygen_init(ctx) == 1) {
+        if (type.id == EVP_PKEY_RSA) {
+            EVP_PKEY_CTX_set_rsa_keygen_bits(ctx, type.parameter);
+        } else if (type.id == EVP_PKEY_EC) {
+            EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx, type.parameter);
+        }
+        EVP_PKEY_keygen(ctx, &pkey);
+    }
+    EVP_PKEY_CTX_free(ctx);
+    return pkey;
+}
+
+static std::vector<uint8_t> sign(const KeyType &type, EVP_PKEY *pkey, const std::vector<uint8_t> &message) {
+    std::vector<uint8_t> sig;
+    EVP_MD_CTX *ctx = EVP_MD_CTX_create();
+    size_t slen = 0;
+    if (EVP_DigestSignInit(ctx, NULL, type.is_prehashed ? EVP_sha256() : NULL, NULL, pkey) == 1
+        && EVP_DigestSign(ctx, NULL, &slen, message.data(), message.size()) == 1) {
+        sig.resize(slen);
+        if (EVP_DigestSign(ctx, sig.data(), &slen, message.data(), message.size()) == 1) {
+            sig.resize(slen);
+        } else {
+            sig.clear();
+        }
+    }
+    EVP_MD_CTX_destroy(ctx);
+    return sig;
+}
+
+static double since(const std::chrono::steady_clock::time_point &start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 20000;
+    size_t size = argc > 2 ? std::stoul(argv[2]) : 1024;
+    if (argc > 3 && !KeyStore::useProvider(argv[3])) {
+        std::cerr << "provider " << argv[3] << " can't be loaded" << std::endl;
+        return -1;
+    }
+
+    std::vector<KeyType> types = {
+            {"rsa-2048", EVP_PKEY_RSA, 2048, true},
+            {"rsa-4096", EVP_PKEY_RSA, 4096, true},
+            {"ecdsa-p256", EVP_PKEY_EC, NID_X9_62_prime256v1, true},
+#ifdef EVP_PKEY_ED25519
+            {"ed25519", EVP_PKEY_ED25519, 0, false},
+#endif
+    };
+    std::vector<uint8_t> message(size);
+    for (size_t i = 0; i < size; ++i) {
+        message[i] = static_cast<uint8_t>(std::rand());
+    }
+
+    for (const auto &type : types) {
+        EVP_PKEY *pkey = makeKey(type);
+        if (!pkey) {
+            std::cout << type.name << ": key generation failed" << std::endl;
+            ERR_clear_error();
+            continue;
+        }
+        std::vector<uint8_t> sig = sign(type, pkey, message);
+        if (sig.empty()) {
+            std::cout << type.name << ": signing failed" << std::endl;
+            ERR_clear_error();
+            EVP_PKEY_free(pkey);
+            continue;
+        }
+
+        size_t valid = 0;
+        double seconds = 0;
+        // Ed25519 can't go through the SHA-256 of KeyStore::verify
+        if (type.is_prehashed) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; ++i) {
+                valid += KeyStore::verify(message.data(), message.size(), sig.data(), sig.size(), pkey);
+            }
+            seconds = since(start);
+            std::cout << type.name << " fresh contexts: " << count / seconds << " verifies/s, " << valid << "/" << count
+                      << " valid" << std::endl;
+        }
+
+        KeyStore::Verifier verifier;
+        valid = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            valid += verifier.verify(message.data(), message.size(), sig.data(), sig.size(), pkey);
+        }
+        seconds = since(start);
+        std::cout << type.name << " reused contexts: " << count / seconds << " verifies/s, " << valid << "/" << count
+                  << " valid" << std::endl;
+
+        std::vector<KeyStore::Verifier::Check> checks(count, {message.data(), message.size(), sig.data(), sig.size(), pkey, false});
+        start = std::chrono::steady_clock::now();
+        valid = verifier.verify(checks);
+        seconds = since(start);
+        std::cout << type.name << " batch: " << count / seconds << " verifies/s, " << valid << "/" << count
+                  << " valid" << std::endl;
+
+        EVP_PKEY_free(pkey);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "invalid_signature_report.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+
+InvalidSignatureReport::InvalidSignatureReport(size_t top, size_t prefix_length)
+        : _top(top)
+        , _prefix_length(prefix_length)
+        , _sketch(ROWS * WIDTH, 0) {
+
+}
+
+size_t InvalidSignatureReport::getTop() const {
+    return _top;
+}
+
+void InvalidSignatureReport::setTop(size_t top) {
+    _top = top;
+}
+
+size_t InvalidSignatureReport::getPrefixLength() const {
+    return _prefix_length;
+}
+
+void InvalidSignatureReport::setPrefixLength(size_t prefix_length) {
+    _prefix_length = prefix_length;
+    _prefixes.clear();
+}
+
+size_t InvalidSignatureReport::increment(uint64_t hash) {
+    uint32_t estimate = UINT32_MAX;
+    for (size_t row = 0; row < ROWS; ++row) {
+        uint32_t &counter = _sketch[row * WIDTH + (name_hash::mix(hash, row + 1) & (WIDTH - 1))];
+        if (counter < UINT32_MAX) {
+            ++counter;
+        }
+        estimate = std::min(estimate, counter);
+    }
+    return estimate;
+}
+
+size_t InvalidSignatureReport::estimate(uint64_t hash) const {
+    uint32_t estimate = UINT32_MAX;
+    for (size_t row = 0; row < ROWS; ++row) {
+        estimate = std::min(estimate, _sketch[row * WIDTH + (name_hash::mix(hash, row + 1) & (WIDTH - 1))]);
+    }
+    return estimate;
+}
+
+void InvalidSignatureReport::offer(std::vector<HeavyHitter> &hitters, size_t top, const HeavyHitter &hitter) {
+    auto it = findHash(hitters, hitter.hash);
+    if (it != hitters.end()) {
+        it->count = std::max(it->count, hitter.count);
+    } else if (hitters.size() < top) {
+        hitters.push_back(hitter);
+    } else if (top > 0) {
+        auto min = findMin(hitters);
+        if (hitter.count > min->count) {
+            *min = hitter;
+        }
+    }
+}
+
+std::vector<InvalidSignatureReport::HeavyHitter>::iterator InvalidSignatureReport::findHash(std::vector<HeavyHitter> &hitters,
+                                                                                                uint64_t hash) {
+    return std::find_if(hitters.begin(), hitters.end(), [hash](const HeavyHitter &hitter) {
+        return hitter.hash == hash;
+    });
+}
+
+std::vector<InvalidSignatureReport::HeavyHitter>::iterator InvalidSignatureReport::findMin(std::vector<HeavyHitter> &hitters) {
+    return std::min_element(hitters.begin(), hitters.end(), [](const HeavyHitter &a, const HeavyHitter &b) {
+        return a.count < b.count;
+    });
+}
+
+void InvalidSignatureReport::recordName(const NdnPacket &packet) {
+    uint64_t hash = packet.getNameView().getHash();
+    size_t estimate = increment(hash);
+    // the URI is only built for a name getting in the top
+    auto it = findHash(_names, hash);
+    if (it != _names.end()) {
+        it->count = estimate;
+    } else if (_names.size() < _top || (_top > 0 && estimate > findMin(_names)->count)) {
+        offer(_names, _top, {hash, packet.getName().toUri(), estimate});
+    }
+}
+
+void InvalidSignatureReport::recordPrefix(const NdnPacket &packet) {
+    const NameView &name = packet.getNameView();
+    size_t length = std::min(_prefix_length, name.size());
+    uint64_t hash = name.getPrefixHash(length);
+    auto it = findHash(_prefixes, hash);
+    if (it != _prefixes.end()) {
+        ++it->count;
+    } else if (_prefixes.size() < _top) {
+        _prefixes.push_back({hash, packet.getName().getPrefix(length).toUri(), 1});
+    } else if (_top > 0) {
+        // the least seen prefix gives its place, the newcomer inherits its count as space saving does
+        auto min = findMin(_prefixes);
+        *min = {hash, packet.getName().getPrefix(length).toUri(), min->count + 1};
+    }
+}
+
+void InvalidSignatureReport::record(const NdnPacket &packet) {
+    ++_count;
+    recordName(packet);
+    recordPrefix(packet);
+}
+
+void InvalidSignatureReport::add(const InvalidSignatureReport &other) {
+    _count += other._count;
+    for (size_t i = 0; i < _sketch.size(); ++i) {
+        _sketch[i] = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(_sketch[i]) + other._sketch[i], UINT32_MAX));
+    }
+    for (auto &name : _names) {
+        name.count = estimate(name.hash);
+    }
+    for (const auto &name : other._names) {
+        offer(_names, _top, {name.hash, name.uri, estimate(name.hash)});
+    }
+    for (const auto &prefix : other._prefixes) {
+        auto it = findHash(_prefixes, prefix.hash);
+        if (it != _prefixes.end()) {
+            it->count += prefix.count;
+        } else {
+            offer(_prefixes, _top, prefix);
+        }
+    }
+}
+
+bool InvalidSignatureReport::empty() const {
+    return _count == 0;
+}
+
+void InvalidSignatureReport::clear() {
+    std::fill(_sketch.begin(), _sketch.end(), 0);
+    _names.clear();
+    _prefixes.clear();
+    _count = 0;
+}
+
+size_t InvalidSignatureReport::getMemoryUsage() const {
+    size_t bytes = memory_usage::of(_sketch) + memory_usage::of(_names) + memory_usage::of(_prefixes);
+    for (const auto &hitter : _names) {
+        bytes += memory_usage::of(hitter.uri);
+    }
+    for (const auto &hitter : _prefixes) {
+        bytes += memory_usage::of(hitter.uri);
+    }
+    return bytes;
+}
+
+std::string InvalidSignatureReport::toJSONMembers(size_t max_size) const {
+    auto by_count = [](const HeavyHitter *a, const HeavyHitter *b) {
+        return a->count > b->count;
+    };
+    std::vector<const HeavyHitter*> names;
+    for (const auto &name : _names) {
+        names.push_back(&name);
+    }
+    std::sort(names.begin(), names.end(), by_count);
+    std::vector<const HeavyHitter*> prefixes;
+    for (const auto &prefix : _prefixes) {
+        prefixes.push_back(&prefix);
+    }
+    std::sort(prefixes.begin(), prefixes.end(), by_count);
+
+    std::stringstream ss;
+    ss << R"("invalid_count":)" << _count << R"(, "invalid_signature_names":[)";
+    bool first = true;
+    for (const auto *name : names) {
+        // the closing of both lists and the prefix object included
+        if (static_cast<size_t>(ss.tellp()) + name->uri.size() + 64 > max_size) {
+            break;
+        }
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << '"' << name->uri << '"';
+    }
+    ss << R"(], "prefixes":[)";
+    first = true;
+    for (const auto *prefix : prefixes) {
+        if (static_cast<size_t>(ss.tellp()) + prefix->uri.size() + 64 > max_size) {
+            break;
+        }
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << R"({"prefix":")" << prefix->uri << R"(", "count":)" << prefix->count << "}";
+    }
+    ss << "]";
+    return ss.str();
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "network/ndn_packet.h"
+
+// the invalid signatures seen between two reports in bounded memory, however many there are: their count, the names
+// seen the most as estimated by a count-min sketch of the name hashes, and the prefixes seen the most as counted by
+// space saving, an upper bound of their count. only the top entries keep their URI, built when they get in the top
+class InvalidSignatureReport {
+public:
+    static const size_t DEFAULT_TOP = 32;
+    static const size_t DEFAULT_PREFIX_LENGTH = 2;
+
+private:
+    static const size_t ROWS = 4;
+    static const size_t WIDTH = 1024;
+
+    struct HeavyHitter {
+        uint64_t hash;
+        std::string uri;
+        size_t count;
+    };
+
+    size_t _top;
+    size_t _prefix_length;
+    std::vector<uint32_t> _sketch;
+    // neither is sorted, they are only a few dozens
+    std::vector<HeavyHitter> _names;
+    std::vector<HeavyHitter> _prefixes;
+    size_t _count = 0;
+
+    // the estimate after the increment
+    size_t increment(uint64_t hash);
+
+    size_t estimate(uint64_t hash) const;
+
+    // the entry of hash is created or raised to count, the one with the least count gives its place when full
+    static void offer(std::vector<HeavyHitter> &hitters, size_t top, const HeavyHitter &hitter);
+
+    void recordName(const NdnPacket &packet);
+
+    void recordPrefix(const NdnPacket &packet);
+
+    static std::vector<HeavyHitter>::iterator findHash(std::vector<HeavyHitter> &hitters, uint64_t hash);
+
+    static std::vector<HeavyHitter>::iterator findMin(std::vector<HeavyHitter> &hitters);
+
+public:
+    explicit InvalidSignatureReport(size_t top = DEFAULT_TOP, size_t prefix_length = DEFAULT_PREFIX_LENGTH);
+
+    size_t getTop() const;
+
+    // takes effect from the next clear
+    void setTop(size_t top);
+
+    size_t getPrefixLength() const;
+
+    // the prefixes counted so far are forgotten
+    void setPrefixLength(size_t prefix_length);
+
+    // the packet must be a Data
+    void record(const NdnPacket &packet);
+
+    // those of other are counted here as well, for the reports kept by thread. the names are ranked again on the sum
+    // of the sketches, the prefixes on the sum of their counts
+    void add(const InvalidSignatureReport &other);
+
+    bool empty() const;
+
+    void clear();
+
+    // of the sketch and the top entries with their URIs
+    size_t getMemoryUsage() const;
+
+    // "invalid_count", "invalid_signature_names" and "prefixes": [{"prefix", "count"}], the most seen first, to be
+    // put in a report. the entries which would take it past max_size bytes are left out
+    std::string toJSONMembers(size_t max_size) const;
+};
\ No newline at end of file
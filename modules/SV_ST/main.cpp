@@ -2,16 +2,38 @@
 
 #include "signature_verifier.h"
 #include "log/logger.h"
-
-static bool stop = false;
-static void signal_handler(int signum) {
-    stop = true;
-}
+#include "network/packet_capture.h"
+#include "network/tracer.h"
+#include "network/socket_options.h"
+#include "network/udp_egress_socket.h"
+#include "network/uring_service.h"
+#include "network/xdp_socket.h"
 
 int main(int argc, char *argv[]) {
     std::string name = "";
     uint16_t local_port = 0;
     uint16_t local_command_port = 0;
+    std::string backend = "epoll";
+    // "eth0" or "eth0:2", the UDP master faces then read their port off the NIC queues with AF_XDP
+    std::string xdp_interface = "";
+    // "receive_buffer=8388608,dscp=46", the default profile of the sockets of the faces, see SocketOptions
+    std::string socket_options = "";
+    // "connected" for a connected socket per egress UDP face, "shared" for one socket shared by them, see UdpEgressSocket
+    std::string egress_sockets = "connected";
+    std::string provider = "";
+    size_t concurrency = SignatureVerifier::DEFAULT_CONCURRENCY;
+    // in milliseconds, SIGINT or SIGTERM lets the module drain that long at most before it stops
+    size_t drain_timeout = 2000;
+    // 0 for no metrics endpoint
+    uint16_t metrics_port = 0;
+    // one packet in trace_sampling is traced through the chain, see Tracer, 0 for none
+    uint64_t trace_sampling = 0;
+    // "directory[:file_mb[:files]]", the packets of the faces are captured there for ndnms-bench -R, see PacketCapture
+    std::string capture = "";
+    // a file or the JSON of the commands applied before the module listens, see StartupConfig
+    std::string startup_config = "";
+    // "ID:FILE", the Data found valid are tagged for the next verifiers sharing the key of FILE, see VerifiedTagger
+    std::string verified_tagging = "";
 
     char flags = 0;
     for (int i = 1; i < argc; i += 2) {
@@ -28,6 +50,42 @@ int main(int argc, char *argv[]) {
                 local_command_port = std::atoi(argv[i + 1]);
                 flags |= 0x4;
                 break;
+            case 'b':
+                backend = argv[i + 1];
+                break;
+            case 'X':
+                xdp_interface = argv[i + 1];
+                break;
+            case 'O':
+                socket_options = argv[i + 1];
+                break;
+            case 'U':
+                egress_sockets = argv[i + 1];
+                break;
+            case 'e':
+                provider = argv[i + 1];
+                break;
+            case 'j':
+                concurrency = std::max(std::atoi(argv[i + 1]), 1);
+                break;
+            case 'g':
+                drain_timeout = std::atoi(argv[i + 1]);
+                break;
+            case 'M':
+                metrics_port = std::atoi(argv[i + 1]);
+                break;
+            case 'T':
+                trace_sampling = std::strtoull(argv[i + 1], nullptr, 10);
+                break;
+            case 'R':
+                capture = argv[i + 1];
+                break;
+            case 'F':
+                startup_config = argv[i + 1];
+                break;
+            case 'V':
+                verified_tagging = argv[i + 1];
+                break;
             case 'h':
             default:
                 exit(0);
@@ -43,18 +101,48 @@ int main(int argc, char *argv[]) {
     logger::setFilename("logs.txt");
     logger::isTee(true);
     logger::setMinimalLogLevel(logger::INFO);
+    Tracer::setSampling(trace_sampling);
+    if (!capture.empty() && !PacketCapture::start(capture)) {
+        logger::log(logger::WARNING, "the packets can't be captured in {}", {capture});
+    }
 
-    SignatureVerifier signature_verifier(name, local_port, local_command_port);
-    signature_verifier.start();
+    // faces created by the module pick the backend up, it must be selected before
+    if (backend == "io_uring" && !UringService::enable()) {
+        logger::log(logger::WARNING, "io_uring is not available, falling back to epoll");
+    }
+    if (!xdp_interface.empty() && !XdpSocket::enable(xdp_interface)) {
+        logger::log(logger::WARNING, "AF_XDP is not available on {}, udp is read from the sockets", {xdp_interface});
+    }
+    SocketOptions options;
+    if (SocketOptions::parse(socket_options, options)) {
+        SocketOptions::setDefault(options);
+    } else {
+        logger::log(logger::WARNING, "invalid socket options {}, the kernel defaults are kept", {socket_options});
+    }
+    if (egress_sockets == "shared") {
+        UdpEgressSocket::enable();
+    }
 
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    // the keys and the verifiers created afterwards use it
+    if (!provider.empty() && !KeyStore::useProvider(provider)) {
+        logger::log(logger::WARNING, "OpenSSL provider " + provider + " can't be loaded, falling back to the default one");
+    }
 
-    do {
-        sleep(15);
-    }while(!stop);
+    SignatureVerifier signature_verifier(name, local_port, local_command_port, concurrency);
+    if (metrics_port != 0) {
+        signature_verifier.enableMetrics(metrics_port);
+    }
+    if (!verified_tagging.empty() && !signature_verifier.setVerifiedTagging(verified_tagging)) {
+        logger::log(logger::ERROR, "invalid verified tagging {}", {verified_tagging});
+        return -1;
+    }
+    if (!startup_config.empty() && !signature_verifier.loadStartupConfig(startup_config)) {
+        logger::log(logger::ERROR, "the startup configuration {} can't be read", {startup_config});
+        return -1;
+    }
+    signature_verifier.start();
 
-    signature_verifier.stop();
+    signature_verifier.waitForStop(boost::posix_time::milliseconds(drain_timeout));
 
     return 0;
 }
\ No newline at end of file
@@ -1,3 +0,0 @@
-#include "face.h"
-
-size_t Face::counter = 0;
\ No newline at end of file
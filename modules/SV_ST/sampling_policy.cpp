@@ -0,0 +1,97 @@
+#include "sampling_policy.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "metrics/memory_stats.h"
+
+SamplingPolicy::SamplingPolicy(double ratio, size_t prefix_length, size_t quiet_period)
+        : _ratio(std::min(std::max(ratio, 0.0), 1.0))
+        , _distribution(_ratio)
+        , _generator(std::random_device()())
+        , _prefix_length(prefix_length)
+        , _quiet_period(quiet_period) {
+
+}
+
+double SamplingPolicy::getRatio() const {
+    return _ratio;
+}
+
+void SamplingPolicy::setRatio(double ratio) {
+    _ratio = std::min(std::max(ratio, 0.0), 1.0);
+    _distribution = std::bernoulli_distribution(_ratio);
+}
+
+size_t SamplingPolicy::getPrefixLength() const {
+    return _prefix_length;
+}
+
+void SamplingPolicy::setPrefixLength(size_t prefix_length) {
+    _prefix_length = prefix_length;
+    _alerts.clear();
+}
+
+size_t SamplingPolicy::getQuietPeriod() const {
+    return static_cast<size_t>(_quiet_period.count());
+}
+
+void SamplingPolicy::setQuietPeriod(size_t quiet_period) {
+    _quiet_period = ndn::time::milliseconds(quiet_period);
+}
+
+bool SamplingPolicy::isChecked(const NameView &name) {
+    bool is_checked = _ratio >= 1;
+    if (!is_checked && !_alerts.empty()) {
+        auto it = _alerts.find(name.getPrefixHash(std::min(_prefix_length, name.size())));
+        if (it != _alerts.end()) {
+            if (it->second > ndn::time::steady_clock::now()) {
+                is_checked = true;
+            } else {
+                _alerts.erase(it);
+            }
+        }
+    }
+    if (!is_checked) {
+        is_checked = _distribution(_generator);
+    }
+    if (is_checked) {
+        ++_checked;
+    } else {
+        ++_skipped;
+    }
+    return is_checked;
+}
+
+void SamplingPolicy::onInvalid(const NameView &name) {
+    uint64_t hash = name.getPrefixHash(std::min(_prefix_length, name.size()));
+    if (!_alerts.count(hash) && _alerts.size() >= MAX_PREFIXES) {
+        removeOldestAlert();
+    }
+    _alerts[hash] = ndn::time::steady_clock::now() + _quiet_period;
+}
+
+void SamplingPolicy::removeOldestAlert() {
+    auto oldest = std::min_element(_alerts.begin(), _alerts.end(), [](const std::pair<const uint64_t, ndn::time::steady_clock::time_point> &a,
+                                                                      const std::pair<const uint64_t, ndn::time::steady_clock::time_point> &b) {
+        return a.second < b.second;
+    });
+    if (oldest != _alerts.end()) {
+        _alerts.erase(oldest);
+    }
+}
+
+size_t SamplingPolicy::getAlerts() const {
+    return _alerts.size();
+}
+
+size_t SamplingPolicy::getMemoryUsage() const {
+    return memory_usage::of(_alerts);
+}
+
+std::string SamplingPolicy::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"ratio":)" << _ratio << R"(, "prefix_length":)" << _prefix_length << R"(, "quiet_period":)" << _quiet_period.count()
+       << R"(, "alerts":)" << _alerts.size() << R"(, "checked":)" << _checked << R"(, "skipped":)" << _skipped << "}";
+    return ss.str();
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "network/name_view.h"
+
+// which of the signed Data have their signature checked when checking them all costs too much. a fraction of the
+// Data is picked at random, a prefix where an invalid signature was seen has all its Data checked until no other one
+// is seen for quiet_period. the prefix is the first prefix_length components of the Data Name, at most max_prefixes
+// are on alert at once, the oldest alert goes past it
+class SamplingPolicy {
+public:
+    static const size_t DEFAULT_PREFIX_LENGTH = 2;
+    static const size_t DEFAULT_QUIET_PERIOD = 30000;
+    static const size_t MAX_PREFIXES = 4096;
+
+private:
+    double _ratio;
+    std::bernoulli_distribution _distribution;
+    std::minstd_rand _generator;
+    size_t _prefix_length;
+    ndn::time::milliseconds _quiet_period;
+    // by name_hash of the prefix, until when all its Data are checked
+    std::unordered_map<uint64_t, ndn::time::steady_clock::time_point> _alerts;
+    size_t _checked = 0;
+    size_t _skipped = 0;
+
+    void removeOldestAlert();
+
+public:
+    // ratio is the fraction of the Data checked out of alert, 1 checks them all
+    explicit SamplingPolicy(double ratio = 1, size_t prefix_length = DEFAULT_PREFIX_LENGTH,
+                            size_t quiet_period = DEFAULT_QUIET_PERIOD);
+
+    double getRatio() const;
+
+    // clamped to [0, 1]
+    void setRatio(double ratio);
+
+    size_t getPrefixLength() const;
+
+    // the prefixes on alert are forgotten
+    void setPrefixLength(size_t prefix_length);
+
+    // in milliseconds
+    size_t getQuietPeriod() const;
+
+    void setQuietPeriod(size_t quiet_period);
+
+    // true if the signature of the Data is to be checked, counted as checked or skipped
+    bool isChecked(const NameView &name);
+
+    // an invalid signature was seen on name, its prefix is on alert for quiet_period from now
+    void onInvalid(const NameView &name);
+
+    // prefixes on alert
+    size_t getAlerts() const;
+
+    size_t getMemoryUsage() const;
+
+    // {"ratio", "prefix_length", "quiet_period", "alerts", "checked", "skipped"}
+    std::string toJSON() const;
+};
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include "signature_cache.h"
+
+#include <sstream>
+
+#include "metrics/memory_stats.h"
+
+SignatureCache::SignatureCache(size_t max_size, size_t ttl)
+        : _max_size(max_size)
+        , _ttl(ttl)
+        , _md_ctx(EVP_MD_CTX_create()) {
+
+}
+
+SignatureCache::~SignatureCache() {
+    if (_md_ctx) {
+        EVP_MD_CTX_destroy(_md_ctx);
+    }
+}
+
+bool SignatureCache::isEnabled() const {
+    return _max_size > 0;
+}
+
+size_t SignatureCache::getMaxSize() const {
+    return _max_size;
+}
+
+void SignatureCache::setMaxSize(size_t max_size) {
+    _max_size = max_size;
+    while (_entries.size() > _max_size) {
+        _index.erase(_entries.back().digest);
+        _entries.pop_back();
+    }
+}
+
+size_t SignatureCache::getTtl() const {
+    return static_cast<size_t>(_ttl.count());
+}
+
+void SignatureCache::setTtl(size_t ttl) {
+    _ttl = ndn::time::milliseconds(ttl);
+}
+
+bool SignatureCache::digest(const NdnPacket::SignatureView &signature, Digest &digest) {
+    if (!_md_ctx) {
+        return false;
+    }
+    unsigned int digest_size = 0;
+    return EVP_DigestInit_ex(_md_ctx, EVP_sha256(), NULL) == 1
+           && EVP_DigestUpdate(_md_ctx, signature.signed_begin, signature.signed_size) == 1
+           && EVP_DigestUpdate(_md_ctx, signature.value, signature.value_size) == 1
+           && EVP_DigestFinal_ex(_md_ctx, digest.data(), &digest_size) == 1
+           && digest_size == digest.size();
+}
+
+SignatureCache::Verdict SignatureCache::find(const Digest &digest) {
+    auto it = _index.find(digest);
+    if (it == _index.end()) {
+        ++_misses;
+        return UNKNOWN;
+    }
+    if (it->second->expire_time < ndn::time::steady_clock::now()) {
+        _entries.erase(it->second);
+        _index.erase(it);
+        ++_misses;
+        return UNKNOWN;
+    }
+    _entries.splice(_entries.begin(), _entries, it->second);
+    ++_hits;
+    return it->second->is_valid ? VALID : INVALID;
+}
+
+void SignatureCache::insert(const Digest &digest, const ndn::Name &key_name, bool is_valid) {
+    if (!isEnabled()) {
+        return;
+    }
+    auto expire_time = ndn::time::steady_clock::now() + _ttl;
+    auto it = _index.find(digest);
+    if (it != _index.end()) {
+        it->second->key_name = key_name;
+        it->second->is_valid = is_valid;
+        it->second->expire_time = expire_time;
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+    }
+    if (_entries.size() >= _max_size) {
+        _index.erase(_entries.back().digest);
+        _entries.pop_back();
+    }
+    _entries.push_front({digest, key_name, is_valid, expire_time});
+    _index.emplace(digest, _entries.begin());
+}
+
+void SignatureCache::remove(const ndn::Name &key_name) {
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it->key_name == key_name) {
+            _index.erase(it->digest);
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t SignatureCache::size() const {
+    return _entries.size();
+}
+
+size_t SignatureCache::getMemoryUsage() const {
+    size_t bytes = memory_usage::of(_entries) + memory_usage::of(_index);
+    for (const auto &entry : _entries) {
+        bytes += memory_usage::of(entry.key_name);
+    }
+    return bytes;
+}
+
+std::string SignatureCache::toJSON() const {
+    std::stringstream ss;
+    size_t lookups = _hits + _misses;
+    ss << R"({"size":)" << _entries.size() << R"(, "max_size":)" << _max_size << R"(, "ttl":)" << _ttl.count()
+       << R"(, "hits":)" << _hits << R"(, "misses":)" << _misses
+       << R"(, "hit_ratio":)" << (lookups ? static_cast<double>(_hits) / lookups : 0.0) << "}";
+    return ss.str();
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/util/time.hpp>
+
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "network/ndn_packet.h"
+
+// the verdicts of the signatures checked, good or bad, so that a Data seen again skips the public key operation. an
+// entry is found by the SHA-256 of the signed part of the Data followed by the signature, a Data hits only if both are
+// the same bit for bit. entries live ttl at most, the least recently used goes first past max_size and those of a key
+// go when the key is removed
+class SignatureCache {
+public:
+    static const size_t DEFAULT_SIZE = 16384;
+    static const size_t DEFAULT_TTL = 10000;
+
+    typedef std::array<uint8_t, SHA256_DIGEST_LENGTH> Digest;
+
+    enum Verdict {
+        UNKNOWN,
+        VALID,
+        INVALID,
+    };
+
+private:
+    struct DigestHash {
+        size_t operator()(const Digest &digest) const {
+            size_t hash;
+            std::memcpy(&hash, digest.data(), sizeof(hash));
+            return hash;
+        }
+    };
+
+    struct Entry {
+        Digest digest;
+        ndn::Name key_name;
+        bool is_valid;
+        ndn::time::steady_clock::time_point expire_time;
+    };
+
+    // 0 disables the cache
+    size_t _max_size;
+    ndn::time::milliseconds _ttl;
+    // most recently used first
+    std::list<Entry> _entries;
+    std::unordered_map<Digest, std::list<Entry>::iterator, DigestHash> _index;
+    EVP_MD_CTX *_md_ctx;
+    size_t _hits = 0;
+    size_t _misses = 0;
+
+public:
+    explicit SignatureCache(size_t max_size = DEFAULT_SIZE, size_t ttl = DEFAULT_TTL);
+
+    SignatureCache(const SignatureCache&) = delete;
+
+    SignatureCache& operator=(const SignatureCache&) = delete;
+
+    ~SignatureCache();
+
+    bool isEnabled() const;
+
+    size_t getMaxSize() const;
+
+    // the least recently used entries past max_size are removed
+    void setMaxSize(size_t max_size);
+
+    // in milliseconds, for the entries inserted from now on
+    size_t getTtl() const;
+
+    void setTtl(size_t ttl);
+
+    // false if the digest can't be computed, the Data is then checked without the cache
+    bool digest(const NdnPacket::SignatureView &signature, Digest &digest);
+
+    // counted as a hit or a miss
+    Verdict find(const Digest &digest);
+
+    void insert(const Digest &digest, const ndn::Name &key_name, bool is_valid);
+
+    // the verdicts given with the key
+    void remove(const ndn::Name &key_name);
+
+    size_t size() const;
+
+    // of the entries with their key names and of the index
+    size_t getMemoryUsage() const;
+
+    // {"size", "max_size", "ttl", "hits", "misses", "hit_ratio"}
+    std::string toJSON() const;
+};
\ No newline at end of file
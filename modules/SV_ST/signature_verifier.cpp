@@ -2,13 +2,23 @@
 
 #include <boost/bind.hpp>
 
+#include <sstream>
 #include <unordered_map>
 
 #include "network/tcp_master_face.h"
 #include "network/tcp_face.h"
 #include "network/udp_master_face.h"
 #include "network/udp_face.h"
+#include "network/shm_master_face.h"
+#include "network/shm_face.h"
+#include "network/memory_master_face.h"
+#include "network/memory_face.h"
+#include "network/striped_tcp_face.h"
 #include "log/logger.h"
+#include "metrics/memory_stats.h"
+#include "metrics/metrics.h"
+#include "metrics/sampling_profiler.h"
+#include "metrics/stage_profile.h"
 
 //static BIO *bio = BIO_new_mem_buf(RSA_PUBLIC_KEY.c_str(), RSA_PUBLIC_KEY.length());
 //static BIO *bio = BIO_new_mem_buf(DEFAULT_RSA_PUBLIC_KEY_DER, sizeof(DEFAULT_RSA_PUBLIC_KEY_DER));
@@ -16,129 +26,347 @@
 //static EVP_PKEY* pkey = d2i_PUBKEY_bio(bio, NULL);
 //static EVP_PKEY* pkey = d2i_PUBKEY_fp(fopen("tan.pub", "r"), NULL);
 
-SignatureVerifier::SignatureVerifier(const std::string &name, uint16_t local_port, uint16_t command_local_port)
-        : Module(1)
+void SignatureVerifier::Verdicts::add(const Verdicts &other) {
+    valid += other.valid;
+    invalid += other.invalid;
+    no_key += other.no_key;
+    unsigned_data += other.unsigned_data;
+    skipped += other.skipped;
+    shed += other.shed;
+    trusted += other.trusted;
+}
+
+std::string SignatureVerifier::Verdicts::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"valid":)" << valid << R"(, "invalid":)" << invalid << R"(, "no_key":)" << no_key
+       << R"(, "unsigned":)" << unsigned_data << R"(, "skipped":)" << skipped << R"(, "shed":)" << shed
+       << R"(, "trusted":)" << trusted << "}";
+    return ss.str();
+}
+
+SignatureVerifier::SignatureVerifier(const std::string &name, uint16_t local_port, uint16_t local_command_port, size_t concurrency)
+        : CoreModule(concurrency)
         , _name(name)
-        , _command_socket(_ios, {{}, 10000})
+        , _egress_faces([]() {
+            return std::unique_ptr<std::vector<std::shared_ptr<Face>>>(new std::vector<std::shared_ptr<Face>>());
+        })
+        , _command_socket(_ios, {{}, local_command_port})
+        , _connection_pool(_ios)
         , _report_timer(_ios)
-        , _delay_between_report(0) {
-    _tcp_ingress_master_face = std::make_shared<TcpMasterFace>(_ios, 16, local_port);
-    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, 16, local_port);
+        , _delay_between_report(0)
+        , _keys([]() {
+            return std::unique_ptr<KeyStore>(new KeyStore());
+        }) {
+    for (size_t i = 0; i <= _concurrency; ++i) {
+        _core_states.emplace_back(new CoreState(coreService(i)));
+    }
+    // the TCP and memory consumers are spread over the cores as they connect, UDP and SHM stay on _ios. each core
+    // accepts the TCP consumers it runs
+    std::vector<boost::asio::io_service*> acceptor_services;
+    for (size_t i = 0; i < _concurrency; ++i) {
+        acceptor_services.push_back(&coreService(i));
+    }
+    auto tcp_master_face = std::make_shared<TcpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    tcp_master_face->setAcceptorServices(acceptor_services);
+    _tcp_ingress_master_face = tcp_master_face;
+    _udp_ingress_master_face = std::make_shared<UdpMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    _shm_ingress_master_face = std::make_shared<ShmMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    auto mem_master_face = std::make_shared<MemoryMasterFace>(_ios, MasterFace::DEFAULT_MAX_CONNECTION, local_port);
+    mem_master_face->setServicePicker([this]() -> boost::asio::io_service& {
+        return nextCoreService();
+    });
+    _mem_ingress_master_face = mem_master_face;
+    _metrics.addCollector(boost::bind(&SignatureVerifier::writeMetrics, this, _1));
 }
 
 void SignatureVerifier::run() {
+    // before the ingress accepts any face, the commands are then read as usual
+    _startup_config.apply(_ios, _remote_command_endpoint, [this](const rapidjson::Document &command) {
+        executeCommand(command);
+    });
     commandRead();
+    for (auto &state : _core_states) {
+        state->loop_monitor.start();
+    }
     _tcp_ingress_master_face->listen(boost::bind(&SignatureVerifier::onMasterFaceNotification, this, _1, _2),
-                                     boost::bind(&SignatureVerifier::onIngressInterest, this, _1, _2),
-                                     boost::bind(&SignatureVerifier::onIngressData, this, _1, _2),
+                                     PacketHandler::bind<SignatureVerifier, &SignatureVerifier::onIngressPacket>(this),
                                      boost::bind(&SignatureVerifier::onMasterFaceError, this, _1, _2));
     _udp_ingress_master_face->listen(boost::bind(&SignatureVerifier::onMasterFaceNotification, this, _1, _2),
-                                     boost::bind(&SignatureVerifier::onIngressInterest, this, _1, _2),
-                                     boost::bind(&SignatureVerifier::onIngressData, this, _1, _2),
+                                     PacketHandler::bind<SignatureVerifier, &SignatureVerifier::onIngressPacket>(this),
+                                     boost::bind(&SignatureVerifier::onMasterFaceError, this, _1, _2));
+    _shm_ingress_master_face->listen(boost::bind(&SignatureVerifier::onMasterFaceNotification, this, _1, _2),
+                                     PacketHandler::bind<SignatureVerifier, &SignatureVerifier::onIngressPacket>(this),
                                      boost::bind(&SignatureVerifier::onMasterFaceError, this, _1, _2));
+    _mem_ingress_master_face->listen(boost::bind(&SignatureVerifier::onMasterFaceNotification, this, _1, _2),
+                                     PacketHandler::bind<SignatureVerifier, &SignatureVerifier::onIngressPacket>(this),
+                                     boost::bind(&SignatureVerifier::onMasterFaceError, this, _1, _2));
+}
+
+bool SignatureVerifier::loadStartupConfig(const std::string &source) {
+    return _startup_config.load(source);
 }
 
-void SignatureVerifier::onIngressInterest(const std::shared_ptr<Face> &face, const ndn::Interest &interest) {
-    for (const auto& egress_face : _egress_faces) {
-        egress_face->send(interest);
+bool SignatureVerifier::setVerifiedTagging(const std::string &spec) {
+    std::shared_ptr<VerifiedTagger> tagger = VerifiedTagger::create(spec);
+    if (!tagger) {
+        return false;
     }
+    _tagger = tagger;
+    return true;
 }
 
-void SignatureVerifier::onIngressData(const std::shared_ptr<Face> &face, const ndn::Data &data) {
-    if (data.getSignature().getType() != ndn::tlv::SignatureTypeValue::DigestSha256) {
-        auto it = _pkeys.find(data.getSignature().getKeyLocator().getName());
-        if (it != _pkeys.end()) {
-            int result = verify(data.wireEncode().value(),
-                                data.wireEncode().value_size() - data.getSignature().getValue().size(),
-                                data.getSignature().getValue().value(), data.getSignature().getValue().value_size(),
-                                it->second);
-            if (result > 0) {
-                if (_report_enable) {
-                    _invalid_signature_packet_names.emplace(data.getName().toUri());
-                }
-                if (!_drop) {
-                    for (const auto &egress_face : _egress_faces) {
-                        egress_face->send(data);
-                    }
-                }
-            } else {
-                for (const auto &egress_face : _egress_faces) {
-                    egress_face->send(data);
-                }
+void SignatureVerifier::beginDrain() {
+    for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face, _shm_ingress_master_face, _mem_ingress_master_face}) {
+        master_face->stopAccepting();
+    }
+}
+
+bool SignatureVerifier::isDrained() {
+    size_t queued = 0;
+    for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face, _shm_ingress_master_face, _mem_ingress_master_face}) {
+        queued += master_face->getQueuedPackets();
+    }
+    _egress_faces.read([&queued](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+        for (const auto &egress_face : egress_faces) {
+            queued += egress_face->getQueueStats().packets;
+        }
+    });
+    if (queued > 0) {
+        return false;
+    }
+    for (const auto &core_state : _core_states) {
+        std::lock_guard<std::mutex> guard(core_state->mutex);
+        if (!core_state->pending_data[INGRESS].empty() || !core_state->pending_data[EGRESS].empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SignatureVerifier::onIngressPacket(const std::shared_ptr<Face> &face, NdnPacket &&packet) {
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST:
+            forward(INGRESS, packet);
+            break;
+        case NdnPacket::DATA:
+            onData(INGRESS, std::move(packet));
+            break;
+        default:
+            break;
+    }
+}
+
+void SignatureVerifier::onEgressPacket(const std::shared_ptr<Face> &face, NdnPacket &&packet) {
+    switch (packet.getType()) {
+        case NdnPacket::INTEREST:
+            forward(EGRESS, packet);
+            break;
+        case NdnPacket::DATA:
+            onData(EGRESS, std::move(packet));
+            break;
+        default:
+            break;
+    }
+}
+
+void SignatureVerifier::onData(Direction direction, NdnPacket &&packet) {
+    // the key lookups and the signature cache, the checks are in verify and the forwarding in send
+    stage_profile::Scope stage(stage_profile::TABLE);
+    size_t core = currentCore();
+    CoreState &state = *_core_states[core];
+    std::lock_guard<std::mutex> lock(state.mutex);
+    // the Data isn't decoded, the signature is checked on the packet buffer and the packet is forwarded as received
+    uint64_t verifier_id;
+    if (_tagger && _tagger->check(packet, verifier_id)) {
+        ++state.verdicts.trusted;
+        deliver(state, direction, std::move(packet), true, true);
+        return;
+    }
+    const NdnPacket::SignatureView &signature = packet.getSignatureView();
+    if (signature.type == ndn::tlv::SignatureTypeValue::DigestSha256) {
+        ++state.verdicts.unsigned_data;
+        deliver(state, direction, std::move(packet), !_unsigned_drop);
+        return;
+    }
+    // the name of the key in the store, the anchor of a trust rule or the KeyLocator itself
+    ndn::Name key_name;
+    std::shared_ptr<EVP_PKEY> pkey = signature.key_name ? resolveKey(state, signature, key_name) : nullptr;
+    if (!pkey) {
+        ++state.verdicts.no_key;
+        deliver(state, direction, std::move(packet), !_no_key_drop);
+        return;
+    }
+    SignatureCache::Digest digest;
+    bool is_cacheable = state.signature_cache.isEnabled() && state.signature_cache.digest(signature, digest);
+    if (is_cacheable) {
+        SignatureCache::Verdict verdict = state.signature_cache.find(digest);
+        if (verdict != SignatureCache::UNKNOWN) {
+            bool is_valid = verdict == SignatureCache::VALID;
+            deliver(state, direction, std::move(packet), onVerified(state, packet, is_valid), is_valid);
+            return;
+        }
+    }
+    // the Data not sampled go as if their signature was valid, as do all of them while the core is overloaded
+    if (state.loop_monitor.isOverloaded()) {
+        ++state.verdicts.shed;
+        deliver(state, direction, std::move(packet), true);
+        return;
+    }
+    if (!state.sampling.isChecked(packet.getNameView())) {
+        ++state.verdicts.skipped;
+        deliver(state, direction, std::move(packet), true);
+        return;
+    }
+    std::shared_ptr<VerifierPool> verifier_pool = std::atomic_load(&_verifier_pool);
+    if (!verifier_pool) {
+        bool is_valid = state.verifier.verify(signature.signed_begin, signature.signed_size, signature.value, signature.value_size,
+                                              pkey.get());
+        if (is_cacheable) {
+            cacheVerdict(state, digest, key_name, pkey, is_valid);
+        }
+        deliver(state, direction, std::move(packet), onVerified(state, packet, is_valid), is_valid);
+    } else if (_verify_in_order) {
+        auto pending = std::make_shared<PendingData>(std::move(packet), false, false);
+        state.pending_data[direction].push_back(pending);
+        // the pool holds the pending Data itself
+        std::shared_ptr<const NdnPacket> held(pending, &pending->packet);
+        verifier_pool->verify(held, pkey, coreService(core), [this, core, direction, pending, is_cacheable, digest, key_name, pkey](bool is_valid) {
+            CoreState &state = *_core_states[core];
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (is_cacheable) {
+                cacheVerdict(state, digest, key_name, pkey, is_valid);
             }
-        } else if (!_no_key_drop) {
-            for (const auto &egress_face : _egress_faces) {
-                egress_face->send(data);
+            pending->is_done = true;
+            pending->is_forwarded = onVerified(state, pending->packet, is_valid);
+            pending->is_tagged = is_valid;
+            flushPendingData(state, direction);
+        });
+    } else {
+        // shared by the pool and the callback, which is called once
+        auto held = std::make_shared<NdnPacket>(std::move(packet));
+        verifier_pool->verify(held, pkey, coreService(core), [this, core, direction, held, is_cacheable, digest, key_name, pkey](bool is_valid) {
+            CoreState &state = *_core_states[core];
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (is_cacheable) {
+                cacheVerdict(state, digest, key_name, pkey, is_valid);
             }
+            deliver(state, direction, std::move(*held), onVerified(state, *held, is_valid), is_valid);
+        });
+    }
+}
+
+std::shared_ptr<EVP_PKEY> SignatureVerifier::resolveKey(CoreState &state, const NdnPacket::SignatureView &signature, ndn::Name &key_name) {
+    if (!_is_caching_keys.load(std::memory_order_relaxed)) {
+        ndn::Name locator(ndn::Block(signature.key_name, signature.key_name_size));
+        return _keys.read([&locator, &key_name](const KeyStore &keys) {
+            return keys.resolve(locator, key_name);
+        });
+    }
+    // the TLV of the KeyLocator hashed whole, as a single component
+    uint64_t hash = name_hash::extend(name_hash::SEED, {0, signature.key_name, signature.key_name_size});
+    return _keys.readWithGeneration([&state, &signature, &key_name, hash](const KeyStore &keys, uint64_t generation) {
+        if (const KeyLookup *cached = state.key_cache.find(hash, generation)) {
+            key_name = cached->key_name;
+            return cached->pkey;
         }
-    } else if (!_unsigned_drop) {
-        for (const auto &egress_face : _egress_faces) {
-            egress_face->send(data);
+        ndn::Name locator(ndn::Block(signature.key_name, signature.key_name_size));
+        std::shared_ptr<EVP_PKEY> pkey = keys.resolve(locator, key_name);
+        state.key_cache.insert(hash, generation, KeyLookup{pkey, key_name});
+        return pkey;
+    });
+}
+
+bool SignatureVerifier::onVerified(CoreState &state, const NdnPacket &packet, bool is_valid) {
+    if (is_valid) {
+        ++state.verdicts.valid;
+    } else {
+        ++state.verdicts.invalid;
+        state.sampling.onInvalid(packet.getNameView());
+        if (_report_enable) {
+            state.invalid_signatures.record(packet);
         }
     }
+    return is_valid || !_drop;
 }
 
-void SignatureVerifier::onEgressInterest(const std::shared_ptr<Face> &face, const ndn::Interest &interest) {
-    _tcp_ingress_master_face->sendToAllFaces(interest);
-    _udp_ingress_master_face->sendToAllFaces(interest);
+void SignatureVerifier::cacheVerdict(CoreState &state, const SignatureCache::Digest &digest, const ndn::Name &key_name,
+                                     const std::shared_ptr<EVP_PKEY> &pkey, bool is_valid) {
+    bool is_current = _keys.read([&key_name, &pkey](const KeyStore &keys) {
+        return keys.find(key_name) == pkey.get();
+    });
+    if (is_current) {
+        state.signature_cache.insert(digest, key_name, is_valid);
+    }
 }
 
-void SignatureVerifier::onEgressData(const std::shared_ptr<Face> &face, const ndn::Data &data) {
-    if (data.getSignature().getType() != ndn::tlv::SignatureTypeValue::DigestSha256) {
-        auto it = _pkeys.find(data.getSignature().getKeyLocator().getName());
-        if (it != _pkeys.end()) {
-            int result = verify(data.wireEncode().value(),
-                                data.wireEncode().value_size() - data.getSignature().getValue().size(),
-                                data.getSignature().getValue().value(), data.getSignature().getValue().value_size(),
-                                it->second);
-            if (result > 0) {
-                if (_report_enable) {
-                    _invalid_signature_packet_names.emplace(data.getName().toUri());
-                }
-                if (!_drop) {
-                    _tcp_ingress_master_face->sendToAllFaces(data);
-                    _udp_ingress_master_face->sendToAllFaces(data);
+void SignatureVerifier::deliver(CoreState &state, Direction direction, NdnPacket &&packet, bool is_forwarded, bool is_tagged) {
+    // also when the order was given up meanwhile, the Data pending are still forwarded first
+    if (!state.pending_data[direction].empty()) {
+        state.pending_data[direction].push_back(std::make_shared<PendingData>(std::move(packet), true, is_forwarded, is_tagged));
+    } else if (is_forwarded) {
+        forward(direction, packet, is_tagged);
+    }
+}
+
+void SignatureVerifier::flushPendingData(CoreState &state, Direction direction) {
+    auto &pending_data = state.pending_data[direction];
+    while (!pending_data.empty() && pending_data.front()->is_done) {
+        if (pending_data.front()->is_forwarded) {
+            forward(direction, pending_data.front()->packet, pending_data.front()->is_tagged);
+        }
+        pending_data.pop_front();
+    }
+}
+
+void SignatureVerifier::forward(Direction direction, const NdnPacket &packet, bool is_tagged) {
+    // the tag of this verifier, also on a Data trusted on the tag of another one, on the faces which carry it
+    std::shared_ptr<const ndn::Buffer> tagged_wire = is_tagged && _tagger ? _tagger->tag(packet) : nullptr;
+    if (direction == INGRESS) {
+        // a send only queues the packet on its face, whichever core it runs on
+        _egress_faces.read([&packet, &tagged_wire](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+            for (const auto &egress_face : egress_faces) {
+                if (tagged_wire && egress_face->carriesLpPacket(tagged_wire->size())) {
+                    egress_face->send(tagged_wire);
+                } else {
+                    egress_face->send(packet);
                 }
-            } else {
-                _tcp_ingress_master_face->sendToAllFaces(data);
-                _udp_ingress_master_face->sendToAllFaces(data);
             }
-        } else if (!_no_key_drop) {
-            _tcp_ingress_master_face->sendToAllFaces(data);
-            _udp_ingress_master_face->sendToAllFaces(data);
-        }
-    } else if (!_unsigned_drop) {
-        _tcp_ingress_master_face->sendToAllFaces(data);
-        _udp_ingress_master_face->sendToAllFaces(data);
+        });
+    } else {
+        std::shared_ptr<const ndn::Buffer> wire = packet.getWire();
+        std::shared_ptr<const ndn::Buffer> udp_wire = tagged_wire && tagged_wire->size() <= LpLink::getMtu() ? tagged_wire : wire;
+        _tcp_ingress_master_face->sendToAllFaces(tagged_wire ? tagged_wire : wire);
+        _mem_ingress_master_face->sendToAllFaces(wire);
+        // the faces of the UDP and SHM master faces are only walked from _ios, the packet may come from a core
+        _ios.post([this, wire, udp_wire]() {
+            _udp_ingress_master_face->sendToAllFaces(udp_wire);
+            _shm_ingress_master_face->sendToAllFaces(wire);
+        });
     }
 }
 
 void SignatureVerifier::onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << "new " << face->getUnderlyingProtocol() << " face with ID = " << face->getFaceId() << " form "
-       << master_face->getUnderlyingProtocol() << " master face with ID = " << master_face->getMasterFaceId();
-    logger::log(logger::INFO, ss.str());
+    logger::log(logger::INFO, "new {} face with ID = {} form {} master face with ID = {}",
+                {face->getUnderlyingProtocol(), face->getFaceId(), master_face->getUnderlyingProtocol(), master_face->getMasterFaceId()});
 }
 
 void SignatureVerifier::onMasterFaceError(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << face->getUnderlyingProtocol() << " face with ID = " << face->getFaceId() << " from "
-       << master_face->getUnderlyingProtocol() << " master face with ID = " << master_face->getMasterFaceId()
-       << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
+    logger::log(logger::ERROR, "{} face with ID = {} from {} master face with ID = {} can't process normally",
+                {face->getUnderlyingProtocol(), face->getFaceId(), master_face->getUnderlyingProtocol(), master_face->getMasterFaceId()});
 }
 
 void SignatureVerifier::onFaceError(const std::shared_ptr<Face> &face) {
-    std::stringstream ss;
-    ss << face->getUnderlyingProtocol() << " face with ID = " << face->getFaceId() << " can't process normally";
-    logger::log(logger::ERROR, ss.str());
-    for (auto& egress_face : _egress_faces) {
-        if(egress_face == face) {
-            std::swap(egress_face, _egress_faces.back());
-            _egress_faces.pop_back();
-            break;
+    logger::log(logger::ERROR, "{} face with ID = {} can't process normally",
+                {face->getUnderlyingProtocol(), face->getFaceId()});
+    _egress_faces.write([&face](std::vector<std::shared_ptr<Face>> &egress_faces) {
+        for (auto& egress_face : egress_faces) {
+            if(egress_face == face) {
+                std::swap(egress_face, egress_faces.back());
+                egress_faces.pop_back();
+                break;
+            }
         }
-    }
+    });
 }
 
 void SignatureVerifier::commandRead() {
@@ -147,52 +375,13 @@ void SignatureVerifier::commandRead() {
 }
 
 void SignatureVerifier::commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred) {
-    enum action_type {
-        EDIT_CONFIG,
-        ADD_FACE,
-        DEL_FACE,
-        ADD_KEYS,
-        DEL_KEYS,
-        LIST
-    };
-
-    static const std::unordered_map<std::string, action_type> ACTIONS = {
-            {"edit_config", EDIT_CONFIG},
-            {"add_face", ADD_FACE},
-            {"del_face", DEL_FACE},
-            {"add_keys", ADD_KEYS},
-            {"del_keys", DEL_KEYS},
-            {"list", LIST},
-    };
-
     if(!err) {
         try {
             rapidjson::Document document;
             document.Parse(_command_buffer, bytes_transferred);
             if(!document.HasParseError()){
                 if(document.HasMember("action") && document["action"].IsString() && document.HasMember("id") && document["id"].IsUint()){
-                    auto it = ACTIONS.find(document["action"].GetString());
-                    if(it != ACTIONS.end()) {
-                        switch (it->second) {
-                            case EDIT_CONFIG:
-                                commandEditConfig(document);
-                                break;
-                            case ADD_FACE:
-                                commandAddFace(document);
-                                break;
-                            case DEL_FACE:
-                                commandDelFace(document);
-                                break;
-                            case ADD_KEYS:
-                                commandAddKeys(document);
-                                break;
-                            case DEL_KEYS:
-                                commandDelKeys(document);
-                                break;
-                            case LIST:
-                                commandList(document);
-                        }
-                    }
+                    executeCommand(document);
                 } else{
                     //std::string response = R"({"status":"fail", "reason":"action not provided or not implemented"})";
                     //_command_socket.send_to(boost::asio::buffer(response), _remote_command_endpoint);
@@ -211,6 +400,71 @@ void SignatureVerifier::commandReadHandler(const boost::system::error_code &err,
     }
 }
 
+void SignatureVerifier::executeCommand(const rapidjson::Document &document) {
+    enum action_type {
+        EDIT_CONFIG,
+        ADD_FACE,
+        DEL_FACE,
+        ADD_KEYS,
+        DEL_KEYS,
+        ADD_TRUST_RULES,
+        DEL_TRUST_RULES,
+        LIST,
+        MEMORY_STATS,
+        PROFILE
+    };
+
+    static const std::unordered_map<std::string, action_type> ACTIONS = {
+            {"edit_config", EDIT_CONFIG},
+            {"add_face", ADD_FACE},
+            {"del_face", DEL_FACE},
+            {"add_keys", ADD_KEYS},
+            {"del_keys", DEL_KEYS},
+            {"add_trust_rules", ADD_TRUST_RULES},
+            {"del_trust_rules", DEL_TRUST_RULES},
+            {"list", LIST},
+            {"memory_stats", MEMORY_STATS},
+            {"profile", PROFILE},
+    };
+
+    auto it = ACTIONS.find(document["action"].GetString());
+    if (it == ACTIONS.end()) {
+        return;
+    }
+    switch (it->second) {
+        case EDIT_CONFIG:
+            commandEditConfig(document);
+            break;
+        case ADD_FACE:
+            commandAddFace(document);
+            break;
+        case DEL_FACE:
+            commandDelFace(document);
+            break;
+        case ADD_KEYS:
+            commandAddKeys(document);
+            break;
+        case DEL_KEYS:
+            commandDelKeys(document);
+            break;
+        case ADD_TRUST_RULES:
+            commandAddTrustRules(document);
+            break;
+        case DEL_TRUST_RULES:
+            commandDelTrustRules(document);
+            break;
+        case LIST:
+            commandList(document);
+            break;
+        case MEMORY_STATS:
+            commandMemoryStats(document);
+            break;
+        case PROFILE:
+            commandProfile(document);
+            break;
+    }
+}
+
 void SignatureVerifier::commandEditConfig(const rapidjson::Document &document) {
     std::vector<std::string> changes;
     if (document.HasMember("manager_address") && document.HasMember("manager_port") && document["manager_address"].IsString() && document["manager_port"].IsUint()) {
@@ -277,6 +531,347 @@ void SignatureVerifier::commandEditConfig(const rapidjson::Document &document) {
             changes.emplace_back("unsigned_drop");
         }
     }
+    if (document.HasMember("verify_threads") && document["verify_threads"].IsUint()) {
+        bool has_change = false;
+        size_t verify_threads = document["verify_threads"].GetUint();
+        std::shared_ptr<VerifierPool> verifier_pool = std::atomic_load(&_verifier_pool);
+        if (verify_threads != (verifier_pool ? verifier_pool->size() : 0)) {
+            // the checks queued on the former pool are made before the last thread using it lets it go, their Data
+            // are forwarded as usual
+            std::atomic_store(&_verifier_pool, verify_threads > 0 ? std::make_shared<VerifierPool>(verify_threads)
+                                                                  : std::shared_ptr<VerifierPool>());
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("verify_threads");
+        }
+    }
+    if (document.HasMember("verify_in_order") && document["verify_in_order"].IsBool()) {
+        bool has_change = false;
+        bool verify_in_order = document["verify_in_order"].GetBool();
+        if (_verify_in_order != verify_in_order) {
+            _verify_in_order = verify_in_order;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("verify_in_order");
+        }
+    }
+    if (document.HasMember("key_lookup_cache") && document["key_lookup_cache"].IsBool()) {
+        bool has_change = false;
+        bool is_caching_keys = document["key_lookup_cache"].GetBool();
+        if (_is_caching_keys != is_caching_keys) {
+            _is_caching_keys = is_caching_keys;
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("key_lookup_cache");
+        }
+    }
+    if (document.HasMember("signature_cache_size") && document["signature_cache_size"].IsUint()) {
+        bool has_change = false;
+        size_t signature_cache_size = document["signature_cache_size"].GetUint();
+        if (signature_cache_size != _signature_cache_size) {
+            _signature_cache_size = signature_cache_size;
+            forEachCoreState([signature_cache_size](CoreState &state) {
+                state.signature_cache.setMaxSize(signature_cache_size);
+            });
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("signature_cache_size");
+        }
+    }
+    if (document.HasMember("signature_cache_ttl") && document["signature_cache_ttl"].IsUint()) {
+        bool has_change = false;
+        size_t signature_cache_ttl = document["signature_cache_ttl"].GetUint();
+        if (signature_cache_ttl != _signature_cache_ttl) {
+            _signature_cache_ttl = signature_cache_ttl;
+            forEachCoreState([signature_cache_ttl](CoreState &state) {
+                state.signature_cache.setTtl(signature_cache_ttl);
+            });
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("signature_cache_ttl");
+        }
+    }
+    if (document.HasMember("sampling_ratio") && document["sampling_ratio"].IsNumber()) {
+        bool has_change = false;
+        double sampling_ratio = document["sampling_ratio"].GetDouble();
+        if (sampling_ratio != _sampling_ratio) {
+            _sampling_ratio = sampling_ratio;
+            forEachCoreState([sampling_ratio](CoreState &state) {
+                state.sampling.setRatio(sampling_ratio);
+            });
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("sampling_ratio");
+        }
+    }
+    if (document.HasMember("sampling_prefix_length") && document["sampling_prefix_length"].IsUint()) {
+        bool has_change = false;
+        size_t sampling_prefix_length = document["sampling_prefix_length"].GetUint();
+        if (sampling_prefix_length != _sampling_prefix_length) {
+            _sampling_prefix_length = sampling_prefix_length;
+            forEachCoreState([sampling_prefix_length](CoreState &state) {
+                state.sampling.setPrefixLength(sampling_prefix_length);
+            });
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("sampling_prefix_length");
+        }
+    }
+    if (document.HasMember("sampling_quiet_period") && document["sampling_quiet_period"].IsUint()) {
+        bool has_change = false;
+        size_t sampling_quiet_period = document["sampling_quiet_period"].GetUint();
+        if (sampling_quiet_period != _sampling_quiet_period) {
+            _sampling_quiet_period = sampling_quiet_period;
+            forEachCoreState([sampling_quiet_period](CoreState &state) {
+                state.sampling.setQuietPeriod(sampling_quiet_period);
+            });
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("sampling_quiet_period");
+        }
+    }
+    if (document.HasMember("overload_lag") && document["overload_lag"].IsUint()) {
+        bool has_change = false;
+        size_t overload_lag = document["overload_lag"].GetUint();
+        if (overload_lag != _overload_lag) {
+            _overload_lag = overload_lag;
+            forEachCoreState([overload_lag](CoreState &state) {
+                state.loop_monitor.setThreshold(overload_lag);
+            });
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("overload_lag");
+        }
+    }
+    if (document.HasMember("report_top") && document["report_top"].IsUint()) {
+        bool has_change = false;
+        size_t report_top = document["report_top"].GetUint();
+        if (report_top != _report_top) {
+            _report_top = report_top;
+            forEachCoreState([report_top](CoreState &state) {
+                state.invalid_signatures.setTop(report_top);
+            });
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("report_top");
+        }
+    }
+    if (document.HasMember("report_prefix_length") && document["report_prefix_length"].IsUint()) {
+        bool has_change = false;
+        size_t report_prefix_length = document["report_prefix_length"].GetUint();
+        if (report_prefix_length != _report_prefix_length) {
+            _report_prefix_length = report_prefix_length;
+            forEachCoreState([report_prefix_length](CoreState &state) {
+                state.invalid_signatures.setPrefixLength(report_prefix_length);
+            });
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("report_prefix_length");
+        }
+    }
+    if (document.HasMember("tcp_gather_bytes") && document["tcp_gather_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["tcp_gather_bytes"].GetUint();
+        if (max_bytes != TcpFace::getGatherMaxBytes()) {
+            TcpFace::setGatherMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_bytes");
+        }
+    }
+    if (document.HasMember("tcp_gather_packets") && document["tcp_gather_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["tcp_gather_packets"].GetUint();
+        if (max_packets != TcpFace::getGatherMaxPackets()) {
+            TcpFace::setGatherMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_gather_packets");
+        }
+    }
+    if (document.HasMember("tcp_max_packet_size") && document["tcp_max_packet_size"].IsUint()) {
+        bool has_change = false;
+        size_t size = document["tcp_max_packet_size"].GetUint();
+        if (size != TcpFace::getMaxPacketSize()) {
+            has_change = TcpFace::setMaxPacketSize(size);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_max_packet_size");
+        }
+    }
+    if (document.HasMember("tcp_flush") && document["tcp_flush"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_flush"].GetString();
+        if (policy != TcpFace::getFlushPolicy()) {
+            has_change = TcpFace::setFlushPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_flush");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_min_delay") && document["tcp_reconnect_min_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_min_delay"].GetUint();
+        if (value != TcpFace::getReconnectMinDelay()) {
+            TcpFace::setReconnectMinDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_min_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_max_delay") && document["tcp_reconnect_max_delay"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_max_delay"].GetUint();
+        if (value != TcpFace::getReconnectMaxDelay()) {
+            TcpFace::setReconnectMaxDelay(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_max_delay");
+        }
+    }
+    if (document.HasMember("tcp_reconnect_attempts") && document["tcp_reconnect_attempts"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_reconnect_attempts"].GetUint();
+        if (value != TcpFace::getReconnectAttempts()) {
+            TcpFace::setReconnectAttempts(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_reconnect_attempts");
+        }
+    }
+    if (document.HasMember("tcp_replay_max_age") && document["tcp_replay_max_age"].IsUint()) {
+        bool has_change = false;
+        size_t value = document["tcp_replay_max_age"].GetUint();
+        if (value != TcpFace::getReplayMaxAge()) {
+            TcpFace::setReplayMaxAge(value);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_replay_max_age");
+        }
+    }
+    if (document.HasMember("tcp_credit_window") && document["tcp_credit_window"].IsUint()) {
+        bool has_change = false;
+        size_t window = document["tcp_credit_window"].GetUint();
+        if (window != TcpFace::getCreditWindow()) {
+            TcpFace::setCreditWindow(window);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_window");
+        }
+    }
+    if (document.HasMember("tcp_credit_policy") && document["tcp_credit_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["tcp_credit_policy"].GetString();
+        if (policy != TcpFace::getCreditPolicy()) {
+            has_change = TcpFace::setCreditPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("tcp_credit_policy");
+        }
+    }
+    if (document.HasMember("udp_mtu") && document["udp_mtu"].IsUint()) {
+        bool has_change = false;
+        size_t mtu = document["udp_mtu"].GetUint();
+        if (mtu != LpLink::getMtu()) {
+            LpLink::setMtu(mtu);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_mtu");
+        }
+    }
+    if (document.HasMember("udp_aggregation") && document["udp_aggregation"].IsBool()) {
+        bool has_change = false;
+        bool aggregation = document["udp_aggregation"].GetBool();
+        if (aggregation != LpLink::getAggregation()) {
+            LpLink::setAggregation(aggregation);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("udp_aggregation");
+        }
+    }
+    if (document.HasMember("connection_pool") && _connection_pool.update(document["connection_pool"])) {
+        changes.emplace_back("connection_pool");
+    }
+    if (document.HasMember("socket_options")) {
+        bool has_change = false;
+        // the default of the faces created from now on, the ingress master faces change theirs at once
+        SocketOptions options = SocketOptions::getDefault();
+        if (options.update(document["socket_options"]) && options != SocketOptions::getDefault()) {
+            SocketOptions::setDefault(options);
+            for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face}) {
+                master_face->setSocketOptions(options);
+            }
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("socket_options");
+        }
+    }
+    if (document.HasMember("queue_max_packets") && document["queue_max_packets"].IsUint()) {
+        bool has_change = false;
+        size_t max_packets = document["queue_max_packets"].GetUint();
+        if (max_packets != QueuePolicy::getMaxPackets()) {
+            QueuePolicy::setMaxPackets(max_packets);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_packets");
+        }
+    }
+    if (document.HasMember("queue_max_bytes") && document["queue_max_bytes"].IsUint()) {
+        bool has_change = false;
+        size_t max_bytes = document["queue_max_bytes"].GetUint();
+        if (max_bytes != QueuePolicy::getMaxBytes()) {
+            QueuePolicy::setMaxBytes(max_bytes);
+            has_change = true;
+        }
+        if (has_change) {
+            changes.emplace_back("queue_max_bytes");
+        }
+    }
+    if (document.HasMember("queue_drop_policy") && document["queue_drop_policy"].IsString()) {
+        bool has_change = false;
+        std::string policy = document["queue_drop_policy"].GetString();
+        if (policy != QueuePolicy::getDropPolicyName()) {
+            has_change = QueuePolicy::setDropPolicy(policy);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_drop_policy");
+        }
+    }
+    if (document.HasMember("queue_scheduler") && document["queue_scheduler"].IsString()) {
+        bool has_change = false;
+        std::string scheduler = document["queue_scheduler"].GetString();
+        if (scheduler != QueuePolicy::getSchedulerName()) {
+            has_change = QueuePolicy::setScheduler(scheduler);
+        }
+        if (has_change) {
+            changes.emplace_back("queue_scheduler");
+        }
+    }
+    if (document.HasMember("queue_classes") && QueuePolicy::setClasses(document["queue_classes"])) {
+        changes.emplace_back("queue_classes");
+    }
 
     std::stringstream ss;
     ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"edit_config", "changes":[)";
@@ -297,11 +892,15 @@ void SignatureVerifier::commandAddFace(const rapidjson::Document &document) {
     enum layer_type {
         TCP,
         UDP,
+        SHM,
+        MEM,
     };
 
     static const std::unordered_map<std::string, layer_type> LAYERS = {
             {"tcp", TCP},
             {"udp", UDP},
+            {"shm", SHM},
+            {"mem", MEM},
     };
 
     if (document.HasMember("layer") && document.HasMember("address") && document.HasMember("port")
@@ -311,16 +910,36 @@ void SignatureVerifier::commandAddFace(const rapidjson::Document &document) {
             std::shared_ptr<Face> face;
             switch (it->second) {
                 case TCP:
-                    face = std::make_shared<TcpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    if (document.HasMember("connections") && document["connections"].IsUint() && document["connections"].GetUint() > 1) {
+                        // striped by Name over that many connections
+                        face = std::make_shared<StripedTcpFace>(nextCoreService(), _connection_pool, document["address"].GetString(),
+                                                                document["port"].GetUint(), document["connections"].GetUint());
+                    } else {
+                        face = _connection_pool.makeFace(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
+                    }
                     break;
                 case UDP:
-                    face = std::make_shared<UdpFace>(_ios, document["address"].GetString(), document["port"].GetUint());
+                    face = std::make_shared<UdpFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
+                    break;
+                case SHM:
+                    face = std::make_shared<ShmFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
+                    break;
+                case MEM:
+                    face = std::make_shared<MemoryFace>(nextCoreService(), document["address"].GetString(), document["port"].GetUint());
                     break;
             }
-            face->open(boost::bind(&SignatureVerifier::onEgressInterest, this, _1, _2),
-                       boost::bind(&SignatureVerifier::onEgressData, this, _1, _2),
+            if (document.HasMember("socket_options")) {
+                // on top of the default, before open for the buffers of a TCP connection
+                SocketOptions options = SocketOptions::getDefault();
+                if (options.update(document["socket_options"])) {
+                    face->setSocketOptions(options);
+                }
+            }
+            face->open(PacketHandler::bind<SignatureVerifier, &SignatureVerifier::onEgressPacket>(this),
                        boost::bind(&SignatureVerifier::onFaceError, this, _1));
-            _egress_faces.push_back(face);
+            _egress_faces.write([&face](std::vector<std::shared_ptr<Face>> &egress_faces) {
+                egress_faces.push_back(face);
+            });
             std::stringstream ss;
             ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_face", "face_id":)" << face->getFaceId() << "}";
             _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
@@ -331,15 +950,26 @@ void SignatureVerifier::commandAddFace(const rapidjson::Document &document) {
 void SignatureVerifier::commandDelFace(const rapidjson::Document &document) {
     if (document.HasMember("face_id") && document["face_id"].IsUint()) {
         size_t face_id = document["face_id"].GetUint();
-        bool ok = false;
-        for (auto& egress_face : _egress_faces) {
-            if (egress_face->getFaceId() == face_id) {
-                egress_face->close();
-                std::swap(egress_face, _egress_faces.back());
-                _egress_faces.pop_back();
-                ok = true;
-                break;
+        std::shared_ptr<Face> face = _egress_faces.read([face_id](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+            for (const auto& egress_face : egress_faces) {
+                if (egress_face->getFaceId() == face_id) {
+                    return egress_face;
+                }
             }
+            return std::shared_ptr<Face>();
+        });
+        bool ok = face != nullptr;
+        if (ok) {
+            face->close();
+            _egress_faces.write([&face](std::vector<std::shared_ptr<Face>> &egress_faces) {
+                for (auto& egress_face : egress_faces) {
+                    if (egress_face == face) {
+                        std::swap(egress_face, egress_faces.back());
+                        egress_faces.pop_back();
+                        break;
+                    }
+                }
+            });
         }
         std::stringstream ss;
         ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_face", "face_id":)" << face_id << R"(, "status":)" << ok << "}";
@@ -361,13 +991,17 @@ void SignatureVerifier::commandAddKeys(const rapidjson::Document &document) {
                     auto key_info = key.GetArray();
                     if (key_info.Size() == 3 && key_info[0].IsString() && key_info[1].IsString() && key_info[2].IsString()) {
                         ndn::Name key_name(key_info[0].GetString());
-                        auto it = _pkeys.find(key_name);
-                        if (it == _pkeys.end()) {
+                        bool is_known = _keys.read([&key_name](const KeyStore &keys) {
+                            return keys.find(key_name) != nullptr;
+                        });
+                        if (!is_known) {
                             std::stringstream ss1;
-                            std::string blob = key_info[2].GetString();
-                            EVP_PKEY *pkey = PEM_read_bio_PUBKEY(BIO_new_mem_buf(blob.c_str(), blob.size()), NULL, NULL, NULL);
-                            if (pkey != nullptr) {
-                                _pkeys.emplace(key_name, pkey);
+                            // the PEM is read once, both copies of the store share the key
+                            std::shared_ptr<EVP_PKEY> pkey = KeyStore::readKey(key_info[2].GetString());
+                            if (pkey) {
+                                _keys.write([&key_name, &pkey](KeyStore &keys) {
+                                    keys.add(key_name, pkey);
+                                });
                                 ss1 << "key " << key_name << " added by manager";
                                 status.emplace_back("success");
                             } else {
@@ -406,11 +1040,14 @@ void SignatureVerifier::commandDelKeys(const rapidjson::Document &document) {
             for (auto &key : keys) {
                 if (key.IsString()) {
                     ndn::Name key_name(key.GetString());
-                    auto it = _pkeys.find(key_name);
-                    if (it != _pkeys.end()) {
-                        EVP_PKEY *pkey = it->second;
-                        _pkeys.erase(key_name);
-                        EVP_PKEY_free(pkey);
+                    bool is_removed = false;
+                    _keys.write([&key_name, &is_removed](KeyStore &keys) {
+                        is_removed = keys.remove(key_name);
+                    });
+                    if (is_removed) {
+                        forEachCoreState([&key_name](CoreState &state) {
+                            state.signature_cache.remove(key_name);
+                        });
                         std::stringstream ss1;
                         ss1 << "key with name " << key_name << " removed by manager";
                         logger::log(logger::INFO, ss1.str());
@@ -423,38 +1060,216 @@ void SignatureVerifier::commandDelKeys(const rapidjson::Document &document) {
     }
 }
 
+void SignatureVerifier::commandAddTrustRules(const rapidjson::Document &document) {
+    if (document.HasMember("rules") && document["rules"].IsArray()) {
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"add_trust_rules", )";
+        auto &&rules = document["rules"].GetArray();
+        if (rules.Empty()) {
+            ss << R"("status":"fail", "reason":"empty rule list"})";
+        } else {
+            std::vector<std::string> status;
+            for (auto &rule : rules) {
+                if (rule.IsArray() && rule.Size() == 2 && rule[0].IsString() && rule[1].IsString()) {
+                    ndn::Name prefix(rule[0].GetString());
+                    ndn::Name anchor(rule[1].GetString());
+                    _keys.write([&prefix, &anchor](KeyStore &keys) {
+                        keys.addTrustRule(prefix, anchor);
+                    });
+                    std::stringstream ss1;
+                    ss1 << "key names under " << prefix << " checked with anchor " << anchor << " by manager";
+                    logger::log(logger::INFO, ss1.str());
+                    status.emplace_back("success");
+                } else {
+                    status.emplace_back("fail");
+                }
+            }
+            ss << R"("status":[)";
+            bool first = true;
+            for(const auto& s : status) {
+                if (first) {
+                    first = false;
+                } else {
+                    ss << ",";
+                }
+                ss << '"' << s << '"';
+            }
+            ss << "]}";
+        }
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    }
+}
+
+void SignatureVerifier::commandDelTrustRules(const rapidjson::Document &document) {
+    if (document.HasMember("rules") && document["rules"].IsArray()) {
+        std::stringstream ss;
+        ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"del_trust_rules", )";
+        auto &&rules = document["rules"].GetArray();
+        if (rules.Empty()) {
+            ss << R"("status":"fail", "reason":"empty rule list"})";
+        } else {
+            std::vector<std::string> status;
+            for (auto &rule : rules) {
+                // the verdicts cached stay, the Data under the prefix no longer find a key before the cache is looked up
+                bool is_removed = false;
+                if (rule.IsString()) {
+                    ndn::Name prefix(rule.GetString());
+                    _keys.write([&prefix, &is_removed](KeyStore &keys) {
+                        is_removed = keys.removeTrustRule(prefix);
+                    });
+                }
+                if (is_removed) {
+                    std::stringstream ss1;
+                    ss1 << "trust rule for " << rule.GetString() << " removed by manager";
+                    logger::log(logger::INFO, ss1.str());
+                    status.emplace_back("success");
+                } else {
+                    status.emplace_back("fail");
+                }
+            }
+            ss << R"("status":[)";
+            bool first = true;
+            for(const auto& s : status) {
+                if (first) {
+                    first = false;
+                } else {
+                    ss << ",";
+                }
+                ss << '"' << s << '"';
+            }
+            ss << "]}";
+        }
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+    }
+}
+
+void SignatureVerifier::commandMemoryStats(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    MemoryStats stats;
+    MemoryStats instance;
+    _keys.read([&instance](const KeyStore &key_store) {
+        key_store.addMemoryStats(instance, "keys");
+    });
+    stats.add(instance, 2);
+    forEachCoreState([&stats](CoreState &state) {
+        stats.add("signature_cache", state.signature_cache.size(), state.signature_cache.getMemoryUsage());
+        stats.add("sampling_alerts", state.sampling.getAlerts(), state.sampling.getMemoryUsage());
+        stats.add("invalid_signatures", 1, state.invalid_signatures.getMemoryUsage());
+        size_t pending = 0;
+        size_t pending_bytes = 0;
+        for (const auto &pending_data : state.pending_data) {
+            pending += pending_data.size();
+            pending_bytes += memory_usage::of(pending_data) + pending_data.size() * memory_usage::ofShared<PendingData>();
+        }
+        stats.add("pending_data", pending, pending_bytes);
+    });
+    _egress_faces.read([&stats](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+        for (const auto &face : egress_faces) {
+            face->addMemoryStats(stats);
+        }
+    });
+    _tcp_ingress_master_face->addMemoryStats(stats);
+    _udp_ingress_master_face->addMemoryStats(stats);
+    _shm_ingress_master_face->addMemoryStats(stats);
+    _mem_ingress_master_face->addMemoryStats(stats);
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint() << R"(, "action":"memory_stats", "memory":)"
+       << stats.toJSON() << "}";
+    _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+}
+
+void SignatureVerifier::commandProfile(const rapidjson::Document &document) {
+    uint64_t id = document["id"].GetUint();
+    size_t duration = document.HasMember("duration") && document["duration"].IsUint() ? document["duration"].GetUint() : sampling_profiler::DEFAULT_DURATION_MS;
+    size_t frequency = document.HasMember("frequency") && document["frequency"].IsUint() ? document["frequency"].GetUint() : sampling_profiler::DEFAULT_FREQUENCY;
+    std::stringstream ss;
+    ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << id << R"(, "action":"profile", )";
+    if (!sampling_profiler::start(frequency, duration)) {
+        ss << R"("status":"fail", "reason":"a profile is running or the timer can't be set"})";
+        _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
+        return;
+    }
+    logger::log(logger::INFO, "profiling for {}ms", {std::min(duration, sampling_profiler::MAX_DURATION_MS)});
+    boost::asio::ip::udp::endpoint endpoint = _remote_command_endpoint;
+    // the cores go on verifying meanwhile, the stacks are folded on the command thread
+    auto timer = std::make_shared<boost::asio::deadline_timer>(_ios, boost::posix_time::milliseconds(std::min(duration, sampling_profiler::MAX_DURATION_MS)));
+    std::string reply = ss.str();
+    timer->async_wait([this, timer, reply, endpoint](const boost::system::error_code &err) {
+        _command_socket.send_to(boost::asio::buffer(reply + R"("status":"success", "profile":)" + sampling_profiler::stop(sampling_profiler::DATAGRAM_BYTES) + "}"), endpoint);
+    });
+}
+
 void SignatureVerifier::commandList(const rapidjson::Document &document) {
+    stage_profile::Scope stage(stage_profile::REPORT);
+    size_t keys = 0;
+    size_t trust_rules = 0;
+    _keys.read([&keys, &trust_rules](const KeyStore &key_store) {
+        keys = key_store.size();
+        trust_rules = key_store.getTrustRuleCount();
+    });
+    std::shared_ptr<VerifierPool> verifier_pool = std::atomic_load(&_verifier_pool);
+    Verdicts verdicts;
+    size_t pending_data = 0;
+    std::stringstream threads;
+    bool first = true;
+    forEachCoreState([&verdicts, &pending_data, &threads, &first](CoreState &state) {
+        verdicts.add(state.verdicts);
+        pending_data += state.pending_data[INGRESS].size() + state.pending_data[EGRESS].size();
+        if (first) {
+            first = false;
+        } else {
+            threads << ", ";
+        }
+        threads << R"({"signature_cache":)" << state.signature_cache.toJSON() << R"(, "sampling":)" << state.sampling.toJSON()
+                << R"(, "loop":)" << state.loop_monitor.toJSON() << "}";
+    });
     std::stringstream ss;
     ss << R"({"name":")" << _name << R"(", "type":"reply", "id":)" << document["id"].GetUint()
        << R"(, "action":"list", "manager_address":")" << _manager_endpoint.address() << R"(", "manager_port":)" << _manager_endpoint.port()
-       << R"(, "drop":)" << _drop << R"(, "no_key_drop":)" << _no_key_drop << R"(, "unsigned_drop":)" << _unsigned_drop << "}";
+       << R"(, "drop":)" << _drop << R"(, "no_key_drop":)" << _no_key_drop << R"(, "unsigned_drop":)" << _unsigned_drop
+       << R"(, "keys":)" << keys << R"(, "trust_rules":)" << trust_rules << R"(, "concurrency":)" << _concurrency
+       << R"(, "verify_threads":)" << (verifier_pool ? verifier_pool->size() : 0) << R"(, "verify_in_order":)" << _verify_in_order
+       << R"(, "key_lookup_cache":)" << _is_caching_keys       << R"(, "overload_lag":)" << _overload_lag << R"(, "pending_data":)" << pending_data << R"(, "verdicts":)" << verdicts.toJSON()
+       << R"(, "threads":[)" << threads.str() << "]";
+    ss << R"(, "faces":[)";
+    first = true;
+    _egress_faces.read([&ss, &first](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+        for (const auto &face : egress_faces) {
+            if (first) {
+                first = false;
+            } else {
+                ss << ", ";
+            }
+            ss << face->toJSON();
+        }
+    });
+    ss << R"(], "master_faces":[)" << _tcp_ingress_master_face->toJSON() << ", " << _udp_ingress_master_face->toJSON() << ", " << _shm_ingress_master_face->toJSON() << ", " << _mem_ingress_master_face->toJSON() << "]"
+       << R"(, "connection_pool":)" << _connection_pool.toJSON() << R"(, "buffer_pool":)" << BufferPool::getStats().toJSON() << R"(, "stages":)" << stage_profile::toJSON() << "}";
     _command_socket.send_to(boost::asio::buffer(ss.str()), _remote_command_endpoint);
 }
 
 void SignatureVerifier::commandReport(const boost::system::error_code &err) {
     if (!err) {
-        std::set<std::string> current;
-        std::swap(current, _invalid_signature_packet_names);
-        if (!current.empty() && _manager_endpoint.address() != boost::asio::ip::address_v4::any() && _manager_endpoint.port() != 0) {
-            std::stringstream ss;
-            ss << R"({"type":"report", "name":")" << _name << R"(", "action":"invalid_signature", "invalid_signature_names":[)";
-            size_t rank = 0;
-            for (const auto &name : current) {
-                if (name.length() + ss.tellp() + 6 < 65500) {
-                    if (rank) {
-                        ss << ", ";
-                    }
-                    ss << "\"" << name << "\"";
-                    ++rank;
-                } else {
-                    ss << "]}";
-                    _command_socket.send_to(boost::asio::buffer(ss.str()), _manager_endpoint);
-                    ss.str("");
-                    ss << R"({"type":"report", "name":")" << _name << R"(", "action":"invalid_signature", "invalid_signature_packet_names":[)";
-                    rank = 0;
-                }
+        stage_profile::Scope stage(stage_profile::REPORT);
+        // the cores are merged into a single datagram of bounded size whatever the number of invalid signatures
+        InvalidSignatureReport invalid_signatures(_report_top, _report_prefix_length);
+        Verdicts verdicts;
+        std::string signature_cache;
+        forEachCoreState([&invalid_signatures, &verdicts, &signature_cache](CoreState &state) {
+            invalid_signatures.add(state.invalid_signatures);
+            state.invalid_signatures.clear();
+            verdicts.add(state.verdicts);
+            if (signature_cache.empty()) {
+                signature_cache = state.signature_cache.toJSON();
             }
-            ss << "]}";
+        });
+        if (!invalid_signatures.empty() && _manager_endpoint.address() != boost::asio::ip::address_v4::any() && _manager_endpoint.port() != 0) {
+            std::string verdicts_json = verdicts.toJSON();
+            std::string stages = stage_profile::toJSON();
+            std::stringstream ss;
+            ss << R"({"type":"report", "name":")" << _name << R"(", "action":"invalid_signature", )"
+               << invalid_signatures.toJSONMembers(65000 - signature_cache.size() - verdicts_json.size() - stages.size() - _name.size())
+               << R"(, "verdicts":)" << verdicts_json << R"(, "signature_cache":)" << signature_cache << R"(, "stages":)" << stages << "}";
             _command_socket.send_to(boost::asio::buffer(ss.str()), _manager_endpoint);
         }
         if (_report_enable) {
@@ -464,43 +1279,31 @@ void SignatureVerifier::commandReport(const boost::system::error_code &err) {
     }
 }
 
-// from openssl example
-int SignatureVerifier::verify(const unsigned char* msg, size_t mlen, const unsigned char* sig, size_t slen, EVP_PKEY* pkey) {
-    /* Returned to caller */
-    int result = -1;
-    if (!msg || !mlen || !sig || !slen || !pkey) {
-        //printf("a least one of the parameters is undefined\n");
-        return result;
-    }
-    EVP_MD_CTX *ctx = NULL;
-    do {
-        ctx = EVP_MD_CTX_create();
-        if (ctx == NULL) {
-            break; /* failed */
+void SignatureVerifier::writeMetrics(MetricsWriter &writer) {
+    _egress_faces.read([&writer](const std::vector<std::shared_ptr<Face>> &egress_faces) {
+        for (const auto &face : egress_faces) {
+            face->writeMetrics(writer);
         }
-        int rc = EVP_DigestInit_ex(ctx, EVP_sha256(), NULL);
-        if (rc != 1) {
-            break; /* failed */
-        }
-        rc = EVP_DigestVerifyInit(ctx, NULL, EVP_sha256(), NULL, pkey);
-        if (rc != 1) {
-            break; /* failed */
-        }
-        rc = EVP_DigestVerifyUpdate(ctx, msg, mlen);
-        if (rc != 1) {
-            break; /* failed */
-        }
-        /* Clear any errors for the call below */
-        ERR_clear_error();
-        rc = EVP_DigestVerifyFinal(ctx, sig, slen);
-        if (rc != 1) {
-            break; /* failed */
-        }
-        result = 0;
-    } while (0);
-    if (ctx) {
-        EVP_MD_CTX_destroy(ctx);
-        ctx = NULL;
+    });
+    for (const auto &master_face : {_tcp_ingress_master_face, _udp_ingress_master_face, _shm_ingress_master_face, _mem_ingress_master_face}) {
+        master_face->writeMetrics(writer);
+    }
+    BufferPool::getStats().writeMetrics(writer);
+    stage_profile::writeMetrics(writer);
+    Verdicts verdicts;
+    size_t pending_data = 0;
+    size_t core = 0;
+    forEachCoreState([&writer, &verdicts, &pending_data, &core](CoreState &state) {
+        verdicts.add(state.verdicts);
+        pending_data += state.pending_data[INGRESS].size() + state.pending_data[EGRESS].size();
+        state.loop_monitor.writeMetrics(writer, {{"core", std::to_string(core++)}});
+    });
+    const std::pair<const char*, size_t> outcomes[] = {
+            {"valid", verdicts.valid}, {"invalid", verdicts.invalid}, {"no_key", verdicts.no_key},
+            {"unsigned", verdicts.unsigned_data}, {"skipped", verdicts.skipped}, {"shed", verdicts.shed},
+            {"trusted", verdicts.trusted}};
+    for (const auto &outcome : outcomes) {
+        writer.counter("ndn_signature_verdicts_total", "Data by the outcome of their check", {{"verdict", outcome.first}}, outcome.second);
     }
-    return !!result;
+    writer.gauge("ndn_signature_pending_data", "Data held for their check or for the order", {}, pending_data);
 }
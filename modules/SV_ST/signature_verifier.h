@@ -10,57 +10,212 @@
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <queue>
 #include <map>
 #include <set>
+#include <vector>
 
 #include "rapidjson/document.h"
 
-#include "module.h"
+#include "runtime/core_module.h"
+#include "management/startup_config.h"
+#include "network/loop_monitor.h"
 #include "network/master_face.h"
 #include "network/face.h"
+#include "network/tcp_connection_pool.h"
+#include "security/key_store.h"
+#include "tree/flow_cache.h"
+#include "tree/left_right.h"
 #include "rapidjson/document.h"
+#include "invalid_signature_report.h"
+#include "sampling_policy.h"
+#include "signature_cache.h"
+#include "verified_tagger.h"
+#include "verifier_pool.h"
 
-class SignatureVerifier : public Module {
+// threads: each face runs on one core service (-j), the state of a core is in its CoreState and the faces lists and
+// the keys are shared through LeftRight, the options are atomic and the commands run on _ios
+class SignatureVerifier : public CoreModule {
 private:
+    enum Direction {
+        INGRESS,
+        EGRESS,
+    };
+
+    // a Data checked by the pool, or received behind one, while the Data are forwarded in the order received
+    struct PendingData {
+        NdnPacket packet;
+        bool is_done;
+        bool is_forwarded;
+        // found valid, the Data goes with a Verified tag
+        bool is_tagged;
+
+        PendingData(NdnPacket &&packet, bool is_done, bool is_forwarded, bool is_tagged = false)
+                : packet(std::move(packet))
+                , is_done(is_done)
+                , is_forwarded(is_forwarded)
+                , is_tagged(is_tagged) {
+
+        }
+    };
+
+    // how many Data got each outcome
+    struct Verdicts {
+        size_t valid = 0;
+        size_t invalid = 0;
+        size_t no_key = 0;
+        size_t unsigned_data = 0;
+        size_t skipped = 0;
+        // not checked while the loop of their core was overloaded, forwarded as the Data not sampled
+        size_t shed = 0;
+        // not checked either, a verifier before this one tagged them as valid
+        size_t trusted = 0;
+
+        void add(const Verdicts &other);
+
+        std::string toJSON() const;
+    };
+
+    // the key a KeyLocator resolved to, null if none, and its name in the store
+    struct KeyLookup {
+        std::shared_ptr<EVP_PKEY> pkey;
+        ndn::Name key_name;
+    };
+
+    // what each thread handling packets keeps for itself, by currentCore(). the command thread locks it as well to
+    // change a setting or to report, the packet thread which owns it is otherwise alone to take the mutex
+    struct CoreState {
+        std::mutex mutex;
+        KeyStore::Verifier verifier;
+        SignatureCache signature_cache;
+        // by the hash of the KeyLocator, a stream signed by a single key resolves it once by change of the keys
+        FlowCache<KeyLookup, 256> key_cache;
+        SamplingPolicy sampling;
+        InvalidSignatureReport invalid_signatures;
+        Verdicts verdicts;
+        // by direction
+        std::deque<std::shared_ptr<PendingData>> pending_data[2];
+        // of the core service, read without the mutex
+        LoopMonitor loop_monitor;
+
+        explicit CoreState(boost::asio::io_service &ios) : loop_monitor(ios) {
+
+        }
+    };
+
     const std::string _name;
 
-    std::vector<std::shared_ptr<Face>> _egress_faces;
+    // read by every packet without a lock, see LeftRight
+    LeftRight<std::vector<std::shared_ptr<Face>>> _egress_faces;
     std::shared_ptr<MasterFace> _tcp_ingress_master_face;
     std::shared_ptr<MasterFace> _udp_ingress_master_face;
+    std::shared_ptr<MasterFace> _shm_ingress_master_face;
+    std::shared_ptr<MasterFace> _mem_ingress_master_face;
 
     char _command_buffer[65536];
     boost::asio::ip::udp::socket _command_socket;
     boost::asio::ip::udp::endpoint _remote_command_endpoint;
+    StartupConfig _startup_config;
+    // connections kept open to the endpoints set by edit_config, add_face takes them
+    TcpConnectionPool _connection_pool;
     boost::asio::ip::udp::endpoint _manager_endpoint;
 
-    bool _report_enable = false;
+    std::atomic<bool> _report_enable{false};
     boost::asio::deadline_timer _report_timer;
     boost::posix_time::milliseconds _delay_between_report;
 
-    bool _drop = false;
-    bool _no_key_drop = false;
-    bool _unsigned_drop = false;
-    std::set<std::string> _invalid_signature_packet_names;
-    std::map<ndn::Name, EVP_PKEY*> _pkeys;
+    std::atomic<bool> _drop{false};
+    std::atomic<bool> _no_key_drop{false};
+    std::atomic<bool> _unsigned_drop{false};
+    // the keys are looked up without a lock, see LeftRight. a key is read once and shared by the two instances
+    LeftRight<KeyStore> _keys;
+    // swapped with atomic_load and atomic_store, null when the checks are made by the packet threads themselves
+    std::shared_ptr<VerifierPool> _verifier_pool;
+    std::atomic<bool> _verify_in_order{true};
+    // off by default, the KeyLocators are then decoded and resolved for each Data
+    std::atomic<bool> _is_caching_keys{false};
+    // the settings of the core states, as the command thread last set them
+    size_t _signature_cache_size = SignatureCache::DEFAULT_SIZE;
+    size_t _signature_cache_ttl = SignatureCache::DEFAULT_TTL;
+    double _sampling_ratio = 1;
+    size_t _sampling_prefix_length = SamplingPolicy::DEFAULT_PREFIX_LENGTH;
+    size_t _sampling_quiet_period = SamplingPolicy::DEFAULT_QUIET_PERIOD;
+    size_t _report_top = InvalidSignatureReport::DEFAULT_TOP;
+    size_t _report_prefix_length = InvalidSignatureReport::DEFAULT_PREFIX_LENGTH;
+    // in milliseconds of lag of a core, 0 never sheds
+    size_t _overload_lag = 0;
+    // set before start, null if the Data are neither tagged nor trusted on their tag
+    std::shared_ptr<const VerifiedTagger> _tagger;
+    // one by core service and one for _ios, which runs the UDP and SHM faces
+    std::vector<std::unique_ptr<CoreState>> _core_states;
 
 public:
-    SignatureVerifier(const std::string &name, uint16_t local_port, uint16_t local_command_port);
+    static const size_t DEFAULT_CONCURRENCY = 4;
+
+    SignatureVerifier(const std::string &name, uint16_t local_port, uint16_t local_command_port,
+                      size_t concurrency = DEFAULT_CONCURRENCY);
 
     ~SignatureVerifier() override = default;
 
     void run() override;
 
+    // the commands applied by run() before the ingress accepts a face, see StartupConfig. false if source can't be
+    // read. before start()
+    bool loadStartupConfig(const std::string &source);
+
+    // the Data found valid are tagged with spec, "ID:FILE" as VerifiedTagger::create takes it, and those tagged by
+    // the verifiers sharing its key are forwarded without a check. false if spec is invalid. before start()
+    bool setVerifiedTagging(const std::string &spec);
+
 private:
-    void onIngressInterest(const std::shared_ptr<Face> &face, const ndn::Interest &interest);
+    // the ingress master faces stop accepting, the faces already there are served until the module stops
+    void beginDrain() override;
 
-    void onIngressData(const std::shared_ptr<Face> &face, const ndn::Data &data);
+    // nothing queued on the faces and no Data held by a core for its check or for the order
+    bool isDrained() override;
 
-    void onEgressInterest(const std::shared_ptr<Face> &face, const ndn::Interest &interest);
+    // Interests are forwarded as received, only Data are decoded to check their signature. the Data held for the pool
+    // or for the order are the packets of the faces, moved along
+    void onIngressPacket(const std::shared_ptr<Face> &face, NdnPacket &&packet);
 
-    void onEgressData(const std::shared_ptr<Face> &face, const ndn::Data &data);
+    void onEgressPacket(const std::shared_ptr<Face> &face, NdnPacket &&packet);
+
+    // the signature is checked on the packet thread or by the pool, the Data is forwarded according to the drop flags
+    void onData(Direction direction, NdnPacket &&packet);
+
+    // the key of the KeyLocator of signature, from the key cache of state if on. the core state must be locked
+    std::shared_ptr<EVP_PKEY> resolveKey(CoreState &state, const NdnPacket::SignatureView &signature, ndn::Name &key_name);
+
+    // the invalid signatures are reported and put their prefix on alert, true if the Data is to be forwarded. the core
+    // state must be locked
+    bool onVerified(CoreState &state, const NdnPacket &packet, bool is_valid);
+
+    // the verdict is cached unless the key was removed or replaced while the signature was checked
+    void cacheVerdict(CoreState &state, const SignatureCache::Digest &digest, const ndn::Name &key_name,
+                      const std::shared_ptr<EVP_PKEY> &pkey, bool is_valid);
+
+    // forwarded at once unless there are Data before it still pending on the same thread, with a Verified tag if
+    // is_tagged and tagging is on
+    void deliver(CoreState &state, Direction direction, NdnPacket &&packet, bool is_forwarded, bool is_tagged = false);
+
+    // the Data at the front which are done are forwarded or dropped
+    void flushPendingData(CoreState &state, Direction direction);
+
+    // f(CoreState&) on each core state, locked
+    template <class Function>
+    void forEachCoreState(const Function &f) {
+        for (auto &state : _core_states) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            f(*state);
+        }
+    }
+
+    void forward(Direction direction, const NdnPacket &packet, bool is_tagged = false);
 
     void onMasterFaceNotification(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face> &face);
 
@@ -72,6 +227,9 @@ private:
 
     void commandReadHandler(const boost::system::error_code &err, size_t bytes_transferred);
 
+    // a parsed command with an action, on _ios
+    void executeCommand(const rapidjson::Document &document);
+
     void commandEditConfig(const rapidjson::Document &document);
 
     void commandAddFace(const rapidjson::Document &document);
@@ -82,9 +240,21 @@ private:
 
     void commandDelKeys(const rapidjson::Document &document);
 
+    void commandAddTrustRules(const rapidjson::Document &document);
+
+    void commandDelTrustRules(const rapidjson::Document &document);
+
     void commandList(const rapidjson::Document &document);
 
+    // the bytes held by the keys, the state of each core and the faces, see MemoryStats
+    void commandMemoryStats(const rapidjson::Document &document);
+
+    // where the CPU time of the process goes for duration ms, answered with the folded stacks once it is over, see
+    // sampling_profiler
+    void commandProfile(const rapidjson::Document &document);
+
     void commandReport(const boost::system::error_code &err);
 
-    int verify(const unsigned char* msg, size_t mlen, const unsigned char* sig, size_t slen, EVP_PKEY* pkey);
+    // at each scrape, from _ios as commandList
+    void writeMetrics(MetricsWriter &writer);
 };
\ No newline at end of file
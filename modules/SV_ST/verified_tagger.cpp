@@ -0,0 +1,74 @@
+#include "verified_tagger.h"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <fstream>
+#include <iterator>
+
+VerifiedTagger::VerifiedTagger(uint64_t verifier_id, const std::vector<uint8_t> &key)
+        : _verifier_id(verifier_id)
+        , _key(key)
+        , _own_key(deriveKey(verifier_id)) {
+
+}
+
+std::unique_ptr<VerifiedTagger> VerifiedTagger::create(const std::string &spec) {
+    size_t colon = spec.find(':');
+    if (colon == std::string::npos || colon == 0 || colon + 1 == spec.size()
+        || spec.find_first_not_of("0123456789") != colon) {
+        return nullptr;
+    }
+    std::ifstream file(spec.substr(colon + 1), std::ios::binary);
+    std::vector<uint8_t> key((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (key.empty()) {
+        return nullptr;
+    }
+    return std::unique_ptr<VerifiedTagger>(new VerifiedTagger(std::stoull(spec.substr(0, colon)), key));
+}
+
+uint64_t VerifiedTagger::getVerifierId() const {
+    return _verifier_id;
+}
+
+VerifiedTagger::Key VerifiedTagger::deriveKey(uint64_t verifier_id) const {
+    uint8_t id[sizeof(verifier_id)];
+    for (size_t i = 0; i < sizeof(id); ++i) {
+        id[i] = static_cast<uint8_t>(verifier_id >> (8 * (sizeof(id) - 1 - i)));
+    }
+    Key key;
+    unsigned int size = key.size();
+    HMAC(EVP_sha256(), _key.data(), static_cast<int>(_key.size()), id, sizeof(id), key.data(), &size);
+    return key;
+}
+
+void VerifiedTagger::mac(const Key &key, const NdnPacket &packet, uint8_t *mac) {
+    const ndn::Block &block = packet.getBlock();
+    unsigned int size = LpLink::VerifiedTag::MAC_SIZE;
+    HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()), block.wire(), block.size(), mac, &size);
+}
+
+std::shared_ptr<const ndn::Buffer> VerifiedTagger::tag(const NdnPacket &packet) const {
+    LpLink::VerifiedTag tag;
+    tag.verifier_id = _verifier_id;
+    mac(_own_key, packet, tag.mac.data());
+    const ndn::Block &block = packet.getBlock();
+    return LpLink::verified(block.wire(), block.size(), tag);
+}
+
+bool VerifiedTagger::check(const NdnPacket &packet, uint64_t &verifier_id) const {
+    LpLink::VerifiedTag tag;
+    if (!packet.getLpPacket() || !LpLink::readVerified(packet.getLpPacket(), packet.getLpPacketSize(), tag)) {
+        return false;
+    }
+    // the key of another verifier is derived again, an HMAC of 8 bytes
+    Key key = tag.verifier_id == _verifier_id ? _own_key : deriveKey(tag.verifier_id);
+    uint8_t expected[LpLink::VerifiedTag::MAC_SIZE];
+    mac(key, packet, expected);
+    if (CRYPTO_memcmp(expected, tag.mac.data(), sizeof(expected)) != 0) {
+        return false;
+    }
+    verifier_id = tag.verifier_id;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ndn-cxx/encoding/buffer.hpp>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "network/lp_link.h"
+#include "network/ndn_packet.h"
+
+// the Verified tags of the Data this verifier found valid and the check of those the verifiers before it tagged, see
+// LpLink::VerifiedTag, so that a Data goes through a public key operation once by deployment rather than by hop. the
+// MAC covers the whole Data under a key derived from the one the verifiers share and the ID of the verifier: a Data
+// changed on the way, a tag made without the key or moved to another ID fail the check
+class VerifiedTagger {
+public:
+    typedef std::array<uint8_t, LpLink::VerifiedTag::MAC_SIZE> Key;
+
+private:
+    const uint64_t _verifier_id;
+    const std::vector<uint8_t> _key;
+    // derived for _verifier_id
+    Key _own_key;
+
+    // HMAC-SHA256 of the ID under the shared key
+    Key deriveKey(uint64_t verifier_id) const;
+
+    static void mac(const Key &key, const NdnPacket &packet, uint8_t *mac);
+
+public:
+    VerifiedTagger(uint64_t verifier_id, const std::vector<uint8_t> &key);
+
+    // "ID:FILE", FILE holding the raw bytes of the key shared by the verifiers. null if spec is invalid or the key
+    // can't be read
+    static std::unique_ptr<VerifiedTagger> create(const std::string &spec);
+
+    uint64_t getVerifierId() const;
+
+    // an LpPacket carrying the Data and the tag of this verifier
+    std::shared_ptr<const ndn::Buffer> tag(const NdnPacket &packet) const;
+
+    // true and set verifier_id if the Data came in an LpPacket with a tag which matches it
+    bool check(const NdnPacket &packet, uint64_t &verifier_id) const;
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "verifier_pool.h"
+
+// the verifier of the pool thread running the check
+static thread_local KeyStore::Verifier *thread_verifier = nullptr;
+
+VerifierPool::VerifierPool(size_t size)
+        : _pool_ios(size)
+        , _pool_ios_work(new boost::asio::io_service::work(_pool_ios))
+        , _size(size) {
+    for (size_t i = 0; i < _size; ++i) {
+        _threads.create_thread(boost::bind(&VerifierPool::work, this));
+    }
+}
+
+VerifierPool::~VerifierPool() {
+    _pool_ios_work.reset();
+    _threads.join_all();
+}
+
+void VerifierPool::work() {
+    KeyStore::Verifier verifier;
+    thread_verifier = &verifier;
+    _pool_ios.run();
+    thread_verifier = nullptr;
+}
+
+size_t VerifierPool::size() const {
+    return _size;
+}
+
+void VerifierPool::verify(const std::shared_ptr<const NdnPacket> &packet, const std::shared_ptr<EVP_PKEY> &pkey, boost::asio::io_service &result_ios,
+                          const Callback &callback) {
+    // the signature is located here, the pool threads only read the packet buffer
+    const NdnPacket::SignatureView &signature = packet->getSignatureView();
+    const uint8_t *msg = signature.signed_begin;
+    size_t mlen = signature.signed_size;
+    const uint8_t *sig = signature.value;
+    size_t slen = signature.value_size;
+    boost::asio::io_service *ios = &result_ios;
+    _pool_ios.post([packet, pkey, ios, callback, msg, mlen, sig, slen]() {
+        bool is_valid = thread_verifier->verify(msg, mlen, sig, slen, pkey.get());
+        ios->post(boost::bind(callback, is_valid));
+    });
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+
+#include <openssl/evp.h>
+
+#include <functional>
+#include <memory>
+
+#include "network/ndn_packet.h"
+#include "security/key_store.h"
+
+// threads checking the signature of Data off the threads handling packets, each with a KeyStore::Verifier of its own.
+// the checks are taken from one queue by whichever thread is free and their result is handed back on the io_service
+// given with each, the state of the caller is only touched there
+class VerifierPool {
+public:
+    typedef std::function<void(bool)> Callback;
+
+private:
+    boost::asio::io_service _pool_ios;
+    std::unique_ptr<boost::asio::io_service::work> _pool_ios_work;
+    boost::thread_group _threads;
+    const size_t _size;
+
+    void work();
+
+public:
+    explicit VerifierPool(size_t size);
+
+    VerifierPool(const VerifierPool&) = delete;
+
+    VerifierPool& operator=(const VerifierPool&) = delete;
+
+    // the checks queued are made and their callbacks posted before it returns
+    ~VerifierPool();
+
+    size_t size() const;
+
+    // packet must be a Data, the packet and the key are held until the check is done
+    void verify(const std::shared_ptr<const NdnPacket> &packet, const std::shared_ptr<EVP_PKEY> &pkey, boost::asio::io_service &result_ios,
+                const Callback &callback);
+};
\ No newline at end of file
@@ -0,0 +1,367 @@
+#! /usr/bin/python3
+# end-to-end benchmark of a chain of modules on this host, without Docker nor manager: the module binaries of the tree
+# are started in a directory each, wired through their command sockets as attachNode of manager.py does, loaded by
+# ndnms-bench and watched meanwhile. the scenario gives the chain, the load and the scale-up events, e.g.
+#
+#   ./chain_bench.py scenarios/chain.json -o results.json
+#
+# the results are the throughput and the latency seen by the consumers, second by second and in total, the time each
+# module holds a packet, from its trace logs, and the CPU each one used, printed or written as JSON. the modules and
+# LG_MT must be built, e.g. with -DCMAKE_BUILD_TYPE=Release
+
+import argparse
+import collections
+import json
+import os
+import re
+import shlex
+import shutil
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+MODULES_DIR = os.path.dirname(os.path.abspath(__file__))
+BENCH_BINARY = os.path.join(MODULES_DIR, "LG_MT", "bin", "ndnms-bench")
+
+# by type, the binary and the arguments the manager starts its containers with, those of the scenario are added
+BINARIES = {"PD": "PD_ST/bin/PD", "CS": "CS_ST/bin/CS", "SV": "SV_ST/bin/SV", "NF": "NF_ST/bin/FW",
+            "BR": "BR_ST/bin/BR", "NR": "NR_ST/bin/NR"}
+DEFAULT_ARGS = {"CS": "-s 100000", "BR": "-s 250"}
+# which take add_face, the dispatcher is given its next hop with -c when it starts
+LINKABLE_TYPES = {"CS", "SV", "NF", "BR", "NR"}
+
+COMMAND_TIMEOUT = 5
+START_TIMEOUT = 10
+
+TRACE_SENT = re.compile(r"trace \d+: (Interest|Data) sent at \d+us on face \d+, (\d+)us after its receive")
+BENCH_SECOND = re.compile(r"^\s*(\d+)s: (\d+) Interests/s, (\d+) Data/s \(([\d.e+-]+) Mbit/s\), (\d+) timeouts/s")
+BENCH_TOTALS = re.compile(r"^sent (\d+) Interests in ([\d.e+-]+)s, received (\d+) Data, (\d+) timeouts")
+BENCH_THROUGHPUT = re.compile(r"^throughput: ([\d.e+-]+) Data/s, ([\d.e+-]+) Mbit/s")
+BENCH_LATENCY = re.compile(r"^latency: p50 (\d+)us, p90 (\d+)us, p99 (\d+)us, p99.9 (\d+)us, max (\d+)us")
+
+
+class Node:
+    def __init__(self, name: str, type: str, args: str, ports: dict, directory: str):
+        self.name = name
+        self.type = type
+        self.args = args
+        self.ports = ports
+        self.directory = directory
+        self.process = None
+        self.cpu_start = 0.0
+
+    # where the previous hop connects: the consumer port of a Name Router, the data port of the others
+    def getIngressPort(self) -> int:
+        return self.ports["consumer"] if self.type == "NR" else self.ports["data"]
+
+    def getCommandLine(self, next_hop=None) -> list:
+        ports = self.ports
+        if self.type == "PD":
+            args = "-p %d -C %d" % (ports["data"], ports["command"])
+            if next_hop:
+                args += " -c 127.0.0.1:%d" % next_hop.getIngressPort()
+        elif self.type == "NR":
+            args = "-n %s -c %d -p %d -C %d" % (self.name, ports["consumer"], ports["data"], ports["command"])
+        else:
+            args = "-n %s -p %d -C %d" % (self.name, ports["data"], ports["command"])
+        args += " " + DEFAULT_ARGS.get(self.type, "") + " " + self.args
+        return [os.path.join(MODULES_DIR, BINARIES[self.type])] + shlex.split(args)
+
+    # utime and stime of the process, in seconds
+    def getCpuTime(self) -> float:
+        try:
+            with open("/proc/%d/stat" % self.process.pid) as stat:
+                fields = stat.read().rsplit(")", 1)[1].split()
+            return (int(fields[11]) + int(fields[12])) / os.sysconf("SC_CLK_TCK")
+        except (OSError, IndexError, ValueError):
+            return 0.0
+
+
+class CommandSocket:
+    def __init__(self):
+        self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.socket.bind(("127.0.0.1", 0))
+        self.request_counter = 1
+
+    # the reply to the command, None if it didn't come in time
+    def send(self, node: Node, command: dict, timeout=COMMAND_TIMEOUT):
+        command = dict(command, id=self.request_counter)
+        self.request_counter += 1
+        self.socket.sendto(json.dumps(command).encode(), ("127.0.0.1", node.ports["command"]))
+        deadline = time.monotonic() + timeout
+        while time.monotonic() < deadline:
+            self.socket.settimeout(max(deadline - time.monotonic(), 0.01))
+            try:
+                data, _ = self.socket.recvfrom(1 << 16)
+            except socket.timeout:
+                break
+            try:
+                reply = json.loads(data.decode())
+            except ValueError:
+                continue
+            if reply.get("type") == "reply" and reply.get("id") == command["id"]:
+                return reply
+        return None
+
+
+class Chain:
+    def __init__(self, scenario: dict, directory: str, base_port: int):
+        self.scenario = scenario
+        self.directory = directory
+        self.next_port = base_port
+        self.nodes = collections.OrderedDict()
+        self.links = {}
+        self.producers = []
+        self.commands = CommandSocket()
+        self.events = []
+
+    def log(self, *message):
+        print("[", "%.3f" % time.monotonic(), "]", *message, file=sys.stderr)
+
+    def allocatePorts(self, count: int) -> list:
+        ports = list(range(self.next_port, self.next_port + count))
+        self.next_port += count
+        return ports
+
+    def addNode(self, name: str, type: str, args: str) -> Node:
+        if type not in BINARIES:
+            raise ValueError("unknown module type %s" % type)
+        data, command, consumer = self.allocatePorts(3)
+        directory = os.path.join(self.directory, name)
+        os.makedirs(directory, exist_ok=True)
+        node = Node(name, type, args, {"data": data, "command": command, "consumer": consumer}, directory)
+        self.nodes[name] = node
+        return node
+
+    def startNode(self, node: Node, next_hop=None):
+        trace = self.scenario.get("trace", 0)
+        command_line = node.getCommandLine(next_hop) + (["-T", str(trace)] if trace else [])
+        self.log("start", node.name, " ".join(command_line))
+        with open(os.path.join(node.directory, "stdout.txt"), "w") as output:
+            node.process = subprocess.Popen(command_line, cwd=node.directory, stdout=output, stderr=subprocess.STDOUT)
+        # up once it answers on its command socket
+        deadline = time.monotonic() + START_TIMEOUT
+        while time.monotonic() < deadline:
+            if node.process.poll() is not None:
+                raise RuntimeError("%s exited with %d, see %s" % (node.name, node.process.returncode, node.directory))
+            if self.commands.send(node, {"action": "memory_stats"}, timeout=0.2):
+                break
+        else:
+            raise RuntimeError("%s doesn't answer on its command port %d" % (node.name, node.ports["command"]))
+        for command in self.scenario.get("commands", {}).get(node.type, []) + self.getNodeSpec(node.name).get("commands", []):
+            if not self.commands.send(node, command):
+                self.log("no reply from", node.name, "to", command)
+
+    def getNodeSpec(self, name: str) -> dict:
+        for spec in self.scenario["nodes"]:
+            if spec["name"] == name:
+                return spec
+        return {}
+
+    # the face id, 0 if it failed
+    def addFace(self, source: Node, target: Node) -> int:
+        if source.type not in LINKABLE_TYPES:
+            self.log(source.name, "takes no add_face, not linked to", target.name)
+            return 0
+        face_id = self.openFace(source, target.getIngressPort())
+        if face_id > 0:
+            self.links[source.name, target.name] = face_id
+            self.log(source.name, "linked to", target.name)
+        else:
+            self.log(source.name, "not linked to", target.name)
+        return face_id
+
+    def openFace(self, source: Node, port: int) -> int:
+        command = {"action": "add_face", "layer": self.scenario.get("layer", "tcp"), "address": "127.0.0.1", "port": port}
+        command.update(self.scenario.get("face", {}))
+        reply = self.commands.send(source, command)
+        return reply.get("face_id", 0) if reply else 0
+
+    def addProducer(self, node: Node, producer: dict):
+        face_id = self.openFace(node, producer["port"])
+        if face_id > 0:
+            self.commands.send(node, {"action": "add_route", "face_id": face_id, "prefixes": [producer.get("prefix", "/bench")]})
+            self.log(node.name, "routes", producer.get("prefix", "/bench"), "to", producer["name"])
+        else:
+            self.log(node.name, "not linked to", producer["name"])
+
+    def predecessors(self, name: str) -> list:
+        return [source for source, target in self.links if target == name and source in self.nodes]
+
+    def successors(self, name: str) -> list:
+        return [target for source, target in self.links if source == name and target in self.nodes]
+
+    # as attachNode of manager.py with new_link: the clone links to the next hops of the node, then the previous hops of
+    # the node link to the clone too and share their traffic between both
+    def scaleUp(self, name: str, clone_name: str):
+        node = self.nodes[name]
+        clone = self.addNode(clone_name, node.type, node.args)
+        self.startNode(clone)
+        for out_name in self.successors(name):
+            self.addFace(clone, self.nodes[out_name])
+        for producer in self.producers:
+            if producer["node"] == name:
+                self.addProducer(clone, producer)
+        for in_name in self.predecessors(name):
+            self.addFace(self.nodes[in_name], clone)
+        clone.cpu_start = clone.getCpuTime()
+
+    def start(self):
+        specs = self.scenario["nodes"]
+        for spec in specs:
+            self.addNode(spec["name"], spec["type"], spec.get("args", ""))
+        links = [tuple(link) for link in self.scenario.get("links", [])]
+        for link in links:
+            if link[0] not in self.nodes or link[1] not in self.nodes:
+                raise ValueError("link %s between unknown nodes" % str(link))
+        # producers first, then the chain from its end, a hop is up before the one linking to it
+        for producer in self.scenario.get("producers", []):
+            producer = dict(producer, port=self.allocatePorts(1)[0])
+            self.producers.append(producer)
+            directory = os.path.join(self.directory, producer["name"])
+            os.makedirs(directory, exist_ok=True)
+            command_line = [BENCH_BINARY, "-m", "producer", "-p", str(producer["port"])] + shlex.split(producer.get("args", ""))
+            self.log("start", producer["name"], " ".join(command_line))
+            with open(os.path.join(directory, "stdout.txt"), "w") as output:
+                producer["process"] = subprocess.Popen(command_line + ["-D", "0"], cwd=directory, stdout=output, stderr=subprocess.STDOUT)
+        time.sleep(0.5)
+        for name in reversed(list(self.nodes)):
+            node = self.nodes[name]
+            next_hops = [self.nodes[target] for source, target in links if source == name]
+            self.startNode(node, next_hops[0] if next_hops else None)
+            for next_hop in next_hops:
+                if node.type == "PD":
+                    self.links[name, next_hop.name] = 0
+                else:
+                    self.addFace(node, next_hop)
+            for producer in self.producers:
+                if producer["node"] == name:
+                    self.addProducer(node, producer)
+
+    def run(self) -> dict:
+        load = self.scenario.get("load", {})
+        entry = self.nodes[load.get("entry", next(iter(self.nodes)))]
+        command_line = [BENCH_BINARY, "-m", "consumer", "-c", "127.0.0.1:%d" % entry.getIngressPort()] + shlex.split(load.get("args", ""))
+        self.log("load", " ".join(command_line))
+        for node in self.nodes.values():
+            node.cpu_start = node.getCpuTime()
+        start = time.monotonic()
+        bench = subprocess.Popen(command_line, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        events = sorted(self.scenario.get("events", []), key=lambda event: event["at"])
+        output = []
+        # the events are applied between the lines of the bench, one a second
+        for line in bench.stdout:
+            output.append(line)
+            while events and time.monotonic() - start >= events[0]["at"]:
+                event = events.pop(0)
+                if event.get("action") == "scale_up":
+                    self.log("scale up", event["node"], "to", event["clone"])
+                    self.scaleUp(event["node"], event["clone"])
+                    self.events.append({"at": round(time.monotonic() - start, 3), "action": "scale_up", "node": event["node"], "clone": event["clone"]})
+        bench.wait()
+        elapsed = time.monotonic() - start
+        results = parseBench(output)
+        results["duration"] = round(elapsed, 3)
+        results["events"] = self.events
+        results["modules"] = collections.OrderedDict()
+        for name, node in self.nodes.items():
+            cpu = node.getCpuTime() - node.cpu_start
+            results["modules"][name] = {"type": node.type, "cpu_seconds": round(cpu, 3), "cpu_percent": round(100 * cpu / elapsed, 1)}
+        return results
+
+    def stop(self):
+        processes = [node.process for node in self.nodes.values() if node.process] + [producer["process"] for producer in self.producers if "process" in producer]
+        for process in processes:
+            if process.poll() is None:
+                process.terminate()
+        for process in processes:
+            try:
+                process.wait(timeout=5)
+            except subprocess.TimeoutExpired:
+                process.kill()
+
+    # after stop(), once the logs are flushed: the time from the receive of a packet to its send, by module and type
+    def addHopLatencies(self, results: dict):
+        for name, node in self.nodes.items():
+            hops = {"Interest": [], "Data": []}
+            try:
+                with open(os.path.join(node.directory, "logs.txt"), errors="replace") as logs:
+                    for line in logs:
+                        match = TRACE_SENT.search(line)
+                        if match:
+                            hops[match.group(1)].append(int(match.group(2)))
+            except OSError:
+                pass
+            results["modules"][name]["hop_latency_us"] = {type.lower(): summarize(values) for type, values in hops.items()}
+
+
+def summarize(values: list) -> dict:
+    if not values:
+        return {"samples": 0}
+    values = sorted(values)
+    quantile = lambda q: values[min(int(q * len(values)), len(values) - 1)]
+    return {"samples": len(values), "p50": quantile(0.5), "p90": quantile(0.9), "p99": quantile(0.99), "max": values[-1]}
+
+
+def parseBench(lines: list) -> dict:
+    results = {"seconds": []}
+    for line in lines:
+        match = BENCH_SECOND.match(line)
+        if match:
+            results["seconds"].append({"second": int(match.group(1)), "interests": int(match.group(2)), "data": int(match.group(3)),
+                                       "mbits": float(match.group(4)), "timeouts": int(match.group(5))})
+            continue
+        match = BENCH_TOTALS.match(line)
+        if match:
+            results.update(sent=int(match.group(1)), received=int(match.group(3)), timeouts=int(match.group(4)))
+            continue
+        match = BENCH_THROUGHPUT.match(line)
+        if match:
+            results.update(throughput_data_per_second=float(match.group(1)), throughput_mbits=float(match.group(2)))
+            continue
+        match = BENCH_LATENCY.match(line)
+        if match:
+            results["latency_us"] = dict(zip(["p50", "p90", "p99", "p99.9", "max"], map(int, match.groups())))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="runs a chain of modules on this host under the load of ndnms-bench")
+    parser.add_argument("scenario", help="JSON file of the chain, its load and its events")
+    parser.add_argument("-o", "--output", help="where the results go as JSON, printed if not given")
+    parser.add_argument("-w", "--work-dir", help="directory of the logs of the modules, kept, a temporary one by default")
+    parser.add_argument("-P", "--base-port", type=int, default=21000, help="first of the ports given to the modules")
+    args = parser.parse_args()
+
+    with open(args.scenario) as scenario_file:
+        scenario = json.load(scenario_file)
+    missing = [path for path in [BENCH_BINARY] + [os.path.join(MODULES_DIR, BINARIES[spec["type"]]) for spec in scenario["nodes"] if spec["type"] in BINARIES]
+               if not os.access(path, os.X_OK)]
+    if missing:
+        print("not built: " + ", ".join(missing), file=sys.stderr)
+        return 1
+    directory = args.work_dir or tempfile.mkdtemp(prefix="ndnms-chain-")
+    chain = Chain(scenario, directory, args.base_port)
+    try:
+        chain.start()
+        results = chain.run()
+    finally:
+        chain.stop()
+    chain.addHopLatencies(results)
+    results["scenario"] = os.path.basename(args.scenario)
+    results["work_dir"] = directory
+    if args.output:
+        with open(args.output, "w") as output:
+            json.dump(results, output, indent=2)
+    else:
+        print(json.dumps(results, indent=2))
+    if not args.work_dir and not args.output:
+        shutil.rmtree(directory, ignore_errors=True)
+        results["work_dir"] = None
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
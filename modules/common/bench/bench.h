@@ -0,0 +1,296 @@
+#pragma once
+
+// what the table benchmarks share: Names with the fan-out of a real namespace, their packets, and the time, the
+// allocations and the heap of an operation. the seeds are fixed so that two runs compare. a benchmark includes it
+// in its single source file, the allocations of the whole process are then counted, and its dTLB load misses too
+// where perf events are allowed
+// usage of a table benchmark: <name>_bench [-H pages] [entries...], 1000, 100000 and 1000000 by default, the tables
+// then on the pages given as to the modules, e.g. -H 2M:local, see PageArena
+
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/encoding/buffer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <malloc.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#endif
+
+#include "network/face.h"
+#include "network/ndn_packet.h"
+#include "network/page_arena.h"
+
+namespace bench {
+    size_t allocations = 0;
+}
+
+void* operator new(size_t size) {
+    ++bench::allocations;
+    if (void *p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace bench {
+    // 10 segments per object, 100 objects per application, 50 applications per site, as many sites as needed
+    static const size_t SEGMENTS = 10;
+    static const size_t OBJECTS = 100;
+    static const size_t APPLICATIONS = 50;
+
+    // a face which only counts what it is given
+    class NullFace : public Face {
+    public:
+        size_t sent = 0;
+
+        explicit NullFace(boost::asio::io_service &ios) : Face(ios) {
+
+        }
+
+        std::string getUnderlyingProtocol() const override {
+            return "null";
+        }
+
+        std::string getUnderlyingEndpoint() const override {
+            return "";
+        }
+
+        void open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) override {
+
+        }
+
+        void close() override {
+
+        }
+
+        void send(const std::string &message) override {
+            ++sent;
+        }
+
+        void send(const ndn::Interest &interest) override {
+            ++sent;
+        }
+
+        void send(const ndn::Data &data) override {
+            ++sent;
+        }
+
+        void send(const std::shared_ptr<const ndn::Buffer> &wire) override {
+            ++sent;
+        }
+
+        QueueStats getQueueStats() const override {
+            return {};
+        }
+    };
+
+    inline std::vector<size_t> getSizes(int argc, char *argv[]) {
+        std::vector<size_t> sizes;
+        for (int i = 1; i < argc; ++i) {
+            if (std::string(argv[i]) == "-H" && i + 1 < argc) {
+                if (!PageArena::enable(argv[++i])) {
+                    std::fprintf(stderr, "invalid pages %s, the tables are kept in the heap\n", argv[i]);
+                }
+                continue;
+            }
+            sizes.emplace_back(std::stoul(argv[i]));
+        }
+        if (sizes.empty()) {
+            sizes = {1000, 100000, 1000000};
+        }
+        return sizes;
+    }
+
+    // /bench/site<s>/app<a>/object<o>/<segment>, the i-th Name of a namespace filled level by level. offset starts
+    // in another part of it, e.g. for Names missing from a table built from the first ones
+    inline std::vector<ndn::Name> makeNames(size_t count, size_t offset = 0) {
+        std::vector<ndn::Name> names;
+        names.reserve(count);
+        for (size_t j = offset; j < offset + count; ++j) {
+            ndn::Name name("/bench");
+            name.append(ndn::Name::Component("site" + std::to_string(j / (SEGMENTS * OBJECTS * APPLICATIONS))))
+                .append(ndn::Name::Component("app" + std::to_string(j / (SEGMENTS * OBJECTS) % APPLICATIONS)))
+                .append(ndn::Name::Component("object" + std::to_string(j / SEGMENTS % OBJECTS)))
+                .appendSegment(j % SEGMENTS);
+            names.emplace_back(std::move(name));
+        }
+        return names;
+    }
+
+    // the indices of count entries in a shuffled order, the same at each run, so that lookups don't walk the table
+    // in the order it was filled
+    inline std::vector<size_t> makeOrder(size_t count) {
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; ++i) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+        return order;
+    }
+
+    inline ndn::Interest makeInterest(const ndn::Name &name, uint32_t nonce) {
+        ndn::Interest interest(name);
+        interest.setCanBePrefix(false);
+        interest.setNonce(nonce);
+        interest.setInterestLifetime(ndn::time::milliseconds(4000));
+        return interest;
+    }
+
+    inline void appendVarNumber(std::vector<uint8_t> &wire, size_t number) {
+        if (number < 253) {
+            wire.push_back(static_cast<uint8_t>(number));
+        } else {
+            wire.push_back(253);
+            wire.push_back(static_cast<uint8_t>(number >> 8));
+            wire.push_back(static_cast<uint8_t>(number));
+        }
+    }
+
+    // Name, a FreshnessPeriod, payload bytes of Content and a DigestSha256 SignatureInfo, nothing checks the
+    // SignatureValue here
+    inline ndn::Block makeData(const ndn::Name &name, uint16_t freshness, size_t payload) {
+        const ndn::Block &name_block = name.wireEncode();
+        std::vector<uint8_t> value(name_block.wire(), name_block.wire() + name_block.size());
+        const uint8_t meta_info[] = {0x14, 0x04, 0x19, 0x02, static_cast<uint8_t>(freshness >> 8), static_cast<uint8_t>(freshness)};
+        value.insert(value.end(), meta_info, meta_info + sizeof(meta_info));
+        value.push_back(0x15);
+        appendVarNumber(value, payload);
+        value.insert(value.end(), payload, 'x');
+        const uint8_t signature[] = {0x16, 0x03, 0x1b, 0x01, 0x00, 0x17, 0x00};
+        value.insert(value.end(), signature, signature + sizeof(signature));
+        std::vector<uint8_t> wire;
+        wire.push_back(ndn::tlv::Data);
+        appendVarNumber(wire, value.size());
+        wire.insert(wire.end(), value.begin(), value.end());
+        return ndn::Block(std::make_shared<const ndn::Buffer>(wire.data(), wire.size()));
+    }
+
+    inline std::vector<NdnPacket> toPackets(const std::vector<ndn::Block> &blocks) {
+        std::vector<NdnPacket> packets;
+        packets.reserve(blocks.size());
+        for (const auto &block : blocks) {
+            packets.emplace_back(block);
+        }
+        return packets;
+    }
+
+    // large blocks such as the arenas are mmapped and not counted in uordblks, nor are the regions of PageArena,
+    // whose mapped bytes are added
+    inline size_t getHeapBytes() {
+        struct mallinfo2 info = mallinfo2();
+        PageArenaStats pages = PageArena::getStats();
+        return info.uordblks + info.hblkhd + pages.normal_bytes + pages.transparent_bytes + pages.huge_bytes + pages.gigantic_bytes;
+    }
+
+    // dTLB load misses of the process in user space, inherited by the threads it starts afterwards such as the
+    // shards. unavailable with a perf_event_paranoid above 2 or in most containers, the column then shows n/a
+    class TlbCounter {
+    private:
+        int _fd = -1;
+
+        TlbCounter() {
+#if defined(__linux__) && defined(__NR_perf_event_open)
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;
+            _fd = static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+        }
+
+    public:
+        TlbCounter(const TlbCounter&) = delete;
+
+        TlbCounter& operator=(const TlbCounter&) = delete;
+
+        ~TlbCounter() {
+            if (_fd >= 0) {
+                ::close(_fd);
+            }
+        }
+
+        static TlbCounter& get() {
+            static TlbCounter counter;
+            return counter;
+        }
+
+        bool isAvailable() const {
+            return _fd >= 0;
+        }
+
+        uint64_t read() const {
+            uint64_t count = 0;
+            if (_fd >= 0 && ::read(_fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+            return count;
+        }
+    };
+
+    inline void printOperation(const char *table, const char *name, size_t entries, size_t count, double seconds,
+                               size_t allocations_before, uint64_t misses_before) {
+        std::printf("%-24s %9zu entries  %-10s %10.1f ns/op  %6.2f allocations/op", table, entries, name,
+                    seconds * 1e9 / count, static_cast<double>(allocations - allocations_before) / count);
+        const TlbCounter &tlb = TlbCounter::get();
+        if (tlb.isAvailable()) {
+            std::printf("  %8.3f dTLB misses/op\n", static_cast<double>(tlb.read() - misses_before) / count);
+        } else {
+            std::printf("       n/a dTLB misses/op\n");
+        }
+    }
+
+    inline void printMemory(const char *table, size_t entries, size_t bytes) {
+        std::printf("%-24s %9zu entries  %10.1f bytes/entry\n", table, entries, static_cast<double>(bytes) / entries);
+    }
+
+    // operation() once for count entries, e.g. all those expired at once
+    template <typename Operation>
+    void measureBatch(const char *table, const char *name, size_t entries, size_t count, const Operation &operation) {
+        size_t before = allocations;
+        uint64_t misses = TlbCounter::get().read();
+        auto start = std::chrono::steady_clock::now();
+        operation();
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+        printOperation(table, name, entries, count, time.count(), before, misses);
+    }
+
+    // operation(i) for i in [0, count), the mean time and allocations of a call are printed
+    template <typename Operation>
+    void measure(const char *table, const char *name, size_t entries, size_t count, const Operation &operation) {
+        size_t before = allocations;
+        uint64_t misses = TlbCounter::get().read();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            operation(i);
+        }
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+        printOperation(table, name, entries, count, time.count(), before, misses);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+// the stream framing of TcpFace: packets found with tlv_reader::frame in 32k reads of a TCP stream, as views on the
+// read chunk, then their NameView as the modules read it first. half of them are Interests, half 1000 bytes Data.
+// then the resync scan on as many bytes of garbage
+// usage: framing_bench [packets...]
+
+#include <cstring>
+
+#include "bench/bench.h"
+#include "network/tcp_face.h"
+#include "network/tlv_reader.h"
+
+static void run(size_t count) {
+    auto names = bench::makeNames(count);
+    std::vector<uint8_t> stream;
+    for (size_t i = 0; i < count; ++i) {
+        ndn::Block block = i % 2 == 0 ? bench::makeInterest(names[i], static_cast<uint32_t>(i)).wireEncode()
+                                      : bench::makeData(names[i], 4000, 1000);
+        stream.insert(stream.end(), block.wire(), block.wire() + block.size());
+    }
+
+    auto chunk = std::make_shared<ndn::Buffer>(TcpFace::BUFFER_SIZE);
+    size_t framed = 0;
+    size_t components = 0;
+    size_t chunk_end = 0;
+    size_t offset = 0;
+    auto start = std::chrono::steady_clock::now();
+    bench::measureBatch("tlv_reader::frame", "frame", count, count, [&]() {
+        while (offset < stream.size()) {
+            // one read, what is left of the former one is at the start of the chunk
+            size_t read = std::min(chunk->size() - chunk_end, stream.size() - offset);
+            std::memcpy(chunk->data() + chunk_end, stream.data() + offset, read);
+            offset += read;
+            chunk_end += read;
+            const uint8_t *begin = chunk->data();
+            const uint8_t *current = begin;
+            const uint8_t *end = begin + chunk_end;
+            while (current < end) {
+                size_t size;
+                if (tlv_reader::frame(current, end, TcpFace::NDN_MAX_PACKET_SIZE, size) != tlv_reader::COMPLETE) {
+                    break;
+                }
+                auto it = chunk->cbegin() + (current - begin);
+                NdnPacket packet(ndn::Block(chunk, it, it + size));
+                components += packet.getNameView().size();
+                ++framed;
+                current += size;
+            }
+            chunk_end = end - current;
+            std::memmove(chunk->data(), current, chunk_end);
+        }
+    });
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    std::printf("%-24s %9zu entries  %-10s %10.1f MB/s\n", "tlv_reader::frame", count, "stream", stream.size() / time.count() / 1e6);
+    if (framed != count || components != count * 5) {
+        std::printf("tlv_reader::frame: unexpected packets\n");
+    }
+
+    // a stream of the same size resynced past garbage, none of its bytes can start a packet
+    std::vector<uint8_t> garbage(stream.size(), 0x07);
+    start = std::chrono::steady_clock::now();
+    const uint8_t *found = tlv_reader::findPacketStart(garbage.data(), garbage.data() + garbage.size());
+    time = std::chrono::steady_clock::now() - start;
+    std::printf("%-24s %9zu entries  %-10s %10.1f MB/s\n", "tlv_reader::findPacket", count, "resync", garbage.size() / time.count() / 1e6);
+    if (found != garbage.data() + garbage.size()) {
+        std::printf("tlv_reader::findPacketStart: unexpected start\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t count : bench::getSizes(argc, argv)) {
+        run(count);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+// the hand-off of a received packet to its module: Face::deliver to a Face::PacketCallback wrapping a boost::bind of a
+// member, as the modules opened their faces, and to a PacketHandler bound to the same member, then the bare calls on
+// packets already decoded. half of the packets are Interests, half 100 bytes Data. the cycles are those of the TSC
+// usage: handler_bench [packets...]
+
+#include <boost/bind.hpp>
+
+#ifdef __x86_64__
+#include <x86intrin.h>
+#endif
+
+#include "bench/bench.h"
+
+namespace {
+    struct Module {
+        size_t interests = 0;
+        size_t data = 0;
+
+        void onPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+            if (packet.getType() == NdnPacket::INTEREST) {
+                ++interests;
+            } else {
+                ++data;
+            }
+        }
+    };
+
+    // deliver is what the faces call on each packet of a read
+    class DeliveringFace : public bench::NullFace {
+    public:
+        using bench::NullFace::NullFace;
+
+        using Face::open;
+
+        using Face::deliver;
+    };
+
+    uint64_t readCycles() {
+#ifdef __x86_64__
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    template <typename Operation>
+    void measure(const char *table, const char *name, size_t count, const Operation &operation) {
+        uint64_t cycles = readCycles();
+        bench::measure(table, name, count, count, operation);
+        cycles = readCycles() - cycles;
+        if (cycles != 0) {
+            std::printf("%-24s %9s          %-10s %10.1f cycles/op\n", table, "", name, static_cast<double>(cycles) / count);
+        }
+    }
+}
+
+static void run(size_t count) {
+    auto names = bench::makeNames(count);
+    std::vector<ndn::Block> blocks;
+    blocks.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        blocks.emplace_back(i % 2 == 0 ? bench::makeInterest(names[i], static_cast<uint32_t>(i)).wireEncode()
+                                       : bench::makeData(names[i], 4000, 100));
+    }
+    std::vector<NdnPacket> packets = bench::toPackets(blocks);
+
+    boost::asio::io_service ios;
+    Module module;
+    Face::ErrorCallback error_callback = [](const std::shared_ptr<Face>&) {
+
+    };
+
+    auto bound_face = std::make_shared<DeliveringFace>(ios);
+    bound_face->open(Face::PacketCallback(boost::bind(&Module::onPacket, &module, _1, _2)), error_callback);
+    std::shared_ptr<Face> face = bound_face;
+    measure("Face::deliver", "bind", count, [&](size_t i) {
+        bound_face->deliver(face, blocks[i]);
+    });
+
+    auto handled_face = std::make_shared<DeliveringFace>(ios);
+    handled_face->open(PacketHandler::bind<Module, &Module::onPacket>(&module), error_callback);
+    face = handled_face;
+    measure("Face::deliver", "handler", count, [&](size_t i) {
+        handled_face->deliver(face, blocks[i]);
+    });
+
+    Face::PacketCallback callback = boost::bind(&Module::onPacket, &module, _1, _2);
+    measure("dispatch", "bind", count, [&](size_t i) {
+        callback(face, packets[i]);
+    });
+
+    PacketHandler handler = PacketHandler::bind<Module, &Module::onPacket>(&module);
+    measure("dispatch", "handler", count, [&](size_t i) {
+        handler(face, packets[i]);
+    });
+
+    if (module.interests + module.data != 4 * count) {
+        std::printf("missing packets\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t count : bench::getSizes(argc, argv)) {
+        run(count);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+// compares the UDP ingress of the asio epoll reactor, as used by UdpMasterFace, with the io_uring backend
+// usage: io_backend_bench [datagrams] [datagram size]
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <time.h>
+
+#include "network/uring_service.h"
+
+static const size_t SEND_BATCH = 64;
+
+struct Result {
+    size_t received = 0;
+    double seconds = 0;
+    // CPU time of the receiving thread, meaningful even when the sender shares its core
+    double cpu_seconds = 0;
+};
+
+static double threadCpuTime() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// one async_receive_from per datagram, like the face read() loop
+class EpollReceiver : public std::enable_shared_from_this<EpollReceiver> {
+private:
+    boost::asio::ip::udp::socket &_socket;
+    boost::asio::ip::udp::endpoint _remote_endpoint;
+    char _buffer[1 << 16];
+    Result &_result;
+    std::chrono::steady_clock::time_point _start;
+
+public:
+    EpollReceiver(boost::asio::ip::udp::socket &socket, Result &result) : _socket(socket), _result(result) {
+
+    }
+
+    void read() {
+        _socket.async_receive_from(boost::asio::buffer(_buffer, sizeof(_buffer)), _remote_endpoint,
+                                   boost::bind(&EpollReceiver::readHandler, shared_from_this(), _1, _2));
+    }
+
+private:
+    void readHandler(const boost::system::error_code &err, size_t bytes_transferred) {
+        if (err) {
+            return;
+        }
+        if (_result.received++ == 0) {
+            _start = std::chrono::steady_clock::now();
+        }
+        _result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+        read();
+    }
+};
+
+static void sendDatagrams(uint16_t port, size_t datagrams, size_t size) {
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    std::vector<char> payload(size, '\x05');
+    std::vector<iovec> iovecs(SEND_BATCH);
+    std::vector<mmsghdr> messages(SEND_BATCH);
+    for (size_t i = 0; i < SEND_BATCH; ++i) {
+        iovecs[i].iov_base = payload.data();
+        iovecs[i].iov_len = payload.size();
+        messages[i].msg_hdr = msghdr{};
+        messages[i].msg_hdr.msg_name = &address;
+        messages[i].msg_hdr.msg_namelen = sizeof(address);
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    for (size_t sent = 0; sent < datagrams; sent += SEND_BATCH) {
+        // not paced, the receiver rate is what is measured, what it can't keep up with is dropped by the kernel
+        ::sendmmsg(fd, messages.data(), SEND_BATCH, 0);
+    }
+    ::close(fd);
+}
+
+static Result run(bool uring, size_t datagrams, size_t size, std::string &stats) {
+    boost::asio::io_service ios(1);
+    boost::asio::ip::udp::socket socket(ios, boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    socket.set_option(boost::asio::socket_base::receive_buffer_size(1 << 24));
+    Result result;
+    std::chrono::steady_clock::time_point start;
+
+    std::shared_ptr<UringService> service;
+    if (uring) {
+        service = UringService::get(ios);
+        service->receive(socket.native_handle(), true, [&](const uint8_t *data, size_t length, const sockaddr *, socklen_t) {
+            if (result.received++ == 0) {
+                start = std::chrono::steady_clock::now();
+            }
+            result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }, [](int error) {
+            std::cerr << "receive error " << error << std::endl;
+        });
+    } else {
+        std::make_shared<EpollReceiver>(socket, result)->read();
+    }
+
+    std::thread sender(sendDatagrams, socket.local_endpoint().port(), datagrams, size);
+    std::thread runner([&ios, &result]() {
+        double cpu_start = threadCpuTime();
+        ios.run();
+        result.cpu_seconds = threadCpuTime() - cpu_start;
+    });
+    sender.join();
+    // leave time for the last datagrams to be received
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ios.stop();
+    runner.join();
+    if (service) {
+        stats = service->toJSON();
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    size_t datagrams = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    size_t size = argc > 2 ? std::stoul(argv[2]) : 100;
+
+    std::string stats;
+    Result epoll = run(false, datagrams, size, stats);
+    std::cout << "epoll:    " << epoll.received << "/" << datagrams << " datagrams, " << epoll.received / epoll.seconds / 1e6 << " Mpkt/s, "
+              << epoll.cpu_seconds / epoll.received * 1e9 << " ns of CPU per datagram" << std::endl;
+    if (!UringService::enable()) {
+        std::cout << "io_uring: not available" << std::endl;
+        return 0;
+    }
+    Result uring = run(true, datagrams, size, stats);
+    std::cout << "io_uring: " << uring.received << "/" << datagrams << " datagrams, " << uring.received / uring.seconds / 1e6 << " Mpkt/s, "
+              << uring.cpu_seconds / uring.received * 1e9 << " ns of CPU per datagram " << stats << std::endl;
+
+    return 0;
+}
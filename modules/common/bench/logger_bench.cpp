@@ -0,0 +1,58 @@
+// cost of a log line for the thread writing it: filtered out by the level, formatted by the caller as the modules
+// did before, and as an event whose fields are formatted by the thread of the logger. the lines are written to
+// logger_bench.txt, the queue drops what the writer can't keep up with
+// usage: logger_bench [lines per thread] [threads]
+
+#include <boost/asio.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "log/logger.h"
+
+template <typename Log>
+static void run(const char *label, size_t lines, size_t threads, const Log &log) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&log, lines, t]() {
+            for (size_t i = 0; i < lines; ++i) {
+                log(t, i);
+            }
+        });
+    }
+    for (auto &thread : pool) {
+        thread.join();
+    }
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+    std::cout << label << ": " << time.count() * 1e9 / lines << " ns per line and thread" << std::endl;
+    logger::flush();
+}
+
+int main(int argc, char *argv[]) {
+    size_t lines = argc > 1 ? std::stoul(argv[1]) : 100000;
+    size_t threads = argc > 2 ? std::stoul(argv[2]) : 4;
+
+    logger::setFilename("logger_bench.txt");
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), 6363);
+
+    logger::setMinimalLogLevel(logger::WARNING);
+    run("filtered", lines, threads, [&endpoint](size_t t, size_t i) {
+        logger::log(logger::INFO, "face with ID = {} connected to tcp://{}", {i, endpoint});
+    });
+
+    logger::setMinimalLogLevel(logger::INFO);
+    run("stringstream", lines, threads, [&endpoint](size_t t, size_t i) {
+        std::stringstream ss;
+        ss << "face with ID = " << i << " connected to tcp://" << endpoint;
+        logger::log(logger::INFO, ss.str());
+    });
+    run("event", lines, threads, [&endpoint](size_t t, size_t i) {
+        logger::log(logger::INFO, "face with ID = {} connected to tcp://{}", {i, endpoint});
+    });
+
+    return 0;
+}
\ No newline at end of file
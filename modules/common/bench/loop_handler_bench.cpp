@@ -0,0 +1,141 @@
+// the read and write loops of the faces over a local stream socket pair, with a boost::bind of shared_from_this() per
+// operation, as the faces did, and with a LoopHandler moved from one operation to the next. a read is of 1 byte, the
+// writes of 64 bytes go 16 at a time through a strand as the faces gather them, the peer end is served in between
+// usage: loop_handler_bench [operations...]
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+
+#include <unistd.h>
+
+#include "bench/bench.h"
+#include "network/loop_handler.h"
+
+namespace {
+    using Socket = boost::asio::local::stream_protocol::socket;
+
+    const size_t WRITE_SIZE = 64;
+    const size_t WRITE_LOOP = 16;
+
+    class BoundLoops : public std::enable_shared_from_this<BoundLoops> {
+    public:
+        Socket socket;
+        boost::asio::strand strand;
+        char buffer[WRITE_SIZE];
+        size_t reads = 0;
+        size_t writes = 0;
+
+        explicit BoundLoops(boost::asio::io_service &ios) : socket(ios), strand(ios) {
+
+        }
+
+        void read() {
+            boost::asio::async_read(socket, boost::asio::buffer(buffer, 1), boost::asio::transfer_at_least(1),
+                                    boost::bind(&BoundLoops::readHandler, shared_from_this(), _1, _2));
+        }
+
+        void write() {
+            boost::asio::async_write(socket, boost::asio::buffer(buffer, WRITE_SIZE),
+                                     strand.wrap(boost::bind(&BoundLoops::writeHandler, shared_from_this(), _1, _2)));
+        }
+
+    private:
+        void readHandler(const boost::system::error_code &err, size_t bytes_transferred) {
+            if (!err) {
+                ++reads;
+                read();
+            }
+        }
+
+        void writeHandler(const boost::system::error_code &err, size_t bytes_transferred) {
+            if (!err && --writes > 0) {
+                write();
+            }
+        }
+    };
+
+    class HandledLoops : public std::enable_shared_from_this<HandledLoops> {
+    public:
+        Socket socket;
+        boost::asio::strand strand;
+        char buffer[WRITE_SIZE];
+        size_t reads = 0;
+        size_t writes = 0;
+        HandlerMemory read_memory;
+        HandlerMemory write_memory;
+
+        explicit HandledLoops(boost::asio::io_service &ios) : socket(ios), strand(ios) {
+
+        }
+
+        void read() {
+            read(LoopHandler<HandledLoops>(shared_from_this(), &HandledLoops::readHandler, read_memory));
+        }
+
+        void write() {
+            write(LoopHandler<HandledLoops>(shared_from_this(), &HandledLoops::writeHandler, write_memory));
+        }
+
+    private:
+        void read(LoopHandler<HandledLoops> &&handler) {
+            boost::asio::async_read(socket, boost::asio::buffer(buffer, 1), boost::asio::transfer_at_least(1), std::move(handler));
+        }
+
+        void write(LoopHandler<HandledLoops> &&handler) {
+            boost::asio::async_write(socket, boost::asio::buffer(buffer, WRITE_SIZE), strand.wrap(std::move(handler)));
+        }
+
+        void readHandler(LoopHandler<HandledLoops> &&handler, const boost::system::error_code &err, size_t bytes_transferred) {
+            if (!err) {
+                ++reads;
+                read(std::move(handler));
+            }
+        }
+
+        void writeHandler(LoopHandler<HandledLoops> &&handler, const boost::system::error_code &err, size_t bytes_transferred) {
+            if (!err && --writes > 0) {
+                write(std::move(handler));
+            }
+        }
+    };
+
+    template <class Loops>
+    void run(const char *name, size_t count) {
+        boost::asio::io_service ios;
+        auto loops = std::make_shared<Loops>(ios);
+        Socket peer(ios);
+        boost::asio::local::connect_pair(loops->socket, peer);
+        char bytes[WRITE_SIZE * WRITE_LOOP] = {};
+
+        loops->read();
+        bench::measure("read loop", name, count, count, [&](size_t i) {
+            if (::write(peer.native_handle(), bytes, 1) != 1) {
+                return;
+            }
+            size_t reads = loops->reads;
+            while (loops->reads == reads) {
+                ios.run_one();
+            }
+        });
+
+        bench::measure("write loop of 16", name, count, count / WRITE_LOOP, [&](size_t i) {
+            loops->writes = WRITE_LOOP;
+            loops->write();
+            while (loops->writes > 0) {
+                ios.run_one();
+            }
+            boost::asio::read(peer, boost::asio::buffer(bytes, sizeof(bytes)));
+        });
+
+        loops->socket.close();
+        ios.run();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t count : bench::getSizes(argc, argv)) {
+        run<BoundLoops>("bind", count);
+        run<HandledLoops>("handler", count);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+// heap allocations and time per operation of a bounded LRU table of Names, with the former list of Names indexed
+// by toUri() next to the tree, with the recency links kept in the tree nodes, and with the emptied nodes pruned in
+// slices as the timers of Pit and LruCache do rather than by each eviction
+// usage: lru_bench [entries]
+
+#include <ndn-cxx/name.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tree/named_tree.h"
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+struct Entry {
+    int value = 0;
+
+    std::string toJSON() const {
+        return "{}";
+    }
+};
+
+// the former layout of Pit and LruCache
+class ListLru {
+private:
+    size_t _max_size;
+    NamedTree<Entry> _tree;
+    std::list<ndn::Name> _list;
+    std::unordered_map<std::string, std::list<ndn::Name>::iterator> _list_index;
+
+public:
+    explicit ListLru(size_t size) : _max_size(size) {
+
+    }
+
+    void insert(const ndn::Name &name, const std::shared_ptr<Entry> &value) {
+        _tree.insert(name, value);
+        _list_index[name.toUri()] = _list.emplace(_list.begin(), name);
+        if (_list.size() > _max_size) {
+            _tree.remove(*_list.rbegin());
+            _list_index.erase(_list.rbegin()->toUri());
+            _list.erase(--_list.end());
+        }
+    }
+
+    bool get(const ndn::Name &name) {
+        if (!_tree.find(name)) {
+            return false;
+        }
+        _list.splice(_list.begin(), _list, _list_index.at(name.toUri()));
+        return true;
+    }
+};
+
+class IntrusiveLru {
+private:
+    size_t _max_size;
+    NamedTree<Entry> _tree;
+
+public:
+    explicit IntrusiveLru(size_t size) : _max_size(size) {
+
+    }
+
+    void insert(const ndn::Name &name, const std::shared_ptr<Entry> &value) {
+        _tree.insert(name, value);
+        if (_tree.getPopulatedNodes() > _max_size) {
+            _tree.removeLeastRecent();
+        }
+    }
+
+    bool get(const ndn::Name &name) {
+        return static_cast<bool>(_tree.touch(name));
+    }
+};
+
+class DeferredLru {
+private:
+    static const size_t PRUNE_INTERVAL = 256;
+
+    size_t _max_size;
+    NamedTree<Entry> _tree;
+    size_t _inserts = 0;
+
+public:
+    explicit DeferredLru(size_t size) : _max_size(size) {
+        _tree.setDeferredPruning(true);
+    }
+
+    void insert(const ndn::Name &name, const std::shared_ptr<Entry> &value) {
+        _tree.insert(name, value);
+        if (_tree.getPopulatedNodes() > _max_size) {
+            _tree.removeLeastRecent();
+        }
+        if (++_inserts % PRUNE_INTERVAL == 0) {
+            _tree.prune(SIZE_MAX);
+        }
+    }
+
+    bool get(const ndn::Name &name) {
+        return static_cast<bool>(_tree.touch(name));
+    }
+};
+
+static std::vector<ndn::Name> makeNames(size_t count) {
+    std::vector<ndn::Name> names;
+    names.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        ndn::Name name("/bench/video");
+        name.append(ndn::Name::Component("object" + std::to_string(i / 100)));
+        name.appendSegment(i % 100);
+        names.emplace_back(std::move(name));
+    }
+    return names;
+}
+
+template <typename Lru>
+static void run(const char *label, size_t entries, const std::vector<ndn::Name> &names) {
+    Lru lru(entries);
+    // one value for all, only the allocations of the table itself are counted
+    auto value = std::make_shared<Entry>();
+    for (size_t i = 0; i < entries; ++i) {
+        lru.insert(names[i], value);
+    }
+
+    // every insert evicts the least recent entry
+    size_t before = allocations;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = entries; i < names.size(); ++i) {
+        lru.insert(names[i], value);
+    }
+    std::chrono::duration<double> insert_time = std::chrono::steady_clock::now() - start;
+    double insert_allocations = static_cast<double>(allocations - before) / (names.size() - entries);
+
+    size_t hits = 0;
+    before = allocations;
+    start = std::chrono::steady_clock::now();
+    for (size_t i = names.size() - entries; i < names.size(); ++i) {
+        hits += lru.get(names[i]);
+    }
+    std::chrono::duration<double> hit_time = std::chrono::steady_clock::now() - start;
+    double hit_allocations = static_cast<double>(allocations - before) / entries;
+
+    std::cout << label << ": insert with eviction " << insert_allocations << " allocations, "
+              << insert_time.count() * 1e9 / (names.size() - entries) << " ns, hit " << hit_allocations
+              << " allocations, " << hit_time.count() * 1e9 / entries << " ns"
+              << (hits == entries ? "" : " (missing entries)") << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    size_t entries = argc > 1 ? std::stoul(argv[1]) : 100000;
+    auto names = makeNames(entries * 2);
+
+    run<ListLru>("list     ", entries, names);
+    run<IntrusiveLru>("intrusive", entries, names);
+    run<DeferredLru>("deferred ", entries, names);
+
+    return 0;
+}
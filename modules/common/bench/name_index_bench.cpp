@@ -0,0 +1,104 @@
+// longest prefix match cost of the tree, hash and static NameIndex engines on a FIB dump, one prefix URI per line as
+// printed by `nfdc fib list | awk '{print $1}'`, looked up with Interests below each prefix and below none of them
+// usage: name_index_bench fib_dump [lookups]
+
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/name.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "network/name_view.h"
+#include "tree/name_index.h"
+
+struct Entry {
+    int value = 0;
+
+    std::string toJSON() const {
+        return "{}";
+    }
+};
+
+static std::vector<ndn::Name> readPrefixes(const char *path) {
+    std::vector<ndn::Name> prefixes;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] != '/') {
+            continue;
+        }
+        try {
+            prefixes.emplace_back(line);
+        } catch (const std::exception &e) {
+            std::cerr << "skipping " << line << ": " << e.what() << std::endl;
+        }
+    }
+    return prefixes;
+}
+
+// a tenth of the Interests match no prefix at all, the others extend a random prefix by a few components
+static std::vector<ndn::Block> makeInterests(const std::vector<ndn::Name> &prefixes, size_t lookups) {
+    std::vector<ndn::Block> interests;
+    interests.reserve(lookups);
+    std::mt19937 rng(42);
+    for (size_t i = 0; i < lookups; ++i) {
+        ndn::Name name;
+        if (i % 10 == 0) {
+            name.append(ndn::Name::Component("unrouted")).append(ndn::Name::Component(std::to_string(i)));
+        } else {
+            name = prefixes[rng() % prefixes.size()];
+            name.append(ndn::Name::Component("object" + std::to_string(rng() % 1000)));
+            name.appendSegment(rng() % 100);
+        }
+        interests.emplace_back(ndn::Interest(name).wireEncode());
+    }
+    return interests;
+}
+
+static void run(const std::string &engine, const std::vector<ndn::Name> &prefixes, const std::vector<ndn::Block> &interests) {
+    auto index = NameIndex<Entry>::create(engine);
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &prefix : prefixes) {
+        index->insert(prefix, std::make_shared<Entry>(), false);
+    }
+    std::chrono::duration<double> insert_time = std::chrono::steady_clock::now() - start;
+
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (const auto &interest : interests) {
+        // as on the forwarding path, the Name is read from the wire without decoding the Interest
+        if (index->findLastValueUntil(NameView(interest))) {
+            ++found;
+        }
+    }
+    std::chrono::duration<double> lookup_time = std::chrono::steady_clock::now() - start;
+
+    std::cout << engine << ": insert " << insert_time.count() * 1e9 / prefixes.size() << " ns, lookup "
+              << lookup_time.count() * 1e9 / interests.size() << " ns, " << found << "/" << interests.size()
+              << " matched" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " fib_dump [lookups]" << std::endl;
+        return 1;
+    }
+    auto prefixes = readPrefixes(argv[1]);
+    if (prefixes.empty()) {
+        std::cerr << "no prefix in " << argv[1] << std::endl;
+        return 1;
+    }
+    size_t lookups = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    auto interests = makeInterests(prefixes, lookups);
+
+    run("tree", prefixes, interests);
+    run("hash", prefixes, interests);
+    run("static", prefixes, interests);
+
+    return 0;
+}
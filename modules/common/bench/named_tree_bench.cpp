@@ -0,0 +1,134 @@
+// heap bytes per entry and lookup cost of the former node layout and of the arena NamedTree, on content store names
+// usage: named_tree_bench [entries]
+
+#include <ndn-cxx/name.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <malloc.h>
+
+#include "tree/named_tree.h"
+
+struct Entry {
+    int value = 0;
+
+    std::string toJSON() const {
+        return "{}";
+    }
+};
+
+// the former layout: a full Name, a parent link and a map of children per node, plus an index of every Name
+class LegacyNamedTree {
+private:
+    struct NamedNode {
+        const ndn::Name name;
+        const std::weak_ptr<NamedNode> parent;
+        std::map<ndn::Name::Component, std::shared_ptr<NamedNode>> children;
+        std::shared_ptr<Entry> value;
+
+        NamedNode(ndn::Name name, const std::shared_ptr<NamedNode> &parent) : name(std::move(name)), parent(parent) {
+
+        }
+    };
+
+    std::shared_ptr<NamedNode> _root;
+    std::map<ndn::Name, std::weak_ptr<NamedNode>> _nodes;
+
+public:
+    LegacyNamedTree() : _root(std::make_shared<NamedNode>("/", nullptr)) {
+        _nodes.emplace("/", _root);
+    }
+
+    void insert(const ndn::Name &name, const std::shared_ptr<Entry> &value) {
+        auto node = _root;
+        for (size_t i = 0; i < name.size(); ++i) {
+            auto it = node->children.find(name.get(i));
+            if (it == node->children.end()) {
+                ndn::Name child_name(node->name);
+                child_name.append(name.get(i));
+                auto child = std::make_shared<NamedNode>(child_name, node);
+                it = node->children.emplace(name.get(i), child).first;
+                _nodes.emplace(child_name, child);
+            }
+            node = it->second;
+        }
+        node->value = value;
+    }
+
+    std::vector<std::pair<ndn::Name, std::shared_ptr<Entry>>> findAllUntil(const ndn::Name &name) const {
+        std::vector<std::pair<ndn::Name, std::shared_ptr<Entry>>> values;
+        auto node = _root;
+        for (const auto &component : name) {
+            auto it = node->children.find(component);
+            if (it == node->children.end()) {
+                break;
+            }
+            node = it->second;
+            if (node->value) {
+                values.emplace_back(node->name, node->value);
+            }
+        }
+        return values;
+    }
+};
+
+// large blocks such as the arena are mmapped and not counted in uordblks
+static size_t heapBytes() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+// /ndn/bench/video<v>/frame<f>/<segment>, 10 segments per frame and 1000 frames per video
+static std::vector<ndn::Name> makeNames(size_t entries) {
+    std::vector<ndn::Name> names;
+    names.reserve(entries);
+    for (size_t i = 0; i < entries; ++i) {
+        ndn::Name name("/ndn/bench");
+        name.append(ndn::Name::Component("video" + std::to_string(i / 10000)))
+            .append(ndn::Name::Component("frame" + std::to_string(i / 10 % 1000)))
+            .appendSegment(i % 10);
+        names.emplace_back(std::move(name));
+    }
+    return names;
+}
+
+template <typename Tree, typename Lookup>
+static void run(const char *label, const std::vector<ndn::Name> &names, const Lookup &lookup) {
+    size_t before = heapBytes();
+    std::unique_ptr<Tree> tree(new Tree());
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &name : names) {
+        tree->insert(name, std::make_shared<Entry>());
+    }
+    std::chrono::duration<double> insert_time = std::chrono::steady_clock::now() - start;
+    size_t bytes = heapBytes() - before;
+
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (const auto &name : names) {
+        found += lookup(*tree, name);
+    }
+    std::chrono::duration<double> lookup_time = std::chrono::steady_clock::now() - start;
+
+    std::cout << label << ": " << bytes / names.size() << " bytes/entry, insert "
+              << insert_time.count() * 1e9 / names.size() << " ns, lookup " << lookup_time.count() * 1e9 / names.size()
+              << " ns" << (found == names.size() ? "" : " (missing entries)") << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    size_t entries = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    auto names = makeNames(entries);
+
+    run<LegacyNamedTree>("legacy", names, [](const LegacyNamedTree &tree, const ndn::Name &name) {
+        return tree.findAllUntil(name).size();
+    });
+    run<NamedTree<Entry>>("arena ", names, [](const NamedTree<Entry> &tree, const ndn::Name &name) {
+        return tree.findValuesUntil(name).size();
+    });
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+// time of a content store lookup by prefix in deep segment hierarchies where the first segments went stale, with the
+// former loop which removes each stale entry found and searches again from the Interest Name, and with a single
+// ordered walk of the subtree which skips them
+// usage: selector_bench [objects] [segments] [stale]
+
+#include <ndn-cxx/name.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tree/named_tree.h"
+
+struct Entry {
+    ndn::Name name;
+    bool valid = true;
+
+    std::string toJSON() const {
+        return "{}";
+    }
+};
+
+// /bench/video/objectK/v1/segN, the lowest segments of each object stale
+static void fill(NamedTree<Entry> &tree, std::vector<std::shared_ptr<Entry>> &entries, size_t objects,
+                 size_t segments, size_t stale) {
+    for (size_t i = 0; i < objects; ++i) {
+        for (size_t j = 0; j < segments; ++j) {
+            auto entry = std::make_shared<Entry>();
+            entry->name = ndn::Name("/bench/video");
+            entry->name.append(ndn::Name::Component("object" + std::to_string(i))).append("v1").appendSegment(j);
+            entry->valid = j >= stale;
+            tree.insert(entry->name, entry);
+            entries.emplace_back(entry);
+        }
+    }
+}
+
+static std::shared_ptr<Entry> restartLoop(NamedTree<Entry> &tree, const ndn::Name &prefix) {
+    auto pair = tree.findFirstFrom(prefix, false);
+    while (pair.second) {
+        if (pair.second->valid) {
+            return pair.second;
+        }
+        tree.remove(pair.first);
+        pair = tree.findFirstFrom(prefix, false);
+    }
+    return nullptr;
+}
+
+static std::shared_ptr<Entry> singleWalk(NamedTree<Entry> &tree, const ndn::Name &prefix) {
+    std::vector<Entry*> stale;
+    auto entry = tree.findFirstMatch(prefix, false, [&stale](const std::shared_ptr<Entry> &candidate) {
+        if (candidate->valid) {
+            return true;
+        }
+        stale.emplace_back(candidate.get());
+        return false;
+    });
+    for (Entry *e : stale) {
+        ndn::Name name = e->name;
+        tree.remove(name);
+    }
+    return entry;
+}
+
+template <typename Lookup>
+static void run(const char *label, const Lookup &lookup, size_t objects, size_t segments, size_t stale) {
+    // a fresh tree for each run, not timed, the stale entries are only met by the first lookup of each object
+    NamedTree<Entry> tree;
+    std::vector<std::shared_ptr<Entry>> entries;
+    fill(tree, entries, objects, segments, stale);
+    std::vector<ndn::Name> prefixes;
+    for (size_t i = 0; i < objects; ++i) {
+        prefixes.emplace_back(ndn::Name("/bench/video").append(ndn::Name::Component("object" + std::to_string(i))));
+    }
+
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &prefix : prefixes) {
+        hits += static_cast<bool>(lookup(tree, prefix));
+    }
+    std::chrono::duration<double> first_time = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (const auto &prefix : prefixes) {
+        hits += static_cast<bool>(lookup(tree, prefix));
+    }
+    std::chrono::duration<double> next_time = std::chrono::steady_clock::now() - start;
+
+    std::cout << label << ": first lookup " << first_time.count() * 1e9 / objects << " ns, next lookup "
+              << next_time.count() * 1e9 / objects << " ns"
+              << (hits == 2 * objects || stale >= segments ? "" : " (missing entries)") << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    size_t objects = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t segments = argc > 2 ? std::stoul(argv[2]) : 1000;
+    size_t stale = argc > 3 ? std::stoul(argv[3]) : 500;
+
+    run("restart", restartLoop, objects, segments, stale);
+    run("walk   ", singleWalk, objects, segments, stale);
+
+    return 0;
+}
\ No newline at end of file
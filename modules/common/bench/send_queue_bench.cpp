@@ -0,0 +1,136 @@
+// compares the former strand-dispatched send path with the MPSC queue used by the faces
+// usage: send_queue_bench [packets per thread]
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "network/buffer_pool.h"
+#include "network/mpsc_queue.h"
+#include "network/ndn_packet.h"
+
+static const size_t PACKET_SIZE = 100;
+
+// writer fed through the strand, one bind object and one strand handler per packet
+class StrandSink : public std::enable_shared_from_this<StrandSink> {
+private:
+    boost::asio::io_service::strand _strand;
+    std::deque<NdnPacket> _queue;
+    std::atomic<size_t> &_written;
+
+public:
+    StrandSink(boost::asio::io_service &ios, std::atomic<size_t> &written) : _strand(ios), _written(written) {
+
+    }
+
+    void send(const NdnPacket &packet) {
+        _strand.post(boost::bind(&StrandSink::sendImpl, shared_from_this(), packet));
+    }
+
+private:
+    void sendImpl(const NdnPacket &packet) {
+        _queue.push_back(packet);
+        while (!_queue.empty()) {
+            _queue.pop_front();
+            ++_written;
+        }
+    }
+};
+
+// writer fed through the MPSC queue, posted on the strand only when it went idle
+class QueueSink : public std::enable_shared_from_this<QueueSink> {
+private:
+    boost::asio::io_service::strand _strand;
+    MpscQueue<NdnPacket> _queue;
+    std::atomic<bool> _is_writing;
+    std::atomic<size_t> &_written;
+
+public:
+    QueueSink(boost::asio::io_service &ios, std::atomic<size_t> &written)
+            : _strand(ios)
+            , _queue(1 << 12)
+            , _is_writing(false)
+            , _written(written) {
+
+    }
+
+    void send(const NdnPacket &packet) {
+        // a face drops the packet when its queue is full, the benchmark waits instead
+        while (!_queue.emplace(packet)) {
+            std::this_thread::yield();
+        }
+        if (!_is_writing.exchange(true)) {
+            _strand.post(boost::bind(&QueueSink::write, shared_from_this()));
+        }
+    }
+
+private:
+    void write() {
+        for (;;) {
+            while (_queue.peek(0)) {
+                _queue.pop();
+                ++_written;
+            }
+            _is_writing.exchange(false);
+            if (!_queue.peek(0) || _is_writing.exchange(true)) {
+                return;
+            }
+        }
+    }
+};
+
+template <typename Sink>
+static double run(size_t threads, size_t packets) {
+    boost::asio::io_service ios;
+    std::atomic<size_t> written(0);
+    auto sink = std::make_shared<Sink>(ios, written);
+    // an Interest TLV header followed by a dummy value
+    std::string wire(PACKET_SIZE, '\x05');
+    wire[1] = PACKET_SIZE - 2;
+    const NdnPacket packet(ndn::Block(BufferPool::local().copy(wire.data(), wire.size())));
+
+    std::unique_ptr<boost::asio::io_service::work> work(new boost::asio::io_service::work(ios));
+    boost::thread_group pool;
+    for (size_t i = 0; i < threads; ++i) {
+        pool.create_thread(boost::bind(&boost::asio::io_service::run, &ios));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    // producers have their own threads, so a full queue never blocks the writer
+    boost::thread_group producers;
+    for (size_t i = 0; i < threads; ++i) {
+        producers.create_thread([sink, &packet, packets]() {
+            for (size_t j = 0; j < packets; ++j) {
+                sink->send(packet);
+            }
+        });
+    }
+    producers.join_all();
+    work.reset();
+    pool.join_all();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (written != threads * packets) {
+        std::cerr << "only " << written << " packets written out of " << threads * packets << std::endl;
+    }
+    return threads * packets / elapsed.count() / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    size_t packets = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    for (size_t threads : {1, 4, 8}) {
+        double strand = run<StrandSink>(threads, packets);
+        double queue = run<QueueSink>(threads, packets);
+        std::cout << threads << " thread(s): strand " << strand << " Mpkt/s, mpsc " << queue << " Mpkt/s" << std::endl;
+    }
+
+    return 0;
+}
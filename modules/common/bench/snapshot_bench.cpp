@@ -0,0 +1,83 @@
+// time to fill a NamedTree with routes inserted one by one, bulk inserted, and read back from a name_snapshot
+// usage: snapshot_bench [routes]
+
+#include <ndn-cxx/name.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tree/named_tree.h"
+
+struct Entry {
+    uint8_t value = 0;
+
+    std::string toJSON() const {
+        return "{}";
+    }
+};
+
+// shuffled, as routes come from the manager
+static std::vector<ndn::Name> makeRoutes(size_t count) {
+    std::vector<ndn::Name> routes;
+    routes.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        ndn::Name name;
+        name.append(ndn::Name::Component("site" + std::to_string(i % 100)));
+        name.append(ndn::Name::Component("app" + std::to_string(i / 100 % 1000)));
+        name.append(ndn::Name::Component("prefix" + std::to_string(i / 100000)));
+        routes.emplace_back(std::move(name));
+    }
+    std::shuffle(routes.begin(), routes.end(), std::mt19937(42));
+    return routes;
+}
+
+static double since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    auto routes = makeRoutes(count);
+    auto value = std::make_shared<Entry>();
+
+    auto start = std::chrono::steady_clock::now();
+    NamedTree<Entry> one_by_one;
+    for (const auto &route : routes) {
+        one_by_one.insert(route, value);
+    }
+    std::cout << "insert one by one: " << since(start) << " s" << std::endl;
+
+    std::vector<std::pair<ndn::Name, std::shared_ptr<Entry>>> entries;
+    entries.reserve(count);
+    for (const auto &route : routes) {
+        entries.emplace_back(route, value);
+    }
+    start = std::chrono::steady_clock::now();
+    NamedTree<Entry> bulk;
+    bulk.insert(std::move(entries));
+    std::cout << "bulk insert: " << since(start) << " s" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    std::string snapshot;
+    bulk.writeSnapshot(snapshot, [](const Entry &entry) {
+        return std::string(1, static_cast<char>(entry.value));
+    });
+    std::cout << "write snapshot: " << since(start) << " s, " << snapshot.size() << " bytes" << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    NamedTree<Entry> loaded;
+    loaded.readSnapshot(reinterpret_cast<const uint8_t*>(snapshot.data()), snapshot.size(), [](const uint8_t *wire, size_t length) {
+        auto entry = std::make_shared<Entry>();
+        entry->value = length > 0 ? wire[0] : 0;
+        return entry;
+    });
+    std::cout << "read snapshot: " << since(start) << " s, " << loaded.getPopulatedNodes() << "/" << count
+              << " routes" << std::endl;
+
+    return 0;
+}
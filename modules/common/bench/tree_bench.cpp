@@ -0,0 +1,56 @@
+// insert, lookup, longest prefix match, touch and eviction in NamedTree, with the heap it takes per entry
+// usage: tree_bench [entries...]
+
+#include "bench/bench.h"
+#include "tree/named_tree.h"
+
+struct Entry {
+    int value = 0;
+
+    std::string toJSON() const {
+        return "{}";
+    }
+};
+
+static void run(size_t entries) {
+    auto names = bench::makeNames(entries);
+    auto misses = bench::makeNames(entries, entries);
+    auto order = bench::makeOrder(entries);
+    // one value for all, only the tree itself is counted
+    auto value = std::make_shared<Entry>();
+
+    size_t before = bench::getHeapBytes();
+    std::unique_ptr<NamedTree<Entry>> tree(new NamedTree<Entry>());
+    bench::measure("NamedTree", "insert", entries, entries, [&](size_t i) {
+        tree->insert(names[i], value);
+    });
+    bench::printMemory("NamedTree", entries, bench::getHeapBytes() - before);
+
+    size_t found = 0;
+    bench::measure("NamedTree", "find", entries, entries, [&](size_t i) {
+        found += static_cast<bool>(tree->find(names[order[i]]));
+    });
+    bench::measure("NamedTree", "miss", entries, entries, [&](size_t i) {
+        found += static_cast<bool>(tree->find(misses[order[i]]));
+    });
+    bench::measure("NamedTree", "prefix", entries, entries, [&](size_t i) {
+        found += static_cast<bool>(tree->findLastValueUntil(names[order[i]]));
+    });
+    bench::measure("NamedTree", "touch", entries, entries, [&](size_t i) {
+        found += static_cast<bool>(tree->touch(names[order[i]]));
+    });
+    bench::measure("NamedTree", "evict", entries, entries, [&](size_t i) {
+        tree->removeLeastRecent();
+    });
+    if (found != entries * 3 || tree->getPopulatedNodes() != 0) {
+        std::printf("NamedTree: unexpected entries\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    for (size_t entries : bench::getSizes(argc, argv)) {
+        run(entries);
+    }
+
+    return 0;
+}
\ No newline at end of file
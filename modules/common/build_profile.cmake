@@ -0,0 +1,77 @@
+# build types and optimization switches shared by the modules, each one includes this after setting its flags, and
+# ../common inherits them, e.g. cmake -DCMAKE_BUILD_TYPE=Release -DNDNMS_LTO=ON -DNDNMS_MARCH=native
+#
+#   CMAKE_BUILD_TYPE  Release, -O2 without assertions, or Profile, the same with symbols and frame pointers for perf,
+#                     none keeps the plain -O2 of the modules
+#   NDNMS_LTO         link-time optimization, ThinLTO with clang and parallel LTO with gcc
+#   NDNMS_MARCH       -march of the binaries, e.g. native or skylake, the compiler default if empty
+#   NDNMS_PGO         GENERATE for binaries which write their profiles in NDNMS_PGO_DIR when they exit, USE to build
+#                     with them, pgo.sh does both around a run of ndnms-bench
+#   NDNMS_USDT        the USDT probes of log/probes.h, built when <sys/sdt.h> is found and left out when OFF
+set(CMAKE_CXX_FLAGS_RELEASE "-O2 -DNDEBUG")
+set(CMAKE_CXX_FLAGS_PROFILE "-O2 -DNDEBUG -g -fno-omit-frame-pointer")
+set(CMAKE_EXE_LINKER_FLAGS_PROFILE "")
+
+option(NDNMS_LTO "link-time optimization of the modules and of ndnms_net" OFF)
+set(NDNMS_MARCH "" CACHE STRING "-march of the binaries, e.g. native")
+set(NDNMS_PGO "OFF" CACHE STRING "profile-guided optimization: OFF, GENERATE or USE")
+set_property(CACHE NDNMS_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(NDNMS_PGO_DIR "${CMAKE_BINARY_DIR}/pgo" CACHE PATH "where the instrumented binaries write their profiles")
+option(NDNMS_USDT "USDT probes on the packet paths, nops until a tracer attaches" ON)
+
+set(NDNMS_IS_CLANG OFF)
+if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    set(NDNMS_IS_CLANG ON)
+endif()
+
+if(NOT NDNMS_USDT)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DNDNMS_NO_USDT")
+endif()
+
+if(NDNMS_MARCH)
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -march=${NDNMS_MARCH}")
+endif()
+
+if(NDNMS_LTO)
+    # ndnms_net is a static library, its archive must keep the IR objects for the link of the module
+    if(NDNMS_IS_CLANG)
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -flto=thin")
+        set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} -flto=thin")
+        find_program(NDNMS_LLD ld.lld)
+        if(NDNMS_LLD)
+            set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} -fuse-ld=lld")
+        endif()
+        find_program(NDNMS_AR NAMES llvm-ar)
+        find_program(NDNMS_RANLIB NAMES llvm-ranlib)
+    else()
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -flto=auto")
+        set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} -flto=auto")
+        find_program(NDNMS_AR NAMES gcc-ar)
+        find_program(NDNMS_RANLIB NAMES gcc-ranlib)
+    endif()
+    if(NDNMS_AR AND NDNMS_RANLIB)
+        set(CMAKE_AR ${NDNMS_AR})
+        set(CMAKE_RANLIB ${NDNMS_RANLIB})
+    else()
+        message(WARNING "no LTO-aware ar/ranlib found, ndnms_net is linked without its IR")
+    endif()
+endif()
+
+if(NDNMS_PGO STREQUAL "GENERATE")
+    # the counters are shared by the threads of the multi-threaded modules
+    set(NDNMS_PGO_FLAGS "-fprofile-generate=${NDNMS_PGO_DIR}")
+    if(NOT NDNMS_IS_CLANG)
+        set(NDNMS_PGO_FLAGS "${NDNMS_PGO_FLAGS} -fprofile-update=atomic")
+    endif()
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${NDNMS_PGO_FLAGS}")
+    set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${NDNMS_PGO_FLAGS}")
+elseif(NDNMS_PGO STREQUAL "USE")
+    # clang reads the merged profile pgo.sh writes, gcc the .gcda files next to the paths of the objects
+    if(NDNMS_IS_CLANG)
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fprofile-use=${NDNMS_PGO_DIR}/merged.profdata -Wno-profile-instr-unprofiled")
+    else()
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fprofile-use=${NDNMS_PGO_DIR} -fprofile-partial-training -Wno-missing-profile")
+    endif()
+elseif(NOT NDNMS_PGO STREQUAL "OFF")
+    message(FATAL_ERROR "NDNMS_PGO is OFF, GENERATE or USE, not ${NDNMS_PGO}")
+endif()
\ No newline at end of file
@@ -0,0 +1,80 @@
+// libFuzzer target of the stream framing of TcpFace, tlv_reader::frame: the packets framed must be the same whether
+// the stream comes at once or in two reads split anywhere, a complete frame must be a well formed TLV header
+// whose value ends with it, and the resync must skip exactly the bytes which can't start a packet. build with -DBUILD_FUZZERS=ON and clang, run as tlv_frame_fuzz [corpus_dir]
+
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "network/tlv_reader.h"
+
+namespace {
+
+    const size_t MAX_PACKET_SIZE = 8800;
+
+    // the face loop on buffer from begin: the frames found are appended to frames as (offset, size) from base,
+    // returns where the next read has to resume
+    size_t proceed(const std::vector<uint8_t> &buffer, size_t begin, size_t base, std::vector<std::pair<size_t, size_t>> &frames) {
+        const uint8_t *start = buffer.data();
+        const uint8_t *current = start + begin;
+        const uint8_t *end = start + buffer.size();
+        while (current < end) {
+            if (!tlv_reader::isPacketStart(current[0])) {
+                // the vector scan must stop on the same byte as the scalar one
+                const uint8_t *next = tlv_reader::findPacketStart(current, end);
+                for (const uint8_t *skipped = current; skipped != next; ++skipped) {
+                    if (tlv_reader::isPacketStart(*skipped)) {
+                        std::abort();
+                    }
+                }
+                if (next != end && !tlv_reader::isPacketStart(*next)) {
+                    std::abort();
+                }
+                current = next;
+                continue;
+            }
+            size_t size = 0;
+            auto frame = tlv_reader::frame(current, end, MAX_PACKET_SIZE, size);
+            if (frame == tlv_reader::PARTIAL) {
+                break;
+            } else if (frame == tlv_reader::OVERSIZED) {
+                ++current;
+                continue;
+            }
+            if (size > static_cast<size_t>(end - current) || size > MAX_PACKET_SIZE) {
+                std::abort();
+            }
+            // readHeader throws on a truncated element, the value must end with the frame
+            const uint8_t *value = current;
+            uint32_t type;
+            size_t length = tlv_reader::readHeader(value, current + size, type);
+            if (value + length != current + size) {
+                std::abort();
+            }
+            frames.emplace_back(base + (current - start), size);
+            current += size;
+        }
+        return current - start;
+    }
+
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    std::vector<uint8_t> whole(data, data + size);
+    std::vector<std::pair<size_t, size_t>> expected;
+    proceed(whole, 0, 0, expected);
+
+    // the first read stops at split, the bytes left unframed are kept in front of the second one as in the chunk
+    size_t split = size > 0 ? data[0] % (size + 1) : 0;
+    std::vector<uint8_t> first(data, data + split);
+    std::vector<std::pair<size_t, size_t>> frames;
+    size_t resume = proceed(first, 0, 0, frames);
+    std::vector<uint8_t> second(data + resume, data + size);
+    proceed(second, 0, resume, frames);
+
+    if (frames != expected) {
+        std::abort();
+    }
+    return 0;
+}
\ No newline at end of file
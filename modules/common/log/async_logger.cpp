@@ -0,0 +1,52 @@
+#include "async_logger.h"
+
+AsyncLogger::AsyncLogger(size_t capacity)
+        : _capacity(capacity)
+        , _thread(&AsyncLogger::run, this) {
+
+}
+
+AsyncLogger::~AsyncLogger() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _is_stopped = true;
+    }
+    _condition.notify_one();
+    _thread.join();
+}
+
+void AsyncLogger::run() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _condition.wait(lock, [this]() {
+            return _is_stopped || !_messages.empty();
+        });
+        if (_messages.empty()) {
+            return;
+        }
+        Message message = std::move(_messages.front());
+        _messages.pop_front();
+        lock.unlock();
+        logger::log(message.level, message.build());
+        lock.lock();
+    }
+}
+
+bool AsyncLogger::log(logger::Level level, MessageBuilder build) {
+    {
+        // only held to queue the message, never while one is written
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_messages.size() >= _capacity) {
+            ++_dropped;
+            return false;
+        }
+        _messages.push_back({level, std::move(build)});
+    }
+    _condition.notify_one();
+    return true;
+}
+
+size_t AsyncLogger::getDropped() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "logger.h"
+
+// messages handed to a thread of their own which writes them through logger::log, so that the packet path never
+// waits on the log file. a message is given as a function building it, the formatting is done on that thread too.
+// the queue is bounded, the messages which don't fit are dropped and counted
+class AsyncLogger {
+public:
+    static const size_t DEFAULT_CAPACITY = 1024;
+
+    using MessageBuilder = std::function<std::string()>;
+
+private:
+    struct Message {
+        logger::Level level;
+        MessageBuilder build;
+    };
+
+    const size_t _capacity;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    std::deque<Message> _messages;
+    size_t _dropped = 0;
+    bool _is_stopped = false;
+    std::thread _thread;
+
+    void run();
+
+public:
+    explicit AsyncLogger(size_t capacity = DEFAULT_CAPACITY);
+
+    // the messages queued are written before
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // false if the queue is full, the message is then dropped
+    bool log(logger::Level level, MessageBuilder build);
+
+    size_t getDropped();
+};
\ No newline at end of file
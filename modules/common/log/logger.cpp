@@ -0,0 +1,245 @@
+#include "logger.h"
+
+#include <boost/asio/ip/address.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <thread>
+
+#include "../network/mpsc_queue.h"
+
+namespace {
+    const char* const LEVEL_OUTPUT_STRINGS[] = {"[INFO] ", "[WARNING] ", "[ERROR] "};
+    const size_t MAX_FIELDS = 4;
+
+    struct Record {
+        logger::Level level;
+        // null for a message formatted by the caller
+        const char *text;
+        std::string message;
+        size_t field_count;
+        logger::Field fields[MAX_FIELDS];
+
+        Record(logger::Level level, const std::string &message)
+                : level(level)
+                , text(nullptr)
+                , message(message)
+                , field_count(0)
+                , fields{0, 0, 0, 0} {
+
+        }
+
+        Record(logger::Level level, const char *text, std::initializer_list<logger::Field> fields)
+                : level(level)
+                , text(text)
+                , field_count(std::min(fields.size(), MAX_FIELDS))
+                , fields{0, 0, 0, 0} {
+            std::copy(fields.begin(), fields.begin() + field_count, this->fields);
+        }
+
+        void format(std::ostream &os) const {
+            os << LEVEL_OUTPUT_STRINGS[level];
+            if (!text) {
+                os << message;
+                return;
+            }
+            size_t field = 0;
+            for (const char *c = text; *c; ++c) {
+                if (c[0] == '{' && c[1] == '}' && field < field_count) {
+                    fields[field++].format(os);
+                    ++c;
+                } else {
+                    os << *c;
+                }
+            }
+        }
+    };
+
+    // the thread writing the records, started with the first one and stopped at exit once the queue is empty
+    class Writer {
+    private:
+        static const size_t QUEUE_SIZE = 1 << 12;
+
+        MpscQueue<Record> _queue;
+        std::atomic<logger::Level> _level{logger::INFO};
+        std::atomic<bool> _is_tee{false};
+        std::atomic<uint64_t> _dropped{0};
+        std::atomic<uint64_t> _pushed{0};
+        std::atomic<uint64_t> _written{0};
+        // the records are only waited for while the queue is empty, the writer polls then rather than being woken
+        // by each push
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::ofstream _file;
+        bool _is_stopped = false;
+        std::thread _thread;
+
+        void run() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (true) {
+                uint64_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+                if (dropped > 0) {
+                    std::stringstream ss;
+                    ss << dropped << " log messages dropped, the queue was full";
+                    write(Record(logger::WARNING, ss.str()));
+                }
+                size_t written = 0;
+                while (Record *record = _queue.peek(0)) {
+                    write(*record);
+                    _queue.pop();
+                    ++written;
+                }
+                if (written > 0) {
+                    if (_file) {
+                        _file.flush();
+                    }
+                    if (_is_tee) {
+                        std::cout.flush();
+                    }
+                    _written.fetch_add(written, std::memory_order_release);
+                    _condition.notify_all();
+                    continue;
+                }
+                if (_is_stopped) {
+                    return;
+                }
+                _condition.wait_for(lock, std::chrono::milliseconds(10));
+            }
+        }
+
+        void write(const Record &record) {
+            if (_file) {
+                record.format(_file);
+                _file << '\n';
+            }
+            if (_is_tee) {
+                record.format(std::cout);
+                std::cout << '\n';
+            }
+        }
+
+    public:
+        Writer() : _queue(QUEUE_SIZE), _thread(&Writer::run, this) {
+
+        }
+
+        ~Writer() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _is_stopped = true;
+            }
+            _condition.notify_all();
+            _thread.join();
+        }
+
+        void setFilename(const std::string &filename) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _file.open(filename);
+            if (!_file) {
+                std::cerr << "logger can't open this file" << std::endl;
+            }
+        }
+
+        void setTee(bool state) {
+            _is_tee = state;
+        }
+
+        void setLevel(logger::Level level) {
+            _level.store(level, std::memory_order_relaxed);
+        }
+
+        bool isEnabled(logger::Level level) const {
+            return level >= _level.load(std::memory_order_relaxed);
+        }
+
+        template <typename... Args>
+        void push(Args&&... args) {
+            if (_queue.emplace(std::forward<Args>(args)...)) {
+                _pushed.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void flush() {
+            uint64_t pushed = _pushed.load(std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.notify_all();
+            _condition.wait(lock, [this, pushed]() {
+                return _written.load(std::memory_order_acquire) >= pushed;
+            });
+        }
+    };
+
+    Writer& writer() {
+        static Writer writer;
+        return writer;
+    }
+}
+
+void logger::Field::setText(const char *text, size_t size) {
+    _text_size = static_cast<uint8_t>(std::min(size, TEXT_SIZE));
+    std::memcpy(_text, text, _text_size);
+}
+
+logger::Field::Field(const std::string &text) : _type(TEXT) {
+    setText(text.data(), text.size());
+}
+
+logger::Field::Field(const char *text) : _type(TEXT) {
+    setText(text, std::strlen(text));
+}
+
+void logger::Field::format(std::ostream &os) const {
+    switch (_type) {
+        case NUMBER:
+            os << _number;
+            break;
+        case ENDPOINT:
+            if (_is_v6) {
+                os << '[' << boost::asio::ip::address_v6(_address) << "]:" << _port;
+            } else {
+                boost::asio::ip::address_v4::bytes_type bytes;
+                std::copy(_address.begin(), _address.begin() + bytes.size(), bytes.begin());
+                os << boost::asio::ip::address_v4(bytes) << ':' << _port;
+            }
+            break;
+        case TEXT:
+            os.write(_text, _text_size);
+            break;
+    }
+}
+
+void logger::setFilename(const std::string &filename) {
+    writer().setFilename(filename);
+}
+
+void logger::isTee(bool state) {
+    writer().setTee(state);
+};
+
+void logger::setMinimalLogLevel(Level l) {
+    writer().setLevel(l);
+}
+
+bool logger::isEnabled(Level l) {
+    return writer().isEnabled(l);
+}
+
+void logger::log(Level l, const std::string &message) {
+    if (writer().isEnabled(l)) {
+        writer().push(l, message);
+    }
+}
+
+void logger::log(Level l, const char *text, std::initializer_list<Field> fields) {
+    if (writer().isEnabled(l)) {
+        writer().push(l, text, fields);
+    }
+}
+
+void logger::flush() {
+    writer().flush();
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <boost/asio/ip/basic_endpoint.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// the messages are queued without a lock and written by a thread of the logger, a line only costs the caller its
+// copy in the queue. the lines which don't fit while the queue is full are dropped and their count written later
+namespace logger {
+    enum Level {
+        INFO,
+        WARNING,
+        ERROR,
+    };
+
+    // a value of an event, kept as given and only formatted by the thread of the logger
+    class Field {
+    public:
+        // longer strings are cut
+        static const size_t TEXT_SIZE = 40;
+
+    private:
+        enum Type {
+            NUMBER,
+            ENDPOINT,
+            TEXT,
+        };
+
+        Type _type;
+        uint64_t _number = 0;
+        // address bytes in network order, 4 of them are used for IPv4
+        std::array<uint8_t, 16> _address{};
+        bool _is_v6 = false;
+        uint16_t _port = 0;
+        char _text[TEXT_SIZE];
+        uint8_t _text_size = 0;
+
+        void setText(const char *text, size_t size);
+
+    public:
+        template <typename T, typename std::enable_if<std::is_integral<T>::value, int>::type = 0>
+        Field(T number) : _type(NUMBER), _number(static_cast<uint64_t>(number)) {
+
+        }
+
+        template <typename Protocol>
+        Field(const boost::asio::ip::basic_endpoint<Protocol> &endpoint) : _type(ENDPOINT), _port(endpoint.port()) {
+            if (endpoint.address().is_v6()) {
+                _is_v6 = true;
+                _address = endpoint.address().to_v6().to_bytes();
+            } else {
+                auto bytes = endpoint.address().to_v4().to_bytes();
+                std::copy(bytes.begin(), bytes.end(), _address.begin());
+            }
+        }
+
+        Field(const std::string &text);
+
+        Field(const char *text);
+
+        void format(std::ostream &os) const;
+    };
+
+    void setFilename(const std::string &filename);
+
+    void isTee(bool state);
+
+    void setMinimalLogLevel(Level level);
+
+    // to check before building a message, a level filtered out costs nothing more then
+    bool isEnabled(Level level);
+
+    void log(Level level, const std::string &message);
+
+    // an event: text is a literal whose {} are replaced by the fields in order, both are formatted by the thread of
+    // the logger. text must outlive the logger, at most 4 fields are kept
+    void log(Level level, const char *text, std::initializer_list<Field> fields);
+
+    // waits until the lines queued before are written, e.g. before exiting on an error
+    void flush();
+};
\ No newline at end of file
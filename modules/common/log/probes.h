@@ -0,0 +1,33 @@
+#pragma once
+
+// USDT probes of the provider ndnms, for bpftrace or SystemTap on a running module, e.g.
+//   bpftrace -e 'usdt:/CS:ndnms:cs_miss { @misses = count(); }'
+//   bpftrace -e 'usdt:/SV:ndnms:sv_verify_start { @s[tid] = nsecs; }
+//                usdt:/SV:ndnms:sv_verify_end /@s[tid]/ { @ns = hist(nsecs - @s[tid]); delete(@s[tid]); }'
+// a probe is a nop in the code and a note in the binary until a tracer attaches, its arguments are values already at
+// hand: face IDs, sizes, name_hash. they are built with <sys/sdt.h> (systemtap-sdt-dev) when found, to nothing
+// otherwise or with -DNDNMS_USDT=OFF
+//
+//   face_receive(face_id, type, size)      face_send(face_id, type, size)
+//   queue_enqueue(queue, size, packets)    queue_dequeue(queue, size, wait_us)     queue_drop(queue, size, is_data)
+//   cs_hit(name_hash, size)                cs_miss(name_hash)                      cs_evict(size)
+//   pit_insert(name_hash, face_id, verdict) pit_satisfy(name_hash, egress_face_id) pit_expire(name_hash)
+//   fib_lookup_start(name_hash)            fib_lookup_end(name_hash, faces)
+//   sv_verify_start(size)                  sv_verify_end(size, is_valid)
+//   nf_verdict(name_hash, face_id, verdict)
+#if !defined(NDNMS_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define NDNMS_HAS_USDT
+#endif
+#endif
+
+#ifdef NDNMS_HAS_USDT
+#define NDNMS_PROBE1(name, a) DTRACE_PROBE1(ndnms, name, a)
+#define NDNMS_PROBE2(name, a, b) DTRACE_PROBE2(ndnms, name, a, b)
+#define NDNMS_PROBE3(name, a, b, c) DTRACE_PROBE3(ndnms, name, a, b, c)
+#else
+#define NDNMS_PROBE1(name, a) ((void)0)
+#define NDNMS_PROBE2(name, a, b) ((void)0)
+#define NDNMS_PROBE3(name, a, b, c) ((void)0)
+#endif
\ No newline at end of file
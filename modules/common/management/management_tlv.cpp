@@ -0,0 +1,152 @@
+#include "management_tlv.h"
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/encoding/tlv.hpp>
+
+#include <algorithm>
+
+#include "../network/tlv_reader.h"
+
+namespace {
+    void appendVarNumber(std::string &wire, uint64_t number) {
+        if (number < 253) {
+            wire.push_back(static_cast<char>(number));
+            return;
+        }
+        size_t length = number <= 0xffff ? 2 : number <= 0xffffffff ? 4 : 8;
+        wire.push_back(static_cast<char>(length == 2 ? 253 : length == 4 ? 254 : 255));
+        for (size_t i = length; i > 0; --i) {
+            wire.push_back(static_cast<char>(number >> (8 * (i - 1))));
+        }
+    }
+
+    void appendTlv(std::string &wire, uint32_t type, const char *value, size_t length) {
+        appendVarNumber(wire, type);
+        appendVarNumber(wire, length);
+        wire.append(value, length);
+    }
+
+    void appendTlv(std::string &wire, uint32_t type, const std::string &value) {
+        appendTlv(wire, type, value.data(), value.size());
+    }
+
+    void appendNonNegativeInteger(std::string &wire, uint32_t type, uint64_t number) {
+        size_t length = number <= 0xff ? 1 : number <= 0xffff ? 2 : number <= 0xffffffff ? 4 : 8;
+        char value[8];
+        for (size_t i = 0; i < length; ++i) {
+            value[i] = static_cast<char>(number >> (8 * (length - 1 - i)));
+        }
+        appendTlv(wire, type, value, length);
+    }
+
+    management::Command decodeCommand(const uint8_t *begin, const uint8_t *end) {
+        management::Command command;
+        while (begin < end) {
+            const uint8_t *element = begin;
+            uint32_t type;
+            size_t length = tlv_reader::readHeader(begin, end, type);
+            switch (type) {
+                case management::tlv::CommandId:
+                    command.id = tlv_reader::readNonNegativeInteger(begin, length);
+                    break;
+                case management::tlv::Action:
+                    command.action = tlv_reader::readNonNegativeInteger(begin, length);
+                    break;
+                case management::tlv::FaceId:
+                    command.has_face_id = true;
+                    command.face_id = tlv_reader::readNonNegativeInteger(begin, length);
+                    break;
+                case management::tlv::Cost:
+                    command.has_cost = true;
+                    command.cost = tlv_reader::readNonNegativeInteger(begin, length);
+                    break;
+                case management::tlv::Weight:
+                    command.has_weight = true;
+                    command.weight = tlv_reader::readNonNegativeInteger(begin, length);
+                    break;
+                case ndn::tlv::Name:
+                    command.names.emplace_back(ndn::Block(element, begin + length - element));
+                    break;
+                default:
+                    break;
+            }
+            begin += length;
+        }
+        return command;
+    }
+}
+
+namespace management {
+    std::vector<Command> decodeBatch(const char *buffer, size_t size) {
+        const uint8_t *begin = reinterpret_cast<const uint8_t*>(buffer);
+        const uint8_t *end = begin + size;
+        uint32_t type;
+        size_t length = tlv_reader::readHeader(begin, end, type);
+        if (type != tlv::Batch) {
+            throw ndn::tlv::Error("not a management batch");
+        }
+        end = begin + length;
+        std::vector<Command> commands;
+        while (begin < end) {
+            length = tlv_reader::readHeader(begin, end, type);
+            if (type == tlv::Command) {
+                commands.emplace_back(decodeCommand(begin, begin + length));
+            }
+            begin += length;
+        }
+        return commands;
+    }
+
+    void ReplyBatch::addReply(const std::string &reply) {
+        // the headers of the Reply and of the ReplyBatch take 8 bytes at most under MAX_DATAGRAM
+        if (!_replies.empty() && _replies.size() + reply.size() + 8 > MAX_DATAGRAM) {
+            _datagrams.emplace_back();
+            appendTlv(_datagrams.back(), tlv::ReplyBatch, _replies);
+            _replies.clear();
+        }
+        appendTlv(_replies, tlv::Reply, reply);
+    }
+
+    void ReplyBatch::add(uint64_t id, uint64_t action, uint64_t status, const std::string &reason) {
+        std::string reply;
+        appendNonNegativeInteger(reply, tlv::CommandId, id);
+        appendNonNegativeInteger(reply, tlv::Action, action);
+        appendNonNegativeInteger(reply, tlv::Status, status);
+        if (!reason.empty()) {
+            appendTlv(reply, tlv::Reason, reason);
+        }
+        addReply(reply);
+    }
+
+    void ReplyBatch::addPayload(uint64_t id, uint64_t action, const std::string &payload) {
+        // room for the other elements of the Reply and its header
+        static const size_t CHUNK_SIZE = MAX_DATAGRAM - 64;
+        size_t count = std::max<size_t>((payload.size() + CHUNK_SIZE - 1) / CHUNK_SIZE, 1);
+        for (size_t i = 0; i < count; ++i) {
+            std::string reply;
+            appendNonNegativeInteger(reply, tlv::CommandId, id);
+            appendNonNegativeInteger(reply, tlv::Action, action);
+            appendNonNegativeInteger(reply, tlv::Status, SUCCESS);
+            appendNonNegativeInteger(reply, tlv::ChunkIndex, i);
+            appendNonNegativeInteger(reply, tlv::ChunkCount, count);
+            size_t offset = i * CHUNK_SIZE;
+            appendTlv(reply, tlv::Payload, payload.data() + offset, std::min(CHUNK_SIZE, payload.size() - offset));
+            addReply(reply);
+        }
+    }
+
+    bool ReplyBatch::empty() const {
+        return _datagrams.empty() && _replies.empty();
+    }
+
+    std::vector<std::string> ReplyBatch::finish() {
+        if (!_replies.empty()) {
+            _datagrams.emplace_back();
+            appendTlv(_datagrams.back(), tlv::ReplyBatch, _replies);
+            _replies.clear();
+        }
+        std::vector<std::string> datagrams;
+        datagrams.swap(_datagrams);
+        return datagrams;
+    }
+}
\ No newline at end of file
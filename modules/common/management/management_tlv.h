@@ -0,0 +1,96 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// the binary management protocol, spoken on the command socket alongside JSON for the bulk commands: a datagram
+// starting with a Batch TLV rather than '{'. a Batch carries any number of Commands, all answered in the datagrams of a
+// ReplyBatch, and the manager may have several batches in flight on the socket, the replies are matched by id. a reply
+// too large for one datagram, e.g. a list, is cut in chunks the manager puts back in order
+//
+//   Batch      := 200 Command*
+//   Command    := 201 CommandId Action [FaceId] [Cost] [Weight] Name*
+//   ReplyBatch := 210 Reply*
+//   Reply      := 211 CommandId Action Status [Reason] [ChunkIndex ChunkCount Payload]
+//
+// types and lengths are VAR-NUMBERs and the numbers NonNegativeIntegers as in NDN, the prefixes are Name TLVs
+namespace management {
+    namespace tlv {
+        enum : uint32_t {
+            Batch = 200,
+            Command = 201,
+            CommandId = 202,
+            Action = 203,
+            FaceId = 204,
+            Cost = 205,
+            Weight = 206,
+            ReplyBatch = 210,
+            Reply = 211,
+            Status = 212,
+            Reason = 213,
+            ChunkIndex = 214,
+            ChunkCount = 215,
+            Payload = 216,
+        };
+    }
+
+    enum Action : uint64_t {
+        ADD_ROUTE = 1,
+        DEL_ROUTE = 2,
+        // the payload is the JSON reply of the list command
+        LIST = 3,
+    };
+
+    enum Status : uint64_t {
+        SUCCESS = 0,
+        FAIL = 1,
+    };
+
+    struct Command {
+        uint64_t id = 0;
+        uint64_t action = 0;
+        bool has_face_id = false;
+        uint64_t face_id = 0;
+        bool has_cost = false;
+        uint64_t cost = 0;
+        bool has_weight = false;
+        uint64_t weight = 0;
+        std::vector<ndn::Name> names;
+    };
+
+    // the first byte tells a Batch from a JSON document
+    inline bool isBatch(const char *buffer, size_t size) {
+        return size > 0 && static_cast<uint8_t>(buffer[0]) == tlv::Batch;
+    }
+
+    // unknown elements of a Command are skipped, a truncated or malformed batch throws ndn::tlv::Error
+    std::vector<Command> decodeBatch(const char *buffer, size_t size);
+
+    // the replies to a batch, cut in datagrams which fit in the 64 KB the manager reads at once
+    class ReplyBatch {
+    public:
+        static const size_t MAX_DATAGRAM = 60000;
+
+    private:
+        std::vector<std::string> _datagrams;
+        // the Replies of the datagram being filled
+        std::string _replies;
+
+        void addReply(const std::string &reply);
+
+    public:
+        void add(uint64_t id, uint64_t action, uint64_t status, const std::string &reason = "");
+
+        // payload in as many Replies as needed, each of them with its chunk of it
+        void addPayload(uint64_t id, uint64_t action, const std::string &payload);
+
+        bool empty() const;
+
+        // the datagrams to send, in order
+        std::vector<std::string> finish();
+    };
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "startup_config.h"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <fstream>
+#include <iterator>
+
+#include "../log/logger.h"
+
+namespace {
+    // a reply without status is taken as a success
+    bool isFailure(const rapidjson::Document &reply) {
+        if (!reply.IsObject() || !reply.HasMember("status")) {
+            return false;
+        }
+        const rapidjson::Value &status = reply["status"];
+        return (status.IsBool() && !status.GetBool()) || (status.IsInt() && status.GetInt() == 0)
+               || (status.IsString() && std::string(status.GetString()) == "fail");
+    }
+}
+
+StartupConfig::StartupConfig(bool is_numbering) : _is_numbering(is_numbering) {
+    _commands.SetArray();
+}
+
+bool StartupConfig::load(const std::string &source) {
+    std::string json;
+    if (!source.empty() && (source[0] == '[' || source[0] == '{')) {
+        json = source;
+    } else {
+        std::ifstream file(source);
+        if (!file) {
+            return false;
+        }
+        json.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    rapidjson::Document document;
+    document.Parse(json.c_str(), json.size());
+    if (document.HasParseError()) {
+        return false;
+    }
+    if (document.IsObject() && document.HasMember("commands") && document["commands"].IsArray()) {
+        rapidjson::Value commands(document["commands"], document.GetAllocator());
+        document.Swap(commands);
+    }
+    if (!document.IsArray()) {
+        return false;
+    }
+    _commands.Swap(document);
+    return true;
+}
+
+size_t StartupConfig::size() const {
+    return _commands.Size();
+}
+
+size_t StartupConfig::apply(boost::asio::io_service &ios, boost::asio::ip::udp::endpoint &reply_endpoint, const Executor &execute) const {
+    boost::asio::ip::udp::socket replies(ios, {boost::asio::ip::address_v4::loopback(), 0});
+    reply_endpoint = replies.local_endpoint();
+    size_t failed = 0;
+    for (rapidjson::SizeType i = 0; i < _commands.Size(); ++i) {
+        const rapidjson::Value &value = _commands[i];
+        if (!value.IsObject() || !value.HasMember("action") || !value["action"].IsString()) {
+            logger::log(logger::WARNING, "startup command {} has no action", {i});
+            ++failed;
+            continue;
+        }
+        rapidjson::Document command;
+        command.CopyFrom(value, command.GetAllocator());
+        if (_is_numbering && !command.HasMember("id")) {
+            command.AddMember("id", i, command.GetAllocator());
+        }
+        try {
+            execute(command);
+        } catch (const std::exception &e) {
+            logger::log(logger::WARNING, "startup command {} ({}) failed: {}", {i, command["action"].GetString(), e.what()});
+            ++failed;
+        }
+    }
+    // the replies a module posts to its control thread come after the command returned, they are read until none
+    // came for REPLY_WAIT_MS
+    timeval timeout{0, REPLY_WAIT_MS * 1000};
+    setsockopt(replies.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    static char buffer[65536];
+    boost::system::error_code err;
+    while (true) {
+        boost::asio::ip::udp::endpoint sender;
+        size_t size = replies.receive_from(boost::asio::buffer(buffer), sender, 0, err);
+        if (err) {
+            break;
+        }
+        rapidjson::Document reply;
+        reply.Parse(buffer, size);
+        if (!reply.HasParseError() && isFailure(reply)) {
+            std::string id = reply.HasMember("id") && reply["id"].IsUint() ? std::to_string(reply["id"].GetUint()) : "?";
+            std::string action = reply.HasMember("action") && reply["action"].IsString() ? reply["action"].GetString() : "?";
+            std::string reason = reply.HasMember("reason") && reply["reason"].IsString() ? reply["reason"].GetString() : "";
+            logger::log(logger::WARNING, "startup command {} ({}) failed: {}", {id, action, reason});
+            ++failed;
+        }
+    }
+    reply_endpoint = boost::asio::ip::udp::endpoint();
+    logger::log(logger::INFO, "{} startup commands applied, {} failed", {_commands.Size(), failed});
+    return failed;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "rapidjson/document.h"
+
+// the commands a module applies as it starts, before it listens, rather than being sent them by the manager one
+// datagram each: add_face, add_route, add_keys, edit_config... as they would come on the command socket, in order. the
+// configuration is a JSON array of commands or an object with a "commands" array, read from a file or given inline
+class StartupConfig {
+public:
+    // a command as the command socket hands it over, applied on the calling thread
+    using Executor = std::function<void(const rapidjson::Document&)>;
+
+private:
+    // of quiet on the reply socket once the commands are applied
+    static constexpr long REPLY_WAIT_MS = 100;
+
+    rapidjson::Document _commands;
+    bool _is_numbering;
+
+public:
+    // a command without an id is given its index, as the replies carry it, unless is_numbering is false for a module
+    // where the id means something else, e.g. the module id in the edit_config of PD
+    explicit StartupConfig(bool is_numbering = true);
+
+    // source is the JSON itself if it starts with '[' or '{', else the path of a file holding it. false if it can't be
+    // read or parsed, nothing is then applied
+    bool load(const std::string &source);
+
+    size_t size() const;
+
+    // each command given to execute in order, with reply_endpoint meanwhile set to a socket of ios which then reads
+    // the replies: one with a "status" false, 0 or "fail" is logged. reply_endpoint is reset afterwards. the number of
+    // commands which failed
+    size_t apply(boost::asio::io_service &ios, boost::asio::ip::udp::endpoint &reply_endpoint, const Executor &execute) const;
+};
\ No newline at end of file
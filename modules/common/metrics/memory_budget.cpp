@@ -0,0 +1,245 @@
+#include "memory_budget.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "../log/logger.h"
+
+const size_t MemoryBudget::INTERVAL_MS;
+constexpr double MemoryBudget::PRESSURE_THRESHOLD;
+
+namespace {
+    struct Cgroup {
+        // of the memory controller, from the cgroup of the process up to the root, none without cgroup
+        std::vector<std::string> directories;
+        bool is_v2 = false;
+    };
+
+    Cgroup findCgroup() {
+        // hierarchy-ID:controller-list:cgroup-path, "0::path" for v2. a v1 memory controller is used first, the other
+        // controllers may be on v2 in the hybrid layout
+        std::ifstream file("/proc/self/cgroup");
+        std::string line;
+        std::string v1_path;
+        std::string v2_path;
+        while (std::getline(file, line)) {
+            size_t first = line.find(':');
+            size_t second = line.find(':', first == std::string::npos ? first : first + 1);
+            if (second == std::string::npos) {
+                continue;
+            }
+            std::string controllers = line.substr(first + 1, second - first - 1);
+            std::string path = line.substr(second + 1);
+            if (line.compare(0, first, "0") == 0 && controllers.empty()) {
+                v2_path = path;
+            } else if (("," + controllers + ",").find(",memory,") != std::string::npos) {
+                v1_path = path;
+            }
+        }
+        Cgroup cgroup;
+        std::string root;
+        std::string path;
+        if (!v1_path.empty()) {
+            root = "/sys/fs/cgroup/memory";
+            path = v1_path;
+        } else if (!v2_path.empty()) {
+            root = "/sys/fs/cgroup";
+            path = v2_path;
+            cgroup.is_v2 = true;
+        } else {
+            return cgroup;
+        }
+        // "/" under a cgroup namespace, the directories missing otherwise, e.g. in a container which sees its own
+        // cgroup at the root, are skipped by the reads
+        while (!path.empty() && path != "/") {
+            cgroup.directories.push_back(root + path);
+            path = path.substr(0, path.find_last_of('/'));
+        }
+        cgroup.directories.push_back(root);
+        return cgroup;
+    }
+
+    const Cgroup& getCgroup() {
+        static const Cgroup cgroup = findCgroup();
+        return cgroup;
+    }
+
+    // false if the file is missing or doesn't start with a number, e.g. "max"
+    bool readNumber(const std::string &path, size_t &number) {
+        std::ifstream file(path);
+        unsigned long long value;
+        if (!(file >> value)) {
+            return false;
+        }
+        number = static_cast<size_t>(value);
+        return true;
+    }
+
+    // the value of key in a memory.stat, 0 if it isn't there
+    size_t readStat(const std::string &path, const std::string &key) {
+        std::ifstream file(path);
+        std::string name;
+        unsigned long long value;
+        while (file >> name >> value) {
+            if (name == key) {
+                return static_cast<size_t>(value);
+            }
+        }
+        return 0;
+    }
+}
+
+MemoryBudget::MemoryBudget(boost::asio::io_service &ios) : _ios(ios), _timer(ios) {
+
+}
+
+bool MemoryBudget::start(size_t percent, const Callback &callback) {
+    if (percent == 0 || readLimit() == 0) {
+        return false;
+    }
+    _percent.store(std::min<size_t>(percent, 100), std::memory_order_relaxed);
+    _callback = callback;
+    _ios.post([this]() {
+        update();
+        arm();
+    });
+    return true;
+}
+
+void MemoryBudget::arm() {
+    _timer.expires_from_now(boost::posix_time::milliseconds(INTERVAL_MS));
+    _timer.async_wait([this](const boost::system::error_code &err) {
+        onTimer(err);
+    });
+}
+
+void MemoryBudget::onTimer(const boost::system::error_code &err) {
+    if (err) {
+        return;
+    }
+    update();
+    arm();
+}
+
+void MemoryBudget::update() {
+    size_t limit = readLimit();
+    if (limit == 0) {
+        // lifted meanwhile, the last budget is kept
+        return;
+    }
+    size_t usage = readUsage();
+    double pressure = readPressure();
+    _limit.store(limit, std::memory_order_relaxed);
+    _usage.store(usage, std::memory_order_relaxed);
+    _pressure.store(pressure > 0 ? static_cast<size_t>(pressure * 100) : 0, std::memory_order_relaxed);
+
+    size_t target = limit / 100 * _percent.load(std::memory_order_relaxed);
+    size_t budget = _budget.load(std::memory_order_relaxed);
+    size_t new_budget = budget;
+    if (budget == 0) {
+        new_budget = target;
+    } else if (pressure > PRESSURE_THRESHOLD || usage > limit - limit / 16) {
+        new_budget = std::max(budget - budget / 8, target / 4);
+        if (new_budget < budget) {
+            _shrinks.fetch_add(1, std::memory_order_relaxed);
+            logger::log(logger::WARNING, "memory pressure of {}% with {} bytes used out of {}, the tables shrink to {} bytes",
+                        {static_cast<size_t>(pressure), usage, limit, new_budget});
+        }
+    } else if (budget < target) {
+        new_budget = std::min(budget + std::max<size_t>(target / 16, 1), target);
+    } else {
+        // the limit was lowered
+        new_budget = target;
+    }
+    if (new_budget != budget) {
+        _budget.store(new_budget, std::memory_order_relaxed);
+        _callback(new_budget);
+    }
+}
+
+bool MemoryBudget::isEnabled() const {
+    return _percent.load(std::memory_order_relaxed) > 0;
+}
+
+size_t MemoryBudget::getBudget() const {
+    return _budget.load(std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::readLimit() {
+    const Cgroup &cgroup = getCgroup();
+    // v1 writes the largest page aligned value of its counter when there is none
+    static const size_t UNLIMITED = size_t(1) << 60;
+    size_t limit = 0;
+    for (const auto &directory : cgroup.directories) {
+        size_t value;
+        if (readNumber(directory + (cgroup.is_v2 ? "/memory.max" : "/memory.limit_in_bytes"), value) && value > 0 && value < UNLIMITED) {
+            limit = limit == 0 ? value : std::min(limit, value);
+        }
+    }
+    if (limit == 0) {
+        return 0;
+    }
+    // a limit above the RAM never triggers
+    long pages = sysconf(_SC_PHYS_PAGES);
+    if (pages > 0) {
+        limit = std::min(limit, static_cast<size_t>(pages) * static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+    }
+    return limit;
+}
+
+size_t MemoryBudget::readUsage() {
+    const Cgroup &cgroup = getCgroup();
+    for (const auto &directory : cgroup.directories) {
+        size_t usage;
+        if (readNumber(directory + (cgroup.is_v2 ? "/memory.current" : "/memory.usage_in_bytes"), usage)) {
+            // the inactive page cache is reclaimed before anything is killed, e.g. the pages of the disk tier
+            size_t inactive = readStat(directory + "/memory.stat", cgroup.is_v2 ? "inactive_file" : "total_inactive_file");
+            return usage - std::min(usage, inactive);
+        }
+    }
+    return 0;
+}
+
+double MemoryBudget::readPressure() {
+    const Cgroup &cgroup = getCgroup();
+    // some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    std::vector<std::string> paths;
+    if (cgroup.is_v2 && !cgroup.directories.empty()) {
+        paths.push_back(cgroup.directories.front() + "/memory.pressure");
+    }
+    paths.push_back("/proc/pressure/memory");
+    for (const auto &path : paths) {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            size_t avg10 = line.find("avg10=");
+            if (line.compare(0, 4, "some") == 0 && avg10 != std::string::npos) {
+                return std::strtod(line.c_str() + avg10 + 6, nullptr);
+            }
+        }
+    }
+    return -1;
+}
+
+std::string MemoryBudget::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"percent":)" << _percent.load(std::memory_order_relaxed) << R"(, "limit_bytes":)" << _limit.load(std::memory_order_relaxed)
+       << R"(, "usage_bytes":)" << _usage.load(std::memory_order_relaxed)
+       << R"(, "pressure":)" << _pressure.load(std::memory_order_relaxed) / 100.0 << R"(, "budget_bytes":)" << getBudget()
+       << R"(, "shrinks":)" << _shrinks.load(std::memory_order_relaxed) << "}";
+    return ss.str();
+}
+
+void MemoryBudget::writeMetrics(MetricsWriter &writer, const metrics::Labels &labels) const {
+    writer.gauge("ndn_memory_limit_bytes", "memory limit of the cgroup of the module", labels, _limit.load(std::memory_order_relaxed));
+    writer.gauge("ndn_memory_usage_bytes", "memory used by the cgroup of the module, the inactive page cache aside", labels,
+                 _usage.load(std::memory_order_relaxed));
+    writer.gauge("ndn_memory_budget_bytes", "bytes the tables of the module may take", labels, getBudget());
+    writer.counter("ndn_memory_budget_shrinks_total", "cuts of the budget under memory pressure", labels,
+                   _shrinks.load(std::memory_order_relaxed));
+}
\ No newline at end of file
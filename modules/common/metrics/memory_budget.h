@@ -0,0 +1,72 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "metrics.h"
+
+// the bytes the tables of a module may take: a share of the memory limit of its cgroup, memory.max for v2 and
+// memory.limit_in_bytes for v1, the lowest of those of its ancestors, read at start and every INTERVAL_MS. under
+// pressure, i.e. once the tasks of the cgroup stalled on memory for more than PRESSURE_THRESHOLD percent of the last
+// 10 seconds (PSI) or its usage is within 1/16 of the limit, the budget is cut by 1/8 down to a quarter of the
+// share, it then grows back by 1/16 of it each tick. the module is called back on ios with each new budget, which it
+// applies as the byte limit of its tables, so that it neither gets OOM killed nor leaves the quota unused
+class MemoryBudget {
+public:
+    static const size_t INTERVAL_MS = 5000;
+    static constexpr double PRESSURE_THRESHOLD = 10.0;
+
+    using Callback = std::function<void(size_t budget)>;
+
+private:
+    boost::asio::io_service &_ios;
+    boost::asio::deadline_timer _timer;
+    Callback _callback;
+    // of the limit, 0 while off. written on _ios and read by the commands
+    std::atomic<size_t> _percent{0};
+    std::atomic<size_t> _limit{0};
+    std::atomic<size_t> _usage{0};
+    // the PSI "some" avg10, in hundredths of a percent
+    std::atomic<size_t> _pressure{0};
+    std::atomic<size_t> _budget{0};
+    std::atomic<size_t> _shrinks{0};
+
+    void arm();
+
+    void onTimer(const boost::system::error_code &err);
+
+    void update();
+
+public:
+    explicit MemoryBudget(boost::asio::io_service &ios);
+
+    MemoryBudget(const MemoryBudget&) = delete;
+
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    // percent of the limit given to the tables, the first budget is given on ios. false if the process has no cgroup
+    // memory limit, nothing is called back then. the budget must outlive the runs of ios
+    bool start(size_t percent, const Callback &callback);
+
+    bool isEnabled() const;
+
+    // 0 until the first tick
+    size_t getBudget() const;
+
+    // in bytes, 0 without a cgroup limit
+    static size_t readLimit();
+
+    static size_t readUsage();
+
+    // percent of the last 10 seconds some task of the cgroup stalled on memory, -1 without PSI
+    static double readPressure();
+
+    // {"percent", "limit_bytes", "usage_bytes", "pressure", "budget_bytes", "shrinks"}
+    std::string toJSON() const;
+
+    void writeMetrics(MetricsWriter &writer, const metrics::Labels &labels) const;
+};
\ No newline at end of file
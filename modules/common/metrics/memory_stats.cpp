@@ -0,0 +1,71 @@
+#include "memory_stats.h"
+
+#include <malloc.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "../network/buffer_pool.h"
+#include "../network/page_arena.h"
+
+namespace {
+    // resident pages of the process, 0 without procfs
+    size_t readRss() {
+        std::ifstream statm("/proc/self/statm");
+        size_t size = 0;
+        size_t resident = 0;
+        if (!(statm >> size >> resident)) {
+            return 0;
+        }
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    }
+}
+
+void MemoryStats::add(const std::string &name, size_t count, size_t bytes) {
+    for (auto &part : _parts) {
+        if (part.name == name) {
+            part.count += count;
+            part.bytes += bytes;
+            return;
+        }
+    }
+    _parts.push_back(Part{name, count, bytes});
+}
+
+void MemoryStats::add(const MemoryStats &other, size_t copies) {
+    for (const auto &part : other._parts) {
+        add(part.name, part.count, part.bytes * copies);
+    }
+}
+
+size_t MemoryStats::getBytes() const {
+    size_t bytes = 0;
+    for (const auto &part : _parts) {
+        bytes += part.bytes;
+    }
+    return bytes;
+}
+
+std::string MemoryStats::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"total_bytes":)" << getBytes() << R"(, "parts":{)";
+    for (size_t i = 0; i < _parts.size(); ++i) {
+        ss << (i == 0 ? "" : ", ") << "\"" << _parts[i].name << R"(":{"count":)" << _parts[i].count
+           << R"(, "bytes":)" << _parts[i].bytes << "}";
+    }
+    ss << "}";
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 heap = mallinfo2();
+#else
+    // the fields wrap past 2 GB
+    struct mallinfo heap = mallinfo();
+#endif
+    ss << R"(, "heap":{"arena_bytes":)" << static_cast<size_t>(heap.arena) << R"(, "mapped_bytes":)" << static_cast<size_t>(heap.hblkhd)
+       << R"(, "in_use_bytes":)" << static_cast<size_t>(heap.uordblks) + static_cast<size_t>(heap.hblkhd)
+       << R"(, "free_bytes":)" << static_cast<size_t>(heap.fordblks) << "}";
+    BufferPoolStats buffer_pool = BufferPool::getStats();
+    ss << R"(, "buffer_pool":)" << buffer_pool.toJSON() << R"(, "buffer_pool_bytes":)" << buffer_pool.buffers * BufferPool::BUFFER_SIZE
+       << R"(, "page_arena":)" << PageArena::getStats().toJSON() << R"(, "rss_bytes":)" << readRss() << "}";
+    return ss.str();
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+
+#include <boost/container/small_vector.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// the memory held by the tables of a module, by part, for the memory_stats command: how many elements a part holds
+// and the bytes they take as laid out by libstdc++ on 64 bits, capacities and container nodes included, malloc
+// headers aside. a part added twice, e.g. by each shard, is summed. the heap, the pools and the RSS of the process
+// are added by toJSON, the parts should account for most of the heap in use
+class MemoryStats {
+private:
+    struct Part {
+        std::string name;
+        size_t count;
+        size_t bytes;
+    };
+
+    std::vector<Part> _parts;
+
+public:
+    void add(const std::string &name, size_t count, size_t bytes);
+
+    // the parts of other with their bytes counted copies times, e.g. for the two instances of a LeftRight
+    void add(const MemoryStats &other, size_t copies = 1);
+
+    // summed over the parts
+    size_t getBytes() const;
+
+    // {"total_bytes", "parts":{name:{"count", "bytes"}}, "heap":{"arena_bytes", "mapped_bytes", "in_use_bytes",
+    // "free_bytes"}, "buffer_pool":{...}, "buffer_pool_bytes", "page_arena":{...}, "rss_bytes"}
+    std::string toJSON() const;
+};
+
+// bytes of the blocks a container allocated, the object itself aside
+namespace memory_usage {
+    // with a hash code kept in each node, as libstdc++ does for the hashes it doesn't deem fast, i.e. but for integers
+    template <class K>
+    constexpr size_t hashCodeSize() {
+        return std::is_integral<K>::value ? 0 : sizeof(size_t);
+    }
+
+    inline size_t of(const std::string &string) {
+        // the short strings are held inline
+        return string.capacity() > 15 ? string.capacity() + 1 : 0;
+    }
+
+    // the components, and the TLV they point into unless it is a view on a larger buffer, e.g. the packet the Name
+    // was decoded from, which its holder counts
+    inline size_t of(const ndn::Name &name) {
+        size_t bytes = name.size() * sizeof(ndn::Name::Component);
+        if (name.hasWire()) {
+            const ndn::Block &wire = name.wireEncode();
+            if (wire.getBuffer() && wire.getBuffer()->size() == wire.size()) {
+                bytes += wire.size();
+            }
+        }
+        return bytes;
+    }
+
+    template <class T, class A>
+    size_t of(const std::vector<T, A> &vector) {
+        return vector.capacity() * sizeof(T);
+    }
+
+    // nothing until it spills out of its inline elements
+    template <class T, size_t N, class... Rest>
+    size_t of(const boost::container::small_vector<T, N, Rest...> &vector) {
+        return vector.capacity() > N ? vector.capacity() * sizeof(T) : 0;
+    }
+
+    template <class T, class A>
+    size_t of(const std::deque<T, A> &deque) {
+        // blocks of 512 bytes and the map pointing at them, 8 slots at least
+        const size_t per_block = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+        size_t blocks = deque.size() / per_block + 1;
+        return blocks * per_block * sizeof(T) + std::max<size_t>(8, blocks + 2) * sizeof(void*);
+    }
+
+    template <class T, class A>
+    size_t of(const std::list<T, A> &list) {
+        return list.size() * (2 * sizeof(void*) + sizeof(T));
+    }
+
+    template <class K, class V, class C, class A>
+    size_t of(const std::map<K, V, C, A> &map) {
+        // color and three links
+        return map.size() * (4 * sizeof(void*) + sizeof(std::pair<const K, V>));
+    }
+
+    template <class K, class C, class A>
+    size_t of(const std::set<K, C, A> &set) {
+        return set.size() * (4 * sizeof(void*) + sizeof(K));
+    }
+
+    template <class K, class V, class H, class E, class A>
+    size_t of(const std::unordered_map<K, V, H, E, A> &map) {
+        return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(void*) + sizeof(std::pair<const K, V>) + hashCodeSize<K>());
+    }
+
+    template <class K, class V, class H, class E, class A>
+    size_t of(const std::unordered_multimap<K, V, H, E, A> &map) {
+        return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(void*) + sizeof(std::pair<const K, V>) + hashCodeSize<K>());
+    }
+
+    // of an object made with std::make_shared, the control block and the object itself
+    template <class T>
+    constexpr size_t ofShared() {
+        return 2 * sizeof(int) + sizeof(void*) + sizeof(T);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+size_t metrics::getThreadSlot() {
+    static std::atomic<size_t> next_slot{0};
+    static thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % SLOTS;
+    return slot;
+}
+
+uint64_t Counter::get() const {
+    uint64_t value = 0;
+    for (const auto &slot : _slots) {
+        value += slot.value.load(std::memory_order_relaxed);
+    }
+    return value;
+}
+
+Histogram::Histogram(const std::vector<double> &bounds)
+        : _bounds(bounds)
+        // 8 counts by cache line
+        , _stride((bounds.size() + 2 + 7) / 8 * 8)
+        , _counts(new std::atomic<uint64_t>[_stride * metrics::SLOTS]) {
+    for (size_t i = 0; i < _stride * metrics::SLOTS; ++i) {
+        _counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double value) {
+    std::atomic<uint64_t> *counts = &_counts[metrics::getThreadSlot() * _stride];
+    size_t bucket = std::lower_bound(_bounds.begin(), _bounds.end(), value) - _bounds.begin();
+    counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    counts[_bounds.size() + 1].fetch_add(static_cast<uint64_t>(value * 1000), std::memory_order_relaxed);
+}
+
+std::vector<uint64_t> Histogram::getBuckets() const {
+    std::vector<uint64_t> buckets(_bounds.size() + 1, 0);
+    for (size_t slot = 0; slot < metrics::SLOTS; ++slot) {
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            buckets[i] += _counts[slot * _stride + i].load(std::memory_order_relaxed);
+        }
+    }
+    return buckets;
+}
+
+double Histogram::getSum() const {
+    uint64_t sum = 0;
+    for (size_t slot = 0; slot < metrics::SLOTS; ++slot) {
+        sum += _counts[slot * _stride + _bounds.size() + 1].load(std::memory_order_relaxed);
+    }
+    return sum / 1000.0;
+}
+
+const std::vector<double>& Histogram::getBounds() const {
+    return _bounds;
+}
+
+MetricsWriter::Family& MetricsWriter::getFamily(const std::string &name, const char *type, const std::string &help) {
+    auto &family = _families[name];
+    if (family.type.empty()) {
+        family.type = type;
+        family.help = help;
+    }
+    return family;
+}
+
+void MetricsWriter::writeSample(std::string &line, const std::string &name, const metrics::Labels &labels, double value) {
+    std::stringstream ss;
+    ss << name;
+    if (!labels.empty()) {
+        ss << '{';
+        for (size_t i = 0; i < labels.size(); ++i) {
+            if (i > 0) {
+                ss << ',';
+            }
+            ss << labels[i].first << "=\"";
+            for (char c : labels[i].second) {
+                if (c == '\\' || c == '"') {
+                    ss << '\\' << c;
+                } else if (c == '\n') {
+                    ss << "\\n";
+                } else {
+                    ss << c;
+                }
+            }
+            ss << '"';
+        }
+        ss << '}';
+    }
+    ss << ' ';
+    if (std::isinf(value)) {
+        ss << (value > 0 ? "+Inf" : "-Inf");
+    } else {
+        ss.precision(17);
+        ss << value;
+    }
+    line = ss.str();
+}
+
+void MetricsWriter::counter(const std::string &name, const std::string &help, const metrics::Labels &labels, double value) {
+    auto &family = getFamily(name, "counter", help);
+    family.samples.emplace_back();
+    writeSample(family.samples.back(), name, labels, value);
+}
+
+void MetricsWriter::gauge(const std::string &name, const std::string &help, const metrics::Labels &labels, double value) {
+    auto &family = getFamily(name, "gauge", help);
+    family.samples.emplace_back();
+    writeSample(family.samples.back(), name, labels, value);
+}
+
+void MetricsWriter::histogram(const std::string &name, const std::string &help, const metrics::Labels &labels, const Histogram &histogram) {
+    auto &family = getFamily(name, "histogram", help);
+    auto buckets = histogram.getBuckets();
+    const auto &bounds = histogram.getBounds();
+    uint64_t count = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        count += buckets[i];
+        metrics::Labels bucket_labels = labels;
+        std::stringstream bound;
+        if (i < bounds.size()) {
+            bound << bounds[i];
+        } else {
+            bound << "+Inf";
+        }
+        bucket_labels.emplace_back("le", bound.str());
+        family.samples.emplace_back();
+        writeSample(family.samples.back(), name + "_bucket", bucket_labels, count);
+    }
+    family.samples.emplace_back();
+    writeSample(family.samples.back(), name + "_sum", labels, histogram.getSum());
+    family.samples.emplace_back();
+    writeSample(family.samples.back(), name + "_count", labels, count);
+}
+
+std::string MetricsWriter::toText() const {
+    std::stringstream ss;
+    for (const auto &family : _families) {
+        ss << "# HELP " << family.first << ' ' << family.second.help << '\n';
+        ss << "# TYPE " << family.first << ' ' << family.second.type << '\n';
+        for (const auto &sample : family.second.samples) {
+            ss << sample << '\n';
+        }
+    }
+    return ss.str();
+}
+
+std::shared_ptr<Counter> Metrics::addCounter(const std::string &name, const std::string &help, const metrics::Labels &labels) {
+    auto counter = std::make_shared<Counter>();
+    std::lock_guard<std::mutex> guard(_mutex);
+    _counters.push_back({name, help, labels, counter});
+    return counter;
+}
+
+std::shared_ptr<Gauge> Metrics::addGauge(const std::string &name, const std::string &help, const metrics::Labels &labels) {
+    auto gauge = std::make_shared<Gauge>();
+    std::lock_guard<std::mutex> guard(_mutex);
+    _gauges.push_back({name, help, labels, gauge});
+    return gauge;
+}
+
+std::shared_ptr<Histogram> Metrics::addHistogram(const std::string &name, const std::string &help, const std::vector<double> &bounds,
+                                                 const metrics::Labels &labels) {
+    auto histogram = std::make_shared<Histogram>(bounds);
+    std::lock_guard<std::mutex> guard(_mutex);
+    _histograms.push_back({name, help, labels, histogram});
+    return histogram;
+}
+
+void Metrics::addCollector(const Collector &collector) {
+    std::lock_guard<std::mutex> guard(_mutex);
+    _collectors.push_back(collector);
+}
+
+std::string Metrics::toText() const {
+    MetricsWriter writer;
+    std::lock_guard<std::mutex> guard(_mutex);
+    for (const auto &counter : _counters) {
+        writer.counter(counter.name, counter.help, counter.labels, counter.metric->get());
+    }
+    for (const auto &gauge : _gauges) {
+        writer.gauge(gauge.name, gauge.help, gauge.labels, gauge.metric->get());
+    }
+    for (const auto &histogram : _histograms) {
+        writer.histogram(histogram.name, histogram.help, histogram.labels, *histogram.metric);
+    }
+    for (const auto &collector : _collectors) {
+        collector(writer);
+    }
+    return writer.toText();
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// metrics of a module in the Prometheus text format, pulled from MetricsServer. the counters and histograms are
+// written by any thread on a slot of its own, each on its cache line, and only summed up by the scrape. what a module
+// already counts elsewhere, e.g. the faces or its tables, is read at the scrape by a collector instead
+
+namespace metrics {
+    // name="value" pairs, in order
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    // the slot of the calling thread, threads get them in turn and share them past SLOTS
+    size_t getThreadSlot();
+
+    static const size_t SLOTS = 16;
+}
+
+class Counter {
+private:
+    // padded rather than aligned, a counter then needs no over-aligned allocation
+    struct Slot {
+        std::atomic<uint64_t> value{0};
+        char padding[64 - sizeof(std::atomic<uint64_t>)];
+    };
+
+    Slot _slots[metrics::SLOTS];
+
+public:
+    void add(uint64_t n = 1) {
+        _slots[metrics::getThreadSlot()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t get() const;
+};
+
+class Gauge {
+private:
+    std::atomic<int64_t> _value{0};
+
+public:
+    void set(int64_t value) {
+        _value.store(value, std::memory_order_relaxed);
+    }
+
+    void add(int64_t n) {
+        _value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    int64_t get() const {
+        return _value.load(std::memory_order_relaxed);
+    }
+};
+
+// cumulative buckets of the observations up to each bound, as Prometheus expects, the counts of a thread are on
+// cache lines of their own
+class Histogram {
+private:
+    const std::vector<double> _bounds;
+    // by slot, the counts of the buckets, the last one past the bounds, then the sum in 1/1000 of the unit
+    const size_t _stride;
+    std::unique_ptr<std::atomic<uint64_t>[]> _counts;
+
+public:
+    // bounds in increasing order
+    explicit Histogram(const std::vector<double> &bounds);
+
+    // value >= 0
+    void observe(double value);
+
+    // not cumulative, one more than the bounds
+    std::vector<uint64_t> getBuckets() const;
+
+    double getSum() const;
+
+    const std::vector<double>& getBounds() const;
+};
+
+// the samples of a scrape, grouped by name when written out
+class MetricsWriter {
+private:
+    struct Family {
+        std::string type;
+        std::string help;
+        std::vector<std::string> samples;
+    };
+
+    // by name, in order
+    std::map<std::string, Family> _families;
+
+    Family& getFamily(const std::string &name, const char *type, const std::string &help);
+
+    static void writeSample(std::string &line, const std::string &name, const metrics::Labels &labels, double value);
+
+public:
+    void counter(const std::string &name, const std::string &help, const metrics::Labels &labels, double value);
+
+    void gauge(const std::string &name, const std::string &help, const metrics::Labels &labels, double value);
+
+    void histogram(const std::string &name, const std::string &help, const metrics::Labels &labels, const Histogram &histogram);
+
+    std::string toText() const;
+};
+
+// what a module exposes: the metrics it registered and the collectors called at each scrape, from the thread
+// serving it. the registry is only locked by the registrations and the scrapes
+class Metrics {
+public:
+    using Collector = std::function<void(MetricsWriter&)>;
+
+private:
+    template <typename T>
+    struct Registered {
+        std::string name;
+        std::string help;
+        metrics::Labels labels;
+        std::shared_ptr<T> metric;
+    };
+
+    mutable std::mutex _mutex;
+    std::vector<Registered<Counter>> _counters;
+    std::vector<Registered<Gauge>> _gauges;
+    std::vector<Registered<Histogram>> _histograms;
+    std::vector<Collector> _collectors;
+
+public:
+    std::shared_ptr<Counter> addCounter(const std::string &name, const std::string &help, const metrics::Labels &labels = {});
+
+    std::shared_ptr<Gauge> addGauge(const std::string &name, const std::string &help, const metrics::Labels &labels = {});
+
+    std::shared_ptr<Histogram> addHistogram(const std::string &name, const std::string &help, const std::vector<double> &bounds,
+                                            const metrics::Labels &labels = {});
+
+    void addCollector(const Collector &collector);
+
+    std::string toText() const;
+};
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "metrics_server.h"
+
+#include <boost/bind.hpp>
+
+#include <sstream>
+
+#include "../log/logger.h"
+
+MetricsServer::Session::Session(boost::asio::io_service &ios, const Metrics &metrics)
+        : _socket(ios)
+        , _request(MAX_REQUEST_SIZE)
+        , _metrics(metrics) {
+
+}
+
+boost::asio::ip::tcp::socket& MetricsServer::Session::getSocket() {
+    return _socket;
+}
+
+void MetricsServer::Session::start() {
+    boost::asio::async_read_until(_socket, _request, "\r\n\r\n",
+                                  boost::bind(&MetricsServer::Session::readHandler, shared_from_this(), _1));
+}
+
+void MetricsServer::Session::readHandler(const boost::system::error_code &err) {
+    if (err) {
+        return;
+    }
+    std::string body = _metrics.toText();
+    std::stringstream ss;
+    ss << "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " << body.size()
+       << "\r\nConnection: close\r\n\r\n" << body;
+    _response = ss.str();
+    boost::asio::async_write(_socket, boost::asio::buffer(_response),
+                             boost::bind(&MetricsServer::Session::writeHandler, shared_from_this(), _1));
+}
+
+void MetricsServer::Session::writeHandler(const boost::system::error_code &err) {
+    boost::system::error_code ignored;
+    _socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+    _socket.close(ignored);
+}
+
+MetricsServer::MetricsServer(boost::asio::io_service &ios, const Metrics &metrics, uint16_t port)
+        : _metrics(metrics)
+        , _ios(ios)
+        , _acceptor(ios, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port))
+        , _port(port) {
+
+}
+
+void MetricsServer::listen() {
+    _acceptor.listen(boost::asio::socket_base::max_connections);
+    logger::log(logger::INFO, "metrics served on tcp://0.0.0.0:{}", {_port});
+    accept();
+}
+
+void MetricsServer::close() {
+    boost::system::error_code err;
+    _acceptor.close(err);
+}
+
+void MetricsServer::accept() {
+    auto session = std::make_shared<Session>(_ios, _metrics);
+    _acceptor.async_accept(session->getSocket(), boost::bind(&MetricsServer::acceptHandler, shared_from_this(), session, _1));
+}
+
+void MetricsServer::acceptHandler(const std::shared_ptr<Session> &session, const boost::system::error_code &err) {
+    if (err == boost::asio::error::operation_aborted) {
+        return;
+    }
+    if (!err) {
+        session->start();
+    }
+    accept();
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <memory>
+
+#include "metrics.h"
+
+// serves the metrics in the Prometheus text format on TCP, any request gets the whole of them and the connection is
+// closed after the response. runs on the io_service it is given, the collectors of the metrics are called there
+class MetricsServer : public std::enable_shared_from_this<MetricsServer> {
+private:
+    // a request larger than that is dropped
+    static const size_t MAX_REQUEST_SIZE = 8192;
+
+    class Session : public std::enable_shared_from_this<Session> {
+    private:
+        boost::asio::ip::tcp::socket _socket;
+        boost::asio::streambuf _request;
+        std::string _response;
+        const Metrics &_metrics;
+
+    public:
+        Session(boost::asio::io_service &ios, const Metrics &metrics);
+
+        boost::asio::ip::tcp::socket& getSocket();
+
+        void start();
+
+    private:
+        void readHandler(const boost::system::error_code &err);
+
+        void writeHandler(const boost::system::error_code &err);
+    };
+
+    const Metrics &_metrics;
+    boost::asio::io_service &_ios;
+    boost::asio::ip::tcp::acceptor _acceptor;
+    uint16_t _port;
+
+public:
+    // metrics must outlive the server
+    MetricsServer(boost::asio::io_service &ios, const Metrics &metrics, uint16_t port);
+
+    void listen();
+
+    void close();
+
+private:
+    void accept();
+
+    void acceptHandler(const std::shared_ptr<Session> &session, const boost::system::error_code &err);
+};
\ No newline at end of file
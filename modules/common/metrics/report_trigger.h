@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+// what turns the reports pushed to the manager from a fixed poll into events: a threshold crossing is reported at once,
+// and the periodic reports may only carry what changed since the previous one. neither is thread-safe, a module keeps
+// them where it sends its reports from
+
+// a threshold with hysteresis: raised once the value goes past the trigger, cleared only once it is back past the
+// release, a value hovering around the trigger isn't reported at each check
+class ThresholdAlarm {
+public:
+    enum Direction {
+        // e.g. a queue depth or a drop rate
+        ABOVE,
+        // e.g. a hit ratio
+        BELOW,
+    };
+
+private:
+    Direction _direction;
+    bool _is_enabled = false;
+    bool _is_raised = false;
+    double _trigger = 0;
+    double _release = 0;
+
+public:
+    explicit ThresholdAlarm(Direction direction) : _direction(direction) {
+
+    }
+
+    // release is on the other side of trigger, the alarm starts cleared
+    void set(double trigger, double release) {
+        _is_enabled = true;
+        _is_raised = false;
+        _trigger = trigger;
+        _release = release;
+    }
+
+    void disable() {
+        _is_enabled = false;
+        _is_raised = false;
+    }
+
+    bool isEnabled() const {
+        return _is_enabled;
+    }
+
+    bool isRaised() const {
+        return _is_raised;
+    }
+
+    double getTrigger() const {
+        return _trigger;
+    }
+
+    // true when value raises or clears the alarm
+    bool update(double value) {
+        if (!_is_enabled) {
+            return false;
+        }
+        if (!_is_raised && (_direction == ABOVE ? value >= _trigger : value <= _trigger)) {
+            _is_raised = true;
+            return true;
+        }
+        if (_is_raised && (_direction == ABOVE ? value <= _release : value >= _release)) {
+            _is_raised = false;
+            return true;
+        }
+        return false;
+    }
+
+    // the alarm once update returned true, for the "alarms" of a report
+    std::string toJSON(const std::string &name, double value) const {
+        std::stringstream ss;
+        ss << R"({"alarm":")" << name << R"(", "raised":)" << (_is_raised ? "true" : "false") << R"(, "value":)" << value
+           << R"(, "trigger":)" << _trigger << R"(, "release":)" << _release << "}";
+        return ss.str();
+    }
+};
+
+// the members of a compact report: the increase of each counter since the previous report and the gauges which moved,
+// the rest is left out
+class ReportDeltas {
+private:
+    std::unordered_map<std::string, uint64_t> _previous;
+    bool _has_changes = false;
+
+public:
+    // , "name":increase unless it is 0 and not always
+    void counter(std::ostream &os, const std::string &name, uint64_t value, bool always = false) {
+        uint64_t &previous = _previous[name];
+        uint64_t increase = value >= previous ? value - previous : value;
+        previous = value;
+        if (increase > 0) {
+            _has_changes = true;
+        }
+        if (increase > 0 || always) {
+            os << R"(, ")" << name << R"(":)" << increase;
+        }
+    }
+
+    // , "name":value if it changed, the first time as well
+    void gauge(std::ostream &os, const std::string &name, uint64_t value) {
+        auto result = _previous.emplace(name, value);
+        if (result.second || result.first->second != value) {
+            result.first->second = value;
+            _has_changes = true;
+            os << R"(, ")" << name << R"(":)" << value;
+        }
+    }
+
+    // true if something written since the previous call changed, a report without changes isn't sent
+    bool takeChanges() {
+        bool has_changes = _has_changes;
+        _has_changes = false;
+        return has_changes;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "sampling_profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace sampling_profiler {
+    namespace {
+        // the handler itself and the trampoline of the signal
+        const int SKIPPED_FRAMES = 2;
+
+        struct Sample {
+            void *frames[MAX_FRAMES];
+            int depth;
+        };
+
+        // start and stop are serialized by the mutex, the handler only reads the fields set before the timer runs
+        std::mutex mutex;
+        std::unique_ptr<Sample[]> samples;
+        size_t capacity = 0;
+        size_t frequency = 0;
+        std::atomic<bool> running{false};
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> in_flight{0};
+        bool is_installed = false;
+
+        // backtrace is async-signal-safe once libgcc is loaded, which start() does by calling it first
+        void onSignal(int) {
+            int saved_errno = errno;
+            in_flight.fetch_add(1);
+            if (running.load()) {
+                size_t index = next.fetch_add(1, std::memory_order_relaxed);
+                if (index < capacity) {
+                    samples[index].depth = ::backtrace(samples[index].frames, MAX_FRAMES);
+                }
+            }
+            in_flight.fetch_sub(1);
+            errno = saved_errno;
+        }
+
+        bool setTimer(size_t frequency) {
+            itimerval timer = {};
+            if (frequency > 0) {
+                long period = 1000000 / frequency;
+                timer.it_interval.tv_sec = period / 1000000;
+                timer.it_interval.tv_usec = period % 1000000;
+                timer.it_value = timer.it_interval;
+            }
+            return ::setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+        }
+
+        std::string getSymbol(void *address, bool is_return_address) {
+            // a return address is past the call, which may be the last instruction of the function
+            void *lookup = is_return_address ? static_cast<char*>(address) - 1 : address;
+            Dl_info info;
+            if (::dladdr(lookup, &info) == 0) {
+                std::stringstream ss;
+                ss << address;
+                return ss.str();
+            }
+            if (info.dli_sname) {
+                int status;
+                char *demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+                std::string symbol = status == 0 && demangled ? demangled : info.dli_sname;
+                std::free(demangled);
+                return symbol;
+            }
+            std::string object = info.dli_fname ? info.dli_fname : "?";
+            std::stringstream ss;
+            ss << object.substr(object.find_last_of('/') + 1) << "+0x" << std::hex
+               << static_cast<char*>(address) - static_cast<char*>(info.dli_fbase);
+            return ss.str();
+        }
+
+        void appendEscaped(std::string &out, const std::string &text) {
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                }
+                out += c;
+            }
+        }
+    }
+
+    bool start(size_t profile_frequency, size_t duration_ms) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running || profile_frequency == 0) {
+            return false;
+        }
+        profile_frequency = std::min(profile_frequency, MAX_FREQUENCY);
+        duration_ms = std::min(duration_ms, MAX_DURATION_MS);
+        // CPU time runs as fast as the cores busy, all of them at most
+        size_t cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        capacity = std::min(profile_frequency * duration_ms / 1000 * cores + 1, MAX_SAMPLES);
+        samples.reset(new Sample[capacity]);
+        frequency = profile_frequency;
+        next = 0;
+        void *frames[1];
+        ::backtrace(frames, 1);
+        if (!is_installed) {
+            // kept once installed, a signal still pending when a profile stops then finds it not running
+            struct sigaction action = {};
+            action.sa_handler = onSignal;
+            action.sa_flags = SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            if (::sigaction(SIGPROF, &action, nullptr) != 0) {
+                return false;
+            }
+            is_installed = true;
+        }
+        running = true;
+        if (!setTimer(frequency)) {
+            running = false;
+            return false;
+        }
+        return true;
+    }
+
+    bool isRunning() {
+        return running;
+    }
+
+    std::string stop(size_t max_bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool was_running = running.exchange(false);
+        if (was_running) {
+            setTimer(0);
+        }
+        while (in_flight.load() > 0) {
+            std::this_thread::yield();
+        }
+        size_t taken = was_running ? next.load() : 0;
+        size_t count = std::min(taken, capacity);
+
+        // by addresses first, each address is then symbolized once
+        std::map<std::vector<void*>, size_t> by_addresses;
+        for (size_t i = 0; i < count; ++i) {
+            const Sample &sample = samples[i];
+            if (sample.depth > SKIPPED_FRAMES) {
+                ++by_addresses[std::vector<void*>(sample.frames + SKIPPED_FRAMES, sample.frames + sample.depth)];
+            }
+        }
+        std::unordered_map<void*, std::string> symbols;
+        std::map<std::string, size_t> by_symbols;
+        for (const auto &stack : by_addresses) {
+            std::string folded;
+            // from the root down to the leaf, the interrupted instruction
+            for (size_t i = stack.first.size(); i-- > 0;) {
+                void *address = stack.first[i];
+                auto it = symbols.find(address);
+                if (it == symbols.end()) {
+                    it = symbols.emplace(address, getSymbol(address, i > 0)).first;
+                }
+                if (!folded.empty()) {
+                    folded += ';';
+                }
+                folded += it->second;
+            }
+            by_symbols[folded] += stack.second;
+        }
+        std::vector<std::pair<size_t, const std::string*>> stacks;
+        stacks.reserve(by_symbols.size());
+        for (const auto &stack : by_symbols) {
+            stacks.emplace_back(stack.second, &stack.first);
+        }
+        std::sort(stacks.begin(), stacks.end(), [](const std::pair<size_t, const std::string*> &lhs, const std::pair<size_t, const std::string*> &rhs) {
+            return lhs.first > rhs.first;
+        });
+
+        std::string folded;
+        size_t truncated = 0;
+        for (const auto &stack : stacks) {
+            std::string line;
+            appendEscaped(line, *stack.second);
+            line += ' ' + std::to_string(stack.first) + "\\n";
+            if (folded.size() + line.size() > max_bytes) {
+                ++truncated;
+                continue;
+            }
+            folded += line;
+        }
+        samples.reset();
+        capacity = 0;
+
+        std::stringstream ss;
+        ss << R"({"frequency":)" << (was_running ? frequency : 0) << R"(, "samples":)" << count << R"(, "lost_samples":)" << taken - count
+           << R"(, "stacks":)" << stacks.size() << R"(, "truncated_stacks":)" << truncated << R"(, "folded":")" << folded << R"("})";
+        return ss.str();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// where the CPU time of the whole process goes, sampled on demand for the profile command, without perf in the
+// container: SIGPROF is raised every 1/frequency s of CPU time of the process, at most at the tick rate of the kernel,
+// on the thread spending it, and its handler takes the stack of that thread at once into a buffer reserved for the
+// profile. stop() symbolizes the stacks with the dynamic symbols, the executables export theirs, and folds them as
+// flamegraph.pl reads them, "main;run;...;leaf count". a frame without a symbol is "object+0xoffset", for addr2line.
+// one profile at a time
+namespace sampling_profiler {
+    static const size_t DEFAULT_FREQUENCY = 99;
+    static const size_t MAX_FREQUENCY = 1000;
+    static const size_t DEFAULT_DURATION_MS = 5000;
+    static const size_t MAX_DURATION_MS = 60000;
+    // of the folded stacks, for the reply to fit in a datagram
+    static const size_t DATAGRAM_BYTES = 60000;
+    // of a profile, those beyond are counted as lost
+    static const size_t MAX_SAMPLES = 1 << 15;
+    static const size_t MAX_FRAMES = 48;
+
+    // for duration_ms at frequency, at most MAX_FREQUENCY, false if a profile is running or the timer can't be set
+    bool start(size_t frequency, size_t duration_ms);
+
+    bool isRunning();
+
+    // {"frequency", "samples", "lost_samples", "stacks", "truncated_stacks", "folded"}, the most frequent stacks first
+    // in folded for at most max_bytes, the others counted in truncated_stacks. an empty profile if none is running
+    std::string stop(size_t max_bytes);
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "stage_profile.h"
+
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "metrics.h"
+
+namespace stage_profile {
+    namespace {
+        const char *const NAMES[STAGE_COUNT] = {"decode", "table", "encode", "send", "verify", "report"};
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<Counters>> counters;
+            // the calibration of the cycles, from the first scope of the process
+            uint64_t start_cycles = readCycles();
+            std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        };
+
+        Registry& getRegistry() {
+            static Registry registry;
+            return registry;
+        }
+    }
+
+    const char* getName(Stage stage) {
+        return NAMES[stage];
+    }
+
+    Counters::Counters() {
+        for (size_t i = 0; i < STAGE_COUNT; ++i) {
+            cycles[i].store(0, std::memory_order_relaxed);
+            scopes[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    Counters* addCounters() {
+        Registry &registry = getRegistry();
+        std::unique_ptr<Counters> counters(new Counters());
+        Counters *raw = counters.get();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.counters.push_back(std::move(counters));
+        return raw;
+    }
+
+    Totals getTotals() {
+        Registry &registry = getRegistry();
+        Totals totals;
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto &counters : registry.counters) {
+            for (size_t i = 0; i < STAGE_COUNT; ++i) {
+                totals.cycles[i] += counters->cycles[i].load(std::memory_order_relaxed) * SAMPLE_PERIOD;
+                totals.scopes[i] += counters->scopes[i].load(std::memory_order_relaxed);
+            }
+        }
+        return totals;
+    }
+
+    double getCyclesPerSecond() {
+        const Registry &registry = getRegistry();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - registry.start_time).count();
+        uint64_t cycles = readCycles() - registry.start_cycles;
+        return seconds > 0 && cycles > 0 ? cycles / seconds : 1e9;
+    }
+
+    std::string toJSON() {
+        Totals totals = getTotals();
+        double cycles_per_second = getCyclesPerSecond();
+        uint64_t all_cycles = 0;
+        for (size_t i = 0; i < STAGE_COUNT; ++i) {
+            all_cycles += totals.cycles[i];
+        }
+        std::stringstream ss;
+        ss << R"({"sample_period":)" << SAMPLE_PERIOD;
+        for (size_t i = 0; i < STAGE_COUNT; ++i) {
+            ss << R"(, ")" << NAMES[i] << R"(":{"seconds":)" << totals.cycles[i] / cycles_per_second
+               << R"(, "scopes":)" << totals.scopes[i]
+               << R"(, "share":)" << (all_cycles > 0 ? 100.0 * totals.cycles[i] / all_cycles : 0.0) << "}";
+        }
+        ss << "}";
+        return ss.str();
+    }
+
+    void writeMetrics(MetricsWriter &writer) {
+        Totals totals = getTotals();
+        double cycles_per_second = getCyclesPerSecond();
+        for (size_t i = 0; i < STAGE_COUNT; ++i) {
+            writer.counter("ndn_stage_seconds_total", "time spent by the threads in each stage, sampled", {{"stage", NAMES[i]}},
+                           totals.cycles[i] / cycles_per_second);
+            writer.counter("ndn_stage_scopes_total", "times each stage was entered", {{"stage", NAMES[i]}}, totals.scopes[i]);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#ifdef __x86_64__
+#include <x86intrin.h>
+#endif
+
+class MetricsWriter;
+
+// where the threads of a module spend their time, by stage of the packet handling, for the reports: a scope opened
+// around a stage counts its cycles, less those of the scopes nested in it which count for their own stage. 1 read in
+// SAMPLE_PERIOD is timed with the TSC, from its outermost scope down, the others only count their scopes. decode is
+// opened by the faces on each read and holds the fields decoded on first access and what the handlers do outside of
+// the other stages
+namespace stage_profile {
+    enum Stage {
+        DECODE,
+        TABLE,
+        ENCODE,
+        SEND,
+        VERIFY,
+        REPORT,
+        STAGE_COUNT
+    };
+
+    static const size_t SAMPLE_PERIOD = 64;
+
+    const char* getName(Stage stage);
+
+    inline uint64_t readCycles() {
+#ifdef __x86_64__
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // of a thread, written by it alone and read by the reports, kept once the thread is gone
+    struct Counters {
+        std::atomic<uint64_t> cycles[STAGE_COUNT];
+        std::atomic<uint64_t> scopes[STAGE_COUNT];
+
+        Counters();
+    };
+
+    struct State {
+        Counters *counters = nullptr;
+        size_t depth = 0;
+        size_t reads = 0;
+        bool is_sampled = false;
+        // the stage running and when its current slice began, while sampled
+        Stage stage = DECODE;
+        uint64_t begin = 0;
+    };
+
+    Counters* addCounters();
+
+    inline State& getState() {
+        static thread_local State state;
+        if (!state.counters) {
+            state.counters = addCounters();
+        }
+        return state;
+    }
+
+    inline void add(std::atomic<uint64_t> &counter, uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    class Scope {
+    private:
+        Stage _parent;
+
+    public:
+        explicit Scope(Stage stage) {
+            State &state = getState();
+            if (state.depth++ == 0) {
+                state.is_sampled = ++state.reads % SAMPLE_PERIOD == 0;
+            }
+            add(state.counters->scopes[stage], 1);
+            if (state.is_sampled) {
+                uint64_t now = readCycles();
+                if (state.depth > 1) {
+                    add(state.counters->cycles[state.stage], now - state.begin);
+                }
+                state.begin = now;
+            }
+            _parent = state.stage;
+            state.stage = stage;
+        }
+
+        ~Scope() {
+            State &state = getState();
+            if (state.is_sampled) {
+                uint64_t now = readCycles();
+                add(state.counters->cycles[state.stage], now - state.begin);
+                state.begin = now;
+            }
+            state.stage = _parent;
+            --state.depth;
+        }
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // of all the threads, the cycles scaled up to all the reads
+    struct Totals {
+        uint64_t cycles[STAGE_COUNT] = {};
+        uint64_t scopes[STAGE_COUNT] = {};
+    };
+
+    Totals getTotals();
+
+    // measured against the steady clock since the first scope
+    double getCyclesPerSecond();
+
+    // {"sample_period", "decode": {"seconds", "scopes", "share"}, ...} with the share in percent of the stages
+    std::string toJSON();
+
+    void writeMetrics(MetricsWriter &writer);
+}
\ No newline at end of file
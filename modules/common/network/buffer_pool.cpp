@@ -0,0 +1,91 @@
+#include "buffer_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#include "../metrics/metrics.h"
+
+namespace {
+    std::mutex pools_mutex;
+    std::vector<BufferPool*> pools;
+    // stats of the pools whose thread exited
+    BufferPoolStats retired;
+}
+
+std::string BufferPoolStats::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"hits":)" << hits << R"(, "misses":)" << misses << R"(, "buffers":)" << buffers << "}";
+    return ss.str();
+}
+
+void BufferPoolStats::writeMetrics(MetricsWriter &writer) const {
+    writer.counter("ndn_buffer_pool_hits_total", "buffers taken from the pools", {}, hits);
+    writer.counter("ndn_buffer_pool_misses_total", "buffers allocated past the pools", {}, misses);
+    writer.gauge("ndn_buffer_pool_buffers", "buffers held by the pools", {}, buffers);
+}
+
+BufferPool::BufferPool() : _hits(0), _misses(0), _size(0) {
+    std::lock_guard<std::mutex> lock(pools_mutex);
+    pools.push_back(this);
+}
+
+BufferPool::~BufferPool() {
+    std::lock_guard<std::mutex> lock(pools_mutex);
+    retired.hits += _hits;
+    retired.misses += _misses;
+    pools.erase(std::find(pools.begin(), pools.end(), this));
+}
+
+BufferPool& BufferPool::local() {
+    static thread_local BufferPool pool;
+    return pool;
+}
+
+BufferPoolStats BufferPool::getStats() {
+    std::lock_guard<std::mutex> lock(pools_mutex);
+    BufferPoolStats stats = retired;
+    for (const BufferPool *pool : pools) {
+        stats.hits += pool->_hits.load(std::memory_order_relaxed);
+        stats.misses += pool->_misses.load(std::memory_order_relaxed);
+        stats.buffers += pool->_size.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+std::shared_ptr<ndn::Buffer> BufferPool::acquire(size_t size) {
+    if (size > BUFFER_SIZE) {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return std::make_shared<ndn::Buffer>(size);
+    }
+
+    size_t scan = std::min(SCAN_LENGTH, _buffers.size());
+    for (size_t i = 0; i < scan; ++i) {
+        const std::shared_ptr<ndn::Buffer> &buffer = _buffers[_cursor];
+        _cursor = (_cursor + 1) % _buffers.size();
+        if (buffer.use_count() == 1) {
+            // the last other holder may have released it from another thread, see its writes before reusing it
+            std::atomic_thread_fence(std::memory_order_acquire);
+            buffer->resize(size);
+            _hits.fetch_add(1, std::memory_order_relaxed);
+            return buffer;
+        }
+    }
+
+    _misses.fetch_add(1, std::memory_order_relaxed);
+    auto buffer = std::make_shared<ndn::Buffer>(BUFFER_SIZE);
+    buffer->resize(size);
+    // every buffer is held elsewhere (cached packets, long queues), the pool grows up to MAX_BUFFERS
+    if (_buffers.size() < MAX_BUFFERS) {
+        _buffers.push_back(buffer);
+        _size.store(_buffers.size(), std::memory_order_relaxed);
+    }
+    return buffer;
+}
+
+std::shared_ptr<ndn::Buffer> BufferPool::copy(const void *data, size_t size) {
+    auto buffer = acquire(size);
+    std::memcpy(buffer->data(), data, size);
+    return buffer;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ndn-cxx/encoding/buffer.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class MetricsWriter;
+
+struct BufferPoolStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    size_t buffers = 0;
+
+    std::string toJSON() const;
+
+    void writeMetrics(MetricsWriter &writer) const;
+};
+
+// per-thread pool of packet sized buffers, used for received datagrams and copied wires,
+// a buffer is free again as soon as the pool is its only holder (packet consumed, write completed)
+// so a steady-state forwarding loop keeps reusing the same buffers instead of allocating
+class BufferPool {
+public:
+    static const size_t BUFFER_SIZE = 8800; // NDN_MAX_PACKET_SIZE
+    static const size_t MAX_BUFFERS = 1024;
+    // buffers are mostly released in the order they were taken, the next one after the cursor is usually free
+    static const size_t SCAN_LENGTH = 8;
+
+private:
+    std::vector<std::shared_ptr<ndn::Buffer>> _buffers;
+    size_t _cursor = 0;
+
+    // written by the owner thread only, read by getStats() from any thread
+    std::atomic<uint64_t> _hits;
+    std::atomic<uint64_t> _misses;
+    std::atomic<size_t> _size;
+
+    BufferPool();
+
+public:
+    BufferPool(const BufferPool&) = delete;
+
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    ~BufferPool();
+
+    // pool of the calling thread
+    static BufferPool& local();
+
+    // sum over the pools of all the threads
+    static BufferPoolStats getStats();
+
+    // the buffer comes from the pool when it isn't larger than BUFFER_SIZE, its content is undefined
+    std::shared_ptr<ndn::Buffer> acquire(size_t size);
+
+    std::shared_ptr<ndn::Buffer> copy(const void *data, size_t size);
+};
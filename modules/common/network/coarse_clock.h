@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <cstddef>
+
+// the time of the read being handled, for the expiry checks of the tables: the clock is read once when a face
+// delivers a read or a shard drains its inbox, rather than at each of those checks for each packet. out of such a
+// scope, e.g. in a timer or a command, now() reads the clock as before. per thread, a scope is only seen by the thread
+// it was opened on
+namespace coarse_clock {
+    struct State {
+        ndn::time::steady_clock::time_point now;
+        size_t depth = 0;
+    };
+
+    inline State& getState() {
+        static thread_local State state;
+        return state;
+    }
+
+    inline ndn::time::steady_clock::time_point now() {
+        const State &state = getState();
+        return state.depth > 0 ? state.now : ndn::time::steady_clock::now();
+    }
+
+    // the clock is read again within the outermost scope, for a loop which may run long, e.g. under load
+    inline void refresh() {
+        State &state = getState();
+        if (state.depth > 0) {
+            state.now = ndn::time::steady_clock::now();
+        }
+    }
+
+    // the time of the outermost scope is replaced, e.g. by that of a trace replayed offline, the tables then expire
+    // their entries at the times of the trace
+    inline void set(const ndn::time::steady_clock::time_point &now) {
+        State &state = getState();
+        if (state.depth > 0) {
+            state.now = now;
+        }
+    }
+
+    // nested scopes keep the time of the outermost one
+    class Scope {
+    public:
+        Scope() {
+            State &state = getState();
+            if (state.depth++ == 0) {
+                state.now = ndn::time::steady_clock::now();
+            }
+        }
+
+        ~Scope() {
+            --getState().depth;
+        }
+
+        Scope(const Scope&) = delete;
+
+        Scope& operator=(const Scope&) = delete;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "egress_queue.h"
+
+#include <ndn-cxx/name.hpp>
+
+#include <sstream>
+#include <unordered_map>
+
+std::atomic<size_t> QueuePolicy::_max_packets(8192);
+std::atomic<size_t> QueuePolicy::_max_bytes(1 << 25); // 32M
+std::atomic<int> QueuePolicy::_drop_policy(QueuePolicy::TAIL_DROP);
+std::atomic<int> QueuePolicy::_scheduler(QueuePolicy::FIFO);
+std::shared_ptr<const QueueClasses> QueuePolicy::_classes = std::make_shared<const QueueClasses>();
+std::atomic<size_t> QueuePolicy::_classes_version(0);
+
+size_t QueuePolicy::getMaxPackets() {
+    return _max_packets;
+}
+
+void QueuePolicy::setMaxPackets(size_t max_packets) {
+    _max_packets = max_packets;
+}
+
+size_t QueuePolicy::getMaxBytes() {
+    return _max_bytes;
+}
+
+void QueuePolicy::setMaxBytes(size_t max_bytes) {
+    _max_bytes = max_bytes;
+}
+
+QueuePolicy::DropPolicy QueuePolicy::getDropPolicy() {
+    return static_cast<DropPolicy>(_drop_policy.load());
+}
+
+std::string QueuePolicy::getDropPolicyName() {
+    switch (_drop_policy) {
+        case DROP_OLDEST_INTEREST:
+            return "oldest_interest";
+        case PROTECT_DATA:
+            return "protect_data";
+        default:
+            return "tail";
+    }
+}
+
+bool QueuePolicy::setDropPolicy(const std::string &policy) {
+    static const std::unordered_map<std::string, DropPolicy> POLICIES = {
+            {"tail", TAIL_DROP},
+            {"oldest_interest", DROP_OLDEST_INTEREST},
+            {"protect_data", PROTECT_DATA},
+    };
+
+    auto it = POLICIES.find(policy);
+    if (it == POLICIES.end()) {
+        return false;
+    }
+    _drop_policy = it->second;
+    return true;
+}
+
+QueuePolicy::Scheduler QueuePolicy::getScheduler() {
+    return static_cast<Scheduler>(_scheduler.load(std::memory_order_relaxed));
+}
+
+std::string QueuePolicy::getSchedulerName() {
+    return getScheduler() == QOS ? "qos" : "fifo";
+}
+
+bool QueuePolicy::setScheduler(const std::string &scheduler) {
+    if (scheduler == "fifo") {
+        _scheduler = FIFO;
+    } else if (scheduler == "qos") {
+        _scheduler = QOS;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const QueueClasses> QueuePolicy::getClasses() {
+    return std::atomic_load(&_classes);
+}
+
+size_t QueuePolicy::getClassesVersion() {
+    return _classes_version.load(std::memory_order_acquire);
+}
+
+bool QueuePolicy::setClasses(const rapidjson::Value &classes) {
+    if (!classes.IsArray()) {
+        return false;
+    }
+    auto queue_classes = std::make_shared<QueueClasses>();
+    for (const auto &value : classes.GetArray()) {
+        if (!value.IsObject() || !value.HasMember("prefix") || !value["prefix"].IsString()) {
+            return false;
+        }
+        QueueClass queue_class;
+        try {
+            const ndn::Block &name = ndn::Name(value["prefix"].GetString()).wireEncode();
+            queue_class.prefix.assign(reinterpret_cast<const char*>(name.value()), name.value_size());
+        } catch (const std::exception &e) {
+            return false;
+        }
+        queue_class.quantum = DEFAULT_QUANTUM;
+        if (value.HasMember("quantum")) {
+            if (!value["quantum"].IsUint() || value["quantum"].GetUint() == 0) {
+                return false;
+            }
+            queue_class.quantum = value["quantum"].GetUint();
+        }
+        queue_class.is_priority = value.HasMember("priority") && value["priority"].IsBool() && value["priority"].GetBool();
+        queue_classes->emplace_back(std::move(queue_class));
+    }
+    std::atomic_store(&_classes, std::shared_ptr<const QueueClasses>(std::move(queue_classes)));
+    _classes_version.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+size_t QueuePolicy::classify(const ndn::Buffer &wire, const QueueClasses &classes) {
+    const uint8_t *begin = wire.data();
+    const uint8_t *end = begin + wire.size();
+    uint64_t type, length;
+    // the outer header, then the Name in front of an Interest or a Data
+    if (classes.empty() || !tlv_reader::tryReadVarNumber(begin, end, type) || !tlv_reader::tryReadVarNumber(begin, end, length)
+        || !tlv_reader::tryReadVarNumber(begin, end, type) || type != ndn::tlv::Name
+        || !tlv_reader::tryReadVarNumber(begin, end, length) || length > static_cast<uint64_t>(end - begin)) {
+        return classes.size();
+    }
+    size_t best = classes.size();
+    for (size_t i = 0; i < classes.size(); ++i) {
+        const std::string &prefix = classes[i].prefix;
+        if (prefix.size() <= length && std::memcmp(prefix.data(), begin, prefix.size()) == 0
+            && (best == classes.size() || prefix.size() > classes[best].prefix.size())) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+std::string QueueStats::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"packets":)" << packets << R"(, "bytes":)" << bytes
+       << R"(, "dropped_interests":)" << dropped_interests << R"(, "dropped_data":)" << dropped_data
+       << R"(, "expired_interests":)" << expired_interests << R"(, "shed_interests":)" << shed_interests << "}";
+    return ss.str();
+}
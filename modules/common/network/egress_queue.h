@@ -0,0 +1,364 @@
+#pragma once
+
+#include <ndn-cxx/encoding/buffer.hpp>
+#include <ndn-cxx/encoding/tlv.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "face_stats.h"
+#include "../log/probes.h"
+#include "tlv_reader.h"
+#include "rapidjson/document.h"
+
+// a class of the qos scheduler, the packets under its prefix
+struct QueueClass {
+    // the TLV-VALUE of the Name, a packet is under it if its own starts with these bytes
+    std::string prefix;
+    // in bytes, the share of the class among the Interests is its quantum over the sum of those of the classes queued
+    size_t quantum;
+    // its Interests and Data go before all the others, e.g. the management and the latency-sensitive traffic
+    bool is_priority;
+};
+
+using QueueClasses = std::vector<QueueClass>;
+
+// limits and drop policy shared by every egress queue, editable at runtime through edit_config
+class QueuePolicy {
+public:
+    enum DropPolicy {
+        TAIL_DROP,            // the incoming packet is dropped
+        DROP_OLDEST_INTEREST, // queued Interests are dropped first (oldest first), then the incoming packet
+        PROTECT_DATA,         // incoming Interests are dropped, Data make room by dropping Interests and is never dropped
+    };
+
+    enum Scheduler {
+        FIFO, // the packets are sent in the order they are queued
+        QOS,  // the priority classes first, then Data, then Interests shared between the classes by deficit round robin
+    };
+
+    // of the Interests under no class, the quantum of a class isn't given
+    static const size_t DEFAULT_QUANTUM = 1500;
+
+private:
+    static std::atomic<size_t> _max_packets;
+    static std::atomic<size_t> _max_bytes;
+    static std::atomic<int> _drop_policy;
+    static std::atomic<int> _scheduler;
+    // replaced as a whole, the queues only load it again once the version changed
+    static std::shared_ptr<const QueueClasses> _classes;
+    static std::atomic<size_t> _classes_version;
+
+public:
+    // 0 means no limit
+    static size_t getMaxPackets();
+
+    static void setMaxPackets(size_t max_packets);
+
+    static size_t getMaxBytes();
+
+    static void setMaxBytes(size_t max_bytes);
+
+    static DropPolicy getDropPolicy();
+
+    static std::string getDropPolicyName();
+
+    // return false if the policy is unknown
+    static bool setDropPolicy(const std::string &policy);
+
+    static Scheduler getScheduler();
+
+    static std::string getSchedulerName();
+
+    // "fifo" or "qos", return false if the scheduler is unknown
+    static bool setScheduler(const std::string &scheduler);
+
+    static std::shared_ptr<const QueueClasses> getClasses();
+
+    static size_t getClassesVersion();
+
+    // from an array of {"prefix":"/a/b", "quantum":bytes, "priority":bool}, the last two optional. return false and
+    // leave the classes as they are if the array is malformed
+    static bool setClasses(const rapidjson::Value &classes);
+
+    // the longest class whose prefix the Name of the packet starts with, classes.size() if there is none or the packet
+    // has no Name in front, e.g. a link layer packet
+    static size_t classify(const ndn::Buffer &wire, const QueueClasses &classes);
+};
+
+struct QueueStats {
+    size_t packets = 0;
+    size_t bytes = 0;
+    uint64_t dropped_interests = 0;
+    uint64_t dropped_data = 0;
+    // Interests past their InterestLifetime before being sent, or which waited too long to be replayed, not counted
+    // in dropped_interests
+    uint64_t expired_interests = 0;
+    // Interests a TCP face dropped for lack of credits, see TcpFace::setCreditPolicy
+    uint64_t shed_interests = 0;
+
+    std::string toJSON() const;
+};
+
+// queue of encoded packets, an entry is either the buffer itself or a pair whose first member is the buffer. FIFO
+// unless the qos scheduler is set, a packet is then queued at the place it is sent from, never before the pinned
+// entries being sent: the priority classes, then Data and the link layer packets in order, then the Interests in the
+// rounds a deficit round robin between the classes would send them in. a round is the start tag of start-time fair
+// queueing, which orders the packets the same way without a queue per class, so the faces keep a single queue to index
+template <typename Entry>
+class EgressQueue {
+private:
+    // in ms, of an Interest without one as in ndn-cxx
+    static const size_t DEFAULT_LIFETIME = 4000;
+
+    enum Band : uint8_t {
+        PRIORITY,
+        DATA,
+        INTEREST,
+    };
+
+    struct Slot {
+        std::chrono::steady_clock::time_point push_time;
+        Band band;
+        // of an Interest under the qos scheduler
+        double round;
+    };
+
+    std::deque<Entry> _entries;
+    // in lockstep with _entries
+    std::deque<Slot> _slots;
+    // the classes the rounds are for, and the round each of them, then the Interests under none, is at
+    std::shared_ptr<const QueueClasses> _classes;
+    size_t _classes_version = 0;
+    std::vector<double> _class_rounds;
+    // of the last Interest written, a class which was idle starts there rather than being owed the rounds it missed
+    double _round = 0;
+    QueueStats _stats;
+    // time from push to pop_front, i.e. until the packet is written
+    LatencyHistogram _latency;
+
+public:
+    const QueueStats& getStats() const {
+        return _stats;
+    }
+
+    const LatencyHistogram& getLatency() const {
+        return _latency;
+    }
+
+    bool empty() const {
+        return _entries.empty();
+    }
+
+    size_t size() const {
+        return _entries.size();
+    }
+
+    typename std::deque<Entry>::const_iterator begin() const {
+        return _entries.begin();
+    }
+
+    typename std::deque<Entry>::const_iterator end() const {
+        return _entries.end();
+    }
+
+    Entry& front() {
+        return _entries.front();
+    }
+
+    Entry& operator[](size_t i) {
+        return _entries[i];
+    }
+
+    // return false if the packet is dropped, the first pinned entries are being sent and can't be dropped
+    bool push(Entry &&entry, size_t pinned) {
+        size_t size = wire(entry)->size();
+        bool is_data = isData(entry);
+        if (!fits(size)) {
+            QueuePolicy::DropPolicy policy = QueuePolicy::getDropPolicy();
+            if (policy == QueuePolicy::DROP_OLDEST_INTEREST || (policy == QueuePolicy::PROTECT_DATA && is_data)) {
+                dropInterests(size, pinned);
+            }
+            if (!fits(size) && !(policy == QueuePolicy::PROTECT_DATA && is_data)) {
+                if (is_data) {
+                    ++_stats.dropped_data;
+                } else {
+                    ++_stats.dropped_interests;
+                }
+                NDNMS_PROBE3(queue_drop, this, size, is_data ? 1 : 0);
+                return false;
+            }
+        }
+        _stats.bytes += size;
+        ++_stats.packets;
+        NDNMS_PROBE3(queue_enqueue, this, size, _stats.packets);
+        Slot slot{std::chrono::steady_clock::now(), DATA, 0};
+        if (QueuePolicy::getScheduler() == QueuePolicy::FIFO) {
+            _entries.push_back(std::move(entry));
+            _slots.push_back(slot);
+            return true;
+        }
+        schedule(*wire(entry), size, slot);
+        // the unpinned entries are in the order of their slots, the place is found by bisection
+        auto first = _slots.begin() + std::min(pinned, _slots.size());
+        auto position = std::upper_bound(first, _slots.end(), slot, precedes);
+        _entries.insert(_entries.begin() + (position - _slots.begin()), std::move(entry));
+        _slots.insert(position, slot);
+        return true;
+    }
+
+    void pop_front() {
+        size_t size = wire(_entries.front())->size();
+        _stats.bytes -= size;
+        --_stats.packets;
+        _entries.pop_front();
+        const Slot &slot = _slots.front();
+        auto elapsed = std::chrono::steady_clock::now() - slot.push_time;
+        auto wait = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        _latency.record(wait);
+        NDNMS_PROBE3(queue_dequeue, this, size, wait);
+        if (slot.band == INTEREST) {
+            _round = std::max(_round, slot.round);
+        }
+        _slots.pop_front();
+    }
+
+    // drops the Interests queued for longer than max_age, nothing must be being sent from the queue
+    void expireInterests(std::chrono::steady_clock::duration max_age) {
+        auto deadline = std::chrono::steady_clock::now() - max_age;
+        auto slot_it = _slots.begin();
+        for (auto it = _entries.begin(); it != _entries.end();) {
+            if (slot_it->push_time < deadline && !isData(*it)) {
+                _stats.bytes -= wire(*it)->size();
+                --_stats.packets;
+                ++_stats.expired_interests;
+                it = _entries.erase(it);
+                slot_it = _slots.erase(slot_it);
+            } else {
+                ++it;
+                ++slot_it;
+            }
+        }
+    }
+
+    // drops the Interests past their InterestLifetime from the front, until count packets which aren't are found, e.g.
+    // the packets of the next write. returns the number dropped, nothing must be being sent from the queue
+    size_t dropExpired(size_t count) {
+        auto now = std::chrono::steady_clock::now();
+        size_t dropped = 0;
+        size_t kept = 0;
+        auto slot_it = _slots.begin();
+        for (auto it = _entries.begin(); it != _entries.end() && kept < count;) {
+            const ndn::Buffer &buffer = *wire(*it);
+            if (!buffer.empty() && buffer.front() == ndn::tlv::Interest && now - slot_it->push_time > lifetimeOf(buffer)) {
+                _stats.bytes -= buffer.size();
+                --_stats.packets;
+                ++_stats.expired_interests;
+                NDNMS_PROBE3(queue_drop, this, buffer.size(), 0);
+                it = _entries.erase(it);
+                slot_it = _slots.erase(slot_it);
+                ++dropped;
+            } else {
+                ++it;
+                ++slot_it;
+                ++kept;
+            }
+        }
+        return dropped;
+    }
+
+private:
+    // only the elements of the Interest are walked, the default if it can't be read
+    static std::chrono::milliseconds lifetimeOf(const ndn::Buffer &buffer) {
+        try {
+            const uint8_t *it = buffer.data();
+            const uint8_t *end = it + buffer.size();
+            uint32_t type;
+            size_t length = tlv_reader::readHeader(it, end, type);
+            end = it + length;
+            while (it != end) {
+                length = tlv_reader::readHeader(it, end, type);
+                if (type == ndn::tlv::InterestLifetime) {
+                    return std::chrono::milliseconds(tlv_reader::readNonNegativeInteger(it, length));
+                }
+                it += length;
+            }
+        } catch (const ndn::tlv::Error&) {
+
+        }
+        return std::chrono::milliseconds(static_cast<int64_t>(DEFAULT_LIFETIME));
+    }
+
+    static const std::shared_ptr<const ndn::Buffer>& wire(const std::shared_ptr<const ndn::Buffer> &entry) {
+        return entry;
+    }
+
+    template <typename T>
+    static const std::shared_ptr<const ndn::Buffer>& wire(const std::pair<std::shared_ptr<const ndn::Buffer>, T> &entry) {
+        return entry.first;
+    }
+
+    static bool isData(const Entry &entry) {
+        const auto &buffer = wire(entry);
+        return !buffer->empty() && buffer->front() == ndn::tlv::Data;
+    }
+
+    // the Data of a band go in order, the Interests by round
+    static bool precedes(const Slot &slot, const Slot &other) {
+        return slot.band < other.band || (slot.band == INTEREST && other.band == INTEREST && slot.round < other.round);
+    }
+
+    void schedule(const ndn::Buffer &buffer, size_t size, Slot &slot) {
+        size_t version = QueuePolicy::getClassesVersion();
+        if (!_classes || version != _classes_version) {
+            _classes = QueuePolicy::getClasses();
+            _classes_version = version;
+            _class_rounds.assign(_classes->size() + 1, _round);
+        }
+        bool is_interest = !buffer.empty() && buffer.front() == ndn::tlv::Interest;
+        if (!is_interest && (buffer.empty() || buffer.front() != ndn::tlv::Data)) {
+            // e.g. the fragments of a packet, which stay in order
+            return;
+        }
+        size_t index = QueuePolicy::classify(buffer, *_classes);
+        if (index < _classes->size() && (*_classes)[index].is_priority) {
+            slot.band = PRIORITY;
+        } else if (is_interest) {
+            size_t quantum = index < _classes->size() ? (*_classes)[index].quantum : QueuePolicy::DEFAULT_QUANTUM;
+            slot.band = INTEREST;
+            slot.round = std::max(_round, _class_rounds[index]);
+            _class_rounds[index] = slot.round + static_cast<double>(size) / quantum;
+        }
+    }
+
+    // a packet always fits in an empty queue, even a larger one than the byte limit
+    bool fits(size_t size) const {
+        size_t max_packets = QueuePolicy::getMaxPackets();
+        size_t max_bytes = QueuePolicy::getMaxBytes();
+        return _entries.empty() ||
+               ((max_packets == 0 || _stats.packets < max_packets) && (max_bytes == 0 || _stats.bytes + size <= max_bytes));
+    }
+
+    void dropInterests(size_t size, size_t pinned) {
+        auto it = _entries.begin() + std::min(pinned, _entries.size());
+        while (it != _entries.end() && !fits(size)) {
+            if (isData(*it)) {
+                ++it;
+            } else {
+                _stats.bytes -= wire(*it)->size();
+                --_stats.packets;
+                ++_stats.dropped_interests;
+                NDNMS_PROBE3(queue_drop, this, wire(*it)->size(), 0);
+                _slots.erase(_slots.begin() + (it - _entries.begin()));
+                it = _entries.erase(it);
+            }
+        }
+    }
+};
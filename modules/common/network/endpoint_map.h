@@ -0,0 +1,131 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// open addressing hash table (linear probing, backward shift deletion) from remote endpoints to faces,
+// the slots only hold indexes in a dense vector so that iterating over all faces doesn't walk empty slots
+template <typename T>
+class EndpointMap {
+public:
+    using value_type = std::pair<boost::asio::ip::udp::endpoint, std::shared_ptr<T>>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+private:
+    static const uint32_t EMPTY = UINT32_MAX;
+
+    std::vector<uint32_t> _slots;
+    std::vector<value_type> _values;
+
+public:
+    EndpointMap() : _slots(16, EMPTY) {
+
+    }
+
+    size_t size() const {
+        return _values.size();
+    }
+
+    iterator begin() {
+        return _values.begin();
+    }
+
+    iterator end() {
+        return _values.end();
+    }
+
+    const_iterator begin() const {
+        return _values.begin();
+    }
+
+    const_iterator end() const {
+        return _values.end();
+    }
+
+    iterator find(const boost::asio::ip::udp::endpoint &endpoint) {
+        size_t slot = findSlot(endpoint);
+        return _slots[slot] == EMPTY ? _values.end() : _values.begin() + _slots[slot];
+    }
+
+    // the endpoint must not be in the map yet
+    void emplace(const boost::asio::ip::udp::endpoint &endpoint, const std::shared_ptr<T> &value) {
+        // keep the load factor under 1/2, probe sequences stay short
+        if ((_values.size() + 1) * 2 > _slots.size()) {
+            rehash(_slots.size() * 2);
+        }
+        _slots[findSlot(endpoint)] = (uint32_t) _values.size();
+        _values.emplace_back(endpoint, value);
+    }
+
+    void erase(const boost::asio::ip::udp::endpoint &endpoint) {
+        size_t mask = _slots.size() - 1;
+        size_t hole = findSlot(endpoint);
+        uint32_t index = _slots[hole];
+        if (index == EMPTY) {
+            return;
+        }
+
+        // shift back the following entries of the cluster which could not be placed in the hole
+        for (size_t next = (hole + 1) & mask; _slots[next] != EMPTY; next = (next + 1) & mask) {
+            size_t ideal = hash(_values[_slots[next]].first) & mask;
+            if (((next - ideal) & mask) >= ((next - hole) & mask)) {
+                _slots[hole] = _slots[next];
+                hole = next;
+            }
+        }
+        _slots[hole] = EMPTY;
+
+        // fill the gap in the dense vector with its last value
+        uint32_t last = (uint32_t) _values.size() - 1;
+        if (index != last) {
+            _slots[findSlot(_values[last].first)] = index;
+            _values[index] = std::move(_values[last]);
+        }
+        _values.pop_back();
+    }
+
+private:
+    static size_t hash(const boost::asio::ip::udp::endpoint &endpoint) {
+        uint64_t key;
+        if (endpoint.address().is_v4()) {
+            key = (uint64_t) endpoint.address().to_v4().to_ulong() << 16 | endpoint.port();
+        } else {
+            // FNV-1a over the address bytes
+            key = 14695981039346656037ULL;
+            for (uint8_t byte : endpoint.address().to_v6().to_bytes()) {
+                key = (key ^ byte) * 1099511628211ULL;
+            }
+            key ^= endpoint.port();
+        }
+        // mix the bits so that consecutive ports and addresses don't end up in the same cluster
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return (size_t) key;
+    }
+
+    // slot holding the endpoint, or the empty slot where it would be inserted
+    size_t findSlot(const boost::asio::ip::udp::endpoint &endpoint) const {
+        size_t mask = _slots.size() - 1;
+        size_t slot = hash(endpoint) & mask;
+        while (_slots[slot] != EMPTY && _values[_slots[slot]].first != endpoint) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void rehash(size_t size) {
+        _slots.assign(size, EMPTY);
+        for (uint32_t i = 0; i < _values.size(); ++i) {
+            _slots[findSlot(_values[i].first)] = i;
+        }
+    }
+};
+
+template <typename T>
+const uint32_t EndpointMap<T>::EMPTY;
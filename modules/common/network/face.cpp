@@ -0,0 +1,125 @@
+#include "face.h"
+
+#include <iostream>
+#include <sstream>
+
+#include "coarse_clock.h"
+#include "lp_link.h"
+#include "../metrics/memory_stats.h"
+#include "../metrics/metrics.h"
+#include "../metrics/stage_profile.h"
+
+std::atomic<size_t> Face::counter{0};
+
+Face::~Face() {
+    FaceTable::global().release(*this);
+}
+
+std::string Face::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"id":)" << _face_id << R"(, "protocol":")" << getUnderlyingProtocol() << R"(", "endpoint":")" << getUnderlyingEndpoint()
+       << R"(", "state":")" << getState() << R"(", "queue":)" << getQueueStats().toJSON() << R"(, "counters":)" << _counters.toJSON();
+    if (const LatencyHistogram *latency = getQueueLatency()) {
+        ss << R"(, "latency":)" << latency->toJSON();
+    }
+    ss << "}";
+    return ss.str();
+}
+
+void Face::addMemoryStats(MemoryStats &stats) const {
+    stats.add("face_buffers", 1, getBufferBytes());
+    QueueStats queue = getQueueStats();
+    stats.add("face_queues", queue.packets, queue.bytes);
+}
+
+void Face::writeMetrics(MetricsWriter &writer) const {
+    metrics::Labels labels = {{"face", std::to_string(_face_id)}, {"protocol", getUnderlyingProtocol()}};
+    auto traffic = [&](const char *direction, const TrafficCounters &counters) {
+        const std::pair<const char*, const RelaxedCounter*> types[] = {
+                {"interest", &counters.interests}, {"data", &counters.data}, {"other", &counters.others}};
+        const RelaxedCounter *bytes[] = {&counters.interest_bytes, &counters.data_bytes, &counters.other_bytes};
+        for (size_t i = 0; i < 3; ++i) {
+            metrics::Labels type_labels = labels;
+            type_labels.emplace_back("direction", direction);
+            type_labels.emplace_back("type", types[i].first);
+            writer.counter("ndn_face_packets_total", "packets through the face", type_labels, types[i].second->get());
+            writer.counter("ndn_face_bytes_total", "bytes through the face", type_labels, bytes[i]->get());
+        }
+    };
+    traffic("in", _counters.in);
+    traffic("out", _counters.out);
+    writer.counter("ndn_face_reconnects_total", "reconnections of the face", labels, _counters.reconnects.get());
+    QueueStats stats = getQueueStats();
+    writer.gauge("ndn_face_queued_packets", "packets waiting in the egress queue of the face", labels, stats.packets);
+    writer.gauge("ndn_face_queued_bytes", "bytes waiting in the egress queue of the face", labels, stats.bytes);
+    const std::pair<const char*, uint64_t> drops[] = {
+            {"interest", stats.dropped_interests}, {"data", stats.dropped_data}, {"expired", stats.expired_interests},
+            {"shed", stats.shed_interests}};
+    for (const auto &drop : drops) {
+        metrics::Labels drop_labels = labels;
+        drop_labels.emplace_back("reason", drop.first);
+        writer.counter("ndn_face_dropped_total", "packets dropped by the egress queue of the face", drop_labels, drop.second);
+    }
+}
+
+bool Face::carriesLpPacket(size_t size) const {
+    std::string protocol = getUnderlyingProtocol();
+    return protocol == "TCP" || (protocol == "UDP" && size <= LpLink::getMtu());
+}
+
+void Face::deliver(const std::shared_ptr<Face> &face, const ndn::Block &block, const ndn::Block *lp_packet) {
+    _counters.in.count(block.type(), block.size());
+    NDNMS_PROBE3(face_receive, _face_id, block.type(), block.size());
+    if (Tracer::isEnabled()) {
+        Tracer::onReceive(_face_id, block);
+    }
+    if (PacketCapture::isEnabled()) {
+        PacketCapture::onPacket(_face_id, PacketCapture::IN, block.wire(), block.size());
+    }
+    if (_burst_callback) {
+        _burst.emplace_back(block);
+        if (lp_packet) {
+            _burst.back().setLpPacket(*lp_packet);
+        }
+        return;
+    }
+    // the tables the packet goes through read the clock once, a burst does once for all its packets
+    coarse_clock::Scope scope;
+    stage_profile::Scope stage(stage_profile::DECODE);
+    if (_packet_handler || _packet_callback) {
+        NdnPacket packet(block);
+        if (lp_packet) {
+            packet.setLpPacket(*lp_packet);
+        }
+        if (_packet_handler) {
+            _packet_handler(face, std::move(packet));
+        } else {
+            _packet_callback(face, packet);
+        }
+        return;
+    }
+    switch (block.type()) {
+        case ndn::tlv::Interest:
+            _interest_callback(face, ndn::Interest(block));
+            break;
+        case ndn::tlv::Data:
+            _data_callback(face, ndn::Data(block));
+            break;
+        default:
+            break;
+    }
+}
+
+void Face::flushBurst(const std::shared_ptr<Face> &face) {
+    if (_burst.empty()) {
+        return;
+    }
+    coarse_clock::Scope scope;
+    stage_profile::Scope stage(stage_profile::DECODE);
+    try {
+        _burst_callback(face, _burst);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+    }
+    _burst.clear();
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/data.hpp>
+
+#include <boost/asio.hpp>
+//#include <boost/function.hpp>
+
+#include <atomic>
+#include <functional>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "egress_queue.h"
+#include "face_stats.h"
+#include "face_table.h"
+#include "ndn_packet.h"
+#include "packet_capture.h"
+#include "packet_handler.h"
+#include "socket_options.h"
+#include "tracer.h"
+#include "../log/probes.h"
+
+class MemoryStats;
+class MetricsWriter;
+
+class Face {
+public:
+    using InterestCallback = std::function<void(const std::shared_ptr<Face>&, const ndn::Interest&)>;
+    using DataCallback = std::function<void(const std::shared_ptr<Face>&, const ndn::Data&)>;
+    // for modules which don't need to decode packets, it replaces both typed callbacks
+    using PacketCallback = std::function<void(const std::shared_ptr<Face>&, const NdnPacket&)>;
+    // same as PacketCallback for all the packets of a read at once, e.g. a TCP chunk, the vector is only valid during
+    // the call
+    using BurstCallback = std::function<void(const std::shared_ptr<Face>&, const std::vector<NdnPacket>&)>;
+    using ErrorCallback = std::function<void(const std::shared_ptr<Face>&)>;
+
+private:
+    friend class FaceTable;
+
+    // faces are made on several threads at once, e.g. the accepts of the core services
+    static std::atomic<size_t> counter;
+
+    // the slot of the face in FaceTable::global(), 0 until a table refers to it
+    std::atomic<uint64_t> _table_ref{0};
+
+protected:
+    const size_t _face_id;
+
+    bool _is_connected = false;
+
+    boost::asio::io_service &_ios;
+
+    InterestCallback _interest_callback;
+    DataCallback _data_callback;
+    PacketCallback _packet_callback;
+    // same as _packet_callback without the type erasure, taken first when set
+    PacketHandler _packet_handler;
+    BurstCallback _burst_callback;
+    ErrorCallback _error_callback;
+    // the packets delivered since the last flushBurst, with a burst callback only
+    std::vector<NdnPacket> _burst;
+
+    // in is counted by deliver(), out by each face when a packet is handed to its send path, dropped or not
+    FaceCounters _counters;
+
+public:
+    explicit Face(boost::asio::io_service &ios) : _face_id(counter.fetch_add(1, std::memory_order_relaxed) + 1), _ios(ios) {
+
+    };
+
+    // the slot of the face in FaceTable::global() is released
+    virtual ~Face();
+
+    size_t getFaceId() const {
+        return _face_id;
+    }
+
+    bool isConnected() {
+        return _is_connected;
+    }
+
+    virtual std::string getUnderlyingProtocol() const = 0;
+
+    virtual std::string getUnderlyingEndpoint() const = 0;
+
+    // whether the peer gets an LpPacket of size bytes whole, with its fields: the TCP faces unwrap them, the UDP ones
+    // too below the MTU, past which they would fragment it as a whole, the others only carry bare packets
+    bool carriesLpPacket(size_t size) const;
+
+    virtual void open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) = 0;
+
+    void open(const PacketCallback &packet_callback, const ErrorCallback &error_callback) {
+        _packet_callback = packet_callback;
+        open(nullptr, nullptr, error_callback);
+    }
+
+    void open(const PacketHandler &packet_handler, const ErrorCallback &error_callback) {
+        _packet_handler = packet_handler;
+        open(nullptr, nullptr, error_callback);
+    }
+
+    void open(const BurstCallback &burst_callback, const ErrorCallback &error_callback) {
+        _burst_callback = burst_callback;
+        open(nullptr, nullptr, error_callback);
+    }
+
+    virtual void close() = 0;
+
+    virtual void send(const std::string &message) = 0;
+
+    virtual void send(const ndn::Interest &interest) = 0;
+
+    virtual void send(const ndn::Data &data) = 0;
+
+    // send an already encoded packet, the buffer is shared and never modified so it can be queued on several faces
+    virtual void send(const std::shared_ptr<const ndn::Buffer> &wire) = 0;
+
+    void send(const NdnPacket &packet) {
+        send(packet.getWire());
+    }
+
+    // reported by list
+    virtual std::string getState() const {
+        return _is_connected ? "connected" : "closed";
+    }
+
+    virtual QueueStats getQueueStats() const = 0;
+
+    // null for faces without their own egress queue
+    virtual const LatencyHistogram* getQueueLatency() const {
+        return nullptr;
+    }
+
+    // the receive buffers the face holds whatever the traffic, e.g. its read chunk or its rings
+    virtual size_t getBufferBytes() const {
+        return 0;
+    }
+
+    // before open for the options which only apply to a new connection, ignored by the faces without socket
+    virtual void setSocketOptions(const SocketOptions &options) {
+
+    }
+
+    const FaceCounters& getCounters() const {
+        return _counters;
+    }
+
+    std::string toJSON() const;
+
+    // the counters and the queue of the face, labelled with its id and protocol
+    void writeMetrics(MetricsWriter &writer) const;
+
+    // the buffers of the face as the part "face_buffers" and the packets waiting in its queue as "face_queues"
+    void addMemoryStats(MemoryStats &stats) const;
+
+    // the buffer behind a Block can be larger than the Block itself (view on a read chunk, encoding headroom)
+    static std::shared_ptr<const ndn::Buffer> getWireBuffer(const ndn::Block &block) {
+        auto buffer = block.getBuffer();
+        if (buffer->size() == block.size()) {
+            return buffer;
+        }
+        return BufferPool::local().copy(block.wire(), block.size());
+    }
+
+protected:
+    // counts a packet handed to the send path of the face, traces it and captures it
+    void countOut(const std::shared_ptr<const ndn::Buffer> &wire) {
+        _counters.out.count(wire->empty() ? 0 : wire->front(), wire->size());
+        NDNMS_PROBE3(face_send, _face_id, wire->empty() ? 0 : wire->front(), wire->size());
+        if (Tracer::isEnabled()) {
+            Tracer::onSend(_face_id, wire);
+        }
+        if (PacketCapture::isEnabled()) {
+            PacketCapture::onPacket(_face_id, PacketCapture::OUT, wire->data(), wire->size());
+        }
+    }
+
+    // gives a received packet to the callbacks the face was opened with, throws if it can't be decoded. with a burst
+    // callback the packet is only kept until flushBurst. lp_packet is the LpPacket which carried the packet whole, if
+    // any, see NdnPacket::getLpPacket
+    void deliver(const std::shared_ptr<Face> &face, const ndn::Block &block, const ndn::Block *lp_packet = nullptr);
+
+    // called by each face once it delivered all the packets of a read
+    void flushBurst(const std::shared_ptr<Face> &face);
+};
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// the faces of a master face, walked from any thread, e.g. by sendToAllFaces from the threads of the packets, while
+// they are accepted and lost on the threads of the master face and of the faces. the list is copied on each change
+// and published whole, a walk goes through the copy it got and never waits for a change, which may thus not be seen
+// by the walks already running. faces come and go far less often than packets are sent to all of them
+template <class F>
+class FaceList {
+public:
+    using Faces = std::vector<std::shared_ptr<F>>;
+
+private:
+    // the changes are serialized, the copies are read with atomic_load
+    std::mutex _mutex;
+    std::shared_ptr<const Faces> _faces;
+
+public:
+    FaceList() : _faces(std::make_shared<const Faces>()) {
+
+    }
+
+    FaceList(const FaceList&) = delete;
+
+    FaceList& operator=(const FaceList&) = delete;
+
+    void add(const std::shared_ptr<F> &face) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto faces = std::make_shared<Faces>(*_faces);
+        faces->push_back(face);
+        std::atomic_store(&_faces, std::shared_ptr<const Faces>(std::move(faces)));
+    }
+
+    // the order of the others may change, false if face wasn't there
+    template <class G>
+    bool remove(const std::shared_ptr<G> &face) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = std::find(_faces->begin(), _faces->end(), face);
+        if (it == _faces->end()) {
+            return false;
+        }
+        auto faces = std::make_shared<Faces>(*_faces);
+        std::swap((*faces)[it - _faces->begin()], faces->back());
+        faces->pop_back();
+        std::atomic_store(&_faces, std::shared_ptr<const Faces>(std::move(faces)));
+        return true;
+    }
+
+    // the faces at the time of the call, they may be closed while walked
+    std::shared_ptr<const Faces> get() const {
+        return std::atomic_load(&_faces);
+    }
+
+    size_t size() const {
+        return get()->size();
+    }
+};
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "face_stats.h"
+
+#include <ndn-cxx/encoding/tlv.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+void TrafficCounters::count(uint32_t type, size_t size) {
+    switch (type) {
+        case ndn::tlv::Interest:
+            interests.add(1);
+            interest_bytes.add(size);
+            break;
+        case ndn::tlv::Data:
+            data.add(1);
+            data_bytes.add(size);
+            break;
+        default:
+            others.add(1);
+            other_bytes.add(size);
+            break;
+    }
+}
+
+std::string TrafficCounters::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"interests":)" << interests.get() << R"(, "interest_bytes":)" << interest_bytes.get()
+       << R"(, "data":)" << data.get() << R"(, "data_bytes":)" << data_bytes.get()
+       << R"(, "others":)" << others.get() << R"(, "other_bytes":)" << other_bytes.get() << "}";
+    return ss.str();
+}
+
+std::string FaceCounters::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"in":)" << in.toJSON() << R"(, "out":)" << out.toJSON() << R"(, "reconnects":)" << reconnects.get() << "}";
+    return ss.str();
+}
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto &bucket : _buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::record(uint64_t microseconds) {
+    auto &bucket = _buckets[getBucket(microseconds)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    _count.add(1);
+    if (microseconds > _max.get()) {
+        _max.set(microseconds);
+    }
+}
+
+void LatencyHistogram::add(const LatencyHistogram &other) {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        _buckets[i].store(_buckets[i].load(std::memory_order_relaxed) + other._buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    _count.add(other._count.get());
+    if (other._max.get() > _max.get()) {
+        _max.set(other._max.get());
+    }
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return _count.get();
+}
+
+uint64_t LatencyHistogram::getQuantile(double quantile) const {
+    // buckets are read one by one while being written, the total is taken from them rather than from _count
+    uint64_t counts[BUCKETS];
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        counts[i] = _buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * total + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(getUpperBound(i), _max.get());
+        }
+    }
+    return _max.get();
+}
+
+std::string LatencyHistogram::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"count":)" << getCount() << R"(, "p50_us":)" << getQuantile(0.5) << R"(, "p90_us":)" << getQuantile(0.9)
+       << R"(, "p99_us":)" << getQuantile(0.99) << R"(, "p999_us":)" << getQuantile(0.999) << R"(, "max_us":)" << _max.get() << "}";
+    return ss.str();
+}
+
+size_t LatencyHistogram::getBucket(uint64_t microseconds) {
+    if (microseconds < SUB_BUCKETS) {
+        return microseconds;
+    }
+    // position of the highest bit, at least 3, the next 3 bits select the sub-bucket
+    size_t magnitude = 63 - __builtin_clzll(microseconds);
+    size_t bucket = (magnitude - 2) * SUB_BUCKETS + ((microseconds >> (magnitude - 3)) & (SUB_BUCKETS - 1));
+    return std::min(bucket, BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::getUpperBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+    size_t magnitude = bucket / SUB_BUCKETS + 2;
+    uint64_t sub_bucket = bucket % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub_bucket + 1) << (magnitude - 3)) - 1;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// counter with a single writer, the face thread or strand, read by the list command from any thread:
+// no read-modify-write is needed so an increment costs the same as on a plain integer
+class RelaxedCounter {
+private:
+    std::atomic<uint64_t> _value;
+
+public:
+    RelaxedCounter() : _value(0) {
+
+    }
+
+    void add(uint64_t n) {
+        _value.store(_value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void set(uint64_t value) {
+        _value.store(value, std::memory_order_relaxed);
+    }
+
+    uint64_t get() const {
+        return _value.load(std::memory_order_relaxed);
+    }
+};
+
+// packets and bytes of one direction of a face, by type of the outer TLV
+struct TrafficCounters {
+    RelaxedCounter interests;
+    RelaxedCounter interest_bytes;
+    RelaxedCounter data;
+    RelaxedCounter data_bytes;
+    // LpPacket fragments and anything else sent as is
+    RelaxedCounter others;
+    RelaxedCounter other_bytes;
+
+    void count(uint32_t type, size_t size);
+
+    std::string toJSON() const;
+};
+
+struct FaceCounters {
+    TrafficCounters in;
+    TrafficCounters out;
+    RelaxedCounter reconnects;
+
+    std::string toJSON() const;
+};
+
+// HDR style histogram of durations in microseconds: 8 linear sub-buckets per power of 2, so a recorded value is
+// known within 12.5%, up to 2^29us (about 9min), larger values fall in the last bucket
+class LatencyHistogram {
+public:
+    static const size_t SUB_BUCKETS = 8;
+    static const size_t MAGNITUDES = 26;
+    static const size_t BUCKETS = SUB_BUCKETS * (MAGNITUDES + 1);
+
+private:
+    std::atomic<uint64_t> _buckets[BUCKETS];
+    RelaxedCounter _count;
+    RelaxedCounter _max;
+
+public:
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    // single writer, like RelaxedCounter
+    void record(uint64_t microseconds);
+
+    // the counts of other are added, e.g. to sum up the histograms of several threads on one of them
+    void add(const LatencyHistogram &other);
+
+    uint64_t getCount() const;
+
+    // upper bound of the bucket holding the given quantile, in [0, 1]
+    uint64_t getQuantile(double quantile) const;
+
+    std::string toJSON() const;
+
+private:
+    static size_t getBucket(uint64_t microseconds);
+
+    static uint64_t getUpperBound(size_t bucket);
+};
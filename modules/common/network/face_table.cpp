@@ -0,0 +1,111 @@
+#include "face_table.h"
+
+#include <algorithm>
+
+#include "face.h"
+
+FaceTable::FaceTable() {
+    for (auto &chunk : _chunks) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+FaceTable& FaceTable::global() {
+    static FaceTable *table = new FaceTable();
+    return *table;
+}
+
+FaceTable::Slot& FaceTable::getSlot(uint32_t slot) const {
+    return _chunks[slot / CHUNK_SIZE].load(std::memory_order_acquire)[slot % CHUNK_SIZE];
+}
+
+void FaceTable::lock(Slot &slot) {
+    while (slot.locked.exchange(true, std::memory_order_acquire)) {
+
+    }
+}
+
+void FaceTable::unlock(Slot &slot) {
+    slot.locked.store(false, std::memory_order_release);
+}
+
+uint64_t FaceTable::pack(const Ref &ref) {
+    return (static_cast<uint64_t>(ref.slot) + 1) << 32 | ref.generation;
+}
+
+FaceTable::Ref FaceTable::unpack(uint64_t packed) {
+    return {static_cast<uint32_t>((packed >> 32) - 1), static_cast<uint32_t>(packed)};
+}
+
+FaceTable::Ref FaceTable::getRef(const std::shared_ptr<Face> &face) {
+    uint64_t packed = face->_table_ref.load(std::memory_order_acquire);
+    if (packed != 0) {
+        return unpack(packed);
+    }
+    std::lock_guard<std::mutex> guard(_mutex);
+    packed = face->_table_ref.load(std::memory_order_relaxed);
+    if (packed != 0) {
+        return unpack(packed);
+    }
+    uint32_t index;
+    if (!_free_slots.empty()) {
+        index = _free_slots.back();
+        _free_slots.pop_back();
+    } else {
+        index = _next_slot++;
+        if (index % CHUNK_SIZE == 0) {
+            // a process with more than CHUNK_SIZE * MAX_CHUNKS faces alive at once is out of reach
+            _chunks[index / CHUNK_SIZE].store(new Slot[CHUNK_SIZE], std::memory_order_release);
+        }
+    }
+    Slot &slot = getSlot(index);
+    lock(slot);
+    slot.face = face;
+    Ref ref{index, slot.generation};
+    unlock(slot);
+    face->_table_ref.store(pack(ref), std::memory_order_release);
+    return ref;
+}
+
+void FaceTable::release(Face &face) {
+    uint64_t packed = face._table_ref.load(std::memory_order_acquire);
+    if (packed == 0) {
+        return;
+    }
+    Ref ref = unpack(packed);
+    Slot &slot = getSlot(ref.slot);
+    lock(slot);
+    slot.face.reset();
+    ++slot.generation;
+    unlock(slot);
+    std::lock_guard<std::mutex> guard(_mutex);
+    _free_slots.emplace_back(ref.slot);
+}
+
+std::shared_ptr<Face> FaceTable::resolve(const Ref &ref) const {
+    Slot &slot = getSlot(ref.slot);
+    lock(slot);
+    std::shared_ptr<Face> face = slot.generation == ref.generation ? slot.face.lock() : nullptr;
+    unlock(slot);
+    return face;
+}
+
+void FaceTable::add(Refs &refs, const Ref &ref) {
+    if (!contains(refs, ref)) {
+        refs.emplace_back(ref);
+    }
+}
+
+bool FaceTable::contains(const Refs &refs, const Ref &ref) {
+    return std::find(refs.begin(), refs.end(), ref) != refs.end();
+}
+
+void FaceTable::resolve(const Refs &refs, Faces &faces) const {
+    for (const auto &ref : refs) {
+        if (auto face = resolve(ref)) {
+            if (std::find(faces.begin(), faces.end(), face) == faces.end()) {
+                faces.emplace_back(std::move(face));
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <boost/container/small_vector.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Face;
+
+// the faces of the process by slot, so that PIT and FIB entries name a face by a Ref of 8 bytes kept inline rather
+// than by a weak_ptr in a std::set. a face gets its slot the first time a table refers to it and gives it back when
+// destroyed, the generation of the slot is then bumped so that the references to the former face resolve to null and
+// not to the next face in that slot. slots are in chunks which never move and each one has its own spin lock,
+// resolving a Ref takes no global lock and allocates nothing
+class FaceTable {
+public:
+    struct Ref {
+        uint32_t slot;
+        uint32_t generation;
+
+        bool operator==(const Ref &other) const {
+            return slot == other.slot && generation == other.generation;
+        }
+
+        bool operator!=(const Ref &other) const {
+            return !(*this == other);
+        }
+    };
+
+    // entries almost always have 1 to 4 faces
+    using Refs = boost::container::small_vector<Ref, 4>;
+    using Faces = boost::container::small_vector<std::shared_ptr<Face>, 4>;
+
+private:
+    static const size_t CHUNK_SIZE = 1024;
+    static const size_t MAX_CHUNKS = 1024;
+
+    struct Slot {
+        std::atomic<bool> locked{false};
+        uint32_t generation = 0;
+        std::weak_ptr<Face> face;
+    };
+
+    // written under _mutex, read by any thread
+    std::atomic<Slot*> _chunks[MAX_CHUNKS];
+    std::mutex _mutex;
+    std::vector<uint32_t> _free_slots;
+    uint32_t _next_slot = 0;
+
+    FaceTable();
+
+    Slot& getSlot(uint32_t slot) const;
+
+    static void lock(Slot &slot);
+
+    static void unlock(Slot &slot);
+
+    // how a Ref is kept in its face, 0 while it has none
+    static uint64_t pack(const Ref &ref);
+
+    static Ref unpack(uint64_t packed);
+
+public:
+    FaceTable(const FaceTable&) = delete;
+
+    FaceTable& operator=(const FaceTable&) = delete;
+
+    // never destroyed, faces may outlive the static objects
+    static FaceTable& global();
+
+    // the Ref of the face, given a slot on first call
+    Ref getRef(const std::shared_ptr<Face> &face);
+
+    // from the destructor of the face
+    void release(Face &face);
+
+    // null if the face is gone
+    std::shared_ptr<Face> resolve(const Ref &ref) const;
+
+    // ref is appended unless already there
+    static void add(Refs &refs, const Ref &ref);
+
+    static bool contains(const Refs &refs, const Ref &ref);
+
+    // the faces of refs still alive are appended to faces unless already there
+    void resolve(const Refs &refs, Faces &faces) const;
+};
\ No newline at end of file
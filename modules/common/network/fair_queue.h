@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+
+// round robin over the faces the items came from, each face active at the start of a round has up to quantum of its
+// items handled by it, in their order. a face flooding the module then only delays the others by a quantum a round
+// rather than by all it queued before them. faces are forgotten once they have nothing queued
+template <class T>
+class FairQueue {
+private:
+    const size_t _quantum;
+    std::unordered_map<size_t, std::deque<T>> _queues;
+    // the faces with items, in the order they are served
+    std::deque<size_t> _active;
+    size_t _size = 0;
+
+public:
+    explicit FairQueue(size_t quantum) : _quantum(quantum) {
+
+    }
+
+    void push(size_t face_id, T &&item) {
+        auto &queue = _queues[face_id];
+        if (queue.empty()) {
+            _active.push_back(face_id);
+        }
+        queue.push_back(std::move(item));
+        ++_size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    // f(T&&) on the items of the round, it mustn't push
+    template <class F>
+    void round(const F &f) {
+        for (size_t faces = _active.size(); faces > 0; --faces) {
+            size_t face_id = _active.front();
+            _active.pop_front();
+            auto it = _queues.find(face_id);
+            for (size_t i = 0; i < _quantum && !it->second.empty(); ++i) {
+                T item = std::move(it->second.front());
+                it->second.pop_front();
+                --_size;
+                f(std::move(item));
+            }
+            if (it->second.empty()) {
+                _queues.erase(it);
+            } else {
+                _active.push_back(face_id);
+            }
+        }
+    }
+};
\ No newline at end of file
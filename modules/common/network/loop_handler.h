@@ -0,0 +1,89 @@
+#pragma once
+
+#include <boost/system/error_code.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// the memory of the operation a face keeps pending in a loop, e.g. its read: the same block from one operation to
+// the next instead of an allocation each. asio takes it through the allocation hooks of the handler and gives it back
+// before calling the handler, which can then start the next operation in it. an operation larger than the block, or
+// started while another one holds it, e.g. the read left by a lost connection, is allocated as before
+class HandlerMemory {
+public:
+    static const size_t SIZE = 256;
+
+private:
+    typename std::aligned_storage<SIZE>::type _storage;
+    bool _in_use = false;
+
+public:
+    HandlerMemory() = default;
+
+    HandlerMemory(const HandlerMemory&) = delete;
+
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+    void* allocate(size_t size) {
+        if (!_in_use && size <= SIZE) {
+            _in_use = true;
+            return &_storage;
+        }
+        return ::operator new(size);
+    }
+
+    void deallocate(void *pointer) {
+        if (pointer == &_storage) {
+            _in_use = false;
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+};
+
+// a member of T called with the error and the bytes of an operation, as boost::bind(&T::member, shared_from_this(),
+// _1, _2), but whose operations take their memory from a HandlerMemory of T and which is given to the member so that
+// a loop moves it into its next operation: T is then referenced once for the whole loop rather than once per
+// operation. a strand.wrap still copies it on each completion
+template <class T>
+class LoopHandler {
+public:
+    using Member = void (T::*)(LoopHandler&&, const boost::system::error_code&, size_t);
+
+private:
+    std::shared_ptr<T> _owner;
+    Member _member;
+    HandlerMemory *_memory;
+
+public:
+    LoopHandler(std::shared_ptr<T> owner, Member member, HandlerMemory &memory)
+            : _owner(std::move(owner)), _member(member), _memory(&memory) {
+
+    }
+
+    LoopHandler(const LoopHandler&) = default;
+
+    LoopHandler(LoopHandler&&) = default;
+
+    LoopHandler& operator=(const LoopHandler&) = default;
+
+    LoopHandler& operator=(LoopHandler&&) = default;
+
+    void operator()(const boost::system::error_code &err, size_t bytes_transferred) {
+        // the member may move this handler away, e.g. into the next read
+        T *owner = _owner.get();
+        (owner->*_member)(std::move(*this), err, bytes_transferred);
+    }
+
+    // found by asio through ADL, the memory of a handler moved from is still that of its owner
+    friend void* asio_handler_allocate(size_t size, LoopHandler *handler) {
+        return handler->_memory->allocate(size);
+    }
+
+    friend void asio_handler_deallocate(void *pointer, size_t size, LoopHandler *handler) {
+        handler->_memory->deallocate(pointer);
+    }
+};
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "loop_monitor.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "../log/logger.h"
+
+const size_t LoopMonitor::INTERVAL_MS;
+
+LoopMonitor::LoopMonitor(boost::asio::io_service &ios) : _ios(ios), _timer(ios) {
+
+}
+
+void LoopMonitor::start() {
+    _ios.post([this]() {
+        arm();
+    });
+}
+
+void LoopMonitor::arm() {
+    _expiry = Clock::now() + std::chrono::milliseconds(INTERVAL_MS);
+    _timer.expires_from_now(boost::posix_time::milliseconds(INTERVAL_MS));
+    _timer.async_wait([this](const boost::system::error_code &err) {
+        onTimer(err);
+    });
+}
+
+void LoopMonitor::onTimer(const boost::system::error_code &err) {
+    if (err) {
+        return;
+    }
+    Clock::time_point now = Clock::now();
+    uint64_t lag = now > _expiry ? std::chrono::duration_cast<std::chrono::microseconds>(now - _expiry).count() : 0;
+    // 1/8 of each new measure, a single slow handler doesn't make the loop overloaded
+    uint64_t smoothed = (_lag.load(std::memory_order_relaxed) * 7 + lag) / 8;
+    _lag.store(smoothed, std::memory_order_relaxed);
+    _max_lag.store(std::max(_max_lag.load(std::memory_order_relaxed), lag), std::memory_order_relaxed);
+    _ios.post([this, now]() {
+        _ready_wait.store(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - now).count(),
+                          std::memory_order_relaxed);
+    });
+    uint64_t threshold = _threshold.load(std::memory_order_relaxed) * 1000;
+    bool is_overloaded = _is_overloaded.load(std::memory_order_relaxed);
+    if (!is_overloaded && threshold > 0 && smoothed > threshold) {
+        _is_overloaded.store(true, std::memory_order_relaxed);
+        _overloads.fetch_add(1, std::memory_order_relaxed);
+        logger::log(logger::WARNING, "event loop lag of {}us, shedding load", {smoothed});
+    } else if (is_overloaded && (threshold == 0 || smoothed < threshold / 2)) {
+        _is_overloaded.store(false, std::memory_order_relaxed);
+        logger::log(logger::INFO, "event loop lag back to {}us", {smoothed});
+    }
+    arm();
+}
+
+size_t LoopMonitor::getThreshold() const {
+    return _threshold.load(std::memory_order_relaxed);
+}
+
+void LoopMonitor::setThreshold(size_t threshold) {
+    _threshold.store(threshold, std::memory_order_relaxed);
+}
+
+uint64_t LoopMonitor::getLag() const {
+    return _lag.load(std::memory_order_relaxed);
+}
+
+std::string LoopMonitor::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"lag_us":)" << getLag() << R"(, "max_lag_us":)" << _max_lag.load(std::memory_order_relaxed)
+       << R"(, "ready_wait_us":)" << _ready_wait.load(std::memory_order_relaxed) << R"(, "threshold_ms":)" << getThreshold()
+       << R"(, "overloaded":)" << (isOverloaded() ? "true" : "false")
+       << R"(, "overloads":)" << _overloads.load(std::memory_order_relaxed) << "}";
+    return ss.str();
+}
+
+void LoopMonitor::writeMetrics(MetricsWriter &writer, const metrics::Labels &labels) const {
+    writer.gauge("ndn_loop_lag_seconds", "how late the timers of the event loop fire, smoothed", labels, getLag() / 1e6);
+    writer.gauge("ndn_loop_ready_wait_seconds", "how long a handler ready to run waited for its turn", labels,
+                 _ready_wait.load(std::memory_order_relaxed) / 1e6);
+    writer.gauge("ndn_loop_overloaded", "1 while the work which can be done without is shed", labels, isOverloaded() ? 1 : 0);
+    writer.counter("ndn_loop_overloads_total", "times the event loop became overloaded", labels,
+                   _overloads.load(std::memory_order_relaxed));
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "../metrics/metrics.h"
+
+// how far behind an io_service runs its handlers: a timer armed every INTERVAL_MS measures how late it fires, and a
+// probe posted at the same time how long a handler ready to run waits for its turn, asio not telling how many there
+// are. the lag is smoothed over a few ticks, the loop is overloaded once it passes the threshold and until it is back
+// under half of it, the modules then shed the work they can do without, see isOverloaded
+class LoopMonitor {
+public:
+    static const size_t INTERVAL_MS = 100;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    boost::asio::io_service &_ios;
+    boost::asio::deadline_timer _timer;
+    Clock::time_point _expiry;
+    // in microseconds, written on _ios and read by the reports
+    std::atomic<uint64_t> _lag{0};
+    std::atomic<uint64_t> _max_lag{0};
+    std::atomic<uint64_t> _ready_wait{0};
+    // in milliseconds, 0 never overloaded
+    std::atomic<size_t> _threshold{0};
+    std::atomic<bool> _is_overloaded{false};
+    std::atomic<uint64_t> _overloads{0};
+
+    void arm();
+
+    void onTimer(const boost::system::error_code &err);
+
+public:
+    explicit LoopMonitor(boost::asio::io_service &ios);
+
+    LoopMonitor(const LoopMonitor&) = delete;
+
+    LoopMonitor& operator=(const LoopMonitor&) = delete;
+
+    // from any thread, the monitor must outlive the runs of ios
+    void start();
+
+    size_t getThreshold() const;
+
+    // in milliseconds of smoothed lag, 0 to never shed
+    void setThreshold(size_t threshold);
+
+    // read by each packet which could be shed
+    bool isOverloaded() const {
+        return _is_overloaded.load(std::memory_order_relaxed);
+    }
+
+    // smoothed, in microseconds
+    uint64_t getLag() const;
+
+    std::string toJSON() const;
+
+    void writeMetrics(MetricsWriter &writer, const metrics::Labels &labels) const;
+};
\ No newline at end of file
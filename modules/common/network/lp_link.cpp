@@ -0,0 +1,318 @@
+#include "lp_link.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "buffer_pool.h"
+
+namespace {
+
+    size_t varNumberSize(uint64_t number) {
+        return number < 253 ? 1 : number <= 0xFFFF ? 3 : number <= 0xFFFFFFFF ? 5 : 9;
+    }
+
+    uint8_t* writeVarNumber(uint8_t *out, uint64_t number) {
+        size_t length;
+        if (number < 253) {
+            *out++ = static_cast<uint8_t>(number);
+            return out;
+        } else if (number <= 0xFFFF) {
+            *out++ = 253;
+            length = 2;
+        } else if (number <= 0xFFFFFFFF) {
+            *out++ = 254;
+            length = 4;
+        } else {
+            *out++ = 255;
+            length = 8;
+        }
+        for (size_t i = length; i > 0; --i) {
+            *out++ = static_cast<uint8_t>(number >> (8 * (i - 1)));
+        }
+        return out;
+    }
+
+    size_t nonNegativeIntegerSize(uint64_t number) {
+        return number <= 0xFF ? 1 : number <= 0xFFFF ? 2 : number <= 0xFFFFFFFF ? 4 : 8;
+    }
+
+    uint8_t* writeNonNegativeInteger(uint8_t *out, uint32_t type, uint64_t number, size_t length) {
+        out = writeVarNumber(out, type);
+        out = writeVarNumber(out, length);
+        for (size_t i = length; i > 0; --i) {
+            *out++ = static_cast<uint8_t>(number >> (8 * (i - 1)));
+        }
+        return out;
+    }
+
+}
+
+// bound to references by std::min/max and std::chrono
+const size_t LpLink::VerifiedTag::MAC_SIZE;
+const size_t LpLink::MIN_MTU;
+const size_t LpLink::MAX_MTU;
+const int LpReassembler::TIMEOUT_MS;
+
+std::atomic<size_t> LpLink::_mtu(LpLink::DEFAULT_MTU);
+std::atomic<bool> LpLink::_aggregation(false);
+
+size_t LpLink::getMtu() {
+    return _mtu;
+}
+
+void LpLink::setMtu(size_t mtu) {
+    _mtu = std::max(MIN_MTU, std::min(mtu, MAX_MTU));
+}
+
+bool LpLink::getAggregation() {
+    return _aggregation;
+}
+
+void LpLink::setAggregation(bool aggregation) {
+    _aggregation = aggregation;
+}
+
+void LpLink::fragment(const ndn::Buffer &wire, size_t mtu, uint64_t &sequence, std::vector<std::shared_ptr<const ndn::Buffer>> &fragments) {
+    size_t payload = mtu - FRAGMENT_OVERHEAD;
+    size_t count = (wire.size() + payload - 1) / payload;
+    size_t count_size = nonNegativeIntegerSize(count);
+    for (size_t index = 0; index < count; ++index) {
+        size_t offset = index * payload;
+        size_t size = std::min(payload, wire.size() - offset);
+        size_t index_size = nonNegativeIntegerSize(index);
+        size_t value_size = 2 + 8
+                            + 2 + index_size
+                            + 2 + count_size
+                            + 1 + varNumberSize(size) + size;
+        auto buffer = BufferPool::local().acquire(1 + varNumberSize(value_size) + value_size);
+        uint8_t *out = buffer->data();
+        out = writeVarNumber(out, LP_PACKET);
+        out = writeVarNumber(out, value_size);
+        out = writeNonNegativeInteger(out, SEQUENCE, sequence++, 8);
+        out = writeNonNegativeInteger(out, FRAG_INDEX, index, index_size);
+        out = writeNonNegativeInteger(out, FRAG_COUNT, count, count_size);
+        out = writeVarNumber(out, FRAGMENT);
+        out = writeVarNumber(out, size);
+        std::memcpy(out, wire.data() + offset, size);
+        fragments.emplace_back(std::move(buffer));
+    }
+}
+
+std::shared_ptr<const ndn::Buffer> LpLink::nack(const uint8_t *interest, size_t size, NackReason reason) {
+    size_t reason_size = nonNegativeIntegerSize(reason);
+    size_t nack_size = varNumberSize(NACK_REASON) + 1 + reason_size;
+    size_t value_size = varNumberSize(NACK) + varNumberSize(nack_size) + nack_size
+                        + 1 + varNumberSize(size) + size;
+    auto buffer = BufferPool::local().acquire(1 + varNumberSize(value_size) + value_size);
+    uint8_t *out = buffer->data();
+    out = writeVarNumber(out, LP_PACKET);
+    out = writeVarNumber(out, value_size);
+    out = writeVarNumber(out, NACK);
+    out = writeVarNumber(out, nack_size);
+    out = writeNonNegativeInteger(out, NACK_REASON, reason, reason_size);
+    out = writeVarNumber(out, FRAGMENT);
+    out = writeVarNumber(out, size);
+    std::memcpy(out, interest, size);
+    return buffer;
+}
+
+std::shared_ptr<const ndn::Buffer> LpLink::congestionMark(const uint8_t *packet, size_t size, uint64_t mark) {
+    size_t mark_size = nonNegativeIntegerSize(mark);
+    size_t value_size = varNumberSize(CONGESTION_MARK) + 1 + mark_size + 1 + varNumberSize(size) + size;
+    auto buffer = BufferPool::local().acquire(1 + varNumberSize(value_size) + value_size);
+    uint8_t *out = buffer->data();
+    out = writeVarNumber(out, LP_PACKET);
+    out = writeVarNumber(out, value_size);
+    out = writeNonNegativeInteger(out, CONGESTION_MARK, mark, mark_size);
+    out = writeVarNumber(out, FRAGMENT);
+    out = writeVarNumber(out, size);
+    std::memcpy(out, packet, size);
+    return buffer;
+}
+
+std::shared_ptr<const ndn::Buffer> LpLink::credit(uint64_t limit) {
+    size_t limit_size = nonNegativeIntegerSize(limit);
+    size_t value_size = varNumberSize(CREDIT) + 1 + limit_size;
+    auto buffer = BufferPool::local().acquire(1 + varNumberSize(value_size) + value_size);
+    uint8_t *out = buffer->data();
+    out = writeVarNumber(out, LP_PACKET);
+    out = writeVarNumber(out, value_size);
+    writeNonNegativeInteger(out, CREDIT, limit, limit_size);
+    return buffer;
+}
+
+bool LpLink::readCredit(const uint8_t *lp_packet, size_t size, uint64_t &limit) {
+    const uint8_t *it = lp_packet;
+    const uint8_t *end = it + size;
+    try {
+        uint32_t type;
+        tlv_reader::readHeader(it, end, type);
+        while (it != end) {
+            size_t length = tlv_reader::readHeader(it, end, type);
+            if (type == CREDIT) {
+                limit = tlv_reader::readNonNegativeInteger(it, length);
+                return true;
+            }
+            it += length;
+        }
+    } catch (const ndn::tlv::Error &) {
+
+    }
+    return false;
+}
+
+std::shared_ptr<const ndn::Buffer> LpLink::verified(const uint8_t *data, size_t size, const VerifiedTag &tag) {
+    const size_t tag_size = sizeof(tag.verifier_id) + VerifiedTag::MAC_SIZE;
+    size_t value_size = varNumberSize(VERIFIED) + 1 + tag_size + 1 + varNumberSize(size) + size;
+    auto buffer = BufferPool::local().acquire(1 + varNumberSize(value_size) + value_size);
+    uint8_t *out = buffer->data();
+    out = writeVarNumber(out, LP_PACKET);
+    out = writeVarNumber(out, value_size);
+    out = writeVarNumber(out, VERIFIED);
+    out = writeVarNumber(out, tag_size);
+    for (size_t i = sizeof(tag.verifier_id); i > 0; --i) {
+        *out++ = static_cast<uint8_t>(tag.verifier_id >> (8 * (i - 1)));
+    }
+    out = std::copy(tag.mac.begin(), tag.mac.end(), out);
+    out = writeVarNumber(out, FRAGMENT);
+    out = writeVarNumber(out, size);
+    std::memcpy(out, data, size);
+    return buffer;
+}
+
+bool LpLink::readVerified(const uint8_t *lp_packet, size_t size, VerifiedTag &tag) {
+    const uint8_t *it = lp_packet;
+    const uint8_t *end = it + size;
+    try {
+        uint32_t type;
+        tlv_reader::readHeader(it, end, type);
+        while (it != end) {
+            size_t length = tlv_reader::readHeader(it, end, type);
+            if (type == VERIFIED) {
+                if (length != sizeof(tag.verifier_id) + VerifiedTag::MAC_SIZE) {
+                    return false;
+                }
+                tag.verifier_id = tlv_reader::readNonNegativeInteger(it, sizeof(tag.verifier_id));
+                std::copy(it + sizeof(tag.verifier_id), it + length, tag.mac.begin());
+                return true;
+            }
+            it += length;
+        }
+    } catch (const ndn::tlv::Error &) {
+
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool LpReassembler::receive(const ndn::Block &lp_packet, ndn::Block &packet) {
+    const uint8_t *it = lp_packet.wire();
+    const uint8_t *end = it + lp_packet.size();
+    uint32_t type;
+    tlv_reader::readHeader(it, end, type);
+
+    bool has_sequence = false;
+    uint64_t sequence = 0;
+    uint64_t index = 0;
+    uint64_t count = 1;
+    const uint8_t *fragment = nullptr;
+    size_t fragment_size = 0;
+    while (it != end) {
+        size_t length = tlv_reader::readHeader(it, end, type);
+        switch (type) {
+            case LpLink::SEQUENCE:
+                if (length != 8) {
+                    return false;
+                }
+                sequence = tlv_reader::readNonNegativeInteger(it, length);
+                has_sequence = true;
+                break;
+            case LpLink::FRAG_INDEX:
+                index = tlv_reader::readNonNegativeInteger(it, length);
+                break;
+            case LpLink::FRAG_COUNT:
+                count = tlv_reader::readNonNegativeInteger(it, length);
+                break;
+            case LpLink::FRAGMENT:
+                fragment = it;
+                fragment_size = length;
+                break;
+            case LpLink::NACK:
+                // the Interest of a Nack must not be forwarded as a new one
+                return false;
+            default:
+                // fields in [800, 959] ending with two 0 bits can be ignored, any other unknown one drops the packet
+                if (type < 800 || type > 959 || (type & 0x03) != 0) {
+                    return false;
+                }
+                break;
+        }
+        it += length;
+    }
+    // no Fragment is an idle packet
+    if (!fragment || index >= count || count > MAX_FRAGMENTS) {
+        return false;
+    }
+
+    const auto &buffer = lp_packet.getBuffer();
+    if (count == 1) {
+        auto begin = buffer->begin() + (fragment - buffer->data());
+        packet = ndn::Block(buffer, begin, begin + fragment_size);
+        return true;
+    }
+    if (!has_sequence) {
+        return false;
+    }
+
+    expire();
+    uint64_t first = sequence - index;
+    auto partial_it = _partial_packets.find(first);
+    if (partial_it == _partial_packets.end()) {
+        if (_partial_packets.size() >= MAX_PARTIAL_PACKETS) {
+            // the oldest sequence is the most likely to have lost a fragment
+            _partial_packets.erase(_partial_packets.begin());
+        }
+        partial_it = _partial_packets.emplace(first, PartialPacket()).first;
+        partial_it->second.fragments.resize(count);
+        partial_it->second.created = std::chrono::steady_clock::now();
+    }
+    PartialPacket &partial = partial_it->second;
+    if (partial.fragments.size() != count || partial.bytes + fragment_size > MAX_PACKET_SIZE) {
+        _partial_packets.erase(partial_it);
+        return false;
+    }
+    Fragment &slot = partial.fragments[index];
+    if (slot.buffer) {
+        // duplicate
+        return false;
+    }
+    slot.buffer = buffer;
+    slot.value = fragment;
+    slot.size = fragment_size;
+    partial.bytes += fragment_size;
+    if (++partial.received < count) {
+        return false;
+    }
+
+    auto wire = BufferPool::local().acquire(partial.bytes);
+    uint8_t *out = wire->data();
+    for (const auto &part : partial.fragments) {
+        std::memcpy(out, part.value, part.size);
+        out += part.size;
+    }
+    _partial_packets.erase(partial_it);
+    packet = ndn::Block(wire);
+    return true;
+}
+
+void LpReassembler::expire() {
+    auto deadline = std::chrono::steady_clock::now() - std::chrono::milliseconds(TIMEOUT_MS);
+    for (auto it = _partial_packets.begin(); it != _partial_packets.end();) {
+        if (it->second.created < deadline) {
+            it = _partial_packets.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/encoding/buffer.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tlv_reader.h"
+
+// NDNLPv2 on the UDP faces, settings shared by all of them and editable at runtime through edit_config
+//
+// packets larger than the MTU are sent as LpPackets holding a Sequence, a FragIndex, a FragCount and a Fragment each.
+// with aggregation, packets queued behind each other are also sent in a single datagram as long as they fit in the
+// MTU. NDNLPv2 has one Fragment per LpPacket, so this concatenates whole packets instead, only these faces split
+// such datagrams and aggregation is off by default for links to NFD
+class LpLink {
+public:
+    static const uint32_t LP_PACKET = 100;
+    static const uint32_t FRAGMENT = 80;
+    static const uint32_t SEQUENCE = 81;
+    static const uint32_t FRAG_INDEX = 82;
+    static const uint32_t FRAG_COUNT = 83;
+    static const uint32_t NACK = 800;
+    static const uint32_t NACK_REASON = 801;
+    static const uint32_t CONGESTION_MARK = 832;
+    // not part of NDNLPv2, in the range of the fields a peer which doesn't know them ignores
+    static const uint32_t CREDIT = 844;
+    // the Data was found valid by a signature verifier of the deployment, see VerifiedTag
+    static const uint32_t VERIFIED = 848;
+
+    // the value of a Verified field: the ID of the verifier which checked the Data and an HMAC-SHA256 of the Data by
+    // that verifier under a key the verifiers of the deployment share, for the next ones to trust the Data rather
+    // than check its signature again
+    struct VerifiedTag {
+        static const size_t MAC_SIZE = 32;
+
+        uint64_t verifier_id = 0;
+        std::array<uint8_t, MAC_SIZE> mac;
+    };
+
+    enum NackReason {
+        CONGESTION = 50,
+        DUPLICATE = 100,
+        NO_ROUTE = 150,
+    };
+
+    // IPv4 and UDP headers out of an Ethernet MTU
+    static const size_t DEFAULT_MTU = 1472;
+    static const size_t MIN_MTU = 256;
+    static const size_t MAX_MTU = 65507;
+    // LpPacket, Sequence, FragIndex, FragCount and Fragment headers, with less than 65536 fragments
+    static const size_t FRAGMENT_OVERHEAD = 26;
+    static const size_t MAX_AGGREGATED_PACKETS = 16;
+
+private:
+    static std::atomic<size_t> _mtu;
+    static std::atomic<bool> _aggregation;
+
+public:
+    static size_t getMtu();
+
+    // clamped to [MIN_MTU, MAX_MTU]
+    static void setMtu(size_t mtu);
+
+    static bool getAggregation();
+
+    static void setAggregation(bool aggregation);
+
+    // only NDN packets can be split again on reception, the probes of the master faces are sent alone
+    static bool canAggregate(const ndn::Buffer &wire) {
+        return !wire.empty() && (wire[0] == ndn::tlv::Interest || wire[0] == ndn::tlv::Data || wire[0] == LP_PACKET);
+    }
+
+    // LpPacket holding a Nack with the reason and the Interest of size bytes as Fragment, for the consumer to give up
+    // at once rather than at the end of the Interest lifetime
+    static std::shared_ptr<const ndn::Buffer> nack(const uint8_t *interest, size_t size, NackReason reason);
+
+    // LpPacket holding a CongestionMark and the packet of size bytes as Fragment, for the consumer to slow down
+    static std::shared_ptr<const ndn::Buffer> congestionMark(const uint8_t *packet, size_t size, uint64_t mark = 1);
+
+    // LpPacket holding a Credit alone: how many Interests the peer may have sent in all on the connection, see
+    // TcpFace::setCreditWindow
+    static std::shared_ptr<const ndn::Buffer> credit(uint64_t limit);
+
+    // true and set limit if the LpPacket of size bytes holds a Credit, it has nothing else to deliver then
+    static bool readCredit(const uint8_t *lp_packet, size_t size, uint64_t &limit);
+
+    // LpPacket holding a Verified field with tag and the Data of size bytes as Fragment
+    static std::shared_ptr<const ndn::Buffer> verified(const uint8_t *data, size_t size, const VerifiedTag &tag);
+
+    // true and set tag if the LpPacket of size bytes holds a Verified field
+    static bool readVerified(const uint8_t *lp_packet, size_t size, VerifiedTag &tag);
+
+    // LpPackets carrying wire in order, each one at most mtu bytes, sequence is advanced by the number of fragments
+    static void fragment(const ndn::Buffer &wire, size_t mtu, uint64_t &sequence, std::vector<std::shared_ptr<const ndn::Buffer>> &fragments);
+};
+
+// reassembly of the fragments received from a single peer
+class LpReassembler {
+public:
+    static const size_t MAX_PARTIAL_PACKETS = 32;
+    static const size_t MAX_FRAGMENTS = 128;
+    static const size_t MAX_PACKET_SIZE = 1 << 16;
+    // a packet whose fragments are not all received by then is dropped
+    static const int TIMEOUT_MS = 500;
+
+private:
+    struct Fragment {
+        // the received buffer is kept rather than copied until the packet is complete
+        std::shared_ptr<const ndn::Buffer> buffer;
+        const uint8_t *value = nullptr;
+        size_t size = 0;
+    };
+
+    struct PartialPacket {
+        std::vector<Fragment> fragments;
+        size_t received = 0;
+        size_t bytes = 0;
+        std::chrono::steady_clock::time_point created;
+    };
+
+    // by the sequence of the first fragment
+    std::map<uint64_t, PartialPacket> _partial_packets;
+
+public:
+    // the packets of a datagram in order: aggregated packets are split, LpPackets unwrapped or kept until their
+    // last fragment arrives, handler(packet, lp_packet) is called with each complete Interest or Data and the LpPacket
+    // which carried it whole, empty if none did, throws on a malformed datagram
+    template <typename Handler>
+    void receiveDatagram(const std::shared_ptr<const ndn::Buffer> &datagram, const Handler &handler) {
+        const uint8_t *begin = datagram->data();
+        const uint8_t *end = begin + datagram->size();
+        const uint8_t *current = begin;
+        while (current < end) {
+            const uint8_t *value = current;
+            uint32_t type;
+            size_t length = tlv_reader::readHeader(value, end, type);
+            const uint8_t *next = value + length;
+            if (type == ndn::tlv::Interest || type == ndn::tlv::Data) {
+                handler(ndn::Block(datagram, datagram->begin() + (current - begin), datagram->begin() + (next - begin)), ndn::Block());
+            } else if (type == LpLink::LP_PACKET) {
+                ndn::Block lp_packet(datagram, datagram->begin() + (current - begin), datagram->begin() + (next - begin));
+                ndn::Block packet;
+                if (receive(lp_packet, packet)) {
+                    handler(packet, packet.getBuffer() == datagram ? lp_packet : ndn::Block());
+                }
+            }
+            current = next;
+        }
+    }
+
+    // return true and set packet if the LpPacket holds or completes a network packet, false if it is kept or dropped.
+    // a packet the LpPacket carries whole is a view on its buffer
+    bool receive(const ndn::Block &lp_packet, ndn::Block &packet);
+
+private:
+    void expire();
+};
@@ -0,0 +1,4 @@
+#include "master_face.h"
+
+std::atomic<size_t> MasterFace::counter{0};
+const size_t MasterFace::DEFAULT_MAX_CONNECTION;
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <memory>
+#include <atomic>
+
+#include "face.h"
+#include "socket_options.h"
+
+class MasterFace {
+public:
+    // what modules give as max_connection, a master face can front thousands of consumers
+    static const size_t DEFAULT_MAX_CONNECTION = 4096;
+
+    using NotificationCallback = std::function<void(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face>&)>;
+    using ErrorCallback = std::function<void(const std::shared_ptr<MasterFace> &master_face, const std::shared_ptr<Face>&)>;
+
+private:
+    static std::atomic<size_t> counter;
+
+protected:
+    const size_t _master_face_id;
+
+    boost::asio::io_service &_ios;
+
+    size_t _max_connection;
+
+    NotificationCallback _notification_callback;
+    Face::InterestCallback _interest_callback;
+    Face::DataCallback _data_callback;
+    Face::PacketCallback _packet_callback;
+    PacketHandler _packet_handler;
+    Face::BurstCallback _burst_callback;
+    ErrorCallback _error_callback;
+
+public:
+    MasterFace(boost::asio::io_service &ios, size_t max_connection) : _master_face_id(counter.fetch_add(1, std::memory_order_relaxed) + 1), _ios(ios), _max_connection(max_connection) {
+
+    }
+
+    virtual ~MasterFace() = default;
+
+    boost::asio::io_service& get_io_service() const {
+        return _ios;
+    }
+
+    size_t getMasterFaceId() const {
+        return _master_face_id;
+    }
+
+    virtual std::string getUnderlyingProtocol() const = 0;
+
+    virtual void listen(const NotificationCallback &notification_callback, const Face::InterestCallback &interest_callback,
+                        const Face::DataCallback &data_callback, const ErrorCallback &error_callback) = 0;
+
+    void listen(const NotificationCallback &notification_callback, const Face::PacketCallback &packet_callback, const ErrorCallback &error_callback) {
+        _packet_callback = packet_callback;
+        listen(notification_callback, nullptr, nullptr, error_callback);
+    }
+
+    // the accepted faces are opened with packet_handler, see PacketHandler
+    void listen(const NotificationCallback &notification_callback, const PacketHandler &packet_handler, const ErrorCallback &error_callback) {
+        _packet_handler = packet_handler;
+        listen(notification_callback, nullptr, nullptr, error_callback);
+    }
+
+    void listen(const NotificationCallback &notification_callback, const Face::BurstCallback &burst_callback, const ErrorCallback &error_callback) {
+        _burst_callback = burst_callback;
+        listen(notification_callback, nullptr, nullptr, error_callback);
+    }
+
+    virtual void close() = 0;
+
+    // the faces already accepted are kept, e.g. while the module drains before it stops
+    virtual void stopAccepting() = 0;
+
+    // waiting in the egress queues of the master face and of its faces
+    virtual size_t getQueuedPackets() const = 0;
+
+    virtual void sendToAllFaces(const std::string &message) = 0;
+
+    virtual void sendToAllFaces(const ndn::Interest &interest) = 0;
+
+    virtual void sendToAllFaces(const ndn::Data &data) = 0;
+
+    virtual void sendToAllFaces(const std::shared_ptr<const ndn::Buffer> &wire) = 0;
+
+    void sendToAllFaces(const NdnPacket &packet) {
+        sendToAllFaces(packet.getWire());
+    }
+
+    virtual std::string toJSON() const = 0;
+
+    // the metrics of its faces, from where toJSON would be called
+    virtual void writeMetrics(MetricsWriter &writer) const = 0;
+
+    // the buffers and the queues of its faces, see Face::addMemoryStats
+    virtual void addMemoryStats(MemoryStats &stats) const = 0;
+
+    // for the sockets of the master face and of the faces it accepts later on, ignored by the faces without socket
+    virtual void setSocketOptions(const SocketOptions &options) {
+
+    }
+
+protected:
+    // new faces get the same kind of callbacks the master face listens with
+    void openFace(const std::shared_ptr<Face> &face, const Face::ErrorCallback &error_callback) {
+        if (_burst_callback) {
+            face->open(_burst_callback, error_callback);
+        } else if (_packet_handler) {
+            face->open(_packet_handler, error_callback);
+        } else if (_packet_callback) {
+            face->open(_packet_callback, error_callback);
+        } else {
+            face->open(_interest_callback, _data_callback, error_callback);
+        }
+    }
+};
\ No newline at end of file
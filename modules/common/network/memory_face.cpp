@@ -0,0 +1,181 @@
+#include "memory_face.h"
+
+#include <boost/bind.hpp>
+
+#include <sstream>
+
+#include "memory_master_face.h"
+#include "../log/logger.h"
+#include "../metrics/stage_profile.h"
+
+MemoryFace::MemoryFace(boost::asio::io_service &ios, const std::string &host, uint16_t port)
+        : Face(ios)
+        , _skip_connect(false)
+        , _port(port)
+        , _inbox(INBOX_SIZE)
+        , _is_receiving(false)
+        , _dropped_interests(0)
+        , _dropped_data(0) {
+
+}
+
+MemoryFace::MemoryFace(boost::asio::io_service &ios, uint16_t port, const std::shared_ptr<MemoryFace> &peer)
+        : Face(ios)
+        , _skip_connect(true)
+        , _port(port)
+        , _peer(peer)
+        , _inbox(INBOX_SIZE)
+        , _is_receiving(false)
+        , _dropped_interests(0)
+        , _dropped_data(0) {
+    _is_connected = true;
+}
+
+std::string MemoryFace::getUnderlyingProtocol() const {
+    return "MEM";
+}
+
+std::string MemoryFace::getUnderlyingEndpoint() const {
+    std::stringstream ss;
+    ss << "mem://" << _port;
+    return ss.str();
+}
+
+void MemoryFace::open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) {
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    if (_skip_connect) {
+        return;
+    }
+    auto master_face = MemoryMasterFace::find(_port);
+    if (!master_face) {
+        std::stringstream ss;
+        ss << "no master face listening on mem://" << _port;
+        logger::log(logger::ERROR, ss.str());
+        _ios.post(boost::bind(&MemoryFace::onError, shared_from_this()));
+        return;
+    }
+    master_face->get_io_service().post(boost::bind(&MemoryMasterFace::accept, master_face, shared_from_this()));
+}
+
+void MemoryFace::close() {
+    _is_connected = false;
+    _is_closed = true;
+    auto peer = std::atomic_exchange(&_peer, std::shared_ptr<MemoryFace>());
+    if (peer) {
+        peer->_ios.post(boost::bind(&MemoryFace::onPeerClosed, peer));
+    }
+}
+
+void MemoryFace::send(const std::string &message) {
+    send(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void MemoryFace::send(const ndn::Interest &interest) {
+    send(getWireBuffer(interest.wireEncode()));
+}
+
+void MemoryFace::send(const ndn::Data &data) {
+    send(getWireBuffer(data.wireEncode()));
+}
+
+void MemoryFace::send(const std::shared_ptr<const ndn::Buffer> &wire) {
+    stage_profile::Scope stage(stage_profile::SEND);
+    auto peer = std::atomic_load(&_peer);
+    if (!peer || !peer->push(wire)) {
+        if (!wire->empty() && wire->front() == ndn::tlv::Interest) {
+            _dropped_interests.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            _dropped_data.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+QueueStats MemoryFace::getQueueStats() const {
+    // nothing waits on this side, the packets are either in the inbox of the peer or dropped
+    QueueStats stats;
+    stats.dropped_interests = _dropped_interests.load(std::memory_order_relaxed);
+    stats.dropped_data = _dropped_data.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MemoryFace::link(const std::shared_ptr<MemoryFace> &peer) {
+    _ios.post(boost::bind(&MemoryFace::linkHandler, shared_from_this(), peer));
+}
+
+void MemoryFace::linkHandler(const std::shared_ptr<MemoryFace> &peer) {
+    if (!peer) {
+        std::stringstream ss;
+        ss << "master face on mem://" << _port << " refused the face with ID = " << _face_id;
+        logger::log(logger::ERROR, ss.str());
+        onError();
+        return;
+    }
+    if (_is_closed) {
+        peer->_ios.post(boost::bind(&MemoryFace::onPeerClosed, peer));
+        return;
+    }
+    std::atomic_store(&_peer, peer);
+    _is_connected = true;
+}
+
+bool MemoryFace::push(const std::shared_ptr<const ndn::Buffer> &wire) {
+    if (!_inbox.emplace(wire)) {
+        return false;
+    }
+    if (!_is_receiving.exchange(true)) {
+        _ios.post(boost::bind(&MemoryFace::receive, shared_from_this()));
+    }
+    return true;
+}
+
+void MemoryFace::receive() {
+    // the out counters and the send traces of the peer are written here rather than by its senders, which can be on
+    // any thread
+    auto peer = std::atomic_load(&_peer);
+    size_t count = 0;
+    while (count < RECEIVE_BATCH) {
+        std::shared_ptr<const ndn::Buffer> *wire = _inbox.peek(0);
+        if (!wire) {
+            break;
+        }
+        std::shared_ptr<const ndn::Buffer> buffer = std::move(*wire);
+        _inbox.pop();
+        ++count;
+        if (peer) {
+            peer->countOut(buffer);
+        }
+        // what was pushed before the face closed is dropped
+        if (!_is_connected) {
+            continue;
+        }
+        try {
+            deliver(shared_from_this(), ndn::Block(buffer));
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    flushBurst(shared_from_this());
+    if (count == RECEIVE_BATCH) {
+        _ios.post(boost::bind(&MemoryFace::receive, shared_from_this()));
+        return;
+    }
+    // a sender may have pushed after the last peek but seen the face as still receiving
+    _is_receiving = false;
+    if (_inbox.peek(0) && !_is_receiving.exchange(true)) {
+        _ios.post(boost::bind(&MemoryFace::receive, shared_from_this()));
+    }
+}
+
+void MemoryFace::onPeerClosed() {
+    // the peer closed first, reported as a TCP face reports the end of the stream
+    if (std::atomic_exchange(&_peer, std::shared_ptr<MemoryFace>()) && !_is_closed) {
+        onError();
+    }
+}
+
+void MemoryFace::onError() {
+    _is_connected = false;
+    _error_callback(shared_from_this());
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "face.h"
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "mpsc_queue.h"
+
+// face to a module of the same process, i.e. another stage of a pipeline: a packet sent is pushed with its buffer to
+// the inbox of the peer face and delivered on the io_service of the peer, there is no copy, no framing and no syscall
+//
+// the connecting face finds the master face listening on its port in a registry of the process, see MemoryMasterFace,
+// which creates the peer face on its own io_service. a full inbox drops the packet as a full socket buffer would
+class MemoryFace : public Face, public std::enable_shared_from_this<MemoryFace> {
+public:
+    static const size_t INBOX_SIZE = 1 << 12;
+    // packets delivered by one handler before it lets the others run
+    static const size_t RECEIVE_BATCH = 256;
+
+private:
+    bool _skip_connect;
+    // a face closed before the master face linked it gives the peer back at once
+    bool _is_closed = false;
+
+    uint16_t _port;
+    // set once both faces are linked and reset by close(), the senders of any thread read it
+    std::shared_ptr<MemoryFace> _peer;
+    // pushed by the peer, drained by receive()
+    MpscQueue<std::shared_ptr<const ndn::Buffer>> _inbox;
+    std::atomic<bool> _is_receiving;
+    std::atomic<uint64_t> _dropped_interests;
+    std::atomic<uint64_t> _dropped_data;
+
+public:
+    // use this when creating a face yourself, host is not used since the peer is found by its port in this process
+    MemoryFace(boost::asio::io_service &ios, const std::string &host, uint16_t port);
+
+    // specific constructor for MasterFace, not recommended to use it yourself
+    MemoryFace(boost::asio::io_service &ios, uint16_t port, const std::shared_ptr<MemoryFace> &peer);
+
+    ~MemoryFace() override = default;
+
+    std::string getUnderlyingProtocol() const override;
+
+    std::string getUnderlyingEndpoint() const override;
+
+    using Face::open;
+
+    void open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+    void close() override;
+
+    using Face::send;
+
+    void send(const std::string &message) override;
+
+    void send(const ndn::Interest &interest) override;
+
+    void send(const ndn::Data &data) override;
+
+    void send(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+    QueueStats getQueueStats() const override;
+
+    // called by the master face from its own thread once it accepted the face, null when it refused it
+    void link(const std::shared_ptr<MemoryFace> &peer);
+
+private:
+    void linkHandler(const std::shared_ptr<MemoryFace> &peer);
+
+    // from the thread of the peer, false if the inbox is full
+    bool push(const std::shared_ptr<const ndn::Buffer> &wire);
+
+    void receive();
+
+    void onPeerClosed();
+
+    void onError();
+};
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "memory_master_face.h"
+
+#include <boost/bind.hpp>
+
+#include "../log/logger.h"
+#include "../metrics/memory_stats.h"
+#include "../metrics/metrics.h"
+
+std::mutex MemoryMasterFace::registry_mutex;
+std::unordered_map<uint16_t, std::weak_ptr<MemoryMasterFace>> MemoryMasterFace::registry;
+
+MemoryMasterFace::MemoryMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port)
+        : MasterFace(ios, max_connection)
+        , _port(port) {
+
+}
+
+std::shared_ptr<MemoryMasterFace> MemoryMasterFace::find(uint16_t port) {
+    std::lock_guard<std::mutex> guard(registry_mutex);
+    auto it = registry.find(port);
+    return it != registry.end() ? it->second.lock() : nullptr;
+}
+
+std::string MemoryMasterFace::getUnderlyingProtocol() const {
+    return "MEM";
+}
+
+void MemoryMasterFace::setServicePicker(const ServicePicker &service_picker) {
+    _service_picker = service_picker;
+}
+
+void MemoryMasterFace::listen(const NotificationCallback &notification_callback, const Face::InterestCallback &interest_callback,
+                              const Face::DataCallback &data_callback, const ErrorCallback &error_callback) {
+    _notification_callback = notification_callback;
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    {
+        std::lock_guard<std::mutex> guard(registry_mutex);
+        auto &master_face = registry[_port];
+        if (!master_face.expired()) {
+            std::stringstream ss;
+            ss << "master face with ID = " << _master_face_id << " can't listen on mem://" << _port << ": port already in use";
+            logger::log(logger::ERROR, ss.str());
+            return;
+        }
+        master_face = shared_from_this();
+    }
+    _is_listening = true;
+    std::stringstream ss;
+    ss << "master face with ID = " << _master_face_id << " listening on mem://" << _port;
+    logger::log(logger::INFO, ss.str());
+}
+
+void MemoryMasterFace::close() {
+    stopAccepting();
+    std::lock_guard<std::mutex> guard(_faces_mutex);
+    for(const auto &face : _faces) {
+        face->close();
+    }
+}
+
+void MemoryMasterFace::stopAccepting() {
+    if (_is_listening) {
+        _is_listening = false;
+        std::lock_guard<std::mutex> guard(registry_mutex);
+        registry.erase(_port);
+    }
+}
+
+size_t MemoryMasterFace::getQueuedPackets() const {
+    size_t packets = 0;
+    std::lock_guard<std::mutex> guard(_faces_mutex);
+    for (const auto &face : _faces) {
+        packets += face->getQueueStats().packets;
+    }
+    return packets;
+}
+
+void MemoryMasterFace::sendToAllFaces(const std::string &message) {
+    sendToAllFaces(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void MemoryMasterFace::sendToAllFaces(const ndn::Interest &interest) {
+    sendToAllFaces(Face::getWireBuffer(interest.wireEncode()));
+}
+
+void MemoryMasterFace::sendToAllFaces(const ndn::Data &data) {
+    sendToAllFaces(Face::getWireBuffer(data.wireEncode()));
+}
+
+void MemoryMasterFace::sendToAllFaces(const std::shared_ptr<const ndn::Buffer> &wire) {
+    std::lock_guard<std::mutex> guard(_faces_mutex);
+    for(const auto &face : _faces) {
+        face->send(wire);
+    }
+}
+
+std::string MemoryMasterFace::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"id":)" << _master_face_id << R"(, "protocol":"MEM", "port":)" << _port << R"(, "listening":)" << _is_listening << R"(, "faces":[)";
+    bool first = true;
+    std::lock_guard<std::mutex> guard(_faces_mutex);
+    for (const auto &face : _faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face->toJSON();
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+void MemoryMasterFace::writeMetrics(MetricsWriter &writer) const {
+    std::lock_guard<std::mutex> guard(_faces_mutex);
+    for (const auto &face : _faces) {
+        face->writeMetrics(writer);
+    }
+}
+
+void MemoryMasterFace::addMemoryStats(MemoryStats &stats) const {
+    std::lock_guard<std::mutex> guard(_faces_mutex);
+    for (const auto &face : _faces) {
+        face->addMemoryStats(stats);
+    }
+}
+
+void MemoryMasterFace::accept(const std::shared_ptr<MemoryFace> &face) {
+    std::unique_lock<std::mutex> lock(_faces_mutex);
+    if (!_is_listening || _faces.size() >= _max_connection) {
+        lock.unlock();
+        face->link(nullptr);
+        return;
+    }
+    logger::log(logger::INFO, "new connection from mem://{}", {_port});
+    auto peer = std::make_shared<MemoryFace>(_service_picker ? _service_picker() : _ios, _port, face);
+    _faces.emplace(peer);
+    lock.unlock();
+    _notification_callback(shared_from_this(), peer);
+    openFace(peer, boost::bind(&MemoryMasterFace::onFaceError, shared_from_this(), _1));
+    // only then can the connecting face send, the peer has its callbacks
+    face->link(peer);
+}
+
+void MemoryMasterFace::onFaceError(const std::shared_ptr<Face> &face) {
+    {
+        std::lock_guard<std::mutex> guard(_faces_mutex);
+        _faces.erase(face);
+    }
+    _error_callback(shared_from_this(), face);
+}
\ No newline at end of file
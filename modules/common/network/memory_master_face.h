@@ -0,0 +1,78 @@
+#pragma once
+
+#include "master_face.h"
+
+#include <boost/asio.hpp>
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "memory_face.h"
+
+// accepts the memory faces of the other modules of the process, see MemoryFace. the listening master faces are kept
+// by port in a registry of the process, where the connecting faces look them up
+class MemoryMasterFace : public MasterFace, public std::enable_shared_from_this<MemoryMasterFace> {
+public:
+    // the io_service an accepted face runs on, e.g. one per core
+    using ServicePicker = std::function<boost::asio::io_service&()>;
+
+private:
+    static std::mutex registry_mutex;
+    static std::unordered_map<uint16_t, std::weak_ptr<MemoryMasterFace>> registry;
+
+    uint16_t _port;
+    bool _is_listening = false;
+    ServicePicker _service_picker;
+    // the faces report their errors from their own io_service and are sent to from any thread
+    mutable std::mutex _faces_mutex;
+    std::unordered_set<std::shared_ptr<Face>> _faces;
+
+public:
+    MemoryMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port);
+
+    ~MemoryMasterFace() override = default;
+
+    // the master face listening on port in this process, null if there is none
+    static std::shared_ptr<MemoryMasterFace> find(uint16_t port);
+
+    std::string getUnderlyingProtocol() const override;
+
+    // before listen, the faces run on the io_service of the master face otherwise
+    void setServicePicker(const ServicePicker &service_picker);
+
+    // a port already listened on in the process only logs an error, the module keeps its other master faces
+    void listen(const NotificationCallback &notification_callback, const Face::InterestCallback &interest_callback,
+                const Face::DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+    using MasterFace::listen;
+
+    void close() override;
+
+    void stopAccepting() override;
+
+    size_t getQueuedPackets() const override;
+
+    void sendToAllFaces(const std::string &message) override;
+
+    void sendToAllFaces(const ndn::Interest &interest) override;
+
+    void sendToAllFaces(const ndn::Data &data) override;
+
+    void sendToAllFaces(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+    using MasterFace::sendToAllFaces;
+
+    std::string toJSON() const override;
+
+    void writeMetrics(MetricsWriter &writer) const override;
+
+    void addMemoryStats(MemoryStats &stats) const override;
+
+    // posted by the connecting MemoryFace on the io_service of the master face, not recommended to use it yourself
+    void accept(const std::shared_ptr<MemoryFace> &face);
+
+private:
+    void onFaceError(const std::shared_ptr<Face> &face);
+};
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// bounded lock-free queue, any thread can push, only one at a time can peek/pop (the face writer, on its strand)
+// each cell carries a sequence number telling if it is free for the producer of a lap or ready for the consumer
+template <typename T>
+class MpscQueue {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    const size_t _mask;
+    std::unique_ptr<Cell[]> _cells;
+
+    // producers and consumer positions are kept on different cache lines, padded rather than aligned
+    // so that faces holding a queue don't need an over-aligned allocation
+    std::atomic<size_t> _push_position;
+    char _padding[64 - sizeof(std::atomic<size_t>)];
+    size_t _pop_position = 0;
+
+public:
+    // capacity is rounded up to a power of 2
+    explicit MpscQueue(size_t capacity)
+            : _mask(roundUp(capacity) - 1)
+            , _cells(new Cell[_mask + 1])
+            , _push_position(0) {
+        for (size_t i = 0; i <= _mask; ++i) {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    ~MpscQueue() {
+        while (peek(0)) {
+            pop();
+        }
+    }
+
+    // return false if the queue is full
+    template <typename... Args>
+    bool emplace(Args&&... args) {
+        size_t position = _push_position.load(std::memory_order_relaxed);
+        Cell *cell;
+        for (;;) {
+            cell = &_cells[position & _mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+            if (diff == 0) {
+                if (_push_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = _push_position.load(std::memory_order_relaxed);
+            }
+        }
+        new (&cell->storage) T(std::forward<Args>(args)...);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only, the i-th element from the front or nullptr if it is not pushed yet
+    T* peek(size_t i) {
+        size_t position = _pop_position + i;
+        if (i > _mask) {
+            return nullptr;
+        }
+        Cell &cell = _cells[position & _mask];
+        if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(&cell.storage);
+    }
+
+    // consumer only, the front element must exist
+    void pop() {
+        Cell &cell = _cells[_pop_position & _mask];
+        reinterpret_cast<T*>(&cell.storage)->~T();
+        cell.sequence.store(_pop_position + _mask + 1, std::memory_order_release);
+        ++_pop_position;
+    }
+
+private:
+    static size_t roundUp(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+#include "name_view.h"
+
+// incremental hashing of Names: the hash of a prefix extends the hash of the prefix one component shorter, so the
+// hashes of all the prefixes of a Name come out of a single pass over its components. the same value is computed
+// from a NameView and from an ndn::Name, tables filled from decoded Names can be probed with received packets
+namespace name_hash {
+
+    // hash of the empty Name
+    const uint64_t SEED = 0xCBF29CE484222325ULL;
+
+    inline uint64_t mix(uint64_t hash, uint64_t word) {
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ULL;
+        return hash ^ (hash >> 29);
+    }
+
+    inline uint64_t extend(uint64_t hash, const NameComponentRef &component) {
+        hash = mix(hash, (static_cast<uint64_t>(component.type) << 32) | component.length);
+        size_t i = 0;
+        for (; i + 8 <= component.length; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, component.value + i, 8);
+            hash = mix(hash, word);
+        }
+        if (i < component.length) {
+            uint64_t word = 0;
+            std::memcpy(&word, component.value + i, component.length - i);
+            hash = mix(hash, word);
+        }
+        return hash;
+    }
+
+    inline NameComponentRef toRef(const ndn::Name::Component &component) {
+        return {component.type(), component.value(), component.value_size()};
+    }
+
+    // hash of the prefix of name made of its first length components, of the whole Name by default
+    inline uint64_t hash(const ndn::Name &name, size_t length = SIZE_MAX) {
+        uint64_t hash = SEED;
+        for (size_t i = 0; i < length && i < name.size(); ++i) {
+            hash = extend(hash, toRef(name.get(i)));
+        }
+        return hash;
+    }
+
+}
@@ -0,0 +1,82 @@
+#include "name_view.h"
+
+#include <ndn-cxx/encoding/tlv.hpp>
+
+#include "name_hash.h"
+#include "tlv_reader.h"
+
+using tlv_reader::readHeader;
+using tlv_reader::readNonNegativeInteger;
+
+NameView::NameView(const ndn::Block &block) : _wire(block.wire()) {
+    const uint8_t *it = _wire;
+    const uint8_t *end = _wire + block.size();
+
+    uint32_t packet_type;
+    size_t packet_length = readHeader(it, end, packet_type);
+    const uint8_t *packet_end = it + packet_length;
+    if (packet_type != ndn::tlv::Interest && packet_type != ndn::tlv::Data) {
+        throw ndn::tlv::Error("neither Interest nor Data");
+    }
+
+    // the Name is the first element of both Interest and Data
+    readName(it, packet_end);
+
+    uint32_t type;
+    if (packet_type == ndn::tlv::Interest && it == packet_end) {
+        // v0.3, a v0.2 Interest carries a Nonce
+        _can_be_prefix = false;
+    } else if (packet_type == ndn::tlv::Interest) {
+        const uint8_t *selectors = it;
+        size_t length = readHeader(selectors, packet_end, type);
+        if (type == ndn::tlv::Selectors) {
+            const uint8_t *selectors_end = selectors + length;
+            while (selectors != selectors_end) {
+                length = readHeader(selectors, selectors_end, type);
+                if (type == ndn::tlv::ChildSelector) {
+                    _child_selector = static_cast<int>(readNonNegativeInteger(selectors, length));
+                } else if (type == ndn::tlv::MaxSuffixComponents) {
+                    _can_be_prefix = readNonNegativeInteger(selectors, length) != 1;
+                }
+                selectors += length;
+            }
+        } else if (type == ndn::tlv::MustBeFresh || type == ndn::tlv::ForwardingHint) {
+            // only v0.3 puts them right after the Name, its CanBePrefix would come first
+            _can_be_prefix = false;
+        }
+    }
+}
+
+NameView::NameView(const uint8_t *name, size_t size) : _wire(name) {
+    const uint8_t *it = _wire;
+    readName(it, _wire + size);
+}
+
+void NameView::readName(const uint8_t *&it, const uint8_t *end) {
+    _name_begin = static_cast<uint32_t>(it - _wire);
+    uint32_t type;
+    size_t name_length = readHeader(it, end, type);
+    const uint8_t *name_end = it + name_length;
+    if (type != ndn::tlv::Name) {
+        throw ndn::tlv::Error("packet without Name");
+    }
+    _name_size = static_cast<uint32_t>(name_end - _wire) - _name_begin;
+
+    while (it != name_end) {
+        size_t length = readHeader(it, name_end, type);
+        _spans.push_back({type, static_cast<uint32_t>(it - _wire), static_cast<uint32_t>(length)});
+        it += length;
+    }
+}
+
+ndn::Name NameView::toName() const {
+    return ndn::Name(ndn::Block(_wire + _name_begin, _name_size));
+}
+
+void NameView::computePrefixHashes() const {
+    _prefix_hashes.resize(_spans.size() + 1);
+    _prefix_hashes[0] = name_hash::SEED;
+    for (size_t i = 0; i < _spans.size(); ++i) {
+        _prefix_hashes[i + 1] = name_hash::extend(_prefix_hashes[i], (*this)[i]);
+    }
+}
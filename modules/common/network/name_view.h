@@ -0,0 +1,149 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/encoding/block.hpp>
+
+#include <boost/container/small_vector.hpp>
+
+#include <cstring>
+
+// Name component pointing into the wire encoding it was read from, valid as long as that buffer is
+struct NameComponentRef {
+    uint32_t type;
+    const uint8_t *value;
+    size_t length;
+
+    // same canonical order as ndn::Name::Component::compare: type, then length, then value
+    static int compare(const ndn::Name::Component &component, const NameComponentRef &ref) {
+        if (component.type() != ref.type) {
+            return component.type() < ref.type ? -1 : 1;
+        }
+        if (component.value_size() != ref.length) {
+            return component.value_size() < ref.length ? -1 : 1;
+        }
+        return ref.length == 0 ? 0 : std::memcmp(component.value(), ref.value, ref.length);
+    }
+};
+
+// transparent ordering so maps keyed by ndn::Name::Component can be searched with a NameComponentRef
+struct NameComponentLess {
+    using is_transparent = void;
+
+    bool operator()(const ndn::Name::Component &lhs, const ndn::Name::Component &rhs) const {
+        return lhs < rhs;
+    }
+
+    bool operator()(const ndn::Name::Component &lhs, const NameComponentRef &rhs) const {
+        return NameComponentRef::compare(lhs, rhs) < 0;
+    }
+
+    bool operator()(const NameComponentRef &lhs, const ndn::Name::Component &rhs) const {
+        return NameComponentRef::compare(rhs, lhs) > 0;
+    }
+};
+
+// Name of an Interest or a Data read without decoding the packet, components are kept as (offset, length)
+// spans into the receive buffer, the Interest ChildSelector and CanBePrefix are read along since the content store
+// needs them
+class NameView {
+public:
+    static const size_t INLINE_COMPONENTS = 16;
+
+private:
+    struct Span {
+        uint32_t type;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    const uint8_t *_wire;
+    uint32_t _name_begin;
+    uint32_t _name_size;
+    boost::container::small_vector<Span, INLINE_COMPONENTS> _spans;
+    int _child_selector = 0;
+    bool _can_be_prefix = true;
+    // name_hash of every prefix, computed on first access, so one packet is hashed once whatever looks it up
+    mutable boost::container::small_vector<uint64_t, INLINE_COMPONENTS + 1> _prefix_hashes;
+
+public:
+    class const_iterator {
+    private:
+        const NameView *_view;
+        size_t _index;
+
+    public:
+        const_iterator(const NameView *view, size_t index) : _view(view), _index(index) {
+
+        }
+
+        NameComponentRef operator*() const {
+            return (*_view)[_index];
+        }
+
+        const_iterator& operator++() {
+            ++_index;
+            return *this;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return _index != other._index;
+        }
+    };
+
+    // walks the outer TLV and the Name TLV only, throws ndn::tlv::Error on malformed packets
+    explicit NameView(const ndn::Block &block);
+
+    // of a Name element alone, e.g. a delegation of a ForwardingHint, into a buffer which outlives the view
+    NameView(const uint8_t *name, size_t size);
+
+    ~NameView() = default;
+
+    size_t size() const {
+        return _spans.size();
+    }
+
+    NameComponentRef operator[](size_t i) const {
+        const auto &span = _spans[i];
+        return {span.type, _wire + span.offset, span.length};
+    }
+
+    const_iterator begin() const {
+        return {this, 0};
+    }
+
+    const_iterator end() const {
+        return {this, _spans.size()};
+    }
+
+    // 0 for leftmost, 1 for rightmost, always 0 for Data
+    int getChildSelector() const {
+        return _child_selector;
+    }
+
+    // as ndn::Interest decodes it: a v0.2 Interest is a prefix unless its MaxSuffixComponents is 1, a v0.3 one only
+    // with the element. always true for Data
+    bool getCanBePrefix() const {
+        return _can_be_prefix;
+    }
+
+    // name_hash of the prefix made of the first length components, length is at most size()
+    uint64_t getPrefixHash(size_t length) const {
+        if (_prefix_hashes.empty()) {
+            computePrefixHashes();
+        }
+        return _prefix_hashes[length];
+    }
+
+    uint64_t getHash() const {
+        return getPrefixHash(_spans.size());
+    }
+
+    // full decoding of the components, for paths which need an ndn::Name
+    ndn::Name toName() const;
+
+private:
+    // the Name element at it, which is left past it, and its components
+    void readName(const uint8_t *&it, const uint8_t *end);
+
+    void computePrefixHashes() const;
+};
@@ -0,0 +1,188 @@
+#include "ndn_packet.h"
+
+#include <cstring>
+
+#include "face.h"
+#include "tlv_reader.h"
+
+ndn::Name NdnPacket::copyName(const ndn::Name &name) {
+    const ndn::Block &block = name.wireEncode();
+    if (block.getBuffer()->size() == block.size()) {
+        return name;
+    }
+    return ndn::Name(ndn::Block(std::make_shared<ndn::Buffer>(block.wire(), block.size())));
+}
+
+const std::shared_ptr<const ndn::Buffer>& NdnPacket::getWire() const {
+    if (!_wire) {
+        _wire = Face::getWireBuffer(_block);
+    }
+    return _wire;
+}
+
+const ndn::Name& NdnPacket::getName() const {
+    if (!_name) {
+        if (_interest) {
+            _name = std::make_shared<const ndn::Name>(_interest->getName());
+        } else if (_data) {
+            _name = std::make_shared<const ndn::Name>(_data->getName());
+        } else {
+            // the Name is the first element of both Interest and Data, parsing only splits the top level elements
+            _block.parse();
+            auto it = _block.find(ndn::tlv::Name);
+            if (it == _block.elements_end()) {
+                throw ndn::tlv::Error("packet without Name");
+            }
+            _name = std::make_shared<const ndn::Name>(*it);
+        }
+    }
+    return *_name;
+}
+
+bool NdnPacket::isLocalScope() const {
+    static const char LOCALHOST[] = "localhost";
+    static const char LOCALHOP[] = "localhop";
+    const uint8_t *begin = _block.wire();
+    const uint8_t *end = begin + _block.size();
+    try {
+        uint32_t type;
+        tlv_reader::readHeader(begin, end, type);
+        if (tlv_reader::readHeader(begin, end, type) == 0 || type != ndn::tlv::Name) {
+            return false;
+        }
+        size_t length = tlv_reader::readHeader(begin, end, type);
+        if (type != ndn::tlv::NameComponent) {
+            return false;
+        }
+        return (length == sizeof(LOCALHOST) - 1 && std::memcmp(begin, LOCALHOST, length) == 0)
+               || (length == sizeof(LOCALHOP) - 1 && std::memcmp(begin, LOCALHOP, length) == 0);
+    } catch (const ndn::tlv::Error &) {
+        return false;
+    }
+}
+
+boost::optional<NameView> NdnPacket::getForwardingHint() const {
+    boost::optional<NameView> hint;
+    if (getType() != INTEREST) {
+        return hint;
+    }
+    const uint8_t *begin = _block.value();
+    const uint8_t *end = begin + _block.value_size();
+    try {
+        while (begin != end) {
+            uint32_t type;
+            size_t length = tlv_reader::readHeader(begin, end, type);
+            const uint8_t *value_end = begin + length;
+            if (type != ndn::tlv::ForwardingHint) {
+                begin = value_end;
+                continue;
+            }
+            uint64_t best_preference = 0;
+            while (begin != value_end) {
+                const uint8_t *element = begin;
+                length = tlv_reader::readHeader(begin, value_end, type);
+                const uint8_t *element_end = begin + length;
+                if (type == ndn::tlv::Name) {
+                    // the Names come in order of preference
+                    hint.emplace(element, element_end - element);
+                    break;
+                }
+                if (type == ndn::tlv::Delegation) {
+                    length = tlv_reader::readHeader(begin, element_end, type);
+                    if (type != ndn::tlv::LinkPreference) {
+                        throw ndn::tlv::Error("Delegation without Preference");
+                    }
+                    uint64_t preference = tlv_reader::readNonNegativeInteger(begin, length);
+                    begin += length;
+                    if (!hint || preference < best_preference) {
+                        hint.emplace(begin, element_end - begin);
+                        best_preference = preference;
+                    }
+                }
+                begin = element_end;
+            }
+            break;
+        }
+    } catch (const ndn::tlv::Error &) {
+        hint = boost::none;
+    }
+    return hint;
+}
+
+const ndn::Interest& NdnPacket::getInterest() const {
+    if (!_interest) {
+        _interest = std::make_shared<const ndn::Interest>(_block);
+    }
+    return *_interest;
+}
+
+const ndn::Data& NdnPacket::getData() const {
+    if (!_data) {
+        _data = std::make_shared<const ndn::Data>(_block);
+    }
+    return *_data;
+}
+
+
+ndn::time::milliseconds NdnPacket::getFreshnessPeriod() const {
+    if (_data) {
+        return _data->getFreshnessPeriod();
+    }
+    _block.parse();
+    auto meta_info = _block.find(ndn::tlv::MetaInfo);
+    if (meta_info == _block.elements_end()) {
+        return ndn::time::milliseconds::zero();
+    }
+    meta_info->parse();
+    auto freshness_period = meta_info->find(ndn::tlv::FreshnessPeriod);
+    if (freshness_period == meta_info->elements_end()) {
+        return ndn::time::milliseconds::zero();
+    }
+    return ndn::time::milliseconds(ndn::readNonNegativeInteger(*freshness_period));
+}
+
+const NdnPacket::SignatureView& NdnPacket::getSignatureView() const {
+    if (_signature_view) {
+        return *_signature_view;
+    }
+    SignatureView view;
+    const uint8_t *begin = _block.value();
+    const uint8_t *end = begin + _block.value_size();
+    view.signed_begin = begin;
+    bool has_info = false;
+    while (begin != end) {
+        uint32_t type;
+        size_t length = tlv_reader::readHeader(begin, end, type);
+        const uint8_t *value_end = begin + length;
+        if (type == ndn::tlv::SignatureInfo) {
+            has_info = true;
+            view.signed_size = value_end - view.signed_begin;
+            while (begin != value_end) {
+                uint32_t info_type;
+                size_t info_length = tlv_reader::readHeader(begin, value_end, info_type);
+                if (info_type == ndn::tlv::SignatureType) {
+                    view.type = static_cast<uint32_t>(tlv_reader::readNonNegativeInteger(begin, info_length));
+                } else if (info_type == ndn::tlv::KeyLocator && info_length > 0) {
+                    const uint8_t *name = begin;
+                    uint32_t name_type;
+                    size_t name_length = tlv_reader::readHeader(name, begin + info_length, name_type);
+                    if (name_type == ndn::tlv::Name) {
+                        view.key_name = begin;
+                        view.key_name_size = name + name_length - begin;
+                    }
+                }
+                begin += info_length;
+            }
+        } else if (type == ndn::tlv::SignatureValue) {
+            if (!has_info) {
+                break;
+            }
+            view.value = begin;
+            view.value_size = length;
+            _signature_view = view;
+            return *_signature_view;
+        }
+        begin = value_end;
+    }
+    throw ndn::tlv::Error("Data without SignatureInfo or SignatureValue");
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/interest.hpp>
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/encoding/buffer.hpp>
+#include <ndn-cxx/encoding/tlv.hpp>
+
+#include <boost/optional.hpp>
+
+#include <memory>
+
+#include "name_view.h"
+
+// undecoded packet given to modules which only forward, it shares the buffer the face received it in,
+// fields are decoded on first access only so forwarding it unchanged costs no decoding nor encoding
+class NdnPacket {
+public:
+    // the signature of a Data as spans into the packet buffer
+    struct SignatureView {
+        uint32_t type = 0;
+        // the whole Name element of the KeyLocator, null if there is no KeyLocator or it holds a KeyDigest
+        const uint8_t *key_name = nullptr;
+        size_t key_name_size = 0;
+        // from the Name to the SignatureInfo included, what the signature covers
+        const uint8_t *signed_begin = nullptr;
+        size_t signed_size = 0;
+        const uint8_t *value = nullptr;
+        size_t value_size = 0;
+    };
+
+private:
+    ndn::Block _block;
+
+    mutable boost::optional<NameView> _name_view;
+    mutable std::shared_ptr<const ndn::Name> _name;
+    mutable std::shared_ptr<const ndn::Interest> _interest;
+    mutable std::shared_ptr<const ndn::Data> _data;
+    // the buffer sent, shared by all the faces the packet goes to
+    mutable std::shared_ptr<const ndn::Buffer> _wire;
+    mutable boost::optional<SignatureView> _signature_view;
+    // in the buffer of _block, null if the packet came bare or in fragments
+    const uint8_t *_lp_packet = nullptr;
+    size_t _lp_packet_size = 0;
+
+public:
+    enum Type {
+        INTEREST,
+        DATA,
+        UNKNOWN,
+    };
+
+    explicit NdnPacket(const ndn::Block &block) : _block(block) {
+
+    }
+
+    NdnPacket(const NdnPacket&) = default;
+
+    // the spans of the views stay valid, they are into the buffer which is moved along with the Block
+    NdnPacket(NdnPacket&&) = default;
+
+    NdnPacket& operator=(const NdnPacket&) = default;
+
+    NdnPacket& operator=(NdnPacket&&) = default;
+
+    ~NdnPacket() = default;
+
+    Type getType() const {
+        switch (_block.type()) {
+            case ndn::tlv::Interest:
+                return INTEREST;
+            case ndn::tlv::Data:
+                return DATA;
+            default:
+                return UNKNOWN;
+        }
+    }
+
+    const ndn::Block& getBlock() const {
+        return _block;
+    }
+
+    // Name components as spans into the packet buffer, nothing is decoded nor copied
+    const NameView& getNameView() const {
+        if (!_name_view) {
+            _name_view.emplace(_block);
+        }
+        return *_name_view;
+    }
+
+    // the LpPacket which carried the packet whole, set by the face which received it. lp_packet shares its buffer
+    void setLpPacket(const ndn::Block &lp_packet) {
+        _lp_packet = lp_packet.wire();
+        _lp_packet_size = lp_packet.size();
+    }
+
+    // the LpPacket itself, e.g. to read a field of it with LpLink, null if the packet came bare or in fragments
+    const uint8_t* getLpPacket() const {
+        return _lp_packet;
+    }
+
+    size_t getLpPacketSize() const {
+        return _lp_packet_size;
+    }
+
+    // the packet alone in its buffer, which is never modified: the buffer it was received in if the packet fills
+    // it, else a copy made on first call only, so that a packet sent to several faces is copied once at most
+    const std::shared_ptr<const ndn::Buffer>& getWire() const;
+
+    // the delegation of the ForwardingHint of an Interest with the lowest preference, or its first Name as of NDN
+    // 0.3, as spans into the packet buffer. none without ForwardingHint, for a Data and if the hint is malformed.
+    // read again at each call, it isn't kept with the packet
+    boost::optional<NameView> getForwardingHint() const;
+
+    // only the Name element is decoded, the rest of the packet is left as is
+    const ndn::Name& getName() const;
+
+    // whether the first Name component is localhost or localhop, read in the wire with nothing decoded. a malformed
+    // packet is not local
+    bool isLocalScope() const;
+
+    // full decoding, the packet must be an Interest
+    const ndn::Interest& getInterest() const;
+
+    // full decoding, the packet must be a Data
+    const ndn::Data& getData() const;
+
+    // read in the MetaInfo without decoding the rest of the packet, 0 if it has none. the packet must be a Data
+    ndn::time::milliseconds getFreshnessPeriod() const;
+
+    // walked with tlv_reader without decoding the packet, throws ndn::tlv::Error if the Data has no SignatureInfo or
+    // SignatureValue. the packet must be a Data
+    const SignatureView& getSignatureView() const;
+
+    // the components of a Name decoded from a packet share the buffer it was received in, a read chunk of the face.
+    // the tables which keep a Name longer than the packet take this copy alone in an exact-size buffer
+    static ndn::Name copyName(const ndn::Name &name);
+};
@@ -0,0 +1,265 @@
+#include "packet_capture.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../log/logger.h"
+
+std::atomic<bool> PacketCapture::is_enabled{false};
+std::atomic<size_t> PacketCapture::writers{0};
+std::atomic<uint64_t> PacketCapture::position{0};
+std::mutex PacketCapture::files_mutex;
+std::vector<PacketCapture::File> PacketCapture::files;
+size_t PacketCapture::file_size = 0;
+uint64_t PacketCapture::sequence = 0;
+int64_t PacketCapture::start_time = 0;
+
+namespace {
+    const uint64_t OFFSET_MASK = (static_cast<uint64_t>(1) << 48) - 1;
+    const char *FILE_PREFIX = "capture-";
+    const char *FILE_SUFFIX = ".ndncap";
+
+    int64_t getEpochNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    bool hasSuffix(const std::string &name, const std::string &suffix) {
+        return name.size() >= suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+bool PacketCapture::start(const std::string &spec) {
+    std::string directory = spec;
+    size_t size = DEFAULT_FILE_SIZE;
+    size_t count = DEFAULT_FILES;
+    size_t colon = spec.find(':');
+    if (colon != std::string::npos) {
+        directory = spec.substr(0, colon);
+        char *end;
+        size = std::strtoull(spec.c_str() + colon + 1, &end, 10) << 20;
+        if (*end == ':') {
+            count = std::strtoull(end + 1, &end, 10);
+        }
+        if (*end != '\0') {
+            return false;
+        }
+    }
+    return start(directory, size, count);
+}
+
+bool PacketCapture::start(const std::string &directory, size_t new_file_size, size_t count) {
+    stop();
+    if (directory.empty() || new_file_size < MIN_FILE_SIZE || new_file_size > OFFSET_MASK || count < 2 || count > 0xFFFF) {
+        return false;
+    }
+    if (::mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) {
+        logger::log(logger::ERROR, "can't create the capture directory {} ({})", {directory, std::strerror(errno)});
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(files_mutex);
+    file_size = new_file_size;
+    for (size_t i = 0; i < count; ++i) {
+        std::string path = directory + "/" + FILE_PREFIX + std::to_string(i) + FILE_SUFFIX;
+        int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        void *address = MAP_FAILED;
+        if (fd >= 0 && ::ftruncate(fd, file_size) == 0) {
+            address = ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (address == MAP_FAILED) {
+            logger::log(logger::ERROR, "can't map the capture file {} ({})", {path, std::strerror(errno)});
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            unmap();
+            return false;
+        }
+        files.push_back({fd, static_cast<uint8_t*>(address)});
+    }
+
+    sequence = 0;
+    start_time = getEpochNanoseconds();
+    writeHeader(files[0]);
+    position = sizeof(FileHeader);
+    is_enabled = true;
+    logger::log(logger::INFO, "capturing the packets in {}, {} files of {} bytes", {directory, count, file_size});
+    return true;
+}
+
+void PacketCapture::stop() {
+    // a writer either sees the capture off or is counted before the files go away
+    is_enabled = false;
+    while (writers.load() != 0) {
+        std::this_thread::yield();
+    }
+    std::lock_guard<std::mutex> lock(files_mutex);
+    unmap();
+}
+
+void PacketCapture::unmap() {
+    for (const File &file : files) {
+        ::msync(file.address, file_size, MS_ASYNC);
+        ::munmap(file.address, file_size);
+        ::close(file.fd);
+    }
+    files.clear();
+}
+
+void PacketCapture::writeHeader(const File &file) {
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.sequence = sequence;
+    header.start_time = start_time;
+    std::memcpy(file.address, &header, sizeof(header));
+}
+
+uint8_t* PacketCapture::reserve(size_t size) {
+    uint64_t current = position.load(std::memory_order_acquire);
+    while (true) {
+        uint64_t offset = current & OFFSET_MASK;
+        if (offset + size <= file_size) {
+            if (position.compare_exchange_weak(current, current + size, std::memory_order_acq_rel)) {
+                return files[current >> 48].address + offset;
+            }
+        } else {
+            rotate(current);
+            current = position.load(std::memory_order_acquire);
+        }
+    }
+}
+
+void PacketCapture::rotate(uint64_t observed) {
+    std::lock_guard<std::mutex> lock(files_mutex);
+    size_t index = observed >> 48;
+    if (position.load(std::memory_order_acquire) >> 48 != index) {
+        return;
+    }
+    // the oldest file, the records of a write still in flight in it are lost: it was filled files.size() - 1 files
+    // ago. the truncation zeroes it, the mapping stays valid once it has its size again
+    index = (index + 1) % files.size();
+    const File &file = files[index];
+    if (::ftruncate(file.fd, 0) < 0 || ::ftruncate(file.fd, file_size) < 0) {
+        std::memset(file.address, 0, file_size);
+    }
+    ++sequence;
+    writeHeader(file);
+    position.store(static_cast<uint64_t>(index) << 48 | sizeof(FileHeader), std::memory_order_release);
+}
+
+void PacketCapture::onPacket(size_t face_id, Direction direction, const uint8_t *wire, size_t size) {
+    int64_t time = getEpochNanoseconds();
+    writers.fetch_add(1);
+    if (is_enabled.load()) {
+        uint8_t *record = reserve(recordSize(size));
+        RecordHeader header;
+        std::memset(&header, 0, sizeof(header));
+        header.face_id = static_cast<uint32_t>(face_id);
+        header.time = time;
+        header.direction = direction;
+        std::memcpy(record, &header, sizeof(header));
+        std::memcpy(record + sizeof(RecordHeader), wire, size);
+        // published last, a reader of a live capture stops at a record not written yet
+        __atomic_store_n(reinterpret_cast<uint32_t*>(record), static_cast<uint32_t>(size), __ATOMIC_RELEASE);
+    }
+    writers.fetch_sub(1, std::memory_order_release);
+}
+
+CaptureReader::CaptureReader(const std::string &directory) {
+    DIR *dir = ::opendir(directory.c_str());
+    if (dir == nullptr) {
+        throw std::runtime_error("can't open " + directory + ": " + std::strerror(errno));
+    }
+    std::vector<std::pair<int64_t, File>> found;
+    while (dirent *entry = ::readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.compare(0, std::strlen(FILE_PREFIX), FILE_PREFIX) != 0 || !hasSuffix(name, FILE_SUFFIX)) {
+            continue;
+        }
+        int fd = ::open((directory + "/" + name).c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat status;
+        if (fd < 0 || ::fstat(fd, &status) < 0 || static_cast<size_t>(status.st_size) < sizeof(PacketCapture::FileHeader)) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            continue;
+        }
+        void *address = ::mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            continue;
+        }
+        PacketCapture::FileHeader header;
+        std::memcpy(&header, address, sizeof(header));
+        if (header.magic != PacketCapture::MAGIC || header.version != PacketCapture::VERSION) {
+            ::munmap(address, status.st_size);
+            continue;
+        }
+        found.emplace_back(header.start_time, File{static_cast<const uint8_t*>(address), static_cast<size_t>(status.st_size), header.sequence});
+    }
+    ::closedir(dir);
+
+    int64_t last_start = 0;
+    for (const auto &file : found) {
+        last_start = std::max(last_start, file.first);
+    }
+    for (const auto &file : found) {
+        if (file.first == last_start) {
+            _files.push_back(file.second);
+        } else {
+            ::munmap(const_cast<uint8_t*>(file.second.address), file.second.size);
+        }
+    }
+    if (_files.empty()) {
+        throw std::runtime_error("no capture in " + directory);
+    }
+    std::sort(_files.begin(), _files.end(), [](const File &a, const File &b) {
+        return a.sequence < b.sequence;
+    });
+}
+
+CaptureReader::~CaptureReader() {
+    for (const File &file : _files) {
+        ::munmap(const_cast<uint8_t*>(file.address), file.size);
+    }
+}
+
+bool CaptureReader::next(Record &record) {
+    while (_file < _files.size()) {
+        const File &file = _files[_file];
+        if (_offset + sizeof(PacketCapture::RecordHeader) <= file.size) {
+            const uint8_t *at = file.address + _offset;
+            uint32_t size = __atomic_load_n(reinterpret_cast<const uint32_t*>(at), __ATOMIC_ACQUIRE);
+            if (size != 0 && _offset + sizeof(PacketCapture::RecordHeader) + size <= file.size) {
+                PacketCapture::RecordHeader header;
+                std::memcpy(&header, at, sizeof(header));
+                record.time = header.time;
+                record.face_id = header.face_id;
+                record.direction = static_cast<PacketCapture::Direction>(header.direction);
+                record.wire = at + sizeof(PacketCapture::RecordHeader);
+                record.size = size;
+                _offset += (sizeof(PacketCapture::RecordHeader) + size + 7) & ~static_cast<size_t>(7);
+                return true;
+            }
+        }
+        ++_file;
+        _offset = sizeof(PacketCapture::FileHeader);
+    }
+    return false;
+}
+
+void CaptureReader::rewind() {
+    _file = 0;
+    _offset = sizeof(PacketCapture::FileHeader);
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// capture of the packets the faces receive and send, for a replay of the traffic of a module against another build
+// of it. the packets are appended as they are on the wire to a ring of files mapped in memory, the oldest file is
+// overwritten once they are all full, so a capture left on keeps the last files * file_size bytes of traffic.
+// a packet costs a few atomic operations and a copy while capturing, and a relaxed load otherwise
+//
+// a file is a header then records, each of them a header then the wire padded to 8 bytes. the size of a record is
+// written last, a file ends at its first record of size 0
+class PacketCapture {
+public:
+    static const uint32_t MAGIC = 0x4e444e43; // "NDNC"
+    static const uint32_t VERSION = 1;
+    static const size_t DEFAULT_FILE_SIZE = 64 << 20; // 64M
+    static const size_t DEFAULT_FILES = 8;
+    // larger than any packet
+    static const size_t MIN_FILE_SIZE = 1 << 20;
+
+    enum Direction : uint8_t {
+        IN = 0,
+        OUT = 1,
+    };
+
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        // of the file in the capture, the replay reads them in that order
+        uint64_t sequence;
+        // nanoseconds since the epoch at the start of the capture, the files of an older one are ignored
+        int64_t start_time;
+        uint8_t reserved[40];
+    };
+
+    struct RecordHeader {
+        uint32_t size;
+        uint32_t face_id;
+        // nanoseconds since the epoch
+        int64_t time;
+        uint8_t direction;
+        uint8_t reserved[7];
+    };
+
+private:
+    struct File {
+        int fd;
+        uint8_t *address;
+    };
+
+    // false while the capture is off
+    static std::atomic<bool> is_enabled;
+    // in onPacket, stop() waits for them before unmapping the files
+    static std::atomic<size_t> writers;
+    // the file written in the top 16 bits, the offset of the next record in it below
+    static std::atomic<uint64_t> position;
+    static std::mutex files_mutex;
+    static std::vector<File> files;
+    static size_t file_size;
+    static uint64_t sequence;
+    static int64_t start_time;
+
+    static size_t recordSize(size_t size) {
+        return (sizeof(RecordHeader) + size + 7) & ~static_cast<size_t>(7);
+    }
+
+    // room for a record of that size, in the next file if the current one is full
+    static uint8_t* reserve(size_t size);
+
+    // the next file is emptied and becomes the current one, unless another thread did it since observed
+    static void rotate(uint64_t observed);
+
+    static void writeHeader(const File &file);
+
+    static void unmap();
+
+public:
+    // "directory[:file_mb[:files]]", the directory is created if needed. false and no capture if the files can't be
+    // mapped. from any thread, a capture already running is stopped first
+    static bool start(const std::string &spec);
+
+    static bool start(const std::string &directory, size_t file_size, size_t files);
+
+    // the files are flushed and kept as they are for the replay
+    static void stop();
+
+    // checked by the faces before anything else
+    static bool isEnabled() {
+        return is_enabled.load(std::memory_order_relaxed);
+    }
+
+    static void onPacket(size_t face_id, Direction direction, const uint8_t *wire, size_t size);
+};
+
+// the records of the last capture written in a directory, read in the order they were written. the timestamps of
+// the records of different threads may be slightly out of order
+class CaptureReader {
+public:
+    struct Record {
+        int64_t time;
+        uint32_t face_id;
+        PacketCapture::Direction direction;
+        const uint8_t *wire;
+        size_t size;
+    };
+
+private:
+    struct File {
+        const uint8_t *address;
+        size_t size;
+        uint64_t sequence;
+    };
+
+    std::vector<File> _files;
+    size_t _file = 0;
+    size_t _offset = sizeof(PacketCapture::FileHeader);
+
+public:
+    // throws std::runtime_error if the directory holds no capture
+    explicit CaptureReader(const std::string &directory);
+
+    CaptureReader(const CaptureReader&) = delete;
+
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    ~CaptureReader();
+
+    // false at the end of the capture, the wire is valid as long as the reader
+    bool next(Record &record);
+
+    // back to the first record
+    void rewind();
+};
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "ndn_packet.h"
+
+class Face;
+
+// the packet callback of a face bound at compile time to a member function of the module: an object and the address
+// of a function made for that member, which the compiler inlines into it. a Face::PacketCallback wrapping a
+// boost::bind goes through the std::function, then the bind object and the member pointer, for each packet
+//
+// e.g. face->open(PacketHandler::bind<Router, &Router::onPacket>(this), error_callback). nothing is owned, the
+// object must outlive the face as with the binds of this
+//
+// a member taking an NdnPacket&& is given the packet the face made for the read, which it may keep, e.g. in the
+// inbox of a shard or while its signature is checked, with its buffer and the views already decoded moved along
+class PacketHandler {
+private:
+    // packet is only moved from by the members taking an NdnPacket&&
+    using Call = void (*)(void *object, const std::shared_ptr<Face> &face, NdnPacket &packet);
+
+    void *_object = nullptr;
+    Call _call = nullptr;
+    bool _takes_packet = false;
+
+    PacketHandler(void *object, Call call, bool takes_packet) : _object(object), _call(call), _takes_packet(takes_packet) {
+
+    }
+
+    template <class T, void (T::*Method)(const std::shared_ptr<Face>&, const NdnPacket&)>
+    static void callWithFace(void *object, const std::shared_ptr<Face> &face, NdnPacket &packet) {
+        (static_cast<T*>(object)->*Method)(face, packet);
+    }
+
+    template <class T, void (T::*Method)(const std::shared_ptr<Face>&, NdnPacket&&)>
+    static void callTakingPacket(void *object, const std::shared_ptr<Face> &face, NdnPacket &packet) {
+        (static_cast<T*>(object)->*Method)(face, std::move(packet));
+    }
+
+    template <class T, void (T::*Method)(const NdnPacket&)>
+    static void callWithoutFace(void *object, const std::shared_ptr<Face> &face, NdnPacket &packet) {
+        (static_cast<T*>(object)->*Method)(packet);
+    }
+
+public:
+    // none, a face opened with it falls back to its other callbacks
+    PacketHandler() = default;
+
+    template <class T, void (T::*Method)(const std::shared_ptr<Face>&, const NdnPacket&)>
+    static PacketHandler bind(T *object) {
+        return PacketHandler(object, &callWithFace<T, Method>, false);
+    }
+
+    template <class T, void (T::*Method)(const std::shared_ptr<Face>&, NdnPacket&&)>
+    static PacketHandler bind(T *object) {
+        return PacketHandler(object, &callTakingPacket<T, Method>, true);
+    }
+
+    // for the handlers which don't need the face, e.g. those of the egress faces
+    template <class T, void (T::*Method)(const NdnPacket&)>
+    static PacketHandler bind(T *object) {
+        return PacketHandler(object, &callWithoutFace<T, Method>, false);
+    }
+
+    explicit operator bool() const {
+        return _call != nullptr;
+    }
+
+    // packet is left empty if the member takes it
+    void operator()(const std::shared_ptr<Face> &face, NdnPacket &&packet) const {
+        _call(_object, face, packet);
+    }
+
+    // a member taking the packet is given a copy, the others the packet itself, which they only read
+    void operator()(const std::shared_ptr<Face> &face, const NdnPacket &packet) const {
+        if (_takes_packet) {
+            NdnPacket copy(packet);
+            _call(_object, face, copy);
+        } else {
+            _call(_object, face, const_cast<NdnPacket&>(packet));
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "page_arena.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <sstream>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "../log/logger.h"
+#include "../metrics/metrics.h"
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+// mempolicy.h isn't always installed, MPOL_PREFERRED falls back to the other nodes when the preferred one is full
+#define NDNMS_MPOL_PREFERRED 1
+
+const size_t PageArena::HUGE_PAGE_SIZE;
+const size_t PageArena::GIGANTIC_PAGE_SIZE;
+const size_t PageArena::MAX_REGION_SIZE;
+
+std::atomic<PageArena::Pages> PageArena::_pages(PageArena::Pages::NONE);
+std::atomic<bool> PageArena::_is_local(false);
+
+namespace {
+    std::atomic<size_t> normal_bytes(0);
+    std::atomic<size_t> transparent_bytes(0);
+    std::atomic<size_t> huge_bytes(0);
+    std::atomic<size_t> gigantic_bytes(0);
+    std::atomic<size_t> local_bytes(0);
+    // the fallback is logged once, every region would fail the same way
+    std::atomic<bool> has_warned(false);
+
+    void* mapHuge(size_t size, unsigned int shift) {
+        void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (shift << MAP_HUGE_SHIFT), -1, 0);
+        if (address == MAP_FAILED && !has_warned.exchange(true)) {
+            logger::log(logger::WARNING, "no {} huge pages ({}), the tables fall back to smaller pages",
+                        {shift == 30 ? "1G" : "2M", std::strerror(errno)});
+        }
+        return address;
+    }
+
+    std::atomic<size_t>& bytesOf(PageArena::Pages pages) {
+        switch (pages) {
+            case PageArena::Pages::TRANSPARENT:
+                return transparent_bytes;
+            case PageArena::Pages::HUGE_2M:
+                return huge_bytes;
+            case PageArena::Pages::HUGE_1G:
+                return gigantic_bytes;
+            default:
+                return normal_bytes;
+        }
+    }
+
+    // to the node of the calling thread, before the first access faults the pages in
+    bool bindLocal(void *address, size_t size) {
+#if defined(__NR_mbind) && defined(__NR_getcpu)
+        unsigned int cpu = 0;
+        unsigned int node = 0;
+        if (::syscall(__NR_getcpu, &cpu, &node, nullptr) < 0 || node >= 64) {
+            return false;
+        }
+        unsigned long mask = 1UL << node;
+        return ::syscall(__NR_mbind, address, size, NDNMS_MPOL_PREFERRED, &mask, 64 + 1, 0) == 0;
+#else
+        return false;
+#endif
+    }
+}
+
+std::string PageArenaStats::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"normal_bytes":)" << normal_bytes << R"(, "transparent_bytes":)" << transparent_bytes
+       << R"(, "huge_bytes":)" << huge_bytes << R"(, "gigantic_bytes":)" << gigantic_bytes
+       << R"(, "local_bytes":)" << local_bytes << "}";
+    return ss.str();
+}
+
+void PageArenaStats::writeMetrics(MetricsWriter &writer) const {
+    const char *help = "bytes mapped for the tables, by kind of page";
+    writer.gauge("ndn_page_arena_bytes", help, {{"pages", "normal"}}, normal_bytes);
+    writer.gauge("ndn_page_arena_bytes", help, {{"pages", "transparent"}}, transparent_bytes);
+    writer.gauge("ndn_page_arena_bytes", help, {{"pages", "2M"}}, huge_bytes);
+    writer.gauge("ndn_page_arena_bytes", help, {{"pages", "1G"}}, gigantic_bytes);
+    writer.gauge("ndn_page_arena_local_bytes", "bytes of the tables bound to the NUMA node of their thread", {}, local_bytes);
+}
+
+PageArena::~PageArena() {
+    for (const Region &region : _regions) {
+        ::munmap(region.address, region.size);
+        bytesOf(region.pages) -= region.size;
+        if (region.is_local) {
+            local_bytes -= region.size;
+        }
+    }
+}
+
+void PageArena::map(size_t size) {
+    size_t region_size = _next_size;
+    while (region_size < size) {
+        region_size *= 2;
+    }
+    if (_next_size < MAX_REGION_SIZE) {
+        _next_size *= 2;
+    }
+
+    Pages selected = _pages.load(std::memory_order_relaxed);
+    Pages pages = Pages::NONE;
+    void *address = MAP_FAILED;
+    if (selected == Pages::HUGE_1G && region_size % GIGANTIC_PAGE_SIZE == 0) {
+        address = mapHuge(region_size, 30);
+        pages = Pages::HUGE_1G;
+    }
+    if (address == MAP_FAILED && selected >= Pages::HUGE_2M) {
+        address = mapHuge(region_size, 21);
+        pages = Pages::HUGE_2M;
+    }
+    if (address == MAP_FAILED) {
+        address = ::mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        pages = Pages::NONE;
+#ifdef MADV_HUGEPAGE
+        if (selected != Pages::NONE && ::madvise(address, region_size, MADV_HUGEPAGE) == 0) {
+            pages = Pages::TRANSPARENT;
+        }
+#endif
+    }
+    bool is_local = _is_local.load(std::memory_order_relaxed) && bindLocal(address, region_size);
+
+    bytesOf(pages) += region_size;
+    if (is_local) {
+        local_bytes += region_size;
+    }
+    _regions.push_back({static_cast<uint8_t*>(address), region_size, pages, is_local});
+    _used = 0;
+}
+
+void* PageArena::allocate(size_t size, size_t alignment) {
+    size_t offset = (_used + alignment - 1) & ~(alignment - 1);
+    if (_regions.empty() || offset + size > _regions.back().size) {
+        map(size);
+        offset = 0;
+    }
+    _used = offset + size;
+    return _regions.back().address + offset;
+}
+
+size_t PageArena::capacity() const {
+    size_t bytes = 0;
+    for (const Region &region : _regions) {
+        bytes += region.size;
+    }
+    return bytes;
+}
+
+bool PageArena::enable(const std::string &text) {
+    std::string pages = text;
+    bool is_local = false;
+    size_t colon = text.find(':');
+    if (colon != std::string::npos) {
+        if (text.substr(colon + 1) != "local") {
+            return false;
+        }
+        pages = text.substr(0, colon);
+        is_local = true;
+    }
+
+    if (pages == "thp") {
+        _pages = Pages::TRANSPARENT;
+    } else if (pages == "2M") {
+        _pages = Pages::HUGE_2M;
+    } else if (pages == "1G") {
+        _pages = Pages::HUGE_1G;
+    } else {
+        return false;
+    }
+    _is_local = is_local;
+    return true;
+}
+
+bool PageArena::isEnabled() {
+    return _pages.load(std::memory_order_relaxed) != Pages::NONE;
+}
+
+PageArenaStats PageArena::getStats() {
+    PageArenaStats stats;
+    stats.normal_bytes = normal_bytes;
+    stats.transparent_bytes = transparent_bytes;
+    stats.huge_bytes = huge_bytes;
+    stats.gigantic_bytes = gigantic_bytes;
+    stats.local_bytes = local_bytes;
+    return stats;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MetricsWriter;
+
+struct PageArenaStats {
+    // bytes mapped by the arenas, on each kind of page
+    size_t normal_bytes = 0;
+    size_t transparent_bytes = 0;
+    size_t huge_bytes = 0;
+    size_t gigantic_bytes = 0;
+    // bytes bound to the NUMA node of the thread which mapped them
+    size_t local_bytes = 0;
+
+    std::string toJSON() const;
+
+    void writeMetrics(MetricsWriter &writer) const;
+};
+
+// memory of the large tables, e.g. the nodes of a NamedTree, in regions mapped apart from the heap. with -H the
+// regions are backed by huge pages, so that a lookup walking through millions of nodes misses the TLB less, and may be
+// bound to the NUMA node of the thread which maps them, which is the one serving the table for the sharded modules.
+// blocks are carved out of the last region and only given back with the whole arena
+//
+// regions double from HUGE_PAGE_SIZE, a small table doesn't hold a 1 GB page, and fall back to smaller pages when
+// the kernel has none reserved
+class PageArena {
+public:
+    enum class Pages {
+        NONE,
+        // 4 KB pages the kernel may collapse into 2 MB ones (madvise), nothing to reserve
+        TRANSPARENT,
+        // MAP_HUGETLB, from vm.nr_hugepages or the 1 GB pool reserved at boot
+        HUGE_2M,
+        HUGE_1G,
+    };
+
+    static const size_t HUGE_PAGE_SIZE = 2 << 20;
+    static const size_t GIGANTIC_PAGE_SIZE = 1 << 30;
+    // a huge page region is reserved as a whole when it is mapped, the growth stops at one gigantic page
+    static const size_t MAX_REGION_SIZE = GIGANTIC_PAGE_SIZE;
+
+private:
+    struct Region {
+        uint8_t *address;
+        size_t size;
+        // what it was mapped with, NONE for regular pages
+        Pages pages;
+        bool is_local;
+    };
+
+    std::vector<Region> _regions;
+    // in the last region
+    size_t _used = 0;
+    size_t _next_size = HUGE_PAGE_SIZE;
+
+    static std::atomic<Pages> _pages;
+    static std::atomic<bool> _is_local;
+
+    void map(size_t size);
+
+public:
+    PageArena() = default;
+
+    PageArena(const PageArena&) = delete;
+
+    PageArena& operator=(const PageArena&) = delete;
+
+    ~PageArena();
+
+    // the block is zeroed, throws std::bad_alloc when nothing can be mapped
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // bytes mapped by this arena
+    size_t capacity() const;
+
+    // "thp", "2M" or "1G", followed by ":local" to bind the regions to the NUMA node of their thread. the tables
+    // created afterwards use the arenas, false if text is invalid
+    static bool enable(const std::string &text);
+
+    // set, the tables allocate their large blocks from PageArena rather than from the heap
+    static bool isEnabled();
+
+    // sum over all the arenas
+    static PageArenaStats getStats();
+};
\ No newline at end of file
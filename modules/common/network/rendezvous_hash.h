@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "name_hash.h"
+
+// highest random weight hashing (Thaler and Ravishankar) of Names onto the members of a cluster, e.g. the clones of a
+// content store: a Name goes to the member whose key weighs the most with its name_hash. every module knowing the
+// same members picks the same one, and a member joining or leaving only moves the Names it takes or held
+namespace rendezvous_hash {
+
+    // of the key of a member, e.g. the endpoint its clones and routers reach it at
+    inline uint64_t hashKey(const std::string &key) {
+        return name_hash::extend(name_hash::SEED, {0, reinterpret_cast<const uint8_t*>(key.data()), key.size()});
+    }
+
+    inline uint64_t weight(uint64_t name_hash, uint64_t key_hash) {
+        return name_hash::mix(name_hash::mix(key_hash, name_hash), key_hash);
+    }
+
+    // index of the member taking name_hash among the key hashes, SIZE_MAX if there is none
+    inline size_t select(uint64_t name_hash, const std::vector<uint64_t> &key_hashes) {
+        size_t selected = SIZE_MAX;
+        uint64_t max_weight = 0;
+        for (size_t i = 0; i < key_hashes.size(); ++i) {
+            uint64_t w = weight(name_hash, key_hashes[i]);
+            if (selected == SIZE_MAX || w > max_weight) {
+                selected = i;
+                max_weight = w;
+            }
+        }
+        return selected;
+    }
+
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "return_table.h"
+
+#include <sstream>
+
+#include "../metrics/metrics.h"
+
+const ndn::time::milliseconds ReturnTable::DEFAULT_TTL {4000};
+
+namespace {
+    size_t roundUp(size_t size) {
+        size_t capacity = 1;
+        while (capacity < size) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+}
+
+ReturnTable::ReturnTable(size_t size, const ndn::time::milliseconds &ttl)
+        : _mask(roundUp(size) - 1)
+        , _slots(new Slot[_mask + 1]())
+        , _ttl(ndn::time::duration_cast<ndn::time::nanoseconds>(ttl).count()) {
+
+}
+
+uint64_t ReturnTable::pack(const FaceTable::Ref &ref) {
+    return static_cast<uint64_t>(ref.slot) << 32 | ref.generation;
+}
+
+FaceTable::Ref ReturnTable::unpack(uint64_t packed) {
+    return {static_cast<uint32_t>(packed >> 32), static_cast<uint32_t>(packed)};
+}
+
+int64_t ReturnTable::toNanoseconds(const Clock::time_point &time) {
+    return ndn::time::duration_cast<ndn::time::nanoseconds>(time.time_since_epoch()).count();
+}
+
+ReturnTable::Slot& ReturnTable::getSlot(uint64_t name_hash) const {
+    return _slots[name_hash & _mask];
+}
+
+ndn::time::milliseconds ReturnTable::getTtl() const {
+    return ndn::time::duration_cast<ndn::time::milliseconds>(ndn::time::nanoseconds(_ttl.load(std::memory_order_relaxed)));
+}
+
+void ReturnTable::setTtl(const ndn::time::milliseconds &ttl) {
+    _ttl.store(ndn::time::duration_cast<ndn::time::nanoseconds>(ttl).count(), std::memory_order_relaxed);
+}
+
+void ReturnTable::insert(const NameView &name, const std::shared_ptr<Face> &face, const Clock::time_point &now) {
+    uint64_t name_hash = name.getHash();
+    uint64_t packed = pack(FaceTable::global().getRef(face));
+    int64_t time = toNanoseconds(now);
+    Slot &slot = getSlot(name_hash);
+    uint32_t version;
+    do {
+        version = slot.version.load(std::memory_order_relaxed);
+    } while ((version & 1) != 0 || !slot.version.compare_exchange_weak(version, version + 1, std::memory_order_acquire));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    uint32_t count = slot.count.load(std::memory_order_relaxed);
+    bool is_live = count > 0 && slot.expiry.load(std::memory_order_relaxed) > time;
+    if (!is_live) {
+        slot.is_collided.store(0, std::memory_order_relaxed);
+        count = 0;
+    } else if (slot.name_hash.load(std::memory_order_relaxed) != name_hash) {
+        // the faces of the former Name can't be told apart from those of the new one, its Data will be a miss
+        slot.is_collided.store(1, std::memory_order_relaxed);
+        count = 0;
+    }
+    slot.name_hash.store(name_hash, std::memory_order_relaxed);
+    if (count <= WAYS) {
+        bool is_known = false;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (slot.faces[i].load(std::memory_order_relaxed) == packed) {
+                is_known = true;
+                break;
+            }
+        }
+        if (!is_known) {
+            if (count < WAYS) {
+                slot.faces[count].store(packed, std::memory_order_relaxed);
+            }
+            ++count;
+        }
+    }
+    slot.count.store(count, std::memory_order_relaxed);
+    slot.expiry.store(time + _ttl.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    slot.version.store(version + 2, std::memory_order_release);
+}
+
+bool ReturnTable::lookup(const NameView &name, FaceTable::Faces &faces, const Clock::time_point &now) {
+    int64_t time = toNanoseconds(now);
+    FaceTable::Refs refs;
+    bool is_found = false;
+    for (size_t length = name.size() + 1; length-- > 0;) {
+        uint64_t name_hash = name.getPrefixHash(length);
+        const Slot &slot = getSlot(name_hash);
+        uint32_t version = slot.version.load(std::memory_order_acquire);
+        if ((version & 1) != 0) {
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        uint32_t count = slot.count.load(std::memory_order_relaxed);
+        bool is_collided = slot.is_collided.load(std::memory_order_relaxed) != 0;
+        uint64_t slot_hash = slot.name_hash.load(std::memory_order_relaxed);
+        int64_t expiry = slot.expiry.load(std::memory_order_relaxed);
+        uint64_t packed[WAYS];
+        for (uint32_t i = 0; i < count && i < WAYS; ++i) {
+            packed[i] = slot.faces[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) != version) {
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (count == 0 || expiry <= time) {
+            continue;
+        }
+        if (slot_hash != name_hash) {
+            if (is_collided) {
+                _misses.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            continue;
+        }
+        if (count > WAYS) {
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            FaceTable::add(refs, unpack(packed[i]));
+        }
+        is_found = true;
+    }
+    if (!is_found) {
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    FaceTable::global().resolve(refs, faces);
+    _hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+size_t ReturnTable::size() const {
+    return _mask + 1;
+}
+
+size_t ReturnTable::getMemoryUsage() const {
+    return size() * sizeof(Slot);
+}
+
+std::string ReturnTable::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"size":)" << _mask + 1 << R"(, "ttl":)" << getTtl().count() << R"(, "hits":)" << _hits.load(std::memory_order_relaxed)
+       << R"(, "misses":)" << _misses.load(std::memory_order_relaxed) << "}";
+    return ss.str();
+}
+
+void ReturnTable::writeMetrics(MetricsWriter &writer) const {
+    writer.counter("ndn_return_lookups_total", "lookups of the Data in the return table", {{"result", "hit"}}, _hits.load(std::memory_order_relaxed));
+    writer.counter("ndn_return_lookups_total", "lookups of the Data in the return table", {{"result", "miss"}}, _misses.load(std::memory_order_relaxed));
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "face_table.h"
+#include "name_view.h"
+
+class Face;
+class MetricsWriter;
+
+// who asked for a Name: the ingress faces which sent an Interest for it in the last ttl, by name_hash, so that a router
+// sends the Data back to these faces only rather than to all of them. a Data is looked up by each prefix of its Name,
+// for the CanBePrefix Interests, and a miss means a broadcast as before: a slot being written, a slot holding more
+// faces than it fits or taken over from another Name while live can't tell who asked and is a miss. an entry expires
+// after ttl, which must be no shorter than the InterestLifetime of the consumers. lookups never wait, the writers of a
+// slot hold it for a few stores and bump its version, which is what lookups check as a seqlock
+class ReturnTable {
+public:
+    static const size_t DEFAULT_SIZE = 65536;
+    // faces kept by slot, more Interests for the same Name from distinct faces are rare
+    static const size_t WAYS = 4;
+    // the default InterestLifetime
+    static const ndn::time::milliseconds DEFAULT_TTL;
+
+    using Clock = ndn::time::steady_clock;
+
+private:
+    // 64 bytes
+    struct Slot {
+        // odd while written
+        std::atomic<uint32_t> version;
+        // WAYS + 1 once more faces asked than fit
+        std::atomic<uint32_t> count;
+        // another Name had the slot while live, its faces are lost
+        std::atomic<uint32_t> is_collided;
+        std::atomic<uint64_t> name_hash;
+        // in nanoseconds of Clock
+        std::atomic<int64_t> expiry;
+        // FaceTable::Ref of each face, packed
+        std::atomic<uint64_t> faces[WAYS];
+    };
+
+    const size_t _mask;
+    std::unique_ptr<Slot[]> _slots;
+    std::atomic<int64_t> _ttl;
+    std::atomic<size_t> _hits{0};
+    std::atomic<size_t> _misses{0};
+
+    static uint64_t pack(const FaceTable::Ref &ref);
+
+    static FaceTable::Ref unpack(uint64_t packed);
+
+    static int64_t toNanoseconds(const Clock::time_point &time);
+
+    Slot& getSlot(uint64_t name_hash) const;
+
+public:
+    // size is rounded up to a power of 2
+    explicit ReturnTable(size_t size = DEFAULT_SIZE, const ndn::time::milliseconds &ttl = DEFAULT_TTL);
+
+    ReturnTable(const ReturnTable&) = delete;
+
+    ReturnTable& operator=(const ReturnTable&) = delete;
+
+    ndn::time::milliseconds getTtl() const;
+
+    void setTtl(const ndn::time::milliseconds &ttl);
+
+    // from any thread, for each Interest received
+    void insert(const NameView &name, const std::shared_ptr<Face> &face, const Clock::time_point &now = Clock::now());
+
+    // from any thread, the faces still alive which asked for the Data are appended to faces. false on a miss, the
+    // Data must then go to all faces
+    bool lookup(const NameView &name, FaceTable::Faces &faces, const Clock::time_point &now = Clock::now());
+
+    // slots, whether live or not
+    size_t size() const;
+
+    size_t getMemoryUsage() const;
+
+    // {"size", "ttl", "hits", "misses"}
+    std::string toJSON() const;
+
+    void writeMetrics(MetricsWriter &writer) const;
+};
\ No newline at end of file
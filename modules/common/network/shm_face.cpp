@@ -0,0 +1,368 @@
+#include "shm_face.h"
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../log/logger.h"
+#include "../metrics/stage_profile.h"
+
+ShmFace::ShmFace(boost::asio::io_service &ios, const std::string &host, uint16_t port)
+        : Face(ios)
+        , _skip_connect(false)
+        , _port(port)
+        , _socket(ios)
+        , _strand(ios)
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _is_stopping(false)
+        , _timer(ios) {
+}
+
+ShmFace::ShmFace(boost::asio::local::stream_protocol::socket &&socket, uint16_t port)
+        : Face(socket.get_io_service())
+        , _skip_connect(true)
+        , _port(port)
+        , _socket(std::move(socket))
+        , _strand(socket.get_io_service())
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _is_stopping(false)
+        , _timer(socket.get_io_service()) {
+
+}
+
+ShmFace::~ShmFace() {
+    stopWaiter();
+    if (_segment) {
+        ::munmap(_segment, sizeof(ShmSegment));
+    }
+}
+
+std::string ShmFace::getSocketPath(uint16_t port) {
+    std::stringstream ss;
+    ss << "/dev/shm/ndnms-" << port << ".sock";
+    return ss.str();
+}
+
+std::string ShmFace::getUnderlyingProtocol() const {
+    return "SHM";
+}
+
+std::string ShmFace::getUnderlyingEndpoint() const {
+    return getSocketPath(_port);
+}
+
+void ShmFace::open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) {
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    _self = shared_from_this();
+    if (!_skip_connect) {
+        if (!createSegment()) {
+            _error_callback(shared_from_this());
+            return;
+        }
+        _socket.async_connect(boost::asio::local::stream_protocol::endpoint(getSocketPath(_port)),
+                              _strand.wrap(boost::bind(&ShmFace::connectHandler, shared_from_this(), _1)));
+    } else {
+        boost::asio::async_read(_socket, boost::asio::buffer(_name_buffer, NAME_SIZE),
+                                _strand.wrap(boost::bind(&ShmFace::handshakeHandler, shared_from_this(), _1)));
+    }
+}
+
+void ShmFace::close() {
+    _is_connected = false;
+    stopWaiter();
+    _timer.cancel();
+    _socket.close();
+}
+
+void ShmFace::send(const std::string &message) {
+    send(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void ShmFace::send(const ndn::Interest &interest) {
+    send(getWireBuffer(interest.wireEncode()));
+}
+
+void ShmFace::send(const ndn::Data &data) {
+    send(getWireBuffer(data.wireEncode()));
+}
+
+void ShmFace::send(const std::shared_ptr<const ndn::Buffer> &wire) {
+    if (!_inbox.emplace(wire)) {
+        // the inbox only absorbs bursts between two drains, the egress queue applies the real limits
+        _strand.post(boost::bind(&ShmFace::sendImpl, shared_from_this(), wire));
+        return;
+    }
+    if (!_is_draining.exchange(true)) {
+        _strand.post(boost::bind(&ShmFace::drainInbox, shared_from_this()));
+    }
+}
+
+QueueStats ShmFace::getQueueStats() const {
+    return _queue.getStats();
+}
+
+const LatencyHistogram* ShmFace::getQueueLatency() const {
+    return &_queue.getLatency();
+}
+
+size_t ShmFace::getBufferBytes() const {
+    // the rings of the segment, mapped once connected
+    return _is_connected ? sizeof(ShmSegment) : 0;
+}
+
+bool ShmFace::createSegment() {
+    std::stringstream ss;
+    ss << "/ndnms-" << _port << "-" << ::getpid() << "-" << _face_id;
+    _segment_name = ss.str();
+    int fd = ::shm_open(_segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        logger::log(logger::ERROR, "can't create shared memory segment " + _segment_name + ": " + std::strerror(errno));
+        return false;
+    }
+    void *address = MAP_FAILED;
+    if (::ftruncate(fd, sizeof(ShmSegment)) == 0) {
+        address = ::mmap(nullptr, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        logger::log(logger::ERROR, "can't map shared memory segment " + _segment_name + ": " + std::strerror(errno));
+        ::shm_unlink(_segment_name.c_str());
+        return false;
+    }
+    // a new segment is zeroed, the rings are already empty
+    _segment = static_cast<ShmSegment*>(address);
+    _segment->magic.store(ShmSegment::MAGIC, std::memory_order_release);
+    _egress = &_segment->rings[0];
+    _ingress = &_segment->rings[1];
+    return true;
+}
+
+bool ShmFace::mapSegment() {
+    _segment_name.assign(_name_buffer, strnlen(_name_buffer, NAME_SIZE));
+    int fd = ::shm_open(_segment_name.c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        logger::log(logger::ERROR, "can't open shared memory segment " + _segment_name + ": " + std::strerror(errno));
+        return false;
+    }
+    struct stat status;
+    void *address = MAP_FAILED;
+    if (::fstat(fd, &status) == 0 && static_cast<size_t>(status.st_size) == sizeof(ShmSegment)) {
+        address = ::mmap(nullptr, sizeof(ShmSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    // both sides hold a mapping from now on, the name is no longer needed
+    ::shm_unlink(_segment_name.c_str());
+    if (address == MAP_FAILED) {
+        logger::log(logger::ERROR, "can't map shared memory segment " + _segment_name);
+        return false;
+    }
+    _segment = static_cast<ShmSegment*>(address);
+    if (_segment->magic.load(std::memory_order_acquire) != ShmSegment::MAGIC) {
+        logger::log(logger::ERROR, "invalid shared memory segment " + _segment_name);
+        return false;
+    }
+    _ingress = &_segment->rings[0];
+    _egress = &_segment->rings[1];
+    return true;
+}
+
+void ShmFace::connectHandler(const boost::system::error_code &err) {
+    if (!err) {
+        std::memset(_name_buffer, 0, NAME_SIZE);
+        std::memcpy(_name_buffer, _segment_name.c_str(), std::min(_segment_name.size(), NAME_SIZE));
+        boost::asio::async_write(_socket, boost::asio::buffer(_name_buffer, NAME_SIZE),
+                                 _strand.wrap(boost::bind(&ShmFace::handshakeHandler, shared_from_this(), _1)));
+    } else {
+        std::stringstream ss;
+        ss << "failed to connect to " << getSocketPath(_port);
+        logger::log(logger::ERROR, ss.str());
+        ::shm_unlink(_segment_name.c_str());
+        _error_callback(shared_from_this());
+    }
+}
+
+void ShmFace::handshakeHandler(const boost::system::error_code &err) {
+    if (err || (_skip_connect && !mapSegment())) {
+        if (!_skip_connect) {
+            ::shm_unlink(_segment_name.c_str());
+        }
+        _error_callback(shared_from_this());
+        return;
+    }
+    start();
+}
+
+void ShmFace::start() {
+    logger::log(logger::INFO, "SHM face with ID = {} successfully connected through {}", {_face_id, _segment_name});
+    _is_connected = true;
+    _waiter = std::thread(&ShmFace::wait, this);
+    watch();
+    // packets sent before the segment was mapped
+    if (!_queue.empty()) {
+        write();
+    }
+}
+
+void ShmFace::watch() {
+    _socket.async_read_some(boost::asio::buffer(&_peer_byte, 1),
+                            _strand.wrap(boost::bind(&ShmFace::watchHandler, shared_from_this(), _1)));
+}
+
+void ShmFace::watchHandler(const boost::system::error_code &err) {
+    if (!err) {
+        // nothing is sent after the handshake
+        watch();
+    } else if (_is_connected) {
+        logger::log(logger::WARNING, "lost connection to {}", {getSocketPath(_port)});
+        onError();
+    }
+}
+
+void ShmFace::onError() {
+    _is_connected = false;
+    stopWaiter();
+    _error_callback(shared_from_this());
+}
+
+void ShmFace::stopWaiter() {
+    if (!_waiter.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _is_stopping = true;
+    }
+    _received.notify_one();
+    _ingress->wake();
+    _waiter.join();
+}
+
+void ShmFace::wait() {
+    while (!_is_stopping) {
+        _ingress->wait();
+        if (_is_stopping || _ingress->empty()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_mutex);
+        _is_receiving = true;
+        // the waiter doesn't own the face, a face destroyed before the handler runs just isn't drained
+        std::weak_ptr<ShmFace> self = _self;
+        _ios.post([self]() {
+            if (auto face = self.lock()) {
+                face->receive();
+            }
+        });
+        _received.wait(lock, [this]() { return !_is_receiving || _is_stopping; });
+    }
+}
+
+void ShmFace::receive() {
+    size_t count = 0;
+    try {
+        size_t size;
+        while (_is_connected && count < RECEIVE_BATCH) {
+            const uint8_t *data = _ingress->peek(size);
+            if (!data) {
+                break;
+            }
+            auto buffer = BufferPool::local().copy(data, size);
+            _ingress->pop(size);
+            ++count;
+            try {
+                deliver(shared_from_this(), ndn::Block(buffer));
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    } catch (const std::runtime_error &e) {
+        logger::log(logger::ERROR, e.what());
+        flushBurst(shared_from_this());
+        if (_is_connected) {
+            onError();
+        }
+        return;
+    }
+    flushBurst(shared_from_this());
+    if (_is_connected && count == RECEIVE_BATCH) {
+        _ios.post(boost::bind(&ShmFace::receive, shared_from_this()));
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _is_receiving = false;
+    }
+    _received.notify_one();
+}
+
+void ShmFace::drainInbox() {
+    stage_profile::Scope stage(stage_profile::SEND);
+    for (;;) {
+        while (std::shared_ptr<const ndn::Buffer> *wire = _inbox.peek(0)) {
+            std::shared_ptr<const ndn::Buffer> buffer = std::move(*wire);
+            _inbox.pop();
+            countOut(buffer);
+            _queue.push(std::move(buffer), 0);
+        }
+        // everything drained goes to the ring at once
+        if (!_is_retrying) {
+            write();
+        }
+        // a sender may have pushed after the last peek but seen the inbox as still being drained
+        _is_draining = false;
+        if (!_inbox.peek(0) || _is_draining.exchange(true)) {
+            return;
+        }
+    }
+}
+
+void ShmFace::sendImpl(std::shared_ptr<const ndn::Buffer> &buffer) {
+    stage_profile::Scope stage(stage_profile::SEND);
+    countOut(buffer);
+    // nothing is being sent from the queue, any queued packet can be dropped
+    if (!_queue.push(std::move(buffer), 0)) {
+        return;
+    }
+    if (!_is_retrying) {
+        write();
+    }
+}
+
+void ShmFace::write() {
+    if (!_egress) {
+        return;
+    }
+    bool pushed = false;
+    while (!_queue.empty() && _egress->push(_queue.front()->data(), _queue.front()->size())) {
+        _queue.pop_front();
+        pushed = true;
+    }
+    // a single wake for the whole batch, none at all while the peer is draining
+    if (pushed) {
+        _egress->notify();
+    }
+    if (!_queue.empty() && !_is_retrying) {
+        // the peer frees the ring without telling, poll it until the queue is flushed
+        _is_retrying = true;
+        _timer.expires_from_now(boost::posix_time::milliseconds(1));
+        _timer.async_wait(_strand.wrap(boost::bind(&ShmFace::timerHandler, shared_from_this(), _1)));
+    }
+}
+
+void ShmFace::timerHandler(const boost::system::error_code &err) {
+    _is_retrying = false;
+    if (!err) {
+        write();
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "face.h"
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "mpsc_queue.h"
+#include "shm_ring.h"
+
+// face to a module on the same host, packets go through a shared memory ring per direction
+//
+// the connecting face creates the segment in /dev/shm, then gives its name to the master face over a unix socket
+// next to it, /dev/shm must hence be shared by the containers of both modules. the socket then only tells when the
+// peer is gone. a waiter thread sleeps on the ingress ring futex and hands the ring over to the io_service, which
+// copies the packets out and delivers them, while it is drained the producer sees the waiter awake and makes no syscall
+class ShmFace : public Face, public std::enable_shared_from_this<ShmFace> {
+public:
+    static const size_t INBOX_SIZE = 1 << 6;
+    static const size_t NAME_SIZE = 64;
+    // packets delivered by one handler before it lets the others run
+    static const size_t RECEIVE_BATCH = 256;
+
+private:
+    bool _skip_connect;
+
+    uint16_t _port;
+    std::string _segment_name;
+    boost::asio::local::stream_protocol::socket _socket;
+    boost::asio::strand _strand;
+    // senders from any thread push here without the strand, only the one which finds it idle posts drainInbox()
+    MpscQueue<std::shared_ptr<const ndn::Buffer>> _inbox;
+    std::atomic<bool> _is_draining;
+    // packets which didn't fit in the egress ring, retried on the timer
+    EgressQueue<std::shared_ptr<const ndn::Buffer>> _queue;
+
+    ShmSegment *_segment = nullptr;
+    ShmRing *_ingress = nullptr;
+    ShmRing *_egress = nullptr;
+    char _name_buffer[NAME_SIZE];
+    char _peer_byte;
+
+    std::weak_ptr<ShmFace> _self;
+    std::thread _waiter;
+    std::atomic<bool> _is_stopping;
+    // set by the waiter when it posts receive(), cleared once the ring is empty
+    std::mutex _mutex;
+    std::condition_variable _received;
+    bool _is_receiving = false;
+
+    boost::asio::deadline_timer _timer;
+    bool _is_retrying = false;
+
+public:
+    // use this when creating a face yourself, host is not used since the peer is found by its port on this host
+    ShmFace(boost::asio::io_service &ios, const std::string &host, uint16_t port);
+
+    // specific constructor for MasterFace, not recommended to use it yourself
+    ShmFace(boost::asio::local::stream_protocol::socket &&socket, uint16_t port);
+
+    ~ShmFace() override;
+
+    // unix socket of the master face listening on port
+    static std::string getSocketPath(uint16_t port);
+
+    std::string getUnderlyingProtocol() const override;
+
+    std::string getUnderlyingEndpoint() const override;
+
+    using Face::open;
+
+    void open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+    void close() override;
+
+    using Face::send;
+
+    void send(const std::string &message) override;
+
+    void send(const ndn::Interest &interest) override;
+
+    void send(const ndn::Data &data) override;
+
+    void send(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+    QueueStats getQueueStats() const override;
+
+    const LatencyHistogram* getQueueLatency() const override;
+
+    size_t getBufferBytes() const override;
+
+private:
+    bool createSegment();
+
+    bool mapSegment();
+
+    void connectHandler(const boost::system::error_code &err);
+
+    void handshakeHandler(const boost::system::error_code &err);
+
+    void start();
+
+    void watch();
+
+    void watchHandler(const boost::system::error_code &err);
+
+    void onError();
+
+    void stopWaiter();
+
+    void wait();
+
+    void receive();
+
+    void drainInbox();
+
+    void sendImpl(std::shared_ptr<const ndn::Buffer> &buffer);
+
+    void write();
+
+    void timerHandler(const boost::system::error_code &err);
+};
@@ -0,0 +1,153 @@
+#include "shm_master_face.h"
+
+#include <boost/bind.hpp>
+
+#include <unistd.h>
+
+#include "../log/logger.h"
+#include "../metrics/memory_stats.h"
+#include "../metrics/metrics.h"
+
+ShmMasterFace::ShmMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port)
+        : MasterFace(ios, max_connection)
+        , _port(port)
+        , _path(ShmFace::getSocketPath(port))
+        , _socket(ios)
+        , _acceptor(ios) {
+
+}
+
+std::string ShmMasterFace::getUnderlyingProtocol() const {
+    return "SHM";
+}
+
+void ShmMasterFace::listen(const NotificationCallback &notification_callback, const Face::InterestCallback &interest_callback,
+                           const Face::DataCallback &data_callback, const ErrorCallback &error_callback) {
+    _notification_callback = notification_callback;
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    // a socket left by a previous run of the module would make bind fail
+    ::unlink(_path.c_str());
+    boost::system::error_code err;
+    _acceptor.open(boost::asio::local::stream_protocol(), err);
+    if (!err) {
+        _acceptor.bind(boost::asio::local::stream_protocol::endpoint(_path), err);
+    }
+    if (!err) {
+        _acceptor.listen(boost::asio::socket_base::max_connections, err);
+    }
+    if (err) {
+        std::stringstream ss;
+        ss << "master face with ID = " << _master_face_id << " can't listen on " << _path << ": " << err.message();
+        logger::log(logger::ERROR, ss.str());
+        return;
+    }
+    std::stringstream ss;
+    ss << "master face with ID = " << _master_face_id << " listening on unix://" << _path;
+    logger::log(logger::INFO, ss.str());
+    accept();
+}
+
+void ShmMasterFace::close() {
+    if (_acceptor.is_open()) {
+        _acceptor.close();
+        ::unlink(_path.c_str());
+    }
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        face->close();
+    }
+}
+
+void ShmMasterFace::stopAccepting() {
+    // the socket file is left, a successor on this host may already listen on it
+    if (_acceptor.is_open()) {
+        _acceptor.close();
+    }
+}
+
+size_t ShmMasterFace::getQueuedPackets() const {
+    size_t packets = 0;
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        packets += face->getQueueStats().packets;
+    }
+    return packets;
+}
+
+void ShmMasterFace::sendToAllFaces(const std::string &message) {
+    sendToAllFaces(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void ShmMasterFace::sendToAllFaces(const ndn::Interest &interest) {
+    sendToAllFaces(Face::getWireBuffer(interest.wireEncode()));
+}
+
+void ShmMasterFace::sendToAllFaces(const ndn::Data &data) {
+    sendToAllFaces(Face::getWireBuffer(data.wireEncode()));
+}
+
+void ShmMasterFace::sendToAllFaces(const std::shared_ptr<const ndn::Buffer> &wire) {
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        face->send(wire);
+    }
+}
+
+std::string ShmMasterFace::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"id":)" << _master_face_id << R"(, "protocol":"SHM", "port":)" << _port << R"(, "listening":)" << _acceptor.is_open() << R"(, "faces":[)";
+    bool first = true;
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face->toJSON();
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+void ShmMasterFace::writeMetrics(MetricsWriter &writer) const {
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        face->writeMetrics(writer);
+    }
+}
+
+void ShmMasterFace::addMemoryStats(MemoryStats &stats) const {
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        face->addMemoryStats(stats);
+    }
+}
+
+void ShmMasterFace::accept() {
+    _acceptor.async_accept(_socket, boost::bind(&ShmMasterFace::acceptHandler, shared_from_this(), _1));
+}
+
+void ShmMasterFace::acceptHandler(const boost::system::error_code &err) {
+    if(!err) {
+        if(_faces.size() < _max_connection) {
+            logger::log(logger::INFO, "new connection from unix://{}", {_path});
+            auto face = std::make_shared<ShmFace>(std::move(_socket), _port);
+            _faces.add(face);
+            _notification_callback(shared_from_this(), face);
+            openFace(face, boost::bind(&ShmMasterFace::onFaceError, shared_from_this(), _1));
+        } else {
+            _socket.close();
+        }
+        accept();
+    } else if (err != boost::asio::error::operation_aborted) {
+        std::cerr << err.message() << std::endl;
+    }
+}
+
+void ShmMasterFace::onFaceError(const std::shared_ptr<Face> &face) {
+    _faces.remove(face);
+    _error_callback(shared_from_this(), face);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "master_face.h"
+
+#include <boost/asio.hpp>
+
+#include "face_list.h"
+#include "shm_face.h"
+
+// accepts shared memory faces from the modules of the same host, see ShmFace
+class ShmMasterFace : public MasterFace, public std::enable_shared_from_this<ShmMasterFace> {
+private:
+    uint16_t _port;
+    std::string _path;
+    boost::asio::local::stream_protocol::socket _socket;
+    boost::asio::local::stream_protocol::acceptor _acceptor;
+    // accepted and lost on the io_service of the master face, sent to from any thread
+    FaceList<Face> _faces;
+
+public:
+    ShmMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port);
+
+    ~ShmMasterFace() override = default;
+
+    std::string getUnderlyingProtocol() const override;
+
+    // a host without /dev/shm only logs an error, the module keeps its other master faces
+    void listen(const NotificationCallback &notification_callback, const Face::InterestCallback &interest_callback,
+                const Face::DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+    using MasterFace::listen;
+
+    void close() override;
+
+    void stopAccepting() override;
+
+    size_t getQueuedPackets() const override;
+
+    void sendToAllFaces(const std::string &message) override;
+
+    void sendToAllFaces(const ndn::Interest &interest) override;
+
+    void sendToAllFaces(const ndn::Data &data) override;
+
+    void sendToAllFaces(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+    using MasterFace::sendToAllFaces;
+
+    std::string toJSON() const override;
+
+    void writeMetrics(MetricsWriter &writer) const override;
+
+    void addMemoryStats(MemoryStats &stats) const override;
+
+private:
+    void accept();
+
+    void acceptHandler(const boost::system::error_code &err);
+
+    void onFaceError(const std::shared_ptr<Face> &face);
+};
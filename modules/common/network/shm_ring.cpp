@@ -0,0 +1,107 @@
+#include "shm_ring.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+    // not FUTEX_PRIVATE_FLAG, the word is shared with the other process
+    void futexWait(std::atomic<uint32_t> &word, uint32_t expected) {
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+    }
+
+    void futexWake(std::atomic<uint32_t> &word) {
+        ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+}
+
+bool ShmRing::push(const uint8_t *data, size_t size) {
+    size_t record_size = recordSize(size);
+    uint64_t tail = _tail.load(std::memory_order_relaxed);
+    uint64_t head = _head.load(std::memory_order_acquire);
+    size_t offset = tail & (SIZE - 1);
+    size_t contiguous = SIZE - offset;
+    size_t padding = contiguous < record_size ? contiguous : 0;
+    if (padding + record_size > SIZE - (tail - head)) {
+        return false;
+    }
+    if (padding) {
+        uint32_t marker = PADDING;
+        std::memcpy(_data + offset, &marker, sizeof(marker));
+        tail += padding;
+        offset = 0;
+    }
+    uint32_t length = static_cast<uint32_t>(size);
+    std::memcpy(_data + offset, &length, sizeof(length));
+    std::memcpy(_data + offset + HEADER_SIZE, data, size);
+    // seq_cst against the load of _is_waiting in notify(), see wait()
+    _tail.store(tail + record_size, std::memory_order_seq_cst);
+    return true;
+}
+
+void ShmRing::notify() {
+    if (_is_waiting.load(std::memory_order_seq_cst)) {
+        _sequence.fetch_add(1, std::memory_order_seq_cst);
+        futexWake(_sequence);
+    }
+}
+
+const uint8_t* ShmRing::peek(size_t &size) {
+    uint64_t head = _head.load(std::memory_order_relaxed);
+    uint64_t tail = _tail.load(std::memory_order_acquire);
+    if (head == tail) {
+        return nullptr;
+    }
+    size_t offset = head & (SIZE - 1);
+    uint32_t length;
+    std::memcpy(&length, _data + offset, sizeof(length));
+    if (length == PADDING) {
+        head += SIZE - offset;
+        _head.store(head, std::memory_order_release);
+        if (head == tail) {
+            return nullptr;
+        }
+        offset = 0;
+        std::memcpy(&length, _data, sizeof(length));
+    }
+    // the other process is not trusted to keep its records in the ring
+    if (recordSize(length) > SIZE - offset || recordSize(length) > tail - head) {
+        throw std::runtime_error("corrupted shared memory ring");
+    }
+    size = length;
+    return _data + offset + HEADER_SIZE;
+}
+
+void ShmRing::pop(size_t size) {
+    _head.store(_head.load(std::memory_order_relaxed) + recordSize(size), std::memory_order_release);
+}
+
+void ShmRing::wait() {
+    // the producer publishes _tail then reads _is_waiting, the consumer sets _is_waiting then reads _tail, with both
+    // sequentially consistent at least one of them sees the other: either the ring is found not empty here or the
+    // producer bumps _sequence, which makes the futex wait return at once if it happened after the load below
+    _is_waiting.store(1, std::memory_order_seq_cst);
+    uint32_t sequence = _sequence.load(std::memory_order_seq_cst);
+    if (empty()) {
+        futexWait(_sequence, sequence);
+    }
+    _is_waiting.store(0, std::memory_order_relaxed);
+}
+
+void ShmRing::wake() {
+    _sequence.fetch_add(1, std::memory_order_seq_cst);
+    futexWake(_sequence);
+}
+
+bool ShmRing::empty() const {
+    return _head.load(std::memory_order_relaxed) == _tail.load(std::memory_order_seq_cst);
+}
+
+size_t ShmRing::bytes() const {
+    return _tail.load(std::memory_order_relaxed) - _head.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// single producer single consumer ring of packets, placed in memory shared by two processes
+//
+// records are an 8 bytes header holding the packet size followed by the packet, padded to 8 bytes. positions only
+// grow, a record never wraps around the end of the ring: when it doesn't fit there a padding record fills the rest.
+// the consumer sleeps on a futex only after announcing it in _is_waiting, so a producer which finds it awake
+// publishes its records without any syscall
+class ShmRing {
+public:
+    static const size_t SIZE = 1 << 20; // 1M
+    static const size_t HEADER_SIZE = 8;
+    static const uint32_t PADDING = 0xFFFFFFFF;
+
+private:
+    alignas(64) std::atomic<uint64_t> _tail;
+    alignas(64) std::atomic<uint64_t> _head;
+    // futex word, bumped when the consumer has to be woken up
+    alignas(64) std::atomic<uint32_t> _sequence;
+    std::atomic<uint32_t> _is_waiting;
+    alignas(64) uint8_t _data[SIZE];
+
+public:
+    // the memory of a new segment is zeroed, which is an empty ring
+    ShmRing() = delete;
+
+    // producer only, return false if there is not enough room for the packet yet
+    bool push(const uint8_t *data, size_t size);
+
+    // producer only, after a batch of push(), wakes the consumer up if it sleeps
+    void notify();
+
+    // consumer only, the next packet or nullptr if the ring is empty, throws std::runtime_error on a corrupted ring
+    const uint8_t* peek(size_t &size);
+
+    // consumer only, releases the packet returned by the last peek()
+    void pop(size_t size);
+
+    // consumer only, blocks until a packet is available or until wake() is called
+    void wait();
+
+    // wakes the consumer up even if the ring is empty, to stop it
+    void wake();
+
+    bool empty() const;
+
+    size_t bytes() const;
+
+private:
+    static size_t recordSize(size_t size) {
+        return (HEADER_SIZE + size + 7) & ~static_cast<size_t>(7);
+    }
+};
+
+// what a shared memory face maps, created by the connecting side
+struct ShmSegment {
+    static const uint32_t MAGIC = 0x4e444e53; // "NDNS"
+
+    // set once the rings are initialized
+    std::atomic<uint32_t> magic;
+    // from the face which connected to the face of the master face, then back
+    ShmRing rings[2];
+
+    ShmSegment() = delete;
+};
@@ -0,0 +1,142 @@
+#include "socket_options.h"
+
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "../log/logger.h"
+
+#ifdef __linux__
+#include <linux/sock_diag.h>
+#endif
+
+std::mutex SocketOptions::_default_mutex;
+SocketOptions SocketOptions::_default;
+
+bool SocketOptions::parse(const std::string &text, SocketOptions &options) {
+    SocketOptions parsed = options;
+    std::stringstream ss(text);
+    std::string option;
+    while (std::getline(ss, option, ',')) {
+        size_t equal = option.find('=');
+        if (equal == std::string::npos) {
+            return false;
+        }
+        char *end;
+        long long value = std::strtoll(option.c_str() + equal + 1, &end, 10);
+        if (end == option.c_str() + equal + 1 || *end != '\0' || !parsed.set(option.substr(0, equal), value)) {
+            return false;
+        }
+    }
+    options = parsed;
+    return true;
+}
+
+bool SocketOptions::update(const rapidjson::Value &value) {
+    if (!value.IsObject()) {
+        return false;
+    }
+    SocketOptions updated = *this;
+    for (const auto &member : value.GetObject()) {
+        if (!member.value.IsInt64() || !updated.set(member.name.GetString(), member.value.GetInt64())) {
+            return false;
+        }
+    }
+    *this = updated;
+    return true;
+}
+
+bool SocketOptions::set(const std::string &key, int64_t value) {
+    if (key == "dscp") {
+        // 6 bits, the 2 lower bits of the traffic class are ECN
+        if (value < -1 || value > 63) {
+            return false;
+        }
+        dscp = static_cast<int>(value);
+        return true;
+    }
+    if (value < 0 || value > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    if (key == "receive_buffer") {
+        receive_buffer = static_cast<int>(value);
+    } else if (key == "send_buffer") {
+        send_buffer = static_cast<int>(value);
+    } else if (key == "busy_poll") {
+        busy_poll = static_cast<int>(value);
+    } else if (key == "backlog") {
+        backlog = static_cast<int>(value);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void SocketOptions::apply(int fd) const {
+    auto option = [fd](int level, int name, int value, const char *label) {
+        if (::setsockopt(fd, level, name, &value, sizeof(value)) < 0) {
+            logger::log(logger::WARNING, "can't set {} to {} ({})", {label, value, std::strerror(errno)});
+            return false;
+        }
+        return true;
+    };
+
+    // the FORCE variants lift the sysctl limits for a privileged process, the sysctl ones cap the value otherwise
+    if (receive_buffer > 0 && ::setsockopt(fd, SOL_SOCKET, SO_RCVBUFFORCE, &receive_buffer, sizeof(receive_buffer)) < 0) {
+        option(SOL_SOCKET, SO_RCVBUF, receive_buffer, "SO_RCVBUF");
+    }
+    if (send_buffer > 0 && ::setsockopt(fd, SOL_SOCKET, SO_SNDBUFFORCE, &send_buffer, sizeof(send_buffer)) < 0) {
+        option(SOL_SOCKET, SO_SNDBUF, send_buffer, "SO_SNDBUF");
+    }
+#ifdef SO_BUSY_POLL
+    if (busy_poll > 0) {
+        option(SOL_SOCKET, SO_BUSY_POLL, busy_poll, "SO_BUSY_POLL");
+    }
+#endif
+    if (dscp >= 0) {
+        sockaddr_storage address;
+        socklen_t length = sizeof(address);
+        if (::getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) == 0 && address.ss_family == AF_INET6) {
+            option(IPPROTO_IPV6, IPV6_TCLASS, dscp << 2, "IPV6_TCLASS");
+        } else {
+            option(IPPROTO_IP, IP_TOS, dscp << 2, "IP_TOS");
+        }
+    }
+}
+
+std::string SocketOptions::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"receive_buffer":)" << receive_buffer << R"(, "send_buffer":)" << send_buffer << R"(, "busy_poll":)" << busy_poll
+       << R"(, "dscp":)" << dscp << R"(, "backlog":)" << backlog << "}";
+    return ss.str();
+}
+
+bool SocketOptions::operator==(const SocketOptions &other) const {
+    return receive_buffer == other.receive_buffer && send_buffer == other.send_buffer && busy_poll == other.busy_poll
+           && dscp == other.dscp && backlog == other.backlog;
+}
+
+SocketOptions SocketOptions::getDefault() {
+    std::lock_guard<std::mutex> lock(_default_mutex);
+    return _default;
+}
+
+void SocketOptions::setDefault(const SocketOptions &options) {
+    std::lock_guard<std::mutex> lock(_default_mutex);
+    _default = options;
+}
+
+uint64_t SocketOptions::getDrops(int fd) {
+#if defined(SO_MEMINFO) && defined(__linux__)
+    uint32_t meminfo[SK_MEMINFO_VARS];
+    socklen_t length = sizeof(meminfo);
+    if (fd >= 0 && ::getsockopt(fd, SOL_SOCKET, SO_MEMINFO, meminfo, &length) == 0 && length > SK_MEMINFO_DROPS * sizeof(uint32_t)) {
+        return meminfo[SK_MEMINFO_DROPS];
+    }
+#endif
+    return 0;
+}
\ No newline at end of file
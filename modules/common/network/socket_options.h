@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "rapidjson/document.h"
+
+// kernel settings of the sockets of the faces. every face starts from the default profile, set with -O at startup or
+// replaced by edit_config, and a master face or an egress face may be given its own. a 0 (-1 for dscp) leaves the
+// kernel default
+struct SocketOptions {
+    // SO_RCVBUF and SO_SNDBUF in bytes, past net.core.rmem_max and wmem_max only with CAP_NET_ADMIN
+    int receive_buffer = 0;
+    int send_buffer = 0;
+    // SO_BUSY_POLL, microseconds a receive polls the NIC queue before sleeping
+    int busy_poll = 0;
+    // DSCP of the packets sent, e.g. 46 for expedited forwarding
+    int dscp = -1;
+    // pending connections of a TCP master face, SOMAXCONN with 0
+    int backlog = 0;
+
+    // "receive_buffer=4194304,dscp=46" onto options, false on an unknown key or a value out of range
+    static bool parse(const std::string &text, SocketOptions &options);
+
+    // the members given in value, false and nothing changed if one of them is unknown or invalid
+    bool update(const rapidjson::Value &value);
+
+    // the failures are logged and the other options still applied
+    void apply(int fd) const;
+
+    std::string toJSON() const;
+
+    bool operator==(const SocketOptions &other) const;
+
+    bool operator!=(const SocketOptions &other) const {
+        return !(*this == other);
+    }
+
+    static SocketOptions getDefault();
+
+    static void setDefault(const SocketOptions &options);
+
+    // datagrams the kernel dropped on a full receive buffer of the socket since it was opened (SO_MEMINFO)
+    static uint64_t getDrops(int fd);
+
+private:
+    static std::mutex _default_mutex;
+    static SocketOptions _default;
+
+    bool set(const std::string &key, int64_t value);
+};
\ No newline at end of file
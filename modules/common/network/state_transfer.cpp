@@ -0,0 +1,151 @@
+#include "state_transfer.h"
+
+namespace {
+    const size_t HEADER_SIZE = 8;
+
+    struct Sender {
+        boost::asio::ip::tcp::socket socket;
+        std::shared_ptr<const std::string> state;
+        char header[HEADER_SIZE];
+        state_transfer::SendCallback callback;
+
+        Sender(boost::asio::io_service &ios, const std::shared_ptr<const std::string> &state,
+               const state_transfer::SendCallback &callback)
+                : socket(ios)
+                , state(state)
+                , callback(callback) {
+            for (size_t i = 0; i < HEADER_SIZE; ++i) {
+                header[i] = static_cast<char>(static_cast<uint64_t>(state->size()) >> (8 * (HEADER_SIZE - 1 - i)));
+            }
+        }
+    };
+
+    struct Receiver {
+        boost::asio::ip::tcp::acceptor acceptor;
+        boost::asio::ip::tcp::socket socket;
+        boost::asio::deadline_timer timer;
+        size_t max_size;
+        unsigned char header[HEADER_SIZE];
+        std::shared_ptr<std::string> state;
+        state_transfer::ReceiveCallback callback;
+        bool is_done = false;
+
+        Receiver(boost::asio::io_service &ios, size_t max_size, const state_transfer::ReceiveCallback &callback)
+                : acceptor(ios)
+                , socket(ios)
+                , timer(ios)
+                , max_size(max_size)
+                , state(std::make_shared<std::string>())
+                , callback(callback) {
+
+        }
+
+        // once, a timeout may race with the last read
+        void finish(const boost::system::error_code &err) {
+            if (is_done) {
+                return;
+            }
+            is_done = true;
+            boost::system::error_code ignored;
+            timer.cancel(ignored);
+            acceptor.close(ignored);
+            socket.close(ignored);
+            callback(err, err ? std::shared_ptr<const std::string>() : state);
+        }
+    };
+
+    void onBody(const std::shared_ptr<Receiver> &receiver, const boost::system::error_code &err) {
+        receiver->finish(err);
+    }
+
+    void onHeader(const std::shared_ptr<Receiver> &receiver, const boost::system::error_code &err) {
+        if (err) {
+            receiver->finish(err);
+            return;
+        }
+        uint64_t size = 0;
+        for (unsigned char byte : receiver->header) {
+            size = size << 8 | byte;
+        }
+        if (size > receiver->max_size) {
+            receiver->finish(boost::asio::error::message_size);
+            return;
+        }
+        receiver->state->resize(size);
+        boost::asio::async_read(receiver->socket, boost::asio::buffer(&(*receiver->state)[0], size),
+                                [receiver](const boost::system::error_code &err, size_t) {
+                                    onBody(receiver, err);
+                                });
+    }
+}
+
+namespace state_transfer {
+    void send(boost::asio::io_service &ios, const std::string &address, uint16_t port,
+              const std::shared_ptr<const std::string> &state, const SendCallback &callback) {
+        auto sender = std::make_shared<Sender>(ios, state, callback);
+        boost::system::error_code err;
+        boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(address, err), port);
+        if (err) {
+            ios.post([sender, err]() {
+                sender->callback(err);
+            });
+            return;
+        }
+        sender->socket.async_connect(endpoint, [sender](const boost::system::error_code &err) {
+            if (err) {
+                sender->callback(err);
+                return;
+            }
+            // a single gather write, the state is not copied
+            std::vector<boost::asio::const_buffer> buffers = {
+                    boost::asio::buffer(sender->header, HEADER_SIZE),
+                    boost::asio::buffer(*sender->state)
+            };
+            boost::asio::async_write(sender->socket, buffers, [sender](const boost::system::error_code &err, size_t) {
+                boost::system::error_code ignored;
+                sender->socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+                sender->socket.close(ignored);
+                sender->callback(err);
+            });
+        });
+    }
+
+    boost::system::error_code receive(boost::asio::io_service &ios, uint16_t port, size_t max_size, size_t timeout,
+                                      const ReceiveCallback &callback) {
+        auto receiver = std::make_shared<Receiver>(ios, max_size, callback);
+        boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), port);
+        boost::system::error_code err;
+        receiver->acceptor.open(endpoint.protocol(), err);
+        if (!err) {
+            receiver->acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true), err);
+        }
+        if (!err) {
+            receiver->acceptor.bind(endpoint, err);
+        }
+        if (!err) {
+            receiver->acceptor.listen(1, err);
+        }
+        if (err) {
+            return err;
+        }
+        receiver->timer.expires_from_now(boost::posix_time::seconds(timeout));
+        receiver->timer.async_wait([receiver](const boost::system::error_code &err) {
+            if (!err) {
+                receiver->finish(boost::asio::error::timed_out);
+            }
+        });
+        receiver->acceptor.async_accept(receiver->socket, [receiver](const boost::system::error_code &err) {
+            if (err) {
+                receiver->finish(err);
+                return;
+            }
+            boost::system::error_code ignored;
+            receiver->acceptor.close(ignored);
+            boost::asio::async_read(receiver->socket, boost::asio::buffer(receiver->header, HEADER_SIZE),
+                                    [receiver](const boost::system::error_code &err, size_t) {
+                                        onHeader(receiver, err);
+                                    });
+        });
+        return err;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+// warm state handed from a module to its new clone, e.g. the hot entries of a CS or the routes of a NR, straight over
+// a TCP connection of its own rather than a face, which only carries NDN packets. the clone listens first, then the
+// manager tells the module to send. the state is a length then its bytes, a connection cut short is an error rather
+// than a partial state
+namespace state_transfer {
+    using SendCallback = std::function<void(const boost::system::error_code &err)>;
+
+    // state is empty on error
+    using ReceiveCallback = std::function<void(const boost::system::error_code &err, const std::shared_ptr<const std::string> &state)>;
+
+    // the callbacks run on ios
+    void send(boost::asio::io_service &ios, const std::string &address, uint16_t port,
+              const std::shared_ptr<const std::string> &state, const SendCallback &callback);
+
+    // a single connection is accepted on port, whatever comes in this many seconds and up to max_size bytes. the error
+    // is returned at once if port can't be bound, callback is not called then
+    boost::system::error_code receive(boost::asio::io_service &ios, uint16_t port, size_t max_size, size_t timeout,
+                                      const ReceiveCallback &callback);
+}
\ No newline at end of file
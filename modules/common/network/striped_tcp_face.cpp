@@ -0,0 +1,164 @@
+#include "striped_tcp_face.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "name_hash.h"
+#include "name_view.h"
+#include "tcp_connection_pool.h"
+#include "tcp_face.h"
+#include "../log/logger.h"
+
+StripedTcpFace::StripedTcpFace(boost::asio::io_service &ios, TcpConnectionPool &pool, const std::string &address, uint16_t port,
+                               size_t connections)
+        : Face(ios) {
+    connections = std::min(std::max<size_t>(connections, 1), MAX_CONNECTIONS);
+    for (size_t i = 0; i < connections; ++i) {
+        _connections.push_back(pool.makeFace(ios, address, port));
+    }
+    _endpoint = _connections.front()->getUnderlyingEndpoint();
+}
+
+std::string StripedTcpFace::getUnderlyingProtocol() const {
+    return "TCP";
+}
+
+std::string StripedTcpFace::getUnderlyingEndpoint() const {
+    return _endpoint;
+}
+
+std::string StripedTcpFace::getState() const {
+    if (!_is_connected) {
+        return Face::getState();
+    }
+    for (const auto &connection : _connections) {
+        std::string state = connection->getState();
+        if (state != "connected") {
+            return state;
+        }
+    }
+    return "connected";
+}
+
+void StripedTcpFace::open(const InterestCallback &interest_callback,
+                          const DataCallback &data_callback,
+                          const ErrorCallback &error_callback) {
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    _is_connected = true;
+    // the connections only hold the face weakly, it is gone once the module dropped it
+    std::weak_ptr<StripedTcpFace> self = shared_from_this();
+    BurstCallback burst_callback = [self](const std::shared_ptr<Face>&, const std::vector<NdnPacket> &packets) {
+        if (auto face = self.lock()) {
+            face->onBurst(packets);
+        }
+    };
+    ErrorCallback connection_error_callback = [self](const std::shared_ptr<Face>&) {
+        if (auto face = self.lock()) {
+            face->onConnectionError();
+        }
+    };
+    for (const auto &connection : _connections) {
+        connection->open(burst_callback, connection_error_callback);
+    }
+}
+
+void StripedTcpFace::close() {
+    _is_connected = false;
+    for (const auto &connection : _connections) {
+        connection->close();
+    }
+}
+
+void StripedTcpFace::send(const std::string &message) {
+    send(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void StripedTcpFace::send(const ndn::Interest &interest) {
+    send(getWireBuffer(interest.wireEncode()));
+}
+
+void StripedTcpFace::send(const ndn::Data &data) {
+    send(getWireBuffer(data.wireEncode()));
+}
+
+void StripedTcpFace::send(const std::shared_ptr<const ndn::Buffer> &wire) {
+    countOut(wire);
+    connectionOf(wire).send(wire);
+}
+
+QueueStats StripedTcpFace::getQueueStats() const {
+    QueueStats stats;
+    for (const auto &connection : _connections) {
+        QueueStats connection_stats = connection->getQueueStats();
+        stats.packets += connection_stats.packets;
+        stats.bytes += connection_stats.bytes;
+        stats.dropped_interests += connection_stats.dropped_interests;
+        stats.dropped_data += connection_stats.dropped_data;
+        stats.expired_interests += connection_stats.expired_interests;
+        stats.shed_interests += connection_stats.shed_interests;
+    }
+    return stats;
+}
+
+size_t StripedTcpFace::getBufferBytes() const {
+    size_t bytes = 0;
+    for (const auto &connection : _connections) {
+        bytes += connection->getBufferBytes();
+    }
+    return bytes;
+}
+
+void StripedTcpFace::setSocketOptions(const SocketOptions &options) {
+    for (const auto &connection : _connections) {
+        connection->setSocketOptions(options);
+    }
+}
+
+TcpFace& StripedTcpFace::connectionOf(uint64_t hash) const {
+    return *_connections[hash % _connections.size()];
+}
+
+TcpFace& StripedTcpFace::connectionOf(const std::shared_ptr<const ndn::Buffer> &wire) const {
+    if (_connections.size() == 1 || wire->empty() || (wire->front() != ndn::tlv::Interest && wire->front() != ndn::tlv::Data)) {
+        return *_connections.front();
+    }
+    try {
+        return connectionOf(NameView(ndn::Block(wire)).getHash());
+    } catch (const std::exception &e) {
+        return *_connections.front();
+    }
+}
+
+void StripedTcpFace::onBurst(const std::vector<NdnPacket> &packets) {
+    if (!_is_connected) {
+        return;
+    }
+    auto self = shared_from_this();
+    for (const auto &packet : packets) {
+        try {
+            if (packet.getLpPacket()) {
+                // the LpPacket is in the buffer of the packet, as the connection read them both
+                const auto &buffer = packet.getBlock().getBuffer();
+                auto begin = buffer->begin() + (packet.getLpPacket() - buffer->data());
+                ndn::Block lp_packet(buffer, begin, begin + packet.getLpPacketSize(), false);
+                deliver(self, packet.getBlock(), &lp_packet);
+            } else {
+                deliver(self, packet.getBlock());
+            }
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+    flushBurst(self);
+}
+
+void StripedTcpFace::onConnectionError() {
+    if (!_is_connected) {
+        return;
+    }
+    logger::log(logger::ERROR, "a connection of the striped face with ID = {} to {} failed", {_face_id, _endpoint});
+    close();
+    _error_callback(shared_from_this());
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "face.h"
+
+#include <boost/asio.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class TcpConnectionPool;
+class TcpFace;
+
+// one face over several TCP connections to the same endpoint, for the links between modules which a single
+// connection can't fill, e.g. a Content Store to its Signature Verifier: each connection has its own socket buffers,
+// window and write, a loss stalls only the packets of its own connection. a packet goes on the connection given by
+// the name_hash of its Name, so the packets of a Name keep their order, the others on the first one
+//
+// the master face on the other end sees a face per connection, it answers an Interest on the one it came from, so a
+// Data comes back on the connection of its Interest and is delivered here. the connections run on the io_service of
+// the face and reconnect on their own, the face fails once one of them gives up. the packets are counted by the face
+// and by its connection, which trace and capture them under their own ids too
+class StripedTcpFace : public Face, public std::enable_shared_from_this<StripedTcpFace> {
+public:
+    static const size_t MAX_CONNECTIONS = 16;
+
+private:
+    std::string _endpoint;
+    std::vector<std::shared_ptr<TcpFace>> _connections;
+
+public:
+    // connections to address:port taken from pool as TcpConnectionPool::makeFace, between 1 and MAX_CONNECTIONS.
+    // throws as TcpFace on an invalid address
+    StripedTcpFace(boost::asio::io_service &ios, TcpConnectionPool &pool, const std::string &address, uint16_t port, size_t connections);
+
+    ~StripedTcpFace() override = default;
+
+    std::string getUnderlyingProtocol() const override;
+
+    std::string getUnderlyingEndpoint() const override;
+
+    // that of the first connection not connected, if any
+    std::string getState() const override;
+
+    using Face::open;
+
+    void open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+    void close() override;
+
+    using Face::send;
+
+    void send(const std::string &message) override;
+
+    void send(const ndn::Interest &interest) override;
+
+    void send(const ndn::Data &data) override;
+
+    void send(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+    // summed over the connections
+    QueueStats getQueueStats() const override;
+
+    size_t getBufferBytes() const override;
+
+    void setSocketOptions(const SocketOptions &options) override;
+
+    size_t getConnections() const {
+        return _connections.size();
+    }
+
+private:
+    TcpFace& connectionOf(uint64_t hash) const;
+
+    // by the Name of wire, the first connection for the packets without one or which can't be parsed
+    TcpFace& connectionOf(const std::shared_ptr<const ndn::Buffer> &wire) const;
+
+    void onBurst(const std::vector<NdnPacket> &packets);
+
+    void onConnectionError();
+};
\ No newline at end of file
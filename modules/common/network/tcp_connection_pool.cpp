@@ -0,0 +1,198 @@
+#include "tcp_connection_pool.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <functional>
+#include <sstream>
+#include <vector>
+
+#include "socket_options.h"
+#include "tcp_face.h"
+#include "../log/logger.h"
+
+TcpConnectionPool::TcpConnectionPool(boost::asio::io_service &ios) : _ios(ios), _timer(ios) {
+
+}
+
+void TcpConnectionPool::setSize(const boost::asio::ip::tcp::endpoint &endpoint, size_t size) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Target &target = _targets[endpoint];
+    target.size = size;
+    while (target.idle.size() > size) {
+        target.idle.pop_back();
+    }
+    refill(endpoint, target);
+    arm();
+}
+
+bool TcpConnectionPool::update(const rapidjson::Value &value) {
+    std::vector<std::pair<boost::asio::ip::tcp::endpoint, size_t>> sizes;
+    auto parse = [&sizes](const rapidjson::Value &entry) {
+        if (!entry.IsObject() || !entry.HasMember("address") || !entry["address"].IsString() || !entry.HasMember("port")
+            || !entry["port"].IsUint() || entry["port"].GetUint() > UINT16_MAX || !entry.HasMember("size") || !entry["size"].IsUint()) {
+            return false;
+        }
+        boost::system::error_code err;
+        auto address = boost::asio::ip::address::from_string(entry["address"].GetString(), err);
+        if (err) {
+            return false;
+        }
+        sizes.emplace_back(boost::asio::ip::tcp::endpoint(address, static_cast<uint16_t>(entry["port"].GetUint())), entry["size"].GetUint());
+        return true;
+    };
+    if (value.IsArray()) {
+        for (const auto &entry : value.GetArray()) {
+            if (!parse(entry)) {
+                return false;
+            }
+        }
+    } else if (!parse(value)) {
+        return false;
+    }
+    for (const auto &size : sizes) {
+        setSize(size.first, size.second);
+    }
+    return true;
+}
+
+std::shared_ptr<TcpFace> TcpConnectionPool::makeFace(boost::asio::io_service &ios, const std::string &address, uint16_t port) {
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::address::from_string(address), port);
+    std::unique_ptr<boost::asio::ip::tcp::socket> connection;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _targets.find(endpoint);
+        if (it == _targets.end() || it->second.size == 0) {
+            return std::make_shared<TcpFace>(ios, endpoint);
+        }
+        Target &target = it->second;
+        while (!connection && !target.idle.empty()) {
+            connection = std::move(target.idle.front());
+            target.idle.pop_front();
+            if (!isHealthy(*connection)) {
+                connection.reset();
+                ++target.dropped;
+            }
+        }
+        if (!connection) {
+            ++target.misses;
+            refill(endpoint, target);
+            return std::make_shared<TcpFace>(ios, endpoint);
+        }
+        ++target.hits;
+        refill(endpoint, target);
+    }
+    // a socket stays on the io_service it was made on, the descriptor is handed over to one of ios
+    int fd = ::dup(connection->native_handle());
+    connection.reset();
+    boost::asio::ip::tcp::socket socket(ios);
+    boost::system::error_code err;
+    if (fd < 0 || socket.assign(endpoint.protocol(), fd, err)) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return std::make_shared<TcpFace>(ios, endpoint);
+    }
+    return std::make_shared<TcpFace>(std::move(socket), endpoint);
+}
+
+std::string TcpConnectionPool::toJSON() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::stringstream ss;
+    ss << "[";
+    bool first = true;
+    for (const auto &entry : _targets) {
+        const Target &target = entry.second;
+        ss << (first ? "" : ", ") << R"({"endpoint":")" << entry.first << R"(", "size":)" << target.size
+           << R"(, "idle":)" << target.idle.size() << R"(, "connecting":)" << target.connecting << R"(, "hits":)" << target.hits
+           << R"(, "misses":)" << target.misses << R"(, "failures":)" << target.failures << R"(, "dropped":)" << target.dropped << "}";
+        first = false;
+    }
+    ss << "]";
+    return ss.str();
+}
+
+void TcpConnectionPool::refill(const boost::asio::ip::tcp::endpoint &endpoint, Target &target) {
+    while (target.idle.size() + target.connecting < target.size) {
+        ++target.connecting;
+        _ios.post(std::bind(&TcpConnectionPool::connect, this, endpoint));
+    }
+}
+
+void TcpConnectionPool::connect(const boost::asio::ip::tcp::endpoint &endpoint) {
+    auto socket = std::make_shared<boost::asio::ip::tcp::socket>(_ios);
+    auto timer = std::make_shared<boost::asio::deadline_timer>(_ios);
+    boost::system::error_code err;
+    // before the handshake, as a TcpFace does, for the window scale to follow the buffers
+    socket->open(endpoint.protocol(), err);
+    if (!err) {
+        SocketOptions::getDefault().apply(socket->native_handle());
+    }
+    timer->expires_from_now(boost::posix_time::milliseconds(TcpFace::CONNECT_TIMEOUT_MS));
+    timer->async_wait([socket](const boost::system::error_code &err) {
+        if (!err) {
+            boost::system::error_code ec;
+            socket->close(ec);
+        }
+    });
+    socket->async_connect(endpoint, [this, socket, timer, endpoint](const boost::system::error_code &err) {
+        timer->cancel();
+        std::lock_guard<std::mutex> lock(_mutex);
+        Target &target = _targets[endpoint];
+        --target.connecting;
+        if (err) {
+            // tried again at the next check rather than at once against a peer which is down
+            ++target.failures;
+            logger::log(logger::WARNING, "pooled connection to {} failed", {endpoint});
+        } else if (target.idle.size() < target.size) {
+            target.idle.emplace_back(new boost::asio::ip::tcp::socket(std::move(*socket)));
+        }
+    });
+}
+
+void TcpConnectionPool::arm() {
+    if (_is_armed) {
+        return;
+    }
+    _is_armed = true;
+    _timer.expires_from_now(boost::posix_time::milliseconds(CHECK_INTERVAL_MS));
+    _timer.async_wait(std::bind(&TcpConnectionPool::check, this, std::placeholders::_1));
+}
+
+void TcpConnectionPool::check(const boost::system::error_code &err) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _is_armed = false;
+    if (err) {
+        return;
+    }
+    for (auto it = _targets.begin(); it != _targets.end();) {
+        Target &target = it->second;
+        for (auto idle = target.idle.begin(); idle != target.idle.end();) {
+            if (isHealthy(**idle)) {
+                ++idle;
+            } else {
+                idle = target.idle.erase(idle);
+                ++target.dropped;
+            }
+        }
+        if (target.size == 0 && target.idle.empty() && target.connecting == 0) {
+            it = _targets.erase(it);
+            continue;
+        }
+        refill(it->first, target);
+        ++it;
+    }
+    if (!_targets.empty()) {
+        arm();
+    }
+}
+
+bool TcpConnectionPool::isHealthy(boost::asio::ip::tcp::socket &socket) {
+    if (!socket.is_open()) {
+        return false;
+    }
+    char byte;
+    ssize_t received = ::recv(socket.native_handle(), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return received > 0 || (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "rapidjson/document.h"
+
+class TcpFace;
+
+// connections kept open to the downstream endpoints a module links to, so that a face added to one or a session
+// started towards it takes a connection already past its handshake instead of connecting then, 2s at most. the pool
+// refills itself in the background and checks its idle connections every CHECK_INTERVAL_MS, those the peer closed are
+// dropped. an endpoint without connections ready, or not pooled, gets a TcpFace connecting itself as before
+//
+// the faces may be taken from any thread, each connection moves to the io_service of its face
+class TcpConnectionPool {
+public:
+    static const size_t CHECK_INTERVAL_MS = 1000;
+
+private:
+    struct Target {
+        size_t size = 0;
+        std::deque<std::unique_ptr<boost::asio::ip::tcp::socket>> idle;
+        size_t connecting = 0;
+        // faces given a connection of the pool or connecting themselves, connects which failed, idle connections
+        // found closed
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t failures = 0;
+        uint64_t dropped = 0;
+    };
+
+    boost::asio::io_service &_ios;
+    boost::asio::deadline_timer _timer;
+    mutable std::mutex _mutex;
+    std::map<boost::asio::ip::tcp::endpoint, Target> _targets;
+    bool _is_armed = false;
+
+public:
+    explicit TcpConnectionPool(boost::asio::io_service &ios);
+
+    // size connections kept open to endpoint, 0 closes those idle
+    void setSize(const boost::asio::ip::tcp::endpoint &endpoint, size_t size);
+
+    // {"address", "port", "size"} or an array of them, false and nothing changed if one of them is invalid
+    bool update(const rapidjson::Value &value);
+
+    // on ios, over a connection of the pool to address:port if one is ready. throws as TcpFace on an invalid address
+    std::shared_ptr<TcpFace> makeFace(boost::asio::io_service &ios, const std::string &address, uint16_t port);
+
+    // [{"endpoint", "size", "idle", "connecting", "hits", "misses", "failures", "dropped"}]
+    std::string toJSON() const;
+
+private:
+    // _mutex must be held
+    void refill(const boost::asio::ip::tcp::endpoint &endpoint, Target &target);
+
+    void connect(const boost::asio::ip::tcp::endpoint &endpoint);
+
+    // _mutex must be held
+    void arm();
+
+    void check(const boost::system::error_code &err);
+
+    // false once the peer closed it or it failed, data already received doesn't count against it
+    static bool isHealthy(boost::asio::ip::tcp::socket &socket);
+};
\ No newline at end of file
@@ -0,0 +1,764 @@
+#include "tcp_face.h"
+
+#include <boost/bind.hpp>
+
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include "tlv_reader.h"
+#include "../log/logger.h"
+#include "../metrics/stage_profile.h"
+
+std::atomic<size_t> TcpFace::_max_packet_size(TcpFace::NDN_MAX_PACKET_SIZE);
+std::atomic<size_t> TcpFace::_gather_max_bytes(1 << 16);
+std::atomic<size_t> TcpFace::_gather_max_packets(64);
+std::atomic<int> TcpFace::_flush_policy(TcpFace::NAGLE);
+std::atomic<size_t> TcpFace::_reconnect_min_delay(5);
+std::atomic<size_t> TcpFace::_reconnect_max_delay(1000);
+std::atomic<size_t> TcpFace::_reconnect_attempts(10);
+std::atomic<size_t> TcpFace::_replay_max_age(1000);
+std::atomic<size_t> TcpFace::_credit_window(0);
+std::atomic<int> TcpFace::_credit_policy(TcpFace::PAUSE);
+std::atomic<size_t> TcpFace::_backlog(0);
+
+// bound to a reference by boost::posix_time
+const size_t TcpFace::CONNECT_TIMEOUT_MS;
+
+TcpFace::TcpFace(boost::asio::io_service &ios, std::string host, uint16_t port)
+        : Face(ios)
+        , _skip_connect(false)
+        , _endpoint(boost::asio::ip::address::from_string(host), port)
+        , _socket(ios)
+        , _strand(ios)
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _chunk(std::make_shared<ndn::Buffer>(BUFFER_SIZE))
+        , _socket_options(SocketOptions::getDefault())
+        , _credit_timer(ios)
+        , _timer(ios) {
+}
+
+TcpFace::TcpFace(boost::asio::io_service &ios, const boost::asio::ip::tcp::endpoint &endpoint)
+        : Face(ios)
+        , _skip_connect(false)
+        , _endpoint(endpoint)
+        , _socket(ios)
+        , _strand(ios)
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _chunk(std::make_shared<ndn::Buffer>(BUFFER_SIZE))
+        , _socket_options(SocketOptions::getDefault())
+        , _credit_timer(ios)
+        , _timer(ios) {
+}
+
+TcpFace::TcpFace(boost::asio::ip::tcp::socket &&socket)
+        : Face(socket.get_io_service())
+        , _skip_connect(true)
+        , _endpoint(socket.remote_endpoint())
+        , _socket(std::move(socket))
+        , _strand(socket.get_io_service())
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _chunk(std::make_shared<ndn::Buffer>(BUFFER_SIZE))
+        , _credit_timer(socket.get_io_service())
+        , _timer(socket.get_io_service()) {
+
+}
+
+TcpFace::TcpFace(boost::asio::ip::tcp::socket &&socket, const boost::asio::ip::tcp::endpoint &endpoint)
+        : Face(socket.get_io_service())
+        , _skip_connect(false)
+        , _endpoint(endpoint)
+        , _socket(std::move(socket))
+        , _strand(socket.get_io_service())
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _chunk(std::make_shared<ndn::Buffer>(BUFFER_SIZE))
+        , _socket_options(SocketOptions::getDefault())
+        , _credit_timer(socket.get_io_service())
+        , _timer(socket.get_io_service()) {
+    // open() reads at once instead of connecting
+    _is_connected = true;
+}
+
+TcpFace::~TcpFace() {
+    _backlog -= _queue.size() + _held.size();
+}
+
+size_t TcpFace::getMaxPacketSize() {
+    return _max_packet_size;
+}
+
+bool TcpFace::setMaxPacketSize(size_t size) {
+    if (size == 0 || size > MAX_PACKET_SIZE_LIMIT) {
+        return false;
+    }
+    _max_packet_size = size;
+    return true;
+}
+
+size_t TcpFace::getGatherMaxBytes() {
+    return _gather_max_bytes;
+}
+
+void TcpFace::setGatherMaxBytes(size_t max_bytes) {
+    _gather_max_bytes = max_bytes;
+}
+
+size_t TcpFace::getGatherMaxPackets() {
+    return _gather_max_packets;
+}
+
+void TcpFace::setGatherMaxPackets(size_t max_packets) {
+    _gather_max_packets = std::max<size_t>(max_packets, 1);
+}
+
+std::string TcpFace::getFlushPolicy() {
+    switch (_flush_policy) {
+        case NODELAY:
+            return "nodelay";
+        case CORK:
+            return "cork";
+        default:
+            return "nagle";
+    }
+}
+
+bool TcpFace::setFlushPolicy(const std::string &policy) {
+    static const std::unordered_map<std::string, FlushPolicy> POLICIES = {
+            {"nagle", NAGLE},
+            {"nodelay", NODELAY},
+            {"cork", CORK},
+    };
+
+    auto it = POLICIES.find(policy);
+    if (it == POLICIES.end()) {
+        return false;
+    }
+    _flush_policy = it->second;
+    return true;
+}
+
+size_t TcpFace::getReconnectMinDelay() {
+    return _reconnect_min_delay;
+}
+
+void TcpFace::setReconnectMinDelay(size_t delay) {
+    _reconnect_min_delay = std::max<size_t>(delay, 1);
+}
+
+size_t TcpFace::getReconnectMaxDelay() {
+    return _reconnect_max_delay;
+}
+
+void TcpFace::setReconnectMaxDelay(size_t delay) {
+    _reconnect_max_delay = std::max<size_t>(delay, 1);
+}
+
+size_t TcpFace::getReconnectAttempts() {
+    return _reconnect_attempts;
+}
+
+void TcpFace::setReconnectAttempts(size_t attempts) {
+    _reconnect_attempts = attempts;
+}
+
+size_t TcpFace::getReplayMaxAge() {
+    return _replay_max_age;
+}
+
+void TcpFace::setReplayMaxAge(size_t max_age) {
+    _replay_max_age = max_age;
+}
+
+size_t TcpFace::getCreditWindow() {
+    return _credit_window;
+}
+
+void TcpFace::setCreditWindow(size_t window) {
+    _credit_window = window;
+}
+
+std::string TcpFace::getCreditPolicy() {
+    return _credit_policy == SHED ? "shed" : "pause";
+}
+
+bool TcpFace::setCreditPolicy(const std::string &policy) {
+    if (policy == "pause") {
+        _credit_policy = PAUSE;
+    } else if (policy == "shed") {
+        _credit_policy = SHED;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string TcpFace::getUnderlyingProtocol() const {
+    return "TCP";
+}
+
+std::string TcpFace::getUnderlyingEndpoint() const {
+    std::stringstream ss;
+    ss << _endpoint;
+    return ss.str();
+}
+
+std::string TcpFace::getState() const {
+    return _is_reconnecting ? "reconnecting" : Face::getState();
+}
+
+void TcpFace::open(const InterestCallback &interest_callback,
+                   const DataCallback &data_callback,
+                   const ErrorCallback &error_callback) {
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    _uring = UringService::get(_ios);
+    if(!_skip_connect && !_is_connected) {
+        connect();
+    } else {
+        _is_connected = true;
+        read();
+    }
+}
+
+void TcpFace::close() {
+    _is_connected = false;
+    _is_reconnecting = false;
+    _timer.cancel();
+    _credit_timer.cancel();
+    cancelUringReceive();
+    _socket.close();
+}
+
+void TcpFace::send(const std::string &message) {
+    send(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void TcpFace::send(const ndn::Interest &interest) {
+    send(getWireBuffer(interest.wireEncode()));
+}
+
+void TcpFace::send(const ndn::Data &data) {
+    send(getWireBuffer(data.wireEncode()));
+}
+
+void TcpFace::send(const std::shared_ptr<const ndn::Buffer> &wire) {
+    if (!_inbox.emplace(wire)) {
+        // the inbox only absorbs bursts between two drains, the egress queue applies the real limits
+        _strand.post(boost::bind(&TcpFace::sendImpl, shared_from_this(), wire));
+        return;
+    }
+    if (!_is_draining.exchange(true)) {
+        _strand.post(boost::bind(&TcpFace::drainInbox, shared_from_this()));
+    }
+}
+
+QueueStats TcpFace::getQueueStats() const {
+    QueueStats stats = _queue.getStats();
+    const QueueStats &held = _held.getStats();
+    stats.packets += held.packets;
+    stats.bytes += held.bytes;
+    stats.dropped_interests += held.dropped_interests;
+    stats.expired_interests += held.expired_interests;
+    stats.shed_interests = _shed_interests;
+    return stats;
+}
+
+const LatencyHistogram* TcpFace::getQueueLatency() const {
+    return &_queue.getLatency();
+}
+
+size_t TcpFace::getBufferBytes() const {
+    // the read chunk, moved to a new one when a packet still points into it
+    return _chunk_size;
+}
+
+void TcpFace::setSocketOptions(const SocketOptions &options) {
+    _socket_options = options;
+    if (_socket.is_open()) {
+        _socket_options.apply(_socket.native_handle());
+    }
+}
+
+void TcpFace::openSocket() {
+    // the buffers must be sized before the handshake for the window scale to follow them
+    boost::system::error_code ec;
+    _socket.open(_endpoint.protocol(), ec);
+    if (!ec) {
+        _socket_options.apply(_socket.native_handle());
+    }
+}
+
+void TcpFace::connect() {
+    _timer.expires_from_now(boost::posix_time::seconds(2));
+    _timer.async_wait(_strand.wrap(boost::bind(&TcpFace::timerHandler, shared_from_this(), _1)));
+    openSocket();
+    _socket.async_connect(_endpoint, _strand.wrap(boost::bind(&TcpFace::connectHandler, shared_from_this(), _1)));
+}
+
+void TcpFace::connectHandler(const boost::system::error_code &err) {
+    _timer.cancel();
+    if (!err) {
+        logger::log(logger::INFO, "TCP face with ID = {} successfully connected to tcp://{}", {_face_id, _endpoint});
+        _is_connected = true;
+        read();
+    } else {
+        logger::log(logger::ERROR, "failed to connect to {}", {_endpoint});
+        _error_callback(shared_from_this());
+    }
+}
+
+void TcpFace::reconnect() {
+    logger::log(logger::INFO, "try to reconnect to {} (attempt {})", {_endpoint, _reconnect_attempt + 1});
+    cancelUringReceive();
+    _socket.close();
+    // a partially received packet can't be completed by the new connection
+    _chunk_begin = _chunk_end = 0;
+    _discard = 0;
+    // options are lost with the old socket
+    _socket_flush_policy = -1;
+    _corked = false;
+    _is_connecting = true;
+    _timer.expires_from_now(boost::posix_time::milliseconds(CONNECT_TIMEOUT_MS));
+    _timer.async_wait(_strand.wrap(boost::bind(&TcpFace::connectTimeoutHandler, shared_from_this(), _1)));
+    openSocket();
+    _socket.async_connect(_endpoint, _strand.wrap(boost::bind(&TcpFace::reconnectHandler, shared_from_this(), _1)));
+}
+
+void TcpFace::reconnectHandler(const boost::system::error_code &err) {
+    _is_connecting = false;
+    _timer.cancel();
+    if (!_is_connected) {
+        // closed meanwhile
+        return;
+    }
+    if(!err) {
+        logger::log(logger::INFO, "TCP face with ID = {} reconnected to tcp://{}", {_face_id, _endpoint});
+        _counters.reconnects.add(1);
+        _is_reconnecting = false;
+        // the credits are those of the peer on the new connection, the Interests replayed aren't counted
+        _interests_received = 0;
+        _credit_granted = 0;
+        _credit_limit = 0;
+        const QueueStats &stats = _queue.getStats();
+        _credit_base = _interests_queued - stats.dropped_interests - stats.expired_interests;
+        read();
+        replay();
+        releaseHeld();
+    } else if (++_reconnect_attempt < _reconnect_attempts) {
+        // 2^attempt times the minimal delay, the shift is bounded so it can't overflow
+        size_t delay = std::min<size_t>(_reconnect_min_delay << std::min<size_t>(_reconnect_attempt - 1, 20), _reconnect_max_delay);
+        logger::log(logger::INFO, "wait {}ms before next reconnection to {}", {delay, _endpoint});
+        _timer.expires_from_now(boost::posix_time::milliseconds(delay));
+        _timer.async_wait(_strand.wrap(boost::bind(&TcpFace::reconnectTimerHandler, shared_from_this(), _1)));
+    } else {
+        logger::log(logger::ERROR, "failed to reconnect to {}", {_endpoint});
+        _is_reconnecting = false;
+        _error_callback(shared_from_this());
+    }
+}
+
+void TcpFace::reconnectTimerHandler(const boost::system::error_code &err) {
+    if (!err && _is_connected) {
+        reconnect();
+    }
+}
+
+void TcpFace::connectTimeoutHandler(const boost::system::error_code &err) {
+    // the connect handler may already be queued when the timer expires
+    if (!err && _is_connecting) {
+        // aborts the pending connect, its handler moves on to the next attempt
+        boost::system::error_code ec;
+        _socket.close(ec);
+    }
+}
+
+void TcpFace::replay() {
+    size_t max_age = _replay_max_age;
+    if (max_age > 0) {
+        size_t queued = _queue.size() + _held.size();
+        _queue.expireInterests(std::chrono::milliseconds(max_age));
+        updateBacklog(queued);
+    }
+    // the write pending when the connection was lost never completed, its packets are still at the front
+    _write_buffers.clear();
+    _queue_in_use = !_queue.empty();
+    if (_queue_in_use) {
+        write();
+    }
+}
+
+void TcpFace::read() {
+    if (_uring) {
+        if (!_uring_receive) {
+            _uring_receive = _uring->receive(_socket.native_handle(), false,
+                                             boost::bind(&TcpFace::onUringReceive, shared_from_this(), _1, _2),
+                                             boost::bind(&TcpFace::onUringError, shared_from_this(), _1));
+        }
+        return;
+    }
+    read(LoopHandler<TcpFace>(shared_from_this(), &TcpFace::readHandler, _read_memory));
+}
+
+void TcpFace::read(LoopHandler<TcpFace> &&handler) {
+    boost::asio::async_read(_socket, boost::asio::buffer(_chunk->data() + _chunk_end, _chunk->size() - _chunk_end),
+                            boost::asio::transfer_at_least(1), std::move(handler));
+}
+
+void TcpFace::readHandler(LoopHandler<TcpFace> &&handler, const boost::system::error_code &err, size_t bytes_transferred) {
+    if(!err) {
+        proceedChunk(bytes_transferred);
+        read(std::move(handler));
+    } else {
+        onReadError();
+    }
+}
+
+void TcpFace::onUringReceive(const uint8_t *data, size_t size) {
+    // the chunk always keeps room for a whole packet, a large receive is parsed in several steps
+    while (size > 0) {
+        size_t length = std::min(size, _chunk->size() - _chunk_end);
+        std::memcpy(_chunk->data() + _chunk_end, data, length);
+        proceedChunk(length);
+        data += length;
+        size -= length;
+    }
+}
+
+void TcpFace::onUringError(int error) {
+    _uring_receive = 0;
+    onReadError();
+}
+
+void TcpFace::cancelUringReceive() {
+    if (_uring_receive) {
+        _uring->cancel(_uring_receive);
+        _uring_receive = 0;
+    }
+}
+
+void TcpFace::proceedChunk(size_t bytes_transferred) {
+    _chunk_end += bytes_transferred;
+    const uint8_t *begin = _chunk->data();
+    const uint8_t *current = begin + _chunk_begin;
+    const uint8_t *end = begin + _chunk_end;
+    if (_discard > 0) {
+        size_t length = std::min<size_t>(_discard, end - current);
+        current += length;
+        _discard -= length;
+    }
+    size_t max_size = _max_packet_size;
+    while (current < end) {
+        // the bytes which can't start a packet are skipped, the stream resyncs on the next one
+        if (!tlv_reader::isPacketStart(current[0])) {
+            current = tlv_reader::findPacketStart(current, end);
+            continue;
+        }
+        size_t size = 0;
+        auto frame = tlv_reader::frame(current, end, max_size, size);
+        if (frame == tlv_reader::PARTIAL) {
+            // kept from _chunk_begin until the rest of it is received, its size is known once its header is
+            _largest_packet = std::max(_largest_packet, size);
+            break;
+        } else if (frame == tlv_reader::OVERSIZED) {
+            if (size == 0 || size > MAX_PACKET_SIZE_LIMIT) {
+                // a length no peer would send, rather a byte which looked like the start of a packet
+                ++current;
+                continue;
+            }
+            logger::log(logger::WARNING, "dropped a packet of {} bytes from {}, the maximum is {}", {size, _endpoint, max_size});
+            size_t length = std::min<size_t>(size, end - current);
+            current += length;
+            _discard = size - length;
+            continue;
+        }
+        try {
+            // the block is a view on the chunk, no copy is made
+            auto it = _chunk->cbegin() + (current - begin);
+            ndn::Block block(_chunk, it, it + size);
+            uint64_t limit;
+            if (current[0] != LpLink::LP_PACKET) {
+                if (current[0] == ndn::tlv::Interest) {
+                    ++_interests_received;
+                }
+                deliver(shared_from_this(), block);
+            } else if (LpLink::readCredit(current, size, limit)) {
+                _strand.post(boost::bind(&TcpFace::onCredit, shared_from_this(), limit));
+            } else {
+                // links from NFD may wrap packets in LpPackets
+                ndn::Block packet;
+                if (_reassembler.receive(block, packet)) {
+                    if (packet.type() == ndn::tlv::Interest) {
+                        ++_interests_received;
+                    }
+                    deliver(shared_from_this(), packet, packet.getBuffer() == block.getBuffer() ? &block : nullptr);
+                }
+            }
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << std::endl;
+        }
+        current += size;
+    }
+    flushBurst(shared_from_this());
+    if (_credit_window > 0 || _credit_granted > 0) {
+        grantCredits();
+    }
+    _chunk_begin = current - begin;
+    if (_chunk->size() - _chunk_end < _largest_packet) {
+        rotateChunk();
+    }
+}
+
+void TcpFace::onReadError() {
+    if(!_skip_connect && _is_connected) {
+        logger::log(logger::WARNING, "lost connection to {}", {_endpoint});
+        if (!_is_reconnecting) {
+            _is_reconnecting = true;
+            _reconnect_attempt = 0;
+            reconnect();
+        }
+    } else {
+        _error_callback(shared_from_this());
+    }
+}
+
+void TcpFace::rotateChunk() {
+    size_t leftover = _chunk_end - _chunk_begin;
+    size_t chunk_size = BUFFER_SIZE;
+    while (chunk_size < 4 * _largest_packet) {
+        chunk_size <<= 1;
+    }
+    chunk_size = std::max(chunk_size, _chunk->size());
+    if (_chunk.use_count() == 1 && chunk_size == _chunk->size()) {
+        // no packet still references the chunk, so it can be reused
+        std::memmove(_chunk->data(), _chunk->data() + _chunk_begin, leftover);
+    } else {
+        // only the partial packet at the end of the chunk is copied, the chunk is released with its last packet
+        auto chunk = std::make_shared<ndn::Buffer>(chunk_size);
+        _chunk_size = chunk_size;
+        std::copy(_chunk->begin() + _chunk_begin, _chunk->begin() + _chunk_end, chunk->begin());
+        _chunk = std::move(chunk);
+    }
+    _chunk_begin = 0;
+    _chunk_end = leftover;
+}
+
+void TcpFace::drainInbox() {
+    for (;;) {
+        while (std::shared_ptr<const ndn::Buffer> *wire = _inbox.peek(0)) {
+            std::shared_ptr<const ndn::Buffer> buffer = std::move(*wire);
+            _inbox.pop();
+            sendImpl(buffer);
+        }
+        // a sender may have pushed after the last peek but seen the inbox as still being drained
+        _is_draining = false;
+        if (!_inbox.peek(0) || _is_draining.exchange(true)) {
+            return;
+        }
+    }
+}
+
+void TcpFace::sendImpl(std::shared_ptr<const ndn::Buffer> &buffer) {
+    stage_profile::Scope stage(stage_profile::SEND);
+    countOut(buffer);
+    size_t queued = _queue.size() + _held.size();
+    if (!buffer->empty() && buffer->front() == ndn::tlv::Interest) {
+        // behind those already held, so that the Interests keep their order
+        if (!_held.empty() || !hasCredit()) {
+            if (_credit_policy == SHED) {
+                ++_shed_interests;
+            } else {
+                _held.push(std::move(buffer), 0);
+                updateBacklog(queued);
+            }
+            return;
+        }
+        ++_interests_queued;
+    }
+    // packets of the pending gather write can't be dropped
+    bool is_queued = _queue.push(std::move(buffer), _queue_in_use ? _write_buffers.size() : 0);
+    updateBacklog(queued);
+    if (!is_queued) {
+        return;
+    }
+    // packets queued while reconnecting are written by replay()
+    if (_queue_in_use || _is_reconnecting) {
+        return;
+    }
+
+    _queue_in_use = true;
+    write();
+}
+
+void TcpFace::applyFlushPolicy() {
+    int policy = _flush_policy;
+    if (policy != _socket_flush_policy) {
+        boost::system::error_code ec;
+        _socket.set_option(boost::asio::ip::tcp::no_delay(policy == NODELAY), ec);
+        if (_corked && policy != CORK) {
+            int value = 0;
+            ::setsockopt(_socket.native_handle(), IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+            _corked = false;
+        }
+        _socket_flush_policy = policy;
+    }
+    if (policy == CORK && !_corked) {
+        int value = 1;
+        _corked = ::setsockopt(_socket.native_handle(), IPPROTO_TCP, TCP_CORK, &value, sizeof(value)) == 0;
+    }
+}
+
+void TcpFace::write() {
+    write(LoopHandler<TcpFace>(shared_from_this(), &TcpFace::writeHandler, _write_memory));
+}
+
+void TcpFace::write(LoopHandler<TcpFace> &&handler) {
+    // the Interests nobody waits for any more, e.g. queued during a reconnection or behind a backlog, aren't sent
+    size_t queued = _queue.size() + _held.size();
+    if (_queue.dropExpired(std::max<size_t>(_gather_max_packets, 1)) > 0) {
+        updateBacklog(queued);
+        if (_queue.empty()) {
+            stopWriting();
+            return;
+        }
+    }
+    applyFlushPolicy();
+    // gather as many queued packets as allowed in a single write, at least one even if it is larger than the limit
+    size_t max_bytes = _gather_max_bytes;
+    size_t max_packets = _gather_max_packets;
+    size_t bytes = 0;
+    _write_buffers.clear();
+    for (const auto &buffer : _queue) {
+        if (!_write_buffers.empty() && (_write_buffers.size() >= max_packets || bytes + buffer->size() > max_bytes)) {
+            break;
+        }
+        _write_buffers.emplace_back(buffer->data(), buffer->size());
+        bytes += buffer->size();
+    }
+    boost::asio::async_write(_socket, _write_buffers, _strand.wrap(std::move(handler)));
+}
+
+void TcpFace::writeHandler(LoopHandler<TcpFace> &&handler, const boost::system::error_code &err, size_t bytesTransferred) {
+    stage_profile::Scope stage(stage_profile::SEND);
+    if(!err) {
+        for (size_t i = 0; i < _write_buffers.size(); ++i) {
+            _queue.pop_front();
+        }
+        _backlog -= _write_buffers.size();
+        _write_buffers.clear();
+
+        if (!_queue.empty()) {
+            write(std::move(handler));
+        } else {
+            stopWriting();
+        }
+    }
+}
+
+void TcpFace::stopWriting() {
+    _queue_in_use = false;
+    if (_corked) {
+        // nothing left to gather, push out the last partial segment
+        int value = 0;
+        ::setsockopt(_socket.native_handle(), IPPROTO_TCP, TCP_CORK, &value, sizeof(value));
+        _corked = false;
+    }
+}
+
+void TcpFace::timerHandler(const boost::system::error_code &err) {
+    if (!err) {
+        _error_callback(shared_from_this());
+    }
+}
+
+void TcpFace::updateBacklog(size_t queued) {
+    size_t now = _queue.size() + _held.size();
+    if (now > queued) {
+        _backlog += now - queued;
+    } else {
+        _backlog -= queued - now;
+    }
+}
+
+void TcpFace::grantCredits() {
+    static const uint64_t UNLIMITED = std::numeric_limits<uint64_t>::max();
+
+    size_t window = _credit_window;
+    uint64_t granted = _credit_granted;
+    uint64_t received = _interests_received;
+    uint64_t limit;
+    if (window == 0) {
+        // the peer was told before, it is let go for good
+        if (granted == 0 || granted == UNLIMITED) {
+            return;
+        }
+        limit = UNLIMITED;
+    } else {
+        // the module only takes more Interests as its own queues have room for them
+        size_t backlog = _backlog;
+        limit = received + (backlog < window ? window - backlog : 0);
+        bool may_be_out = received >= granted;
+        if (granted != UNLIMITED && limit < granted + std::max<size_t>(window / 4, 1) && !(may_be_out && limit > received)) {
+            if (may_be_out && !_is_credit_timer_armed.exchange(true)) {
+                // nothing more may come to read, the grant waits for the backlog to go down
+                _credit_timer.expires_from_now(boost::posix_time::milliseconds(CREDIT_RETRY_MS));
+                _credit_timer.async_wait(boost::bind(&TcpFace::creditTimerHandler, shared_from_this(), _1));
+            }
+            return;
+        }
+    }
+    // the read handlers and the timer may both be here
+    if (_credit_granted.compare_exchange_strong(granted, limit)) {
+        send(LpLink::credit(limit));
+    }
+}
+
+void TcpFace::creditTimerHandler(const boost::system::error_code &err) {
+    _is_credit_timer_armed = false;
+    if (!err && _is_connected) {
+        grantCredits();
+    }
+}
+
+bool TcpFace::hasCredit() const {
+    if (_credit_limit == 0) {
+        return true;
+    }
+    const QueueStats &stats = _queue.getStats();
+    return _interests_queued - stats.dropped_interests - stats.expired_interests - _credit_base < _credit_limit;
+}
+
+void TcpFace::onCredit(uint64_t limit) {
+    // in the order sent, a grant only goes down when the peer starts counting again
+    _credit_limit = limit;
+    releaseHeld();
+}
+
+void TcpFace::releaseHeld() {
+    if (_held.empty()) {
+        return;
+    }
+    size_t queued = _queue.size() + _held.size();
+    while (!_held.empty() && hasCredit()) {
+        // those which expired while held aren't given to _queue, which would take them for new ones
+        if (_held.dropExpired(1) > 0 && _held.empty()) {
+            break;
+        }
+        std::shared_ptr<const ndn::Buffer> buffer = std::move(_held.front());
+        _held.pop_front();
+        ++_interests_queued;
+        _queue.push(std::move(buffer), _queue_in_use ? _write_buffers.size() : 0);
+    }
+    updateBacklog(queued);
+    if (!_queue_in_use && !_is_reconnecting && !_queue.empty()) {
+        _queue_in_use = true;
+        write();
+    }
+}
\ No newline at end of file
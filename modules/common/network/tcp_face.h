@@ -0,0 +1,274 @@
+#pragma once
+
+#include "face.h"
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <deque>
+#include <vector>
+
+#include "loop_handler.h"
+#include "lp_link.h"
+#include "mpsc_queue.h"
+#include "uring_service.h"
+
+class TcpFace : public Face, public std::enable_shared_from_this<TcpFace> {
+public:
+    // default of the largest packet received, raised with setMaxPacketSize for bulk transfers
+    static const size_t NDN_MAX_PACKET_SIZE = 8800;
+    static const size_t MAX_PACKET_SIZE_LIMIT = 1 << 22; // 4M
+    // size of the read chunk of a face until it sees packets too large for it
+    static const size_t BUFFER_SIZE = 1 << 15; // 32k
+    static const size_t INBOX_SIZE = 1 << 6;
+    static const size_t CONNECT_TIMEOUT_MS = 2000;
+    // a receiver which couldn't grant anything to a sender out of credits looks at its backlog again after that
+    static const size_t CREDIT_RETRY_MS = 10;
+
+    // how packets still in the kernel are flushed between two gather writes
+    enum FlushPolicy {
+        NAGLE,   // default socket behavior
+        NODELAY, // TCP_NODELAY, every write goes out immediately
+        CORK,    // TCP_CORK while the queue is not empty, only full segments are sent until it drains
+    };
+
+    // what a sender does with the Interests beyond the credits the receiver granted
+    enum CreditPolicy {
+        PAUSE, // they wait in a queue of their own, under the limits and the drop policy of the egress queues
+        SHED,  // they are dropped
+    };
+
+private:
+    // shared by all TCP faces, editable at runtime through edit_config
+    static std::atomic<size_t> _max_packet_size;
+    static std::atomic<size_t> _gather_max_bytes;
+    static std::atomic<size_t> _gather_max_packets;
+    static std::atomic<int> _flush_policy;
+    // reconnection after a lost connection, delays in ms double from min to max between attempts
+    static std::atomic<size_t> _reconnect_min_delay;
+    static std::atomic<size_t> _reconnect_max_delay;
+    static std::atomic<size_t> _reconnect_attempts;
+    // Interests queued for longer than that when the connection is back are dropped rather than replayed, 0 keeps them
+    static std::atomic<size_t> _replay_max_age;
+    // Interests a receiver lets its peer send ahead, 0 grants nothing and the peer sends freely
+    static std::atomic<size_t> _credit_window;
+    static std::atomic<int> _credit_policy;
+    // packets in the egress queues of all the TCP faces of the process, the part of the window it can't grant
+    static std::atomic<size_t> _backlog;
+
+    bool _skip_connect;
+
+    boost::asio::ip::tcp::endpoint _endpoint;
+    boost::asio::ip::tcp::socket _socket;
+    boost::asio::strand _strand;
+    // senders from any thread push here without the strand, only the one which finds it idle posts drainInbox()
+    MpscQueue<std::shared_ptr<const ndn::Buffer>> _inbox;
+    std::atomic<bool> _is_draining;
+    // packets are parsed in place, the Blocks given to callbacks share ownership of the chunk they come from
+    std::shared_ptr<ndn::Buffer> _chunk;
+    size_t _chunk_begin = 0;
+    size_t _chunk_end = 0;
+    // the room kept at the end of the chunk, the largest packet seen so far, the chunk grows to four times that
+    size_t _largest_packet = NDN_MAX_PACKET_SIZE;
+    std::atomic<size_t> _chunk_size{BUFFER_SIZE};
+    // bytes left of an oversized packet, skipped as they are received
+    size_t _discard = 0;
+    LpReassembler _reassembler;
+    bool _queue_in_use = false;
+    EgressQueue<std::shared_ptr<const ndn::Buffer>> _queue;
+    // queued packets submitted by the pending gather write
+    std::vector<boost::asio::const_buffer> _write_buffers;
+    int _socket_flush_policy = -1;
+    // applied again to the socket of each reconnection
+    SocketOptions _socket_options;
+    bool _corked = false;
+    // of the pending read and write, reused by each next one
+    HandlerMemory _read_memory;
+    HandlerMemory _write_memory;
+    // io_uring backend, received bytes are copied in the chunk and parsed the same way
+    std::shared_ptr<UringService> _uring;
+    uint64_t _uring_receive = 0;
+
+    // as a receiver, from the read handlers and the credit timer: the Interests received on the connection and the
+    // number the peer was allowed to send in all, UINT64_MAX once the window was set to 0 after some grants
+    std::atomic<uint64_t> _interests_received{0};
+    std::atomic<uint64_t> _credit_granted{0};
+    boost::asio::deadline_timer _credit_timer;
+    std::atomic<bool> _is_credit_timer_armed{false};
+    // as a sender, on the strand: the last grant of the peer, 0 until it sends one. the Interests sent are those
+    // given to _queue which it didn't drop, since _credit_base was taken at the start of the connection
+    uint64_t _credit_limit = 0;
+    uint64_t _interests_queued = 0;
+    uint64_t _credit_base = 0;
+    // the Interests paused for lack of credits, in order
+    EgressQueue<std::shared_ptr<const ndn::Buffer>> _held;
+    uint64_t _shed_interests = 0;
+
+    boost::asio::deadline_timer _timer;
+    bool _is_reconnecting = false;
+    bool _is_connecting = false;
+    size_t _reconnect_attempt = 0;
+
+public:
+    // use these when creating a face yourself
+    TcpFace(boost::asio::io_service &ios, std::string host, uint16_t port);
+
+    TcpFace(boost::asio::io_service &ios, const boost::asio::ip::tcp::endpoint &endpoint);
+
+    // specific constructor for MasterFace, not recommended to use it yourself
+    explicit TcpFace(boost::asio::ip::tcp::socket &&socket);
+
+    // over a connection already open to endpoint, e.g. by a TcpConnectionPool, then reconnected to it as the others
+    TcpFace(boost::asio::ip::tcp::socket &&socket, const boost::asio::ip::tcp::endpoint &endpoint);
+
+    ~TcpFace() override;
+
+    static size_t getMaxPacketSize();
+
+    // for the packets received by all TCP faces, those larger are dropped whole, return false if size is 0 or above
+    // MAX_PACKET_SIZE_LIMIT
+    static bool setMaxPacketSize(size_t size);
+
+    static size_t getGatherMaxBytes();
+
+    static void setGatherMaxBytes(size_t max_bytes);
+
+    static size_t getGatherMaxPackets();
+
+    static void setGatherMaxPackets(size_t max_packets);
+
+    static std::string getFlushPolicy();
+
+    // return false if the policy is unknown
+    static bool setFlushPolicy(const std::string &policy);
+
+    static size_t getReconnectMinDelay();
+
+    static void setReconnectMinDelay(size_t delay);
+
+    static size_t getReconnectMaxDelay();
+
+    static void setReconnectMaxDelay(size_t delay);
+
+    static size_t getReconnectAttempts();
+
+    static void setReconnectAttempts(size_t attempts);
+
+    static size_t getReplayMaxAge();
+
+    static void setReplayMaxAge(size_t max_age);
+
+    static size_t getCreditWindow();
+
+    // on the faces of both ends for the grants to be sent and followed, the peers which don't know the credits, e.g.
+    // NFD, ignore them. changed at runtime, the senders already told are freed from the credits with a last grant
+    static void setCreditWindow(size_t window);
+
+    static std::string getCreditPolicy();
+
+    // "pause" or "shed", return false if the policy is unknown
+    static bool setCreditPolicy(const std::string &policy);
+
+    std::string getUnderlyingProtocol() const override;
+
+    std::string getUnderlyingEndpoint() const override;
+
+    std::string getState() const override;
+
+    using Face::open;
+
+    void open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+    void close() override;
+
+    using Face::send;
+
+    void send(const std::string &message) override;
+
+    void send(const ndn::Interest &interest) override;
+
+    void send(const ndn::Data &data) override;
+
+    void send(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+    QueueStats getQueueStats() const override;
+
+    const LatencyHistogram* getQueueLatency() const override;
+
+    size_t getBufferBytes() const override;
+
+    void setSocketOptions(const SocketOptions &options) override;
+
+private:
+    void openSocket();
+
+    void connect();
+
+    void connectHandler(const boost::system::error_code &err);
+
+    void reconnect();
+
+    void reconnectHandler(const boost::system::error_code &err);
+
+    void reconnectTimerHandler(const boost::system::error_code &err);
+
+    void connectTimeoutHandler(const boost::system::error_code &err);
+
+    // queued packets are written again on the new connection
+    void replay();
+
+    // nothing left to write, until the next packet queued
+    void stopWriting();
+
+    void read();
+
+    // the next read of the loop handler belongs to
+    void read(LoopHandler<TcpFace> &&handler);
+
+    void readHandler(LoopHandler<TcpFace> &&handler, const boost::system::error_code &err, size_t bytes_transferred);
+
+    void onUringReceive(const uint8_t *data, size_t size);
+
+    void onUringError(int error);
+
+    void cancelUringReceive();
+
+    // parses the packets completed by the bytes_transferred bytes just written at the end of the chunk
+    void proceedChunk(size_t bytes_transferred);
+
+    void onReadError();
+
+    void rotateChunk();
+
+    void drainInbox();
+
+    void sendImpl(std::shared_ptr<const ndn::Buffer> &buffer);
+
+    void applyFlushPolicy();
+
+    void write();
+
+    void write(LoopHandler<TcpFace> &&handler);
+
+    void writeHandler(LoopHandler<TcpFace> &&handler, const boost::system::error_code &err, size_t bytesTransferred);
+
+    void timerHandler(const boost::system::error_code &err);
+
+    // with the packets of _queue and _held as they were before a change of either
+    void updateBacklog(size_t queued);
+
+    // as a receiver, the grant is sent when it moved by a quarter of the window or the peer may be out of credits
+    void grantCredits();
+
+    void creditTimerHandler(const boost::system::error_code &err);
+
+    // as a sender, on the strand
+    bool hasCredit() const;
+
+    void onCredit(uint64_t limit);
+
+    // the Interests held go to _queue while there are credits
+    void releaseHeld();
+};
@@ -0,0 +1,210 @@
+#include "tcp_master_face.h"
+
+#include <boost/bind.hpp>
+
+#include "../log/logger.h"
+#include "../metrics/memory_stats.h"
+#include "../metrics/metrics.h"
+
+TcpMasterFace::TcpMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port)
+        : MasterFace(ios, max_connection)
+        , _port(port)
+        , _socket_options(SocketOptions::getDefault()) {
+    _acceptors.push_back(openAcceptor(ios));
+}
+
+std::string TcpMasterFace::getUnderlyingProtocol() const {
+    return "TCP";
+}
+
+void TcpMasterFace::setServicePicker(const ServicePicker &service_picker) {
+    _service_picker = service_picker;
+}
+
+void TcpMasterFace::setAcceptorServices(const std::vector<boost::asio::io_service*> &services) {
+    if (services.empty()) {
+        return;
+    }
+    // bound before the previous ones are closed, the port is never free in between
+    std::vector<std::unique_ptr<Acceptor>> acceptors;
+    for (auto service : services) {
+        acceptors.push_back(openAcceptor(*service));
+    }
+    for (const auto &acceptor : _acceptors) {
+        boost::system::error_code err;
+        acceptor->acceptor.close(err);
+    }
+    _acceptors = std::move(acceptors);
+}
+
+void TcpMasterFace::listen(const NotificationCallback &notification_callback, const Face::InterestCallback &interest_callback,
+                           const Face::DataCallback &data_callback, const ErrorCallback &error_callback) {
+    _notification_callback = notification_callback;
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    int backlog;
+    {
+        std::lock_guard<std::mutex> lock(_socket_options_mutex);
+        backlog = _socket_options.backlog > 0 ? _socket_options.backlog : boost::asio::socket_base::max_connections;
+    }
+    for (const auto &acceptor : _acceptors) {
+        acceptor->acceptor.listen(backlog);
+    }
+    std::stringstream ss;
+    ss << "master face with ID = " << _master_face_id << " listening on tcp://0.0.0.0:" << _port;
+    if (_acceptors.size() > 1) {
+        ss << " with " << _acceptors.size() << " acceptors";
+    }
+    logger::log(logger::INFO, ss.str());
+    for (const auto &acceptor : _acceptors) {
+        // the first accept on the thread of the acceptor as the next ones
+        acceptor->ios.post(boost::bind(&TcpMasterFace::accept, shared_from_this(), acceptor.get()));
+    }
+}
+
+void TcpMasterFace::close() {
+    for (const auto &acceptor : _acceptors) {
+        Acceptor *a = acceptor.get();
+        auto self = shared_from_this();
+        a->ios.post([self, a]() {
+            if (a->socket) {
+                boost::system::error_code err;
+                a->socket->close(err);
+            }
+        });
+    }
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        face->close();
+    }
+}
+
+void TcpMasterFace::stopAccepting() {
+    // an acceptor is only touched from its own io_service once listening
+    for (const auto &acceptor : _acceptors) {
+        Acceptor *a = acceptor.get();
+        auto self = shared_from_this();
+        a->ios.post([self, a]() {
+            boost::system::error_code err;
+            a->acceptor.close(err);
+        });
+    }
+}
+
+size_t TcpMasterFace::getQueuedPackets() const {
+    size_t packets = 0;
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        packets += face->getQueueStats().packets;
+    }
+    return packets;
+}
+
+void TcpMasterFace::sendToAllFaces(const std::string &message) {
+    sendToAllFaces(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void TcpMasterFace::sendToAllFaces(const ndn::Interest &interest) {
+    sendToAllFaces(Face::getWireBuffer(interest.wireEncode()));
+}
+
+void TcpMasterFace::sendToAllFaces(const ndn::Data &data) {
+    sendToAllFaces(Face::getWireBuffer(data.wireEncode()));
+}
+
+void TcpMasterFace::sendToAllFaces(const std::shared_ptr<const ndn::Buffer> &wire) {
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        face->send(wire);
+    }
+}
+
+std::string TcpMasterFace::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"id":)" << _master_face_id << R"(, "protocol":"TCP", "port":)" << _port << R"(, "faces":[)";
+    bool first = true;
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face->toJSON();
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+void TcpMasterFace::writeMetrics(MetricsWriter &writer) const {
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        face->writeMetrics(writer);
+    }
+}
+
+void TcpMasterFace::addMemoryStats(MemoryStats &stats) const {
+    auto faces = _faces.get();
+    for (const auto &face : *faces) {
+        face->addMemoryStats(stats);
+    }
+}
+
+void TcpMasterFace::setSocketOptions(const SocketOptions &options) {
+    // the faces already accepted keep theirs, the backlog only changes with the next listen
+    std::lock_guard<std::mutex> lock(_socket_options_mutex);
+    _socket_options = options;
+    for (const auto &acceptor : _acceptors) {
+        // a closed one has a fd of -1 and the options fail harmlessly
+        _socket_options.apply(acceptor->acceptor.native_handle());
+    }
+}
+
+std::unique_ptr<TcpMasterFace::Acceptor> TcpMasterFace::openAcceptor(boost::asio::io_service &ios) const {
+    std::unique_ptr<Acceptor> acceptor(new Acceptor(ios));
+    boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v4(), _port);
+    acceptor->acceptor.open(endpoint.protocol());
+    acceptor->acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+    acceptor->acceptor.set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+    {
+        // the accepted sockets inherit the buffer sizes of the listening one
+        std::lock_guard<std::mutex> lock(_socket_options_mutex);
+        _socket_options.apply(acceptor->acceptor.native_handle());
+    }
+    acceptor->acceptor.bind(endpoint);
+    return acceptor;
+}
+
+void TcpMasterFace::accept(Acceptor *acceptor) {
+    // the picker only spreads the faces of the acceptor on the io_service of the master face
+    boost::asio::io_service &ios = &acceptor->ios == &_ios && _service_picker ? _service_picker() : acceptor->ios;
+    acceptor->socket.reset(new boost::asio::ip::tcp::socket(ios));
+    acceptor->acceptor.async_accept(*acceptor->socket, boost::bind(&TcpMasterFace::acceptHandler, shared_from_this(), acceptor, _1));
+}
+
+void TcpMasterFace::acceptHandler(Acceptor *acceptor, const boost::system::error_code &err) {
+    if(!err) {
+        // the accepts of an acceptor are handled one at a time, the faces lost meanwhile only make room. with several
+        // acceptors the count may be passed by one per acceptor
+        if(_faces.size() < _max_connection) {
+            logger::log(logger::INFO, "new connection from tcp://{}", {acceptor->socket->remote_endpoint()});
+            auto face = std::make_shared<TcpFace>(std::move(*acceptor->socket));
+            {
+                std::lock_guard<std::mutex> lock(_socket_options_mutex);
+                face->setSocketOptions(_socket_options);
+            }
+            _faces.add(face);
+            _notification_callback(shared_from_this(), face);
+            openFace(face, boost::bind(&TcpMasterFace::onFaceError, shared_from_this(), _1));
+        }
+        accept(acceptor);
+    } else if (err != boost::asio::error::operation_aborted) {
+        std::cerr << err.message() << std::endl;
+    }
+}
+
+void TcpMasterFace::onFaceError(const std::shared_ptr<Face> &face) {
+    _faces.remove(face);
+    _error_callback(shared_from_this(), face);
+}
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "master_face.h"
+
+#include <boost/asio.hpp>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "face_list.h"
+#include "tcp_face.h"
+
+class TcpMasterFace : public MasterFace, public std::enable_shared_from_this<TcpMasterFace> {
+public:
+    // the io_service an accepted face runs on, e.g. one per core
+    using ServicePicker = std::function<boost::asio::io_service&()>;
+
+private:
+    // bound with SO_REUSEPORT, the kernel spreads the connections over the acceptors of the port and each accepts on
+    // its own io_service
+    struct Acceptor {
+        boost::asio::io_service &ios;
+        boost::asio::ip::tcp::acceptor acceptor;
+        // made on the io_service of the next face before each accept
+        std::unique_ptr<boost::asio::ip::tcp::socket> socket;
+
+        explicit Acceptor(boost::asio::io_service &ios) : ios(ios), acceptor(ios) {
+
+        }
+    };
+
+    uint16_t _port;
+    ServicePicker _service_picker;
+    // not changed once listening
+    std::vector<std::unique_ptr<Acceptor>> _acceptors;
+    // the accepted faces get them as well, read by the acceptors from their threads
+    mutable std::mutex _socket_options_mutex;
+    SocketOptions _socket_options;
+    // the faces report their errors from their own io_service and are sent to from any thread
+    FaceList<Face> _faces;
+
+public:
+    TcpMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port);
+
+    ~TcpMasterFace() override = default;
+
+    std::string getUnderlyingProtocol() const override;
+
+    // before listen, the faces run on the io_service of the master face otherwise
+    void setServicePicker(const ServicePicker &service_picker);
+
+    // before listen, one acceptor per service in place of the one on the io_service of the master face, a face then
+    // runs on the service of the acceptor it came from without the picker. a reconnection storm is accepted by all
+    // the services at once, each with a backlog of its own. throws if the port can't be bound again
+    void setAcceptorServices(const std::vector<boost::asio::io_service*> &services);
+
+    void listen(const NotificationCallback &notification_callback, const Face::InterestCallback &interest_callback,
+                const Face::DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+    using MasterFace::listen;
+
+    void close() override;
+
+    void stopAccepting() override;
+
+    size_t getQueuedPackets() const override;
+
+    void sendToAllFaces(const std::string &message) override;
+
+    void sendToAllFaces(const ndn::Interest &interest) override;
+
+    void sendToAllFaces(const ndn::Data &data) override;
+
+    void sendToAllFaces(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+    using MasterFace::sendToAllFaces;
+
+    std::string toJSON() const override;
+
+    void writeMetrics(MetricsWriter &writer) const override;
+
+    void addMemoryStats(MemoryStats &stats) const override;
+
+    void setSocketOptions(const SocketOptions &options) override;
+
+private:
+    std::unique_ptr<Acceptor> openAcceptor(boost::asio::io_service &ios) const;
+
+    void accept(Acceptor *acceptor);
+
+    void acceptHandler(Acceptor *acceptor, const boost::system::error_code &err);
+
+    void onFaceError(const std::shared_ptr<Face> &face);
+};
\ No newline at end of file
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <ndn-cxx/encoding/tlv.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__SSE2__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// bare TLV reading on a wire buffer, for the paths which walk a few elements without decoding the packet,
+// all of them throw ndn::tlv::Error on truncated or malformed input
+namespace tlv_reader {
+
+    // false if the buffer ends before the number, begin is then left unchanged
+    inline bool tryReadVarNumber(const uint8_t *&begin, const uint8_t *end, uint64_t &number) {
+        if (begin == end) {
+            return false;
+        }
+        size_t length;
+        switch (*begin) {
+            case 253:
+                length = 2;
+                break;
+            case 254:
+                length = 4;
+                break;
+            case 255:
+                length = 8;
+                break;
+            default:
+                number = *begin++;
+                return true;
+        }
+        if (static_cast<size_t>(end - begin) <= length) {
+            return false;
+        }
+        ++begin;
+        number = 0;
+        for (size_t i = 0; i < length; ++i) {
+            number = (number << 8) | *begin++;
+        }
+        return true;
+    }
+
+    inline uint64_t readVarNumber(const uint8_t *&begin, const uint8_t *end) {
+        uint64_t number;
+        if (!tryReadVarNumber(begin, end, number)) {
+            throw ndn::tlv::Error("truncated VAR-NUMBER");
+        }
+        return number;
+    }
+
+    inline uint64_t readNonNegativeInteger(const uint8_t *begin, size_t length) {
+        if (length != 1 && length != 2 && length != 4 && length != 8) {
+            throw ndn::tlv::Error("invalid NonNegativeInteger length");
+        }
+        uint64_t number = 0;
+        for (size_t i = 0; i < length; ++i) {
+            number = (number << 8) | begin[i];
+        }
+        return number;
+    }
+
+    // reads a TLV header and checks its value fits in the buffer, begin is left on the value
+    inline size_t readHeader(const uint8_t *&begin, const uint8_t *end, uint32_t &type) {
+        // a 1 byte type and a 1 byte length, e.g. every component of most Names
+        if (end - begin >= 2 && begin[0] < 253 && begin[1] < 253) {
+            type = begin[0];
+            size_t length = begin[1];
+            begin += 2;
+            if (length > static_cast<size_t>(end - begin)) {
+                throw ndn::tlv::Error("TLV length exceeds buffer size");
+            }
+            return length;
+        }
+        type = static_cast<uint32_t>(readVarNumber(begin, end));
+        uint64_t length = readVarNumber(begin, end);
+        if (length > static_cast<uint64_t>(end - begin)) {
+            throw ndn::tlv::Error("TLV length exceeds buffer size");
+        }
+        return length;
+    }
+
+    // the type of an LpPacket, links from NFD may wrap the packets in them
+    const uint8_t LP_PACKET = 100;
+
+    inline bool isPacketStart(uint8_t byte) {
+        return byte == ndn::tlv::Interest || byte == ndn::tlv::Data || byte == LP_PACKET;
+    }
+
+    // the first byte from begin which may start a packet, end if there is none. a stream resyncs on it past garbage,
+    // 32 or 16 bytes are compared at once where the build targets AVX2 or SSE2, which every x86-64 has
+    inline const uint8_t* findPacketStart(const uint8_t *begin, const uint8_t *end) {
+#if defined(__AVX2__)
+        const __m256i interests = _mm256_set1_epi8(ndn::tlv::Interest);
+        const __m256i data = _mm256_set1_epi8(ndn::tlv::Data);
+        const __m256i lp_packets = _mm256_set1_epi8(LP_PACKET);
+        for (; end - begin >= 32; begin += 32) {
+            __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+            __m256i starts = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(bytes, interests), _mm256_cmpeq_epi8(bytes, data)),
+                                             _mm256_cmpeq_epi8(bytes, lp_packets));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(starts));
+            if (mask != 0) {
+                return begin + __builtin_ctz(mask);
+            }
+        }
+#endif
+#if defined(__SSE2__)
+        const __m128i interests_128 = _mm_set1_epi8(ndn::tlv::Interest);
+        const __m128i data_128 = _mm_set1_epi8(ndn::tlv::Data);
+        const __m128i lp_packets_128 = _mm_set1_epi8(LP_PACKET);
+        for (; end - begin >= 16; begin += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            __m128i starts = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, interests_128), _mm_cmpeq_epi8(bytes, data_128)),
+                                          _mm_cmpeq_epi8(bytes, lp_packets_128));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(starts));
+            if (mask != 0) {
+                return begin + __builtin_ctz(mask);
+            }
+        }
+#endif
+        for (; begin != end; ++begin) {
+            if (isPacketStart(*begin)) {
+                return begin;
+            }
+        }
+        return end;
+    }
+
+    enum Frame {
+        // the whole element is in the buffer
+        COMPLETE,
+        // its header or its value is not fully received yet
+        PARTIAL,
+        // it would be larger than allowed, the stream has to resync past its first byte
+        OVERSIZED,
+    };
+
+    // framing of a stream, e.g. TCP: the element starting at begin and its size, header included, without throwing
+    // nor reading past end. a length which can't fit in max_size is OVERSIZED before it is added to anything, size is
+    // then that of the element, for it to be skipped, or 0 if it would overflow
+    inline Frame frame(const uint8_t *begin, const uint8_t *end, size_t max_size, size_t &size) {
+        const uint8_t *current = begin;
+        uint64_t type, length;
+        if (end - begin >= 2 && begin[0] < 253 && begin[1] < 253) {
+            length = begin[1];
+            current += 2;
+        } else if (!tryReadVarNumber(current, end, type) || !tryReadVarNumber(current, end, length)) {
+            return PARTIAL;
+        }
+        size_t header = current - begin;
+        if (header > max_size || length > max_size - header) {
+            size = length <= std::numeric_limits<size_t>::max() - header ? header + length : 0;
+            return OVERSIZED;
+        }
+        size = header + length;
+        return size <= static_cast<size_t>(end - begin) ? COMPLETE : PARTIAL;
+    }
+
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <algorithm>
+
+// rate limit in packets: rate tokens per second up to burst of them, a packet takes one. a rate of 0 lets all go
+class TokenBucket {
+private:
+    using Clock = ndn::time::steady_clock;
+
+    double _rate;
+    double _burst;
+    double _tokens;
+    Clock::time_point _last_refill;
+
+public:
+    explicit TokenBucket(double rate = 0, double burst = 1)
+            : _rate(rate)
+            , _burst(std::max(burst, 1.0))
+            , _tokens(_burst)
+            , _last_refill(Clock::now()) {
+
+    }
+
+    double getRate() const {
+        return _rate;
+    }
+
+    double getBurst() const {
+        return _burst;
+    }
+
+    // the bucket starts full again
+    void set(double rate, double burst) {
+        _rate = rate;
+        _burst = std::max(burst, 1.0);
+        _tokens = _burst;
+    }
+
+    bool take(const Clock::time_point &now = Clock::now()) {
+        if (!canTake(now)) {
+            return false;
+        }
+        if (_rate > 0) {
+            _tokens -= 1;
+        }
+        return true;
+    }
+
+    // whether take would succeed, nothing is taken
+    bool canTake(const Clock::time_point &now = Clock::now()) {
+        if (_rate <= 0) {
+            return true;
+        }
+        double elapsed = ndn::time::duration_cast<ndn::time::milliseconds>(now - _last_refill).count() / 1000.0;
+        if (elapsed > 0) {
+            _tokens = std::min(_burst, _tokens + elapsed * _rate);
+            _last_refill = now;
+        }
+        return _tokens >= 1;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "tracer.h"
+
+#include "name_view.h"
+#include "../log/logger.h"
+
+std::atomic<uint64_t> Tracer::sampling{0};
+std::mutex Tracer::receives_mutex;
+std::unordered_map<uint64_t, Tracer::Receive> Tracer::receives;
+
+void Tracer::setSampling(uint64_t new_sampling) {
+    sampling = new_sampling;
+    if (new_sampling == 0) {
+        std::lock_guard<std::mutex> guard(receives_mutex);
+        receives.clear();
+    }
+}
+
+uint64_t Tracer::getSampling() {
+    return sampling.load(std::memory_order_relaxed);
+}
+
+bool Tracer::getTraceId(const ndn::Block &block, uint64_t &trace_id) {
+    if (block.type() != ndn::tlv::Interest && block.type() != ndn::tlv::Data) {
+        return false;
+    }
+    uint64_t current_sampling = sampling.load(std::memory_order_relaxed);
+    if (current_sampling == 0) {
+        return false;
+    }
+    try {
+        trace_id = NameView(block).getHash();
+    } catch (const std::exception &e) {
+        return false;
+    }
+    return trace_id % current_sampling == 0;
+}
+
+int64_t Tracer::getEpochMicroseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::onReceive(size_t face_id, const ndn::Block &block) {
+    uint64_t trace_id;
+    if (!getTraceId(block, trace_id)) {
+        return;
+    }
+    bool is_interest = block.type() == ndn::tlv::Interest;
+    auto now = std::chrono::steady_clock::now();
+    {
+        // an Interest and its Data share their trace ID, the type tells them apart
+        uint64_t key = trace_id ^ is_interest;
+        std::lock_guard<std::mutex> guard(receives_mutex);
+        if (receives.size() >= MAX_RECEIVES) {
+            for (auto it = receives.begin(); it != receives.end();) {
+                if (now - it->second.time > std::chrono::milliseconds(SPAN_TIMEOUT_MS)) {
+                    it = receives.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        if (receives.size() < MAX_RECEIVES) {
+            receives[key] = {now, face_id};
+        }
+    }
+    logger::log(logger::INFO, is_interest ? "trace {}: Interest received at {}us on face {}" : "trace {}: Data received at {}us on face {}",
+                {trace_id, getEpochMicroseconds(), face_id});
+}
+
+void Tracer::onSend(size_t face_id, const std::shared_ptr<const ndn::Buffer> &wire) {
+    if (wire->empty() || (wire->front() != ndn::tlv::Interest && wire->front() != ndn::tlv::Data)) {
+        return;
+    }
+    ndn::Block block;
+    try {
+        block = ndn::Block(wire);
+    } catch (const std::exception &e) {
+        return;
+    }
+    uint64_t trace_id;
+    if (!getTraceId(block, trace_id)) {
+        return;
+    }
+    bool is_interest = block.type() == ndn::tlv::Interest;
+    auto now = std::chrono::steady_clock::now();
+    int64_t elapsed = -1;
+    {
+        uint64_t key = trace_id ^ is_interest;
+        std::lock_guard<std::mutex> guard(receives_mutex);
+        auto it = receives.find(key);
+        if (it != receives.end() && now - it->second.time <= std::chrono::milliseconds(SPAN_TIMEOUT_MS)) {
+            elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - it->second.time).count();
+        }
+    }
+    // a packet the module made itself, e.g. a Data from the cache, has no receive
+    if (elapsed < 0) {
+        logger::log(logger::INFO, is_interest ? "trace {}: Interest sent at {}us on face {}" : "trace {}: Data sent at {}us on face {}",
+                    {trace_id, getEpochMicroseconds(), face_id});
+        return;
+    }
+    logger::log(logger::INFO, is_interest ? "trace {}: Interest sent at {}us on face {}, {}us after its receive"
+                                          : "trace {}: Data sent at {}us on face {}, {}us after its receive",
+                {trace_id, getEpochMicroseconds(), face_id, elapsed});
+}
\ No newline at end of file
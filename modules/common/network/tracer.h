@@ -0,0 +1,59 @@
+#pragma once
+
+#include <ndn-cxx/encoding/block.hpp>
+#include <ndn-cxx/encoding/buffer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// sampled tracing of the packets through a chain of modules. a packet is traced when the name_hash of its Name is a
+// multiple of the sampling, so every module of the chain picks the same packets on its own and nothing is added to
+// the wire: the trace ID is that name_hash. the faces stamp the receive and the sends of a traced packet, each one is
+// logged as an event with the time in microseconds since the epoch, the send with the time spent since the receive.
+// the events of the modules of a host, whose clock they share, are joined by trace ID to find the slow hop
+class Tracer {
+public:
+    // a receive is forgotten after that long, the default InterestLifetime
+    static const int SPAN_TIMEOUT_MS = 4000;
+    // receives waiting for their sends, the sampled packets over that are only logged when received
+    static const size_t MAX_RECEIVES = 4096;
+
+private:
+    struct Receive {
+        std::chrono::steady_clock::time_point time;
+        size_t face_id;
+    };
+
+    // 0 while tracing is off
+    static std::atomic<uint64_t> sampling;
+    static std::mutex receives_mutex;
+    // by trace ID and type, only the sampled packets take the lock
+    static std::unordered_map<uint64_t, Receive> receives;
+
+    // the trace ID of a sampled Interest or Data, false for the other packets
+    static bool getTraceId(const ndn::Block &block, uint64_t &trace_id);
+
+    static int64_t getEpochMicroseconds();
+
+public:
+    // one packet traced in sampling, 0 turns tracing off. from any thread
+    static void setSampling(uint64_t sampling);
+
+    static uint64_t getSampling();
+
+    // checked by the faces before anything else, a packet costs a relaxed load while tracing is off
+    static bool isEnabled() {
+        return sampling.load(std::memory_order_relaxed) != 0;
+    }
+
+    // a packet delivered by the face, from its thread
+    static void onReceive(size_t face_id, const ndn::Block &block);
+
+    // a packet handed to the send path of the face, before its egress queue
+    static void onSend(size_t face_id, const std::shared_ptr<const ndn::Buffer> &wire);
+};
\ No newline at end of file
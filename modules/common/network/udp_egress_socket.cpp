@@ -0,0 +1,118 @@
+#include "udp_egress_socket.h"
+
+#include <boost/bind.hpp>
+
+#include <map>
+#include <sstream>
+
+#include "../log/logger.h"
+#include "socket_options.h"
+#include "udp_face.h"
+
+std::atomic<bool> UdpEgressSocket::_is_enabled(false);
+
+UdpEgressSocket::UdpEgressSocket(boost::asio::io_service &ios)
+        : _socket(ios)
+        , _unknown_datagrams(0)
+        , _dropped_datagrams(0) {
+
+}
+
+void UdpEgressSocket::enable() {
+    _is_enabled = true;
+}
+
+bool UdpEgressSocket::isEnabled() {
+    return _is_enabled;
+}
+
+std::shared_ptr<UdpEgressSocket> UdpEgressSocket::get(boost::asio::io_service &ios) {
+    static std::mutex mutex;
+    static std::map<boost::asio::io_service*, std::weak_ptr<UdpEgressSocket>> sockets;
+
+    if (!_is_enabled) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &weak_socket = sockets[&ios];
+    auto socket = weak_socket.lock();
+    if (!socket) {
+        socket = std::make_shared<UdpEgressSocket>(ios);
+        try {
+            socket->open();
+        } catch (const boost::system::system_error &e) {
+            logger::log(logger::ERROR, std::string("can't open the shared egress socket, faces keep their own: ") + e.what());
+            return nullptr;
+        }
+        weak_socket = socket;
+        socket->read();
+    }
+    return socket;
+}
+
+bool UdpEgressSocket::add(const boost::asio::ip::udp::endpoint &endpoint, const std::shared_ptr<UdpFace> &face) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_faces.find(endpoint) != _faces.end()) {
+        return false;
+    }
+    _faces.emplace(endpoint, face);
+    return true;
+}
+
+void UdpEgressSocket::remove(const boost::asio::ip::udp::endpoint &endpoint, const UdpFace *face) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _faces.find(endpoint);
+    if (it != _faces.end() && it->second.get() == face) {
+        _faces.erase(endpoint);
+    }
+}
+
+std::string UdpEgressSocket::toJSON() const {
+    size_t faces;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        faces = _faces.size();
+    }
+    std::stringstream ss;
+    ss << R"({"faces":)" << faces << R"(, "unknown_datagrams":)" << _unknown_datagrams
+       << R"(, "dropped_datagrams":)" << _dropped_datagrams << "}";
+    return ss.str();
+}
+
+void UdpEgressSocket::open() {
+    _socket.open(boost::asio::ip::udp::v4());
+    SocketOptions::getDefault().apply(_socket.native_handle());
+    _socket.non_blocking(true);
+    // an ephemeral port, the replies to the first send could otherwise be read before it binds the socket
+    _socket.bind(boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+}
+
+void UdpEgressSocket::read() {
+    _socket.async_receive_from(boost::asio::buffer(_buffer, BUFFER_SIZE), _remote_endpoint,
+                               boost::bind(&UdpEgressSocket::readHandler, shared_from_this(), _1, _2));
+}
+
+void UdpEgressSocket::readHandler(const boost::system::error_code &err, size_t bytes_transferred) {
+    if (err == boost::asio::error::operation_aborted) {
+        return;
+    }
+    if (!err) {
+        std::shared_ptr<UdpFace> face;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _faces.find(_remote_endpoint);
+            if (it != _faces.end()) {
+                face = it->second;
+            }
+        }
+        if (face) {
+            face->proceedDatagram(_buffer, bytes_transferred);
+        } else {
+            ++_unknown_datagrams;
+        }
+    } else {
+        // e.g. the ICMP error of a next hop which isn't listening, the other faces still receive
+        logger::log(logger::WARNING, "shared egress socket: " + err.message());
+    }
+    read();
+}
\ No newline at end of file
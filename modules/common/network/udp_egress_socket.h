@@ -0,0 +1,70 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "endpoint_map.h"
+
+class UdpFace;
+
+// optional socket shared by the egress UDP faces of an io_service, selected at startup with enable(), instead of one
+// socket per face: one descriptor, one receive and one buffer whatever the number of next hops. the datagrams are
+// handed to the face registered for their source, the others are dropped as a face filters them on its own socket
+//
+// the sends are synchronous, the socket is non-blocking so that a datagram the kernel can't queue is dropped as on a
+// full link instead of parking the writes of the face. the faces keep their own socket, connected, when it is disabled
+class UdpEgressSocket : public std::enable_shared_from_this<UdpEgressSocket> {
+public:
+    static const size_t BUFFER_SIZE = 1 << 16;
+
+private:
+    static std::atomic<bool> _is_enabled;
+
+    boost::asio::ip::udp::socket _socket;
+    boost::asio::ip::udp::endpoint _remote_endpoint;
+    char _buffer[BUFFER_SIZE];
+
+    // faces are registered from the command handlers while datagrams are read, the lock is held for a lookup
+    mutable std::mutex _mutex;
+    EndpointMap<UdpFace> _faces;
+    std::atomic<size_t> _unknown_datagrams;
+    std::atomic<size_t> _dropped_datagrams;
+
+public:
+    explicit UdpEgressSocket(boost::asio::io_service &ios);
+
+    static void enable();
+
+    static bool isEnabled();
+
+    // socket of the given io_service, created on first use, null if the mode is not enabled
+    static std::shared_ptr<UdpEgressSocket> get(boost::asio::io_service &ios);
+
+    // false if a face already receives from endpoint, the new one then keeps its own socket
+    bool add(const boost::asio::ip::udp::endpoint &endpoint, const std::shared_ptr<UdpFace> &face);
+
+    // only the face registered for endpoint is removed
+    void remove(const boost::asio::ip::udp::endpoint &endpoint, const UdpFace *face);
+
+    template <typename ConstBufferSequence>
+    void send(const ConstBufferSequence &buffers, const boost::asio::ip::udp::endpoint &endpoint) {
+        boost::system::error_code err;
+        _socket.send_to(buffers, endpoint, 0, err);
+        if (err) {
+            ++_dropped_datagrams;
+        }
+    }
+
+    // {"faces", "unknown_datagrams", "dropped_datagrams"}
+    std::string toJSON() const;
+
+private:
+    void open();
+
+    void read();
+
+    void readHandler(const boost::system::error_code &err, size_t bytes_transferred);
+};
\ No newline at end of file
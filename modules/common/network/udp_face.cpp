@@ -0,0 +1,292 @@
+#include "udp_face.h"
+
+#include <boost/bind.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include "../metrics/stage_profile.h"
+
+UdpFace::UdpFace(boost::asio::io_service &ios, const std::string &host, uint16_t port)
+        : Face(ios)
+        , _endpoint(boost::asio::ip::address::from_string(host), port)
+        , _socket(ios)
+        , _egress_socket(UdpEgressSocket::get(ios))
+        , _socket_options(SocketOptions::getDefault())
+        , _strand(ios)
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _timer(ios) {
+    if (!_egress_socket) {
+        openSocket();
+    }
+}
+
+UdpFace::UdpFace(boost::asio::io_service &ios, const boost::asio::ip::udp::endpoint &endpoint)
+        : Face(ios)
+        , _endpoint(endpoint)
+        , _socket(ios)
+        , _egress_socket(UdpEgressSocket::get(ios))
+        , _socket_options(SocketOptions::getDefault())
+        , _strand(ios)
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _timer(ios) {
+    if (!_egress_socket) {
+        openSocket();
+    }
+}
+
+std::string UdpFace::getUnderlyingProtocol() const {
+    return "UDP";
+}
+
+std::string UdpFace::getUnderlyingEndpoint() const {
+    std::stringstream ss;
+    ss << _endpoint;
+    return ss.str();
+}
+
+void UdpFace::open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) {
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    if (_egress_socket) {
+        if (_egress_socket->add(_endpoint, shared_from_this())) {
+            return;
+        }
+        // another face receives from this endpoint on the shared socket
+        _egress_socket.reset();
+        openSocket();
+    }
+    _uring = UringService::get(_ios);
+    read();
+}
+
+void UdpFace::close() {
+    if (_egress_socket) {
+        _egress_socket->remove(_endpoint, this);
+        return;
+    }
+    if (_uring_receive) {
+        _uring->cancel(_uring_receive);
+        _uring_receive = 0;
+    }
+    _socket.close();
+}
+
+void UdpFace::send(const std::string &message) {
+    send(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void UdpFace::send(const ndn::Interest &interest) {
+    send(getWireBuffer(interest.wireEncode()));
+}
+
+void UdpFace::send(const ndn::Data &data) {
+    send(getWireBuffer(data.wireEncode()));
+}
+
+void UdpFace::send(const std::shared_ptr<const ndn::Buffer> &wire) {
+    if (!_inbox.emplace(wire)) {
+        // the inbox only absorbs bursts between two drains, the egress queue applies the real limits
+        _strand.post(boost::bind(&UdpFace::sendImpl, shared_from_this(), wire));
+        return;
+    }
+    if (!_is_draining.exchange(true)) {
+        _strand.post(boost::bind(&UdpFace::drainInbox, shared_from_this()));
+    }
+}
+
+void UdpFace::openSocket() {
+    _socket.open(boost::asio::ip::udp::v4());
+    _socket_options.apply(_socket.native_handle());
+    _buffer.reset(new char[BUFFER_SIZE]);
+    boost::system::error_code err;
+    _socket.connect(_endpoint, err);
+    _is_connected = !err;
+}
+
+void UdpFace::read() {
+    if (_uring) {
+        if (!_uring_receive) {
+            _uring_receive = _uring->receive(_socket.native_handle(), !_is_connected,
+                                             boost::bind(&UdpFace::onUringDatagram, shared_from_this(), _1, _2, _3, _4),
+                                             boost::bind(&UdpFace::onUringError, shared_from_this(), _1));
+        }
+        return;
+    }
+    read(LoopHandler<UdpFace>(shared_from_this(), &UdpFace::readHandler, _read_memory));
+}
+
+void UdpFace::read(LoopHandler<UdpFace> &&handler) {
+    if (_is_connected) {
+        _socket.async_receive(boost::asio::buffer(_buffer.get(), BUFFER_SIZE), std::move(handler));
+        return;
+    }
+    _socket.async_receive_from(boost::asio::buffer(_buffer.get(), BUFFER_SIZE), _remote_endpoint, std::move(handler));
+}
+
+void UdpFace::readHandler(LoopHandler<UdpFace> &&handler, const boost::system::error_code &err, size_t bytes_transferred) {
+    if(!err) {
+        if (_is_connected || _remote_endpoint == _endpoint) {
+            proceedDatagram(_buffer.get(), bytes_transferred);
+        }
+        read(std::move(handler));
+    } else if (err == boost::asio::error::connection_refused) {
+        // the ICMP error of a next hop not listening yet, reported on a connected socket only
+        read(std::move(handler));
+    } else {
+        std::cerr << err.message() << std::endl;
+        _error_callback(shared_from_this());
+    }
+}
+
+void UdpFace::onUringDatagram(const uint8_t *data, size_t size, const sockaddr *address, socklen_t address_length) {
+    if (_is_connected) {
+        proceedDatagram(reinterpret_cast<const char *>(data), size);
+        return;
+    }
+    boost::asio::ip::udp::endpoint endpoint;
+    if (address_length > endpoint.capacity()) {
+        return;
+    }
+    std::memcpy(endpoint.data(), address, address_length);
+    endpoint.resize(address_length);
+    if (endpoint == _endpoint) {
+        proceedDatagram(reinterpret_cast<const char *>(data), size);
+    }
+}
+
+void UdpFace::onUringError(int error) {
+    _uring_receive = 0;
+    if (error == -ECONNREFUSED) {
+        read();
+        return;
+    }
+    std::cerr << std::strerror(-error) << std::endl;
+    _error_callback(shared_from_this());
+}
+
+void UdpFace::proceedDatagram(const char *buffer, size_t size) {
+    try {
+        if (buffer[0] == 0x00) {
+            // special packet, just echoes it
+            send("0");
+            return;
+        }
+        auto self = shared_from_this();
+        _reassembler.receiveDatagram(BufferPool::local().copy(buffer, size), [&self](const ndn::Block &packet, const ndn::Block &lp_packet) {
+            try {
+                self->deliver(self, packet, lp_packet.hasWire() ? &lp_packet : nullptr);
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << std::endl;
+            }
+        });
+        // a datagram may carry several packets once aggregated
+        flushBurst(self);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+QueueStats UdpFace::getQueueStats() const {
+    return _queue.getStats();
+}
+
+void UdpFace::setSocketOptions(const SocketOptions &options) {
+    _socket_options = options;
+    if (_socket.is_open()) {
+        _socket_options.apply(_socket.native_handle());
+    }
+}
+
+const LatencyHistogram* UdpFace::getQueueLatency() const {
+    return &_queue.getLatency();
+}
+
+size_t UdpFace::getBufferBytes() const {
+    return _buffer ? BUFFER_SIZE : 0;
+}
+
+void UdpFace::drainInbox() {
+    for (;;) {
+        while (std::shared_ptr<const ndn::Buffer> *wire = _inbox.peek(0)) {
+            std::shared_ptr<const ndn::Buffer> buffer = std::move(*wire);
+            _inbox.pop();
+            sendImpl(buffer);
+        }
+        // a sender may have pushed after the last peek but seen the inbox as still being drained
+        _is_draining = false;
+        if (!_inbox.peek(0) || _is_draining.exchange(true)) {
+            return;
+        }
+    }
+}
+
+void UdpFace::sendImpl(std::shared_ptr<const ndn::Buffer> &buffer) {
+    stage_profile::Scope stage(stage_profile::SEND);
+    countOut(buffer);
+    // packets of the pending write can't be dropped
+    size_t mtu = LpLink::getMtu();
+    if (buffer->size() > mtu) {
+        _fragments.clear();
+        LpLink::fragment(*buffer, mtu, _lp_sequence, _fragments);
+        for (auto &fragment : _fragments) {
+            _queue.push(std::move(fragment), _write_count);
+        }
+    } else if (!_queue.push(std::move(buffer), _write_count)) {
+        return;
+    }
+    if (_write_count == 0 && !_queue.empty()) {
+        write();
+    }
+}
+
+void UdpFace::write() {
+    write(LoopHandler<UdpFace>(shared_from_this(), &UdpFace::writeHandler, _write_memory));
+}
+
+void UdpFace::write(LoopHandler<UdpFace> &&handler) {
+    size_t max_packets = LpLink::getAggregation() ? LpLink::MAX_AGGREGATED_PACKETS : 1;
+    size_t mtu = LpLink::getMtu();
+    size_t bytes = 0;
+    _write_buffers.clear();
+    for (const auto &buffer : _queue) {
+        if (!_write_buffers.empty() && (_write_buffers.size() >= max_packets || bytes + buffer->size() > mtu || !LpLink::canAggregate(*buffer))) {
+            break;
+        }
+        _write_buffers.emplace_back(buffer->data(), buffer->size());
+        bytes += buffer->size();
+        if (!LpLink::canAggregate(*buffer)) {
+            break;
+        }
+    }
+    _write_count = _write_buffers.size();
+    if (_egress_socket) {
+        // sent now, the handler is posted so that a queue being flushed doesn't recurse
+        _egress_socket->send(_write_buffers, _endpoint);
+        _strand.post([handler = std::move(handler), bytes]() mutable {
+            handler(boost::system::error_code(), bytes);
+        });
+    } else if (_is_connected) {
+        _socket.async_send(_write_buffers, _strand.wrap(std::move(handler)));
+    } else {
+        _socket.async_send_to(_write_buffers, _endpoint, _strand.wrap(std::move(handler)));
+    }
+}
+
+void UdpFace::writeHandler(LoopHandler<UdpFace> &&handler, const boost::system::error_code &err, size_t bytesTransferred) {
+    stage_profile::Scope stage(stage_profile::SEND);
+    // a refused datagram is lost as on the wire, the next ones may reach the next hop once it listens
+    if(!err || err == boost::asio::error::connection_refused) {
+        for (size_t i = 0; i < _write_count; ++i) {
+            _queue.pop_front();
+        }
+        _write_count = 0;
+        if (!_queue.empty()) {
+            write(std::move(handler));
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "face.h"
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <deque>
+#include <vector>
+
+#include "loop_handler.h"
+#include "lp_link.h"
+#include "mpsc_queue.h"
+#include "udp_egress_socket.h"
+#include "uring_service.h"
+
+class UdpFace : public Face, public std::enable_shared_from_this<UdpFace> {
+public:
+    static const size_t BUFFER_SIZE = 1 << 16;
+    static const size_t INBOX_SIZE = 1 << 6;
+
+private:
+    boost::asio::ip::udp::endpoint _endpoint;
+    boost::asio::ip::udp::endpoint _remote_endpoint;
+    // connected once opened, the kernel then drops the datagrams of other sources and skips the route lookup of
+    // each send. unopened when the face goes through the shared egress socket
+    boost::asio::ip::udp::socket _socket;
+    bool _is_connected = false;
+    std::shared_ptr<UdpEgressSocket> _egress_socket;
+    SocketOptions _socket_options;
+    boost::asio::strand _strand;
+    // senders from any thread push here without the strand, only the one which finds it idle posts drainInbox()
+    MpscQueue<std::shared_ptr<const ndn::Buffer>> _inbox;
+    std::atomic<bool> _is_draining;
+    // BUFFER_SIZE bytes, only for a socket of its own
+    std::unique_ptr<char[]> _buffer;
+    EgressQueue<std::shared_ptr<const ndn::Buffer>> _queue;
+    // queued packets submitted by the pending write, several of them when aggregated in one datagram
+    std::vector<boost::asio::const_buffer> _write_buffers;
+    size_t _write_count = 0;
+    // of the pending read and write, reused by each next one
+    HandlerMemory _read_memory;
+    HandlerMemory _write_memory;
+    uint64_t _lp_sequence = 0;
+    std::vector<std::shared_ptr<const ndn::Buffer>> _fragments;
+    LpReassembler _reassembler;
+    std::shared_ptr<UringService> _uring;
+    uint64_t _uring_receive = 0;
+
+    boost::asio::deadline_timer _timer;
+
+public:
+    // use these when creating a face yourself
+    UdpFace(boost::asio::io_service &ios, const std::string &host, uint16_t port);
+
+    UdpFace(boost::asio::io_service &ios, const boost::asio::ip::udp::endpoint &endpoint);
+
+    ~UdpFace() override = default;
+
+    std::string getUnderlyingProtocol() const override;
+
+    std::string getUnderlyingEndpoint() const override;
+
+    using Face::open;
+
+    void open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+    void close() override;
+
+    using Face::send;
+
+    void send(const std::string &message) override;
+
+    void send(const ndn::Interest &interest) override;
+
+    void send(const ndn::Data &data) override;
+
+    void send(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+    QueueStats getQueueStats() const override;
+
+    void setSocketOptions(const SocketOptions &options) override;
+
+    const LatencyHistogram* getQueueLatency() const override;
+
+    size_t getBufferBytes() const override;
+
+private:
+    friend class UdpEgressSocket;
+
+    void openSocket();
+
+    void read();
+
+    // the next read of the loop handler belongs to
+    void read(LoopHandler<UdpFace> &&handler);
+
+    void readHandler(LoopHandler<UdpFace> &&handler, const boost::system::error_code &err, size_t bytes_transferred);
+
+    void onUringDatagram(const uint8_t *data, size_t size, const sockaddr *address, socklen_t address_length);
+
+    void onUringError(int error);
+
+    void proceedDatagram(const char *buffer, size_t size);
+
+    void drainInbox();
+
+    void sendImpl(std::shared_ptr<const ndn::Buffer> &buffer);
+
+    void write();
+
+    void write(LoopHandler<UdpFace> &&handler);
+
+    void writeHandler(LoopHandler<UdpFace> &&handler, const boost::system::error_code &err, size_t bytesTransferred);
+};
@@ -0,0 +1,833 @@
+#include "udp_master_face.h"
+
+#include <boost/bind.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <netinet/udp.h>
+
+#include "../log/logger.h"
+#include "../metrics/memory_stats.h"
+#include "../metrics/metrics.h"
+#include "../metrics/stage_profile.h"
+
+UdpMasterFace::UdpSubFace::UdpSubFace(UdpMasterFace &master_face, const boost::asio::ip::udp::endpoint &endpoint)
+        : Face(master_face.get_io_service())
+        , _master_face(master_face)
+        , _endpoint(endpoint)
+        , _last_activity(master_face._tick) {
+
+}
+
+std::string UdpMasterFace::UdpSubFace::getUnderlyingProtocol() const {
+    return "UDP";
+}
+
+std::string UdpMasterFace::UdpSubFace::getUnderlyingEndpoint() const {
+    std::stringstream ss;
+    ss << _endpoint;
+    return ss.str();
+}
+
+const boost::asio::ip::udp::endpoint& UdpMasterFace::UdpSubFace::getEndpoint() {
+    return _endpoint;
+}
+
+void UdpMasterFace::UdpSubFace::open(const InterestCallback &interest_callback,
+                                     const DataCallback &data_callback,
+                                     const ErrorCallback &error_callback) {
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    _is_connected = true;
+    _master_face.scheduleIdleCheck(shared_from_this(), _last_activity + PROBE_TICKS);
+}
+
+void UdpMasterFace::UdpSubFace::close() {
+    // the sub-face belongs to the master face strand, which may run on a shard thread
+    _master_face._strand.post(boost::bind(&UdpSubFace::closeImpl, shared_from_this()));
+}
+
+void UdpMasterFace::UdpSubFace::closeImpl() {
+    if (_is_connected) {
+        _is_connected = false;
+        _error_callback(shared_from_this());
+    }
+}
+
+void UdpMasterFace::UdpSubFace::send(const std::string &message) {
+    send(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void UdpMasterFace::UdpSubFace::send(const ndn::Interest &interest) {
+    send(getWireBuffer(interest.wireEncode()));
+}
+
+void UdpMasterFace::UdpSubFace::send(const ndn::Data &data) {
+    send(getWireBuffer(data.wireEncode()));
+}
+
+void UdpMasterFace::UdpSubFace::send(const std::shared_ptr<const ndn::Buffer> &wire) {
+    _master_face.enqueue(shared_from_this(), wire);
+}
+
+void UdpMasterFace::UdpSubFace::sendImpl(const std::shared_ptr<const ndn::Buffer> &wire) {
+    stage_profile::Scope stage(stage_profile::SEND);
+    _last_activity = _master_face._tick;
+    countOut(wire);
+    _master_face.sendImpl(wire, _endpoint);
+}
+
+QueueStats UdpMasterFace::UdpSubFace::getQueueStats() const {
+    return QueueStats();
+}
+
+void UdpMasterFace::UdpSubFace::proceedPacket(const char *buffer, size_t size) {
+    _last_activity = _master_face._tick;
+    try {
+        auto self = shared_from_this();
+        _reassembler.receiveDatagram(BufferPool::local().copy(buffer, size), [&self](const ndn::Block &packet, const ndn::Block &lp_packet) {
+            try {
+                self->deliver(self, packet, lp_packet.hasWire() ? &lp_packet : nullptr);
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << std::endl;
+            }
+        });
+        flushBurst(self);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void UdpMasterFace::UdpSubFace::onIdleCheck(uint64_t tick) {
+    if (!_is_connected) {
+        return;
+    }
+    uint64_t idle = tick - _last_activity;
+    if (idle >= PROBE_TICKS + CLOSE_TICKS) {
+        logger::log(logger::INFO, "no activity from/to {} since 5s", {_endpoint});
+        _is_connected = false;
+        _error_callback(shared_from_this());
+    } else if (idle >= PROBE_TICKS) {
+        // endpoint must manifest itself in the given time, else the socket will close (icmp or timeout)
+        _master_face.sendImpl(BufferPool::local().copy("0", 1), _endpoint);
+        _master_face.scheduleIdleCheck(shared_from_this(), _last_activity + PROBE_TICKS + CLOSE_TICKS);
+    } else {
+        _master_face.scheduleIdleCheck(shared_from_this(), _last_activity + PROBE_TICKS);
+    }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+UdpMasterFace::UdpMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port, size_t shards)
+        : MasterFace(ios, max_connection)
+        , _local_endpoint(boost::asio::ip::udp::v4(), port)
+        , _socket(_ios)
+        , _socket_options(SocketOptions::getDefault())
+        , _strand(_ios)
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _tick_timer(_ios)
+        , _wheel(WHEEL_SIZE) {
+    if (shards <= 1) {
+        _socket.open(_local_endpoint.protocol());
+        _socket_fd = _socket.native_handle();
+        _socket_options.apply(_socket_fd);
+        _socket.bind(_local_endpoint);
+        return;
+    }
+    for (size_t i = 0; i < shards; ++i) {
+        _shard_services.emplace_back(new boost::asio::io_service(1));
+        _shard_works.emplace_back(new boost::asio::io_service::work(*_shard_services.back()));
+        _shards.emplace_back(new UdpMasterFace(*_shard_services.back(), max_connection, port, ShardTag{i}));
+    }
+}
+
+UdpMasterFace::UdpMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port, ShardTag tag)
+        : MasterFace(ios, max_connection)
+        , _local_endpoint(boost::asio::ip::udp::v4(), port)
+        , _socket(_ios)
+        , _socket_options(SocketOptions::getDefault())
+        , _strand(_ios)
+        , _inbox(INBOX_SIZE)
+        , _is_draining(false)
+        , _tick_timer(_ios)
+        , _wheel(WHEEL_SIZE)
+        , _shard_index(tag.index) {
+    _socket.open(_local_endpoint.protocol());
+    _socket_fd = _socket.native_handle();
+    _socket_options.apply(_socket_fd);
+    _socket.set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+    _socket.bind(_local_endpoint);
+}
+
+UdpMasterFace::~UdpMasterFace() {
+    for (const auto &shard_service : _shard_services) {
+        shard_service->stop();
+    }
+    _shard_threads.join_all();
+}
+
+std::string UdpMasterFace::getUnderlyingProtocol() const {
+    return "UDP";
+}
+
+void UdpMasterFace::listen(const MasterFace::NotificationCallback &notification_callback, const Face::InterestCallback &interest_callback,
+                           const Face::DataCallback &data_callback, const MasterFace::ErrorCallback &error_callback) {
+    _notification_callback = notification_callback;
+    _interest_callback = interest_callback;
+    _data_callback = data_callback;
+    _error_callback = error_callback;
+    if (!_shards.empty()) {
+        NotificationCallback shard_notification_callback = boost::bind(&UdpMasterFace::onShardNotification, this, _1, _2);
+        ErrorCallback shard_error_callback = boost::bind(&UdpMasterFace::onShardError, this, _1, _2);
+        for (size_t i = 0; i < _shards.size(); ++i) {
+            auto shard = _shards[i];
+            if (_burst_callback) {
+                Face::BurstCallback shard_burst_callback = boost::bind(&UdpMasterFace::onShardBurst, this, _1, _2);
+                _shard_services[i]->post([=]() {
+                    shard->listen(shard_notification_callback, shard_burst_callback, shard_error_callback);
+                });
+            } else if (_packet_handler || _packet_callback) {
+                // the packets cross over to _ios anyway, the shards keep the callback
+                Face::PacketCallback shard_packet_callback = boost::bind(&UdpMasterFace::onShardPacket, this, _1, _2);
+                _shard_services[i]->post([=]() {
+                    shard->listen(shard_notification_callback, shard_packet_callback, shard_error_callback);
+                });
+            } else {
+                Face::InterestCallback shard_interest_callback = boost::bind(&UdpMasterFace::onShardInterest, this, _1, _2);
+                Face::DataCallback shard_data_callback = boost::bind(&UdpMasterFace::onShardData, this, _1, _2);
+                _shard_services[i]->post([=]() {
+                    shard->listen(shard_notification_callback, shard_interest_callback, shard_data_callback, shard_error_callback);
+                });
+            }
+            _shard_threads.create_thread(boost::bind(&boost::asio::io_service::run, _shard_services[i].get()));
+        }
+        std::stringstream ss;
+        ss << "master face with ID = " << _master_face_id << " dispatching udp://" << _local_endpoint << " over " << _shards.size() << " shards";
+        logger::log(logger::INFO, ss.str());
+        return;
+    }
+    std::stringstream ss;
+    ss << "master face with ID = " << _master_face_id << " listening on udp://" << _local_endpoint;
+    logger::log(logger::INFO, ss.str());
+    _uring = UringService::get(_ios);
+    _xdp = XdpSocket::open(_ios, _local_endpoint.port(), static_cast<uint32_t>(_shard_index),
+                           boost::bind(&UdpMasterFace::onXdpDatagram, shared_from_this(), _1, _2, _3, _4));
+    tick();
+    read();
+}
+
+void UdpMasterFace::close() {
+    _tick_timer.cancel();
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        _shard_services[i]->post(boost::bind(&UdpMasterFace::close, _shards[i]));
+    }
+    if (_uring_receive) {
+        _uring->cancel(_uring_receive);
+        _uring_receive = 0;
+    }
+    if (_xdp) {
+        _xdp->close();
+        _xdp.reset();
+    }
+    _socket.close();
+    auto faces = _face_list.get();
+    for (const auto &face : *faces) {
+        face->close();
+    }
+}
+
+void UdpMasterFace::stopAccepting() {
+    _is_accepting = false;
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        _shard_services[i]->post(boost::bind(&UdpMasterFace::stopAccepting, _shards[i]));
+    }
+}
+
+size_t UdpMasterFace::getQueuedPackets() const {
+    // the sub-faces queue on their master face, the queues of the shards are read as list does
+    size_t packets = _queue.getStats().packets;
+    for (const auto &shard : _shards) {
+        packets += shard->getQueuedPackets();
+    }
+    return packets;
+}
+
+void UdpMasterFace::sendToAllFaces(const std::string &message) {
+    sendToAllFaces(BufferPool::local().copy(message.c_str(), message.length()));
+}
+
+void UdpMasterFace::sendToAllFaces(const ndn::Interest &interest) {
+    sendToAllFaces(Face::getWireBuffer(interest.wireEncode()));
+}
+
+void UdpMasterFace::sendToAllFaces(const ndn::Data &data) {
+    sendToAllFaces(Face::getWireBuffer(data.wireEncode()));
+}
+
+void UdpMasterFace::sendToAllFaces(const std::shared_ptr<const ndn::Buffer> &wire) {
+    // the shard sub-faces can only be walked from the shard thread
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        auto shard = _shards[i];
+        _shard_services[i]->post([shard, wire]() {
+            shard->sendToAllFaces(wire);
+        });
+    }
+    auto faces = _face_list.get();
+    for (const auto &face : *faces) {
+        face->send(wire);
+    }
+}
+
+std::string UdpMasterFace::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"id":)" << _master_face_id << R"(, "protocol":"UDP", "port":)" << _local_endpoint.port();
+    if (!_shards.empty()) {
+        // sub-faces of the shards are owned by other threads, only their queue counters are reported
+        ss << R"(, "shards":[)";
+        for (size_t i = 0; i < _shards.size(); ++i) {
+            if (i > 0) {
+                ss << ", ";
+            }
+            ss << R"({"queue":)" << _shards[i]->_queue.getStats().toJSON() << R"(, "latency":)" << _shards[i]->_queue.getLatency().toJSON()
+               << R"(, "kernel_drops":)" << SocketOptions::getDrops(_shards[i]->_socket_fd) << "}";
+        }
+        ss << "]}";
+        return ss.str();
+    }
+    ss << R"(, "queue":)" << _queue.getStats().toJSON() << R"(, "latency":)" << _queue.getLatency().toJSON()
+       << R"(, "kernel_drops":)" << SocketOptions::getDrops(_socket_fd);
+    if (_uring) {
+        ss << R"(, "uring":)" << _uring->toJSON();
+    }
+    if (_is_segmenting) {
+        ss << R"(, "segmentation":{"sent":)" << _segmented_sent << R"(, "received":)" << _coalesced_received << "}";
+    }
+    if (_xdp) {
+        ss << R"(, "xdp":)" << _xdp->toJSON();
+    }
+    ss << R"(, "faces":[)";
+    bool first = true;
+    auto faces = _face_list.get();
+    for (const auto &face : *faces) {
+        if (first) {
+            first = false;
+        } else {
+            ss << ", ";
+        }
+        ss << face->toJSON();
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+void UdpMasterFace::writeMetrics(MetricsWriter &writer) const {
+    // the sub-faces queue on their master face, with shards only the queues of the shards are reported as in toJSON
+    auto queue = [&](const metrics::Labels &labels, const QueueStats &stats, int fd) {
+        writer.counter("ndn_master_face_kernel_drops_total", "datagrams dropped by the kernel on a full receive buffer", labels,
+                       SocketOptions::getDrops(fd));
+        writer.gauge("ndn_master_face_queued_packets", "packets waiting in the egress queue of the master face", labels, stats.packets);
+        writer.gauge("ndn_master_face_queued_bytes", "bytes waiting in the egress queue of the master face", labels, stats.bytes);
+        const std::pair<const char*, uint64_t> drops[] = {
+                {"interest", stats.dropped_interests}, {"data", stats.dropped_data}, {"expired", stats.expired_interests}};
+        for (const auto &drop : drops) {
+            metrics::Labels drop_labels = labels;
+            drop_labels.emplace_back("reason", drop.first);
+            writer.counter("ndn_master_face_dropped_total", "packets dropped by the egress queue of the master face", drop_labels,
+                           drop.second);
+        }
+    };
+    std::string id = std::to_string(_master_face_id);
+    if (!_shards.empty()) {
+        for (size_t i = 0; i < _shards.size(); ++i) {
+            queue({{"master_face", id}, {"protocol", "UDP"}, {"shard", std::to_string(i)}}, _shards[i]->_queue.getStats(), _shards[i]->_socket_fd);
+        }
+        return;
+    }
+    queue({{"master_face", id}, {"protocol", "UDP"}}, _queue.getStats(), _socket_fd);
+    auto faces = _face_list.get();
+    for (const auto &face : *faces) {
+        face->writeMetrics(writer);
+    }
+}
+
+void UdpMasterFace::addMemoryStats(MemoryStats &stats) const {
+    // the batch buffer as resizeBatch makes it, from the settings the shards are given as well
+    size_t batch_bytes = isBatching() ? _batch_size * (_is_segmenting ? BUFFER_SIZE : BATCH_SLOT_SIZE) : 0;
+    auto add = [&stats, batch_bytes](const UdpMasterFace &master_face) {
+        stats.add("face_buffers", 1, BUFFER_SIZE + batch_bytes);
+        QueueStats queue = master_face._queue.getStats();
+        stats.add("face_queues", queue.packets, queue.bytes);
+        auto faces = master_face._face_list.get();
+        stats.add("udp_sub_faces", faces->size(), faces->size() * memory_usage::ofShared<UdpSubFace>());
+    };
+    if (_shards.empty()) {
+        add(*this);
+    }
+    for (const auto &shard : _shards) {
+        add(*shard);
+    }
+}
+
+void UdpMasterFace::setSocketOptions(const SocketOptions &options) {
+    _socket_options = options;
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        _shard_services[i]->post(boost::bind(&UdpMasterFace::setSocketOptions, _shards[i], options));
+    }
+    if (_shards.empty() && _socket.is_open()) {
+        _socket_options.apply(_socket_fd);
+    }
+}
+
+size_t UdpMasterFace::getBatchSize() const {
+    return _batch_size;
+}
+
+void UdpMasterFace::setBatchSize(size_t batch_size) {
+    batch_size = std::max<size_t>(1, std::min(batch_size, MAX_BATCH_SIZE));
+    if (batch_size == _batch_size) {
+        return;
+    }
+    _batch_size = batch_size;
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        _shard_services[i]->post(boost::bind(&UdpMasterFace::setBatchSize, _shards[i], batch_size));
+    }
+    resizeBatch();
+}
+
+bool UdpMasterFace::isSegmenting() const {
+    return _is_segmenting;
+}
+
+void UdpMasterFace::setSegmentation(bool segmentation) {
+    if (segmentation == _is_segmenting) {
+        return;
+    }
+    _is_segmenting = segmentation;
+    for (size_t i = 0; i < _shards.size(); ++i) {
+        _shard_services[i]->post(boost::bind(&UdpMasterFace::setSegmentation, _shards[i], segmentation));
+    }
+    if (!_shards.empty()) {
+        return;
+    }
+    // io_uring hands the datagrams over as received, it can't cut the coalesced ones
+    int gro = segmentation && !_uring ? 1 : 0;
+    if (::setsockopt(_socket.native_handle(), SOL_UDP, UDP_GRO, &gro, sizeof(gro)) < 0 && gro) {
+        logger::log(logger::WARNING, "UDP_GRO not available on udp://{} ({}), only sending is segmented",
+                    {_local_endpoint.port(), std::strerror(errno)});
+    }
+    resizeBatch();
+}
+
+bool UdpMasterFace::isBatching() const {
+    return _batch_size > 1 || _is_segmenting;
+}
+
+void UdpMasterFace::resizeBatch() {
+    if (!isBatching()) {
+        return;
+    }
+    // a coalesced datagram may take up to 64 KB, it is truncated otherwise
+    _batch_buffer.resize(_batch_size * (_is_segmenting ? BUFFER_SIZE : BATCH_SLOT_SIZE));
+    _batch_addresses.resize(_batch_size);
+    _recv_iovecs.resize(_batch_size);
+    _recv_messages.resize(_batch_size);
+    _recv_controls.resize(_batch_size * CMSG_SPACE(sizeof(int)));
+    _send_iovecs.resize(_batch_size * std::max(LpLink::MAX_AGGREGATED_PACKETS, MAX_SEGMENTS));
+    _send_messages.resize(_batch_size);
+    _send_controls.resize(_batch_size * CMSG_SPACE(sizeof(uint16_t)));
+    _send_counts.resize(_batch_size);
+}
+
+void UdpMasterFace::onShardNotification(const std::shared_ptr<MasterFace> &shard, const std::shared_ptr<Face> &face) {
+    _ios.post(boost::bind(_notification_callback, shared_from_this(), face));
+}
+
+void UdpMasterFace::onShardInterest(const std::shared_ptr<Face> &face, const ndn::Interest &interest) {
+    _ios.post(boost::bind(_interest_callback, face, interest));
+}
+
+void UdpMasterFace::onShardData(const std::shared_ptr<Face> &face, const ndn::Data &data) {
+    _ios.post(boost::bind(_data_callback, face, data));
+}
+
+void UdpMasterFace::onShardPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet) {
+    if (_packet_handler) {
+        PacketHandler packet_handler = _packet_handler;
+        _ios.post([packet_handler, face, packet]() mutable {
+            packet_handler(face, std::move(packet));
+        });
+        return;
+    }
+    _ios.post(boost::bind(_packet_callback, face, packet));
+}
+
+void UdpMasterFace::onShardBurst(const std::shared_ptr<Face> &face, const std::vector<NdnPacket> &packets) {
+    _ios.post(boost::bind(_burst_callback, face, packets));
+}
+
+void UdpMasterFace::onShardError(const std::shared_ptr<MasterFace> &shard, const std::shared_ptr<Face> &face) {
+    _ios.post(boost::bind(_error_callback, shared_from_this(), face));
+}
+
+void UdpMasterFace::scheduleIdleCheck(const std::shared_ptr<UdpSubFace> &face, uint64_t tick) {
+    // never in the past, the current slot is already swept
+    tick = std::max(tick, _tick + 1);
+    _wheel[tick % WHEEL_SIZE].emplace_back(face);
+}
+
+void UdpMasterFace::tick() {
+    _tick_timer.expires_from_now(boost::posix_time::milliseconds(TICK_MS));
+    _tick_timer.async_wait(_strand.wrap(boost::bind(&UdpMasterFace::tickHandler, shared_from_this(), _1)));
+}
+
+void UdpMasterFace::tickHandler(const boost::system::error_code &err) {
+    if (err) {
+        return;
+    }
+    ++_tick;
+    std::vector<std::weak_ptr<UdpSubFace>> due;
+    due.swap(_wheel[_tick % WHEEL_SIZE]);
+    for (const auto &weak_face : due) {
+        auto face = weak_face.lock();
+        if (face) {
+            face->onIdleCheck(_tick);
+        }
+    }
+    tick();
+}
+
+void UdpMasterFace::read() {
+    if (_uring) {
+        // armed once, the receive then completes for every datagram until it is cancelled
+        if (!_uring_receive) {
+            _uring_receive = _uring->receive(_socket.native_handle(), true,
+                                             boost::bind(&UdpMasterFace::onUringDatagram, shared_from_this(), _1, _2, _3, _4),
+                                             boost::bind(&UdpMasterFace::onUringError, shared_from_this(), _1));
+        }
+    } else if (isBatching()) {
+        // only wait for readability, datagrams are pulled by recvmmsg in the handler
+        _socket.async_receive(boost::asio::null_buffers(), _strand.wrap(boost::bind(&UdpMasterFace::readBatchHandler, shared_from_this(), _1)));
+    } else {
+        // on the strand like the writes and the wheel, the sub-faces map is then never walked by two threads
+        _socket.async_receive_from(boost::asio::buffer(_buffer, BUFFER_SIZE), _remote_endpoint,
+                                   _strand.wrap(boost::bind(&UdpMasterFace::readHandler, shared_from_this(), _1, _2)));
+    }
+}
+
+void UdpMasterFace::readHandler(const boost::system::error_code &err, size_t bytes_transferred) {
+    if(!err) {
+        proceedDatagram(_remote_endpoint, _buffer, bytes_transferred);
+        read();
+    } else {
+        std::cerr << "[ERROR] " << err.message() << std::endl;
+    }
+}
+
+void UdpMasterFace::readBatchHandler(const boost::system::error_code &err) {
+    if(!err) {
+        // batch mode may have been disabled while waiting, the pending datagrams are then read one by one
+        if (isBatching()) {
+            size_t slot_size = _is_segmenting ? BUFFER_SIZE : BATCH_SLOT_SIZE;
+            size_t control_size = CMSG_SPACE(sizeof(int));
+            for (size_t i = 0; i < _batch_size; ++i) {
+                _recv_iovecs[i].iov_base = &_batch_buffer[i * slot_size];
+                _recv_iovecs[i].iov_len = slot_size;
+                std::memset(&_recv_messages[i], 0, sizeof(mmsghdr));
+                _recv_messages[i].msg_hdr.msg_name = &_batch_addresses[i];
+                _recv_messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+                _recv_messages[i].msg_hdr.msg_iov = &_recv_iovecs[i];
+                _recv_messages[i].msg_hdr.msg_iovlen = 1;
+                _recv_messages[i].msg_hdr.msg_control = &_recv_controls[i * control_size];
+                _recv_messages[i].msg_hdr.msg_controllen = control_size;
+            }
+            int received = ::recvmmsg(_socket.native_handle(), _recv_messages.data(), _batch_size, MSG_DONTWAIT, nullptr);
+            if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "[ERROR] recvmmsg: " << std::strerror(errno) << std::endl;
+            }
+            for (int i = 0; i < received; ++i) {
+                const msghdr &header = _recv_messages[i].msg_hdr;
+                if (header.msg_flags & MSG_TRUNC) {
+                    continue;
+                }
+                boost::asio::ip::udp::endpoint endpoint;
+                std::memcpy(endpoint.data(), header.msg_name, header.msg_namelen);
+                endpoint.resize(header.msg_namelen);
+                // the datagrams coalesced by GRO all have the size given in the control message but the last
+                size_t segment_size = _recv_messages[i].msg_len;
+                for (cmsghdr *control = CMSG_FIRSTHDR(&header); control; control = CMSG_NXTHDR(const_cast<msghdr *>(&header), control)) {
+                    if (control->cmsg_level == SOL_UDP && control->cmsg_type == UDP_GRO) {
+                        int size;
+                        std::memcpy(&size, CMSG_DATA(control), sizeof(size));
+                        segment_size = size > 0 ? static_cast<size_t>(size) : segment_size;
+                    }
+                }
+                const char *datagram = &_batch_buffer[i * slot_size];
+                const char *end = datagram + _recv_messages[i].msg_len;
+                if (end - datagram > static_cast<ptrdiff_t>(segment_size)) {
+                    _coalesced_received += (end - datagram + segment_size - 1) / segment_size;
+                }
+                for (; datagram < end; datagram += segment_size) {
+                    proceedDatagram(endpoint, datagram, std::min<size_t>(segment_size, end - datagram));
+                }
+            }
+        }
+        read();
+    } else {
+        std::cerr << "[ERROR] " << err.message() << std::endl;
+    }
+}
+
+void UdpMasterFace::onUringDatagram(const uint8_t *data, size_t size, const sockaddr *address, socklen_t address_length) {
+    boost::asio::ip::udp::endpoint endpoint;
+    if (address_length > endpoint.capacity()) {
+        return;
+    }
+    std::memcpy(endpoint.data(), address, address_length);
+    endpoint.resize(address_length);
+    proceedDatagram(endpoint, reinterpret_cast<const char *>(data), size);
+}
+
+void UdpMasterFace::onUringError(int error) {
+    _uring_receive = 0;
+    std::cerr << "[ERROR] io_uring receive: " << std::strerror(-error) << std::endl;
+}
+
+void UdpMasterFace::onXdpDatagram(const uint8_t *data, size_t size, const sockaddr *address, socklen_t address_length) {
+    // the program takes IPv6 as well, the socket which answers is IPv4 only
+    if (address->sa_family != AF_INET) {
+        return;
+    }
+    onUringDatagram(data, size, address, address_length);
+}
+
+void UdpMasterFace::proceedDatagram(const boost::asio::ip::udp::endpoint &endpoint, const char *buffer, size_t size) {
+    std::shared_ptr<UdpSubFace> face;
+    auto it = _faces.find(endpoint);
+    if (it != _faces.end()) {
+        face = it->second;
+        face->proceedPacket(buffer, size);
+    } else if (_is_accepting && _faces.size() < _max_connection) {
+        logger::log(logger::INFO, "new connection from udp://{}", {endpoint});
+        face = std::make_shared<UdpSubFace>(*this, endpoint);
+        openFace(face, boost::bind(&UdpMasterFace::onFaceError, shared_from_this(), _1));
+        _notification_callback(shared_from_this(), face);
+        _faces.emplace(endpoint, face);
+        _face_list.add(face);
+        face->proceedPacket(buffer, size);
+    }
+}
+
+void UdpMasterFace::enqueue(const std::shared_ptr<UdpSubFace> &face, const std::shared_ptr<const ndn::Buffer> &wire) {
+    if (!_inbox.emplace(wire, face)) {
+        // the inbox only absorbs bursts between two drains, the egress queue applies the real limits
+        _strand.post(boost::bind(&UdpSubFace::sendImpl, face, wire));
+        return;
+    }
+    if (!_is_draining.exchange(true)) {
+        _strand.post(boost::bind(&UdpMasterFace::drainInbox, shared_from_this()));
+    }
+}
+
+void UdpMasterFace::drainInbox() {
+    for (;;) {
+        while (auto *message = _inbox.peek(0)) {
+            auto wire = std::move(message->first);
+            auto face = std::move(message->second);
+            _inbox.pop();
+            face->sendImpl(wire);
+        }
+        // a sub-face may have pushed after the last peek but seen the inbox as still being drained
+        _is_draining = false;
+        if (!_inbox.peek(0) || _is_draining.exchange(true)) {
+            return;
+        }
+    }
+}
+
+void UdpMasterFace::sendImpl(const std::shared_ptr<const ndn::Buffer> &wire, const boost::asio::ip::udp::endpoint &endpoint) {
+    // packets of the pending write can't be dropped
+    size_t mtu = LpLink::getMtu();
+    if (wire->size() > mtu) {
+        _fragments.clear();
+        LpLink::fragment(*wire, mtu, _lp_sequence, _fragments);
+        for (auto &fragment : _fragments) {
+            _queue.push(std::make_pair(std::move(fragment), endpoint), _write_count);
+        }
+    } else if (!_queue.push(std::make_pair(wire, endpoint), _write_count)) {
+        return;
+    }
+    if (_write_count == 0 && !_queue.empty()) {
+        write();
+    }
+}
+
+size_t UdpMasterFace::aggregate(size_t first) {
+    if (!LpLink::getAggregation()) {
+        return 1;
+    }
+    size_t mtu = LpLink::getMtu();
+    const auto &endpoint = _queue[first].second;
+    size_t bytes = 0;
+    size_t count = 0;
+    for (size_t i = first; i < _queue.size() && count < LpLink::MAX_AGGREGATED_PACKETS; ++i) {
+        const auto &message = _queue[i];
+        if (count > 0 && (message.second != endpoint || bytes + message.first->size() > mtu || !LpLink::canAggregate(*message.first))) {
+            break;
+        }
+        bytes += message.first->size();
+        ++count;
+        if (!LpLink::canAggregate(*message.first)) {
+            break;
+        }
+    }
+    return count;
+}
+
+size_t UdpMasterFace::segment(size_t first) {
+    const auto &endpoint = _queue[first].second;
+    size_t segment_size = _queue[first].first->size();
+    // a segment past the MTU would need IP fragmentation, which the kernel refuses with segmentation
+    if (segment_size > LpLink::getMtu()) {
+        return 1;
+    }
+    size_t bytes = 0;
+    size_t count = 0;
+    for (size_t i = first; i < _queue.size() && count < MAX_SEGMENTS; ++i) {
+        const auto &message = _queue[i];
+        size_t size = message.first->size();
+        if (count > 0 && (message.second != endpoint || size > segment_size || bytes + size > MAX_SEGMENTED_BYTES)) {
+            break;
+        }
+        bytes += size;
+        ++count;
+        // only the last segment may be shorter, e.g. the last fragment of a packet
+        if (size < segment_size) {
+            break;
+        }
+    }
+    return count;
+}
+
+void UdpMasterFace::write() {
+    if (isBatching()) {
+        // the batch is built once the socket is writable, the queue may have grown meanwhile
+        _write_count = _queue.size();
+        _socket.async_send(boost::asio::null_buffers(), _strand.wrap(boost::bind(&UdpMasterFace::writeBatchHandler, shared_from_this(), _1)));
+    } else {
+        _write_count = aggregate(0);
+        _write_buffers.clear();
+        for (size_t i = 0; i < _write_count; ++i) {
+            _write_buffers.emplace_back(_queue[i].first->data(), _queue[i].first->size());
+        }
+        _socket.async_send_to(_write_buffers, _queue.front().second,
+                              _strand.wrap(boost::bind(&UdpMasterFace::writeHandler, shared_from_this(), _1, _2)));
+    }
+}
+
+void UdpMasterFace::writeHandler(const boost::system::error_code &err, size_t bytesTransferred) {
+    stage_profile::Scope stage(stage_profile::SEND);
+    if(!err) {
+        for (size_t i = 0; i < _write_count; ++i) {
+            _queue.pop_front();
+        }
+        _write_count = 0;
+        if (!_queue.empty()) {
+            write();
+        }
+    } else {
+        std::cerr << err.message() << std::endl;
+    }
+}
+
+void UdpMasterFace::writeBatchHandler(const boost::system::error_code &err) {
+    stage_profile::Scope stage(stage_profile::SEND);
+    if(!err) {
+        if (isBatching()) {
+            // everything backlogged in the queue goes in the same batch
+            size_t count = 0;
+            size_t packets = 0;
+            size_t iovecs = 0;
+            bool is_first_segmented = false;
+            while (count < _batch_size && packets < _queue.size()) {
+                size_t aggregated = aggregate(packets);
+                // packets aggregated in a datagram are smaller than the MTU, segments are full datagrams
+                size_t segments = _is_segmenting && aggregated == 1 ? segment(packets) : 1;
+                std::memset(&_send_messages[count], 0, sizeof(mmsghdr));
+                _send_messages[count].msg_hdr.msg_name = const_cast<sockaddr *>(_queue[packets].second.data());
+                _send_messages[count].msg_hdr.msg_namelen = _queue[packets].second.size();
+                _send_messages[count].msg_hdr.msg_iov = &_send_iovecs[iovecs];
+                if (segments > 1) {
+                    size_t control_size = CMSG_SPACE(sizeof(uint16_t));
+                    msghdr &header = _send_messages[count].msg_hdr;
+                    header.msg_control = &_send_controls[count * control_size];
+                    header.msg_controllen = control_size;
+                    cmsghdr *control = CMSG_FIRSTHDR(&header);
+                    control->cmsg_level = SOL_UDP;
+                    control->cmsg_type = UDP_SEGMENT;
+                    control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    auto segment_size = static_cast<uint16_t>(_queue[packets].first->size());
+                    std::memcpy(CMSG_DATA(control), &segment_size, sizeof(segment_size));
+                    aggregated = segments;
+                    is_first_segmented = is_first_segmented || count == 0;
+                }
+                _send_messages[count].msg_hdr.msg_iovlen = aggregated;
+                for (size_t i = 0; i < aggregated; ++i) {
+                    auto &message = _queue[packets + i];
+                    _send_iovecs[iovecs].iov_base = const_cast<uint8_t *>(message.first->data());
+                    _send_iovecs[iovecs].iov_len = message.first->size();
+                    ++iovecs;
+                }
+                _send_counts[count] = aggregated;
+                packets += aggregated;
+                ++count;
+            }
+            int sent = ::sendmmsg(_socket.native_handle(), _send_messages.data(), count, MSG_DONTWAIT);
+            if (sent > 0) {
+                for (int i = 0; i < sent; ++i) {
+                    if (_send_messages[i].msg_hdr.msg_controllen > 0) {
+                        _segmented_sent += _send_counts[i];
+                    }
+                    for (size_t j = 0; j < _send_counts[i]; ++j) {
+                        _queue.pop_front();
+                    }
+                }
+            } else if (sent < 0 && is_first_segmented && (errno == EINVAL || errno == EIO)) {
+                // segments larger than the MTU of the interface, or no checksum offload, the queue is sent again
+                // without segmentation
+                logger::log(logger::WARNING, "UDP_SEGMENT refused on udp://{} ({}), segmentation disabled",
+                            {_local_endpoint.port(), std::strerror(errno)});
+                setSegmentation(false);
+            } else if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                // the first datagram can't be sent, drop it so the rest of the queue is not blocked
+                std::cerr << "sendmmsg: " << std::strerror(errno) << std::endl;
+                for (size_t j = 0; j < _send_counts[0]; ++j) {
+                    _queue.pop_front();
+                }
+            }
+        } else {
+            // batch mode disabled while waiting, send one datagram
+            auto &message = _queue.front();
+            boost::system::error_code ec;
+            _socket.send_to(boost::asio::buffer(*message.first), message.second, 0, ec);
+            _queue.pop_front();
+        }
+        _write_count = 0;
+        if (!_queue.empty()) {
+            write();
+        }
+    } else {
+        std::cerr << err.message() << std::endl;
+    }
+}
+
+void UdpMasterFace::onFaceError(const std::shared_ptr<Face> &face) {
+    _faces.erase(((UdpSubFace*)face.get())->getEndpoint());
+    _face_list.remove(face);
+    _error_callback(shared_from_this(), face);
+}
+
+
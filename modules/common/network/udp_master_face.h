@@ -0,0 +1,271 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include <sys/socket.h>
+
+#include "master_face.h"
+#include "face.h"
+#include "endpoint_map.h"
+#include "face_list.h"
+#include "lp_link.h"
+#include "mpsc_queue.h"
+#include "socket_options.h"
+#include "uring_service.h"
+#include "xdp_socket.h"
+
+class UdpSubFace;
+
+class UdpMasterFace : public MasterFace, public std::enable_shared_from_this<UdpMasterFace> {
+public:
+    static const size_t BUFFER_SIZE = 1 << 16;
+    // slot size used in batch mode, large enough for any NDN packet
+    static const size_t BATCH_SLOT_SIZE = 1 << 14;
+    static const size_t MAX_BATCH_SIZE = 256;
+    // segmentation offload, the kernel takes up to 64 datagrams of the same size per message and the
+    // coalesced ones received come in a single buffer
+    static const size_t MAX_SEGMENTS = 64;
+    static const size_t MAX_SEGMENTED_BYTES = 60000;
+    static const size_t INBOX_SIZE = 1 << 10;
+    // idle sub-faces are detected by a coarse timer wheel, a probe is sent after 3s without activity
+    // and the sub-face is closed if the next 2s are still silent
+    static const size_t TICK_MS = 250;
+    static const size_t WHEEL_SIZE = 32;
+    static const uint64_t PROBE_TICKS = 3000 / TICK_MS;
+    static const uint64_t CLOSE_TICKS = 2000 / TICK_MS;
+
+    class UdpSubFace : public Face, public std::enable_shared_from_this<UdpSubFace> {
+    private:
+        UdpMasterFace &_master_face;
+
+        boost::asio::ip::udp::endpoint _endpoint;
+        // tick of the master face wheel when the last packet was sent or received
+        uint64_t _last_activity;
+        LpReassembler _reassembler;
+
+    public:
+        UdpSubFace(UdpMasterFace &master_face, const boost::asio::ip::udp::endpoint &endpoint);
+
+        ~UdpSubFace() override = default;
+
+        std::string getUnderlyingProtocol() const override;
+
+        std::string getUnderlyingEndpoint() const override;
+
+        const boost::asio::ip::udp::endpoint& getEndpoint();
+
+        using Face::open;
+
+        void open(const InterestCallback &interest_callback, const DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+        void close() override;
+
+        using Face::send;
+
+        void send(const std::string &message) override;
+
+        void send(const ndn::Interest &interest) override;
+
+        void send(const ndn::Data &data) override;
+
+        void send(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+        // packets of sub-faces are queued on their master face
+        QueueStats getQueueStats() const override;
+
+        void proceedPacket(const char* buffer, size_t size);
+
+        // called by the master face when the sub-face deadline is reached on the wheel
+        void onIdleCheck(uint64_t tick);
+
+        // called on the master face strand
+        void sendImpl(const std::shared_ptr<const ndn::Buffer> &wire);
+
+    private:
+        void closeImpl();
+    };
+
+private:
+    boost::asio::ip::udp::endpoint _local_endpoint;
+    boost::asio::ip::udp::endpoint _remote_endpoint;
+    boost::asio::ip::udp::socket _socket;
+    // for the drop counter of the kernel, read from const methods
+    int _socket_fd = -1;
+    SocketOptions _socket_options;
+    boost::asio::strand _strand;
+    char _buffer[BUFFER_SIZE];
+    // by endpoint for the datagrams received, only used on the receiving thread
+    EndpointMap<UdpSubFace> _faces;
+    // the same faces for the walks made from any thread, see FaceList
+    FaceList<UdpSubFace> _face_list;
+    // datagrams from unknown endpoints are dropped once false
+    std::atomic<bool> _is_accepting{true};
+    bool _queue_in_use = false;
+    EgressQueue<std::pair<std::shared_ptr<const ndn::Buffer>, boost::asio::ip::udp::endpoint>> _queue;
+    // queued packets submitted by the pending write, consecutive ones to the same endpoint can share a datagram
+    std::vector<boost::asio::const_buffer> _write_buffers;
+    size_t _write_count = 0;
+    uint64_t _lp_sequence = 0;
+    std::vector<std::shared_ptr<const ndn::Buffer>> _fragments;
+    // sub-faces push here from any thread without the strand, only the one which finds it idle posts drainInbox()
+    MpscQueue<std::pair<std::shared_ptr<const ndn::Buffer>, std::shared_ptr<UdpSubFace>>> _inbox;
+    std::atomic<bool> _is_draining;
+
+    // batch mode, up to _batch_size datagrams are received or sent per syscall (recvmmsg/sendmmsg)
+    size_t _batch_size = 1;
+    std::vector<char> _batch_buffer;
+    std::vector<sockaddr_storage> _batch_addresses;
+    std::vector<iovec> _recv_iovecs;
+    std::vector<mmsghdr> _recv_messages;
+    std::vector<iovec> _send_iovecs;
+    std::vector<mmsghdr> _send_messages;
+    // queued packets in each message of the batch
+    std::vector<size_t> _send_counts;
+
+    // UDP_SEGMENT and UDP_GRO, the queued packets to the same endpoint with the size of the first go in one message,
+    // cut by the kernel or the NIC. the datagrams then go through the batch path even with a batch size of 1
+    bool _is_segmenting = false;
+    std::vector<char> _send_controls;
+    std::vector<char> _recv_controls;
+    size_t _segmented_sent = 0;
+    size_t _coalesced_received = 0;
+
+    // io_uring backend, a single multishot receive replaces the read() loop and the batch mode for ingress
+    std::shared_ptr<UringService> _uring;
+    uint64_t _uring_receive = 0;
+    // AF_XDP backend, the datagrams it takes off the NIC queue of the shard never reach the socket, which still gets
+    // the rest and sends
+    std::shared_ptr<XdpSocket> _xdp;
+
+    // activity only updates a timestamp, each wheel slot holds the sub-faces to check at its tick,
+    // the ones which were active meanwhile are moved to the slot of their new deadline
+    boost::asio::deadline_timer _tick_timer;
+    uint64_t _tick = 0;
+    std::vector<std::vector<std::weak_ptr<UdpSubFace>>> _wheel;
+
+    // sharded mode, this master face only forwards to shards bound on the same port with SO_REUSEPORT,
+    // each shard runs alone on its own io_service thread and the callbacks are posted back to _ios
+    struct ShardTag {
+        size_t index;
+    };
+    size_t _shard_index = 0;
+    std::vector<std::unique_ptr<boost::asio::io_service>> _shard_services;
+    std::vector<std::unique_ptr<boost::asio::io_service::work>> _shard_works;
+    std::vector<std::shared_ptr<UdpMasterFace>> _shards;
+    boost::thread_group _shard_threads;
+
+    UdpMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port, ShardTag);
+
+public:
+    // with several shards the kernel spreads remote endpoints across shard sockets
+    UdpMasterFace(boost::asio::io_service &ios, size_t max_connection, uint16_t port, size_t shards = 1);
+
+    ~UdpMasterFace() override;
+
+    std::string getUnderlyingProtocol() const override;
+
+    void listen(const NotificationCallback &notification_callback, const Face::InterestCallback &interest_callback,
+                const Face::DataCallback &data_callback, const ErrorCallback &error_callback) override;
+
+    using MasterFace::listen;
+
+    void close() override;
+
+    void stopAccepting() override;
+
+    size_t getQueuedPackets() const override;
+
+    void sendToAllFaces(const std::string &message) override;
+
+    void sendToAllFaces(const ndn::Interest &interest) override;
+
+    void sendToAllFaces(const ndn::Data &data) override;
+
+    void sendToAllFaces(const std::shared_ptr<const ndn::Buffer> &wire) override;
+
+    using MasterFace::sendToAllFaces;
+
+    std::string toJSON() const override;
+
+    void writeMetrics(MetricsWriter &writer) const override;
+
+    // the sub-faces hold nothing but their endpoint, the buffers and the queue are those of the master face or of
+    // its shards
+    void addMemoryStats(MemoryStats &stats) const override;
+
+    void setSocketOptions(const SocketOptions &options) override;
+
+    size_t getBatchSize() const;
+
+    // a batch size of 1 disables batch mode
+    void setBatchSize(size_t batch_size);
+
+    bool isSegmenting() const;
+
+    // only effective on Linux 4.18+ (5.0+ for the receive side), the datagrams must fit in the MTU of the interface,
+    // segmentation is disabled again if the kernel refuses them
+    void setSegmentation(bool segmentation);
+
+private:
+    void onShardNotification(const std::shared_ptr<MasterFace> &shard, const std::shared_ptr<Face> &face);
+
+    void onShardInterest(const std::shared_ptr<Face> &face, const ndn::Interest &interest);
+
+    void onShardData(const std::shared_ptr<Face> &face, const ndn::Data &data);
+
+    void onShardPacket(const std::shared_ptr<Face> &face, const NdnPacket &packet);
+
+    void onShardBurst(const std::shared_ptr<Face> &face, const std::vector<NdnPacket> &packets);
+
+    void onShardError(const std::shared_ptr<MasterFace> &shard, const std::shared_ptr<Face> &face);
+
+    void scheduleIdleCheck(const std::shared_ptr<UdpSubFace> &face, uint64_t tick);
+
+    void tick();
+
+    void tickHandler(const boost::system::error_code &err);
+
+    void read();
+
+    void readHandler(const boost::system::error_code &err, size_t bytes_transferred);
+
+    void readBatchHandler(const boost::system::error_code &err);
+
+    void onUringDatagram(const uint8_t *data, size_t size, const sockaddr *address, socklen_t address_length);
+
+    void onUringError(int error);
+
+    bool isBatching() const;
+
+    // sizes the buffers of the batch path for the batch size and the segmentation
+    void resizeBatch();
+
+    // number of queued packets from first which go in the same message as segments
+    size_t segment(size_t first);
+
+    void onXdpDatagram(const uint8_t *data, size_t size, const sockaddr *address, socklen_t address_length);
+
+    void proceedDatagram(const boost::asio::ip::udp::endpoint &endpoint, const char *buffer, size_t size);
+
+    void enqueue(const std::shared_ptr<UdpSubFace> &face, const std::shared_ptr<const ndn::Buffer> &wire);
+
+    void drainInbox();
+
+    void sendImpl(const std::shared_ptr<const ndn::Buffer> &wire, const boost::asio::ip::udp::endpoint &endpoint);
+
+    // number of queued packets from first which go in the same datagram
+    size_t aggregate(size_t first);
+
+    void write();
+
+    void writeHandler(const boost::system::error_code &err, size_t bytesTransferred);
+
+    void writeBatchHandler(const boost::system::error_code &err);
+
+    void onFaceError(const std::shared_ptr<Face> &face);
+};
\ No newline at end of file
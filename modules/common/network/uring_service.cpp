@@ -0,0 +1,401 @@
+#include "uring_service.h"
+
+#include <boost/bind.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+#endif
+
+#include "../log/logger.h"
+
+// multishot receives are the newest feature used (kernel and headers >= 6.0), the backend is not built without them
+#if defined(IORING_RECV_MULTISHOT) && defined(__NR_io_uring_setup)
+#define NDNMS_HAS_URING
+#endif
+
+std::atomic<bool> UringService::_is_enabled(false);
+
+UringService::UringService(boost::asio::io_service &ios)
+        : _ios(ios)
+        , _event_descriptor(ios) {
+
+}
+
+UringService::~UringService() {
+    teardown();
+}
+
+bool UringService::enable() {
+    if (!_is_enabled) {
+        // probe with a throwaway ring, the faces only ask for a ring once enabled
+        boost::asio::io_service ios;
+        UringService probe(ios);
+        _is_enabled = probe.setup();
+    }
+    return _is_enabled;
+}
+
+bool UringService::isEnabled() {
+    return _is_enabled;
+}
+
+std::string UringService::getBackend() {
+    return _is_enabled ? "io_uring" : "epoll";
+}
+
+std::shared_ptr<UringService> UringService::get(boost::asio::io_service &ios) {
+    static std::mutex mutex;
+    static std::map<boost::asio::io_service*, std::weak_ptr<UringService>> services;
+
+    if (!_is_enabled) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto &weak_service = services[&ios];
+    auto service = weak_service.lock();
+    if (!service) {
+        service = std::make_shared<UringService>(ios);
+        if (!service->setup()) {
+            logger::log(logger::ERROR, "can't set up io_uring, faces fall back to epoll");
+            return nullptr;
+        }
+        weak_service = service;
+        ios.post(boost::bind(&UringService::wait, service));
+    }
+    return service;
+}
+
+uint64_t UringService::receive(int fd, bool with_address, const ReceiveHandler &receive_handler, const ErrorHandler &error_handler) {
+    uint64_t id = _next_id++;
+    auto &receive = _receives[id];
+    receive.fd = fd;
+    receive.with_address = with_address;
+    receive.is_cancelled = false;
+    receive.receive_handler = receive_handler;
+    receive.error_handler = error_handler;
+    if (!submitReceive(id, receive)) {
+        _receives.erase(id);
+        return 0;
+    }
+    return id;
+}
+
+void UringService::cancel(uint64_t id) {
+    auto it = _receives.find(id);
+    if (it == _receives.end() || it->second.is_cancelled) {
+        return;
+    }
+    it->second.is_cancelled = true;
+    // the handlers may hold the face, they are released now, the entry goes away with the last completion
+    it->second.receive_handler = nullptr;
+    it->second.error_handler = nullptr;
+    if (!submitCancel(id)) {
+        _receives.erase(it);
+    }
+}
+
+std::string UringService::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"receives":)" << _receives.size() << R"(, "completions":)" << _completions << R"(, "wakeups":)" << _wakeups << "}";
+    return ss.str();
+}
+
+#ifdef NDNMS_HAS_URING
+
+bool UringService::setup() {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    // every data completion holds a buffer, so a completion queue twice the buffer count can't overflow in practice
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = 2 * BUFFER_COUNT;
+    _ring_fd = (int)syscall(__NR_io_uring_setup, ENTRIES, &params);
+    if (_ring_fd < 0) {
+        return false;
+    }
+
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    _sq_ring = mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+    _cq_ring = mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_CQ_RING);
+    _sqes = mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES);
+    if (_sq_ring == MAP_FAILED || _cq_ring == MAP_FAILED || _sqes == MAP_FAILED) {
+        return false;
+    }
+    auto *sq = static_cast<uint8_t *>(_sq_ring);
+    auto *cq = static_cast<uint8_t *>(_cq_ring);
+    _sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    _sq_mask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    _sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    _sq_flags = reinterpret_cast<unsigned *>(sq + params.sq_off.flags);
+    _cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    _cq_mask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    _cqes = cq + params.cq_off.cqes;
+
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd < 0 || syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_EVENTFD, &_event_fd, 1) < 0) {
+        return false;
+    }
+    _event_descriptor.assign(_event_fd);
+
+    // the buffer ring must be page aligned, an anonymous mapping is
+    _buffer_ring_size = BUFFER_COUNT * sizeof(io_uring_buf);
+    _buffer_ring = mmap(nullptr, _buffer_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (_buffer_ring == MAP_FAILED) {
+        return false;
+    }
+    // faulted in before the kernel maps it, else it may keep the zero page while our writes go to a private copy
+    std::memset(_buffer_ring, 0, _buffer_ring_size);
+    io_uring_buf_reg registration;
+    std::memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uint64_t>(_buffer_ring);
+    registration.ring_entries = BUFFER_COUNT;
+    registration.bgid = 0;
+    if (syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+        return false;
+    }
+    _buffers.resize(BUFFER_COUNT * BUFFER_SIZE);
+    for (unsigned i = 0; i < BUFFER_COUNT; ++i) {
+        provideBuffer(i);
+    }
+    return true;
+}
+
+void UringService::teardown() {
+    boost::system::error_code ec;
+    if (_event_descriptor.is_open()) {
+        _event_descriptor.close(ec);
+    } else if (_event_fd >= 0) {
+        ::close(_event_fd);
+    }
+    _event_fd = -1;
+    if (_ring_fd >= 0) {
+        // closing the ring cancels what is still in flight
+        ::close(_ring_fd);
+        _ring_fd = -1;
+    }
+    if (_sq_ring && _sq_ring != MAP_FAILED) {
+        munmap(_sq_ring, _sq_ring_size);
+    }
+    if (_cq_ring && _cq_ring != MAP_FAILED) {
+        munmap(_cq_ring, _cq_ring_size);
+    }
+    if (_sqes && _sqes != MAP_FAILED) {
+        munmap(_sqes, _sqes_size);
+    }
+    if (_buffer_ring && _buffer_ring != MAP_FAILED) {
+        munmap(_buffer_ring, _buffer_ring_size);
+    }
+    _sq_ring = _cq_ring = _sqes = _buffer_ring = nullptr;
+}
+
+void UringService::provideBuffer(unsigned id) {
+    // io_uring_buf_ring is not used, its flexible array member is shifted by the C++ expansion of the header,
+    // the ring is an array of io_uring_buf whose first reserved field holds the tail
+    auto *ring = static_cast<io_uring_buf *>(_buffer_ring);
+    io_uring_buf &buffer = ring[_buffer_tail & (BUFFER_COUNT - 1)];
+    buffer.addr = reinterpret_cast<uint64_t>(&_buffers[id * BUFFER_SIZE]);
+    buffer.len = BUFFER_SIZE;
+    buffer.bid = (uint16_t)id;
+    ++_buffer_tail;
+    __atomic_store_n(&ring[0].resv, (uint16_t)_buffer_tail, __ATOMIC_RELEASE);
+}
+
+bool UringService::submitReceive(uint64_t id, Receive &receive) {
+    auto *sqe = static_cast<io_uring_sqe *>(getSqe());
+    if (!sqe) {
+        return false;
+    }
+    sqe->fd = receive.fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->user_data = id;
+    if (receive.with_address) {
+        // the kernel only reads the header sizes, the name and the payload are written in the selected buffer
+        std::memset(&receive.header, 0, sizeof(receive.header));
+        receive.header.msg_namelen = sizeof(sockaddr_storage);
+        sqe->opcode = IORING_OP_RECVMSG;
+        sqe->addr = reinterpret_cast<uint64_t>(&receive.header);
+    } else {
+        sqe->opcode = IORING_OP_RECV;
+    }
+    return submit();
+}
+
+bool UringService::submitCancel(uint64_t id) {
+    auto *sqe = static_cast<io_uring_sqe *>(getSqe());
+    if (!sqe) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = id;
+    // ids of receives start at 1, the completion of the cancel itself is ignored
+    sqe->user_data = 0;
+    return submit();
+}
+
+void *UringService::getSqe() {
+    // entries are submitted one by one, the kernel consumed all of them when io_uring_enter returned
+    unsigned tail = *_sq_tail;
+    unsigned head = __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head > *_sq_mask) {
+        return nullptr;
+    }
+    unsigned index = tail & *_sq_mask;
+    _sq_array[index] = index;
+    auto *sqe = static_cast<io_uring_sqe *>(_sqes) + index;
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    return sqe;
+}
+
+bool UringService::submit() {
+    __atomic_store_n(_sq_tail, *_sq_tail + 1, __ATOMIC_RELEASE);
+    if (syscall(__NR_io_uring_enter, _ring_fd, 1, 0, 0, nullptr, 0) < 0) {
+        std::stringstream ss;
+        ss << "io_uring_enter: " << std::strerror(errno);
+        logger::log(logger::ERROR, ss.str());
+        return false;
+    }
+    return true;
+}
+
+void UringService::wait() {
+    // completions posted before the first wait are reaped too, the eventfd counter is only a wake up
+    reap();
+    _event_descriptor.async_read_some(boost::asio::buffer(&_event_value, sizeof(_event_value)),
+                                      boost::bind(&UringService::waitHandler, shared_from_this(), _1));
+}
+
+void UringService::waitHandler(const boost::system::error_code &err) {
+    if (err) {
+        return;
+    }
+    ++_wakeups;
+    wait();
+}
+
+void UringService::reap() {
+    auto *cqes = static_cast<io_uring_cqe *>(_cqes);
+    unsigned head = *_cq_head;
+    unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const io_uring_cqe &cqe = cqes[head & *_cq_mask];
+        uint64_t id = cqe.user_data;
+        int result = cqe.res;
+        unsigned flags = cqe.flags;
+        __atomic_store_n(_cq_head, ++head, __ATOMIC_RELEASE);
+        ++_completions;
+
+        unsigned buffer_id = flags >> IORING_CQE_BUFFER_SHIFT;
+        bool has_buffer = (flags & IORING_CQE_F_BUFFER) && buffer_id < BUFFER_COUNT;
+        auto it = _receives.find(id);
+        if (it != _receives.end() && !it->second.is_cancelled && result > 0 && has_buffer) {
+            // handlers may arm or cancel receives, the entry is looked up again afterwards
+            const uint8_t *buffer = &_buffers[buffer_id * BUFFER_SIZE];
+            ReceiveHandler handler = it->second.receive_handler;
+            if (it->second.with_address) {
+                const auto *out = reinterpret_cast<const io_uring_recvmsg_out *>(buffer);
+                const uint8_t *name = buffer + sizeof(io_uring_recvmsg_out);
+                const uint8_t *payload = name + it->second.header.msg_namelen + it->second.header.msg_controllen;
+                if (!(out->flags & MSG_TRUNC) && out->namelen <= it->second.header.msg_namelen) {
+                    handler(payload, out->payloadlen, reinterpret_cast<const sockaddr *>(name), out->namelen);
+                }
+            } else {
+                handler(buffer, (size_t)result, nullptr, 0);
+            }
+        }
+        if (has_buffer) {
+            provideBuffer(buffer_id);
+        }
+
+        if (!(flags & IORING_CQE_F_MORE) && id != 0) {
+            it = _receives.find(id);
+            if (it == _receives.end()) {
+                continue;
+            }
+            bool is_end_of_stream = result == 0 && !it->second.with_address;
+            if (it->second.is_cancelled) {
+                _receives.erase(it);
+            } else if ((result >= 0 && !is_end_of_stream) || result == -ENOBUFS) {
+                // the kernel may stop a multishot receive, for instance when it runs out of buffers
+                if (!submitReceive(id, it->second)) {
+                    ErrorHandler handler = std::move(it->second.error_handler);
+                    _receives.erase(it);
+                    handler(-EIO);
+                }
+            } else {
+                ErrorHandler handler = std::move(it->second.error_handler);
+                _receives.erase(it);
+                handler(result);
+            }
+        }
+        if (head == tail) {
+            if (__atomic_load_n(_sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) {
+                // completions which didn't fit are kept by the kernel until asked for, ending multishot receives
+                syscall(__NR_io_uring_enter, _ring_fd, 0, 0, IORING_ENTER_GETEVENTS, nullptr, 0);
+            }
+            tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        }
+    }
+}
+
+#else
+
+bool UringService::setup() {
+    return false;
+}
+
+void UringService::teardown() {
+
+}
+
+void UringService::provideBuffer(unsigned id) {
+
+}
+
+bool UringService::submitReceive(uint64_t id, Receive &receive) {
+    return false;
+}
+
+bool UringService::submitCancel(uint64_t id) {
+    return false;
+}
+
+void *UringService::getSqe() {
+    return nullptr;
+}
+
+bool UringService::submit() {
+    return false;
+}
+
+void UringService::wait() {
+
+}
+
+void UringService::waitHandler(const boost::system::error_code &err) {
+
+}
+
+void UringService::reap() {
+
+}
+
+#endif
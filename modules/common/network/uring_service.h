@@ -0,0 +1,125 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/socket.h>
+
+// optional receive backend for the faces, selected at startup with enable()
+//
+// there is one ring per io_service, completions are signalled on an eventfd watched by that io_service so the ring
+// is driven from the same thread as the asio handlers, the io_service must therefore be run by a single thread
+// (every _ST module, the UDP shards). receives are multishot: armed once, they pick buffers in a ring registered
+// with the kernel and keep completing until cancelled, there is no syscall per packet besides the eventfd read
+// shared by all the completions available at once. sends stay on the asio reactor, already batched by the faces.
+class UringService : public std::enable_shared_from_this<UringService> {
+public:
+    static const unsigned ENTRIES = 256;
+    static const unsigned BUFFER_COUNT = 1024;
+    // large enough for an NDN packet behind the recvmsg header and the source address
+    static const size_t BUFFER_SIZE = 1 << 14;
+
+    // data is only valid during the call, address is null for stream sockets
+    using ReceiveHandler = std::function<void(const uint8_t *data, size_t size, const sockaddr *address, socklen_t address_length)>;
+    // -errno, or 0 when the peer closed the stream, the receive is over and won't call its handlers again
+    using ErrorHandler = std::function<void(int error)>;
+
+private:
+    struct Receive {
+        int fd;
+        bool with_address;
+        bool is_cancelled;
+        msghdr header;
+        ReceiveHandler receive_handler;
+        ErrorHandler error_handler;
+    };
+
+    static std::atomic<bool> _is_enabled;
+
+    boost::asio::io_service &_ios;
+    int _ring_fd = -1;
+    int _event_fd = -1;
+    boost::asio::posix::stream_descriptor _event_descriptor;
+    uint64_t _event_value = 0;
+
+    // kernel shared rings
+    void *_sq_ring = nullptr;
+    size_t _sq_ring_size = 0;
+    void *_cq_ring = nullptr;
+    size_t _cq_ring_size = 0;
+    void *_sqes = nullptr;
+    size_t _sqes_size = 0;
+    unsigned *_sq_head;
+    unsigned *_sq_tail;
+    unsigned *_sq_mask;
+    unsigned *_sq_array;
+    unsigned *_sq_flags;
+    unsigned *_cq_head;
+    unsigned *_cq_tail;
+    unsigned *_cq_mask;
+    void *_cqes;
+
+    // provided buffers, given back to the kernel once their completion is handled
+    void *_buffer_ring = nullptr;
+    size_t _buffer_ring_size = 0;
+    std::vector<uint8_t> _buffers;
+    unsigned _buffer_tail = 0;
+
+    uint64_t _next_id = 1;
+    std::unordered_map<uint64_t, Receive> _receives;
+
+    size_t _completions = 0;
+    size_t _wakeups = 0;
+
+public:
+    explicit UringService(boost::asio::io_service &ios);
+
+    ~UringService();
+
+    // return false if the kernel or the build can't provide io_uring, faces then stay on the asio reactor
+    static bool enable();
+
+    static bool isEnabled();
+
+    // "io_uring" or "epoll", for the logs and the list replies
+    static std::string getBackend();
+
+    // ring of the given io_service, created on first use, null if the backend is not enabled
+    static std::shared_ptr<UringService> get(boost::asio::io_service &ios);
+
+    // multishot receive on a socket, with the source address of each datagram if with_address,
+    // return an id for cancel(), 0 if the receive can't be submitted
+    uint64_t receive(int fd, bool with_address, const ReceiveHandler &receive_handler, const ErrorHandler &error_handler);
+
+    // no handler of the receive is called after this, the socket can then be closed
+    void cancel(uint64_t id);
+
+    std::string toJSON() const;
+
+private:
+    bool setup();
+
+    void teardown();
+
+    void provideBuffer(unsigned id);
+
+    bool submitReceive(uint64_t id, Receive &receive);
+
+    bool submitCancel(uint64_t id);
+
+    void *getSqe();
+
+    bool submit();
+
+    void wait();
+
+    void waitHandler(const boost::system::error_code &err);
+
+    void reap();
+};
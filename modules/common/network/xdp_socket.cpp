@@ -0,0 +1,550 @@
+#include "xdp_socket.h"
+
+#include <boost/bind.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/bpf.h>
+#include <linux/if_xdp.h>
+#endif
+
+#include "../log/logger.h"
+
+// the wakeup flags of the rings are the newest feature used, the XDP links came with them (headers >= 5.9)
+#if defined(XDP_USE_NEED_WAKEUP) && defined(__NR_bpf)
+#define NDNMS_HAS_XDP
+#endif
+
+#ifndef AF_XDP
+#define AF_XDP 44
+#endif
+
+#ifndef SOL_XDP
+#define SOL_XDP 283
+#endif
+
+std::atomic<bool> XdpSocket::_is_enabled(false);
+std::string XdpSocket::_interface;
+uint32_t XdpSocket::_first_queue = 0;
+
+// the program of the interface and the map of its sockets by queue, shared by the sockets of the process
+struct XdpSocket::Program {
+    static const uint32_t MAX_QUEUES = 64;
+
+    unsigned ifindex = 0;
+    uint16_t port = 0;
+    int map_fd = -1;
+    int prog_fd = -1;
+    int link_fd = -1;
+
+    ~Program() {
+        // the program is detached with its link
+        for (int fd : {link_fd, prog_fd, map_fd}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    bool load();
+
+    bool insert(uint32_t queue, int fd);
+
+    void remove(uint32_t queue);
+
+    static std::shared_ptr<Program> get(unsigned ifindex, uint16_t port);
+};
+
+XdpSocket::XdpSocket(boost::asio::io_service &ios, uint16_t port, uint32_t queue)
+        : _ios(ios)
+        , _port(port)
+        , _queue(queue)
+        , _descriptor(ios) {
+
+}
+
+XdpSocket::~XdpSocket() {
+    teardown();
+}
+
+bool XdpSocket::enable(const std::string &interface) {
+#ifdef NDNMS_HAS_XDP
+    size_t colon = interface.find(':');
+    std::string name = interface.substr(0, colon);
+    if (if_nametoindex(name.c_str()) == 0) {
+        return false;
+    }
+    _interface = name;
+    _first_queue = colon != std::string::npos ? static_cast<uint32_t>(std::strtoul(interface.c_str() + colon + 1, nullptr, 10)) : 0;
+    _is_enabled = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool XdpSocket::isEnabled() {
+    return _is_enabled;
+}
+
+std::shared_ptr<XdpSocket> XdpSocket::open(boost::asio::io_service &ios, uint16_t port, uint32_t shard, const ReceiveHandler &handler) {
+    if (!_is_enabled) {
+        return nullptr;
+    }
+    auto socket = std::make_shared<XdpSocket>(ios, port, _first_queue + shard);
+    socket->_handler = handler;
+    if (!socket->setup()) {
+        logger::log(logger::ERROR, "can't set up AF_XDP on {} queue {} ({}), udp port {} is read from its socket",
+                    {_interface, socket->_queue, std::strerror(errno), port});
+        return nullptr;
+    }
+    logger::log(logger::INFO, "udp port {} read from {} queue {} in {} mode",
+                {port, _interface, socket->_queue, socket->_is_zero_copy ? "zero-copy" : "copy"});
+    ios.post(boost::bind(&XdpSocket::wait, socket));
+    return socket;
+}
+
+void XdpSocket::close() {
+    _is_closed = true;
+    _handler = nullptr;
+    if (_program) {
+        _program->remove(_queue);
+    }
+    boost::system::error_code ec;
+    _descriptor.cancel(ec);
+}
+
+std::string XdpSocket::toJSON() const {
+    std::stringstream ss;
+    ss << R"({"interface":")" << _interface << R"(", "queue":)" << _queue << R"(, "mode":")" << (_is_zero_copy ? "zero-copy" : "copy")
+       << R"(", "frames":)" << _frames << R"(, "wakeups":)" << _wakeups << R"(, "dropped":)" << _dropped << "}";
+    return ss.str();
+}
+
+void XdpSocket::proceedFrame(const uint8_t *frame, size_t size) {
+    // the program only lets through what it checked, the headers are read again without trusting it
+    static const size_t ETHERNET = 14;
+    static const size_t UDP = 8;
+    if (size < ETHERNET + 20 + UDP) {
+        ++_dropped;
+        return;
+    }
+    uint16_t ether_type = static_cast<uint16_t>(frame[12] << 8 | frame[13]);
+    sockaddr_storage address;
+    std::memset(&address, 0, sizeof(address));
+    socklen_t address_length;
+    const uint8_t *udp;
+    if (ether_type == 0x0800 && frame[ETHERNET] == 0x45 && frame[ETHERNET + 9] == IPPROTO_UDP) {
+        udp = frame + ETHERNET + 20;
+        auto *source = reinterpret_cast<sockaddr_in *>(&address);
+        source->sin_family = AF_INET;
+        std::memcpy(&source->sin_addr, frame + ETHERNET + 12, 4);
+        std::memcpy(&source->sin_port, udp, 2);
+        address_length = sizeof(sockaddr_in);
+    } else if (ether_type == 0x86dd && size >= ETHERNET + 40 + UDP && frame[ETHERNET + 6] == IPPROTO_UDP) {
+        udp = frame + ETHERNET + 40;
+        auto *source = reinterpret_cast<sockaddr_in6 *>(&address);
+        source->sin6_family = AF_INET6;
+        std::memcpy(&source->sin6_addr, frame + ETHERNET + 8, 16);
+        std::memcpy(&source->sin6_port, udp, 2);
+        address_length = sizeof(sockaddr_in6);
+    } else {
+        ++_dropped;
+        return;
+    }
+    uint16_t port = static_cast<uint16_t>(udp[2] << 8 | udp[3]);
+    size_t length = static_cast<size_t>(udp[4] << 8 | udp[5]);
+    // short frames are padded up to the Ethernet minimum, the UDP length tells where the datagram ends
+    if (port != _port || length < UDP || udp + length > frame + size) {
+        ++_dropped;
+        return;
+    }
+    _handler(udp + UDP, length - UDP, reinterpret_cast<const sockaddr *>(&address), address_length);
+}
+
+#ifdef NDNMS_HAS_XDP
+
+namespace {
+    long bpf(int command, bpf_attr &attr) {
+        return syscall(__NR_bpf, command, &attr, sizeof(attr));
+    }
+
+    // the few instructions of the program, jumps go to labels resolved once it is written
+    class Assembler {
+    private:
+        std::vector<bpf_insn> _instructions;
+        std::map<int, size_t> _labels;
+        std::vector<std::pair<size_t, int>> _jumps;
+
+        void emit(uint8_t code, uint8_t dst, uint8_t src, int16_t off, int32_t imm) {
+            bpf_insn instruction;
+            std::memset(&instruction, 0, sizeof(instruction));
+            instruction.code = code;
+            instruction.dst_reg = dst;
+            instruction.src_reg = src;
+            instruction.off = off;
+            instruction.imm = imm;
+            _instructions.push_back(instruction);
+        }
+
+    public:
+        void label(int label) {
+            _labels[label] = _instructions.size();
+        }
+
+        void move(uint8_t dst, uint8_t src) {
+            emit(BPF_ALU64 | BPF_MOV | BPF_X, dst, src, 0, 0);
+        }
+
+        void moveImmediate(uint8_t dst, int32_t imm) {
+            emit(BPF_ALU64 | BPF_MOV | BPF_K, dst, 0, 0, imm);
+        }
+
+        void add(uint8_t dst, int32_t imm) {
+            emit(BPF_ALU64 | BPF_ADD | BPF_K, dst, 0, 0, imm);
+        }
+
+        void bitAnd(uint8_t dst, int32_t imm) {
+            emit(BPF_ALU64 | BPF_AND | BPF_K, dst, 0, 0, imm);
+        }
+
+        void load(uint8_t size, uint8_t dst, uint8_t src, int16_t off) {
+            emit(BPF_LDX | size | BPF_MEM, dst, src, off, 0);
+        }
+
+        void loadMap(uint8_t dst, int fd) {
+            emit(BPF_LD | BPF_DW | BPF_IMM, dst, BPF_PSEUDO_MAP_FD, 0, fd);
+            emit(0, 0, 0, 0, 0);
+        }
+
+        void jumpIf(uint8_t op, uint8_t dst, int32_t imm, int label) {
+            _jumps.emplace_back(_instructions.size(), label);
+            emit(BPF_JMP | op | BPF_K, dst, 0, 0, imm);
+        }
+
+        void jumpIfRegister(uint8_t op, uint8_t dst, uint8_t src, int label) {
+            _jumps.emplace_back(_instructions.size(), label);
+            emit(BPF_JMP | op | BPF_X, dst, src, 0, 0);
+        }
+
+        void jump(int label) {
+            _jumps.emplace_back(_instructions.size(), label);
+            emit(BPF_JMP | BPF_JA, 0, 0, 0, 0);
+        }
+
+        void call(int32_t helper) {
+            emit(BPF_JMP | BPF_CALL, 0, 0, 0, helper);
+        }
+
+        void exit() {
+            emit(BPF_JMP | BPF_EXIT, 0, 0, 0, 0);
+        }
+
+        const std::vector<bpf_insn>& finish() {
+            for (const auto &jump : _jumps) {
+                _instructions[jump.first].off = static_cast<int16_t>(_labels[jump.second] - jump.first - 1);
+            }
+            return _instructions;
+        }
+    };
+}
+
+bool XdpSocket::Program::load() {
+    bpf_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_type = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size = sizeof(uint32_t);
+    attr.value_size = sizeof(int);
+    attr.max_entries = MAX_QUEUES;
+    map_fd = static_cast<int>(bpf(BPF_MAP_CREATE, attr));
+    if (map_fd < 0) {
+        return false;
+    }
+
+    // the UDP datagrams to port go to the socket of their queue, anything else or a queue without socket to the
+    // kernel. the lengths are checked before each read for the verifier
+    enum { PASS, IPV6, REDIRECT };
+    const int port_be = htons(port);
+    Assembler program;
+    program.move(BPF_REG_6, BPF_REG_1);
+    program.load(BPF_W, BPF_REG_2, BPF_REG_6, offsetof(xdp_md, data));
+    program.load(BPF_W, BPF_REG_3, BPF_REG_6, offsetof(xdp_md, data_end));
+    program.move(BPF_REG_4, BPF_REG_2);
+    program.add(BPF_REG_4, 14 + 20 + 8);
+    program.jumpIfRegister(BPF_JGT, BPF_REG_4, BPF_REG_3, PASS);
+    program.load(BPF_H, BPF_REG_5, BPF_REG_2, 12);
+    program.jumpIf(BPF_JNE, BPF_REG_5, htons(0x0800), IPV6);
+    // version 4 without options, not a fragment, UDP to port
+    program.load(BPF_B, BPF_REG_5, BPF_REG_2, 14);
+    program.jumpIf(BPF_JNE, BPF_REG_5, 0x45, PASS);
+    program.load(BPF_H, BPF_REG_5, BPF_REG_2, 14 + 6);
+    program.bitAnd(BPF_REG_5, htons(0x3fff));
+    program.jumpIf(BPF_JNE, BPF_REG_5, 0, PASS);
+    program.load(BPF_B, BPF_REG_5, BPF_REG_2, 14 + 9);
+    program.jumpIf(BPF_JNE, BPF_REG_5, IPPROTO_UDP, PASS);
+    program.load(BPF_H, BPF_REG_5, BPF_REG_2, 14 + 20 + 2);
+    program.jumpIf(BPF_JNE, BPF_REG_5, port_be, PASS);
+    program.jump(REDIRECT);
+    // UDP right after the fixed header, to port
+    program.label(IPV6);
+    program.jumpIf(BPF_JNE, BPF_REG_5, htons(0x86dd), PASS);
+    program.move(BPF_REG_4, BPF_REG_2);
+    program.add(BPF_REG_4, 14 + 40 + 8);
+    program.jumpIfRegister(BPF_JGT, BPF_REG_4, BPF_REG_3, PASS);
+    program.load(BPF_B, BPF_REG_5, BPF_REG_2, 14 + 6);
+    program.jumpIf(BPF_JNE, BPF_REG_5, IPPROTO_UDP, PASS);
+    program.load(BPF_H, BPF_REG_5, BPF_REG_2, 14 + 40 + 2);
+    program.jumpIf(BPF_JNE, BPF_REG_5, port_be, PASS);
+    // the flags of the helper are the action when the queue has no socket
+    program.label(REDIRECT);
+    program.loadMap(BPF_REG_1, map_fd);
+    program.load(BPF_W, BPF_REG_2, BPF_REG_6, offsetof(xdp_md, rx_queue_index));
+    program.moveImmediate(BPF_REG_3, XDP_PASS);
+    program.call(BPF_FUNC_redirect_map);
+    program.exit();
+    program.label(PASS);
+    program.moveImmediate(BPF_REG_0, XDP_PASS);
+    program.exit();
+    const auto &instructions = program.finish();
+
+    static const char LICENSE[] = "GPL";
+    std::memset(&attr, 0, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns = reinterpret_cast<uint64_t>(instructions.data());
+    attr.insn_cnt = static_cast<uint32_t>(instructions.size());
+    attr.license = reinterpret_cast<uint64_t>(LICENSE);
+    prog_fd = static_cast<int>(bpf(BPF_PROG_LOAD, attr));
+    if (prog_fd < 0) {
+        return false;
+    }
+
+    std::memset(&attr, 0, sizeof(attr));
+    attr.link_create.prog_fd = static_cast<uint32_t>(prog_fd);
+    attr.link_create.target_ifindex = ifindex;
+    attr.link_create.attach_type = BPF_XDP;
+    link_fd = static_cast<int>(bpf(BPF_LINK_CREATE, attr));
+    return link_fd >= 0;
+}
+
+bool XdpSocket::Program::insert(uint32_t queue, int fd) {
+    bpf_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_fd = static_cast<uint32_t>(map_fd);
+    attr.key = reinterpret_cast<uint64_t>(&queue);
+    attr.value = reinterpret_cast<uint64_t>(&fd);
+    attr.flags = BPF_NOEXIST;
+    return queue < MAX_QUEUES && bpf(BPF_MAP_UPDATE_ELEM, attr) == 0;
+}
+
+void XdpSocket::Program::remove(uint32_t queue) {
+    bpf_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.map_fd = static_cast<uint32_t>(map_fd);
+    attr.key = reinterpret_cast<uint64_t>(&queue);
+    bpf(BPF_MAP_DELETE_ELEM, attr);
+}
+
+std::shared_ptr<XdpSocket::Program> XdpSocket::Program::get(unsigned ifindex, uint16_t port) {
+    static std::mutex mutex;
+    static std::weak_ptr<Program> weak_program;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto program = weak_program.lock();
+    if (program) {
+        if (program->port != port) {
+            errno = EBUSY;
+            return nullptr;
+        }
+        return program;
+    }
+    program = std::make_shared<Program>();
+    program->ifindex = ifindex;
+    program->port = port;
+    if (!program->load()) {
+        return nullptr;
+    }
+    weak_program = program;
+    return program;
+}
+
+bool XdpSocket::setup() {
+    unsigned ifindex = if_nametoindex(_interface.c_str());
+    if (ifindex == 0 || !(_program = Program::get(ifindex, _port))) {
+        return false;
+    }
+    _fd = ::socket(AF_XDP, SOCK_RAW | SOCK_CLOEXEC, 0);
+    if (_fd < 0) {
+        return false;
+    }
+
+    // the frames must be page aligned, an anonymous mapping is
+    _umem_size = static_cast<size_t>(FRAME_COUNT) * FRAME_SIZE;
+    _umem = mmap(nullptr, _umem_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (_umem == MAP_FAILED) {
+        _umem = nullptr;
+        return false;
+    }
+    xdp_umem_reg registration;
+    std::memset(&registration, 0, sizeof(registration));
+    registration.addr = reinterpret_cast<uint64_t>(_umem);
+    registration.len = _umem_size;
+    registration.chunk_size = FRAME_SIZE;
+    registration.headroom = 0;
+    uint32_t rx_size = RX_RING_SIZE;
+    uint32_t fill_size = FILL_RING_SIZE;
+    uint32_t completion_size = COMPLETION_RING_SIZE;
+    if (setsockopt(_fd, SOL_XDP, XDP_UMEM_REG, &registration, sizeof(registration)) < 0
+        || setsockopt(_fd, SOL_XDP, XDP_RX_RING, &rx_size, sizeof(rx_size)) < 0
+        || setsockopt(_fd, SOL_XDP, XDP_UMEM_FILL_RING, &fill_size, sizeof(fill_size)) < 0
+        || setsockopt(_fd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &completion_size, sizeof(completion_size)) < 0) {
+        return false;
+    }
+
+    xdp_mmap_offsets offsets;
+    socklen_t offsets_length = sizeof(offsets);
+    if (getsockopt(_fd, SOL_XDP, XDP_MMAP_OFFSETS, &offsets, &offsets_length) < 0) {
+        return false;
+    }
+    auto map = [this](Ring &ring, const xdp_ring_offset &offset, size_t entry_size, uint32_t entries, off_t page) {
+        ring.map_size = offset.desc + entries * entry_size;
+        ring.map = mmap(nullptr, ring.map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, page);
+        if (ring.map == MAP_FAILED) {
+            ring.map = nullptr;
+            return false;
+        }
+        auto *base = static_cast<uint8_t *>(ring.map);
+        ring.producer = reinterpret_cast<uint32_t *>(base + offset.producer);
+        ring.consumer = reinterpret_cast<uint32_t *>(base + offset.consumer);
+        ring.flags = reinterpret_cast<uint32_t *>(base + offset.flags);
+        ring.descriptors = base + offset.desc;
+        return true;
+    };
+    if (!map(_rx, offsets.rx, sizeof(xdp_desc), RX_RING_SIZE, XDP_PGOFF_RX_RING)
+        || !map(_fill, offsets.fr, sizeof(uint64_t), FILL_RING_SIZE, XDP_UMEM_PGOFF_FILL_RING)) {
+        return false;
+    }
+    // every frame waits for a datagram from the start
+    auto *fill = static_cast<uint64_t *>(_fill.descriptors);
+    for (uint32_t i = 0; i < FRAME_COUNT; ++i) {
+        fill[i & (FILL_RING_SIZE - 1)] = static_cast<uint64_t>(i) * FRAME_SIZE;
+    }
+    __atomic_store_n(_fill.producer, *_fill.producer + FRAME_COUNT, __ATOMIC_RELEASE);
+
+    // zero-copy if the driver has it, the kernel copies into the frames otherwise
+    sockaddr_xdp address;
+    std::memset(&address, 0, sizeof(address));
+    address.sxdp_family = AF_XDP;
+    address.sxdp_ifindex = _program->ifindex;
+    address.sxdp_queue_id = _queue;
+    address.sxdp_flags = XDP_ZEROCOPY | XDP_USE_NEED_WAKEUP;
+    _is_zero_copy = bind(_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+    if (!_is_zero_copy) {
+        address.sxdp_flags = XDP_COPY | XDP_USE_NEED_WAKEUP;
+        if (bind(_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0) {
+            return false;
+        }
+    }
+    if (!_program->insert(_queue, _fd)) {
+        return false;
+    }
+    _descriptor.assign(_fd);
+    return true;
+}
+
+void XdpSocket::teardown() {
+    boost::system::error_code ec;
+    if (_descriptor.is_open()) {
+        _descriptor.close(ec);
+    } else if (_fd >= 0) {
+        ::close(_fd);
+    }
+    _fd = -1;
+    for (Ring *ring : {&_rx, &_fill}) {
+        if (ring->map) {
+            munmap(ring->map, ring->map_size);
+            ring->map = nullptr;
+        }
+    }
+    if (_umem) {
+        munmap(_umem, _umem_size);
+        _umem = nullptr;
+    }
+}
+
+void XdpSocket::wait() {
+    if (_is_closed) {
+        return;
+    }
+    _descriptor.async_read_some(boost::asio::null_buffers(), boost::bind(&XdpSocket::waitHandler, shared_from_this(), _1));
+}
+
+void XdpSocket::waitHandler(const boost::system::error_code &err) {
+    if (err || _is_closed) {
+        return;
+    }
+    ++_wakeups;
+    reap();
+    wait();
+}
+
+void XdpSocket::reap() {
+    auto *rx = static_cast<xdp_desc *>(_rx.descriptors);
+    auto *fill = static_cast<uint64_t *>(_fill.descriptors);
+    uint32_t consumer = *_rx.consumer;
+    uint32_t producer = __atomic_load_n(_rx.producer, __ATOMIC_ACQUIRE);
+    uint32_t fill_producer = *_fill.producer;
+    uint32_t count = 0;
+    for (; consumer != producer && count < RECEIVE_BATCH && !_is_closed; ++consumer, ++count) {
+        const xdp_desc &descriptor = rx[consumer & (RX_RING_SIZE - 1)];
+        proceedFrame(static_cast<const uint8_t *>(_umem) + descriptor.addr, descriptor.len);
+        // the frames hold no packet past the call, the handler copies what it keeps
+        fill[fill_producer++ & (FILL_RING_SIZE - 1)] = descriptor.addr & ~static_cast<uint64_t>(FRAME_SIZE - 1);
+    }
+    _frames += count;
+    __atomic_store_n(_rx.consumer, consumer, __ATOMIC_RELEASE);
+    __atomic_store_n(_fill.producer, fill_producer, __ATOMIC_RELEASE);
+    if (__atomic_load_n(_fill.flags, __ATOMIC_ACQUIRE) & XDP_RING_NEED_WAKEUP) {
+        recvfrom(_fd, nullptr, 0, MSG_DONTWAIT, nullptr, nullptr);
+    }
+    if (consumer != producer && !_is_closed) {
+        // the rest after the other handlers, the socket stays readable meanwhile
+        _ios.post(boost::bind(&XdpSocket::reap, shared_from_this()));
+    }
+}
+
+#else
+
+bool XdpSocket::setup() {
+    return false;
+}
+
+void XdpSocket::teardown() {
+
+}
+
+void XdpSocket::wait() {
+
+}
+
+void XdpSocket::waitHandler(const boost::system::error_code &err) {
+
+}
+
+void XdpSocket::reap() {
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <sys/socket.h>
+
+// optional kernel-bypass ingress of the UDP master faces, selected at startup with enable()
+//
+// an XDP program attached to the interface takes the datagrams to the port of the master face off the NIC queues
+// before the kernel stack sees them, and writes them to frames shared with the process (UMEM), with no copy where
+// the driver supports it. each master face, or each shard of one, has an AF_XDP socket on its own queue: shard i
+// reads queue first_queue + i, the NIC spreads the remote endpoints across its queues as SO_REUSEPORT does across
+// the shard sockets. only IPv4 without options and IPv6 without extension headers are taken, the rest, fragments
+// included, goes on to the kernel and is read from the UDP socket, which also keeps sending. one port per process,
+// the first master face to open takes the interface
+class XdpSocket : public std::enable_shared_from_this<XdpSocket> {
+public:
+    static const uint32_t FRAME_COUNT = 4096;
+    // the smallest frame the kernel accepts, a datagram larger than the MTU comes fragmented and goes to the kernel
+    static const uint32_t FRAME_SIZE = 2048;
+    static const uint32_t RX_RING_SIZE = 2048;
+    // all the frames fit in the fill ring, a frame handled can always be given back
+    static const uint32_t FILL_RING_SIZE = FRAME_COUNT;
+    // nothing is sent, the kernel still wants the ring
+    static const uint32_t COMPLETION_RING_SIZE = 64;
+    // frames handled per wakeup before the other handlers of the io_service get a turn
+    static const uint32_t RECEIVE_BATCH = 256;
+
+    // payload is only valid during the call, address is the source of the datagram
+    using ReceiveHandler = std::function<void(const uint8_t *payload, size_t size, const sockaddr *address, socklen_t address_length)>;
+
+private:
+    struct Ring {
+        uint32_t *producer = nullptr;
+        uint32_t *consumer = nullptr;
+        uint32_t *flags = nullptr;
+        void *descriptors = nullptr;
+        void *map = nullptr;
+        size_t map_size = 0;
+    };
+
+    struct Program;
+
+    static std::atomic<bool> _is_enabled;
+    static std::string _interface;
+    static uint32_t _first_queue;
+
+    boost::asio::io_service &_ios;
+    uint16_t _port;
+    uint32_t _queue;
+    int _fd = -1;
+    boost::asio::posix::stream_descriptor _descriptor;
+    std::shared_ptr<Program> _program;
+    void *_umem = nullptr;
+    size_t _umem_size = 0;
+    Ring _rx;
+    Ring _fill;
+    bool _is_zero_copy = false;
+    bool _is_closed = false;
+    ReceiveHandler _handler;
+
+    size_t _frames = 0;
+    size_t _wakeups = 0;
+    // not UDP to the port, should the program let them through
+    size_t _dropped = 0;
+
+    bool setup();
+
+    void teardown();
+
+    void wait();
+
+    void waitHandler(const boost::system::error_code &err);
+
+    void reap();
+
+    void proceedFrame(const uint8_t *frame, size_t size);
+
+public:
+    XdpSocket(boost::asio::io_service &ios, uint16_t port, uint32_t queue);
+
+    ~XdpSocket();
+
+    // interface is "eth0" or "eth0:2" to start from its queue 2, false if it doesn't exist or the build has no AF_XDP
+    static bool enable(const std::string &interface);
+
+    static bool isEnabled();
+
+    // the socket of the queue of the shard, handler is then called on ios for each datagram to port. null if the
+    // backend isn't enabled or the socket can't be set up, e.g. without CAP_NET_ADMIN, the face then keeps reading
+    // its UDP socket only
+    static std::shared_ptr<XdpSocket> open(boost::asio::io_service &ios, uint16_t port, uint32_t shard, const ReceiveHandler &handler);
+
+    // no handler is called after this, the queue is given back to the kernel
+    void close();
+
+    std::string toJSON() const;
+};
\ No newline at end of file
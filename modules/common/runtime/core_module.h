@@ -0,0 +1,26 @@
+#pragma once
+
+#include <algorithm>
+
+#include "module.h"
+
+// thread per core: _ios runs the commands and the accepts on a thread of its own, each of the concurrency core
+// services runs alone on a thread pinned to one core and the faces are spread over them, so that all the
+// completions of a face stay on one core. packets cross cores through the MPSC inbox of the face they are sent to.
+// the state a module keeps by thread is found with currentCore()
+class CoreModule : public ModuleBase {
+public:
+    explicit CoreModule(size_t concurrency) : ModuleBase(concurrency, std::max<size_t>(concurrency, 1)) {
+
+    }
+
+    // the core service the calling thread runs, concurrency for _ios and any other thread
+    size_t currentCore() const {
+        return std::min(coreIndex(), _concurrency);
+    }
+
+    // _ios for concurrency
+    boost::asio::io_service& coreService(size_t core) {
+        return core < _core_services.size() ? *_core_services[core] : _ios;
+    }
+};
\ No newline at end of file
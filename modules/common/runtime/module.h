@@ -0,0 +1,276 @@
+/*
+Copyright (C) 2015-2018  Xavier MARCHAL
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "log/logger.h"
+#include "metrics/metrics_server.h"
+
+// what the runtimes of the modules share: _ios, the core services each run by a thread pinned to a core if there are
+// any, the drain before stopping and the metrics endpoint. Module and CoreModule set which threads run what
+class ModuleBase {
+protected:
+    size_t _concurrency;
+    boost::asio::io_service _ios;
+    boost::asio::io_service::work _ios_work;
+    std::vector<std::unique_ptr<boost::asio::io_service>> _core_services;
+    std::vector<std::unique_ptr<boost::asio::io_service::work>> _core_works;
+    std::atomic<size_t> _next_core_service{0};
+    boost::thread_group _thread_pool;
+    boost::asio::deadline_timer _drain_timer;
+    // registered by the module constructors, pulled once enableMetrics is called
+    Metrics _metrics;
+    std::shared_ptr<MetricsServer> _metrics_server;
+
+    // the core thread i runs on core i modulo the cores of the host, a failure only costs the affinity
+    static void pinToCore(size_t i) {
+        unsigned int cores = boost::thread::hardware_concurrency();
+        if (cores == 0) {
+            return;
+        }
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(i % cores, &cpu_set);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    }
+
+    // the core service run by the calling thread, SIZE_MAX for the other threads
+    static size_t& coreIndex() {
+        static thread_local size_t core = SIZE_MAX;
+        return core;
+    }
+
+    static void runCoreService(boost::asio::io_service *core_service, size_t i) {
+        pinToCore(i);
+        coreIndex() = i;
+        core_service->run();
+    }
+
+    // on _ios when the drain begins, the module e.g. stops accepting new faces
+    virtual void beginDrain() {
+
+    }
+
+    // polled on _ios while draining, true once nothing is in flight any more
+    virtual bool isDrained() {
+        return true;
+    }
+
+    void pollDrain(const boost::posix_time::ptime &deadline, const std::function<void(bool)> &done) {
+        if (isDrained()) {
+            done(true);
+            return;
+        }
+        if (boost::posix_time::microsec_clock::universal_time() >= deadline) {
+            done(false);
+            return;
+        }
+        // the module goes on meanwhile, the drain is polled rather than signaled by each of its tables
+        _drain_timer.expires_from_now(boost::posix_time::milliseconds(10));
+        _drain_timer.async_wait([this, deadline, done](const boost::system::error_code &err) {
+            if (!err) {
+                pollDrain(deadline, done);
+            }
+        });
+    }
+
+    // without core services, _ios is run by concurrency threads, else by one
+    ModuleBase(size_t concurrency, size_t core_services)
+            : _concurrency(std::max<size_t>(concurrency, 1))
+            , _ios(core_services == 0 ? _concurrency : 1)
+            , _ios_work(_ios)
+            , _drain_timer(_ios) {
+        for (size_t i = 0; i < core_services; ++i) {
+            _core_services.emplace_back(new boost::asio::io_service(1));
+            _core_works.emplace_back(new boost::asio::io_service::work(*_core_services.back()));
+        }
+    }
+
+    virtual void startThreads() {
+        size_t ios_threads = _core_services.empty() ? _concurrency : 1;
+        for (size_t i = 0; i < ios_threads; ++i) {
+            _thread_pool.create_thread(boost::bind(&boost::asio::io_service::run, &_ios));
+        }
+        for (size_t i = 0; i < _core_services.size(); ++i) {
+            _thread_pool.create_thread(boost::bind(&ModuleBase::runCoreService, _core_services[i].get(), i));
+        }
+    }
+
+public:
+    ModuleBase(const ModuleBase&) = delete;
+
+    ModuleBase& operator=(const ModuleBase&) = delete;
+
+    virtual ~ModuleBase() = default;
+
+    void start() {
+        startThreads();
+        _ios.post(boost::bind(&ModuleBase::run, this));
+    }
+
+    virtual void stop() {
+        _ios.stop();
+        for (const auto &core_service : _core_services) {
+            core_service->stop();
+        }
+        _thread_pool.join_all();
+    }
+
+    // stops accepting, then waits for what is in flight until isDrained() or for timeout at most. done(drained) is
+    // called on _ios, the module still runs until stop()
+    void drain(const boost::posix_time::time_duration &timeout, const std::function<void(bool)> &done) {
+        _ios.post([this, timeout, done]() {
+            beginDrain();
+            pollDrain(boost::posix_time::microsec_clock::universal_time() + timeout, done);
+        });
+    }
+
+    // blocks until SIGINT or SIGTERM, drains for drain_timeout at most and stops. a second signal stops at once
+    void waitForStop(const boost::posix_time::time_duration &drain_timeout) {
+        boost::asio::io_service signal_ios;
+        boost::asio::signal_set signals(signal_ios, SIGINT, SIGTERM);
+        bool is_draining = false;
+        std::function<void(const boost::system::error_code&, int)> on_signal;
+        on_signal = [&](const boost::system::error_code &err, int signum) {
+            if (err) {
+                return;
+            }
+            if (is_draining) {
+                signal_ios.stop();
+                return;
+            }
+            is_draining = true;
+            logger::log(logger::INFO, "draining before stopping");
+            drain(drain_timeout, [&signal_ios](bool drained) {
+                if (!drained) {
+                    logger::log(logger::WARNING, "drain timed out, stopping with packets in flight");
+                }
+                signal_ios.stop();
+            });
+            signals.async_wait(on_signal);
+        };
+        signals.async_wait(on_signal);
+        signal_ios.run();
+        stop();
+    }
+
+    // serves the metrics on a TCP port, before start(). throws if the port can't be bound
+    void enableMetrics(uint16_t port) {
+        _metrics_server = std::make_shared<MetricsServer>(_ios, _metrics, port);
+        _metrics_server->listen();
+    }
+
+    // what only the metrics need is measured on the packet path while this is true, it doesn't change once started
+    bool isMetricsEnabled() const {
+        return _metrics_server != nullptr;
+    }
+
+    virtual void run() = 0;
+
+    const boost::asio::io_service& get_io_service() const {
+        return _ios;
+    }
+
+    // round-robin over the core services, for each new face, _ios if there are none
+    boost::asio::io_service& nextCoreService() {
+        if (_core_services.empty()) {
+            return _ios;
+        }
+        return *_core_services[_next_core_service.fetch_add(1, std::memory_order_relaxed) % _core_services.size()];
+    }
+};
+
+// the threads of a module either all run _ios (SHARED), any handler may then run on any of them, or each runs an
+// io_service of its own pinned to a core (PINNED) while _ios keeps a thread for the timers. a module creating its faces
+// on nextCoreService() gets both: in PINNED all the completions of a face stay on one core
+//
+// the command socket of a module is on _control_ios, a thread of its own, a command never waits behind the packets
+// and the parsing, the replies and the reports don't run between them. the modules whose tables are only touched by
+// their module thread hand the parsed command over with applyCommand
+//
+// each module tells in its header which of its state is shared by the threads and how it is guarded, the modules
+// constructed with a concurrency of 1 touch all of theirs from the module thread only
+class Module : public ModuleBase {
+public:
+    enum Runtime {
+        SHARED,
+        PINNED,
+    };
+
+    // "pinned" or "shared", anything else is SHARED
+    static Runtime parseRuntime(const std::string &runtime) {
+        return runtime == "pinned" ? PINNED : SHARED;
+    }
+
+protected:
+    Runtime _runtime;
+    boost::asio::io_service _control_ios;
+    boost::asio::io_service::work _control_work;
+
+    void startThreads() override {
+        ModuleBase::startThreads();
+        _thread_pool.create_thread(boost::bind(&boost::asio::io_service::run, &_control_ios));
+    }
+
+public:
+    explicit Module(size_t concurrency, Runtime runtime = SHARED)
+            : ModuleBase(concurrency, concurrency > 1 && runtime == PINNED ? concurrency : 0)
+            , _runtime(_core_services.empty() ? SHARED : PINNED)
+            , _control_ios(1)
+            , _control_work(_control_ios) {
+
+    }
+
+    void stop() override {
+        _control_ios.stop();
+        ModuleBase::stop();
+    }
+
+    // command on _ios, then next on _control_ios, e.g. the read of the next command: the commands are applied in
+    // order and _remote_command_endpoint stays the one of the command being applied. a throwing command is logged
+    void applyCommand(const std::function<void()> &command, const std::function<void()> &next) {
+        _ios.post([this, command, next]() {
+            try {
+                command();
+            } catch (const std::exception &e) {
+                logger::log(logger::ERROR, e.what());
+            }
+            _control_ios.post(next);
+        });
+    }
+
+    // message sent on a socket of _control_ios from any thread, a failed send is dropped as an unanswered datagram
+    void sendOnControl(boost::asio::ip::udp::socket &socket, const std::string &message, const boost::asio::ip::udp::endpoint &endpoint) {
+        _control_ios.post([&socket, message, endpoint]() {
+            boost::system::error_code err;
+            socket.send_to(boost::asio::buffer(message), endpoint, 0, err);
+        });
+    }
+};
\ No newline at end of file
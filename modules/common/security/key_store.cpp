@@ -0,0 +1,277 @@
+#include "key_store.h"
+
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/provider.h>
+#else
+#include <openssl/engine.h>
+#endif
+
+#include <algorithm>
+
+#include "../log/probes.h"
+#include "../metrics/memory_stats.h"
+#include "../metrics/stage_profile.h"
+
+KeyStore::Verifier::Verifier() : _md_ctx(EVP_MD_CTX_create()) {
+
+}
+
+KeyStore::Verifier::~Verifier() {
+    clearKeyContexts();
+    if (_md_ctx) {
+        EVP_MD_CTX_destroy(_md_ctx);
+    }
+}
+
+EVP_PKEY_CTX* KeyStore::Verifier::getKeyContext(EVP_PKEY *pkey) {
+    auto it = _pkey_ctxs.find(pkey);
+    if (it != _pkey_ctxs.end()) {
+        return it->second;
+    }
+    // the keys removed from the store are only released here, they are dropped all at once past the limit
+    if (_pkey_ctxs.size() >= MAX_KEY_CONTEXTS) {
+        clearKeyContexts();
+    }
+    EVP_PKEY_CTX *pkey_ctx = EVP_PKEY_CTX_new(pkey, NULL);
+    if (!pkey_ctx) {
+        return nullptr;
+    }
+    if (EVP_PKEY_verify_init(pkey_ctx) != 1 || EVP_PKEY_CTX_set_signature_md(pkey_ctx, EVP_sha256()) != 1) {
+        EVP_PKEY_CTX_free(pkey_ctx);
+        return nullptr;
+    }
+    _pkey_ctxs.emplace(pkey, pkey_ctx);
+    return pkey_ctx;
+}
+
+void KeyStore::Verifier::clearKeyContexts() {
+    for (auto &pkey_ctx : _pkey_ctxs) {
+        EVP_PKEY_CTX_free(pkey_ctx.second);
+    }
+    _pkey_ctxs.clear();
+}
+
+bool KeyStore::Verifier::verifyMessage(const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, EVP_PKEY *pkey) {
+    bool result = EVP_DigestVerifyInit(_md_ctx, NULL, NULL, NULL, pkey) == 1
+                  && EVP_DigestVerify(_md_ctx, sig, slen, msg, mlen) == 1;
+    if (!result) {
+        ERR_clear_error();
+    }
+    // the key context set by the init goes, the context is back to a bare digest context
+    EVP_MD_CTX_reset(_md_ctx);
+    return result;
+}
+
+bool KeyStore::Verifier::verify(const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, EVP_PKEY *pkey) {
+    stage_profile::Scope stage(stage_profile::VERIFY);
+    NDNMS_PROBE1(sv_verify_start, mlen);
+    bool is_valid = verifyDigest(msg, mlen, sig, slen, pkey);
+    NDNMS_PROBE2(sv_verify_end, mlen, is_valid ? 1 : 0);
+    return is_valid;
+}
+
+bool KeyStore::Verifier::verifyDigest(const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, EVP_PKEY *pkey) {
+    if (!msg || !mlen || !sig || !slen || !pkey || !_md_ctx) {
+        return false;
+    }
+#ifdef EVP_PKEY_ED25519
+    if (EVP_PKEY_id(pkey) == EVP_PKEY_ED25519) {
+        return verifyMessage(msg, mlen, sig, slen, pkey);
+    }
+#endif
+    EVP_PKEY_CTX *pkey_ctx = getKeyContext(pkey);
+    if (!pkey_ctx) {
+        return false;
+    }
+    // the digest is computed apart and checked with the key context, as EVP_DigestVerify* does with fresh contexts
+    uint8_t digest[EVP_MAX_MD_SIZE];
+    unsigned int digest_size = 0;
+    if (EVP_DigestInit_ex(_md_ctx, EVP_sha256(), NULL) != 1 || EVP_DigestUpdate(_md_ctx, msg, mlen) != 1
+        || EVP_DigestFinal_ex(_md_ctx, digest, &digest_size) != 1) {
+        return false;
+    }
+    bool result = EVP_PKEY_verify(pkey_ctx, sig, slen, digest, digest_size) == 1;
+    if (!result) {
+        ERR_clear_error();
+    }
+    return result;
+}
+
+size_t KeyStore::Verifier::verify(std::vector<Check> &checks) {
+    std::vector<Check*> sorted;
+    sorted.reserve(checks.size());
+    for (auto &check : checks) {
+        sorted.push_back(&check);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Check *a, const Check *b) {
+        return a->pkey < b->pkey;
+    });
+    size_t valid = 0;
+    for (auto *check : sorted) {
+        check->is_valid = verify(check->msg, check->mlen, check->sig, check->slen, check->pkey);
+        valid += check->is_valid;
+    }
+    return valid;
+}
+
+bool KeyStore::add(const ndn::Name &key_name, const std::string &pem) {
+    if (_pkeys.find(key_name)) {
+        return true;
+    }
+    return add(key_name, readKey(pem));
+}
+
+bool KeyStore::add(const ndn::Name &key_name, const std::shared_ptr<EVP_PKEY> &pkey) {
+    if (!pkey) {
+        return false;
+    }
+    _pkeys.insert(key_name, pkey);
+    return true;
+}
+
+std::shared_ptr<EVP_PKEY> KeyStore::readKey(const std::string &pem) {
+    BIO *bio = BIO_new_mem_buf(pem.c_str(), static_cast<int>(pem.size()));
+    if (!bio) {
+        return nullptr;
+    }
+    EVP_PKEY *pkey = PEM_read_bio_PUBKEY(bio, NULL, NULL, NULL);
+    BIO_free(bio);
+    if (!pkey) {
+        return nullptr;
+    }
+    return std::shared_ptr<EVP_PKEY>(pkey, EVP_PKEY_free);
+}
+
+bool KeyStore::remove(const ndn::Name &key_name) {
+    if (!_pkeys.find(key_name)) {
+        return false;
+    }
+    _pkeys.remove(key_name);
+    return true;
+}
+
+EVP_PKEY* KeyStore::find(const ndn::Name &key_name) const {
+    return _pkeys.find(key_name).get();
+}
+
+std::shared_ptr<EVP_PKEY> KeyStore::share(const ndn::Name &key_name) const {
+    return _pkeys.find(key_name);
+}
+
+size_t KeyStore::size() const {
+    return _pkeys.size();
+}
+
+void KeyStore::addTrustRule(const ndn::Name &prefix, const ndn::Name &anchor) {
+    _trust_rules.insert(prefix, std::make_shared<ndn::Name>(anchor), true);
+}
+
+bool KeyStore::removeTrustRule(const ndn::Name &prefix) {
+    if (!_trust_rules.find(prefix)) {
+        return false;
+    }
+    _trust_rules.remove(prefix);
+    return true;
+}
+
+size_t KeyStore::getTrustRuleCount() const {
+    return _trust_rules.size();
+}
+
+void KeyStore::addMemoryStats(MemoryStats &stats, const std::string &prefix) const {
+    _pkeys.addMemoryStats(stats, prefix + "_keys");
+    _trust_rules.addMemoryStats(stats, prefix + "_trust_rules");
+    size_t anchor_bytes = 0;
+    _trust_rules.forEachValue([&anchor_bytes](const ndn::Name &anchor) {
+        anchor_bytes += memory_usage::ofShared<ndn::Name>() + memory_usage::of(anchor);
+    });
+    stats.add(prefix + "_anchors", _trust_rules.size(), anchor_bytes);
+}
+
+std::shared_ptr<EVP_PKEY> KeyStore::resolve(const ndn::Name &key_name, ndn::Name &store_name) const {
+    if (std::shared_ptr<EVP_PKEY> pkey = _pkeys.find(key_name)) {
+        store_name = key_name;
+        return pkey;
+    }
+    if (_trust_rules.size() == 0) {
+        return nullptr;
+    }
+    std::shared_ptr<ndn::Name> anchor = _trust_rules.findLastValueUntil(key_name);
+    if (!anchor) {
+        return nullptr;
+    }
+    std::shared_ptr<EVP_PKEY> pkey = _pkeys.find(*anchor);
+    if (pkey) {
+        store_name = *anchor;
+    }
+    return pkey;
+}
+
+bool KeyStore::verify(const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, EVP_PKEY *pkey) {
+    if (!msg || !mlen || !sig || !slen || !pkey) {
+        return false;
+    }
+    bool result = false;
+    EVP_MD_CTX *ctx = NULL;
+    do {
+        ctx = EVP_MD_CTX_create();
+        if (ctx == NULL) {
+            break; /* failed */
+        }
+        int rc = EVP_DigestInit_ex(ctx, EVP_sha256(), NULL);
+        if (rc != 1) {
+            break; /* failed */
+        }
+        rc = EVP_DigestVerifyInit(ctx, NULL, EVP_sha256(), NULL, pkey);
+        if (rc != 1) {
+            break; /* failed */
+        }
+        rc = EVP_DigestVerifyUpdate(ctx, msg, mlen);
+        if (rc != 1) {
+            break; /* failed */
+        }
+        /* Clear any errors for the call below */
+        ERR_clear_error();
+        rc = EVP_DigestVerifyFinal(ctx, sig, slen);
+        if (rc != 1) {
+            break; /* failed */
+        }
+        result = true;
+    } while (0);
+    if (ctx) {
+        EVP_MD_CTX_destroy(ctx);
+    }
+    return result;
+}
+
+bool KeyStore::useProvider(const std::string &name) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    if (!OSSL_PROVIDER_load(NULL, name.c_str())) {
+        ERR_clear_error();
+        return false;
+    }
+    // the default provider is no longer loaded by itself once another one is
+    if (!OSSL_PROVIDER_load(NULL, "default")) {
+        ERR_clear_error();
+        return false;
+    }
+    std::string properties = "?provider=" + name;
+    return EVP_set_default_properties(NULL, properties.c_str()) == 1;
+#else
+    ENGINE_load_builtin_engines();
+    ENGINE *engine = ENGINE_by_id(name.c_str());
+    if (!engine) {
+        ERR_clear_error();
+        return false;
+    }
+    bool result = ENGINE_init(engine) == 1;
+    if (result) {
+        result = ENGINE_set_default(engine, ENGINE_METHOD_ALL) == 1;
+        ENGINE_finish(engine);
+    }
+    ENGINE_free(engine);
+    return result;
+#endif
+}
\ No newline at end of file
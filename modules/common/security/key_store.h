@@ -0,0 +1,128 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+
+#include <openssl/evp.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tree/name_hash_index.h"
+
+// the public keys the manager pushes with add_keys, by key name, and the SHA-256 signature check of the modules
+// which verify signatures themselves rather than asking the manager. a trust rule maps a key namespace to an anchor,
+// the key checking the signatures of all the key names under it, so that producers whose key names change, e.g. with
+// the certificate version, don't each need a key of their own. both are hashed indexes, a key is found in O(1) and
+// a rule in one probe per prefix length holding rules
+class KeyStore {
+public:
+    // the contexts of a signature check kept from one call to the next: the digest context is reinitialised and the
+    // key context is set up once per key rather than both being allocated for each signature. not thread safe, each
+    // thread checking signatures needs its own
+    class Verifier {
+    public:
+        static const size_t MAX_KEY_CONTEXTS = 64;
+
+        // one signature of a batch, is_valid is set by verify
+        struct Check {
+            const uint8_t *msg;
+            size_t mlen;
+            const uint8_t *sig;
+            size_t slen;
+            EVP_PKEY *pkey;
+            bool is_valid;
+        };
+
+    private:
+        EVP_MD_CTX *_md_ctx;
+        // by key, a context holds a reference to its key so the address isn't reused while it is here
+        std::unordered_map<const EVP_PKEY*, EVP_PKEY_CTX*> _pkey_ctxs;
+
+        EVP_PKEY_CTX* getKeyContext(EVP_PKEY *pkey);
+
+        // Ed25519 signs the message itself, not its SHA-256, this is a one-shot check through the digest context
+        bool verifyMessage(const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, EVP_PKEY *pkey);
+
+        bool verifyDigest(const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, EVP_PKEY *pkey);
+
+        void clearKeyContexts();
+
+    public:
+        Verifier();
+
+        Verifier(const Verifier&) = delete;
+
+        Verifier& operator=(const Verifier&) = delete;
+
+        ~Verifier();
+
+        // as KeyStore::verify for RSA and ECDSA keys, which sign the SHA-256 of msg, Ed25519 keys are checked as well
+        bool verify(const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, EVP_PKEY *pkey);
+
+        // the checks are made by key, those of a key one after the other on the same context, the number of valid
+        // signatures is returned
+        size_t verify(std::vector<Check> &checks);
+    };
+
+private:
+    NameHashIndex<EVP_PKEY> _pkeys;
+    // the anchor by key namespace
+    NameHashIndex<ndn::Name> _trust_rules;
+
+public:
+    KeyStore() = default;
+
+    KeyStore(const KeyStore&) = delete;
+
+    KeyStore& operator=(const KeyStore&) = delete;
+
+    ~KeyStore() = default;
+
+    // pem is a PEM public key, false if it can't be read. a key already there is kept and true is returned
+    bool add(const ndn::Name &key_name, const std::string &pem);
+
+    // same as above with a key already read, e.g. one added to several stores
+    bool add(const ndn::Name &key_name, const std::shared_ptr<EVP_PKEY> &pkey);
+
+    // null if pem isn't a PEM public key
+    static std::shared_ptr<EVP_PKEY> readKey(const std::string &pem);
+
+    // false if there was no such key
+    bool remove(const ndn::Name &key_name);
+
+    // null if there is no such key, the key belongs to the store
+    EVP_PKEY* find(const ndn::Name &key_name) const;
+
+    // as find, but the key stays valid while held even if it is removed meanwhile, for checks made on other threads
+    std::shared_ptr<EVP_PKEY> share(const ndn::Name &key_name) const;
+
+    size_t size() const;
+
+    // the key of anchor checks the signatures of the key names under prefix from now on, an existing rule for the
+    // same prefix is replaced. the anchor key may be added later
+    void addTrustRule(const ndn::Name &prefix, const ndn::Name &anchor);
+
+    // false if there was no such rule
+    bool removeTrustRule(const ndn::Name &prefix);
+
+    size_t getTrustRuleCount() const;
+
+    // prefix + "_keys_..." and prefix + "_trust_rules_..." parts of the indexes, the anchors with the rules. the keys
+    // are allocated by OpenSSL and left out
+    void addMemoryStats(MemoryStats &stats, const std::string &prefix) const;
+
+    // the key checking the signatures made with key_name, the key itself if there is one, else the anchor of the
+    // longest rule whose prefix covers key_name. null if there is none, store_name is then left unchanged
+    std::shared_ptr<EVP_PKEY> resolve(const ndn::Name &key_name, ndn::Name &store_name) const;
+
+    // true if sig is a valid signature of msg with pkey
+    static bool verify(const uint8_t *msg, size_t mlen, const uint8_t *sig, size_t slen, EVP_PKEY *pkey);
+
+    // the OpenSSL provider, or the engine before OpenSSL 3, preferred for the checks from now on, such as qatprovider
+    // or qatengine. the default implementation stays for what it doesn't do, false if it can't be loaded. to be called
+    // before any key is added and any verifier is created
+    static bool useProvider(const std::string &name);
+};
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bloom filter of 64-bit hashes split in blocks of a cache line (Putze et al.): a hash picks a block and sets one bit
+// in each of its 8 words, so a query reads a single cache line. under 1% of false positives at 12 bits by key
+class BlockedBloomFilter {
+public:
+    static const size_t DEFAULT_BITS_PER_KEY = 12;
+
+private:
+    static const size_t BLOCK_WORDS = 8;
+
+    // a block starts on a cache line, at _offset words in _words
+    std::vector<uint64_t> _words;
+    size_t _offset = 0;
+    size_t _blocks = 0;
+
+    static uint64_t mask(uint64_t hash, size_t word) {
+        static const uint32_t SALTS[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                          0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+        return uint64_t(1) << ((static_cast<uint32_t>(hash) * SALTS[word]) >> 26);
+    }
+
+    size_t blockOf(uint64_t hash) const {
+        return _offset + (((hash >> 32) * _blocks) >> 32) * BLOCK_WORDS;
+    }
+
+public:
+    BlockedBloomFilter() = default;
+
+    ~BlockedBloomFilter() = default;
+
+    // empties the filter and sizes it for keys hashes. a copy works but may not be aligned
+    void reset(size_t keys, size_t bits_per_key = DEFAULT_BITS_PER_KEY) {
+        _blocks = std::max<size_t>((keys * bits_per_key + 511) / 512, 1);
+        _words.assign((_blocks + 1) * BLOCK_WORDS, 0);
+        auto address = reinterpret_cast<uintptr_t>(_words.data());
+        _offset = ((64 - address % 64) % 64) / sizeof(uint64_t);
+    }
+
+    void clear() {
+        _words.clear();
+        _offset = 0;
+        _blocks = 0;
+    }
+
+    bool empty() const {
+        return _blocks == 0;
+    }
+
+    size_t getBytes() const {
+        return _words.size() * sizeof(uint64_t);
+    }
+
+    // the filter must have been reset
+    void insert(uint64_t hash) {
+        size_t block = blockOf(hash);
+        for (size_t i = 0; i < BLOCK_WORDS; ++i) {
+            _words[block + i] |= mask(hash, i);
+        }
+    }
+
+    // false if hash was never inserted, true if it may have been. always true for an empty filter
+    bool mayContain(uint64_t hash) const {
+        if (_blocks == 0) {
+            return true;
+        }
+        const uint64_t *block = _words.data() + blockOf(hash);
+        for (size_t i = 0; i < BLOCK_WORDS; ++i) {
+            if (!(block[i] & mask(hash, i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the block of hash is brought into the cache, for a query of it a bit later
+    void prefetch(uint64_t hash) const {
+        if (_blocks != 0) {
+            __builtin_prefetch(_words.data() + blockOf(hash));
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// what the lookup of a table gave for exact Names, e.g. the faces of the FIB for the most requested ones, so that
+// their next lookups skip the walk of the index. direct-mapped on the name_hash, a slot keeps the generation of the
+// table it was computed under, see LeftRight::readWithGeneration, a single write of the table leaves every slot
+// stale. meant to be thread_local, nothing is shared: a thread caches the Names it looks up itself
+template <class V, size_t SLOTS = 1024>
+class DecisionCache {
+private:
+    static_assert((SLOTS & (SLOTS - 1)) == 0, "SLOTS must be a power of 2");
+
+    struct Slot {
+        uint64_t hash = 0;
+        // 0 for an empty slot, generations start at 1
+        uint64_t generation = 0;
+        V value;
+    };
+
+    // allocated by the first insert, the threads which never look up take nothing
+    std::unique_ptr<Slot[]> _slots;
+
+public:
+    // null unless the value of hash was computed under generation
+    V* find(uint64_t hash, uint64_t generation) {
+        if (_slots) {
+            Slot &slot = _slots[hash & (SLOTS - 1)];
+            if (slot.generation == generation && slot.hash == hash) {
+                return &slot.value;
+            }
+        }
+        return nullptr;
+    }
+
+    // replaces whatever the slot held
+    void insert(uint64_t hash, uint64_t generation, V value) {
+        if (!_slots) {
+            _slots.reset(new Slot[SLOTS]);
+        }
+        Slot &slot = _slots[hash & (SLOTS - 1)];
+        slot.hash = hash;
+        slot.generation = generation;
+        slot.value = std::move(value);
+    }
+
+    // a hit which turned out unusable, e.g. a face of it is gone
+    void erase(uint64_t hash) {
+        if (_slots) {
+            Slot &slot = _slots[hash & (SLOTS - 1)];
+            if (slot.hash == hash) {
+                slot.generation = 0;
+                slot.value = V();
+            }
+        }
+    }
+};
\ No newline at end of file
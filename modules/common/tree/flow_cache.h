@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include "decision_cache.h"
+#include "network/name_hash.h"
+#include "network/name_view.h"
+
+// the decision a module took for a flow, the packets sharing the first components of their Name and, when the
+// decision depends on it, their ingress face: e.g. the segments of a stream, which the filter, the key store or the
+// strategy would otherwise be looked up again for, one by one. as DecisionCache, whose slots it uses, a decision is
+// kept with the generation of the table it was computed under and meant to be thread_local. it may in addition
+// expire, for what the generation doesn't cover. the module picks prefix_length so that the decision depends on no
+// later component
+template <class V, size_t SLOTS = 1024>
+class FlowCache {
+public:
+    using Clock = ndn::time::steady_clock;
+
+private:
+    struct Entry {
+        Clock::time_point expiry;
+        V value;
+    };
+
+    DecisionCache<Entry, SLOTS> _cache;
+
+public:
+    // the first prefix_length components, the whole Name if it is shorter
+    static uint64_t getKey(const NameView &name, size_t prefix_length) {
+        return name.getPrefixHash(std::min(name.size(), prefix_length));
+    }
+
+    static uint64_t getKey(const NameView &name, size_t prefix_length, size_t face_id) {
+        return name_hash::mix(getKey(name, prefix_length), face_id);
+    }
+
+    // null unless the value of key was computed under generation and hasn't expired, now may be left out if no value
+    // is inserted with an expiry
+    V* find(uint64_t key, uint64_t generation, const Clock::time_point &now = Clock::time_point()) {
+        Entry *entry = _cache.find(key, generation);
+        if (!entry || entry->expiry <= now) {
+            return nullptr;
+        }
+        return &entry->value;
+    }
+
+    // replaces whatever the slot held
+    void insert(uint64_t key, uint64_t generation, V value, const Clock::time_point &expiry = Clock::time_point::max()) {
+        _cache.insert(key, generation, Entry{expiry, std::move(value)});
+    }
+
+    void erase(uint64_t key) {
+        _cache.erase(key);
+    }
+};
\ No newline at end of file
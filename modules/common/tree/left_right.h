@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// read-mostly sharing of a table between the threads of a module, e.g. a FIB: two instances are kept, readers use
+// one of them without taking any lock nor ever waiting, while a writer changes the other one, makes the readers
+// switch to it, waits for the readers which were still on the previous one and replays the change there
+// (Left-Right, Ramalhete and Correia). A read costs an increment and a decrement on a counter of its own cache line,
+// a write is applied twice and the instances must hence be changed by functions which give the same result on both
+//
+// readers only call const functions of the instance, values shared between the two instances must not be changed by
+// a writer, it creates one per instance instead
+template <class T>
+class LeftRight {
+private:
+    // threads are spread on the indicators, more threads than that only share cache lines
+    static const size_t READ_INDICATORS = 64;
+
+    struct alignas(64) ReadIndicator {
+        std::atomic<size_t> readers;
+
+        ReadIndicator() : readers(0) {
+
+        }
+    };
+
+    std::unique_ptr<T> _instances[2];
+    std::atomic<int> _read_instance;
+    std::atomic<int> _version;
+    // changed by each write once the readers switched, see readWithGeneration
+    std::atomic<uint64_t> _generation;
+    mutable ReadIndicator _indicators[2][READ_INDICATORS];
+    std::mutex _writer_mutex;
+
+    // unique among the LeftRight of T, a cache shared by several of them can't mistake one for another
+    static uint64_t nextGeneration() {
+        static std::atomic<uint64_t> next(1);
+        return next++;
+    }
+
+    static size_t getIndicator() {
+        static std::atomic<size_t> next(0);
+        static thread_local size_t indicator = next++ % READ_INDICATORS;
+        return indicator;
+    }
+
+    void waitForReaders(int version) {
+        for (auto &indicator : _indicators[version]) {
+            while (indicator.readers.load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    class ReadGuard {
+    private:
+        std::atomic<size_t> &_readers;
+
+    public:
+        explicit ReadGuard(std::atomic<size_t> &readers) : _readers(readers) {
+            _readers.fetch_add(1);
+        }
+
+        ~ReadGuard() {
+            _readers.fetch_sub(1);
+        }
+    };
+
+public:
+    // factory() makes each of the two instances, they must start equal
+    template <class Factory>
+    explicit LeftRight(const Factory &factory)
+            : _instances{factory(), factory()}
+            , _read_instance(0)
+            , _version(0)
+            , _generation(nextGeneration()) {
+
+    }
+
+    LeftRight(const LeftRight&) = delete;
+
+    LeftRight& operator=(const LeftRight&) = delete;
+
+    // reader(const T&), whose result is returned, from any thread and concurrently with writes. the result must not
+    // point into the instance, which may change as soon as the read is over
+    template <class Reader>
+    auto read(const Reader &reader) const -> decltype(reader(std::declval<const T&>())) {
+        // the indicator of the current version is raised before the instance is chosen, a writer waiting for it to
+        // drop knows the reader may be on any instance
+        ReadGuard guard(_indicators[_version.load()][getIndicator()].readers);
+        return reader(static_cast<const T&>(*_instances[_read_instance.load()]));
+    }
+
+    // reader(const T&, uint64_t generation) as read, the generation is taken before the instance: as long as
+    // getGeneration() returns it, what the reader computed still holds, e.g. for a DecisionCache. never 0
+    template <class Reader>
+    auto readWithGeneration(const Reader &reader) const -> decltype(reader(std::declval<const T&>(), uint64_t())) {
+        ReadGuard guard(_indicators[_version.load()][getIndicator()].readers);
+        uint64_t generation = _generation.load();
+        return reader(static_cast<const T&>(*_instances[_read_instance.load()]), generation);
+    }
+
+    uint64_t getGeneration() const {
+        return _generation.load();
+    }
+
+    // writer(T&) applied to both instances, writes are serialized and wait for the readers of the instance they change
+    template <class Writer>
+    void write(const Writer &writer) {
+        std::lock_guard<std::mutex> lock(_writer_mutex);
+        int read_instance = _read_instance.load();
+        writer(*_instances[1 - read_instance]);
+        _read_instance.store(1 - read_instance);
+        // after the switch, a reader taking the new generation reads the new instance
+        _generation.store(nextGeneration());
+        // the new readers raise the indicator of the next version, those of the previous one are waited for, a
+        // reader which took the version before the toggle and the instance after it is covered by the first wait
+        int version = _version.load();
+        waitForReaders(1 - version);
+        _version.store(1 - version);
+        waitForReaders(version);
+        writer(*_instances[read_instance]);
+    }
+};
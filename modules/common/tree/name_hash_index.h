@@ -0,0 +1,436 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/encoding/block-helpers.hpp>
+
+#include <boost/container/small_vector.hpp>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+#include "network/name_view.h"
+#include "name_snapshot.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// longest prefix match by hashing, an alternative to NamedTree for FIB-like tables: the hashes of all the prefixes
+// of a Name are computed in a single pass over its component spans, then each prefix length which holds entries is
+// probed in its own flat table, longest first as NFD NameTree does. No component is compared on a miss
+template <class T>
+class NameHashIndex {
+private:
+    static const uint32_t EMPTY = UINT32_MAX;
+    static const uint32_t DELETED = UINT32_MAX - 1;
+    static const size_t INITIAL_CAPACITY = 16;
+
+    struct Slot {
+        uint64_t hash;
+        uint32_t record;
+    };
+
+    struct Record {
+        ndn::Name name;
+        std::shared_ptr<T> value;
+    };
+
+    // open addressing with linear probing, at most half full counting the deleted slots
+    struct Table {
+        std::vector<Slot> slots;
+        size_t size = 0;
+        size_t used = 0;
+    };
+
+    using Hashes = boost::container::small_vector<uint64_t, NameView::INLINE_COMPONENTS + 1>;
+
+    std::vector<Record> _records;
+    std::vector<uint32_t> _free_records;
+    // by prefix length, index 0 holds the root
+    std::vector<Table> _tables;
+    size_t _size = 0;
+
+    static NameComponentRef componentAt(const ndn::Name &name, size_t i) {
+        const auto &component = name.get(i);
+        return {component.type(), component.value(), component.value_size()};
+    }
+
+    static NameComponentRef componentAt(const NameView &name, size_t i) {
+        return name[i];
+    }
+
+    // hashes[k] is the hash of the prefix of length k, up to max_length components
+    static void computeHashes(const ndn::Name &name, size_t max_length, Hashes &hashes) {
+        size_t length = std::min<size_t>(name.size(), max_length);
+        hashes.resize(length + 1);
+        hashes[0] = name_hash::SEED;
+        for (size_t i = 0; i < length; ++i) {
+            hashes[i + 1] = name_hash::extend(hashes[i], componentAt(name, i));
+        }
+    }
+
+    // a received Name carries its hashes, they are only copied
+    static void computeHashes(const NameView &name, size_t max_length, Hashes &hashes) {
+        size_t length = std::min<size_t>(name.size(), max_length);
+        hashes.resize(length + 1);
+        for (size_t i = 0; i <= length; ++i) {
+            hashes[i] = name.getPrefixHash(i);
+        }
+    }
+
+    template <class NameType>
+    bool matches(const Record &record, const NameType &name, size_t length) const {
+        for (size_t i = 0; i < length; ++i) {
+            if (NameComponentRef::compare(record.name.get(i), componentAt(name, i)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // index of the slot holding the prefix of name of the given length, or of the first free one on its probe sequence
+    template <class NameType>
+    size_t probe(const Table &table, uint64_t hash, const NameType &name, size_t length, bool &found) const {
+        size_t mask = table.slots.size() - 1;
+        size_t free_slot = SIZE_MAX;
+        for (size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot &slot = table.slots[i];
+            if (slot.record == EMPTY) {
+                found = false;
+                return free_slot != SIZE_MAX ? free_slot : i;
+            } else if (slot.record == DELETED) {
+                if (free_slot == SIZE_MAX) {
+                    free_slot = i;
+                }
+            } else if (slot.hash == hash && matches(_records[slot.record], name, length)) {
+                found = true;
+                return i;
+            }
+        }
+    }
+
+    template <class NameType>
+    const Record* lookup(const NameType &name, size_t length, uint64_t hash) const {
+        if (length >= _tables.size() || _tables[length].size == 0) {
+            return nullptr;
+        }
+        bool found;
+        size_t i = probe(_tables[length], hash, name, length, found);
+        return found ? &_records[_tables[length].slots[i].record] : nullptr;
+    }
+
+    void rehash(Table &table, size_t capacity) {
+        std::vector<Slot> slots(capacity, Slot{0, EMPTY});
+        size_t mask = capacity - 1;
+        for (const Slot &slot : table.slots) {
+            if (slot.record != EMPTY && slot.record != DELETED) {
+                size_t i = slot.hash & mask;
+                while (slots[i].record != EMPTY) {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = slot;
+            }
+        }
+        table.slots.swap(slots);
+        table.used = table.size;
+    }
+
+    template <class Writer>
+    static void writeValue(Writer &writer, const std::shared_ptr<T> &value) {
+        std::string json = value ? value->toJSON() : "{}";
+        writer.RawValue(json.c_str(), json.size(), rapidjson::kObjectType);
+    }
+
+    template <class NameType>
+    std::shared_ptr<T> takeImpl(const NameType &name, uint64_t hash) {
+        size_t length = name.size();
+        if (length >= _tables.size() || _tables[length].size == 0) {
+            return nullptr;
+        }
+        Table &table = _tables[length];
+        bool found;
+        size_t i = probe(table, hash, name, length, found);
+        if (!found) {
+            return nullptr;
+        }
+        uint32_t record = table.slots[i].record;
+        std::shared_ptr<T> value = std::move(_records[record].value);
+        _records[record] = Record();
+        _free_records.emplace_back(record);
+        table.slots[i].record = DELETED;
+        --table.size;
+        --_size;
+        // the longest lengths are not probed at all once they are empty
+        while (_tables.size() > 1 && _tables.back().size == 0) {
+            _tables.pop_back();
+        }
+        return value;
+    }
+
+    template <class NameType>
+    std::vector<std::shared_ptr<T>> findValuesUntilImpl(const NameType &name) const {
+        std::vector<std::shared_ptr<T>> values;
+        Hashes hashes;
+        computeHashes(name, _tables.size() - 1, hashes);
+        for (size_t length = 0; length < hashes.size(); ++length) {
+            if (const Record *record = lookup(name, length, hashes[length])) {
+                values.emplace_back(record->value);
+            }
+        }
+        return values;
+    }
+
+    template <class NameType>
+    std::shared_ptr<T> findLastValueUntilImpl(const NameType &name) const {
+        Hashes hashes;
+        computeHashes(name, _tables.size() - 1, hashes);
+        for (size_t length = hashes.size(); length-- > 0;) {
+            if (const Record *record = lookup(name, length, hashes[length])) {
+                return record->value;
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    NameHashIndex() : _tables(1) {
+
+    }
+
+    ~NameHashIndex() = default;
+
+    // entries in the index
+    size_t size() const {
+        return _size;
+    }
+
+    // visitor(const T&) on each value, in no particular order
+    template <class Visitor>
+    void forEachValue(const Visitor &visitor) const {
+        for (const auto &record : _records) {
+            if (record.value) {
+                visitor(*record.value);
+            }
+        }
+    }
+
+    // the records with their Names as the part prefix + "_records", the tables by length as prefix + "_slots", the
+    // values aside
+    void addMemoryStats(MemoryStats &stats, const std::string &prefix) const {
+        size_t record_bytes = memory_usage::of(_records) + memory_usage::of(_free_records);
+        for (const auto &record : _records) {
+            record_bytes += memory_usage::of(record.name);
+        }
+        stats.add(prefix + "_records", _size, record_bytes);
+        size_t slots = 0;
+        size_t slot_bytes = memory_usage::of(_tables);
+        for (const auto &table : _tables) {
+            slots += table.slots.size();
+            slot_bytes += memory_usage::of(table.slots);
+        }
+        stats.add(prefix + "_slots", slots, slot_bytes);
+    }
+
+    std::shared_ptr<T> find(const ndn::Name &name) const {
+        const Record *record = lookup(name, name.size(), name_hash::hash(name));
+        return record ? record->value : nullptr;
+    }
+
+    // hash is the name_hash of name, e.g. known from the packet it was decoded from
+    std::shared_ptr<T> find(const ndn::Name &name, uint64_t hash) const {
+        const Record *record = lookup(name, name.size(), hash);
+        return record ? record->value : nullptr;
+    }
+
+    // the hash is the one the packet carries, nothing is computed
+    std::shared_ptr<T> find(const NameView &name) const {
+        const Record *record = lookup(name, name.size(), name.getHash());
+        return record ? record->value : nullptr;
+    }
+
+    // the slot the exact Name would be probed at first is brought into the cache, for a lookup of it a bit later,
+    // e.g. once the next packets of a burst were prefetched as well
+    void prefetch(const NameView &name) const {
+        size_t length = name.size();
+        if (length < _tables.size() && _tables[length].size > 0) {
+            const Table &table = _tables[length];
+            __builtin_prefetch(&table.slots[name.getHash() & (table.slots.size() - 1)]);
+        }
+    }
+
+    std::vector<std::shared_ptr<T>> findValuesUntil(const ndn::Name &name) const {
+        return findValuesUntilImpl(name);
+    }
+
+    std::vector<std::shared_ptr<T>> findValuesUntil(const NameView &name) const {
+        return findValuesUntilImpl(name);
+    }
+
+    std::shared_ptr<T> findLastValueUntil(const ndn::Name &name) const {
+        return findLastValueUntilImpl(name);
+    }
+
+    std::shared_ptr<T> findLastValueUntil(const NameView &name) const {
+        return findLastValueUntilImpl(name);
+    }
+
+    void insert(const ndn::Name &name, const std::shared_ptr<T> &value, bool replace = false) {
+        size_t length = name.size();
+        if (length >= _tables.size()) {
+            _tables.resize(length + 1);
+        }
+        Table &table = _tables[length];
+        if ((table.used + 1) * 2 > table.slots.size()) {
+            // deleted slots are dropped, the table grows only if it is really full
+            size_t capacity = INITIAL_CAPACITY;
+            while (capacity < (table.size + 1) * 4) {
+                capacity *= 2;
+            }
+            rehash(table, capacity);
+        }
+        uint64_t hash = name_hash::hash(name);
+        bool found;
+        size_t i = probe(table, hash, name, length, found);
+        if (found) {
+            if (replace) {
+                _records[table.slots[i].record].value = value;
+            }
+            return;
+        }
+        uint32_t record;
+        if (!_free_records.empty()) {
+            record = _free_records.back();
+            _free_records.pop_back();
+            _records[record] = Record{name, value};
+        } else {
+            record = static_cast<uint32_t>(_records.size());
+            _records.emplace_back(Record{name, value});
+        }
+        if (table.slots[i].record == EMPTY) {
+            ++table.used;
+        }
+        table.slots[i] = Slot{hash, record};
+        ++table.size;
+        ++_size;
+    }
+
+    // same as NamedTree, the records have no order so the entries are inserted one by one
+    void insert(std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> entries, bool replace = false) {
+        for (const auto &entry : entries) {
+            insert(entry.first, entry.second, replace);
+        }
+    }
+
+    void clear() {
+        _records.clear();
+        _free_records.clear();
+        _tables.assign(1, Table());
+        _size = 0;
+    }
+
+    void remove(const ndn::Name &name) {
+        takeImpl(name, name_hash::hash(name));
+    }
+
+    // same as find, the entry found is removed as well
+    std::shared_ptr<T> take(const NameView &name) {
+        return takeImpl(name, name.getHash());
+    }
+
+    // same layout as NamedTree::toJSON, every entry is a child of the root
+    template <class Writer>
+    void toJSON(Writer &writer) const {
+        const Record *root = _tables[0].size > 0 ? lookup(ndn::Name(), 0, name_hash::SEED) : nullptr;
+        writer.StartObject();
+        writer.Key("name");
+        writer.String("/");
+        writer.Key("info");
+        writeValue(writer, root ? root->value : nullptr);
+        writer.Key("children");
+        writer.StartArray();
+        for (const Record &record : _records) {
+            if (!record.value || record.name.size() == 0) {
+                continue;
+            }
+            writer.StartObject();
+            writer.Key("name");
+            std::string uri = record.name.toUri();
+            writer.String(uri.c_str(), static_cast<rapidjson::SizeType>(uri.size()));
+            writer.Key("info");
+            writeValue(writer, record.value);
+            writer.Key("children");
+            writer.StartArray();
+            writer.EndArray();
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+
+    std::string toJSON() const {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        toJSON(writer);
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+
+    // same as NamedTree::writeSnapshot, the records are sorted so the snapshot loads in any engine
+    template <class Encoder>
+    void writeSnapshot(std::string &out, const Encoder &encode) const {
+        name_snapshot::writeHeader(out, _size);
+        std::vector<NameComponentRef> components;
+        forEachAfter(nullptr, [&](const ndn::Name &name, const std::shared_ptr<T> &value) {
+            components.clear();
+            for (size_t i = 0; i < name.size(); ++i) {
+                components.emplace_back(componentAt(name, i));
+            }
+            name_snapshot::writeRecord(out, components, components.size(), encode(*value));
+            return true;
+        });
+    }
+
+    // same as NamedTree::readSnapshot, the Names are decoded to be kept in the records
+    template <class Decoder>
+    void readSnapshot(const uint8_t *wire, size_t size, const Decoder &decode) {
+        name_snapshot::Reader reader(wire, size);
+        std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> entries;
+        std::vector<NameComponentRef> components;
+        const uint8_t *value;
+        size_t value_length;
+        while (reader.next(components, value, value_length)) {
+            if (auto decoded = decode(value, value_length)) {
+                ndn::Name name;
+                for (const auto &component : components) {
+                    name.append(ndn::Name::Component(ndn::makeBinaryBlock(component.type, component.value, component.length)));
+                }
+                entries.emplace_back(std::move(name), std::move(decoded));
+            }
+            components.clear();
+        }
+        insert(std::move(entries), true);
+    }
+
+    // same as NamedTree::forEachAfter, the records have no order so the ones after cursor are sorted on every call
+    template <class Visitor>
+    void forEachAfter(const ndn::Name *cursor, const Visitor &visitor) const {
+        std::vector<const Record*> records;
+        for (const Record &record : _records) {
+            if (record.value && (!cursor || *cursor < record.name)) {
+                records.emplace_back(&record);
+            }
+        }
+        std::sort(records.begin(), records.end(), [](const Record *lhs, const Record *rhs) {
+            return lhs->name < rhs->name;
+        });
+        for (const Record *record : records) {
+            if (!visitor(record->name, record->value)) {
+                return;
+            }
+        }
+    }
+};
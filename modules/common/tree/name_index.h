@@ -0,0 +1,189 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "named_tree.h"
+#include "name_hash_index.h"
+#include "static_name_index.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+// prefix table whose lookup engine is chosen at startup, for the modules which only need exact and prefix lookups
+template <class T>
+class NameIndex {
+public:
+    using JsonWriter = rapidjson::Writer<rapidjson::StringBuffer>;
+    // called on each entry of a listing, returns false to stop it
+    using Visitor = std::function<bool(const ndn::Name&, const std::shared_ptr<T>&)>;
+    using Entries = std::vector<std::pair<ndn::Name, std::shared_ptr<T>>>;
+    // bytes of a value in a snapshot and back, a null value skips the record
+    using ValueEncoder = std::function<std::string(const T&)>;
+    using ValueDecoder = std::function<std::shared_ptr<T>(const uint8_t*, size_t)>;
+
+    virtual ~NameIndex() = default;
+
+    // "tree", "hash" or "static", null if the engine is unknown
+    static std::unique_ptr<NameIndex<T>> create(const std::string &engine);
+
+    virtual std::string getEngine() const = 0;
+
+    virtual std::shared_ptr<T> find(const ndn::Name &name) const = 0;
+
+    // values of all the prefixes of name, shortest first
+    virtual std::vector<std::shared_ptr<T>> findValuesUntil(const ndn::Name &name) const = 0;
+
+    virtual std::vector<std::shared_ptr<T>> findValuesUntil(const NameView &name) const = 0;
+
+    // value of the longest prefix of name, null if there is none
+    virtual std::shared_ptr<T> findLastValueUntil(const ndn::Name &name) const = 0;
+
+    virtual std::shared_ptr<T> findLastValueUntil(const NameView &name) const = 0;
+
+    virtual void insert(const ndn::Name &name, const std::shared_ptr<T> &value, bool replace) = 0;
+
+    // bulk insert, see NamedTree
+    virtual void insert(Entries entries, bool replace) = 0;
+
+    virtual void remove(const ndn::Name &name) = 0;
+
+    virtual void clear() = 0;
+
+    // a name_snapshot of the entries appended to out, in canonical Name order
+    virtual void writeSnapshot(std::string &out, const ValueEncoder &encode) const = 0;
+
+    // bulk insert with replace of the records of a snapshot, throws ndn::tlv::Error if it is malformed, the index
+    // is then unchanged
+    virtual void readSnapshot(const uint8_t *wire, size_t size, const ValueDecoder &decode) = 0;
+
+    virtual std::string toJSON() const = 0;
+
+    virtual void toJSON(JsonWriter &writer) const = 0;
+
+    // entries in canonical Name order, starting right after cursor or from the first one if cursor is null
+    virtual void forEachAfter(const ndn::Name *cursor, const Visitor &visitor) const = 0;
+
+    // the parts of the engine under prefix, the values aside
+    virtual void addMemoryStats(MemoryStats &stats, const std::string &prefix) const = 0;
+
+    // an array of {"name", "info"} objects for the entries after cursor, until limit of them are written or
+    // buffer, which writer writes to, holds max_bytes. returns true if the page stops before the last entry, the
+    // cursor of the next page is then set in next
+    bool writePage(JsonWriter &writer, const rapidjson::StringBuffer &buffer, const ndn::Name *cursor, size_t limit,
+                   size_t max_bytes, ndn::Name &next) const {
+        size_t count = 0;
+        bool is_truncated = false;
+        writer.StartArray();
+        forEachAfter(cursor, [&](const ndn::Name &name, const std::shared_ptr<T> &value) {
+            if (count == limit || buffer.GetSize() >= max_bytes) {
+                is_truncated = true;
+                return false;
+            }
+            writer.StartObject();
+            writer.Key("name");
+            std::string uri = name.toUri();
+            writer.String(uri.c_str(), static_cast<rapidjson::SizeType>(uri.size()));
+            writer.Key("info");
+            std::string json = value->toJSON();
+            writer.RawValue(json.c_str(), json.size(), rapidjson::kObjectType);
+            writer.EndObject();
+            next = name;
+            ++count;
+            return true;
+        });
+        writer.EndArray();
+        return is_truncated;
+    }
+};
+
+template <class T, class Engine>
+class NameIndexImpl : public NameIndex<T> {
+private:
+    const std::string _engine_name;
+    Engine _engine;
+
+public:
+    explicit NameIndexImpl(std::string engine_name) : _engine_name(std::move(engine_name)) {
+
+    }
+
+    std::string getEngine() const override {
+        return _engine_name;
+    }
+
+    std::shared_ptr<T> find(const ndn::Name &name) const override {
+        return _engine.find(name);
+    }
+
+    std::vector<std::shared_ptr<T>> findValuesUntil(const ndn::Name &name) const override {
+        return _engine.findValuesUntil(name);
+    }
+
+    std::vector<std::shared_ptr<T>> findValuesUntil(const NameView &name) const override {
+        return _engine.findValuesUntil(name);
+    }
+
+    std::shared_ptr<T> findLastValueUntil(const ndn::Name &name) const override {
+        return _engine.findLastValueUntil(name);
+    }
+
+    std::shared_ptr<T> findLastValueUntil(const NameView &name) const override {
+        return _engine.findLastValueUntil(name);
+    }
+
+    void insert(const ndn::Name &name, const std::shared_ptr<T> &value, bool replace) override {
+        _engine.insert(name, value, replace);
+    }
+
+    void insert(typename NameIndex<T>::Entries entries, bool replace) override {
+        _engine.insert(std::move(entries), replace);
+    }
+
+    void remove(const ndn::Name &name) override {
+        _engine.remove(name);
+    }
+
+    void clear() override {
+        _engine.clear();
+    }
+
+    void writeSnapshot(std::string &out, const typename NameIndex<T>::ValueEncoder &encode) const override {
+        _engine.writeSnapshot(out, encode);
+    }
+
+    void readSnapshot(const uint8_t *wire, size_t size, const typename NameIndex<T>::ValueDecoder &decode) override {
+        _engine.readSnapshot(wire, size, decode);
+    }
+
+    std::string toJSON() const override {
+        return _engine.toJSON();
+    }
+
+    void toJSON(typename NameIndex<T>::JsonWriter &writer) const override {
+        _engine.toJSON(writer);
+    }
+
+    void forEachAfter(const ndn::Name *cursor, const typename NameIndex<T>::Visitor &visitor) const override {
+        _engine.forEachAfter(cursor, visitor);
+    }
+
+    void addMemoryStats(MemoryStats &stats, const std::string &prefix) const override {
+        _engine.addMemoryStats(stats, prefix);
+    }
+};
+
+template <class T>
+std::unique_ptr<NameIndex<T>> NameIndex<T>::create(const std::string &engine) {
+    if (engine == "tree") {
+        return std::unique_ptr<NameIndex<T>>(new NameIndexImpl<T, NamedTree<T>>(engine));
+    } else if (engine == "hash") {
+        return std::unique_ptr<NameIndex<T>>(new NameIndexImpl<T, NameHashIndex<T>>(engine));
+    } else if (engine == "static") {
+        return std::unique_ptr<NameIndex<T>>(new NameIndexImpl<T, StaticNameIndex<T>>(engine));
+    }
+    return nullptr;
+}
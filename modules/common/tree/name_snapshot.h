@@ -0,0 +1,126 @@
+#pragma once
+
+#include <ndn-cxx/encoding/tlv.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "network/name_view.h"
+#include "network/tlv_reader.h"
+
+// binary snapshot of a Name table, the Names keep their TLV wire encoding so a snapshot is read back without
+// decoding any ndn::Name:
+//
+//   Snapshot = Header *(Name Value)
+//   Header   = HEADER-TYPE TLV-LENGTH NonNegativeInteger  ; number of records
+//   Value    = VALUE-TYPE TLV-LENGTH *OCTET               ; the entry, as encoded by the owner of the table
+//
+// the tables write their records in canonical Name order, which lets NamedTree load them in a single pass
+namespace name_snapshot {
+
+    // application range of the TLV types
+    const uint32_t HEADER = 200;
+    const uint32_t VALUE = 201;
+
+    inline size_t sizeOfVarNumber(uint64_t number) {
+        return number < 253 ? 1 : number <= 0xFFFF ? 3 : number <= 0xFFFFFFFF ? 5 : 9;
+    }
+
+    inline void writeVarNumber(std::string &out, uint64_t number) {
+        size_t size = sizeOfVarNumber(number);
+        if (size == 1) {
+            out.push_back(static_cast<char>(number));
+            return;
+        }
+        out.push_back(static_cast<char>(size == 3 ? 253 : size == 5 ? 254 : 255));
+        for (size_t i = size - 1; i-- > 0;) {
+            out.push_back(static_cast<char>(number >> (8 * i)));
+        }
+    }
+
+    inline void writeHeader(std::string &out, uint64_t records) {
+        writeVarNumber(out, HEADER);
+        writeVarNumber(out, 8);
+        for (size_t i = 8; i-- > 0;) {
+            out.push_back(static_cast<char>(records >> (8 * i)));
+        }
+    }
+
+    // the TLV of each component. VAR-NUMBERs keep the order of the numbers they encode, so these bytes compare with
+    // memcmp in the canonical order of the Names, a shorter prefix first
+    template <class Components>
+    void writeComponents(std::string &out, const Components &components, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            writeVarNumber(out, components[i].type);
+            writeVarNumber(out, components[i].length);
+            out.append(reinterpret_cast<const char*>(components[i].value), components[i].length);
+        }
+    }
+
+    // components is a sequence of NameComponentRef, of count elements
+    template <class Components>
+    void writeRecord(std::string &out, const Components &components, size_t count, const std::string &value) {
+        size_t name_length = 0;
+        for (size_t i = 0; i < count; ++i) {
+            name_length += sizeOfVarNumber(components[i].type) + sizeOfVarNumber(components[i].length) + components[i].length;
+        }
+        writeVarNumber(out, ndn::tlv::Name);
+        writeVarNumber(out, name_length);
+        writeComponents(out, components, count);
+        writeVarNumber(out, VALUE);
+        writeVarNumber(out, value.size());
+        out.append(value);
+    }
+
+    // walks the records of a snapshot, the components and values returned point into its buffer. throws
+    // ndn::tlv::Error on truncated or malformed input
+    class Reader {
+    private:
+        const uint8_t *_it;
+        const uint8_t *_end;
+        uint64_t _records;
+
+    public:
+        Reader(const uint8_t *wire, size_t size) : _it(wire), _end(wire + size) {
+            uint32_t type;
+            size_t length = tlv_reader::readHeader(_it, _end, type);
+            if (type != HEADER) {
+                throw ndn::tlv::Error("not a Name snapshot");
+            }
+            _records = tlv_reader::readNonNegativeInteger(_it, length);
+            _it += length;
+        }
+
+        // as written in the header, only a hint to reserve memory
+        uint64_t getRecords() const {
+            return _records;
+        }
+
+        // appends the components of the next record and points value at its bytes, false at the end of the snapshot
+        bool next(std::vector<NameComponentRef> &components, const uint8_t *&value, size_t &value_length) {
+            if (_it == _end) {
+                return false;
+            }
+            uint32_t type;
+            size_t name_length = tlv_reader::readHeader(_it, _end, type);
+            if (type != ndn::tlv::Name) {
+                throw ndn::tlv::Error("snapshot record without Name");
+            }
+            const uint8_t *name_end = _it + name_length;
+            while (_it != name_end) {
+                size_t length = tlv_reader::readHeader(_it, name_end, type);
+                components.push_back({type, _it, length});
+                _it += length;
+            }
+            value_length = tlv_reader::readHeader(_it, _end, type);
+            if (type != VALUE) {
+                throw ndn::tlv::Error("snapshot record without value");
+            }
+            value = _it;
+            _it += value_length;
+            return true;
+        }
+    };
+
+}
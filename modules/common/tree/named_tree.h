@@ -0,0 +1,1026 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/encoding/block-helpers.hpp>
+#include <boost/container/small_vector.hpp>
+
+#include "metrics/memory_stats.h"
+#include "network/name_view.h"
+#include "network/page_arena.h"
+#include "name_snapshot.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// name prefix tree, nodes live in an arena and refer to each other by index: a node holds no Name, only its own
+// component whose value bytes are interned, so a value shared by many nodes (segments, versions, directories found
+// under several prefixes) is stored once. Names are rebuilt from the parent links when a caller asks for them
+//
+// populated nodes are also linked in recency order, most recent first: insert() and the touch calls move a node to
+// the front, so tables with a bounded size evict the least recent node without keeping a list of their Names
+//
+// many Names are inserted at once in canonical order, each one only walks the components after those it shares with
+// the Name before it and its new nodes are appended last in their parent, the whole tree is thus built in one pass
+// from a sorted list or a snapshot
+//
+// with deferred pruning, a removal only empties its node, the nodes left without value nor children are freed by
+// prune() up the tree later, e.g. from a timer, rather than by each removal on the insert path of a full table
+template <class T>
+class NamedTree {
+private:
+    static const uint32_t ROOT = 0;
+    static const uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        // null for the root and for free nodes
+        const std::string *component_value = nullptr;
+        uint32_t component_type = 0;
+        uint32_t parent = NONE;
+        // in canonical component order, like ndn::Name::Component::compare
+        std::vector<uint32_t> children;
+        std::shared_ptr<T> value;
+        // recency links, NONE unless the node is populated
+        uint32_t newer = NONE;
+        uint32_t older = NONE;
+    };
+
+    // nodes are allocated by chunks which never move, there is no reallocation nor growth slack as with a vector.
+    // once PageArena is enabled the chunks of a new tree are packed in its regions, on huge pages, rather than
+    // spread over the heap
+    class NodeArena {
+    private:
+        static const size_t CHUNK_SIZE = 1024;
+
+        struct ChunkDeleter {
+            bool is_paged = false;
+
+            void operator()(Node *chunk) const {
+                if (!is_paged) {
+                    delete[] chunk;
+                    return;
+                }
+                // the memory goes back with the PageArena
+                for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+                    chunk[i].~Node();
+                }
+            }
+        };
+
+        // before the chunks, which are destroyed first
+        std::unique_ptr<PageArena> _pages = PageArena::isEnabled() ? std::unique_ptr<PageArena>(new PageArena()) : nullptr;
+        std::vector<std::unique_ptr<Node[], ChunkDeleter>> _chunks;
+        uint32_t _size = 0;
+
+    public:
+        NodeArena() = default;
+
+        NodeArena(NodeArena&&) = default;
+
+        // the chunks go before the PageArena holding them, which a member-wise assignment would swap first
+        NodeArena& operator=(NodeArena &&other) {
+            _chunks.clear();
+            _pages = std::move(other._pages);
+            _chunks = std::move(other._chunks);
+            _size = other._size;
+            other._size = 0;
+            return *this;
+        }
+
+        Node& operator[](uint32_t index) {
+            return _chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+        }
+
+        const Node& operator[](uint32_t index) const {
+            return _chunks[index / CHUNK_SIZE][index % CHUNK_SIZE];
+        }
+
+        uint32_t allocate() {
+            if (_size % CHUNK_SIZE == 0) {
+                if (_pages) {
+                    Node *chunk = static_cast<Node*>(_pages->allocate(CHUNK_SIZE * sizeof(Node), alignof(Node)));
+                    std::uninitialized_fill_n(chunk, CHUNK_SIZE, Node());
+                    _chunks.emplace_back(chunk, ChunkDeleter{true});
+                } else {
+                    _chunks.emplace_back(new Node[CHUNK_SIZE]);
+                }
+            }
+            return _size++;
+        }
+
+        size_t size() const {
+            return _size;
+        }
+
+        // of the chunks, allocated whole
+        size_t getBytes() const {
+            return _chunks.size() * CHUNK_SIZE * sizeof(Node) + memory_usage::of(_chunks);
+        }
+    };
+
+    NodeArena _nodes;
+    std::vector<uint32_t> _free_nodes;
+    // value bytes of the components, each with the number of nodes using it
+    std::unordered_map<std::string, size_t> _component_values;
+
+    bool _deferred_pruning = false;
+    // emptied leaves waiting for prune(), which may have been populated again or freed since
+    std::vector<uint32_t> _emptied_nodes;
+
+    size_t _populated_nodes = 0;
+    uint32_t _most_recent = NONE;
+    uint32_t _least_recent = NONE;
+
+    static NameComponentRef toRef(const ndn::Name::Component &component) {
+        return {component.type(), component.value(), component.value_size()};
+    }
+
+    static NameComponentRef toRef(const NameComponentRef &component) {
+        return component;
+    }
+
+    static NameComponentRef toRef(const Node &node) {
+        return {node.component_type, reinterpret_cast<const uint8_t*>(node.component_value->data()), node.component_value->size()};
+    }
+
+    static ndn::Name::Component toComponent(const Node &node) {
+        NameComponentRef ref = toRef(node);
+        return ndn::Name::Component(ndn::makeBinaryBlock(ref.type, ref.value, ref.length));
+    }
+
+    static int compare(const Node &node, const NameComponentRef &component) {
+        if (node.component_type != component.type) {
+            return node.component_type < component.type ? -1 : 1;
+        }
+        size_t length = node.component_value->size();
+        if (length != component.length) {
+            return length < component.length ? -1 : 1;
+        }
+        return length == 0 ? 0 : std::memcmp(node.component_value->data(), component.value, length);
+    }
+
+    // position of the child with this component in the children of parent, or of where it would be inserted
+    std::vector<uint32_t>::const_iterator lowerBound(uint32_t parent, const NameComponentRef &component) const {
+        const auto &children = _nodes[parent].children;
+        return std::lower_bound(children.begin(), children.end(), component, [this](uint32_t child, const NameComponentRef &ref) {
+            return compare(_nodes[child], ref) < 0;
+        });
+    }
+
+    uint32_t getChild(uint32_t parent, const NameComponentRef &component) const {
+        auto it = lowerBound(parent, component);
+        return it != _nodes[parent].children.end() && compare(_nodes[*it], component) == 0 ? *it : NONE;
+    }
+
+    uint32_t getOrCreateChild(uint32_t parent, const NameComponentRef &component) {
+        const auto &children = _nodes[parent].children;
+        // a child greater than all the others, as in a bulk insert, skips the search
+        if (!children.empty() && compare(_nodes[children.back()], component) < 0) {
+            return createChild(parent, children.size(), component);
+        }
+        auto it = lowerBound(parent, component);
+        if (it != children.end() && compare(_nodes[*it], component) == 0) {
+            return *it;
+        }
+        return createChild(parent, it - children.begin(), component);
+    }
+
+    uint32_t createChild(uint32_t parent, size_t position, const NameComponentRef &component) {
+        uint32_t child;
+        if (!_free_nodes.empty()) {
+            child = _free_nodes.back();
+            _free_nodes.pop_back();
+        } else {
+            child = _nodes.allocate();
+        }
+        auto value_it = _component_values.emplace(std::string(reinterpret_cast<const char*>(component.value), component.length), 0).first;
+        ++value_it->second;
+        Node &node = _nodes[child];
+        node.component_value = &value_it->first;
+        node.component_type = component.type;
+        node.parent = parent;
+        auto &children = _nodes[parent].children;
+        children.insert(children.begin() + position, child);
+        return child;
+    }
+
+    void freeNode(uint32_t index) {
+        Node &node = _nodes[index];
+        auto &siblings = _nodes[node.parent].children;
+        siblings.erase(lowerBound(node.parent, toRef(node)));
+        auto value_it = _component_values.find(*node.component_value);
+        if (--value_it->second == 0) {
+            _component_values.erase(value_it);
+        }
+        node.component_value = nullptr;
+        node.parent = NONE;
+        std::vector<uint32_t>().swap(node.children);
+        _free_nodes.emplace_back(index);
+    }
+
+    void link(uint32_t index) {
+        Node &node = _nodes[index];
+        node.newer = NONE;
+        node.older = _most_recent;
+        if (_most_recent != NONE) {
+            _nodes[_most_recent].newer = index;
+        } else {
+            _least_recent = index;
+        }
+        _most_recent = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node &node = _nodes[index];
+        if (node.newer != NONE) {
+            _nodes[node.newer].older = node.older;
+        } else {
+            _most_recent = node.older;
+        }
+        if (node.older != NONE) {
+            _nodes[node.older].newer = node.newer;
+        } else {
+            _least_recent = node.newer;
+        }
+        node.newer = NONE;
+        node.older = NONE;
+    }
+
+    void touchNode(uint32_t index) {
+        if (index != _most_recent) {
+            unlink(index);
+            link(index);
+        }
+    }
+
+    void removeNode(uint32_t node) {
+        unlink(node);
+        _nodes[node].value.reset();
+        --_populated_nodes;
+        if (!_deferred_pruning) {
+            pruneFrom(node);
+        } else if (_nodes[node].children.empty()) {
+            _emptied_nodes.emplace_back(node);
+        }
+    }
+
+    // frees node and its ancestors as long as they are left without value nor children, returns how many
+    size_t pruneFrom(uint32_t node) {
+        size_t freed = 0;
+        // a free node has no component
+        while (node != ROOT && _nodes[node].component_value && !_nodes[node].value && _nodes[node].children.empty()) {
+            uint32_t parent = _nodes[node].parent;
+            freeNode(node);
+            node = parent;
+            ++freed;
+        }
+        return freed;
+    }
+
+    void setValue(uint32_t node, const std::shared_ptr<T> &value, bool replace) {
+        if (!_nodes[node].value) {
+            _nodes[node].value = value;
+            ++_populated_nodes;
+            link(node);
+        } else {
+            if (replace) {
+                _nodes[node].value = value;
+            }
+            touchNode(node);
+        }
+    }
+
+    // node of the Name made of the first count components, created if needed. path holds the nodes of the Name
+    // inserted before, down from the root excluded, the components shared with it are not looked up again
+    template <class Components>
+    uint32_t getOrCreatePath(const Components &components, size_t count, std::vector<uint32_t> &path) {
+        size_t depth = 0;
+        while (depth < count && depth < path.size() && compare(_nodes[path[depth]], toRef(components[depth])) == 0) {
+            ++depth;
+        }
+        path.resize(depth);
+        uint32_t node = depth > 0 ? path.back() : ROOT;
+        for (; depth < count; ++depth) {
+            node = getOrCreateChild(node, toRef(components[depth]));
+            path.emplace_back(node);
+        }
+        return node;
+    }
+
+    template <class NameType>
+    uint32_t walk(const NameType &name) const {
+        uint32_t node = ROOT;
+        for (const auto& component : name) {
+            if ((node = getChild(node, toRef(component))) == NONE) {
+                break;
+            }
+        }
+        return node;
+    }
+
+    ndn::Name getName(uint32_t index) const {
+        std::vector<uint32_t> path;
+        for (; index != ROOT; index = _nodes[index].parent) {
+            path.emplace_back(index);
+        }
+        ndn::Name name;
+        for (auto it = path.rbegin(); it != path.rend(); ++it) {
+            name.append(toComponent(_nodes[*it]));
+        }
+        return name;
+    }
+
+    template <class NameType>
+    std::pair<ndn::Name, std::shared_ptr<T>> findLastUntilImpl(const NameType &name) const {
+        uint32_t node = ROOT;
+        auto value = _nodes[ROOT].value;
+        for (const auto& component : name) {
+            uint32_t child = getChild(node, toRef(component));
+            if (child == NONE) {
+                break;
+            }
+            if (_nodes[child].value) {
+                value = _nodes[child].value;
+            }
+            node = child;
+        }
+        return {getName(node), value};
+    }
+
+    template <class NameType>
+    std::shared_ptr<T> findLastValueUntilImpl(const NameType &name) const {
+        uint32_t node = ROOT;
+        auto value = _nodes[ROOT].value;
+        for (const auto& component : name) {
+            if ((node = getChild(node, toRef(component))) == NONE) {
+                break;
+            }
+            if (_nodes[node].value) {
+                value = _nodes[node].value;
+            }
+        }
+        return value;
+    }
+
+    template <class NameType>
+    std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> findAllUntilImpl(const NameType &name) const {
+        std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> values;
+        if (_nodes[ROOT].value) {
+            values.emplace_back(ndn::Name(), _nodes[ROOT].value);
+        }
+        uint32_t node = ROOT;
+        for (const auto& component : name) {
+            if ((node = getChild(node, toRef(component))) == NONE) {
+                break;
+            }
+            if (_nodes[node].value) {
+                values.emplace_back(getName(node), _nodes[node].value);
+            }
+        }
+        return values;
+    }
+
+    template <class NameType>
+    std::vector<std::shared_ptr<T>> findValuesUntilImpl(const NameType &name) const {
+        std::vector<std::shared_ptr<T>> values;
+        if (_nodes[ROOT].value) {
+            values.emplace_back(_nodes[ROOT].value);
+        }
+        uint32_t node = ROOT;
+        for (const auto& component : name) {
+            if ((node = getChild(node, toRef(component))) == NONE) {
+                break;
+            }
+            if (_nodes[node].value) {
+                values.emplace_back(_nodes[node].value);
+            }
+        }
+        return values;
+    }
+
+    // first populated node among node and its descendants, NONE if there is none
+    uint32_t findFirstNode(uint32_t node, bool rightmost) const {
+        if (_nodes[node].value) {
+            return node;
+        }
+        const auto &children = _nodes[node].children;
+        if (!children.empty()) {
+            node = rightmost ? children.back() : children.front();
+            for (;;) {
+                if (_nodes[node].value) {
+                    return node;
+                }
+                if (_nodes[node].children.empty()) {
+                    break;
+                }
+                node = _nodes[node].children.front();
+            }
+        }
+        return NONE;
+    }
+
+    // pre-order on an explicit stack, the children of the start node are taken from the right if rightmost, those of
+    // the nodes below always from the left
+    template <class Accept>
+    uint32_t findFirstMatchingNode(uint32_t start, bool rightmost, const Accept &accept) const {
+        boost::container::small_vector<uint32_t, 32> stack;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            uint32_t node = stack.back();
+            stack.pop_back();
+            if (_nodes[node].value && accept(_nodes[node].value)) {
+                return node;
+            }
+            const auto &children = _nodes[node].children;
+            if (node == start && rightmost) {
+                stack.insert(stack.end(), children.begin(), children.end());
+            } else {
+                stack.insert(stack.end(), children.rbegin(), children.rend());
+            }
+        }
+        return NONE;
+    }
+
+    std::pair<ndn::Name, std::shared_ptr<T>> findFirstFromNode(uint32_t node, bool rightmost) const {
+        node = findFirstNode(node, rightmost);
+        return node != NONE ? std::pair<ndn::Name, std::shared_ptr<T>>(getName(node), _nodes[node].value)
+                            : std::pair<ndn::Name, std::shared_ptr<T>>(ndn::Name(), nullptr);
+    }
+
+    template <class Writer>
+    static void writeString(Writer &writer, const std::string &value) {
+        writer.String(value.c_str(), static_cast<rapidjson::SizeType>(value.size()));
+    }
+
+    // the values serialize themselves to strings, these are small and copied as is
+    template <class Writer>
+    static void writeValue(Writer &writer, const std::shared_ptr<T> &value) {
+        std::string json = value ? value->toJSON() : "{}";
+        writer.RawValue(json.c_str(), json.size(), rapidjson::kObjectType);
+    }
+
+public:
+    // a node reached by a SubtreeIterator, valid until the tree changes
+    class SubtreeNode {
+    private:
+        const NamedTree *_tree;
+        uint32_t _node;
+        size_t _depth;
+
+    public:
+        SubtreeNode(const NamedTree *tree, uint32_t node, size_t depth) : _tree(tree), _node(node), _depth(depth) {
+
+        }
+
+        // null if the node only leads to others
+        const std::shared_ptr<T>& getValue() const {
+            return _tree->_nodes[_node].value;
+        }
+
+        // 0 for the node the walk starts from
+        size_t getDepth() const {
+            return _depth;
+        }
+
+        // last component of the Name, not meaningful for the root
+        NameComponentRef getComponent() const {
+            const Node &node = _tree->_nodes[_node];
+            return node.component_value ? toRef(node) : NameComponentRef{0, nullptr, 0};
+        }
+
+        // rebuilt from the parent links on each call
+        ndn::Name getName() const {
+            return _tree->getName(_node);
+        }
+    };
+
+    // pre-order walk of a subtree in canonical Name order, the start node first and every node, populated or not,
+    // down to a depth limit. a frame per level is all it keeps, no Name is built unless asked for. any change to
+    // the tree invalidates it
+    class SubtreeIterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = SubtreeNode;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = SubtreeNode;
+
+    private:
+        struct Frame {
+            uint32_t node;
+            uint32_t next_child;
+        };
+
+        const NamedTree *_tree = nullptr;
+        size_t _max_depth = 0;
+        std::vector<Frame> _stack;
+
+    public:
+        // the end of any walk
+        SubtreeIterator() = default;
+
+        SubtreeIterator(const NamedTree *tree, uint32_t node, size_t max_depth) : _tree(tree), _max_depth(max_depth) {
+            _stack.push_back({node, 0});
+        }
+
+        SubtreeNode operator*() const {
+            return {_tree, _stack.back().node, _stack.size() - 1};
+        }
+
+        SubtreeIterator& operator++() {
+            while (!_stack.empty()) {
+                Frame &frame = _stack.back();
+                const auto &children = _tree->_nodes[frame.node].children;
+                if (_stack.size() <= _max_depth && frame.next_child < children.size()) {
+                    _stack.push_back({children[frame.next_child++], 0});
+                    return *this;
+                }
+                _stack.pop_back();
+            }
+            return *this;
+        }
+
+        // the descendants of the current node are not walked, e.g. once a whole branch is known to match
+        void skipDescendants() {
+            _stack.back().next_child = static_cast<uint32_t>(_tree->_nodes[_stack.back().node].children.size());
+        }
+
+        bool operator==(const SubtreeIterator &other) const {
+            return _stack.empty() ? other._stack.empty()
+                                  : !other._stack.empty() && _stack.back().node == other._stack.back().node;
+        }
+
+        bool operator!=(const SubtreeIterator &other) const {
+            return !(*this == other);
+        }
+    };
+
+    class SubtreeRange {
+    private:
+        SubtreeIterator _begin;
+
+    public:
+        explicit SubtreeRange(SubtreeIterator begin) : _begin(std::move(begin)) {
+
+        }
+
+        SubtreeIterator begin() const {
+            return _begin;
+        }
+
+        SubtreeIterator end() const {
+            return SubtreeIterator();
+        }
+    };
+
+    NamedTree() {
+        _nodes.allocate();
+    }
+
+    // the interned values don't move with the map, the nodes keep pointing at them
+    NamedTree(NamedTree&&) = default;
+
+    NamedTree& operator=(NamedTree&&) = default;
+
+    ~NamedTree() = default;
+
+    // nodes in the tree, root included
+    size_t size() const {
+        return _nodes.size() - _free_nodes.size();
+    }
+
+    size_t getPopulatedNodes() const {
+        return _populated_nodes;
+    }
+
+    bool isPruningDeferred() const {
+        return _deferred_pruning;
+    }
+
+    // the nodes already emptied are freed when it is turned off
+    void setDeferredPruning(bool deferred) {
+        _deferred_pruning = deferred;
+        if (!deferred) {
+            prune(SIZE_MAX);
+        }
+    }
+
+    // leaves emptied by the removals and not pruned yet
+    size_t getEmptiedNodes() const {
+        return _emptied_nodes.size();
+    }
+
+    // frees the emptied leaves and the ancestors they leave empty, until about max_nodes are freed, returns how many
+    size_t prune(size_t max_nodes) {
+        size_t freed = 0;
+        while (!_emptied_nodes.empty() && freed < max_nodes) {
+            uint32_t node = _emptied_nodes.back();
+            _emptied_nodes.pop_back();
+            freed += pruneFrom(node);
+        }
+        return freed;
+    }
+
+    // distinct component values interned by the nodes
+    size_t getComponentValues() const {
+        return _component_values.size();
+    }
+
+    // visitor(const T&) on each value, most recent first, without rebuilding the Names as the listings do
+    template <class Visitor>
+    void forEachValue(const Visitor &visitor) const {
+        for (uint32_t node = _most_recent; node != NONE; node = _nodes[node].older) {
+            visitor(*_nodes[node].value);
+        }
+    }
+
+    // the nodes with their children and the free list as the part prefix + "_nodes", the interned values as prefix +
+    // "_components". the values are left to the caller, which knows what they hold
+    void addMemoryStats(MemoryStats &stats, const std::string &prefix) const {
+        size_t node_bytes = _nodes.getBytes() + memory_usage::of(_free_nodes) + memory_usage::of(_emptied_nodes);
+        for (uint32_t i = 0; i < _nodes.size(); ++i) {
+            node_bytes += memory_usage::of(_nodes[i].children);
+        }
+        stats.add(prefix + "_nodes", size(), node_bytes);
+        size_t component_bytes = memory_usage::of(_component_values);
+        for (const auto &value : _component_values) {
+            component_bytes += memory_usage::of(value.first);
+        }
+        stats.add(prefix + "_components", _component_values.size(), component_bytes);
+    }
+
+    std::shared_ptr<T> find(const ndn::Name &name) const {
+        uint32_t node = walk(name);
+        return node != NONE ? _nodes[node].value : nullptr;
+    }
+
+    std::shared_ptr<T> find(const NameView &name) const {
+        uint32_t node = walk(name);
+        return node != NONE ? _nodes[node].value : nullptr;
+    }
+
+    // the value of the Name made of the first length components of name, e.g. without its implicit digest
+    std::shared_ptr<T> find(const NameView &name, size_t length) const {
+        uint32_t node = ROOT;
+        for (size_t i = 0; i < length && node != NONE; ++i) {
+            node = getChild(node, toRef(name[i]));
+        }
+        return node != NONE ? _nodes[node].value : nullptr;
+    }
+
+    std::pair<ndn::Name, std::shared_ptr<T>> findLastUntil(const ndn::Name &name) const {
+        return findLastUntilImpl(name);
+    }
+
+    std::pair<ndn::Name, std::shared_ptr<T>> findLastUntil(const NameView &name) const {
+        return findLastUntilImpl(name);
+    }
+
+    // same as findLastUntil without rebuilding the Name
+    std::shared_ptr<T> findLastValueUntil(const ndn::Name &name) const {
+        return findLastValueUntilImpl(name);
+    }
+
+    std::shared_ptr<T> findLastValueUntil(const NameView &name) const {
+        return findLastValueUntilImpl(name);
+    }
+
+    std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> findAllUntil(const ndn::Name &name) const {
+        return findAllUntilImpl(name);
+    }
+
+    std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> findAllUntil(const NameView &name) const {
+        return findAllUntilImpl(name);
+    }
+
+    // same as findAllUntil without rebuilding the Names, for lookups which only need the values
+    std::vector<std::shared_ptr<T>> findValuesUntil(const ndn::Name &name) const {
+        return findValuesUntilImpl(name);
+    }
+
+    std::vector<std::shared_ptr<T>> findValuesUntil(const NameView &name) const {
+        return findValuesUntilImpl(name);
+    }
+
+    std::pair<ndn::Name, std::shared_ptr<T>> findFirstFrom(const ndn::Name &name, bool rightmost = false) const {
+        uint32_t node = walk(name);
+        return node != NONE ? findFirstFromNode(node, rightmost) : std::pair<ndn::Name, std::shared_ptr<T>>(ndn::Name(), nullptr);
+    }
+
+    std::pair<ndn::Name, std::shared_ptr<T>> findFirstFrom(const NameView &name, bool rightmost = false) const {
+        uint32_t node = walk(name);
+        return node != NONE ? findFirstFromNode(node, rightmost) : std::pair<ndn::Name, std::shared_ptr<T>>(ndn::Name(), nullptr);
+    }
+
+    // first value of the subtree of name which accept(const std::shared_ptr<T>&) takes, in the order of
+    // findFirstFrom: the node of name, then its children from the leftmost or the rightmost one, each of them
+    // walked leftmost first. a value refused, e.g. a stale one, doesn't stop the walk. null if none is taken
+    template <class Accept>
+    std::shared_ptr<T> findFirstMatch(const ndn::Name &name, bool rightmost, const Accept &accept) const {
+        uint32_t node = walk(name);
+        return node != NONE && (node = findFirstMatchingNode(node, rightmost, accept)) != NONE ? _nodes[node].value : nullptr;
+    }
+
+    template <class Accept>
+    std::shared_ptr<T> findFirstMatch(const NameView &name, bool rightmost, const Accept &accept) const {
+        uint32_t node = walk(name);
+        return node != NONE && (node = findFirstMatchingNode(node, rightmost, accept)) != NONE ? _nodes[node].value : nullptr;
+    }
+
+    // the node of name and its descendants down to max_depth levels below it, empty if name has no node
+    SubtreeRange subtree(const ndn::Name &name, size_t max_depth = SIZE_MAX) const {
+        uint32_t node = walk(name);
+        return SubtreeRange(node != NONE ? SubtreeIterator(this, node, max_depth) : SubtreeIterator());
+    }
+
+    SubtreeRange subtree(const NameView &name, size_t max_depth = SIZE_MAX) const {
+        uint32_t node = walk(name);
+        return SubtreeRange(node != NONE ? SubtreeIterator(this, node, max_depth) : SubtreeIterator());
+    }
+
+    // the node and all its descendants in the order of subtree(), with their Names
+    std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> findAllFrom(const ndn::Name &name) const {
+        std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> values;
+        for (const auto &node : subtree(name)) {
+            values.emplace_back(node.getName(), node.getValue());
+        }
+        return values;
+    }
+
+    // same as findFirstFrom, the node found becomes the most recent
+    std::pair<ndn::Name, std::shared_ptr<T>> touchFirstFrom(const NameView &name, bool rightmost = false) {
+        uint32_t node = walk(name);
+        if (node == NONE || (node = findFirstNode(node, rightmost)) == NONE) {
+            return {ndn::Name(), nullptr};
+        }
+        touchNode(node);
+        return {getName(node), _nodes[node].value};
+    }
+
+    // same as find, the node found becomes the most recent
+    std::shared_ptr<T> touch(const ndn::Name &name) {
+        uint32_t node = walk(name);
+        if (node == NONE || !_nodes[node].value) {
+            return nullptr;
+        }
+        touchNode(node);
+        return _nodes[node].value;
+    }
+
+    // the node of name becomes the most recent, whether it was already populated or not
+    void insert(const ndn::Name &name, const std::shared_ptr<T> &value, bool replace = false) {
+        uint32_t node = ROOT;
+        for (const auto& component : name) {
+            node = getOrCreateChild(node, toRef(component));
+        }
+        setValue(node, value, replace);
+    }
+
+    // bulk insert, entries are sorted first and become the most recent in canonical order. with replace, the last
+    // of several entries with the same Name wins
+    void insert(std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> entries, bool replace = false) {
+        // sorted on their encoded components laid out in one buffer rather than by comparing the Names, which
+        // would chase the components of both on every comparison
+        struct Key {
+            size_t offset;
+            size_t length;
+            size_t entry;
+        };
+        std::string encoded;
+        std::vector<Key> keys;
+        keys.reserve(entries.size());
+        std::vector<NameComponentRef> components;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            components.clear();
+            for (const auto &component : entries[i].first) {
+                components.emplace_back(toRef(component));
+            }
+            size_t offset = encoded.size();
+            name_snapshot::writeComponents(encoded, components, components.size());
+            keys.push_back({offset, encoded.size() - offset, i});
+        }
+        const char *data = encoded.data();
+        std::stable_sort(keys.begin(), keys.end(), [data](const Key &lhs, const Key &rhs) {
+            int order = std::memcmp(data + lhs.offset, data + rhs.offset, std::min(lhs.length, rhs.length));
+            return order != 0 ? order < 0 : lhs.length < rhs.length;
+        });
+        std::vector<uint32_t> path;
+        for (const auto &key : keys) {
+            const auto &entry = entries[key.entry];
+            setValue(getOrCreatePath(entry.first, entry.first.size(), path), entry.second, replace);
+        }
+    }
+
+    void clear() {
+        bool deferred = _deferred_pruning;
+        *this = NamedTree();
+        _deferred_pruning = deferred;
+    }
+
+    void remove(const ndn::Name &name) {
+        uint32_t node = walk(name);
+        if (node == NONE || !_nodes[node].value) {
+            return;
+        }
+        removeNode(node);
+    }
+
+    // same as findValuesUntil, the nodes found are removed as well, the deepest first so that the path above stays
+    // valid while it is pruned
+    template <class NameType>
+    std::vector<std::shared_ptr<T>> takeValuesUntil(const NameType &name) {
+        boost::container::small_vector<uint32_t, 32> populated;
+        uint32_t node = ROOT;
+        if (_nodes[node].value) {
+            populated.emplace_back(node);
+        }
+        for (const auto& component : name) {
+            if ((node = getChild(node, toRef(component))) == NONE) {
+                break;
+            }
+            if (_nodes[node].value) {
+                populated.emplace_back(node);
+            }
+        }
+        std::vector<std::shared_ptr<T>> values(populated.size());
+        for (size_t i = populated.size(); i-- > 0;) {
+            values[i] = std::move(_nodes[populated[i]].value);
+            removeNode(populated[i]);
+        }
+        return values;
+    }
+
+    // eviction of the populated node used the least recently, if any
+    void removeLeastRecent() {
+        if (_least_recent != NONE) {
+            removeNode(_least_recent);
+        }
+    }
+
+    // the whole tree as nested {"name", "info", "children"} objects, written as the nodes are walked with an explicit
+    // stack so neither the depth of the tree nor its size builds up anything but the output
+    template <class Writer>
+    void toJSON(Writer &writer) const {
+        struct Frame {
+            uint32_t node;
+            size_t next_child;
+            ndn::Name name;
+        };
+        std::vector<Frame> stack;
+        auto open = [&](uint32_t node, ndn::Name name) {
+            writer.StartObject();
+            writer.Key("name");
+            writeString(writer, name.toUri());
+            writer.Key("info");
+            writeValue(writer, _nodes[node].value);
+            writer.Key("children");
+            writer.StartArray();
+            stack.push_back(Frame{node, 0, std::move(name)});
+        };
+        open(ROOT, ndn::Name());
+        while (!stack.empty()) {
+            Frame &frame = stack.back();
+            const auto &children = _nodes[frame.node].children;
+            if (frame.next_child < children.size()) {
+                uint32_t child = children[frame.next_child++];
+                ndn::Name name(frame.name);
+                name.append(toComponent(_nodes[child]));
+                open(child, std::move(name));
+            } else {
+                writer.EndArray();
+                writer.EndObject();
+                stack.pop_back();
+            }
+        }
+    }
+
+    // appends a name_snapshot of the populated nodes to out, encode(const T&) returns the bytes of a value
+    template <class Encoder>
+    void writeSnapshot(std::string &out, const Encoder &encode) const {
+        name_snapshot::writeHeader(out, _populated_nodes);
+        std::vector<std::pair<uint32_t, size_t>> stack{{ROOT, 0}};
+        std::vector<NameComponentRef> components;
+        if (_nodes[ROOT].value) {
+            name_snapshot::writeRecord(out, components, 0, encode(*_nodes[ROOT].value));
+        }
+        while (!stack.empty()) {
+            auto &frame = stack.back();
+            const auto &children = _nodes[frame.first].children;
+            if (frame.second < children.size()) {
+                uint32_t child = children[frame.second++];
+                components.emplace_back(toRef(_nodes[child]));
+                if (_nodes[child].value) {
+                    name_snapshot::writeRecord(out, components, components.size(), encode(*_nodes[child].value));
+                }
+                stack.emplace_back(child, 0);
+            } else {
+                stack.pop_back();
+                if (!stack.empty()) {
+                    components.pop_back();
+                }
+            }
+        }
+    }
+
+    // inserts the records of a name_snapshot as a bulk insert with replace, decode(value, length) returns the value
+    // of a record or null to skip it. the whole snapshot is checked first, on ndn::tlv::Error the tree is unchanged
+    template <class Decoder>
+    void readSnapshot(const uint8_t *wire, size_t size, const Decoder &decode) {
+        struct Record {
+            size_t begin;
+            size_t count;
+            std::shared_ptr<T> value;
+        };
+        name_snapshot::Reader reader(wire, size);
+        std::vector<NameComponentRef> components;
+        std::vector<Record> records;
+        records.reserve(std::min<uint64_t>(reader.getRecords(), size));
+        const uint8_t *value;
+        size_t value_length;
+        size_t begin = 0;
+        while (reader.next(components, value, value_length)) {
+            if (auto decoded = decode(value, value_length)) {
+                records.push_back({begin, components.size() - begin, std::move(decoded)});
+                begin = components.size();
+            } else {
+                components.resize(begin);
+            }
+        }
+        // written in canonical order, the records need no sorting
+        std::vector<uint32_t> path;
+        for (const auto &record : records) {
+            setValue(getOrCreatePath(components.data() + record.begin, record.count, path), record.value, true);
+        }
+    }
+
+    std::string toJSON() const {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        toJSON(writer);
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+
+    // visitor(name, value) on the populated nodes in canonical Name order, which is the depth first order of the
+    // tree, starting right after cursor or from the root if cursor is null, until visitor returns false. cursor
+    // doesn't need to be in the tree anymore, a listing paged this way sees neither gaps nor repeats from changes
+    // made between two pages, only the entries added or removed meanwhile
+    template <class Visitor>
+    void forEachAfter(const ndn::Name *cursor, const Visitor &visitor) const {
+        struct Frame {
+            uint32_t node;
+            size_t next_child;
+            ndn::Name name;
+        };
+        std::vector<Frame> stack;
+        if (!cursor) {
+            if (_nodes[ROOT].value && !visitor(ndn::Name(), _nodes[ROOT].value)) {
+                return;
+            }
+            stack.push_back(Frame{ROOT, 0, ndn::Name()});
+        } else {
+            // the nodes down the cursor come before it, so do their children which are before the cursor component
+            uint32_t node = ROOT;
+            ndn::Name name;
+            size_t depth = 0;
+            for (; depth < cursor->size(); ++depth) {
+                NameComponentRef component = toRef(cursor->get(depth));
+                auto it = lowerBound(node, component);
+                size_t position = it - _nodes[node].children.begin();
+                if (it == _nodes[node].children.end() || compare(_nodes[*it], component) != 0) {
+                    stack.push_back(Frame{node, position, name});
+                    break;
+                }
+                stack.push_back(Frame{node, position + 1, name});
+                node = *it;
+                name.append(cursor->get(depth));
+            }
+            if (depth == cursor->size()) {
+                // the descendants of the cursor come after it
+                stack.push_back(Frame{node, 0, name});
+            }
+        }
+        while (!stack.empty()) {
+            Frame &frame = stack.back();
+            const auto &children = _nodes[frame.node].children;
+            if (frame.next_child < children.size()) {
+                uint32_t child = children[frame.next_child++];
+                ndn::Name name(frame.name);
+                name.append(toComponent(_nodes[child]));
+                if (_nodes[child].value && !visitor(name, _nodes[child].value)) {
+                    return;
+                }
+                stack.push_back(Frame{child, 0, std::move(name)});
+            } else {
+                stack.pop_back();
+            }
+        }
+    }
+};
@@ -0,0 +1,457 @@
+#pragma once
+
+#include <ndn-cxx/name.hpp>
+#include <ndn-cxx/encoding/block-helpers.hpp>
+
+#include <boost/container/small_vector.hpp>
+
+#include "metrics/memory_stats.h"
+#include "network/name_hash.h"
+#include "network/name_view.h"
+#include "name_snapshot.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// longest prefix match for route sets which are set once and seldom changed, e.g. pushed at deploy time: the
+// records are a single array in canonical Name order, and each prefix length gets a perfect hash of its records
+// (hash and displace, Belazzougui et al.) so that a probe reads a displacement and a slot and compares a single
+// record. every change builds the whole index again, a bulk insert only once
+template <class T>
+class StaticNameIndex {
+private:
+    static const uint32_t EMPTY = UINT32_MAX;
+    // records by bucket on average, and displacements tried for a bucket before the table is made larger
+    static const size_t BUCKET_SIZE = 4;
+    static const uint32_t MAX_DISPLACEMENT = 1 << 16;
+
+    struct Slot {
+        uint64_t hash;
+        uint32_t record;
+    };
+
+    struct Record {
+        ndn::Name name;
+        std::shared_ptr<T> value;
+    };
+
+    struct Table {
+        std::vector<uint32_t> displacements;
+        std::vector<Slot> slots;
+        // the records whose hash equals the one of another record of the same length, looked at one by one
+        std::vector<uint32_t> collided;
+        size_t size = 0;
+    };
+
+    using Hashes = boost::container::small_vector<uint64_t, NameView::INLINE_COMPONENTS + 1>;
+
+    std::vector<Record> _records;
+    // by prefix length, index 0 holds the root
+    std::vector<Table> _tables;
+
+    static NameComponentRef componentAt(const ndn::Name &name, size_t i) {
+        const auto &component = name.get(i);
+        return {component.type(), component.value(), component.value_size()};
+    }
+
+    static NameComponentRef componentAt(const NameView &name, size_t i) {
+        return name[i];
+    }
+
+    static void computeHashes(const ndn::Name &name, size_t max_length, Hashes &hashes) {
+        size_t length = std::min<size_t>(name.size(), max_length);
+        hashes.resize(length + 1);
+        hashes[0] = name_hash::SEED;
+        for (size_t i = 0; i < length; ++i) {
+            hashes[i + 1] = name_hash::extend(hashes[i], componentAt(name, i));
+        }
+    }
+
+    static void computeHashes(const NameView &name, size_t max_length, Hashes &hashes) {
+        size_t length = std::min<size_t>(name.size(), max_length);
+        hashes.resize(length + 1);
+        for (size_t i = 0; i <= length; ++i) {
+            hashes[i] = name.getPrefixHash(i);
+        }
+    }
+
+    static size_t bucketOf(uint64_t hash, size_t buckets) {
+        return (hash >> 32) % buckets;
+    }
+
+    static size_t slotOf(uint64_t hash, uint32_t displacement, size_t mask) {
+        return name_hash::mix(hash, displacement) & mask;
+    }
+
+    template <class NameType>
+    bool matches(const Record &record, const NameType &name, size_t length) const {
+        for (size_t i = 0; i < length; ++i) {
+            if (NameComponentRef::compare(record.name.get(i), componentAt(name, i)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <class NameType>
+    const Record* lookup(const NameType &name, size_t length, uint64_t hash) const {
+        if (length >= _tables.size() || _tables[length].size == 0) {
+            return nullptr;
+        }
+        const Table &table = _tables[length];
+        uint32_t displacement = table.displacements[bucketOf(hash, table.displacements.size())];
+        const Slot &slot = table.slots[slotOf(hash, displacement, table.slots.size() - 1)];
+        if (slot.record != EMPTY && slot.hash == hash && matches(_records[slot.record], name, length)) {
+            return &_records[slot.record];
+        }
+        for (uint32_t record : table.collided) {
+            if (matches(_records[record], name, length)) {
+                return &_records[record];
+            }
+        }
+        return nullptr;
+    }
+
+    // false if a bucket found no displacement, the table must be larger
+    static bool place(Table &table, std::vector<std::vector<Slot>> &buckets) {
+        std::vector<size_t> order(buckets.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        // the largest buckets first, while the table is still empty
+        std::sort(order.begin(), order.end(), [&buckets](size_t lhs, size_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+        size_t mask = table.slots.size() - 1;
+        boost::container::small_vector<size_t, 2 * BUCKET_SIZE> taken;
+        for (size_t bucket : order) {
+            if (buckets[bucket].empty()) {
+                break;
+            }
+            uint32_t displacement = 0;
+            for (; displacement < MAX_DISPLACEMENT; ++displacement) {
+                taken.clear();
+                bool is_free = true;
+                for (const Slot &slot : buckets[bucket]) {
+                    size_t i = slotOf(slot.hash, displacement, mask);
+                    if (table.slots[i].record != EMPTY || std::find(taken.begin(), taken.end(), i) != taken.end()) {
+                        is_free = false;
+                        break;
+                    }
+                    taken.emplace_back(i);
+                }
+                if (is_free) {
+                    break;
+                }
+            }
+            if (displacement == MAX_DISPLACEMENT) {
+                return false;
+            }
+            table.displacements[bucket] = displacement;
+            for (const Slot &slot : buckets[bucket]) {
+                table.slots[slotOf(slot.hash, displacement, mask)] = slot;
+            }
+        }
+        return true;
+    }
+
+    static void build(Table &table, std::vector<Slot> &slots) {
+        table.size = slots.size();
+        table.collided.clear();
+        // the records of a same hash can't be told apart by the perfect hash, all but the first are kept aside
+        std::sort(slots.begin(), slots.end(), [](const Slot &lhs, const Slot &rhs) {
+            return lhs.hash < rhs.hash;
+        });
+        std::vector<Slot> unique;
+        for (const Slot &slot : slots) {
+            if (!unique.empty() && unique.back().hash == slot.hash) {
+                table.collided.emplace_back(slot.record);
+            } else {
+                unique.emplace_back(slot);
+            }
+        }
+        size_t buckets_count = unique.size() / BUCKET_SIZE + 1;
+        std::vector<std::vector<Slot>> buckets(buckets_count);
+        for (const Slot &slot : unique) {
+            buckets[bucketOf(slot.hash, buckets_count)].emplace_back(slot);
+        }
+        // a load of 0.8 at most
+        size_t capacity = 1;
+        while (capacity * 4 < unique.size() * 5) {
+            capacity *= 2;
+        }
+        for (;; capacity *= 2) {
+            table.displacements.assign(buckets_count, 0);
+            table.slots.assign(capacity, Slot{0, EMPTY});
+            if (place(table, buckets)) {
+                return;
+            }
+        }
+    }
+
+    // the tables of all the lengths from the records
+    void rebuild() {
+        size_t max_length = 0;
+        for (const Record &record : _records) {
+            max_length = std::max(max_length, record.name.size());
+        }
+        std::vector<std::vector<Slot>> slots(_records.empty() ? 1 : max_length + 1);
+        for (size_t i = 0; i < _records.size(); ++i) {
+            slots[_records[i].name.size()].emplace_back(Slot{name_hash::hash(_records[i].name), static_cast<uint32_t>(i)});
+        }
+        _tables.assign(slots.size(), Table());
+        for (size_t length = 0; length < slots.size(); ++length) {
+            if (!slots[length].empty()) {
+                build(_tables[length], slots[length]);
+            }
+        }
+    }
+
+    typename std::vector<Record>::iterator lowerBound(const ndn::Name &name) {
+        return std::lower_bound(_records.begin(), _records.end(), name, [](const Record &record, const ndn::Name &name) {
+            return record.name < name;
+        });
+    }
+
+    template <class Writer>
+    static void writeValue(Writer &writer, const std::shared_ptr<T> &value) {
+        std::string json = value ? value->toJSON() : "{}";
+        writer.RawValue(json.c_str(), json.size(), rapidjson::kObjectType);
+    }
+
+    template <class NameType>
+    std::vector<std::shared_ptr<T>> findValuesUntilImpl(const NameType &name) const {
+        std::vector<std::shared_ptr<T>> values;
+        Hashes hashes;
+        computeHashes(name, _tables.size() - 1, hashes);
+        for (size_t length = 0; length < hashes.size(); ++length) {
+            if (const Record *record = lookup(name, length, hashes[length])) {
+                values.emplace_back(record->value);
+            }
+        }
+        return values;
+    }
+
+    template <class NameType>
+    std::shared_ptr<T> findLastValueUntilImpl(const NameType &name) const {
+        Hashes hashes;
+        computeHashes(name, _tables.size() - 1, hashes);
+        for (size_t length = hashes.size(); length-- > 0;) {
+            if (const Record *record = lookup(name, length, hashes[length])) {
+                return record->value;
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    StaticNameIndex() : _tables(1) {
+
+    }
+
+    ~StaticNameIndex() = default;
+
+    size_t size() const {
+        return _records.size();
+    }
+
+    // as NameHashIndex::addMemoryStats, the displacements and the collided records are counted with the slots
+    void addMemoryStats(MemoryStats &stats, const std::string &prefix) const {
+        size_t record_bytes = memory_usage::of(_records);
+        for (const auto &record : _records) {
+            record_bytes += memory_usage::of(record.name);
+        }
+        stats.add(prefix + "_records", _records.size(), record_bytes);
+        size_t slots = 0;
+        size_t slot_bytes = memory_usage::of(_tables);
+        for (const auto &table : _tables) {
+            slots += table.slots.size();
+            slot_bytes += memory_usage::of(table.slots) + memory_usage::of(table.displacements) + memory_usage::of(table.collided);
+        }
+        stats.add(prefix + "_slots", slots, slot_bytes);
+    }
+
+    std::shared_ptr<T> find(const ndn::Name &name) const {
+        const Record *record = lookup(name, name.size(), name_hash::hash(name));
+        return record ? record->value : nullptr;
+    }
+
+    std::shared_ptr<T> find(const NameView &name) const {
+        const Record *record = lookup(name, name.size(), name.getHash());
+        return record ? record->value : nullptr;
+    }
+
+    std::vector<std::shared_ptr<T>> findValuesUntil(const ndn::Name &name) const {
+        return findValuesUntilImpl(name);
+    }
+
+    std::vector<std::shared_ptr<T>> findValuesUntil(const NameView &name) const {
+        return findValuesUntilImpl(name);
+    }
+
+    std::shared_ptr<T> findLastValueUntil(const ndn::Name &name) const {
+        return findLastValueUntilImpl(name);
+    }
+
+    std::shared_ptr<T> findLastValueUntil(const NameView &name) const {
+        return findLastValueUntilImpl(name);
+    }
+
+    void insert(const ndn::Name &name, const std::shared_ptr<T> &value, bool replace = false) {
+        auto it = lowerBound(name);
+        if (it != _records.end() && it->name == name) {
+            if (!replace) {
+                return;
+            }
+            it->value = value;
+            // the tables only hold indexes, they stay valid
+            return;
+        }
+        _records.insert(it, Record{name, value});
+        rebuild();
+    }
+
+    // same as NamedTree, the index is built once for all the entries
+    void insert(std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> entries, bool replace = false) {
+        if (entries.empty()) {
+            return;
+        }
+        // a Name given twice keeps its first value, as the records already there unless replace is set
+        std::stable_sort(entries.begin(), entries.end(), [](const std::pair<ndn::Name, std::shared_ptr<T>> &lhs,
+                                                            const std::pair<ndn::Name, std::shared_ptr<T>> &rhs) {
+            return lhs.first < rhs.first;
+        });
+        std::vector<Record> records;
+        records.reserve(_records.size() + entries.size());
+        auto it = _records.begin();
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (i > 0 && entries[i].first == entries[i - 1].first) {
+                continue;
+            }
+            while (it != _records.end() && it->name < entries[i].first) {
+                records.emplace_back(std::move(*it++));
+            }
+            if (it != _records.end() && it->name == entries[i].first) {
+                if (replace) {
+                    it->value = std::move(entries[i].second);
+                }
+                records.emplace_back(std::move(*it++));
+            } else {
+                records.emplace_back(Record{std::move(entries[i].first), std::move(entries[i].second)});
+            }
+        }
+        while (it != _records.end()) {
+            records.emplace_back(std::move(*it++));
+        }
+        _records.swap(records);
+        rebuild();
+    }
+
+    void clear() {
+        _records.clear();
+        _tables.assign(1, Table());
+    }
+
+    void remove(const ndn::Name &name) {
+        auto it = lowerBound(name);
+        if (it != _records.end() && it->name == name) {
+            _records.erase(it);
+            rebuild();
+        }
+    }
+
+    // same layout as NamedTree::toJSON, every entry is a child of the root
+    template <class Writer>
+    void toJSON(Writer &writer) const {
+        const Record *root = !_records.empty() && _records.front().name.empty() ? &_records.front() : nullptr;
+        writer.StartObject();
+        writer.Key("name");
+        writer.String("/");
+        writer.Key("info");
+        writeValue(writer, root ? root->value : nullptr);
+        writer.Key("children");
+        writer.StartArray();
+        for (const Record &record : _records) {
+            if (!record.value || record.name.size() == 0) {
+                continue;
+            }
+            writer.StartObject();
+            writer.Key("name");
+            std::string uri = record.name.toUri();
+            writer.String(uri.c_str(), static_cast<rapidjson::SizeType>(uri.size()));
+            writer.Key("info");
+            writeValue(writer, record.value);
+            writer.Key("children");
+            writer.StartArray();
+            writer.EndArray();
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+
+    std::string toJSON() const {
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        toJSON(writer);
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
+
+    // same as NamedTree::writeSnapshot
+    template <class Encoder>
+    void writeSnapshot(std::string &out, const Encoder &encode) const {
+        name_snapshot::writeHeader(out, _records.size());
+        std::vector<NameComponentRef> components;
+        forEachAfter(nullptr, [&](const ndn::Name &name, const std::shared_ptr<T> &value) {
+            components.clear();
+            for (size_t i = 0; i < name.size(); ++i) {
+                components.emplace_back(componentAt(name, i));
+            }
+            name_snapshot::writeRecord(out, components, components.size(), encode(*value));
+            return true;
+        });
+    }
+
+    // same as NamedTree::readSnapshot, the index is built once for the whole snapshot
+    template <class Decoder>
+    void readSnapshot(const uint8_t *wire, size_t size, const Decoder &decode) {
+        name_snapshot::Reader reader(wire, size);
+        std::vector<std::pair<ndn::Name, std::shared_ptr<T>>> entries;
+        std::vector<NameComponentRef> components;
+        const uint8_t *value;
+        size_t value_length;
+        while (reader.next(components, value, value_length)) {
+            if (auto decoded = decode(value, value_length)) {
+                ndn::Name name;
+                for (const auto &component : components) {
+                    name.append(ndn::Name::Component(ndn::makeBinaryBlock(component.type, component.value, component.length)));
+                }
+                entries.emplace_back(std::move(name), std::move(decoded));
+            }
+            components.clear();
+        }
+        insert(std::move(entries), true);
+    }
+
+    // same as NamedTree::forEachAfter, the records are in order already
+    template <class Visitor>
+    void forEachAfter(const ndn::Name *cursor, const Visitor &visitor) const {
+        auto it = _records.begin();
+        if (cursor) {
+            it = std::upper_bound(_records.begin(), _records.end(), *cursor, [](const ndn::Name &name, const Record &record) {
+                return name < record.name;
+            });
+        }
+        for (; it != _records.end(); ++it) {
+            if (it->value && !visitor(it->name, it->value)) {
+                return;
+            }
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <ndn-cxx/util/time.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "metrics/memory_stats.h"
+
+// hashed timing wheel (Varghese and Lauck) of the entries of a table by deadline: a slot per tick, an entry goes to
+// the slot of its deadline and is handed back once the wheel has turned past it. the wheel only holds weak_ptr, an
+// entry removed from its table is skipped and one whose deadline moved is scheduled again by the owner when handed
+// back, so nothing is ever looked up or removed. deadlines beyond a turn go to the last slot and come back early
+template <class T>
+class TimerWheel {
+public:
+    using Clock = ndn::time::steady_clock;
+
+private:
+    Clock::duration _tick;
+    std::vector<std::vector<std::weak_ptr<T>>> _slots;
+    size_t _current = 0;
+    Clock::time_point _current_time;
+    // entries scheduled and not handed back yet, dead ones included
+    size_t _size = 0;
+    // reused by each advance
+    std::vector<std::weak_ptr<T>> _due;
+
+public:
+    TimerWheel(Clock::duration tick, size_t slots, const Clock::time_point &now = Clock::now())
+            : _tick(tick)
+            , _slots(std::max<size_t>(slots, 2))
+            , _current_time(now) {
+
+    }
+
+    Clock::duration getTick() const {
+        return _tick;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    // of the slots and the weak_ptr they hold, the entries aside
+    size_t getMemoryUsage() const {
+        size_t bytes = memory_usage::of(_slots) + memory_usage::of(_due);
+        for (const auto &slot : _slots) {
+            bytes += memory_usage::of(slot);
+        }
+        return bytes;
+    }
+
+    // at least a tick ahead, the slot being handed back is never scheduled into
+    void schedule(const std::shared_ptr<T> &entry, const Clock::time_point &deadline) {
+        size_t ticks = 1;
+        if (deadline > _current_time) {
+            ticks = static_cast<size_t>((deadline - _current_time + _tick - Clock::duration(1)) / _tick);
+        }
+        ticks = std::min(std::max<size_t>(ticks, 1), _slots.size() - 1);
+        _slots[(_current + ticks) % _slots.size()].emplace_back(entry);
+        ++_size;
+    }
+
+    // turns the wheel up to now, on_due(const std::shared_ptr<T>&) is called on the entries of the slots passed which
+    // are still alive, their deadline is at or before now unless it was beyond a turn
+    template <class OnDue>
+    void advance(const Clock::time_point &now, const OnDue &on_due) {
+        while (_current_time + _tick <= now) {
+            _current = (_current + 1) % _slots.size();
+            _current_time += _tick;
+            _due.swap(_slots[_current]);
+            _size -= _due.size();
+            for (const auto &weak : _due) {
+                if (auto entry = weak.lock()) {
+                    on_due(entry);
+                }
+            }
+            _due.clear();
+        }
+    }
+};
\ No newline at end of file
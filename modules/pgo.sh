@@ -0,0 +1,45 @@
+#!/bin/sh
+# profile-guided build of a module: an instrumented build serves a load from ndnms-bench, then the module is built
+# again with the profiles of that run. the load should look like production, e.g. the distribution of its Names
+#
+#   ./pgo.sh CS_ST "-n cs -s 100000 -p 6363 -C 6362" "-m consumer -c 127.0.0.1:6363 -d zipf:10000:0.8 -D 30" -DNDNMS_LTO=ON
+#
+# the arguments after the ones of the bench go to cmake, SETUP is run once the module is up if set, e.g. a script
+# sending it the add_face of its upstream, and the build goes in BUILD_DIR, <module>/build-pgo by default
+set -e
+
+if [ $# -lt 3 ]; then
+    echo "usage: $0 MODULE MODULE_ARGS BENCH_ARGS [CMAKE_ARGS...]" >&2
+    exit 1
+fi
+cd "$(dirname "$0")"
+module=${1%/}
+module_args=$2
+bench_args=$3
+shift 3
+build_dir=${BUILD_DIR:-$module/build-pgo}
+pgo_dir=$(pwd)/$build_dir/pgo
+binary=$(sed -n 's/^project(\(.*\))/\1/p' "$module/CMakeLists.txt")
+
+rm -rf "$pgo_dir"
+cmake -S "$module" -B "$build_dir" -DCMAKE_BUILD_TYPE=Release -DNDNMS_PGO=GENERATE -DNDNMS_PGO_DIR="$pgo_dir" "$@"
+cmake --build "$build_dir" --target "$binary" -j "$(nproc)"
+cmake -S LG_MT -B LG_MT/build-pgo -DCMAKE_BUILD_TYPE=Release
+cmake --build LG_MT/build-pgo -j "$(nproc)"
+
+# the profiles are written when the module exits, after the drain of SIGINT
+"$module/bin/$binary" $module_args &
+pid=$!
+sleep 1
+if [ -n "$SETUP" ]; then
+    sh -c "$SETUP"
+fi
+LG_MT/bin/ndnms-bench $bench_args
+kill -INT $pid
+wait $pid || true
+
+if ls "$pgo_dir"/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -o "$pgo_dir/merged.profdata" "$pgo_dir"/*.profraw
+fi
+cmake -S "$module" -B "$build_dir" -DNDNMS_PGO=USE
+cmake --build "$build_dir" --target "$binary" --clean-first -j "$(nproc)"
\ No newline at end of file